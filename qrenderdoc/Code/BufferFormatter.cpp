@@ -1484,6 +1484,312 @@ QVariantList GetVariants(ResourceFormat rowFormat, uint32_t rowCount, uint32_t r
   return ret;
 }
 
+FormatDecodePlan CompileDecodePlan(const ResourceFormat &rowFormat, uint32_t rowCount,
+                                   uint32_t rowByteStride)
+{
+  using Kernel = FormatDecodePlan::Kernel;
+
+  FormatDecodePlan plan;
+
+  if(rowFormat.type != ResourceFormatType::Regular || rowFormat.compCount == 0)
+    return plan;
+
+  const uint32_t w = rowFormat.compByteWidth;
+
+  Kernel kernel = Kernel::Generic;
+  QMetaType::Type valueType = QMetaType::Float;
+
+  switch(rowFormat.compType)
+  {
+    case CompType::Float:
+      if(w == 8)
+      {
+        kernel = Kernel::Float64;
+        valueType = QMetaType::Double;
+      }
+      else if(w == 4)
+      {
+        kernel = Kernel::Float32;
+      }
+      else if(w == 2)
+      {
+        kernel = Kernel::Float16;
+      }
+      break;
+    case CompType::Double:
+      if(w == 8)
+      {
+        kernel = Kernel::Float64;
+        valueType = QMetaType::Double;
+      }
+      break;
+    case CompType::SInt:
+      valueType = QMetaType::Int;
+      if(w == 8)
+      {
+        kernel = Kernel::SInt64;
+        valueType = QMetaType::LongLong;
+      }
+      else if(w == 4)
+      {
+        kernel = Kernel::SInt32;
+      }
+      else if(w == 2)
+      {
+        kernel = Kernel::SInt16;
+      }
+      else if(w == 1)
+      {
+        kernel = Kernel::SInt8;
+      }
+      break;
+    case CompType::UInt:
+      valueType = QMetaType::UInt;
+      if(w == 8)
+      {
+        kernel = Kernel::UInt64;
+        valueType = QMetaType::ULongLong;
+      }
+      else if(w == 4)
+      {
+        kernel = Kernel::UInt32;
+      }
+      else if(w == 2)
+      {
+        kernel = Kernel::UInt16;
+      }
+      else if(w == 1)
+      {
+        kernel = Kernel::UInt8;
+      }
+      break;
+    case CompType::SScaled:
+      if(w == 4)
+        kernel = Kernel::SScaled32;
+      else if(w == 2)
+        kernel = Kernel::SScaled16;
+      else if(w == 1)
+        kernel = Kernel::SScaled8;
+      break;
+    case CompType::UScaled:
+      if(w == 4)
+        kernel = Kernel::UScaled32;
+      else if(w == 2)
+        kernel = Kernel::UScaled16;
+      else if(w == 1)
+        kernel = Kernel::UScaled8;
+      break;
+    case CompType::Depth:
+      // 24-bit depth needs masking against the stencil bits, leave that to GetVariants
+      if(w == 4)
+        kernel = Kernel::Float32;
+      else if(w == 2)
+        kernel = Kernel::UNorm16;
+      break;
+    case CompType::UNorm:
+    case CompType::UNormSRGB:
+      if(w == 2)
+        kernel = Kernel::UNorm16;
+      else if(w == 1)
+        kernel = Kernel::UNorm8;
+      break;
+    case CompType::SNorm:
+      if(w == 2)
+        kernel = Kernel::SNorm16;
+      else if(w == 1)
+        kernel = Kernel::SNorm8;
+      break;
+    default: break;
+  }
+
+  if(kernel == Kernel::Generic)
+    return plan;
+
+  plan.kernel = kernel;
+  plan.valueType = valueType;
+  plan.compCount = rowFormat.compCount;
+  plan.rowCount = qMax(rowCount, 1U);
+  plan.compByteWidth = w;
+
+  // GetVariants never steps backwards, so a row stride smaller than a row acts as tightly packed
+  const uint32_t rowBytes = plan.compCount * w;
+  plan.rowByteStride = qMax(rowByteStride, rowBytes);
+  plan.elementByteSize = (plan.rowCount - 1) * plan.rowByteStride + rowBytes;
+  plan.bgraOrder = rowFormat.BGRAOrder();
+
+  return plan;
+}
+
+template <typename T, typename Convert>
+static void DecodeElementsKernel(const FormatDecodePlan &plan, const byte *data, size_t byteStride,
+                                 uint32_t numElements, DecodedValue *out, Convert convert)
+{
+  for(uint32_t e = 0; e < numElements; e++)
+  {
+    const byte *element = data + byteStride * e;
+
+    for(uint32_t r = 0; r < plan.rowCount; r++)
+    {
+      const byte *row = element + plan.rowByteStride * r;
+
+      for(uint32_t c = 0; c < plan.compCount; c++)
+      {
+        T raw;
+        memcpy(&raw, row + sizeof(T) * c, sizeof(T));
+        convert(*(out++), raw);
+      }
+    }
+  }
+}
+
+uint32_t DecodeElements(const FormatDecodePlan &plan, const byte *data, const byte *end,
+                        size_t byteStride, uint32_t numElements, QVector<DecodedValue> &out)
+{
+  using Kernel = FormatDecodePlan::Kernel;
+
+  if(plan.kernel == Kernel::Generic || data == NULL || data > end ||
+     size_t(end - data) < plan.elementByteSize)
+    return 0;
+
+  // only decode the elements that are entirely in bounds
+  uint32_t numValid = numElements;
+  if(byteStride > 0)
+    numValid = (uint32_t)qMin<size_t>(
+        numElements, (size_t(end - data) - plan.elementByteSize) / byteStride + 1);
+
+  if(numValid == 0)
+    return 0;
+
+  const int base = out.size();
+  out.resize(base + int(numValid * plan.valuesPerElement()));
+  DecodedValue *dst = out.data() + base;
+
+  switch(plan.kernel)
+  {
+    case Kernel::Generic: break;
+    case Kernel::Float16:
+      DecodeElementsKernel<uint16_t>(plan, data, byteStride, numValid, dst,
+                                     [](DecodedValue &v, uint16_t x) {
+                                       v.f = RENDERDOC_HalfToFloat(x);
+                                     });
+      break;
+    case Kernel::Float32:
+      DecodeElementsKernel<float>(plan, data, byteStride, numValid, dst,
+                                  [](DecodedValue &v, float x) { v.f = x; });
+      break;
+    case Kernel::Float64:
+      DecodeElementsKernel<double>(plan, data, byteStride, numValid, dst,
+                                   [](DecodedValue &v, double x) { v.d = x; });
+      break;
+    case Kernel::SInt8:
+      DecodeElementsKernel<int8_t>(plan, data, byteStride, numValid, dst,
+                                   [](DecodedValue &v, int8_t x) { v.i = x; });
+      break;
+    case Kernel::SInt16:
+      DecodeElementsKernel<int16_t>(plan, data, byteStride, numValid, dst,
+                                    [](DecodedValue &v, int16_t x) { v.i = x; });
+      break;
+    case Kernel::SInt32:
+      DecodeElementsKernel<int32_t>(plan, data, byteStride, numValid, dst,
+                                    [](DecodedValue &v, int32_t x) { v.i = x; });
+      break;
+    case Kernel::SInt64:
+      DecodeElementsKernel<int64_t>(plan, data, byteStride, numValid, dst,
+                                    [](DecodedValue &v, int64_t x) { v.i64 = x; });
+      break;
+    case Kernel::UInt8:
+      DecodeElementsKernel<uint8_t>(plan, data, byteStride, numValid, dst,
+                                    [](DecodedValue &v, uint8_t x) { v.u = x; });
+      break;
+    case Kernel::UInt16:
+      DecodeElementsKernel<uint16_t>(plan, data, byteStride, numValid, dst,
+                                     [](DecodedValue &v, uint16_t x) { v.u = x; });
+      break;
+    case Kernel::UInt32:
+      DecodeElementsKernel<uint32_t>(plan, data, byteStride, numValid, dst,
+                                     [](DecodedValue &v, uint32_t x) { v.u = x; });
+      break;
+    case Kernel::UInt64:
+      DecodeElementsKernel<uint64_t>(plan, data, byteStride, numValid, dst,
+                                     [](DecodedValue &v, uint64_t x) { v.u64 = x; });
+      break;
+    case Kernel::SScaled8:
+      DecodeElementsKernel<int8_t>(plan, data, byteStride, numValid, dst,
+                                   [](DecodedValue &v, int8_t x) { v.f = (float)x; });
+      break;
+    case Kernel::SScaled16:
+      DecodeElementsKernel<int16_t>(plan, data, byteStride, numValid, dst,
+                                    [](DecodedValue &v, int16_t x) { v.f = (float)x; });
+      break;
+    case Kernel::SScaled32:
+      DecodeElementsKernel<int32_t>(plan, data, byteStride, numValid, dst,
+                                    [](DecodedValue &v, int32_t x) { v.f = (float)x; });
+      break;
+    case Kernel::UScaled8:
+      DecodeElementsKernel<uint8_t>(plan, data, byteStride, numValid, dst,
+                                    [](DecodedValue &v, uint8_t x) { v.f = (float)x; });
+      break;
+    case Kernel::UScaled16:
+      DecodeElementsKernel<uint16_t>(plan, data, byteStride, numValid, dst,
+                                     [](DecodedValue &v, uint16_t x) { v.f = (float)x; });
+      break;
+    case Kernel::UScaled32:
+      DecodeElementsKernel<uint32_t>(plan, data, byteStride, numValid, dst,
+                                     [](DecodedValue &v, uint32_t x) { v.f = (float)x; });
+      break;
+    case Kernel::SNorm8:
+      DecodeElementsKernel<int8_t>(plan, data, byteStride, numValid, dst,
+                                   [](DecodedValue &v, int8_t x) {
+                                     v.f = x == -128 ? -1.0f : (float)x / 127.0f;
+                                   });
+      break;
+    case Kernel::SNorm16:
+      DecodeElementsKernel<int16_t>(plan, data, byteStride, numValid, dst,
+                                    [](DecodedValue &v, int16_t x) {
+                                      v.f = x == -32768 ? -1.0f : (float)x / 32767.0f;
+                                    });
+      break;
+    case Kernel::UNorm8:
+      DecodeElementsKernel<uint8_t>(plan, data, byteStride, numValid, dst,
+                                    [](DecodedValue &v, uint8_t x) { v.f = (float)x / 255.0f; });
+      break;
+    case Kernel::UNorm16:
+      DecodeElementsKernel<uint16_t>(plan, data, byteStride, numValid, dst,
+                                     [](DecodedValue &v, uint16_t x) {
+                                       v.f = (float)x / (float)0xffff;
+                                     });
+      break;
+  }
+
+  // same as GetVariants, only the first row is swizzled
+  if(plan.bgraOrder && plan.compCount >= 3)
+  {
+    for(uint32_t e = 0; e < numValid; e++)
+    {
+      DecodedValue *element = dst + e * plan.valuesPerElement();
+      qSwap(element[0], element[2]);
+    }
+  }
+
+  return numValid;
+}
+
+QVariant DecodedToVariant(const FormatDecodePlan &plan, const DecodedValue &val)
+{
+  switch(plan.valueType)
+  {
+    case QMetaType::Float: return val.f;
+    case QMetaType::Double: return val.d;
+    case QMetaType::Int: return val.i;
+    case QMetaType::UInt: return val.u;
+    case QMetaType::LongLong: return (qlonglong)val.i64;
+    case QMetaType::ULongLong: return (qulonglong)val.u64;
+    default: break;
+  }
+
+  return QVariant();
+}
+
 QString TypeString(const ShaderVariable &v)
 {
   if(!v.members.isEmpty() || v.isStruct)
@@ -34,6 +34,7 @@
 #include <QMetaObject>
 #include <QProgressDialog>
 #include <QRegularExpression>
+#include <QSet>
 #include <QTimer>
 #include "Code/Resources.h"
 #include "Code/pyrenderdoc/PythonContext.h"
@@ -983,6 +984,8 @@ void CaptureContext::LoadCaptureThreaded(const QString &captureFile, const Repla
     }
   }
 
+  StartSearchIndex();
+
   m_LoadInProgress = false;
   m_CaptureLoaded = true;
 }
@@ -1248,6 +1251,9 @@ void CaptureContext::CloseCapture()
 
   m_CaptureFile = QString();
 
+  // the index reads the structured file owned by the replay, so it must stop first
+  StopSearchIndex();
+
   m_Replay.CloseThread();
 
   memset(&m_APIProps, 0, sizeof(m_APIProps));
@@ -1277,6 +1283,9 @@ void CaptureContext::CloseCapture()
   m_DebugMessages.clear();
   m_UnreadMessageCount = 0;
 
+  ClearReplayData();
+  m_ReplayDataEventID = 0;
+
   m_CaptureLoaded = false;
 
   rdcarray<ICaptureViewer *> capviewers(m_CaptureViewers);
@@ -1288,6 +1297,169 @@ void CaptureContext::CloseCapture()
   }
 }
 
+static void AddSearchTerms(QSet<QString> &terms, const SDObject *obj)
+{
+  terms.insert(QString(obj->name).toLower());
+
+  if(obj->type.flags & SDTypeFlags::HasCustomString)
+    terms.insert(QString(obj->data.str).toLower());
+
+  switch(obj->type.basetype)
+  {
+    case SDBasic::Chunk:
+    case SDBasic::Struct:
+    case SDBasic::Array:
+      for(size_t i = 0; i < obj->NumChildren(); i++)
+        AddSearchTerms(terms, obj->GetChild(i));
+      break;
+    case SDBasic::String:
+      // don't index large strings like shader source, they're not useful as exact search terms
+      if(obj->data.str.size() <= 256)
+        terms.insert(QString(obj->data.str).toLower());
+      break;
+    case SDBasic::Resource: terms.insert(ToQStr(obj->data.basic.id).toLower()); break;
+    case SDBasic::Enum:
+    case SDBasic::UnsignedInteger: terms.insert(QString::number(obj->data.basic.u)); break;
+    case SDBasic::SignedInteger: terms.insert(QString::number(obj->data.basic.i)); break;
+    case SDBasic::Float: terms.insert(QString::number(obj->data.basic.d)); break;
+    case SDBasic::Boolean: terms.insert(obj->data.basic.b ? lit("true") : lit("false")); break;
+    case SDBasic::Null:
+    case SDBasic::Buffer:
+    case SDBasic::Character: break;
+  }
+}
+
+void CaptureContext::StartSearchIndex()
+{
+  m_SearchIndexAbort = false;
+  m_SearchIndexedChunks = 0;
+  m_SearchIndex.clear();
+
+  const SDFile *file = m_StructuredFile;
+
+  m_SearchIndexThread = new LambdaThread([this, file]() {
+    const size_t batchSize = 256;
+
+    for(size_t first = 0; first < file->chunks.size(); first += batchSize)
+    {
+      size_t last = qMin(first + batchSize, file->chunks.size());
+
+      // gather the terms without holding the lock, so queries only wait for the merge
+      QVector<QSet<QString>> chunkTerms((int)(last - first));
+      for(size_t c = first; c < last; c++)
+        AddSearchTerms(chunkTerms[int(c - first)], file->chunks[c]);
+
+      QMutexLocker lock(&m_SearchIndexLock);
+
+      if(m_SearchIndexAbort)
+        return;
+
+      for(size_t c = first; c < last; c++)
+        for(const QString &term : chunkTerms[int(c - first)])
+          m_SearchIndex[term].push_back(uint32_t(c));
+
+      m_SearchIndexedChunks = last;
+    }
+  });
+  m_SearchIndexThread->setName(lit("StructuredSearchIndex"));
+  m_SearchIndexThread->start(QThread::LowPriority);
+}
+
+void CaptureContext::StopSearchIndex()
+{
+  if(!m_SearchIndexThread)
+    return;
+
+  {
+    QMutexLocker lock(&m_SearchIndexLock);
+    m_SearchIndexAbort = true;
+  }
+
+  m_SearchIndexThread->wait();
+  m_SearchIndexThread->deleteLater();
+  m_SearchIndexThread = NULL;
+
+  m_SearchIndex.clear();
+  m_SearchIndexedChunks = 0;
+}
+
+QVector<uint32_t> CaptureContext::LookupSearchTerm(const QString &term,
+                                                   const QVector<QString> &resourceTerms)
+{
+  QVector<uint32_t> ret = m_SearchIndex.value(term);
+
+  // merge in the chunks referencing any resource with this name, keeping the list sorted
+  for(const QString &res : resourceTerms)
+  {
+    QVector<uint32_t> resChunks = m_SearchIndex.value(res);
+    QVector<uint32_t> merged;
+    std::set_union(ret.begin(), ret.end(), resChunks.begin(), resChunks.end(),
+                   std::back_inserter(merged));
+    ret.swap(merged);
+  }
+
+  return ret;
+}
+
+rdcarray<uint32_t> CaptureContext::FindStructuredChunks(const rdcarray<rdcstr> &terms)
+{
+  if(terms.empty() || !m_SearchIndexThread)
+    return {};
+
+  // resolve resource names before taking the lock, the index only knows the IDs
+  QVector<QVector<QString>> resourceTerms(terms.count());
+  for(int i = 0; i < terms.count(); i++)
+  {
+    QString term = QString(terms[i]).toLower();
+    for(const ResourceDescription &res : m_ResourceList)
+    {
+      if(QString(GetResourceName(&res)).toLower() == term)
+        resourceTerms[i].push_back(ToQStr(res.resourceId).toLower());
+    }
+  }
+
+  QMutexLocker lock(&m_SearchIndexLock);
+
+  QVector<uint32_t> matches;
+
+  for(int i = 0; i < terms.count(); i++)
+  {
+    QVector<uint32_t> termMatches = LookupSearchTerm(QString(terms[i]).toLower(), resourceTerms[i]);
+
+    if(i == 0)
+    {
+      matches.swap(termMatches);
+    }
+    else
+    {
+      QVector<uint32_t> both;
+      std::set_intersection(matches.begin(), matches.end(), termMatches.begin(),
+                            termMatches.end(), std::back_inserter(both));
+      matches.swap(both);
+    }
+
+    if(matches.isEmpty())
+      break;
+  }
+
+  rdcarray<uint32_t> ret;
+  ret.assign(matches);
+  return ret;
+}
+
+float CaptureContext::GetStructuredSearchProgress()
+{
+  if(!m_SearchIndexThread)
+    return 1.0f;
+
+  QMutexLocker lock(&m_SearchIndexLock);
+
+  if(m_StructuredFile->chunks.empty())
+    return 1.0f;
+
+  return float(m_SearchIndexedChunks) / float(m_StructuredFile->chunks.size());
+}
+
 bool CaptureContext::ImportCapture(const CaptureFileFormat &fmt, const rdcstr &importfile,
                                    const rdcstr &rdcfile)
 {
@@ -1433,8 +1605,24 @@ void CaptureContext::SetEventID(const rdcarray<ICaptureViewer *> &exclude, uint3
   uint32_t prevEventID = m_EventID;
   m_EventID = eventId;
 
-  m_Replay.BlockInvoke([this, eventId, force](IReplayController *r) {
+  // the API inspector shows the chunks for the selected drawcall, which may not be the current one
+  rdcarray<uint32_t> selectedChunks;
+  const DrawcallDescription *selectedDraw = GetDrawcall(selectedEventID);
+  if(selectedDraw)
+  {
+    for(const APIEvent &ev : selectedDraw->events)
+      selectedChunks.push_back(ev.chunkIndex);
+  }
+
+  m_Replay.BlockInvoke([this, eventId, force, selectedChunks](IReplayController *r) {
+    // a forced refresh can change the results at any event, e.g. after editing a shader
+    if(force)
+      ClearReplayData();
+
+    m_ReplayDataEventID = eventId;
+
     r->SetFrameEvent(eventId, force);
+    r->FetchStructuredChunks(selectedChunks);
     m_CurD3D11PipelineState = r->GetD3D11PipelineState();
     m_CurD3D12PipelineState = r->GetD3D12PipelineState();
     m_CurGLPipelineState = r->GetGLPipelineState();
@@ -1448,6 +1636,117 @@ void CaptureContext::SetEventID(const rdcarray<ICaptureViewer *> &exclude, uint3
   RefreshUIStatus(exclude, updateSelectedEvent, updateEvent);
 }
 
+static size_t ShaderVariableByteSize(const rdcarray<ShaderVariable> &vars)
+{
+  size_t ret = vars.size() * sizeof(ShaderVariable);
+  for(const ShaderVariable &v : vars)
+    ret += v.name.size() + ShaderVariableByteSize(v.members);
+  return ret;
+}
+
+bytebuf CaptureContext::GetCachedBufferData(IReplayController *r, ResourceId buff,
+                                            uint64_t offset, uint64_t len)
+{
+  QString key = QFormatStr("buf:%1:%2:%3:%4")
+                    .arg(m_ReplayDataEventID)
+                    .arg(ToQStr(buff))
+                    .arg(offset)
+                    .arg(len);
+
+  {
+    QMutexLocker lock(&m_ReplayDataLock);
+    auto it = m_ReplayData.find(key);
+    if(it != m_ReplayData.end())
+    {
+      it->lastUse = ++m_ReplayDataTick;
+      return it->data;
+    }
+  }
+
+  ReplayDataEntry entry;
+  entry.data = r->GetBufferData(buff, offset, len);
+  entry.size = entry.data.size();
+
+  AddReplayData(key, entry);
+
+  return entry.data;
+}
+
+rdcarray<ShaderVariable> CaptureContext::GetCachedCBufferVariableContents(
+    IReplayController *r, ResourceId pipeline, ResourceId shader, const rdcstr &entryPoint,
+    uint32_t cbufslot, ResourceId buffer, uint64_t offset, uint64_t length)
+{
+  QString key = QFormatStr("cb:%1:%2:%3:%4:%5:%6:%7:%8")
+                    .arg(m_ReplayDataEventID)
+                    .arg(ToQStr(pipeline))
+                    .arg(ToQStr(shader))
+                    .arg(QString(entryPoint))
+                    .arg(cbufslot)
+                    .arg(ToQStr(buffer))
+                    .arg(offset)
+                    .arg(length);
+
+  {
+    QMutexLocker lock(&m_ReplayDataLock);
+    auto it = m_ReplayData.find(key);
+    if(it != m_ReplayData.end())
+    {
+      it->lastUse = ++m_ReplayDataTick;
+      return it->vars;
+    }
+  }
+
+  ReplayDataEntry entry;
+  entry.vars = r->GetCBufferVariableContents(pipeline, shader, entryPoint, cbufslot, buffer,
+                                             offset, length);
+  entry.size = ShaderVariableByteSize(entry.vars);
+
+  AddReplayData(key, entry);
+
+  return entry.vars;
+}
+
+void CaptureContext::AddReplayData(const QString &key, ReplayDataEntry &entry)
+{
+  // don't let a single huge readback flush everything else out
+  if(entry.size > ReplayDataBudget / 4)
+    return;
+
+  QMutexLocker lock(&m_ReplayDataLock);
+
+  entry.lastUse = ++m_ReplayDataTick;
+
+  auto it = m_ReplayData.find(key);
+  if(it != m_ReplayData.end())
+  {
+    m_ReplayDataSize -= it->size;
+    m_ReplayData.erase(it);
+  }
+
+  while(!m_ReplayData.isEmpty() && m_ReplayDataSize + entry.size > ReplayDataBudget)
+  {
+    auto oldest = m_ReplayData.begin();
+    for(auto cur = m_ReplayData.begin(); cur != m_ReplayData.end(); ++cur)
+    {
+      if(cur->lastUse < oldest->lastUse)
+        oldest = cur;
+    }
+
+    m_ReplayDataSize -= oldest->size;
+    m_ReplayData.erase(oldest);
+  }
+
+  m_ReplayDataSize += entry.size;
+  m_ReplayData.insert(key, entry);
+}
+
+void CaptureContext::ClearReplayData()
+{
+  QMutexLocker lock(&m_ReplayDataLock);
+  m_ReplayData.clear();
+  m_ReplayDataSize = 0;
+}
+
 void CaptureContext::SetRemoteHost(int hostIdx)
 {
   m_MainWindow->setRemoteHost(hostIdx);
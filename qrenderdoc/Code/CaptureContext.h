@@ -25,10 +25,13 @@
 #pragma once
 
 #include <QDebug>
+#include <QHash>
 #include <QList>
 #include <QMap>
 #include <QMessageBox>
+#include <QMutex>
 #include <QString>
+#include <QVector>
 #include <QtWidgets/QWidget>
 #include "Interface/QRDInterface.h"
 #include "ReplayManager.h"
@@ -133,6 +136,14 @@ public:
   // Accessors
 
   IReplayManager &Replay() override { return m_Replay; }
+  bytebuf GetCachedBufferData(IReplayController *r, ResourceId buff, uint64_t offset,
+                              uint64_t len) override;
+  rdcarray<ShaderVariable> GetCachedCBufferVariableContents(IReplayController *r,
+                                                            ResourceId pipeline, ResourceId shader,
+                                                            const rdcstr &entryPoint,
+                                                            uint32_t cbufslot, ResourceId buffer,
+                                                            uint64_t offset,
+                                                            uint64_t length) override;
   IExtensionManager &Extensions() override { return *this; }
   bool IsCaptureLoaded() override { return m_CaptureLoaded; }
   bool IsCaptureLocal() override { return m_CaptureLocal; }
@@ -172,6 +183,8 @@ public:
     return GetDrawcall(*m_Drawcalls, eventId);
   }
   const SDFile &GetStructuredFile() override { return *m_StructuredFile; }
+  rdcarray<uint32_t> FindStructuredChunks(const rdcarray<rdcstr> &terms) override;
+  float GetStructuredSearchProgress() override;
   WindowingSystem CurWindowingSystem() override { return m_CurWinSystem; }
   WindowingData CreateWindowingData(QWidget *window) override;
 
@@ -287,6 +300,31 @@ private:
   rdcarray<DebugMessage> m_DebugMessages;
   int m_UnreadMessageCount = 0;
 
+  // replay data shared between panels, keyed by the event the replay was at and the query. The
+  // replay thread runs requests in order, so a request queued behind an identical one is served
+  // from here rather than being replayed again. The least recently used entries are evicted once
+  // the total size goes over budget.
+  struct ReplayDataEntry
+  {
+    bytebuf data;
+    rdcarray<ShaderVariable> vars;
+    size_t size = 0;
+    uint64_t lastUse = 0;
+  };
+
+  static const size_t ReplayDataBudget = 64 * 1024 * 1024;
+
+  void ClearReplayData();
+  void AddReplayData(const QString &key, ReplayDataEntry &entry);
+
+  QMutex m_ReplayDataLock;
+  QHash<QString, ReplayDataEntry> m_ReplayData;
+  size_t m_ReplayDataSize = 0;
+  uint64_t m_ReplayDataTick = 0;
+  // the event the replay is at, set on the replay thread. This can lag m_EventID while requests
+  // from before an event change are still queued
+  uint32_t m_ReplayDataEventID = 0;
+
   void SaveChanges();
 
   bool SaveRenames();
@@ -362,6 +400,18 @@ private:
   const SDFile *m_StructuredFile = NULL;
   SDFile m_DummySDFile;
 
+  // inverted index from lower-cased search term to the sorted chunk indices containing it. Built
+  // on m_SearchIndexThread after load, and protected by m_SearchIndexLock while that runs.
+  void StartSearchIndex();
+  void StopSearchIndex();
+  QVector<uint32_t> LookupSearchTerm(const QString &term, const QVector<QString> &resourceTerms);
+
+  LambdaThread *m_SearchIndexThread = NULL;
+  QMutex m_SearchIndexLock;
+  bool m_SearchIndexAbort = false;
+  size_t m_SearchIndexedChunks = 0;
+  QHash<QString, QVector<uint32_t>> m_SearchIndex;
+
   rdcarray<WindowingSystem> m_WinSystems;
 
   WindowingSystem m_CurWinSystem = WindowingSystem::Unknown;
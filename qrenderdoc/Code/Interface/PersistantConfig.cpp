@@ -704,6 +704,14 @@ ReplayOptions::ReplayOptions(const QVariant &var)
     forceGPUDriverName = map[lit("forceGPUDriverName")].toString();
   if(map.contains(lit("optimisation")))
     optimisation = (ReplayOptimisationLevel)map[lit("optimisation")].toUInt();
+  if(map.contains(lit("concurrentQueues")))
+    concurrentQueues = map[lit("concurrentQueues")].toBool();
+  if(map.contains(lit("replayCheckpointInterval")))
+    replayCheckpointInterval = map[lit("replayCheckpointInterval")].toUInt();
+  if(map.contains(lit("replayCheckpointBudgetMB")))
+    replayCheckpointBudgetMB = map[lit("replayCheckpointBudgetMB")].toUInt();
+  if(map.contains(lit("rerecordCacheMB")))
+    rerecordCacheMB = map[lit("rerecordCacheMB")].toUInt();
 }
 
 ReplayOptions::operator QVariant() const
@@ -715,6 +723,10 @@ ReplayOptions::operator QVariant() const
   map[lit("forceGPUDeviceID")] = forceGPUDeviceID;
   map[lit("forceGPUDriverName")] = forceGPUDriverName;
   map[lit("optimisation")] = (uint32_t)optimisation;
+  map[lit("concurrentQueues")] = concurrentQueues;
+  map[lit("replayCheckpointInterval")] = replayCheckpointInterval;
+  map[lit("replayCheckpointBudgetMB")] = replayCheckpointBudgetMB;
+  map[lit("rerecordCacheMB")] = rerecordCacheMB;
 
   return map;
 }
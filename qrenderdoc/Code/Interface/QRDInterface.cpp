@@ -106,6 +106,19 @@ CaptureSettings::operator QVariant() const
   opts[lit("refAllResources")] = options.refAllResources;
   opts[lit("captureAllCmdLists")] = options.captureAllCmdLists;
   opts[lit("debugOutputMute")] = options.debugOutputMute;
+  opts[lit("flightRecorderFrames")] = options.flightRecorderFrames;
+  opts[lit("flightRecorderMemoryMB")] = options.flightRecorderMemoryMB;
+  opts[lit("captureQueueFamily")] = options.captureQueueFamily;
+  opts[lit("captureFirstSubmit")] = options.captureFirstSubmit;
+  opts[lit("captureNumSubmits")] = options.captureNumSubmits;
+  opts[lit("mergeMultiFrameCaptures")] = options.mergeMultiFrameCaptures;
+  opts[lit("captureMemoryBudgetMB")] = options.captureMemoryBudgetMB;
+  opts[lit("watchCoherentMapWrites")] = options.watchCoherentMapWrites;
+  opts[lit("deferDescriptorUpdates")] = options.deferDescriptorUpdates;
+  opts[lit("dedupInitialContents")] = options.dedupInitialContents;
+  opts[lit("compactInitialStates")] = options.compactInitialStates;
+  opts[lit("asyncCaptureWrite")] = options.asyncCaptureWrite;
+  opts[lit("deferCreationChunks")] = options.deferCreationChunks;
   ret[lit("options")] = opts;
 
   ret[lit("queuedFrameCap")] = queuedFrameCap;
@@ -149,6 +162,21 @@ CaptureSettings::CaptureSettings(const QVariant &v)
   options.refAllResources = opts[lit("refAllResources")].toBool();
   options.captureAllCmdLists = opts[lit("captureAllCmdLists")].toBool();
   options.debugOutputMute = opts[lit("debugOutputMute")].toBool();
+  options.flightRecorderFrames = opts[lit("flightRecorderFrames")].toUInt();
+  if(opts.contains(lit("flightRecorderMemoryMB")))
+    options.flightRecorderMemoryMB = opts[lit("flightRecorderMemoryMB")].toUInt();
+  if(opts.contains(lit("captureQueueFamily")))
+    options.captureQueueFamily = opts[lit("captureQueueFamily")].toUInt();
+  options.captureFirstSubmit = opts[lit("captureFirstSubmit")].toUInt();
+  options.captureNumSubmits = opts[lit("captureNumSubmits")].toUInt();
+  options.mergeMultiFrameCaptures = opts[lit("mergeMultiFrameCaptures")].toBool();
+  options.captureMemoryBudgetMB = opts[lit("captureMemoryBudgetMB")].toUInt();
+  options.watchCoherentMapWrites = opts[lit("watchCoherentMapWrites")].toBool();
+  options.deferDescriptorUpdates = opts[lit("deferDescriptorUpdates")].toBool();
+  options.dedupInitialContents = opts[lit("dedupInitialContents")].toBool();
+  options.compactInitialStates = opts[lit("compactInitialStates")].toBool();
+  options.asyncCaptureWrite = opts[lit("asyncCaptureWrite")].toBool();
+  options.deferCreationChunks = opts[lit("deferCreationChunks")].toBool();
 
   if(data.contains(lit("queuedFrameCap")))
     queuedFrameCap = data[lit("queuedFrameCap")].toUInt();
@@ -653,6 +653,15 @@ struct IPixelHistoryView
 )");
   virtual void SetHistory(const rdcarray<PixelModification> &history) = 0;
 
+  DOCUMENT(R"(Add a batch of history to this window while the full history is still being
+fetched, e.g. from :meth:`~renderdoc.ReplayController.StreamPixelHistory`. Batches can be added in
+any order and are displayed in event order.
+
+:param list history: A list of :class:`~renderdoc.PixelModification` events to add.
+:param float progress: The fraction of the history that has now been added, from 0.0 to 1.0.
+)");
+  virtual void AddHistory(const rdcarray<PixelModification> &history, float progress) = 0;
+
 protected:
   IPixelHistoryView() = default;
   ~IPixelHistoryView() = default;
@@ -868,6 +877,16 @@ comes in, we remove any other requests in the queue before it that have the same
 )");
   virtual void AsyncInvoke(InvokeCallback method) = 0;
 
+  DOCUMENT(R"(Cancel any tagged invoke calls that are still waiting in the queue.
+
+Requests that have already started executing on the replay thread are unaffected. This is useful
+when the work a request would do is no longer needed, e.g. because the UI it would update has been
+closed.
+
+:param str tag: The tag of the callbacks to cancel.
+)");
+  virtual void CancelInvoke(const rdcstr &tag) = 0;
+
   // This is an ugly hack, but we leave BlockInvoke as the last method, so that when the class is
   // extended and the wrapper around BlockInvoke to release the python GIL happens, it picks up the
   // same docstring.
@@ -1177,6 +1196,47 @@ been made.
 )");
   virtual IReplayManager &Replay() = 0;
 
+  DOCUMENT(R"(Retrieve the contents of a range of a buffer at the current event, through a cache
+shared by all panels.
+
+This must be called on the replay thread, e.g. from inside :meth:`ReplayManager.AsyncInvoke`.
+Requests run on the replay thread in order, so when several panels request the same data on an event
+change only the first one is replayed and the rest are served from the cache. The cache is bounded
+in size and is cleared whenever the replay is forcibly refreshed or the capture is closed.
+
+:param ~renderdoc.ReplayController r: The replay controller passed to the invoked callback.
+:param ~renderdoc.ResourceId buff: The id of the buffer to retrieve data from.
+:param int offset: The byte offset to the start of the range.
+:param int len: The length of the range, or 0 to retrieve the rest of the bytes in the buffer.
+:return: The requested buffer contents.
+:rtype: ``bytes``
+)");
+  virtual bytebuf GetCachedBufferData(IReplayController *r, ResourceId buff, uint64_t offset,
+                                      uint64_t len) = 0;
+
+  DOCUMENT(R"(Retrieve the contents of a constant block at the current event, through the same
+cache as :meth:`GetCachedBufferData`.
+
+This must be called on the replay thread, e.g. from inside :meth:`ReplayManager.AsyncInvoke`.
+
+:param ~renderdoc.ReplayController r: The replay controller passed to the invoked callback.
+:param ~renderdoc.ResourceId pipeline: The pipeline state object, if applicable, that this shader is
+  bound to.
+:param ~renderdoc.ResourceId shader: The id of the shader to use for metadata.
+:param str entryPoint: The entry point of the shader being used. In some APIs, this is ignored.
+:param int cbufslot: The index in the :data:`~renderdoc.ShaderReflection.constantBlocks` list to
+  look up.
+:param ~renderdoc.ResourceId buffer: The id of the buffer to use for data.
+:param int offset: Retrieve buffer contents starting at this byte offset.
+:param int length: Retrieve this many bytes after :paramref:`offset`. May be 0 to fetch the rest of
+  the buffer.
+:return: The shader variables with their contents.
+:rtype: ``list`` of :class:`~renderdoc.ShaderVariable`
+)");
+  virtual rdcarray<ShaderVariable> GetCachedCBufferVariableContents(
+      IReplayController *r, ResourceId pipeline, ResourceId shader, const rdcstr &entryPoint,
+      uint32_t cbufslot, ResourceId buffer, uint64_t offset, uint64_t length) = 0;
+
   DOCUMENT(R"(Check whether or not a capture is currently loaded.
 
 :return: ``True`` if a capture is loaded.
@@ -1466,6 +1526,29 @@ called.
 )");
   virtual const SDFile &GetStructuredFile() = 0;
 
+  DOCUMENT(R"(Find the chunks in the :class:`~renderdoc.SDFile` for the currently open capture that
+match a set of search terms.
+
+Each term is matched case-insensitively and exactly against the chunk's name and the names and
+values of all of its parameters. A term can also be the current name of a resource, which matches
+any chunk referencing that resource. Only chunks that match every term are returned.
+
+The search index is built in the background after a capture is loaded, so until
+:meth:`GetStructuredSearchProgress` reaches ``1.0`` only the chunks indexed so far are searched.
+
+:param List[str] terms: The terms to search for.
+:return: The indices of the matching chunks, in ascending order.
+:rtype: List[int]
+)");
+  virtual rdcarray<uint32_t> FindStructuredChunks(const rdcarray<rdcstr> &terms) = 0;
+
+  DOCUMENT(R"(Retrieve how much of the structured data search index has been built so far.
+
+:return: The fraction of chunks that have been indexed, from ``0.0`` to ``1.0``.
+:rtype: float
+)");
+  virtual float GetStructuredSearchProgress() = 0;
+
   DOCUMENT(R"(Retrieve the current windowing system in use.
 
 :return: The active windowing system.
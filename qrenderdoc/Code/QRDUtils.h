@@ -101,6 +101,74 @@ public:
 
 QVariantList GetVariants(ResourceFormat rowFormat, uint32_t rowCount, uint32_t rowByteStride,
                          const byte *&data, const byte *end);
+
+// a single decoded component. Which member is valid is given by the plan's valueType
+union DecodedValue
+{
+  float f;
+  double d;
+  int32_t i;
+  uint32_t u;
+  int64_t i64;
+  uint64_t u64;
+};
+
+// a format compiled down to a flat description of how to decode it, so that many rows can be
+// decoded with one tight typed loop instead of dispatching on the format for every value. Only
+// regular formats get a plan, packed and unusual formats have kernel == Generic and must go
+// through GetVariants
+struct FormatDecodePlan
+{
+  enum class Kernel
+  {
+    Generic,
+    Float16,
+    Float32,
+    Float64,
+    SInt8,
+    SInt16,
+    SInt32,
+    SInt64,
+    UInt8,
+    UInt16,
+    UInt32,
+    UInt64,
+    SScaled8,
+    SScaled16,
+    SScaled32,
+    UScaled8,
+    UScaled16,
+    UScaled32,
+    SNorm8,
+    SNorm16,
+    UNorm8,
+    UNorm16,
+  };
+
+  Kernel kernel = Kernel::Generic;
+  // the QMetaType that GetVariants would have produced for each value
+  QMetaType::Type valueType = QMetaType::UnknownType;
+  // the number of components in a row, and number of rows (e.g. for matrices)
+  uint32_t compCount = 0;
+  uint32_t rowCount = 1;
+  // the byte size of each component, and the stride between rows
+  uint32_t compByteWidth = 0;
+  uint32_t rowByteStride = 0;
+  // the total bytes read for one element
+  uint32_t elementByteSize = 0;
+  bool bgraOrder = false;
+
+  uint32_t valuesPerElement() const { return compCount * rowCount; }
+};
+
+FormatDecodePlan CompileDecodePlan(const ResourceFormat &rowFormat, uint32_t rowCount,
+                                   uint32_t rowByteStride);
+// decodes numElements elements each byteStride apart, starting at data, appending
+// valuesPerElement() values per element to out. Decoding stops at the first element that would
+// read past end, and the number of elements fully decoded is returned.
+uint32_t DecodeElements(const FormatDecodePlan &plan, const byte *data, const byte *end,
+                        size_t byteStride, uint32_t numElements, QVector<DecodedValue> &out);
+QVariant DecodedToVariant(const FormatDecodePlan &plan, const DecodedValue &val);
 ResourceFormat GetInterpretedResourceFormat(const ShaderConstant &elem);
 void SetInterpretedResourceFormat(ShaderConstant &elem, ResourceFormatType interpretType,
                                   CompType interpretCompType);
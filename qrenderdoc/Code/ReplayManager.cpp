@@ -244,22 +244,7 @@ void ReplayManager::AsyncInvoke(const rdcstr &tag, ReplayManager::InvokeCallback
 {
   QString qtag(tag);
 
-  {
-    QMutexLocker autolock(&m_RenderLock);
-    for(int i = 0; i < m_RenderQueue.count();)
-    {
-      if(m_RenderQueue[i]->tag == qtag)
-      {
-        InvokeHandle *cmd = m_RenderQueue.takeAt(i);
-        if(cmd->selfdelete)
-          delete cmd;
-      }
-      else
-      {
-        i++;
-      }
-    }
-  }
+  CancelInvoke(tag);
 
   InvokeHandle *cmd = new InvokeHandle(m, qtag);
   cmd->selfdelete = true;
@@ -286,6 +271,26 @@ void ReplayManager::BlockInvoke(ReplayManager::InvokeCallback m)
   delete cmd;
 }
 
+void ReplayManager::CancelInvoke(const rdcstr &tag)
+{
+  QString qtag(tag);
+
+  QMutexLocker autolock(&m_RenderLock);
+  for(int i = 0; i < m_RenderQueue.count();)
+  {
+    if(m_RenderQueue[i]->tag == qtag)
+    {
+      InvokeHandle *cmd = m_RenderQueue.takeAt(i);
+      if(cmd->selfdelete)
+        delete cmd;
+    }
+    else
+    {
+      i++;
+    }
+  }
+}
+
 void ReplayManager::CancelReplayLoop()
 {
   m_Renderer->CancelReplayLoop();
@@ -64,6 +64,7 @@ public:
   void AsyncInvoke(const rdcstr &tag, InvokeCallback m);
   void AsyncInvoke(InvokeCallback m);
   void BlockInvoke(InvokeCallback m);
+  void CancelInvoke(const rdcstr &tag);
 
   void CancelReplayLoop();
 
@@ -152,16 +152,27 @@ fail:
 
 DEFINE_SAFE_EQUALITY(DrawcallDescription)
 DEFINE_SAFE_EQUALITY(CounterResult)
+DEFINE_SAFE_EQUALITY(EventTiming)
+DEFINE_SAFE_EQUALITY(MarkerRegionTiming)
 DEFINE_SAFE_EQUALITY(APIEvent)
 DEFINE_SAFE_EQUALITY(Bindpoint)
 DEFINE_SAFE_EQUALITY(BufferDescription)
 DEFINE_SAFE_EQUALITY(CaptureFileFormat)
+DEFINE_SAFE_EQUALITY(CaptureDifference)
+DEFINE_SAFE_EQUALITY(ChunkLoadStatistics)
 DEFINE_SAFE_EQUALITY(ConstantBlock)
+DEFINE_SAFE_EQUALITY(ConstantBlockFetch)
 DEFINE_SAFE_EQUALITY(DebugMessage)
 DEFINE_SAFE_EQUALITY(EnvironmentModification)
 DEFINE_SAFE_EQUALITY(EventUsage)
+DEFINE_SAFE_EQUALITY(EventVisitBufferRange)
+DEFINE_SAFE_EQUALITY(EventVisitResult)
+DEFINE_SAFE_EQUALITY(MemoryUsage)
+DEFINE_SAFE_EQUALITY(OverdrawStatistics)
 DEFINE_SAFE_EQUALITY(PathEntry)
 DEFINE_SAFE_EQUALITY(PixelModification)
+DEFINE_SAFE_EQUALITY(PixelHistoryResult)
+DEFINE_SAFE_EQUALITY(PoolObjectCount)
 DEFINE_SAFE_EQUALITY(ResourceDescription)
 DEFINE_SAFE_EQUALITY(ResourceId)
 DEFINE_SAFE_EQUALITY(LineColumnInfo)
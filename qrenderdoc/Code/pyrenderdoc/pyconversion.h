@@ -485,6 +485,51 @@ struct TypeConversion<rdcpair<A, B>, false>
   static PyObject *ConvertToPy(const rdcpair<A, B> &in) { return ConvertToPy(in, NULL); }
 };
 
+// a python object that owns a bytebuf and exposes its contents read-only through the buffer
+// protocol, so large results can be handed to python without copying them into a bytes object.
+struct PyByteBufOwner
+{
+  PyObject_HEAD;
+  bytebuf *buf;
+
+  static void dealloc(PyObject *self)
+  {
+    PyByteBufOwner *owner = (PyByteBufOwner *)self;
+    delete owner->buf;
+    Py_TYPE(self)->tp_free(self);
+  }
+
+  static int getbuffer(PyObject *self, Py_buffer *view, int flags)
+  {
+    bytebuf *buf = ((PyByteBufOwner *)self)->buf;
+    return PyBuffer_FillInfo(view, self, buf->data(), (Py_ssize_t)buf->size(), 1, flags);
+  }
+
+  static PyTypeObject *GetType()
+  {
+    static PyBufferProcs bufferProcs = {&PyByteBufOwner::getbuffer, NULL};
+    static PyTypeObject type = {PyVarObject_HEAD_INIT(NULL, 0)};
+    static bool ready = false;
+
+    if(!ready)
+    {
+      type.tp_name = "renderdoc.ByteBufferOwner";
+      type.tp_basicsize = sizeof(PyByteBufOwner);
+      type.tp_flags = Py_TPFLAGS_DEFAULT;
+      type.tp_doc = "Owns the storage behind a memoryview returned from replay readback functions.";
+      type.tp_dealloc = &PyByteBufOwner::dealloc;
+      type.tp_as_buffer = &bufferProcs;
+
+      if(PyType_Ready(&type) < 0)
+        return NULL;
+
+      ready = true;
+    }
+
+    return &type;
+  }
+};
+
 // specialisation for bytebuf
 template <>
 struct TypeConversion<bytebuf, false>
@@ -517,6 +562,26 @@ struct TypeConversion<bytebuf, false>
   }
 
   static PyObject *ConvertToPy(const bytebuf &in) { return ConvertToPy(in, NULL); }
+
+  // takes the contents of in and returns a memoryview over them, without copying
+  static PyObject *ConvertToPyView(bytebuf &in)
+  {
+    PyTypeObject *type = PyByteBufOwner::GetType();
+    if(!type)
+      return NULL;
+
+    PyByteBufOwner *owner = PyObject_New(PyByteBufOwner, type);
+    if(!owner)
+      return NULL;
+
+    owner->buf = new bytebuf;
+    owner->buf->swap(in);
+
+    // the memoryview holds the only reference to the owner, which is freed along with it
+    PyObject *ret = PyMemoryView_FromObject((PyObject *)owner);
+    Py_DECREF(owner);
+    return ret;
+  }
 };
 
 // specialisation for array
@@ -192,6 +192,12 @@ SIMPLE_TYPEMAPS(rdcstr)
 SIMPLE_TYPEMAPS(rdcdatetime)
 SIMPLE_TYPEMAPS(bytebuf)
 
+// buffer and texture readbacks can be hundreds of megabytes, so instead of copying them into a
+// bytes object they are returned as a memoryview over the readback itself.
+%typemap(out) bytebuf GetBufferData, bytebuf GetTextureData {
+  $result = TypeConversion<bytebuf>::ConvertToPyView($1);
+}
+
 FIXED_ARRAY_TYPEMAPS(ResourceId)
 FIXED_ARRAY_TYPEMAPS(double)
 FIXED_ARRAY_TYPEMAPS(float)
@@ -279,6 +285,101 @@ Invalid if the object is not actually a floating point number.
 Invalid if the object is not actually a string.
 )";
   PyObject *AsString() { return ConvertToPy($self->data.str); }
+
+  %feature("docstring") R"(Interprets the object as an array of integers and returns their values
+as a ``list``. This is much faster than fetching each child individually for large arrays.
+
+Invalid if the object is not actually an array of integers.
+)";
+  PyObject *AsIntList()
+  {
+    PyObject *list = PyList_New((Py_ssize_t)$self->data.children.size());
+    if(!list)
+      return NULL;
+
+    for(size_t i = 0; i < $self->data.children.size(); i++)
+    {
+      const SDObject *child = $self->data.children[i];
+      PyObject *val = NULL;
+      if(child->type.basetype == SDBasic::UnsignedInteger)
+        val = ConvertToPy(child->data.basic.u);
+      else
+        val = ConvertToPy(child->data.basic.i);
+
+      if(!val)
+      {
+        Py_DecRef(list);
+        return NULL;
+      }
+
+      PyList_SetItem(list, (Py_ssize_t)i, val);
+    }
+
+    return list;
+  }
+
+  %feature("docstring") R"(Interprets the object as an array of floating point numbers and returns
+their values as a ``list``. This is much faster than fetching each child individually for large
+arrays.
+
+Invalid if the object is not actually an array of floating point numbers.
+)";
+  PyObject *AsFloatList()
+  {
+    PyObject *list = PyList_New((Py_ssize_t)$self->data.children.size());
+    if(!list)
+      return NULL;
+
+    for(size_t i = 0; i < $self->data.children.size(); i++)
+    {
+      PyObject *val = ConvertToPy($self->data.children[i]->data.basic.d);
+
+      if(!val)
+      {
+        Py_DecRef(list);
+        return NULL;
+      }
+
+      PyList_SetItem(list, (Py_ssize_t)i, val);
+    }
+
+    return list;
+  }
+}
+
+%extend SDFile {
+  %feature("docstring") R"(Finds all chunks with a given name. The search is done natively, so this
+is much faster than filtering :data:`chunks` from python on large captures.
+
+:param str name: The name of the chunks to find.
+:return: The matching chunks, in the order they appear in the file.
+:rtype: ``list`` of :class:`SDChunk`
+)";
+  PyObject *FindChunks(const char *name)
+  {
+    PyObject *list = PyList_New(0);
+    if(!list)
+      return NULL;
+
+    for(SDChunk *chunk : $self->chunks)
+    {
+      if(chunk->name != name)
+        continue;
+
+      PyObject *val = ConvertToPy(chunk);
+
+      if(!val)
+      {
+        Py_DecRef(list);
+        return NULL;
+      }
+
+      PyList_Append(list, val);
+      Py_DecRef(val);
+    }
+
+    return list;
+  }
 }
 
 // add python array members that aren't in slots
@@ -292,6 +393,7 @@ EXTEND_ARRAY_CLASS_METHODS(StructuredBufferList)
 // or in qrenderdoc.i, depending on which one is appropriate
 TEMPLATE_ARRAY_INSTANTIATE(rdcarray, int)
 TEMPLATE_ARRAY_INSTANTIATE(rdcarray, float)
+TEMPLATE_ARRAY_INSTANTIATE(rdcarray, double)
 TEMPLATE_ARRAY_INSTANTIATE(rdcarray, uint32_t)
 TEMPLATE_ARRAY_INSTANTIATE(rdcarray, uint64_t)
 TEMPLATE_ARRAY_INSTANTIATE(rdcarray, rdcstr)
@@ -299,16 +401,26 @@ TEMPLATE_ARRAY_INSTANTIATE(rdcarray, WindowingSystem)
 TEMPLATE_ARRAY_INSTANTIATE(rdcarray, DrawcallDescription)
 TEMPLATE_ARRAY_INSTANTIATE(rdcarray, GPUCounter)
 TEMPLATE_ARRAY_INSTANTIATE(rdcarray, CounterResult)
+TEMPLATE_ARRAY_INSTANTIATE(rdcarray, EventTiming)
+TEMPLATE_ARRAY_INSTANTIATE(rdcarray, MarkerRegionTiming)
 TEMPLATE_ARRAY_INSTANTIATE(rdcarray, APIEvent)
 TEMPLATE_ARRAY_INSTANTIATE(rdcarray, Bindpoint)
 TEMPLATE_ARRAY_INSTANTIATE(rdcarray, BufferDescription)
 TEMPLATE_ARRAY_INSTANTIATE(rdcarray, CaptureFileFormat)
+TEMPLATE_ARRAY_INSTANTIATE(rdcarray, ChunkLoadStatistics)
 TEMPLATE_ARRAY_INSTANTIATE(rdcarray, ConstantBlock)
+TEMPLATE_ARRAY_INSTANTIATE(rdcarray, ConstantBlockFetch)
 TEMPLATE_ARRAY_INSTANTIATE(rdcarray, DebugMessage)
 TEMPLATE_ARRAY_INSTANTIATE(rdcarray, EnvironmentModification)
 TEMPLATE_ARRAY_INSTANTIATE(rdcarray, EventUsage)
+TEMPLATE_ARRAY_INSTANTIATE(rdcarray, EventVisitBufferRange)
+TEMPLATE_ARRAY_INSTANTIATE(rdcarray, EventVisitResult)
+TEMPLATE_ARRAY_INSTANTIATE(rdcarray, MemoryUsage)
+TEMPLATE_ARRAY_INSTANTIATE(rdcarray, OverdrawStatistics)
 TEMPLATE_ARRAY_INSTANTIATE(rdcarray, PathEntry)
 TEMPLATE_ARRAY_INSTANTIATE(rdcarray, PixelModification)
+TEMPLATE_ARRAY_INSTANTIATE(rdcarray, PixelHistoryResult)
+TEMPLATE_ARRAY_INSTANTIATE(rdcarray, PoolObjectCount)
 TEMPLATE_ARRAY_INSTANTIATE(rdcarray, ResourceDescription)
 TEMPLATE_ARRAY_INSTANTIATE(rdcarray, ResourceId)
 TEMPLATE_ARRAY_INSTANTIATE(rdcarray, LineColumnInfo)
@@ -325,6 +437,7 @@ TEMPLATE_ARRAY_INSTANTIATE(rdcarray, DebugVariableReference)
 TEMPLATE_ARRAY_INSTANTIATE(rdcarray, SourceVariableMapping)
 TEMPLATE_ARRAY_INSTANTIATE(rdcarray, SigParameter)
 TEMPLATE_ARRAY_INSTANTIATE(rdcarray, TextureDescription)
+TEMPLATE_ARRAY_INSTANTIATE(rdcarray, TextureSave)
 TEMPLATE_ARRAY_INSTANTIATE(rdcarray, ShaderEntryPoint)
 TEMPLATE_ARRAY_INSTANTIATE(rdcarray, Viewport)
 TEMPLATE_ARRAY_INSTANTIATE(rdcarray, Scissor)
@@ -336,6 +449,7 @@ TEMPLATE_ARRAY_INSTANTIATE(rdcarray, BoundResourceArray)
 TEMPLATE_ARRAY_INSTANTIATE(rdcarray, FloatVector)
 TEMPLATE_ARRAY_INSTANTIATE(rdcarray, GraphicsAPI)
 TEMPLATE_ARRAY_INSTANTIATE(rdcarray, GPUDevice)
+TEMPLATE_ARRAY_INSTANTIATE(rdcarray, CaptureSummary)
 TEMPLATE_ARRAY_INSTANTIATE(rdcarray, ShaderVariableType)
 TEMPLATE_NAMESPACE_ARRAY_INSTANTIATE(rdcarray, VKPipe, Attachment)
 TEMPLATE_NAMESPACE_ARRAY_INSTANTIATE(rdcarray, VKPipe, BindingElement)
@@ -24,6 +24,7 @@
 
 #include "BufferViewer.h"
 #include <float.h>
+#include <QBitArray>
 #include <QDoubleSpinBox>
 #include <QFontDatabase>
 #include <QItemSelection>
@@ -687,6 +688,44 @@ uint32_t CalcIndex(BufferData *data, uint32_t vertID, int32_t baseVertex, uint32
 
 static int columnGroupRole = Qt::UserRole + 10000;
 
+// a page of elements decoded in one go from a compiled plan, so that walking many rows doesn't
+// re-interpret the format for every value
+struct DecodedElementPage
+{
+  static const uint32_t PageSize = 256;
+
+  // returns the decoded values for element idx, where base points to element 0. Returns NULL if the
+  // plan can't decode the format or the element is out of bounds
+  const DecodedValue *fetch(const FormatDecodePlan &plan, const byte *base, const byte *end,
+                            size_t stride, uint32_t idx)
+  {
+    if(plan.kernel == FormatDecodePlan::Kernel::Generic)
+      return NULL;
+
+    const uint32_t pageStart = idx - (idx % PageSize);
+
+    if(first != pageStart)
+    {
+      first = pageStart;
+      count = 0;
+      values.resize(0);
+
+      // don't form a pointer past the end of the buffer
+      if(base <= end && (stride == 0 || pageStart <= size_t(end - base) / stride))
+        count = DecodeElements(plan, base + stride * pageStart, end, stride, PageSize, values);
+    }
+
+    if(idx - first >= count)
+      return NULL;
+
+    return values.data() + (idx - first) * plan.valuesPerElement();
+  }
+
+  uint32_t first = ~0U;
+  uint32_t count = 0;
+  QVector<DecodedValue> values;
+};
+
 class BufferItemModel : public QAbstractItemModel
 {
 public:
@@ -1000,14 +1039,29 @@ public:
 
             data += el.byteOffset;
 
-            // only slightly wasteful, we need to fetch all variants together
-            // since some formats are packed and can't be read individually
-            QVariantList list = GetVariants(prop.format, el.type.descriptor.rows,
-                                            el.type.descriptor.matrixByteStride, data, end);
+            const int elIdx = elementIndexForColumn(col);
+            const FormatDecodePlan &plan = decodePlans[elIdx];
+
+            // decode through the element's page where we can, and only create the one value we
+            // display. Otherwise we need to fetch all variants together since some formats are
+            // packed and can't be read individually
+            const DecodedValue *decoded =
+                decodedElement(elIdx, prop.perinstance ? instIdx : idx, prop, el);
+
+            QVariantList list;
+            if(!decoded)
+              list = GetVariants(prop.format, el.type.descriptor.rows,
+                                 el.type.descriptor.matrixByteStride, data, end);
+
+            auto value = [&](int i) -> QVariant {
+              return decoded ? DecodedToVariant(plan, decoded[i]) : list[i];
+            };
+
+            const int valueCount = decoded ? (int)plan.valuesPerElement() : list.count();
 
             int comp = componentForIndex(col);
 
-            if(comp < list.count())
+            if(comp < valueCount)
             {
               uint32_t rowdim = el.type.descriptor.rows;
               uint32_t coldim = el.type.descriptor.columns;
@@ -1017,9 +1071,9 @@ public:
                 QVariant v;
 
                 if(el.type.descriptor.rowMajorStorage)
-                  v = list[comp];
+                  v = value(comp);
                 else
-                  v = list[comp * rowdim];
+                  v = value(comp * rowdim);
 
                 if(el.type.descriptor.pointerTypeID != ~0U)
                 {
@@ -1046,9 +1100,9 @@ public:
                     ret += lit("\n");
 
                   if(el.type.descriptor.rowMajorStorage)
-                    ret += interpretVariant(list[comp + r * coldim], el, prop);
+                    ret += interpretVariant(value(comp + r * coldim), el, prop);
                   else
-                    ret += interpretVariant(list[r + comp * rowdim], el, prop);
+                    ret += interpretVariant(value(r + comp * rowdim), el, prop);
                 }
 
                 return ret;
@@ -1161,6 +1215,11 @@ private:
   // { 0, 1, 2, 3, 0, 1, 2, 0 };
   QVector<int> columnLookup;
   QVector<int> componentLookup;
+
+  // the compiled decode plan for each column element, and the most recently decoded page of
+  // elements for it
+  QVector<FormatDecodePlan> decodePlans;
+  mutable QVector<DecodedElementPage> decodedPages;
   // the total number of columns including any reserved ones like VTX / IDX
   int totalColumnCount = 0;
 
@@ -1204,18 +1263,39 @@ private:
     componentLookup.clear();
     componentLookup.reserve(config.columns.count() * 4);
 
+    decodePlans.clear();
+    decodePlans.reserve(config.columns.count());
+    decodedPages.clear();
+    decodedPages.resize(config.columns.count());
+
     for(int i = 0; i < config.columns.count(); i++)
     {
       const BufferElementProperties &prop = config.props[i];
+      const ShaderConstant &el = config.columns[i];
 
       for(uint32_t c = 0; c < prop.format.compCount; c++)
       {
         columnLookup.push_back(i);
         componentLookup.push_back((int)c);
       }
+
+      decodePlans.push_back(CompileDecodePlan(prop.format, el.type.descriptor.rows,
+                                              el.type.descriptor.matrixByteStride));
     }
   }
 
+  const DecodedValue *decodedElement(int elIdx, uint32_t idx, const BufferElementProperties &prop,
+                                     const ShaderConstant &el) const
+  {
+    if(prop.buffer >= config.buffers.size())
+      return NULL;
+
+    const BufferData *buf = config.buffers[prop.buffer];
+
+    return decodedPages[elIdx].fetch(decodePlans[elIdx], buf->data() + el.byteOffset, buf->end(),
+                                     buf->stride, idx);
+  }
+
   QString outOfBounds() const { return lit("---"); }
   QString interpretGeneric(int col, const ShaderConstant &el, const BufferElementProperties &prop) const
   {
@@ -1327,6 +1407,8 @@ struct CachedElData
   uint32_t instIdx = 0;
 
   QByteArray nulls;
+
+  FormatDecodePlan plan;
 };
 
 struct PopulateBufferData
@@ -1374,6 +1456,9 @@ void CacheDataForIteration(QVector<CachedElData> &cache, const rdcarray<ShaderCo
     d.byteSize = prop.format.ElementSize() * el.type.descriptor.rows;
     d.nulls = QByteArray(d.byteSize, '\0');
 
+    d.plan = CompileDecodePlan(prop.format, el.type.descriptor.rows,
+                               el.type.descriptor.matrixByteStride);
+
     if(prop.instancerate > 0)
       d.instIdx = inst / prop.instancerate;
 
@@ -1590,8 +1675,9 @@ static void RT_FetchMeshData(IReplayController *r, ICaptureContext &ctx, Populat
 
   bytebuf idata;
   if(ib.resourceId != ResourceId() && draw && (draw->flags & DrawFlags::Indexed))
-    idata = r->GetBufferData(ib.resourceId, ib.byteOffset + draw->indexOffset * draw->indexByteWidth,
-                             draw->numIndices * draw->indexByteWidth);
+    idata = ctx.GetCachedBufferData(r, ib.resourceId,
+                                    ib.byteOffset + draw->indexOffset * draw->indexByteWidth,
+                                    draw->numIndices * draw->indexByteWidth);
 
   if(data->vsinConfig.indices)
     data->vsinConfig.indices->deref();
@@ -1710,8 +1796,9 @@ static void RT_FetchMeshData(IReplayController *r, ICaptureContext &ctx, Populat
     BufferData *buf = new BufferData;
     if(used)
     {
-      buf->storage = r->GetBufferData(vb.resourceId, vb.byteOffset + offset * vb.byteStride,
-                                      qMax(maxIdx, maxIdx + 1) * vb.byteStride + maxAttrOffset);
+      buf->storage =
+          ctx.GetCachedBufferData(r, vb.resourceId, vb.byteOffset + offset * vb.byteStride,
+                                  qMax(maxIdx, maxIdx + 1) * vb.byteStride + maxAttrOffset);
 
       buf->stride = vb.byteStride;
     }
@@ -2417,11 +2504,26 @@ void BufferViewer::OnEventChanged(uint32_t eventId)
 
   QPointer<BufferViewer> me(this);
 
-  m_Ctx.Replay().AsyncInvoke([this, me, bufdata](IReplayController *r) {
+  m_Ctx.Replay().AsyncInvoke([this, me, bufdata, eventId](IReplayController *r) {
 
     if(!me)
       return;
 
+    // when scrubbing through events the selection can move on before this runs, in which case the
+    // fetch for the new event is already queued behind us. Skip fetching data that will never be
+    // seen and only complete the model reset.
+    if(m_Ctx.CurEvent() != eventId)
+    {
+      GUIInvoke::call(this, [this, bufdata]() {
+        m_ModelVSIn->endReset(bufdata->vsinConfig);
+        m_ModelVSOut->endReset(bufdata->vsoutConfig);
+        m_ModelGSOut->endReset(bufdata->gsoutConfig);
+
+        delete bufdata;
+      });
+      return;
+    }
+
     BufferData *buf = NULL;
 
     if(m_MeshView)
@@ -2459,7 +2561,7 @@ void BufferViewer::OnEventChanged(uint32_t eventId)
 
       if(m_IsBuffer)
       {
-        buf->storage = r->GetBufferData(m_BufferID, CurrentByteOffset(), clampedLen);
+        buf->storage = m_Ctx.GetCachedBufferData(r, m_BufferID, CurrentByteOffset(), clampedLen);
       }
       else
       {
@@ -2679,8 +2781,13 @@ void BufferViewer::calcBoundingData(CalcBoundingBoxData &bbox)
 
     CacheDataForIteration(cache, s.columns, s.props, s.buffers, bbox.input[0].curInstance);
 
-    // possible optimisation here if this shows up as a hot spot - sort and unique the indices and
-    // iterate in ascending order, to be more cache friendly
+    QVector<DecodedElementPage> pages(cache.count());
+
+    // the bounds only depend on which vertices are referenced, not how many times. With an index
+    // buffer most vertices are shared by several triangles, so remember which have been visited
+    // and only decode each one once. Implausibly large indices aren't tracked, to bound the memory.
+    const uint32_t maxTrackedIndex = 1U << 26;
+    QBitArray visited;
 
     for(uint32_t row = 0; row < s.numRows; row++)
     {
@@ -2692,6 +2799,17 @@ void BufferViewer::calcBoundingData(CalcBoundingBoxData &bbox)
 
         if(idx == ~0U || (s.primRestart && idx == s.primRestart))
           continue;
+
+        if(idx < maxTrackedIndex)
+        {
+          if((int)idx >= visited.size())
+            visited.resize(qMax((int)idx + 1, visited.size() * 2));
+
+          if(visited.testBit((int)idx))
+            continue;
+
+          visited.setBit((int)idx);
+        }
       }
 
       for(int col = 0; col < s.columns.count(); col++)
@@ -2703,7 +2821,37 @@ void BufferViewer::calcBoundingData(CalcBoundingBoxData &bbox)
         float *minOut = (float *)&minOutputList[col];
         float *maxOut = (float *)&maxOutputList[col];
 
-        if(d.data)
+        if(d.data && d.plan.kernel != FormatDecodePlan::Kernel::Generic)
+        {
+          const DecodedValue *decoded =
+              pages[col].fetch(d.plan, d.data, d.end, d.stride, prop->perinstance ? 0 : idx);
+
+          if(!decoded)
+            continue;
+
+          for(uint32_t comp = 0; comp < 4 && comp < d.plan.valuesPerElement(); comp++)
+          {
+            float fval = 0.0f;
+
+            if(d.plan.valueType == QMetaType::Double)
+              fval = (float)decoded[comp].d;
+            else if(d.plan.valueType == QMetaType::Float)
+              fval = decoded[comp].f;
+            else if(d.plan.valueType == QMetaType::UInt)
+              fval = (float)decoded[comp].u;
+            else if(d.plan.valueType == QMetaType::Int)
+              fval = (float)decoded[comp].i;
+            else
+              continue;
+
+            if(qIsFinite(fval))
+            {
+              minOut[comp] = qMin(minOut[comp], fval);
+              maxOut[comp] = qMax(maxOut[comp], fval);
+            }
+          }
+        }
+        else if(d.data)
         {
           const byte *bytes = d.data;
 
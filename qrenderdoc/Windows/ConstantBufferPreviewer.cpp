@@ -136,7 +136,7 @@ void ConstantBufferPreviewer::OnEventChanged(uint32_t eventId)
   if(!m_formatOverride.type.members.empty())
   {
     m_Ctx.Replay().AsyncInvoke([this, offset, size, wasEmpty](IReplayController *r) {
-      bytebuf data = r->GetBufferData(m_cbuffer, offset, size);
+      bytebuf data = m_Ctx.GetCachedBufferData(r, m_cbuffer, offset, size);
       rdcarray<ShaderVariable> vars = applyFormatOverride(data);
       GUIInvoke::call(this, [this, vars, wasEmpty] {
         RDTreeViewExpansionState state;
@@ -158,8 +158,8 @@ void ConstantBufferPreviewer::OnEventChanged(uint32_t eventId)
   {
     m_Ctx.Replay().AsyncInvoke(
         [this, prevShader, entryPoint, offset, size, wasEmpty](IReplayController *r) {
-          rdcarray<ShaderVariable> vars = r->GetCBufferVariableContents(
-              m_pipe, m_shader, entryPoint.toUtf8().data(), m_slot, m_cbuffer, offset, size);
+          rdcarray<ShaderVariable> vars = m_Ctx.GetCachedCBufferVariableContents(
+              r, m_pipe, m_shader, entryPoint.toUtf8().data(), m_slot, m_cbuffer, offset, size);
           GUIInvoke::call(this, [this, prevShader, vars, wasEmpty] {
 
             RDTreeViewExpansionState &prevShaderExpansionState =
@@ -665,6 +665,31 @@ void LiveCapture::updateAPIStatus()
   ui->apiIcon->setVisible(nonpresenting);
 }
 
+void LiveCapture::updateOverhead(const CaptureOverheadData &overhead)
+{
+  const double MB = 1024.0 * 1024.0;
+
+  ui->overhead->setText(
+      tr("%1 chunks/s, diffing %2 MB/s, scanning maps %3 MB/s\n"
+         "Lock waits %4 ms/s, preparing initial states %5 ms/s")
+          .arg(overhead.chunksPerSecond, 0, 'f', 0)
+          .arg(overhead.diffedBytesPerSecond / MB, 0, 'f', 1)
+          .arg(overhead.scannedMapBytesPerSecond / MB, 0, 'f', 1)
+          .arg(overhead.lockWaitMSPerSecond, 0, 'f', 1)
+          .arg(overhead.prepareInitialStateMSPerSecond, 0, 'f', 1));
+
+  // list the pools with the most wrapped objects first
+  rdcarray<PoolObjectCount> pools = overhead.poolObjects;
+  std::sort(pools.begin(), pools.end(),
+            [](const PoolObjectCount &a, const PoolObjectCount &b) { return a.count > b.count; });
+
+  QString tooltip = tr("Wrapped objects allocated:");
+  for(const PoolObjectCount &pool : pools)
+    tooltip += lit("\n%1: %2").arg(pool.name).arg(qulonglong(pool.count));
+
+  ui->overhead->setToolTip(tooltip);
+}
+
 QString LiveCapture::MakeText(Capture *cap)
 {
   QString text = cap->name;
@@ -1188,6 +1213,8 @@ void LiveCapture::connectionThreadEntry()
     ui->connectionStatus->setText(tr("Established"));
   });
 
+  m_Connection->EnableOverheadStats(true);
+
   while(m_Connection && m_Connection->Connected())
   {
     if(m_TriggerCapture.tryAcquire())
@@ -1319,6 +1346,12 @@ void LiveCapture::connectionThreadEntry()
       uint32_t windows = msg.capturableWindowCount;
       GUIInvoke::call(this, [this, windows]() { ui->cycleActiveWindow->setEnabled(windows > 1); });
     }
+
+    if(msg.type == TargetControlMessageType::CaptureOverhead)
+    {
+      CaptureOverheadData overhead = msg.overhead;
+      GUIInvoke::call(this, [this, overhead]() { updateOverhead(overhead); });
+    }
   }
 
   if(m_Connection)
@@ -1342,6 +1375,9 @@ void LiveCapture::connectionThreadEntry()
     ui->apiStatus->setText(tr("None"));
     ui->apiIcon->setVisible(false);
 
+    ui->overhead->setText(tr("None"));
+    ui->overhead->setToolTip(QString());
+
     connectionClosed();
   });
 }
@@ -136,6 +136,7 @@ private:
   QImage MakeThumb(const QImage &screenshot);
 
   void updateAPIStatus();
+  void updateOverhead(const CaptureOverheadData &overhead);
 
   void connectionThreadEntry();
   void captureCopied(uint32_t ID, const QString &localPath);
@@ -29,6 +29,7 @@
 #include <QKeyEvent>
 #include <QLineEdit>
 #include <QMenu>
+#include <QSet>
 #include <QShortcut>
 #include <QTextEdit>
 #include <QTimer>
@@ -256,6 +257,12 @@ void EventBrowser::OnCaptureLoaded()
 
   ui->events->addTopLevelItem(frame);
 
+  m_ForwardIndex.clear();
+  m_BackwardIndex.clear();
+  m_FindResults.clear();
+  BuildEventIndex(frame, true);
+  BuildEventIndex(frame, false);
+
   ui->events->expandItem(frame);
 
   clearBookmarks();
@@ -278,6 +285,10 @@ void EventBrowser::OnCaptureClosed()
 
   ui->events->clear();
 
+  m_ForwardIndex.clear();
+  m_BackwardIndex.clear();
+  m_FindResults.clear();
+
   ui->find->setEnabled(false);
   ui->gotoEID->setEnabled(false);
   ui->timeDraws->setEnabled(false);
@@ -504,7 +515,13 @@ void EventBrowser::on_timeDraws_clicked()
 
   m_Ctx.Replay().AsyncInvoke([this](IReplayController *r) {
 
-    m_Times = r->FetchCounters({GPUCounter::EventGPUDuration});
+    // replay a few times and show the median, a single replay is easily skewed by clock ramping
+    rdcarray<EventTiming> timings = r->FetchEventTimings(5);
+
+    m_Times.clear();
+    m_Times.reserve(timings.size());
+    for(const EventTiming &t : timings)
+      m_Times.push_back(CounterResult(t.eventId, GPUCounter::EventGPUDuration, t.median));
 
     GUIInvoke::call(this, [this]() {
       if(ui->events->topLevelItemCount() == 0)
@@ -1075,8 +1092,7 @@ void EventBrowser::repopulateBookmarks()
 
       highlightBookmarks();
 
-      RDTreeWidgetItem *found = NULL;
-      FindEventNode(found, ui->events->topLevelItem(0), EID);
+      RDTreeWidgetItem *found = FindEventNode(EID);
 
       if(found)
       {
@@ -1100,8 +1116,7 @@ void EventBrowser::repopulateBookmarks()
       delete m_BookmarkButtons[EID];
       m_BookmarkButtons.remove(EID);
 
-      RDTreeWidgetItem *found = NULL;
-      FindEventNode(found, ui->events->topLevelItem(0), EID);
+      RDTreeWidgetItem *found = FindEventNode(EID);
 
       if(found)
       {
@@ -1172,32 +1187,49 @@ void EventBrowser::RefreshIcon(RDTreeWidgetItem *item, EventItemTag tag)
     item->setIcon(COL_NAME, QIcon());
 }
 
-bool EventBrowser::FindEventNode(RDTreeWidgetItem *&found, RDTreeWidgetItem *parent, uint32_t eventId)
+void EventBrowser::BuildEventIndex(RDTreeWidgetItem *parent, bool forward)
 {
-  // do a reverse search to find the last match (in case of 'set' markers that
-  // inherit the event of the next real draw).
-  for(int i = parent->childCount() - 1; i >= 0; i--)
+  // backwards the siblings are visited in reverse, but each parent still comes before its children
+  // so this matches the order the tree was previously searched in.
+  for(int c = 0; c < parent->childCount(); c++)
   {
-    RDTreeWidgetItem *n = parent->child(i);
+    RDTreeWidgetItem *n = parent->child(forward ? c : parent->childCount() - 1 - c);
 
-    uint nEID = n->tag().value<EventItemTag>().lastEID;
-    uint fEID = found ? found->tag().value<EventItemTag>().lastEID : 0;
+    EventIndexEntry entry;
+    entry.item = n;
+    entry.lastEID = n->tag().value<EventItemTag>().lastEID;
+    entry.leaf = n->childCount() == 0;
 
-    if(nEID >= eventId && (found == NULL || nEID <= fEID))
-      found = n;
-
-    if(nEID == eventId && n->childCount() == 0)
-      return true;
+    if(forward)
+      m_ForwardIndex.push_back(entry);
+    else
+      m_BackwardIndex.push_back(entry);
 
     if(n->childCount() > 0)
+      BuildEventIndex(n, forward);
+  }
+}
+
+RDTreeWidgetItem *EventBrowser::FindEventNode(uint32_t eventId)
+{
+  RDTreeWidgetItem *found = NULL;
+  uint32_t foundEID = 0;
+
+  // do a reverse search to find the last match (in case of 'set' markers that
+  // inherit the event of the next real draw).
+  for(const EventIndexEntry &n : m_BackwardIndex)
+  {
+    if(n.lastEID >= eventId && (found == NULL || n.lastEID <= foundEID))
     {
-      bool exact = FindEventNode(found, n, eventId);
-      if(exact)
-        return true;
+      found = n.item;
+      foundEID = n.lastEID;
     }
+
+    if(n.lastEID == eventId && n.leaf)
+      break;
   }
 
-  return false;
+  return found;
 }
 
 void EventBrowser::ExpandNode(RDTreeWidgetItem *node)
@@ -1218,8 +1250,7 @@ bool EventBrowser::SelectEvent(uint32_t eventId)
   if(!m_Ctx.IsCaptureLoaded())
     return false;
 
-  RDTreeWidgetItem *found = NULL;
-  FindEventNode(found, ui->events->topLevelItem(0), eventId);
+  RDTreeWidgetItem *found = FindEventNode(eventId);
   if(found != NULL)
   {
     ui->events->setCurrentItem(found);
@@ -1232,124 +1263,94 @@ bool EventBrowser::SelectEvent(uint32_t eventId)
   return false;
 }
 
-void EventBrowser::ClearFindIcons(RDTreeWidgetItem *parent)
+void EventBrowser::ClearFindIcons()
 {
-  for(int i = 0; i < parent->childCount(); i++)
+  for(RDTreeWidgetItem *n : m_FindResults)
   {
-    RDTreeWidgetItem *n = parent->child(i);
-
     EventItemTag tag = n->tag().value<EventItemTag>();
     tag.find = false;
     n->setTag(QVariant::fromValue(tag));
     RefreshIcon(n, tag);
-
-    if(n->childCount() > 0)
-      ClearFindIcons(n);
   }
-}
 
-void EventBrowser::ClearFindIcons()
-{
-  if(m_Ctx.IsCaptureLoaded() && ui->events->topLevelItemCount() > 0)
-    ClearFindIcons(ui->events->topLevelItem(0));
+  m_FindResults.clear();
 }
 
-int EventBrowser::SetFindIcons(RDTreeWidgetItem *parent, QString filter)
+int EventBrowser::SetFindIcons(QString filter)
 {
+  if(filter.isEmpty() || !m_Ctx.IsCaptureLoaded())
+    return 0;
+
   int results = 0;
 
-  for(int i = 0; i < parent->childCount(); i++)
-  {
-    RDTreeWidgetItem *n = parent->child(i);
+  QSet<uint32_t> chunks = FindChunks(filter);
 
-    if(n->text(COL_NAME).contains(filter, Qt::CaseInsensitive))
+  for(const EventIndexEntry &n : m_ForwardIndex)
+  {
+    if(MatchesFind(n, filter, chunks))
     {
-      EventItemTag tag = n->tag().value<EventItemTag>();
+      EventItemTag tag = n.item->tag().value<EventItemTag>();
       tag.find = true;
-      n->setTag(QVariant::fromValue(tag));
-      RefreshIcon(n, tag);
+      n.item->setTag(QVariant::fromValue(tag));
+      RefreshIcon(n.item, tag);
+      m_FindResults.push_back(n.item);
       results++;
     }
-
-    if(n->childCount() > 0)
-    {
-      results += SetFindIcons(n, filter);
-    }
   }
 
   return results;
 }
 
-int EventBrowser::SetFindIcons(QString filter)
+int EventBrowser::FindEvent(QString filter, uint32_t after, bool forward)
 {
-  if(filter.isEmpty() || !m_Ctx.IsCaptureLoaded())
+  if(!m_Ctx.IsCaptureLoaded())
     return 0;
 
-  return SetFindIcons(ui->events->topLevelItem(0), filter);
-}
-
-RDTreeWidgetItem *EventBrowser::FindNode(RDTreeWidgetItem *parent, QString filter, uint32_t after)
-{
-  for(int i = 0; i < parent->childCount(); i++)
-  {
-    RDTreeWidgetItem *n = parent->child(i);
-
-    uint eid = n->tag().value<EventItemTag>().lastEID;
+  const QVector<EventIndexEntry> &index = forward ? m_ForwardIndex : m_BackwardIndex;
 
-    if(eid > after && n->text(COL_NAME).contains(filter, Qt::CaseInsensitive))
-      return n;
+  QSet<uint32_t> chunks = FindChunks(filter);
 
-    if(n->childCount() > 0)
-    {
-      RDTreeWidgetItem *found = FindNode(n, filter, after);
+  for(const EventIndexEntry &n : index)
+  {
+    bool matchesAfter = (forward && n.lastEID > after) || (!forward && n.lastEID < after);
 
-      if(found != NULL)
-        return found;
-    }
+    if(matchesAfter && MatchesFind(n, filter, chunks))
+      return (int)n.lastEID;
   }
 
-  return NULL;
+  return -1;
 }
 
-int EventBrowser::FindEvent(RDTreeWidgetItem *parent, QString filter, uint32_t after, bool forward)
+QSet<uint32_t> EventBrowser::FindChunks(const QString &filter)
 {
-  if(parent == NULL)
-    return -1;
+  QSet<uint32_t> ret;
 
-  for(int i = forward ? 0 : parent->childCount() - 1; i >= 0 && i < parent->childCount();
-      i += forward ? 1 : -1)
-  {
-    auto n = parent->child(i);
+  for(uint32_t chunk : m_Ctx.FindStructuredChunks({rdcstr(filter)}))
+    ret.insert(chunk);
 
-    uint eid = n->tag().value<EventItemTag>().lastEID;
+  return ret;
+}
 
-    bool matchesAfter = (forward && eid > after) || (!forward && eid < after);
+bool EventBrowser::MatchesFind(const EventIndexEntry &n, const QString &filter,
+                               const QSet<uint32_t> &chunks)
+{
+  if(n.item->text(COL_NAME).contains(filter, Qt::CaseInsensitive))
+    return true;
 
-    if(matchesAfter)
-    {
-      QString name = n->text(COL_NAME);
-      if(name.contains(filter, Qt::CaseInsensitive))
-        return (int)eid;
-    }
+  // also match draws where one of the API calls has the filter as a parameter name or value
+  if(!n.leaf || chunks.isEmpty())
+    return false;
 
-    if(n->childCount() > 0)
-    {
-      int found = FindEvent(n, filter, after, forward);
+  const DrawcallDescription *draw = m_Ctx.GetDrawcall(n.lastEID);
 
-      if(found > 0)
-        return found;
-    }
+  if(draw)
+  {
+    for(const APIEvent &ev : draw->events)
+      if(chunks.contains(ev.chunkIndex))
+        return true;
   }
 
-  return -1;
-}
-
-int EventBrowser::FindEvent(QString filter, uint32_t after, bool forward)
-{
-  if(!m_Ctx.IsCaptureLoaded())
-    return 0;
-
-  return FindEvent(ui->events->topLevelItem(0), filter, after, forward);
+  return false;
 }
 
 void EventBrowser::Find(bool forward)
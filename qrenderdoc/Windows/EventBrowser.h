@@ -26,6 +26,8 @@
 
 #include <QFrame>
 #include <QIcon>
+#include <QSet>
+#include <QVector>
 #include "Code/Interface/QRDInterface.h"
 
 namespace Ui
@@ -102,22 +104,19 @@ private:
 
   void ExpandNode(RDTreeWidgetItem *node);
 
-  bool FindEventNode(RDTreeWidgetItem *&found, RDTreeWidgetItem *parent, uint32_t eventId);
+  void BuildEventIndex(RDTreeWidgetItem *parent, bool forward);
+  RDTreeWidgetItem *FindEventNode(uint32_t eventId);
   bool SelectEvent(uint32_t eventId);
 
-  void ClearFindIcons(RDTreeWidgetItem *parent);
   void ClearFindIcons();
-
-  int SetFindIcons(RDTreeWidgetItem *parent, QString filter);
   int SetFindIcons(QString filter);
 
   void repopulateBookmarks();
   void highlightBookmarks();
   bool hasBookmark(RDTreeWidgetItem *node);
 
-  RDTreeWidgetItem *FindNode(RDTreeWidgetItem *parent, QString filter, uint32_t after);
-  int FindEvent(RDTreeWidgetItem *parent, QString filter, uint32_t after, bool forward);
   int FindEvent(QString filter, uint32_t after, bool forward);
+  QSet<uint32_t> FindChunks(const QString &filter);
   void Find(bool forward);
 
   QString GetExportDrawcallString(int indent, bool firstchild, const DrawcallDescription &drawcall);
@@ -135,6 +134,22 @@ private:
 
   QTimer *m_FindHighlight;
 
+  // the event tree flattened in the order it's walked when searching forwards or backwards, so
+  // that finding and selecting events doesn't need to recurse over every item each time.
+  struct EventIndexEntry
+  {
+    RDTreeWidgetItem *item;
+    uint32_t lastEID;
+    bool leaf;
+  };
+  QVector<EventIndexEntry> m_ForwardIndex;
+  QVector<EventIndexEntry> m_BackwardIndex;
+
+  // the items that currently have a find icon, so they can be cleared without a full walk
+  QVector<RDTreeWidgetItem *> m_FindResults;
+
+  bool MatchesFind(const EventIndexEntry &n, const QString &filter, const QSet<uint32_t> &chunks);
+
   FlowLayout *m_BookmarkStripLayout;
   QSpacerItem *m_BookmarkSpacer;
   QMap<uint32_t, QToolButton *> m_BookmarkButtons;
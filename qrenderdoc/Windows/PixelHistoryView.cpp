@@ -85,8 +85,26 @@ public:
     emit endResetModel();
   }
 
+  void addHistory(const rdcarray<PixelModification> &history)
+  {
+    for(const PixelModification &h : history)
+      m_ModList.push_back(h);
+
+    // batches can arrive in any order, but each batch is in event order and covers whole events
+    std::stable_sort(m_ModList.begin(), m_ModList.end(),
+                     [](const PixelModification &a, const PixelModification &b) {
+                       return a.eventId < b.eventId;
+                     });
+
+    m_Loading = false;
+
+    setShowFailures(m_ShowFailures);
+  }
+
   void setShowFailures(bool show)
   {
+    m_ShowFailures = show;
+
     emit beginResetModel();
 
     m_History.clear();
@@ -418,6 +436,7 @@ private:
   bool m_IsDepth = false, m_IsUint = false, m_IsSint = false, m_IsFloat = true;
 
   bool m_Loading = true;
+  bool m_ShowFailures = true;
   QVector<QList<PixelModification>> m_History;
   QVector<PixelModification> m_ModList;
 
@@ -654,6 +673,9 @@ void PixelHistoryView::updateWindowTitle()
   if(tex->msSamp > 1)
     title += tr(" @ Sample %1").arg(m_Display.subresource.sample);
 
+  if(m_Progress < 1.0f)
+    title += tr(" - %1% loaded").arg(int(m_Progress * 100.0f));
+
   setWindowTitle(title);
 }
 
@@ -709,6 +731,16 @@ void PixelHistoryView::SetHistory(const rdcarray<PixelModification> &history)
   enableTimelineHighlight();
 }
 
+void PixelHistoryView::AddHistory(const rdcarray<PixelModification> &history, float progress)
+{
+  m_Model->addHistory(history);
+
+  m_Progress = progress;
+  updateWindowTitle();
+
+  enableTimelineHighlight();
+}
+
 void PixelHistoryView::startDebug(EventTag tag)
 {
   m_Ctx.SetEventID({this}, tag.eventId, tag.eventId);
@@ -47,6 +47,7 @@ public:
   // IPixelHistoryView
   QWidget *Widget() override { return this; }
   void SetHistory(const rdcarray<PixelModification> &history) override;
+  void AddHistory(const rdcarray<PixelModification> &history, float progress) override;
 
   // ICaptureViewer
   void OnCaptureLoaded() override;
@@ -76,6 +77,8 @@ private:
   QPoint m_Pixel;
   PixelHistoryItemModel *m_Model;
   bool m_ShowFailures = true;
+  // fraction of the history received so far, when it's being streamed in with AddHistory
+  float m_Progress = 1.0f;
   void startDebug(EventTag tag);
   void jumpToPrimitive(EventTag tag);
 };
@@ -115,6 +115,14 @@ struct CaptureContextInvoker : ICaptureContext
   }
   virtual IRGPInterop *GetRGPInterop() override { return m_Ctx.GetRGPInterop(); }
   virtual const SDFile &GetStructuredFile() override { return m_Ctx.GetStructuredFile(); }
+  virtual rdcarray<uint32_t> FindStructuredChunks(const rdcarray<rdcstr> &terms) override
+  {
+    return m_Ctx.FindStructuredChunks(terms);
+  }
+  virtual float GetStructuredSearchProgress() override
+  {
+    return m_Ctx.GetStructuredSearchProgress();
+  }
   virtual WindowingSystem CurWindowingSystem() override { return m_Ctx.CurWindowingSystem(); }
   virtual const rdcarray<DebugMessage> &DebugMessages() override { return m_Ctx.DebugMessages(); }
   virtual int UnreadMessageCount() override { return m_Ctx.UnreadMessageCount(); }
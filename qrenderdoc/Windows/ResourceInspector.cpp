@@ -45,6 +45,24 @@ public:
   void reset()
   {
     emit beginResetModel();
+
+    // the filter proxy queries every row's name when filtering or sorting, so build the names once
+    // here instead of looking each resource up again for every query. Callers reset the model
+    // whenever the names change.
+    const rdcarray<ResourceDescription> &resources = m_Ctx.GetResources();
+
+    m_Names.clear();
+    m_FilterStrings.clear();
+    m_Names.reserve(resources.count());
+    m_FilterStrings.reserve(resources.count());
+
+    for(const ResourceDescription &desc : resources)
+    {
+      QString name = m_Ctx.GetResourceName(desc.resourceId);
+      m_Names.push_back(name);
+      m_FilterStrings.push_back(ToQStr(desc.type) + lit(" ") + name);
+    }
+
     emit endResetModel();
   }
 
@@ -57,10 +75,7 @@ public:
   }
 
   QModelIndex parent(const QModelIndex &index) const override { return QModelIndex(); }
-  int rowCount(const QModelIndex &parent = QModelIndex()) const override
-  {
-    return m_Ctx.GetResources().count();
-  }
+  int rowCount(const QModelIndex &parent = QModelIndex()) const override { return m_Names.count(); }
   int columnCount(const QModelIndex &parent = QModelIndex()) const override { return 1; }
   Qt::ItemFlags flags(const QModelIndex &index) const override
   {
@@ -76,18 +91,16 @@ public:
     {
       const rdcarray<ResourceDescription> &resources = m_Ctx.GetResources();
 
-      if(index.row() < resources.count())
+      if(index.row() < m_Names.count() && index.row() < resources.count())
       {
-        const ResourceDescription &desc = resources[index.row()];
-
         if(role == Qt::DisplayRole)
-          return m_Ctx.GetResourceName(desc.resourceId);
+          return m_Names[index.row()];
 
         if(role == ResourceIdRole)
-          return QVariant::fromValue(desc.resourceId);
+          return QVariant::fromValue(resources[index.row()].resourceId);
 
         if(role == FilterRole)
-          return ToQStr(desc.type) + lit(" ") + m_Ctx.GetResourceName(desc.resourceId);
+          return m_FilterStrings[index.row()];
       }
     }
 
@@ -96,6 +109,8 @@ public:
 
 private:
   ICaptureContext &m_Ctx;
+  QVector<QString> m_Names;
+  QVector<QString> m_FilterStrings;
 };
 
 ResourceInspector::ResourceInspector(ICaptureContext &ctx, QWidget *parent)
@@ -305,6 +320,10 @@ void ResourceInspector::Inspect(ResourceId id)
     }
     ui->relatedResources->endUpdate();
 
+    rdcarray<uint32_t> initChunks = desc->initialisationChunks;
+    m_Ctx.Replay().BlockInvoke(
+        [initChunks](IReplayController *r) { r->FetchStructuredChunks(initChunks); });
+
     for(uint32_t chunk : desc->initialisationChunks)
     {
       RDTreeWidgetItem *root = new RDTreeWidgetItem({QString(), QString()});
@@ -815,6 +815,24 @@ void TextureViewer::RT_UpdateAndDisplay(IReplayController *r)
   GUIInvoke::call(this, [this]() { ui->render->update(); });
 }
 
+void TextureViewer::UI_QueueUpdateAndDisplay()
+{
+  // panning and zooming can queue many updates faster than the replay can render them, especially
+  // on a remote replay. Since the display state is only read when the update runs, replace any
+  // update still waiting in the queue rather than rendering every intermediate position.
+  m_Ctx.Replay().AsyncInvoke(lit("UpdateAndDisplay"),
+                             [this](IReplayController *r) { RT_UpdateAndDisplay(r); });
+}
+
+void TextureViewer::UI_QueueUpdateVisualRange()
+{
+  // dragging the range or changing channels can queue many histogram updates, each of which is a
+  // full pass over the texture. Only the most recent one is worth computing, so replace any that
+  // haven't started yet.
+  m_Ctx.Replay().AsyncInvoke(lit("UpdateVisualRange"),
+                             [this](IReplayController *r) { RT_UpdateVisualRange(r); });
+}
+
 void TextureViewer::RT_UpdateVisualRange(IReplayController *r)
 {
   TextureDescription *texptr = GetCurrentTexture();
@@ -1789,7 +1807,7 @@ void TextureViewer::UI_UpdateChannels()
   m_TexDisplay.flipY = ui->flip_y->isChecked();
 
   INVOKE_MEMFN(RT_UpdateAndDisplay);
-  INVOKE_MEMFN(RT_UpdateVisualRange);
+  UI_QueueUpdateVisualRange();
 }
 
 void TextureViewer::SetupTextureTabs()
@@ -2515,7 +2533,7 @@ void TextureViewer::render_resize(QResizeEvent *e)
   UI_UpdateFittedScale();
   UI_CalcScrollbars();
 
-  INVOKE_MEMFN(RT_UpdateAndDisplay);
+  UI_QueueUpdateAndDisplay();
 }
 
 void TextureViewer::render_keyPress(QKeyEvent *e)
@@ -2631,7 +2649,7 @@ void TextureViewer::setScrollPosition(const QPoint &pos)
     ScrollUpdateScrollbars = true;
   }
 
-  INVOKE_MEMFN(RT_UpdateAndDisplay);
+  UI_QueueUpdateAndDisplay();
 }
 
 void TextureViewer::UI_CalcScrollbars()
@@ -3124,7 +3142,7 @@ void TextureViewer::UI_SetScale(float s, int x, int y)
 
   m_TexDisplay.scale = qBound(0.1f, s, 256.0f);
 
-  INVOKE_MEMFN(RT_UpdateAndDisplay);
+  UI_QueueUpdateAndDisplay();
 
   float scaleDelta = (m_TexDisplay.scale / prevScale);
 
@@ -3311,7 +3329,7 @@ void TextureViewer::rangePoint_Update()
 
   ui->rangeHistogram->setRange(black, white);
 
-  INVOKE_MEMFN(RT_UpdateVisualRange);
+  UI_QueueUpdateVisualRange();
 }
 
 void TextureViewer::rangePoint_leave()
@@ -3347,7 +3365,7 @@ void TextureViewer::on_zoomRange_clicked()
 
   ui->rangeHistogram->setRange(black, white);
 
-  INVOKE_MEMFN(RT_UpdateVisualRange);
+  UI_QueueUpdateVisualRange();
 }
 
 void TextureViewer::on_autoFit_clicked()
@@ -3368,7 +3386,7 @@ void TextureViewer::on_reset01_clicked()
 
   ui->autoFit->setChecked(false);
 
-  INVOKE_MEMFN(RT_UpdateVisualRange);
+  UI_QueueUpdateVisualRange();
 }
 
 void TextureViewer::on_visualiseRange_clicked()
@@ -3378,7 +3396,7 @@ void TextureViewer::on_visualiseRange_clicked()
     ui->rangeHistogram->setMinimumSize(QSize(300, 90));
 
     m_Visualise = true;
-    INVOKE_MEMFN(RT_UpdateVisualRange);
+    UI_QueueUpdateVisualRange();
   }
   else
   {
@@ -3395,7 +3413,7 @@ void TextureViewer::AutoFitRange()
   if(!m_Ctx.IsCaptureLoaded() || GetCurrentTexture() == NULL || m_Output == NULL)
     return;
 
-  m_Ctx.Replay().AsyncInvoke([this](IReplayController *r) {
+  m_Ctx.Replay().AsyncInvoke(lit("AutoFitRange"), [this](IReplayController *r) {
 
     ResourceId textureId = m_TexDisplay.resourceId;
     Subresource sub = m_TexDisplay.subresource;
@@ -3471,7 +3489,7 @@ void TextureViewer::AutoFitRange()
       {
         GUIInvoke::call(this, [this, minval, maxval]() {
           ui->rangeHistogram->setRange(minval, maxval);
-          INVOKE_MEMFN(RT_UpdateVisualRange);
+          UI_QueueUpdateVisualRange();
         });
       }
     }
@@ -3565,7 +3583,7 @@ void TextureViewer::on_mipLevel_currentIndexChanged(int index)
     return;
   }
 
-  INVOKE_MEMFN(RT_UpdateVisualRange);
+  UI_QueueUpdateVisualRange();
 
   if(m_Output != NULL && m_PickedPoint.x() >= 0 && m_PickedPoint.y() >= 0)
   {
@@ -3584,7 +3602,7 @@ void TextureViewer::on_sliceFace_currentIndexChanged(int index)
   TextureDescription &tex = *texptr;
   m_TexDisplay.subresource.slice = (uint32_t)qMax(0, index);
 
-  INVOKE_MEMFN(RT_UpdateVisualRange);
+  UI_QueueUpdateVisualRange();
 
   if(m_Output != NULL && m_PickedPoint.x() >= 0 && m_PickedPoint.y() >= 0)
   {
@@ -3822,17 +3840,28 @@ void TextureViewer::on_pixelHistory_clicked()
 
   // add a short delay so that controls repainting after a new panel appears can get at the
   // render thread before we insert the long blocking pixel history task
-  LambdaThread *thread = new LambdaThread([this, texptr, x, y, hist, histWidget]() {
+  // set from the UI thread once the history viewer has been closed, so the replay can stop early
+  QSharedPointer<QAtomicInt> cancelled(new QAtomicInt(0));
+
+  LambdaThread *thread = new LambdaThread([this, texptr, x, y, hist, histWidget, cancelled]() {
     QThread::msleep(150);
-    m_Ctx.Replay().AsyncInvoke([this, texptr, x, y, hist, histWidget](IReplayController *r) {
-      rdcarray<PixelModification> history =
-          r->PixelHistory(texptr->resourceId, (uint32_t)x, (int32_t)y, m_TexDisplay.subresource,
-                          m_TexDisplay.typeCast);
-
-      GUIInvoke::call(this, [hist, histWidget, history] {
-        if(histWidget)
-          hist->SetHistory(history);
-      });
+    m_Ctx.Replay().AsyncInvoke([this, texptr, x, y, hist, histWidget,
+                                cancelled](IReplayController *r) {
+      // stream the most recent events first, those are usually the most interesting
+      r->StreamPixelHistory(
+          texptr->resourceId, (uint32_t)x, (int32_t)y, m_TexDisplay.subresource,
+          m_TexDisplay.typeCast, 32, true,
+          [this, hist, histWidget, cancelled](const rdcarray<PixelModification> &history,
+                                              float progress) {
+            GUIInvoke::call(this, [hist, histWidget, cancelled, history, progress] {
+              if(histWidget)
+                hist->AddHistory(history, progress);
+              else
+                cancelled->storeRelease(1);
+            });
+
+            return cancelled->loadAcquire() == 0;
+          });
     });
   });
   thread->selfDelete(true);
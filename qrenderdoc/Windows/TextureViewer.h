@@ -221,7 +221,9 @@ private:
   void RT_PickPixelsAndUpdate(IReplayController *);
   void RT_PickHoverAndUpdate(IReplayController *);
   void RT_UpdateAndDisplay(IReplayController *);
+  void UI_QueueUpdateAndDisplay();
   void RT_UpdateVisualRange(IReplayController *);
+  void UI_QueueUpdateVisualRange();
 
   void UI_RecreatePanels();
 
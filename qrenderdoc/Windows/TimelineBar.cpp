@@ -27,6 +27,7 @@
 #include <QPainter>
 #include <QScrollBar>
 #include <QWheelEvent>
+#include <QtMath>
 #include "Code/QRDUtils.h"
 #include "Code/Resources.h"
 
@@ -361,12 +362,8 @@ void TimelineBar::mousePressEvent(QMouseEvent *e)
     if(!m_Draws.isEmpty() && m_dataArea.contains(m_lastPos))
     {
       uint32_t eid = eventAt(x);
-      auto it = std::find_if(m_Draws.begin(), m_Draws.end(), [eid](uint32_t d) {
-        if(d >= eid)
-          return true;
-
-        return false;
-      });
+      // m_Draws is in ascending order, so find the first draw at or after eid
+      auto it = std::lower_bound(m_Draws.begin(), m_Draws.end(), eid);
 
       if(it == m_Draws.end())
         m_Ctx.SetEventID({}, m_Draws.back(), m_Draws.back());
@@ -399,12 +396,8 @@ void TimelineBar::mouseMoveEvent(QMouseEvent *e)
             !m_highlightingRect.contains(e->localPos()))
     {
       uint32_t eid = eventAt(x);
-      auto it = std::find_if(m_Draws.begin(), m_Draws.end(), [eid](uint32_t d) {
-        if(d >= eid)
-          return true;
-
-        return false;
-      });
+      // m_Draws is in ascending order, so find the first draw at or after eid
+      auto it = std::lower_bound(m_Draws.begin(), m_Draws.end(), eid);
 
       if(it != m_Draws.end())
         m_Ctx.SetEventID({}, *it, *it);
@@ -781,12 +774,20 @@ void TimelineBar::paintEvent(QPaintEvent *e)
 
     if(!m_HistoryEvents.isEmpty())
     {
-      for(const PixelModification &mod : m_HistoryEvents)
+      // the events are sorted, so skip straight to the first visible one and stop after the last
+      auto it = std::lower_bound(m_HistoryEvents.begin(), m_HistoryEvents.end(), leftClip,
+                                 [this, triRadius](const PixelModification &mod, qreal clip) {
+                                   return offsetOf(mod.eventId) + m_eidWidth / 2 - triRadius < clip;
+                                 });
+
+      for(; it != m_HistoryEvents.end(); ++it)
       {
+        const PixelModification &mod = *it;
+
         qreal pos = offsetOf(mod.eventId) + m_eidWidth / 2 - triRadius;
 
-        if(pos < leftClip || pos > rightClip)
-          continue;
+        if(pos > rightClip)
+          break;
 
         if(mod.Passed())
           pipranges[HistoryPassed].push(pos, triRadius);
@@ -796,12 +797,19 @@ void TimelineBar::paintEvent(QPaintEvent *e)
     }
     else
     {
-      for(const EventUsage &use : m_UsageEvents)
+      auto it = std::lower_bound(m_UsageEvents.begin(), m_UsageEvents.end(), leftClip,
+                                 [this, triRadius](const EventUsage &use, qreal clip) {
+                                   return offsetOf(use.eventId) + m_eidWidth / 2 - triRadius < clip;
+                                 });
+
+      for(; it != m_UsageEvents.end(); ++it)
       {
+        const EventUsage &use = *it;
+
         qreal pos = offsetOf(use.eventId) + m_eidWidth / 2 - triRadius;
 
-        if(pos < leftClip || pos > rightClip)
-          continue;
+        if(pos > rightClip)
+          break;
 
         if(((int)use.usage >= (int)ResourceUsage::VS_RWResource &&
             (int)use.usage <= (int)ResourceUsage::All_RWResource) ||
@@ -857,8 +865,17 @@ TimelineBar::Marker *TimelineBar::findMarker(QVector<Marker> &markers, QRectF ma
 {
   QFontMetrics fm(Formatter::PreferredFont());
 
-  for(Marker &m : markers)
+  auto it = std::lower_bound(
+      markers.begin(), markers.end(), pos.x(),
+      [this](const Marker &m, qreal x) { return offsetOf(m.eidEnd + 1) < x; });
+
+  for(; it != markers.end(); ++it)
   {
+    Marker &m = *it;
+
+    if(offsetOf(m.eidStart) > pos.x())
+      break;
+
     QRectF r = markerRect;
     r.setLeft(qMax(m_markerRect.left() + borderWidth * 2, offsetOf(m.eidStart)));
     r.setRight(qMin(m_markerRect.right() - borderWidth, offsetOf(m.eidEnd + 1)));
@@ -904,8 +921,19 @@ void TimelineBar::paintMarkers(QPainter &p, const QVector<Marker> &markers,
   // store a reference of what a completely elided string looks like
   QString tooshort = fm.elidedText(lit("asd"), Qt::ElideRight, fm.height());
 
-  for(const Marker &m : markers)
+  // markers and draws are both in ascending EID order, so only the visible range is walked
+  auto markerIt = std::lower_bound(markers.begin(), markers.end(), m_dataArea.left(),
+                                   [this](const Marker &m, qreal x) {
+                                     return offsetOf(m.eidEnd + 1) < x;
+                                   });
+
+  for(; markerIt != markers.end(); ++markerIt)
   {
+    const Marker &m = *markerIt;
+
+    if(offsetOf(m.eidStart) > m_dataArea.right())
+      break;
+
     QRectF r = markerRect;
     r.setLeft(qMax(m_dataArea.left() + borderWidth * 3, offsetOf(m.eidStart)));
     r.setRight(qMin(m_dataArea.right() - borderWidth, offsetOf(m.eidEnd + 1)));
@@ -962,18 +990,36 @@ void TimelineBar::paintMarkers(QPainter &p, const QVector<Marker> &markers,
 
   p.setRenderHint(QPainter::Antialiasing);
 
-  for(uint32_t d : draws)
+  auto drawIt = std::lower_bound(draws.begin(), draws.end(), m_dataArea.left(),
+                                 [this](uint32_t d, qreal x) { return offsetOf(d + 1) < x; });
+
+  // when zoomed out many draws land on the same pixel, and only the first one there (or the
+  // current event) is visible, so don't paint the rest
+  int lastPixel = -1;
+  uint32_t curEvent = m_Ctx.CurEvent();
+
+  for(; drawIt != draws.end(); ++drawIt)
   {
+    uint32_t d = *drawIt;
+
+    if(offsetOf(d) > m_dataArea.right())
+      break;
+
     QRectF r = markerRect;
     r.setLeft(qMax(m_dataArea.left() + borderWidth * 3, offsetOf(d)));
     r.setRight(qMin(m_dataArea.right() - borderWidth, offsetOf(d + 1)));
     r.setHeight(fm.height() + borderWidth * 2);
 
+    int pixel = qFloor(r.left());
+    if(pixel == lastPixel && d != curEvent)
+      continue;
+    lastPixel = pixel;
+
     QPainterPath path;
     path.addRoundedRect(r, 5, 5);
 
     p.setPen(QPen(palette().brush(QPalette::Text), 1.0));
-    p.fillPath(path, d == m_Ctx.CurEvent() ? Qt::green : Qt::blue);
+    p.fillPath(path, d == curEvent ? Qt::green : Qt::blue);
     p.drawPath(path);
   }
 
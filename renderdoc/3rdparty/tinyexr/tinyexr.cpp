@@ -4,4 +4,5 @@
 #include "3rdparty/miniz/miniz.h"
 
 #define TINYEXR_IMPLEMENTATION
+#define TINYEXR_USE_THREAD 1
 #include "tinyexr.h"
@@ -105,6 +105,11 @@ extern "C" {
 // http://computation.llnl.gov/projects/floating-point-compression
 #endif
 
+// Use std::thread to encode scanline blocks in parallel when saving. Requires C++11.
+#ifndef TINYEXR_USE_THREAD
+#define TINYEXR_USE_THREAD (0)
+#endif
+
 #define TINYEXR_SUCCESS (0)
 #define TINYEXR_ERROR_INVALID_MAGIC_NUMBER (-1)
 #define TINYEXR_ERROR_INVALID_EXR_VERSION (-2)
@@ -440,6 +445,11 @@ extern int LoadEXRFromMemory(float **out_rgba, int *width, int *height,
 #include <cstdint>
 #endif  // __cplusplus > 199711L
 
+#if TINYEXR_USE_THREAD
+#include <atomic>
+#include <thread>
+#endif
+
 #ifdef _OPENMP
 #include <omp.h>
 #endif
@@ -11413,12 +11423,28 @@ size_t SaveEXRImageToMemory(const EXRImage *exr_image,
   }
 #endif
 
+#if TINYEXR_USE_THREAD
+  // each block is encoded independently into data_list, so workers only need
+  // to share the index of the next block to encode
+  std::atomic<int> next_block(0);
+  std::vector<std::thread> workers;
+
+  int num_threads =
+      (std::max)(1, static_cast<int>(std::thread::hardware_concurrency()));
+  num_threads = (std::min)(num_threads, num_blocks);
+
+  for (int t = 0; t < num_threads; t++) {
+    workers.emplace_back([&]() {
+  int i = 0;
+  while ((i = next_block++) < num_blocks) {
+#else
 // Use signed int since some OpenMP compiler doesn't allow unsigned type for
 // `parallel for`
 #ifdef _OPENMP
 #pragma omp parallel for
 #endif
   for (int i = 0; i < num_blocks; i++) {
+#endif
     size_t ii = static_cast<size_t>(i);
     int start_y = num_scanlines * i;
     int endY = (std::min)(num_scanlines * (i + 1), exr_image->height);
@@ -11664,6 +11690,14 @@ size_t SaveEXRImageToMemory(const EXRImage *exr_image,
       assert(0);
     }
   }  // omp parallel
+#if TINYEXR_USE_THREAD
+    });
+  }
+
+  for (size_t t = 0; t < workers.size(); t++) {
+    workers[t].join();
+  }
+#endif
 
   for (size_t i = 0; i < static_cast<size_t>(num_blocks); i++) {
     data.insert(data.end(), data_list[i].begin(), data_list[i].end());
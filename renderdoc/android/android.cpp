@@ -967,6 +967,52 @@ struct AndroidController : public IDeviceProtocolHandler
     return new AndroidRemoteServer(sock, deviceID, portbase);
   }
 
+  bool CanPullFiles(const rdcstr &deviceID) override { return true; }
+  bool PullFile(const rdcstr &deviceID, const rdcstr &remotePath, const rdcstr &localPath,
+                uint64_t totalSize, RENDERDOC_ProgressCallback progress) override
+  {
+    FileIO::CreateParentDirectory(localPath);
+    FileIO::Delete(localPath.c_str());
+
+    // adb pull goes straight over the adb connection which is much faster than a forwarded port.
+    // It doesn't report progress so run it on a thread and watch the file grow.
+    volatile int32_t finished = 0;
+    Process::ProcessResult result = {};
+
+    Threading::ThreadHandle thread = Threading::CreateThread([&]() {
+      result = Android::adbExecCommand(deviceID, StringFormat::Fmt("pull \"%s\" \"%s\"",
+                                                                   remotePath.c_str(),
+                                                                   localPath.c_str()));
+      Atomic::Inc32(&finished);
+    });
+
+    while(Atomic::CmpExch32(&finished, 0, 0) == 0)
+    {
+      if(progress && totalSize > 0)
+        progress(RDCMIN(1.0f, float(FileIO::GetFileSize(localPath)) / float(totalSize)));
+
+      Threading::Sleep(50);
+    }
+
+    Threading::JoinThread(thread);
+    Threading::CloseThread(thread);
+
+    uint64_t pulledSize = FileIO::GetFileSize(localPath);
+
+    if(result.retCode != 0 || pulledSize != totalSize)
+    {
+      RDCWARN("adb pull of '%s' failed (%llu of %llu bytes): %s", remotePath.c_str(), pulledSize,
+              totalSize, result.strStderror.c_str());
+      FileIO::Delete(localPath.c_str());
+      return false;
+    }
+
+    if(progress)
+      progress(1.0f);
+
+    return true;
+  }
+
   int32_t running = 0;
   struct Device
   {
@@ -213,6 +213,110 @@ typedef enum RENDERDOC_CaptureOption {
   // necessary as directed by a RenderDoc developer.
   eRENDERDOC_Option_AllowUnsupportedVendorExtensions = 12,
 
+  // Restrict captures to the submissions made to one queue. Submissions to
+  // other queues are not recorded, and the resources they use are not included.
+  // The capture only begins at the first submission in scope, so initial
+  // contents are taken from that point.
+  //
+  // On Vulkan this is the queue family index. Other APIs ignore this option.
+  //
+  // Default - 0xFFFFFFFF
+  //
+  // 0xFFFFFFFF - Submissions to all queues are captured
+  // N - Only submissions to queue family N are captured
+  eRENDERDOC_Option_CaptureQueueFamily = 13,
+
+  // The first submission to capture, counted from when the capture is started.
+  // Only submissions to the queue selected by eRENDERDOC_Option_CaptureQueueFamily
+  // are counted. Other APIs than Vulkan ignore this option.
+  //
+  // Default - 0
+  eRENDERDOC_Option_CaptureFirstSubmit = 14,
+
+  // The number of submissions to capture, starting from the one selected by
+  // eRENDERDOC_Option_CaptureFirstSubmit. Other APIs than Vulkan ignore this option.
+  //
+  // Default - 0
+  //
+  // 0 - All submissions are captured until the capture ends
+  // N - Only N submissions are captured, later ones are not recorded
+  eRENDERDOC_Option_CaptureNumSubmits = 15,
+
+  // Record consecutive frames captured together, e.g. by TriggerMultiFrameCapture,
+  // into a single capture with one set of initial contents.
+  //
+  // Default - disabled
+  //
+  // 1 - Consecutive frames are merged into one capture
+  // 0 - Each frame is captured separately
+  eRENDERDOC_Option_MergeMultiFrameCaptures = 16,
+
+  // The memory in megabytes that a frame's recorded commands can use while it's being captured.
+  // Past this, further commands are compressed and spilled to a temporary file until the capture
+  // is written, for memory-constrained targets.
+  //
+  // Default - 0
+  //
+  // 0 - No limit, everything is kept in memory
+  // N - Spill commands to disk once they use more than N megabytes
+  eRENDERDOC_Option_CaptureMemoryBudgetMB = 17,
+
+  // Write-protect persistently mapped memory so that only the pages the application writes
+  // are saved, instead of comparing the whole mapping against a shadow copy. Other APIs than
+  // Vulkan and OpenGL ignore this option.
+  //
+  // Default - disabled
+  //
+  // 1 - Only the pages written through persistent mappings are saved
+  // 0 - Persistent mappings are compared against a shadow copy
+  eRENDERDOC_Option_WatchCoherentMapWrites = 18,
+
+  // Defer applying read-only descriptor updates while not capturing, until a capture starts.
+  // Other APIs than Vulkan ignore this option.
+  //
+  // Default - disabled
+  //
+  // 1 - Read-only descriptor updates are deferred while not capturing
+  // 0 - All descriptor updates are applied immediately
+  eRENDERDOC_Option_DeferDescriptorUpdates = 19,
+
+  // Store identical initial contents, such as zero-filled buffers, only once in a capture.
+  // Captures written with this enabled can't be opened by older versions.
+  //
+  // Default - disabled
+  //
+  // 1 - Identical initial contents are stored once and shared
+  // 0 - Each resource's initial contents are stored separately
+  eRENDERDOC_Option_DedupInitialContents = 20,
+
+  // Compact large images' initial contents on the GPU before reading them back, so that
+  // tiles of a single repeated value aren't copied. Other APIs than Vulkan ignore this option.
+  //
+  // Default - disabled
+  //
+  // 1 - Large images are compacted on the GPU before being read back
+  // 0 - Images are read back in full
+  eRENDERDOC_Option_CompactInitialStates = 21,
+
+  // Compress and write captures to disk on a background thread, so that the application
+  // continues as soon as the frame has been serialised.
+  //
+  // Default - disabled
+  //
+  // 1 - Captures are written to disk on a background thread
+  // 0 - Captures are written to disk before the application continues
+  eRENDERDOC_Option_AsyncCaptureWrite = 22,
+
+  // Defer recording the creation of samplers and views while not capturing, so that objects
+  // created and destroyed between captures aren't recorded. Other APIs than Vulkan ignore this
+  // option.
+  //
+  // Default - disabled
+  //
+  // 1 - Recording the creation of samplers and views is deferred while not capturing
+  // 0 - The creation of every object is recorded immediately
+  eRENDERDOC_Option_DeferCreationChunks = 23,
+
 } RENDERDOC_CaptureOption;
 
 // Sets an option that controls how RenderDoc behaves on capture.
@@ -548,6 +652,7 @@ typedef enum RENDERDOC_Version {
   eRENDERDOC_API_Version_1_3_0 = 10300,    // RENDERDOC_API_1_3_0 = 1 03 00
   eRENDERDOC_API_Version_1_4_0 = 10400,    // RENDERDOC_API_1_4_0 = 1 04 00
   eRENDERDOC_API_Version_1_4_1 = 10401,    // RENDERDOC_API_1_4_1 = 1 04 01
+  eRENDERDOC_API_Version_1_5_0 = 10500,    // RENDERDOC_API_1_5_0 = 1 05 00
 } RENDERDOC_Version;
 
 // API version changelog:
@@ -574,8 +679,27 @@ typedef enum RENDERDOC_Version {
 // 1.4.0 - Added feature: DiscardFrameCapture() to discard a frame capture in progress and stop
 //         capturing without saving anything to disk.
 // 1.4.1 - Refactor: Renamed Shutdown to RemoveHooks to better clarify what is happening
-
-typedef struct RENDERDOC_API_1_4_1
+// 1.5.0 - Added feature: New capture options eRENDERDOC_Option_CaptureQueueFamily,
+//         eRENDERDOC_Option_CaptureFirstSubmit and eRENDERDOC_Option_CaptureNumSubmits to capture
+//         only some of the submissions made while capturing.
+//         Added feature: New capture option eRENDERDOC_Option_MergeMultiFrameCaptures to record
+//         multi-frame captures into a single capture.
+//         Added feature: New capture option eRENDERDOC_Option_CaptureMemoryBudgetMB to spill a
+//         capture's commands to disk past a memory budget.
+//         Added feature: New capture option eRENDERDOC_Option_WatchCoherentMapWrites to only
+//         save the pages written through persistent mappings.
+//         Added feature: New capture option eRENDERDOC_Option_DeferDescriptorUpdates to defer
+//         descriptor updates while not capturing.
+//         Added feature: New capture option eRENDERDOC_Option_DedupInitialContents to store
+//         identical initial contents only once.
+//         Added feature: New capture option eRENDERDOC_Option_CompactInitialStates to compact
+//         images' initial contents on the GPU before reading them back.
+//         Added feature: New capture option eRENDERDOC_Option_AsyncCaptureWrite to write
+//         captures to disk on a background thread.
+//         Added feature: New capture option eRENDERDOC_Option_DeferCreationChunks to defer
+//         recording the creation of samplers and views while not capturing.
+
+typedef struct RENDERDOC_API_1_5_0
 {
   pRENDERDOC_GetAPIVersion GetAPIVersion;
 
@@ -647,17 +771,18 @@ typedef struct RENDERDOC_API_1_4_1
 
   // new function in 1.4.0
   pRENDERDOC_DiscardFrameCapture DiscardFrameCapture;
-} RENDERDOC_API_1_4_1;
-
-typedef RENDERDOC_API_1_4_1 RENDERDOC_API_1_0_0;
-typedef RENDERDOC_API_1_4_1 RENDERDOC_API_1_0_1;
-typedef RENDERDOC_API_1_4_1 RENDERDOC_API_1_0_2;
-typedef RENDERDOC_API_1_4_1 RENDERDOC_API_1_1_0;
-typedef RENDERDOC_API_1_4_1 RENDERDOC_API_1_1_1;
-typedef RENDERDOC_API_1_4_1 RENDERDOC_API_1_1_2;
-typedef RENDERDOC_API_1_4_1 RENDERDOC_API_1_2_0;
-typedef RENDERDOC_API_1_4_1 RENDERDOC_API_1_3_0;
-typedef RENDERDOC_API_1_4_1 RENDERDOC_API_1_4_0;
+} RENDERDOC_API_1_5_0;
+
+typedef RENDERDOC_API_1_5_0 RENDERDOC_API_1_0_0;
+typedef RENDERDOC_API_1_5_0 RENDERDOC_API_1_0_1;
+typedef RENDERDOC_API_1_5_0 RENDERDOC_API_1_0_2;
+typedef RENDERDOC_API_1_5_0 RENDERDOC_API_1_1_0;
+typedef RENDERDOC_API_1_5_0 RENDERDOC_API_1_1_1;
+typedef RENDERDOC_API_1_5_0 RENDERDOC_API_1_1_2;
+typedef RENDERDOC_API_1_5_0 RENDERDOC_API_1_2_0;
+typedef RENDERDOC_API_1_5_0 RENDERDOC_API_1_3_0;
+typedef RENDERDOC_API_1_5_0 RENDERDOC_API_1_4_0;
+typedef RENDERDOC_API_1_5_0 RENDERDOC_API_1_4_1;
 
 //////////////////////////////////////////////////////////////////////////////////////////////////
 // RenderDoc API entry point
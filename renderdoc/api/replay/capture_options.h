@@ -204,6 +204,168 @@ Default - enabled
 ``False`` - API debugging is displayed as normal.
 )");
   bool debugOutputMute;
+
+  DOCUMENT(R"(Keep the most recent frames in an in-memory ring, so that they can be saved after the
+fact with :meth:`TargetControl.SaveRecordedFrames` - e.g. when a hitch is noticed.
+
+Every frame that isn't otherwise being captured is captured into the ring, so this has the same
+per-frame cost as continually capturing. Frames are evicted oldest first once either this limit or
+:data:`flightRecorderMemoryMB` is exceeded.
+
+Default - ``0``, which disables the flight recorder.
+)");
+  uint32_t flightRecorderFrames;
+
+  DOCUMENT(R"(The maximum amount of memory in megabytes that frames held by the flight recorder can
+use. The most recent frame is always kept, even if it alone is larger than this limit.
+
+Only used when :data:`flightRecorderFrames` is non-zero. ``0`` means there is no memory limit.
+
+Default - ``512``
+)");
+  uint32_t flightRecorderMemoryMB;
+
+  DOCUMENT(R"(Restrict a capture to the submissions made to one queue family, e.g. to capture only
+the work on an async compute queue. Submissions to other queues aren't recorded, and the resources
+they use aren't referenced or have their initial contents saved.
+
+The capture doesn't begin until the first submission in scope is made, so the initial contents are
+the state at that point rather than when the capture was triggered.
+
+.. note:: This is currently only supported on Vulkan, where this is the queue family index. Other
+  APIs ignore it.
+
+Default - ``0xFFFFFFFF``, which captures submissions to all queues.
+)");
+  uint32_t captureQueueFamily;
+
+  DOCUMENT(R"(The first submission to include in a capture, counted from when the capture is
+triggered. Only submissions to :data:`captureQueueFamily` are counted. As with that option the
+capture doesn't begin until this submission is made.
+
+.. note:: This is currently only supported on Vulkan, other APIs ignore it.
+
+Default - ``0``
+)");
+  uint32_t captureFirstSubmit;
+
+  DOCUMENT(R"(The number of submissions to include in a capture, starting at
+:data:`captureFirstSubmit`. Once they have been made, later submissions are not recorded even if
+the capture hasn't ended yet.
+
+.. note:: This is currently only supported on Vulkan, other APIs ignore it.
+
+Default - ``0``, which includes all submissions until the capture ends.
+)");
+  uint32_t captureNumSubmits;
+
+  DOCUMENT(R"(When several consecutive frames are captured at once, e.g. with
+:meth:`TargetControl.TriggerCapture`, record them all into one capture instead of one capture per
+frame. The initial contents are only saved once, at the start of the first frame, and each frame
+ends at its present.
+
+Default - disabled
+
+``True`` - Consecutive frames are merged into one capture.
+
+``False`` - Each frame is captured separately.
+)");
+  bool mergeMultiFrameCaptures;
+
+  DOCUMENT(R"(The memory in megabytes that the commands recorded for a frame can use while it is
+being captured. Once they use more than this, further commands are compressed and spilled to a
+temporary file, and streamed back out of it when the capture is written. This is intended for
+memory-constrained targets where holding a large frame in memory could run the application out of
+memory.
+
+Default - ``0``, which keeps everything in memory.
+)");
+  uint32_t captureMemoryBudgetMB;
+
+  DOCUMENT(R"(Write-protect memory that the application keeps persistently mapped, so that only the
+pages it actually writes are saved. Otherwise the whole mapping is compared against a shadow copy
+each time it could have been written. This is much cheaper when large mappings are only partly
+written each frame, at the cost of a fault on the first write to each page.
+
+.. note:: This is currently only supported on Vulkan and OpenGL, other APIs ignore it.
+
+Default - disabled
+
+``True`` - Only the pages written through persistent mappings are saved.
+
+``False`` - Persistent mappings are compared against a shadow copy to find what was written.
+)");
+  bool watchCoherentMapWrites;
+
+  DOCUMENT(R"(While not capturing, only record descriptor updates that can't be written by shaders,
+instead of applying them to RenderDoc's copy of the descriptor set straight away. They are applied
+when a capture starts or the set is copied. This makes descriptor updates cheaper for applications
+that update many descriptors every frame, at the cost of a slower start to each capture.
+
+.. note:: This is currently only supported on Vulkan, other APIs ignore it.
+
+Default - disabled
+
+``True`` - Read-only descriptor updates are deferred while not capturing.
+
+``False`` - All descriptor updates are applied immediately.
+)");
+  bool deferDescriptorUpdates;
+
+  DOCUMENT(R"(Store identical buffer contents in a capture's initial contents only once, such as
+zero-filled buffers or default textures.
+
+Captures written this way can't be opened by older versions of RenderDoc.
+
+Default - disabled
+
+``True`` - Identical initial contents are stored once and shared.
+
+``False`` - Each resource's initial contents are stored separately.
+)");
+  bool dedupInitialContents;
+
+  DOCUMENT(R"(Compact large images' initial contents on the GPU before reading them back, so that
+tiles filled with a single repeated value aren't copied to the CPU. This saves time and memory when
+large render targets or textures are mostly cleared.
+
+.. note:: This is currently only supported on Vulkan, other APIs ignore it.
+
+Default - disabled
+
+``True`` - Large images are compacted on the GPU before being read back.
+
+``False`` - Images are read back in full.
+)");
+  bool compactInitialStates;
+
+  DOCUMENT(R"(Compress and write captures to disk on a background thread, so that the application
+can continue as soon as the frame has been serialised instead of waiting for the file to be
+written.
+
+The serialised capture is held in memory until it has been written.
+
+Default - disabled
+
+``True`` - Captures are written to disk on a background thread.
+
+``False`` - Captures are written to disk before the application continues.
+)");
+  bool asyncCaptureWrite;
+
+  DOCUMENT(R"(While not capturing, don't record the creation of samplers and image or buffer views
+until a capture starts while they are still alive. Objects that are created and destroyed between
+captures then cost nothing to record, which helps applications that create many short-lived views.
+
+.. note:: This is currently only supported on Vulkan, other APIs ignore it.
+
+Default - disabled
+
+``True`` - Recording the creation of short-lived objects is deferred while not capturing.
+
+``False`` - The creation of every object is recorded immediately.
+)");
+  bool deferCreationChunks;
 };
 
 DECLARE_REFLECTION_STRUCT(CaptureOptions);
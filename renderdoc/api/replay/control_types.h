@@ -540,6 +540,67 @@ struct NewChildData
 
 DECLARE_REFLECTION_STRUCT(NewChildData);
 
+DOCUMENT("The number of wrapped objects allocated from one of the target's object pools.");
+struct PoolObjectCount
+{
+  DOCUMENT("");
+  PoolObjectCount() = default;
+  PoolObjectCount(const PoolObjectCount &) = default;
+  PoolObjectCount &operator=(const PoolObjectCount &) = default;
+
+  bool operator==(const PoolObjectCount &o) const { return name == o.name && count == o.count; }
+  bool operator<(const PoolObjectCount &o) const
+  {
+    if(!(name == o.name))
+      return name < o.name;
+    if(!(count == o.count))
+      return count < o.count;
+    return false;
+  }
+
+  DOCUMENT("The name of the pool, which is the type of the wrapped objects allocated from it.");
+  rdcstr name;
+  DOCUMENT("The number of objects currently allocated.");
+  uint64_t count = 0;
+};
+
+DECLARE_REFLECTION_STRUCT(PoolObjectCount);
+
+DOCUMENT(R"(A breakdown of the work the target is doing for RenderDoc, on top of the application's
+own work. Rates are averaged since the previous update, which is sent about once a second while
+enabled with :meth:`TargetControl.EnableOverheadStats`.
+)");
+struct CaptureOverheadData
+{
+  DOCUMENT("");
+  CaptureOverheadData() = default;
+  CaptureOverheadData(const CaptureOverheadData &) = default;
+  CaptureOverheadData &operator=(const CaptureOverheadData &) = default;
+
+  DOCUMENT("The number of chunks serialised per second.");
+  float chunksPerSecond = 0.0f;
+  DOCUMENT("The number of bytes of mapped memory compared against a previous copy, per second.");
+  float diffedBytesPerSecond = 0.0f;
+  DOCUMENT(R"(The number of bytes of persistently mapped memory checked for changes when work is
+submitted, per second.
+)");
+  float scannedMapBytesPerSecond = 0.0f;
+  DOCUMENT(R"(The milliseconds per second spent by all threads together waiting for locks held by
+another thread.
+)");
+  float lockWaitMSPerSecond = 0.0f;
+  DOCUMENT("The milliseconds per second spent preparing the initial states of resources.");
+  float prepareInitialStateMSPerSecond = 0.0f;
+  DOCUMENT(R"(The number of wrapped objects currently allocated from each object pool, for any pool
+that has objects allocated.
+
+:type: List[PoolObjectCount]
+)");
+  rdcarray<PoolObjectCount> poolObjects;
+};
+
+DECLARE_REFLECTION_STRUCT(CaptureOverheadData);
+
 DOCUMENT("A message from a target control connection.");
 struct TargetControlMessage
 {
@@ -568,6 +629,9 @@ or has finished, it will be -1.0
 
   DOCUMENT("The number of the capturable windows");
   uint32_t capturableWindowCount = 0;
+
+  DOCUMENT("The :class:`capture overhead breakdown <CaptureOverheadData>`.");
+  CaptureOverheadData overhead;
 };
 
 DECLARE_REFLECTION_STRUCT(TargetControlMessage);
@@ -668,6 +732,64 @@ structured data.
 
 DECLARE_REFLECTION_STRUCT(CaptureFileFormat);
 
+DOCUMENT(R"(A single difference found when comparing the structured data of two captures with
+:meth:`CaptureFile.DiffStructuredData`.
+)");
+struct CaptureDifference
+{
+  DOCUMENT("");
+  CaptureDifference() = default;
+  CaptureDifference(const CaptureDifference &) = default;
+  CaptureDifference &operator=(const CaptureDifference &) = default;
+
+  bool operator==(const CaptureDifference &o) const
+  {
+    return chunkA == o.chunkA && chunkB == o.chunkB && name == o.name && path == o.path &&
+           valueA == o.valueA && valueB == o.valueB;
+  }
+  bool operator<(const CaptureDifference &o) const
+  {
+    if(!(chunkA == o.chunkA))
+      return chunkA < o.chunkA;
+    if(!(chunkB == o.chunkB))
+      return chunkB < o.chunkB;
+    if(!(name == o.name))
+      return name < o.name;
+    if(!(path == o.path))
+      return path < o.path;
+    if(!(valueA == o.valueA))
+      return valueA < o.valueA;
+    if(!(valueB == o.valueB))
+      return valueB < o.valueB;
+    return false;
+  }
+  DOCUMENT(R"(The index of the chunk in the first capture, or -1 if the chunk was only present in
+the second capture.
+)");
+  int32_t chunkA = -1;
+
+  DOCUMENT(R"(The index of the chunk in the second capture, or -1 if the chunk was only present in
+the first capture.
+)");
+  int32_t chunkB = -1;
+
+  DOCUMENT("The name of the chunk that differs.");
+  rdcstr name;
+
+  DOCUMENT(R"(The path to the differing member inside the chunk, such as
+``CreateInfo.extent.width``. Empty if the whole chunk was added or removed.
+)");
+  rdcstr path;
+
+  DOCUMENT("The value of the member in the first capture, formatted as a string.");
+  rdcstr valueA;
+
+  DOCUMENT("The value of the member in the second capture, formatted as a string.");
+  rdcstr valueB;
+};
+
+DECLARE_REFLECTION_STRUCT(CaptureDifference);
+
 DOCUMENT("Describes a single GPU at replay time.");
 struct GPUDevice
 {
@@ -770,6 +892,56 @@ The default is :data:`ReplayOptimisationLevel.Balanced`.
 )");
   ReplayOptimisationLevel optimisation = ReplayOptimisationLevel::Balanced;
 
+  DOCUMENT(R"(Replay submissions to different queues concurrently, the way they originally ran.
+
+Normally all queue work is serialised during replay, waiting for each queue to go idle before work
+is submitted to another, since that is always safe. With this enabled, submissions keep the
+semaphores or fences that ordered them against other queues in the captured program, so work such
+as async compute overlaps with graphics work as it did when captured. This makes full frame replay
+timings more representative, at the cost of relying on the program's own synchronisation.
+
+Only dependencies signalled within the frame are kept - anything signalled before the frame began is
+assumed to be complete. Any submission that can't be replayed this way, such as with Vulkan timeline
+semaphores, falls back to waiting for all queues to be idle.
+
+The default is to serialise queues.
+
+.. note:: Only Vulkan and D3D12 support this, other APIs only have a single queue.
+)");
+  bool concurrentQueues = false;
+
+  DOCUMENT(R"(The minimum number of events between replay checkpoints, or 0 to disable them.
+
+While replaying the whole frame, the contents of the frame's resources are snapshotted at
+submission boundaries at least this many events apart. A later replay to an event after a
+checkpoint skips all of the work before it and restores the snapshot instead.
+
+The default is ``0``, which doesn't take any checkpoints.
+
+.. note:: Only Vulkan supports this.
+)");
+  uint32_t replayCheckpointInterval = 0;
+
+  DOCUMENT(R"(The most GPU memory in megabytes that replay checkpoints can use. Once this is used up
+no more checkpoints are taken. See :data:`replayCheckpointInterval`.
+
+The default is ``1024``.
+)");
+  uint32_t replayCheckpointBudgetMB = 1024;
+
+  DOCUMENT(R"(The most memory in megabytes that can be spent caching re-recorded command buffers, or
+0 to disable the cache.
+
+Command buffers that are re-recorded in full are kept between replays, and a later replay submits
+the cached recording instead of recording it again. The least recently used are freed once the
+budget is used up.
+
+The default is ``0``, which doesn't cache any command buffers.
+
+.. note:: Only Vulkan supports this.
+)");
+  uint32_t rerecordCacheMB = 0;
+
 // helpers for Qt, define constructor and cast. These will be defined in Qt code
 #if defined(RENDERDOC_QT_COMPAT)
   ReplayOptions(const QVariant &var);
@@ -883,6 +1055,12 @@ internal operation where enumerating GPUs would be too expensive or problematic,
 here.
 )");
   bool enumerateGPUs = true;
+
+  DOCUMENT(R"(Whether to replay headless, without initialising any windowing system. No display
+connection is opened and drivers don't set up any presentation support, which avoids stalls on
+machines without a display. Only headless outputs can be created in this mode.
+)");
+  bool headless = false;
 };
 
 DECLARE_REFLECTION_STRUCT(GlobalEnvironment);
@@ -911,4 +1089,5 @@ DECLARE_REFLECTION_STRUCT(ExecuteResult);
 // name.
 typedef std::function<bool()> RENDERDOC_KillCallback;
 typedef std::function<void(float)> RENDERDOC_ProgressCallback;
+typedef std::function<bool(const CaptureDifference &)> RENDERDOC_CaptureDiffCallback;
 typedef std::function<WindowingData(bool, const rdcarray<WindowingSystem> &)> RENDERDOC_PreviewWindowCallback;
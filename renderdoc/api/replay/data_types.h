@@ -1159,6 +1159,57 @@ struct FrameStatistics
 
 DECLARE_REFLECTION_STRUCT(FrameStatistics);
 
+DOCUMENT(R"(The cost of loading every chunk of one type when the capture was opened for replay.
+
+The times are measured around each chunk as it's processed, so the capture-scope chunk includes
+applying initial contents and the first replay of the frame.
+)");
+struct ChunkLoadStatistics
+{
+  DOCUMENT("");
+  ChunkLoadStatistics() = default;
+  ChunkLoadStatistics(const ChunkLoadStatistics &) = default;
+  ChunkLoadStatistics &operator=(const ChunkLoadStatistics &) = default;
+
+  bool operator==(const ChunkLoadStatistics &o) const
+  {
+    return name == o.name && chunkID == o.chunkID && count == o.count && byteSize == o.byteSize &&
+           cpuTime == o.cpuTime && gpuWaitTime == o.gpuWaitTime;
+  }
+  bool operator<(const ChunkLoadStatistics &o) const
+  {
+    if(!(chunkID == o.chunkID))
+      return chunkID < o.chunkID;
+    if(!(cpuTime == o.cpuTime))
+      return cpuTime < o.cpuTime;
+    return false;
+  }
+  DOCUMENT("The name of the chunk type, e.g. ``vkCreateGraphicsPipelines``.");
+  rdcstr name;
+
+  DOCUMENT(R"(The API-specific chunk ID, matching :data:`SDChunkMetaData.chunkID` in the structured
+data.
+)");
+  uint32_t chunkID = 0;
+
+  DOCUMENT("How many chunks of this type were loaded.");
+  uint32_t count = 0;
+
+  DOCUMENT("The total size in bytes of every chunk of this type, after decompression.");
+  uint64_t byteSize = 0;
+
+  DOCUMENT("The total CPU time in seconds spent processing chunks of this type.");
+  double cpuTime = 0.0;
+
+  DOCUMENT(R"(The part of :data:`cpuTime` in seconds that was spent blocked waiting for the GPU,
+such as while uploading initial contents. This is only measured on Vulkan and D3D12, where the
+replay waits for the GPU explicitly, and is ``0`` otherwise.
+)");
+  double gpuWaitTime = 0.0;
+};
+
+DECLARE_REFLECTION_STRUCT(ChunkLoadStatistics);
+
 DOCUMENT(R"(Contains frame-level global information
 
 .. data:: NoFrameNumber
@@ -1218,6 +1269,13 @@ this counts the frame number when the capture was made.
   DOCUMENT("A list of debug messages that are not associated with any particular event.");
   rdcarray<DebugMessage> debugMessages;
 
+  DOCUMENT(R"(The cost of loading each type of chunk when the capture was opened, with the most
+expensive first. Empty if the driver didn't record it.
+
+:type: List[ChunkLoadStatistics]
+)");
+  rdcarray<ChunkLoadStatistics> loadStatistics;
+
   static const uint32_t NoFrameNumber = ~0U;
 };
 
@@ -1393,6 +1451,106 @@ for very coarse bucketing of drawcalls into similar passes by their outputs.
 
 DECLARE_REFLECTION_STRUCT(DrawcallDescription);
 
+DOCUMENT("A range of a buffer to read back at each event in :meth:`ReplayController.VisitEvents`.");
+struct EventVisitBufferRange
+{
+  DOCUMENT("");
+  EventVisitBufferRange() = default;
+  EventVisitBufferRange(const EventVisitBufferRange &) = default;
+  EventVisitBufferRange &operator=(const EventVisitBufferRange &) = default;
+  EventVisitBufferRange(ResourceId id, uint64_t offs, uint64_t size)
+      : resourceId(id), byteOffset(offs), byteSize(size)
+  {
+  }
+
+  bool operator==(const EventVisitBufferRange &o) const
+  {
+    return resourceId == o.resourceId && byteOffset == o.byteOffset && byteSize == o.byteSize;
+  }
+  bool operator<(const EventVisitBufferRange &o) const
+  {
+    if(!(resourceId == o.resourceId))
+      return resourceId < o.resourceId;
+    if(!(byteOffset == o.byteOffset))
+      return byteOffset < o.byteOffset;
+    if(!(byteSize == o.byteSize))
+      return byteSize < o.byteSize;
+    return false;
+  }
+  DOCUMENT("The :class:`ResourceId` of the buffer to read from.");
+  ResourceId resourceId;
+
+  DOCUMENT("The byte offset to the start of the range.");
+  uint64_t byteOffset = 0;
+
+  DOCUMENT("The length of the range, or 0 to read the rest of the buffer.");
+  uint64_t byteSize = 0;
+};
+
+DECLARE_REFLECTION_STRUCT(EventVisitBufferRange);
+
+DOCUMENT(R"(The data gathered at one event by :meth:`ReplayController.VisitEvents`. Only the members
+selected by the requested :class:`EventVisitData` are filled in, the rest are left empty.
+)");
+struct EventVisitResult
+{
+  DOCUMENT("");
+  EventVisitResult() = default;
+  EventVisitResult(const EventVisitResult &) = default;
+  EventVisitResult &operator=(const EventVisitResult &) = default;
+
+  bool operator==(const EventVisitResult &o) const { return eventId == o.eventId; }
+  bool operator<(const EventVisitResult &o) const { return eventId < o.eventId; }
+  DOCUMENT("The :data:`eventId <APIEvent.eventId>` this data was gathered at.");
+  uint32_t eventId = 0;
+
+  DOCUMENT(R"(The :class:`DrawFlags` of the drawcall at this event, or ``NoFlags`` if there is no
+drawcall at this event.
+)");
+  DrawFlags flags = DrawFlags::NoFlags;
+  DOCUMENT("The :data:`DrawcallDescription.numIndices` of the drawcall.");
+  uint32_t numIndices = 0;
+  DOCUMENT("The :data:`DrawcallDescription.numInstances` of the drawcall.");
+  uint32_t numInstances = 0;
+  DOCUMENT("The :data:`DrawcallDescription.baseVertex` of the drawcall.");
+  int32_t baseVertex = 0;
+  DOCUMENT("The :data:`DrawcallDescription.indexOffset` of the drawcall.");
+  uint32_t indexOffset = 0;
+  DOCUMENT("The :data:`DrawcallDescription.vertexOffset` of the drawcall.");
+  uint32_t vertexOffset = 0;
+  DOCUMENT("The :data:`DrawcallDescription.instanceOffset` of the drawcall.");
+  uint32_t instanceOffset = 0;
+  DOCUMENT("The :data:`DrawcallDescription.dispatchDimension` of the drawcall.");
+  uint32_t dispatchDimension[3] = {0, 0, 0};
+
+  DOCUMENT("The shader bound to each stage, indexed by :class:`ShaderStage`.");
+  rdcarray<ResourceId> shaders;
+
+  DOCUMENT("The resources bound for reading by any shader stage, without duplicates.");
+  rdcarray<ResourceId> readOnlyResources;
+  DOCUMENT("The resources bound for reading and writing by any shader stage, without duplicates.");
+  rdcarray<ResourceId> readWriteResources;
+  DOCUMENT("The bound vertex buffers, in slot order.");
+  rdcarray<ResourceId> vertexBuffers;
+  DOCUMENT("The bound index buffer.");
+  ResourceId indexBuffer;
+  DOCUMENT("The bound color output targets, in slot order.");
+  rdcarray<ResourceId> outputTargets;
+  DOCUMENT("The bound depth-stencil target.");
+  ResourceId depthTarget;
+
+  DOCUMENT(R"(The contents of each requested :class:`EventVisitBufferRange` after this event, one
+after the other in the order they were requested.
+)");
+  bytebuf bufferData;
+  DOCUMENT(R"(The offset in :data:`bufferData` where each requested range starts. A range ends where
+the next one starts, or at the end of :data:`bufferData` for the last one.
+)");
+  rdcarray<uint64_t> bufferDataOffsets;
+};
+
+DECLARE_REFLECTION_STRUCT(EventVisitResult);
+
 DOCUMENT("Gives some API-specific information about the capture.");
 struct APIProperties
 {
@@ -1632,6 +1790,169 @@ struct CounterResult
 
 DECLARE_REFLECTION_STRUCT(CounterResult);
 
+DOCUMENT(R"(The GPU duration of a single event, aggregated over several timing replays.
+
+All times are in seconds.
+)");
+struct EventTiming
+{
+  DOCUMENT("");
+  EventTiming() = default;
+  EventTiming(const EventTiming &) = default;
+  EventTiming &operator=(const EventTiming &) = default;
+
+  bool operator==(const EventTiming &o) const
+  {
+    return eventId == o.eventId && median == o.median && mean == o.mean &&
+           variance == o.variance && minimum == o.minimum && maximum == o.maximum &&
+           samples == o.samples;
+  }
+  bool operator<(const EventTiming &o) const
+  {
+    if(!(eventId == o.eventId))
+      return eventId < o.eventId;
+    if(!(median == o.median))
+      return median < o.median;
+    return false;
+  }
+  DOCUMENT("The :data:`eventId <APIEvent.eventId>` that was timed.");
+  uint32_t eventId = 0;
+
+  DOCUMENT("The median duration over all timing replays.");
+  double median = 0.0;
+
+  DOCUMENT("The mean duration over all timing replays.");
+  double mean = 0.0;
+
+  DOCUMENT("The variance of the duration over all timing replays.");
+  double variance = 0.0;
+
+  DOCUMENT("The shortest duration seen in any timing replay.");
+  double minimum = 0.0;
+
+  DOCUMENT("The longest duration seen in any timing replay.");
+  double maximum = 0.0;
+
+  DOCUMENT("The number of timing replays that produced a valid duration for this event.");
+  uint32_t samples = 0;
+};
+
+DECLARE_REFLECTION_STRUCT(EventTiming);
+
+DOCUMENT("The GPU time spent inside one marker region, for each iteration of a measured loop.");
+struct MarkerRegionTiming
+{
+  DOCUMENT("");
+  MarkerRegionTiming() = default;
+  MarkerRegionTiming(const MarkerRegionTiming &) = default;
+  MarkerRegionTiming &operator=(const MarkerRegionTiming &) = default;
+
+  bool operator==(const MarkerRegionTiming &o) const
+  {
+    return eventId == o.eventId && name == o.name && depth == o.depth &&
+           gpuDurations == o.gpuDurations;
+  }
+  bool operator<(const MarkerRegionTiming &o) const
+  {
+    if(!(eventId == o.eventId))
+      return eventId < o.eventId;
+    if(!(name == o.name))
+      return name < o.name;
+    return false;
+  }
+  DOCUMENT("The :data:`eventId <APIEvent.eventId>` of the marker region.");
+  uint32_t eventId = 0;
+
+  DOCUMENT("The name of the marker region.");
+  rdcstr name;
+
+  DOCUMENT("How deeply nested this region is, with ``0`` for regions at the root of the frame.");
+  uint32_t depth = 0;
+
+  DOCUMENT(R"(The summed GPU duration in seconds of all events inside the region, one per loop
+iteration.
+
+:type: List[float]
+)");
+  rdcarray<double> gpuDurations;
+};
+
+DECLARE_REFLECTION_STRUCT(MarkerRegionTiming);
+
+DOCUMENT(R"(The results of a measured replay loop.
+
+The per-iteration lists all have one entry for each iteration that completed.
+)");
+struct ReplayLoopMeasurement
+{
+  DOCUMENT("");
+  ReplayLoopMeasurement() = default;
+  ReplayLoopMeasurement(const ReplayLoopMeasurement &) = default;
+  ReplayLoopMeasurement &operator=(const ReplayLoopMeasurement &) = default;
+
+  DOCUMENT(R"(The CPU time in seconds taken to replay and submit the whole frame, per iteration.
+
+:type: List[float]
+)");
+  rdcarray<double> cpuTimes;
+
+  DOCUMENT(R"(The summed GPU duration in seconds of every event in the frame, per iteration.
+
+:type: List[float]
+)");
+  rdcarray<double> gpuTimes;
+
+  DOCUMENT(R"(The GPU time spent in each marker region, in the order they appear in the frame.
+
+:type: List[MarkerRegionTiming]
+)");
+  rdcarray<MarkerRegionTiming> regions;
+};
+
+DECLARE_REFLECTION_STRUCT(ReplayLoopMeasurement);
+
+DOCUMENT(R"(The memory held for one category of data belonging to an open capture.
+
+Sizes are estimates of the memory owned by the replay for this category, not exact allocation sizes
+as reported by the operating system or driver.
+)");
+struct MemoryUsage
+{
+  DOCUMENT("");
+  MemoryUsage() = default;
+  MemoryUsage(const MemoryUsage &) = default;
+  MemoryUsage &operator=(const MemoryUsage &) = default;
+  MemoryUsage(MemoryCategory c, uint64_t cpu, uint64_t gpu)
+      : category(c), cpuBytes(cpu), gpuBytes(gpu)
+  {
+  }
+
+  bool operator==(const MemoryUsage &o) const
+  {
+    return category == o.category && cpuBytes == o.cpuBytes && gpuBytes == o.gpuBytes;
+  }
+  bool operator<(const MemoryUsage &o) const
+  {
+    if(!(category == o.category))
+      return category < o.category;
+    if(!(cpuBytes == o.cpuBytes))
+      return cpuBytes < o.cpuBytes;
+    if(!(gpuBytes == o.gpuBytes))
+      return gpuBytes < o.gpuBytes;
+    return false;
+  }
+  DOCUMENT("The :class:`MemoryCategory` that this usage is for.");
+  MemoryCategory category = MemoryCategory::StructuredData;
+
+  DOCUMENT("The number of bytes of CPU memory used by this category.");
+  uint64_t cpuBytes = 0;
+
+  DOCUMENT("The number of bytes of GPU memory used by this category.");
+  uint64_t gpuBytes = 0;
+};
+
+DECLARE_REFLECTION_STRUCT(MemoryUsage);
+
 DOCUMENT("The contents of an RGBA pixel.");
 union PixelValue
 {
@@ -1838,6 +2159,88 @@ pixel.
 
 DECLARE_REFLECTION_STRUCT(PixelModification);
 
+DOCUMENT("The history of a single pixel, as returned from a batched pixel history query.");
+struct PixelHistoryResult
+{
+  DOCUMENT("");
+  PixelHistoryResult() = default;
+  PixelHistoryResult(const PixelHistoryResult &) = default;
+  PixelHistoryResult &operator=(const PixelHistoryResult &) = default;
+
+  bool operator==(const PixelHistoryResult &o) const
+  {
+    return x == o.x && y == o.y && modifications == o.modifications;
+  }
+  bool operator<(const PixelHistoryResult &o) const
+  {
+    if(!(x == o.x))
+      return x < o.x;
+    if(!(y == o.y))
+      return y < o.y;
+    if(!(modifications == o.modifications))
+      return modifications < o.modifications;
+    return false;
+  }
+  DOCUMENT("The x co-ordinate of the pixel.");
+  uint32_t x = 0;
+  DOCUMENT("The y co-ordinate of the pixel.");
+  uint32_t y = 0;
+
+  DOCUMENT("The list of :class:`PixelModification` events for this pixel.");
+  rdcarray<PixelModification> modifications;
+};
+
+DECLARE_REFLECTION_STRUCT(PixelHistoryResult);
+
+// declared here rather than with the other callbacks in control_types.h since it needs
+// PixelModification. It's documented along with them in the main IReplayController.
+typedef std::function<bool(const rdcarray<PixelModification> &, float)>
+    RENDERDOC_PixelHistoryCallback;
+
+DOCUMENT(R"(The shading cost of a single draw, gathered while rendering a quad overdraw overlay.
+
+Helper lanes are the pixel shader invocations in partially covered 2x2 quads which are run only to
+compute derivatives. They cost as much as a real invocation but never produce any output.
+)");
+struct OverdrawStatistics
+{
+  DOCUMENT("");
+  OverdrawStatistics() = default;
+  OverdrawStatistics(const OverdrawStatistics &) = default;
+  OverdrawStatistics &operator=(const OverdrawStatistics &) = default;
+
+  bool operator==(const OverdrawStatistics &o) const
+  {
+    return eventId == o.eventId && shadedPixels == o.shadedPixels &&
+           helperLanes == o.helperLanes && quads == o.quads;
+  }
+  bool operator<(const OverdrawStatistics &o) const
+  {
+    if(!(eventId == o.eventId))
+      return eventId < o.eventId;
+    if(!(shadedPixels == o.shadedPixels))
+      return shadedPixels < o.shadedPixels;
+    if(!(helperLanes == o.helperLanes))
+      return helperLanes < o.helperLanes;
+    if(!(quads == o.quads))
+      return quads < o.quads;
+    return false;
+  }
+  DOCUMENT("The :data:`eventId <APIEvent.eventId>` of the draw.");
+  uint32_t eventId = 0;
+
+  DOCUMENT("The number of pixels that were shaded by this draw and passed depth/stencil testing.");
+  uint32_t shadedPixels = 0;
+
+  DOCUMENT("The number of helper lanes launched for this draw's partially covered quads.");
+  uint32_t helperLanes = 0;
+
+  DOCUMENT("The number of 2x2 pixel quads that were shaded by this draw.");
+  uint32_t quads = 0;
+};
+
+DECLARE_REFLECTION_STRUCT(OverdrawStatistics);
+
 DOCUMENT("Contains the bytes and metadata describing a thumbnail.");
 struct Thumbnail
 {
@@ -1860,3 +2263,58 @@ struct Thumbnail
 };
 
 DECLARE_REFLECTION_STRUCT(Thumbnail);
+
+DOCUMENT(R"(A summary of a capture file on a remote system, for browsing captures without copying
+them.
+)");
+struct CaptureSummary
+{
+  DOCUMENT("");
+  CaptureSummary() = default;
+  CaptureSummary(const CaptureSummary &) = default;
+  CaptureSummary &operator=(const CaptureSummary &) = default;
+
+  bool operator==(const CaptureSummary &o) const
+  {
+    // deliberately don't compare the thumbnail
+    return path == o.path && status == o.status && driverName == o.driverName &&
+           machineIdent == o.machineIdent && fileSize == o.fileSize;
+  }
+  bool operator<(const CaptureSummary &o) const
+  {
+    if(!(path == o.path))
+      return path < o.path;
+    if(!(status == o.status))
+      return status < o.status;
+    if(!(driverName == o.driverName))
+      return driverName < o.driverName;
+    if(!(machineIdent == o.machineIdent))
+      return machineIdent < o.machineIdent;
+    if(!(fileSize == o.fileSize))
+      return fileSize < o.fileSize;
+    return false;
+  }
+  DOCUMENT("The path to the capture on the remote system.");
+  rdcstr path;
+
+  DOCUMENT(R"(The :class:`ReplayStatus` from opening the capture. If this isn't
+:data:`ReplayStatus.Succeeded` the other details are not valid.
+)");
+  ReplayStatus status = ReplayStatus::UnknownError;
+
+  DOCUMENT("The name of the driver the capture was made with.");
+  rdcstr driverName;
+
+  DOCUMENT("A human-readable description of the machine the capture was made on.");
+  rdcstr machineIdent;
+
+  DOCUMENT("The size of the capture file in bytes.");
+  uint64_t fileSize = 0;
+
+  DOCUMENT(R"(The :class:`Thumbnail` embedded in the capture. If the capture doesn't contain a
+thumbnail, this will be empty.
+)");
+  Thumbnail thumbnail;
+};
+
+DECLARE_REFLECTION_STRUCT(CaptureSummary);
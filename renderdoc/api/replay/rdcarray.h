@@ -30,6 +30,7 @@
 #include <functional>
 #include <initializer_list>
 #include <type_traits>
+#include <utility>    // for std::move
 
 #ifdef RENDERDOC_EXPORTS
 #include <stdlib.h>    // for malloc/free
@@ -96,6 +97,26 @@ struct ItemCopyHelper<T, true>
   }
 };
 
+// ItemMoveHelper checks if memcpy can be used over placement new when elements are moved to new
+// storage, otherwise the elements are move-constructed so e.g. nested arrays and strings only hand
+// over their allocations instead of copying them
+
+template <typename T, bool isStd = std::is_trivially_copyable<T>::value>
+struct ItemMoveHelper
+{
+  static void moveRange(T *dest, T *src, size_t count)
+  {
+    for(size_t i = 0; i < count; i++)
+      new(dest + i) T(std::move(src[i]));
+  }
+};
+
+template <typename T>
+struct ItemMoveHelper<T, true>
+{
+  static void moveRange(T *dest, T *src, size_t count) { memcpy(dest, src, count * sizeof(T)); }
+};
+
 // ItemDestroyHelper checks if the destructor is trivial/do-nothing and can be skipped
 
 template <typename T, bool isStd = std::is_trivially_destructible<T>::value>
@@ -234,8 +255,8 @@ public:
     // satisfy coverity's static analysis which can't figure that out from the copy constructor
     if(elems)
     {
-      // copy the elements to new storage
-      ItemCopyHelper<T>::copyRange(newElems, elems, usedCount);
+      // move the elements to new storage
+      ItemMoveHelper<T>::moveRange(newElems, elems, usedCount);
 
       // delete the old elements
       ItemDestroyHelper<T>::destroyRange(elems, usedCount);
@@ -288,6 +309,14 @@ public:
     setUsedCount(usedCount + 1);
   }
 
+  void push_back(T &&el)
+  {
+    const size_t lastIdx = size();
+    reserve(size() + 1);
+    new(elems + lastIdx) T(std::move(el));
+    setUsedCount(usedCount + 1);
+  }
+
   // fill the string with 'count' copies of 'el'
   void fill(size_t count, const T &el)
   {
@@ -343,7 +372,7 @@ public:
     {
       // we need to shuffle everything up. Iterate from the back in two stages: first into the
       // newly-allocated elements that don't need to be destructed. Then one-by-one destructing an
-      // element (which has been moved later), and copy-constructing the new one into place
+      // element (which has been moved later), and move-constructing the new one into place
       //
       // e.g. an array of 6 elements, inserting 3 more at offset 1
       //
@@ -353,9 +382,9 @@ public:
       //
       // first pass:
       //
-      // [8].copyConstruct([5])
-      // [7].copyConstruct([4])
-      // [6].copyConstruct([3])
+      // [8].moveConstruct([5])
+      // [7].moveConstruct([4])
+      // [6].moveConstruct([3])
       //
       // [0] [1] [2] [3] [4] [5] [6] [7] [8]
       //  A   B   C   D*  E*  F*  D   E   F
@@ -364,9 +393,9 @@ public:
       //
       // second pass:
       // [5].destruct()
-      // [5].copyConstruct([2])
+      // [5].moveConstruct([2])
       // [4].destruct()
-      // [4].copyConstruct([1])
+      // [4].moveConstruct([1])
       //
       // [0] [1] [2] [3] [4] [5] [6] [7] [8]
       //  A   B*  C*  D*  B   C   D   E   F
@@ -385,10 +414,10 @@ public:
       // In the next part we just need to check if the slot was < oldCount to know if we should
       // destruct it before inserting.
 
-      // first pass, copy
+      // first pass, move
       size_t copyCount = count < oldSize ? count : oldSize;
       for(size_t i = 0; i < copyCount; i++)
-        new(elems + oldSize + count - 1 - i) T(elems[oldSize - 1 - i]);
+        new(elems + oldSize + count - 1 - i) T(std::move(elems[oldSize - 1 - i]));
 
       // second pass, destruct & copy if there was any overlap
       if(count < oldSize - offs)
@@ -398,8 +427,8 @@ public:
         {
           // destruct old element
           elems[oldSize - 1 - i].~T();
-          // copy from earlier
-          new(elems + oldSize - 1 - i) T(elems[oldSize - 1 - count - i]);
+          // move from earlier
+          new(elems + oldSize - 1 - i) T(std::move(elems[oldSize - 1 - count - i]));
         }
       }
 
@@ -457,8 +486,8 @@ public:
     // this is simpler to implement than insert(). We do two simpler passes:
     //
     // Pass 1: Iterate over the secified range, destruct it.
-    // Pass 2: Iterate over the remainder after the range (if it exists), destruct and
-    // copy-construct into new place
+    // Pass 2: Iterate over the remainder after the range (if it exists), move-construct into new
+    // place and destruct
 
     // destruct elements to be removed
     for(size_t i = 0; i < count; i++)
@@ -467,7 +496,7 @@ public:
     // move remaining elements into place
     for(size_t i = offs + count; i < sz; i++)
     {
-      new(elems + i - count) T(elems[i]);
+      new(elems + i - count) T(std::move(elems[i]));
       elems[i].~T();
     }
 
@@ -487,7 +516,7 @@ public:
   // erase & return an index
   T takeAt(size_t offs)
   {
-    T ret = elems[offs];
+    T ret = std::move(elems[offs]);
     erase(offs);
     return ret;
   }
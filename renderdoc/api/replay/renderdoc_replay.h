@@ -329,6 +329,20 @@ Should only be called for texture outputs.
 )");
   virtual ResourceId GetDebugOverlayTexID() = 0;
 
+  DOCUMENT(R"(Retrieves the per-draw shading costs gathered while rendering the debug overlay.
+
+This is only filled in for the :data:`DebugOverlay.QuadOverdrawPass` and
+:data:`DebugOverlay.QuadOverdrawDraw` overlays, and the statistics are collected in the same replay
+that renders the overlay. On APIs that don't support it, and for any other overlay, the list is
+empty.
+
+Should only be called for texture outputs.
+
+:return: The statistics for each draw in the overlay, in event order.
+:rtype: ``list`` of :class:`OverdrawStatistics`
+)");
+  virtual rdcarray<OverdrawStatistics> GetOverdrawStatistics() = 0;
+
   DOCUMENT(R"(Retrieves the vertex and instance that is under the cursor location, when viewed
 relative to the current window with the current mesh display configuration.
 
@@ -391,6 +405,29 @@ well as control the replay and analysis functionality available.
     created.
   :rtype: WindowingData
 
+.. function:: PixelHistoryCallback()
+
+  Not an actual member function - the signature for any ``PixelHistoryCallback`` callbacks.
+
+  Called by :meth:`ReplayController.StreamPixelHistory` each time a batch of events has been
+  processed.
+
+  :param List[PixelModification] history: The modifications from this batch of events, in event
+    order.
+  :param float progress: The fraction of events processed so far, reaching 1.0 with the last batch.
+  :return: Whether or not to continue processing the remaining events.
+  :rtype: ``bool``
+
+.. function:: CaptureDiffCallback()
+
+  Not an actual member function - the signature for any ``CaptureDiffCallback`` callbacks.
+
+  Called by :meth:`CaptureFile.DiffStructuredData` for each difference as soon as it is found.
+
+  :param CaptureDifference difference: The difference that was found.
+  :return: Whether or not to continue comparing the captures.
+  :rtype: ``bool``
+
 .. data:: NoPreference
 
   No preference for a particular value, see :meth:`ReplayController.DebugPixel`.
@@ -434,6 +471,22 @@ function must be called from another thread.
 )");
   virtual void ReplayLoop(WindowingData window, ResourceId texid) = 0;
 
+  DOCUMENT(R"(Repeatedly replays the open capture, measuring each iteration.
+
+This is intended for using a capture as a reproducible GPU benchmark. Nothing is displayed. Each
+iteration does one plain replay of the frame, to measure the CPU cost of replaying and submitting
+it, and one replay with GPU timestamps around every event. The timestamps are summed for the whole
+frame and for every marker region.
+
+Like :meth:`ReplayLoop`, this blocks until it is finished. :meth:`CancelReplayLoop` can be called
+from another thread to stop early, and the iterations completed so far are returned.
+
+:param int iterations: The number of iterations to measure.
+:return: The measurements for every completed iteration.
+:rtype: ReplayLoopMeasurement
+)");
+  virtual ReplayLoopMeasurement MeasureReplayLoop(uint32_t iterations) = 0;
+
   DOCUMENT(R"(Uses the given output window to create an RGP Profile.
 
 :param WindowingData window: A :class:`WindowingData` describing the native window.
@@ -445,6 +498,31 @@ function must be called from another thread.
   DOCUMENT("Cancels a replay loop begun in :meth:`ReplayLoop`. Does nothing if no loop is active.");
   virtual void CancelReplayLoop() = 0;
 
+  DOCUMENT(R"(Retrieve an estimate of the memory held for the open capture, broken down by category.
+
+Categories that aren't used by the current API or replay are not listed.
+
+:return: The CPU and GPU memory used by each category.
+:rtype: ``list`` of :class:`MemoryUsage`
+)");
+  virtual rdcarray<MemoryUsage> GetMemoryUsage() = 0;
+
+  DOCUMENT(R"(Set a budget for the memory held in a given category.
+
+The budget is checked whenever the current event changes, and for
+:data:`MemoryCategory.TextureStatsCache` whenever a result is added. If the category is over budget
+then its contents are evicted, and will be recalculated the next time they are needed.
+
+Only categories which are caches can be evicted: :data:`MemoryCategory.PostVSCache`,
+:data:`MemoryCategory.TextureStatsCache`, :data:`MemoryCategory.ShaderCache`,
+:data:`MemoryCategory.RerecordCache` and :data:`MemoryCategory.TextureReadback`. Budgets for any
+other category are ignored.
+
+:param MemoryCategory category: The category to set a budget for.
+:param int bytes: The budget in bytes of combined CPU and GPU memory, or 0 for no budget.
+)");
+  virtual void SetMemoryBudget(MemoryCategory category, uint64_t bytes) = 0;
+
   DOCUMENT("Notify the interface that the file it has open has been changed on disk.");
   virtual void FileChanged() = 0;
 
@@ -457,6 +535,23 @@ function must be called from another thread.
 )");
   virtual void SetFrameEvent(uint32_t eventId, bool force) = 0;
 
+  DOCUMENT(R"(Gather data at each of a list of events, without the cost of a full
+:meth:`SetFrameEvent` and pipeline state query for every one.
+
+The events are visited in ascending order, so replaying from one to the next can continue on from
+the previous event where the driver supports it, and pipeline state is only fetched when the
+requested data needs it. Afterwards the replay is moved back to the current event.
+
+:param list eventIds: The :data:`eventIds <APIEvent.eventId>` to visit.
+:param EventVisitData data: The data to gather at each event.
+:param list buffers: The list of :class:`EventVisitBufferRange` to read back after each event.
+:return: The data gathered at each event, in the same order as ``eventIds``.
+:rtype: ``list`` of :class:`EventVisitResult`
+)");
+  virtual rdcarray<EventVisitResult> VisitEvents(
+      const rdcarray<uint32_t> &eventIds, EventVisitData data,
+      const rdcarray<EventVisitBufferRange> &buffers) = 0;
+
   DOCUMENT(R"(Retrieve the current :class:`D3D11State` pipeline state.
 
 The return value will be ``None`` if the capture is not using the D3D11 API.
@@ -651,6 +746,19 @@ See :meth:`BuildTargetShader`.
 )");
   virtual const SDFile &GetStructuredFile() = 0;
 
+  DOCUMENT(R"(Make sure the contents of the given chunks in the structured file are available.
+
+When replaying remotely the structured file initially only contains each chunk's name and metadata,
+and the parameters are fetched as they're needed to avoid transferring the whole file up front.
+This function should be called before accessing the contents of chunks. When replaying locally the
+whole file is always available and this does nothing.
+
+The parameters of chunks for the drawcall at the current event are always fetched.
+
+:param List[int] chunkIndices: The indices in :data:`SDFile.chunks` of the chunks to fetch.
+)");
+  virtual void FetchStructuredChunks(const rdcarray<uint32_t> &chunkIndices) = 0;
+
   DOCUMENT(R"(Add fake marker regions to the list of drawcalls in the capture, based on which
 textures are bound as outputs.
 )");
@@ -671,6 +779,19 @@ textures are bound as outputs.
 )");
   virtual rdcarray<CounterResult> FetchCounters(const rdcarray<GPUCounter> &counters) = 0;
 
+  DOCUMENT(R"(Time every event on the GPU over several replays of the frame.
+
+Each replay records the timestamps for the whole frame, without any other counters enabled, and the
+results are aggregated per event. A single replay can be skewed by clock changes or by other work
+on the GPU, so the median over several replays is a more stable measure than
+:meth:`FetchCounters` with :data:`GPUCounter.EventGPUDuration`.
+
+:param int repeats: The number of times to replay the frame. At least one replay is always done.
+:return: The aggregated timing for each event, sorted by event.
+:rtype: ``list`` of :class:`EventTiming`
+)");
+  virtual rdcarray<EventTiming> FetchEventTimings(uint32_t repeats) = 0;
+
   DOCUMENT(R"(Retrieve a list of which counters are available in the current capture analysis
 implementation.
 
@@ -829,6 +950,52 @@ bucket when the pixel values are divided between ``minval`` and ``maxval``.
   virtual rdcarray<PixelModification> PixelHistory(ResourceId texture, uint32_t x, uint32_t y,
                                                    const Subresource &sub, CompType typeCast) = 0;
 
+  DOCUMENT(R"(Retrieve the history of modifications to many pixels in the given texture, as with
+:meth:`PixelHistory`.
+
+The texture's events are looked up once for the whole batch, duplicate pixels are only processed
+once, and the replay is only restored to the current event at the end. This is much faster than
+calling :meth:`PixelHistory` for each pixel in turn.
+
+:param ResourceId texture: The texture to search for modifications.
+:param List[int] pixels: The pixels to fetch history for, as a flat list of ``x, y`` pairs.
+:param Subresource sub: The subresource within this texture to use.
+:param CompType typeCast: If possible interpret the texture with this type instead of its normal
+  type. See :meth:`PixelHistory`.
+:return: The pixel history of each pixel, in the same order as :paramref:`pixels`. Pixels that are
+  out of bounds have an empty history.
+:rtype: ``list`` of :class:`PixelHistoryResult`
+)");
+  virtual rdcarray<PixelHistoryResult> BatchPixelHistory(ResourceId texture,
+                                                         const rdcarray<uint32_t> &pixels,
+                                                         const Subresource &sub,
+                                                         CompType typeCast) = 0;
+
+  DOCUMENT(R"(Retrieve the history of modifications to the selected pixel as with
+:meth:`PixelHistory`, but return the results incrementally.
+
+The events that wrote to the texture are processed in batches and :paramref:`callback` is called
+with each batch's modifications as soon as they're available, so that results can be displayed
+before the whole history is complete on heavy captures. Returning ``False`` from the callback skips
+the remaining events.
+
+:param ResourceId texture: The texture to search for modifications.
+:param int x: The x co-ordinate.
+:param int y: The y co-ordinate.
+:param Subresource sub: The subresource within this texture to use.
+:param CompType typeCast: If possible interpret the texture with this type instead of its normal
+  type. See :meth:`PixelHistory`.
+:param int batchSize: The number of events to process in each batch. Events are not split between
+  batches, so a batch may be slightly larger.
+:param bool mostRecentFirst: ``True`` if batches should be processed starting with the events
+  closest to the current event, going backwards. ``False`` to process from the start of the frame.
+:param PixelHistoryCallback callback: Called with the modifications from each batch.
+)");
+  virtual void StreamPixelHistory(ResourceId texture, uint32_t x, uint32_t y,
+                                  const Subresource &sub, CompType typeCast, uint32_t batchSize,
+                                  bool mostRecentFirst,
+                                  RENDERDOC_PixelHistoryCallback callback) = 0;
+
   DOCUMENT(R"(Retrieve a debugging trace from running a vertex shader.
 
 :param int vertid: The vertex ID as a 0-based index up to the number of vertices in the draw.
@@ -885,6 +1052,43 @@ completed, further calls will return an empty list.
 )");
   virtual rdcarray<ShaderDebugState> ContinueDebug(ShaderDebugger *debugger) = 0;
 
+  DOCUMENT(R"(Continue a shader's debugging with a given shader debugger instance, until one of the
+conditions in the given parameters is hit or the debugging process completes.
+
+Unlike :meth:`ContinueDebug` the intermediate states are not returned. Instead a list of keyframes
+is returned, one every :data:`ShaderDebugRunParameters.keyframeInterval` steps. The last keyframe
+in the list is always the state that running stopped at. Each keyframe contains the complete value
+of every mutable variable in its :data:`ShaderDebugState.changes`, with an empty
+:data:`ShaderVariableChange.before`, in the same way as the initial state of a debug.
+
+The states between keyframes can be reconstructed on demand with :meth:`ReconstructDebugSteps`.
+
+If the list is empty, the debugging process has already completed.
+
+:param ShaderDebugger debugger: The shader debugger to continue running.
+:param ShaderDebugRunParameters params: The conditions to stop on.
+:return: The keyframes recorded while running.
+:rtype: ``list`` of :class:`ShaderDebugState`
+)");
+  virtual rdcarray<ShaderDebugState> RunDebug(ShaderDebugger *debugger,
+                                              const ShaderDebugRunParameters &params) = 0;
+
+  DOCUMENT(R"(Reconstruct a range of states that were previously stepped over by
+:meth:`ContinueDebug` or :meth:`RunDebug`, by deterministically re-executing the shader.
+
+The returned states are the same as :meth:`ContinueDebug` would have returned for those steps, so
+they can be applied on top of the nearest preceding keyframe returned from :meth:`RunDebug`.
+
+:param ShaderDebugger debugger: The shader debugger that originally ran these steps.
+:param int firstStep: The :data:`ShaderDebugState.stepIndex` of the first state to return.
+:param int count: The number of states to return.
+:return: The reconstructed states. This may be shorter than requested if the range extends past
+  the steps that have been run.
+:rtype: ``list`` of :class:`ShaderDebugState`
+)");
+  virtual rdcarray<ShaderDebugState> ReconstructDebugSteps(ShaderDebugger *debugger,
+                                                           uint32_t firstStep, uint32_t count) = 0;
+
   DOCUMENT(R"(Free a debugging trace from running a shader invocation debug.
 
 :param ShaderDebugTrace trace: The shader debugging trace to free.
@@ -919,6 +1123,20 @@ otherwise.
                                                               uint32_t cbufslot, ResourceId buffer,
                                                               uint64_t offset, uint64_t length) = 0;
 
+  DOCUMENT(R"(Retrieve the contents of several constant blocks at once, such as every constant block
+bound to every stage at the current event.
+
+This is equivalent to calling :meth:`GetCBufferVariableContents` for each entry, but each distinct
+buffer is read back only once covering the range of every block that uses it. When constants are
+sub-allocated from one large buffer this saves a readback per block.
+
+:param List[ConstantBlockFetch] fetches: The constant blocks to fetch.
+:return: The same list, with :data:`ConstantBlockFetch.variables` filled out in each entry.
+:rtype: List[ConstantBlockFetch]
+)");
+  virtual rdcarray<ConstantBlockFetch> GetCBufferVariableContentsBatch(
+      const rdcarray<ConstantBlockFetch> &fetches) = 0;
+
   DOCUMENT(R"(Save a texture to a file on disk, with possible transformation to map a complex
 texture to something compatible with the target file format.
 
@@ -929,6 +1147,21 @@ texture to something compatible with the target file format.
 )");
   virtual bool SaveTexture(const TextureSave &saveData, const char *path) = 0;
 
+  DOCUMENT(R"(Save a list of textures to files on disk, as with :meth:`SaveTexture`.
+
+Textures are read back in order, and converting and writing each file happens on background
+threads while later textures are still being read back. This is much faster than calling
+:meth:`SaveTexture` for each texture when saving a large number of textures.
+
+:param List[TextureSave] saveData: The configuration settings of each texture to save.
+:param List[str] paths: The path to save each texture to, must be the same length as
+  :paramref:`saveData`.
+:return: The indices of any textures that failed to save. Empty if every texture was saved.
+:rtype: ``list`` of ``int``
+)");
+  virtual rdcarray<uint32_t> SaveTextures(const rdcarray<TextureSave> &saveData,
+                                          const rdcarray<rdcstr> &paths) = 0;
+
   DOCUMENT(R"(Retrieve the generated data from one of the geometry processing shader stages.
 
 :param int instance: The index of the instance to retrieve data for, or 0 for non-instanced draws.
@@ -939,22 +1172,28 @@ texture to something compatible with the target file format.
 )");
   virtual MeshFormat GetPostVSData(uint32_t instance, uint32_t view, MeshDataStage stage) = 0;
 
-  DOCUMENT(R"(Retrieve the contents of a range of a buffer as a ``bytes``.
+  DOCUMENT(R"(Retrieve the contents of a range of a buffer as a read-only ``memoryview``.
+
+The view refers directly to the retrieved data rather than a copy, so it can be passed to e.g.
+``struct.unpack_from`` or ``numpy.frombuffer`` without duplicating large readbacks. Use ``bytes()``
+on it if a ``bytes`` object is needed.
 
 :param ResourceId buff: The id of the buffer to retrieve data from.
 :param int offset: The byte offset to the start of the range.
 :param int len: The length of the range, or 0 to retrieve the rest of the bytes in the buffer.
 :return: The requested buffer contents.
-:rtype: ``bytes``
+:rtype: ``memoryview``
 )");
   virtual bytebuf GetBufferData(ResourceId buff, uint64_t offset, uint64_t len) = 0;
 
-  DOCUMENT(R"(Retrieve the contents of one subresource of a texture as a ``bytes``.
+  DOCUMENT(R"(Retrieve the contents of one subresource of a texture as a read-only ``memoryview``.
+
+As with :meth:`GetBufferData` the view refers directly to the retrieved data rather than a copy.
 
 :param ResourceId tex: The id of the texture to retrieve data from.
 :param Subresource sub: The subresource within this texture to use.
 :return: The requested texture contents.
-:rtype: ``bytes``
+:rtype: ``memoryview``
 )");
   virtual bytebuf GetTextureData(ResourceId tex, const Subresource &sub) = 0;
 
@@ -1067,6 +1306,38 @@ The details of the types of messages that can be received are listed under
   DOCUMENT("Cycle the currently active window if there are more windows to capture.");
   virtual void CycleActiveWindow() = 0;
 
+  DOCUMENT(R"(Save frames held by the target's flight recorder to disk. Each saved frame is then
+reported as a new capture, the same as any other capture made on the target.
+
+Only frames still in the ring can be saved, see :data:`CaptureOptions.flightRecorderFrames`. Once
+saved, a frame is removed from the ring.
+
+:param int frameNumber: The number of the first frame to save.
+:param int numFrames: How many frames to save, starting at ``frameNumber``.
+)");
+  virtual void SaveRecordedFrames(uint32_t frameNumber, uint32_t numFrames) = 0;
+
+  DOCUMENT(R"(Have the target send new captures over the target control connection while they are
+being written, instead of saving them on the remote machine. Useful for devices with little storage,
+and the capture is available as soon as it's finished.
+
+Each streamed capture is written to ``localDirectory`` with the same filename it would have had on
+the target, and is reported as a new capture with its local path, the same as once a capture has
+been copied with :meth:`CopyCapture`. There is nothing to copy or delete on the remote machine.
+
+:param str localDirectory: The absolute path of the local directory to save streamed captures in,
+  or an empty string to go back to saving captures on the remote machine.
+)");
+  virtual void StreamCaptures(const char *localDirectory) = 0;
+
+  DOCUMENT(R"(Have the target measure the work it's doing for RenderDoc on top of the application's
+own work, and send a :data:`TargetControlMessageType.CaptureOverhead` message with a breakdown
+about once a second. Measuring has a small cost of its own, so it's only done while enabled.
+
+:param bool enable: ``True`` to start measuring and sending updates, ``False`` to stop.
+)");
+  virtual void EnableOverheadStats(bool enable) = 0;
+
 protected:
   ITargetControl() = default;
   ~ITargetControl() = default;
@@ -1246,6 +1517,23 @@ If an error occurs, a single :class:`PathEntry` will be returned with appropriat
 )");
   virtual rdcarray<PathEntry> ListFolder(const char *path) = 0;
 
+  DOCUMENT(R"(Retrieve summaries of a batch of captures on the remote system, without copying them.
+
+Each capture is opened on the remote system only far enough to read its metadata and any embedded
+thumbnail, which is converted there so only the requested size is transferred.
+
+:param List[str] paths: The remote paths of the captures to summarise.
+:param FileType thumbType: The file type to return thumbnails in. The only supported values are
+  :attr:`FileType.JPG`, :attr:`FileType.PNG`, :attr:`FileType.TGA`, and :attr:`FileType.BMP`.
+:param int maxThumbSize: The largest width or height allowed for thumbnails. If the embedded
+  thumbnail is larger, it's downscaled. If 0, the thumbnails are returned at full size.
+:return: A summary of each capture, in the same order as :paramref:`GetCaptureSummaries.paths`.
+:rtype: ``list`` of :class:`CaptureSummary`
+)");
+  virtual rdcarray<CaptureSummary> GetCaptureSummaries(const rdcarray<rdcstr> &paths,
+                                                       FileType thumbType,
+                                                       uint32_t maxThumbSize) = 0;
+
   DOCUMENT(R"(Launch an application and inject into it to allow capturing.
 
 This happens on the remote system, so all paths are relative to the remote filesystem.
@@ -1372,6 +1660,19 @@ empty or unrecognised.
   virtual ReplayStatus OpenFile(const char *filename, const char *filetype,
                                 RENDERDOC_ProgressCallback progress) = 0;
 
+  DOCUMENT(R"(Initialises the capture handle from a file, reading only the file header and section
+table. Nothing is decompressed, so this is much cheaper than :meth:`OpenFile` when only the driver,
+machine ident, thumbnail or section list are needed.
+
+Only native ``rdc`` files are supported. Any extended thumbnail stored in a section is not loaded,
+so :meth:`GetThumbnail` returns the thumbnail embedded in the header.
+
+:param str filename: The filename of the file to open.
+:return: The status of the open operation, whether it succeeded or failed (and how it failed).
+:rtype: ReplayStatus
+)");
+  virtual ReplayStatus OpenFileHeader(const char *filename) = 0;
+
   DOCUMENT(R"(Initialises the file handle from a raw memory buffer.
 
 This may be useful if you don't want to parse the whole file or already have the file in memory.
@@ -1412,7 +1713,9 @@ representation back to native RDC.
 :param SDFile file: An optional :class:`SDFile` with the structured data to source from. This is
   useful in case the format specifies that it doesn't need buffers, and you already have a
   :class:`ReplayController` open with the structured data. This saves the need to load the file
-  again. If ``None`` then structured data will be fetched if not already present and used.
+  again. If ``None`` then structured data will be fetched if not already present and used. When
+  converting to native ``rdc`` the frame capture is written from this data instead of being copied,
+  so it must include buffers.
 :param ProgressCallback progress: A callback that will be repeatedly called with an updated progress
   value for the conversion. Can be ``None`` if no progress is desired.
 :return: The status of the conversion operation, whether it succeeded or failed (and how it failed).
@@ -1519,6 +1822,22 @@ The data is copied internally so it can be destroyed after calling this function
 )");
   virtual void SetStructuredData(const SDFile &file) = 0;
 
+  DOCUMENT(R"(Compares the structured data of this capture against another capture.
+
+Chunks are aligned by name so that inserted or removed calls are reported once rather than
+shifting every following chunk. Whole chunks and member subtrees that hash identically are skipped
+without being walked, and buffer contents are compared by hash. Differences are passed to the
+callback as they are found, so a large comparison can be displayed or aborted incrementally.
+
+:param CaptureFile other: The capture to compare against.
+:param CaptureDiffCallback callback: Called with each :class:`CaptureDifference` found. If it
+  returns ``False`` the comparison stops.
+:return: The number of differences that were reported.
+:rtype: ``int``
+)");
+  virtual uint32_t DiffStructuredData(ICaptureFile *other,
+                                      RENDERDOC_CaptureDiffCallback callback) = 0;
+
   DOCUMENT(R"(Retrieves the embedded thumbnail from the capture.
 
 .. note:: The only supported values for :paramref:`GetThumbnail.type` are :attr:`FileType.JPG`,
@@ -1738,7 +2057,8 @@ extern "C" RENDERDOC_API uint32_t RENDERDOC_CC RENDERDOC_EnumerateRemoteTargets(
 DOCUMENT(R"(Create a connection to a remote server running on given hostname and port.
 
 :param str URL: The hostname to connect to, if blank then localhost is used. If no protocol is
-  specified then default TCP enumeration happens.
+  specified then default TCP enumeration happens, and a ``:port`` suffix can pick a server
+  listening on a non-default port.
 :return: The status of opening the capture, whether success or failure, and a :class:`RemoteServer`
   instance if it were successful
 :rtype: ``pair`` of ReplayStatus and RemoteServer
@@ -1752,7 +2072,8 @@ from external sources.
 This function will block until a remote connection tells the server to shut down, or the
 ``killReplay`` callback returns ``True``.
 
-:param str host: The name of the interface to listen on.
+:param str host: The name of the interface to listen on, optionally with a ``:port`` suffix to
+  listen on a non-default port so that several servers can share one machine.
 :param KillCallback killReplay: A callback that returns a ``bool`` indicating if the server should
   be shut down or not.
 :param PreviewWindowCallback previewWindow: A callback that returns information for a preview window
@@ -1943,6 +2264,27 @@ analysis program.
 )");
 extern "C" RENDERDOC_API const char *RENDERDOC_CC RENDERDOC_GetLogFile();
 
+DOCUMENT(R"(Enables or disables recording of RenderDoc's own internal profiling zones, covering work
+such as replaying, initial state preparation, counter fetching, remote proxy calls and compression.
+
+Recording can also be enabled from startup by setting the ``RENDERDOC_PROFILE_TRACE`` environment
+variable to a filename, in which case a trace is written there on shutdown.
+
+:param bool enabled: Whether profiling zones should be recorded.
+)");
+extern "C" RENDERDOC_API void RENDERDOC_CC RENDERDOC_SetSelfProfiling(bool enabled);
+
+DOCUMENT(R"(Writes the most recently recorded internal profiling zones from every thread out as a
+JSON trace that can be loaded in chrome's profiler at chrome://tracing.
+
+See :func:`SetSelfProfiling`.
+
+:param str filename: The path to write the trace to.
+:return: Whether or not the trace was successfully written.
+:rtype: ``bool``
+)");
+extern "C" RENDERDOC_API bool RENDERDOC_CC RENDERDOC_WriteSelfProfileTrace(const char *filename);
+
 DOCUMENT("Internal function for fetching the contents of a log");
 extern "C" RENDERDOC_API void RENDERDOC_CC RENDERDOC_GetLogFileContents(rdcstr &logfile);
 
@@ -900,6 +900,26 @@ rdcstr DoStringise(const MeshDataStage &el)
   END_ENUM_STRINGISE();
 }
 
+template <>
+rdcstr DoStringise(const MemoryCategory &el)
+{
+  BEGIN_ENUM_STRINGISE(MemoryCategory)
+  {
+    STRINGISE_ENUM_CLASS(StructuredData);
+    STRINGISE_ENUM_CLASS(InitialContents);
+    STRINGISE_ENUM_CLASS(ProxyCache);
+    STRINGISE_ENUM_CLASS(PostVSCache);
+    STRINGISE_ENUM_CLASS(TextureStatsCache);
+    STRINGISE_ENUM_CLASS(ShaderCache);
+    STRINGISE_ENUM_CLASS(RerecordCache);
+    STRINGISE_ENUM_CLASS(TextureReadback);
+    STRINGISE_ENUM_CLASS(ShaderReflection);
+    STRINGISE_ENUM_CLASS(ReplayTextures);
+    STRINGISE_ENUM_CLASS(ReplayBuffers);
+  }
+  END_ENUM_STRINGISE();
+}
+
 template <>
 rdcstr DoStringise(const DebugOverlay &el)
 {
@@ -983,6 +1003,8 @@ rdcstr DoStringise(const SectionType &el)
     STRINGISE_ENUM_CLASS_NAMED(ResourceRenames, "renderdoc/ui/resrenames");
     STRINGISE_ENUM_CLASS_NAMED(AMDRGPProfile, "amd/rgp/profile");
     STRINGISE_ENUM_CLASS_NAMED(ExtendedThumbnail, "renderdoc/internal/exthumb");
+    STRINGISE_ENUM_CLASS_NAMED(SeekTable, "renderdoc/internal/seektable");
+    STRINGISE_ENUM_CLASS_NAMED(ShaderBlobs, "renderdoc/internal/shaderblobs");
   }
   END_ENUM_STRINGISE();
 }
@@ -1014,6 +1036,20 @@ rdcstr DoStringise(const D3DBufferViewFlags &el)
   END_BITFIELD_STRINGISE();
 }
 
+template <>
+rdcstr DoStringise(const EventVisitData &el)
+{
+  BEGIN_BITFIELD_STRINGISE(EventVisitData);
+  {
+    STRINGISE_BITFIELD_CLASS_VALUE(NoFlags);
+
+    STRINGISE_BITFIELD_CLASS_BIT(Drawcall);
+    STRINGISE_BITFIELD_CLASS_BIT(Shaders);
+    STRINGISE_BITFIELD_CLASS_BIT(BoundResources);
+  }
+  END_BITFIELD_STRINGISE();
+}
+
 template <>
 rdcstr DoStringise(const PathProperty &el)
 {
@@ -1041,6 +1077,7 @@ rdcstr DoStringise(const SectionFlags &el)
     STRINGISE_BITFIELD_CLASS_BIT_NAMED(ASCIIStored, "Stored as ASCII");
     STRINGISE_BITFIELD_CLASS_BIT_NAMED(LZ4Compressed, "Compressed with LZ4");
     STRINGISE_BITFIELD_CLASS_BIT_NAMED(ZstdCompressed, "Compressed with Zstd");
+    STRINGISE_BITFIELD_CLASS_BIT_NAMED(ZstdDictionary, "Zstd first block dictionary");
   }
   END_BITFIELD_STRINGISE();
 }
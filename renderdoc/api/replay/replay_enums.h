@@ -86,6 +86,21 @@ version of RenderDoc that addes a new section type. They should be considered eq
   lossless.
 
   The name for this section will be "renderdoc/internal/exthumb".
+
+.. data:: SeekTable
+
+  This section contains an index of the compressed blocks in the frame capture section, allowing
+  readers to jump to a given offset without decompressing everything before it. It is regenerated
+  whenever the frame capture section is written and can be safely discarded.
+
+  The name for this section will be "renderdoc/internal/seektable".
+
+.. data:: ShaderBlobs
+
+  This section contains shader code referenced from the frame capture, stored once per distinct
+  blob. Chunks that create shaders refer to it by hash instead of embedding the code themselves.
+
+  The name for this section will be "renderdoc/internal/shaderblobs".
 )");
 enum class SectionType : uint32_t
 {
@@ -98,6 +113,8 @@ enum class SectionType : uint32_t
   ResourceRenames,
   AMDRGPProfile,
   ExtendedThumbnail,
+  SeekTable,
+  ShaderBlobs,
   Count,
 };
 
@@ -1051,6 +1068,77 @@ enum class MeshDataStage : uint32_t
 
 DECLARE_REFLECTION_ENUM(MeshDataStage);
 
+DOCUMENT(R"(A category of memory held by the replay on behalf of an open capture.
+
+.. data:: StructuredData
+
+  The structured data for the capture's chunks, as returned by
+  :meth:`ReplayController.GetStructuredFile`.
+
+.. data:: InitialContents
+
+  The contents of resources at the start of the frame, which are restored before each replay.
+
+.. data:: ProxyCache
+
+  Resource contents copied back from a remote server to be displayed locally. This is only used
+  when replaying on a remote server.
+
+.. data:: PostVSCache
+
+  The cached outputs of vertex processing for each draw, used by the mesh viewer. This is a cache
+  and can be evicted to stay within a budget set with :meth:`ReplayController.SetMemoryBudget`.
+
+.. data:: TextureStatsCache
+
+  The min/max and histogram results cached for textures at the current event. This is a cache and
+  can be evicted.
+
+.. data:: ShaderCache
+
+  Shaders, disassembly and reflection data loaded from the on-disk shader caches. Entries that are
+  only used to look up data can be evicted and will be loaded again when next needed.
+
+.. data:: RerecordCache
+
+  Command buffers kept between replays so that they don't need to be recorded again. This is only
+  used by Vulkan, when enabled. This is a cache and can be evicted.
+
+.. data:: TextureReadback
+
+  Staging memory kept between texture readbacks, such as when saving textures. This is a cache and
+  can be evicted.
+
+.. data:: ShaderReflection
+
+  The reflection data, including the shader bytecode, of the capture's shaders that have been
+  reflected so far.
+
+.. data:: ReplayTextures
+
+  The textures created from the capture, as estimated from their descriptions.
+
+.. data:: ReplayBuffers
+
+  The buffers created from the capture, as estimated from their descriptions.
+)");
+enum class MemoryCategory : uint32_t
+{
+  StructuredData,
+  InitialContents,
+  ProxyCache,
+  PostVSCache,
+  TextureStatsCache,
+  ShaderCache,
+  RerecordCache,
+  TextureReadback,
+  ShaderReflection,
+  ReplayTextures,
+  ReplayBuffers,
+};
+
+DECLARE_REFLECTION_ENUM(MemoryCategory);
+
 DOCUMENT(R"(The type of overlay image to render on top of an existing texture view, for debugging
 purposes.
 
@@ -3462,6 +3550,14 @@ DOCUMENT(R"(The type of message received from or sent to an application target c
 .. data:: CaptureProgress
 
   Progress update on an on-going frame capture.
+
+.. data:: CapturableWindowCount
+
+  The number of windows that can be captured has changed.
+
+.. data:: CaptureOverhead
+
+  An update to the breakdown of the work the target is doing for RenderDoc.
 )");
 enum class TargetControlMessageType : uint32_t
 {
@@ -3474,7 +3570,8 @@ enum class TargetControlMessageType : uint32_t
   RegisterAPI,
   NewChild,
   CaptureProgress,
-  CapturableWindowCount
+  CapturableWindowCount,
+  CaptureOverhead,
 };
 
 DECLARE_REFLECTION_ENUM(TargetControlMessageType);
@@ -3737,6 +3834,11 @@ DOCUMENT(R"(A set of flags describing the properties of a section in a renderdoc
 .. data:: ZstdCompressed
 
   This section is compressed with Zstd on disk.
+
+.. data:: ZstdDictionary
+
+  Used along with :data:`ZstdCompressed`. The first block of the section is used as a dictionary
+  when compressing every later block, which compresses small repetitive data much better.
 )");
 enum class SectionFlags : uint32_t
 {
@@ -3744,6 +3846,7 @@ enum class SectionFlags : uint32_t
   ASCIIStored = 0x1,
   LZ4Compressed = 0x2,
   ZstdCompressed = 0x4,
+  ZstdDictionary = 0x8,
 };
 
 BITMASK_OPERATORS(SectionFlags);
@@ -4197,6 +4300,36 @@ enum class AndroidFlags : uint32_t
 BITMASK_OPERATORS(AndroidFlags);
 DECLARE_REFLECTION_ENUM(AndroidFlags);
 
+DOCUMENT(R"(A set of flags selecting which data :meth:`ReplayController.VisitEvents` gathers at each
+event.
+
+.. data:: NoFlags
+
+  No data is gathered beyond any requested buffer ranges.
+
+.. data:: Drawcall
+
+  The parameters of the drawcall at the event are gathered.
+
+.. data:: Shaders
+
+  The shader bound to each stage is gathered.
+
+.. data:: BoundResources
+
+  The resources bound to the pipeline are gathered.
+)");
+enum class EventVisitData : uint32_t
+{
+  NoFlags = 0x0,
+  Drawcall = 0x1,
+  Shaders = 0x2,
+  BoundResources = 0x4,
+};
+
+BITMASK_OPERATORS(EventVisitData);
+DECLARE_REFLECTION_ENUM(EventVisitData);
+
 #if defined(DISABLE_PYTHON_FLAG_ENUMS)
 DISABLE_PYTHON_FLAG_ENUMS;
 #endif
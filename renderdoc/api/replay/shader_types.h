@@ -611,6 +611,39 @@ The oldest/outer function is first in the list, the newest/inner function is las
 
 DECLARE_REFLECTION_STRUCT(ShaderDebugState);
 
+DOCUMENT(R"(Describes the conditions under which :meth:`ReplayController.RunDebug` should stop
+running a shader debugger, and how often it should record keyframes along the way.
+)");
+struct ShaderDebugRunParameters
+{
+  DOCUMENT("");
+  ShaderDebugRunParameters() = default;
+  ShaderDebugRunParameters(const ShaderDebugRunParameters &) = default;
+  ShaderDebugRunParameters &operator=(const ShaderDebugRunParameters &) = default;
+
+  DOCUMENT(R"(A ``list`` of instruction indices to break on. Running stops at the first state whose
+:data:`ShaderDebugState.nextInstruction` is in this list.
+)");
+  rdcarray<uint32_t> breakpoints;
+
+  DOCUMENT(R"(A ``list`` of ``str`` with the names of debug variables to watch. Running stops at the
+first state that changes any of these variables.
+)");
+  rdcarray<rdcstr> watchVariables;
+
+  DOCUMENT(R"(A set of :class:`ShaderEvents` flags. Running stops at the first state that has any of
+these events.
+)");
+  ShaderEvents stopOnEvents = ShaderEvents::NoEvent;
+
+  DOCUMENT(R"(The number of steps between recorded keyframes. If set to 0, only the state that
+running stopped at is returned.
+)");
+  uint32_t keyframeInterval = 1000;
+};
+
+DECLARE_REFLECTION_STRUCT(ShaderDebugRunParameters);
+
 DOCUMENT("An opaque structure that has internal state for shader debugging");
 struct ShaderDebugger
 {
@@ -1369,3 +1402,74 @@ struct ShaderBindpointMapping
 };
 
 DECLARE_REFLECTION_STRUCT(ShaderBindpointMapping);
+
+DOCUMENT(R"(One constant block to fetch with
+:meth:`ReplayController.GetCBufferVariableContentsBatch`.
+
+The parameters match those of :meth:`ReplayController.GetCBufferVariableContents`.
+)");
+struct ConstantBlockFetch
+{
+  DOCUMENT("");
+  ConstantBlockFetch() = default;
+  ConstantBlockFetch(const ConstantBlockFetch &) = default;
+  ConstantBlockFetch &operator=(const ConstantBlockFetch &) = default;
+
+  bool operator==(const ConstantBlockFetch &o) const
+  {
+    return pipeline == o.pipeline && shader == o.shader && entryPoint == o.entryPoint &&
+           cbufSlot == o.cbufSlot && buffer == o.buffer && byteOffset == o.byteOffset &&
+           byteSize == o.byteSize && variables == o.variables;
+  }
+  bool operator<(const ConstantBlockFetch &o) const
+  {
+    if(!(pipeline == o.pipeline))
+      return pipeline < o.pipeline;
+    if(!(shader == o.shader))
+      return shader < o.shader;
+    if(!(entryPoint == o.entryPoint))
+      return entryPoint < o.entryPoint;
+    if(!(cbufSlot == o.cbufSlot))
+      return cbufSlot < o.cbufSlot;
+    if(!(buffer == o.buffer))
+      return buffer < o.buffer;
+    if(!(byteOffset == o.byteOffset))
+      return byteOffset < o.byteOffset;
+    if(!(byteSize == o.byteSize))
+      return byteSize < o.byteSize;
+    return false;
+  }
+  DOCUMENT("The pipeline state object, if applicable, that the shader is bound to.");
+  ResourceId pipeline;
+
+  DOCUMENT("The id of the shader to use for metadata.");
+  ResourceId shader;
+
+  DOCUMENT("The entry point of the shader being used. In some APIs, this is ignored.");
+  rdcstr entryPoint;
+
+  DOCUMENT("The index in the :data:`ShaderReflection.constantBlocks` list to look up.");
+  uint32_t cbufSlot = 0;
+
+  DOCUMENT(R"(The id of the buffer to use for data. If :data:`ConstantBlock.bufferBacked` is
+``False`` this is ignored.
+)");
+  ResourceId buffer;
+
+  DOCUMENT("The byte offset in :data:`buffer` where the constant block's contents start.");
+  uint64_t byteOffset = 0;
+
+  DOCUMENT(R"(The number of bytes after :data:`byteOffset` to read. May be 0 to read the rest of the
+buffer.
+)");
+  uint64_t byteSize = 0;
+
+  DOCUMENT(R"(The shader variables with their contents. This is ignored when passed in and filled
+out in the returned list.
+
+:type: List[ShaderVariable]
+)");
+  rdcarray<ShaderVariable> variables;
+};
+
+DECLARE_REFLECTION_STRUCT(ConstantBlockFetch);
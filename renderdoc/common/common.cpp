@@ -39,33 +39,30 @@ void rdcassert(const char *msg, const char *file, unsigned int line, const char
                 "Assertion failed: %s", msg);
 }
 
-#if 0
-static __m128 zero = {0};
+// x64 always has SSE2, and NEON is detected at compile time. Wider vectors don't gain anything
+// here since these comparisons are limited by memory bandwidth rather than instruction throughput.
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define DIFF_USE_SSE2 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define DIFF_USE_NEON 1
+#include <arm_neon.h>
 #endif
 
 // assumes a and b both point to 16-byte aligned 16-byte chunks of memory.
 // Returns if they're equal or different
 bool Vec16NotEqual(void *a, void *b)
 {
-// disabled SSE version as it's acting dodgy
-#if 0
-	__m128 avec = _mm_load_ps(aflt);
-	__m128 bvec = _mm_load_ps(bflt);
-
-	__m128 diff = _mm_xor_ps(avec, bvec);
-
-	__m128 eq = _mm_cmpeq_ps(diff, zero);
-	int mask = _mm_movemask_ps(eq);
-	int signMask = _mm_movemask_ps(diff);
-
-	// first check ensures that diff is floatequal to zero (ie. avec bitwise equal to bvec).
-	// HOWEVER -0 is floatequal to 0, so we ensure no sign bits are set on diff
-	if((mask^0xf) || signMask != 0)
-	{
-		return true;
-	}
-	
-	return false;
+#if defined(DIFF_USE_SSE2)
+  __m128i diff =
+      _mm_xor_si128(_mm_load_si128((const __m128i *)a), _mm_load_si128((const __m128i *)b));
+
+  return _mm_movemask_epi8(_mm_cmpeq_epi8(diff, _mm_setzero_si128())) != 0xffff;
+#elif defined(DIFF_USE_NEON)
+  uint64x2_t diff = vreinterpretq_u64_u8(
+      veorq_u8(vld1q_u8((const uint8_t *)a), vld1q_u8((const uint8_t *)b)));
+
+  return (vgetq_lane_u64(diff, 0) | vgetq_lane_u64(diff, 1)) != 0;
 #elif ENABLED(RDOC_X64)
   uint64_t *a64 = (uint64_t *)a;
   uint64_t *b64 = (uint64_t *)b;
@@ -79,38 +76,90 @@ bool Vec16NotEqual(void *a, void *b)
 #endif
 }
 
+// as Vec16NotEqual but for 64 bytes, folding the differences together before a single test
+static bool Vec64NotEqual(const byte *a, const byte *b)
+{
+#if defined(DIFF_USE_SSE2)
+  const __m128i *a128 = (const __m128i *)a;
+  const __m128i *b128 = (const __m128i *)b;
+
+  __m128i diff = _mm_or_si128(
+      _mm_or_si128(_mm_xor_si128(_mm_load_si128(a128 + 0), _mm_load_si128(b128 + 0)),
+                   _mm_xor_si128(_mm_load_si128(a128 + 1), _mm_load_si128(b128 + 1))),
+      _mm_or_si128(_mm_xor_si128(_mm_load_si128(a128 + 2), _mm_load_si128(b128 + 2)),
+                   _mm_xor_si128(_mm_load_si128(a128 + 3), _mm_load_si128(b128 + 3))));
+
+  return _mm_movemask_epi8(_mm_cmpeq_epi8(diff, _mm_setzero_si128())) != 0xffff;
+#elif defined(DIFF_USE_NEON)
+  uint8x16_t diff = vorrq_u8(vorrq_u8(veorq_u8(vld1q_u8(a + 0), vld1q_u8(b + 0)),
+                                      veorq_u8(vld1q_u8(a + 16), vld1q_u8(b + 16))),
+                             vorrq_u8(veorq_u8(vld1q_u8(a + 32), vld1q_u8(b + 32)),
+                                      veorq_u8(vld1q_u8(a + 48), vld1q_u8(b + 48))));
+
+  uint64x2_t diff64 = vreinterpretq_u64_u8(diff);
+
+  return (vgetq_lane_u64(diff64, 0) | vgetq_lane_u64(diff64, 1)) != 0;
+#else
+  const uint64_t *a64 = (const uint64_t *)a;
+  const uint64_t *b64 = (const uint64_t *)b;
+
+  uint64_t diff = 0;
+  for(int i = 0; i < 8; i++)
+    diff |= a64[i] ^ b64[i];
+
+  return diff != 0;
+#endif
+}
+
+// returns the offset of the first differing 16-byte vector in [offs, end), or end if there is none.
+// offs and end must be multiples of 16
+static size_t FirstDiffVec(const byte *a, const byte *b, size_t offs, size_t end)
+{
+  while(offs + 64 <= end && !Vec64NotEqual(a + offs, b + offs))
+    offs += 64;
+
+  while(offs < end && !Vec16NotEqual((void *)(a + offs), (void *)(b + offs)))
+    offs += 16;
+
+  return offs;
+}
+
+// returns the end of the last differing 16-byte vector in [begin, end), or begin if there is none.
+// begin and end must be multiples of 16
+static size_t LastDiffVecEnd(const byte *a, const byte *b, size_t begin, size_t end)
+{
+  while(end >= begin + 64 && !Vec64NotEqual(a + end - 64, b + end - 64))
+    end -= 64;
+
+  while(end > begin && !Vec16NotEqual((void *)(a + end - 16), (void *)(b + end - 16)))
+    end -= 16;
+
+  return end;
+}
+
 bool FindDiffRange(void *a, void *b, size_t bufSize, size_t &diffStart, size_t &diffEnd)
 {
   RDCASSERT(uintptr_t(a) % 16 == 0);
   RDCASSERT(uintptr_t(b) % 16 == 0);
 
+  OverheadCounters::Add(OverheadCounter::DiffedBytes, int64_t(bufSize));
+
+  const byte *abyte = (const byte *)a;
+  const byte *bbyte = (const byte *)b;
+
   diffStart = bufSize + 1;
   diffEnd = 0;
 
   size_t alignedSize = bufSize & (~0xf);
-  size_t numVecs = alignedSize / 16;
-
-  size_t offs = 0;
-
-  float *aflt = (float *)a;
-  float *bflt = (float *)b;
 
   // sweep to find the start of differences
-  for(size_t v = 0; v < numVecs; v++)
-  {
-    if(Vec16NotEqual(aflt, bflt))
-    {
-      diffStart = offs;
-      break;
-    }
+  size_t offs = FirstDiffVec(abyte, bbyte, 0, alignedSize);
 
-    aflt += 4;
-    bflt += 4;
-    offs += 4 * sizeof(float);
-  }
+  if(offs < alignedSize)
+    diffStart = offs;
 
   // make sure we're byte-accurate, to comply with WRITE_NO_OVERWRITE
-  while(diffStart < bufSize && *((byte *)a + diffStart) == *((byte *)b + diffStart))
+  while(diffStart < bufSize && abyte[diffStart] == bbyte[diffStart])
     diffStart++;
 
   // do we have some unaligned bytes at the end of the buffer?
@@ -121,24 +170,20 @@ bool FindDiffRange(void *a, void *b, size_t bufSize, size_t &diffStart, size_t &
     // if we haven't even found a start, check in these bytes
     if(diffStart > bufSize)
     {
-      offs = alignedSize;
-
       for(size_t by = 0; by < numBytes; by++)
       {
-        if(*((byte *)a + alignedSize + by) != *((byte *)b + alignedSize + by))
+        if(abyte[alignedSize + by] != bbyte[alignedSize + by])
         {
-          diffStart = offs;
+          diffStart = alignedSize + by;
           break;
         }
-
-        offs++;
       }
     }
 
     // sweep from the last byte to find the end
     for(size_t by = 0; by < numBytes; by++)
     {
-      if(*((byte *)a + bufSize - 1 - by) != *((byte *)b + bufSize - 1 - by))
+      if(abyte[bufSize - 1 - by] != bbyte[bufSize - 1 - by])
       {
         diffEnd = bufSize - by;
         break;
@@ -151,31 +196,101 @@ bool FindDiffRange(void *a, void *b, size_t bufSize, size_t &diffStart, size_t &
   if(diffStart > bufSize || diffEnd > 0)
     return diffStart < bufSize;
 
-  offs = alignedSize;
+  // sweep back from the end, which can't go past the start we found
+  diffEnd = LastDiffVecEnd(abyte, bbyte, diffStart & (~0xf), alignedSize);
 
-  // sweep from the last __m128
-  aflt = (float *)a + offs / sizeof(float) - 4;
-  bflt = (float *)b + offs / sizeof(float) - 4;
+  // make sure we're byte-accurate, to comply with WRITE_NO_OVERWRITE
+  while(diffEnd > 0 && abyte[diffEnd - 1] == bbyte[diffEnd - 1])
+    diffEnd--;
+
+  // if we found a start then we necessarily found an end
+  return diffStart < bufSize;
+}
 
-  for(size_t v = 0; v < numVecs; v++)
+size_t FindDiffRanges(void *a, void *b, size_t bufSize, size_t minGap, size_t *rangeStarts,
+                      size_t *rangeEnds, size_t maxRanges)
+{
+  RDCASSERT(uintptr_t(a) % 16 == 0);
+  RDCASSERT(uintptr_t(b) % 16 == 0);
+
+  if(maxRanges == 0)
+    return 0;
+
+  OverheadCounters::Add(OverheadCounter::DiffedBytes, int64_t(bufSize));
+
+  const byte *abyte = (const byte *)a;
+  const byte *bbyte = (const byte *)b;
+
+  size_t alignedSize = bufSize & (~0xf);
+
+  size_t numRanges = 0;
+  size_t offs = 0;
+
+  while(offs < alignedSize)
   {
-    if(Vec16NotEqual(aflt, bflt))
-    {
-      diffEnd = offs;
+    size_t start = FirstDiffVec(abyte, bbyte, offs, alignedSize);
+
+    if(start >= alignedSize)
       break;
+
+    size_t end = start + 16;
+
+    if(numRanges + 1 == maxRanges)
+    {
+      // out of ranges, so this last one covers everything else that differs
+      end = LastDiffVecEnd(abyte, bbyte, start, alignedSize);
+      offs = alignedSize;
+    }
+    else
+    {
+      // extend the range until we see at least minGap bytes that are unchanged
+      offs = end;
+      while(offs < alignedSize && offs - end < minGap)
+      {
+        if(Vec16NotEqual((void *)(abyte + offs), (void *)(bbyte + offs)))
+          end = offs + 16;
+        offs += 16;
+      }
     }
 
-    aflt -= 4;
-    bflt -= 4;
-    offs -= 16;
+    // make sure we're byte-accurate, to comply with WRITE_NO_OVERWRITE. The first and last vectors
+    // are known to differ so these can't run off the range
+    while(abyte[start] == bbyte[start])
+      start++;
+    while(abyte[end - 1] == bbyte[end - 1])
+      end--;
+
+    rangeStarts[numRanges] = start;
+    rangeEnds[numRanges] = end;
+    numRanges++;
   }
 
-  // make sure we're byte-accurate, to comply with WRITE_NO_OVERWRITE
-  while(diffEnd > 0 && *((byte *)a + diffEnd - 1) == *((byte *)b + diffEnd - 1))
-    diffEnd--;
+  // check any unaligned bytes at the end of the buffer
+  size_t tailStart = bufSize, tailEnd = 0;
+  for(size_t by = alignedSize; by < bufSize; by++)
+  {
+    if(abyte[by] != bbyte[by])
+    {
+      tailStart = RDCMIN(tailStart, by);
+      tailEnd = by + 1;
+    }
+  }
 
-  // if we found a start then we necessarily found an end
-  return diffStart < bufSize;
+  if(tailEnd > 0)
+  {
+    if(numRanges > 0 && (numRanges == maxRanges || tailStart - rangeEnds[numRanges - 1] < minGap))
+    {
+      rangeEnds[numRanges - 1] = tailEnd;
+    }
+    else
+    {
+      rangeStarts[numRanges] = tailStart;
+      rangeEnds[numRanges] = tailEnd;
+      numRanges++;
+    }
+  }
+
+  return numRanges;
 }
 
 uint32_t CalcNumMips(int w, int h, int d)
@@ -501,3 +616,80 @@ void rdclog_direct(time_t utcTime, uint32_t pid, LogType type, const char *proje
 
   SAFE_DELETE_ARRAY(oversizedBuffer);
 }
+
+#if ENABLED(ENABLE_UNIT_TESTS)
+
+#include "3rdparty/catch/catch.hpp"
+
+TEST_CASE("Test finding differences between buffers", "[common]")
+{
+  // deliberately not a multiple of 16 so the unaligned tail is exercised
+  const size_t size = 1024 * 1024 + 7;
+
+  byte *a = AllocAlignedBuffer(size);
+  byte *b = AllocAlignedBuffer(size);
+
+  for(size_t i = 0; i < size; i++)
+    a[i] = b[i] = byte(i * 17);
+
+  size_t starts[4], ends[4];
+  size_t diffStart = 0, diffEnd = 0;
+
+  SECTION("Identical buffers")
+  {
+    CHECK_FALSE(FindDiffRange(a, b, size, diffStart, diffEnd));
+    CHECK(FindDiffRanges(a, b, size, 4096, starts, ends, 4) == 0);
+  };
+
+  SECTION("Single byte difference")
+  {
+    b[12345] ^= 0xff;
+
+    CHECK(FindDiffRange(a, b, size, diffStart, diffEnd));
+    CHECK(diffStart == 12345);
+    CHECK(diffEnd == 12346);
+
+    REQUIRE(FindDiffRanges(a, b, size, 4096, starts, ends, 4) == 1);
+    CHECK(starts[0] == 12345);
+    CHECK(ends[0] == 12346);
+  };
+
+  SECTION("Differences at both ends")
+  {
+    b[3] ^= 0xff;
+    b[100] ^= 0xff;
+    b[size - 1] ^= 0xff;
+
+    CHECK(FindDiffRange(a, b, size, diffStart, diffEnd));
+    CHECK(diffStart == 3);
+    CHECK(diffEnd == size);
+
+    // the first two are within minGap of each other so merge
+    REQUIRE(FindDiffRanges(a, b, size, 4096, starts, ends, 4) == 2);
+    CHECK(starts[0] == 3);
+    CHECK(ends[0] == 101);
+    CHECK(starts[1] == size - 1);
+    CHECK(ends[1] == size);
+  };
+
+  SECTION("More differences than ranges")
+  {
+    for(size_t i = 0; i < 8; i++)
+      b[i * 100000 + 50] ^= 0xff;
+
+    REQUIRE(FindDiffRanges(a, b, size, 4096, starts, ends, 4) == 4);
+    CHECK(starts[0] == 50);
+    CHECK(ends[0] == 51);
+    CHECK(starts[2] == 200050);
+    CHECK(ends[2] == 200051);
+
+    // the last range covers everything else
+    CHECK(starts[3] == 300050);
+    CHECK(ends[3] == 700051);
+  };
+
+  FreeAlignedBuffer(a);
+  FreeAlignedBuffer(b);
+};
+
+#endif    // ENABLED(ENABLE_UNIT_TESTS)
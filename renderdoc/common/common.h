@@ -188,6 +188,11 @@ inline T AlignUpPtr(T x, A a)
   (((uint32_t)(d) << 24) | ((uint32_t)(c) << 16) | ((uint32_t)(b) << 8) | (uint32_t)(a))
 
 bool FindDiffRange(void *a, void *b, size_t bufSize, size_t &diffStart, size_t &diffEnd);
+// finds up to maxRanges disjoint [start, end) ranges where a and b differ, merging differences
+// that are less than minGap bytes apart. If there are more, the last range covers all remaining
+// differences. Returns the number of ranges written.
+size_t FindDiffRanges(void *a, void *b, size_t bufSize, size_t minGap, size_t *rangeStarts,
+                      size_t *rangeEnds, size_t maxRanges);
 uint32_t CalcNumMips(int Width, int Height, int Depth);
 
 typedef uint8_t byte;
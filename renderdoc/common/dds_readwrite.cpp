@@ -892,12 +892,8 @@ bool write_dds_to_file(FILE *f, const dds_data &data)
             pitch = RDCMAX(blockSize, (((rowlen + 3) / 4)) * blockSize);
           }
 
-          for(int row = 0; row < numRows; row++)
-          {
-            FileIO::fwrite(bytedata, 1, pitch, f);
-
-            bytedata += pitch;
-          }
+          // rows are tightly packed in the source data, so write them all at once
+          FileIO::fwrite(bytedata, 1, size_t(pitch) * numRows, f);
 
           i++;
         }
@@ -920,7 +916,7 @@ bool is_dds_file(FILE *f)
   return magic == dds_fourcc;
 }
 
-dds_data load_dds_from_file(FILE *f)
+dds_data load_dds_header(FILE *f)
 {
   dds_data ret = {};
   dds_data error = {};
@@ -1094,8 +1090,10 @@ dds_data load_dds_from_file(FILE *f)
     }
   }
 
+  ret.bgrSwap = bgrSwap;
+  ret.dataOffset = FileIO::ftell64(f);
   ret.subsizes = new uint32_t[ret.slices * ret.mips];
-  ret.subdata = new byte *[ret.slices * ret.mips];
+  ret.subdata = NULL;
 
   int i = 0;
   for(int slice = 0; slice < ret.slices; slice++)
@@ -1123,41 +1121,54 @@ dds_data load_dds_from_file(FILE *f)
 
       ret.subsizes[i] = numdepths * numRows * pitch;
 
-      byte *bytedata = ret.subdata[i] = new byte[ret.subsizes[i]];
+      i++;
+    }
+  }
 
-      for(int d = 0; d < numdepths; d++)
-      {
-        for(int row = 0; row < numRows; row++)
-        {
-          FileIO::fread(bytedata, 1, pitch, f);
+  return ret;
+}
 
-          if(bgrSwap)
-          {
-            byte *rgba = bytedata;
-
-            if(bytesPerPixel >= 3)
-            {
-              for(int p = 0; p < rowlen; p++)
-              {
-                std::swap(rgba[0], rgba[2]);
-                rgba += bytesPerPixel;
-              }
-            }
-            else
-            {
-              for(int p = 0; p < rowlen; p++)
-              {
-                std::swap(rgba[0], rgba[1]);
-                rgba += bytesPerPixel;
-              }
-            }
-          }
+bool read_dds_subresource(FILE *f, const dds_data &data, int subresource, byte *out)
+{
+  // subresources are tightly packed one after another, with no padding between rows
+  uint64_t offset = data.dataOffset;
+  for(int i = 0; i < subresource; i++)
+    offset += data.subsizes[i];
 
-          bytedata += pitch;
-        }
-      }
+  FileIO::fseek64(f, offset, SEEK_SET);
 
-      i++;
+  uint32_t size = data.subsizes[subresource];
+
+  if(FileIO::fread(out, 1, size, f) != size)
+    return false;
+
+  // the only format that needs swizzling is packed 422 where each pixel is two bytes
+  if(data.bgrSwap)
+  {
+    for(uint32_t b = 0; b + 1 < size; b += 2)
+      std::swap(out[b], out[b + 1]);
+  }
+
+  return true;
+}
+
+dds_data load_dds_from_file(FILE *f)
+{
+  dds_data ret = load_dds_header(f);
+
+  if(ret.subsizes == NULL)
+    return ret;
+
+  ret.subdata = new byte *[ret.slices * ret.mips];
+
+  for(int i = 0; i < ret.slices * ret.mips; i++)
+  {
+    ret.subdata[i] = new byte[ret.subsizes[i]];
+
+    if(!read_dds_subresource(f, ret, i, ret.subdata[i]))
+    {
+      RDCWARN("DDS file truncated reading subresource %d", i);
+      memset(ret.subdata[i], 0, ret.subsizes[i]);
     }
   }
 
@@ -42,8 +42,18 @@ struct dds_data
 
   byte **subdata;
   uint32_t *subsizes;
+
+  // only used when reading
+  uint64_t dataOffset;
+  bool bgrSwap;
 };
 
 extern bool is_dds_file(FILE *f);
 extern dds_data load_dds_from_file(FILE *f);
+
+// reads only the header and the subresource sizes, leaving subdata NULL. On failure subsizes is
+// NULL. Subresources (indexed as slice * mips + mip) can then be read individually with
+// read_dds_subresource into a buffer of at least subsizes[subresource] bytes.
+extern dds_data load_dds_header(FILE *f);
+extern bool read_dds_subresource(FILE *f, const dds_data &data, int subresource, byte *out);
 extern bool write_dds_to_file(FILE *f, const dds_data &data);
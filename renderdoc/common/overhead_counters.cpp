@@ -0,0 +1,111 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019-2020 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+
+#include "overhead_counters.h"
+#include "common/threading.h"
+
+namespace OverheadCounters
+{
+// each counter is on its own cache line, so threads updating different counters don't contend
+struct alignas(64) Counter
+{
+  volatile int64_t value = 0;
+};
+
+static volatile bool enabled = false;
+static Counter counters[(size_t)OverheadCounter::Count];
+
+struct RegisteredPool
+{
+  void *pool;
+  const char *name;
+  PoolLiveCountCallback callback;
+};
+
+// pools are created during static initialisation, so these are constructed on first use rather
+// than relying on initialisation order.
+struct RegisteredPools
+{
+  Threading::CriticalSection lock;
+  rdcarray<RegisteredPool> pools;
+};
+
+static RegisteredPools &GetPools()
+{
+  static RegisteredPools pools;
+  return pools;
+}
+
+void SetEnabled(bool en)
+{
+  enabled = en;
+}
+
+bool IsEnabled()
+{
+  return enabled;
+}
+
+void Add(OverheadCounter counter, int64_t value)
+{
+  if(enabled)
+    Atomic::ExchAdd64(&counters[(size_t)counter].value, value);
+}
+
+int64_t Get(OverheadCounter counter)
+{
+  return counters[(size_t)counter].value;
+}
+
+void RegisterPool(void *pool, const char *name, PoolLiveCountCallback callback)
+{
+  RegisteredPools &pools = GetPools();
+  SCOPED_LOCK(pools.lock);
+  pools.pools.push_back({pool, name, callback});
+}
+
+void UnregisterPool(void *pool)
+{
+  RegisteredPools &pools = GetPools();
+  SCOPED_LOCK(pools.lock);
+  pools.pools.removeIf([pool](const RegisteredPool &p) { return p.pool == pool; });
+}
+
+rdcarray<rdcpair<rdcstr, uint64_t>> GetPoolLiveCounts()
+{
+  rdcarray<rdcpair<rdcstr, uint64_t>> ret;
+
+  RegisteredPools &pools = GetPools();
+  SCOPED_LOCK(pools.lock);
+  for(const RegisteredPool &p : pools.pools)
+  {
+    uint64_t count = p.callback(p.pool);
+    if(count > 0)
+      ret.push_back({p.name, count});
+  }
+
+  return ret;
+}
+};
@@ -0,0 +1,92 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019-2020 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+
+#pragma once
+
+#include "os/os_specific.h"
+#include "common.h"
+
+// Counters of the work RenderDoc does on top of the application while capturing, so a connected
+// target control client can show where the overhead is going. Counters are only updated while a
+// client has asked for them - otherwise an update costs a single enabled check.
+enum class OverheadCounter : uint32_t
+{
+  // chunks serialised by the drivers
+  SerialisedChunks,
+  // bytes compared looking for changes, by FindDiffRange and FindDiffRanges
+  DiffedBytes,
+  // bytes of persistently mapped memory checked for changes when work is submitted
+  ScannedMapBytes,
+  // ticks spent by all threads waiting for locks held by another thread
+  LockWaitTicks,
+  // ticks spent preparing initial states
+  PrepareInitialStateTicks,
+  Count,
+};
+
+namespace OverheadCounters
+{
+void SetEnabled(bool enabled);
+bool IsEnabled();
+
+// does nothing unless enabled
+void Add(OverheadCounter counter, int64_t value);
+
+// returns the running total of a counter, which is never reset
+int64_t Get(OverheadCounter counter);
+
+// wrapping pools register themselves on creation so the number of objects allocated from each can
+// be reported. The callback is only called with the registration lock held, and unregistering
+// takes the same lock, so a pool is never queried once it's been destroyed.
+typedef size_t (*PoolLiveCountCallback)(void *pool);
+void RegisterPool(void *pool, const char *name, PoolLiveCountCallback callback);
+void UnregisterPool(void *pool);
+
+// the name and number of live objects of every registered pool that has any
+rdcarray<rdcpair<rdcstr, uint64_t>> GetPoolLiveCounts();
+};
+
+// adds the ticks spent in a scope to a counter
+class ScopedOverheadTimer
+{
+public:
+  ScopedOverheadTimer(OverheadCounter counter) : m_Counter(counter), m_Start(0)
+  {
+    if(OverheadCounters::IsEnabled())
+      m_Start = Timing::GetTick();
+  }
+
+  ~ScopedOverheadTimer()
+  {
+    if(m_Start)
+      OverheadCounters::Add(m_Counter, int64_t(Timing::GetTick() - m_Start));
+  }
+
+private:
+  OverheadCounter m_Counter;
+  uint64_t m_Start;
+};
+
+#define RDCOVERHEAD_TIMER(counter) ScopedOverheadTimer CONCAT(overheadTimer, __LINE__)(counter);
@@ -0,0 +1,180 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019-2020 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include "profiler.h"
+#include "common/formatting.h"
+#include "common/threading.h"
+#include "strings/string_utils.h"
+
+namespace Profiler
+{
+struct ProfileZone
+{
+  const char *name;
+  uint64_t start;
+  uint64_t end;
+};
+
+// only ever written by the owning thread. The count is read when writing out the trace, which is
+// best-effort against threads that are still recording.
+struct ThreadZones
+{
+  static const uint32_t Capacity = 64 * 1024;
+
+  uint64_t threadID = 0;
+  volatile int64_t count = 0;
+  ProfileZone zones[Capacity];
+};
+
+static volatile bool enabled = false;
+static bool tlsAllocated = false;
+static uint64_t tlsSlot = 0;
+
+// profiling can be enabled while the library is still being initialised, so these are constructed
+// on first use rather than relying on static initialisation order.
+struct ProfilerThreads
+{
+  Threading::CriticalSection lock;
+  rdcarray<ThreadZones *> threads;
+};
+
+static ProfilerThreads &GetThreads()
+{
+  static ProfilerThreads threads;
+  return threads;
+}
+
+void SetEnabled(bool en)
+{
+  if(en && !tlsAllocated)
+  {
+    tlsSlot = Threading::AllocateTLSSlot();
+    tlsAllocated = true;
+  }
+
+  enabled = en;
+}
+
+bool IsEnabled()
+{
+  return enabled;
+}
+
+void RecordZone(const char *name, uint64_t startTick, uint64_t endTick)
+{
+  ThreadZones *zones = (ThreadZones *)Threading::GetTLSValue(tlsSlot);
+
+  if(zones == NULL)
+  {
+    zones = new ThreadZones;
+    zones->threadID = Threading::GetCurrentID();
+    Threading::SetTLSValue(tlsSlot, zones);
+
+    ProfilerThreads &threads = GetThreads();
+    SCOPED_LOCK(threads.lock);
+    threads.threads.push_back(zones);
+  }
+
+  ProfileZone &zone = zones->zones[zones->count % ThreadZones::Capacity];
+  zone.name = name;
+  zone.start = startTick;
+  zone.end = endTick;
+
+  zones->count++;
+}
+
+void Clear()
+{
+  ProfilerThreads &threads = GetThreads();
+  SCOPED_LOCK(threads.lock);
+  for(ThreadZones *zones : threads.threads)
+    zones->count = 0;
+}
+
+bool WriteChromeTrace(const rdcstr &filename)
+{
+  FILE *f = FileIO::fopen(filename.c_str(), "w");
+
+  if(!f)
+  {
+    RDCERR("Couldn't open '%s' to write profile trace", filename.c_str());
+    return false;
+  }
+
+  // ticks per millisecond, converted to microseconds for the trace
+  const double ticksToMicro = 1000.0 / Timing::GetTickFrequency();
+
+  rdcstr str = R"({
+  "displayTimeUnit": "ns",
+  "traceEvents": [)";
+
+  bool first = true;
+
+  {
+    ProfilerThreads &threads = GetThreads();
+    SCOPED_LOCK(threads.lock);
+
+    // pick a base so timestamps start near 0. Zones are recorded when they end, so the oldest
+    // zone in a buffer isn't necessarily the one that started first.
+    uint64_t base = ~0ULL;
+    for(ThreadZones *zones : threads.threads)
+    {
+      int64_t count = zones->count;
+      int64_t begin = RDCMAX(int64_t(0), count - int64_t(ThreadZones::Capacity));
+      for(int64_t i = begin; i < count; i++)
+        base = RDCMIN(base, zones->zones[i % ThreadZones::Capacity].start);
+    }
+
+    for(ThreadZones *zones : threads.threads)
+    {
+      int64_t count = zones->count;
+      int64_t begin = RDCMAX(int64_t(0), count - int64_t(ThreadZones::Capacity));
+
+      for(int64_t i = begin; i < count; i++)
+      {
+        const ProfileZone &zone = zones->zones[i % ThreadZones::Capacity];
+
+        if(!first)
+          str += ",";
+
+        first = false;
+
+        const char *fmt = R"(
+    { "name": "%s", "ph": "X", "ts": %.3f, "dur": %.3f, "pid": 1, "tid": %llu })";
+
+        str += StringFormat::Fmt(fmt, zone.name, double(zone.start - base) * ticksToMicro,
+            double(zone.end - zone.start) * ticksToMicro, zones->threadID);
+      }
+    }
+  }
+
+  str += "\n  ]\n}";
+
+  FileIO::fwrite(str.data(), 1, str.size(), f);
+
+  FileIO::fclose(f);
+
+  return true;
+}
+};
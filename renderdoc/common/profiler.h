@@ -0,0 +1,68 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019-2020 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#pragma once
+
+#include "os/os_specific.h"
+#include "common.h"
+
+// Lightweight self-profiling of RenderDoc's own work. Zones are only recorded while profiling is
+// enabled - otherwise a zone costs a single enabled check. Each thread records into its own ring
+// buffer so recording never takes a lock, and the most recent zones from every thread can be
+// written out as a Chrome trace that loads in chrome://tracing.
+namespace Profiler
+{
+void SetEnabled(bool enabled);
+bool IsEnabled();
+
+// name must be a string with static lifetime, it's stored by pointer
+void RecordZone(const char *name, uint64_t startTick, uint64_t endTick);
+
+// discard any recorded zones from all threads
+void Clear();
+
+bool WriteChromeTrace(const rdcstr &filename);
+};
+
+class ScopedProfileZone
+{
+public:
+  ScopedProfileZone(const char *name) : m_Name(name), m_Start(0)
+  {
+    if(Profiler::IsEnabled())
+      m_Start = Timing::GetTick();
+  }
+
+  ~ScopedProfileZone()
+  {
+    if(m_Start)
+      Profiler::RecordZone(m_Name, m_Start, Timing::GetTick());
+  }
+
+private:
+  const char *m_Name;
+  uint64_t m_Start;
+};
+
+#define RDCPROFILE_ZONE(name) ScopedProfileZone CONCAT(profileZone, __LINE__)(name);
@@ -22,166 +22,483 @@
  * THE SOFTWARE.
  ******************************************************************************/
 
+
 #pragma once
 
 #include <map>
+#include "3rdparty/zstd/xxhash.h"
 #include "common/common.h"
 #include "os/os_specific.h"
 
-template <typename ResultType, typename ShaderCallbacks>
-bool LoadShaderCache(const char *filename, const uint32_t magicNumber, const uint32_t versionNumber,
-                     std::map<uint32_t, ResultType> &resultCache, const ShaderCallbacks &callbacks)
+// hashes data into a 64-bit cache key. Calls can be chained by passing the previous key as the
+// seed.
+inline uint64_t ShaderCacheHash(const void *data, size_t length, uint64_t seed = 0)
 {
-  rdcstr shadercache = FileIO::GetAppFolderFilename(filename);
+  return XXH64(data, length, seed);
+}
 
-  FILE *f = FileIO::fopen(shadercache.c_str(), "rb");
+inline uint64_t ShaderCacheHash(const char *str, uint64_t seed = 0)
+{
+  if(str == NULL)
+    return seed;
+  return XXH64(str, strlen(str), seed);
+}
 
-  if(!f)
-    return false;
+// a cache key along with a second, differently seeded hash of the same data. Both are stored in
+// the index and an entry is only found when both match, so a collision in the 64-bit key misses
+// instead of returning another shader's data. Built up by chaining Hash() calls.
+struct ShaderCacheKey
+{
+  ShaderCacheKey() = default;
+  // a key that was hashed by the caller, with no separate check
+  explicit ShaderCacheKey(uint64_t k) : key(k), check(0) {}
 
-  FileIO::fseek64(f, 0, SEEK_END);
-  uint64_t cachelen = FileIO::ftell64(f);
-  FileIO::fseek64(f, 0, SEEK_SET);
+  ShaderCacheKey &Hash(const void *data, size_t length)
+  {
+    key = ShaderCacheHash(data, length, key);
+    check = ShaderCacheHash(data, length, check);
+    return *this;
+  }
 
-  bool ret = true;
+  ShaderCacheKey &Hash(const char *str)
+  {
+    key = ShaderCacheHash(str, key);
+    check = ShaderCacheHash(str, check);
+    return *this;
+  }
 
-  // header: magic number, file version, number of entries
-  if(cachelen < sizeof(uint32_t) * 3)
+  bool operator==(const ShaderCacheKey &o) const { return key == o.key && check == o.check; }
+  bool operator<(const ShaderCacheKey &o) const
   {
-    RDCERR("Invalid shader cache");
-    ret = false;
+    if(key != o.key)
+      return key < o.key;
+    return check < o.check;
   }
-  else
+
+  uint64_t key = 5381;
+  uint64_t check = 0x811c9dc5;
+};
+
+// The cache file layout is:
+//
+//   header - magic number, version number, format version, number of entries, index offset
+//   index  - {key, check, offset, length} for each entry
+//   blobs  - the data for each entry, at the offsets given in the index
+//
+// When written from scratch the index comes directly after the header, so loading only needs to
+// read the front of the file and map it - blobs are only touched when they're first looked up.
+// Saving new entries appends their blobs followed by a new index, then updates the header in place
+// so existing data is never rewritten. Once superseded indices and replaced blobs take up more than
+// half of the file it's compacted by writing it from scratch.
+static const uint32_t ShaderCacheFormatVersion = 3;
+
+struct ShaderCacheHeader
+{
+  uint32_t magicNumber;
+  uint32_t versionNumber;
+  uint32_t formatVersion;
+  uint32_t numEntries;
+  uint64_t indexOffset;
+};
+
+struct ShaderCacheIndexEntry
+{
+  uint64_t key;
+  uint64_t check;
+  uint64_t offset;
+  uint64_t length;
+};
+
+// ShaderCallbacks must provide:
+//
+//   bool Create(uint32_t size, const byte *data, ResultType *ret) const;
+//   void Destroy(ResultType result) const;
+//   uint32_t GetSize(ResultType result) const;
+//   const byte *GetData(ResultType result) const;
+template <typename ResultType, typename ShaderCallbacks>
+class ShaderCache
+{
+public:
+  ShaderCache(const char *filename, uint32_t magicNumber, uint32_t versionNumber,
+              const ShaderCallbacks &callbacks)
+      : m_Filename(filename), m_Magic(magicNumber), m_Version(versionNumber), m_Callbacks(callbacks)
   {
-    byte *cache = new byte[(size_t)cachelen];
-    FileIO::fread(cache, 1, (size_t)cachelen, f);
+  }
 
-    uint32_t *header = (uint32_t *)cache;
+  ~ShaderCache()
+  {
+    Unmap();
 
-    uint32_t fileMagic = header[0];
-    uint32_t fileVer = header[1];
+    for(auto it = m_Results.begin(); it != m_Results.end(); ++it)
+      m_Callbacks.Destroy(it->second);
+  }
+
+  // reads the index and maps the file, without creating any results. Returns false if the cache
+  // doesn't exist, is out of date or is invalid.
+  bool Load()
+  {
+    if(!Map())
+      return false;
 
-    if(fileMagic != magicNumber || fileVer != versionNumber)
+    if(m_FileSize < sizeof(ShaderCacheHeader))
     {
-      RDCDEBUG("Out of date or invalid shader cache magic: %d version: %d", fileMagic, fileVer);
-      ret = false;
+      RDCERR("Invalid shader cache");
+      Unmap();
+      return false;
     }
-    else
+
+    const byte *data = GetFileData();
+
+    ShaderCacheHeader header;
+    memcpy(&header, data, sizeof(header));
+
+    if(header.magicNumber != m_Magic || header.versionNumber != m_Version ||
+       header.formatVersion != ShaderCacheFormatVersion)
+    {
+      RDCDEBUG("Out of date or invalid shader cache magic: %d version: %d format: %d",
+               header.magicNumber, header.versionNumber, header.formatVersion);
+      Unmap();
+      return false;
+    }
+
+    const uint64_t indexSize = uint64_t(header.numEntries) * sizeof(ShaderCacheIndexEntry);
+
+    if(header.indexOffset < sizeof(ShaderCacheHeader) || header.indexOffset > m_FileSize ||
+       indexSize > m_FileSize - header.indexOffset)
+    {
+      RDCERR("Invalid shader cache - index of %u entries at %llu is outside the %llu byte file",
+             header.numEntries, header.indexOffset, m_FileSize);
+      Unmap();
+      return false;
+    }
+
+    const byte *index = data + header.indexOffset;
+
+    for(uint32_t i = 0; i < header.numEntries; i++)
+    {
+      ShaderCacheIndexEntry entry;
+      memcpy(&entry, index + i * sizeof(ShaderCacheIndexEntry), sizeof(entry));
+
+      if(entry.offset < sizeof(ShaderCacheHeader) || entry.offset > m_FileSize ||
+         entry.length > m_FileSize - entry.offset || entry.length > UINT32_MAX)
+      {
+        RDCERR("Invalid shader cache - entry %u of %llu bytes at %llu is outside the file", i,
+               entry.length, entry.offset);
+        m_Index.clear();
+        Unmap();
+        return false;
+      }
+
+      ShaderCacheKey key(entry.key);
+      key.check = entry.check;
+      m_Index[key] = entry;
+    }
+
+    m_Valid = true;
+
+    RDCDEBUG("Successfully loaded index of %u shaders from shader cache", header.numEntries);
+
+    return true;
+  }
+
+  // looks up an entry, creating the result from the file the first time it's accessed. The result
+  // remains owned by the cache. An entry stored under the same key with a different check hash
+  // isn't returned.
+  bool Find(uint64_t key, ResultType &result) { return Find(ShaderCacheKey(key), result); }
+  bool Find(const ShaderCacheKey &key, ResultType &result)
+  {
+    auto it = m_Results.find(key);
+    if(it != m_Results.end())
+    {
+      result = it->second;
+      return true;
+    }
+
+    auto idx = m_Index.find(key);
+    if(idx == m_Index.end() || GetFileData() == NULL)
+      return false;
+
+    const ShaderCacheIndexEntry &entry = idx->second;
+
+    ResultType created;
+    if(!m_Callbacks.Create((uint32_t)entry.length, GetFileData() + entry.offset, &created))
     {
-      uint32_t numentries = header[2];
+      RDCERR("Couldn't create blob of size %llu from shadercache", entry.length);
+      m_Index.erase(idx);
+      return false;
+    }
 
-      // assume at least 16 bytes for any cache entry. 8 bytes for hash and length, and 8 bytes
-      // data.
-      if(numentries > cachelen / 16LLU)
+    m_Results[key] = created;
+    result = created;
+    return true;
+  }
+
+  // adds or replaces an entry, taking ownership of the result. It will be written on the next Save
+  void Insert(uint64_t key, ResultType result) { Insert(ShaderCacheKey(key), result); }
+  void Insert(const ShaderCacheKey &key, ResultType result)
+  {
+    auto it = m_Results.find(key);
+    if(it != m_Results.end())
+      m_Callbacks.Destroy(it->second);
+
+    m_Results[key] = result;
+
+    if(!m_Pending.contains(key))
+      m_Pending.push_back(key);
+  }
+
+  size_t size() const
+  {
+    size_t ret = m_Index.size();
+    for(const ShaderCacheKey &key : m_Pending)
+      if(m_Index.find(key) == m_Index.end())
+        ret++;
+    return ret;
+  }
+
+  bool IsDirty() const { return !m_Pending.empty(); }
+  // the memory held by the results created so far, and by the file contents if they had to be read
+  // in rather than mapped
+  uint64_t GetMemoryUsage() const
+  {
+    uint64_t ret = m_FileData.size();
+    for(auto it = m_Results.begin(); it != m_Results.end(); ++it)
+      ret += m_Callbacks.GetSize(it->second);
+    return ret;
+  }
+
+  // destroys the results that were created from the file, which will be created again the next
+  // time they're looked up. Entries not yet saved are kept. Only valid if nothing still holds a
+  // result returned from Find.
+  void EvictResults()
+  {
+    for(auto it = m_Results.begin(); it != m_Results.end();)
+    {
+      if(m_Index.find(it->first) != m_Index.end() && !m_Pending.contains(it->first))
       {
-        RDCERR("Invalid shader cache - more entries %u than are feasible in a %llu byte cache",
-               numentries, cachelen);
-        ret = false;
+        m_Callbacks.Destroy(it->second);
+        it = m_Results.erase(it);
       }
       else
       {
-        byte *ptr = cache + sizeof(uint32_t) * 3;
-
-        int64_t bufsize = (int64_t)cachelen - sizeof(uint32_t) * 3;
-
-        for(uint32_t i = 0; i < numentries; i++)
-        {
-          if((size_t)bufsize < sizeof(uint32_t))
-          {
-            RDCERR("Invalid shader cache - truncated, not enough data for shader hash");
-            ret = false;
-            break;
-          }
-
-          uint32_t hash = *(uint32_t *)ptr;
-          ptr += sizeof(uint32_t);
-          bufsize -= sizeof(uint32_t);
-
-          if((size_t)bufsize < sizeof(uint32_t))
-          {
-            RDCERR("Invalid shader cache - truncated, not enough data for shader length");
-            ret = false;
-            break;
-          }
-
-          uint32_t len = *(uint32_t *)ptr;
-          ptr += sizeof(uint32_t);
-          bufsize -= sizeof(uint32_t);
-
-          if(bufsize < len)
-          {
-            RDCERR("Invalid shader cache - truncated, not enough data for shader buffer");
-            ret = false;
-            break;
-          }
-
-          byte *data = ptr;
-          ptr += len;
-          bufsize -= len;
-
-          ResultType result;
-          bool created = callbacks.Create(len, data, &result);
-
-          if(!created)
-          {
-            RDCERR("Couldn't create blob of size %u from shadercache", len);
-            ret = false;
-            break;
-          }
-
-          resultCache[hash] = result;
-        }
-
-        if(ret == true && bufsize != 0)
-        {
-          RDCERR("Invalid shader cache - trailing data");
-          ret = false;
-        }
-
-        RDCDEBUG("Successfully loaded %d shaders from shader cache", resultCache.size());
+        ++it;
       }
     }
+  }
+  // writes any new entries to disk. Entries that haven't been looked up yet can still be accessed
+  // afterwards, from the updated file.
+  void Save()
+  {
+    if(m_Pending.empty())
+      return;
+
+    // if the cache has been written by someone else since we loaded it, our index no longer
+    // matches the file and only what we have in memory can be saved.
+    if(m_Valid && FileIO::GetFileSize(FileIO::GetAppFolderFilename(m_Filename)) != m_FileSize)
+    {
+      RDCDEBUG("Shader cache changed on disk since it was loaded, rewriting");
+      Unmap();
+      m_Index.clear();
+      m_Valid = false;
+    }
+
+    // work out how much of the file would still be referenced after appending
+    uint64_t liveBytes = sizeof(ShaderCacheHeader);
+    for(auto it = m_Index.begin(); it != m_Index.end(); ++it)
+      if(!m_Pending.contains(it->first))
+        liveBytes += it->second.length + sizeof(ShaderCacheIndexEntry);
 
-    delete[] cache;
+    if(m_Valid && liveBytes * 2 >= m_FileSize)
+      Append();
+    else
+      Rewrite();
+
+    m_Pending.clear();
   }
 
-  FileIO::fclose(f);
+private:
+  const byte *GetFileData() const
+  {
+    if(m_View)
+      return m_View;
+    return m_FileData.empty() ? NULL : m_FileData.data();
+  }
 
-  return ret;
-}
+  // maps the whole file, or reads it all in if it can't be mapped. Results are still only created
+  // on demand.
+  bool Map()
+  {
+    rdcstr shadercache = FileIO::GetAppFolderFilename(m_Filename);
 
-template <typename ResultType, typename ShaderCallbacks>
-void SaveShaderCache(const char *filename, uint32_t magicNumber, uint32_t versionNumber,
-                     const std::map<uint32_t, ResultType> &cache, const ShaderCallbacks &callbacks)
-{
-  rdcstr shadercache = FileIO::GetAppFolderFilename(filename);
+    FILE *f = FileIO::fopen(shadercache.c_str(), "rb");
 
-  FILE *f = FileIO::fopen(shadercache.c_str(), "wb");
+    if(!f)
+      return false;
 
-  if(!f)
+    FileIO::fseek64(f, 0, SEEK_END);
+    m_FileSize = FileIO::ftell64(f);
+    FileIO::fseek64(f, 0, SEEK_SET);
+
+    if(m_FileSize > 0)
+    {
+      m_View = (const byte *)FileIO::MapFileRegion(f, 0, m_FileSize);
+
+      if(m_View == NULL)
+      {
+        m_FileData.resize((size_t)m_FileSize);
+        FileIO::fread(m_FileData.data(), 1, m_FileData.size(), f);
+      }
+    }
+
+    FileIO::fclose(f);
+
+    return true;
+  }
+
+  void Unmap()
   {
-    RDCERR("Error opening shader cache for write");
-    return;
+    if(m_View)
+      FileIO::UnmapFileRegion(m_View, m_FileSize);
+    m_View = NULL;
+    m_FileData.clear();
   }
 
-  FileIO::fwrite(&magicNumber, 1, sizeof(magicNumber), f);
-  FileIO::fwrite(&versionNumber, 1, sizeof(versionNumber), f);
-  uint32_t numentries = (uint32_t)cache.size();
-  FileIO::fwrite(&numentries, 1, sizeof(numentries), f);
+  void WriteIndex(FILE *f)
+  {
+    for(auto it = m_Index.begin(); it != m_Index.end(); ++it)
+      FileIO::fwrite(&it->second, 1, sizeof(ShaderCacheIndexEntry), f);
+  }
 
-  for(auto it = cache.begin(); it != cache.end(); ++it)
+  void Append()
   {
-    uint32_t hash = it->first;
-    uint32_t len = callbacks.GetSize(it->second);
-    const byte *data = callbacks.GetData(it->second);
-    FileIO::fwrite(&hash, 1, sizeof(hash), f);
-    FileIO::fwrite(&len, 1, sizeof(len), f);
-    FileIO::fwrite(data, 1, len, f);
+    // unmap before writing, some platforms don't allow modifying a file with a mapped view
+    Unmap();
+
+    rdcstr shadercache = FileIO::GetAppFolderFilename(m_Filename);
+
+    FILE *f = FileIO::fopen(shadercache.c_str(), "r+b");
+
+    if(!f)
+    {
+      RDCERR("Error opening shader cache for append");
+      Map();
+      return;
+    }
+
+    FileIO::fseek64(f, m_FileSize, SEEK_SET);
+
+    uint64_t offset = m_FileSize;
+
+    for(const ShaderCacheKey &key : m_Pending)
+    {
+      ResultType result = m_Results[key];
+
+      ShaderCacheIndexEntry &entry = m_Index[key];
+      entry.key = key.key;
+      entry.check = key.check;
+      entry.offset = offset;
+      entry.length = m_Callbacks.GetSize(result);
+
+      FileIO::fwrite(m_Callbacks.GetData(result), 1, (size_t)entry.length, f);
+      offset += entry.length;
+    }
+
+    ShaderCacheHeader header = {
+        m_Magic, m_Version, ShaderCacheFormatVersion, (uint32_t)m_Index.size(), offset,
+    };
+
+    WriteIndex(f);
+
+    m_FileSize = offset + m_Index.size() * sizeof(ShaderCacheIndexEntry);
+
+    // only point the header at the new index once everything else has been written
+    FileIO::fflush(f);
+    FileIO::fseek64(f, 0, SEEK_SET);
+    FileIO::fwrite(&header, 1, sizeof(header), f);
+
+    FileIO::fclose(f);
 
-    callbacks.Destroy(it->second);
+    // map the file again so entries that haven't been looked up yet can still be read, and so
+    // a later Rewrite() can bring them into memory before overwriting the file.
+    Map();
+
+    RDCDEBUG("Successfully appended %zu shaders to shader cache", m_Pending.size());
   }
 
-  FileIO::fclose(f);
+  void Rewrite()
+  {
+    // make sure every existing entry is in memory before the file is overwritten
+    for(auto it = m_Index.begin(); it != m_Index.end();)
+    {
+      // advance first, Find() removes entries that fail to be created
+      ShaderCacheKey key = (it++)->first;
+      ResultType result;
+      Find(key, result);
+    }
+
+    Unmap();
 
-  RDCDEBUG("Successfully wrote %u shaders to shader cache", numentries);
-}
+    rdcstr shadercache = FileIO::GetAppFolderFilename(m_Filename);
+
+    FILE *f = FileIO::fopen(shadercache.c_str(), "wb");
+
+    if(!f)
+    {
+      RDCERR("Error opening shader cache for write");
+      return;
+    }
+
+    m_Index.clear();
+
+    uint64_t offset =
+        sizeof(ShaderCacheHeader) + m_Results.size() * sizeof(ShaderCacheIndexEntry);
+
+    for(auto it = m_Results.begin(); it != m_Results.end(); ++it)
+    {
+      ShaderCacheIndexEntry &entry = m_Index[it->first];
+      entry.key = it->first.key;
+      entry.check = it->first.check;
+      entry.offset = offset;
+      entry.length = m_Callbacks.GetSize(it->second);
+      offset += entry.length;
+    }
+
+    ShaderCacheHeader header = {
+        m_Magic, m_Version, ShaderCacheFormatVersion, (uint32_t)m_Index.size(),
+        sizeof(ShaderCacheHeader),
+    };
+
+    FileIO::fwrite(&header, 1, sizeof(header), f);
+
+    WriteIndex(f);
+
+    for(auto it = m_Results.begin(); it != m_Results.end(); ++it)
+      FileIO::fwrite(m_Callbacks.GetData(it->second), 1, m_Callbacks.GetSize(it->second), f);
+
+    FileIO::fclose(f);
+
+    m_FileSize = offset;
+    m_Valid = true;
+
+    RDCDEBUG("Successfully wrote %zu shaders to shader cache", m_Index.size());
+  }
+
+  rdcstr m_Filename;
+  uint32_t m_Magic, m_Version;
+  const ShaderCallbacks &m_Callbacks;
+
+  // whether the file on disk is valid to be appended to
+  bool m_Valid = false;
+  uint64_t m_FileSize = 0;
+
+  // the file contents, either mapped or read in if mapping wasn't possible
+  const byte *m_View = NULL;
+  bytebuf m_FileData;
+
+  // the location of each entry in the file
+  std::map<ShaderCacheKey, ShaderCacheIndexEntry> m_Index;
+  // results that have been created from the file or inserted
+  std::map<ShaderCacheKey, ResultType> m_Results;
+  // keys inserted that need to be written on save
+  rdcarray<ShaderCacheKey> m_Pending;
+};
@@ -0,0 +1,302 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019-2020 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+
+#include "common/shader_cache.h"
+#include "os/os_specific.h"
+
+#if ENABLED(ENABLE_UNIT_TESTS)
+
+#include "3rdparty/catch/catch.hpp"
+
+struct TestBlobCallbacks
+{
+  bool Create(uint32_t size, const byte *data, bytebuf **ret) const
+  {
+    *ret = new bytebuf(data, size);
+    return true;
+  }
+
+  void Destroy(bytebuf *blob) const { delete blob; }
+  uint32_t GetSize(bytebuf *blob) const { return (uint32_t)blob->size(); }
+  const byte *GetData(bytebuf *blob) const { return blob->data(); }
+} TestCacheCallbacks;
+
+typedef ShaderCache<bytebuf *, TestBlobCallbacks> TestCache;
+
+static bytebuf *MakeBlob(const char *str)
+{
+  return new bytebuf((const byte *)str, strlen(str));
+}
+
+static rdcstr FindString(TestCache &cache, uint64_t key)
+{
+  bytebuf *blob = NULL;
+  if(!cache.Find(key, blob))
+    return "<missing>";
+  return rdcstr((const char *)blob->data(), blob->size());
+}
+
+TEST_CASE("Test shader cache", "[shadercache]")
+{
+  const char *filename = "unittest_shaders.cache";
+  const uint32_t magic = 0xf00dcafe;
+  const uint32_t version = 1;
+
+  rdcstr path = FileIO::GetAppFolderFilename(filename);
+  FileIO::Delete(path.c_str());
+
+  {
+    TestCache cache(filename, magic, version, TestCacheCallbacks);
+
+    CHECK_FALSE(cache.Load());
+
+    cache.Insert(1, MakeBlob("first"));
+    cache.Insert(2, MakeBlob("second"));
+
+    CHECK(cache.size() == 2);
+    CHECK(cache.IsDirty());
+
+    cache.Save();
+
+    CHECK_FALSE(cache.IsDirty());
+  }
+
+  const uint64_t initialSize = FileIO::GetFileSize(path);
+
+  CHECK(initialSize == sizeof(ShaderCacheHeader) + sizeof(ShaderCacheIndexEntry) * 2 + 11);
+
+  SECTION("Entries are read back on demand")
+  {
+    TestCache cache(filename, magic, version, TestCacheCallbacks);
+
+    REQUIRE(cache.Load());
+
+    CHECK(cache.size() == 2);
+    CHECK_FALSE(cache.IsDirty());
+
+    CHECK(FindString(cache, 2) == "second");
+    CHECK(FindString(cache, 1) == "first");
+    CHECK(FindString(cache, 3) == "<missing>");
+
+    // saving with nothing new doesn't touch the file
+    cache.Save();
+
+    CHECK(FileIO::GetFileSize(path) == initialSize);
+  }
+
+  SECTION("New entries are appended")
+  {
+    {
+      TestCache cache(filename, magic, version, TestCacheCallbacks);
+
+      REQUIRE(cache.Load());
+
+      cache.Insert(3, MakeBlob("third"));
+
+      CHECK(cache.size() == 3);
+
+      cache.Save();
+    }
+
+    // the new blob and a new index are added, nothing is rewritten
+    CHECK(FileIO::GetFileSize(path) == initialSize + 5 + sizeof(ShaderCacheIndexEntry) * 3);
+
+    TestCache cache(filename, magic, version, TestCacheCallbacks);
+
+    REQUIRE(cache.Load());
+
+    CHECK(cache.size() == 3);
+    CHECK(FindString(cache, 1) == "first");
+    CHECK(FindString(cache, 2) == "second");
+    CHECK(FindString(cache, 3) == "third");
+  }
+
+  SECTION("Entries not yet looked up survive appends and rewrites")
+  {
+    {
+      TestCache cache(filename, magic, version, TestCacheCallbacks);
+
+      REQUIRE(cache.Load());
+
+      cache.Insert(3, MakeBlob("third"));
+      cache.Save();
+
+      // still readable from the file after the append
+      CHECK(FindString(cache, 1) == "first");
+
+      // keep replacing the new entry in the same session until the file is compacted, which must
+      // not lose entry 2 that was never looked up
+      for(int i = 0; i < 8; i++)
+      {
+        cache.Insert(3, MakeBlob("replacement"));
+        cache.Save();
+      }
+
+      // at most double what the file is after compacting, with the third entry added
+      const uint64_t compactedSize = initialSize + 11 + sizeof(ShaderCacheIndexEntry);
+
+      CHECK(FileIO::GetFileSize(path) < compactedSize * 2);
+
+      CHECK(FindString(cache, 2) == "second");
+    }
+
+    TestCache cache(filename, magic, version, TestCacheCallbacks);
+
+    REQUIRE(cache.Load());
+
+    CHECK(cache.size() == 3);
+    CHECK(FindString(cache, 1) == "first");
+    CHECK(FindString(cache, 2) == "second");
+    CHECK(FindString(cache, 3) == "replacement");
+  }
+
+  SECTION("Results created from the file can be evicted")
+  {
+    TestCache cache(filename, magic, version, TestCacheCallbacks);
+
+    REQUIRE(cache.Load());
+
+    const uint64_t baseUsage = cache.GetMemoryUsage();
+
+    CHECK(FindString(cache, 1) == "first");
+    CHECK(FindString(cache, 2) == "second");
+    cache.Insert(3, MakeBlob("third"));
+
+    CHECK(cache.GetMemoryUsage() == baseUsage + 16);
+
+    // only the unsaved entry is kept
+    cache.EvictResults();
+
+    CHECK(cache.GetMemoryUsage() == baseUsage + 5);
+    CHECK(cache.IsDirty());
+
+    CHECK(FindString(cache, 1) == "first");
+    CHECK(FindString(cache, 2) == "second");
+    CHECK(FindString(cache, 3) == "third");
+  }
+
+  SECTION("Replaced entries are compacted away")
+  {
+    for(int i = 0; i < 8; i++)
+    {
+      TestCache cache(filename, magic, version, TestCacheCallbacks);
+
+      REQUIRE(cache.Load());
+
+      cache.Insert(1, MakeBlob("replacement"));
+
+      CHECK(cache.size() == 2);
+
+      cache.Save();
+    }
+
+    CHECK(FileIO::GetFileSize(path) < initialSize * 2);
+
+    TestCache cache(filename, magic, version, TestCacheCallbacks);
+
+    REQUIRE(cache.Load());
+
+    CHECK(cache.size() == 2);
+    CHECK(FindString(cache, 1) == "replacement");
+    CHECK(FindString(cache, 2) == "second");
+  }
+
+  SECTION("Entries are only found when the check hash matches")
+  {
+    ShaderCacheKey key;
+    key.Hash("shader source");
+
+    // same 64-bit key, different data
+    ShaderCacheKey collision = key;
+    collision.check++;
+
+    bytebuf *blob = NULL;
+
+    {
+      TestCache cache(filename, magic, version, TestCacheCallbacks);
+
+      REQUIRE(cache.Load());
+
+      cache.Insert(key, MakeBlob("checked"));
+
+      CHECK_FALSE(cache.Find(collision, blob));
+
+      cache.Save();
+    }
+
+    TestCache cache(filename, magic, version, TestCacheCallbacks);
+
+    REQUIRE(cache.Load());
+
+    CHECK_FALSE(cache.Find(collision, blob));
+    CHECK_FALSE(cache.Find(key.key, blob));
+
+    REQUIRE(cache.Find(key, blob));
+    CHECK(rdcstr((const char *)blob->data(), blob->size()) == "checked");
+  }
+
+  SECTION("Out of date caches are discarded")
+  {
+    {
+      TestCache cache(filename, magic, version + 1, TestCacheCallbacks);
+
+      CHECK_FALSE(cache.Load());
+      CHECK(cache.size() == 0);
+
+      cache.Insert(5, MakeBlob("fifth"));
+      cache.Save();
+    }
+
+    TestCache cache(filename, magic, version + 1, TestCacheCallbacks);
+
+    REQUIRE(cache.Load());
+
+    CHECK(cache.size() == 1);
+    CHECK(FindString(cache, 5) == "fifth");
+  }
+
+  SECTION("Invalid caches are rejected")
+  {
+    // point the index past the end of the file
+    FILE *f = FileIO::fopen(path.c_str(), "r+b");
+    REQUIRE(f);
+
+    ShaderCacheHeader header;
+    FileIO::fread(&header, 1, sizeof(header), f);
+    header.indexOffset = initialSize;
+    FileIO::fseek64(f, 0, SEEK_SET);
+    FileIO::fwrite(&header, 1, sizeof(header), f);
+    FileIO::fclose(f);
+
+    TestCache cache(filename, magic, version, TestCacheCallbacks);
+
+    CHECK_FALSE(cache.Load());
+    CHECK(cache.size() == 0);
+  }
+
+  FileIO::Delete(path.c_str());
+}
+
+#endif    // ENABLED(ENABLE_UNIT_TESTS)
@@ -0,0 +1,187 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019-2020 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+
+#include "common/temp_memory.h"
+
+static const size_t TempMemoryAlignment = 16;
+static const size_t TempMemoryFirstBlockSize = 64 * 1024;
+
+TempMemoryArena::~TempMemoryArena()
+{
+  for(Block &b : m_Blocks)
+    FreeAlignedBuffer(b.memory);
+}
+
+byte *TempMemoryArena::Alloc(size_t size)
+{
+  size = AlignUp(size, TempMemoryAlignment);
+
+  // use the current block if it fits, otherwise move on to the first later block that does. The
+  // rest of any block we skip stays unused until we're released back below it
+  for(; m_Block < m_Blocks.size(); m_Block++, m_Offset = 0)
+  {
+    if(m_Offset + size <= m_Blocks[m_Block].size)
+    {
+      byte *ret = m_Blocks[m_Block].memory + m_Offset;
+      m_Offset += size;
+      return ret;
+    }
+  }
+
+  // no block fits, add a new one at least double the size of the last
+  Block b;
+  b.size = m_Blocks.empty() ? TempMemoryFirstBlockSize : m_Blocks.back().size * 2;
+  while(b.size < size)
+    b.size *= 2;
+  b.memory = AllocAlignedBuffer(b.size, TempMemoryAlignment);
+
+  m_Blocks.push_back(b);
+  m_Block = m_Blocks.size() - 1;
+  m_Offset = size;
+
+  return b.memory;
+}
+
+size_t TempMemoryArena::GetReservedSize() const
+{
+  size_t ret = 0;
+  for(const Block &b : m_Blocks)
+    ret += b.size;
+  return ret;
+}
+
+ThreadTempMemory::~ThreadTempMemory()
+{
+  for(TempMemoryArena *arena : m_Arenas)
+    delete arena;
+}
+
+TempMemoryArena &ThreadTempMemory::GetArena()
+{
+  TempMemoryArena *arena = (TempMemoryArena *)Threading::GetTLSValue(m_TLSSlot);
+
+  if(arena == NULL)
+  {
+    arena = new TempMemoryArena;
+    Threading::SetTLSValue(m_TLSSlot, arena);
+
+    // save it for deletion on shutdown
+    SCOPED_LOCK(m_Lock);
+    m_Arenas.push_back(arena);
+  }
+
+  return *arena;
+}
+
+#if ENABLED(ENABLE_UNIT_TESTS)
+
+#include "3rdparty/catch/catch.hpp"
+
+TEST_CASE("Test temp memory arena", "[tempmemory]")
+{
+  SECTION("Allocations are aligned and don't overlap")
+  {
+    TempMemoryArena arena;
+
+    byte *a = arena.Alloc(3);
+    byte *b = arena.Alloc(100);
+    byte *c = arena.Alloc(16);
+
+    CHECK(((uintptr_t)a % TempMemoryAlignment) == 0);
+    CHECK(((uintptr_t)b % TempMemoryAlignment) == 0);
+    CHECK(((uintptr_t)c % TempMemoryAlignment) == 0);
+    CHECK(b >= a + 3);
+    CHECK(c >= b + 100);
+  };
+
+  SECTION("Releasing to a mark reuses memory")
+  {
+    TempMemoryArena arena;
+
+    byte *a = arena.Alloc(64);
+    TempMemoryArena::Mark mark = arena.GetMark();
+    byte *b = arena.Alloc(64);
+
+    arena.Release(mark);
+    CHECK(arena.Alloc(64) == b);
+
+    arena.Release({0, 0});
+    CHECK(arena.Alloc(64) == a);
+  };
+
+  SECTION("Growth keeps earlier allocations valid")
+  {
+    TempMemoryArena arena;
+
+    byte *small = arena.Alloc(16);
+    memset(small, 0x55, 16);
+
+    byte *big = arena.Alloc(TempMemoryFirstBlockSize * 3);
+    memset(big, 0xaa, TempMemoryFirstBlockSize * 3);
+
+    CHECK(small[0] == 0x55);
+    CHECK(small[15] == 0x55);
+    CHECK(arena.GetReservedSize() >= TempMemoryFirstBlockSize * 4);
+
+    // once grown, the same pattern of allocations doesn't need any more memory
+    size_t reserved = arena.GetReservedSize();
+    for(int i = 0; i < 10; i++)
+    {
+      arena.Release({0, 0});
+      arena.Alloc(16);
+      arena.Alloc(TempMemoryFirstBlockSize * 3);
+    }
+    CHECK(arena.GetReservedSize() == reserved);
+  };
+
+  SECTION("Scopes nest, and unscoped allocations restart")
+  {
+    ThreadTempMemory mem;
+
+    byte *a = mem.Alloc(32);
+    CHECK(mem.Alloc(32) == a);
+
+    {
+      TempMemoryScope outer(mem);
+
+      byte *b = mem.Alloc(32);
+      byte *c = mem.Alloc(32);
+      CHECK(b != c);
+
+      {
+        TempMemoryScope inner(mem);
+        byte *d = mem.Alloc(32);
+        CHECK(d != b);
+        CHECK(d != c);
+      }
+
+      CHECK(mem.Alloc(32) != b);
+    }
+
+    CHECK(mem.Alloc(32) == a);
+  };
+};
+
+#endif    // ENABLED(ENABLE_UNIT_TESTS)
@@ -0,0 +1,120 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019-2020 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+
+#pragma once
+
+#include "common/common.h"
+#include "common/threading.h"
+
+// A stack allocator for short-lived scratch memory, such as unwrapped copies of API structures.
+// Memory comes from blocks that grow geometrically and are kept until the arena is destroyed, so
+// once it has grown to fit the working set, allocating never touches the heap.
+class TempMemoryArena
+{
+public:
+  TempMemoryArena() = default;
+  ~TempMemoryArena();
+  TempMemoryArena(const TempMemoryArena &) = delete;
+  TempMemoryArena &operator=(const TempMemoryArena &) = delete;
+
+  struct Mark
+  {
+    size_t block;
+    size_t offset;
+  };
+
+  byte *Alloc(size_t size);
+
+  // releasing to a mark frees everything allocated since it was taken
+  Mark GetMark() const { return {m_Block, m_Offset}; }
+  void Release(Mark mark)
+  {
+    m_Block = mark.block;
+    m_Offset = mark.offset;
+  }
+
+  size_t GetReservedSize() const;
+
+  // the number of TempMemoryScopes currently open on this arena
+  int32_t scopeDepth = 0;
+
+private:
+  struct Block
+  {
+    byte *memory;
+    size_t size;
+  };
+
+  rdcarray<Block> m_Blocks;
+  size_t m_Block = 0;
+  size_t m_Offset = 0;
+};
+
+// a separate arena for each thread, to hold one driver's temporary memory
+class ThreadTempMemory
+{
+public:
+  ThreadTempMemory() : m_TLSSlot(Threading::AllocateTLSSlot()) {}
+  ~ThreadTempMemory();
+
+  TempMemoryArena &GetArena();
+
+  // Allocations inside a TempMemoryScope stay valid until the scope ends. With no scope open each
+  // allocation starts again from the bottom of the stack, so it's only valid until the next one.
+  byte *Alloc(size_t size)
+  {
+    TempMemoryArena &arena = GetArena();
+    if(arena.scopeDepth == 0)
+      arena.Release({0, 0});
+    return arena.Alloc(size);
+  }
+
+private:
+  uint64_t m_TLSSlot;
+  Threading::CriticalSection m_Lock;
+  rdcarray<TempMemoryArena *> m_Arenas;
+};
+
+// keeps all of the calling thread's temporary memory allocated within it valid until it's
+// destroyed, so that several allocations can be used together or nested
+class TempMemoryScope
+{
+public:
+  TempMemoryScope(ThreadTempMemory &mem) : m_Arena(mem.GetArena()), m_Mark(m_Arena.GetMark())
+  {
+    m_Arena.scopeDepth++;
+  }
+  ~TempMemoryScope()
+  {
+    m_Arena.scopeDepth--;
+    m_Arena.Release(m_Mark);
+  }
+  TempMemoryScope(const TempMemoryScope &) = delete;
+  TempMemoryScope &operator=(const TempMemoryScope &) = delete;
+
+private:
+  TempMemoryArena &m_Arena;
+  TempMemoryArena::Mark m_Mark;
+};
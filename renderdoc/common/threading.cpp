@@ -0,0 +1,316 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019-2020 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+
+#include "common/threading.h"
+#include <deque>
+
+namespace Threading
+{
+struct TaskScheduler::TaskQueue
+{
+  TaskQueue(TaskScheduler *o, uint32_t idx) : owner(o), index(idx) {}
+  TaskScheduler *owner;
+  uint32_t index;
+
+  SpinLock lock;
+  std::deque<Task> tasks;
+
+  void PushBack(Task &&task)
+  {
+    ScopedSpinLock scope(lock);
+    tasks.push_back(std::move(task));
+  }
+
+  bool PopBack(Task &task)
+  {
+    ScopedSpinLock scope(lock);
+    if(tasks.empty())
+      return false;
+    task = std::move(tasks.back());
+    tasks.pop_back();
+    return true;
+  }
+
+  bool PopFront(Task &task)
+  {
+    ScopedSpinLock scope(lock);
+    if(tasks.empty())
+      return false;
+    task = std::move(tasks.front());
+    tasks.pop_front();
+    return true;
+  }
+};
+
+// each worker thread stores its own queue here, so we can tell which worker (if any) we're on
+static uint64_t WorkerQueueSlot()
+{
+  static uint64_t slot = AllocateTLSSlot();
+  return slot;
+}
+
+static uint32_t SharedWorkerCount = ~0U;
+
+void TaskGroup::Run(std::function<void()> task)
+{
+  {
+    ScopedSpinLock scope(m_Lock);
+    Atomic::Inc32(&m_Pending);
+    m_Retiring = false;
+  }
+
+  m_Scheduler.Push(task, this);
+}
+
+void TaskGroup::Then(std::function<void()> continuation)
+{
+  {
+    ScopedSpinLock scope(m_Lock);
+
+    // a task that is retiring has already decided there's nothing to run after it, so only queue
+    // the continuation if something else will see it
+    if(Atomic::CmpExch32(&m_Pending, 0, 0) != 0 && !m_Retiring)
+    {
+      m_Continuations.push_back(continuation);
+      return;
+    }
+
+    Atomic::Inc32(&m_Pending);
+    m_Retiring = false;
+  }
+
+  // nothing is left to wait for, so the continuation can run straight away
+  m_Scheduler.Push(continuation, this);
+}
+
+void TaskGroup::Wait()
+{
+  while(!Done())
+  {
+    if(!m_Scheduler.RunOne())
+      Sleep(0);
+  }
+}
+
+void TaskGroup::TaskFinished()
+{
+  rdcarray<std::function<void()>> continuations;
+
+  {
+    ScopedSpinLock scope(m_Lock);
+
+    // if this is the last task, count the continuations before retiring it so the group is never
+    // seen as done in between.
+    if(Atomic::CmpExch32(&m_Pending, 0, 0) == 1)
+    {
+      if(m_Continuations.empty())
+        m_Retiring = true;
+
+      continuations.swap(m_Continuations);
+      for(size_t i = 0; i < continuations.size(); i++)
+        Atomic::Inc32(&m_Pending);
+    }
+  }
+
+  for(std::function<void()> &c : continuations)
+    m_Scheduler.Push(c, this);
+
+  // this must be the last thing we touch, as once the count reaches 0 a waiter can return and
+  // destroy the group
+  Atomic::Dec32(&m_Pending);
+}
+
+TaskScheduler::TaskScheduler(uint32_t numWorkers)
+{
+  for(uint32_t i = 0; i <= numWorkers; i++)
+    m_Queues.push_back(new TaskQueue(this, i));
+
+  for(uint32_t i = 0; i < numWorkers; i++)
+    m_Threads.push_back(CreateThread([this, i]() { WorkerLoop(i); }));
+}
+
+TaskScheduler::~TaskScheduler()
+{
+  while(RunOne())
+  {
+  }
+
+  m_Shutdown = 1;
+  for(size_t i = 0; i < m_Threads.size(); i++)
+    m_Available.Signal();
+
+  for(ThreadHandle t : m_Threads)
+  {
+    if(t == 0)
+      continue;
+
+    JoinThread(t);
+    CloseThread(t);
+  }
+
+  // anything pushed by the last running tasks
+  while(RunOne())
+  {
+  }
+
+  for(TaskQueue *q : m_Queues)
+    delete q;
+}
+
+TaskScheduler &TaskScheduler::Shared()
+{
+  // never destroyed, as the workers can't be safely joined while the module is unloading
+  static TaskScheduler *shared = new TaskScheduler(
+      SharedWorkerCount != ~0U ? SharedWorkerCount : RDCMAX(1U, NumberOfCores() - 1));
+  return *shared;
+}
+
+void TaskScheduler::SetSharedWorkerCount(uint32_t numWorkers)
+{
+  SharedWorkerCount = numWorkers;
+}
+
+void TaskScheduler::Push(std::function<void()> func, TaskGroup *group)
+{
+  Task task = {func, group};
+
+  if(m_Threads.empty())
+  {
+    Execute(task);
+    return;
+  }
+
+  int32_t worker = CurrentWorker();
+
+  if(worker >= 0)
+    m_Queues[worker]->PushBack(std::move(task));
+  else
+    m_Queues.back()->PushBack(std::move(task));
+
+  m_Available.Signal();
+}
+
+void TaskScheduler::Execute(Task &task)
+{
+  task.func();
+
+  if(task.group)
+    task.group->TaskFinished();
+}
+
+bool TaskScheduler::RunOne()
+{
+  Task task;
+  if(!PopTask(CurrentWorker(), task))
+    return false;
+
+  Execute(task);
+  return true;
+}
+
+bool TaskScheduler::PopTask(int32_t worker, Task &task)
+{
+  // newest first from our own queue, since its data is most likely still in cache
+  if(worker >= 0 && m_Queues[worker]->PopBack(task))
+    return true;
+
+  const uint32_t numWorkers = (uint32_t)m_Queues.size() - 1;
+
+  if(m_Queues[numWorkers]->PopFront(task))
+    return true;
+
+  // steal the oldest task from another worker, starting with our neighbour so that thieves
+  // spread out over the victims
+  uint32_t start = worker >= 0 ? uint32_t(worker + 1) : 0;
+  for(uint32_t i = 0; i < numWorkers; i++)
+  {
+    uint32_t victim = (start + i) % numWorkers;
+    if(int32_t(victim) != worker && m_Queues[victim]->PopFront(task))
+      return true;
+  }
+
+  return false;
+}
+
+int32_t TaskScheduler::CurrentWorker()
+{
+  TaskQueue *queue = (TaskQueue *)GetTLSValue(WorkerQueueSlot());
+  if(queue && queue->owner == this)
+    return (int32_t)queue->index;
+  return -1;
+}
+
+void TaskScheduler::WorkerLoop(uint32_t index)
+{
+  SetTLSValue(WorkerQueueSlot(), m_Queues[index]);
+
+  for(;;)
+  {
+    m_Available.Wait();
+
+    while(RunOne())
+    {
+    }
+
+    if(m_Shutdown)
+      return;
+  }
+}
+
+static LockStats *&LockStatsList()
+{
+  static LockStats *head = NULL;
+  return head;
+}
+
+static SpinLock &LockStatsListLock()
+{
+  static SpinLock lock;
+  return lock;
+}
+
+LockStats::LockStats(const char *n) : name(n)
+{
+  ScopedSpinLock scope(LockStatsListLock());
+  next = LockStatsList();
+  LockStatsList() = this;
+}
+
+void LogLockStats()
+{
+  ScopedSpinLock scope(LockStatsListLock());
+  for(LockStats *stats = LockStatsList(); stats; stats = stats->next)
+  {
+    if(stats->contended == 0)
+      continue;
+
+    int64_t acquired = stats->acquired, contended = stats->contended, parked = stats->parked;
+
+    RDCLOG("Lock '%s': %lld acquisitions, %lld contended (%.2f%%), %lld parked", stats->name,
+           acquired, contended, double(contended) * 100.0 / double(acquired > 0 ? acquired : 1),
+           parked);
+  }
+}
+};
@@ -26,32 +26,134 @@
 #pragma once
 
 #include "common/common.h"
+#include "common/overhead_counters.h"
 #include "os/os_specific.h"
 
 namespace Threading
 {
+// hint to the CPU that we're in a spin-wait loop
+inline void CpuRelax()
+{
+#if ENABLED(RDOC_WIN32)
+  YieldProcessor();
+#elif defined(__i386__) || defined(__x86_64__)
+  __builtin_ia32_pause();
+#elif defined(__arm__) || defined(__aarch64__)
+  asm volatile("yield");
+#endif
+}
+
+// contention counters for a lock. Declare one statically next to a hot lock and pass it to the
+// AdaptiveLock, and any contention is logged at shutdown by LogLockStats()
+struct LockStats
+{
+  LockStats(const char *n);
+
+  const char *name;
+  // number of times the lock was taken
+  volatile int64_t acquired = 0;
+  // number of times the lock was already held when we tried to take it
+  volatile int64_t contended = 0;
+  // number of times spinning didn't get the lock and we slept in the kernel
+  volatile int64_t parked = 0;
+
+  LockStats *next = NULL;
+};
+
+void LogLockStats();
+
+// a non-recursive lock for short hot critical sections. It spins briefly with backoff on
+// contention before sleeping on an OS mutex, so the uncontended case is a single atomic and
+// short waits never go to the kernel.
+class AdaptiveLock
+{
+public:
+  AdaptiveLock(LockStats *stats = NULL) : m_Stats(stats) {}
+  void Lock()
+  {
+    if(m_Mutex.Trylock())
+    {
+      if(m_Stats)
+        Atomic::Inc64(&m_Stats->acquired);
+      return;
+    }
+
+    if(m_Stats)
+      Atomic::Inc64(&m_Stats->contended);
+
+    RDCOVERHEAD_TIMER(OverheadCounter::LockWaitTicks);
+
+    for(uint32_t spins = 1; spins <= MaxSpins; spins *= 2)
+    {
+      for(uint32_t i = 0; i < spins; i++)
+        CpuRelax();
+
+      if(m_Mutex.Trylock())
+      {
+        if(m_Stats)
+          Atomic::Inc64(&m_Stats->acquired);
+        return;
+      }
+    }
+
+    if(m_Stats)
+      Atomic::Inc64(&m_Stats->parked);
+
+    m_Mutex.Lock();
+
+    if(m_Stats)
+      Atomic::Inc64(&m_Stats->acquired);
+  }
+  bool Trylock() { return m_Mutex.Trylock(); }
+  void Unlock() { m_Mutex.Unlock(); }
+private:
+  static const uint32_t MaxSpins = 64;
+
+  Mutex m_Mutex;
+  LockStats *m_Stats;
+};
+
 class ScopedLock
 {
 public:
   ScopedLock(CriticalSection *cs) : m_CS(cs)
   {
-    if(m_CS)
+    // only time the wait if another thread holds the lock
+    if(m_CS && !m_CS->Trylock())
+    {
+      RDCOVERHEAD_TIMER(OverheadCounter::LockWaitTicks);
       m_CS->Lock();
+    }
+  }
+  ScopedLock(AdaptiveLock *lock) : m_Adaptive(lock)
+  {
+    if(m_Adaptive)
+      m_Adaptive->Lock();
   }
   ~ScopedLock()
   {
     if(m_CS)
       m_CS->Unlock();
+    if(m_Adaptive)
+      m_Adaptive->Unlock();
   }
 
 private:
-  CriticalSection *m_CS;
+  CriticalSection *m_CS = NULL;
+  AdaptiveLock *m_Adaptive = NULL;
 };
 
 class ScopedReadLock
 {
 public:
-  ScopedReadLock(RWLock &rw) : m_RW(&rw) { m_RW->ReadLock(); }
+  ScopedReadLock(RWLock &rw) : m_RW(&rw)
+  {
+    if(!m_RW->TryReadlock())
+    {
+      RDCOVERHEAD_TIMER(OverheadCounter::LockWaitTicks);
+      m_RW->ReadLock();
+    }
+  }
   ~ScopedReadLock() { m_RW->ReadUnlock(); }
 private:
   RWLock *m_RW;
@@ -60,7 +162,14 @@ private:
 class ScopedWriteLock
 {
 public:
-  ScopedWriteLock(RWLock &rw) : m_RW(&rw) { m_RW->WriteLock(); }
+  ScopedWriteLock(RWLock &rw) : m_RW(&rw)
+  {
+    if(!m_RW->TryWritelock())
+    {
+      RDCOVERHEAD_TIMER(OverheadCounter::LockWaitTicks);
+      m_RW->WriteLock();
+    }
+  }
   ~ScopedWriteLock() { m_RW->WriteUnlock(); }
 private:
   RWLock *m_RW;
@@ -71,9 +180,20 @@ class SpinLock
 public:
   void Lock()
   {
+    uint32_t spins = 1;
     while(!Trylock())
     {
-      // spin!
+      // spin with exponential backoff, and yield our timeslice if the holder isn't letting go
+      if(spins <= 64)
+      {
+        for(uint32_t i = 0; i < spins; i++)
+          CpuRelax();
+        spins *= 2;
+      }
+      else
+      {
+        Threading::Sleep(0);
+      }
     }
   }
   bool Trylock() { return Atomic::CmpExch32(&val, 0, 1) == 0; }
@@ -110,6 +230,183 @@ public:
 private:
   SpinLock *m_Spin = NULL;
 };
+
+class TaskScheduler;
+
+// a set of tasks that can be waited on together. Continuations added with Then() are run once
+// every task in the group has finished, and count as part of the group themselves.
+class TaskGroup
+{
+public:
+  TaskGroup(TaskScheduler &scheduler) : m_Scheduler(scheduler) {}
+  ~TaskGroup() { Wait(); }
+  TaskGroup(const TaskGroup &) = delete;
+  TaskGroup &operator=(const TaskGroup &) = delete;
+
+  void Run(std::function<void()> task);
+  void Then(std::function<void()> continuation);
+
+  // runs tasks on the calling thread until the group (and its continuations) has finished
+  void Wait();
+  bool Done() { return Atomic::CmpExch32(&m_Pending, 0, 0) == 0; }
+private:
+  friend class TaskScheduler;
+
+  void TaskFinished();
+
+  TaskScheduler &m_Scheduler;
+  SpinLock m_Lock;
+  volatile int32_t m_Pending = 0;
+  // set while the last task is finishing with no continuations, until something new is run
+  bool m_Retiring = false;
+  rdcarray<std::function<void()>> m_Continuations;
+};
+
+// a work-stealing task scheduler. Each worker has its own deque, pushing and popping its own
+// tasks from the back so that work spawned by a task stays on the same thread. Idle workers steal
+// from the front of other deques. Tasks from threads outside the scheduler go into a shared queue.
+class TaskScheduler
+{
+public:
+  // with 0 workers, tasks run immediately on the thread that pushes them
+  TaskScheduler(uint32_t numWorkers);
+  ~TaskScheduler();
+  TaskScheduler(const TaskScheduler &) = delete;
+  TaskScheduler &operator=(const TaskScheduler &) = delete;
+
+  uint32_t NumWorkers() const { return (uint32_t)m_Threads.size(); }
+  // runs a task that nothing waits on
+  void Run(std::function<void()> task) { Push(task, NULL); }
+
+  // the scheduler shared by the whole library, created on first use. By default it has one
+  // worker per core, leaving one for the calling thread. SetSharedWorkerCount must be called
+  // before the first use to change that.
+  static TaskScheduler &Shared();
+  static void SetSharedWorkerCount(uint32_t numWorkers);
+
+private:
+  friend class TaskGroup;
+
+  struct Task
+  {
+    std::function<void()> func;
+    TaskGroup *group;
+  };
+  struct TaskQueue;
+
+  void Push(std::function<void()> func, TaskGroup *group);
+  void Execute(Task &task);
+  bool RunOne();
+  bool PopTask(int32_t worker, Task &task);
+  int32_t CurrentWorker();
+  void WorkerLoop(uint32_t index);
+
+  // one queue per worker, then the shared queue for everyone else
+  rdcarray<TaskQueue *> m_Queues;
+  rdcarray<ThreadHandle> m_Threads;
+  Semaphore m_Available;
+  volatile int32_t m_Shutdown = 0;
+};
+
+// runs func(i) for every i in [0, count), spread over at most numThreads threads including the
+// calling thread, using the shared task scheduler. Items are claimed one at a time so uneven work
+// balances out. Returns once every item has completed.
+inline void ParallelFor(uint32_t numThreads, uint32_t count, std::function<void(uint32_t)> func)
+{
+  TaskScheduler &scheduler = TaskScheduler::Shared();
+
+  numThreads = RDCMIN(numThreads, count);
+  numThreads = RDCMIN(numThreads, scheduler.NumWorkers() + 1);
+
+  if(numThreads <= 1)
+  {
+    for(uint32_t i = 0; i < count; i++)
+      func(i);
+    return;
+  }
+
+  volatile int32_t next = -1;
+
+  std::function<void()> worker = [&next, count, &func]() {
+    for(int32_t i = Atomic::Inc32(&next); i < (int32_t)count; i = Atomic::Inc32(&next))
+      func((uint32_t)i);
+  };
+
+  TaskGroup group(scheduler);
+
+  for(uint32_t i = 0; i < numThreads - 1; i++)
+    group.Run(worker);
+
+  worker();
+
+  // any worker task that hasn't started yet finds nothing left, or is run here while waiting
+  group.Wait();
+}
+
+// runs jobs on the shared task scheduler in the order they were pushed, with at most numThreads
+// running at once. Wait() helps run jobs on the calling thread, and returns once every job pushed
+// so far has completed.
+class JobQueue
+{
+public:
+  JobQueue(uint32_t numThreads)
+      : m_Group(TaskScheduler::Shared()), m_MaxRunning(RDCMAX(1U, numThreads))
+  {
+  }
+
+  ~JobQueue() { Wait(); }
+  JobQueue(const JobQueue &) = delete;
+  JobQueue &operator=(const JobQueue &) = delete;
+
+  void Push(std::function<void()> job)
+  {
+    {
+      ScopedSpinLock scope(m_Lock);
+      m_Jobs.push_back(job);
+
+      if(m_Running >= m_MaxRunning)
+        return;
+
+      m_Running++;
+    }
+
+    m_Group.Run([this]() { Drain(); });
+  }
+
+  void Wait() { m_Group.Wait(); }
+private:
+  // runs jobs until the queue is empty. Only m_MaxRunning of these are ever scheduled at once.
+  void Drain()
+  {
+    for(;;)
+    {
+      std::function<void()> job;
+      {
+        ScopedSpinLock scope(m_Lock);
+        if(m_Next >= m_Jobs.size())
+        {
+          m_Jobs.clear();
+          m_Next = 0;
+          m_Running--;
+          return;
+        }
+
+        job = m_Jobs[m_Next];
+        m_Jobs[m_Next] = std::function<void()>();
+        m_Next++;
+      }
+
+      job();
+    }
+  }
+
+  TaskGroup m_Group;
+  SpinLock m_Lock;
+  rdcarray<std::function<void()>> m_Jobs;
+  size_t m_Next = 0;
+  uint32_t m_Running = 0;
+  uint32_t m_MaxRunning;
+};
 };
 
 #define SCOPED_LOCK(cs) Threading::ScopedLock CONCAT(scopedlock, __LINE__)(&cs);
@@ -23,6 +23,7 @@
  ******************************************************************************/
 
 #include "common/threading.h"
+#include "common/timing.h"
 #include "os/os_specific.h"
 
 #if ENABLED(ENABLE_UNIT_TESTS)
@@ -71,4 +72,338 @@ TEST_CASE("Test spin lock", "[threading]")
   CHECK(finalValue == value);
 }
 
+TEST_CASE("Test mutex and adaptive lock", "[threading]")
+{
+  SECTION("Mutex")
+  {
+    Threading::Mutex lock;
+
+    CHECK(lock.Trylock());
+    CHECK_FALSE(lock.Trylock());
+    lock.Unlock();
+
+    int counter = 0;
+
+    rdcarray<Threading::ThreadHandle> threads;
+    for(int i = 0; i < 8; i++)
+    {
+      threads.push_back(Threading::CreateThread([&lock, &counter]() {
+        for(int c = 0; c < 10000; c++)
+        {
+          lock.Lock();
+          counter++;
+          lock.Unlock();
+        }
+      }));
+    }
+
+    for(Threading::ThreadHandle t : threads)
+    {
+      Threading::JoinThread(t);
+      Threading::CloseThread(t);
+    }
+
+    CHECK(counter == 80000);
+  };
+
+  SECTION("Adaptive lock")
+  {
+    static Threading::LockStats stats("Test adaptive lock");
+    stats.acquired = stats.contended = stats.parked = 0;
+
+    Threading::AdaptiveLock lock(&stats);
+
+    int counter = 0;
+
+    rdcarray<Threading::ThreadHandle> threads;
+    for(int i = 0; i < 8; i++)
+    {
+      threads.push_back(Threading::CreateThread([&lock, &counter]() {
+        for(int c = 0; c < 10000; c++)
+        {
+          SCOPED_LOCK(lock);
+          counter++;
+        }
+      }));
+    }
+
+    for(Threading::ThreadHandle t : threads)
+    {
+      Threading::JoinThread(t);
+      Threading::CloseThread(t);
+    }
+
+    CHECK(counter == 80000);
+    CHECK(stats.acquired == 80000);
+    CHECK(stats.contended <= stats.acquired);
+    CHECK(stats.parked <= stats.contended);
+
+    // while held, trylock fails and doesn't count an acquisition
+    lock.Lock();
+    CHECK_FALSE(lock.Trylock());
+    lock.Unlock();
+    CHECK(stats.acquired == 80001);
+  };
+};
+
+TEST_CASE("Test job queue", "[threading]")
+{
+  Threading::JobQueue jobs(4);
+
+  volatile int32_t counter = 0;
+  rdcarray<int> results;
+  results.resize(1000);
+
+  for(int i = 0; i < 1000; i++)
+  {
+    jobs.Push([&counter, &results, i]() {
+      results[i] = i * 2;
+      Atomic::Inc32(&counter);
+    });
+  }
+
+  jobs.Wait();
+
+  CHECK(counter == 1000);
+
+  for(int i = 0; i < 1000; i++)
+    CHECK(results[i] == i * 2);
+
+  // the queue is reusable after waiting
+  jobs.Push([&counter]() { Atomic::Inc32(&counter); });
+  jobs.Wait();
+
+  CHECK(counter == 1001);
+
+  // no more than the requested number of jobs run at once
+  Threading::JobQueue narrow(2);
+
+  volatile int32_t running = 0;
+  volatile int32_t maxRunning = 0;
+
+  for(int i = 0; i < 100; i++)
+  {
+    narrow.Push([&running, &maxRunning]() {
+      int32_t now = Atomic::Inc32(&running);
+      int32_t prev = Atomic::CmpExch32(&maxRunning, 0, 0);
+      while(now > prev && Atomic::CmpExch32(&maxRunning, prev, now) != prev)
+        prev = Atomic::CmpExch32(&maxRunning, 0, 0);
+      Threading::Sleep(0);
+      Atomic::Dec32(&running);
+    });
+  }
+
+  narrow.Wait();
+
+  CHECK(maxRunning >= 1);
+  CHECK(maxRunning <= 2);
+}
+
+TEST_CASE("Test parallel for", "[threading]")
+{
+  rdcarray<int> results;
+  results.resize(1000);
+
+  Threading::ParallelFor(8, 1000, [&results](uint32_t i) { results[i] = int(i) * 3; });
+
+  for(int i = 0; i < 1000; i++)
+    CHECK(results[i] == i * 3);
+
+  // nested inside a scheduler task, the waiting thread helps rather than blocking a worker
+  volatile int32_t counter = 0;
+  Threading::ParallelFor(4, 16, [&counter](uint32_t) {
+    Threading::ParallelFor(4, 16, [&counter](uint32_t) { Atomic::Inc32(&counter); });
+  });
+
+  CHECK(counter == 256);
+}
+
+// counts the nodes of a binary tree of the given depth, spawning a task per node
+static void SpawnTree(Threading::TaskGroup &group, uint32_t depth, volatile int32_t *nodes)
+{
+  Atomic::Inc32(nodes);
+
+  if(depth == 0)
+    return;
+
+  group.Run([&group, depth, nodes]() { SpawnTree(group, depth - 1, nodes); });
+  group.Run([&group, depth, nodes]() { SpawnTree(group, depth - 1, nodes); });
+}
+
+TEST_CASE("Test task scheduler", "[threading]")
+{
+  SECTION("Tasks in a group all complete before Wait returns")
+  {
+    Threading::TaskScheduler scheduler(4);
+    Threading::TaskGroup group(scheduler);
+
+    rdcarray<int> results;
+    results.resize(1000);
+
+    for(int i = 0; i < 1000; i++)
+      group.Run([&results, i]() { results[i] = i * 2; });
+
+    group.Wait();
+
+    CHECK(group.Done());
+
+    for(int i = 0; i < 1000; i++)
+      CHECK(results[i] == i * 2);
+  };
+
+  SECTION("Tasks spawned from tasks are counted in the group")
+  {
+    Threading::TaskScheduler scheduler(4);
+    Threading::TaskGroup group(scheduler);
+
+    volatile int32_t nodes = 0;
+
+    group.Run([&group, &nodes]() { SpawnTree(group, 10, &nodes); });
+    group.Wait();
+
+    CHECK(nodes == (1 << 11) - 1);
+  };
+
+  SECTION("Continuations run after the group's tasks")
+  {
+    Threading::TaskScheduler scheduler(4);
+    Threading::TaskGroup group(scheduler);
+
+    volatile int32_t counter = 0;
+    int32_t seenByContinuation = -1;
+    int32_t seenByChained = -1;
+
+    for(int i = 0; i < 100; i++)
+      group.Run([&counter]() {
+        Threading::Sleep(0);
+        Atomic::Inc32(&counter);
+      });
+
+    group.Then([&group, &counter, &seenByContinuation, &seenByChained]() {
+      seenByContinuation = Atomic::CmpExch32(&counter, 0, 0);
+
+      // a continuation adding to the group keeps it alive until the new work has run
+      group.Run([&counter]() { Atomic::Inc32(&counter); });
+      group.Then([&counter, &seenByChained]() {
+        seenByChained = Atomic::CmpExch32(&counter, 0, 0);
+      });
+    });
+
+    group.Wait();
+
+    CHECK(seenByContinuation == 100);
+    CHECK(seenByChained == 101);
+
+    // a continuation on a finished group runs immediately
+    bool ran = false;
+    group.Then([&ran]() { ran = true; });
+    group.Wait();
+
+    CHECK(ran);
+  };
+
+  SECTION("A group can be destroyed as soon as it is done")
+  {
+    Threading::TaskScheduler scheduler(4);
+
+    volatile int32_t counter = 0;
+
+    for(int i = 0; i < 2000; i++)
+    {
+      Threading::TaskGroup *group = new Threading::TaskGroup(scheduler);
+      group->Run([&counter]() { Atomic::Inc32(&counter); });
+      group->Run([&counter]() { Atomic::Inc32(&counter); });
+      group->Wait();
+      delete group;
+    }
+
+    CHECK(counter == 4000);
+  };
+
+  SECTION("A continuation added while the last task finishes still runs")
+  {
+    Threading::TaskScheduler scheduler(2);
+
+    for(int i = 0; i < 2000; i++)
+    {
+      Threading::TaskGroup group(scheduler);
+      volatile int32_t ran = 0;
+
+      group.Run([]() {});
+      group.Then([&ran]() { Atomic::Inc32(&ran); });
+      group.Wait();
+
+      CHECK(ran == 1);
+    }
+  };
+
+  SECTION("No workers runs tasks inline")
+  {
+    Threading::TaskScheduler scheduler(0);
+    Threading::TaskGroup group(scheduler);
+
+    CHECK(scheduler.NumWorkers() == 0);
+
+    int value = 0;
+    group.Run([&value]() { value = 5; });
+
+    CHECK(value == 5);
+    CHECK(group.Done());
+  };
+
+  SECTION("Destroying the scheduler runs outstanding tasks")
+  {
+    volatile int32_t counter = 0;
+
+    {
+      Threading::TaskScheduler scheduler(2);
+
+      for(int i = 0; i < 100; i++)
+        scheduler.Run([&counter]() { Atomic::Inc32(&counter); });
+    }
+
+    CHECK(counter == 100);
+  };
+
+  SECTION("Task scheduler benchmark")
+  {
+    const uint32_t numWorkers = RDCMAX(1U, Threading::NumberOfCores() - 1);
+    const int numTasks = 100000;
+
+    volatile int32_t counter = 0;
+
+    PerformanceTimer timer;
+
+    {
+      Threading::JobQueue jobs(numWorkers);
+      for(int i = 0; i < numTasks; i++)
+        jobs.Push([&counter]() { Atomic::Inc32(&counter); });
+      jobs.Wait();
+    }
+
+    double jobQueueTime = timer.GetMilliseconds();
+
+    timer.Restart();
+
+    {
+      Threading::TaskScheduler scheduler(numWorkers);
+      Threading::TaskGroup group(scheduler);
+
+      // spawn from inside a task so the work is split between worker deques and stolen
+      group.Run([&group, &counter]() {
+        for(int i = 0; i < numTasks; i++)
+          group.Run([&counter]() { Atomic::Inc32(&counter); });
+      });
+      group.Wait();
+    }
+
+    double schedulerTime = timer.GetMilliseconds();
+
+    CHECK(counter == numTasks * 2);
+
+    RDCLOG("%d tiny tasks on %u workers: job queue %.2f ms, task scheduler %.2f ms", numTasks,
+           numWorkers, jobQueueTime, schedulerTime);
+  };
+};
+
 #endif    // ENABLED(ENABLE_UNIT_TESTS)
@@ -27,7 +27,9 @@
 
 #include <stdint.h>
 #include <string.h>
+#include <atomic>
 #include "common.h"
+#include "overhead_counters.h"
 #include "threading.h"
 
 #define INCLUDE_TYPE_NAMES RDOC_DEVEL
@@ -55,38 +57,36 @@ class WrappingPool
 public:
   void *Allocate()
   {
-    SCOPED_LOCK(m_Lock);
-
-    // try and allocate from immediate pool
-    void *ret = m_ImmediatePool.Allocate();
-    if(ret != NULL)
-      return ret;
+    void *ret = NULL;
 
-    // fall back to additional pools, if there are any
-    for(size_t i = 0; i < m_AdditionalPools.size(); i++)
+    if(ThreadCacheSize > 0)
     {
-      ret = m_AdditionalPools[i]->Allocate();
-      if(ret != NULL)
-        return ret;
-    }
+      // the common case takes a free slot cached for this thread, only locking the cache itself
+      ThreadCache *cache = GetThreadCache();
+      Threading::ScopedSpinLock scope(cache->lock);
 
-// warn when we need to allocate an additional pool
-#if ENABLED(INCLUDE_TYPE_NAMES)
-    RDCWARN("Ran out of free slots in %s pool!", GetTypeName<WrapType>::Name());
-#else
-    RDCWARN("Ran out of free slots in pool 0x%p!", &m_ImmediatePool.items[0]);
-#endif
+      if(cache->count == 0)
+      {
+        SCOPED_LOCK(m_Lock);
 
-    // allocate a new additional pool and use that to allocate from
-    m_AdditionalPools.push_back(new ItemPool());
+        // refill half the cache at once, so bulk creation on one thread only locks occasionally
+        while(cache->count < ThreadCacheSize / 2)
+          cache->items[cache->count++] = AllocateLocked();
+      }
 
-#if ENABLED(INCLUDE_TYPE_NAMES)
-    RDCDEBUG("WrappingPool[%d]<%s>: %p -> %p", (uint32_t)m_AdditionalPools.size() - 1,
-             GetTypeName<WrapType>::Name(), &m_AdditionalPools.back()->items[0],
-             &m_AdditionalPools.back()->items[AllocCount - 1]);
+      ret = cache->items[--cache->count];
+    }
+    else
+    {
+      SCOPED_LOCK(m_Lock);
+      ret = AllocateLocked();
+    }
+
+#if ENABLED(RDOC_DEVEL)
+    memset(ret, 0xb0, AllocByteSize);
 #endif
 
-    return m_AdditionalPools.back()->Allocate();
+    return ret;
   }
 
   bool IsAlloc(const void *p)
@@ -95,13 +95,16 @@ public:
     if(m_ImmediatePool.IsAlloc(p))
       return true;
 
-    // if we have additional pools, lock and check them.
-    // TODO: Check for additional pools in a lock-free manner,
-    // to prevent the cost of locking if there are no more pools.
+    // additional pools are looked up by address, lock-free
+    if(FindPool(p) != NULL)
+      return true;
+
+    // only pools that didn't fit in the lookup table need the lock
+    if(m_OverflowPoolCount.load(std::memory_order_acquire) > 0)
     {
       SCOPED_LOCK(m_Lock);
 
-      for(size_t i = 0; i < m_AdditionalPools.size(); i++)
+      for(size_t i = MaxTablePools; i < m_AdditionalPools.size(); i++)
         if(m_AdditionalPools[i]->IsAlloc(p))
           return true;
     }
@@ -114,35 +117,66 @@ public:
     if(p == NULL)
       return;
 
-    SCOPED_LOCK(m_Lock);
-
-    // try immediate pool
-    if(m_ImmediatePool.IsAlloc(p))
+    if(!IsAlloc(p))
     {
-      m_ImmediatePool.Deallocate(p);
+// this is an error - deleting an object that we don't recognise
+#if ENABLED(INCLUDE_TYPE_NAMES)
+      RDCERR("Resource being deleted through wrong pool - 0x%p not a member of %s", p,
+             GetTypeName<WrapType>::Name());
+#else
+      RDCERR("Resource being deleted through wrong pool - 0x%p not a member of 0x%p", p,
+             &m_ImmediatePool.items[0]);
+#endif
       return;
     }
-    else if(!m_AdditionalPools.empty())
+
+#if ENABLED(RDOC_DEVEL)
+    if(DebugClear)
+      memset(p, 0xfe, AllocByteSize);
+#endif
+
+    if(ThreadCacheSize > 0)
     {
-      // fall back and try additional pools
-      for(size_t i = 0; i < m_AdditionalPools.size(); i++)
+      ThreadCache *cache = GetThreadCache();
+      Threading::ScopedSpinLock scope(cache->lock);
+
+      if(cache->count == ThreadCacheSize)
       {
-        if(m_AdditionalPools[i]->IsAlloc(p))
-        {
-          m_AdditionalPools[i]->Deallocate(p);
-          return;
-        }
+        SCOPED_LOCK(m_Lock);
+
+        // return the older half of the cache to the pools, keeping the most recently freed
+        const int keep = ThreadCacheSize / 2;
+        for(int i = 0; i < ThreadCacheSize - keep; i++)
+          DeallocateLocked(cache->items[i]);
+
+        memmove(&cache->items[0], &cache->items[ThreadCacheSize - keep], keep * sizeof(void *));
+        cache->count = keep;
       }
+
+      cache->items[cache->count++] = p;
     }
+    else
+    {
+      SCOPED_LOCK(m_Lock);
+      DeallocateLocked(p);
+    }
+  }
 
-// this is an error - deleting an object that we don't recognise
-#if ENABLED(INCLUDE_TYPE_NAMES)
-    RDCERR("Resource being deleted through wrong pool - 0x%p not a member of %s", p,
-           GetTypeName<WrapType>::Name());
-#else
-    RDCERR("Resource being deleted through wrong pool - 0x%p not a member of 0x%p", p,
-           &m_ImmediatePool.items[0]);
-#endif
+  // the number of objects currently allocated. Slots held in the thread caches count as free.
+  // This is only approximate while other threads are allocating, since the caches aren't locked
+  size_t GetLiveCount()
+  {
+    SCOPED_LOCK(m_Lock);
+
+    size_t allocated = m_ImmediatePool.NumAllocated();
+    for(size_t i = 0; i < m_AdditionalPools.size(); i++)
+      allocated += m_AdditionalPools[i]->NumAllocated();
+
+    size_t cached = 0;
+    for(int i = 0; m_ThreadCaches && i < NumThreadCaches; i++)
+      cached += m_ThreadCaches[i].count;
+
+    return allocated > cached ? allocated - cached : 0;
   }
 
   static const size_t AllocCount = PoolCount;
@@ -150,8 +184,19 @@ public:
   static const size_t AllocByteSize;
 
 private:
-  WrappingPool()
+  WrappingPool(const char *name)
   {
+    if(ThreadCacheSize > 0)
+    {
+      m_CacheSlot = Threading::AllocateTLSSlot();
+      m_ThreadCaches = new ThreadCache[NumThreadCaches];
+    }
+
+    OverheadCounters::RegisterPool(this, name, &GetLiveCountCallback);
+
+    while((size_t(1) << m_BucketShift) < AllocCount * AllocByteSize)
+      m_BucketShift++;
+
 #if ENABLED(INCLUDE_TYPE_NAMES)
     // hack - print in kB because float printing relies on statics that might not be initialised
     // yet in loading order. Ugly :(
@@ -162,10 +207,195 @@ private:
   }
   ~WrappingPool()
   {
+    OverheadCounters::UnregisterPool(this);
+
     for(size_t i = 0; i < m_AdditionalPools.size(); i++)
       delete m_AdditionalPools[i];
 
     m_AdditionalPools.clear();
+
+    delete[] m_ThreadCaches;
+
+    delete[] m_Table.load();
+  }
+
+  static size_t GetLiveCountCallback(void *pool) { return ((WrappingPool *)pool)->GetLiveCount(); }
+
+  // pools for objects that are only ever created a handful of times don't cache per-thread, since
+  // a cache could hold more slots than the pool has and force an additional pool for no reason.
+  static const int ThreadCacheSize = PoolCount >= 1024 ? 32 : 0;
+
+  // there's a fixed set of caches that threads are assigned to round-robin on first use, rather
+  // than one per thread. We aren't told when threads exit, so this keeps the caches bounded and
+  // lets new threads pick up the slots cached by threads that are gone. Each cache has its own
+  // lock, which is uncontended unless more threads than this are allocating at once.
+  static const int NumThreadCaches = 16;
+
+  struct ThreadCache
+  {
+    Threading::SpinLock lock;
+    int count = 0;
+    void *items[ThreadCacheSize > 0 ? ThreadCacheSize : 1];
+  };
+
+  ThreadCache *GetThreadCache()
+  {
+    // the TLS value is the index of this thread's cache plus one, so that 0 means unassigned
+    uintptr_t idx = (uintptr_t)Threading::GetTLSValue(m_CacheSlot);
+
+    if(idx == 0)
+    {
+      idx = uintptr_t(uint32_t(Atomic::Inc32(&m_NextThreadCache)) % NumThreadCaches) + 1;
+      Threading::SetTLSValue(m_CacheSlot, (void *)idx);
+    }
+
+    return &m_ThreadCaches[idx - 1];
+  }
+
+  struct ItemPool;
+
+  void *AllocateLocked()
+  {
+    // try and allocate from immediate pool
+    void *ret = m_ImmediatePool.Allocate();
+    if(ret != NULL)
+      return ret;
+
+    // fall back to additional pools, starting with the one we last allocated from
+    if(m_AllocPool < m_AdditionalPools.size())
+    {
+      ret = m_AdditionalPools[m_AllocPool]->Allocate();
+      if(ret != NULL)
+        return ret;
+    }
+
+    for(size_t i = 0; i < m_AdditionalPools.size(); i++)
+    {
+      ret = m_AdditionalPools[i]->Allocate();
+      if(ret != NULL)
+      {
+        m_AllocPool = i;
+        return ret;
+      }
+    }
+
+// warn when we need to allocate an additional pool
+#if ENABLED(INCLUDE_TYPE_NAMES)
+    RDCWARN("Ran out of free slots in %s pool!", GetTypeName<WrapType>::Name());
+#else
+    RDCWARN("Ran out of free slots in pool 0x%p!", &m_ImmediatePool.items[0]);
+#endif
+
+    // allocate a new additional pool and use that to allocate from
+    m_AdditionalPools.push_back(new ItemPool());
+
+#if ENABLED(INCLUDE_TYPE_NAMES)
+    RDCDEBUG("WrappingPool[%d]<%s>: %p -> %p", (uint32_t)m_AdditionalPools.size() - 1,
+             GetTypeName<WrapType>::Name(), &m_AdditionalPools.back()->items[0],
+             &m_AdditionalPools.back()->items[AllocCount - 1]);
+#endif
+
+    m_AllocPool = m_AdditionalPools.size() - 1;
+
+    if(m_AllocPool < MaxTablePools)
+      InsertPool(m_AdditionalPools.back());
+    else
+      m_OverflowPoolCount.fetch_add(1, std::memory_order_release);
+
+    return m_AdditionalPools.back()->Allocate();
+  }
+
+  void DeallocateLocked(void *p)
+  {
+    if(m_ImmediatePool.IsAlloc(p))
+    {
+      m_ImmediatePool.Deallocate(p);
+      return;
+    }
+
+    ItemPool *pool = FindPool(p);
+
+    for(size_t i = MaxTablePools; pool == NULL && i < m_AdditionalPools.size(); i++)
+      if(m_AdditionalPools[i]->IsAlloc(p))
+        pool = m_AdditionalPools[i];
+
+    RDCASSERT(pool);
+    if(pool)
+      pool->Deallocate(p);
+  }
+
+  // Additional pools are found through a fixed-size hash table keyed on the address divided by a
+  // bucket size at least as big as a pool. A pool then spans at most two buckets, and each bucket
+  // has an entry per pool touching it. The table is only allocated once there's an additional
+  // pool, and entries are only added under the lock. The table pointer and each entry's key are
+  // published with release stores after everything they guard is written, and read with acquire
+  // loads, so lock-free readers never see a partial entry.
+  static const size_t MaxTablePools = 256;
+  static const size_t TableSize = MaxTablePools * 4;
+
+  struct TableEntry
+  {
+    std::atomic<uintptr_t> key;
+    uintptr_t start;
+    uintptr_t end;
+    ItemPool *pool;
+  };
+
+  static size_t HashBucket(uintptr_t bucket) { return (bucket * 0x9E3779B1U) % TableSize; }
+  void InsertPool(ItemPool *pool)
+  {
+    // only called under the lock, so nothing else writes the table
+    TableEntry *table = m_Table.load(std::memory_order_relaxed);
+
+    if(table == NULL)
+    {
+      table = new TableEntry[TableSize];
+      for(size_t i = 0; i < TableSize; i++)
+      {
+        table[i].key.store(0, std::memory_order_relaxed);
+        table[i].start = table[i].end = 0;
+        table[i].pool = NULL;
+      }
+      m_Table.store(table, std::memory_order_release);
+    }
+
+    uintptr_t start = (uintptr_t)&pool->items[0];
+    uintptr_t end = (uintptr_t)&pool->items[AllocCount];
+
+    for(uintptr_t bucket = start >> m_BucketShift; bucket <= (end - 1) >> m_BucketShift; bucket++)
+    {
+      size_t idx = HashBucket(bucket);
+      while(table[idx].key.load(std::memory_order_relaxed) != 0)
+        idx = (idx + 1) % TableSize;
+
+      table[idx].start = start;
+      table[idx].end = end;
+      table[idx].pool = pool;
+      // keys are stored +1 so that 0 marks an empty entry
+      table[idx].key.store(bucket + 1, std::memory_order_release);
+    }
+  }
+
+  ItemPool *FindPool(const void *p)
+  {
+    const TableEntry *table = m_Table.load(std::memory_order_acquire);
+    if(table == NULL)
+      return NULL;
+
+    uintptr_t addr = (uintptr_t)p;
+    uintptr_t key = (addr >> m_BucketShift) + 1;
+
+    for(size_t idx = HashBucket(key - 1);; idx = (idx + 1) % TableSize)
+    {
+      const TableEntry &entry = table[idx];
+      uintptr_t entryKey = entry.key.load(std::memory_order_acquire);
+      if(entryKey == 0)
+        break;
+      if(entryKey == key && addr >= entry.start && addr < entry.end)
+        return entry.pool;
+    }
+
+    return NULL;
   }
 
   Threading::CriticalSection m_Lock;
@@ -194,13 +424,7 @@ private:
         return NULL;
       }
       --freeStackHead;
-      void *ret = items + freeStack[freeStackHead];
-
-#if ENABLED(RDOC_DEVEL)
-      memset(ret, 0xb0, AllocByteSize);
-#endif
-
-      return ret;
+      return items + freeStack[freeStackHead];
     }
 
     void Deallocate(void *p)
@@ -219,14 +443,10 @@ private:
 
       freeStack[freeStackHead] = idx;
       ++freeStackHead;
-
-#if ENABLED(RDOC_DEVEL)
-      if(DebugClear)
-        memset(p, 0xfe, AllocByteSize);
-#endif
     }
 
     bool IsAlloc(const void *p) const { return p >= &items[0] && p < &items[PoolCount]; }
+    size_t NumAllocated() const { return AllocCount - (size_t)freeStackHead; }
     WrapType *items;
     int *freeStack;
     int freeStackHead;
@@ -234,6 +454,15 @@ private:
 
   ItemPool m_ImmediatePool;
   rdcarray<ItemPool *> m_AdditionalPools;
+  size_t m_AllocPool = 0;
+  std::atomic<size_t> m_OverflowPoolCount{0};
+
+  std::atomic<TableEntry *> m_Table{NULL};
+  size_t m_BucketShift = 0;
+
+  uint64_t m_CacheSlot = 0;
+  ThreadCache *m_ThreadCaches = NULL;
+  volatile int32_t m_NextThreadCache = -1;
 
   friend typename FriendMaker<WrapType>::Type;
 };
@@ -256,7 +485,7 @@ private:
 #endif
 
 #define WRAPPED_POOL_INST(a)                                                              \
-  a::PoolType a::m_Pool;                                                                  \
+  a::PoolType a::m_Pool(#a);                                                              \
   template <>                                                                             \
   const size_t a::PoolType::AllocByteSize = sizeof(a);                                    \
   RDCCOMPILE_ASSERT(a::PoolType::AllocCount * sizeof(a) <= a::PoolType::AllocMaxByteSize, \
@@ -0,0 +1,227 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019-2020 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+
+#include "common/wrapped_pool.h"
+#include "common/timing.h"
+
+#if ENABLED(ENABLE_UNIT_TESTS)
+
+#include "3rdparty/catch/catch.hpp"
+
+struct PooledTestObject
+{
+  ALLOCATE_WITH_WRAPPED_POOL(PooledTestObject, 1024);
+
+  uint64_t owner;
+  uint64_t index;
+};
+
+WRAPPED_POOL_INST(PooledTestObject);
+
+TEST_CASE("Test wrapping pool", "[wrappedpool]")
+{
+  SECTION("Allocations beyond the immediate pool")
+  {
+    rdcarray<PooledTestObject *> objs;
+    for(uint64_t i = 0; i < 5000; i++)
+    {
+      objs.push_back(new PooledTestObject);
+      objs.back()->index = i;
+    }
+
+    for(uint64_t i = 0; i < objs.size(); i++)
+    {
+      CHECK(PooledTestObject::IsAlloc(objs[i]));
+      CHECK(objs[i]->index == i);
+    }
+
+    uint64_t stackValue = 0;
+    uint64_t *heapValue = new uint64_t;
+    CHECK_FALSE(PooledTestObject::IsAlloc(&stackValue));
+    CHECK_FALSE(PooledTestObject::IsAlloc(heapValue));
+    CHECK_FALSE(PooledTestObject::IsAlloc(NULL));
+    delete heapValue;
+
+    for(PooledTestObject *o : objs)
+      delete o;
+
+    // freed slots are reused rather than growing the pools again
+    PooledTestObject *o = new PooledTestObject;
+    CHECK(PooledTestObject::IsAlloc(o));
+    delete o;
+  };
+
+  SECTION("Allocating and freeing on many threads")
+  {
+    const uint64_t numThreads = 8;
+    volatile int32_t failures = 0;
+
+    rdcarray<Threading::ThreadHandle> threads;
+    for(uint64_t t = 0; t < numThreads; t++)
+    {
+      threads.push_back(Threading::CreateThread([t, &failures]() {
+        rdcarray<PooledTestObject *> objs;
+
+        for(int iter = 0; iter < 20; iter++)
+        {
+          for(uint64_t i = 0; i < 500; i++)
+          {
+            objs.push_back(new PooledTestObject);
+            objs.back()->owner = t;
+            objs.back()->index = i;
+          }
+
+          // if any slot were handed out twice, another thread would have overwritten it
+          for(uint64_t i = 0; i < objs.size(); i++)
+          {
+            if(objs[i]->owner != t || objs[i]->index != i || !PooledTestObject::IsAlloc(objs[i]))
+              Atomic::Inc32(&failures);
+          }
+
+          for(PooledTestObject *o : objs)
+            delete o;
+          objs.clear();
+        }
+      }));
+    }
+
+    for(Threading::ThreadHandle t : threads)
+    {
+      Threading::JoinThread(t);
+      Threading::CloseThread(t);
+    }
+
+    CHECK(failures == 0);
+  };
+
+  SECTION("Live object counts")
+  {
+    size_t baseline = PooledTestObject::m_Pool.GetLiveCount();
+
+    rdcarray<PooledTestObject *> objs;
+    for(uint64_t i = 0; i < 100; i++)
+      objs.push_back(new PooledTestObject);
+
+    CHECK(PooledTestObject::m_Pool.GetLiveCount() == baseline + 100);
+
+    bool reported = false;
+    for(const rdcpair<rdcstr, uint64_t> &pool : OverheadCounters::GetPoolLiveCounts())
+    {
+      if(pool.first == "PooledTestObject")
+      {
+        reported = true;
+        CHECK(pool.second == baseline + 100);
+      }
+    }
+    CHECK(reported);
+
+    for(PooledTestObject *o : objs)
+      delete o;
+
+    CHECK(PooledTestObject::m_Pool.GetLiveCount() == baseline);
+  };
+
+  SECTION("Contended allocation")
+  {
+    const int numThreads = 8;
+    const int numAllocs = 100000;
+
+    size_t baseline = PooledTestObject::m_Pool.GetLiveCount();
+
+    volatile int32_t errors = 0;
+
+    PerformanceTimer timer;
+
+    rdcarray<Threading::ThreadHandle> threads;
+    for(int t = 0; t < numThreads; t++)
+    {
+      threads.push_back(Threading::CreateThread([t, &errors]() {
+        PooledTestObject *objs[16];
+        for(int i = 0; i < numAllocs; i += 16)
+        {
+          for(int j = 0; j < 16; j++)
+          {
+            objs[j] = new PooledTestObject;
+            objs[j]->owner = t;
+            objs[j]->index = i + j;
+          }
+
+          // no other thread can have been handed the same objects
+          for(int j = 0; j < 16; j++)
+          {
+            if(!PooledTestObject::IsAlloc(objs[j]) || objs[j]->owner != (uint64_t)t ||
+               objs[j]->index != uint64_t(i + j))
+              Atomic::Inc32(&errors);
+            delete objs[j];
+          }
+        }
+      }));
+    }
+
+    for(Threading::ThreadHandle t : threads)
+    {
+      Threading::JoinThread(t);
+      Threading::CloseThread(t);
+    }
+
+    CHECK(errors == 0);
+    CHECK(PooledTestObject::m_Pool.GetLiveCount() == baseline);
+
+    RDCLOG("%d threads allocated and freed %d pooled objects each in %.2f ms", numThreads,
+           numAllocs, timer.GetMilliseconds());
+  };
+
+  SECTION("Allocating from many short-lived threads")
+  {
+    size_t baseline = PooledTestObject::m_Pool.GetLiveCount();
+
+    // many more short-lived threads than there are caches, each leaving freed slots cached
+    for(int t = 0; t < 100; t++)
+    {
+      Threading::ThreadHandle thread = Threading::CreateThread([]() {
+        PooledTestObject *objs[64];
+        for(int j = 0; j < 64; j++)
+          objs[j] = new PooledTestObject;
+        for(int j = 0; j < 64; j++)
+          delete objs[j];
+      });
+      Threading::JoinThread(thread);
+      Threading::CloseThread(thread);
+    }
+
+    CHECK(PooledTestObject::m_Pool.GetLiveCount() == baseline);
+
+    rdcarray<PooledTestObject *> objs;
+    for(int j = 0; j < 64; j++)
+      objs.push_back(new PooledTestObject);
+
+    CHECK(PooledTestObject::m_Pool.GetLiveCount() == baseline + 64);
+
+    for(PooledTestObject *o : objs)
+      delete o;
+  };
+};
+
+#endif    // ENABLED(ENABLE_UNIT_TESTS)
@@ -61,6 +61,16 @@ void LogReplayOptions(const ReplayOptions &opts)
   }
 
   RDCLOG("Replay optimisation level: %s", ToStr(opts.optimisation).c_str());
+
+  RDCLOG("%s queues concurrently during replay",
+         (opts.concurrentQueues ? "Replaying" : "Not replaying"));
+
+  if(opts.replayCheckpointInterval > 0)
+    RDCLOG("Replay checkpoints every %u events, up to %u MB", opts.replayCheckpointInterval,
+           opts.replayCheckpointBudgetMB);
+
+  if(opts.rerecordCacheMB > 0)
+    RDCLOG("Caching re-recorded command buffers, up to %u MB", opts.rerecordCacheMB);
 }
 
 // these one is done by hand as we format it
@@ -345,6 +355,15 @@ void RenderDoc::Initialise()
 
   Threading::Init();
 
+  {
+    const char *profileTrace = Process::GetEnvVariable("RENDERDOC_PROFILE_TRACE");
+    if(profileTrace && profileTrace[0])
+    {
+      m_ProfileTraceFilename = profileTrace;
+      Profiler::SetEnabled(true);
+    }
+  }
+
   m_RemoteIdent = 0;
   m_RemoteThread = 0;
 
@@ -467,6 +486,13 @@ RenderDoc::~RenderDoc()
     (*it)();
   m_ShutdownFunctions.clear();
 
+  WaitForCaptureWrite();
+
+  if(!m_ProfileTraceFilename.empty())
+    Profiler::WriteChromeTrace(m_ProfileTraceFilename);
+
+  FreeRecordedFrames();
+
   for(size_t i = 0; i < m_Captures.size(); i++)
   {
     if(m_Captures[i].retrieved)
@@ -480,6 +506,8 @@ RenderDoc::~RenderDoc()
     }
   }
 
+  Threading::LogLockStats();
+
   RDCSTOPLOGGING(m_LoggingFilename.c_str());
 
   if(m_RemoteThread)
@@ -526,10 +554,13 @@ void RenderDoc::InitialiseReplay(GlobalEnvironment env, const rdcarray<rdcstr> &
   m_GlobalEnv = env;
 
 #if ENABLED(RDOC_LINUX) && ENABLED(RDOC_XLIB)
-  if(!m_GlobalEnv.xlibDisplay)
+  if(!m_GlobalEnv.xlibDisplay && !m_GlobalEnv.headless)
     m_GlobalEnv.xlibDisplay = XOpenDisplay(NULL);
 #endif
 
+  if(m_GlobalEnv.headless)
+    RDCLOG("Replaying headless, no windowing systems will be initialised");
+
   if(!args.empty())
   {
     RDCDEBUG("Replay application launched with parameters:");
@@ -740,11 +771,24 @@ void RenderDoc::StartFrameCapture(void *dev, void *wnd)
   IFrameCapturer *frameCap = MatchFrameCapturer(dev, wnd);
   if(frameCap)
   {
+    m_FlightRecordingCapture = m_FlightRecordNextCapture;
+    m_FlightRecordNextCapture = false;
+
+    ChunkSpill::BeginCapture(uint64_t(m_Options.captureMemoryBudgetMB) * 1024 * 1024);
+
     frameCap->StartFrameCapture(dev, wnd);
     m_CapturesActive++;
   }
 }
 
+void RenderDoc::DiscardFlightRecording(void *dev, void *wnd)
+{
+  m_FlightRecordNextCapture = false;
+
+  if(m_FlightRecordingCapture && m_CapturesActive > 0)
+    DiscardFrameCapture(dev, wnd);
+}
+
 void RenderDoc::SetActiveWindow(void *dev, void *wnd)
 {
   DeviceWnd dw(dev, wnd);
@@ -765,7 +809,10 @@ bool RenderDoc::EndFrameCapture(void *dev, void *wnd)
   if(frameCap)
   {
     bool ret = frameCap->EndFrameCapture(dev, wnd);
+    ChunkSpill::EndCapture();
     m_CapturesActive--;
+    m_FlightRecordingCapture = false;
+    m_CaptureFramesRemaining = 0;
     return ret;
   }
   return false;
@@ -777,7 +824,10 @@ bool RenderDoc::DiscardFrameCapture(void *dev, void *wnd)
   if(frameCap)
   {
     bool ret = frameCap->DiscardFrameCapture(dev, wnd);
+    ChunkSpill::EndCapture();
     m_CapturesActive--;
+    m_FlightRecordingCapture = false;
+    m_CaptureFramesRemaining = 0;
     return ret;
   }
   return false;
@@ -821,6 +871,9 @@ void RenderDoc::Tick()
 
   prev_focus = cur_focus;
   prev_cap = cur_cap;
+
+  // start the next frame's chunks in fresh slabs, so this frame's can be freed in bulk
+  ChunkAllocator::ReleaseCurrentSlabs();
 }
 
 void RenderDoc::CycleActiveWindow()
@@ -920,6 +973,9 @@ rdcstr RenderDoc::GetOverlayText(RDCDriver driver, uint32_t frameNumber, int fla
 #if ENABLED(RDOC_DEVEL)
     overlayText += StringFormat::Fmt("%llu chunks - %.2f MB\n", Chunk::NumLiveChunks(),
                                      float(Chunk::TotalMem()) / 1024.0f / 1024.0f);
+    overlayText +=
+        StringFormat::Fmt("%llu chunk slabs - %.2f MB\n", ChunkAllocator::NumLiveSlabs(),
+                          float(ChunkAllocator::SlabMem()) / 1024.0f / 1024.0f);
 #endif
   }
   else if(capturesEnabled)
@@ -981,7 +1037,221 @@ bool RenderDoc::ShouldTriggerCapture(uint32_t frameNumber)
     }
   }
 
-  return ret;
+  // a merged capture takes in every consecutive frame that would otherwise be captured on its own,
+  // so they share one set of initial contents.
+  if(ret && m_Options.mergeMultiFrameCaptures)
+  {
+    m_CaptureFramesRemaining = m_Cap;
+    m_Cap = 0;
+
+    while(!m_QueuedFrameCaptures.empty() &&
+          m_QueuedFrameCaptures[0] == frameNumber + 1 + m_CaptureFramesRemaining)
+    {
+      m_QueuedFrameCaptures.erase(0);
+      m_CaptureFramesRemaining++;
+    }
+  }
+
+  // with the flight recorder enabled, every frame that isn't captured on request is captured into
+  // the in-memory ring instead, so that it can be saved after the fact.
+  m_FlightRecordNextCapture = !ret && m_Options.flightRecorderFrames > 0;
+
+  return ret || m_FlightRecordNextCapture;
+}
+
+bool RenderDoc::ShouldContinueCapture()
+{
+  if(m_CaptureFramesRemaining == 0)
+    return false;
+
+  m_CaptureFramesRemaining--;
+  return true;
+}
+
+void RenderDoc::SaveRecordedFrames(uint32_t frameNumber, uint32_t numFrames)
+{
+  rdcarray<RecordedFrame> frames;
+
+  // take the frames out of the ring, so they can't be evicted while they're being written
+  {
+    SCOPED_LOCK(m_FlightRecorderLock);
+
+    for(size_t i = 0; i < m_RecordedFrames.size();)
+    {
+      const RecordedFrame &frame = m_RecordedFrames[i];
+
+      if(frame.frameNumber >= frameNumber && frame.frameNumber - frameNumber < numFrames)
+      {
+        m_RecordedFramesSize -= frame.byteSize;
+        frames.push_back(frame);
+        m_RecordedFrames.erase(i);
+      }
+      else
+      {
+        i++;
+      }
+    }
+  }
+
+  if(frames.empty())
+  {
+    RDCWARN("No recorded frames in [%u, %u] to save", frameNumber, frameNumber + numFrames - 1);
+    return;
+  }
+
+  for(const RecordedFrame &frame : frames)
+  {
+    RDCFile *src = frame.rdc;
+
+    rdcstr path = GetNewCapturePath(frame.frameNumber);
+
+    if(WriteCaptureToDisk(src, path))
+    {
+      RDCLOG("Saved recorded frame %u to disk: %s", frame.frameNumber, path.c_str());
+
+      CaptureData cap(path, frame.timestamp, src->GetDriver(), frame.frameNumber);
+      {
+        SCOPED_LOCK(m_CaptureLock);
+        m_Captures.push_back(cap);
+      }
+    }
+    else
+    {
+      RDCERR("Error saving recorded frame %u to '%s'", frame.frameNumber, path.c_str());
+    }
+
+    delete src;
+  }
+}
+
+void RenderDoc::WriteExtendedThumbnail(RDCFile *rdc, const RDCThumb &thumb)
+{
+  if(thumb.format == FileType::JPG || thumb.width == 0 || thumb.height == 0)
+    return;
+
+  SectionProperties props = {};
+  props.type = SectionType::ExtendedThumbnail;
+  props.version = 1;
+  StreamWriter *w = rdc->WriteSection(props);
+
+  // if this file format ever changes, be sure to update the XML export which has a special
+  // handling for this case.
+
+  ExtThumbnailHeader header;
+  header.width = thumb.width;
+  header.height = thumb.height;
+  header.len = thumb.len;
+  header.format = thumb.format;
+  w->Write(header);
+  w->Write(thumb.pixels, thumb.len);
+
+  w->Finish();
+
+  delete w;
+}
+
+bool RenderDoc::WriteCaptureToDisk(RDCFile *rdc, const rdcstr &path)
+{
+  RDCFile output;
+  output.SetData(rdc->GetDriver(), rdc->GetDriverName().c_str(), rdc->GetMachineIdent(),
+                 &rdc->GetThumbnail());
+
+  // a raw thumbnail was left unencoded when the capture was made, the file header's JPG is
+  // compressed directly from it and the extended PNG thumbnail is encoded here.
+  RDCThumb pngThumb;
+  if(rdc->GetThumbnail().format == FileType::Raw)
+    EncodePixelsPNG(rdc->GetThumbnail(), pngThumb);
+
+  // when a target control client is streaming captures, it's sent there instead of to disk
+  RDCFileStream *stream = BeginCaptureStream(path);
+  if(stream)
+  {
+    output.Create(stream);
+  }
+  else
+  {
+    FileIO::CreateParentDirectory(path);
+    output.Create(path.c_str());
+  }
+
+  bool success = output.ErrorCode() == ContainerError::NoError;
+
+  // sections were written uncompressed into memory, they're compressed here as they're written
+  // according to their flags.
+  for(int i = 0; success && i < rdc->NumSections(); i++)
+  {
+    StreamWriter *writer = output.WriteSection(rdc->GetSectionProperties(i));
+    StreamReader *reader = rdc->ReadSection(i);
+
+    StreamTransfer(writer, reader, NULL);
+
+    writer->Finish();
+
+    success = !writer->IsErrored() && !reader->IsErrored();
+
+    delete reader;
+    delete writer;
+  }
+
+  if(success && pngThumb.pixels)
+    WriteExtendedThumbnail(&output, pngThumb);
+
+  SAFE_DELETE_ARRAY(pngThumb.pixels);
+
+  return success && output.ErrorCode() == ContainerError::NoError;
+}
+
+void RenderDoc::WaitForCaptureWrite()
+{
+  if(m_CaptureWriteThread)
+  {
+    Threading::JoinThread(m_CaptureWriteThread);
+    Threading::CloseThread(m_CaptureWriteThread);
+    m_CaptureWriteThread = 0;
+  }
+}
+
+void RenderDoc::AddRecordedFrame(RDCFile *rdc, uint32_t frameNumber)
+{
+  RecordedFrame frame;
+  frame.rdc = rdc;
+  frame.timestamp = Timing::GetUnixTimestamp();
+  frame.frameNumber = frameNumber;
+  frame.byteSize = 0;
+  for(int i = 0; i < rdc->NumSections(); i++)
+    frame.byteSize += rdc->GetSectionProperties(i).uncompressedSize;
+
+  const uint64_t memoryLimit = uint64_t(m_Options.flightRecorderMemoryMB) * 1024 * 1024;
+
+  SCOPED_LOCK(m_FlightRecorderLock);
+
+  m_RecordedFrames.push_back(frame);
+  m_RecordedFramesSize += frame.byteSize;
+
+  // evict the oldest frames until we're within both limits. The newest frame is always kept even
+  // if on its own it's over the memory limit.
+  while(m_RecordedFrames.size() > 1 &&
+        (m_RecordedFrames.size() > m_Options.flightRecorderFrames ||
+         (memoryLimit > 0 && m_RecordedFramesSize > memoryLimit)))
+  {
+    m_RecordedFramesSize -= m_RecordedFrames[0].byteSize;
+    delete m_RecordedFrames[0].rdc;
+    m_RecordedFrames.erase(0);
+  }
+
+  RDCDEBUG("Recorded frame %u (%llu bytes), %zu frames (%llu bytes) in flight recorder",
+           frameNumber, frame.byteSize, m_RecordedFrames.size(), m_RecordedFramesSize);
+}
+
+void RenderDoc::FreeRecordedFrames()
+{
+  SCOPED_LOCK(m_FlightRecorderLock);
+
+  for(RecordedFrame &frame : m_RecordedFrames)
+    delete frame.rdc;
+
+  m_RecordedFrames.clear();
+  m_RecordedFramesSize = 0;
 }
 
 void RenderDoc::ResamplePixels(const FramePixels &in, RDCThumb &out)
@@ -1120,49 +1390,90 @@ void RenderDoc::EncodePixelsPNG(const RDCThumb &in, RDCThumb &out)
   out.format = FileType::PNG;
 }
 
-RDCFile *RenderDoc::CreateRDC(RDCDriver driver, uint32_t frameNum, const FramePixels &fp)
+rdcstr RenderDoc::GetNewCapturePath(uint32_t frameNum)
 {
-  RDCFile *ret = new RDCFile;
-
   rdcstr suffix = StringFormat::Fmt("_frame%u", frameNum);
 
   if(frameNum == ~0U)
     suffix = "_capture";
 
-  m_CurrentLogFile = StringFormat::Fmt("%s%s.rdc", m_CaptureFileTemplate.c_str(), suffix.c_str());
+  rdcstr path = StringFormat::Fmt("%s%s.rdc", m_CaptureFileTemplate.c_str(), suffix.c_str());
 
   // make sure we don't stomp another capture if we make multiple captures in the same frame.
   {
     SCOPED_LOCK(m_CaptureLock);
     int altnum = 2;
-    while(std::find_if(m_Captures.begin(), m_Captures.end(), [this](const CaptureData &o) {
-            return o.path == m_CurrentLogFile;
+    while(path == m_PendingCaptureWrite ||
+          std::find_if(m_Captures.begin(), m_Captures.end(), [&path](const CaptureData &o) {
+            return o.path == path;
           }) != m_Captures.end())
     {
-      m_CurrentLogFile =
+      path =
           StringFormat::Fmt("%s%s_%d.rdc", m_CaptureFileTemplate.c_str(), suffix.c_str(), altnum);
       altnum++;
     }
   }
 
+  return path;
+}
+
+RDCFile *RenderDoc::CreateRDC(RDCDriver driver, uint32_t frameNum, const FramePixels &fp)
+{
+  RDCFile *ret = new RDCFile;
+
+  // frames for the flight recorder aren't given a file, so their sections stay in memory until the
+  // frame is saved or evicted. Likewise when writing asynchronously the file is only created on the
+  // writing thread.
+  m_AsyncWritingCapture = m_Options.asyncCaptureWrite && !m_FlightRecordingCapture;
+
+  // in either of those cases the thumbnail is kept raw and only encoded when the file is written,
+  // so the capturing thread doesn't pay for it.
+  const bool deferredWrite = m_AsyncWritingCapture || m_FlightRecordingCapture;
+
   RDCThumb outRaw, outPng;
   if(fp.data)
   {
     // point sample info into raw buffer
     ResamplePixels(fp, outRaw);
-    EncodePixelsPNG(outRaw, outPng);
-  }
 
-  ret->SetData(driver, ToStr(driver).c_str(), OSUtility::GetMachineIdent(), &outPng);
+    if(!deferredWrite)
+      EncodePixelsPNG(outRaw, outPng);
+  }
 
-  FileIO::CreateParentDirectory(m_CurrentLogFile);
+  ret->SetData(driver, ToStr(driver).c_str(), OSUtility::GetMachineIdent(),
+               deferredWrite ? &outRaw : &outPng);
 
-  ret->Create(m_CurrentLogFile.c_str());
+  if(m_AsyncWritingCapture)
+  {
+    // only one capture is written at once, so wait for the previous one to finish before claiming
+    // another filename.
+    WaitForCaptureWrite();
 
-  if(ret->ErrorCode() != ContainerError::NoError)
+    m_CurrentLogFile = GetNewCapturePath(frameNum);
+  }
+  else if(!m_FlightRecordingCapture)
   {
-    RDCERR("Error creating RDC at '%s'", m_CurrentLogFile.c_str());
-    SAFE_DELETE(ret);
+    m_CurrentLogFile = GetNewCapturePath(frameNum);
+
+    RDCFileStream *stream = BeginCaptureStream(m_CurrentLogFile);
+    m_StreamingCapture = (stream != NULL);
+
+    if(m_StreamingCapture)
+    {
+      ret->Create(stream);
+    }
+    else
+    {
+      FileIO::CreateParentDirectory(m_CurrentLogFile);
+
+      ret->Create(m_CurrentLogFile.c_str());
+    }
+
+    if(ret->ErrorCode() != ContainerError::NoError)
+    {
+      RDCERR("Error creating RDC at '%s'", m_CurrentLogFile.c_str());
+      SAFE_DELETE(ret);
+    }
   }
 
   SAFE_DELETE_ARRAY(outRaw.pixels);
@@ -1620,39 +1931,84 @@ void RenderDoc::FinishCaptureWriting(RDCFile *rdc, uint32_t frameNumber)
       delete w;
     }
 
+    // raw thumbnails are encoded and written by WriteCaptureToDisk, off this thread
     const RDCThumb &thumb = rdc->GetThumbnail();
-    if(thumb.format != FileType::JPG && thumb.width > 0 && thumb.height > 0)
+    if(thumb.format != FileType::Raw)
+      WriteExtendedThumbnail(rdc, thumb);
+
+    if(m_FlightRecordingCapture)
     {
-      SectionProperties props = {};
-      props.type = SectionType::ExtendedThumbnail;
-      props.version = 1;
-      StreamWriter *w = rdc->WriteSection(props);
+      AddRecordedFrame(rdc, frameNumber);
+    }
+    else if(m_AsyncWritingCapture)
+    {
+      rdcstr path = m_CurrentLogFile;
+      uint64_t timestamp = Timing::GetUnixTimestamp();
 
-      // if this file format ever changes, be sure to update the XML export which has a special
-      // handling for this case.
+      {
+        SCOPED_LOCK(m_CaptureLock);
+        m_PendingCaptureWrite = path;
+      }
 
-      ExtThumbnailHeader header;
-      header.width = thumb.width;
-      header.height = thumb.height;
-      header.len = thumb.len;
-      header.format = thumb.format;
-      w->Write(header);
-      w->Write(thumb.pixels, thumb.len);
+      // the capture is only added to the list once it's complete on disk, so that's when target
+      // control reports it as a new capture.
+      std::function<void()> write = [this, rdc, path, timestamp, frameNumber]() {
+        bool success = WriteCaptureToDisk(rdc, path);
 
-      w->Finish();
+        if(success)
+          RDCLOG("Written to disk: %s", path.c_str());
+        else
+          RDCERR("Error writing capture to '%s'", path.c_str());
 
-      delete w;
-    }
+        {
+          SCOPED_LOCK(m_CaptureLock);
+          if(success)
+            m_Captures.push_back(CaptureData(path, timestamp, rdc->GetDriver(), frameNumber));
+          m_PendingCaptureWrite.clear();
+        }
 
-    RDCLOG("Written to disk: %s", m_CurrentLogFile.c_str());
+        delete rdc;
+      };
 
-    CaptureData cap(m_CurrentLogFile, Timing::GetUnixTimestamp(), rdc->GetDriver(), frameNumber);
-    {
-      SCOPED_LOCK(m_CaptureLock);
-      m_Captures.push_back(cap);
+      m_CaptureWriteThread = Threading::CreateThread([write]() {
+        Threading::SetCurrentThreadName("CaptureWriteThread");
+        Threading::KeepModuleAlive();
+        write();
+        Threading::ReleaseModuleExitThread();
+      });
+
+      // writing on another thread is an optimisation, if the thread can't be created just write here
+      if(m_CaptureWriteThread == 0)
+      {
+        RDCWARN("Couldn't create capture writing thread, writing synchronously");
+        write();
+      }
     }
+    else
+    {
+      CaptureData cap(m_CurrentLogFile, Timing::GetUnixTimestamp(), rdc->GetDriver(),
+                      frameNumber);
+
+      // a streamed capture is only finished once the file is closed, and it's not announced until
+      // then so the client has all of it.
+      bool success = rdc->ErrorCode() == ContainerError::NoError;
+      delete rdc;
+
+      if(!m_StreamingCapture)
+        RDCLOG("Written to disk: %s", m_CurrentLogFile.c_str());
+      else if(success)
+        RDCLOG("Streamed to target control client: %s", m_CurrentLogFile.c_str());
+      else
+        RDCERR("Error streaming capture to target control client");
 
-    delete rdc;
+      if(success || !m_StreamingCapture)
+      {
+        SCOPED_LOCK(m_CaptureLock);
+        m_Captures.push_back(cap);
+      }
+
+      m_StreamingCapture = false;
+    }
   }
   else
   {
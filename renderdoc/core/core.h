@@ -33,6 +33,7 @@
 #include "api/replay/capture_options.h"
 #include "api/replay/control_types.h"
 #include "api/replay/stringise.h"
+#include "common/profiler.h"
 #include "common/timing.h"
 #include "os/os_specific.h"
 
@@ -51,6 +52,7 @@ class IReplayDriver;
 
 class StreamReader;
 class RDCFile;
+class RDCFileStream;
 struct SDFile;
 enum class VulkanLayerFlags : uint32_t;
 
@@ -237,6 +239,16 @@ struct CaptureData
   bool retrieved;
 };
 
+// a frame held in the flight recorder ring. The RDC has no backing file, its sections are held in
+// memory until the frame is either saved to disk or evicted from the ring.
+struct RecordedFrame
+{
+  RDCFile *rdc;
+  uint64_t timestamp;
+  uint64_t byteSize;
+  uint32_t frameNumber;
+};
+
 enum class LoadProgress
 {
   DebugManagerInit,
@@ -437,6 +449,7 @@ public:
   ICrashHandler *GetCrashHandler() const { return m_ExHandler; }
   void ResamplePixels(const FramePixels &in, RDCThumb &out);
   void EncodePixelsPNG(const RDCThumb &in, RDCThumb &out);
+  void WriteExtendedThumbnail(RDCFile *rdc, const RDCThumb &thumb);
   RDCFile *CreateRDC(RDCDriver driver, uint32_t frameNum, const FramePixels &fp);
   void FinishCaptureWriting(RDCFile *rdc, uint32_t frameNumber);
 
@@ -523,10 +536,12 @@ public:
   void RemoveDeviceFrameCapturer(void *dev);
 
   void StartFrameCapture(void *dev, void *wnd);
-  bool IsFrameCapturing() { return m_CapturesActive > 0; }
+  // frames captured only for the flight recorder don't count, they're invisible to the application
+  bool IsFrameCapturing() { return m_CapturesActive > 0 && !m_FlightRecordingCapture; }
   void SetActiveWindow(void *dev, void *wnd);
   bool EndFrameCapture(void *dev, void *wnd);
   bool DiscardFrameCapture(void *dev, void *wnd);
+  void DiscardFlightRecording(void *dev, void *wnd);
 
   bool MatchClosestWindow(void *&dev, void *&wnd);
 
@@ -545,6 +560,7 @@ public:
   uint32_t GetOverlayBits() { return m_Overlay; }
   void MaskOverlayBits(uint32_t And, uint32_t Or) { m_Overlay = (m_Overlay & And) | Or; }
   void QueueCapture(uint32_t frameNumber);
+  void SaveRecordedFrames(uint32_t frameNumber, uint32_t numFrames);
   void SetFocusKeys(RENDERDOC_InputButton *keys, int num)
   {
     m_FocusKeys.resize(num);
@@ -561,6 +577,7 @@ public:
   const rdcarray<RENDERDOC_InputButton> &GetFocusKeys() { return m_FocusKeys; }
   const rdcarray<RENDERDOC_InputButton> &GetCaptureKeys() { return m_CaptureKeys; }
   bool ShouldTriggerCapture(uint32_t frameNumber);
+  bool ShouldContinueCapture();
 
   enum
   {
@@ -578,11 +595,20 @@ private:
 
   void SyncAvailableGPUThread();
 
+  rdcstr GetNewCapturePath(uint32_t frameNum);
+  bool WriteCaptureToDisk(RDCFile *rdc, const rdcstr &path);
+  RDCFileStream *BeginCaptureStream(const rdcstr &path);
+  void WaitForCaptureWrite();
+  void AddRecordedFrame(RDCFile *rdc, uint32_t frameNumber);
+  void FreeRecordedFrames();
+
   static RenderDoc *m_Inst;
 
   bool m_Replay;
 
   uint32_t m_Cap;
+  // frames still to be recorded into the current merged multi-frame capture, after this one
+  uint32_t m_CaptureFramesRemaining = 0;
 
   rdcarray<RENDERDOC_InputButton> m_FocusKeys;
   rdcarray<RENDERDOC_InputButton> m_CaptureKeys;
@@ -603,6 +629,29 @@ private:
 
   rdcarray<uint32_t> m_QueuedFrameCaptures;
 
+  // whether the next capture to begin is only being taken for the flight recorder, and whether
+  // the capture currently in progress is.
+  bool m_FlightRecordNextCapture = false;
+  bool m_FlightRecordingCapture = false;
+
+  // whether the capture in progress is being streamed to the target control client instead of
+  // being written to disk.
+  bool m_StreamingCapture = false;
+
+  // with CaptureOptions::asyncCaptureWrite, captures are serialised into memory, and compressed and
+  // written to disk on a background thread.
+  bool m_AsyncWritingCapture = false;
+  Threading::ThreadHandle m_CaptureWriteThread = 0;
+  rdcstr m_PendingCaptureWrite;
+
+  // when set by RENDERDOC_PROFILE_TRACE, our own profile zones are recorded from startup and
+  // written to this file as a Chrome trace on shutdown.
+  rdcstr m_ProfileTraceFilename;
+
+  Threading::CriticalSection m_FlightRecorderLock;
+  rdcarray<RecordedFrame> m_RecordedFrames;
+  uint64_t m_RecordedFramesSize = 0;
+
   uint32_t m_RemoteIdent;
   Threading::ThreadHandle m_RemoteThread;
 
@@ -70,6 +70,7 @@ public:
   }
 
   bool IsRemoteProxy() { return true; }
+  void FetchStructuredChunks(const rdcarray<uint32_t> &chunkIndices) {}
   void Shutdown() { delete this; }
   // pass through necessary operations to proxy
   rdcarray<WindowingSystem> GetSupportedWindowSystems()
@@ -206,6 +207,8 @@ public:
     return ret;
   }
   rdcarray<GPUDevice> GetAvailableGPUs() { return {}; }
+  rdcarray<MemoryUsage> GetMemoryUsage() { return {}; }
+  void EvictCache(MemoryCategory category) {}
   const D3D12Pipe::State *GetD3D12PipelineState() { return NULL; }
   const GLPipe::State *GetGLPipelineState() { return NULL; }
   const VKPipe::State *GetVulkanPipelineState() { return NULL; }
@@ -241,6 +244,7 @@ public:
   {
     return ResourceId();
   }
+  rdcarray<OverdrawStatistics> GetOverdrawStatistics() { return {}; }
   rdcarray<ShaderEntryPoint> GetShaderEntryPoints(ResourceId shader) { return {}; }
   ShaderReflection *GetShader(ResourceId pipeline, ResourceId shader, ShaderEntryPoint entry)
   {
@@ -392,20 +396,17 @@ ReplayStatus IMG_CreateReplayDevice(RDCFile *rdc, IReplayDriver **driver)
   }
   else if(is_dds_file(f))
   {
+    // only the header needs to be valid here, the contents are streamed in when the file is loaded
     FileIO::fseek64(f, 0, SEEK_SET);
-    dds_data read_data = load_dds_from_file(f);
+    dds_data read_data = load_dds_header(f);
 
-    if(read_data.subdata == NULL)
+    if(read_data.subsizes == NULL)
     {
       FileIO::fclose(f);
       RDCERR("DDS file recognised, but couldn't load");
       return ReplayStatus::ImageUnsupported;
     }
 
-    for(int i = 0; i < read_data.slices * read_data.mips; i++)
-      delete[] read_data.subdata[i];
-
-    delete[] read_data.subdata;
     delete[] read_data.subsizes;
   }
   else
@@ -667,9 +668,9 @@ void ImageViewer::RefreshFile()
   if(dds)
   {
     FileIO::fseek64(f, 0, SEEK_SET);
-    read_data = load_dds_from_file(f);
+    read_data = load_dds_header(f);
 
-    if(read_data.subdata == NULL)
+    if(read_data.subsizes == NULL)
     {
       FileIO::fclose(f);
       return;
@@ -750,15 +751,23 @@ void ImageViewer::RefreshFile()
   }
   else
   {
+    // read and upload one subresource at a time, so that very large files don't need to be held
+    // in memory all at once. The top mip of the first slice is always the largest.
+    bytebuf subdata;
+    subdata.resize(read_data.subsizes[0]);
+
     for(uint32_t i = 0; i < texDetails.arraysize * texDetails.mips; i++)
     {
-      m_Proxy->SetProxyTextureData(m_TextureID, {i % texDetails.mips, i / texDetails.mips},
-                                   read_data.subdata[i], (size_t)read_data.subsizes[i]);
+      if(!read_dds_subresource(f, read_data, i, subdata.data()))
+      {
+        RDCERR("DDS file truncated reading subresource %u", i);
+        break;
+      }
 
-      delete[] read_data.subdata[i];
+      m_Proxy->SetProxyTextureData(m_TextureID, {i % texDetails.mips, i / texDetails.mips},
+                                   subdata.data(), (size_t)read_data.subsizes[i]);
     }
 
-    delete[] read_data.subdata;
     delete[] read_data.subsizes;
   }
 
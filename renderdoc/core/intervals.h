@@ -24,12 +24,93 @@
 
 #pragma once
 
+#include <algorithm>
 #include <map>
+#include "api/replay/rdcarray.h"
 #include "common/common.h"
 
+// A sorted-vector stand-in for std::map<uint64_t, T>, implementing just the part of its interface
+// that `Intervals` needs. Lookups are binary searches over contiguous storage and iteration is a
+// linear walk, at the cost of inserts and erases moving the tail of the array. That suits interval
+// sets with many small ranges that are mostly iterated, searched or updated in bulk.
+// Unlike std::map, inserting or erasing invalidates any other iterators.
 template <typename T>
+class IntervalsVectorMap
+{
+public:
+  typedef std::pair<uint64_t, T> value_type;
+  typedef value_type *iterator;
+  typedef const value_type *const_iterator;
+  typedef size_t size_type;
+
+  inline iterator begin() { return elems.begin(); }
+  inline iterator end() { return elems.end(); }
+  inline const_iterator begin() const { return elems.begin(); }
+  inline const_iterator end() const { return elems.end(); }
+  inline size_type size() const { return elems.size(); }
+  inline bool empty() const { return elems.empty(); }
+  inline void swap(IntervalsVectorMap &other) { elems.swap(other.elems); }
+  iterator upper_bound(uint64_t x)
+  {
+    return std::upper_bound(begin(), end(), x,
+                            [](uint64_t a, const value_type &b) { return a < b.first; });
+  }
+
+  const_iterator upper_bound(uint64_t x) const
+  {
+    return std::upper_bound(begin(), end(), x,
+                            [](uint64_t a, const value_type &b) { return a < b.first; });
+  }
+
+  std::pair<iterator, bool> insert(const value_type &val)
+  {
+    iterator it = std::lower_bound(
+        begin(), end(), val.first, [](const value_type &a, uint64_t b) { return a.first < b; });
+    if(it != end() && it->first == val.first)
+      return std::make_pair(it, false);
+
+    size_t idx = it - begin();
+    elems.insert(idx, val);
+    return std::make_pair(begin() + idx, true);
+  }
+
+  // appending in order is the common case when building a new set of intervals, so a hint at the
+  // end avoids the search.
+  iterator insert(const_iterator hint, const value_type &val)
+  {
+    if(hint == end() && (elems.empty() || elems.back().first < val.first))
+    {
+      elems.push_back(val);
+      return end() - 1;
+    }
+    return insert(val).first;
+  }
+
+  iterator erase(iterator it)
+  {
+    size_t idx = it - begin();
+    elems.erase(idx);
+    return begin() + idx;
+  }
+
+private:
+  rdcarray<value_type> elems;
+};
+
+template <typename T, typename Map = std::map<uint64_t, T>>
 struct Intervals;
 
+// One range of a bulk `Intervals::update`.
+template <typename T>
+struct IntervalUpdate
+{
+  // Inclusive lower bound
+  uint64_t start;
+  // Exclusive upper bound
+  uint64_t finish;
+  T value;
+};
+
 template <typename T, typename Map, typename Iter, typename Interval>
 class IntervalsIter;
 
@@ -107,7 +188,8 @@ public:
 template <typename T, typename Map, typename Iter, typename Interval>
 class IntervalsIter
 {
-  friend struct Intervals<T>;
+  template <typename, typename>
+  friend struct Intervals;
 
 protected:
   Interval ref;
@@ -156,39 +238,34 @@ public:
 };
 
 // Data structure to efficiently store values for disjoint intervals.
-template <typename T>
+// `Map` holds the start point of each interval. It defaults to std::map, and can be
+// `IntervalsVectorMap<T>` where many small intervals would make a node-based map slow to walk.
+template <typename T, typename Map>
 struct Intervals
 {
 public:
-  typedef IntervalRef<T, std::map<uint64_t, T>, typename std::map<uint64_t, T>::iterator> interval;
-  typedef IntervalsIter<T, std::map<uint64_t, T>, typename std::map<uint64_t, T>::iterator, interval> iterator;
+  typedef IntervalRef<T, Map, typename Map::iterator> interval;
+  typedef IntervalsIter<T, Map, typename Map::iterator, interval> iterator;
 
-  typedef ConstIntervalRef<T, const std::map<uint64_t, T>, typename std::map<uint64_t, T>::const_iterator>
-      const_interval;
-  typedef IntervalsIter<T, const std::map<uint64_t, T>,
-                        typename std::map<uint64_t, T>::const_iterator, const_interval>
-      const_iterator;
+  typedef ConstIntervalRef<T, const Map, typename Map::const_iterator> const_interval;
+  typedef IntervalsIter<T, const Map, typename Map::const_iterator, const_interval> const_iterator;
 
 private:
-  std::map<uint64_t, T> StartPoints;
-
-  iterator Wrap(typename std::map<uint64_t, T>::iterator iter)
-  {
-    return iterator(&StartPoints, iter);
-  }
+  Map StartPoints;
 
-  const_iterator Wrap(typename std::map<uint64_t, T>::const_iterator iter) const
+  iterator Wrap(typename Map::iterator iter) { return iterator(&StartPoints, iter); }
+  const_iterator Wrap(typename Map::const_iterator iter) const
   {
     return const_iterator(&StartPoints, iter);
   }
 
 public:
-  Intervals() : StartPoints{{0, T()}} {}
+  Intervals() { StartPoints.insert(std::pair<uint64_t, T>(0, T())); }
   inline iterator end() { return Wrap(StartPoints.end()); }
   inline iterator begin() { return Wrap(StartPoints.begin()); }
   inline const_iterator begin() const { return Wrap(StartPoints.begin()); }
   inline const_iterator end() const { return Wrap(StartPoints.end()); }
-  typedef typename std::map<uint64_t, T>::size_type size_type;
+  typedef typename Map::size_type size_type;
   inline size_type size() const { return StartPoints.size(); }
   // Find the interval containing `x`.
   iterator find(uint64_t x)
@@ -246,6 +323,84 @@ public:
       i->mergeLeft();
   }
 
+  // Apply many updates at once, with the same result as calling `update` for each in turn.
+  // When the updated ranges don't overlap, the intervals are rebuilt in a single pass over the
+  // existing intervals and the sorted updates, instead of searching and splitting for each one.
+  template <typename Compose>
+  void update(const rdcarray<IntervalUpdate<T>> &updates, Compose comp)
+  {
+    rdcarray<IntervalUpdate<T>> sorted;
+    sorted.reserve(updates.size());
+    for(const IntervalUpdate<T> &u : updates)
+      if(u.start < u.finish)
+        sorted.push_back(u);
+
+    std::sort(sorted.begin(), sorted.end(),
+              [](const IntervalUpdate<T> &a, const IntervalUpdate<T> &b) {
+                return a.start < b.start;
+              });
+
+    for(size_t u = 1; u < sorted.size(); u++)
+    {
+      // overlapping updates compose in order, so apply them one by one
+      if(sorted[u].start < sorted[u - 1].finish)
+      {
+        for(const IntervalUpdate<T> &up : updates)
+          update(up.start, up.finish, up.value, comp);
+        return;
+      }
+    }
+
+    if(sorted.empty())
+      return;
+
+    Map result;
+    typename Map::iterator last = result.end();
+
+    auto it = StartPoints.begin();
+    size_t u = 0;
+    uint64_t pos = 0;
+
+    while(true)
+    {
+      auto next = it;
+      next++;
+      uint64_t oldFinish = next == StartPoints.end() ? UINT64_MAX : next->first;
+
+      // find the value of [pos, segFinish), which lies in a single old interval and is either
+      // entirely inside or entirely outside the current update
+      T val = it->second;
+      uint64_t segFinish = oldFinish;
+      if(u < sorted.size())
+      {
+        if(pos < sorted[u].start)
+        {
+          segFinish = RDCMIN(segFinish, sorted[u].start);
+        }
+        else
+        {
+          val = comp(val, sorted[u].value);
+          segFinish = RDCMIN(segFinish, sorted[u].finish);
+        }
+      }
+
+      // only start a new interval when the value changes, so neighbours stay merged
+      if(result.empty() || !(val == last->second))
+        last = result.insert(result.end(), std::pair<uint64_t, T>(pos, val));
+
+      if(segFinish == UINT64_MAX)
+        break;
+
+      pos = segFinish;
+      if(pos == oldFinish)
+        it = next;
+      if(u < sorted.size() && pos >= sorted[u].finish)
+        u++;
+    }
+
+    StartPoints.swap(result);
+  }
+
   // Update `this` by composing the value of each interval with the value of the
   // corresponding interval in `other`.
   // If the intervals in `this` and `other` do not line up, then the intervals in
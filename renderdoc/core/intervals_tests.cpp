@@ -27,6 +27,7 @@
 #if ENABLED(ENABLE_UNIT_TESTS)
 
 #include "api/replay/rdcarray.h"
+#include "common/timing.h"
 #include "intervals.h"
 
 #include "3rdparty/catch/catch.hpp"
@@ -40,7 +41,8 @@ struct Interval
   uint64_t end;
 };
 
-void check_intervals(Intervals<uint64_t> &value, const rdcarray<Interval> &expected)
+template <typename Map>
+void check_intervals(Intervals<uint64_t, Map> &value, const rdcarray<Interval> &expected)
 {
   auto i = value.begin();
   auto j = expected.begin();
@@ -54,6 +56,15 @@ void check_intervals(Intervals<uint64_t> &value, const rdcarray<Interval> &expec
   CHECK((j == expected.end()));
 }
 
+template <typename Map>
+rdcarray<Interval> list_intervals(const Intervals<uint64_t, Map> &value)
+{
+  rdcarray<Interval> ret;
+  for(auto i = value.begin(); i != value.end(); i++)
+    ret.push_back({i->start(), i->value(), i->finish()});
+  return ret;
+}
+
 Intervals<uint64_t> make_intervals(const rdcarray<Interval> &intervals)
 {
   Intervals<uint64_t> res;
@@ -441,4 +452,156 @@ TEST_CASE("Test Intervals type", "[intervals]")
   };
 };
 
+TEST_CASE("Test Intervals storage and bulk updates", "[intervals]")
+{
+  auto add = [](uint64_t x, uint64_t y) -> uint64_t { return x + y; };
+
+  // small deterministic generator so the random ranges are the same on every run
+  uint32_t seed = 0x1234567;
+  auto rand = [&seed]() -> uint32_t {
+    seed = seed * 1103515245 + 12345;
+    return (seed >> 8) & 0xffff;
+  };
+
+  SECTION("vector map matches std::map")
+  {
+    Intervals<uint64_t> reference;
+    Intervals<uint64_t, IntervalsVectorMap<uint64_t>> test;
+
+    check_intervals(test, {{0, 0, UINT64_MAX}});
+
+    for(int i = 0; i < 1000; i++)
+    {
+      uint64_t start = rand();
+      uint64_t finish = start + (rand() % 64);
+      uint64_t val = rand() % 3;
+      reference.update(start, finish, val, add);
+      test.update(start, finish, val, add);
+    }
+
+    test.update(100, UINT64_MAX, 1, add);
+    reference.update(100, UINT64_MAX, 1, add);
+
+    CHECK(test.size() == reference.size());
+    check_intervals(test, list_intervals(reference));
+
+    Intervals<uint64_t> otherReference;
+    Intervals<uint64_t, IntervalsVectorMap<uint64_t>> other;
+    for(int i = 0; i < 100; i++)
+    {
+      uint64_t start = rand();
+      uint64_t finish = start + (rand() % 1024);
+      otherReference.update(start, finish, 1, add);
+      other.update(start, finish, 1, add);
+    }
+
+    reference.merge(otherReference, add);
+    test.merge(other, add);
+    check_intervals(test, list_intervals(reference));
+  };
+
+  SECTION("bulk update of disjoint ranges")
+  {
+    Intervals<uint64_t> test = make_intervals({{0, 0, 10}, {10, 1, 20}, {20, 0, UINT64_MAX}});
+    test.update({{15, 25, 1}, {5, 10, 1}, {30, 30, 5}, {40, UINT64_MAX, 2}}, add);
+    check_intervals(test, {{0, 0, 5},
+                           {5, 1, 15},
+                           {15, 2, 20},
+                           {20, 1, 25},
+                           {25, 0, 40},
+                           {40, 2, UINT64_MAX}});
+  };
+
+  SECTION("bulk update of touching ranges merges them")
+  {
+    Intervals<uint64_t> test;
+    test.update({{0, 10, 1}, {10, 20, 1}, {20, 30, 1}}, add);
+    check_intervals(test, {{0, 1, 30}, {30, 0, UINT64_MAX}});
+  };
+
+  SECTION("bulk update of overlapping ranges composes in order")
+  {
+    Intervals<uint64_t, IntervalsVectorMap<uint64_t>> test;
+    test.update({{0, 20, 1}, {10, 30, 1}}, add);
+    check_intervals(test, {{0, 1, 10}, {10, 2, 20}, {20, 1, 30}, {30, 0, UINT64_MAX}});
+  };
+
+  SECTION("bulk update matches individual updates")
+  {
+    Intervals<uint64_t> reference;
+    Intervals<uint64_t, IntervalsVectorMap<uint64_t>> test;
+
+    for(int pass = 0; pass < 10; pass++)
+    {
+      rdcarray<IntervalUpdate<uint64_t>> updates;
+      uint64_t offs = rand() % 64;
+      for(int i = 0; i < 200; i++)
+      {
+        uint64_t start = offs + (rand() % 32);
+        uint64_t finish = start + (rand() % 32);
+        updates.push_back({start, finish, rand() % 3});
+        offs = finish;
+      }
+
+      for(const IntervalUpdate<uint64_t> &u : updates)
+        reference.update(u.start, u.finish, u.value, add);
+      test.update(updates, add);
+
+      check_intervals(test, list_intervals(reference));
+    }
+  };
+
+  SECTION("Range tracking benchmark")
+  {
+    const uint64_t numRanges = 20000;
+    const uint64_t rangeSize = 256;
+
+    rdcarray<IntervalUpdate<uint64_t>> updates;
+    for(uint64_t i = 0; i < numRanges; i++)
+      updates.push_back({i * rangeSize * 2, i * rangeSize * 2 + rangeSize, (i % 3) + 1});
+
+    Intervals<uint64_t> mapIntervals;
+    Intervals<uint64_t, IntervalsVectorMap<uint64_t>> vecIntervals;
+    Intervals<uint64_t, IntervalsVectorMap<uint64_t>> bulkIntervals;
+
+    PerformanceTimer timer;
+    for(const IntervalUpdate<uint64_t> &u : updates)
+      mapIntervals.update(u.start, u.finish, u.value, add);
+    double mapUpdate = timer.GetMilliseconds();
+
+    timer.Restart();
+    for(const IntervalUpdate<uint64_t> &u : updates)
+      vecIntervals.update(u.start, u.finish, u.value, add);
+    double vecUpdate = timer.GetMilliseconds();
+
+    timer.Restart();
+    bulkIntervals.update(updates, add);
+    double bulkUpdate = timer.GetMilliseconds();
+
+    uint64_t mapSum = 0, vecSum = 0;
+
+    timer.Restart();
+    for(int pass = 0; pass < 10; pass++)
+      for(auto it = mapIntervals.begin(); it != mapIntervals.end(); it++)
+        mapSum += it->value();
+    double mapIterate = timer.GetMilliseconds();
+
+    timer.Restart();
+    for(int pass = 0; pass < 10; pass++)
+      for(auto it = vecIntervals.begin(); it != vecIntervals.end(); it++)
+        vecSum += it->value();
+    double vecIterate = timer.GetMilliseconds();
+
+    CHECK(mapSum == vecSum);
+    CHECK(mapIntervals.size() == numRanges * 2);
+    CHECK(vecIntervals.size() == mapIntervals.size());
+    CHECK(bulkIntervals.size() == mapIntervals.size());
+
+    RDCLOG("%d ranges: std::map update %.2f ms, iterate x10 %.2f ms", (int)numRanges, mapUpdate,
+           mapIterate);
+    RDCLOG("%d ranges: vector update %.2f ms, bulk update %.2f ms, iterate x10 %.2f ms",
+           (int)numRanges, vecUpdate, bulkUpdate, vecIterate);
+  };
+};
+
 #endif    // ENABLED(ENABLE_UNIT_TESTS)
@@ -24,10 +24,14 @@
  ******************************************************************************/
 
 #include "remote_server.h"
+#include <algorithm>
+#include <map>
+#include <set>
 #include <utility>
 #include "android/android.h"
 #include "api/replay/renderdoc_replay.h"
 #include "api/replay/version.h"
+#include "common/threading.h"
 #include "core/core.h"
 #include "os/os_specific.h"
 #include "replay/replay_controller.h"
@@ -77,6 +81,7 @@ enum RemoteServerPacket
   eRemoteServer_GetSectionContents,
   eRemoteServer_WriteSection,
   eRemoteServer_GetAvailableGPUs,
+  eRemoteServer_GetCaptureSummaries,
   eRemoteServer_RemoteServerCount,
 };
 
@@ -120,6 +125,7 @@ rdcstr DoStringise(const RemoteServerPacket &el)
     STRINGISE_ENUM_NAMED(eRemoteServer_GetSectionContents, "GetSectionContents");
     STRINGISE_ENUM_NAMED(eRemoteServer_WriteSection, "WriteSection");
     STRINGISE_ENUM_NAMED(eRemoteServer_GetAvailableGPUs, "GetAvailableGPUs");
+    STRINGISE_ENUM_NAMED(eRemoteServer_GetCaptureSummaries, "GetCaptureSummaries");
     STRINGISE_ENUM_NAMED(eRemoteServer_RemoteServerCount, "RemoteServerCount");
   }
   END_ENUM_STRINGISE();
@@ -152,6 +158,130 @@ struct ClientThread
   Threading::ThreadHandle thread;
 };
 
+// in multi-session mode several clients can have captures open at once. Only one of them uses the
+// replay device at a time - this is held while loading, replaying or closing a capture, and is
+// uncontended with a single session. Since it's taken per packet, sessions interleave their work.
+static Threading::CriticalSection replayDeviceLock;
+
+// uploaded captures are kept in a cache keyed by a hash of their contents, so that the same capture
+// opened again - by another session, or later on - doesn't need to be transferred. The number of
+// sessions using each is tracked so that captures in use are never evicted. The cache size is set
+// from remoteserver.conf, and 0 disables it so captures are deleted once no session uses them.
+static Threading::CriticalSection sharedCaptureLock;
+static std::map<rdcstr, int32_t> sharedCaptures;
+static std::set<rdcstr> sharedCaptureUploads;
+static uint64_t captureCacheLimit = 4096ULL * 1024 * 1024;
+
+static rdcstr GetCaptureCachePath(const rdcstr &key)
+{
+  return FileIO::GetAppFolderFilename("capture_cache/" + key);
+}
+
+// the key a capture is stored under in the cache. Clients compute this to find a capture that's
+// already been uploaded, but the server always computes it itself from what it received.
+static rdcstr GetCaptureCacheKey(const rdcstr &filename)
+{
+  return StringFormat::Fmt("%016llx_%llx.rdc", HashFileContents(filename),
+                           FileIO::GetFileSize(filename));
+}
+
+static void TrimCaptureCache()
+{
+  rdcstr folder = GetCaptureCachePath("");
+
+  rdcarray<PathEntry> files;
+  FileIO::GetFilesInDirectory(folder.c_str(), files);
+
+  uint64_t totalSize = 0;
+  for(const PathEntry &f : files)
+    totalSize += f.size;
+
+  // evict the oldest first
+  std::sort(files.begin(), files.end(),
+            [](const PathEntry &a, const PathEntry &b) { return a.lastmod < b.lastmod; });
+
+  for(const PathEntry &f : files)
+  {
+    if(totalSize <= captureCacheLimit)
+      break;
+
+    rdcstr path = folder + f.filename;
+
+    if(f.flags & PathProperty::Directory)
+      continue;
+
+    if(sharedCaptures.find(path) != sharedCaptures.end() ||
+       sharedCaptureUploads.find(path) != sharedCaptureUploads.end())
+      continue;
+
+    RDCLOG("Evicting '%s' from capture cache", path.c_str());
+
+    FileIO::Delete(path.c_str());
+    totalSize -= f.size;
+  }
+}
+
+static bool AcquireSharedCapture(const rdcstr &path)
+{
+  SCOPED_LOCK(sharedCaptureLock);
+
+  if(!FileIO::exists(path.c_str()))
+    return false;
+
+  sharedCaptures[path]++;
+  return true;
+}
+
+static bool PublishSharedCapture(const rdcstr &partialPath, const rdcstr &path)
+{
+  SCOPED_LOCK(sharedCaptureLock);
+
+  // can't replace a copy another session is still using
+  if(sharedCaptures.find(path) != sharedCaptures.end())
+    return false;
+
+  if(!FileIO::Move(partialPath.c_str(), path.c_str(), true))
+    return false;
+
+  sharedCaptures[path] = 1;
+
+  // the new capture is in use so it won't be evicted, but it may push older ones over the limit
+  if(captureCacheLimit > 0)
+    TrimCaptureCache();
+
+  return true;
+}
+
+static void ReleaseSharedCapture(const rdcstr &path)
+{
+  SCOPED_LOCK(sharedCaptureLock);
+
+  auto it = sharedCaptures.find(path);
+  if(it == sharedCaptures.end())
+    return;
+
+  if(--it->second <= 0)
+  {
+    sharedCaptures.erase(it);
+
+    if(captureCacheLimit == 0)
+      FileIO::Delete(path.c_str());
+    else
+      TrimCaptureCache();
+  }
+}
+
+// mark a partial upload as in progress, so it isn't evicted from underneath us
+static void SetCaptureUploading(const rdcstr &partialPath, bool uploading)
+{
+  SCOPED_LOCK(sharedCaptureLock);
+
+  if(uploading)
+    sharedCaptureUploads.insert(partialPath);
+  else
+    sharedCaptureUploads.erase(partialPath);
+}
+
 static void InactiveRemoteClientThread(ClientThread *threadData)
 {
   Threading::SetCurrentThreadName("InactiveRemoteClientThread");
@@ -266,6 +396,7 @@ static void ActiveRemoteClientThread(ClientThread *threadData,
   }
 
   rdcarray<rdcstr> tempFiles;
+  rdcarray<rdcstr> sharedFiles;
   IRemoteDriver *remoteDriver = NULL;
   IReplayDriver *replayDriver = NULL;
   ReplayProxy *proxy = NULL;
@@ -360,13 +491,60 @@ static void ActiveRemoteClientThread(ClientThread *threadData,
         SERIALISE_ELEMENT(files);
       }
     }
+    else if(type == eRemoteServer_GetCaptureSummaries)
+    {
+      rdcarray<rdcstr> paths;
+      FileType thumbType = FileType::JPG;
+      uint32_t maxThumbSize = 0;
+
+      {
+        READ_DATA_SCOPE();
+        SERIALISE_ELEMENT(paths);
+        SERIALISE_ELEMENT(thumbType);
+        SERIALISE_ELEMENT(maxThumbSize);
+      }
+
+      reader.EndChunk();
+
+      rdcarray<CaptureSummary> summaries;
+      summaries.resize(paths.size());
+
+      // this only reads the file headers and thumbnail, so it's cheap enough to do for many files
+      ICaptureFile *file = RENDERDOC_OpenCaptureFile();
+
+      for(size_t i = 0; i < paths.size(); i++)
+      {
+        CaptureSummary &summary = summaries[i];
+        summary.path = paths[i];
+        summary.status = file->OpenFile(paths[i].c_str(), "rdc", NULL);
+
+        if(summary.status == ReplayStatus::Succeeded)
+        {
+          summary.driverName = file->DriverName();
+          summary.machineIdent = file->RecordedMachineIdent();
+          summary.fileSize = FileIO::GetFileSize(paths[i].c_str());
+          summary.thumbnail = file->GetThumbnail(thumbType, maxThumbSize);
+        }
+      }
+
+      file->Shutdown();
+
+      {
+        WRITE_DATA_SCOPE();
+        SCOPED_SERIALISE_CHUNK(eRemoteServer_GetCaptureSummaries);
+        SERIALISE_ELEMENT(summaries);
+      }
+    }
     else if(type == eRemoteServer_CopyCaptureFromRemote)
     {
       rdcstr path;
+      uint64_t resumeOffset = 0, resumeChecksum = 0;
 
       {
         READ_DATA_SCOPE();
         SERIALISE_ELEMENT(path);
+        SERIALISE_ELEMENT(resumeOffset);
+        SERIALISE_ELEMENT(resumeChecksum);
       }
 
       reader.EndChunk();
@@ -375,41 +553,157 @@ static void ActiveRemoteClientThread(ClientThread *threadData,
         WRITE_DATA_SCOPE();
         SCOPED_SERIALISE_CHUNK(eRemoteServer_CopyCaptureFromRemote);
 
-        StreamReader fileStream(FileIO::fopen(path.c_str(), "rb"));
-        ser.SerialiseStream(path, fileStream);
+        uint64_t totalSize = FileIO::GetFileSize(path);
+        uint64_t startOffset = ValidateFileTransferResumePoint(path, resumeOffset, resumeChecksum);
+        SERIALISE_ELEMENT(totalSize);
+        SERIALISE_ELEMENT(startOffset);
+
+        SendFileBlocks(ser.GetWriter(), path, startOffset, totalSize, NULL);
       }
     }
     else if(type == eRemoteServer_CopyCaptureToRemote)
     {
-      rdcstr path;
-      rdcstr dummy, dummy2;
-      FileIO::GetDefaultFiles("remotecopy", path, dummy, dummy2);
+      rdcstr key;
+      uint64_t totalSize = 0;
 
-      RDCLOG("Copying file to local path '%s'.", path.c_str());
+      {
+        READ_DATA_SCOPE();
+        SERIALISE_ELEMENT(key);
+        SERIALISE_ELEMENT(totalSize);
+      }
 
-      FileIO::CreateParentDirectory(path);
+      reader.EndChunk();
+
+      // the client identifies the file by its contents, so that if a previous attempt was
+      // interrupted we can pick up where it left off, and if it's already in the capture cache we
+      // don't need it again. Only allow safe characters since it becomes part of a filename.
+      for(char &c : key)
+      {
+        bool safe = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') ||
+                    c == '_' || c == '-' || c == '.';
+        if(!safe)
+          c = '_';
+      }
+
+      rdcstr sharedPath = GetCaptureCachePath(key);
+      rdcstr partialPath = sharedPath + ".partial";
+
+      bool shared = AcquireSharedCapture(sharedPath);
+
+      {
+        WRITE_DATA_SCOPE();
+        SCOPED_SERIALISE_CHUNK(eRemoteServer_CopyCaptureToRemote);
+
+        uint64_t resumeOffset = 0, resumeChecksum = 0;
+        if(shared)
+        {
+          // offer the whole file, the client will check it matches
+          resumeOffset = totalSize;
+          resumeChecksum = GetFileTransferChecksum(sharedPath, totalSize);
+        }
+        else
+        {
+          GetFileTransferResumePoint(partialPath, resumeOffset, resumeChecksum);
+        }
+        SERIALISE_ELEMENT(resumeOffset);
+        SERIALISE_ELEMENT(resumeChecksum);
+      }
+
+      bool complete = false;
+      uint64_t startOffset = 0;
 
       {
         READ_DATA_SCOPE();
 
-        StreamWriter streamWriter(FileIO::fopen(path.c_str(), "wb"), Ownership::Stream);
+        type = ser.ReadChunk<RemoteServerPacket>();
 
-        ser.SerialiseStream(path.c_str(), streamWriter, NULL);
+        SERIALISE_ELEMENT(startOffset);
+
+        if(shared && startOffset != totalSize)
+        {
+          ReleaseSharedCapture(sharedPath);
+          shared = false;
+        }
+
+        if(type == eRemoteServer_CopyCaptureToRemote && !ser.IsErrored())
+        {
+          if(shared)
+          {
+            complete = true;
+          }
+          else
+          {
+            SetCaptureUploading(partialPath, true);
+            complete =
+                ReceiveFileBlocks(ser.GetReader(), partialPath, startOffset, totalSize, NULL);
+            SetCaptureUploading(partialPath, false);
+          }
+        }
       }
 
       reader.EndChunk();
 
       if(reader.IsErrored())
       {
-        FileIO::Delete(path.c_str());
+        if(shared)
+          ReleaseSharedCapture(sharedPath);
 
-        RDCERR("Network error receiving file");
+        RDCERR("Network error receiving file, keeping partial copy to resume");
         break;
       }
 
-      RDCLOG("File received.");
+      rdcstr path;
 
-      tempFiles.push_back(path);
+      if(shared)
+      {
+        RDCLOG("Using already uploaded capture '%s'.", sharedPath.c_str());
+        path = sharedPath;
+        sharedFiles.push_back(path);
+      }
+      else if(complete)
+      {
+        // the client's key only says where to look for an existing copy. Hash what we actually
+        // received so that the cache never holds a capture under a key that doesn't match its
+        // contents, since the resume checksum only covers the end of the file.
+        rdcstr receivedKey = GetCaptureCacheKey(partialPath);
+        if(receivedKey != key)
+        {
+          RDCWARN("Received capture doesn't match its key '%s', storing as '%s'", key.c_str(),
+                  receivedKey.c_str());
+          sharedPath = GetCaptureCachePath(receivedKey);
+        }
+
+        // if no other session is using the cached copy, move the file there so later uploads of the
+        // same capture can use it. Otherwise it's ours alone.
+        if(PublishSharedCapture(partialPath, sharedPath))
+        {
+          path = sharedPath;
+          sharedFiles.push_back(path);
+        }
+        else
+        {
+          rdcstr dummy, dummy2;
+          FileIO::GetDefaultFiles("remotecopy", path, dummy, dummy2);
+
+          FileIO::CreateParentDirectory(path);
+
+          if(FileIO::Move(partialPath.c_str(), path.c_str(), true))
+          {
+            tempFiles.push_back(path);
+          }
+          else
+          {
+            RDCERR("Couldn't move received file into place");
+            path.clear();
+          }
+        }
+
+        RDCLOG("File received to local path '%s'.", path.c_str());
+      }
+      else
+      {
+        RDCERR("File was corrupted in transfer");
+      }
 
       {
         WRITE_DATA_SCOPE();
@@ -471,6 +765,8 @@ static void ActiveRemoteClientThread(ClientThread *threadData,
 
       reader.EndChunk();
 
+      SCOPED_LOCK(replayDeviceLock);
+
       RDCASSERT(remoteDriver == NULL && proxy == NULL && rdc == NULL);
       ReplayStatus status = ReplayStatus::InternalError;
 
@@ -551,6 +847,8 @@ static void ActiveRemoteClientThread(ClientThread *threadData,
           if(status == ReplayStatus::Succeeded && remoteDriver)
           {
             proxy = new ReplayProxy(reader, writer, remoteDriver, replayDriver, previewWindow);
+            proxy->SetLocalConnection(Network::MatchIPMask(ip, Network::MakeIP(127, 0, 0, 1),
+                                                           Network::MakeIP(255, 0, 0, 0)));
           }
         }
         else
@@ -647,12 +945,11 @@ static void ActiveRemoteClientThread(ClientThread *threadData,
 
       if(resolver)
       {
-        StackFrames.reserve(StackAddresses.size());
-        for(uint64_t frame : StackAddresses)
-        {
-          Callstack::AddressDetails info = resolver->GetAddr(frame);
+        rdcarray<Callstack::AddressDetails> details = resolver->GetAddrs(StackAddresses);
+
+        StackFrames.reserve(details.size());
+        for(Callstack::AddressDetails &info : details)
           StackFrames.push_back(info.formattedString());
-        }
       }
       else
       {
@@ -817,6 +1114,8 @@ static void ActiveRemoteClientThread(ClientThread *threadData,
     {
       reader.EndChunk();
 
+      SCOPED_LOCK(replayDeviceLock);
+
       SAFE_DELETE(proxy);
 
       if(remoteDriver)
@@ -867,7 +1166,12 @@ static void ActiveRemoteClientThread(ClientThread *threadData,
     }
     else if((int)type >= eReplayProxy_First && proxy)
     {
-      bool ok = proxy->Tick(type);
+      bool ok = false;
+
+      {
+        SCOPED_LOCK(replayDeviceLock);
+        ok = proxy->Tick(type);
+      }
 
       if(!ok)
         break;
@@ -876,20 +1180,27 @@ static void ActiveRemoteClientThread(ClientThread *threadData,
     }
   }
 
-  SAFE_DELETE(proxy);
+  {
+    SCOPED_LOCK(replayDeviceLock);
+
+    SAFE_DELETE(proxy);
 
-  if(remoteDriver)
-    remoteDriver->Shutdown();
-  remoteDriver = NULL;
-  replayDriver = NULL;
-  SAFE_DELETE(rdc);
-  SAFE_DELETE(resolver);
+    if(remoteDriver)
+      remoteDriver->Shutdown();
+    remoteDriver = NULL;
+    replayDriver = NULL;
+    SAFE_DELETE(rdc);
+    SAFE_DELETE(resolver);
+  }
 
   for(size_t i = 0; i < tempFiles.size(); i++)
   {
     FileIO::Delete(tempFiles[i].c_str());
   }
 
+  for(const rdcstr &path : sharedFiles)
+    ReleaseSharedCapture(path);
+
   RDCLOG("Closing active connection from %u.%u.%u.%u.", Network::GetIPOctet(ip, 0),
          Network::GetIPOctet(ip, 1), Network::GetIPOctet(ip, 2), Network::GetIPOctet(ip, 3));
 
@@ -909,6 +1220,8 @@ void RenderDoc::BecomeRemoteServer(const char *listenhost, uint16_t port,
 
   rdcarray<rdcpair<uint32_t, uint32_t> > listenRanges;
   bool allowExecution = true;
+  uint32_t maxSessions = 1;
+  uint64_t cacheLimitMB = captureCacheLimit / (1024 * 1024);
 
   FILE *f = FileIO::fopen(FileIO::GetAppFolderFilename("remoteserver.conf").c_str(), "r");
 
@@ -964,6 +1277,26 @@ void RenderDoc::BecomeRemoteServer(const char *listenhost, uint16_t port,
 
       continue;
     }
+    else if(line.substr(0, sizeof("capturecache") - 1) == "capturecache")
+    {
+      const char *val = line.c_str() + sizeof("capturecache");
+
+      if(*val >= '0' && *val <= '9')
+      {
+        cacheLimitMB = strtoull(val, NULL, 10);
+        continue;
+      }
+    }
+    else if(line.substr(0, sizeof("sessions") - 1) == "sessions")
+    {
+      int sessions = atoi(line.c_str() + sizeof("sessions"));
+
+      if(sessions >= 1)
+      {
+        maxSessions = (uint32_t)sessions;
+        continue;
+      }
+    }
 
     RDCLOG("Malformed line '%s'. See documentation for file format.", line.c_str());
   }
@@ -998,9 +1331,19 @@ void RenderDoc::BecomeRemoteServer(const char *listenhost, uint16_t port,
   else
     RDCLOG("Blocking execution commands");
 
+  if(maxSessions > 1)
+    RDCLOG("Allowing up to %u concurrent sessions", maxSessions);
+
+  captureCacheLimit = cacheLimitMB * 1024 * 1024;
+
+  if(captureCacheLimit > 0)
+    RDCLOG("Caching up to %llu MB of uploaded captures", cacheLimitMB);
+  else
+    RDCLOG("Not caching uploaded captures");
+
   RDCLOG("Replay host ready for requests...");
 
-  ClientThread *activeClientData = NULL;
+  rdcarray<ClientThread *> actives;
 
   rdcarray<ClientThread *> inactives;
 
@@ -1008,7 +1351,11 @@ void RenderDoc::BecomeRemoteServer(const char *listenhost, uint16_t port,
   {
     Network::Socket *client = sock->AcceptClient(0);
 
-    if(activeClientData && activeClientData->killServer)
+    bool killServer = false;
+    for(ClientThread *active : actives)
+      killServer |= active->killServer;
+
+    if(killServer)
       break;
 
     // reap any dead inactive threads
@@ -1024,14 +1371,20 @@ void RenderDoc::BecomeRemoteServer(const char *listenhost, uint16_t port,
       }
     }
 
-    // reap our active connection possibly
-    if(activeClientData && activeClientData->socket == NULL)
+    // reap any of our active connections that have closed
+    for(size_t i = 0; i < actives.size();)
     {
-      Threading::JoinThread(activeClientData->thread);
-      Threading::CloseThread(activeClientData->thread);
+      if(actives[i]->socket == NULL)
+      {
+        Threading::JoinThread(actives[i]->thread);
+        Threading::CloseThread(actives[i]->thread);
 
-      delete activeClientData;
-      activeClientData = NULL;
+        delete actives[i];
+        actives.erase(i);
+        continue;
+      }
+
+      i++;
     }
 
     if(client == NULL)
@@ -1075,16 +1428,23 @@ void RenderDoc::BecomeRemoteServer(const char *listenhost, uint16_t port,
       continue;
     }
 
-    if(activeClientData == NULL)
+    if(actives.size() < maxSessions)
     {
-      activeClientData = new ClientThread();
+      ClientThread *activeClientData = new ClientThread();
       activeClientData->socket = client;
       activeClientData->allowExecution = allowExecution;
 
-      activeClientData->thread = Threading::CreateThread([activeClientData, previewWindow]() {
-        ActiveRemoteClientThread(activeClientData, previewWindow);
+      // the preview window is a single window, so it's only given to a lone session
+      RENDERDOC_PreviewWindowCallback sessionPreview;
+      if(maxSessions == 1)
+        sessionPreview = previewWindow;
+
+      activeClientData->thread = Threading::CreateThread([activeClientData, sessionPreview]() {
+        ActiveRemoteClientThread(activeClientData, sessionPreview);
       });
 
+      actives.push_back(activeClientData);
+
       RDCLOG("Making active connection");
     }
     else
@@ -1102,14 +1462,14 @@ void RenderDoc::BecomeRemoteServer(const char *listenhost, uint16_t port,
     }
   }
 
-  if(activeClientData && activeClientData->socket != NULL)
+  for(ClientThread *active : actives)
   {
-    activeClientData->killThread = true;
+    active->killThread = true;
 
-    Threading::JoinThread(activeClientData->thread);
-    Threading::CloseThread(activeClientData->thread);
+    Threading::JoinThread(active->thread);
+    Threading::CloseThread(active->thread);
 
-    delete activeClientData;
+    delete active;
   }
 
   // shut down client threads
@@ -1148,6 +1508,11 @@ RENDERDOC_CreateRemoteServerConnection(const char *URL, IRemoteServer **rend)
 
     port = protocol->RemapPort(deviceID, port);
   }
+  else
+  {
+    // plain TCP connections can name a non-default port, for servers sharing a machine
+    Network::SplitHostPort(host, port);
+  }
 
   Network::Socket *sock = Network::CreateClientSocket(host.c_str(), port, 750);
 
@@ -1210,7 +1575,10 @@ RENDERDOC_CreateRemoteServerConnection(const char *URL, IRemoteServer **rend)
 #undef WRITE_DATA_SCOPE
 #undef READ_DATA_SCOPE
 #define WRITE_DATA_SCOPE() WriteSerialiser &ser = *writer;
-#define READ_DATA_SCOPE() ReadSerialiser &ser = *reader;
+#define READ_DATA_SCOPE()                  \
+  if(m_ActiveProxy)                        \
+    m_ActiveProxy->ReadPendingResponses(); \
+  ReadSerialiser &ser = *reader;
 
 RemoteServer::RemoteServer(Network::Socket *sock, const rdcstr &deviceID)
     : m_Socket(sock), m_deviceID(deviceID)
@@ -1420,6 +1788,40 @@ rdcarray<PathEntry> RemoteServer::ListFolder(const char *path)
   return files;
 }
 
+rdcarray<CaptureSummary> RemoteServer::GetCaptureSummaries(const rdcarray<rdcstr> &paths,
+                                                           FileType thumbType,
+                                                           uint32_t maxThumbSize)
+{
+  {
+    WRITE_DATA_SCOPE();
+    SCOPED_SERIALISE_CHUNK(eRemoteServer_GetCaptureSummaries);
+    SERIALISE_ELEMENT(paths);
+    SERIALISE_ELEMENT(thumbType);
+    SERIALISE_ELEMENT(maxThumbSize);
+  }
+
+  rdcarray<CaptureSummary> summaries;
+
+  {
+    READ_DATA_SCOPE();
+
+    RemoteServerPacket type = ser.ReadChunk<RemoteServerPacket>();
+
+    if(type == eRemoteServer_GetCaptureSummaries)
+    {
+      SERIALISE_ELEMENT(summaries);
+    }
+    else
+    {
+      RDCERR("Unexpected response to capture summaries request");
+    }
+
+    ser.EndChunk();
+  }
+
+  return summaries;
+}
+
 ExecuteResult RemoteServer::ExecuteAndInject(const char *a, const char *w, const char *c,
                                              const rdcarray<EnvironmentModification> &env,
                                              const CaptureOptions &opts)
@@ -1464,10 +1866,18 @@ void RemoteServer::CopyCaptureFromRemote(const char *remotepath, const char *loc
 {
   rdcstr path = remotepath;
 
+  // receive into a partial file first, so that if the connection drops a later copy can resume
+  rdcstr partialPath = rdcstr(localpath) + ".partial";
+
+  uint64_t resumeOffset = 0, resumeChecksum = 0;
+  GetFileTransferResumePoint(partialPath, resumeOffset, resumeChecksum);
+
   {
     WRITE_DATA_SCOPE();
     SCOPED_SERIALISE_CHUNK(eRemoteServer_CopyCaptureFromRemote);
     SERIALISE_ELEMENT(path);
+    SERIALISE_ELEMENT(resumeOffset);
+    SERIALISE_ELEMENT(resumeChecksum);
   }
 
   {
@@ -1476,15 +1886,21 @@ void RemoteServer::CopyCaptureFromRemote(const char *remotepath, const char *loc
 
     if(type == eRemoteServer_CopyCaptureFromRemote)
     {
-      StreamWriter streamWriter(FileIO::fopen(localpath, "wb"), Ownership::Stream);
+      uint64_t totalSize = 0, startOffset = 0;
+      SERIALISE_ELEMENT(totalSize);
+      SERIALISE_ELEMENT(startOffset);
 
-      ser.SerialiseStream(localpath, streamWriter, progress);
+      bool complete =
+          ReceiveFileBlocks(ser.GetReader(), partialPath, startOffset, totalSize, progress);
 
       if(ser.IsErrored())
       {
-        RDCERR("Network error receiving file");
+        RDCERR("Network error receiving file, keeping partial copy to resume");
         return;
       }
+
+      if(!complete || !FileIO::Move(partialPath.c_str(), localpath, true))
+        RDCERR("Failed to receive '%s'", remotepath);
     }
     else
     {
@@ -1497,21 +1913,50 @@ void RemoteServer::CopyCaptureFromRemote(const char *remotepath, const char *loc
 
 rdcstr RemoteServer::CopyCaptureToRemote(const char *filename, RENDERDOC_ProgressCallback progress)
 {
-  FILE *fileHandle = FileIO::fopen(filename, "rb");
-
-  if(!fileHandle)
+  if(!FileIO::exists(filename))
   {
     RDCERR("Can't open file '%s'", filename);
     return "";
   }
 
+  uint64_t totalSize = FileIO::GetFileSize(filename);
+
+  // identify the file to the server by its contents. If it's been uploaded before the server may
+  // already have it, or a partial copy from an attempt that was interrupted. The resume checksum
+  // catches any false matches.
+  rdcstr key = GetCaptureCacheKey(filename);
+
   {
     WRITE_DATA_SCOPE();
     SCOPED_SERIALISE_CHUNK(eRemoteServer_CopyCaptureToRemote);
+    SERIALISE_ELEMENT(key);
+    SERIALISE_ELEMENT(totalSize);
+  }
+
+  uint64_t startOffset = 0;
+
+  {
+    READ_DATA_SCOPE();
+    RemoteServerPacket type = ser.ReadChunk<RemoteServerPacket>();
 
-    // this will take ownership of and close the file
-    StreamReader fileStream(fileHandle);
-    ser.SerialiseStream(filename, fileStream, progress);
+    uint64_t resumeOffset = 0, resumeChecksum = 0;
+    SERIALISE_ELEMENT(resumeOffset);
+    SERIALISE_ELEMENT(resumeChecksum);
+
+    if(type == eRemoteServer_CopyCaptureToRemote)
+      startOffset = ValidateFileTransferResumePoint(filename, resumeOffset, resumeChecksum);
+    else
+      RDCERR("Unexpected response to capture copy request");
+
+    ser.EndChunk();
+  }
+
+  {
+    WRITE_DATA_SCOPE();
+    SCOPED_SERIALISE_CHUNK(eRemoteServer_CopyCaptureToRemote);
+    SERIALISE_ELEMENT(startOffset);
+
+    SendFileBlocks(ser.GetWriter(), filename, startOffset, totalSize, progress);
   }
 
   rdcstr path;
@@ -1648,6 +2093,7 @@ rdcpair<ReplayStatus, IReplayController *> RemoteServer::OpenCapture(
 
   // ReplayController takes ownership of the ProxySerialiser (as IReplayDriver)
   // and it cleans itself up in Shutdown.
+  m_ActiveProxy = proxy;
 
   RDCLOG("Remote capture open complete & proxy ready");
 
@@ -1658,6 +2104,10 @@ rdcpair<ReplayStatus, IReplayController *> RemoteServer::OpenCapture(
 
 void RemoteServer::CloseCapture(IReplayController *rend)
 {
+  if(m_ActiveProxy)
+    m_ActiveProxy->ReadPendingResponses();
+  m_ActiveProxy = NULL;
+
   {
     WRITE_DATA_SCOPE();
     SCOPED_SERIALISE_CHUNK(eRemoteServer_CloseLog);
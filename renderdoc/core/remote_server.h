@@ -36,6 +36,7 @@ enum class RDCDriver : uint32_t;
 
 class WriteSerialiser;
 class ReadSerialiser;
+class ReplayProxy;
 
 struct RemoteServer : public IRemoteServer
 {
@@ -59,6 +60,9 @@ public:
 
   virtual rdcarray<PathEntry> ListFolder(const char *path);
 
+  virtual rdcarray<CaptureSummary> GetCaptureSummaries(const rdcarray<rdcstr> &paths,
+                                                       FileType thumbType, uint32_t maxThumbSize);
+
   virtual ExecuteResult ExecuteAndInject(const char *a, const char *w, const char *c,
                                          const rdcarray<EnvironmentModification> &env,
                                          const CaptureOptions &opts);
@@ -107,4 +111,8 @@ protected:
   rdcstr m_deviceID;
 
   rdcarray<rdcpair<RDCDriver, rdcstr>> m_Proxies;
+
+  // the proxy for the currently open capture, which shares our connection. It may have responses
+  // outstanding that need to be read before we read anything ourselves.
+  ReplayProxy *m_ActiveProxy = NULL;
 };
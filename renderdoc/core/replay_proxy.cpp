@@ -25,8 +25,12 @@
 
 #include "replay_proxy.h"
 #include <list>
+#include <set>
 #include "3rdparty/lz4/lz4.h"
+#include "3rdparty/zstd/xxhash.h"
 #include "serialise/lz4io.h"
+#include "serialise/zstdio.h"
+#include "strings/string_utils.h"
 
 template <>
 rdcstr DoStringise(const ReplayProxyPacket &el)
@@ -87,6 +91,7 @@ rdcstr DoStringise(const ReplayProxyPacket &el)
     STRINGISE_ENUM_NAMED(eReplayProxy_RenderOverlay, "RenderOverlay");
 
     STRINGISE_ENUM_NAMED(eReplayProxy_PixelHistory, "PixelHistory");
+    STRINGISE_ENUM_NAMED(eReplayProxy_BatchPixelHistory, "BatchPixelHistory");
 
     STRINGISE_ENUM_NAMED(eReplayProxy_DisassembleShader, "DisassembleShader");
     STRINGISE_ENUM_NAMED(eReplayProxy_GetDisassemblyTargets, "GetDisassemblyTargets");
@@ -95,10 +100,62 @@ rdcstr DoStringise(const ReplayProxyPacket &el)
     STRINGISE_ENUM_NAMED(eReplayProxy_GetDriverInfo, "GetDriverInfo");
 
     STRINGISE_ENUM_NAMED(eReplayProxy_ContinueDebug, "ContinueDebug");
+
+    STRINGISE_ENUM_NAMED(eReplayProxy_GetTexturePreviewData, "GetTexturePreviewData");
+    STRINGISE_ENUM_NAMED(eReplayProxy_GetStructuredChunks, "GetStructuredChunks");
+
+    STRINGISE_ENUM_NAMED(eReplayProxy_GetOverdrawStatistics, "GetOverdrawStatistics");
+
+    STRINGISE_ENUM_NAMED(eReplayProxy_GetMemoryUsage, "GetMemoryUsage");
+    STRINGISE_ENUM_NAMED(eReplayProxy_EvictCache, "EvictCache");
   }
   END_ENUM_STRINGISE();
 }
 
+template <>
+rdcstr DoStringise(const ProxyCompression &el)
+{
+  BEGIN_ENUM_STRINGISE(ProxyCompression);
+  {
+    STRINGISE_ENUM_CLASS(None);
+    STRINGISE_ENUM_CLASS(LZ4);
+    STRINGISE_ENUM_CLASS(ZstdFast);
+    STRINGISE_ENUM_CLASS(Zstd);
+    STRINGISE_ENUM_CLASS(ZstdMax);
+    STRINGISE_ENUM_CLASS(Count);
+  }
+  END_ENUM_STRINGISE();
+}
+
+// transfers smaller than this are dominated by latency rather than bandwidth, so they aren't used
+// to measure codec throughput
+static const uint64_t CompressionMeasureMinSize = 1024 * 1024;
+
+// how often (in large transfers) to try a neighbouring codec to see if it does better
+static const uint32_t CompressionProbeInterval = 8;
+
+// forwards data unmodified, used for uncompressed transfers so they can share the same path as the
+// compressed ones
+class PassthroughCompressor : public Compressor
+{
+public:
+  PassthroughCompressor(StreamWriter *write) : Compressor(write, Ownership::Nothing) {}
+  bool Write(const void *data, uint64_t numBytes) { return m_Write->Write(data, numBytes); }
+  bool Finish() { return true; }
+};
+
+class PassthroughDecompressor : public Decompressor
+{
+public:
+  PassthroughDecompressor(StreamReader *read) : Decompressor(read, Ownership::Nothing) {}
+  bool Recompress(Compressor *comp)
+  {
+    RDCERR("Recompressing a proxy transfer is not supported");
+    return false;
+  }
+  bool Read(void *data, uint64_t numBytes) { return m_Read->Read(data, numBytes); }
+};
+
 // utility macros for implementing proxied functions
 
 // begins a chunk with the given packet type, and if reading verifies that the
@@ -116,12 +173,15 @@ rdcstr DoStringise(const ReplayProxyPacket &el)
   if(ser.IsWriting())              \
     ser.BeginChunk(packet, 0);
 
-// end the set of parameters, and that chunk.
+// end the set of parameters, and that chunk. On the host side, once the request is sent we read the
+// responses of any earlier deferred calls so that they're out of the way of this call's response.
 #define END_PARAMS()                                \
   {                                                 \
     GET_SERIALISER.Serialise("packet"_lit, packet); \
     ser.EndChunk();                                 \
     CheckError(packet, expectedPacket);             \
+    if(ser.IsWriting())                             \
+      ReadPendingResponses();                       \
   }
 
 // begin serialising a return value. We begin a chunk here in either the writing or reading case
@@ -148,6 +208,18 @@ rdcstr DoStringise(const ReplayProxyPacket &el)
     CheckError(packet, expectedPacket); \
   }
 
+// for void functions that return nothing, the host doesn't need to wait for the remote side to
+// finish before carrying on. Instead the response is read after the next request has been sent, so
+// e.g. the pair of ReplayLog calls and SavePipelineState when changing event cost one round trip
+// rather than three. Responses still come back in order, so there's no need to match them up.
+// This must come before REMOTE_EXECUTION(), which would otherwise wait for the remote side.
+#define DEFER_RETURN_VOID()               \
+  if(retser.IsReading() && !m_IsErrored)  \
+  {                                       \
+    m_PendingResponses.push_back(packet); \
+    return;                               \
+  }
+
 // defines the area where we're executing on the remote host. To avoid timeouts, the remote side
 // will pass over to a thread and begin sending periodic keepalive packets. Once complete, it will
 // send a finished packet and continue. The host side will accept any keepalive packets and continue
@@ -182,6 +254,7 @@ struct RemoteExecution
 // dispatches to the right implementation of the Proxied_ function, depending on whether we're on
 // the remote server or not.
 #define PROXY_FUNCTION(name, ...)                                     \
+  RDCPROFILE_ZONE("ReplayProxy::" #name);                             \
   PROXY_DEBUG("Proxying out %s", #name);                              \
   if(m_RemoteServer)                                                  \
     return CONCAT(Proxied_, name)(m_Reader, m_Writer, ##__VA_ARGS__); \
@@ -833,19 +906,26 @@ void ReplayProxy::Proxied_GetBufferData(ParamSerialiser &paramser, ReturnSeriali
   // to this amount.
   uint64_t dataSize = retData.size() + 2 * retser.GetChunkAlignment();
 
+  ProxyCompression compression = ProxyCompression::None;
+  if(retser.IsWriting())
+    compression = BeginCompressedTransfer(dataSize);
+
+  PerformanceTimer timer;
+
   {
     ReturnSerialiser &ser = retser;
     PACKET_HEADER(packet);
     SERIALISE_ELEMENT(packet);
     SERIALISE_ELEMENT(dataSize);
+    SERIALISE_ELEMENT(compression);
   }
 
   char empty[128] = {};
 
-  // lz4 compress
+  // compress with whichever codec the sending side picked for this transfer
   if(retser.IsReading())
   {
-    ReadSerialiser ser(new StreamReader(new LZ4Decompressor(retser.GetReader(), Ownership::Nothing),
+    ReadSerialiser ser(new StreamReader(CreateDecompressor(compression, retser.GetReader()),
                                         dataSize, Ownership::Stream),
                        Ownership::Stream);
 
@@ -860,7 +940,7 @@ void ReplayProxy::Proxied_GetBufferData(ParamSerialiser &paramser, ReturnSeriali
   }
   else
   {
-    WriteSerialiser ser(new StreamWriter(new LZ4Compressor(retser.GetWriter(), Ownership::Nothing),
+    WriteSerialiser ser(new StreamWriter(CreateCompressor(compression, retser.GetWriter()),
                                          Ownership::Stream),
                         Ownership::Stream);
 
@@ -876,6 +956,10 @@ void ReplayProxy::Proxied_GetBufferData(ParamSerialiser &paramser, ReturnSeriali
 
   retser.EndChunk();
 
+  // the chunk has been flushed to the network by now, so this covers the whole transfer
+  if(retser.IsWriting())
+    EndCompressedTransfer(compression, dataSize, timer.GetMilliseconds());
+
   CheckError(packet, expectedPacket);
 }
 
@@ -911,19 +995,26 @@ void ReplayProxy::Proxied_GetTextureData(ParamSerialiser &paramser, ReturnSerial
   // to this amount.
   uint64_t dataSize = data.size() + 2 * retser.GetChunkAlignment();
 
+  ProxyCompression compression = ProxyCompression::None;
+  if(retser.IsWriting())
+    compression = BeginCompressedTransfer(dataSize);
+
+  PerformanceTimer timer;
+
   {
     ReturnSerialiser &ser = retser;
     PACKET_HEADER(packet);
     SERIALISE_ELEMENT(packet);
     SERIALISE_ELEMENT(dataSize);
+    SERIALISE_ELEMENT(compression);
   }
 
   char empty[128] = {};
 
-  // lz4 compress
+  // compress with whichever codec the sending side picked for this transfer
   if(retser.IsReading())
   {
-    ReadSerialiser ser(new StreamReader(new LZ4Decompressor(retser.GetReader(), Ownership::Nothing),
+    ReadSerialiser ser(new StreamReader(CreateDecompressor(compression, retser.GetReader()),
                                         dataSize, Ownership::Stream),
                        Ownership::Stream);
 
@@ -938,7 +1029,7 @@ void ReplayProxy::Proxied_GetTextureData(ParamSerialiser &paramser, ReturnSerial
   }
   else
   {
-    WriteSerialiser ser(new StreamWriter(new LZ4Compressor(retser.GetWriter(), Ownership::Nothing),
+    WriteSerialiser ser(new StreamWriter(CreateCompressor(compression, retser.GetWriter()),
                                          Ownership::Stream),
                         Ownership::Stream);
 
@@ -954,6 +1045,10 @@ void ReplayProxy::Proxied_GetTextureData(ParamSerialiser &paramser, ReturnSerial
 
   retser.EndChunk();
 
+  // the chunk has been flushed to the network by now, so this covers the whole transfer
+  if(retser.IsWriting())
+    EndCompressedTransfer(compression, dataSize, timer.GetMilliseconds());
+
   CheckError(packet, expectedPacket);
 }
 
@@ -976,6 +1071,8 @@ void ReplayProxy::Proxied_InitPostVSBuffers(ParamSerialiser &paramser, ReturnSer
     END_PARAMS();
   }
 
+  DEFER_RETURN_VOID();
+
   {
     REMOTE_EXECUTION();
     if(paramser.IsReading() && !paramser.IsErrored() && !m_IsErrored)
@@ -1003,6 +1100,8 @@ void ReplayProxy::Proxied_InitPostVSBuffers(ParamSerialiser &paramser, ReturnSer
     END_PARAMS();
   }
 
+  DEFER_RETURN_VOID();
+
   {
     REMOTE_EXECUTION();
     if(paramser.IsReading() && !paramser.IsErrored() && !m_IsErrored)
@@ -1091,6 +1190,111 @@ ResourceId ReplayProxy::RenderOverlay(ResourceId texid, CompType typeCast, Float
   PROXY_FUNCTION(RenderOverlay, texid, typeCast, clearCol, overlay, eventId, passEvents);
 }
 
+template <typename ParamSerialiser, typename ReturnSerialiser>
+rdcarray<OverdrawStatistics> ReplayProxy::Proxied_GetOverdrawStatistics(ParamSerialiser &paramser,
+                                                                        ReturnSerialiser &retser)
+{
+  const ReplayProxyPacket expectedPacket = eReplayProxy_GetOverdrawStatistics;
+  ReplayProxyPacket packet = eReplayProxy_GetOverdrawStatistics;
+  rdcarray<OverdrawStatistics> ret;
+
+  {
+    BEGIN_PARAMS();
+    END_PARAMS();
+  }
+
+  {
+    REMOTE_EXECUTION();
+    if(paramser.IsReading() && !paramser.IsErrored() && !m_IsErrored)
+      ret = m_Remote->GetOverdrawStatistics();
+  }
+
+  SERIALISE_RETURN(ret);
+
+  return ret;
+}
+
+rdcarray<OverdrawStatistics> ReplayProxy::GetOverdrawStatistics()
+{
+  PROXY_FUNCTION(GetOverdrawStatistics);
+}
+
+template <typename ParamSerialiser, typename ReturnSerialiser>
+rdcarray<MemoryUsage> ReplayProxy::Proxied_GetMemoryUsage(ParamSerialiser &paramser,
+                                                          ReturnSerialiser &retser)
+{
+  const ReplayProxyPacket expectedPacket = eReplayProxy_GetMemoryUsage;
+  ReplayProxyPacket packet = eReplayProxy_GetMemoryUsage;
+  rdcarray<MemoryUsage> ret;
+
+  {
+    BEGIN_PARAMS();
+    END_PARAMS();
+  }
+
+  {
+    REMOTE_EXECUTION();
+    if(paramser.IsReading() && !paramser.IsErrored() && !m_IsErrored)
+      ret = m_Remote->GetMemoryUsage();
+  }
+
+  SERIALISE_RETURN(ret);
+
+  // the local copies of remote resource contents only exist on this side
+  if(retser.IsReading())
+  {
+    MemoryUsage proxyCache(MemoryCategory::ProxyCache, 0, 0);
+
+    for(auto it = m_ProxyTextureData.begin(); it != m_ProxyTextureData.end(); ++it)
+      proxyCache.cpuBytes += it->second.size();
+    for(auto it = m_ProxyBufferData.begin(); it != m_ProxyBufferData.end(); ++it)
+    {
+      proxyCache.cpuBytes += it->second.size();
+      proxyCache.gpuBytes += it->second.size();
+    }
+    for(auto it = m_ProxyTextures.begin(); it != m_ProxyTextures.end(); ++it)
+      proxyCache.gpuBytes += it->second.desc.byteSize;
+
+    ret.push_back(proxyCache);
+  }
+
+  return ret;
+}
+
+rdcarray<MemoryUsage> ReplayProxy::GetMemoryUsage()
+{
+  PROXY_FUNCTION(GetMemoryUsage);
+}
+
+template <typename ParamSerialiser, typename ReturnSerialiser>
+void ReplayProxy::Proxied_EvictCache(ParamSerialiser &paramser, ReturnSerialiser &retser,
+                                     MemoryCategory category)
+{
+  const ReplayProxyPacket expectedPacket = eReplayProxy_EvictCache;
+  ReplayProxyPacket packet = eReplayProxy_EvictCache;
+
+  {
+    BEGIN_PARAMS();
+    SERIALISE_ELEMENT(category);
+    END_PARAMS();
+  }
+
+  DEFER_RETURN_VOID();
+
+  {
+    REMOTE_EXECUTION();
+    if(paramser.IsReading() && !paramser.IsErrored() && !m_IsErrored)
+      m_Remote->EvictCache(category);
+  }
+
+  SERIALISE_RETURN_VOID();
+}
+
+void ReplayProxy::EvictCache(MemoryCategory category)
+{
+  PROXY_FUNCTION(EvictCache, category);
+}
+
 template <typename ParamSerialiser, typename ReturnSerialiser>
 rdcarray<ShaderEntryPoint> ReplayProxy::Proxied_GetShaderEntryPoints(ParamSerialiser &paramser,
                                                                      ReturnSerialiser &retser,
@@ -1264,6 +1468,8 @@ void ReplayProxy::Proxied_FreeTargetResource(ParamSerialiser &paramser, ReturnSe
     END_PARAMS();
   }
 
+  DEFER_RETURN_VOID();
+
   {
     REMOTE_EXECUTION();
     if(paramser.IsReading() && !paramser.IsErrored() && !m_IsErrored)
@@ -1372,6 +1578,8 @@ void ReplayProxy::Proxied_ReplaceResource(ParamSerialiser &paramser, ReturnSeria
     END_PARAMS();
   }
 
+  DEFER_RETURN_VOID();
+
   {
     REMOTE_EXECUTION();
     if(paramser.IsReading() && !paramser.IsErrored() && !m_IsErrored)
@@ -1399,6 +1607,8 @@ void ReplayProxy::Proxied_RemoveReplacement(ParamSerialiser &paramser, ReturnSer
     END_PARAMS();
   }
 
+  DEFER_RETURN_VOID();
+
   {
     REMOTE_EXECUTION();
     if(paramser.IsReading() && !paramser.IsErrored() && !m_IsErrored)
@@ -1451,6 +1661,45 @@ rdcarray<PixelModification> ReplayProxy::PixelHistory(rdcarray<EventUsage> event
   PROXY_FUNCTION(PixelHistory, events, target, x, y, sub, typeCast);
 }
 
+template <typename ParamSerialiser, typename ReturnSerialiser>
+rdcarray<PixelHistoryResult> ReplayProxy::Proxied_BatchPixelHistory(
+    ParamSerialiser &paramser, ReturnSerialiser &retser, rdcarray<EventUsage> events,
+    ResourceId target, rdcarray<uint32_t> pixels, const Subresource &sub, CompType typeCast)
+{
+  const ReplayProxyPacket expectedPacket = eReplayProxy_BatchPixelHistory;
+  ReplayProxyPacket packet = eReplayProxy_BatchPixelHistory;
+  rdcarray<PixelHistoryResult> ret;
+
+  {
+    BEGIN_PARAMS();
+    SERIALISE_ELEMENT(events);
+    SERIALISE_ELEMENT(target);
+    SERIALISE_ELEMENT(pixels);
+    SERIALISE_ELEMENT(sub);
+    SERIALISE_ELEMENT(typeCast);
+    END_PARAMS();
+  }
+
+  {
+    REMOTE_EXECUTION();
+    if(paramser.IsReading() && !paramser.IsErrored() && !m_IsErrored)
+      ret = m_Remote->BatchPixelHistory(events, target, pixels, sub, typeCast);
+  }
+
+  SERIALISE_RETURN(ret);
+
+  return ret;
+}
+
+rdcarray<PixelHistoryResult> ReplayProxy::BatchPixelHistory(rdcarray<EventUsage> events,
+                                                            ResourceId target,
+                                                            rdcarray<uint32_t> pixels,
+                                                            const Subresource &sub,
+                                                            CompType typeCast)
+{
+  PROXY_FUNCTION(BatchPixelHistory, events, target, pixels, sub, typeCast);
+}
+
 template <typename ParamSerialiser, typename ReturnSerialiser>
 ShaderDebugTrace *ReplayProxy::Proxied_DebugVertex(ParamSerialiser &paramser,
                                                    ReturnSerialiser &retser, uint32_t eventId,
@@ -1745,20 +1994,23 @@ void ReplayProxy::Proxied_ReplayLog(ParamSerialiser &paramser, ReturnSerialiser
     END_PARAMS();
   }
 
-  {
-    REMOTE_EXECUTION();
-    if(paramser.IsReading() && !paramser.IsErrored() && !m_IsErrored)
-      m_Remote->ReplayLog(endEventID, replayType);
-  }
-
   if(retser.IsReading())
   {
     m_TextureProxyCache.clear();
+    m_PreviewTextureCache.clear();
     m_BufferProxyCache.clear();
   }
 
   m_EventID = endEventID;
 
+  DEFER_RETURN_VOID();
+
+  {
+    REMOTE_EXECUTION();
+    if(paramser.IsReading() && !paramser.IsErrored() && !m_IsErrored)
+      m_Remote->ReplayLog(endEventID, replayType);
+  }
+
   SERIALISE_RETURN_VOID();
 }
 
@@ -1790,32 +2042,120 @@ void ReplayProxy::Proxied_FetchStructuredFile(ParamSerialiser &paramser, ReturnS
     ReturnSerialiser &ser = retser;
     PACKET_HEADER(packet);
 
+    // only send the chunk headers, which is enough to list the events. The contents, which can be
+    // huge in total, are fetched with GetStructuredChunks as and when they're needed.
     uint64_t chunkCount = file->chunks.size();
     SERIALISE_ELEMENT(chunkCount);
 
     if(retser.IsReading())
+    {
       file->chunks.resize((size_t)chunkCount);
+      m_StructuredChunkFetched.clear();
+      m_StructuredChunkFetched.resize((size_t)chunkCount);
+    }
 
     for(size_t c = 0; c < (size_t)chunkCount; c++)
     {
       if(retser.IsReading())
         file->chunks[c] = new SDChunk("");
 
-      ser.Serialise("chunk"_lit, *file->chunks[c]);
+      SDChunk &chunk = *file->chunks[c];
+
+      ser.Serialise("name"_lit, chunk.name);
+      ser.Serialise("type"_lit, chunk.type);
+      ser.Serialise("metadata"_lit, chunk.metadata);
     }
 
+    // similarly buffers are only sent along with the chunks that use them
     uint64_t bufferCount = file->buffers.size();
     SERIALISE_ELEMENT(bufferCount);
 
     if(retser.IsReading())
+    {
       file->buffers.resize((size_t)bufferCount);
+      for(size_t b = 0; b < (size_t)bufferCount; b++)
+        file->buffers[b] = new bytebuf;
+    }
 
-    for(size_t b = 0; b < (size_t)bufferCount; b++)
+    SERIALISE_ELEMENT(packet);
+
+    ser.EndChunk();
+  }
+
+  CheckError(packet, expectedPacket);
+}
+
+void ReplayProxy::FetchStructuredFile()
+{
+  PROXY_FUNCTION(FetchStructuredFile);
+}
+
+static void GetReferencedBuffers(const SDObject *obj, std::set<uint64_t> &buffers)
+{
+  if(obj->type.basetype == SDBasic::Buffer)
+    buffers.insert(obj->data.basic.u);
+
+  for(size_t i = 0; i < obj->NumChildren(); i++)
+    GetReferencedBuffers(obj->GetChild(i), buffers);
+}
+
+template <typename ParamSerialiser, typename ReturnSerialiser>
+void ReplayProxy::Proxied_GetStructuredChunks(ParamSerialiser &paramser, ReturnSerialiser &retser,
+                                              const rdcarray<uint32_t> &chunkIndices)
+{
+  const ReplayProxyPacket expectedPacket = eReplayProxy_GetStructuredChunks;
+  ReplayProxyPacket packet = eReplayProxy_GetStructuredChunks;
+
+  {
+    BEGIN_PARAMS();
+    SERIALISE_ELEMENT(chunkIndices);
+    END_PARAMS();
+  }
+
+  SDFile *file = &m_StructuredFile;
+  std::set<uint64_t> buffers;
+
+  {
+    REMOTE_EXECUTION();
+    if(paramser.IsReading() && !paramser.IsErrored() && !m_IsErrored)
+    {
+      file = (SDFile *)&m_Remote->GetStructuredFile();
+
+      for(uint32_t c : chunkIndices)
+        if(c < file->chunks.size())
+          GetReferencedBuffers(file->chunks[c], buffers);
+    }
+  }
+
+  {
+    ReturnSerialiser &ser = retser;
+    PACKET_HEADER(packet);
+
+    // both sides have the same number of chunks, so out of range indices are skipped on both
+    for(uint32_t c : chunkIndices)
     {
+      if(c >= file->chunks.size())
+        continue;
+
+      ser.Serialise("chunk"_lit, *file->chunks[c]);
+
       if(retser.IsReading())
-        file->buffers[b] = new bytebuf;
+        m_StructuredChunkFetched[c] = true;
+    }
+
+    uint64_t bufferCount = buffers.size();
+    SERIALISE_ELEMENT(bufferCount);
 
-      bytebuf *buf = file->buffers[b];
+    auto it = buffers.begin();
+    for(uint64_t i = 0; i < bufferCount; i++)
+    {
+      uint64_t bufferIndex = retser.IsWriting() ? *(it++) : 0;
+      SERIALISE_ELEMENT(bufferIndex);
+
+      bytebuf dummy;
+      bytebuf *buf = &dummy;
+      if(bufferIndex < file->buffers.size())
+        buf = file->buffers[(size_t)bufferIndex];
 
       ser.Serialise("buffer"_lit, *buf);
     }
@@ -1828,9 +2168,42 @@ void ReplayProxy::Proxied_FetchStructuredFile(ParamSerialiser &paramser, ReturnS
   CheckError(packet, expectedPacket);
 }
 
-void ReplayProxy::FetchStructuredFile()
+void ReplayProxy::GetStructuredChunks(const rdcarray<uint32_t> &chunkIndices)
 {
-  PROXY_FUNCTION(FetchStructuredFile);
+  PROXY_FUNCTION(GetStructuredChunks, chunkIndices);
+}
+
+void ReplayProxy::FetchStructuredChunks(const rdcarray<uint32_t> &chunkIndices)
+{
+  if(m_RemoteServer)
+    return;
+
+  // chunks near each other tend to be needed together - e.g. the events around the selected one -
+  // so fetch whole aligned batches to save on round trips.
+  const uint32_t batchSize = 64;
+  const uint32_t chunkCount = (uint32_t)m_StructuredChunkFetched.size();
+
+  rdcarray<uint32_t> fetch;
+  std::set<uint32_t> batches;
+
+  for(uint32_t c : chunkIndices)
+  {
+    if(c >= chunkCount || m_StructuredChunkFetched[c])
+      continue;
+
+    uint32_t batch = c / batchSize;
+    if(batches.find(batch) != batches.end())
+      continue;
+
+    batches.insert(batch);
+
+    for(uint32_t i = batch * batchSize; i < RDCMIN(chunkCount, (batch + 1) * batchSize); i++)
+      if(!m_StructuredChunkFetched[i])
+        fetch.push_back(i);
+  }
+
+  if(!fetch.empty())
+    GetStructuredChunks(fetch);
 }
 
 struct DeltaSection
@@ -1855,9 +2228,10 @@ void DoSerialise(SerialiserType &ser, DeltaSection &el)
 }
 
 template <typename SerialiserType>
-void ReplayProxy::DeltaTransferBytes(SerialiserType &xferser, bytebuf &referenceData, bytebuf &newData)
+void ReplayProxy::DeltaTransferBytes(SerialiserType &xferser, bytebuf &referenceData,
+                                     DeltaBlockHashes &referenceHashes, bytebuf &newData)
 {
-  // lz4 compress
+  // compressed with the current codec, which is recorded so the reading side can match it
   if(xferser.IsReading())
   {
     uint64_t uncompSize = 0;
@@ -1871,13 +2245,15 @@ void ReplayProxy::DeltaTransferBytes(SerialiserType &xferser, bytebuf &reference
     }
     else
     {
+      ProxyCompression compression = ProxyCompression::None;
+      xferser.Serialise("compression"_lit, compression);
+
       rdcarray<DeltaSection> deltas;
 
       {
-        ReadSerialiser ser(
-            new StreamReader(new LZ4Decompressor(xferser.GetReader(), Ownership::Nothing),
-                             uncompSize, Ownership::Stream),
-            Ownership::Stream);
+        ReadSerialiser ser(new StreamReader(CreateDecompressor(compression, xferser.GetReader()),
+                                            uncompSize, Ownership::Stream),
+                           Ownership::Stream);
 
         SERIALISE_ELEMENT(deltas);
 
@@ -1943,7 +2319,31 @@ void ReplayProxy::DeltaTransferBytes(SerialiserType &xferser, bytebuf &reference
     // previous ones to be reallocated and move around lots of data.
     std::list<DeltaSection> deltasList;
 
-    if(referenceData.empty())
+    // we only care about large-ish chunks at a time. This prevents us generating lots of tiny
+    // deltas where we could batch changes together. This is tuned to not be too large (and
+    // thus causing us to miss too many sections we could skip) and not too small (causing us
+    // to devolve into lots of byte-wise deltas). The current value as of this comment of 128
+    // is definitely on the small end of the range, but consider e.g. an android image of
+    // 1440x2560 and a pixel-wide line that goes vertically from top to bottom. Reading
+    // horizontally that will mean 2560 different diffs, and only actually one pixel changed.
+    // The larger this value gets, the more redundant data we'll send along with.
+    const size_t chunkSize = DeltaBlockHashes::ChunkSize;
+
+    // hash each chunk of the new data. These are compared against the hashes from the last
+    // transfer instead of keeping a full copy of the old contents around, and then stored for next
+    // time. The last chunk may be partial.
+    DeltaBlockHashes newHashes;
+    newHashes.size = newData.size();
+    newHashes.hashes.resize((newData.size() + chunkSize - 1) / chunkSize);
+
+    for(size_t i = 0; i < newHashes.hashes.size(); i++)
+    {
+      const size_t offs = i * chunkSize;
+      const size_t len = RDCMIN(chunkSize, newData.size() - offs);
+      newHashes.hashes[i] = XXH64(newData.data() + offs, len, 0);
+    }
+
+    if(referenceHashes.hashes.empty())
     {
       // no previous reference data, need to transfer the whole object.
       deltasList.resize(1);
@@ -1951,10 +2351,10 @@ void ReplayProxy::DeltaTransferBytes(SerialiserType &xferser, bytebuf &reference
     }
     else
     {
-      if(referenceData.size() != newData.size())
+      if(referenceHashes.size != newData.size())
       {
         RDCERR("Reference data existed at %llu bytes, but new data is now %llu bytes",
-               referenceData.size(), newData.size());
+               referenceHashes.size, newData.size());
 
         // re-transfer the whole block, something went seriously wrong if the resource changed size.
         deltasList.resize(1);
@@ -1964,19 +2364,6 @@ void ReplayProxy::DeltaTransferBytes(SerialiserType &xferser, bytebuf &reference
       {
         // do actual diff.
         const byte *srcBegin = newData.data();
-        const byte *src = srcBegin;
-        const byte *dst = referenceData.data();
-        size_t bytesRemain = newData.size();
-
-        // we only care about large-ish chunks at a time. This prevents us generating lots of tiny
-        // deltas where we could batch changes together. This is tuned to not be too large (and
-        // thus causing us to miss too many sections we could skip) and not too small (causing us
-        // to devolve into lots of byte-wise deltas). The current value as of this comment of 128
-        // is definitely on the small end of the range, but consider e.g. an android image of
-        // 1440x2560 and a pixel-wide line that goes vertically from top to bottom. Reading
-        // horizontally that will mean 2560 different diffs, and only actually one pixel changed.
-        // The larger this value gets, the more redundant data we'll send along with.
-        const size_t chunkSize = 128;
 
         // we use a simple state machine. Start in state 1
         //
@@ -1998,11 +2385,13 @@ void ReplayProxy::DeltaTransferBytes(SerialiserType &xferser, bytebuf &reference
         };
         DeltaState state = DeltaState::None;
 
-        // loop over whole chunks
-        while(bytesRemain > chunkSize)
+        for(size_t i = 0; i < newHashes.hashes.size(); i++)
         {
+          const byte *src = srcBegin + i * chunkSize;
+          const size_t srcSize = RDCMIN(chunkSize, newData.size() - i * chunkSize);
+
           // check if there's a difference in this chunk.
-          bool chunkDiff = memcmp(src, dst, chunkSize) != 0;
+          bool chunkDiff = newHashes.hashes[i] != referenceHashes.hashes[i];
 
           // if we're in state 1
           if(state == DeltaState::None)
@@ -2013,7 +2402,7 @@ void ReplayProxy::DeltaTransferBytes(SerialiserType &xferser, bytebuf &reference
             {
               deltasList.push_back(DeltaSection());
               deltasList.back().offs = src - srcBegin;
-              deltasList.back().contents.append(src, chunkSize);
+              deltasList.back().contents.append(src, srcSize);
 
               state = DeltaState::Active;
             }
@@ -2024,28 +2413,13 @@ void ReplayProxy::DeltaTransferBytes(SerialiserType &xferser, bytebuf &reference
             // continue to append to the delta if there's another difference in this chunk.
             if(chunkDiff)
             {
-              deltasList.back().contents.append(src, chunkSize);
+              deltasList.back().contents.append(src, srcSize);
             }
             else
             {
               state = DeltaState::None;
             }
           }
-
-          // move to the next chunk
-          bytesRemain -= chunkSize;
-          src += chunkSize;
-          dst += chunkSize;
-        }
-
-        // if there are still some bytes remaining at the end of the image, smaller than the chunk
-        // size, just diff directly and send if needed. We could combine this with the last delta if
-        // we ended in the active state.
-        if(bytesRemain > 0 && memcmp(src, dst, bytesRemain) != 0)
-        {
-          deltasList.push_back(DeltaSection());
-          deltasList.back().offs = src - srcBegin;
-          deltasList.back().contents.append(src, bytesRemain);
         }
       }
     }
@@ -2082,7 +2456,12 @@ void ReplayProxy::DeltaTransferBytes(SerialiserType &xferser, bytebuf &reference
 
     if(uncompSize > 0)
     {
-      WriteSerialiser ser(new StreamWriter(new LZ4Compressor(xferser.GetWriter(), Ownership::Nothing),
+      // deltas are part of a larger chunk so they aren't timed, they just follow the codec chosen
+      // from the bulk data transfers.
+      ProxyCompression compression = m_Compression;
+      xferser.Serialise("compression"_lit, compression);
+
+      WriteSerialiser ser(new StreamWriter(CreateCompressor(compression, xferser.GetWriter()),
                                            Ownership::Stream),
                           Ownership::Stream);
 
@@ -2099,9 +2478,10 @@ void ReplayProxy::DeltaTransferBytes(SerialiserType &xferser, bytebuf &reference
         ser.GetWriter()->Write(empty, uncompSize - offs);
     }
 
-    // This is the proxy side, so we have the complete newest contents in data. Swap the new data
-    // into refData for next time.
-    referenceData.swap(newData);
+    // This is the proxy side, so we only need to remember the hashes of the newest contents for
+    // next time.
+    referenceHashes.hashes.swap(newHashes.hashes);
+    referenceHashes.size = newHashes.size;
   }
 }
 
@@ -2132,7 +2512,7 @@ void ReplayProxy::Proxied_CacheBufferData(ParamSerialiser &paramser, ReturnSeria
     SERIALISE_ELEMENT(packet);
   }
 
-  DeltaTransferBytes(retser, m_ProxyBufferData[buff], data);
+  DeltaTransferBytes(retser, m_ProxyBufferData[buff], m_ProxyBufferHashes[buff], data);
 
   retser.EndChunk();
 
@@ -2175,7 +2555,7 @@ void ReplayProxy::Proxied_CacheTextureData(ParamSerialiser &paramser, ReturnSeri
   }
 
   TextureCacheEntry entry = {tex, sub};
-  DeltaTransferBytes(retser, m_ProxyTextureData[entry], data);
+  DeltaTransferBytes(retser, m_ProxyTextureData[entry], m_ProxyTextureHashes[entry], data);
 
   retser.EndChunk();
 
@@ -2188,6 +2568,71 @@ void ReplayProxy::CacheTextureData(ResourceId tex, const Subresource &sub,
   PROXY_FUNCTION(CacheTextureData, tex, sub, params);
 }
 
+template <typename ParamSerialiser, typename ReturnSerialiser>
+void ReplayProxy::Proxied_GetTexturePreviewData(ParamSerialiser &paramser, ReturnSerialiser &retser,
+                                                ResourceId tex, const Subresource &sub,
+                                                const GetTextureDataParams &params,
+                                                uint32_t texelSize, uint32_t stride, bytebuf &data)
+{
+  const ReplayProxyPacket expectedPacket = eReplayProxy_GetTexturePreviewData;
+  ReplayProxyPacket packet = eReplayProxy_GetTexturePreviewData;
+
+  {
+    BEGIN_PARAMS();
+    SERIALISE_ELEMENT(tex);
+    SERIALISE_ELEMENT(sub);
+    SERIALISE_ELEMENT(params);
+    SERIALISE_ELEMENT(texelSize);
+    SERIALISE_ELEMENT(stride);
+    END_PARAMS();
+  }
+
+  {
+    REMOTE_EXECUTION();
+    if(paramser.IsReading() && !paramser.IsErrored() && !m_IsErrored)
+    {
+      bytebuf full;
+      m_Remote->GetTextureData(tex, sub, params, full);
+
+      TextureDescription desc = m_Remote->GetTexture(tex);
+      const size_t width = RDCMAX(1U, desc.width >> sub.mip);
+      const size_t height = RDCMAX(1U, desc.height >> sub.mip);
+
+      data.clear();
+
+      // the data is tightly packed, so anything else means this isn't a format we can stride
+      // through. Return nothing and the host will fall back to fetching the full data.
+      if(stride > 0 && texelSize > 0 && full.size() == width * height * texelSize)
+      {
+        const size_t previewWidth = (width + stride - 1) / stride;
+        const size_t previewHeight = (height + stride - 1) / stride;
+
+        data.resize(previewWidth * previewHeight * texelSize);
+
+        byte *dst = data.data();
+        for(size_t y = 0; y < previewHeight; y++)
+        {
+          const byte *src = full.data() + y * stride * width * texelSize;
+          for(size_t x = 0; x < previewWidth; x++)
+          {
+            memcpy(dst, src + x * stride * texelSize, texelSize);
+            dst += texelSize;
+          }
+        }
+      }
+    }
+  }
+
+  SERIALISE_RETURN(data);
+}
+
+void ReplayProxy::GetTexturePreviewData(ResourceId tex, const Subresource &sub,
+                                        const GetTextureDataParams &params, uint32_t texelSize,
+                                        uint32_t stride, bytebuf &data)
+{
+  PROXY_FUNCTION(GetTexturePreviewData, tex, sub, params, texelSize, stride, data);
+}
+
 #pragma endregion Proxied Functions
 
 // If a remap is required, modify the params that are used when getting the proxy texture data
@@ -2320,23 +2765,9 @@ void ReplayProxy::EnsureTexCached(ResourceId &texid, CompType typeCast, const Su
     }
   }
 
-  auto proxyit = m_ProxyTextures.find(texid);
-
   if(m_TextureProxyCache.find(entry) == m_TextureProxyCache.end())
   {
-    if(proxyit == m_ProxyTextures.end())
-    {
-      TextureDescription tex = GetTexture(texid);
-
-      ProxyTextureProperties proxy;
-      RemapProxyTextureIfNeeded(tex, proxy.params);
-
-      proxy.id = m_Proxy->CreateProxyTexture(tex);
-      proxy.msSamp = RDCMAX(1U, tex.msSamp);
-      proxyit = m_ProxyTextures.insert(std::make_pair(texid, proxy)).first;
-    }
-
-    const ProxyTextureProperties &proxy = proxyit->second;
+    const ProxyTextureProperties &proxy = GetProxyTexture(texid);
 
     for(uint32_t sample = 0; sample < proxy.msSamp; sample++)
     {
@@ -2364,7 +2795,127 @@ void ReplayProxy::EnsureTexCached(ResourceId &texid, CompType typeCast, const Su
   }
 
   // change texid to the proxy texture's ID for passing to our proxy renderer
-  texid = proxyit->second.id;
+  texid = GetProxyTexture(texid).id;
+}
+
+ReplayProxy::ProxyTextureProperties &ReplayProxy::GetProxyTexture(ResourceId texid)
+{
+  auto proxyit = m_ProxyTextures.find(texid);
+
+  if(proxyit == m_ProxyTextures.end())
+  {
+    TextureDescription tex = GetTexture(texid);
+
+    ProxyTextureProperties proxy;
+    RemapProxyTextureIfNeeded(tex, proxy.params);
+
+    proxy.id = m_Proxy->CreateProxyTexture(tex);
+    proxy.msSamp = RDCMAX(1U, tex.msSamp);
+    proxy.desc = tex;
+    proxyit = m_ProxyTextures.insert(std::make_pair(texid, proxy)).first;
+  }
+
+  return proxyit->second;
+}
+
+bool ReplayProxy::EnsurePreviewCached(TextureDisplay &cfg)
+{
+  // below this many texels the full subresource is cheap enough to just transfer
+  const uint64_t minPreviewTexels = 2048 * 2048;
+  const uint32_t maxPreviewStride = 64;
+
+  if(m_Reader.IsErrored() || m_Writer.IsErrored())
+    return false;
+
+  if(cfg.resourceId == ResourceId() ||
+     m_LocalTextures.find(cfg.resourceId) != m_LocalTextures.end())
+    return false;
+
+  // point sampling is only lossless-looking when several texels land on each display pixel
+  if(cfg.scale <= 0.0f || cfg.scale > 0.5f)
+    return false;
+
+  auto infoit = m_TextureInfo.find(cfg.resourceId);
+  if(infoit == m_TextureInfo.end())
+    return false;
+
+  const TextureDescription &info = infoit->second;
+
+  if(info.dimension != 2 || info.msSamp > 1)
+    return false;
+
+  TextureCacheEntry entry = {cfg.resourceId, cfg.subresource};
+  if(info.mips <= 1)
+    entry.sub.mip = 0;
+  if(info.arraysize <= 1)
+    entry.sub.slice = 0;
+  entry.sub.sample = 0;
+
+  // if we already have the full data at this event, there's no reason to use anything less
+  if(m_TextureProxyCache.find(entry) != m_TextureProxyCache.end())
+    return false;
+
+  const uint32_t width = RDCMAX(1U, info.width >> entry.sub.mip);
+  const uint32_t height = RDCMAX(1U, info.height >> entry.sub.mip);
+
+  if(uint64_t(width) * height < minPreviewTexels)
+    return false;
+
+  const ProxyTextureProperties &proxy = GetProxyTexture(cfg.resourceId);
+
+  // block-compressed and packed formats can't be strided through by texel
+  if(proxy.desc.format.Special())
+    return false;
+
+  const uint32_t texelSize = proxy.desc.format.compCount * proxy.desc.format.compByteWidth;
+
+  uint32_t stride = 1;
+  while(stride < maxPreviewStride && cfg.scale * stride * 2 <= 1.0f)
+    stride *= 2;
+
+  TexturePreviewKey key = {entry, stride};
+
+  auto previewit = m_PreviewTextures.find(key);
+
+  if(m_PreviewTextureCache.find(key) == m_PreviewTextureCache.end())
+  {
+    GetTextureDataParams params = proxy.params;
+    params.typeCast = cfg.typeCast;
+
+    bytebuf data;
+    GetTexturePreviewData(cfg.resourceId, entry.sub, params, texelSize, stride, data);
+
+    const uint32_t previewWidth = (width + stride - 1) / stride;
+    const uint32_t previewHeight = (height + stride - 1) / stride;
+
+    if(data.size() != size_t(previewWidth) * previewHeight * texelSize)
+      return false;
+
+    if(previewit == m_PreviewTextures.end())
+    {
+      TextureDescription tex = proxy.desc;
+      tex.type = TextureType::Texture2D;
+      tex.width = previewWidth;
+      tex.height = previewHeight;
+      tex.depth = 1;
+      tex.mips = 1;
+      tex.arraysize = 1;
+      tex.cubemap = false;
+
+      ResourceId previewId = m_Proxy->CreateProxyTexture(tex);
+      previewit = m_PreviewTextures.insert(std::make_pair(key, previewId)).first;
+    }
+
+    m_Proxy->SetProxyTextureData(previewit->second, Subresource(), data.data(), data.size());
+
+    m_PreviewTextureCache.insert(key);
+  }
+
+  cfg.resourceId = previewit->second;
+  cfg.subresource = Subresource();
+  cfg.scale *= stride;
+
+  return true;
 }
 
 void ReplayProxy::EnsureBufCached(ResourceId bufid)
@@ -2672,6 +3223,154 @@ void ReplayProxy::RemoteExecutionThreadEntry()
   }
 }
 
+void ReplayProxy::ReadPendingResponses()
+{
+  if(m_PendingResponses.empty())
+    return;
+
+  // take the list first, so that nothing re-entrantly sees these as still pending
+  rdcarray<ReplayProxyPacket> pending;
+  pending.swap(m_PendingResponses);
+
+  for(ReplayProxyPacket expectedPacket : pending)
+  {
+    if(m_Writer.IsErrored() || m_Reader.IsErrored() || m_IsErrored)
+      return;
+
+    ReplayProxyPacket packet = expectedPacket;
+
+    PROXY_DEBUG("Reading deferred response to %s", ToStr(packet).c_str());
+
+    // wait for the remote side to finish, as REMOTE_EXECUTION() would have
+    EndRemoteExecution();
+
+    // then read the return as with SERIALISE_RETURN_VOID()
+    ReadSerialiser &ser = m_Reader;
+    PACKET_HEADER(packet);
+    SERIALISE_ELEMENT(packet);
+    ser.EndChunk();
+    CheckError(packet, expectedPacket);
+  }
+}
+
+void ReplayProxy::InitCompression()
+{
+  // allow the codec to be forced with the proxyCompression config setting, e.g. zstdfast, for
+  // testing or for links where the adaptive choice does badly.
+  rdcstr setting = strlower(RenderDoc::Inst().GetConfigSetting("proxyCompression"));
+
+  if(setting.empty())
+    return;
+
+  for(uint8_t c = 0; c < (uint8_t)ProxyCompression::Count; c++)
+  {
+    if(strlower(ToStr(ProxyCompression(c))) == setting)
+    {
+      m_Compression = ProxyCompression(c);
+      m_FixedCompression = true;
+      RDCLOG("Using fixed %s compression for proxy transfers", ToStr(m_Compression).c_str());
+      return;
+    }
+  }
+
+  RDCWARN("Unrecognised proxyCompression setting '%s', adapting to the connection",
+          setting.c_str());
+}
+
+void ReplayProxy::SetLocalConnection(bool local)
+{
+  // on the same machine there's no bandwidth to save, so don't spend time compressing
+  if(local && !m_FixedCompression)
+    m_Compression = ProxyCompression::None;
+}
+
+ProxyCompression ReplayProxy::BeginCompressedTransfer(uint64_t uncompSize)
+{
+  if(m_FixedCompression || uncompSize < CompressionMeasureMinSize)
+    return m_Compression;
+
+  m_LargeTransfers++;
+
+  if((m_LargeTransfers % CompressionProbeInterval) != 0)
+    return m_Compression;
+
+  // alternate between probing one step more and one step less compression
+  m_ProbeUp = !m_ProbeUp;
+
+  uint8_t cur = (uint8_t)m_Compression;
+
+  if(m_ProbeUp && cur + 1 < (uint8_t)ProxyCompression::Count)
+    return ProxyCompression(cur + 1);
+  if(!m_ProbeUp && cur > 0)
+    return ProxyCompression(cur - 1);
+
+  return m_Compression;
+}
+
+void ReplayProxy::EndCompressedTransfer(ProxyCompression compression, uint64_t uncompSize,
+                                        double ms)
+{
+  if(m_FixedCompression || uncompSize < CompressionMeasureMinSize)
+    return;
+
+  double sample = double(uncompSize) / RDCMAX(ms, 0.001);
+
+  double &throughput = m_CompressionThroughput[(size_t)compression];
+  if(throughput == 0.0)
+    throughput = sample;
+  else
+    throughput = throughput * 0.75 + sample * 0.25;
+
+  // switch if another codec has been measured noticeably faster than the current one
+  ProxyCompression best = m_Compression;
+  for(uint8_t c = 0; c < (uint8_t)ProxyCompression::Count; c++)
+  {
+    if(m_CompressionThroughput[c] > m_CompressionThroughput[(size_t)best] * 1.1)
+      best = ProxyCompression(c);
+  }
+
+  if(best != m_Compression)
+  {
+    RDCLOG("Switching proxy transfers from %s to %s compression (%.1f MB/s vs %.1f MB/s)",
+           ToStr(m_Compression).c_str(), ToStr(best).c_str(),
+           m_CompressionThroughput[(size_t)best] / 1000.0,
+           m_CompressionThroughput[(size_t)m_Compression] / 1000.0);
+    m_Compression = best;
+  }
+}
+
+Compressor *ReplayProxy::CreateCompressor(ProxyCompression compression, StreamWriter *writer)
+{
+  switch(compression)
+  {
+    case ProxyCompression::None: return new PassthroughCompressor(writer);
+    case ProxyCompression::ZstdFast: return new ZSTDCompressor(writer, Ownership::Nothing, 1, 1);
+    case ProxyCompression::Zstd: return new ZSTDCompressor(writer, Ownership::Nothing);
+    case ProxyCompression::ZstdMax: return new ZSTDCompressor(writer, Ownership::Nothing, 1, 15);
+    case ProxyCompression::LZ4:
+    default: break;
+  }
+
+  return new LZ4Compressor(writer, Ownership::Nothing);
+}
+
+Decompressor *ReplayProxy::CreateDecompressor(ProxyCompression compression, StreamReader *reader)
+{
+  switch(compression)
+  {
+    case ProxyCompression::None: return new PassthroughDecompressor(reader);
+    case ProxyCompression::ZstdFast:
+    case ProxyCompression::Zstd:
+    case ProxyCompression::ZstdMax: return new ZSTDDecompressor(reader, Ownership::Nothing);
+    case ProxyCompression::LZ4: return new LZ4Decompressor(reader, Ownership::Nothing);
+    default: break;
+  }
+
+  RDCERR("Unexpected proxy compression %u", compression);
+  m_IsErrored = true;
+  return new PassthroughDecompressor(reader);
+}
+
 bool ReplayProxy::CheckError(ReplayProxyPacket receivedPacket, ReplayProxyPacket expectedPacket)
 {
   if(m_Writer.IsErrored() || m_Reader.IsErrored() || m_IsErrored)
@@ -2785,18 +3484,32 @@ bool ReplayProxy::Tick(int type)
       break;
     }
     case eReplayProxy_ContinueDebug: ContinueDebug(NULL); break;
+    case eReplayProxy_GetTexturePreviewData:
+    {
+      bytebuf dummy;
+      GetTexturePreviewData(ResourceId(), Subresource(), GetTextureDataParams(), 0, 0, dummy);
+      break;
+    }
+    case eReplayProxy_GetStructuredChunks: GetStructuredChunks(rdcarray<uint32_t>()); break;
     case eReplayProxy_RenderOverlay:
       RenderOverlay(ResourceId(), CompType::Typeless, FloatVector(), DebugOverlay::NoOverlay, 0,
                     rdcarray<uint32_t>());
       break;
+    case eReplayProxy_GetOverdrawStatistics: GetOverdrawStatistics(); break;
     case eReplayProxy_PixelHistory:
       PixelHistory(rdcarray<EventUsage>(), ResourceId(), 0, 0, Subresource(), CompType::Typeless);
       break;
+    case eReplayProxy_BatchPixelHistory:
+      BatchPixelHistory(rdcarray<EventUsage>(), ResourceId(), rdcarray<uint32_t>(), Subresource(),
+                        CompType::Typeless);
+      break;
     case eReplayProxy_DisassembleShader: DisassembleShader(ResourceId(), NULL, ""); break;
     case eReplayProxy_GetDisassemblyTargets: GetDisassemblyTargets(); break;
     case eReplayProxy_GetTargetShaderEncodings: GetTargetShaderEncodings(); break;
     case eReplayProxy_GetDriverInfo: GetDriverInfo(); break;
     case eReplayProxy_GetAvailableGPUs: GetAvailableGPUs(); break;
+    case eReplayProxy_GetMemoryUsage: GetMemoryUsage(); break;
+    case eReplayProxy_EvictCache: EvictCache(MemoryCategory::PostVSCache); break;
     default: RDCERR("Unexpected command %u", type); return false;
   }
 
@@ -93,6 +93,7 @@ enum ReplayProxyPacket
   eReplayProxy_RenderOverlay,
 
   eReplayProxy_PixelHistory,
+  eReplayProxy_BatchPixelHistory,
 
   eReplayProxy_DisassembleShader,
   eReplayProxy_GetDisassemblyTargets,
@@ -102,10 +103,34 @@ enum ReplayProxyPacket
   eReplayProxy_GetAvailableGPUs,
 
   eReplayProxy_ContinueDebug,
+
+  eReplayProxy_GetTexturePreviewData,
+
+  eReplayProxy_GetStructuredChunks,
+
+  eReplayProxy_GetOverdrawStatistics,
+
+  eReplayProxy_GetMemoryUsage,
+  eReplayProxy_EvictCache,
 };
 
 DECLARE_REFLECTION_ENUM(ReplayProxyPacket);
 
+// the codec used for bulk data (buffer and texture contents) sent from the remote server back to
+// the host. The remote server picks one for each transfer and writes it ahead of the data, so the
+// two sides never need to agree on it up front.
+enum class ProxyCompression : uint8_t
+{
+  None,
+  LZ4,
+  ZstdFast,
+  Zstd,
+  ZstdMax,
+  Count,
+};
+
+DECLARE_REFLECTION_ENUM(ProxyCompression);
+
 #define IMPLEMENT_FUNCTION_PROXIED(rettype, name, ...)                                  \
   rettype name(__VA_ARGS__);                                                            \
   template <typename ParamSerialiser, typename ReturnSerialiser>                        \
@@ -145,6 +170,8 @@ public:
   {
     RDCEraseEl(m_APIProps);
 
+    InitCompression();
+
     InitRemoteExecutionThread();
 
     if(m_Replay)
@@ -163,6 +190,14 @@ public:
   void EndRemoteExecution();
   void RemoteExecutionThreadEntry();
 
+  // read the responses of any deferred calls still outstanding. Must be called before anything
+  // else reads from the connection.
+  void ReadPendingResponses();
+
+  // on the remote server, set when the host is on the same machine (e.g. over adb forwarding) so
+  // that bulk transfers can skip compression entirely.
+  void SetLocalConnection(bool local);
+
   bool IsRemoteProxy() { return !m_RemoteServer; }
   void Shutdown() { delete this; }
   ReplayStatus ReadLogInitialisation(RDCFile *rdc, bool storeStructuredBuffers)
@@ -251,7 +286,10 @@ public:
   {
     if(m_Proxy)
     {
-      EnsureTexCached(cfg.resourceId, cfg.typeCast, cfg.subresource);
+      // when zoomed out far enough on a large texture, display a downsampled copy rather than
+      // waiting for the whole subresource to transfer.
+      if(!EnsurePreviewCached(cfg))
+        EnsureTexCached(cfg.resourceId, cfg.typeCast, cfg.subresource);
 
       if(cfg.resourceId == ResourceId())
         return false;
@@ -460,6 +498,11 @@ public:
   const SDFile &GetStructuredFile() { return m_StructuredFile; }
   IMPLEMENT_FUNCTION_PROXIED(void, FetchStructuredFile);
 
+  // the structured file is initially fetched with only the chunk headers, and the contents of
+  // each chunk are fetched here when they're first needed.
+  void FetchStructuredChunks(const rdcarray<uint32_t> &chunkIndices);
+  IMPLEMENT_FUNCTION_PROXIED(void, GetStructuredChunks, const rdcarray<uint32_t> &chunkIndices);
+
   IMPLEMENT_FUNCTION_PROXIED(rdcarray<ResourceDescription>, GetResources);
 
   IMPLEMENT_FUNCTION_PROXIED(rdcarray<BufferDescription>, GetBuffers);
@@ -472,6 +515,9 @@ public:
   IMPLEMENT_FUNCTION_PROXIED(DriverInformation, GetDriverInfo);
   IMPLEMENT_FUNCTION_PROXIED(rdcarray<GPUDevice>, GetAvailableGPUs);
 
+  IMPLEMENT_FUNCTION_PROXIED(rdcarray<MemoryUsage>, GetMemoryUsage);
+  IMPLEMENT_FUNCTION_PROXIED(void, EvictCache, MemoryCategory category);
+
   IMPLEMENT_FUNCTION_PROXIED(rdcarray<DebugMessage>, GetDebugMessages);
 
   IMPLEMENT_FUNCTION_PROXIED(void, SavePipelineState, uint32_t eventId);
@@ -508,6 +554,7 @@ public:
   IMPLEMENT_FUNCTION_PROXIED(ResourceId, RenderOverlay, ResourceId texid, CompType typeCast,
                              FloatVector clearCol, DebugOverlay overlay, uint32_t eventId,
                              const rdcarray<uint32_t> &passEvents);
+  IMPLEMENT_FUNCTION_PROXIED(rdcarray<OverdrawStatistics>, GetOverdrawStatistics);
 
   IMPLEMENT_FUNCTION_PROXIED(rdcarray<ShaderEntryPoint>, GetShaderEntryPoints, ResourceId shader);
   IMPLEMENT_FUNCTION_PROXIED(ShaderReflection *, GetShader, ResourceId pipeline, ResourceId,
@@ -522,6 +569,9 @@ public:
   IMPLEMENT_FUNCTION_PROXIED(rdcarray<PixelModification>, PixelHistory, rdcarray<EventUsage> events,
                              ResourceId target, uint32_t x, uint32_t y, const Subresource &sub,
                              CompType typeCast);
+  IMPLEMENT_FUNCTION_PROXIED(rdcarray<PixelHistoryResult>, BatchPixelHistory,
+                             rdcarray<EventUsage> events, ResourceId target,
+                             rdcarray<uint32_t> pixels, const Subresource &sub, CompType typeCast);
   IMPLEMENT_FUNCTION_PROXIED(ShaderDebugTrace *, DebugVertex, uint32_t eventId, uint32_t vertid,
                              uint32_t instid, uint32_t idx);
   IMPLEMENT_FUNCTION_PROXIED(ShaderDebugTrace *, DebugPixel, uint32_t eventId, uint32_t x,
@@ -545,10 +595,28 @@ public:
   IMPLEMENT_FUNCTION_PROXIED(void, CacheTextureData, ResourceId tex, const Subresource &sub,
                              const GetTextureDataParams &params);
 
-  // utility function to serialise the contents of a byte array given the previous contents that's
-  // available on both sides of the communication.
+  // fetches every stride'th texel in each direction of a 2D subresource, for displaying large
+  // textures zoomed out without transferring the whole thing.
+  IMPLEMENT_FUNCTION_PROXIED(void, GetTexturePreviewData, ResourceId tex, const Subresource &sub,
+                             const GetTextureDataParams &params, uint32_t texelSize,
+                             uint32_t stride, bytebuf &data);
+
+  // the remote side's record of the contents it last sent for a resource. Rather than a full copy
+  // we only keep a hash per chunk, which is all that's needed to tell which chunks changed.
+  struct DeltaBlockHashes
+  {
+    static const size_t ChunkSize = 128;
+
+    uint64_t size = 0;
+    rdcarray<uint64_t> hashes;
+  };
+
+  // utility function to serialise the contents of a byte array given the previous contents. The
+  // reference data is only used on the receiving side, and the reference hashes on the sending
+  // side.
   template <typename SerialiserType>
-  void DeltaTransferBytes(SerialiserType &xferser, bytebuf &referenceData, bytebuf &newData);
+  void DeltaTransferBytes(SerialiserType &xferser, bytebuf &referenceData,
+                          DeltaBlockHashes &referenceHashes, bytebuf &newData);
 
   void FileChanged() {}
   // will never be used
@@ -577,6 +645,7 @@ public:
 
 private:
   void EnsureTexCached(ResourceId &texid, CompType typeCast, const Subresource &sub);
+  bool EnsurePreviewCached(TextureDisplay &cfg);
   void RemapProxyTextureIfNeeded(TextureDescription &tex, GetTextureDataParams &params);
   void EnsureBufCached(ResourceId bufid);
   IMPLEMENT_FUNCTION_PROXIED(bool, NeedRemapForFetch, const ResourceFormat &format);
@@ -586,6 +655,12 @@ private:
 
   bool CheckError(ReplayProxyPacket receivedPacket, ReplayProxyPacket expectedPacket);
 
+  void InitCompression();
+  ProxyCompression BeginCompressedTransfer(uint64_t uncompSize);
+  void EndCompressedTransfer(ProxyCompression compression, uint64_t uncompSize, double ms);
+  Compressor *CreateCompressor(ProxyCompression compression, StreamWriter *writer);
+  Decompressor *CreateDecompressor(ProxyCompression compression, StreamReader *reader);
+
   struct TextureCacheEntry
   {
     ResourceId replayid;
@@ -609,6 +684,8 @@ private:
     ResourceId id;
     uint32_t msSamp;
     GetTextureDataParams params;
+    // the description the proxy texture was created with, after any remapping
+    TextureDescription desc;
 
     ProxyTextureProperties() {}
     // Create a proxy Id with the default get-data parameters.
@@ -620,12 +697,38 @@ private:
   std::map<ResourceId, ProxyTextureProperties> m_ProxyTextures;
   std::map<ResourceId, ResourceId> m_ProxyBufferIds;
 
-  // this cache exists on *both* sides of the proxy connection, and must be kept in sync. It is used
-  // on the remote side to determine which deltas are necessary, and then each time on the client
-  // side the data is uploaded into the proxy textures above.
+  ProxyTextureProperties &GetProxyTexture(ResourceId texid);
+
+  // downsampled stand-ins for large subresources, created on the client side with the proxy
+  // renderer. The textures are kept around as the user zooms in and out, but the set of up-to-date
+  // previews is cleared any time we set event, the same as m_TextureProxyCache.
+  struct TexturePreviewKey
+  {
+    TextureCacheEntry entry;
+    uint32_t stride;
+
+    bool operator<(const TexturePreviewKey &o) const
+    {
+      if(entry < o.entry)
+        return true;
+      if(o.entry < entry)
+        return false;
+      return stride < o.stride;
+    }
+  };
+  std::map<TexturePreviewKey, ResourceId> m_PreviewTextures;
+  std::set<TexturePreviewKey> m_PreviewTextureCache;
+
+  // this cache only exists on the client side, and holds the last contents received for each
+  // resource. Deltas are applied to it and then it is uploaded into the proxy textures above.
   std::map<TextureCacheEntry, bytebuf> m_ProxyTextureData;
   std::map<ResourceId, bytebuf> m_ProxyBufferData;
 
+  // the remote side's counterpart to the above, and must be kept in sync with it. It is used to
+  // determine which deltas are necessary.
+  std::map<TextureCacheEntry, DeltaBlockHashes> m_ProxyTextureHashes;
+  std::map<ResourceId, DeltaBlockHashes> m_ProxyBufferHashes;
+
   // this lists any textures which are only created locally (e.g. custom visualisation shaders) and
   // should not be treated as proxied.
   std::set<ResourceId> m_LocalTextures;
@@ -707,6 +810,19 @@ private:
 
   bool m_IsErrored = false;
 
+  // on the remote server, the codec used for bulk transfers. Unless it was fixed by the user this
+  // adapts to the link: the throughput of each codec (uncompressed bytes per millisecond) is
+  // measured on large transfers, occasionally trying a neighbouring codec to see if it does better.
+  ProxyCompression m_Compression = ProxyCompression::LZ4;
+  bool m_FixedCompression = false;
+  double m_CompressionThroughput[(size_t)ProxyCompression::Count] = {};
+  uint32_t m_LargeTransfers = 0;
+  bool m_ProbeUp = true;
+
+  // on the host side, the packets of void calls that were sent without waiting for the remote side
+  // to finish. Their responses are read, in order, after the next request has been sent.
+  rdcarray<ReplayProxyPacket> m_PendingResponses;
+
   FrameRecord m_FrameRecord;
   APIProperties m_APIProps;
   std::map<ResourceId, TextureDescription> m_TextureInfo;
@@ -714,6 +830,8 @@ private:
   rdcarray<DrawcallDescription *> m_Drawcalls;
 
   SDFile m_StructuredFile;
+  // on the host side, which chunks in m_StructuredFile have had their contents fetched.
+  rdcarray<bool> m_StructuredChunkFetched;
 
   D3D11Pipe::State m_D3D11PipelineState;
   D3D12Pipe::State m_D3D12PipelineState;
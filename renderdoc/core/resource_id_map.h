@@ -0,0 +1,285 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019-2020 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#pragma once
+
+#include <string.h>
+#include <utility>
+#include "api/replay/rdcpair.h"
+#include "api/replay/resourceid.h"
+#include "common/common.h"
+
+// ResourceIds are allocated sequentially, so mix the bits before they're used to pick a bucket.
+// This is the splitmix64 finaliser.
+inline uint64_t HashResourceId(ResourceId id)
+{
+  uint64_t x;
+  RDCCOMPILE_ASSERT(sizeof(x) == sizeof(id), "ResourceId is expected to be a 64-bit value");
+  memcpy(&x, &id, sizeof(x));
+
+  x ^= x >> 30;
+  x *= 0xbf58476d1ce4e5b9ULL;
+  x ^= x >> 27;
+  x *= 0x94d049bb133111ebULL;
+  x ^= x >> 31;
+  return x;
+}
+
+// An open-addressing hash map from ResourceId to V, with linear probing. It covers the subset of
+// std::map's interface that the resource managers use, but iteration order is unspecified.
+//
+// Erased entries leave a tombstone behind rather than shifting later entries down, so erasing
+// (either the current element or any other) while iterating is safe, as with std::map. Inserting
+// while iterating is NOT safe, as it may rehash the table.
+template <typename V>
+class ResourceIdMap
+{
+public:
+  typedef rdcpair<ResourceId, V> value_type;
+
+  template <typename MapType, typename ValueType>
+  class iterator_base
+  {
+  public:
+    iterator_base() : m_Map(NULL), m_Idx(0) {}
+    iterator_base(MapType *map, size_t idx) : m_Map(map), m_Idx(idx) {}
+    // allow converting a non-const iterator to a const one
+    template <typename M, typename T>
+    iterator_base(const iterator_base<M, T> &o) : m_Map(o.m_Map), m_Idx(o.m_Idx)
+    {
+    }
+
+    ValueType &operator*() const { return m_Map->m_Entries[m_Idx]; }
+    ValueType *operator->() const { return &m_Map->m_Entries[m_Idx]; }
+    iterator_base &operator++()
+    {
+      m_Idx = m_Map->NextOccupied(m_Idx + 1);
+      return *this;
+    }
+    iterator_base operator++(int)
+    {
+      iterator_base ret = *this;
+      ++(*this);
+      return ret;
+    }
+    bool operator==(const iterator_base &o) const { return m_Idx == o.m_Idx; }
+    bool operator!=(const iterator_base &o) const { return m_Idx != o.m_Idx; }
+  private:
+    template <typename M, typename T>
+    friend class iterator_base;
+    friend class ResourceIdMap;
+
+    MapType *m_Map;
+    size_t m_Idx;
+  };
+
+  typedef iterator_base<ResourceIdMap, value_type> iterator;
+  typedef iterator_base<const ResourceIdMap, const value_type> const_iterator;
+
+  ResourceIdMap() = default;
+  ~ResourceIdMap()
+  {
+    delete[] m_Entries;
+    delete[] m_States;
+  }
+  ResourceIdMap(const ResourceIdMap &) = delete;
+  ResourceIdMap &operator=(const ResourceIdMap &) = delete;
+
+  iterator begin() { return iterator(this, FirstOccupied()); }
+  iterator end() { return iterator(this, m_Capacity); }
+  const_iterator begin() const { return const_iterator(this, FirstOccupied()); }
+  const_iterator end() const { return const_iterator(this, m_Capacity); }
+  size_t size() const { return m_Size; }
+  bool empty() const { return m_Size == 0; }
+  iterator find(ResourceId id) { return iterator(this, FindIndex(id)); }
+  const_iterator find(ResourceId id) const { return const_iterator(this, FindIndex(id)); }
+  V &operator[](ResourceId id)
+  {
+    // inserting may rehash and reallocate m_Entries, so it must happen before m_Entries is read
+    size_t idx = InsertIndex(id);
+    return m_Entries[idx].second;
+  }
+  size_t erase(ResourceId id)
+  {
+    size_t idx = FindIndex(id);
+    if(idx == m_Capacity)
+      return 0;
+
+    EraseIndex(idx);
+    return 1;
+  }
+
+  void erase(iterator it) { EraseIndex(it.m_Idx); }
+  void clear()
+  {
+    // keep the allocation around, the map is likely to be filled to a similar size again
+    for(size_t i = 0; i < m_Capacity; i++)
+    {
+      if(m_States[i] == Occupied)
+        m_Entries[i] = value_type();
+      m_States[i] = Empty;
+    }
+
+    m_Size = m_Tombstones = 0;
+    m_FirstOccupied = m_Capacity;
+  }
+
+  void reserve(size_t count)
+  {
+    if(NeedsRehash(count))
+      Rehash(CapacityFor(count));
+  }
+
+  void swap(ResourceIdMap &o)
+  {
+    std::swap(m_Entries, o.m_Entries);
+    std::swap(m_States, o.m_States);
+    std::swap(m_Capacity, o.m_Capacity);
+    std::swap(m_Size, o.m_Size);
+    std::swap(m_Tombstones, o.m_Tombstones);
+    std::swap(m_FirstOccupied, o.m_FirstOccupied);
+  }
+
+private:
+  enum : uint8_t
+  {
+    Empty = 0,
+    Occupied,
+    Tombstone,
+  };
+
+  static const size_t MinCapacity = 16;
+
+  value_type *m_Entries = NULL;
+  uint8_t *m_States = NULL;
+  // always 0 or a power of two
+  size_t m_Capacity = 0;
+  size_t m_Size = 0;
+  size_t m_Tombstones = 0;
+  // no slot below this index is occupied. It's only a lower bound so that repeatedly erasing
+  // begin() - e.g. while draining the map on shutdown - doesn't rescan the start of the table.
+  mutable size_t m_FirstOccupied = 0;
+
+  // keep occupied + tombstoned slots under 3/4 of the table so probe sequences stay short
+  bool NeedsRehash(size_t count) const
+  {
+    return (count + m_Tombstones) * 4 > m_Capacity * 3 || m_Capacity == 0;
+  }
+
+  static size_t CapacityFor(size_t count)
+  {
+    size_t cap = MinCapacity;
+    while(count * 4 > cap * 3)
+      cap *= 2;
+    return cap;
+  }
+
+  size_t NextOccupied(size_t idx) const
+  {
+    while(idx < m_Capacity && m_States[idx] != Occupied)
+      idx++;
+    return idx;
+  }
+
+  size_t FirstOccupied() const
+  {
+    m_FirstOccupied = NextOccupied(m_FirstOccupied);
+    return m_FirstOccupied;
+  }
+
+  size_t FindIndex(ResourceId id) const
+  {
+    if(m_Size == 0)
+      return m_Capacity;
+
+    const size_t mask = m_Capacity - 1;
+    for(size_t idx = size_t(HashResourceId(id)) & mask;; idx = (idx + 1) & mask)
+    {
+      if(m_States[idx] == Empty)
+        return m_Capacity;
+      if(m_States[idx] == Occupied && m_Entries[idx].first == id)
+        return idx;
+    }
+  }
+
+  size_t InsertIndex(ResourceId id)
+  {
+    size_t idx = FindIndex(id);
+    if(idx != m_Capacity)
+      return idx;
+
+    if(NeedsRehash(m_Size + 1))
+      Rehash(CapacityFor(m_Size + 1));
+
+    // the table always has at least one empty slot, so this terminates. Re-use the first
+    // tombstone on the probe sequence if there is one.
+    const size_t mask = m_Capacity - 1;
+    for(idx = size_t(HashResourceId(id)) & mask; m_States[idx] == Occupied; idx = (idx + 1) & mask)
+    {
+    }
+
+    if(m_States[idx] == Tombstone)
+      m_Tombstones--;
+
+    m_States[idx] = Occupied;
+    m_Entries[idx].first = id;
+    m_Size++;
+    m_FirstOccupied = RDCMIN(m_FirstOccupied, idx);
+    return idx;
+  }
+
+  void EraseIndex(size_t idx)
+  {
+    m_Entries[idx] = value_type();
+    m_States[idx] = Tombstone;
+    m_Size--;
+    m_Tombstones++;
+  }
+
+  void Rehash(size_t newCapacity)
+  {
+    value_type *oldEntries = m_Entries;
+    uint8_t *oldStates = m_States;
+    size_t oldCapacity = m_Capacity;
+
+    m_Entries = new value_type[newCapacity];
+    m_States = new uint8_t[newCapacity];
+    memset(m_States, Empty, newCapacity);
+    m_Capacity = newCapacity;
+    m_Size = m_Tombstones = 0;
+    m_FirstOccupied = newCapacity;
+
+    for(size_t i = 0; i < oldCapacity; i++)
+    {
+      if(oldStates[i] == Occupied)
+      {
+        size_t idx = InsertIndex(oldEntries[i].first);
+        m_Entries[idx].second = std::move(oldEntries[i].second);
+      }
+    }
+
+    delete[] oldEntries;
+    delete[] oldStates;
+  }
+};
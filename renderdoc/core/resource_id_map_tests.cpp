@@ -0,0 +1,159 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019-2020 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+
+#include "common/globalconfig.h"
+
+#if ENABLED(ENABLE_UNIT_TESTS)
+
+#include <map>
+#include "api/replay/rdcarray.h"
+#include "resource_id_map.h"
+
+#include "3rdparty/catch/catch.hpp"
+
+TEST_CASE("Test ResourceIdMap type", "[resource_id_map]")
+{
+  ResourceIdMap<uint32_t> map;
+
+  CHECK(map.empty());
+  CHECK((map.begin() == map.end()));
+  CHECK((map.find(ResourceIDGen::GetNewUniqueID()) == map.end()));
+  CHECK(map.erase(ResourceIDGen::GetNewUniqueID()) == 0);
+
+  rdcarray<ResourceId> ids;
+  for(uint32_t i = 0; i < 1000; i++)
+    ids.push_back(ResourceIDGen::GetNewUniqueID());
+
+  SECTION("Insert and lookup")
+  {
+    for(uint32_t i = 0; i < ids.size(); i++)
+      map[ids[i]] = i;
+
+    CHECK(map.size() == ids.size());
+
+    for(uint32_t i = 0; i < ids.size(); i++)
+    {
+      auto it = map.find(ids[i]);
+      REQUIRE((it != map.end()));
+      CHECK(it->first == ids[i]);
+      CHECK(it->second == i);
+    }
+
+    // overwriting doesn't add new entries
+    map[ids[5]] = 12345;
+    CHECK(map.size() == ids.size());
+    CHECK(map[ids[5]] == 12345);
+
+    uint32_t count = 0;
+    for(auto it = map.begin(); it != map.end(); ++it)
+      count++;
+    CHECK(count == ids.size());
+
+    map.clear();
+    CHECK(map.empty());
+    CHECK((map.begin() == map.end()));
+    CHECK((map.find(ids[0]) == map.end()));
+  };
+
+  SECTION("Erase while iterating")
+  {
+    for(uint32_t i = 0; i < ids.size(); i++)
+      map[ids[i]] = i;
+
+    // erase odd values as we reach them, and the last entry from the start of iteration
+    map.erase(ids.back());
+    for(auto it = map.begin(); it != map.end(); ++it)
+    {
+      if(it->second & 1)
+        map.erase(it);
+    }
+
+    CHECK(map.size() == ids.size() / 2);
+
+    for(uint32_t i = 0; i < ids.size(); i++)
+    {
+      if(i & 1)
+        CHECK((map.find(ids[i]) == map.end()));
+      else
+        CHECK((map.find(ids[i]) != map.end()));
+    }
+
+    // re-inserting after the erase re-uses tombstones and finds the new value
+    for(uint32_t i = 1; i < ids.size(); i += 2)
+      map[ids[i]] = i * 2;
+
+    CHECK(map.size() == ids.size());
+    for(uint32_t i = 1; i < ids.size(); i += 2)
+      CHECK(map[ids[i]] == i * 2);
+  };
+
+  SECTION("Drain from begin")
+  {
+    for(uint32_t i = 0; i < ids.size(); i++)
+      map[ids[i]] = i;
+
+    uint32_t count = 0;
+    while(!map.empty())
+    {
+      map.erase(map.begin()->first);
+      count++;
+    }
+
+    CHECK(count == ids.size());
+    CHECK((map.begin() == map.end()));
+  };
+
+  SECTION("Matches std::map under churn")
+  {
+    std::map<ResourceId, uint32_t> ref;
+
+    for(uint32_t i = 0; i < 20000; i++)
+    {
+      ResourceId id = ids[(i * 7919) % ids.size()];
+
+      if(i % 3 == 0)
+      {
+        ref.erase(id);
+        map.erase(id);
+      }
+      else
+      {
+        ref[id] = i;
+        map[id] = i;
+      }
+    }
+
+    CHECK(map.size() == ref.size());
+
+    for(auto it = ref.begin(); it != ref.end(); ++it)
+    {
+      auto mapit = map.find(it->first);
+      REQUIRE((mapit != map.end()));
+      CHECK(mapit->second == it->second);
+    }
+  };
+};
+
+#endif    // ENABLED(ENABLE_UNIT_TESTS)
@@ -166,6 +166,72 @@ bool IsDirtyFrameRef(FrameRefType refType)
   return (refType != eFrameRef_None && refType != eFrameRef_Read);
 }
 
+void SortRecordChunks(RecordChunkList &chunks)
+{
+  const size_t count = chunks.size();
+
+  if(count < 2)
+    return;
+
+  // sort on the ID with the sign bit flipped so negative IDs order before positive ones, 11 bits
+  // at a time. Digits that are the same for every chunk (typically the top ones) are skipped.
+  const uint32_t digitBits = 11;
+  const uint32_t numBuckets = 1U << digitBits;
+
+  RecordChunkList scratch;
+  scratch.resize(count);
+
+  RecordChunkList *src = &chunks;
+  RecordChunkList *dst = &scratch;
+
+  rdcarray<uint32_t> offsets;
+  offsets.resize(numBuckets);
+
+  for(uint32_t shift = 0; shift < 32; shift += digitBits)
+  {
+    memset(offsets.data(), 0, numBuckets * sizeof(uint32_t));
+
+    for(size_t i = 0; i < count; i++)
+    {
+      uint32_t key = uint32_t(src->at(i).first) ^ 0x80000000U;
+      offsets[(key >> shift) & (numBuckets - 1)]++;
+    }
+
+    uint32_t firstDigit = (uint32_t(src->at(0).first) ^ 0x80000000U) >> shift;
+    if(offsets[firstDigit & (numBuckets - 1)] == count)
+      continue;
+
+    uint32_t total = 0;
+    for(uint32_t b = 0; b < numBuckets; b++)
+    {
+      uint32_t bucketSize = offsets[b];
+      offsets[b] = total;
+      total += bucketSize;
+    }
+
+    for(size_t i = 0; i < count; i++)
+    {
+      uint32_t key = uint32_t(src->at(i).first) ^ 0x80000000U;
+      dst->at(offsets[(key >> shift) & (numBuckets - 1)]++) = src->at(i);
+    }
+
+    std::swap(src, dst);
+  }
+
+  // drop duplicate IDs, keeping the last one gathered. The sort is stable so that is the last in
+  // each run.
+  size_t out = 0;
+  for(size_t i = 0; i < count; i++)
+  {
+    if(i + 1 < count && src->at(i + 1).first == src->at(i).first)
+      continue;
+
+    chunks[out++] = src->at(i);
+  }
+
+  chunks.resize(out);
+}
+
 void ResourceRecord::AddResourceReferences(ResourceRecordHandler *mgr)
 {
   for(auto it = m_FrameRefs.begin(); it != m_FrameRefs.end(); ++it)
@@ -195,3 +261,75 @@ void ResourceRecord::Delete(ResourceRecordHandler *mgr)
     mgr->DestroyResourceRecord(this);
   }
 }
+
+#if ENABLED(ENABLE_UNIT_TESTS)
+
+#include "3rdparty/catch/catch.hpp"
+
+TEST_CASE("Test record chunk ordering", "[resource_manager]")
+{
+  // the chunks are never dereferenced, so tag each one with the index it was gathered at
+  auto tag = [](size_t idx) { return (Chunk *)(uintptr_t)(idx + 1); };
+
+  SECTION("Empty and single-element lists")
+  {
+    RecordChunkList chunks;
+    SortRecordChunks(chunks);
+    CHECK(chunks.empty());
+
+    chunks.push_back({42, tag(0)});
+    SortRecordChunks(chunks);
+    REQUIRE(chunks.size() == 1);
+    CHECK(chunks[0].first == 42);
+  };
+
+  SECTION("Interleaved runs from several records")
+  {
+    RecordChunkList chunks;
+
+    // three records, each with chunks already in order but interleaved with each other and spanning
+    // several radix digits
+    for(int32_t r = 0; r < 3; r++)
+      for(int32_t i = 0; i < 1000; i++)
+        chunks.push_back({i * 3000 + r, tag(chunks.size())});
+
+    // plus some out of order and negative IDs
+    chunks.push_back({-5, tag(chunks.size())});
+    chunks.push_back({7, tag(chunks.size())});
+    chunks.push_back({-70000, tag(chunks.size())});
+
+    SortRecordChunks(chunks);
+
+    REQUIRE(chunks.size() == 3003);
+    CHECK(chunks[0].first == -70000);
+    CHECK(chunks[1].first == -5);
+
+    bool ordered = true;
+    for(size_t i = 1; i < chunks.size(); i++)
+      ordered &= chunks[i - 1].first < chunks[i].first;
+    CHECK(ordered);
+  };
+
+  SECTION("Duplicate IDs keep the last gathered chunk")
+  {
+    RecordChunkList chunks;
+
+    chunks.push_back({10, tag(0)});
+    chunks.push_back({5, tag(1)});
+    chunks.push_back({10, tag(2)});
+    chunks.push_back({5000, tag(3)});
+    chunks.push_back({10, tag(4)});
+
+    SortRecordChunks(chunks);
+
+    REQUIRE(chunks.size() == 3);
+    CHECK(chunks[0].first == 5);
+    CHECK(chunks[0].second == tag(1));
+    CHECK(chunks[1].first == 10);
+    CHECK(chunks[1].second == tag(4));
+    CHECK(chunks[2].first == 5000);
+    CHECK(chunks[2].second == tag(3));
+  };
+}
+
+#endif    // ENABLED(ENABLE_UNIT_TESTS)
@@ -30,6 +30,7 @@
 #include "api/replay/resourceid.h"
 #include "common/threading.h"
 #include "core/core.h"
+#include "core/resource_id_map.h"
 #include "os/os_specific.h"
 #include "serialise/serialiser.h"
 
@@ -150,6 +151,14 @@ FrameRefType KeepOldFrameRef(FrameRefType first, FrameRefType second);
 
 bool IsDirtyFrameRef(FrameRefType refType);
 
+// A flat list of chunks gathered from resource records, tagged with their chunk IDs. Records append
+// their chunks unordered and the list is put into ID order once before writing.
+typedef rdcarray<rdcpair<int32_t, Chunk *>> RecordChunkList;
+
+// Stable radix sort of the list by chunk ID, in linear time. If the same ID was gathered more than
+// once only the last occurrence is kept.
+void SortRecordChunks(RecordChunkList &chunks);
+
 // Captures the possible initialization/reset requirements for resources.
 // These requirements are entirely determined by the resource's FrameRefType,
 // but this type improves the readability of the code that checks
@@ -251,10 +260,10 @@ inline InitReqType InitReq(FrameRefType refType, InitPolicy policy, bool initial
 #undef CLEAR_ONCE
 }
 
-// handle marking a resource referenced for read or write and storing RAW access etc.
-template <typename Compose>
-bool MarkReferenced(std::map<ResourceId, FrameRefType> &refs, ResourceId id, FrameRefType refType,
-                    Compose comp)
+// handle marking a resource referenced for read or write and storing RAW access etc. RefMap can be
+// any map from ResourceId to FrameRefType, e.g. std::map or ResourceIdMap.
+template <typename RefMap, typename Compose>
+bool MarkReferenced(RefMap &refs, ResourceId id, FrameRefType refType, Compose comp)
 {
   auto refit = refs.find(id);
   if(refit == refs.end())
@@ -269,8 +278,8 @@ bool MarkReferenced(std::map<ResourceId, FrameRefType> &refs, ResourceId id, Fra
   return false;
 }
 
-inline bool MarkReferenced(std::map<ResourceId, FrameRefType> &refs, ResourceId id,
-                           FrameRefType refType)
+template <typename RefMap>
+inline bool MarkReferenced(RefMap &refs, ResourceId id, FrameRefType refType)
 {
   return MarkReferenced(refs, id, refType, ComposeFrameRefs);
 }
@@ -314,15 +323,21 @@ struct ResourceRecord
         DataOffset(0),
         Length(0),
         DataWritten(false),
-        InternalResource(false)
+        InternalResource(false),
+        SpillChunks(false)
   {
     m_ChunkLock = NULL;
+    m_ChunkStream = NULL;
 
     if(lock)
       m_ChunkLock = new Threading::CriticalSection();
   }
 
-  ~ResourceRecord() { SAFE_DELETE(m_ChunkLock); }
+  ~ResourceRecord()
+  {
+    SAFE_DELETE(m_ChunkLock);
+    SAFE_DELETE(m_ChunkStream);
+  }
   void AddParent(ResourceRecord *r)
   {
     if(r == this)
@@ -356,7 +371,8 @@ struct ResourceRecord
   }
 
   void MarkDataUnwritten() { DataWritten = false; }
-  void Insert(std::map<int32_t, Chunk *> &recordlist)
+  bool IsDataWritten() const { return DataWritten; }
+  void Insert(RecordChunkList &recordlist)
   {
     bool dataWritten = DataWritten;
 
@@ -372,8 +388,10 @@ struct ResourceRecord
 
     if(!dataWritten)
     {
-      for(auto it = m_Chunks.begin(); it != m_Chunks.end(); ++it)
-        recordlist[it->first] = it->second;
+      if(m_ChunkStream)
+        m_ChunkStream->TakeChunks(m_Chunks);
+
+      recordlist.append(m_Chunks);
     }
   }
 
@@ -389,15 +407,32 @@ struct ResourceRecord
     UnlockChunks();
   }
 
+  // reserves an ID for a chunk which will be added later, but should sort as if it were added now
+  int32_t ReserveChunkID() { return GetID(); }
   void AddChunk(Chunk *chunk, int32_t ID = 0)
   {
     if(ID == 0)
       ID = GetID();
+    if(SpillChunks)
+      ChunkSpill::Consider(chunk);
     LockChunks();
     m_Chunks.push_back({ID, chunk});
     UnlockChunks();
   }
 
+  // appends the chunk to this record's chunk stream instead of allocating it separately. Only for
+  // records whose chunks are never looked at individually, since they're only visible as Chunks
+  // once the record is inserted.
+  void AddStreamedChunk(ScopedChunk &scope)
+  {
+    int32_t ID = GetID();
+    LockChunks();
+    if(!m_ChunkStream)
+      m_ChunkStream = new ChunkStream();
+    scope.Stream(*m_ChunkStream, ID);
+    UnlockChunks();
+  }
+
   void LockChunks()
   {
     if(m_ChunkLock)
@@ -409,6 +444,7 @@ struct ResourceRecord
       m_ChunkLock->Unlock();
   }
 
+  // these don't include any streamed chunks, which aren't accessible individually
   bool HasChunks() const { return !m_Chunks.empty(); }
   size_t NumChunks() const { return m_Chunks.size(); }
   void SwapChunks(ResourceRecord *other)
@@ -416,6 +452,7 @@ struct ResourceRecord
     LockChunks();
     other->LockChunks();
     m_Chunks.swap(other->m_Chunks);
+    std::swap(m_ChunkStream, other->m_ChunkStream);
     m_FrameRefs.swap(other->m_FrameRefs);
     other->UnlockChunks();
     UnlockChunks();
@@ -426,8 +463,11 @@ struct ResourceRecord
     LockChunks();
     other->LockChunks();
 
+    RDCASSERTMSG("Streamed chunks can't be appended to another record", !other->m_ChunkStream);
+
+    // the chunks are shared rather than copied, since the other record may be appended many times
     for(auto it = other->m_Chunks.begin(); it != other->m_Chunks.end(); ++it)
-      AddChunk(it->second->Duplicate());
+      AddChunk(it->second->Share());
 
     for(auto it = other->Parents.begin(); it != other->Parents.end(); ++it)
       AddParent(*it);
@@ -442,6 +482,8 @@ struct ResourceRecord
     for(auto it = m_Chunks.begin(); it != m_Chunks.end(); ++it)
       SAFE_DELETE(it->second);
     m_Chunks.clear();
+    // deleted after the chunks, since any taken from the stream borrow its memory
+    SAFE_DELETE(m_ChunkStream);
     UnlockChunks();
   }
 
@@ -491,6 +533,11 @@ struct ResourceRecord
   bool InternalResource;
   bool DataWritten;
 
+  // set on records that only hold the frame's own chunks, which are never read back during capture
+  // except to be written out. Chunks added to these count against the capture memory budget and can
+  // be spilled to disk - see ChunkSpill.
+  bool SpillChunks;
+
 protected:
   volatile int32_t RefCount;
 
@@ -509,6 +556,7 @@ protected:
   }
 
   rdcarray<rdcpair<int32_t, Chunk *>> m_Chunks;
+  ChunkStream *m_ChunkStream;
   Threading::CriticalSection *m_ChunkLock;
 
   std::map<ResourceId, FrameRefType> m_FrameRefs;
@@ -671,25 +719,66 @@ protected:
   virtual void Apply_InitialState(WrappedResourceType live, const InitialContentData &initial) = 0;
   virtual rdcarray<ResourceId> InitialContentResources();
 
-  // very coarse lock, protects EVERYTHING. This could certainly be improved and it may be a
-  // bottleneck
-  // for performance. Given that the main use cases are write-rarely read-often the lock should be
-  // optimised
-  // for that as we only want to make sure we're not modifying the objects together, by far the most
-  // common
-  // operation is looking up data.
+  // coarse lock, protects everything except the frame references and record lookups below which
+  // have their own finer-grained locks. Where more than one is taken the order is always m_Lock,
+  // then a frame reference shard's lock, then m_RecordLock.
   Threading::CriticalSection m_Lock;
 
-  // easy optimisation win - don't use maps everywhere. It's convenient but not optimal, and
-  // profiling will
-  // likely prove that some or all of these could be a problem
+  // the maps keyed by ResourceId that are hit on every capture-time lookup are ResourceIdMaps
+  // rather than std::maps, since apps can have millions of live resources.
 
   // used during capture - map from real resource to its wrapper (other way can be done just with an
   // Unwrap)
   std::map<RealResourceType, WrappedResourceType> m_WrapperMap;
 
-  // used during capture - holds resources referenced in current frame (and how they're referenced)
-  std::map<ResourceId, FrameRefType> m_FrameReferencedResources;
+  // used during capture - holds resources referenced in current frame (and how they're referenced).
+  // This is split by ID into shards with their own lock, so that lookups of different resources
+  // don't contend with each other or with m_Lock. New references are collected per-thread first,
+  // see ThreadFrameRefs below.
+  struct FrameRefShard
+  {
+    Threading::CriticalSection lock;
+    ResourceIdMap<FrameRefType> refs;
+  };
+
+  static const uint32_t NumFrameRefShards = 16;
+  FrameRefShard m_FrameRefShards[NumFrameRefShards];
+
+  FrameRefShard &GetFrameRefShard(ResourceId id)
+  {
+    // the low bits of the hash pick the bucket within the shard, use the high bits here
+    return m_FrameRefShards[(HashResourceId(id) >> 32) % NumFrameRefShards];
+  }
+
+  // returns whether id is referenced in the current frame, and if so how
+  bool FindFrameReference(ResourceId id, FrameRefType &refType);
+  bool IsFrameReferenced(ResourceId id)
+  {
+    FrameRefType dummy;
+    return FindFrameReference(id, dummy);
+  }
+  size_t NumFrameReferences();
+
+  // calls func(id, refType) for each resource referenced in the current frame
+  template <typename Func>
+  void ForEachFrameReference(Func func);
+
+  // used during capture - each thread marks its references into its own set, so that threads
+  // recording commands in parallel don't contend at all. These are merged into m_FrameRefShards
+  // before anything reads the frame's references. As with any thread-local data, a thread's set is
+  // only freed when the manager is destroyed.
+  struct ThreadFrameRefs
+  {
+    Threading::SpinLock lock;
+    ResourceIdMap<FrameRefType> refs;
+  };
+
+  uint64_t m_ThreadFrameRefsTLSSlot;
+  Threading::CriticalSection m_ThreadFrameRefsLock;
+  rdcarray<ThreadFrameRefs *> m_ThreadFrameRefs;
+
+  ThreadFrameRefs *GetThreadFrameRefs();
+  void MergeThreadFrameRefs();
 
   // used during capture - holds resources marked as dirty, needing initial contents
   std::set<ResourceId> m_DirtyResources;
@@ -716,16 +805,18 @@ protected:
 
   // used during capture or replay - map of resources currently alive with their real IDs, used in
   // capture and replay.
-  std::map<ResourceId, WrappedResourceType> m_CurrentResourceMap;
+  ResourceIdMap<WrappedResourceType> m_CurrentResourceMap;
 
   // used during replay - maps back and forth from original id to live id and vice-versa
   std::map<ResourceId, ResourceId> m_OriginalIDs, m_LiveIDs;
 
   // used during replay - holds resources allocated and the original id that they represent
-  std::map<ResourceId, WrappedResourceType> m_LiveResourceMap;
+  ResourceIdMap<WrappedResourceType> m_LiveResourceMap;
 
-  // used during capture - holds resource records by id.
-  std::map<ResourceId, RecordType *> m_ResourceRecords;
+  // used during capture - holds resource records by id. Modified only with both m_Lock and a write
+  // lock on m_RecordLock held, so it can be read with either one.
+  ResourceIdMap<RecordType *> m_ResourceRecords;
+  Threading::RWLock m_RecordLock;
 
   // used during replay - holds current resource replacements
   std::map<ResourceId, ResourceId> m_Replacements;
@@ -737,7 +828,7 @@ protected:
   // On marking resource write-referenced in frame, its last write
   // time is reset. The time is used to determine persistent resources,
   // and is checked against the `PERSISTENT_RESOURCE_AGE`.
-  std::map<ResourceId, double> m_LastWriteTime;
+  ResourceIdMap<double> m_LastWriteTime;
 
   // Timestamp at the beginning of the frame capture. Used to determine which
   // resources to refresh for their last write time (see `m_LastWriteTime`).
@@ -752,6 +843,8 @@ protected:
 template <typename Configuration>
 ResourceManager<Configuration>::ResourceManager(CaptureState &state) : m_State(state)
 {
+  m_ThreadFrameRefsTLSSlot = Threading::AllocateTLSSlot();
+
   if(RenderDoc::Inst().GetCrashHandler())
     RenderDoc::Inst().GetCrashHandler()->RegisterMemoryRegion(this, sizeof(ResourceManager));
 }
@@ -782,6 +875,11 @@ ResourceManager<Configuration>::~ResourceManager()
   RDCASSERT(m_InitialContents.empty());
   RDCASSERT(m_ResourceRecords.empty());
 
+  for(ThreadFrameRefs *threadRefs : m_ThreadFrameRefs)
+    delete threadRefs;
+
+  Threading::FreeTLSSlot(m_ThreadFrameRefsTLSSlot);
+
   if(RenderDoc::Inst().GetCrashHandler())
     RenderDoc::Inst().GetCrashHandler()->UnregisterMemoryRegion(this);
 }
@@ -791,13 +889,12 @@ template <typename Compose>
 void ResourceManager<Configuration>::MarkResourceFrameReferenced(ResourceId id,
                                                                  FrameRefType refType, Compose comp)
 {
-  SCOPED_LOCK(m_Lock);
-
   if(id == ResourceId())
     return;
 
   if(IsDirtyFrameRef(refType))
   {
+    SCOPED_LOCK(m_Lock);
     Prepare_ResourceIfActivePostponed(id);
     UpdateLastWriteTime(id);
   }
@@ -805,8 +902,13 @@ void ResourceManager<Configuration>::MarkResourceFrameReferenced(ResourceId id,
   if(IsBackgroundCapturing(m_State))
     return;
 
-  bool newRef = MarkReferenced(m_FrameReferencedResources, id, refType, comp);
+  ThreadFrameRefs *threadRefs = GetThreadFrameRefs();
+  Threading::ScopedSpinLock lock(threadRefs->lock);
+
+  bool newRef = MarkReferenced(threadRefs->refs, id, refType, comp);
 
+  // take the reference now rather than at merge time, in case the resource is destroyed before the
+  // end of the frame. Any thread after the first to reference it gives its reference back on merge.
   if(newRef)
   {
     RecordType *record = GetResourceRecord(id);
@@ -816,12 +918,101 @@ void ResourceManager<Configuration>::MarkResourceFrameReferenced(ResourceId id,
   }
 }
 
+template <typename Configuration>
+typename ResourceManager<Configuration>::ThreadFrameRefs *ResourceManager<
+    Configuration>::GetThreadFrameRefs()
+{
+  ThreadFrameRefs *threadRefs = (ThreadFrameRefs *)Threading::GetTLSValue(m_ThreadFrameRefsTLSSlot);
+
+  if(threadRefs)
+    return threadRefs;
+
+  threadRefs = new ThreadFrameRefs;
+  Threading::SetTLSValue(m_ThreadFrameRefsTLSSlot, (void *)threadRefs);
+
+  {
+    SCOPED_LOCK(m_ThreadFrameRefsLock);
+    m_ThreadFrameRefs.push_back(threadRefs);
+  }
+
+  return threadRefs;
+}
+
+template <typename Configuration>
+void ResourceManager<Configuration>::MergeThreadFrameRefs()
+{
+  SCOPED_LOCK(m_ThreadFrameRefsLock);
+
+  for(ThreadFrameRefs *threadRefs : m_ThreadFrameRefs)
+  {
+    Threading::ScopedSpinLock lock(threadRefs->lock);
+
+    for(auto it = threadRefs->refs.begin(); it != threadRefs->refs.end(); ++it)
+    {
+      FrameRefShard &shard = GetFrameRefShard(it->first);
+      SCOPED_LOCK(shard.lock);
+
+      // there's no ordering between references from different threads, so compose conservatively
+      bool newRef = MarkReferenced(shard.refs, it->first, it->second, ComposeFrameRefsUnordered);
+
+      // the resource is already referenced (and holds a ref) from another thread or earlier merge
+      if(!newRef)
+      {
+        RecordType *record = GetResourceRecord(it->first);
+
+        if(record)
+          record->Delete(this);
+      }
+    }
+
+    threadRefs->refs.clear();
+  }
+}
+
 template <typename Configuration>
 void ResourceManager<Configuration>::MarkResourceFrameReferenced(ResourceId id, FrameRefType refType)
 {
   return MarkResourceFrameReferenced(id, refType, ComposeFrameRefs);
 }
 
+template <typename Configuration>
+bool ResourceManager<Configuration>::FindFrameReference(ResourceId id, FrameRefType &refType)
+{
+  FrameRefShard &shard = GetFrameRefShard(id);
+  SCOPED_LOCK(shard.lock);
+
+  auto it = shard.refs.find(id);
+  if(it == shard.refs.end())
+    return false;
+
+  refType = it->second;
+  return true;
+}
+
+template <typename Configuration>
+size_t ResourceManager<Configuration>::NumFrameReferences()
+{
+  size_t ret = 0;
+  for(FrameRefShard &shard : m_FrameRefShards)
+  {
+    SCOPED_LOCK(shard.lock);
+    ret += shard.refs.size();
+  }
+  return ret;
+}
+
+template <typename Configuration>
+template <typename Func>
+void ResourceManager<Configuration>::ForEachFrameReference(Func func)
+{
+  for(FrameRefShard &shard : m_FrameRefShards)
+  {
+    SCOPED_LOCK(shard.lock);
+    for(auto it = shard.refs.begin(); it != shard.refs.end(); ++it)
+      func(it->first, it->second);
+  }
+}
+
 template <typename Configuration>
 void ResourceManager<Configuration>::MarkDirtyResource(ResourceId res)
 {
@@ -915,31 +1106,31 @@ void ResourceManager<Configuration>::Serialise_InitialContentsNeeded(WriteSerial
   using namespace ResourceManagerInternal;
 
   SCOPED_LOCK(m_Lock);
+  MergeThreadFrameRefs();
 
   rdcarray<WrittenRecord> WrittenRecords;
 
   // reasonable estimate, and these records are small
-  WrittenRecords.reserve(m_FrameReferencedResources.size());
+  WrittenRecords.reserve(NumFrameReferences());
 
   // all resources that were recorded as being modified should be included in the list of those
   // needing initial contents
-  for(auto it = m_FrameReferencedResources.begin(); it != m_FrameReferencedResources.end(); ++it)
-  {
-    RecordType *record = GetResourceRecord(it->first);
-    if(IsDirtyFrameRef(it->second))
+  ForEachFrameReference([this, &WrittenRecords](ResourceId id, FrameRefType refType) {
+    RecordType *record = GetResourceRecord(id);
+    if(IsDirtyFrameRef(refType))
     {
-      WrittenRecord wr = {it->first, record ? record->DataInSerialiser : true};
+      WrittenRecord wr = {id, record ? record->DataInSerialiser : true};
 
       WrittenRecords.push_back(wr);
     }
-  }
+  });
 
   // any resources that had initial contents generated should also be included
   for(auto it = m_InitialContents.begin(); it != m_InitialContents.end(); ++it)
   {
     ResourceId id = it->first;
-    auto ref = m_FrameReferencedResources.find(id);
-    if(ref == m_FrameReferencedResources.end() || !IsDirtyFrameRef(ref->second))
+    FrameRefType refType = eFrameRef_None;
+    if(!FindFrameReference(id, refType) || !IsDirtyFrameRef(refType))
     {
       WrittenRecord wr = {id, true};
 
@@ -975,7 +1166,10 @@ void ResourceManager<Configuration>::Prepare_ResourceInitialStateIfNeeded(Resour
     return;
 
   WrappedResourceType res = GetCurrentResource(id);
-  Prepare_InitialState(res);
+  {
+    RDCOVERHEAD_TIMER(OverheadCounter::PrepareInitialStateTicks);
+    Prepare_InitialState(res);
+  }
 
   m_PostponedResourceIDs.erase(id);
 }
@@ -1138,11 +1332,14 @@ void ResourceManager<Configuration>::MarkUnwrittenResources()
 template <typename Configuration>
 void ResourceManager<Configuration>::InsertReferencedChunks(WriteSerialiser &ser)
 {
-  std::map<int32_t, Chunk *> sortedChunks;
+  RecordChunkList sortedChunks;
 
   SCOPED_LOCK(m_Lock);
+  MergeThreadFrameRefs();
+
+  const size_t numFrameRefs = NumFrameReferences();
 
-  RDCDEBUG("%u frame resource records", (uint32_t)m_FrameReferencedResources.size());
+  RDCDEBUG("%u frame resource records", (uint32_t)numFrameRefs);
 
   if(RenderDoc::Inst().GetCaptureOptions().refAllResources)
   {
@@ -1154,8 +1351,7 @@ void ResourceManager<Configuration>::InsertReferencedChunks(WriteSerialiser &ser
       RenderDoc::Inst().SetProgress(CaptureProgress::AddReferencedResources, idx / num);
       idx += 1.0f;
 
-      if(m_FrameReferencedResources.find(it->first) == m_FrameReferencedResources.end() &&
-         it->second->InternalResource)
+      if(!IsFrameReferenced(it->first) && it->second->InternalResource)
         continue;
 
       it->second->Insert(sortedChunks);
@@ -1163,24 +1359,25 @@ void ResourceManager<Configuration>::InsertReferencedChunks(WriteSerialiser &ser
   }
   else
   {
-    float num = float(m_FrameReferencedResources.size());
+    float num = float(numFrameRefs);
     float idx = 0.0f;
 
-    for(auto it = m_FrameReferencedResources.begin(); it != m_FrameReferencedResources.end(); ++it)
-    {
+    ForEachFrameReference([this, num, &idx, &sortedChunks](ResourceId id, FrameRefType) {
       RenderDoc::Inst().SetProgress(CaptureProgress::AddReferencedResources, idx / num);
       idx += 1.0f;
 
-      RecordType *record = GetResourceRecord(it->first);
+      RecordType *record = GetResourceRecord(id);
       if(record)
         record->Insert(sortedChunks);
-    }
+    });
   }
 
+  SortRecordChunks(sortedChunks);
+
   RDCDEBUG("%u frame resource chunks", (uint32_t)sortedChunks.size());
 
-  for(auto it = sortedChunks.begin(); it != sortedChunks.end(); it++)
-    it->second->Write(ser);
+  for(const rdcpair<int32_t, Chunk *> &chunk : sortedChunks)
+    chunk.second->Write(ser);
 
   RDCDEBUG("inserted to serialiser");
 }
@@ -1193,6 +1390,8 @@ void ResourceManager<Configuration>::PrepareInitialContents()
   RDCDEBUG("Preparing up to %u potentially dirty resources", (uint32_t)m_DirtyResources.size());
   uint32_t prepared = 0;
 
+  RDCOVERHEAD_TIMER(OverheadCounter::PrepareInitialStateTicks);
+
   float num = float(m_DirtyResources.size());
   float idx = 0.0f;
 
@@ -1240,12 +1439,18 @@ template <typename Configuration>
 void ResourceManager<Configuration>::InsertInitialContentsChunks(WriteSerialiser &ser)
 {
   SCOPED_LOCK(m_Lock);
+  MergeThreadFrameRefs();
 
   uint32_t dirty = 0;
   uint32_t skipped = 0;
 
   RDCDEBUG("Checking %u resources with initial contents", (uint32_t)m_InitialContents.size());
 
+  // optionally store identical contents (default textures, zero-filled buffers, ...) only once.
+  // Captures written this way can't be opened by older builds, so it's opt-in.
+  bool dedupBuffers = RenderDoc::Inst().GetCaptureOptions().dedupInitialContents &&
+                      ser.SetBufferDeduplication(true);
+
   float num = float(m_InitialContents.size());
   float idx = 0.0f;
 
@@ -1256,8 +1461,7 @@ void ResourceManager<Configuration>::InsertInitialContentsChunks(WriteSerialiser
     RenderDoc::Inst().SetProgress(CaptureProgress::SerialiseInitialStates, idx / num);
     idx += 1.0f;
 
-    if(m_FrameReferencedResources.find(id) == m_FrameReferencedResources.end() &&
-       !RenderDoc::Inst().GetCaptureOptions().refAllResources)
+    if(!IsFrameReferenced(id) && !RenderDoc::Inst().GetCaptureOptions().refAllResources)
     {
 #if ENABLED(VERBOSE_DIRTY_RESOURCES)
       RDCDEBUG("Dirty tesource %s is GPU dirty but not referenced - skipping", ToStr(id).c_str());
@@ -1317,6 +1521,9 @@ void ResourceManager<Configuration>::InsertInitialContentsChunks(WriteSerialiser
     SetInitialContents(id, InitialContentData());
   }
 
+  if(dedupBuffers)
+    ser.SetBufferDeduplication(false);
+
   RDCDEBUG("Serialised %u resources, skipped %u unreferenced", dirty, skipped);
 }
 
@@ -1324,13 +1531,13 @@ template <typename Configuration>
 void ResourceManager<Configuration>::ApplyInitialContentsNonChunks(WriteSerialiser &ser)
 {
   SCOPED_LOCK(m_Lock);
+  MergeThreadFrameRefs();
 
   for(auto it = m_InitialContents.begin(); it != m_InitialContents.end(); ++it)
   {
     ResourceId id = it->first;
 
-    if(m_FrameReferencedResources.find(id) == m_FrameReferencedResources.end() &&
-       !RenderDoc::Inst().GetCaptureOptions().refAllResources)
+    if(!IsFrameReferenced(id) && !RenderDoc::Inst().GetCaptureOptions().refAllResources)
     {
       continue;
     }
@@ -1349,20 +1556,26 @@ template <typename Configuration>
 void ResourceManager<Configuration>::ClearReferencedResources()
 {
   SCOPED_LOCK(m_Lock);
+  MergeThreadFrameRefs();
 
-  for(auto it = m_FrameReferencedResources.begin(); it != m_FrameReferencedResources.end(); ++it)
+  for(FrameRefShard &shard : m_FrameRefShards)
   {
-    RecordType *record = GetResourceRecord(it->first);
+    SCOPED_LOCK(shard.lock);
 
-    if(record)
+    for(auto it = shard.refs.begin(); it != shard.refs.end(); ++it)
     {
-      if(IncludesWrite(it->second))
-        MarkDirtyResource(it->first);
-      record->Delete(this);
+      RecordType *record = GetResourceRecord(it->first);
+
+      if(record)
+      {
+        if(IncludesWrite(it->second))
+          MarkDirtyResource(it->first);
+        record->Delete(this);
+      }
     }
-  }
 
-  m_FrameReferencedResources.clear();
+    shard.refs.clear();
+  }
 }
 
 template <typename Configuration>
@@ -1398,7 +1611,7 @@ void ResourceManager<Configuration>::RemoveReplacement(ResourceId id)
 template <typename Configuration>
 typename Configuration::RecordType *ResourceManager<Configuration>::GetResourceRecord(ResourceId id)
 {
-  SCOPED_LOCK(m_Lock);
+  SCOPED_READLOCK(m_RecordLock);
 
   auto it = m_ResourceRecords.find(id);
 
@@ -1411,7 +1624,7 @@ typename Configuration::RecordType *ResourceManager<Configuration>::GetResourceR
 template <typename Configuration>
 bool ResourceManager<Configuration>::HasResourceRecord(ResourceId id)
 {
-  SCOPED_LOCK(m_Lock);
+  SCOPED_READLOCK(m_RecordLock);
 
   auto it = m_ResourceRecords.find(id);
 
@@ -1425,6 +1638,7 @@ template <typename Configuration>
 typename Configuration::RecordType *ResourceManager<Configuration>::AddResourceRecord(ResourceId id)
 {
   SCOPED_LOCK(m_Lock);
+  SCOPED_WRITELOCK(m_RecordLock);
 
   RDCASSERT(m_ResourceRecords.find(id) == m_ResourceRecords.end(), id);
 
@@ -1435,6 +1649,7 @@ template <typename Configuration>
 void ResourceManager<Configuration>::RemoveResourceRecord(ResourceId id)
 {
   SCOPED_LOCK(m_Lock);
+  SCOPED_WRITELOCK(m_RecordLock);
 
   RDCASSERT(m_ResourceRecords.find(id) != m_ResourceRecords.end(), id);
 
@@ -25,14 +25,18 @@
 
 #include "android/android.h"
 #include "api/replay/renderdoc_replay.h"
+#include "common/overhead_counters.h"
 #include "common/threading.h"
+#include "common/timing.h"
 #include "core/core.h"
 #include "jpeg-compressor/jpgd.h"
 #include "os/os_specific.h"
 #include "replay/replay_driver.h"
+#include "serialise/rdcfile.h"
 #include "serialise/serialiser.h"
+#include "strings/string_utils.h"
 
-static const uint32_t TargetControlProtocolVersion = 6;
+static const uint32_t TargetControlProtocolVersion = 11;
 
 static bool IsProtocolVersionSupported(const uint32_t protocolVersion)
 {
@@ -52,6 +56,26 @@ static bool IsProtocolVersionSupported(const uint32_t protocolVersion)
   if(protocolVersion == 5)
     return true;
 
+  // 6 -> 7 added saving frames from the flight recorder
+  if(protocolVersion == 6)
+    return true;
+
+  // 7 -> 8 capture copies are sent in checksummed blocks and can resume
+  if(protocolVersion == 7)
+    return true;
+
+  // 8 -> 9 capture copies can return the path for the client to fetch the file itself
+  if(protocolVersion == 8)
+    return true;
+
+  // 9 -> 10 captures can be streamed to the client as they're written
+  if(protocolVersion == 9)
+    return true;
+
+  // 10 -> 11 added capture overhead stats
+  if(protocolVersion == 10)
+    return true;
+
   if(protocolVersion == TargetControlProtocolVersion)
     return true;
 
@@ -72,7 +96,15 @@ enum PacketType : uint32_t
   ePacket_NewChild,
   ePacket_CaptureProgress,
   ePacket_CycleActiveWindow,
-  ePacket_CapturableWindowCount
+  ePacket_CapturableWindowCount,
+  ePacket_SaveRecordedFrames,
+  ePacket_StreamCaptures,
+  ePacket_CaptureStreamBegin,
+  ePacket_CaptureStreamData,
+  ePacket_CaptureStreamPatch,
+  ePacket_CaptureStreamEnd,
+  ePacket_EnableOverheadStats,
+  ePacket_OverheadStats,
 };
 
 DECLARE_REFLECTION_ENUM(PacketType);
@@ -95,6 +127,14 @@ rdcstr DoStringise(const PacketType &el)
     STRINGISE_ENUM_NAMED(ePacket_CaptureProgress, "Capture Progress");
     STRINGISE_ENUM_NAMED(ePacket_CycleActiveWindow, "Cycle Active Window");
     STRINGISE_ENUM_NAMED(ePacket_CapturableWindowCount, "Capturable Window Count");
+    STRINGISE_ENUM_NAMED(ePacket_SaveRecordedFrames, "Save Recorded Frames");
+    STRINGISE_ENUM_NAMED(ePacket_StreamCaptures, "Stream Captures");
+    STRINGISE_ENUM_NAMED(ePacket_CaptureStreamBegin, "Capture Stream Begin");
+    STRINGISE_ENUM_NAMED(ePacket_CaptureStreamData, "Capture Stream Data");
+    STRINGISE_ENUM_NAMED(ePacket_CaptureStreamPatch, "Capture Stream Patch");
+    STRINGISE_ENUM_NAMED(ePacket_CaptureStreamEnd, "Capture Stream End");
+    STRINGISE_ENUM_NAMED(ePacket_EnableOverheadStats, "Enable Overhead Stats");
+    STRINGISE_ENUM_NAMED(ePacket_OverheadStats, "Overhead Stats");
   }
   END_ENUM_STRINGISE();
 }
@@ -102,6 +142,165 @@ rdcstr DoStringise(const PacketType &el)
 #define WRITE_DATA_SCOPE() WriteSerialiser &ser = writer;
 #define READ_DATA_SCOPE() ReadSerialiser &ser = reader;
 
+// captures streamed to the target control client are queued here as they're written, and sent on
+// by the client thread. Writing blocks while too much is queued, so a slow connection holds up
+// writing the capture instead of it all piling up in memory.
+class CaptureStreamQueue : public RDCFileStream
+{
+public:
+  struct Packet
+  {
+    PacketType type = ePacket_Noop;
+    // for ePacket_CaptureStreamBegin, the path the capture would have been saved to
+    rdcstr path;
+    // for ePacket_CaptureStreamPatch, where in the file to write data
+    uint64_t offset = 0;
+    bytebuf data;
+    // for ePacket_CaptureStreamEnd
+    bool success = false;
+  };
+
+  void SetEnabled(bool enabled)
+  {
+    SCOPED_LOCK(m_Lock);
+    m_Enabled = enabled;
+  }
+
+  // starts a new capture. Returns false if streaming isn't enabled, and the capture should be
+  // written to disk as normal.
+  bool Begin(const rdcstr &path)
+  {
+    {
+      SCOPED_LOCK(m_Lock);
+      if(!m_Enabled)
+        return false;
+      m_Aborted = false;
+    }
+
+    m_Pending.clear();
+
+    Packet packet;
+    packet.type = ePacket_CaptureStreamBegin;
+    packet.path = path;
+    return Push(packet);
+  }
+
+  // called when the client goes away. Anything queued is dropped and the capture being streamed
+  // fails, and no more captures are streamed.
+  void Abort()
+  {
+    SCOPED_LOCK(m_Lock);
+    m_Enabled = false;
+    m_Aborted = true;
+    m_Queue.clear();
+    m_QueuedBytes = 0;
+  }
+
+  bool Pop(Packet &packet)
+  {
+    SCOPED_LOCK(m_Lock);
+    if(m_Queue.empty())
+      return false;
+
+    packet = std::move(m_Queue[0]);
+    m_Queue.erase(0);
+    m_QueuedBytes -= packet.data.size();
+    return true;
+  }
+
+  bool Write(const void *data, uint64_t numBytes) override
+  {
+    m_Pending.append((const byte *)data, (size_t)numBytes);
+
+    if(m_Pending.size() >= PacketSize)
+      return Flush();
+
+    return true;
+  }
+
+  bool Flush() override
+  {
+    if(m_Pending.empty())
+      return true;
+
+    Packet packet;
+    packet.type = ePacket_CaptureStreamData;
+    packet.data.swap(m_Pending);
+    return Push(packet);
+  }
+
+  bool Patch(uint64_t offset, const void *data, uint64_t numBytes) override
+  {
+    if(!Flush())
+      return false;
+
+    Packet packet;
+    packet.type = ePacket_CaptureStreamPatch;
+    packet.offset = offset;
+    packet.data.assign((const byte *)data, (size_t)numBytes);
+    return Push(packet);
+  }
+
+  void Finish(bool success) override
+  {
+    success = Flush() && success;
+
+    Packet packet;
+    packet.type = ePacket_CaptureStreamEnd;
+    packet.success = success;
+    Push(packet);
+  }
+
+private:
+  static const size_t PacketSize = 1024 * 1024;
+  static const uint64_t MaxQueuedBytes = 32 * 1024 * 1024;
+
+  bool Push(Packet &packet)
+  {
+    while(true)
+    {
+      {
+        SCOPED_LOCK(m_Lock);
+
+        if(m_Aborted)
+          return false;
+
+        if(m_QueuedBytes < MaxQueuedBytes)
+        {
+          m_QueuedBytes += packet.data.size();
+          m_Queue.push_back(std::move(packet));
+          return true;
+        }
+      }
+
+      // wait for the client thread to send some of what's queued
+      Threading::Sleep(1);
+    }
+  }
+
+  Threading::CriticalSection m_Lock;
+  rdcarray<Packet> m_Queue;
+  uint64_t m_QueuedBytes = 0;
+  bool m_Enabled = false;
+  bool m_Aborted = false;
+
+  // only accessed by the thread writing the capture, data collected up into a packet
+  bytebuf m_Pending;
+};
+
+// this lives as long as the process, since on shutdown the client thread isn't always joined
+static CaptureStreamQueue &GetCaptureStreamQueue()
+{
+  static CaptureStreamQueue queue;
+  return queue;
+}
+
+RDCFileStream *RenderDoc::BeginCaptureStream(const rdcstr &path)
+{
+  CaptureStreamQueue &queue = GetCaptureStreamQueue();
+  return queue.Begin(path) ? &queue : NULL;
+}
+
 void RenderDoc::TargetControlClientThread(uint32_t version, Network::Socket *client)
 {
   Threading::SetCurrentThreadName("TargetControlClientThread");
@@ -153,6 +352,12 @@ void RenderDoc::TargetControlClientThread(uint32_t version, Network::Socket *cli
   float prevCaptureProgress = captureProgress;
   uint32_t prevWindows = 0;
 
+  // overhead stats are sent every second while the client has enabled them, as rates since the
+  // previous update
+  const double overheadtime = 1000.0;
+  PerformanceTimer overheadTimer;
+  int64_t prevOverhead[(size_t)OverheadCounter::Count] = {};
+
   while(client)
   {
     if(RenderDoc::Inst().m_ControlClientThreadShutdown || !client->Connected())
@@ -171,6 +376,34 @@ void RenderDoc::TargetControlClientThread(uint32_t version, Network::Socket *cli
 
     uint32_t curWindows = RenderDoc::Inst().GetCapturableWindowCount();
 
+    // send on anything queued from a capture being streamed. This is after fetching the list of
+    // captures, so a streamed capture has always been sent completely before it's announced.
+    {
+      CaptureStreamQueue::Packet packet;
+      while(!writer.IsErrored() && GetCaptureStreamQueue().Pop(packet))
+      {
+        WRITE_DATA_SCOPE();
+        SCOPED_SERIALISE_CHUNK(packet.type);
+        if(packet.type == ePacket_CaptureStreamBegin)
+        {
+          SERIALISE_ELEMENT(packet.path);
+        }
+        else if(packet.type == ePacket_CaptureStreamData)
+        {
+          SERIALISE_ELEMENT(packet.data);
+        }
+        else if(packet.type == ePacket_CaptureStreamPatch)
+        {
+          SERIALISE_ELEMENT(packet.offset);
+          SERIALISE_ELEMENT(packet.data);
+        }
+        else if(packet.type == ePacket_CaptureStreamEnd)
+        {
+          SERIALISE_ELEMENT(packet.success);
+        }
+      }
+    }
+
     if(curdrivers != drivers)
     {
       // find the first difference, either a new key or a key with a different value, and send it.
@@ -214,12 +447,16 @@ void RenderDoc::TargetControlClientThread(uint32_t version, Network::Socket *cli
 
       bytebuf buf;
 
-      ICaptureFile *file = RENDERDOC_OpenCaptureFile();
-      if(file->OpenFile(captures.back().path.c_str(), "rdc", NULL) == ReplayStatus::Succeeded)
+      // streamed captures were never written here, the client reads the thumbnail itself
+      if(FileIO::exists(captures.back().path.c_str()))
       {
-        buf = file->GetThumbnail(FileType::JPG, 0).data;
+        ICaptureFile *file = RENDERDOC_OpenCaptureFile();
+        if(file->OpenFile(captures.back().path.c_str(), "rdc", NULL) == ReplayStatus::Succeeded)
+        {
+          buf = file->GetThumbnail(FileType::JPG, 0).data;
+        }
+        file->Shutdown();
       }
-      file->Shutdown();
 
       WRITE_DATA_SCOPE();
       {
@@ -287,6 +524,51 @@ void RenderDoc::TargetControlClientThread(uint32_t version, Network::Socket *cli
       }
     }
 
+    if(OverheadCounters::IsEnabled() && overheadTimer.GetMilliseconds() > overheadtime)
+    {
+      const double seconds = overheadTimer.GetMilliseconds() / 1000.0;
+      overheadTimer.Restart();
+
+      double rates[(size_t)OverheadCounter::Count];
+      for(size_t i = 0; i < (size_t)OverheadCounter::Count; i++)
+      {
+        int64_t cur = OverheadCounters::Get((OverheadCounter)i);
+        rates[i] = double(cur - prevOverhead[i]) / seconds;
+        prevOverhead[i] = cur;
+      }
+
+      // ticks per millisecond
+      const double tickFrequency = Timing::GetTickFrequency();
+
+      float chunksPerSecond = float(rates[(size_t)OverheadCounter::SerialisedChunks]);
+      float diffedBytesPerSecond = float(rates[(size_t)OverheadCounter::DiffedBytes]);
+      float scannedMapBytesPerSecond = float(rates[(size_t)OverheadCounter::ScannedMapBytes]);
+      float lockWaitMSPerSecond =
+          float(rates[(size_t)OverheadCounter::LockWaitTicks] / tickFrequency);
+      float prepareInitialStateMSPerSecond =
+          float(rates[(size_t)OverheadCounter::PrepareInitialStateTicks] / tickFrequency);
+
+      rdcarray<rdcstr> poolNames;
+      rdcarray<uint64_t> poolCounts;
+      for(const rdcpair<rdcstr, uint64_t> &pool : OverheadCounters::GetPoolLiveCounts())
+      {
+        poolNames.push_back(pool.first);
+        poolCounts.push_back(pool.second);
+      }
+
+      WRITE_DATA_SCOPE();
+      {
+        SCOPED_SERIALISE_CHUNK(ePacket_OverheadStats);
+        SERIALISE_ELEMENT(chunksPerSecond);
+        SERIALISE_ELEMENT(diffedBytesPerSecond);
+        SERIALISE_ELEMENT(scannedMapBytesPerSecond);
+        SERIALISE_ELEMENT(lockWaitMSPerSecond);
+        SERIALISE_ELEMENT(prepareInitialStateMSPerSecond);
+        SERIALISE_ELEMENT(poolNames);
+        SERIALISE_ELEMENT(poolCounts);
+      }
+    }
+
     if(curtime > pingtime)
     {
       WRITE_DATA_SCOPE();
@@ -342,10 +624,23 @@ void RenderDoc::TargetControlClientThread(uint32_t version, Network::Socket *cli
         caps = RenderDoc::Inst().GetCaptures();
 
         uint32_t id;
+        uint64_t resumeOffset = 0, resumeChecksum = 0;
+        bool direct = false;
 
         {
           READ_DATA_SCOPE();
           SERIALISE_ELEMENT(id);
+
+          if(version >= 8)
+          {
+            SERIALISE_ELEMENT(resumeOffset);
+            SERIALISE_ELEMENT(resumeChecksum);
+          }
+
+          if(version >= 9)
+          {
+            SERIALISE_ELEMENT(direct);
+          }
         }
 
         if(id < caps.size())
@@ -356,10 +651,41 @@ void RenderDoc::TargetControlClientThread(uint32_t version, Network::Socket *cli
 
           rdcstr filename = caps[id].path;
 
-          StreamReader fileStream(FileIO::fopen(filename.c_str(), "rb"));
-          ser.SerialiseStream(filename, fileStream);
+          bool success = false;
+
+          if(version >= 9)
+          {
+            SERIALISE_ELEMENT(direct);
+          }
+
+          if(direct)
+          {
+            // the client will fetch the file itself, it only needs to know where it is
+            uint64_t totalSize = FileIO::GetFileSize(filename);
+            SERIALISE_ELEMENT(filename);
+            SERIALISE_ELEMENT(totalSize);
+
+            success = true;
+          }
+          else if(version >= 8)
+          {
+            uint64_t totalSize = FileIO::GetFileSize(filename);
+            uint64_t startOffset =
+                ValidateFileTransferResumePoint(filename, resumeOffset, resumeChecksum);
+            SERIALISE_ELEMENT(totalSize);
+            SERIALISE_ELEMENT(startOffset);
+
+            success = SendFileBlocks(ser.GetWriter(), filename, startOffset, totalSize, NULL);
+          }
+          else
+          {
+            StreamReader fileStream(FileIO::fopen(filename.c_str(), "rb"));
+            ser.SerialiseStream(filename, fileStream);
+
+            success = !fileStream.IsErrored();
+          }
 
-          if(fileStream.IsErrored() || ser.IsErrored())
+          if(!success || ser.IsErrored())
             SAFE_DELETE(client);
           else
             RenderDoc::Inst().MarkCaptureRetrieved(id);
@@ -369,6 +695,41 @@ void RenderDoc::TargetControlClientThread(uint32_t version, Network::Socket *cli
       {
         RenderDoc::Inst().CycleActiveWindow();
       }
+      else if(type == ePacket_SaveRecordedFrames)
+      {
+        uint32_t frameNum = 0;
+        uint32_t numFrames = 1;
+
+        READ_DATA_SCOPE();
+        SERIALISE_ELEMENT(frameNum);
+        SERIALISE_ELEMENT(numFrames);
+
+        RenderDoc::Inst().SaveRecordedFrames(frameNum, numFrames);
+      }
+      else if(type == ePacket_StreamCaptures)
+      {
+        bool enable = false;
+
+        READ_DATA_SCOPE();
+        SERIALISE_ELEMENT(enable);
+
+        // a capture already being streamed is still finished if streaming is turned off
+        GetCaptureStreamQueue().SetEnabled(enable);
+      }
+      else if(type == ePacket_EnableOverheadStats)
+      {
+        bool enable = false;
+
+        READ_DATA_SCOPE();
+        SERIALISE_ELEMENT(enable);
+
+        // the first update only covers what happened after this
+        for(size_t i = 0; i < (size_t)OverheadCounter::Count; i++)
+          prevOverhead[i] = OverheadCounters::Get((OverheadCounter)i);
+        overheadTimer.Restart();
+
+        OverheadCounters::SetEnabled(enable);
+      }
 
       reader.EndChunk();
 
@@ -379,6 +740,12 @@ void RenderDoc::TargetControlClientThread(uint32_t version, Network::Socket *cli
 
   RenderDoc::Inst().SetProgressCallback<CaptureProgress>(RENDERDOC_ProgressCallback());
 
+  // nothing can be streamed without a client to send it to
+  GetCaptureStreamQueue().Abort();
+
+  // nor is there anyone to send overhead stats to
+  OverheadCounters::SetEnabled(false);
+
   // give up our connection
   {
     SCOPED_LOCK(RenderDoc::Inst().m_SingleClientLock);
@@ -515,8 +882,11 @@ void RenderDoc::TargetControlServerThread(Network::Socket *sock)
 struct TargetControl : public ITargetControl
 {
 public:
-  TargetControl(Network::Socket *sock, rdcstr clientName, bool forceConnection)
+  TargetControl(Network::Socket *sock, rdcstr clientName, bool forceConnection,
+                IDeviceProtocolHandler *protocol, const rdcstr &deviceID)
       : m_Socket(sock),
+        m_Protocol(protocol),
+        m_DeviceID(deviceID),
         reader(new StreamReader(sock, Ownership::Nothing), Ownership::Stream),
         writer(new StreamWriter(sock, Ownership::Nothing), Ownership::Stream)
   {
@@ -594,6 +964,7 @@ public:
   bool Connected() { return m_Socket != NULL && m_Socket->Connected(); }
   void Shutdown()
   {
+    FinishCaptureStream(false);
     SAFE_DELETE(m_Socket);
     delete this;
   }
@@ -627,18 +998,13 @@ public:
 
   void CopyCapture(uint32_t remoteID, const char *localpath)
   {
-    WRITE_DATA_SCOPE();
-    SCOPED_SERIALISE_CHUNK(ePacket_CopyCapture);
-
-    SERIALISE_ELEMENT(remoteID);
+    m_CaptureCopies[remoteID] = localpath;
 
-    if(ser.IsErrored())
-    {
-      SAFE_DELETE(m_Socket);
-      return;
-    }
+    // if the device can give us the file directly that is usually much faster than sending it
+    // over a forwarded connection, e.g. adb pull for Android
+    bool direct = m_Version >= 9 && m_Protocol && m_Protocol->CanPullFiles(m_DeviceID);
 
-    m_CaptureCopies[remoteID] = localpath;
+    RequestCaptureCopy(remoteID, direct);
   }
 
   void DeleteCapture(uint32_t remoteID)
@@ -664,6 +1030,53 @@ public:
       SAFE_DELETE(m_Socket);
   }
 
+  void SaveRecordedFrames(uint32_t frameNumber, uint32_t numFrames)
+  {
+    if(m_Version < 7)
+      return;
+
+    WRITE_DATA_SCOPE();
+    SCOPED_SERIALISE_CHUNK(ePacket_SaveRecordedFrames);
+
+    SERIALISE_ELEMENT(frameNumber);
+    SERIALISE_ELEMENT(numFrames);
+
+    if(ser.IsErrored())
+      SAFE_DELETE(m_Socket);
+  }
+
+  void StreamCaptures(const char *localDirectory)
+  {
+    if(m_Version < 10)
+      return;
+
+    m_StreamDirectory = localDirectory ? localDirectory : "";
+
+    bool enable = !m_StreamDirectory.empty();
+
+    WRITE_DATA_SCOPE();
+    SCOPED_SERIALISE_CHUNK(ePacket_StreamCaptures);
+
+    SERIALISE_ELEMENT(enable);
+
+    if(ser.IsErrored())
+      SAFE_DELETE(m_Socket);
+  }
+
+  void EnableOverheadStats(bool enable)
+  {
+    if(m_Version < 11)
+      return;
+
+    WRITE_DATA_SCOPE();
+    SCOPED_SERIALISE_CHUNK(ePacket_EnableOverheadStats);
+
+    SERIALISE_ELEMENT(enable);
+
+    if(ser.IsErrored())
+      SAFE_DELETE(m_Socket);
+  }
+
   TargetControlMessage ReceiveMessage(RENDERDOC_ProgressCallback progress)
   {
     TargetControlMessage msg;
@@ -777,6 +1190,22 @@ public:
       if(driver != RDCDriver::Unknown)
         msg.newCapture.api = ToStr(driver);
 
+      // a streamed capture only exists here, so report it the same as one that's been copied
+      auto streamed = m_StreamedCaptures.find(msg.newCapture.path);
+      if(streamed != m_StreamedCaptures.end())
+      {
+        msg.newCapture.path = streamed->second;
+        msg.newCapture.byteSize = FileIO::GetFileSize(msg.newCapture.path);
+        m_StreamedCaptures.erase(streamed);
+
+        ICaptureFile *file = RENDERDOC_OpenCaptureFile();
+        if(file->OpenFile(msg.newCapture.path.c_str(), "rdc", NULL) == ReplayStatus::Succeeded)
+        {
+          thumbnail = file->GetThumbnail(FileType::JPG, 0).data;
+        }
+        file->Shutdown();
+      }
+
       msg.newCapture.local = FileIO::exists(msg.newCapture.path.c_str());
 
       RDCLOG("Got a new capture: %d (frame %u) (%u bytes) (time %llu) %d byte thumbnail",
@@ -842,9 +1271,73 @@ public:
 
       msg.newCapture.path = m_CaptureCopies[msg.newCapture.captureId];
 
-      StreamWriter streamWriter(FileIO::fopen(msg.newCapture.path.c_str(), "wb"), Ownership::Stream);
+      bool direct = false;
+      if(m_Version >= 9)
+      {
+        SERIALISE_ELEMENT(direct);
+      }
+
+      if(direct)
+      {
+        rdcstr filename;
+        uint64_t totalSize = 0;
+        SERIALISE_ELEMENT(filename);
+        SERIALISE_ELEMENT(totalSize);
+
+        reader.EndChunk();
+
+        if(reader.IsErrored())
+        {
+          SAFE_DELETE(m_Socket);
+
+          msg.type = TargetControlMessageType::Disconnected;
+          return msg;
+        }
+
+        rdcstr partialPath = msg.newCapture.path + ".partial";
+
+        if(m_Protocol->PullFile(m_DeviceID, filename, partialPath, totalSize, progress) &&
+           FileIO::Move(partialPath.c_str(), msg.newCapture.path.c_str(), true))
+        {
+          m_CaptureCopies.erase(msg.newCapture.captureId);
+          return msg;
+        }
+
+        // if that didn't work, fall back to having the file sent over the connection. We'll get
+        // another reply to this copy when it's done.
+        RDCWARN("Couldn't fetch '%s' directly from the device, copying over the connection",
+                filename.c_str());
+
+        RequestCaptureCopy(msg.newCapture.captureId, false);
+
+        msg.type = TargetControlMessageType::Noop;
+        return msg;
+      }
+      else if(m_Version >= 8)
+      {
+        uint64_t totalSize = 0, startOffset = 0;
+        SERIALISE_ELEMENT(totalSize);
+        SERIALISE_ELEMENT(startOffset);
+
+        // receive into a partial file, which is kept if the connection drops so a later copy can
+        // resume from it.
+        rdcstr partialPath = msg.newCapture.path + ".partial";
 
-      ser.SerialiseStream(msg.newCapture.path.c_str(), streamWriter, progress);
+        bool complete =
+            ReceiveFileBlocks(ser.GetReader(), partialPath, startOffset, totalSize, progress);
+
+        if(complete && !reader.IsErrored())
+          FileIO::Move(partialPath.c_str(), msg.newCapture.path.c_str(), true);
+        else if(!reader.IsErrored())
+          RDCERR("Capture copy to '%s' was corrupted in transfer", msg.newCapture.path.c_str());
+      }
+      else
+      {
+        StreamWriter streamWriter(FileIO::fopen(msg.newCapture.path.c_str(), "wb"),
+                                  Ownership::Stream);
+
+        ser.SerialiseStream(msg.newCapture.path.c_str(), streamWriter, progress);
+      }
 
       if(reader.IsErrored())
       {
@@ -859,6 +1352,23 @@ public:
       reader.EndChunk();
       return msg;
     }
+    else if(type == ePacket_CaptureStreamBegin || type == ePacket_CaptureStreamData ||
+            type == ePacket_CaptureStreamPatch || type == ePacket_CaptureStreamEnd)
+    {
+      ReceiveCaptureStream(type);
+
+      if(reader.IsErrored())
+      {
+        FinishCaptureStream(false);
+        SAFE_DELETE(m_Socket);
+
+        msg.type = TargetControlMessageType::Disconnected;
+        return msg;
+      }
+
+      msg.type = TargetControlMessageType::Noop;
+      return msg;
+    }
     else if(type == ePacket_CapturableWindowCount)
     {
       msg.type = TargetControlMessageType::CapturableWindowCount;
@@ -869,6 +1379,35 @@ public:
       reader.EndChunk();
       return msg;
     }
+    else if(type == ePacket_OverheadStats)
+    {
+      msg.type = TargetControlMessageType::CaptureOverhead;
+
+      rdcarray<rdcstr> poolNames;
+      rdcarray<uint64_t> poolCounts;
+
+      READ_DATA_SCOPE();
+      SERIALISE_ELEMENT(msg.overhead.chunksPerSecond).Named("chunksPerSecond"_lit);
+      SERIALISE_ELEMENT(msg.overhead.diffedBytesPerSecond).Named("diffedBytesPerSecond"_lit);
+      SERIALISE_ELEMENT(msg.overhead.scannedMapBytesPerSecond)
+          .Named("scannedMapBytesPerSecond"_lit);
+      SERIALISE_ELEMENT(msg.overhead.lockWaitMSPerSecond).Named("lockWaitMSPerSecond"_lit);
+      SERIALISE_ELEMENT(msg.overhead.prepareInitialStateMSPerSecond)
+          .Named("prepareInitialStateMSPerSecond"_lit);
+      SERIALISE_ELEMENT(poolNames);
+      SERIALISE_ELEMENT(poolCounts);
+
+      for(size_t i = 0; i < poolNames.size() && i < poolCounts.size(); i++)
+      {
+        PoolObjectCount pool;
+        pool.name = poolNames[i];
+        pool.count = poolCounts[i];
+        msg.overhead.poolObjects.push_back(pool);
+      }
+
+      reader.EndChunk();
+      return msg;
+    }
     else
     {
       RDCERR("Unexpected packed received: %d", type);
@@ -880,13 +1419,137 @@ public:
   }
 
 private:
+  void ReceiveCaptureStream(PacketType type)
+  {
+    READ_DATA_SCOPE();
+
+    if(type == ePacket_CaptureStreamBegin)
+    {
+      rdcstr path;
+      SERIALISE_ELEMENT(path);
+
+      // a capture that was never finished is abandoned
+      FinishCaptureStream(false);
+
+      // streaming may have been turned off since this capture began, it still has to go somewhere
+      rdcstr dir = m_StreamDirectory.empty() ? FileIO::GetTempFolderFilename()
+                                             : m_StreamDirectory + "/";
+
+      m_StreamRemotePath = path;
+      m_StreamLocalPath = dir + get_basename(path);
+
+      FileIO::CreateParentDirectory(m_StreamLocalPath);
+      m_StreamFile = FileIO::fopen(m_StreamLocalPath.c_str(), "wb");
+
+      if(m_StreamFile == NULL)
+        RDCERR("Couldn't open '%s' to receive streamed capture", m_StreamLocalPath.c_str());
+    }
+    else if(type == ePacket_CaptureStreamData)
+    {
+      bytebuf data;
+      SERIALISE_ELEMENT(data);
+
+      if(m_StreamFile && FileIO::fwrite(data.data(), 1, data.size(), m_StreamFile) != data.size())
+      {
+        RDCERR("Error writing streamed capture to '%s'", m_StreamLocalPath.c_str());
+        FinishCaptureStream(false);
+      }
+    }
+    else if(type == ePacket_CaptureStreamPatch)
+    {
+      uint64_t offset = 0;
+      bytebuf data;
+      SERIALISE_ELEMENT(offset);
+      SERIALISE_ELEMENT(data);
+
+      if(m_StreamFile)
+      {
+        uint64_t end = FileIO::ftell64(m_StreamFile);
+        FileIO::fseek64(m_StreamFile, offset, SEEK_SET);
+        size_t written = FileIO::fwrite(data.data(), 1, data.size(), m_StreamFile);
+        FileIO::fseek64(m_StreamFile, end, SEEK_SET);
+
+        if(written != data.size())
+        {
+          RDCERR("Error writing streamed capture to '%s'", m_StreamLocalPath.c_str());
+          FinishCaptureStream(false);
+        }
+      }
+    }
+    else if(type == ePacket_CaptureStreamEnd)
+    {
+      bool success = false;
+      SERIALISE_ELEMENT(success);
+
+      FinishCaptureStream(success);
+    }
+
+    reader.EndChunk();
+  }
+
+  void FinishCaptureStream(bool success)
+  {
+    if(m_StreamFile == NULL)
+      return;
+
+    FileIO::fclose(m_StreamFile);
+    m_StreamFile = NULL;
+
+    if(success)
+    {
+      RDCLOG("Received streamed capture '%s'", m_StreamLocalPath.c_str());
+      m_StreamedCaptures[m_StreamRemotePath] = m_StreamLocalPath;
+    }
+    else
+    {
+      RDCERR("Streaming capture to '%s' failed", m_StreamLocalPath.c_str());
+      FileIO::Delete(m_StreamLocalPath.c_str());
+    }
+  }
+
+  void RequestCaptureCopy(uint32_t remoteID, bool direct)
+  {
+    WRITE_DATA_SCOPE();
+    SCOPED_SERIALISE_CHUNK(ePacket_CopyCapture);
+
+    SERIALISE_ELEMENT(remoteID);
+
+    if(m_Version >= 8)
+    {
+      // if an earlier copy to the same path was interrupted, ask to resume it
+      uint64_t resumeOffset = 0, resumeChecksum = 0;
+      GetFileTransferResumePoint(m_CaptureCopies[remoteID] + ".partial", resumeOffset,
+                                 resumeChecksum);
+      SERIALISE_ELEMENT(resumeOffset);
+      SERIALISE_ELEMENT(resumeChecksum);
+    }
+
+    if(m_Version >= 9)
+    {
+      SERIALISE_ELEMENT(direct);
+    }
+
+    if(ser.IsErrored())
+      SAFE_DELETE(m_Socket);
+  }
+
   Network::Socket *m_Socket;
+  IDeviceProtocolHandler *m_Protocol;
+  rdcstr m_DeviceID;
   WriteSerialiser writer;
   ReadSerialiser reader;
   rdcstr m_Target, m_API, m_BusyClient;
   uint32_t m_Version, m_PID;
 
   std::map<uint32_t, rdcstr> m_CaptureCopies;
+
+  // where captures streamed to us are saved, and the one currently being received
+  rdcstr m_StreamDirectory;
+  FILE *m_StreamFile = NULL;
+  rdcstr m_StreamRemotePath, m_StreamLocalPath;
+
+  // finished streamed captures by their path on the target, until they're announced
+  std::map<rdcstr, rdcstr> m_StreamedCaptures;
 };
 
 extern "C" RENDERDOC_API ITargetControl *RENDERDOC_CC RENDERDOC_CreateTargetControl(
@@ -916,7 +1579,8 @@ extern "C" RENDERDOC_API ITargetControl *RENDERDOC_CC RENDERDOC_CreateTargetCont
   if(sock == NULL)
     return NULL;
 
-  TargetControl *remote = new TargetControl(sock, clientName, forceConnection != 0);
+  TargetControl *remote =
+      new TargetControl(sock, clientName, forceConnection != 0, protocol, deviceID);
 
   if(remote->Connected())
     return remote;
@@ -64,5 +64,7 @@ DECLARE_EMBED(glsl_deptharr2ms_frag);
 DECLARE_EMBED(glsl_depthms2arr_frag);
 DECLARE_EMBED(glsl_gles_texsample_h);
 DECLARE_EMBED(glsl_texremap_frag);
+DECLARE_EMBED(glsl_tilecompact_comp);
+DECLARE_EMBED(glsl_texremap_comp);
 
 #undef DECLARE_EMBED
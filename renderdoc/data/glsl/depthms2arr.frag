@@ -35,14 +35,14 @@ layout(push_constant) uniform multisamplePush
   int numMultiSamples;
   int currentSample;
   int currentSlice;
-  uint currentStencil;
+  uint currentStencilBit;
 }
 mscopy;
 
 #define numMultiSamples (mscopy.numMultiSamples)
 #define currentSample (mscopy.currentSample)
 #define currentSlice (mscopy.currentSlice)
-#define currentStencil (mscopy.currentStencil)
+#define currentStencilBit (mscopy.currentStencilBit)
 
 #else
 
@@ -55,7 +55,7 @@ uniform ivec4 mscopy;
 #define numMultiSamples (mscopy.x)
 #define currentSample (mscopy.y)
 #define currentSlice (mscopy.z)
-#define currentStencil (uint(mscopy.w))
+#define currentStencilBit (uint(mscopy.w))
 
 #endif
 
@@ -63,11 +63,13 @@ void main()
 {
   ivec3 srcCoord = ivec3(int(gl_FragCoord.x), int(gl_FragCoord.y), currentSlice);
 
-  if(currentStencil < 256u)
+  // stencil is written one bit at a time, with only that bit in the write mask. Discard wherever
+  // the source doesn't have the bit set so it keeps the cleared value of 0.
+  if(currentStencilBit < 8u)
   {
     uint stencil = texelFetch(srcStencilMS, srcCoord, currentSample).x;
 
-    if(stencil != currentStencil)
+    if((stencil & (1u << currentStencilBit)) == 0u)
       discard;
   }
 
@@ -168,6 +168,15 @@ vec3 CalcCubeCoord(vec2 uv, int face)
 
 #define HGRAM_NUM_BUCKETS 256u
 
+// texture readback remapping is one thread per texel, in NxN groups. The output format is
+// selected by HistogramFlags
+#define TEXREMAP_GROUP_SIZE 8u
+
+#define TEXREMAP_RGBA8 0u
+#define TEXREMAP_RGBA8_SRGB 1u
+#define TEXREMAP_RGBA16 2u
+#define TEXREMAP_RGBA32 3u
+
 #define MESH_OTHER 0u    // this covers points and lines, logic is the same
 #define MESH_TRIANGLE_LIST 1u
 #define MESH_TRIANGLE_STRIP 2u
@@ -41,6 +41,15 @@
 #ifdef VULKAN
 // descriptor set will be patched from 0 to whichever descriptor set we're using in code
 layout(set = 0, binding = 0, r32ui) uniform coherent uimage2DArray overdrawImage;
+
+// per-draw totals, bound with a dynamic offset for each draw
+layout(set = 0, binding = 1, std430) buffer drawStatsBuffer
+{
+  uint shadedPixels;
+  uint helperLanes;
+  uint quads;
+}
+drawStats;
 #else    // OPENGL and OPENGL_ES
 
 // if we're compiling for GL SPIR-V, give the image an explicit binding
@@ -73,6 +82,27 @@ void main()
 
   ivec3 quad = ivec3(gl_FragCoord.xy * 0.5, pixelCount);
   imageAtomicAdd(overdrawImage, quad, 1);
+
+#ifdef VULKAN
+  // build a mask of which pixels in the quad are live, indexed by their position in the quad, so
+  // that exactly one live pixel can account for the whole quad
+  uint q = p.x + 2u * p.y;
+  uint liveMask = (1u << q);
+  if(c1 != 0u)
+    liveMask |= (1u << (q ^ 1u));
+  if(c2 != 0u)
+    liveMask |= (1u << (q ^ 2u));
+  if(c3 != 0u)
+    liveMask |= (1u << (q ^ 3u));
+
+  atomicAdd(drawStats.shadedPixels, 1u);
+
+  if(uint(findLSB(liveMask)) == q)
+  {
+    atomicAdd(drawStats.quads, 1u);
+    atomicAdd(drawStats.helperLanes, 4u - uint(bitCount(liveMask)));
+  }
+#endif
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////
@@ -152,6 +152,7 @@ WrappedID3D11DeviceContext::WrappedID3D11DeviceContext(WrappedID3D11Device *real
     m_ContextRecord->ResType = Resource_DeviceContext;
     m_ContextRecord->DataInSerialiser = false;
     m_ContextRecord->InternalResource = true;
+    m_ContextRecord->SpillChunks = true;
     m_ContextRecord->Length = 0;
     m_ContextRecord->NumSubResources = 0;
     m_ContextRecord->SubResources = NULL;
@@ -200,6 +201,8 @@ WrappedID3D11DeviceContext::WrappedID3D11DeviceContext(WrappedID3D11Device *real
 
 WrappedID3D11DeviceContext::~WrappedID3D11DeviceContext()
 {
+  ResetCoalescedUnmap();
+
   if(m_ContextRecord)
     m_ContextRecord->Delete(m_pDevice->GetResourceManager());
 
@@ -517,6 +520,8 @@ void WrappedID3D11DeviceContext::AttemptCapture()
     }
     m_ContextRecord->UnlockChunks();
 
+    ResetCoalescedUnmap();
+
     m_ContextRecord->FreeParents(m_pDevice->GetResourceManager());
   }
 }
@@ -639,6 +644,8 @@ void WrappedID3D11DeviceContext::CleanupCapture()
   }
   m_ContextRecord->UnlockChunks();
 
+  ResetCoalescedUnmap();
+
   m_ContextRecord->FreeParents(m_pDevice->GetResourceManager());
 }
 
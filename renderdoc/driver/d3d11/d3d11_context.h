@@ -122,6 +122,25 @@ private:
   std::set<ResourceId> m_HighTrafficResources;
   std::map<MappedResource, MapIntercept> m_OpenMaps;
 
+  // while capturing, a WRITE_NO_OVERWRITE Map/Unmap that directly follows the previous one on the
+  // same subresource is folded into that Unmap's chunk, so a ring of small appends produces one
+  // chunk covering the appended window instead of a Map and Unmap chunk per write.
+  struct CoalescedUnmap
+  {
+    MappedResource mapIdx;
+    // the most recent NO_OVERWRITE Unmap chunk recorded, and its written range
+    Chunk *unmapChunk = NULL;
+    uint32_t diffStart = 0;
+    uint32_t diffEnd = 0;
+    // the Map chunk of a map that may be coalesced, held back until its Unmap
+    Chunk *mapChunk = NULL;
+    // set while serialising an Unmap that is being folded into unmapChunk
+    bool merging = false;
+  } m_CoalescedUnmap;
+
+  bool CanCoalesceUnmap(const MappedResource &mapIdx);
+  void ResetCoalescedUnmap();
+
   struct StreamOutData
   {
     StreamOutData() : query(NULL), running(false), numPrims(0) {}
@@ -313,7 +332,14 @@ public:
   void SetFrameReader(StreamReader *reader) { m_FrameReader = reader; }
   void MarkResourceReferenced(ResourceId id, FrameRefType refType);
 
-  rdcarray<EventUsage> GetUsage(ResourceId id) { return m_ResourceUses[id]; }
+  rdcarray<EventUsage> GetUsage(ResourceId id)
+  {
+    // don't use operator[], looking up a resource with no usage shouldn't add an entry for it
+    auto it = m_ResourceUses.find(id);
+    if(it == m_ResourceUses.end())
+      return {};
+    return it->second;
+  }
   void ClearMaps();
 
   uint32_t GetEventID() { return m_CurEventID; }
@@ -5422,6 +5422,7 @@ HRESULT WrappedID3D11DeviceContext::FinishCommandList(BOOL RestoreDeferredContex
 
         // swap our chunks, references, and dirty resources with the 'baked' command list.
         m_ContextRecord->SwapChunks(r);
+        ResetCoalescedUnmap();
         wrapped->SwapReferences(m_DeferredReferences);
         wrapped->SwapDirtyResources(m_DeferredDirty);
       }
@@ -7336,6 +7337,30 @@ void MapIntercept::CopyToD3D(size_t RangeStart, size_t RangeEnd)
   }
 }
 
+// largest range a run of coalesced NO_OVERWRITE writes can grow to. Each merge re-serialises the
+// whole range, so this keeps long runs from going quadratic.
+static const uint32_t MaxCoalescedUnmapBytes = 64 * 1024;
+
+bool WrappedID3D11DeviceContext::CanCoalesceUnmap(const MappedResource &mapIdx)
+{
+  const CoalescedUnmap &prev = m_CoalescedUnmap;
+
+  if(prev.unmapChunk == NULL || prev.mapIdx.resource != mapIdx.resource ||
+     prev.mapIdx.subresource != mapIdx.subresource)
+    return false;
+
+  if(prev.diffEnd - prev.diffStart >= MaxCoalescedUnmapBytes)
+    return false;
+
+  return m_ContextRecord->HasChunks() && m_ContextRecord->GetLastChunk() == prev.unmapChunk;
+}
+
+void WrappedID3D11DeviceContext::ResetCoalescedUnmap()
+{
+  SAFE_DELETE(m_CoalescedUnmap.mapChunk);
+  m_CoalescedUnmap = CoalescedUnmap();
+}
+
 template <typename SerialiserType>
 bool WrappedID3D11DeviceContext::Serialise_Map(SerialiserType &ser, ID3D11Resource *pResource,
                                                UINT Subresource, D3D11_MAP MapType, UINT MapFlags,
@@ -7613,7 +7638,19 @@ HRESULT WrappedID3D11DeviceContext::Map(ID3D11Resource *pResource, UINT Subresou
         SERIALISE_ELEMENT(m_ResourceID).Named("Context"_lit).TypedAs("ID3D11DeviceContext *"_lit);
         Serialise_Map(GET_SERIALISER, pResource, Subresource, MapType, MapFlags, pMappedResource);
 
-        m_ContextRecord->AddChunk(scope.Get());
+        Chunk *chunk = scope.Get();
+
+        // if this write may be folded into the previous Unmap, hold the chunk until we know
+        if(MapType == D3D11_MAP_WRITE_NO_OVERWRITE &&
+           CanCoalesceUnmap(MappedResource(GetIDForResource(pResource), Subresource)))
+        {
+          SAFE_DELETE(m_CoalescedUnmap.mapChunk);
+          m_CoalescedUnmap.mapChunk = chunk;
+        }
+        else
+        {
+          m_ContextRecord->AddChunk(chunk);
+        }
       }
     }
     else    // IsIdleCapturing(m_State)
@@ -7792,6 +7829,39 @@ bool WrappedID3D11DeviceContext::Serialise_Unmap(SerialiserType &ser, ID3D11Reso
     {
       memcpy(record->GetShadowPtr(ctxMapID, 1) + diffStart, MapWrittenData, diffEnd - diffStart);
     }
+
+    // if this write is being folded into the previous Unmap, serialise the union of both ranges.
+    // The app's pointer holds the whole buffer's current contents so anything between the two
+    // ranges is still accurate.
+    if(m_CoalescedUnmap.merging)
+    {
+      uint32_t start = m_CoalescedUnmap.diffStart;
+      uint32_t end = m_CoalescedUnmap.diffEnd;
+
+      if(diffStart < diffEnd)
+      {
+        start = RDCMIN(start, diffStart);
+        end = RDCMAX(end, diffEnd);
+      }
+
+      if(end - start <= MaxCoalescedUnmapBytes)
+      {
+        diffStart = start;
+        diffEnd = end;
+        len = diffEnd - diffStart;
+        MapWrittenData = (byte *)intercept.app.pData + diffStart;
+      }
+      else
+      {
+        m_CoalescedUnmap.merging = false;
+      }
+    }
+
+    if(IsActiveCapturing(m_State))
+    {
+      m_CoalescedUnmap.diffStart = diffStart;
+      m_CoalescedUnmap.diffEnd = diffEnd;
+    }
   }    // if(ser.IsWriting())
 
   // if we're not actively capturing a frame, we'll skip serialising all this data for nothing as we
@@ -7965,12 +8035,48 @@ void WrappedID3D11DeviceContext::Unmap(ID3D11Resource *pResource, UINT Subresour
         MarkResourceReferenced(it->first.resource, eFrameRef_Read);
         MarkResourceReferenced(it->first.resource, eFrameRef_PartialWrite);
 
+        MappedResource mapIdx = it->first;
+        D3D11_MAP mapType = it->second.MapType;
+
+        // nothing must have been recorded since the previous Unmap for the two to be merged
+        m_CoalescedUnmap.merging = m_CoalescedUnmap.mapChunk && CanCoalesceUnmap(mapIdx);
+
         USE_SCRATCH_SERIALISER();
         SCOPED_SERIALISE_CHUNK(D3D11Chunk::Unmap);
         SERIALISE_ELEMENT(m_ResourceID).Named("Context"_lit).TypedAs("ID3D11DeviceContext *"_lit);
         Serialise_Unmap(GET_SERIALISER, pResource, Subresource);
 
-        m_ContextRecord->AddChunk(scope.Get());
+        Chunk *chunk = scope.Get();
+
+        if(m_CoalescedUnmap.merging)
+        {
+          // the new chunk covers both writes, so replace the previous Unmap and drop our Map
+          m_ContextRecord->LockChunks();
+          m_ContextRecord->PopChunk();
+          m_ContextRecord->UnlockChunks();
+
+          SAFE_DELETE(m_CoalescedUnmap.unmapChunk);
+          SAFE_DELETE(m_CoalescedUnmap.mapChunk);
+        }
+        else if(m_CoalescedUnmap.mapChunk)
+        {
+          m_ContextRecord->AddChunk(m_CoalescedUnmap.mapChunk);
+          m_CoalescedUnmap.mapChunk = NULL;
+        }
+
+        m_CoalescedUnmap.merging = false;
+
+        m_ContextRecord->AddChunk(chunk);
+
+        if(mapType == D3D11_MAP_WRITE_NO_OVERWRITE)
+        {
+          m_CoalescedUnmap.mapIdx = mapIdx;
+          m_CoalescedUnmap.unmapChunk = chunk;
+        }
+        else
+        {
+          m_CoalescedUnmap.unmapChunk = NULL;
+        }
       }
       else    // IsIdleCapturing(m_State)
       {
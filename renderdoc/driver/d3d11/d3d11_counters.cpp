@@ -561,6 +561,8 @@ rdcarray<CounterResult> D3D11Replay::FetchCountersIntel(const rdcarray<GPUCounte
 
 rdcarray<CounterResult> D3D11Replay::FetchCounters(const rdcarray<GPUCounter> &counters)
 {
+  RDCPROFILE_ZONE("D3D11Replay::FetchCounters");
+
   rdcarray<CounterResult> ret;
 
   if(counters.empty())
@@ -1246,17 +1246,10 @@ ReplayStatus WrappedID3D11Device::ReadLogInitialisation(RDCFile *rdc, bool store
 
   int chunkIdx = 0;
 
-  struct chunkinfo
-  {
-    chunkinfo() : count(0), totalsize(0), total(0.0) {}
-    int count;
-    uint64_t totalsize;
-    double total;
-  };
-
-  std::map<D3D11Chunk, chunkinfo> chunkInfos;
+  ChunkLoadRecorder chunkStats;
 
   SCOPED_TIMER("chunk initialisation");
+  RDCPROFILE_ZONE("ReadLogInitialisation");
 
   uint64_t frameDataSize = 0;
 
@@ -1319,9 +1312,7 @@ ReplayStatus WrappedID3D11Device::ReadLogInitialisation(RDCFile *rdc, bool store
         return status;
     }
 
-    chunkInfos[context].total += timer.GetMilliseconds();
-    chunkInfos[context].totalsize += offsetEnd - offsetStart;
-    chunkInfos[context].count++;
+    chunkStats.Record((uint32_t)context, offsetEnd - offsetStart, timer.GetMilliseconds(), 0.0);
 
     if((SystemChunk)context == SystemChunk::CaptureScope || reader->IsErrored() || reader->AtEnd())
       break;
@@ -1362,27 +1353,14 @@ ReplayStatus WrappedID3D11Device::ReadLogInitialisation(RDCFile *rdc, bool store
     }
   }
 
-#if ENABLED(RDOC_DEVEL)
-  for(auto it = chunkInfos.begin(); it != chunkInfos.end(); ++it)
-  {
-    double dcount = double(it->second.count);
-
-    RDCDEBUG(
-        "% 5d chunks - Time: %9.3fms total/%9.3fms avg - Size: %8.3fMB total/%7.3fMB avg - %s (%u)",
-        it->second.count, it->second.total, it->second.total / dcount,
-        double(it->second.totalsize) / (1024.0 * 1024.0),
-        double(it->second.totalsize) / (dcount * 1024.0 * 1024.0),
-        GetChunkName((uint32_t)it->first).c_str(), uint32_t(it->first));
-  }
-#endif
-
   GetReplay()->WriteFrameRecord().frameInfo.uncompressedFileSize =
       rdc->GetSectionProperties(sectionIdx).uncompressedSize;
   GetReplay()->WriteFrameRecord().frameInfo.compressedFileSize =
       rdc->GetSectionProperties(sectionIdx).compressedSize;
   GetReplay()->WriteFrameRecord().frameInfo.persistentSize = frameDataSize;
   GetReplay()->WriteFrameRecord().frameInfo.initDataSize =
-      chunkInfos[(D3D11Chunk)SystemChunk::InitialContents].totalsize;
+      chunkStats.GetTotalSize((uint32_t)SystemChunk::InitialContents);
+  GetReplay()->WriteFrameRecord().frameInfo.loadStatistics = chunkStats.Bake(&GetChunkName);
 
   RDCDEBUG("Allocating %llu persistant bytes of memory for the log.",
            GetReplay()->WriteFrameRecord().frameInfo.persistentSize);
@@ -1393,6 +1371,8 @@ ReplayStatus WrappedID3D11Device::ReadLogInitialisation(RDCFile *rdc, bool store
 void WrappedID3D11Device::ReplayLog(uint32_t startEventID, uint32_t endEventID,
                                     ReplayLogType replayType)
 {
+  RDCPROFILE_ZONE("WrappedID3D11Device::ReplayLog");
+
   bool partial = true;
 
   if(startEventID == 0 && (replayType == eReplay_WithoutDraw || replayType == eReplay_Full))
@@ -1967,19 +1947,21 @@ bool WrappedID3D11Device::EndFrameCapture(void *dev, void *wnd)
 
         RDCDEBUG("Accumulating context resource list");
 
-        std::map<int32_t, Chunk *> recordlist;
+        RecordChunkList recordlist;
         record->Insert(recordlist);
 
+        SortRecordChunks(recordlist);
+
         RDCDEBUG("Flushing %u records to file serialiser", (uint32_t)recordlist.size());
 
         float num = float(recordlist.size());
         float idx = 0.0f;
 
-        for(auto it = recordlist.begin(); it != recordlist.end(); ++it)
+        for(const rdcpair<int32_t, Chunk *> &chunk : recordlist)
         {
           RenderDoc::Inst().SetProgress(CaptureProgress::SerialiseFrameContents, idx / num);
           idx += 1.0f;
-          it->second->Write(ser);
+          chunk.second->Write(ser);
         }
 
         RDCDEBUG("Done");
@@ -2372,8 +2354,10 @@ HRESULT WrappedID3D11Device::Present(IDXGISwapper *swapper, UINT SyncInterval, U
   if(!activeWindow)
     return S_OK;
 
-  // kill any current capture that isn't application defined
-  if(IsActiveCapturing(m_State) && !m_AppControlledCapture)
+  // kill any current capture that isn't application defined, unless it's a merged multi-frame
+  // capture with frames left to record
+  if(IsActiveCapturing(m_State) && !m_AppControlledCapture &&
+     !RenderDoc::Inst().ShouldContinueCapture())
   {
     RenderDoc::Inst().EndFrameCapture((ID3D11Device *)this, swapper->GetHWND());
   }
@@ -29,6 +29,8 @@
 
 bool WrappedID3D11Device::Prepare_InitialState(ID3D11DeviceChild *res)
 {
+  RDCPROFILE_ZONE("WrappedID3D11Device::Prepare_InitialState");
+
   D3D11ResourceType type = IdentifyTypeByPtr(res);
   ResourceId Id = GetIDForResource(res);
 
@@ -281,7 +283,7 @@ uint64_t WrappedID3D11Device::GetSize_InitialState(ResourceId id, const D3D11Ini
 
     // buffer width plus alignment
     ret += desc.ByteWidth;
-    ret += WriteSerialiser::GetChunkAlignment();
+    ret += WriteSerialiser::GetBufferOverhead();
   }
   else if(initial.resourceType == Resource_Texture1D)
   {
@@ -302,7 +304,7 @@ uint64_t WrappedID3D11Device::GetSize_InitialState(ResourceId id, const D3D11Ini
       const UINT RowPitch = GetRowPitch(desc.Width, desc.Format, mip);
 
       ret += RowPitch;
-      ret += WriteSerialiser::GetChunkAlignment();
+      ret += WriteSerialiser::GetBufferOverhead();
     }
   }
   else if(initial.resourceType == Resource_Texture2D)
@@ -337,7 +339,7 @@ uint64_t WrappedID3D11Device::GetSize_InitialState(ResourceId id, const D3D11Ini
         pitch = GetResourcePitchForSubresource(m_pImmediateContext->GetReal(), tex, sub);
         ret += pitch.m_RowPitch * numRows;
 
-        ret += WriteSerialiser::GetChunkAlignment();
+        ret += WriteSerialiser::GetBufferOverhead();
       }
     }
   }
@@ -361,7 +363,7 @@ uint64_t WrappedID3D11Device::GetSize_InitialState(ResourceId id, const D3D11Ini
       pitch = GetResourcePitchForSubresource(m_pImmediateContext->GetReal(), tex, sub);
       ret += pitch.m_DepthPitch * RDCMAX(1U, desc.Depth >> mip);
 
-      ret += WriteSerialiser::GetChunkAlignment();
+      ret += WriteSerialiser::GetBufferOverhead();
     }
   }
   else
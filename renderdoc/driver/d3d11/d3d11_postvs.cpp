@@ -98,6 +98,31 @@ void D3D11Replay::ClearPostVSCache()
   m_PostVSData.clear();
 }
 
+static uint64_t GetBufferSize(ID3D11Buffer *buf)
+{
+  if(buf == NULL)
+    return 0;
+
+  D3D11_BUFFER_DESC desc;
+  buf->GetDesc(&desc);
+  return desc.ByteWidth;
+}
+
+uint64_t D3D11Replay::GetPostVSCacheSize()
+{
+  uint64_t ret = 0;
+
+  for(auto it = m_PostVSData.begin(); it != m_PostVSData.end(); ++it)
+  {
+    ret += GetBufferSize(it->second.vsout.buf);
+    ret += GetBufferSize(it->second.vsout.idxBuf);
+    ret += GetBufferSize(it->second.gsout.buf);
+    ret += GetBufferSize(it->second.gsout.idxBuf);
+  }
+
+  return ret;
+}
+
 MeshFormat D3D11Replay::GetPostVSBuffers(uint32_t eventId, uint32_t instID, uint32_t viewID,
                                          MeshDataStage stage)
 {
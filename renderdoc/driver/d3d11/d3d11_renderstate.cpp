@@ -466,99 +466,226 @@ bool D3D11RenderState::PredicationWouldPass()
   return PredicateValue != data;
 }
 
-void D3D11RenderState::ApplyState(WrappedID3D11DeviceContext *context) const
+// ApplyState always starts from ClearState(), so anything that matches the cleared state doesn't
+// need to be set again. These return the number of leading slots that must be applied, i.e. one
+// past the last slot which differs from its cleared value.
+template <typename T>
+static UINT DirtySlots(T *const *objs, UINT count)
 {
-  context->ClearState();
+  while(count > 0 && objs[count - 1] == NULL)
+    count--;
+  return count;
+}
 
-  // IA
-  context->IASetInputLayout(IA.Layout);
-  context->IASetPrimitiveTopology(IA.Topo);
-  context->IASetIndexBuffer(IA.IndexBuffer, IA.IndexFormat, IA.IndexOffset);
-  context->IASetVertexBuffers(0, D3D11_IA_VERTEX_INPUT_RESOURCE_SLOT_COUNT, IA.VBs, IA.Strides,
-                              IA.Offsets);
+static UINT DirtyVBSlots(const D3D11RenderState::InputAssembler &IA)
+{
+  UINT count = D3D11_IA_VERTEX_INPUT_RESOURCE_SLOT_COUNT;
+  while(count > 0 && IA.VBs[count - 1] == NULL && IA.Strides[count - 1] == 0 &&
+        IA.Offsets[count - 1] == 0)
+    count--;
+  return count;
+}
 
-  // VS
-  context->VSSetShaderResources(0, D3D11_COMMONSHADER_INPUT_RESOURCE_SLOT_COUNT, VS.SRVs);
-  context->VSSetSamplers(0, D3D11_COMMONSHADER_SAMPLER_SLOT_COUNT, VS.Samplers);
-  context->VSSetShader((ID3D11VertexShader *)VS.Object, VS.Instances, VS.NumInstances);
+static UINT DirtyCBSlots(const D3D11RenderState::Shader &sh)
+{
+  UINT count = D3D11_COMMONSHADER_CONSTANT_BUFFER_API_SLOT_COUNT;
+  while(count > 0 && sh.ConstantBuffers[count - 1] == NULL && sh.CBOffsets[count - 1] == 0 &&
+        sh.CBCounts[count - 1] == 4096)
+    count--;
+  return count;
+}
 
-  // DS
-  context->DSSetShaderResources(0, D3D11_COMMONSHADER_INPUT_RESOURCE_SLOT_COUNT, DS.SRVs);
-  context->DSSetSamplers(0, D3D11_COMMONSHADER_SAMPLER_SLOT_COUNT, DS.Samplers);
-  context->DSSetShader((ID3D11DomainShader *)DS.Object, DS.Instances, DS.NumInstances);
+static void ApplyShaderState(WrappedID3D11DeviceContext *context,
+                             const D3D11RenderState::Shader &sh, ShaderStage stage)
+{
+  UINT numSRVs = DirtySlots(sh.SRVs, D3D11_COMMONSHADER_INPUT_RESOURCE_SLOT_COUNT);
+  UINT numSamplers = DirtySlots(sh.Samplers, D3D11_COMMONSHADER_SAMPLER_SLOT_COUNT);
 
-  // HS
-  context->HSSetShaderResources(0, D3D11_COMMONSHADER_INPUT_RESOURCE_SLOT_COUNT, HS.SRVs);
-  context->HSSetSamplers(0, D3D11_COMMONSHADER_SAMPLER_SLOT_COUNT, HS.Samplers);
-  context->HSSetShader((ID3D11HullShader *)HS.Object, HS.Instances, HS.NumInstances);
+  switch(stage)
+  {
+    case ShaderStage::Vertex:
+      if(numSRVs)
+        context->VSSetShaderResources(0, numSRVs, sh.SRVs);
+      if(numSamplers)
+        context->VSSetSamplers(0, numSamplers, sh.Samplers);
+      if(sh.Object)
+        context->VSSetShader((ID3D11VertexShader *)sh.Object, sh.Instances, sh.NumInstances);
+      break;
+    case ShaderStage::Hull:
+      if(numSRVs)
+        context->HSSetShaderResources(0, numSRVs, sh.SRVs);
+      if(numSamplers)
+        context->HSSetSamplers(0, numSamplers, sh.Samplers);
+      if(sh.Object)
+        context->HSSetShader((ID3D11HullShader *)sh.Object, sh.Instances, sh.NumInstances);
+      break;
+    case ShaderStage::Domain:
+      if(numSRVs)
+        context->DSSetShaderResources(0, numSRVs, sh.SRVs);
+      if(numSamplers)
+        context->DSSetSamplers(0, numSamplers, sh.Samplers);
+      if(sh.Object)
+        context->DSSetShader((ID3D11DomainShader *)sh.Object, sh.Instances, sh.NumInstances);
+      break;
+    case ShaderStage::Geometry:
+      if(numSRVs)
+        context->GSSetShaderResources(0, numSRVs, sh.SRVs);
+      if(numSamplers)
+        context->GSSetSamplers(0, numSamplers, sh.Samplers);
+      if(sh.Object)
+        context->GSSetShader((ID3D11GeometryShader *)sh.Object, sh.Instances, sh.NumInstances);
+      break;
+    case ShaderStage::Pixel:
+      if(numSRVs)
+        context->PSSetShaderResources(0, numSRVs, sh.SRVs);
+      if(numSamplers)
+        context->PSSetSamplers(0, numSamplers, sh.Samplers);
+      if(sh.Object)
+        context->PSSetShader((ID3D11PixelShader *)sh.Object, sh.Instances, sh.NumInstances);
+      break;
+    case ShaderStage::Compute:
+      if(numSRVs)
+        context->CSSetShaderResources(0, numSRVs, sh.SRVs);
+      if(numSamplers)
+        context->CSSetSamplers(0, numSamplers, sh.Samplers);
+      if(sh.Object)
+        context->CSSetShader((ID3D11ComputeShader *)sh.Object, sh.Instances, sh.NumInstances);
+      break;
+    default: break;
+  }
+}
 
-  // GS
-  context->GSSetShaderResources(0, D3D11_COMMONSHADER_INPUT_RESOURCE_SLOT_COUNT, GS.SRVs);
-  context->GSSetSamplers(0, D3D11_COMMONSHADER_SAMPLER_SLOT_COUNT, GS.Samplers);
-  context->GSSetShader((ID3D11GeometryShader *)GS.Object, GS.Instances, GS.NumInstances);
+static void ApplyConstantBuffers(WrappedID3D11DeviceContext *context,
+                                 const D3D11RenderState::Shader &sh, ShaderStage stage)
+{
+  UINT numCBs = DirtyCBSlots(sh);
 
-  context->SOSetTargets(D3D11_SO_BUFFER_SLOT_COUNT, SO.Buffers, SO.Offsets);
+  if(numCBs == 0)
+    return;
+
+  switch(stage)
+  {
+    case ShaderStage::Vertex:
+      context->VSSetConstantBuffers1(0, numCBs, sh.ConstantBuffers, sh.CBOffsets, sh.CBCounts);
+      break;
+    case ShaderStage::Hull:
+      context->HSSetConstantBuffers1(0, numCBs, sh.ConstantBuffers, sh.CBOffsets, sh.CBCounts);
+      break;
+    case ShaderStage::Domain:
+      context->DSSetConstantBuffers1(0, numCBs, sh.ConstantBuffers, sh.CBOffsets, sh.CBCounts);
+      break;
+    case ShaderStage::Geometry:
+      context->GSSetConstantBuffers1(0, numCBs, sh.ConstantBuffers, sh.CBOffsets, sh.CBCounts);
+      break;
+    case ShaderStage::Pixel:
+      context->PSSetConstantBuffers1(0, numCBs, sh.ConstantBuffers, sh.CBOffsets, sh.CBCounts);
+      break;
+    case ShaderStage::Compute:
+      context->CSSetConstantBuffers1(0, numCBs, sh.ConstantBuffers, sh.CBOffsets, sh.CBCounts);
+      break;
+    default: break;
+  }
+}
+
+void D3D11RenderState::ApplyState(WrappedID3D11DeviceContext *context) const
+{
+  context->ClearState();
+
+  // everything below only sets state that differs from the cleared defaults, and only up to the
+  // last non-default slot. Replay applies state on every event selection and shader debug/overlay
+  // restore, and the full-width binds were the bulk of the cost.
+
+  // IA
+  if(IA.Layout)
+    context->IASetInputLayout(IA.Layout);
+  if(IA.Topo != D3D11_PRIMITIVE_TOPOLOGY_UNDEFINED)
+    context->IASetPrimitiveTopology(IA.Topo);
+  if(IA.IndexBuffer || IA.IndexFormat != DXGI_FORMAT_UNKNOWN || IA.IndexOffset != 0)
+    context->IASetIndexBuffer(IA.IndexBuffer, IA.IndexFormat, IA.IndexOffset);
+
+  UINT numVBs = DirtyVBSlots(IA);
+  if(numVBs)
+    context->IASetVertexBuffers(0, numVBs, IA.VBs, IA.Strides, IA.Offsets);
+
+  ApplyShaderState(context, VS, ShaderStage::Vertex);
+  ApplyShaderState(context, DS, ShaderStage::Domain);
+  ApplyShaderState(context, HS, ShaderStage::Hull);
+  ApplyShaderState(context, GS, ShaderStage::Geometry);
+
+  UINT numSOs = D3D11_SO_BUFFER_SLOT_COUNT;
+  while(numSOs > 0 && SO.Buffers[numSOs - 1] == NULL && SO.Offsets[numSOs - 1] == 0)
+    numSOs--;
+  if(numSOs)
+    context->SOSetTargets(numSOs, SO.Buffers, SO.Offsets);
 
   // RS
-  context->RSSetState(RS.State);
-  context->RSSetViewports(RS.NumViews, RS.Viewports);
-  context->RSSetScissorRects(RS.NumScissors, RS.Scissors);
+  if(RS.State)
+    context->RSSetState(RS.State);
+  if(RS.NumViews)
+    context->RSSetViewports(RS.NumViews, RS.Viewports);
+  if(RS.NumScissors)
+    context->RSSetScissorRects(RS.NumScissors, RS.Scissors);
 
   UINT UAV_keepcounts[D3D11_1_UAV_SLOT_COUNT] = {(UINT)-1, (UINT)-1, (UINT)-1, (UINT)-1,
                                                  (UINT)-1, (UINT)-1, (UINT)-1, (UINT)-1};
 
   // CS
-  context->CSSetShaderResources(0, D3D11_COMMONSHADER_INPUT_RESOURCE_SLOT_COUNT, CS.SRVs);
-  context->CSSetSamplers(0, D3D11_COMMONSHADER_SAMPLER_SLOT_COUNT, CS.Samplers);
-  if(context->IsFL11_1())
-    context->CSSetUnorderedAccessViews(0, D3D11_1_UAV_SLOT_COUNT, CSUAVs, UAV_keepcounts);
-  else
-    context->CSSetUnorderedAccessViews(0, D3D11_PS_CS_UAV_REGISTER_COUNT, CSUAVs, UAV_keepcounts);
-  context->CSSetShader((ID3D11ComputeShader *)CS.Object, CS.Instances, CS.NumInstances);
+  ApplyShaderState(context, CS, ShaderStage::Compute);
+
+  UINT numCSUAVs = DirtySlots(CSUAVs, context->IsFL11_1() ? D3D11_1_UAV_SLOT_COUNT
+                                                           : D3D11_PS_CS_UAV_REGISTER_COUNT);
+  if(numCSUAVs)
+    context->CSSetUnorderedAccessViews(0, numCSUAVs, CSUAVs, UAV_keepcounts);
 
   // PS
-  context->PSSetShaderResources(0, D3D11_COMMONSHADER_INPUT_RESOURCE_SLOT_COUNT, PS.SRVs);
-  context->PSSetSamplers(0, D3D11_COMMONSHADER_SAMPLER_SLOT_COUNT, PS.Samplers);
-  context->PSSetShader((ID3D11PixelShader *)PS.Object, PS.Instances, PS.NumInstances);
+  ApplyShaderState(context, PS, ShaderStage::Pixel);
 
-  context->VSSetConstantBuffers1(0, D3D11_COMMONSHADER_CONSTANT_BUFFER_API_SLOT_COUNT,
-                                 VS.ConstantBuffers, VS.CBOffsets, VS.CBCounts);
-  context->DSSetConstantBuffers1(0, D3D11_COMMONSHADER_CONSTANT_BUFFER_API_SLOT_COUNT,
-                                 DS.ConstantBuffers, DS.CBOffsets, DS.CBCounts);
-  context->HSSetConstantBuffers1(0, D3D11_COMMONSHADER_CONSTANT_BUFFER_API_SLOT_COUNT,
-                                 HS.ConstantBuffers, HS.CBOffsets, HS.CBCounts);
-  context->GSSetConstantBuffers1(0, D3D11_COMMONSHADER_CONSTANT_BUFFER_API_SLOT_COUNT,
-                                 GS.ConstantBuffers, GS.CBOffsets, GS.CBCounts);
-  context->CSSetConstantBuffers1(0, D3D11_COMMONSHADER_CONSTANT_BUFFER_API_SLOT_COUNT,
-                                 CS.ConstantBuffers, CS.CBOffsets, CS.CBCounts);
-  context->PSSetConstantBuffers1(0, D3D11_COMMONSHADER_CONSTANT_BUFFER_API_SLOT_COUNT,
-                                 PS.ConstantBuffers, PS.CBOffsets, PS.CBCounts);
+  ApplyConstantBuffers(context, VS, ShaderStage::Vertex);
+  ApplyConstantBuffers(context, DS, ShaderStage::Domain);
+  ApplyConstantBuffers(context, HS, ShaderStage::Hull);
+  ApplyConstantBuffers(context, GS, ShaderStage::Geometry);
+  ApplyConstantBuffers(context, CS, ShaderStage::Compute);
+  ApplyConstantBuffers(context, PS, ShaderStage::Pixel);
 
   // OM
-  context->OMSetBlendState(OM.BlendState, OM.BlendFactor, OM.SampleMask);
-  context->OMSetDepthStencilState(OM.DepthStencilState, OM.StencRef);
-
-  if(context->IsFL11_1())
+  if(OM.BlendState || OM.BlendFactor[0] != 1.0f || OM.BlendFactor[1] != 1.0f ||
+     OM.BlendFactor[2] != 1.0f || OM.BlendFactor[3] != 1.0f || OM.SampleMask != 0xffffffff)
+    context->OMSetBlendState(OM.BlendState, OM.BlendFactor, OM.SampleMask);
+  if(OM.DepthStencilState || OM.StencRef != 0)
+    context->OMSetDepthStencilState(OM.DepthStencilState, OM.StencRef);
+
+  // the output bindings are a single call and the UAV start slot is significant, so these are only
+  // skipped entirely when nothing is bound.
+  UINT numUAVs = context->IsFL11_1() ? D3D11_1_UAV_SLOT_COUNT : D3D11_PS_CS_UAV_REGISTER_COUNT;
+  bool outputsBound = OM.DepthView != NULL || OM.UAVStartSlot != 0 ||
+                      DirtySlots(OM.RenderTargets, D3D11_SIMULTANEOUS_RENDER_TARGET_COUNT) > 0 ||
+                      DirtySlots(OM.UAVs, numUAVs) > 0;
+
+  if(outputsBound)
   {
-    context->OMSetRenderTargetsAndUnorderedAccessViews(
-        RDCMIN(OM.UAVStartSlot, (UINT)D3D11_SIMULTANEOUS_RENDER_TARGET_COUNT), OM.RenderTargets,
-        OM.DepthView, OM.UAVStartSlot, D3D11_1_UAV_SLOT_COUNT - OM.UAVStartSlot, OM.UAVs,
-        UAV_keepcounts);
-  }
-  else
-  {
-    if(OM.UAVStartSlot == D3D11_PS_CS_UAV_REGISTER_COUNT)
-      context->OMSetRenderTargets(
-          RDCMIN(OM.UAVStartSlot, (UINT)D3D11_SIMULTANEOUS_RENDER_TARGET_COUNT), OM.RenderTargets,
-          OM.DepthView);
-    else
+    if(context->IsFL11_1())
+    {
       context->OMSetRenderTargetsAndUnorderedAccessViews(
           RDCMIN(OM.UAVStartSlot, (UINT)D3D11_SIMULTANEOUS_RENDER_TARGET_COUNT), OM.RenderTargets,
-          OM.DepthView, OM.UAVStartSlot, D3D11_PS_CS_UAV_REGISTER_COUNT - OM.UAVStartSlot, OM.UAVs,
+          OM.DepthView, OM.UAVStartSlot, D3D11_1_UAV_SLOT_COUNT - OM.UAVStartSlot, OM.UAVs,
           UAV_keepcounts);
+    }
+    else
+    {
+      if(OM.UAVStartSlot == D3D11_PS_CS_UAV_REGISTER_COUNT)
+        context->OMSetRenderTargets(
+            RDCMIN(OM.UAVStartSlot, (UINT)D3D11_SIMULTANEOUS_RENDER_TARGET_COUNT), OM.RenderTargets,
+            OM.DepthView);
+      else
+        context->OMSetRenderTargetsAndUnorderedAccessViews(
+            RDCMIN(OM.UAVStartSlot, (UINT)D3D11_SIMULTANEOUS_RENDER_TARGET_COUNT), OM.RenderTargets,
+            OM.DepthView, OM.UAVStartSlot, D3D11_PS_CS_UAV_REGISTER_COUNT - OM.UAVStartSlot,
+            OM.UAVs, UAV_keepcounts);
+    }
   }
 
-  context->SetPredication(Predicate, PredicateValue);
+  if(Predicate || PredicateValue)
+    context->SetPredication(Predicate, PredicateValue);
 }
 
 void D3D11RenderState::TakeRef(ID3D11DeviceChild *p)
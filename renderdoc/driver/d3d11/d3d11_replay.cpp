@@ -376,6 +376,36 @@ rdcarray<GPUDevice> D3D11Replay::GetAvailableGPUs()
   return ret;
 }
 
+rdcarray<MemoryUsage> D3D11Replay::GetMemoryUsage()
+{
+  uint64_t reflectionSize = 0;
+  {
+    SCOPED_LOCK(WrappedShader::m_ShaderListLock);
+    for(auto it = WrappedShader::m_ShaderList.begin(); it != WrappedShader::m_ShaderList.end();
+        ++it)
+    {
+      const ShaderReflection *refl = it->second->GetBuiltDetails();
+      if(refl)
+        reflectionSize += EstimateReflectionSize(*refl);
+    }
+  }
+
+  rdcarray<MemoryUsage> ret;
+  ret.push_back(MemoryUsage(MemoryCategory::PostVSCache, 0, GetPostVSCacheSize()));
+  ret.push_back(
+      MemoryUsage(MemoryCategory::ShaderCache, m_pDevice->GetShaderCache()->GetMemoryUsage(), 0));
+  ret.push_back(MemoryUsage(MemoryCategory::ShaderReflection, reflectionSize, 0));
+  return ret;
+}
+
+void D3D11Replay::EvictCache(MemoryCategory category)
+{
+  if(category == MemoryCategory::PostVSCache)
+    ClearPostVSCache();
+  else if(category == MemoryCategory::ShaderCache)
+    m_pDevice->GetShaderCache()->EvictCachedData();
+}
+
 APIProperties D3D11Replay::GetAPIProperties()
 {
   APIProperties ret = m_pDevice->APIProps;
@@ -2530,8 +2560,8 @@ void D3D11Replay::BuildShader(ShaderEncoding sourceEncoding, const bytebuf &sour
 
     ID3DBlob *blob = NULL;
 
-    errors = m_pDevice->GetShaderCache()->GetShaderBlob(hlsl.c_str(), entry.c_str(), flags, profile,
-                                                        &blob);
+    errors = m_pDevice->GetShaderCache()->GetUserShaderBlob(hlsl.c_str(), entry.c_str(), flags,
+                                                            profile, &blob);
 
     if(blob == NULL)
     {
@@ -2813,8 +2843,8 @@ void D3D11Replay::FillCBufferVariables(ResourceId pipeline, ResourceId shader, r
     return;
   }
 
-  StandardFillCBufferVariables(refl.resourceId, refl.constantBlocks[cbufSlot].variables, outvars,
-                               data);
+  m_CBufferLayouts.Fill(pipeline, shader, entryPoint, cbufSlot, refl.resourceId,
+                        refl.constantBlocks[cbufSlot].variables, outvars, data);
 }
 
 uint32_t D3D11Replay::PickVertex(uint32_t eventId, int32_t width, int32_t height,
@@ -107,6 +107,7 @@ public:
     m_WARP = warp;
   }
   bool IsRemoteProxy() { return m_Proxy; }
+  void FetchStructuredChunks(const rdcarray<uint32_t> &chunkIndices) {}
   void Shutdown();
 
   void CreateResources(IDXGIFactory *factory);
@@ -114,6 +115,8 @@ public:
 
   DriverInformation GetDriverInfo() { return m_DriverInfo; }
   rdcarray<GPUDevice> GetAvailableGPUs();
+  rdcarray<MemoryUsage> GetMemoryUsage();
+  void EvictCache(MemoryCategory category);
   APIProperties GetAPIProperties();
 
   ResourceDescription &GetResourceDesc(ResourceId id);
@@ -244,6 +247,7 @@ public:
   ResourceId RenderOverlay(ResourceId texid, CompType typeCast, FloatVector clearCol,
                            DebugOverlay overlay, uint32_t eventId,
                            const rdcarray<uint32_t> &passEvents);
+  rdcarray<OverdrawStatistics> GetOverdrawStatistics() { return {}; }
 
   void BuildCustomShader(ShaderEncoding sourceEncoding, const bytebuf &source, const rdcstr &entry,
                          const ShaderCompileFlags &compileFlags, ShaderStage type, ResourceId &id,
@@ -265,6 +269,7 @@ private:
                    rdcstr &errors);
 
   void ClearPostVSCache();
+  uint64_t GetPostVSCacheSize();
 
   void InitStreamOut();
   void CreateSOBuffers();
@@ -343,6 +348,8 @@ private:
 
   HighlightCache m_HighlightCache;
 
+  CBufferLayoutCache m_CBufferLayouts;
+
   uint64_t m_SOBufferSize = 32 * 1024 * 1024;
   ID3D11Buffer *m_SOBuffer = NULL;
   ID3D11Buffer *m_SOStagingBuffer = NULL;
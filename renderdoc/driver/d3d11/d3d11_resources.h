@@ -946,6 +946,9 @@ public:
       return m_Mapping;
     }
 
+    // the reflection if it's been built, without building it
+    const ShaderReflection *GetBuiltDetails() const { return m_Built ? &m_Details : NULL; }
+
   private:
     ShaderEntry(const ShaderEntry &e);
     void TryReplaceOriginalByteCode();
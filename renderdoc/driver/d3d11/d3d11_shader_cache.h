@@ -27,9 +27,11 @@
 #include <map>
 #include <string>
 #include <vector>
+#include "common/shader_cache.h"
 #include "driver/dx/official/d3d11_4.h"
 
 class WrappedID3D11Device;
+struct D3DBlobShaderCallbacks;
 
 class D3D11ShaderCache
 {
@@ -39,6 +41,10 @@ public:
 
   rdcstr GetShaderBlob(const char *source, const char *entry, const uint32_t compileFlags,
                        const char *profile, ID3DBlob **srcblob);
+  // shaders compiled for shader editing and custom display are kept on disk between sessions,
+  // keyed by the source, entry point, profile, flags and the compiler used.
+  rdcstr GetUserShaderBlob(const char *source, const char *entry, const uint32_t compileFlags,
+                           const char *profile, ID3DBlob **srcblob);
   ID3D11VertexShader *MakeVShader(const char *source, const char *entry, const char *profile,
                                   int numInputDescs = 0, D3D11_INPUT_ELEMENT_DESC *inputs = NULL,
                                   ID3D11InputLayout **ret = NULL, rdcarray<byte> *blob = NULL);
@@ -47,12 +53,33 @@ public:
   ID3D11ComputeShader *MakeCShader(const char *source, const char *entry, const char *profile);
 
   void SetCaching(bool enabled) { m_CacheShaders = enabled; }
+  // the memory held by cached shaders loaded from disk
+  uint64_t GetMemoryUsage()
+  {
+    return m_ShaderCache.GetMemoryUsage() + m_UserShaderCache.GetMemoryUsage();
+  }
+  // releases the cache's references to shaders loaded from disk. Anything using them holds its own
+  // reference.
+  void EvictCachedData()
+  {
+    m_ShaderCache.EvictResults();
+    m_UserShaderCache.EvictResults();
+  }
+
 private:
   static const uint32_t m_ShaderCacheMagic = 0xf000baba;
-  static const uint32_t m_ShaderCacheVersion = 3;
+  static const uint32_t m_ShaderCacheVersion = 4;
+
+  static const uint32_t m_UserShaderCacheMagic = 0xf000b5e5;
+  static const uint32_t m_UserShaderCacheVersion = 1;
+  static const size_t m_UserShaderCacheMaxEntries = 1024;
 
   ID3D11Device *m_pDevice = NULL;
 
-  bool m_ShaderCacheDirty = false, m_CacheShaders = false;
-  std::map<uint32_t, ID3DBlob *> m_ShaderCache;
+  bool m_CacheShaders = false;
+  ShaderCache<ID3DBlob *, D3DBlobShaderCallbacks> m_ShaderCache;
+
+  // loaded on first use, only needed when editing shaders
+  bool m_UserShaderCacheLoaded = false;
+  ShaderCache<ID3DBlob *, D3DBlobShaderCallbacks> m_UserShaderCache;
 };
@@ -80,7 +80,22 @@ public:
                              const uint8_t swizzle[4], DXBCDebug::GatherChannel gatherChannel,
                              const char *opString, ShaderVariable &output);
 
+  void CalculateMathIntrinsics(rdcarray<DXBCDebug::MathIntrinsicRequest> &requests);
+  void CalculateSampleGathers(rdcarray<DXBCDebug::SampleGatherRequest> &requests);
+
 private:
+  bool MakeSampleGatherShaders(DXBCBytecode::OpcodeType opcode,
+                               DXBCDebug::SampleGatherResourceData resourceData,
+                               DXBCDebug::SampleGatherSamplerData samplerData, ShaderVariable uv,
+                               ShaderVariable ddxCalc, ShaderVariable ddyCalc,
+                               const int texelOffsets[3], int multisampleIndex,
+                               float lodOrCompareValue, const uint8_t swizzle[4],
+                               DXBCDebug::GatherChannel gatherChannel, const char *opString,
+                               DXBCDebug::SampleGatherShaders &shaders, DXGI_FORMAT &retFmt);
+  bool RenderSampleGather(const DXBCDebug::SampleGatherRequest &req, const rdcstr &vsProgram,
+                          const rdcstr &psProgram, DXGI_FORMAT retFmt, uint32_t count,
+                          rdcarray<ShaderVariable> &results);
+
   DXBC::ShaderType GetShaderType() { return m_dxbc ? m_dxbc->m_Type : DXBC::ShaderType::Pixel; }
   WrappedID3D11Device *m_pDevice;
   const DXBC::DXBCContainer *m_dxbc;
@@ -964,17 +979,17 @@ ShaderVariable D3D11DebugAPIWrapper::GetResourceInfo(DXBCBytecode::OperandType t
   return result;
 }
 
-bool D3D11DebugAPIWrapper::CalculateSampleGather(
+bool D3D11DebugAPIWrapper::MakeSampleGatherShaders(
     DXBCBytecode::OpcodeType opcode, DXBCDebug::SampleGatherResourceData resourceData,
     DXBCDebug::SampleGatherSamplerData samplerData, ShaderVariable uv, ShaderVariable ddxCalc,
     ShaderVariable ddyCalc, const int texelOffsets[3], int multisampleIndex,
     float lodOrCompareValue, const uint8_t swizzle[4], DXBCDebug::GatherChannel gatherChannel,
-    const char *opString, ShaderVariable &output)
+    const char *opString, DXBCDebug::SampleGatherShaders &shaders, DXGI_FORMAT &retFmt)
 {
   using namespace DXBCBytecode;
 
   rdcstr funcRet = "";
-  DXGI_FORMAT retFmt = DXGI_FORMAT_UNKNOWN;
+  retFmt = DXGI_FORMAT_UNKNOWN;
 
   if(opcode == OPCODE_SAMPLE_C || opcode == OPCODE_SAMPLE_C_LZ || opcode == OPCODE_GATHER4_C ||
      opcode == OPCODE_GATHER4_PO_C || opcode == OPCODE_LOD)
@@ -1233,7 +1248,14 @@ bool D3D11DebugAPIWrapper::CalculateSampleGather(
   vsProgram += "return float4((id == 2) ? 3.0f : -1.0f, (id == 0) ? -3.0f : 1.0f, 0.5, 1.0);\n";
   vsProgram += "}";
 
-  rdcstr sampleProgram;
+  rdcstr decls = StringFormat::Fmt("%s : register(t0);\n", textureDecl.c_str());
+  if(opcode != OPCODE_LD && opcode != OPCODE_LD_MS)
+    decls += StringFormat::Fmt("%s : register(s0);\n", samplerDecl.c_str());
+  decls += "\n";
+
+  shaders.funcRet = funcRet;
+  shaders.decls = decls;
+  shaders.vsProgram = vsProgram;
 
   if(opcode == OPCODE_SAMPLE || opcode == OPCODE_SAMPLE_B || opcode == OPCODE_SAMPLE_D)
   {
@@ -1255,28 +1277,20 @@ bool D3D11DebugAPIWrapper::CalculateSampleGather(
       ddy = StringFormat::Fmt(formats[offsetDim + texdimOffs - 1][ddyType], ddyCalc.value.i.x,
                               ddyCalc.value.i.y, ddyCalc.value.i.z, ddyCalc.value.i.w);
 
-    sampleProgram = StringFormat::Fmt("%s : register(t0);\n%s : register(s0);\n\n",
-                                      textureDecl.c_str(), samplerDecl.c_str());
-    sampleProgram += funcRet + " main() : SV_Target0\n{\n";
-    sampleProgram +=
+    shaders.lookup =
         StringFormat::Fmt("return t.SampleGrad(s, %s, %s, %s %s)%s;\n", texcoords.c_str(),
                           ddx.c_str(), ddy.c_str(), offsets.c_str(), strSwizzle.c_str());
-    sampleProgram += "}\n";
   }
   else if(opcode == OPCODE_SAMPLE_L)
   {
-    sampleProgram = StringFormat::Fmt("%s : register(t0);\n%s : register(s0);\n\n",
-                                      textureDecl.c_str(), samplerDecl.c_str());
-    sampleProgram += funcRet + " main() : SV_Target0\n{\n";
-    sampleProgram +=
+    shaders.lookup =
         StringFormat::Fmt("return t.SampleLevel(s, %s, %.10f %s)%s;\n", texcoords.c_str(),
                           lodOrCompareValue, offsets.c_str(), strSwizzle.c_str());
-    sampleProgram += "}\n";
   }
   else if(opcode == OPCODE_SAMPLE_C || opcode == OPCODE_LOD)
   {
     // these operations need derivatives but have no hlsl function to call to provide them, so
-    // we fake it in the vertex shader
+    // we fake it in the vertex shader. That means they need their own shaders and can't be batched
 
     rdcstr uvdecl = StringFormat::Fmt("float%d uv : uvs", texdim + texdimOffs);
 
@@ -1299,78 +1313,69 @@ bool D3D11DebugAPIWrapper::CalculateSampleGather(
     vsProgram += "pos = float4((id == 2) ? 3.0f : -1.0f, (id == 0) ? -3.0f : 1.0f, 0.5, 1.0);\n";
     vsProgram += "}";
 
+    shaders.vsProgram = vsProgram;
+
     if(opcode == OPCODE_SAMPLE_C)
     {
-      sampleProgram = StringFormat::Fmt("%s : register(t0);\n%s : register(s0);\n\n",
-                                        textureDecl.c_str(), samplerDecl.c_str());
-      sampleProgram +=
+      shaders.psProgram = decls;
+      shaders.psProgram +=
           funcRet + " main(float4 pos : SV_Position, " + uvdecl + ") : SV_Target0\n{\n";
-      sampleProgram += StringFormat::Fmt("return t.SampleCmpLevelZero(s, uv, %.10f %s).xxxx;\n",
-                                         lodOrCompareValue, offsets.c_str());
-      sampleProgram += "}\n";
+      shaders.psProgram += StringFormat::Fmt("return t.SampleCmpLevelZero(s, uv, %.10f %s).xxxx;\n",
+                                             lodOrCompareValue, offsets.c_str());
+      shaders.psProgram += "}\n";
     }
     else if(opcode == OPCODE_LOD)
     {
-      sampleProgram = StringFormat::Fmt("%s : register(t0);\n%s : register(s0);\n\n",
-                                        textureDecl.c_str(), samplerDecl.c_str());
-      sampleProgram +=
+      shaders.psProgram = decls;
+      shaders.psProgram +=
           funcRet + " main(float4 pos : SV_Position, " + uvdecl + ") : SV_Target0\n{\n";
-      sampleProgram +=
+      shaders.psProgram +=
           "return float4(t.CalculateLevelOfDetail(s, uv),\n"
           "              t.CalculateLevelOfDetailUnclamped(s, uv),\n"
           "              0.0f, 0.0f);\n";
-      sampleProgram += "}\n";
+      shaders.psProgram += "}\n";
     }
   }
   else if(opcode == OPCODE_SAMPLE_C_LZ)
   {
-    sampleProgram = StringFormat::Fmt("%s : register(t0);\n%s : register(s0);\n\n",
-                                      textureDecl.c_str(), samplerDecl.c_str());
-    sampleProgram += funcRet + " main() : SV_Target0\n{\n";
-    sampleProgram +=
+    shaders.lookup =
         StringFormat::Fmt("return t.SampleCmpLevelZero(s, %s, %.10f %s)%s;\n", texcoords.c_str(),
                           lodOrCompareValue, offsets.c_str(), strSwizzle.c_str());
-    sampleProgram += "}\n";
   }
   else if(opcode == OPCODE_LD)
   {
-    sampleProgram = StringFormat::Fmt("%s : register(t0);\n\n", textureDecl.c_str());
-    sampleProgram += funcRet + " main() : SV_Target0\n{\n";
-    sampleProgram += "return t.Load(" + texcoords + offsets + ")" + strSwizzle + ";";
-    sampleProgram += "\n}\n";
+    shaders.lookup = "return t.Load(" + texcoords + offsets + ")" + strSwizzle + ";\n";
   }
   else if(opcode == OPCODE_LD_MS)
   {
-    sampleProgram = StringFormat::Fmt("%s : register(t0);\n\n", textureDecl.c_str());
-    sampleProgram += funcRet + " main() : SV_Target0\n{\n";
-    sampleProgram += StringFormat::Fmt("return t.Load(%s, int(%d) %s)%s;\n", texcoords.c_str(),
+    shaders.lookup = StringFormat::Fmt("return t.Load(%s, int(%d) %s)%s;\n", texcoords.c_str(),
                                        multisampleIndex, offsets.c_str(), strSwizzle.c_str());
-    sampleProgram += "\n}\n";
   }
   else if(opcode == OPCODE_GATHER4 || opcode == OPCODE_GATHER4_PO)
   {
-    sampleProgram = StringFormat::Fmt("%s : register(t0);\n%s : register(s0);\n\n",
-                                      textureDecl.c_str(), samplerDecl.c_str());
-    sampleProgram += funcRet + " main() : SV_Target0\n{\n";
-    sampleProgram += StringFormat::Fmt("return t.Gather%s(s, %s %s)%s;\n", strGatherChannel.c_str(),
-                                       texcoords.c_str(), offsets.c_str(), strSwizzle.c_str());
-    sampleProgram += "}\n";
+    shaders.lookup =
+        StringFormat::Fmt("return t.Gather%s(s, %s %s)%s;\n", strGatherChannel.c_str(),
+                          texcoords.c_str(), offsets.c_str(), strSwizzle.c_str());
   }
   else if(opcode == OPCODE_GATHER4_C || opcode == OPCODE_GATHER4_PO_C)
   {
-    sampleProgram = StringFormat::Fmt("%s : register(t0);\n%s : register(s0);\n\n",
-                                      textureDecl.c_str(), samplerDecl.c_str());
-    sampleProgram += funcRet + " main() : SV_Target0\n{\n";
-    sampleProgram += StringFormat::Fmt("return t.GatherCmp%s(s, %s, %.10f %s)%s;\n",
+    shaders.lookup = StringFormat::Fmt("return t.GatherCmp%s(s, %s, %.10f %s)%s;\n",
                                        strGatherChannel.c_str(), texcoords.c_str(),
                                        lodOrCompareValue, offsets.c_str(), strSwizzle.c_str());
-    sampleProgram += "}\n";
   }
 
+  return !shaders.lookup.empty() || !shaders.psProgram.empty();
+}
+
+bool D3D11DebugAPIWrapper::RenderSampleGather(const DXBCDebug::SampleGatherRequest &req,
+                                              const rdcstr &vsProgram, const rdcstr &psProgram,
+                                              DXGI_FORMAT retFmt, uint32_t count,
+                                              rdcarray<ShaderVariable> &results)
+{
   ID3D11VertexShader *vs =
       m_pDevice->GetShaderCache()->MakeVShader(vsProgram.c_str(), "main", "vs_5_0");
   ID3D11PixelShader *ps =
-      m_pDevice->GetShaderCache()->MakePShader(sampleProgram.c_str(), "main", "ps_5_0");
+      m_pDevice->GetShaderCache()->MakePShader(psProgram.c_str(), "main", "ps_5_0");
 
   if(!vs || !ps)
   {
@@ -1394,8 +1399,8 @@ bool D3D11DebugAPIWrapper::CalculateSampleGather(
   ID3D11SamplerState *usedSamp = NULL;
 
   // fetch SRV and sampler from the shader stage we're debugging that this opcode wants to load from
-  UINT texSlot = resourceData.binding.shaderRegister;
-  UINT samplerSlot = samplerData.binding.shaderRegister;
+  UINT texSlot = req.resourceData.binding.shaderRegister;
+  UINT samplerSlot = req.samplerData.binding.shaderRegister;
   switch(GetShaderType())
   {
     case DXBC::ShaderType::Vertex:
@@ -1427,14 +1432,14 @@ bool D3D11DebugAPIWrapper::CalculateSampleGather(
 
   // set onto PS while we perform the sample
   context->PSSetShaderResources(0, 1, &usedSRV);
-  if(opcode == OPCODE_SAMPLE_B && samplerData.bias != 0.0f)
+  if(req.opcode == DXBCBytecode::OPCODE_SAMPLE_B && req.samplerData.bias != 0.0f)
   {
     RDCASSERT(usedSamp);
 
     D3D11_SAMPLER_DESC desc;
     usedSamp->GetDesc(&desc);
 
-    desc.MipLODBias = RDCCLAMP(desc.MipLODBias + samplerData.bias, -15.99f, 15.99f);
+    desc.MipLODBias = RDCCLAMP(desc.MipLODBias + req.samplerData.bias, -15.99f, 15.99f);
 
     ID3D11SamplerState *replacementSamp = NULL;
     HRESULT hr = m_pDevice->CreateSamplerState(&desc, &replacementSamp);
@@ -1459,7 +1464,8 @@ bool D3D11DebugAPIWrapper::CalculateSampleGather(
   context->VSSetShader(vs, NULL, 0);
   context->PSSetShader(ps, NULL, 0);
 
-  D3D11_VIEWPORT view = {0.0f, 0.0f, 1.0f, 1.0f, 0.0f, 1.0f};
+  // each lookup is evaluated in its own pixel along a row
+  D3D11_VIEWPORT view = {0.0f, 0.0f, (float)count, 1.0f, 0.0f, 1.0f};
   context->RSSetViewports(1, &view);
 
   context->GSSetShader(NULL, NULL, 0);
@@ -1486,7 +1492,7 @@ bool D3D11DebugAPIWrapper::CalculateSampleGather(
   tdesc.BindFlags = D3D11_BIND_RENDER_TARGET;
   tdesc.CPUAccessFlags = 0;
   tdesc.Format = retFmt;
-  tdesc.Width = 1;
+  tdesc.Width = count;
   tdesc.Height = 1;
   tdesc.MipLevels = 0;
   tdesc.MiscFlags = 0;
@@ -1544,9 +1550,13 @@ bool D3D11DebugAPIWrapper::CalculateSampleGather(
     return false;
   }
 
-  ShaderVariable lookupResult("tex", 0.0f, 0.0f, 0.0f, 0.0f);
-
-  memcpy(lookupResult.value.iv, mapped.pData, sizeof(uint32_t) * 4);
+  results.resize(count);
+  for(uint32_t i = 0; i < count; i++)
+  {
+    results[i] = ShaderVariable("tex", 0.0f, 0.0f, 0.0f, 0.0f);
+    memcpy(results[i].value.iv, (byte *)mapped.pData + i * sizeof(uint32_t) * 4,
+           sizeof(uint32_t) * 4);
+  }
 
   context->Unmap(copyTex, 0);
 
@@ -1569,35 +1579,172 @@ bool D3D11DebugAPIWrapper::CalculateSampleGather(
   SAFE_RELEASE(usedSRV);
   SAFE_RELEASE(usedSamp);
 
-  output = lookupResult;
   return true;
 }
 
+bool D3D11DebugAPIWrapper::CalculateSampleGather(
+    DXBCBytecode::OpcodeType opcode, DXBCDebug::SampleGatherResourceData resourceData,
+    DXBCDebug::SampleGatherSamplerData samplerData, ShaderVariable uv, ShaderVariable ddxCalc,
+    ShaderVariable ddyCalc, const int texelOffsets[3], int multisampleIndex,
+    float lodOrCompareValue, const uint8_t swizzle[4], DXBCDebug::GatherChannel gatherChannel,
+    const char *opString, ShaderVariable &output)
+{
+  DXBCDebug::SampleGatherShaders shaders;
+  DXGI_FORMAT retFmt = DXGI_FORMAT_UNKNOWN;
+  if(!MakeSampleGatherShaders(opcode, resourceData, samplerData, uv, ddxCalc, ddyCalc,
+                              texelOffsets, multisampleIndex, lodOrCompareValue, swizzle,
+                              gatherChannel, opString, shaders, retFmt))
+    return false;
+
+  DXBCDebug::SampleGatherRequest req;
+  req.opcode = opcode;
+  req.resourceData = resourceData;
+  req.samplerData = samplerData;
+
+  rdcarray<ShaderVariable> results;
+  if(!RenderSampleGather(req, shaders.vsProgram, shaders.GetPixelShader(), retFmt, 1, results))
+    return false;
+
+  output = results[0];
+  return true;
+}
+
+void D3D11DebugAPIWrapper::CalculateSampleGathers(
+    rdcarray<DXBCDebug::SampleGatherRequest> &requests)
+{
+  D3D11MarkerRegion region("CalculateSampleGathers");
+
+  rdcarray<DXBCDebug::SampleGatherShaders> shaders;
+  rdcarray<DXGI_FORMAT> retFmts;
+  shaders.resize(requests.size());
+  retFmts.resize(requests.size());
+
+  for(size_t i = 0; i < requests.size(); i++)
+  {
+    DXBCDebug::SampleGatherRequest &req = requests[i];
+    req.succeeded = MakeSampleGatherShaders(
+        req.opcode, req.resourceData, req.samplerData, req.uv, req.ddxCalc, req.ddyCalc,
+        req.texelOffsets, req.multisampleIndex, req.lodOrCompareValue, req.swizzle,
+        req.gatherChannel, req.opString.c_str(), shaders[i], retFmts[i]);
+  }
+
+  rdcarray<bool> done;
+  done.fill(requests.size(), false);
+
+  for(size_t i = 0; i < requests.size(); i++)
+  {
+    if(done[i] || !requests[i].succeeded)
+      continue;
+
+    // gather every other lookup that can share this one's shader, to evaluate them in one draw
+    rdcarray<size_t> batch = {i};
+    rdcarray<const DXBCDebug::SampleGatherShaders *> batchShaders = {&shaders[i]};
+    done[i] = true;
+
+    for(size_t j = i + 1; j < requests.size() && batch.size() < DXBCDebug::MaxSampleGatherBatch;
+        j++)
+    {
+      if(!done[j] && requests[j].succeeded &&
+         DXBCDebug::CanBatchSampleGathers(requests[i], shaders[i], requests[j], shaders[j]))
+      {
+        batch.push_back(j);
+        batchShaders.push_back(&shaders[j]);
+        done[j] = true;
+      }
+    }
+
+    rdcarray<ShaderVariable> results;
+    bool success = RenderSampleGather(requests[i], shaders[i].vsProgram,
+                                      DXBCDebug::MakeBatchedSampleGatherShader(batchShaders),
+                                      retFmts[i], (uint32_t)batch.size(), results);
+
+    for(size_t b = 0; b < batch.size(); b++)
+    {
+      requests[batch[b]].succeeded = success;
+      if(success)
+        requests[batch[b]].output = results[b];
+    }
+  }
+}
+
 bool D3D11DebugAPIWrapper::CalculateMathIntrinsic(DXBCBytecode::OpcodeType opcode,
                                                   const ShaderVariable &input,
                                                   ShaderVariable &output1, ShaderVariable &output2)
 {
-  rdcstr csProgram =
-      "RWBuffer<float4> outval : register(u0);\n"
-      "cbuffer srcOper : register(b0) { float4 inval; };\n"
-      "[numthreads(1, 1, 1)]\n"
-      "void main() {\n";
+  rdcarray<DXBCDebug::MathIntrinsicRequest> requests;
+  requests.resize(1);
+  requests[0].opcode = opcode;
+  requests[0].input = input;
+
+  CalculateMathIntrinsics(requests);
+
+  output1 = requests[0].output1;
+  output2 = requests[0].output2;
+  return requests[0].succeeded;
+}
+
+void D3D11DebugAPIWrapper::CalculateMathIntrinsics(
+    rdcarray<DXBCDebug::MathIntrinsicRequest> &requests)
+{
+  using namespace DXBCBytecode;
 
-  switch(opcode)
+  // the inputs and opcodes for each operation, one thread group per operation
+  struct MathInputs
   {
-    case DXBCBytecode::OPCODE_RCP: csProgram += "outval[0] = rcp(inval);\n"; break;
-    case DXBCBytecode::OPCODE_RSQ: csProgram += "outval[0] = rsqrt(inval);\n"; break;
-    case DXBCBytecode::OPCODE_EXP: csProgram += "outval[0] = exp2(inval);\n"; break;
-    case DXBCBytecode::OPCODE_LOG: csProgram += "outval[0] = log2(inval);\n"; break;
-    case DXBCBytecode::OPCODE_SINCOS: csProgram += "sincos(inval, outval[0], outval[1]);\n"; break;
-    default: RDCERR("Unexpected opcode %d passed to CalculateMathIntrinsic", opcode); return false;
+    Vec4f input[DXBCDebug::MaxMathIntrinsicBatch];
+    Vec4u opcode[DXBCDebug::MaxMathIntrinsicBatch];
+  };
+
+  rdcarray<size_t> batch;
+
+  for(size_t i = 0; i < requests.size(); i++)
+  {
+    DXBCDebug::MathIntrinsicRequest &req = requests[i];
+    req.succeeded = false;
+
+    if(req.opcode != OPCODE_RCP && req.opcode != OPCODE_RSQ && req.opcode != OPCODE_EXP &&
+       req.opcode != OPCODE_LOG && req.opcode != OPCODE_SINCOS)
+    {
+      RDCERR("Unexpected opcode %d passed to CalculateMathIntrinsic", req.opcode);
+      continue;
+    }
+
+    batch.push_back(i);
   }
 
-  csProgram += "}\n";
+  if(batch.empty())
+    return;
+
+  rdcstr csProgram = StringFormat::Fmt(
+      "RWBuffer<float4> outval : register(u0);\n"
+      "cbuffer srcOper : register(b0) { float4 inval[%u]; uint4 operation[%u]; };\n"
+      "[numthreads(1, 1, 1)]\n"
+      "void main(uint3 id : SV_GroupID) {\n"
+      "  uint i = id.x;\n"
+      "  switch(operation[i].x) {\n",
+      DXBCDebug::MaxMathIntrinsicBatch, DXBCDebug::MaxMathIntrinsicBatch);
+
+  csProgram +=
+      StringFormat::Fmt("    case %u: outval[i * 2] = rcp(inval[i]); break;\n", OPCODE_RCP);
+  csProgram +=
+      StringFormat::Fmt("    case %u: outval[i * 2] = rsqrt(inval[i]); break;\n", OPCODE_RSQ);
+  csProgram +=
+      StringFormat::Fmt("    case %u: outval[i * 2] = exp2(inval[i]); break;\n", OPCODE_EXP);
+  csProgram +=
+      StringFormat::Fmt("    case %u: outval[i * 2] = log2(inval[i]); break;\n", OPCODE_LOG);
+  csProgram += StringFormat::Fmt(
+      "    case %u: sincos(inval[i], outval[i * 2], outval[i * 2 + 1]); break;\n", OPCODE_SINCOS);
+  csProgram += "  }\n}\n";
 
   ID3D11ComputeShader *cs =
       m_pDevice->GetShaderCache()->MakeCShader(csProgram.c_str(), "main", "cs_5_0");
 
+  if(!cs)
+  {
+    RDCERR("Math intrinsic CS failed to compile");
+    return;
+  }
+
   ID3D11DeviceContext *context = NULL;
   m_pDevice->GetImmediateContext(&context);
 
@@ -1617,25 +1764,9 @@ bool D3D11DebugAPIWrapper::CalculateMathIntrinsic(DXBCBytecode::OpcodeType opcod
   cdesc.CPUAccessFlags = 0;
   cdesc.MiscFlags = 0;
   cdesc.StructureByteStride = sizeof(Vec4f);
-  cdesc.ByteWidth = sizeof(Vec4f);
+  cdesc.ByteWidth = sizeof(MathInputs);
   cdesc.Usage = D3D11_USAGE_DEFAULT;
 
-  D3D11_SUBRESOURCE_DATA operData = {};
-  operData.pSysMem = &input.value.uv[0];
-  operData.SysMemPitch = sizeof(Vec4f);
-  operData.SysMemSlicePitch = sizeof(Vec4f);
-
-  HRESULT hr = m_pDevice->CreateBuffer(&cdesc, &operData, &constBuf);
-  if(FAILED(hr))
-  {
-    RDCERR("Failed to create constant buf HRESULT: %s", ToStr(hr).c_str());
-    return false;
-  }
-
-  context->CSSetConstantBuffers(0, 1, &constBuf);
-
-  context->CSSetShader(cs, NULL, 0);
-
   ID3D11UnorderedAccessView *uav = NULL;
 
   ID3D11Buffer *uavBuf = NULL;
@@ -1647,15 +1778,17 @@ bool D3D11DebugAPIWrapper::CalculateMathIntrinsic(DXBCBytecode::OpcodeType opcod
   bdesc.CPUAccessFlags = 0;
   bdesc.MiscFlags = 0;
   bdesc.StructureByteStride = sizeof(Vec4f);
-  bdesc.ByteWidth = sizeof(Vec4f) * 2;
+  bdesc.ByteWidth = sizeof(Vec4f) * 2 * DXBCDebug::MaxMathIntrinsicBatch;
   bdesc.Usage = D3D11_USAGE_DEFAULT;
 
-  hr = m_pDevice->CreateBuffer(&bdesc, NULL, &uavBuf);
+  HRESULT hr = m_pDevice->CreateBuffer(&bdesc, NULL, &uavBuf);
 
   if(FAILED(hr))
   {
     RDCERR("Failed to create UAV buf HRESULT: %s", ToStr(hr).c_str());
-    return false;
+    SAFE_RELEASE(cs);
+    SAFE_RELEASE(context);
+    return;
   }
 
   bdesc.BindFlags = 0;
@@ -1667,7 +1800,10 @@ bool D3D11DebugAPIWrapper::CalculateMathIntrinsic(DXBCBytecode::OpcodeType opcod
   if(FAILED(hr))
   {
     RDCERR("Failed to create copy buf HRESULT: %s", ToStr(hr).c_str());
-    return false;
+    SAFE_RELEASE(uavBuf);
+    SAFE_RELEASE(cs);
+    SAFE_RELEASE(context);
+    return;
   }
 
   D3D11_UNORDERED_ACCESS_VIEW_DESC uavDesc = {};
@@ -1675,7 +1811,7 @@ bool D3D11DebugAPIWrapper::CalculateMathIntrinsic(DXBCBytecode::OpcodeType opcod
   uavDesc.Format = DXGI_FORMAT_R32G32B32A32_FLOAT;
   uavDesc.ViewDimension = D3D11_UAV_DIMENSION_BUFFER;
   uavDesc.Buffer.FirstElement = 0;
-  uavDesc.Buffer.NumElements = 2;
+  uavDesc.Buffer.NumElements = 2 * DXBCDebug::MaxMathIntrinsicBatch;
   uavDesc.Buffer.Flags = 0;
 
   hr = m_pDevice->CreateUnorderedAccessView(uavBuf, &uavDesc, &uav);
@@ -1683,32 +1819,73 @@ bool D3D11DebugAPIWrapper::CalculateMathIntrinsic(DXBCBytecode::OpcodeType opcod
   if(FAILED(hr))
   {
     RDCERR("Failed to create uav HRESULT: %s", ToStr(hr).c_str());
-    return false;
+    SAFE_RELEASE(uavBuf);
+    SAFE_RELEASE(copyBuf);
+    SAFE_RELEASE(cs);
+    SAFE_RELEASE(context);
+    return;
   }
 
+  context->CSSetShader(cs, NULL, 0);
   context->CSSetUnorderedAccessViews(0, 1, &uav, NULL);
-  context->Dispatch(1, 1, 1);
 
-  context->CopyResource(copyBuf, uavBuf);
+  // evaluate up to a batch's worth of operations at a time, each in its own thread group
+  for(size_t first = 0; first < batch.size(); first += DXBCDebug::MaxMathIntrinsicBatch)
+  {
+    uint32_t count =
+        (uint32_t)RDCMIN(batch.size() - first, (size_t)DXBCDebug::MaxMathIntrinsicBatch);
 
-  D3D11_MAPPED_SUBRESOURCE mapped;
-  hr = context->Map(copyBuf, 0, D3D11_MAP_READ, 0, &mapped);
+    MathInputs inputs = {};
+    for(uint32_t i = 0; i < count; i++)
+    {
+      const DXBCDebug::MathIntrinsicRequest &req = requests[batch[first + i]];
+      memcpy(&inputs.input[i], &req.input.value.uv[0], sizeof(Vec4f));
+      inputs.opcode[i].x = (uint32_t)req.opcode;
+    }
 
-  if(FAILED(hr))
-  {
-    RDCERR("Failed to map results HRESULT: %s", ToStr(hr).c_str());
-    return false;
-  }
+    D3D11_SUBRESOURCE_DATA operData = {};
+    operData.pSysMem = &inputs;
+    operData.SysMemPitch = sizeof(MathInputs);
+    operData.SysMemSlicePitch = sizeof(MathInputs);
+
+    hr = m_pDevice->CreateBuffer(&cdesc, &operData, &constBuf);
+    if(FAILED(hr))
+    {
+      RDCERR("Failed to create constant buf HRESULT: %s", ToStr(hr).c_str());
+      break;
+    }
+
+    context->CSSetConstantBuffers(0, 1, &constBuf);
+    context->Dispatch(count, 1, 1);
 
-  uint32_t *resA = (uint32_t *)mapped.pData;
-  uint32_t *resB = resA + 4;
+    context->CopyResource(copyBuf, uavBuf);
 
-  memcpy(output1.value.uv, resA, sizeof(uint32_t) * 4);
-  memcpy(output2.value.uv, resB, sizeof(uint32_t) * 4);
+    SAFE_RELEASE(constBuf);
 
-  context->Unmap(copyBuf, 0);
+    D3D11_MAPPED_SUBRESOURCE mapped;
+    hr = context->Map(copyBuf, 0, D3D11_MAP_READ, 0, &mapped);
+
+    if(FAILED(hr))
+    {
+      RDCERR("Failed to map results HRESULT: %s", ToStr(hr).c_str());
+      break;
+    }
+
+    for(uint32_t i = 0; i < count; i++)
+    {
+      DXBCDebug::MathIntrinsicRequest &req = requests[batch[first + i]];
+
+      uint32_t *resA = (uint32_t *)mapped.pData + i * 8;
+      uint32_t *resB = resA + 4;
+
+      memcpy(req.output1.value.uv, resA, sizeof(uint32_t) * 4);
+      memcpy(req.output2.value.uv, resB, sizeof(uint32_t) * 4);
+      req.succeeded = true;
+    }
+
+    context->Unmap(copyBuf, 0);
+  }
 
-  SAFE_RELEASE(constBuf);
   SAFE_RELEASE(uavBuf);
   SAFE_RELEASE(copyBuf);
   SAFE_RELEASE(uav);
@@ -1724,8 +1901,6 @@ bool D3D11DebugAPIWrapper::CalculateMathIntrinsic(DXBCBytecode::OpcodeType opcod
 
   SAFE_RELEASE(prevCB);
   SAFE_RELEASE(prevUAV);
-
-  return true;
 }
 
 void AddCBuffersToGlobalState(const DXBCBytecode::Program &program, D3D11DebugManager &debugManager,
@@ -107,7 +107,12 @@ bool WrappedID3D12CommandQueue::Serialise_ExecuteCommandLists(SerialiserType &se
   {
     ID3D12CommandQueue *real = Unwrap(pQueue);
 
-    if(m_PrevQueueId != GetResID(pQueue))
+    // when replaying queues concurrently, the fence signals and waits order work between queues
+    if(m_pDevice->GetReplayOptions().concurrentQueues)
+    {
+      m_PrevQueueId = GetResID(pQueue);
+    }
+    else if(m_PrevQueueId != GetResID(pQueue))
     {
       RDCDEBUG("Previous queue execution was on queue %s, now executing %s, syncing GPU",
                ToStr(GetResourceManager()->GetOriginalID(m_PrevQueueId)).c_str(),
@@ -125,6 +130,26 @@ bool WrappedID3D12CommandQueue::Serialise_ExecuteCommandLists(SerialiserType &se
       // we're adding multiple events, need to increment ourselves
       m_Cmd.m_RootEventID++;
 
+      // page in everything these command lists use, if residency is being managed
+      {
+        std::set<ResourceId> used;
+
+        for(uint32_t i = 0; i < NumCommandLists; i++)
+        {
+          ResourceId cmd = GetResourceManager()->GetOriginalID(GetResID(ppCommandLists[i]));
+
+          const BakedCmdListInfo &info = m_Cmd.m_BakedCmdListInfo[cmd];
+          if(info.draw == NULL)
+            continue;
+
+          for(const D3D12DrawcallTreeNode &node : info.draw->children)
+            for(const rdcpair<ResourceId, EventUsage> &u : node.resourceUsage)
+              used.insert(u.first);
+        }
+
+        GetResourceManager()->MakeResourcesResident(real, used);
+      }
+
       for(uint32_t i = 0; i < NumCommandLists; i++)
       {
         ResourceId cmd = GetResourceManager()->GetOriginalID(GetResID(ppCommandLists[i]));
@@ -165,10 +190,12 @@ bool WrappedID3D12CommandQueue::Serialise_ExecuteCommandLists(SerialiserType &se
         }
       }
 
-      for(uint32_t i = 0; i < NumCommandLists; i++)
       {
-        ResourceId cmd = GetResID(ppCommandLists[i]);
-        m_pDevice->ApplyBarriers(m_Cmd.m_BakedCmdListInfo[cmd].barriers);
+        rdcarray<const rdcarray<D3D12_RESOURCE_BARRIER> *> barrierLists;
+        barrierLists.reserve(NumCommandLists);
+        for(uint32_t i = 0; i < NumCommandLists; i++)
+          barrierLists.push_back(&m_Cmd.m_BakedCmdListInfo[GetResID(ppCommandLists[i])].barriers);
+        m_pDevice->ApplyBarriers(barrierLists);
       }
 
       rdcstr basename = StringFormat::Fmt("ExecuteCommandLists(%u)", NumCommandLists);
@@ -310,6 +337,9 @@ bool WrappedID3D12CommandQueue::Serialise_ExecuteCommandLists(SerialiserType &se
           eid += 1 + m_Cmd.m_BakedCmdListInfo[cmdId].eventCount;
         }
 
+        GetResourceManager()->MakeEventsResident(real, startEID,
+                                                 RDCMIN(m_Cmd.m_RootEventID, m_Cmd.m_LastEventID));
+
 #if ENABLED(SINGLE_FLUSH_VALIDATE)
         for(size_t i = 0; i < rerecordedCmds.size(); i++)
         {
@@ -326,6 +356,34 @@ bool WrappedID3D12CommandQueue::Serialise_ExecuteCommandLists(SerialiserType &se
   return true;
 }
 
+// resolve every descriptor bound in a command list into the resources it references. This only
+// reads the descriptors so it can run for several command lists at once, leaving the frame
+// referencing itself to be applied afterwards in submission order.
+static void ResolveBoundDescriptorRefs(const CmdListRecordingInfo &info,
+                                       rdcarray<rdcpair<ResourceId, FrameRefType>> &refs)
+{
+  for(const rdcpair<D3D12Descriptor *, UINT> &descRange : info.boundDescs)
+  {
+    for(UINT d = 0; d < descRange.second; ++d)
+    {
+      D3D12Descriptor *desc = descRange.first + d;
+
+      ResourceId id, id2;
+      FrameRefType ref = eFrameRef_Read;
+
+      desc->GetRefIDs(id, id2, ref);
+
+      // the same tables are commonly bound many times, so skip exact repeats. Repeating the same
+      // reference type for a resource never changes the composed result
+      if(id != ResourceId() && (refs.empty() || !(refs.back() == make_rdcpair(id, ref))))
+        refs.push_back(make_rdcpair(id, ref));
+
+      if(id2 != ResourceId() && (refs.empty() || !(refs.back() == make_rdcpair(id2, ref))))
+        refs.push_back(make_rdcpair(id2, ref));
+    }
+  }
+}
+
 void WrappedID3D12CommandQueue::ExecuteCommandLists(UINT NumCommandLists,
                                                     ID3D12CommandList *const *ppCommandLists)
 {
@@ -365,6 +423,42 @@ void WrappedID3D12CommandQueue::ExecuteCommandListsInternal(UINT NumCommandLists
     bool capframe = IsActiveCapturing(m_State);
     std::set<ResourceId> refdIDs;
 
+    // walking the bound descriptors is by far the most expensive part of processing a submission
+    // while capturing, so do that up front across threads for all the command lists.
+    rdcarray<rdcarray<rdcpair<ResourceId, FrameRefType>>> boundDescRefs;
+    if(capframe)
+    {
+      boundDescRefs.resize(NumCommandLists);
+
+      size_t numDescs = 0;
+      for(UINT i = 0; i < NumCommandLists; i++)
+      {
+        for(const rdcpair<D3D12Descriptor *, UINT> &descRange :
+            GetRecord(ppCommandLists[i])->bakedCommands->cmdInfo->boundDescs)
+          numDescs += descRange.second;
+      }
+
+      // spinning up threads costs more than resolving a modest number of descriptors
+      uint32_t numThreads = numDescs >= 16384 ? Threading::NumberOfCores() : 1;
+
+      Threading::ParallelFor(numThreads, NumCommandLists,
+                             [&boundDescRefs, ppCommandLists](uint32_t i) {
+                               ResolveBoundDescriptorRefs(
+                                   *GetRecord(ppCommandLists[i])->bakedCommands->cmdInfo,
+                                   boundDescRefs[i]);
+                             });
+    }
+
+    // apply all the lists' state transitions together, rather than taking the device's resource
+    // state lock once per list
+    {
+      rdcarray<const rdcarray<D3D12_RESOURCE_BARRIER> *> barrierLists;
+      barrierLists.reserve(NumCommandLists);
+      for(UINT i = 0; i < NumCommandLists; i++)
+        barrierLists.push_back(&GetRecord(ppCommandLists[i])->bakedCommands->cmdInfo->barriers);
+      m_pDevice->ApplyBarriers(barrierLists);
+    }
+
     for(UINT i = 0; i < NumCommandLists; i++)
     {
       WrappedID3D12GraphicsCommandList *wrapped =
@@ -374,8 +468,6 @@ void WrappedID3D12CommandQueue::ExecuteCommandListsInternal(UINT NumCommandLists
       if(record->ContainsExecuteIndirect)
         m_QueueRecord->ContainsExecuteIndirect = true;
 
-      m_pDevice->ApplyBarriers(record->bakedCommands->cmdInfo->barriers);
-
       // need to lock the whole section of code, not just the check on
       // m_State, as we also need to make sure we don't check the state,
       // start marking dirty resources then while we're doing so the
@@ -417,33 +509,12 @@ void WrappedID3D12CommandQueue::ExecuteCommandListsInternal(UINT NumCommandLists
           }
         }
 
-        // for each bound descriptor table, mark it referenced as well as all resources currently
-        // bound to it
-        for(auto it = record->bakedCommands->cmdInfo->boundDescs.begin();
-            it != record->bakedCommands->cmdInfo->boundDescs.end(); ++it)
+        // mark all resources currently bound to any descriptor table in this command list,
+        // resolved above
+        for(const rdcpair<ResourceId, FrameRefType> &ref : boundDescRefs[i])
         {
-          rdcpair<D3D12Descriptor *, UINT> &descRange = *it;
-          for(UINT d = 0; d < descRange.second; ++d)
-          {
-            D3D12Descriptor *desc = descRange.first + d;
-
-            ResourceId id, id2;
-            FrameRefType ref = eFrameRef_Read;
-
-            desc->GetRefIDs(id, id2, ref);
-
-            if(id != ResourceId())
-            {
-              refdIDs.insert(id);
-              GetResourceManager()->MarkResourceFrameReferenced(id, ref);
-            }
-
-            if(id2 != ResourceId())
-            {
-              refdIDs.insert(id2);
-              GetResourceManager()->MarkResourceFrameReferenced(id2, ref);
-            }
-          }
+          refdIDs.insert(ref.first);
+          GetResourceManager()->MarkResourceFrameReferenced(ref.first, ref.second);
         }
 
         // pull in frame refs from this baked command list
@@ -496,6 +567,8 @@ void WrappedID3D12CommandQueue::ExecuteCommandListsInternal(UINT NumCommandLists
           continue;
         }
 
+        OverheadCounters::Add(OverheadCounter::ScannedMapBytes, int64_t(size));
+
         size_t diffStart = 0, diffEnd = 0;
         bool found = true;
 
@@ -703,8 +776,16 @@ bool WrappedID3D12CommandQueue::Serialise_Signal(SerialiserType &ser, ID3D12Fenc
 
   if(IsReplayingAndReading() && pFence)
   {
-    m_pReal->Signal(Unwrap(pFence), Value);
-    m_pDevice->GPUSync();
+    if(m_pDevice->GetReplayOptions().concurrentQueues)
+    {
+      Unwrap(pQueue)->Signal(Unwrap(pFence), Value);
+      m_pDevice->ReplayFenceSignal(Unwrap(pQueue), pFence, Value);
+    }
+    else
+    {
+      m_pReal->Signal(Unwrap(pFence), Value);
+      m_pDevice->GPUSync();
+    }
   }
 
   return true;
@@ -742,7 +823,12 @@ bool WrappedID3D12CommandQueue::Serialise_Wait(SerialiserType &ser, ID3D12Fence
 
   if(IsReplayingAndReading() && pFence)
   {
-    m_pDevice->GPUSync();
+    // when replaying queues concurrently, a value that wasn't signalled in this replay was
+    // signalled before the frame began, so there's nothing to wait for.
+    if(m_pDevice->GetReplayOptions().concurrentQueues)
+      m_pDevice->ReplayFenceWait(Unwrap(pQueue), pFence, Value);
+    else
+      m_pDevice->GPUSync();
   }
 
   return true;
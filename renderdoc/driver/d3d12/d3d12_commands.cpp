@@ -1711,6 +1711,7 @@ void D3D12CommandData::AddUsage(const D3D12RenderState &state, D3D12DrawcallTree
               if(!hugeRangeWarned)
                 RDCWARN("Skipping large, most likely 'bindless', descriptor range");
               hugeRangeWarned = true;
+              m_BindlessHeaps.insert(el.id);
             }
             else
             {
@@ -1735,6 +1736,7 @@ void D3D12CommandData::AddUsage(const D3D12RenderState &state, D3D12DrawcallTree
               if(!hugeRangeWarned)
                 RDCWARN("Skipping large, most likely 'bindless', descriptor range");
               hugeRangeWarned = true;
+              m_BindlessHeaps.insert(el.id);
             }
             else
             {
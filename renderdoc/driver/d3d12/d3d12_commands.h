@@ -345,6 +345,10 @@ struct D3D12CommandData
 
   std::map<ResourceId, rdcarray<EventUsage> > m_ResourceUses;
 
+  // descriptor heaps bound with ranges too large to track per-descriptor usage, so anything they
+  // reference may be used by any event.
+  std::set<ResourceId> m_BindlessHeaps;
+
   D3D12DrawcallTreeNode m_ParentDrawcall;
 
   rdcarray<D3D12DrawcallTreeNode *> m_RootDrawcallStack;
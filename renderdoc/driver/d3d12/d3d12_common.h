@@ -738,6 +738,10 @@ DECLARE_REFLECTION_STRUCT(D3D12_ROOT_DESCRIPTOR_TABLE1);
 DECLARE_REFLECTION_STRUCT(D3D12_ROOT_CONSTANTS);
 DECLARE_REFLECTION_STRUCT(D3D12_ROOT_DESCRIPTOR1);
 
+// plain structs of basic members, copied in one go when serialised as arrays
+DECLARE_BULK_SERIALISE_TYPE(D3D12_VIEWPORT);
+DECLARE_BULK_SERIALISE_TYPE(D3D12_BOX);
+
 DECLARE_DESERIALISE_TYPE(D3D12_DISCARD_REGION);
 DECLARE_DESERIALISE_TYPE(D3D12_GRAPHICS_PIPELINE_STATE_DESC);
 DECLARE_DESERIALISE_TYPE(D3D12_COMPUTE_PIPELINE_STATE_DESC);
@@ -276,6 +276,9 @@ void D3D12Replay::FillTimersAMD(uint32_t *eventStartID, uint32_t *sampleIndex,
 {
   uint32_t maxEID = m_pDevice->GetQueue()->GetMaxEID();
 
+  // each pass needs a fresh callback, since command lists must be begun again and aliases are
+  // re-reported. Keep the last one around for the alias events after all passes are done.
+  SAFE_DELETE(m_pAMDDrawCallback);
   m_pAMDDrawCallback = new D3D12AMDDrawCallback(m_pDevice, this, *sampleIndex, *eventIDs);
 
   // replay the events to perform all the queries
@@ -441,6 +444,8 @@ struct D3D12GPUTimerCallback : public D3D12DrawcallCallback
 
 rdcarray<CounterResult> D3D12Replay::FetchCounters(const rdcarray<GPUCounter> &counters)
 {
+  RDCPROFILE_ZONE("D3D12Replay::FetchCounters");
+
   uint32_t maxEID = m_pDevice->GetQueue()->GetMaxEID();
 
   rdcarray<CounterResult> ret;
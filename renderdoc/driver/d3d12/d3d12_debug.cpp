@@ -28,6 +28,7 @@
 #include "driver/dx/official/d3dcompiler.h"
 #include "driver/dxgi/dxgi_common.h"
 #include "driver/shaders/dxbc/dxbc_bytecode.h"
+#include "driver/shaders/dxbc/dxbc_debug.h"
 #include "maths/formatpacking.h"
 #include "maths/matrix.h"
 #include "maths/vec.h"
@@ -521,7 +522,8 @@ bool D3D12DebugManager::CreateMathIntrinsicsResources()
   D3D12_RESOURCE_DESC rdesc;
   ZeroMemory(&rdesc, sizeof(D3D12_RESOURCE_DESC));
   rdesc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
-  rdesc.Width = sizeof(float) * 8;    // Output buffer is 2x float4
+  // Output buffer is 2x float4 for each operation in a batch
+  rdesc.Width = sizeof(float) * 8 * DXBCDebug::MaxMathIntrinsicBatch;
   rdesc.Height = 1;
   rdesc.DepthOrArraySize = 1;
   rdesc.MipLevels = 1;
@@ -266,7 +266,6 @@ WrappedID3D12Device::WrappedID3D12Device(ID3D12Device *realDevice, D3D12InitPara
   m_WrappedDebug.m_pDevice = this;
 
   threadSerialiserTLSSlot = Threading::AllocateTLSSlot();
-  tempMemoryTLSSlot = Threading::AllocateTLSSlot();
 
   m_HeaderChunk = NULL;
 
@@ -363,6 +362,7 @@ WrappedID3D12Device::WrappedID3D12Device(ID3D12Device *realDevice, D3D12InitPara
     m_FrameCaptureRecord = GetResourceManager()->AddResourceRecord(ResourceIDGen::GetNewUniqueID());
     m_FrameCaptureRecord->DataInSerialiser = false;
     m_FrameCaptureRecord->InternalResource = true;
+    m_FrameCaptureRecord->SpillChunks = true;
     m_FrameCaptureRecord->Length = 0;
 
     RenderDoc::Inst().AddDeviceFrameCapturer((ID3D12Device *)this, this);
@@ -464,6 +464,9 @@ WrappedID3D12Device::~WrappedID3D12Device()
 
   RenderDoc::Inst().RemoveDeviceFrameCapturer((ID3D12Device *)this);
 
+  // if loading failed part way through there may still be pipelines being created
+  FinishDeferredPipelines();
+
   if(!m_InternalCmds.pendingcmds.empty())
     ExecuteLists(m_Queue);
 
@@ -526,12 +529,6 @@ WrappedID3D12Device::~WrappedID3D12Device()
   for(size_t i = 0; i < m_ThreadSerialisers.size(); i++)
     delete m_ThreadSerialisers[i];
 
-  for(size_t i = 0; i < m_ThreadTempMem.size(); i++)
-  {
-    delete[] m_ThreadTempMem[i]->memory;
-    delete m_ThreadTempMem[i];
-  }
-
   SAFE_DELETE(m_ResourceList);
   SAFE_DELETE(m_PipelineList);
 
@@ -949,12 +946,20 @@ void WrappedID3D12Device::FirstFrame(IDXGISwapper *swapper)
   }
 }
 
-void WrappedID3D12Device::ApplyBarriers(rdcarray<D3D12_RESOURCE_BARRIER> &barriers)
+void WrappedID3D12Device::ApplyBarriers(const rdcarray<D3D12_RESOURCE_BARRIER> &barriers)
 {
   SCOPED_LOCK(m_ResourceStatesLock);
   GetResourceManager()->ApplyBarriers(barriers, m_ResourceStates);
 }
 
+void WrappedID3D12Device::ApplyBarriers(
+    const rdcarray<const rdcarray<D3D12_RESOURCE_BARRIER> *> &barrierLists)
+{
+  SCOPED_LOCK(m_ResourceStatesLock);
+  for(const rdcarray<D3D12_RESOURCE_BARRIER> *barriers : barrierLists)
+    GetResourceManager()->ApplyBarriers(*barriers, m_ResourceStates);
+}
+
 void WrappedID3D12Device::ReleaseSwapchainResources(IDXGISwapper *swapper, UINT QueueCount,
                                                     IUnknown *const *ppPresentQueue,
                                                     IUnknown **unwrappedQueues)
@@ -1070,7 +1075,7 @@ bool WrappedID3D12Device::Serialise_WrapSwapchainBuffer(SerialiserType &ser, IDX
 
       SubresourceStateVector &states = m_ResourceStates[wrapped->GetResourceID()];
 
-      states = {D3D12_RESOURCE_STATE_PRESENT};
+      states.fill(1, D3D12_RESOURCE_STATE_PRESENT);
     }
   }
 
@@ -1132,7 +1137,7 @@ IUnknown *WrappedID3D12Device::WrapSwapchainBuffer(IDXGISwapper *swapper, DXGI_F
         SCOPED_LOCK(m_ResourceStatesLock);
         SubresourceStateVector &states = m_ResourceStates[id];
 
-        states = {D3D12_RESOURCE_STATE_PRESENT};
+        states.fill(1, D3D12_RESOURCE_STATE_PRESENT);
       }
     }
   }
@@ -1643,8 +1648,10 @@ HRESULT WrappedID3D12Device::Present(ID3D12GraphicsCommandList *pOverlayCommandL
   if(m_InvalidPSO)
     return S_OK;
 
-  // kill any current capture that isn't application defined
-  if(IsActiveCapturing(m_State) && !m_AppControlledCapture)
+  // kill any current capture that isn't application defined, unless it's a merged multi-frame
+  // capture with frames left to record
+  if(IsActiveCapturing(m_State) && !m_AppControlledCapture &&
+     !RenderDoc::Inst().ShouldContinueCapture())
     RenderDoc::Inst().EndFrameCapture((ID3D12Device *)this, swapper->GetHWND());
 
   if(IsBackgroundCapturing(m_State) && RenderDoc::Inst().ShouldTriggerCapture(m_FrameCounter))
@@ -2086,7 +2093,7 @@ bool WrappedID3D12Device::EndFrameCapture(void *dev, void *wnd)
     // in capframe (the transition is thread-protected) so nothing will be
     // pushed to the vector
 
-    std::map<int32_t, Chunk *> recordlist;
+    RecordChunkList recordlist;
 
     for(auto it = queues.begin(); it != queues.end(); ++it)
     {
@@ -2115,17 +2122,19 @@ bool WrappedID3D12Device::EndFrameCapture(void *dev, void *wnd)
 
     m_FrameCaptureRecord->Insert(recordlist);
 
+    SortRecordChunks(recordlist);
+
     RDCDEBUG("Flushing %u chunks to file serialiser from context record",
              (uint32_t)recordlist.size());
 
     float num = float(recordlist.size());
     float idx = 0.0f;
 
-    for(auto it = recordlist.begin(); it != recordlist.end(); ++it)
+    for(const rdcpair<int32_t, Chunk *> &chunk : recordlist)
     {
       RenderDoc::Inst().SetProgress(CaptureProgress::SerialiseFrameContents, idx / num);
       idx += 1.0f;
-      it->second->Write(ser);
+      chunk.second->Write(ser);
     }
 
     RDCDEBUG("Done");
@@ -2290,6 +2299,74 @@ HRESULT WrappedID3D12Device::CreatePipeState(D3D12_EXPANDED_PIPELINE_STATE_STREA
   }
 }
 
+bool WrappedID3D12Device::CanDeferPipelineCreation()
+{
+  // the background creation always goes through a pipeline state stream, so like CreatePipeState
+  // only do it when the stream creation is available.
+  return IsLoading(m_State) && m_pDevice3 != NULL;
+}
+
+void WrappedID3D12Device::DeferPipelineCreation(WrappedID3D12PipelineState *wrapped)
+{
+  // leave a core for the thread reading the capture
+  if(!m_PipelineJobs)
+    m_PipelineJobs = new Threading::JobQueue(RDCMAX(1U, Threading::NumberOfCores() - 1));
+
+  DeferredPipeline *deferred = new DeferredPipeline;
+  deferred->wrapped = wrapped;
+  m_DeferredPipelines.push_back(deferred);
+
+  // the wrapper has its own copy of the whole descriptor by now, so the job doesn't depend on any
+  // of the chunk's data that's about to be freed.
+  ID3D12Device3 *dev = m_pDevice3;
+  m_PipelineJobs->Push([dev, deferred]() {
+    D3D12_EXPANDED_PIPELINE_STATE_STREAM_DESC desc;
+    deferred->wrapped->Fill(desc);
+
+    D3D12_PACKED_PIPELINE_STATE_STREAM_DESC packedDesc = desc;
+    packedDesc.Unwrap();
+
+    deferred->hr = dev->CreatePipelineState(
+        packedDesc.AsDescStream(), __uuidof(ID3D12PipelineState), (void **)&deferred->real);
+  });
+}
+
+bool WrappedID3D12Device::FinishDeferredPipelines()
+{
+  // waits for any jobs still outstanding
+  SAFE_DELETE(m_PipelineJobs);
+
+  bool success = true;
+
+  for(DeferredPipeline *deferred : m_DeferredPipelines)
+  {
+    if(FAILED(deferred->hr))
+    {
+      RDCERR("Failed on resource serialise-creation, HRESULT: %s", ToStr(deferred->hr).c_str());
+      success = false;
+    }
+    else
+    {
+      deferred->wrapped->SetDeferredReal(deferred->real);
+
+      // names are applied to the wrapper as they're read, pass on any the real object missed
+      ResourceId origId = GetResourceManager()->GetOriginalID(deferred->wrapped->GetResourceID());
+      auto it = m_ResourceNames.find(origId);
+      if(it != m_ResourceNames.end())
+        deferred->real->SetName(StringFormat::UTF82Wide(it->second).c_str());
+    }
+
+    delete deferred;
+  }
+
+  m_DeferredPipelines.clear();
+
+  if(!success)
+    m_FailedReplayStatus = ReplayStatus::APIReplayFailed;
+
+  return success;
+}
+
 void WrappedID3D12Device::AddDebugMessage(MessageCategory c, MessageSeverity sv, MessageSource src,
                                           rdcstr d)
 {
@@ -2594,34 +2671,7 @@ HRESULT STDMETHODCALLTYPE WrappedID3D12Device::SetBackgroundProcessingMode(
 
 byte *WrappedID3D12Device::GetTempMemory(size_t s)
 {
-  TempMem *mem = (TempMem *)Threading::GetTLSValue(tempMemoryTLSSlot);
-  if(mem && mem->size >= s)
-    return mem->memory;
-
-  // alloc or grow alloc
-  TempMem *newmem = mem;
-
-  if(!newmem)
-    newmem = new TempMem();
-
-  // free old memory, don't need to keep contents
-  if(newmem->memory)
-    delete[] newmem->memory;
-
-  // alloc new memory
-  newmem->size = s;
-  newmem->memory = new byte[s];
-
-  Threading::SetTLSValue(tempMemoryTLSSlot, (void *)newmem);
-
-  // if this is entirely new, save it for deletion on shutdown
-  if(!mem)
-  {
-    SCOPED_LOCK(m_ThreadTempMemLock);
-    m_ThreadTempMem.push_back(newmem);
-  }
-
-  return newmem->memory;
+  return m_TempMemory.Alloc(s);
 }
 
 WriteSerialiser &WrappedID3D12Device::GetThreadSerialiser()
@@ -2797,6 +2847,10 @@ void WrappedID3D12Device::DestroyInternalResources()
   SAFE_RELEASE(m_Alloc);
   SAFE_RELEASE(m_GPUSyncFence);
   CloseHandle(m_GPUSyncHandle);
+
+  for(auto it = m_ReplayFences.begin(); it != m_ReplayFences.end(); ++it)
+    SAFE_RELEASE(it->second.fence);
+  m_ReplayFences.clear();
 }
 
 void WrappedID3D12Device::GPUSync(ID3D12CommandQueue *queue, ID3D12Fence *fence)
@@ -2811,7 +2865,10 @@ void WrappedID3D12Device::GPUSync(ID3D12CommandQueue *queue, ID3D12Fence *fence)
 
   HRESULT hr = queue->Signal(fence, m_GPUSyncCounter);
   fence->SetEventOnCompletion(m_GPUSyncCounter, m_GPUSyncHandle);
+
+  PerformanceTimer timer;
   WaitForSingleObject(m_GPUSyncHandle, 10000);
+  m_GPUWaitTime += timer.GetMilliseconds();
 
   RDCASSERTEQUAL(hr, S_OK);
   hr = m_pDevice->GetDeviceRemovedReason();
@@ -2824,6 +2881,49 @@ void WrappedID3D12Device::GPUSyncAllQueues()
     GPUSync(m_Queues[i], m_QueueFences[i]);
 }
 
+void WrappedID3D12Device::ReplayFenceSignal(ID3D12CommandQueue *queue, ID3D12Fence *fence,
+                                            UINT64 value)
+{
+  ReplayFence &replayFence = m_ReplayFences[GetResID(fence)];
+
+  if(replayFence.fence == NULL)
+  {
+    HRESULT hr = m_pDevice->CreateFence(0, D3D12_FENCE_FLAG_NONE, __uuidof(ID3D12Fence),
+                                        (void **)&replayFence.fence);
+
+    if(FAILED(hr) || replayFence.fence == NULL)
+    {
+      RDCERR("Couldn't create replay fence, HRESULT: %s", ToStr(hr).c_str());
+      m_ReplayFences.erase(GetResID(fence));
+      return;
+    }
+  }
+
+  // the program can move its fence backwards, but ours must only increase. Waits for a lower value
+  // are satisfied either way.
+  if(replayFence.hasSignalled && value <= replayFence.signalled)
+    return;
+
+  queue->Signal(replayFence.fence, replayFence.base + value);
+
+  replayFence.signalled = value;
+  replayFence.hasSignalled = true;
+  replayFence.maxValue = RDCMAX(replayFence.maxValue, value);
+}
+
+bool WrappedID3D12Device::ReplayFenceWait(ID3D12CommandQueue *queue, ID3D12Fence *fence,
+                                          UINT64 value)
+{
+  auto it = m_ReplayFences.find(GetResID(fence));
+
+  if(it == m_ReplayFences.end() || !it->second.hasSignalled || value > it->second.signalled)
+    return false;
+
+  queue->Wait(it->second.fence, it->second.base + value);
+
+  return true;
+}
+
 ID3D12GraphicsCommandListX *WrappedID3D12Device::GetNewList()
 {
   ID3D12GraphicsCommandListX *ret = NULL;
@@ -3216,23 +3316,17 @@ ReplayStatus WrappedID3D12Device::ReadLogInitialisation(RDCFile *rdc, bool store
 
   int chunkIdx = 0;
 
-  struct chunkinfo
-  {
-    chunkinfo() : count(0), totalsize(0), total(0.0) {}
-    int count;
-    uint64_t totalsize;
-    double total;
-  };
-
-  std::map<D3D12Chunk, chunkinfo> chunkInfos;
+  ChunkLoadRecorder chunkStats;
 
   SCOPED_TIMER("chunk initialisation");
+  RDCPROFILE_ZONE("ReadLogInitialisation");
 
   uint64_t frameDataSize = 0;
 
   for(;;)
   {
     PerformanceTimer timer;
+    double gpuWaitStart = m_GPUWaitTime;
 
     uint64_t offsetStart = reader->GetOffset();
 
@@ -3275,6 +3369,9 @@ ReplayStatus WrappedID3D12Device::ReadLogInitialisation(RDCFile *rdc, bool store
 
       m_Queue->SetFrameReader(new StreamReader(reader, frameDataSize));
 
+      if(!FinishDeferredPipelines())
+        return m_FailedReplayStatus;
+
       if(!IsStructuredExporting(m_State))
       {
         rdcarray<DebugMessage> savedDebugMessages;
@@ -3295,14 +3392,16 @@ ReplayStatus WrappedID3D12Device::ReadLogInitialisation(RDCFile *rdc, bool store
         return status;
     }
 
-    chunkInfos[context].total += timer.GetMilliseconds();
-    chunkInfos[context].totalsize += offsetEnd - offsetStart;
-    chunkInfos[context].count++;
+    chunkStats.Record((uint32_t)context, offsetEnd - offsetStart, timer.GetMilliseconds(),
+                      m_GPUWaitTime - gpuWaitStart);
 
     if((SystemChunk)context == SystemChunk::CaptureScope || reader->IsErrored() || reader->AtEnd())
       break;
   }
 
+  if(!FinishDeferredPipelines())
+    return m_FailedReplayStatus;
+
   // steal the structured data for ourselves
   m_StructuredFile->Swap(m_StoredStructuredData);
 
@@ -3330,27 +3429,14 @@ ReplayStatus WrappedID3D12Device::ReadLogInitialisation(RDCFile *rdc, bool store
       SAFE_RELEASE(it->second);
   }
 
-#if ENABLED(RDOC_DEVEL)
-  for(auto it = chunkInfos.begin(); it != chunkInfos.end(); ++it)
-  {
-    double dcount = double(it->second.count);
-
-    RDCDEBUG(
-        "% 5d chunks - Time: %9.3fms total/%9.3fms avg - Size: %8.3fMB total/%7.3fMB avg - %s (%u)",
-        it->second.count, it->second.total, it->second.total / dcount,
-        double(it->second.totalsize) / (1024.0 * 1024.0),
-        double(it->second.totalsize) / (dcount * 1024.0 * 1024.0),
-        GetChunkName((uint32_t)it->first).c_str(), uint32_t(it->first));
-  }
-#endif
-
   GetReplay()->WriteFrameRecord().frameInfo.uncompressedFileSize =
       rdc->GetSectionProperties(sectionIdx).uncompressedSize;
   GetReplay()->WriteFrameRecord().frameInfo.compressedFileSize =
       rdc->GetSectionProperties(sectionIdx).compressedSize;
   GetReplay()->WriteFrameRecord().frameInfo.persistentSize = frameDataSize;
   GetReplay()->WriteFrameRecord().frameInfo.initDataSize =
-      chunkInfos[(D3D12Chunk)SystemChunk::InitialContents].totalsize;
+      chunkStats.GetTotalSize((uint32_t)SystemChunk::InitialContents);
+  GetReplay()->WriteFrameRecord().frameInfo.loadStatistics = chunkStats.Bake(&GetChunkName);
 
   RDCDEBUG("Allocating %llu persistant bytes of memory for the log.",
            GetReplay()->WriteFrameRecord().frameInfo.persistentSize);
@@ -3361,6 +3447,8 @@ ReplayStatus WrappedID3D12Device::ReadLogInitialisation(RDCFile *rdc, bool store
 void WrappedID3D12Device::ReplayLog(uint32_t startEventID, uint32_t endEventID,
                                     ReplayLogType replayType)
 {
+  RDCPROFILE_ZONE("WrappedID3D12Device::ReplayLog");
+
   bool partial = true;
 
   if(startEventID == 0 && (replayType == eReplay_WithoutDraw || replayType == eReplay_Full))
@@ -3397,6 +3485,39 @@ void WrappedID3D12Device::ReplayLog(uint32_t startEventID, uint32_t endEventID,
     FlushLists(true);
   }
 
+  // anything written up to here will need its initial contents re-applied on the next full replay
+  GetResourceManager()->MarkReplayedUpTo(endEventID);
+
+  // start a new range of values on the replay fences, past anything a previous replay signalled
+  if(m_ReplayOptions.concurrentQueues)
+  {
+    for(auto it = m_ReplayFences.begin(); it != m_ReplayFences.end(); ++it)
+    {
+      it->second.base += it->second.maxValue + 1;
+      it->second.signalled = 0;
+      it->second.hasSignalled = false;
+    }
+  }
+
+  // all of the capture's validation messages were gathered while loading, and nothing fetches from
+  // the info queue once we're actively replaying. Stop the debug layer from storing and printing
+  // the same messages all over again on every replay.
+  if(IsLoading(m_State) && m_pInfoQueue && m_ReplayOptions.apiValidation)
+  {
+    D3D12_MESSAGE_SEVERITY severities[] = {
+        D3D12_MESSAGE_SEVERITY_CORRUPTION, D3D12_MESSAGE_SEVERITY_ERROR,
+        D3D12_MESSAGE_SEVERITY_WARNING,    D3D12_MESSAGE_SEVERITY_INFO,
+        D3D12_MESSAGE_SEVERITY_MESSAGE,
+    };
+
+    D3D12_INFO_QUEUE_FILTER filter = {};
+    filter.DenyList.NumSeverities = ARRAY_COUNT(severities);
+    filter.DenyList.pSeverityList = severities;
+
+    m_pInfoQueue->PushStorageFilter(&filter);
+    m_pInfoQueue->ClearStoredMessages();
+  }
+
   m_State = CaptureState::ActiveReplaying;
 
   D3D12MarkerRegion::Set(
@@ -3451,6 +3572,19 @@ void WrappedID3D12Device::ReplayLog(uint32_t startEventID, uint32_t endEventID,
 
     RDCASSERTEQUAL(status, ReplayStatus::Succeeded);
 
+    // our own work from here on must not overlap with anything still running on other queues.
+    // Wait on the GPU so that the replay itself isn't stalled.
+    if(m_ReplayOptions.concurrentQueues)
+    {
+      m_GPUSyncCounter++;
+
+      for(size_t i = 0; i < m_Queues.size(); i++)
+      {
+        m_Queues[i]->Signal(m_QueueFences[i], m_GPUSyncCounter);
+        GetQueue()->Wait(m_QueueFences[i], m_GPUSyncCounter);
+      }
+    }
+
     if(cmd.m_OutsideCmdList != NULL)
     {
       ID3D12GraphicsCommandList *list = cmd.m_OutsideCmdList;
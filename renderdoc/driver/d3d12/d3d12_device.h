@@ -26,6 +26,7 @@
 
 #include <stdint.h>
 #include <map>
+#include "common/temp_memory.h"
 #include "common/threading.h"
 #include "common/timing.h"
 #include "common/wrapped_pool.h"
@@ -361,6 +362,21 @@ private:
   rdcarray<WrappedID3D12CommandQueue *> m_Queues;
   rdcarray<ID3D12Fence *> m_QueueFences;
 
+  // when replaying queues concurrently, every fence that queues signal is shadowed by a fence of
+  // our own. Values on it are the original values plus a base that moves past everything signalled
+  // in the previous replay, so a wait only ever sees signals from the current replay.
+  struct ReplayFence
+  {
+    ID3D12Fence *fence = NULL;
+    UINT64 base = 0;
+    // the highest original value signalled in any replay
+    UINT64 maxValue = 0;
+    // the last original value signalled in the current replay, if any
+    UINT64 signalled = 0;
+    bool hasSignalled = false;
+  };
+  std::map<ResourceId, ReplayFence> m_ReplayFences;
+
   // list of queues and buffers kept alive during capture artificially even if the user destroys
   // them, so we can use them in the capture. Storing this separately prevents races where a
   // queue/buffer is added between us transitioning away from active capturing (so we don't addref
@@ -424,15 +440,7 @@ private:
   Threading::CriticalSection m_ThreadSerialisersLock;
   rdcarray<WriteSerialiser *> m_ThreadSerialisers;
 
-  uint64_t tempMemoryTLSSlot;
-  struct TempMem
-  {
-    TempMem() : memory(NULL), size(0) {}
-    byte *memory;
-    size_t size;
-  };
-  Threading::CriticalSection m_ThreadTempMemLock;
-  rdcarray<TempMem *> m_ThreadTempMem;
+  ThreadTempMemory m_TempMemory;
 
   rdcarray<DebugMessage> m_DebugMessages;
 
@@ -445,6 +453,26 @@ private:
 
   ReplayStatus m_FailedReplayStatus = ReplayStatus::APIReplayFailed;
 
+  // total milliseconds spent blocked in GPUSync, sampled around each chunk while loading
+  double m_GPUWaitTime = 0.0;
+
+  // while loading, real pipeline states are created on worker threads since they're independent.
+  // The wrappers exist straight away so later chunks can refer to them, and the real objects are
+  // filled in before anything needs them.
+  struct DeferredPipeline
+  {
+    WrappedID3D12PipelineState *wrapped = NULL;
+    ID3D12PipelineState *real = NULL;
+    HRESULT hr = S_OK;
+  };
+
+  Threading::JobQueue *m_PipelineJobs = NULL;
+  rdcarray<DeferredPipeline *> m_DeferredPipelines;
+
+  bool CanDeferPipelineCreation();
+  void DeferPipelineCreation(WrappedID3D12PipelineState *wrapped);
+  bool FinishDeferredPipelines();
+
   bool m_AppControlledCapture = false;
 
   bool m_InvalidPSO = false;
@@ -572,7 +600,7 @@ public:
   void AddResourceCurChunk(ResourceId id);
 
   const rdcstr &GetResourceName(ResourceId id) { return m_ResourceNames[id]; }
-  rdcarray<D3D12_RESOURCE_STATES> &GetSubresourceStates(ResourceId id)
+  const SubresourceStateVector &GetSubresourceStates(ResourceId id)
   {
     return m_ResourceStates[id];
   }
@@ -594,7 +622,9 @@ public:
   D3D12Replay *GetReplay() { return m_Replay; }
   WrappedID3D12CommandQueue *GetQueue() { return m_Queue; }
   ID3D12CommandAllocator *GetAlloc() { return m_Alloc; }
-  void ApplyBarriers(rdcarray<D3D12_RESOURCE_BARRIER> &barriers);
+  void ApplyBarriers(const rdcarray<D3D12_RESOURCE_BARRIER> &barriers);
+  // apply a whole submission's worth of command lists' barriers, in order, under one lock
+  void ApplyBarriers(const rdcarray<const rdcarray<D3D12_RESOURCE_BARRIER> *> &barrierLists);
 
   void GetDynamicDescriptorReferences(rdcarray<D3D12Descriptor> &refs)
   {
@@ -608,7 +638,8 @@ public:
   }
 
   bool IsCubemap(ResourceId id) { return m_Cubemaps.find(id) != m_Cubemaps.end(); }
-  // returns thread-local temporary memory
+  // returns thread-local temporary memory, valid until the next call unless a TempMemoryScope on
+  // m_TempMemory is open
   byte *GetTempMemory(size_t s);
   template <class T>
   T *GetTempArray(uint32_t arraycount)
@@ -656,6 +687,11 @@ public:
   void GPUSync(ID3D12CommandQueue *queue = NULL, ID3D12Fence *fence = NULL);
   void GPUSyncAllQueues();
 
+  // for concurrent queue replay, queue is the real queue and fence is the wrapped captured fence.
+  // Waits return false if the value wasn't signalled in this replay, so there's nothing to wait on.
+  void ReplayFenceSignal(ID3D12CommandQueue *queue, ID3D12Fence *fence, UINT64 value);
+  bool ReplayFenceWait(ID3D12CommandQueue *queue, ID3D12Fence *fence, UINT64 value);
+
   RDCDriver GetFrameCaptureDriver() { return RDCDriver::D3D12; }
   void StartFrameCapture(void *dev, void *wnd);
   bool EndFrameCapture(void *dev, void *wnd);
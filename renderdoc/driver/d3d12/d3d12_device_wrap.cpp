@@ -431,7 +431,12 @@ bool WrappedID3D12Device::Serialise_CreateGraphicsPipelineState(
     }
 
     ID3D12PipelineState *ret = NULL;
-    HRESULT hr = m_pDevice->CreateGraphicsPipelineState(&unwrappedDesc, guid, (void **)&ret);
+    HRESULT hr = S_OK;
+
+    // while loading the real pipeline is created in the background, see DeferPipelineCreation
+    bool defer = CanDeferPipelineCreation();
+    if(!defer)
+      hr = m_pDevice->CreateGraphicsPipelineState(&unwrappedDesc, guid, (void **)&ret);
 
     if(FAILED(hr))
     {
@@ -514,6 +519,9 @@ bool WrappedID3D12Device::Serialise_CreateGraphicsPipelineState(
       }
 
       GetResourceManager()->AddLiveResource(pPipelineState, ret);
+
+      if(defer)
+        DeferPipelineCreation(wrapped);
     }
   }
 
@@ -685,7 +693,12 @@ bool WrappedID3D12Device::Serialise_CreateComputePipelineState(
     }
 
     ID3D12PipelineState *ret = NULL;
-    HRESULT hr = m_pDevice->CreateComputePipelineState(&unwrappedDesc, guid, (void **)&ret);
+    HRESULT hr = S_OK;
+
+    // while loading the real pipeline is created in the background, see DeferPipelineCreation
+    bool defer = CanDeferPipelineCreation();
+    if(!defer)
+      hr = m_pDevice->CreateComputePipelineState(&unwrappedDesc, guid, (void **)&ret);
 
     if(FAILED(hr))
     {
@@ -712,6 +725,9 @@ bool WrappedID3D12Device::Serialise_CreateComputePipelineState(
       wrapped->compute->CS.pShaderBytecode = entry;
 
       GetResourceManager()->AddLiveResource(pPipelineState, ret);
+
+      if(defer)
+        DeferPipelineCreation(wrapped);
     }
   }
 
@@ -1360,6 +1376,12 @@ bool WrappedID3D12Device::Serialise_CreateCommittedResource(
 
       GetResourceManager()->AddLiveResource(pResource, ret);
 
+      if(props.Type == D3D12_HEAP_TYPE_DEFAULT)
+      {
+        D3D12_RESOURCE_ALLOCATION_INFO alloc = m_pDevice->GetResourceAllocationInfo(0, 1, &desc);
+        GetResourceManager()->AddPageable(GetResID(ret), Unwrap(ret), alloc.SizeInBytes);
+      }
+
       SubresourceStateVector &states = m_ResourceStates[GetResID(ret)];
       states.fill(GetNumSubresources(m_pDevice, &desc), InitialResourceState);
 
@@ -1529,6 +1551,9 @@ bool WrappedID3D12Device::Serialise_CreateHeap(SerialiserType &ser, const D3D12_
       ret = new WrappedID3D12Heap1(ret, this);
 
       GetResourceManager()->AddLiveResource(pHeap, ret);
+
+      if(Descriptor.Properties.Type == D3D12_HEAP_TYPE_DEFAULT)
+        GetResourceManager()->AddPageable(GetResID(ret), Unwrap(ret), Descriptor.SizeInBytes);
     }
 
     AddResource(pHeap, ResourceType::Memory, "Heap");
@@ -1649,6 +1674,7 @@ bool WrappedID3D12Device::Serialise_CreatePlacedResource(
       ret = new WrappedID3D12Resource1(ret, this);
 
       GetResourceManager()->AddLiveResource(pResource, ret);
+      GetResourceManager()->AddPlacedResource(GetResID(ret), GetResID(pHeap));
 
       SubresourceStateVector &states = m_ResourceStates[GetResID(ret)];
       states.fill(GetNumSubresources(m_pDevice, &Descriptor), InitialState);
@@ -2165,18 +2191,27 @@ void WrappedID3D12Device::CopyDescriptors(
     const UINT srcSize = pSrcDescriptorRangeSizes ? pSrcDescriptorRangeSizes[srcRange] : 1;
     const UINT dstSize = pDestDescriptorRangeSizes ? pDestDescriptorRangeSizes[dstRange] : 1;
 
-    // just in case a size is specified as 0, check here
-    if(srcIdx < srcSize && dstIdx < dstSize)
+    // process as many descriptors as both current ranges have left in one go. If a size is
+    // specified as 0 this will be 0 and we'll just move onto the next range below
+    const UINT count = RDCMIN(srcSize - srcIdx, dstSize - dstIdx);
+
+    if(count > 0)
     {
       // assume descriptors are volatile
       if(capframe)
-        copies.push_back(DynamicDescriptorCopy(&dst[dstIdx], &src[srcIdx], DescriptorHeapsType));
+      {
+        for(UINT i = 0; i < count; i++)
+          copies.push_back(
+              DynamicDescriptorCopy(&dst[dstIdx + i], &src[srcIdx + i], DescriptorHeapsType));
+      }
       else
-        dst[dstIdx].CopyFrom(src[srcIdx]);
+      {
+        D3D12Descriptor::CopyRange(&dst[dstIdx], &src[srcIdx], count);
+      }
     }
 
-    srcIdx++;
-    dstIdx++;
+    srcIdx += count;
+    dstIdx += count;
 
     // move source onto the next range
     if(srcIdx >= srcSize)
@@ -2201,27 +2236,13 @@ void WrappedID3D12Device::CopyDescriptors(
 
   if(!copies.empty())
   {
-    // reference all the individual heaps
+    // reference all the individual heaps. The resources in the source descriptors aren't
+    // referenced here - the copies are added to the dynamic descriptor refs below, and those are
+    // resolved at submit time alongside bound descriptors, only for work that's actually executed
     for(UINT i = 0; i < NumSrcDescriptorRanges; i++)
     {
       D3D12Descriptor *desc = GetWrapped(pSrcDescriptorRangeStarts[i]);
       GetResourceManager()->MarkResourceFrameReferenced(desc->GetHeapResourceId(), eFrameRef_Read);
-
-      // make sure we reference the resources in the source descriptors too
-      const UINT srcSize = pSrcDescriptorRangeSizes ? pSrcDescriptorRangeSizes[i] : 1;
-      for(UINT d = 0; d < srcSize; d++)
-      {
-        ResourceId id, id2;
-        FrameRefType ref = eFrameRef_Read;
-
-        desc[d].GetRefIDs(id, id2, ref);
-
-        if(id != ResourceId())
-          GetResourceManager()->MarkResourceFrameReferenced(id, ref);
-
-        if(id2 != ResourceId())
-          GetResourceManager()->MarkResourceFrameReferenced(id2, ref);
-      }
     }
 
     for(UINT i = 0; i < NumDestDescriptorRanges; i++)
@@ -2233,6 +2254,7 @@ void WrappedID3D12Device::CopyDescriptors(
     {
       SCOPED_LOCK(m_DynDescLock);
       m_DynamicDescriptorCopies.append(copies);
+      m_DynamicDescriptorRefs.reserve(m_DynamicDescriptorRefs.size() + copies.size());
       for(size_t i = 0; i < copies.size(); i++)
       {
         copies[i].src->GetHeap()->AddRef();
@@ -2273,31 +2295,10 @@ void WrappedID3D12Device::CopyDescriptorsSimple(UINT NumDescriptors,
 
   if(capframe)
   {
-    // reference the heaps
-    {
-      D3D12Descriptor *desc = GetWrapped(SrcDescriptorRangeStart);
-      GetResourceManager()->MarkResourceFrameReferenced(desc->GetHeapResourceId(), eFrameRef_Read);
-
-      // make sure we reference the resources in the source descriptors too
-      for(UINT d = 0; d < NumDescriptors; d++)
-      {
-        ResourceId id, id2;
-        FrameRefType ref = eFrameRef_Read;
-
-        desc[d].GetRefIDs(id, id2, ref);
-
-        if(id != ResourceId())
-          GetResourceManager()->MarkResourceFrameReferenced(id, ref);
-
-        if(id2 != ResourceId())
-          GetResourceManager()->MarkResourceFrameReferenced(id2, ref);
-      }
-    }
-
-    {
-      D3D12Descriptor *desc = GetWrapped(DestDescriptorRangeStart);
-      GetResourceManager()->MarkResourceFrameReferenced(desc->GetHeapResourceId(), eFrameRef_Read);
-    }
+    // reference the heaps. As with CopyDescriptors the resources in the source descriptors are
+    // referenced at submit time via the dynamic descriptor refs
+    GetResourceManager()->MarkResourceFrameReferenced(src->GetHeapResourceId(), eFrameRef_Read);
+    GetResourceManager()->MarkResourceFrameReferenced(dst->GetHeapResourceId(), eFrameRef_Read);
 
     rdcarray<DynamicDescriptorCopy> copies;
     copies.reserve(NumDescriptors);
@@ -2307,6 +2308,7 @@ void WrappedID3D12Device::CopyDescriptorsSimple(UINT NumDescriptors,
     {
       SCOPED_LOCK(m_DynDescLock);
       m_DynamicDescriptorCopies.append(copies);
+      m_DynamicDescriptorRefs.reserve(m_DynamicDescriptorRefs.size() + copies.size());
       for(size_t i = 0; i < copies.size(); i++)
       {
         copies[i].src->GetHeap()->AddRef();
@@ -2326,8 +2328,7 @@ void WrappedID3D12Device::CopyDescriptorsSimple(UINT NumDescriptors,
   }
   else
   {
-    for(UINT i = 0; i < NumDescriptors; i++)
-      dst[i].CopyFrom(src[i]);
+    D3D12Descriptor::CopyRange(dst, src, NumDescriptors);
   }
 }
 
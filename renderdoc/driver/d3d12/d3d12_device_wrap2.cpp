@@ -48,7 +48,11 @@ bool WrappedID3D12Device::Serialise_CreatePipelineState(SerialiserType &ser,
     ID3D12PipelineState *ret = NULL;
     HRESULT hr = E_NOINTERFACE;
 
-    if(m_pDevice2)
+    // while loading the real pipeline is created in the background, see DeferPipelineCreation
+    bool defer = CanDeferPipelineCreation();
+    if(defer)
+      hr = S_OK;
+    else if(m_pDevice2)
       hr = m_pDevice2->CreatePipelineState(unwrappedDesc.AsDescStream(), guid, (void **)&ret);
     else
       RDCERR("Replaying a without D3D12.2 available");
@@ -143,6 +147,9 @@ bool WrappedID3D12Device::Serialise_CreatePipelineState(SerialiserType &ser,
       }
 
       GetResourceManager()->AddLiveResource(pPipelineState, ret);
+
+      if(defer)
+        DeferPipelineCreation(wrapped);
     }
   }
 
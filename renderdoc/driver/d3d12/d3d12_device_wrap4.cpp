@@ -269,6 +269,12 @@ bool WrappedID3D12Device::Serialise_CreateCommittedResource1(
 
       GetResourceManager()->AddLiveResource(pResource, ret);
 
+      if(props.Type == D3D12_HEAP_TYPE_DEFAULT)
+      {
+        D3D12_RESOURCE_ALLOCATION_INFO alloc = m_pDevice->GetResourceAllocationInfo(0, 1, &desc);
+        GetResourceManager()->AddPageable(GetResID(ret), Unwrap(ret), alloc.SizeInBytes);
+      }
+
       SubresourceStateVector &states = m_ResourceStates[GetResID(ret)];
       states.fill(GetNumSubresources(m_pDevice, &desc), InitialResourceState);
 
@@ -436,6 +442,9 @@ bool WrappedID3D12Device::Serialise_CreateHeap1(SerialiserType &ser, const D3D12
       ret = new WrappedID3D12Heap1(ret, this);
 
       GetResourceManager()->AddLiveResource(pHeap, ret);
+
+      if(Descriptor.Properties.Type == D3D12_HEAP_TYPE_DEFAULT)
+        GetResourceManager()->AddPageable(GetResID(ret), Unwrap(ret), Descriptor.SizeInBytes);
     }
 
     AddResource(pHeap, ResourceType::Memory, "Heap");
@@ -32,6 +32,8 @@
 
 bool D3D12ResourceManager::Prepare_InitialState(ID3D12DeviceChild *res)
 {
+  RDCPROFILE_ZONE("D3D12ResourceManager::Prepare_InitialState");
+
   ResourceId id = GetResID(res);
   D3D12ResourceType type = IdentifyTypeByPtr(res);
 
@@ -109,7 +111,7 @@ bool D3D12ResourceManager::Prepare_InitialState(ID3D12DeviceChild *res)
       if(nonresident)
         m_Device->MakeResident(1, &pageable);
 
-      const rdcarray<D3D12_RESOURCE_STATES> &states = m_Device->GetSubresourceStates(GetResID(res));
+      const SubresourceStateVector &states = m_Device->GetSubresourceStates(GetResID(res));
       RDCASSERT(states.size() == 1);
 
       D3D12_RESOURCE_BARRIER barrier;
@@ -215,7 +217,7 @@ bool D3D12ResourceManager::Prepare_InitialState(ID3D12DeviceChild *res)
       rdcarray<D3D12_RESOURCE_BARRIER> barriers;
 
       {
-        const rdcarray<D3D12_RESOURCE_STATES> &states = m_Device->GetSubresourceStates(GetResID(r));
+        const SubresourceStateVector &states = m_Device->GetSubresourceStates(GetResID(r));
 
         barriers.reserve(states.size());
 
@@ -391,9 +393,9 @@ uint64_t D3D12ResourceManager::GetSize_InitialState(ResourceId id, const D3D12In
 
     // readback heaps have already been copied to a buffer, so use that length
     if(data.tag == D3D12InitialContents::MapDirect)
-      return WriteSerialiser::GetChunkAlignment() + 16 + uint64_t(data.dataSize);
+      return WriteSerialiser::GetBufferOverhead() + 16 + uint64_t(data.dataSize);
 
-    return WriteSerialiser::GetChunkAlignment() + 16 + uint64_t(buf ? buf->GetDesc().Width : 0);
+    return WriteSerialiser::GetBufferOverhead() + 16 + uint64_t(buf ? buf->GetDesc().Width : 0);
   }
   else
   {
@@ -818,6 +820,9 @@ void D3D12ResourceManager::Apply_InitialState(ID3D12DeviceChild *live,
   }
   else if(type == Resource_Resource)
   {
+    // the copies below need the destination resident, this may evict others that aren't needed
+    EnsureResident(GetResID(live));
+
     if(data.tag == D3D12InitialContents::Copy)
     {
       ID3D12Resource *copyDst = Unwrap((ID3D12Resource *)live);
@@ -928,8 +933,7 @@ void D3D12ResourceManager::Apply_InitialState(ID3D12DeviceChild *live,
 
         rdcarray<D3D12_RESOURCE_BARRIER> barriers;
 
-        const rdcarray<D3D12_RESOURCE_STATES> &states =
-            m_Device->GetSubresourceStates(GetResID(live));
+        const SubresourceStateVector &states = m_Device->GetSubresourceStates(GetResID(live));
 
         barriers.reserve(states.size());
 
@@ -1034,3 +1038,106 @@ void D3D12ResourceManager::Apply_InitialState(ID3D12DeviceChild *live,
     RDCERR("Unexpected type needing an initial state created: %d", type);
   }
 }
+
+bool D3D12ResourceManager::GetFirstWriteEvent(ResourceId id, uint32_t &eventId)
+{
+  const D3D12InitialContents &data = m_InitialContents[id].data;
+
+  if(data.resourceType != Resource_Resource || data.tag != D3D12InitialContents::Copy ||
+     data.resource == NULL)
+    return false;
+
+  ID3D12Resource *live = GetLiveAs<ID3D12Resource>(id);
+
+  if(!live)
+    return false;
+
+  // placed resources can be overwritten through anything else aliasing the same heap
+  if(!m_Device->GetReplay()->GetResourceDesc(id).parentResources.empty())
+    return false;
+
+  // reserved resources have no heap properties and can have their tile mappings changed. Anything
+  // CPU-visible could be written through a map we don't see as a usage.
+  D3D12_HEAP_PROPERTIES heapProps = {};
+  HRESULT hr = live->GetHeapProperties(&heapProps, NULL);
+  if(FAILED(hr) || heapProps.Type != D3D12_HEAP_TYPE_DEFAULT)
+    return false;
+
+  // buffers can be written by WriteBufferImmediate which isn't tracked as a usage, and outputs can
+  // be written by render passes or bindless access that isn't either. Textures that can't be bound
+  // as any kind of output are only written by copies and resolves, which are always tracked.
+  const D3D12_RESOURCE_FLAGS outputFlags = D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET |
+                                           D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL |
+                                           D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS;
+
+  D3D12_RESOURCE_DESC desc = live->GetDesc();
+  if(desc.Dimension == D3D12_RESOURCE_DIMENSION_BUFFER || (desc.Flags & outputFlags))
+    return false;
+
+  const std::map<ResourceId, rdcarray<EventUsage> > &uses =
+      m_Device->GetQueue()->GetCommandData()->m_ResourceUses;
+
+  eventId = ~0U;
+
+  auto it = uses.find(GetResID(live));
+  if(it == uses.end())
+    return true;
+
+  for(const EventUsage &u : it->second)
+  {
+    switch(u.usage)
+    {
+      case ResourceUsage::Clear:
+      case ResourceUsage::GenMips:
+      case ResourceUsage::Resolve:
+      case ResourceUsage::ResolveDst:
+      case ResourceUsage::Copy:
+      case ResourceUsage::CopyDst:
+      case ResourceUsage::CPUWrite: eventId = RDCMIN(eventId, u.eventId); break;
+      default: break;
+    }
+  }
+
+  return true;
+}
+
+void D3D12ResourceManager::MarkReplayedUpTo(uint32_t eventId)
+{
+  m_ReplayedEvent = RDCMAX(m_ReplayedEvent, eventId);
+}
+
+rdcarray<ResourceId> D3D12ResourceManager::InitialContentResources()
+{
+  rdcarray<ResourceId> resources =
+      ResourceManager<D3D12ResourceManagerConfiguration>::InitialContentResources();
+
+  // while loading everything is applied, and the usage we need to know what's written is gathered.
+  if(IsLoading(m_State))
+    return resources;
+
+  if(!m_FirstWriteEventsKnown)
+  {
+    m_FirstWriteEventsKnown = true;
+
+    for(ResourceId id : resources)
+    {
+      uint32_t eventId = 0;
+      if(GetFirstWriteEvent(id, eventId))
+        m_FirstWriteEvent[id] = eventId;
+    }
+
+    RDCDEBUG("%zu of %zu resources have tracked writes for initial contents reset",
+             m_FirstWriteEvent.size(), resources.size());
+  }
+
+  // anything whose first write wasn't reached since the last reset still has its initial contents
+  const uint32_t replayedEvent = m_ReplayedEvent;
+  resources.removeIf([this, replayedEvent](const ResourceId &id) {
+    auto it = m_FirstWriteEvent.find(id);
+    return it != m_FirstWriteEvent.end() && it->second > replayedEvent;
+  });
+
+  m_ReplayedEvent = 0;
+
+  return resources;
+}
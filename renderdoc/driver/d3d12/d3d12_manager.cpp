@@ -483,6 +483,25 @@ void D3D12Descriptor::CopyFrom(const D3D12Descriptor &src)
   data.samp.idx = index;
 }
 
+void D3D12Descriptor::CopyRange(D3D12Descriptor *dst, const D3D12Descriptor *src, UINT count)
+{
+  if(count == 0)
+    return;
+
+  // a range of descriptors is always within one heap with consecutive indices, so we can copy the
+  // whole block and then patch those back up rather than saving and restoring each descriptor
+  WrappedID3D12DescriptorHeap *heap = dst[0].data.samp.heap;
+  uint32_t index = dst[0].data.samp.idx;
+
+  memmove((void *)dst, (const void *)src, sizeof(D3D12Descriptor) * count);
+
+  for(UINT i = 0; i < count; i++)
+  {
+    dst[i].data.samp.heap = heap;
+    dst[i].data.samp.idx = index + i;
+  }
+}
+
 void D3D12Descriptor::GetRefIDs(ResourceId &id, ResourceId &id2, FrameRefType &ref)
 {
   id = ResourceId();
@@ -649,14 +668,24 @@ D3D12Descriptor *DescriptorFromPortableHandle(D3D12ResourceManager *manager, Por
 #define BARRIER_ASSERT(...)
 #endif
 
-void D3D12ResourceManager::ApplyBarriers(rdcarray<D3D12_RESOURCE_BARRIER> &barriers,
+void D3D12ResourceManager::ApplyBarriers(const rdcarray<D3D12_RESOURCE_BARRIER> &barriers,
                                          std::map<ResourceId, SubresourceStateVector> &states)
 {
+  // barriers commonly come in runs on the same resource (e.g. one per mip), so only look up the
+  // state when the resource changes
+  ResourceId prevId;
+  SubresourceStateVector *prevStates = NULL;
+
   for(size_t b = 0; b < barriers.size(); b++)
   {
-    D3D12_RESOURCE_TRANSITION_BARRIER &trans = barriers[b].Transition;
+    const D3D12_RESOURCE_TRANSITION_BARRIER &trans = barriers[b].Transition;
     ResourceId id = GetResID(trans.pResource);
-    SubresourceStateVector &st = states[id];
+    if(!prevStates || id != prevId)
+    {
+      prevId = id;
+      prevStates = &states[id];
+    }
+    SubresourceStateVector &st = *prevStates;
 
     // skip non-transitions, or begin-halves of transitions
     if(barriers[b].Type != D3D12_RESOURCE_BARRIER_TYPE_TRANSITION ||
@@ -669,14 +698,14 @@ void D3D12ResourceManager::ApplyBarriers(rdcarray<D3D12_RESOURCE_BARRIER> &barri
       {
         BARRIER_ASSERT("Mismatching before state", st[i] == trans.StateBefore, st[i],
                        trans.StateBefore, i);
-        st[i] = trans.StateAfter;
       }
+      st.SetAll(trans.StateAfter);
     }
     else
     {
       BARRIER_ASSERT("Mismatching before state", st[trans.Subresource] == trans.StateBefore,
                      st[trans.Subresource], trans.StateBefore, trans.Subresource);
-      st[trans.Subresource] = trans.StateAfter;
+      st.Set(trans.Subresource, trans.StateAfter);
     }
   }
 }
@@ -693,7 +722,7 @@ void D3D12ResourceManager::SerialiseResourceStates(SerialiserType &ser,
   for(uint32_t i = 0; i < NumMems; i++)
   {
     SERIALISE_ELEMENT_LOCAL(Resource, srcit->first).TypedAs("ID3D12Resource *"_lit);
-    SERIALISE_ELEMENT_LOCAL(States, srcit->second);
+    SERIALISE_ELEMENT_LOCAL(States, srcit->second.ToArray());
 
     ResourceId liveid;
     if(IsReplayingAndReading() && HasLiveResource(Resource))
@@ -757,31 +786,316 @@ bool D3D12ResourceManager::ResourceTypeRelease(ID3D12DeviceChild *res)
   return true;
 }
 
+void D3D12ResourceManager::SetResidencyBudget(uint64_t budget)
+{
+  if(m_ResidencyBudget == 0)
+    RDCLOG("Local video memory budget is %llu MB, %llu MB of captured objects are resident",
+           budget / (1024 * 1024), m_ResidentSize / (1024 * 1024));
+
+  m_ResidencyBudget = budget;
+}
+
+void D3D12ResourceManager::AddPageable(ResourceId id, ID3D12Pageable *pageable, uint64_t size)
+{
+  PageableResidency &p = m_Pageables[id];
+  p.pageable = pageable;
+  p.size = size;
+  p.lastUsed = ++m_ResidencyTick;
+  p.resident = true;
+
+  m_ResidentSize += size;
+
+  // objects are created resident, so make room for this one if we're now over budget. It's the
+  // most recently used so it won't be evicted itself.
+  if(m_ResidencyBudget > 0 && m_ResidentSize > m_ResidencyBudget)
+    Evict(0, {id});
+}
+
+void D3D12ResourceManager::AddPlacedResource(ResourceId id, ResourceId heap)
+{
+  m_PlacedHeaps[id] = heap;
+}
+
+ResourceId D3D12ResourceManager::GetPageable(ResourceId id)
+{
+  auto it = m_PlacedHeaps.find(id);
+  if(it != m_PlacedHeaps.end())
+    return it->second;
+
+  return id;
+}
+
+void D3D12ResourceManager::CacheResidencyEvents()
+{
+  if(m_ResidencyEventsKnown)
+    return;
+
+  m_ResidencyEventsKnown = true;
+
+  const std::map<ResourceId, rdcarray<EventUsage>> &uses =
+      m_Device->GetQueue()->GetCommandData()->m_ResourceUses;
+
+  for(auto it = uses.begin(); it != uses.end(); ++it)
+  {
+    auto p = m_Pageables.find(GetPageable(it->first));
+    if(p == m_Pageables.end())
+      continue;
+
+    for(const EventUsage &u : it->second)
+      p->second.events.push_back(u.eventId);
+  }
+
+  for(auto it = m_Pageables.begin(); it != m_Pageables.end(); ++it)
+  {
+    rdcarray<uint32_t> &events = it->second.events;
+    std::sort(events.begin(), events.end());
+    events.resize(std::unique(events.begin(), events.end()) - events.begin());
+  }
+}
+
+void D3D12ResourceManager::PinBindlessResources()
+{
+  const std::set<ResourceId> &heaps = m_Device->GetQueue()->GetCommandData()->m_BindlessHeaps;
+
+  for(ResourceId heapId : heaps)
+  {
+    if(m_PinnedHeaps.find(heapId) != m_PinnedHeaps.end())
+      continue;
+
+    m_PinnedHeaps.insert(heapId);
+
+    WrappedID3D12DescriptorHeap *heap = GetCurrentAs<WrappedID3D12DescriptorHeap>(heapId);
+    if(heap == NULL)
+      continue;
+
+    D3D12Descriptor *descs = heap->GetDescriptors();
+
+    for(UINT i = 0; i < heap->GetNumDescriptors(); i++)
+    {
+      ResourceId id, id2;
+      FrameRefType ref = eFrameRef_Read;
+
+      descs[i].GetRefIDs(id, id2, ref);
+
+      for(ResourceId res : {id, id2})
+      {
+        if(res == ResourceId())
+          continue;
+
+        auto it = m_Pageables.find(GetPageable(res));
+        if(it != m_Pageables.end())
+          it->second.pinned = true;
+      }
+    }
+  }
+}
+
+void D3D12ResourceManager::MakeEventsResident(ID3D12CommandQueue *queue, uint32_t startEventId,
+                                              uint32_t endEventId)
+{
+  if(m_ResidencyBudget == 0)
+    return;
+
+  // usage is only complete once loading has finished. While loading the command lists are
+  // submitted with the resources they use gathered directly, see MakeResourcesResident.
+  if(IsLoading(m_State))
+    return;
+
+  CacheResidencyEvents();
+  PinBindlessResources();
+
+  rdcarray<ResourceId> needed;
+
+  for(auto it = m_Pageables.begin(); it != m_Pageables.end(); ++it)
+  {
+    const rdcarray<uint32_t> &events = it->second.events;
+    auto ev = std::lower_bound(events.begin(), events.end(), startEventId);
+    if(it->second.pinned || (ev != events.end() && *ev <= endEventId))
+      needed.push_back(it->first);
+  }
+
+  MakeResident(queue, needed);
+}
+
+void D3D12ResourceManager::MakeResourcesResident(ID3D12CommandQueue *queue,
+                                                 const std::set<ResourceId> &ids)
+{
+  if(m_ResidencyBudget == 0)
+    return;
+
+  PinBindlessResources();
+
+  std::set<ResourceId> pageables;
+
+  for(ResourceId id : ids)
+  {
+    ResourceId pageable = GetPageable(id);
+    if(m_Pageables.find(pageable) != m_Pageables.end())
+      pageables.insert(pageable);
+  }
+
+  rdcarray<ResourceId> needed;
+
+  for(auto it = m_Pageables.begin(); it != m_Pageables.end(); ++it)
+  {
+    if(it->second.pinned || pageables.find(it->first) != pageables.end())
+      needed.push_back(it->first);
+  }
+
+  MakeResident(queue, needed);
+}
+
+void D3D12ResourceManager::EnsureResident(ResourceId id)
+{
+  if(m_ResidencyBudget == 0)
+    return;
+
+  rdcarray<ResourceId> needed;
+
+  ResourceId pageable = GetPageable(id);
+  if(m_Pageables.find(pageable) != m_Pageables.end())
+    needed.push_back(pageable);
+
+  MakeResident(NULL, needed);
+}
+
+void D3D12ResourceManager::MakeResident(ID3D12CommandQueue *queue, rdcarray<ResourceId> &pageables)
+{
+  const uint64_t tick = ++m_ResidencyTick;
+
+  uint64_t neededSize = 0;
+  rdcarray<ID3D12Pageable *> objs;
+
+  for(ResourceId id : pageables)
+  {
+    PageableResidency &p = m_Pageables[id];
+    p.lastUsed = tick;
+
+    if(!p.resident)
+    {
+      neededSize += p.size;
+      objs.push_back(p.pageable);
+    }
+  }
+
+  if(objs.empty())
+    return;
+
+  if(m_ResidentSize + neededSize > m_ResidencyBudget)
+    Evict(neededSize, pageables);
+
+  for(ResourceId id : pageables)
+    m_Pageables[id].resident = true;
+
+  m_ResidentSize += neededSize;
+
+  ID3D12Device3 *dev3 = NULL;
+  m_Device->GetReal()->QueryInterface(__uuidof(ID3D12Device3), (void **)&dev3);
+
+  // if we can, page in asynchronously and have the queue wait on it instead of blocking
+  if(dev3 && queue && m_ResidencyFence == NULL)
+    m_Device->GetReal()->CreateFence(0, D3D12_FENCE_FLAG_NONE, __uuidof(ID3D12Fence),
+                                     (void **)&m_ResidencyFence);
+
+  HRESULT hr = S_OK;
+
+  if(dev3 && queue && m_ResidencyFence)
+  {
+    m_ResidencyFenceValue++;
+    hr = dev3->EnqueueMakeResident(D3D12_RESIDENCY_FLAG_NONE, (UINT)objs.size(), objs.data(),
+                                   m_ResidencyFence, m_ResidencyFenceValue);
+    if(SUCCEEDED(hr))
+      queue->Wait(m_ResidencyFence, m_ResidencyFenceValue);
+  }
+  else
+  {
+    hr = m_Device->GetReal()->MakeResident((UINT)objs.size(), objs.data());
+  }
+
+  SAFE_RELEASE(dev3);
+
+  if(FAILED(hr))
+    RDCERR("Couldn't make %zu objects resident (%llu MB), HRESULT: %s", objs.size(),
+           neededSize / (1024 * 1024), ToStr(hr).c_str());
+}
+
+void D3D12ResourceManager::Evict(uint64_t needed, const rdcarray<ResourceId> &keep)
+{
+  // evict down to a little under budget, so we're not immediately evicting again for the next
+  // piece of work
+  const uint64_t target = m_ResidencyBudget - m_ResidencyBudget / 8;
+
+  // we don't know which events use resources accessed through bindless heaps, so keep them
+  PinBindlessResources();
+
+  rdcarray<rdcpair<uint64_t, ResourceId>> candidates;
+
+  for(auto it = m_Pageables.begin(); it != m_Pageables.end(); ++it)
+  {
+    // keep is sorted, it's built in the same order as m_Pageables
+    if(it->second.resident && !it->second.pinned &&
+       !std::binary_search(keep.begin(), keep.end(), it->first))
+      candidates.push_back({it->second.lastUsed, it->first});
+  }
+
+  std::sort(candidates.begin(), candidates.end());
+
+  rdcarray<ID3D12Pageable *> objs;
+  uint64_t evictedSize = 0;
+
+  for(const rdcpair<uint64_t, ResourceId> &c : candidates)
+  {
+    if(m_ResidentSize + needed <= target + evictedSize)
+      break;
+
+    PageableResidency &p = m_Pageables[c.second];
+    p.resident = false;
+    evictedSize += p.size;
+    objs.push_back(p.pageable);
+  }
+
+  if(objs.empty())
+    return;
+
+  // nothing can be evicted while GPU work using it is outstanding. That includes internal lists
+  // that have been recorded but not yet submitted, such as initial contents being applied.
+  if(m_Device->initStateCurList)
+    m_Device->CloseInitialStateList();
+  m_Device->ExecuteLists(NULL, true);
+  m_Device->FlushLists(true);
+  m_Device->GPUSyncAllQueues();
+
+  m_Device->GetReal()->Evict((UINT)objs.size(), objs.data());
+
+  m_ResidentSize -= evictedSize;
+
+  RDCDEBUG("Evicted %zu objects (%llu MB) to stay within residency budget", objs.size(),
+           evictedSize / (1024 * 1024));
+}
+
 void GPUAddressRangeTracker::AddTo(const GPUAddressRange &range)
 {
   SCOPED_WRITELOCK(addressLock);
-  auto it = std::lower_bound(addresses.begin(), addresses.end(), range.start);
 
-  addresses.insert(it - addresses.begin(), range);
+  // multimap inserts after any existing ranges with the same start, so the newest is found last
+  addresses.insert(std::make_pair(range.start, range));
 }
 
 void GPUAddressRangeTracker::RemoveFrom(const GPUAddressRange &range)
 {
   {
     SCOPED_WRITELOCK(addressLock);
-    size_t i = std::lower_bound(addresses.begin(), addresses.end(), range.start) - addresses.begin();
 
     // there might be multiple buffers with the same range start, find the exact range for this
     // buffer
-    while(i < addresses.size() && addresses[i].start == range.start)
+    auto bounds = addresses.equal_range(range.start);
+    for(auto it = bounds.first; it != bounds.second; ++it)
     {
-      if(addresses[i].id == range.id)
+      if(it->second.id == range.id)
       {
-        addresses.erase(i);
+        addresses.erase(it);
         return;
       }
-
-      ++i;
     }
   }
 
@@ -799,15 +1113,17 @@ void GPUAddressRangeTracker::GetResIDFromAddr(D3D12_GPU_VIRTUAL_ADDRESS addr, Re
 
   GPUAddressRange range;
 
-  // this should really be a read-write lock
   {
     SCOPED_READLOCK(addressLock);
 
-    auto it = std::lower_bound(addresses.begin(), addresses.end(), addr);
-    if(it == addresses.end())
+    // find the last range starting at or before addr
+    auto it = addresses.upper_bound(addr);
+    if(it == addresses.begin())
       return;
 
-    range = *it;
+    --it;
+
+    range = it->second;
   }
 
   if(addr < range.start || addr >= range.end)
@@ -326,6 +326,9 @@ public:
   void Create(D3D12_DESCRIPTOR_HEAP_TYPE heapType, WrappedID3D12Device *dev,
               D3D12_CPU_DESCRIPTOR_HANDLE handle);
   void CopyFrom(const D3D12Descriptor &src);
+  // equivalent to calling CopyFrom on each descriptor, for a contiguous run of descriptors within
+  // one heap
+  static void CopyRange(D3D12Descriptor *dst, const D3D12Descriptor *src, UINT count);
   void GetRefIDs(ResourceId &id, ResourceId &id2, FrameRefType &ref);
 
   WrappedID3D12DescriptorHeap *GetHeap() const { return data.samp.heap; }
@@ -445,14 +448,6 @@ struct GPUAddressRange
 {
   D3D12_GPU_VIRTUAL_ADDRESS start, end;
   ResourceId id;
-
-  bool operator<(const D3D12_GPU_VIRTUAL_ADDRESS &o) const
-  {
-    if(o < start)
-      return true;
-
-    return false;
-  }
 };
 
 struct GPUAddressRangeTracker
@@ -462,7 +457,10 @@ struct GPUAddressRangeTracker
   GPUAddressRangeTracker(const GPUAddressRangeTracker &);
   GPUAddressRangeTracker &operator=(const GPUAddressRangeTracker &);
 
-  rdcarray<GPUAddressRange> addresses;
+  // keyed by start address so adding, removing and lookups are all logarithmic, which matters
+  // when thousands of placed resources are created and destroyed every frame. Ranges can share a
+  // start address when placed resources alias, in which case the most recently added wins.
+  std::multimap<D3D12_GPU_VIRTUAL_ADDRESS, GPUAddressRange> addresses;
   Threading::RWLock addressLock;
 
   void AddTo(const GPUAddressRange &range);
@@ -529,7 +527,89 @@ struct D3D12ResourceRecord : public ResourceRecord
   Threading::CriticalSection m_MapLock;
 };
 
-typedef rdcarray<D3D12_RESOURCE_STATES> SubresourceStateVector;
+// Tracked state for each subresource in a resource. Most resources - even textures with many
+// subresources - have every subresource in the same state, so that is stored as a single state and
+// only split out to a full array once a subresource diverges. It's folded back into a single state
+// when everything is transitioned together, or once every subresource returns to the state it had
+// when it split.
+class SubresourceStateVector
+{
+public:
+  SubresourceStateVector() = default;
+
+  size_t size() const { return m_Count; }
+  bool empty() const { return m_Count == 0; }
+  bool IsUniform() const { return m_Split.empty(); }
+  D3D12_RESOURCE_STATES operator[](size_t sub) const
+  {
+    return m_Split.empty() ? m_Uniform : m_Split[sub];
+  }
+
+  void fill(size_t count, D3D12_RESOURCE_STATES state)
+  {
+    m_Count = (uint32_t)count;
+    SetAll(state);
+  }
+
+  void SetAll(D3D12_RESOURCE_STATES state)
+  {
+    m_Uniform = state;
+    m_NumDiverged = 0;
+    m_Split.clear();
+  }
+
+  void Set(size_t sub, D3D12_RESOURCE_STATES state)
+  {
+    if(m_Split.empty())
+    {
+      if(state == m_Uniform || m_Count <= 1)
+      {
+        m_Uniform = state;
+        return;
+      }
+
+      m_Split.fill(m_Count, m_Uniform);
+    }
+
+    D3D12_RESOURCE_STATES &cur = m_Split[sub];
+
+    if(cur == m_Uniform && state != m_Uniform)
+      m_NumDiverged++;
+    else if(cur != m_Uniform && state == m_Uniform)
+      m_NumDiverged--;
+
+    cur = state;
+
+    if(m_NumDiverged == 0)
+      m_Split.clear();
+  }
+
+  rdcarray<D3D12_RESOURCE_STATES> ToArray() const
+  {
+    if(!m_Split.empty())
+      return m_Split;
+
+    rdcarray<D3D12_RESOURCE_STATES> ret;
+    ret.fill(m_Count, m_Uniform);
+    return ret;
+  }
+
+  void FromArray(const rdcarray<D3D12_RESOURCE_STATES> &states)
+  {
+    fill(states.size(), states.empty() ? D3D12_RESOURCE_STATE_COMMON : states[0]);
+
+    for(size_t i = 1; i < states.size(); i++)
+      Set(i, states[i]);
+  }
+
+private:
+  uint32_t m_Count = 0;
+  // while uniform, the state of every subresource. Once split, the state at the time of splitting
+  D3D12_RESOURCE_STATES m_Uniform = D3D12_RESOURCE_STATE_COMMON;
+  // the number of entries in m_Split that differ from m_Uniform
+  uint32_t m_NumDiverged = 0;
+  rdcarray<D3D12_RESOURCE_STATES> m_Split;
+};
 
 struct D3D12InitialContents
 {
@@ -631,6 +711,7 @@ public:
       : ResourceManager(state), m_Device(dev)
   {
   }
+  ~D3D12ResourceManager() { SAFE_RELEASE(m_ResidencyFence); }
   template <class T>
   T *GetLiveAs(ResourceId id)
   {
@@ -643,7 +724,7 @@ public:
     return (T *)GetCurrentResource(id);
   }
 
-  void ApplyBarriers(rdcarray<D3D12_RESOURCE_BARRIER> &barriers,
+  void ApplyBarriers(const rdcarray<D3D12_RESOURCE_BARRIER> &barriers,
                      std::map<ResourceId, SubresourceStateVector> &states);
 
   template <typename SerialiserType>
@@ -656,6 +737,21 @@ public:
 
   void SetInternalResource(ID3D12DeviceChild *res);
 
+  void MarkReplayedUpTo(uint32_t eventId);
+
+  // residency management on replay, for captures whose heaps and committed resources don't fit in
+  // local video memory. Everything is created resident, and once the budget is exceeded the least
+  // recently used objects are evicted to make room for what the next piece of work needs.
+  void SetResidencyBudget(uint64_t budget);
+  void AddPageable(ResourceId id, ID3D12Pageable *pageable, uint64_t size);
+  void AddPlacedResource(ResourceId id, ResourceId heap);
+
+  // make the objects used by the given events or resources resident before work that uses them is
+  // submitted on queue. The queue is made to wait for any residency changes.
+  void MakeEventsResident(ID3D12CommandQueue *queue, uint32_t startEventId, uint32_t endEventId);
+  void MakeResourcesResident(ID3D12CommandQueue *queue, const std::set<ResourceId> &ids);
+  void EnsureResident(ResourceId id);
+
 private:
   ResourceId GetID(ID3D12DeviceChild *res);
 
@@ -670,6 +766,51 @@ private:
   }
   void Create_InitialState(ResourceId id, ID3D12DeviceChild *live, bool hasData);
   void Apply_InitialState(ID3D12DeviceChild *live, const D3D12InitialContents &data);
+  rdcarray<ResourceId> InitialContentResources();
+
+  bool GetFirstWriteEvent(ResourceId id, uint32_t &eventId);
+
+  struct PageableResidency
+  {
+    // the real object, residency isn't tracked on the wrappers since nothing else changes it
+    ID3D12Pageable *pageable = NULL;
+    uint64_t size = 0;
+    uint64_t lastUsed = 0;
+    bool resident = true;
+    // referenced from a bindless descriptor heap, so never evicted
+    bool pinned = false;
+    // sorted events that use this object, or anything placed in it
+    rdcarray<uint32_t> events;
+  };
+
+  void MakeResident(ID3D12CommandQueue *queue, rdcarray<ResourceId> &pageables);
+  void Evict(uint64_t needed, const rdcarray<ResourceId> &keep);
+  void CacheResidencyEvents();
+  void PinBindlessResources();
+
+  // maps from a resource to the object that needs to be resident for it, either the resource
+  // itself or the heap it was placed in.
+  ResourceId GetPageable(ResourceId id);
+
+  // 0 until a budget is known, nothing is evicted until then
+  uint64_t m_ResidencyBudget = 0;
+  uint64_t m_ResidentSize = 0;
+  uint64_t m_ResidencyTick = 0;
+  bool m_ResidencyEventsKnown = false;
+  std::map<ResourceId, PageableResidency> m_Pageables;
+  std::map<ResourceId, ResourceId> m_PlacedHeaps;
+  std::set<ResourceId> m_PinnedHeaps;
+
+  ID3D12Fence *m_ResidencyFence = NULL;
+  UINT64 m_ResidencyFenceValue = 0;
 
   WrappedID3D12Device *m_Device;
+
+  // for resources where every write in the frame is tracked, the first event that writes to them.
+  // Until a replay reaches that event they keep their initial contents and don't need them
+  // re-applied. m_ReplayedEvent is the furthest event replayed since contents were last applied,
+  // which starts as everything since loading replays the whole frame.
+  bool m_FirstWriteEventsKnown = false;
+  std::map<ResourceId, uint32_t> m_FirstWriteEvent;
+  uint32_t m_ReplayedEvent = ~0U;
 };
@@ -305,8 +305,7 @@ ResourceId D3D12Replay::RenderOverlay(ResourceId texid, CompType typeCast, Float
 
     ID3D12GraphicsCommandList *list = m_pDevice->GetNewList();
 
-    const rdcarray<D3D12_RESOURCE_STATES> &states =
-        m_pDevice->GetSubresourceStates(GetResID(realDepth));
+    const SubresourceStateVector &states = m_pDevice->GetSubresourceStates(GetResID(realDepth));
 
     rdcarray<D3D12_RESOURCE_BARRIER> depthBarriers;
     depthBarriers.reserve(states.size());
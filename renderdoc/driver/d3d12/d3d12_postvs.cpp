@@ -156,6 +156,29 @@ void D3D12Replay::ClearPostVSCache()
   m_PostVSData.clear();
 }
 
+static uint64_t GetBufferSize(ID3D12Resource *buf)
+{
+  if(buf == NULL)
+    return 0;
+
+  return buf->GetDesc().Width;
+}
+
+uint64_t D3D12Replay::GetPostVSCacheSize()
+{
+  uint64_t ret = 0;
+
+  for(auto it = m_PostVSData.begin(); it != m_PostVSData.end(); ++it)
+  {
+    ret += GetBufferSize(it->second.vsout.buf);
+    ret += GetBufferSize(it->second.vsout.idxBuf);
+    ret += GetBufferSize(it->second.gsout.buf);
+    ret += GetBufferSize(it->second.gsout.idxBuf);
+  }
+
+  return ret;
+}
+
 void D3D12Replay::InitPostVSBuffers(uint32_t eventId)
 {
   // go through any aliasing
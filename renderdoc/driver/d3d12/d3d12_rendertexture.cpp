@@ -170,7 +170,7 @@ void D3D12DebugManager::PrepareTextureSampling(ID3D12Resource *resource, CompTyp
   }
 
   // transition resource to D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE
-  const rdcarray<D3D12_RESOURCE_STATES> &states = m_pDevice->GetSubresourceStates(GetResID(resource));
+  const SubresourceStateVector &states = m_pDevice->GetSubresourceStates(GetResID(resource));
 
   barriers.reserve(states.size());
   for(size_t i = 0; i < states.size(); i++)
@@ -339,6 +339,8 @@ bool D3D12Replay::RenderTextureInternal(D3D12_CPU_DESCRIPTOR_HANDLE rtv, Texture
   if(resource == NULL)
     return false;
 
+  m_pDevice->GetResourceManager()->EnsureResident(cfg.resourceId);
+
   TexDisplayVSCBuffer vertexData = {};
   TexDisplayPSCBuffer pixelData = {};
   HeatmapData heatmapData = {};
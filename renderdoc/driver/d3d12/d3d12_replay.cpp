@@ -131,9 +131,26 @@ void D3D12Replay::Initialise(IDXGIFactory1 *factory)
 
       RDCLOG("Running replay on %s / %s", ToStr(m_DriverInfo.vendor).c_str(), m_DriverInfo.version);
 
+      pDXGIAdapter->QueryInterface(__uuidof(IDXGIAdapter3), (void **)&m_pAdapter3);
+
       SAFE_RELEASE(pDXGIAdapter);
     }
   }
+
+  // know the budget before loading, since that's where everything is created
+  UpdateResidencyBudget();
+}
+
+void D3D12Replay::UpdateResidencyBudget()
+{
+  if(m_pAdapter3 == NULL)
+    return;
+
+  DXGI_QUERY_VIDEO_MEMORY_INFO info = {};
+  HRESULT hr = m_pAdapter3->QueryVideoMemoryInfo(0, DXGI_MEMORY_SEGMENT_GROUP_LOCAL, &info);
+
+  if(SUCCEEDED(hr) && info.Budget > 0)
+    m_pDevice->GetResourceManager()->SetResidencyBudget(info.Budget);
 }
 
 void D3D12Replay::CreateResources()
@@ -201,6 +218,7 @@ void D3D12Replay::DestroyResources()
   SAFE_RELEASE(m_SOQueryHeap);
 
   SAFE_RELEASE(m_pFactory);
+  SAFE_RELEASE(m_pAdapter3);
 
   SAFE_RELEASE(m_CustomShaderTex);
 
@@ -260,6 +278,33 @@ rdcarray<GPUDevice> D3D12Replay::GetAvailableGPUs()
   return ret;
 }
 
+rdcarray<MemoryUsage> D3D12Replay::GetMemoryUsage()
+{
+  uint64_t reflectionSize = 0;
+  for(auto it = WrappedID3D12Shader::GetShaders().begin();
+      it != WrappedID3D12Shader::GetShaders().end(); ++it)
+  {
+    const ShaderReflection *refl = it->second->GetBuiltDetails();
+    if(refl)
+      reflectionSize += EstimateReflectionSize(*refl);
+  }
+
+  rdcarray<MemoryUsage> ret;
+  ret.push_back(MemoryUsage(MemoryCategory::PostVSCache, 0, GetPostVSCacheSize()));
+  ret.push_back(
+      MemoryUsage(MemoryCategory::ShaderCache, m_pDevice->GetShaderCache()->GetMemoryUsage(), 0));
+  ret.push_back(MemoryUsage(MemoryCategory::ShaderReflection, reflectionSize, 0));
+  return ret;
+}
+
+void D3D12Replay::EvictCache(MemoryCategory category)
+{
+  if(category == MemoryCategory::PostVSCache)
+    ClearPostVSCache();
+  else if(category == MemoryCategory::ShaderCache)
+    m_pDevice->GetShaderCache()->EvictCachedData();
+}
+
 APIProperties D3D12Replay::GetAPIProperties()
 {
   APIProperties ret = m_pDevice->APIProps;
@@ -282,6 +327,9 @@ APIProperties D3D12Replay::GetAPIProperties()
 
 void D3D12Replay::ReplayLog(uint32_t endEventID, ReplayLogType replayType)
 {
+  // the budget changes with other applications' usage
+  UpdateResidencyBudget();
+
   m_pDevice->ReplayLog(0, endEventID, replayType);
 }
 
@@ -2256,6 +2304,8 @@ bool D3D12Replay::GetMinMax(ResourceId texid, const Subresource &sub, CompType t
   if(resource == NULL)
     return false;
 
+  m_pDevice->GetResourceManager()->EnsureResident(texid);
+
   D3D12_RESOURCE_DESC resourceDesc = resource->GetDesc();
 
   HistogramCBufferData cdata;
@@ -2438,6 +2488,8 @@ bool D3D12Replay::GetHistogram(ResourceId texid, const Subresource &sub, CompTyp
   if(resource == NULL)
     return false;
 
+  m_pDevice->GetResourceManager()->EnsureResident(texid);
+
   D3D12_RESOURCE_DESC resourceDesc = resource->GetDesc();
 
   HistogramCBufferData cdata;
@@ -2688,6 +2740,8 @@ void D3D12Replay::GetBufferData(ResourceId buff, uint64_t offset, uint64_t lengt
 
   RDCASSERT(buffer);
 
+  m_pDevice->GetResourceManager()->EnsureResident(buff);
+
   GetDebugManager()->GetBufferData(buffer, offset, length, retData);
 }
 
@@ -2768,8 +2822,8 @@ void D3D12Replay::FillCBufferVariables(ResourceId pipeline, ResourceId shader, r
     }
   }
 
-  StandardFillCBufferVariables(refl.resourceId, c.variables, outvars,
-                               rootData.empty() ? data : rootData);
+  m_CBufferLayouts.Fill(pipeline, shader, entryPoint, cbufSlot, refl.resourceId, c.variables,
+                        outvars, rootData.empty() ? data : rootData);
 }
 
 rdcarray<DebugMessage> D3D12Replay::GetDebugMessages()
@@ -2810,14 +2864,14 @@ void D3D12Replay::BuildShader(ShaderEncoding sourceEncoding, const bytebuf &sour
     hlsl.assign((const char *)source.data(), source.size());
 
     ID3DBlob *blob = NULL;
-    errors = m_pDevice->GetShaderCache()->GetShaderBlob(hlsl.c_str(), entry.c_str(), flags,
-                                                        profile.c_str(), &blob);
+    errors = m_pDevice->GetShaderCache()->GetUserShaderBlob(hlsl.c_str(), entry.c_str(), flags,
+                                                            profile.c_str(), &blob);
 
     if(m_D3D12On7 && blob == NULL && errors.contains("unrecognized compiler target"))
     {
       profile.back() = '0';
-      errors = m_pDevice->GetShaderCache()->GetShaderBlob(hlsl.c_str(), entry.c_str(), flags,
-                                                          profile.c_str(), &blob);
+      errors = m_pDevice->GetShaderCache()->GetUserShaderBlob(hlsl.c_str(), entry.c_str(), flags,
+                                                              profile.c_str(), &blob);
     }
 
     if(blob == NULL)
@@ -3001,6 +3055,8 @@ void D3D12Replay::GetTextureData(ResourceId tex, const Subresource &sub,
     return;
   }
 
+  m_pDevice->GetResourceManager()->EnsureResident(tex);
+
   D3D12MarkerRegion region(m_pDevice->GetQueue(),
                            StringFormat::Fmt("GetTextureData(%u, %u, %u, remap=%d)", sub.mip,
                                              sub.slice, sub.sample, params.remap));
@@ -3206,7 +3262,7 @@ void D3D12Replay::GetTextureData(ResourceId tex, const Subresource &sub,
     list = m_pDevice->GetNewList();
 
     // put source texture into resolve source state
-    const rdcarray<D3D12_RESOURCE_STATES> &states = m_pDevice->GetSubresourceStates(tex);
+    const SubresourceStateVector &states = m_pDevice->GetSubresourceStates(tex);
 
     rdcarray<D3D12_RESOURCE_BARRIER> barriers;
     barriers.reserve(states.size());
@@ -3274,7 +3330,7 @@ void D3D12Replay::GetTextureData(ResourceId tex, const Subresource &sub,
     list = m_pDevice->GetNewList();
 
     // put source texture into shader read state
-    const rdcarray<D3D12_RESOURCE_STATES> &states = m_pDevice->GetSubresourceStates(tex);
+    const SubresourceStateVector &states = m_pDevice->GetSubresourceStates(tex);
 
     rdcarray<D3D12_RESOURCE_BARRIER> barriers;
     barriers.reserve(states.size());
@@ -3339,7 +3395,7 @@ void D3D12Replay::GetTextureData(ResourceId tex, const Subresource &sub,
   // if we have no tmpImage, we're copying directly from the real image
   if(tmpTexture == NULL)
   {
-    const rdcarray<D3D12_RESOURCE_STATES> &states = m_pDevice->GetSubresourceStates(tex);
+    const SubresourceStateVector &states = m_pDevice->GetSubresourceStates(tex);
     barriers.reserve(states.size());
     for(size_t i = 0; i < states.size(); i++)
     {
@@ -60,6 +60,7 @@ public:
   void Set12On7(bool d3d12on7) { m_D3D12On7 = d3d12on7; }
   void SetProxy(bool proxy) { m_Proxy = proxy; }
   bool IsRemoteProxy() { return m_Proxy; }
+  void FetchStructuredChunks(const rdcarray<uint32_t> &chunkIndices) {}
   void Initialise(IDXGIFactory1 *factory);
   void Shutdown();
 
@@ -67,6 +68,8 @@ public:
   void DestroyResources();
   DriverInformation GetDriverInfo() { return m_DriverInfo; }
   rdcarray<GPUDevice> GetAvailableGPUs();
+  rdcarray<MemoryUsage> GetMemoryUsage();
+  void EvictCache(MemoryCategory category);
   APIProperties GetAPIProperties();
 
   ResourceDescription &GetResourceDesc(ResourceId id);
@@ -199,6 +202,7 @@ public:
   ResourceId RenderOverlay(ResourceId texid, CompType typeCast, FloatVector clearCol,
                            DebugOverlay overlay, uint32_t eventId,
                            const rdcarray<uint32_t> &passEvents);
+  rdcarray<OverdrawStatistics> GetOverdrawStatistics() { return {}; }
 
   void BuildCustomShader(ShaderEncoding sourceEncoding, const bytebuf &source, const rdcstr &entry,
                          const ShaderCompileFlags &compileFlags, ShaderStage type, ResourceId &id,
@@ -218,6 +222,7 @@ private:
   void FillResourceView(D3D12Pipe::View &view, const D3D12Descriptor *desc);
 
   void ClearPostVSCache();
+  uint64_t GetPostVSCacheSize();
 
   bool CreateSOBuffers();
 
@@ -326,6 +331,8 @@ private:
 
   HighlightCache m_HighlightCache;
 
+  CBufferLayoutCache m_CBufferLayouts;
+
   ID3D12Resource *m_CustomShaderTex = NULL;
   ResourceId m_CustomShaderResourceId;
 
@@ -428,6 +435,10 @@ private:
 
   IDXGIFactory1 *m_pFactory = NULL;
 
+  // used to query the local video memory budget for residency management
+  IDXGIAdapter3 *m_pAdapter3 = NULL;
+  void UpdateResidencyBudget();
+
   AMDCounters *m_pAMDCounters = NULL;
   AMDRGPControl *m_RGP = NULL;
 
@@ -459,23 +459,24 @@ void WrappedID3D12Resource1::RefBuffers(D3D12ResourceManager *rm)
 {
   // only buffers go into m_Addresses
   SCOPED_READLOCK(m_Addresses.addressLock);
-  for(size_t i = 0; i < m_Addresses.addresses.size(); i++)
-    rm->MarkResourceFrameReferenced(m_Addresses.addresses[i].id, eFrameRef_Read);
+  for(auto it = m_Addresses.addresses.begin(); it != m_Addresses.addresses.end(); ++it)
+    rm->MarkResourceFrameReferenced(it->second.id, eFrameRef_Read);
 }
 
 rdcarray<ID3D12Resource *> WrappedID3D12Resource1::AddRefBuffersBeforeCapture(D3D12ResourceManager *rm)
 {
   rdcarray<ID3D12Resource *> ret;
 
-  rdcarray<GPUAddressRange> addresses;
+  rdcarray<ResourceId> ids;
   {
     SCOPED_READLOCK(m_Addresses.addressLock);
-    addresses = m_Addresses.addresses;
+    for(auto it = m_Addresses.addresses.begin(); it != m_Addresses.addresses.end(); ++it)
+      ids.push_back(it->second.id);
   }
 
-  for(size_t i = 0; i < addresses.size(); i++)
+  for(size_t i = 0; i < ids.size(); i++)
   {
-    ID3D12Resource *resource = (ID3D12Resource *)rm->GetCurrentResource(m_Addresses.addresses[i].id);
+    ID3D12Resource *resource = (ID3D12Resource *)rm->GetCurrentResource(ids[i]);
     resource->AddRef();
     ret.push_back(resource);
   }
@@ -725,6 +725,8 @@ public:
       shader->Release();
     }
 
+    static const std::map<DXBCKey, ShaderEntry *> &GetShaders() { return m_Shaders; }
+
     DXBCKey GetKey() { return m_Key; }
     void SetDebugInfoPath(rdcarray<rdcstr> *searchPaths, const rdcstr &path)
     {
@@ -765,6 +767,9 @@ public:
       return m_Mapping;
     }
 
+    // the reflection if it's been built, without building it
+    const ShaderReflection *GetBuiltDetails() const { return m_Built ? &m_Details : NULL; }
+
   private:
     ShaderEntry(const ShaderEntry &e);
     void TryReplaceOriginalByteCode();
@@ -804,6 +809,14 @@ public:
     if(IsReplayMode(m_pDevice->GetState()))
       m_pDevice->GetPipelineList().push_back(this);
   }
+
+  // for a wrapper created with no real object, when the pipeline was compiled in the background
+  void SetDeferredReal(ID3D12PipelineState *real)
+  {
+    RDCASSERT(m_pReal == NULL);
+    m_pReal = real;
+    m_pDevice->GetResourceManager()->AddWrapper(this, real);
+  }
   virtual ~WrappedID3D12PipelineState()
   {
     if(IsReplayMode(m_pDevice->GetState()))
@@ -23,8 +23,9 @@
  ******************************************************************************/
 
 #include "d3d12_shader_cache.h"
-#include "common/shader_cache.h"
+#include "api/replay/version.h"
 #include "driver/dx/official/d3dcompiler.h"
+#include "driver/shaders/dxbc/dxbc_compile.h"
 #include "driver/shaders/dxbc/dxbc_container.h"
 #include "strings/string_utils.h"
 
@@ -52,7 +53,7 @@ struct D3D12BlobShaderCallbacks
     return blobCreate;
   }
 
-  bool Create(uint32_t size, byte *data, ID3DBlob **ret) const
+  bool Create(uint32_t size, const byte *data, ID3DBlob **ret) const
   {
     RDCASSERT(ret);
 
@@ -106,26 +107,55 @@ struct EmbeddedD3D12Includer : public ID3DInclude
 };
 
 D3D12ShaderCache::D3D12ShaderCache()
+    : m_ShaderCache("d3dshaders.cache", m_ShaderCacheMagic, m_ShaderCacheVersion,
+                    D3D12ShaderCacheCallbacks),
+      m_UserShaderCache("d3dusershaders.cache", m_UserShaderCacheMagic, m_UserShaderCacheVersion,
+                        D3D12ShaderCacheCallbacks)
 {
-  bool success = LoadShaderCache("d3dshaders.cache", m_ShaderCacheMagic, m_ShaderCacheVersion,
-                                 m_ShaderCache, D3D12ShaderCacheCallbacks);
-
-  // if we failed to load from the cache
-  m_ShaderCacheDirty = !success;
+  m_ShaderCache.Load();
 }
 
 D3D12ShaderCache::~D3D12ShaderCache()
 {
-  if(m_ShaderCacheDirty)
+  // only new entries are written, appended to the existing cache
+  m_ShaderCache.Save();
+  m_UserShaderCache.Save();
+}
+
+rdcstr D3D12ShaderCache::GetUserShaderBlob(const char *source, const char *entry,
+                                           const uint32_t compileFlags, const char *profile,
+                                           ID3DBlob **srcblob)
+{
+  if(!m_UserShaderCacheLoaded)
   {
-    SaveShaderCache("d3dshaders.cache", m_ShaderCacheMagic, m_ShaderCacheVersion, m_ShaderCache,
-                    D3D12ShaderCacheCallbacks);
+    m_UserShaderCache.Load();
+    m_UserShaderCacheLoaded = true;
   }
-  else
+
+  uint64_t hash = ShaderCacheHash(source);
+  hash = ShaderCacheHash(entry, hash);
+  hash = ShaderCacheHash(profile, hash);
+  hash = ShaderCacheHash(&compileFlags, sizeof(compileFlags), hash);
+  hash = ShaderCacheHash(GetD3DCompilerIdentity().c_str(), hash);
+  // the embedded include files can change with each build
+  hash = ShaderCacheHash(GitVersionHash, hash);
+
+  if(m_UserShaderCache.Find(hash, *srcblob))
   {
-    for(auto it = m_ShaderCache.begin(); it != m_ShaderCache.end(); ++it)
-      D3D12ShaderCacheCallbacks.Destroy(it->second);
+    (*srcblob)->AddRef();
+    return "";
   }
+
+  rdcstr errors = GetShaderBlob(source, entry, compileFlags, profile, srcblob);
+
+  // only cache clean compiles, so that any warnings are still reported every time
+  if(*srcblob && errors.empty() && m_UserShaderCache.size() < m_UserShaderCacheMaxEntries)
+  {
+    m_UserShaderCache.Insert(hash, *srcblob);
+    (*srcblob)->AddRef();
+  }
+
+  return errors;
 }
 
 rdcstr D3D12ShaderCache::GetShaderBlob(const char *source, const char *entry,
@@ -134,16 +164,15 @@ rdcstr D3D12ShaderCache::GetShaderBlob(const char *source, const char *entry,
 {
   EmbeddedD3D12Includer includer;
 
-  uint32_t hash = strhash(source);
-  hash = strhash(entry, hash);
-  hash = strhash(profile, hash);
-  hash = strhash(includer.cbuffers.c_str(), hash);
-  hash = strhash(includer.texsample.c_str(), hash);
-  hash ^= compileFlags;
+  uint64_t hash = ShaderCacheHash(source);
+  hash = ShaderCacheHash(entry, hash);
+  hash = ShaderCacheHash(profile, hash);
+  hash = ShaderCacheHash(includer.cbuffers.c_str(), hash);
+  hash = ShaderCacheHash(includer.texsample.c_str(), hash);
+  hash = ShaderCacheHash(&compileFlags, sizeof(compileFlags), hash);
 
-  if(m_ShaderCache.find(hash) != m_ShaderCache.end())
+  if(m_ShaderCache.Find(hash, *srcblob))
   {
-    *srcblob = m_ShaderCache[hash];
     (*srcblob)->AddRef();
     return "";
   }
@@ -195,9 +224,8 @@ rdcstr D3D12ShaderCache::GetShaderBlob(const char *source, const char *entry,
 
   if(m_CacheShaders)
   {
-    m_ShaderCache[hash] = byteBlob;
+    m_ShaderCache.Insert(hash, byteBlob);
     byteBlob->AddRef();
-    m_ShaderCacheDirty = true;
   }
 
   SAFE_RELEASE(errBlob);
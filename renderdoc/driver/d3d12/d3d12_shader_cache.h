@@ -27,10 +27,12 @@
 #include <map>
 #include <string>
 #include <vector>
+#include "common/shader_cache.h"
 #include "driver/dx/official/d3d11_4.h"
 #include "d3d12_common.h"
 
 class WrappedID3D11Device;
+struct D3D12BlobShaderCallbacks;
 
 class D3D12ShaderCache
 {
@@ -40,6 +42,10 @@ public:
 
   rdcstr GetShaderBlob(const char *source, const char *entry, const uint32_t compileFlags,
                        const char *profile, ID3DBlob **srcblob);
+  // shaders compiled for shader editing and custom display are kept on disk between sessions,
+  // keyed by the source, entry point, profile, flags and the compiler used.
+  rdcstr GetUserShaderBlob(const char *source, const char *entry, const uint32_t compileFlags,
+                           const char *profile, ID3DBlob **srcblob);
 
   D3D12RootSignature GetRootSig(const void *data, size_t dataSize);
   ID3DBlob *MakeRootSig(const rdcarray<D3D12_ROOT_PARAMETER1> &params,
@@ -50,10 +56,31 @@ public:
   ID3DBlob *MakeFixedColShader(float overlayConsts[4]);
 
   void SetCaching(bool enabled) { m_CacheShaders = enabled; }
+  // the memory held by cached shaders loaded from disk
+  uint64_t GetMemoryUsage()
+  {
+    return m_ShaderCache.GetMemoryUsage() + m_UserShaderCache.GetMemoryUsage();
+  }
+  // releases the cache's references to shaders loaded from disk. Anything using them holds its own
+  // reference.
+  void EvictCachedData()
+  {
+    m_ShaderCache.EvictResults();
+    m_UserShaderCache.EvictResults();
+  }
+
 private:
   static const uint32_t m_ShaderCacheMagic = 0xf000baba;
-  static const uint32_t m_ShaderCacheVersion = 3;
+  static const uint32_t m_ShaderCacheVersion = 4;
+
+  static const uint32_t m_UserShaderCacheMagic = 0xf000b5e5;
+  static const uint32_t m_UserShaderCacheVersion = 1;
+  static const size_t m_UserShaderCacheMaxEntries = 1024;
+
+  bool m_CacheShaders = false;
+  ShaderCache<ID3DBlob *, D3D12BlobShaderCallbacks> m_ShaderCache;
 
-  bool m_ShaderCacheDirty = false, m_CacheShaders = false;
-  std::map<uint32_t, ID3DBlob *> m_ShaderCache;
+  // loaded on first use, only needed when editing shaders
+  bool m_UserShaderCacheLoaded = false;
+  ShaderCache<ID3DBlob *, D3D12BlobShaderCallbacks> m_UserShaderCache;
 };
@@ -91,7 +91,21 @@ public:
                              const uint8_t swizzle[4], DXBCDebug::GatherChannel gatherChannel,
                              const char *opString, ShaderVariable &output);
 
+  void CalculateMathIntrinsics(rdcarray<DXBCDebug::MathIntrinsicRequest> &requests);
+  void CalculateSampleGathers(rdcarray<DXBCDebug::SampleGatherRequest> &requests);
+
 private:
+  bool MakeSampleGatherShaders(DXBCBytecode::OpcodeType opcode,
+                               DXBCDebug::SampleGatherResourceData resourceData,
+                               DXBCDebug::SampleGatherSamplerData samplerData, ShaderVariable uv,
+                               ShaderVariable ddxCalc, ShaderVariable ddyCalc,
+                               const int texelOffsets[3], int multisampleIndex,
+                               float lodOrCompareValue, const uint8_t swizzle[4],
+                               DXBCDebug::GatherChannel gatherChannel, const char *opString,
+                               DXBCDebug::SampleGatherShaders &shaders, DXGI_FORMAT &retFmt);
+  bool RenderSampleGather(const rdcstr &vsProgram, const rdcstr &psProgram, DXGI_FORMAT retFmt,
+                          uint32_t count, rdcarray<ShaderVariable> &results);
+
   DXBC::ShaderType GetShaderType() { return m_dxbc ? m_dxbc->m_Type : DXBC::ShaderType::Pixel; }
   WrappedID3D12Device *m_pDevice;
   const DXBC::DXBCContainer *m_dxbc;
@@ -402,17 +416,42 @@ bool D3D12DebugAPIWrapper::FetchUAV(const DXBCDebug::BindingSlot &slot)
 bool D3D12DebugAPIWrapper::CalculateMathIntrinsic(DXBCBytecode::OpcodeType opcode,
                                                   const ShaderVariable &input,
                                                   ShaderVariable &output1, ShaderVariable &output2)
+{
+  rdcarray<DXBCDebug::MathIntrinsicRequest> requests;
+  requests.resize(1);
+  requests[0].opcode = opcode;
+  requests[0].input = input;
+
+  CalculateMathIntrinsics(requests);
+
+  output1 = requests[0].output1;
+  output2 = requests[0].output2;
+  return requests[0].succeeded;
+}
+
+void D3D12DebugAPIWrapper::CalculateMathIntrinsics(
+    rdcarray<DXBCDebug::MathIntrinsicRequest> &requests)
 {
   D3D12MarkerRegion region(m_pDevice->GetQueue()->GetReal(), "CalculateMathIntrinsic");
 
-  if(opcode != DXBCBytecode::OPCODE_RCP && opcode != DXBCBytecode::OPCODE_RSQ &&
-     opcode != DXBCBytecode::OPCODE_EXP && opcode != DXBCBytecode::OPCODE_LOG &&
-     opcode != DXBCBytecode::OPCODE_SINCOS)
+  rdcarray<size_t> batch;
+
+  for(size_t i = 0; i < requests.size(); i++)
   {
-    // To support a new instruction, the shader created in
-    // D3D12DebugManager::CreateMathIntrinsicsResources will need updated
-    RDCERR("Unsupported instruction for CalculateMathIntrinsic: %u", opcode);
-    return false;
+    DXBCBytecode::OpcodeType opcode = requests[i].opcode;
+    requests[i].succeeded = false;
+
+    if(opcode != DXBCBytecode::OPCODE_RCP && opcode != DXBCBytecode::OPCODE_RSQ &&
+       opcode != DXBCBytecode::OPCODE_EXP && opcode != DXBCBytecode::OPCODE_LOG &&
+       opcode != DXBCBytecode::OPCODE_SINCOS)
+    {
+      // To support a new instruction, the shader created in
+      // D3D12DebugManager::CreateMathIntrinsicsResources will need updated
+      RDCERR("Unsupported instruction for CalculateMathIntrinsic: %u", opcode);
+      continue;
+    }
+
+    batch.push_back(i);
   }
 
   // Create UAV to store the computed results
@@ -420,44 +459,64 @@ bool D3D12DebugAPIWrapper::CalculateMathIntrinsic(DXBCBytecode::OpcodeType opcod
   ZeroMemory(&uavDesc, sizeof(D3D12_UNORDERED_ACCESS_VIEW_DESC));
   uavDesc.Format = DXGI_FORMAT_UNKNOWN;
   uavDesc.ViewDimension = D3D12_UAV_DIMENSION_BUFFER;
-  uavDesc.Buffer.NumElements = 2;
+  uavDesc.Buffer.NumElements = 2 * DXBCDebug::MaxMathIntrinsicBatch;
   uavDesc.Buffer.StructureByteStride = sizeof(float) * 4;
 
   ID3D12Resource *pResultBuffer = m_pDevice->GetDebugManager()->GetMathIntrinsicsResultBuffer();
   D3D12_CPU_DESCRIPTOR_HANDLE uav = m_pDevice->GetDebugManager()->GetCPUHandle(SHADER_DEBUG_UAV);
   m_pDevice->CreateUnorderedAccessView(pResultBuffer, NULL, &uavDesc, uav);
 
-  // Set root signature & sig params on command list, then execute the shader
-  ID3D12GraphicsCommandListX *cmdList = m_pDevice->GetDebugManager()->ResetDebugList();
-  m_pDevice->GetDebugManager()->SetDescriptorHeaps(cmdList, true, false);
-  cmdList->SetPipelineState(m_pDevice->GetDebugManager()->GetMathIntrinsicsPso());
-  cmdList->SetComputeRootSignature(m_pDevice->GetDebugManager()->GetMathIntrinsicsRootSig());
-  cmdList->SetComputeRoot32BitConstants(0, 4, &input.value.uv[0], 0);
-  cmdList->SetComputeRoot32BitConstants(1, 1, &opcode, 0);
-  cmdList->SetComputeRootUnorderedAccessView(2, pResultBuffer->GetGPUVirtualAddress());
-  cmdList->Dispatch(1, 1, 1);
-
-  HRESULT hr = cmdList->Close();
-  if(FAILED(hr))
-  {
-    RDCERR("Failed to close command list HRESULT: %s", ToStr(hr).c_str());
-    return false;
-  }
+  const UINT64 resultStride = sizeof(float) * 4 * 2;
 
+  // record a dispatch for each operation, each writing to its own results, so that a whole batch
+  // only needs one submit and readback
+  for(size_t first = 0; first < batch.size(); first += DXBCDebug::MaxMathIntrinsicBatch)
   {
-    ID3D12CommandList *l = cmdList;
-    m_pDevice->GetQueue()->ExecuteCommandLists(1, &l);
-    m_pDevice->GPUSync();
-  }
+    size_t count = RDCMIN(batch.size() - first, (size_t)DXBCDebug::MaxMathIntrinsicBatch);
 
-  bytebuf results;
-  m_pDevice->GetDebugManager()->GetBufferData(pResultBuffer, 0, 0, results);
-  RDCASSERT(results.size() >= sizeof(uint32_t) * 8);
+    // Set root signature & sig params on command list, then execute the shader
+    ID3D12GraphicsCommandListX *cmdList = m_pDevice->GetDebugManager()->ResetDebugList();
+    m_pDevice->GetDebugManager()->SetDescriptorHeaps(cmdList, true, false);
+    cmdList->SetPipelineState(m_pDevice->GetDebugManager()->GetMathIntrinsicsPso());
+    cmdList->SetComputeRootSignature(m_pDevice->GetDebugManager()->GetMathIntrinsicsRootSig());
 
-  memcpy(output1.value.uv, results.data(), sizeof(uint32_t) * 4);
-  memcpy(output2.value.uv, results.data() + 4, sizeof(uint32_t) * 4);
+    for(size_t i = 0; i < count; i++)
+    {
+      const DXBCDebug::MathIntrinsicRequest &req = requests[batch[first + i]];
+      cmdList->SetComputeRoot32BitConstants(0, 4, &req.input.value.uv[0], 0);
+      cmdList->SetComputeRoot32BitConstants(1, 1, &req.opcode, 0);
+      cmdList->SetComputeRootUnorderedAccessView(
+          2, pResultBuffer->GetGPUVirtualAddress() + resultStride * i);
+      cmdList->Dispatch(1, 1, 1);
+    }
 
-  return true;
+    HRESULT hr = cmdList->Close();
+    if(FAILED(hr))
+    {
+      RDCERR("Failed to close command list HRESULT: %s", ToStr(hr).c_str());
+      return;
+    }
+
+    {
+      ID3D12CommandList *l = cmdList;
+      m_pDevice->GetQueue()->ExecuteCommandLists(1, &l);
+      m_pDevice->GPUSync();
+    }
+
+    bytebuf results;
+    m_pDevice->GetDebugManager()->GetBufferData(pResultBuffer, 0, resultStride * count, results);
+    RDCASSERT(results.size() >= resultStride * count);
+
+    for(size_t i = 0; i < count && resultStride * (i + 1) <= results.size(); i++)
+    {
+      DXBCDebug::MathIntrinsicRequest &req = requests[batch[first + i]];
+
+      memcpy(req.output1.value.uv, results.data() + resultStride * i, sizeof(uint32_t) * 4);
+      memcpy(req.output2.value.uv, results.data() + resultStride * i + sizeof(uint32_t) * 4,
+             sizeof(uint32_t) * 4);
+      req.succeeded = true;
+    }
+  }
 }
 
 ShaderVariable D3D12DebugAPIWrapper::GetSampleInfo(DXBCBytecode::OperandType type,
@@ -1021,19 +1080,17 @@ ShaderVariable D3D12DebugAPIWrapper::GetResourceInfo(DXBCBytecode::OperandType t
   return result;
 }
 
-bool D3D12DebugAPIWrapper::CalculateSampleGather(
+bool D3D12DebugAPIWrapper::MakeSampleGatherShaders(
     DXBCBytecode::OpcodeType opcode, DXBCDebug::SampleGatherResourceData resourceData,
     DXBCDebug::SampleGatherSamplerData samplerData, ShaderVariable uv, ShaderVariable ddxCalc,
     ShaderVariable ddyCalc, const int texelOffsets[3], int multisampleIndex,
     float lodOrCompareValue, const uint8_t swizzle[4], DXBCDebug::GatherChannel gatherChannel,
-    const char *opString, ShaderVariable &output)
+    const char *opString, DXBCDebug::SampleGatherShaders &shaders, DXGI_FORMAT &retFmt)
 {
   using namespace DXBCBytecode;
 
-  D3D12MarkerRegion region(m_pDevice->GetQueue()->GetReal(), "CalculateSampleGather");
-
   rdcstr funcRet = "";
-  DXGI_FORMAT retFmt = DXGI_FORMAT_UNKNOWN;
+  retFmt = DXGI_FORMAT_UNKNOWN;
 
   if(opcode == OPCODE_SAMPLE_C || opcode == OPCODE_SAMPLE_C_LZ || opcode == OPCODE_GATHER4_C ||
      opcode == OPCODE_GATHER4_PO_C || opcode == OPCODE_LOD)
@@ -1293,13 +1350,23 @@ bool D3D12DebugAPIWrapper::CalculateSampleGather(
   vsProgram += "return float4((id == 2) ? 3.0f : -1.0f, (id == 0) ? -3.0f : 1.0f, 0.5, 1.0);\n";
   vsProgram += "}";
 
-  rdcstr sampleProgram;
-
   rdcstr strResourceBinding = StringFormat::Fmt("t%u, space%u", resourceData.binding.shaderRegister,
                                                 resourceData.binding.registerSpace);
   rdcstr strSamplerBinding = StringFormat::Fmt("s%u, space%u", samplerData.binding.shaderRegister,
                                                samplerData.binding.registerSpace);
 
+  rdcstr decls =
+      StringFormat::Fmt("%s : register(%s);\n", textureDecl.c_str(), strResourceBinding.c_str());
+  if(opcode != OPCODE_LD && opcode != OPCODE_LD_MS)
+    decls +=
+        StringFormat::Fmt("%s : register(%s);\n", samplerDecl.c_str(), strSamplerBinding.c_str());
+  decls += "\n";
+
+  shaders.retFmt = retFmt;
+  shaders.funcRet = funcRet;
+  shaders.decls = decls;
+  shaders.vsProgram = vsProgram;
+
   if(opcode == OPCODE_SAMPLE || opcode == OPCODE_SAMPLE_B || opcode == OPCODE_SAMPLE_D)
   {
     rdcstr ddx;
@@ -1320,29 +1387,20 @@ bool D3D12DebugAPIWrapper::CalculateSampleGather(
       ddy = StringFormat::Fmt(formats[offsetDim + texdimOffs - 1][ddyType], ddyCalc.value.i.x,
                               ddyCalc.value.i.y, ddyCalc.value.i.z, ddyCalc.value.i.w);
 
-    sampleProgram = StringFormat::Fmt("%s : register(%s);\n%s : register(%s);\n\n",
-                                      textureDecl.c_str(), strResourceBinding.c_str(),
-                                      samplerDecl.c_str(), strSamplerBinding.c_str());
-    sampleProgram += funcRet + " main() : SV_Target0\n{\nreturn ";
-    sampleProgram += StringFormat::Fmt("t.SampleGrad(s, %s, %s, %s %s)%s;\n", texcoords.c_str(),
-                                       ddx.c_str(), ddy.c_str(), offsets.c_str(), strSwizzle.c_str());
-    sampleProgram += "}\n";
+    shaders.lookup =
+        StringFormat::Fmt("return t.SampleGrad(s, %s, %s, %s %s)%s;\n", texcoords.c_str(),
+                          ddx.c_str(), ddy.c_str(), offsets.c_str(), strSwizzle.c_str());
   }
   else if(opcode == OPCODE_SAMPLE_L)
   {
-    // lod selection
-    sampleProgram = StringFormat::Fmt("%s : register(%s);\n%s : register(%s);\n\n",
-                                      textureDecl.c_str(), strResourceBinding.c_str(),
-                                      samplerDecl.c_str(), strSamplerBinding.c_str());
-    sampleProgram += funcRet + " main() : SV_Target0\n{\nreturn ";
-    sampleProgram += StringFormat::Fmt("t.SampleLevel(s, %s, %.10f %s)%s;\n", texcoords.c_str(),
-                                       lodOrCompareValue, offsets.c_str(), strSwizzle.c_str());
-    sampleProgram += "}\n";
+    shaders.lookup =
+        StringFormat::Fmt("return t.SampleLevel(s, %s, %.10f %s)%s;\n", texcoords.c_str(),
+                          lodOrCompareValue, offsets.c_str(), strSwizzle.c_str());
   }
   else if(opcode == OPCODE_SAMPLE_C || opcode == OPCODE_LOD)
   {
     // these operations need derivatives but have no hlsl function to call to provide them, so
-    // we fake it in the vertex shader
+    // we fake it in the vertex shader. That means they need their own shaders and can't be batched
 
     rdcstr uvdecl = StringFormat::Fmt("float%d uv : uvs", texdim + texdimOffs);
 
@@ -1365,84 +1423,64 @@ bool D3D12DebugAPIWrapper::CalculateSampleGather(
     vsProgram += "pos = float4((id == 2) ? 3.0f : -1.0f, (id == 0) ? -3.0f : 1.0f, 0.5, 1.0);\n";
     vsProgram += "}";
 
+    shaders.vsProgram = vsProgram;
+
     if(opcode == OPCODE_SAMPLE_C)
     {
-      // comparison value
-      sampleProgram = StringFormat::Fmt("%s : register(%s);\n%s : register(%s);\n\n",
-                                        textureDecl.c_str(), strResourceBinding.c_str(),
-                                        samplerDecl.c_str(), strSamplerBinding.c_str());
-      sampleProgram +=
+      shaders.psProgram = decls;
+      shaders.psProgram +=
           funcRet + " main(float4 pos : SV_Position, " + uvdecl + ") : SV_Target0\n{\n";
-      sampleProgram += StringFormat::Fmt("t.SampleCmpLevelZero(s, uv, %.10f %s).xxxx;\n",
-                                         lodOrCompareValue, offsets.c_str());
-      sampleProgram += "}\n";
+      shaders.psProgram += StringFormat::Fmt("return t.SampleCmpLevelZero(s, uv, %.10f %s).xxxx;\n",
+                                             lodOrCompareValue, offsets.c_str());
+      shaders.psProgram += "}\n";
     }
     else if(opcode == OPCODE_LOD)
     {
-      sampleProgram = StringFormat::Fmt("%s : register(%s);\n%s : register(%s);\n\n",
-                                        textureDecl.c_str(), strResourceBinding.c_str(),
-                                        samplerDecl.c_str(), strSamplerBinding.c_str());
-      sampleProgram +=
+      shaders.psProgram = decls;
+      shaders.psProgram +=
           funcRet + " main(float4 pos : SV_Position, " + uvdecl + ") : SV_Target0\n{\n";
-      sampleProgram +=
+      shaders.psProgram +=
           "return float4(t.CalculateLevelOfDetail(s, uv),\n"
           "              t.CalculateLevelOfDetailUnclamped(s, uv),\n"
           "              0.0f, 0.0f);\n";
-      sampleProgram += "}\n";
+      shaders.psProgram += "}\n";
     }
   }
   else if(opcode == OPCODE_SAMPLE_C_LZ)
   {
-    // comparison value
-    sampleProgram = StringFormat::Fmt("%s : register(%s);\n%s : register(%s);\n\n",
-                                      textureDecl.c_str(), strResourceBinding.c_str(),
-                                      samplerDecl.c_str(), strSamplerBinding.c_str());
-    sampleProgram += funcRet + " main() : SV_Target0\n{\n";
-    sampleProgram +=
+    shaders.lookup =
         StringFormat::Fmt("return t.SampleCmpLevelZero(s, %s, %.10f %s)%s;\n", texcoords.c_str(),
                           lodOrCompareValue, offsets.c_str(), strSwizzle.c_str());
-    sampleProgram += "}\n";
   }
   else if(opcode == OPCODE_LD)
   {
-    sampleProgram =
-        StringFormat::Fmt("%s : register(%s);\n\n", textureDecl.c_str(), strResourceBinding.c_str());
-    sampleProgram += funcRet + " main() : SV_Target0\n{\n";
-    sampleProgram += "return t.Load(" + texcoords + offsets + ")" + strSwizzle + ";";
-    sampleProgram += "\n}\n";
+    shaders.lookup = "return t.Load(" + texcoords + offsets + ")" + strSwizzle + ";\n";
   }
   else if(opcode == OPCODE_LD_MS)
   {
-    sampleProgram =
-        StringFormat::Fmt("%s : register(%s);\n\n", textureDecl.c_str(), strResourceBinding.c_str());
-    sampleProgram += funcRet + " main() : SV_Target0\n{\n";
-    sampleProgram += StringFormat::Fmt("return t.Load(%s, int(%d) %s)%s;\n", texcoords.c_str(),
+    shaders.lookup = StringFormat::Fmt("return t.Load(%s, int(%d) %s)%s;\n", texcoords.c_str(),
                                        multisampleIndex, offsets.c_str(), strSwizzle.c_str());
-    sampleProgram += "\n}\n";
   }
   else if(opcode == OPCODE_GATHER4 || opcode == OPCODE_GATHER4_PO)
   {
-    sampleProgram = StringFormat::Fmt("%s : register(%s);\n%s : register(%s);\n\n",
-                                      textureDecl.c_str(), strResourceBinding.c_str(),
-                                      samplerDecl.c_str(), strSamplerBinding.c_str());
-    sampleProgram += funcRet + " main() : SV_Target0\n{\n";
-    sampleProgram += StringFormat::Fmt("return t.Gather%s(s, %s %s)%s;\n", strGatherChannel.c_str(),
-                                       texcoords.c_str(), offsets.c_str(), strSwizzle.c_str());
-    sampleProgram += "}\n";
+    shaders.lookup =
+        StringFormat::Fmt("return t.Gather%s(s, %s %s)%s;\n", strGatherChannel.c_str(),
+                          texcoords.c_str(), offsets.c_str(), strSwizzle.c_str());
   }
   else if(opcode == OPCODE_GATHER4_C || opcode == OPCODE_GATHER4_PO_C)
   {
-    // comparison value
-    sampleProgram = StringFormat::Fmt("%s : register(%s);\n%s : register(%s);\n\n",
-                                      textureDecl.c_str(), strResourceBinding.c_str(),
-                                      samplerDecl.c_str(), strSamplerBinding.c_str());
-    sampleProgram += funcRet + " main() : SV_Target0\n{\n";
-    sampleProgram += StringFormat::Fmt("return t.GatherCmp%s(s, %s, %.10f %s)%s;\n",
+    shaders.lookup = StringFormat::Fmt("return t.GatherCmp%s(s, %s, %.10f %s)%s;\n",
                                        strGatherChannel.c_str(), texcoords.c_str(),
                                        lodOrCompareValue, offsets.c_str(), strSwizzle.c_str());
-    sampleProgram += "}\n";
   }
 
+  return !shaders.lookup.empty() || !shaders.psProgram.empty();
+}
+
+bool D3D12DebugAPIWrapper::RenderSampleGather(const rdcstr &vsProgram, const rdcstr &psProgram,
+                                              DXGI_FORMAT retFmt, uint32_t count,
+                                              rdcarray<ShaderVariable> &results)
+{
   // Create VS/PS to fetch the sample. Because the program being debugged might be using SM 5.1, we
   // need to do that too, to support reusing the existing root signature that may use a non-zero
   // register space for the resource or sampler.
@@ -1455,7 +1493,7 @@ bool D3D12DebugAPIWrapper::CalculateSampleGather(
     RDCERR("Failed to create shader to extract inputs");
     return false;
   }
-  if(m_pDevice->GetShaderCache()->GetShaderBlob(sampleProgram.c_str(), "main", flags, "ps_5_1",
+  if(m_pDevice->GetShaderCache()->GetShaderBlob(psProgram.c_str(), "main", flags, "ps_5_1",
                                                 &psBlob) != "")
   {
     RDCERR("Failed to create shader to extract inputs");
@@ -1510,11 +1548,12 @@ bool D3D12DebugAPIWrapper::CalculateSampleGather(
   rs.pipe = GetResID(samplePso);
   rs.rts.clear();
   // Set viewport/scissor unconditionally - we need to set this all the time for sampling for a
-  // compute shader, but also a graphics draw might exclude pixel (0, 0) from its view or scissor
+  // compute shader, but also a graphics draw might exclude pixel (0, 0) from its view or scissor.
+  // Each lookup is evaluated in its own pixel along a row.
   rs.views.clear();
-  rs.views.push_back({0, 0, 1, 1, 0, 1});
+  rs.views.push_back({0, 0, (float)count, 1, 0, 1});
   rs.scissors.clear();
-  rs.scissors.push_back({0, 0, 1, 1});
+  rs.scissors.push_back({0, 0, (LONG)count, 1});
   if(isCompute)
   {
     // When debugging compute, we need to move the root sig and elems to the graphics portion
@@ -1526,11 +1565,11 @@ bool D3D12DebugAPIWrapper::CalculateSampleGather(
   rs.topo = D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
   rs.ApplyState(m_pDevice, cmdList);
 
-  // Create a 1x1 texture to store the sample result
+  // Create a countx1 texture to store the sample results
   D3D12_RESOURCE_DESC rdesc;
   ZeroMemory(&rdesc, sizeof(D3D12_RESOURCE_DESC));
   rdesc.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
-  rdesc.Width = 1;
+  rdesc.Width = count;
   rdesc.Height = 1;
   rdesc.DepthOrArraySize = 1;
   rdesc.MipLevels = 0;
@@ -1583,10 +1622,15 @@ bool D3D12DebugAPIWrapper::CalculateSampleGather(
   m_pDevice->GetReplay()->GetTextureData(GetResID(pSampleResult), Subresource(),
                                          GetTextureDataParams(), sampleResult);
 
-  ShaderVariable lookupResult("tex", 0.0f, 0.0f, 0.0f, 0.0f);
-  memcpy(lookupResult.value.iv, sampleResult.data(),
-         RDCMIN(sampleResult.size(), sizeof(uint32_t) * 4));
-  output = lookupResult;
+  results.resize(count);
+  for(uint32_t i = 0; i < count; i++)
+  {
+    const size_t offs = i * sizeof(uint32_t) * 4;
+    results[i] = ShaderVariable("tex", 0.0f, 0.0f, 0.0f, 0.0f);
+    if(offs < sampleResult.size())
+      memcpy(results[i].value.iv, sampleResult.data() + offs,
+             RDCMIN(sampleResult.size() - offs, sizeof(uint32_t) * 4));
+  }
 
   SAFE_RELEASE(samplePso);
   SAFE_RELEASE(pSampleResult);
@@ -1594,6 +1638,88 @@ bool D3D12DebugAPIWrapper::CalculateSampleGather(
   return true;
 }
 
+bool D3D12DebugAPIWrapper::CalculateSampleGather(
+    DXBCBytecode::OpcodeType opcode, DXBCDebug::SampleGatherResourceData resourceData,
+    DXBCDebug::SampleGatherSamplerData samplerData, ShaderVariable uv, ShaderVariable ddxCalc,
+    ShaderVariable ddyCalc, const int texelOffsets[3], int multisampleIndex,
+    float lodOrCompareValue, const uint8_t swizzle[4], DXBCDebug::GatherChannel gatherChannel,
+    const char *opString, ShaderVariable &output)
+{
+  D3D12MarkerRegion region(m_pDevice->GetQueue()->GetReal(), "CalculateSampleGather");
+
+  DXBCDebug::SampleGatherShaders shaders;
+  DXGI_FORMAT retFmt = DXGI_FORMAT_UNKNOWN;
+  if(!MakeSampleGatherShaders(opcode, resourceData, samplerData, uv, ddxCalc, ddyCalc,
+                              texelOffsets, multisampleIndex, lodOrCompareValue, swizzle,
+                              gatherChannel, opString, shaders, retFmt))
+    return false;
+
+  rdcarray<ShaderVariable> results;
+  if(!RenderSampleGather(shaders.vsProgram, shaders.GetPixelShader(), retFmt, 1, results))
+    return false;
+
+  output = results[0];
+  return true;
+}
+
+void D3D12DebugAPIWrapper::CalculateSampleGathers(
+    rdcarray<DXBCDebug::SampleGatherRequest> &requests)
+{
+  D3D12MarkerRegion region(m_pDevice->GetQueue()->GetReal(), "CalculateSampleGathers");
+
+  rdcarray<DXBCDebug::SampleGatherShaders> shaders;
+  rdcarray<DXGI_FORMAT> retFmts;
+  shaders.resize(requests.size());
+  retFmts.resize(requests.size());
+
+  for(size_t i = 0; i < requests.size(); i++)
+  {
+    DXBCDebug::SampleGatherRequest &req = requests[i];
+    req.succeeded = MakeSampleGatherShaders(
+        req.opcode, req.resourceData, req.samplerData, req.uv, req.ddxCalc, req.ddyCalc,
+        req.texelOffsets, req.multisampleIndex, req.lodOrCompareValue, req.swizzle,
+        req.gatherChannel, req.opString.c_str(), shaders[i], retFmts[i]);
+  }
+
+  rdcarray<bool> done;
+  done.fill(requests.size(), false);
+
+  for(size_t i = 0; i < requests.size(); i++)
+  {
+    if(done[i] || !requests[i].succeeded)
+      continue;
+
+    // gather every other lookup that can share this one's shader, to evaluate them in one draw
+    rdcarray<size_t> batch = {i};
+    rdcarray<const DXBCDebug::SampleGatherShaders *> batchShaders = {&shaders[i]};
+    done[i] = true;
+
+    for(size_t j = i + 1; j < requests.size() && batch.size() < DXBCDebug::MaxSampleGatherBatch;
+        j++)
+    {
+      if(!done[j] && requests[j].succeeded &&
+         DXBCDebug::CanBatchSampleGathers(requests[i], shaders[i], requests[j], shaders[j]))
+      {
+        batch.push_back(j);
+        batchShaders.push_back(&shaders[j]);
+        done[j] = true;
+      }
+    }
+
+    rdcarray<ShaderVariable> results;
+    bool success = RenderSampleGather(shaders[i].vsProgram,
+                                      DXBCDebug::MakeBatchedSampleGatherShader(batchShaders),
+                                      retFmts[i], (uint32_t)batch.size(), results);
+
+    for(size_t b = 0; b < batch.size(); b++)
+    {
+      requests[batch[b]].succeeded = success;
+      if(success)
+        requests[batch[b]].output = results[b];
+    }
+  }
+}
+
 void GatherConstantBuffers(WrappedID3D12Device *pDevice, const DXBCBytecode::Program &program,
                            const D3D12RenderState::RootSignature &rootsig,
                            const ShaderReflection &refl, const ShaderBindpointMapping &mapping,
@@ -417,14 +417,16 @@ T CheckConstParam(T t);
   template bool WrappedOpenGL::CONCAT(Serialise_, func(ReadSerialiser &ser, ##__VA_ARGS__)); \
   template bool WrappedOpenGL::CONCAT(Serialise_, func(WriteSerialiser &ser, ##__VA_ARGS__));
 
-#define USE_SCRATCH_SERIALISER() WriteSerialiser &ser = m_ScratchSerialiser;
-
-#define SERIALISE_TIME_CALL(...)                                                                    \
-  m_ScratchSerialiser.ChunkMetadata().timestampMicro = RenderDoc::Inst().GetMicrosecondTimestamp(); \
-  __VA_ARGS__;                                                                                      \
-  m_ScratchSerialiser.ChunkMetadata().durationMicro =                                               \
-      RenderDoc::Inst().GetMicrosecondTimestamp() -                                                 \
-      m_ScratchSerialiser.ChunkMetadata().timestampMicro;
+#define USE_SCRATCH_SERIALISER() WriteSerialiser &ser = GetThreadSerialiser();
+
+#define SERIALISE_TIME_CALL(...)                                                          \
+  {                                                                                       \
+    WriteSerialiser &ser = GetThreadSerialiser();                                         \
+    ser.ChunkMetadata().timestampMicro = RenderDoc::Inst().GetMicrosecondTimestamp();     \
+    __VA_ARGS__;                                                                          \
+    ser.ChunkMetadata().durationMicro =                                                   \
+        RenderDoc::Inst().GetMicrosecondTimestamp() - ser.ChunkMetadata().timestampMicro; \
+  }
 
 // A handy macros to say "is the serialiser reading and we're doing replay-mode stuff?"
 // The reason we check both is that checking the first allows the compiler to eliminate the other
@@ -732,6 +734,7 @@ extern bool IsGLES;
   EXT_TO_CHECK(43, 99, ARB_texture_view)                         \
   EXT_TO_CHECK(43, 31, ARB_vertex_attrib_binding)                \
   EXT_TO_CHECK(43, 32, KHR_debug)                                \
+  EXT_TO_CHECK(44, 99, ARB_buffer_storage)                       \
   EXT_TO_CHECK(44, 99, ARB_enhanced_layouts)                     \
   EXT_TO_CHECK(44, 99, ARB_query_buffer_object)                  \
   EXT_TO_CHECK(45, 99, ARB_clip_control)                         \
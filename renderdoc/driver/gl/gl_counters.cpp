@@ -463,6 +463,8 @@ rdcarray<CounterResult> GLReplay::FetchCountersIntel(const rdcarray<GPUCounter>
 
 rdcarray<CounterResult> GLReplay::FetchCounters(const rdcarray<GPUCounter> &allCounters)
 {
+  RDCPROFILE_ZONE("GLReplay::FetchCounters");
+
   rdcarray<CounterResult> ret;
 
   if(allCounters.empty())
@@ -899,6 +899,7 @@ void GLReplay::InitDebugData()
     // sized/created on demand
     DebugData.pickVBBuf = DebugData.pickIBBuf = 0;
     DebugData.pickVBSize = DebugData.pickIBSize = 0;
+    DebugData.pickCacheValid = false;
   }
 
   drv.glGenVertexArrays(1, &DebugData.meshVAO);
@@ -1913,6 +1914,16 @@ bool GLReplay::GetHistogram(ResourceId texid, const Subresource &sub, CompType t
   return true;
 }
 
+static bool SamePickMesh(const MeshFormat &a, const MeshFormat &b)
+{
+  return a.indexResourceId == b.indexResourceId && a.indexByteOffset == b.indexByteOffset &&
+         a.indexByteStride == b.indexByteStride && a.baseVertex == b.baseVertex &&
+         a.vertexResourceId == b.vertexResourceId && a.vertexByteOffset == b.vertexByteOffset &&
+         a.vertexByteStride == b.vertexByteStride && a.format == b.format &&
+         a.topology == b.topology && a.numIndices == b.numIndices &&
+         a.restartIndex == b.restartIndex && a.allowRestart == b.allowRestart;
+}
+
 uint32_t GLReplay::PickVertex(uint32_t eventId, int32_t width, int32_t height,
                               const MeshDisplay &cfg, uint32_t x, uint32_t y)
 {
@@ -2011,10 +2022,19 @@ uint32_t GLReplay::PickVertex(uint32_t eventId, int32_t width, int32_t height,
       (cfg.position.topology == Topology::TriangleFan && cfg.position.allowRestart);
   uint32_t numIndices = cfg.position.numIndices;
 
+  // picking is repeated many times on the same mesh, e.g. while dragging to select, and the data
+  // can only change with the event or the mesh being displayed. If neither has changed since the
+  // last pick, the buffers already hold the converted data so skip reading back and uploading.
+  const bool pickDataCached = DebugData.pickCacheValid && DebugData.pickCacheEventId == eventId &&
+                              SamePickMesh(DebugData.pickCacheFormat, cfg.position);
+
+  if(pickDataCached)
+    numIndices = DebugData.pickCacheNumIndices;
+
   // We copy into our own buffers to promote to the target type (uint32) that the shader expects.
   // Most IBs will be 16-bit indices, most VBs will not be float4. We also apply baseVertex here
 
-  if(ib)
+  if(ib && !pickDataCached)
   {
     rdcarray<uint32_t> idxtmp;
 
@@ -2168,6 +2188,7 @@ uint32_t GLReplay::PickVertex(uint32_t eventId, int32_t width, int32_t height,
   }
 
   // unpack and linearise the data
+  if(!pickDataCached)
   {
     bytebuf oldData;
     GetBufferData(cfg.position.vertexResourceId, cfg.position.vertexByteOffset, 0, oldData);
@@ -2205,6 +2226,11 @@ uint32_t GLReplay::PickVertex(uint32_t eventId, int32_t width, int32_t height,
 
     drv.glBindBuffer(eGL_SHADER_STORAGE_BUFFER, DebugData.pickVBBuf);
     drv.glBufferSubData(eGL_SHADER_STORAGE_BUFFER, 0, (maxIndex + 1) * sizeof(Vec4f), vbData.data());
+
+    DebugData.pickCacheValid = true;
+    DebugData.pickCacheEventId = eventId;
+    DebugData.pickCacheFormat = cfg.position;
+    DebugData.pickCacheNumIndices = numIndices;
   }
 
   drv.glBindBufferBase(eGL_UNIFORM_BUFFER, 0, DebugData.UBOs[0]);
@@ -25,6 +25,7 @@
 
 #include "gl_driver.h"
 #include <algorithm>
+#include "api/replay/version.h"
 #include "common/common.h"
 #include "driver/shaders/spirv/spirv_compile.h"
 #include "jpeg-compressor/jpge.h"
@@ -605,8 +606,26 @@ void WrappedOpenGL::BuildGLESExtensions()
   ************************************************************************/
 }
 
+struct GLReflectionCacheCallbacks
+{
+  bool Create(uint32_t size, const byte *data, bytebuf **ret) const
+  {
+    RDCASSERT(ret);
+
+    *ret = new bytebuf(data, size);
+
+    return true;
+  }
+
+  void Destroy(bytebuf *blob) const { delete blob; }
+  uint32_t GetSize(bytebuf *blob) const { return (uint32_t)blob->size(); }
+  const byte *GetData(bytebuf *blob) const { return blob->data(); }
+} GLReflectionCacheCallbacks;
+
 WrappedOpenGL::WrappedOpenGL(GLPlatform &platform)
-    : m_Platform(platform), m_ScratchSerialiser(new StreamWriter(1024), Ownership::Stream)
+    : m_Platform(platform),
+      m_ReflectionCache("glreflection.cache", m_ReflectionCacheMagic, m_ReflectionCacheVersion,
+                        GLReflectionCacheCallbacks)
 {
   if(RenderDoc::Inst().GetCrashHandler())
     RenderDoc::Inst().GetCrashHandler()->RegisterMemoryRegion(this, sizeof(WrappedOpenGL));
@@ -626,8 +645,11 @@ WrappedOpenGL::WrappedOpenGL(GLPlatform &platform)
   if(RenderDoc::Inst().GetCaptureOptions().captureCallstacks)
     flags |= WriteSerialiser::ChunkCallstack;
 
-  m_ScratchSerialiser.SetChunkMetadataRecording(flags);
-  m_ScratchSerialiser.SetVersion(GLInitParams::CurrentVersion);
+  m_ChunkMetadataFlags = flags;
+
+  m_ThreadSerialiserTLSSlot = Threading::AllocateTLSSlot();
+
+  m_WatchCoherentMapWrites = RenderDoc::Inst().GetCaptureOptions().watchCoherentMapWrites;
 
   m_SectionVersion = GLInitParams::CurrentVersion;
 
@@ -668,8 +690,6 @@ WrappedOpenGL::WrappedOpenGL(GLPlatform &platform)
 
   m_ResourceManager = new GLResourceManager(m_State, this);
 
-  m_ScratchSerialiser.SetUserData(GetResourceManager());
-
   m_DeviceResourceID =
       GetResourceManager()->RegisterResource(GLResource(NULL, eResSpecial, eSpecialResDevice));
   m_ContextResourceID =
@@ -686,6 +706,7 @@ WrappedOpenGL::WrappedOpenGL(GLPlatform &platform)
     m_ContextRecord->DataInSerialiser = false;
     m_ContextRecord->Length = 0;
     m_ContextRecord->InternalResource = true;
+    m_ContextRecord->SpillChunks = true;
   }
   else
   {
@@ -923,6 +944,8 @@ rdcstr WrappedOpenGL::GetChunkName(uint32_t idx)
 
 WrappedOpenGL::~WrappedOpenGL()
 {
+  m_ReflectionCache.Save();
+
   if(m_IndirectBuffer)
     GL.glDeleteBuffers(1, &m_IndirectBuffer);
 
@@ -964,12 +987,148 @@ WrappedOpenGL::~WrappedOpenGL()
   for(size_t i = 0; i < m_CtxDataVector.size(); i++)
     delete m_CtxDataVector[i];
 
+  for(size_t i = 0; i < m_ThreadSerialisers.size(); i++)
+    delete m_ThreadSerialisers[i];
+
   if(RenderDoc::Inst().GetCrashHandler())
     RenderDoc::Inst().GetCrashHandler()->UnregisterMemoryRegion(this);
 
   delete m_Replay;
 }
 
+uint64_t WrappedOpenGL::GetReflectionCacheMemoryUsage()
+{
+  return m_ReflectionCache.GetMemoryUsage();
+}
+
+void WrappedOpenGL::EvictReflectionCache()
+{
+  // cached reflection is deserialised into each shader when it's looked up, so nothing holds it
+  m_ReflectionCache.EvictResults();
+}
+
+ShaderCacheKey WrappedOpenGL::HashShaderReflectionKey(GLenum type, const rdcstr &source)
+{
+  // the reflection depends on the driver that compiled the separable program and on which path
+  // we took to reflect it, so both are part of the key
+  if(m_ReflectionCacheDriver.empty())
+  {
+    const char *strs[] = {
+        (const char *)GL.glGetString(eGL_VENDOR),
+        (const char *)GL.glGetString(eGL_RENDERER),
+        (const char *)GL.glGetString(eGL_VERSION),
+    };
+
+    for(const char *str : strs)
+    {
+      m_ReflectionCacheDriver += str ? str : "";
+      m_ReflectionCacheDriver += "/";
+    }
+
+    m_ReflectionCacheDriver += HasExt[ARB_program_interface_query] ? "1" : "0";
+    m_ReflectionCacheDriver += HasExt[ARB_separate_shader_objects] ? "1" : "0";
+  }
+
+  ShaderCacheKey key;
+  key.Hash(&type, sizeof(type));
+  key.Hash(source.c_str(), source.size());
+  key.Hash(m_ReflectionCacheDriver.c_str());
+  key.Hash(GitVersionHash);
+  return key;
+}
+
+bool WrappedOpenGL::GetCachedReflection(GLenum type, const rdcstr &source, ShaderReflection &refl,
+                                        rdcarray<uint32_t> &spirvWords, rdcstr &spirvErrors)
+{
+  if(!m_ReflectionCacheLoaded)
+  {
+    m_ReflectionCache.Load();
+    m_ReflectionCacheLoaded = true;
+  }
+
+  bytebuf *entry = NULL;
+  if(!m_ReflectionCache.Find(HashShaderReflectionKey(type, source), entry))
+    return false;
+
+  ShaderReflection cachedRefl;
+  rdcarray<uint32_t> cachedWords;
+  rdcstr cachedErrors;
+
+  {
+    ReadSerialiser ser(new StreamReader(entry->data(), entry->size()), Ownership::Stream);
+
+    ser.ReadChunk<uint32_t>();
+    SERIALISE_ELEMENT(cachedRefl);
+    SERIALISE_ELEMENT(cachedWords);
+    SERIALISE_ELEMENT(cachedErrors);
+    ser.EndChunk();
+
+    if(ser.IsErrored())
+      return false;
+  }
+
+  refl = std::move(cachedRefl);
+  spirvWords = std::move(cachedWords);
+  spirvErrors = std::move(cachedErrors);
+
+  return true;
+}
+
+void WrappedOpenGL::SetCachedReflection(GLenum type, const rdcstr &source,
+                                        const ShaderReflection &refl,
+                                        const rdcarray<uint32_t> &spirvWords,
+                                        const rdcstr &spirvErrors)
+{
+  if(m_ReflectionCache.size() >= m_ReflectionCacheMaxEntries)
+    return;
+
+  StreamWriter *writer = new StreamWriter(StreamWriter::DefaultScratchSize);
+
+  {
+    WriteSerialiser ser(writer, Ownership::Nothing);
+
+    ser.WriteChunk(1);
+    SERIALISE_ELEMENT(refl);
+    SERIALISE_ELEMENT(spirvWords);
+    SERIALISE_ELEMENT(spirvErrors);
+    ser.EndChunk();
+
+    if(ser.IsErrored())
+    {
+      delete writer;
+      return;
+    }
+  }
+
+  m_ReflectionCache.Insert(HashShaderReflectionKey(type, source),
+                           new bytebuf(writer->GetData(), (size_t)writer->GetOffset()));
+
+  delete writer;
+}
+
+WriteSerialiser &WrappedOpenGL::GetThreadSerialiser()
+{
+  WriteSerialiser *ser = (WriteSerialiser *)Threading::GetTLSValue(m_ThreadSerialiserTLSSlot);
+  if(ser)
+    return *ser;
+
+  // slow path, but rare
+  ser = new WriteSerialiser(new StreamWriter(1024), Ownership::Stream);
+
+  ser->SetUserData(GetResourceManager());
+  ser->SetVersion(GLInitParams::CurrentVersion);
+
+  Threading::SetTLSValue(m_ThreadSerialiserTLSSlot, (void *)ser);
+
+  {
+    SCOPED_LOCK(m_ThreadSerialisersLock);
+    ser->SetChunkMetadataRecording(m_ChunkMetadataFlags);
+    m_ThreadSerialisers.push_back(ser);
+  }
+
+  return *ser;
+}
+
 ContextPair &WrappedOpenGL::GetCtx()
 {
   GLContextTLSData *ret = (GLContextTLSData *)Threading::GetTLSValue(m_CurCtxDataTLS);
@@ -1137,14 +1296,20 @@ void WrappedOpenGL::CreateContext(GLWindowingData winData, void *shareContext,
   RenderDoc::Inst().AddDeviceFrameCapturer(ctxdata.ctx, this);
 
   // re-configure callstack capture, since WrappedOpenGL constructor may run too early
-  uint32_t flags = m_ScratchSerialiser.GetChunkMetadataRecording();
+  uint32_t flags = m_ChunkMetadataFlags;
 
   if(RenderDoc::Inst().GetCaptureOptions().captureCallstacks)
     flags |= WriteSerialiser::ChunkCallstack;
   else
     flags &= ~WriteSerialiser::ChunkCallstack;
 
-  m_ScratchSerialiser.SetChunkMetadataRecording(flags);
+  m_ChunkMetadataFlags = flags;
+
+  {
+    SCOPED_LOCK(m_ThreadSerialisersLock);
+    for(WriteSerialiser *ser : m_ThreadSerialisers)
+      ser->SetChunkMetadataRecording(flags);
+  }
 }
 
 bool WrappedOpenGL::ForceSharedObjects(void *oldContext, void *newContext)
@@ -2100,8 +2265,11 @@ void WrappedOpenGL::SwapBuffers(WindowingSystem winSystem, void *windowHandle)
   if(ctxdata.Legacy())
     return;
 
-  // kill any current capture that isn't application defined
-  if(IsActiveCapturing(m_State) && !m_AppControlledCapture)
+  // kill any current capture that isn't application defined, unless it's a merged multi-frame
+  // capture with frames left to record. GL doesn't record its swaps, so those frames aren't
+  // delimited in the capture.
+  if(IsActiveCapturing(m_State) && !m_AppControlledCapture &&
+     !RenderDoc::Inst().ShouldContinueCapture())
     RenderDoc::Inst().EndFrameCapture(ctxdata.ctx, windowHandle);
 
   if(RenderDoc::Inst().ShouldTriggerCapture(m_FrameCounter) && IsBackgroundCapturing(m_State))
@@ -2271,7 +2439,7 @@ bool WrappedOpenGL::EndFrameCapture(void *dev, void *wnd)
     {
       WriteSerialiser ser(captureWriter, Ownership::Stream);
 
-      ser.SetChunkMetadataRecording(m_ScratchSerialiser.GetChunkMetadataRecording());
+      ser.SetChunkMetadataRecording(m_ChunkMetadataFlags);
 
       ser.SetUserData(GetResourceManager());
 
@@ -2307,8 +2475,12 @@ bool WrappedOpenGL::EndFrameCapture(void *dev, void *wnd)
 
       GetResourceManager()->InsertReferencedChunks(ser);
 
+      GetResourceManager()->PrefetchTextureInitialContents();
+
       GetResourceManager()->InsertInitialContentsChunks(ser);
 
+      GetResourceManager()->FreeTextureReadbacks();
+
       RDCDEBUG("Creating Capture Scope");
 
       GetResourceManager()->Serialise_InitialContentsNeeded(ser);
@@ -2322,7 +2494,7 @@ bool WrappedOpenGL::EndFrameCapture(void *dev, void *wnd)
       {
         RDCDEBUG("Accumulating context resource list");
 
-        std::map<int32_t, Chunk *> recordlist;
+        RecordChunkList recordlist;
         m_ContextRecord->Insert(recordlist);
 
         for(auto it = m_ContextData.begin(); it != m_ContextData.end(); ++it)
@@ -2339,16 +2511,18 @@ bool WrappedOpenGL::EndFrameCapture(void *dev, void *wnd)
           }
         }
 
+        SortRecordChunks(recordlist);
+
         RDCDEBUG("Flushing %u records to file serialiser", (uint32_t)recordlist.size());
 
         float num = float(recordlist.size());
         float idx = 0.0f;
 
-        for(auto it = recordlist.begin(); it != recordlist.end(); ++it)
+        for(const rdcpair<int32_t, Chunk *> &chunk : recordlist)
         {
           RenderDoc::Inst().SetProgress(CaptureProgress::SerialiseFrameContents, idx / num);
           idx += 1.0f;
-          it->second->Write(ser);
+          chunk.second->Write(ser);
         }
 
         RDCDEBUG("Done");
@@ -2372,6 +2546,7 @@ bool WrappedOpenGL::EndFrameCapture(void *dev, void *wnd)
       GLResourceRecord *record = *it;
 
       record->FreeShadowStorage();
+      record->Map.watchFlushed = false;
     }
 
     // if we changed contexts above, pop back to where we were
@@ -2428,6 +2603,7 @@ bool WrappedOpenGL::EndFrameCapture(void *dev, void *wnd)
       GLResourceRecord *record = *it;
 
       record->FreeShadowStorage();
+      record->Map.watchFlushed = false;
     }
 
     // if it's a capture triggered from application code, immediately
@@ -2500,6 +2676,7 @@ bool WrappedOpenGL::DiscardFrameCapture(void *dev, void *wnd)
     GLResourceRecord *record = *it;
 
     record->FreeShadowStorage();
+    record->Map.watchFlushed = false;
   }
 
   m_CapturedFrames.pop_back();
@@ -3229,17 +3406,10 @@ ReplayStatus WrappedOpenGL::ReadLogInitialisation(RDCFile *rdc, bool storeStruct
 
   int chunkIdx = 0;
 
-  struct chunkinfo
-  {
-    chunkinfo() : count(0), totalsize(0), total(0.0) {}
-    int count;
-    uint64_t totalsize;
-    double total;
-  };
-
-  std::map<GLChunk, chunkinfo> chunkInfos;
+  ChunkLoadRecorder chunkStats;
 
   SCOPED_TIMER("chunk initialisation");
+  RDCPROFILE_ZONE("ReadLogInitialisation");
 
   uint64_t frameDataSize = 0;
 
@@ -3299,28 +3469,12 @@ ReplayStatus WrappedOpenGL::ReadLogInitialisation(RDCFile *rdc, bool storeStruct
         return status;
     }
 
-    chunkInfos[context].total += timer.GetMilliseconds();
-    chunkInfos[context].totalsize += offsetEnd - offsetStart;
-    chunkInfos[context].count++;
+    chunkStats.Record((uint32_t)context, offsetEnd - offsetStart, timer.GetMilliseconds(), 0.0);
 
     if((SystemChunk)context == SystemChunk::CaptureScope || reader->IsErrored() || reader->AtEnd())
       break;
   }
 
-#if ENABLED(RDOC_DEVEL)
-  for(auto it = chunkInfos.begin(); it != chunkInfos.end(); ++it)
-  {
-    double dcount = double(it->second.count);
-
-    RDCDEBUG(
-        "% 5d chunks - Time: %9.3fms total/%9.3fms avg - Size: %8.3fMB total/%7.3fMB avg - %s (%u)",
-        it->second.count, it->second.total, it->second.total / dcount,
-        double(it->second.totalsize) / (1024.0 * 1024.0),
-        double(it->second.totalsize) / (dcount * 1024.0 * 1024.0),
-        GetChunkName((uint32_t)it->first).c_str(), uint32_t(it->first));
-  }
-#endif
-
   // steal the structured data for ourselves
   m_StructuredFile->Swap(m_StoredStructuredData);
 
@@ -3333,7 +3487,8 @@ ReplayStatus WrappedOpenGL::ReadLogInitialisation(RDCFile *rdc, bool storeStruct
       rdc->GetSectionProperties(sectionIdx).compressedSize;
   GetReplay()->WriteFrameRecord().frameInfo.persistentSize = frameDataSize;
   GetReplay()->WriteFrameRecord().frameInfo.initDataSize =
-      chunkInfos[(GLChunk)SystemChunk::InitialContents].totalsize;
+      chunkStats.GetTotalSize((uint32_t)SystemChunk::InitialContents);
+  GetReplay()->WriteFrameRecord().frameInfo.loadStatistics = chunkStats.Bake(&GetChunkName);
 
   RDCDEBUG("Allocating %llu persistant bytes of memory for the log.",
            GetReplay()->WriteFrameRecord().frameInfo.persistentSize);
@@ -5507,6 +5662,8 @@ const DrawcallDescription *WrappedOpenGL::GetDrawcall(uint32_t eventId)
 
 void WrappedOpenGL::ReplayLog(uint32_t startEventID, uint32_t endEventID, ReplayLogType replayType)
 {
+  RDCPROFILE_ZONE("WrappedOpenGL::ReplayLog");
+
   bool partial = true;
 
   if(startEventID == 0 && (replayType == eReplay_WithoutDraw || replayType == eReplay_Full))
@@ -26,6 +26,7 @@
 #pragma once
 
 #include "common/common.h"
+#include "common/shader_cache.h"
 #include "common/timing.h"
 #include "core/core.h"
 #include "driver/shaders/spirv/spirv_reflect.h"
@@ -36,6 +37,7 @@
 #include "gl_resources.h"
 
 class GLReplay;
+struct GLReflectionCacheCallbacks;
 
 namespace glslang
 {
@@ -164,7 +166,11 @@ private:
   GLInitParams m_GlobalInitParams;
   ReplayOptions m_ReplayOptions;
 
-  WriteSerialiser m_ScratchSerialiser;
+  // each thread serialises its chunks separately, so only the chunk metadata flags are shared
+  uint64_t m_ThreadSerialiserTLSSlot;
+  Threading::CriticalSection m_ThreadSerialisersLock;
+  rdcarray<WriteSerialiser *> m_ThreadSerialisers;
+  uint32_t m_ChunkMetadataFlags;
   std::set<rdcstr> m_StringDB;
 
   StreamReader *m_FrameReader = NULL;
@@ -232,6 +238,11 @@ private:
   std::set<GLResourceRecord *> m_CoherentMaps;
   std::set<GLResourceRecord *> m_PersistentMaps;
 
+  // opt-in with CaptureOptions::watchCoherentMapWrites. Coherent maps are write-protected so that
+  // only the pages actually written are propagated at implicit barriers, rather than diffing
+  // against a shadow copy of the whole map.
+  bool m_WatchCoherentMapWrites = false;
+
   // this function iterates over all the maps, checking for any changes between
   // the shadow pointers, and propogates that to 'real' GL
   void PersistentMapMemoryBarrier(const std::set<GLResourceRecord *> &maps);
@@ -587,7 +598,8 @@ public:
   GLResourceManager *GetResourceManager() { return m_ResourceManager; }
   CaptureState GetState() { return m_State; }
   GLReplay *GetReplay() { return m_Replay; }
-  WriteSerialiser &GetSerialiser() { return m_ScratchSerialiser; }
+  WriteSerialiser &GetThreadSerialiser();
+  uint32_t GetChunkMetadataFlags() { return m_ChunkMetadataFlags; }
   void SetDriverType(RDCDriver type) { m_DriverType = type; }
   bool isGLESMode() { return m_DriverType == RDCDriver::OpenGLES; }
   RDCDriver GetDriverType() { return m_DriverType; }
@@ -633,7 +645,14 @@ public:
   const DrawcallDescription *GetDrawcall(uint32_t eventId);
 
   void SuppressDebugMessages(bool suppress) { m_SuppressDebugMessages = suppress; }
-  rdcarray<EventUsage> GetUsage(ResourceId id) { return m_ResourceUses[id]; }
+  rdcarray<EventUsage> GetUsage(ResourceId id)
+  {
+    // don't use operator[], looking up a resource with no usage shouldn't add an entry for it
+    auto it = m_ResourceUses.find(id);
+    if(it == m_ResourceUses.end())
+      return {};
+    return it->second;
+  }
   void CreateContext(GLWindowingData winData, void *shareContext, GLInitParams initParams,
                      bool core, bool attribsCreate);
   void RegisterReplayContext(GLWindowingData winData, void *shareContext, bool core,
@@ -737,6 +756,25 @@ public:
   std::map<ResourceId, ProgramData> m_Programs;
   std::map<ResourceId, PipelineData> m_Pipelines;
 
+  // reflecting a GLSL shader on replay compiles, links and queries a separable program, then
+  // compiles the source to SPIR-V for disassembly. The results are kept on disk between sessions,
+  // keyed by the shader source and the driver, and the cache is loaded on first use.
+  static const uint32_t m_ReflectionCacheMagic = 0xf00d06e5;
+  static const uint32_t m_ReflectionCacheVersion = 2;
+  static const size_t m_ReflectionCacheMaxEntries = 32768;
+
+  bool m_ReflectionCacheLoaded = false;
+  ShaderCache<bytebuf *, GLReflectionCacheCallbacks> m_ReflectionCache;
+  rdcstr m_ReflectionCacheDriver;
+
+  ShaderCacheKey HashShaderReflectionKey(GLenum type, const rdcstr &source);
+  bool GetCachedReflection(GLenum type, const rdcstr &source, ShaderReflection &refl,
+                           rdcarray<uint32_t> &spirvWords, rdcstr &spirvErrors);
+  void SetCachedReflection(GLenum type, const rdcstr &source, const ShaderReflection &refl,
+                           const rdcarray<uint32_t> &spirvWords, const rdcstr &spirvErrors);
+  uint64_t GetReflectionCacheMemoryUsage();
+  void EvictReflectionCache();
+
   void FillReflectionArray(ResourceId program, PerStageReflections &stages)
   {
     ProgramData &progdata = m_Programs[program];
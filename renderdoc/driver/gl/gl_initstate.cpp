@@ -231,7 +231,7 @@ void GLResourceManager::ContextPrepare_InitialState(GLResource res)
   {
     WriteSerialiser ser(new StreamWriter(4 * 1024), Ownership::Stream);
 
-    ser.SetChunkMetadataRecording(m_Driver->GetSerialiser().GetChunkMetadataRecording());
+    ser.SetChunkMetadataRecording(m_Driver->GetChunkMetadataFlags());
 
     SCOPED_SERIALISE_CHUNK(SystemChunk::InitialContents);
 
@@ -539,6 +539,8 @@ void GLResourceManager::ContextPrepare_InitialState(GLResource res)
 
 bool GLResourceManager::Prepare_InitialState(GLResource res)
 {
+  RDCPROFILE_ZONE("GLResourceManager::Prepare_InitialState");
+
   // We need to fetch the data for this resource on the right context.
   // It's not safe for us to go changing contexts ourselves (the context could be active on
   // another thread), so instead we'll queue this up to fetch when we are on a correct context.
@@ -959,7 +961,7 @@ uint64_t GLResourceManager::GetSize_InitialState(ResourceId resid, const GLIniti
   if(initial.type == eResBuffer)
   {
     // buffers just have their contents, no metadata needed
-    return initial.bufferLength + WriteSerialiser::GetChunkAlignment() + 16;
+    return initial.bufferLength + WriteSerialiser::GetBufferOverhead() + 16;
   }
   else if(initial.type == eResProgram)
   {
@@ -1038,7 +1040,7 @@ uint64_t GLResourceManager::GetSize_InitialState(ResourceId resid, const GLIniti
         targetcount = 6;
 
       for(int t = 0; t < targetcount; t++)
-        ret += WriteSerialiser::GetChunkAlignment() + size;
+        ret += WriteSerialiser::GetBufferOverhead() + size;
     }
 
     return ret;
@@ -1075,6 +1077,279 @@ uint64_t GLResourceManager::GetSize_InitialState(ResourceId resid, const GLIniti
   return 16;
 }
 
+// upper bound on the pixel pack buffer memory used by texture readbacks in flight at once. A single
+// texture larger than this is still read back, just on its own.
+static const uint64_t MaxTextureReadbackBytes = 256 * 1024 * 1024;
+
+void GLResourceManager::PrefetchTextureInitialContents()
+{
+  // GLES has no glGetTexImage to read into a pack buffer, so it keeps the synchronous path.
+  if(IsGLES)
+    return;
+
+  SCOPED_LOCK(m_Lock);
+  MergeThreadFrameRefs();
+
+  // queue up the textures in the same order and with the same filtering that
+  // InsertInitialContentsChunks will serialise them.
+  for(auto it = m_InitialContents.begin(); it != m_InitialContents.end(); ++it)
+  {
+    ResourceId id = it->first;
+    const GLInitialContents &initial = it->second.data;
+
+    if(!IsFrameReferenced(id) && !RenderDoc::Inst().GetCaptureOptions().refAllResources)
+      continue;
+
+    GLResourceRecord *record = GetResourceRecord(id);
+
+    if(record == NULL || record->InternalResource || it->second.chunk)
+      continue;
+
+    // persistent resources are serialised on a different context
+    if(IsResourceTrackedForPersistency(record->Resource))
+      continue;
+
+    if(initial.type != eResTexture || initial.resource.name == 0 ||
+       !Need_InitialStateChunk(id, initial))
+      continue;
+
+    const TextureStateInitialData &TextureState = initial.tex;
+
+    if(TextureState.internalformat == eGL_NONE || TextureState.type == eGL_TEXTURE_BUFFER ||
+       TextureState.isView)
+      continue;
+
+    m_ReadbackQueue.push_back(id);
+  }
+
+  m_ReadbackNext = 0;
+
+  IssueTextureReadbacks();
+}
+
+void GLResourceManager::IssueTextureReadbacks()
+{
+  if(m_ReadbackNext >= m_ReadbackQueue.size())
+    return;
+
+  GLuint ppb = 0;
+  GL.glGetIntegerv(eGL_PIXEL_PACK_BUFFER_BINDING, (GLint *)&ppb);
+
+  PixelPackState pack;
+  pack.Fetch(false);
+
+  ResetPixelPackState(false, 1);
+
+  bool issued = false;
+
+  while(m_ReadbackNext < m_ReadbackQueue.size())
+  {
+    ResourceId id = m_ReadbackQueue[m_ReadbackNext];
+
+    auto it = m_InitialContents.find(id);
+
+    // if the contents have gone away there's nothing to read back
+    if(it == m_InitialContents.end() || it->second.data.resource.name == 0)
+    {
+      m_ReadbackNext++;
+      continue;
+    }
+
+    // stop once we're over budget, the next one will be issued when space frees up
+    if(!IssueTextureReadback(id, it->second.data))
+      break;
+
+    issued = true;
+    m_ReadbackNext++;
+  }
+
+  GL.glBindBuffer(eGL_PIXEL_PACK_BUFFER, ppb);
+  pack.Apply(false);
+
+  // make sure the readbacks start executing while we serialise
+  if(issued)
+    GL.glFlush();
+}
+
+bool GLResourceManager::IssueTextureReadback(ResourceId id, const GLInitialContents &initial)
+{
+  const TextureStateInitialData &TextureState = initial.tex;
+
+  bool isCompressed = IsCompressedFormat(TextureState.internalformat);
+
+  GLenum fmt = eGL_NONE;
+  GLenum type = eGL_NONE;
+
+  if(!isCompressed)
+  {
+    fmt = GetBaseFormat(TextureState.internalformat);
+    type = GetDataType(TextureState.internalformat);
+  }
+
+  // this mirrors the iteration in Serialise_InitialState
+  GLenum targets[] = {
+      eGL_TEXTURE_CUBE_MAP_POSITIVE_X, eGL_TEXTURE_CUBE_MAP_NEGATIVE_X,
+      eGL_TEXTURE_CUBE_MAP_POSITIVE_Y, eGL_TEXTURE_CUBE_MAP_NEGATIVE_Y,
+      eGL_TEXTURE_CUBE_MAP_POSITIVE_Z, eGL_TEXTURE_CUBE_MAP_NEGATIVE_Z,
+  };
+
+  int targetcount = ARRAY_COUNT(targets);
+
+  if(TextureState.type != eGL_TEXTURE_CUBE_MAP)
+  {
+    targets[0] = TextureState.type;
+    targetcount = 1;
+  }
+
+  uint32_t copySlices = RDCMAX(1U, TextureState.depth);
+  int mips = TextureState.mips;
+
+  // if this is an MSAA texture, we prepared an array to serialise
+  if(TextureState.samples > 1)
+  {
+    copySlices = RDCMAX(1U, TextureState.depth) * TextureState.samples;
+    targets[0] = eGL_TEXTURE_2D_ARRAY;
+  }
+
+  if(TextureState.type == eGL_TEXTURE_2D_MULTISAMPLE ||
+     TextureState.type == eGL_TEXTURE_2D_MULTISAMPLE_ARRAY)
+    mips = 1;
+
+  TextureReadback readback;
+
+  for(int i = 0; i < mips; i++)
+  {
+    uint32_t w = RDCMAX(TextureState.width >> i, 1U);
+    uint32_t h = RDCMAX(TextureState.height >> i, 1U);
+    uint32_t d = RDCMAX(TextureState.depth >> i, 1U);
+
+    if(targets[0] == eGL_TEXTURE_CUBE_MAP_ARRAY || targets[0] == eGL_TEXTURE_2D_ARRAY)
+      d = copySlices;
+
+    if(targets[0] == eGL_TEXTURE_1D_ARRAY)
+      h = TextureState.height;
+
+    uint32_t size = 0;
+    if(isCompressed)
+      size = (uint32_t)GetCompressedByteSize(w, h, d, TextureState.internalformat);
+    else
+      size = (uint32_t)GetByteSize(w, h, d, fmt, type);
+
+    for(int trg = 0; trg < targetcount; trg++)
+    {
+      // keep every subresource aligned for any pixel type
+      readback.offsets.push_back(readback.size);
+      readback.size += AlignUp16((uint64_t)size);
+    }
+  }
+
+  readback.size = RDCMAX(readback.size, (uint64_t)16);
+
+  if(m_ReadbackBytes > 0 && m_ReadbackBytes + readback.size > MaxTextureReadbackBytes)
+    return false;
+
+  GL.glGenBuffers(1, &readback.buffer);
+  GL.glBindBuffer(eGL_PIXEL_PACK_BUFFER, readback.buffer);
+
+  if(HasExt[ARB_buffer_storage])
+  {
+    // map persistently up front, coherent so the fence is all we need before reading
+    GLbitfield flags = GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+    GL.glNamedBufferStorageEXT(readback.buffer, (GLsizeiptr)readback.size, NULL, flags);
+    readback.mapped = (byte *)GL.glMapNamedBufferRangeEXT(readback.buffer, 0,
+                                                          (GLsizeiptr)readback.size, flags);
+    readback.persistent = (readback.mapped != NULL);
+  }
+  else
+  {
+    GL.glNamedBufferDataEXT(readback.buffer, (GLsizeiptr)readback.size, NULL, eGL_STREAM_READ);
+  }
+
+  GLenum bindtarget = targets[0];
+  if(TextureState.type == eGL_TEXTURE_CUBE_MAP)
+    bindtarget = eGL_TEXTURE_CUBE_MAP;
+
+  GLuint prevtex = 0;
+  GL.glGetIntegerv(TextureBinding(bindtarget), (GLint *)&prevtex);
+
+  GLuint tex = initial.resource.name;
+  GL.glBindTexture(bindtarget, tex);
+
+  size_t sub = 0;
+  for(int i = 0; i < mips; i++)
+  {
+    for(int trg = 0; trg < targetcount; trg++)
+    {
+      void *dst = (void *)(uintptr_t)readback.offsets[sub++];
+
+      if(isCompressed)
+        GL.glGetCompressedTextureImageEXT(tex, targets[trg], i, dst);
+      else
+        GL.glGetTexImage(targets[trg], i, fmt, type, dst);
+    }
+  }
+
+  GL.glBindTexture(bindtarget, prevtex);
+
+  readback.fence = GL.glFenceSync(eGL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+  m_ReadbackBytes += readback.size;
+  m_Readbacks[id] = readback;
+
+  return true;
+}
+
+byte *GLResourceManager::WaitTextureReadback(TextureReadback &readback)
+{
+  if(readback.fence)
+  {
+    GLenum status = eGL_TIMEOUT_EXPIRED;
+    while(status == eGL_TIMEOUT_EXPIRED)
+      status = GL.glClientWaitSync(readback.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000ULL);
+
+    GL.glDeleteSync(readback.fence);
+    readback.fence = NULL;
+
+    if(status == eGL_WAIT_FAILED)
+      return NULL;
+  }
+
+  if(readback.mapped == NULL)
+    readback.mapped = (byte *)GL.glMapNamedBufferRangeEXT(
+        readback.buffer, 0, (GLsizeiptr)readback.size, GL_MAP_READ_BIT);
+
+  return readback.mapped;
+}
+
+void GLResourceManager::FreeTextureReadback(ResourceId id)
+{
+  auto it = m_Readbacks.find(id);
+  if(it == m_Readbacks.end())
+    return;
+
+  TextureReadback &readback = it->second;
+
+  if(readback.fence)
+    GL.glDeleteSync(readback.fence);
+  if(readback.mapped)
+    GL.glUnmapNamedBufferEXT(readback.buffer);
+  GL.glDeleteBuffers(1, &readback.buffer);
+
+  m_ReadbackBytes -= readback.size;
+  m_Readbacks.erase(it);
+}
+
+void GLResourceManager::FreeTextureReadbacks()
+{
+  while(!m_Readbacks.empty())
+    FreeTextureReadback(m_Readbacks.begin()->first);
+
+  m_ReadbackQueue.clear();
+  m_ReadbackNext = 0;
+  m_ReadbackBytes = 0;
+}
+
 template <typename SerialiserType>
 bool GLResourceManager::Serialise_InitialState(SerialiserType &ser, ResourceId id,
                                                GLResourceRecord *record,
@@ -1593,6 +1868,24 @@ bool GLResourceManager::Serialise_InitialState(SerialiserType &ser, ResourceId i
           // to avoid repeated new/free.
           byte *scratchBuf = AllocAlignedBuffer(size);
 
+          // if the contents were already read back into a pack buffer, serialise straight out of
+          // it rather than stalling on glGetTexImage here.
+          bool readback = false;
+          byte *readbackData = NULL;
+          const rdcarray<uint64_t> *readbackOffsets = NULL;
+          size_t sub = 0;
+
+          if(ser.IsWriting())
+          {
+            auto rb = m_Readbacks.find(id);
+            if(rb != m_Readbacks.end())
+            {
+              readback = true;
+              readbackData = WaitTextureReadback(rb->second);
+              readbackOffsets = &rb->second.offsets;
+            }
+          }
+
           // loop over all the available mips
           for(int i = 0; i < TextureState.mips; i++)
           {
@@ -1615,10 +1908,14 @@ bool GLResourceManager::Serialise_InitialState(SerialiserType &ser, ResourceId i
             // loop over the number of targets (this will only ever be >1 for cubemaps)
             for(int trg = 0; trg < targetcount; trg++)
             {
+              byte *contents = scratchBuf;
+
               // when writing, fetch the source data out of the texture
               if(ser.IsWriting())
               {
-                if(isCompressed)
+                if(readbackData)
+                  contents = readbackData + readbackOffsets->at(sub++);
+                else if(isCompressed)
                 {
                   if(IsGLES)
                     details.GetCompressedImageDataGLES(i, targets[trg], size, scratchBuf);
@@ -1633,7 +1930,7 @@ bool GLResourceManager::Serialise_InitialState(SerialiserType &ser, ResourceId i
               }
 
               // serialise without allocating memory as we already have our scratch buf sized.
-              ser.Serialise("SubresourceContents"_lit, scratchBuf, size, SerialiserFlags::NoFlags);
+              ser.Serialise("SubresourceContents"_lit, contents, size, SerialiserFlags::NoFlags);
 
               // on replay, restore the data into the initial contents texture
               if(IsReplayingAndReading() && !ser.IsErrored())
@@ -1679,6 +1976,13 @@ bool GLResourceManager::Serialise_InitialState(SerialiserType &ser, ResourceId i
 
           // free our scratch buffer
           FreeAlignedBuffer(scratchBuf);
+
+          // release the pack buffer and start reading back the next textures in its place
+          if(readback)
+          {
+            FreeTextureReadback(id);
+            IssueTextureReadbacks();
+          }
         }
 
         // restore the previous texture binding
@@ -275,6 +275,12 @@ public:
 
   void ContextPrepare_InitialState(GLResource res);
 
+  // start reading back prepared texture contents into pixel pack buffers ahead of
+  // InsertInitialContentsChunks, so the copies overlap rather than each glGetTexImage stalling in
+  // turn. FreeTextureReadbacks releases anything left over afterwards.
+  void PrefetchTextureInitialContents();
+  void FreeTextureReadbacks();
+
   void SetInternalResource(GLResource res);
 
 private:
@@ -287,6 +293,22 @@ private:
   void Create_InitialState(ResourceId id, GLResource live, bool hasData);
   void Apply_InitialState(GLResource live, const GLInitialContents &initial);
 
+  struct TextureReadback
+  {
+    GLuint buffer = 0;
+    GLsync fence = NULL;
+    byte *mapped = NULL;
+    bool persistent = false;
+    uint64_t size = 0;
+    // offset of each mip/face in the buffer, in the order they're serialised
+    rdcarray<uint64_t> offsets;
+  };
+
+  void IssueTextureReadbacks();
+  bool IssueTextureReadback(ResourceId id, const GLInitialContents &initial);
+  byte *WaitTextureReadback(TextureReadback &readback);
+  void FreeTextureReadback(ResourceId id);
+
   std::map<GLResource, GLResourceRecord *> m_GLResourceRecords;
 
   std::map<GLResource, ResourceId> m_CurrentResourceIds;
@@ -298,5 +320,11 @@ private:
   std::map<ResourceId, rdcstr> m_Names;
   volatile int64_t m_SyncName;
 
+  // textures waiting to be read back in serialise order, and those currently in flight
+  rdcarray<ResourceId> m_ReadbackQueue;
+  size_t m_ReadbackNext = 0;
+  std::map<ResourceId, TextureReadback> m_Readbacks;
+  uint64_t m_ReadbackBytes = 0;
+
   WrappedOpenGL *m_Driver;
 };
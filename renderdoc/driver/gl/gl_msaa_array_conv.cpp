@@ -319,6 +319,12 @@ void WrappedOpenGL::CopyDepthTex2DMSToArray(GLuint &destArray, GLuint srcMS, GLi
                         eGL_STENCIL_INDEX);
   }
 
+  // the depth is written in one draw, then stencil one bit per draw into a cleared stencil. This
+  // is far fewer draws than writing each of the 256 stencil values with the stencil reference.
+  uint32_t numStencilBits = numStencil > 1 ? 8 : 0;
+
+  drv.glStencilFunc(eGL_ALWAYS, 0xff, 0xff);
+
   GLint loc = drv.glGetUniformLocation(arrms.DepthMS2Array, "mscopy");
   if(loc >= 0)
   {
@@ -326,14 +332,24 @@ void WrappedOpenGL::CopyDepthTex2DMSToArray(GLuint &destArray, GLuint srcMS, GLi
     {
       drv.glFramebufferTextureLayer(eGL_DRAW_FRAMEBUFFER, attach, texs[0], 0, i);
 
-      for(uint32_t s = 0; s < numStencil; s++)
+      if(numStencilBits > 0)
       {
-        uint32_t currentStencil = numStencil == 1 ? 1000 : s;
+        GLint zero = 0;
+        drv.glStencilMask(0xff);
+        drv.glClearBufferiv(eGL_STENCIL, 0, &zero);
+      }
 
-        drv.glStencilFunc(eGL_ALWAYS, int(s), 0xff);
+      drv.glStencilMask(0);
+
+      drv.glProgramUniform4i(arrms.DepthMS2Array, loc, samples, i % samples, i / samples, 1000);
+
+      drv.glDrawArrays(eGL_TRIANGLE_STRIP, 0, 4);
+
+      for(uint32_t b = 0; b < numStencilBits; b++)
+      {
+        drv.glStencilMask(1U << b);
 
-        drv.glProgramUniform4i(arrms.DepthMS2Array, loc, samples, i % samples, i / samples,
-                               currentStencil);
+        drv.glProgramUniform4i(arrms.DepthMS2Array, loc, samples, i % samples, i / samples, b);
 
         drv.glDrawArrays(eGL_TRIANGLE_STRIP, 0, 4);
       }
@@ -208,6 +208,34 @@ void GLReplay::ClearPostVSCache()
   }
 
   m_PostVSData.clear();
+
+  // the pick buffers may have been filled from post-transform data that's now gone
+  DebugData.pickCacheValid = false;
+}
+
+uint64_t GLReplay::GetPostVSCacheSize()
+{
+  WrappedOpenGL &drv = *m_pDriver;
+
+  uint64_t ret = 0;
+
+  for(auto it = m_PostVSData.begin(); it != m_PostVSData.end(); ++it)
+  {
+    GLuint bufs[] = {it->second.vsout.buf, it->second.vsout.idxBuf, it->second.gsout.buf,
+                     it->second.gsout.idxBuf};
+
+    for(GLuint buf : bufs)
+    {
+      if(buf == 0)
+        continue;
+
+      GLint size = 0;
+      drv.glGetNamedBufferParameterivEXT(buf, eGL_BUFFER_SIZE, &size);
+      ret += (uint64_t)size;
+    }
+  }
+
+  return ret;
 }
 
 void GLReplay::InitPostVSBuffers(uint32_t eventId)
@@ -140,6 +140,9 @@ rdcarray<WindowingSystem> GLReplay::GetSupportedWindowSystems()
 {
   rdcarray<WindowingSystem> ret;
 
+  if(RenderDoc::Inst().GetGlobalEnvironment().headless)
+    return ret;
+
 #if ENABLED(RDOC_LINUX)
 
 #if ENABLED(RDOC_WAYLAND)
@@ -183,6 +186,28 @@ rdcarray<GPUDevice> GLReplay::GetAvailableGPUs()
   return {};
 }
 
+rdcarray<MemoryUsage> GLReplay::GetMemoryUsage()
+{
+  uint64_t reflectionSize = 0;
+  for(auto it = m_pDriver->m_Shaders.begin(); it != m_pDriver->m_Shaders.end(); ++it)
+    reflectionSize += EstimateReflectionSize(it->second.reflection) + it->second.disassembly.size();
+
+  rdcarray<MemoryUsage> ret;
+  ret.push_back(MemoryUsage(MemoryCategory::PostVSCache, 0, GetPostVSCacheSize()));
+  ret.push_back(
+      MemoryUsage(MemoryCategory::ShaderCache, m_pDriver->GetReflectionCacheMemoryUsage(), 0));
+  ret.push_back(MemoryUsage(MemoryCategory::ShaderReflection, reflectionSize, 0));
+  return ret;
+}
+
+void GLReplay::EvictCache(MemoryCategory category)
+{
+  if(category == MemoryCategory::PostVSCache)
+    ClearPostVSCache();
+  else if(category == MemoryCategory::ShaderCache)
+    m_pDriver->EvictReflectionCache();
+}
+
 APIProperties GLReplay::GetAPIProperties()
 {
   APIProperties ret = m_pDriver->APIProps;
@@ -2257,8 +2282,8 @@ void GLReplay::FillCBufferVariables(ResourceId pipeline, ResourceId shader, rdcs
     }
     else
     {
-      StandardFillCBufferVariables(shaderDetails.reflection.resourceId, cblock.variables, outvars,
-                                   data);
+      m_CBufferLayouts.Fill(pipeline, shader, entryPoint, cbufSlot,
+                            shaderDetails.reflection.resourceId, cblock.variables, outvars, data);
     }
   }
 }
@@ -3733,6 +3758,14 @@ ReplayStatus GL_CreateReplayDevice(RDCFile *rdc, const ReplayOptions &opts, IRep
     return ReplayStatus::InternalError;
 #endif
   }
+#if ENABLED(RDOC_LINUX) && defined(RENDERDOC_SUPPORT_EGL)
+  else if(RenderDoc::Inst().GetGlobalEnvironment().headless)
+  {
+    // GLX needs an X display, EGL can create a context on the default display with no window
+    RDCLOG("Using EGL device creation for headless replay");
+    gl_platform = &GetEGLPlatform();
+  }
+#endif
 
   bool can_create_gl_context = gl_platform->CanCreateGLContext();
 
@@ -110,10 +110,13 @@ public:
   virtual ~GLReplay() {}
   void SetProxy(bool p) { m_Proxy = p; }
   bool IsRemoteProxy() { return m_Proxy; }
+  void FetchStructuredChunks(const rdcarray<uint32_t> &chunkIndices) {}
   void Shutdown();
 
   DriverInformation GetDriverInfo() { return m_DriverInfo; }
   rdcarray<GPUDevice> GetAvailableGPUs();
+  rdcarray<MemoryUsage> GetMemoryUsage();
+  void EvictCache(MemoryCategory category);
   APIProperties GetAPIProperties();
 
   ResourceDescription &GetResourceDesc(ResourceId id);
@@ -229,6 +232,7 @@ public:
   ResourceId RenderOverlay(ResourceId id, CompType typeCast, FloatVector clearCol,
                            DebugOverlay overlay, uint32_t eventId,
                            const rdcarray<uint32_t> &passEvents);
+  rdcarray<OverdrawStatistics> GetOverdrawStatistics() { return {}; }
   ResourceId ApplyCustomShader(ResourceId shader, ResourceId texid, const Subresource &sub,
                                CompType typeCast);
 
@@ -345,6 +349,11 @@ private:
     GLuint meshPickProgram;
     GLuint pickIBBuf, pickVBBuf;
     uint32_t pickIBSize, pickVBSize;
+    // what the pick buffers were last filled with, so picks on the same mesh can reuse them
+    bool pickCacheValid;
+    uint32_t pickCacheEventId;
+    uint32_t pickCacheNumIndices;
+    MeshFormat pickCacheFormat;
     GLuint pickResultBuf;
 
     GLuint checkerProg;
@@ -395,10 +404,13 @@ private:
 
   HighlightCache m_HighlightCache;
 
+  CBufferLayoutCache m_CBufferLayouts;
+
   // eventId -> data
   std::map<uint32_t, GLPostVSData> m_PostVSData;
 
   void ClearPostVSCache();
+  uint64_t GetPostVSCacheSize();
 
   // cache the previous data returned
   ResourceId m_GetTexturePrevID;
@@ -242,6 +242,10 @@ struct GLResourceRecord : public ResourceRecord
     bool verifyWrite;
     bool orphaned;
     bool persistent;
+    // coherent persistent maps can have their pages write-watched instead of compared against a
+    // shadow copy. watchFlushed is set once the whole map has been propagated during a capture
+    bool writeWatched;
+    bool watchFlushed;
     byte *ptr;
   } Map;
 
@@ -270,18 +274,23 @@ struct GLResourceRecord : public ResourceRecord
 
   GLResource Resource;
 
-  void AllocShadowStorage(size_t size)
+  // the second shadow pointer is only needed to compare against for intercepted maps. Persistent
+  // maps only need one copy of what was last propagated, so can skip it with comparison = false
+  void AllocShadowStorage(size_t size, bool comparison = true)
   {
-    if(ShadowSize != size)
+    if(ShadowSize != size || (comparison && ShadowPtr[1] == NULL))
       FreeShadowStorage();
 
     if(ShadowPtr[0] == NULL)
     {
       ShadowPtr[0] = AllocAlignedBuffer(size + sizeof(markerValue));
-      ShadowPtr[1] = AllocAlignedBuffer(size + sizeof(markerValue));
-
       memcpy(ShadowPtr[0] + size, markerValue, sizeof(markerValue));
-      memcpy(ShadowPtr[1] + size, markerValue, sizeof(markerValue));
+
+      if(comparison)
+      {
+        ShadowPtr[1] = AllocAlignedBuffer(size + sizeof(markerValue));
+        memcpy(ShadowPtr[1] + size, markerValue, sizeof(markerValue));
+      }
 
       ShadowSize = size;
     }
@@ -300,11 +309,8 @@ struct GLResourceRecord : public ResourceRecord
 
   void FreeShadowStorage()
   {
-    if(ShadowPtr[0] != NULL)
-    {
-      FreeAlignedBuffer(ShadowPtr[0]);
-      FreeAlignedBuffer(ShadowPtr[1]);
-    }
+    FreeAlignedBuffer(ShadowPtr[0]);
+    FreeAlignedBuffer(ShadowPtr[1]);
     ShadowPtr[0] = ShadowPtr[1] = NULL;
     ShadowSize = 0;
   }
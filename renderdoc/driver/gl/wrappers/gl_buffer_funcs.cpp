@@ -2071,6 +2071,9 @@ void WrappedOpenGL::glInvalidateBufferSubData(GLuint buffer, GLintptr offset, GL
  * Coherent persistent maps have their shadow storage freed at the end of every frame capture, to
  * ensure it does not hang around and pollute captures after that with stale data.
  *
+ * With CaptureOptions::watchCoherentMapWrites coherent maps are write-protected instead of
+ * shadowed, and each implicit barrier only propagates the pages written since the last one.
+ *
  ************************************************************************/
 
 void *WrappedOpenGL::glMapNamedBufferRangeEXT(GLuint buffer, GLintptr offset, GLsizeiptr length,
@@ -2156,6 +2159,8 @@ void *WrappedOpenGL::glMapNamedBufferRangeEXT(GLuint buffer, GLintptr offset, GL
     record->Map.invalidate = invalidateMap;
     record->Map.verifyWrite = verifyWrite;
     record->Map.persistent = persistent;
+    record->Map.writeWatched = false;
+    record->Map.watchFlushed = false;
 
     // store a list of all persistent writing maps, and subset of all coherent maps
     uint32_t persistentWriteFlags = GL_MAP_PERSISTENT_BIT | GL_MAP_WRITE_BIT;
@@ -2172,6 +2177,10 @@ void *WrappedOpenGL::glMapNamedBufferRangeEXT(GLuint buffer, GLintptr offset, GL
       record->Map.ptr = (byte *)GL.glMapNamedBufferRangeEXT(buffer, offset, length, access);
       record->Map.status = GLResourceRecord::Mapped_Direct;
 
+      if(m_WatchCoherentMapWrites && record->Map.ptr && (access & GL_MAP_COHERENT_BIT) &&
+         (access & GL_MAP_WRITE_BIT))
+        record->Map.writeWatched = MemoryWatch::Watch(record->Map.ptr, (size_t)length);
+
       return record->Map.ptr;
     }
 
@@ -2214,8 +2223,8 @@ void *WrappedOpenGL::glMapNamedBufferRangeEXT(GLuint buffer, GLintptr offset, GL
       // if we're verifying writes intercept with shadow storage
       if(verifyWrite)
       {
-        // intercept with shadow storage
-        record->AllocShadowStorage(length);
+        // intercept with shadow storage, there's nothing to compare against
+        record->AllocShadowStorage(length, false);
 
         // if we're not invalidating, we need the existing contents
         if(!invalidateMap)
@@ -2460,6 +2469,13 @@ GLboolean WrappedOpenGL::glUnmapNamedBufferEXT(GLuint buffer)
           m_SuccessfulCapture = false;
           m_FailureReason = CaptureFailed_UncappedUnmap;
         }
+        // the pages have to be writable again before GL unmaps them
+        if(record->Map.writeWatched)
+        {
+          MemoryWatch::Unwatch(record->Map.ptr);
+          record->Map.writeWatched = false;
+        }
+
         // need to do the real unmap
         ret = GL.glUnmapNamedBufferEXT(buffer);
         break;
@@ -2775,31 +2791,73 @@ void WrappedOpenGL::PersistentMapMemoryBarrier(const std::set<GLResourceRecord *
 
     RDCASSERT(record && record->Map.ptr);
 
-    if(record->Map.ptr)
-    {
-      size_t diffStart = 0, diffEnd = record->Map.length;
-      bool found = true;
+    if(!record->Map.ptr)
+      continue;
 
-      if(record->GetShadowPtr(0))
-        found = FindDiffRange(record->GetShadowPtr(0), record->Map.ptr, (size_t)record->Map.length,
-                              diffStart, diffEnd);
+    const size_t mapLength = (size_t)record->Map.length;
 
-      if(found && diffEnd > diffStart)
-      {
-        // update the modified region in the 'comparison' shadow buffer for next check
-        if(record->GetShadowPtr(0) == NULL)
-          record->AllocShadowStorage(record->Map.length);
-        else
-          memcpy(record->GetShadowPtr(0) + diffStart, record->Map.ptr + diffStart,
-                 diffEnd - diffStart);
+    OverheadCounters::Add(OverheadCounter::ScannedMapBytes, int64_t(mapLength));
 
-        // we use our own flush function so it will serialise chunks when necessary, and it
-        // also handles copying into the persistent mapped pointer and flushing the real GL
-        // buffer
-        gl_CurChunk = GLChunk::CoherentMapWrite;
-        glFlushMappedNamedBufferRangeEXT(record->Resource.name, GLintptr(diffStart),
-                                         GLsizeiptr(diffEnd - diffStart));
+    // ring buffers write a moving window, so propagate each separately written run rather than one
+    // range from the first to last change.
+    static const size_t maxDiffRanges = 8;
+    size_t diffStarts[maxDiffRanges] = {0};
+    size_t diffEnds[maxDiffRanges] = {mapLength};
+    size_t numDiffRanges = 1;
+
+    if(record->Map.writeWatched)
+    {
+      // the pages written since the last barrier are known exactly. The first barrier in a capture
+      // still propagates everything, the same as an unshadowed map below.
+      rdcarray<rdcpair<size_t, size_t>> written;
+      MemoryWatch::FetchWrites(record->Map.ptr, written);
+
+      if(record->Map.watchFlushed)
+      {
+        // merge anything beyond what we can flush at once into the last range
+        numDiffRanges = RDCMIN(written.size(), maxDiffRanges);
+        for(size_t r = 0; r < written.size(); r++)
+        {
+          size_t idx = RDCMIN(r, maxDiffRanges - 1);
+          if(r == idx)
+            diffStarts[idx] = written[r].first;
+          diffEnds[idx] = written[r].first + written[r].second;
+        }
       }
+
+      record->Map.watchFlushed = true;
+    }
+    else if(record->GetShadowPtr(0))
+    {
+      numDiffRanges = FindDiffRanges(record->GetShadowPtr(0), record->Map.ptr, mapLength,
+                                     64 * 1024, diffStarts, diffEnds, maxDiffRanges);
+
+      // update the modified regions in the 'comparison' shadow buffer for next check
+      for(size_t r = 0; r < numDiffRanges; r++)
+        memcpy(record->GetShadowPtr(0) + diffStarts[r], record->Map.ptr + diffStarts[r],
+               diffEnds[r] - diffStarts[r]);
+    }
+    else
+    {
+      // only one copy is needed of what was last propagated, and it must start out with the
+      // current contents so the next barrier only sees what changed after this one
+      record->AllocShadowStorage(mapLength, false);
+      memcpy(record->GetShadowPtr(0), record->Map.ptr, mapLength);
+    }
+
+    for(size_t r = 0; r < numDiffRanges; r++)
+    {
+      size_t diffStart = diffStarts[r], diffEnd = diffEnds[r];
+
+      if(diffEnd <= diffStart)
+        continue;
+
+      // we use our own flush function so it will serialise chunks when necessary, and it
+      // also handles copying into the persistent mapped pointer and flushing the real GL
+      // buffer
+      gl_CurChunk = GLChunk::CoherentMapWrite;
+      glFlushMappedNamedBufferRangeEXT(record->Resource.name, GLintptr(diffStart),
+                                       GLsizeiptr(diffEnd - diffStart));
     }
   }
 }
@@ -4856,6 +4914,10 @@ void WrappedOpenGL::glDeleteBuffers(GLsizei n, const GLuint *buffers)
           m_PersistentMaps.erase(record);
           if(record->Map.access & GL_MAP_COHERENT_BIT)
             m_CoherentMaps.erase(record);
+
+          if(record->Map.writeWatched)
+            MemoryWatch::Unwatch(record->Map.ptr);
+          record->Map.writeWatched = false;
         }
 
         // free any shadow storage
@@ -157,8 +157,9 @@ void WrappedOpenGL::glLabelObjectEXT(GLenum identifier, GLuint name, GLsizei len
   }
   else
   {
-    m_ScratchSerialiser.ChunkMetadata().timestampMicro = RenderDoc::Inst().GetMicrosecondTimestamp();
-    m_ScratchSerialiser.ChunkMetadata().durationMicro = 0;
+    SDChunkMetaData &meta = GetThreadSerialiser().ChunkMetadata();
+    meta.timestampMicro = RenderDoc::Inst().GetMicrosecondTimestamp();
+    meta.durationMicro = 0;
   }
 
   if(IsCaptureMode(m_State))
@@ -188,8 +189,9 @@ void WrappedOpenGL::glObjectLabel(GLenum identifier, GLuint name, GLsizei length
   }
   else
   {
-    m_ScratchSerialiser.ChunkMetadata().timestampMicro = RenderDoc::Inst().GetMicrosecondTimestamp();
-    m_ScratchSerialiser.ChunkMetadata().durationMicro = 0;
+    SDChunkMetaData &meta = GetThreadSerialiser().ChunkMetadata();
+    meta.timestampMicro = RenderDoc::Inst().GetMicrosecondTimestamp();
+    meta.durationMicro = 0;
   }
 
   if(IsCaptureMode(m_State))
@@ -219,8 +221,9 @@ void WrappedOpenGL::glObjectPtrLabel(const void *ptr, GLsizei length, const GLch
   }
   else
   {
-    m_ScratchSerialiser.ChunkMetadata().timestampMicro = RenderDoc::Inst().GetMicrosecondTimestamp();
-    m_ScratchSerialiser.ChunkMetadata().durationMicro = 0;
+    SDChunkMetaData &meta = GetThreadSerialiser().ChunkMetadata();
+    meta.timestampMicro = RenderDoc::Inst().GetMicrosecondTimestamp();
+    meta.durationMicro = 0;
   }
 
   if(IsCaptureMode(m_State))
@@ -325,8 +328,9 @@ void WrappedOpenGL::glDebugMessageInsert(GLenum source, GLenum type, GLuint id,
   }
   else
   {
-    m_ScratchSerialiser.ChunkMetadata().timestampMicro = RenderDoc::Inst().GetMicrosecondTimestamp();
-    m_ScratchSerialiser.ChunkMetadata().durationMicro = 0;
+    SDChunkMetaData &meta = GetThreadSerialiser().ChunkMetadata();
+    meta.timestampMicro = RenderDoc::Inst().GetMicrosecondTimestamp();
+    meta.durationMicro = 0;
   }
 
   HandleVRFrameMarkers(buf, length);
@@ -470,8 +474,9 @@ void WrappedOpenGL::glPushDebugGroup(GLenum source, GLuint id, GLsizei length, c
   }
   else
   {
-    m_ScratchSerialiser.ChunkMetadata().timestampMicro = RenderDoc::Inst().GetMicrosecondTimestamp();
-    m_ScratchSerialiser.ChunkMetadata().durationMicro = 0;
+    SDChunkMetaData &meta = GetThreadSerialiser().ChunkMetadata();
+    meta.timestampMicro = RenderDoc::Inst().GetMicrosecondTimestamp();
+    meta.durationMicro = 0;
   }
 
   if(IsActiveCapturing(m_State))
@@ -514,8 +519,9 @@ void WrappedOpenGL::glPopDebugGroup()
   }
   else
   {
-    m_ScratchSerialiser.ChunkMetadata().timestampMicro = RenderDoc::Inst().GetMicrosecondTimestamp();
-    m_ScratchSerialiser.ChunkMetadata().durationMicro = 0;
+    SDChunkMetaData &meta = GetThreadSerialiser().ChunkMetadata();
+    meta.timestampMicro = RenderDoc::Inst().GetMicrosecondTimestamp();
+    meta.durationMicro = 0;
   }
 
   if(IsActiveCapturing(m_State))
@@ -52,6 +52,10 @@ WrappedOpenGL *driver = NULL;
 
 typedef GLenum (*BindingLookupFunc)(GLenum target);
 
+// Binds obj for the duration of an emulated call, then restores the previous binding. If obj is
+// already bound both the bind and the restore are skipped - on GLES replay the object being
+// modified is nearly always the one that's currently bound, since the non-DSA calls we serialised
+// are replayed through the DSA entry points on the bound object.
 struct PushPop
 {
   enum VAOMode
@@ -65,30 +69,51 @@ struct PushPop
 
   // we can use PFNGLBINDTEXTUREPROC since most bind functions are identical - taking GLenum and
   // GLuint.
-  PushPop(GLenum target, PFNGLBINDTEXTUREPROC bindFunc, BindingLookupFunc bindingLookup)
+  PushPop(GLenum target, PFNGLBINDTEXTUREPROC bindFunc, BindingLookupFunc bindingLookup, GLuint obj)
   {
-    other = bindFunc;
     t = target;
     GL.glGetIntegerv(bindingLookup(target), (GLint *)&o);
+
+    // binding GL_FRAMEBUFFER sets both the draw and read bindings, but we only fetched one of them
+    if(o != obj || target == eGL_FRAMEBUFFER)
+    {
+      other = bindFunc;
+      other(t, obj);
+    }
   }
 
-  PushPop(GLenum target, PFNGLBINDTEXTUREPROC bindFunc, GLenum binding)
+  PushPop(GLenum target, PFNGLBINDTEXTUREPROC bindFunc, GLenum binding, GLuint obj)
   {
-    other = bindFunc;
     t = target;
     GL.glGetIntegerv(binding, (GLint *)&o);
+
+    if(o != obj)
+    {
+      other = bindFunc;
+      other(t, obj);
+    }
   }
 
-  PushPop(VAOMode, PFNGLBINDVERTEXARRAYPROC bindFunc)
+  PushPop(VAOMode, PFNGLBINDVERTEXARRAYPROC bindFunc, GLuint obj)
   {
-    vao = bindFunc;
     GL.glGetIntegerv(eGL_VERTEX_ARRAY_BINDING, (GLint *)&o);
+
+    if(o != obj)
+    {
+      vao = bindFunc;
+      vao(obj);
+    }
   }
 
-  PushPop(ProgramMode, PFNGLUSEPROGRAMPROC bindFunc)
+  PushPop(ProgramMode, PFNGLUSEPROGRAMPROC bindFunc, GLuint obj)
   {
-    prog = bindFunc;
     GL.glGetIntegerv(eGL_CURRENT_PROGRAM, (GLint *)&o);
+
+    if(o != obj)
+    {
+      prog = bindFunc;
+      prog(obj);
+    }
   }
 
   ~PushPop()
@@ -126,35 +151,29 @@ GLenum TexBindTarget(GLenum target)
   return target;
 }
 
-#define PushPopTexture(target, obj)                                              \
-  GLenum bindtarget = TexBindTarget(target);                                     \
-  PushPop CONCAT(prev, __LINE__)(bindtarget, GL.glBindTexture, &TextureBinding); \
-  GL.glBindTexture(bindtarget, obj);
+#define PushPopTexture(target, obj)                                                   \
+  GLenum bindtarget = TexBindTarget(target);                                          \
+  PushPop CONCAT(prev, __LINE__)(bindtarget, GL.glBindTexture, &TextureBinding, obj);
 
-#define PushPopBuffer(target, obj)                                         \
-  PushPop CONCAT(prev, __LINE__)(target, GL.glBindBuffer, &BufferBinding); \
-  GL.glBindBuffer(target, obj);
+#define PushPopBuffer(target, obj)                                              \
+  PushPop CONCAT(prev, __LINE__)(target, GL.glBindBuffer, &BufferBinding, obj);
 
 #define PushPopXFB(obj)                                                              \
   PushPop CONCAT(prev, __LINE__)(eGL_TRANSFORM_FEEDBACK, GL.glBindTransformFeedback, \
-                                 eGL_TRANSFORM_FEEDBACK_BINDING);                    \
-  GL.glBindTransformFeedback(eGL_TRANSFORM_FEEDBACK, obj);
+                                 eGL_TRANSFORM_FEEDBACK_BINDING, obj);
 
-#define PushPopFramebuffer(target, obj)                                              \
-  PushPop CONCAT(prev, __LINE__)(target, GL.glBindFramebuffer, &FramebufferBinding); \
-  GL.glBindFramebuffer(target, obj);
+#define PushPopFramebuffer(target, obj)                                                   \
+  PushPop CONCAT(prev, __LINE__)(target, GL.glBindFramebuffer, &FramebufferBinding, obj);
 
-#define PushPopRenderbuffer(obj)                                                                     \
-  PushPop CONCAT(prev, __LINE__)(eGL_RENDERBUFFER, GL.glBindRenderbuffer, eGL_RENDERBUFFER_BINDING); \
-  GL.glBindRenderbuffer(eGL_RENDERBUFFER, obj);
+#define PushPopRenderbuffer(obj)                                          \
+  PushPop CONCAT(prev, __LINE__)(eGL_RENDERBUFFER, GL.glBindRenderbuffer, \
+                                 eGL_RENDERBUFFER_BINDING, obj);
 
-#define PushPopVertexArray(obj)                                       \
-  PushPop CONCAT(prev, __LINE__)(PushPop::VAO, GL.glBindVertexArray); \
-  GL.glBindVertexArray(obj);
+#define PushPopVertexArray(obj)                                            \
+  PushPop CONCAT(prev, __LINE__)(PushPop::VAO, GL.glBindVertexArray, obj);
 
-#define PushPopProgram(obj)                                          \
-  PushPop CONCAT(prev, __LINE__)(PushPop::Program, GL.glUseProgram); \
-  GL.glUseProgram(obj);
+#define PushPopProgram(obj)                                               \
+  PushPop CONCAT(prev, __LINE__)(PushPop::Program, GL.glUseProgram, obj);
 
 void APIENTRY _glTransformFeedbackBufferBase(GLuint xfb, GLuint index, GLuint buffer)
 {
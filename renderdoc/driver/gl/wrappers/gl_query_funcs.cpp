@@ -142,7 +142,21 @@ bool WrappedOpenGL::Serialise_glClientWaitSync(SerialiserType &ser, GLsync sync_
 GLenum WrappedOpenGL::glClientWaitSync(GLsync sync, GLbitfield flags, GLuint64 timeout)
 {
   GLenum ret;
-  SERIALISE_TIME_CALL(ret = GL.glClientWaitSync(sync, flags, timeout));
+
+  // this can block for a long time, e.g. on an upload thread waiting for its transfers. With the
+  // serialiser being per-thread nothing here needs the global lock so let other contexts continue.
+  if(IsCaptureMode(m_State) && timeout > 0)
+  {
+    GLChunk chunk = gl_CurChunk;
+    glLock.Unlock();
+    SERIALISE_TIME_CALL(ret = GL.glClientWaitSync(sync, flags, timeout));
+    glLock.Lock();
+    gl_CurChunk = chunk;
+  }
+  else
+  {
+    SERIALISE_TIME_CALL(ret = GL.glClientWaitSync(sync, flags, timeout));
+  }
 
   if(IsActiveCapturing(m_State))
   {
@@ -213,11 +213,20 @@ void WrappedOpenGL::ShaderData::ProcessCompilation(WrappedOpenGL &drv, ResourceI
     }
     else
     {
-      bool reflected = false;
+      rdcarray<uint32_t> spirvwords;
+      rdcstr spirvErrors;
+
+      bool cached =
+          drv.GetCachedReflection(type, concatenated, reflection, spirvwords, spirvErrors);
+      bool reflected = cached;
 
       // if we have separate shader object support, we can create a separable program and reflect it
       // - this may or may not be emulated depending on if ARB_program_interface_query is supported.
-      if(HasExt[ARB_separate_shader_objects])
+      if(cached)
+      {
+        // reflection and SPIR-V were restored from a previous load of identical source
+      }
+      else if(HasExt[ARB_separate_shader_objects])
       {
         GLuint sepProg = MakeSeparableShaderProgram(drv, type, sources, NULL);
 
@@ -263,16 +272,20 @@ void WrappedOpenGL::ShaderData::ProcessCompilation(WrappedOpenGL &drv, ResourceI
 
       if(reflected)
       {
-        rdcarray<uint32_t> spirvwords;
+        if(!cached)
+        {
+          rdcspv::CompilationSettings settings(rdcspv::InputLanguage::OpenGLGLSL,
+                                               rdcspv::ShaderStage(ShaderIdx(type)));
+
+          spirvErrors = rdcspv::Compile(settings, sources, spirvwords);
 
-        rdcspv::CompilationSettings settings(rdcspv::InputLanguage::OpenGLGLSL,
-                                             rdcspv::ShaderStage(ShaderIdx(type)));
+          drv.SetCachedReflection(type, concatenated, reflection, spirvwords, spirvErrors);
+        }
 
-        rdcstr s = rdcspv::Compile(settings, sources, spirvwords);
         if(!spirvwords.empty())
           spirv.Parse(spirvwords);
         else
-          disassembly = "Disassembly to SPIR-V failed:\n\n" + s;
+          disassembly = "Disassembly to SPIR-V failed:\n\n" + spirvErrors;
 
         reflection.resourceId = id;
 
@@ -23,8 +23,11 @@
  ******************************************************************************/
 
 #include "amd_isa.h"
+#include "api/replay/version.h"
 #include "common/common.h"
 #include "common/formatting.h"
+#include "common/shader_cache.h"
+#include "core/core.h"
 #include "core/plugins.h"
 #include "os/os_specific.h"
 #include "strings/string_utils.h"
@@ -45,7 +48,7 @@ rdcstr pluginPath = "amd/isa";
 // in amd_isa_<plat>.cpp
 rdcstr DisassembleDXBC(const bytebuf &shaderBytes, const rdcstr &target);
 
-static bool IsSupported(ShaderEncoding encoding)
+static bool CheckSupported(ShaderEncoding encoding)
 {
   if(encoding == ShaderEncoding::GLSL)
   {
@@ -87,6 +90,113 @@ static bool IsSupported(ShaderEncoding encoding)
   return false;
 }
 
+static bool IsSupported(ShaderEncoding encoding)
+{
+  // checking means launching the tool, which is as slow as a disassembly. The plugins and the
+  // running driver won't change while we're running so only check each encoding once.
+  static std::map<ShaderEncoding, bool> supported;
+
+  auto it = supported.find(encoding);
+  if(it != supported.end())
+    return it->second;
+
+  bool ret = CheckSupported(encoding);
+  supported[encoding] = ret;
+  return ret;
+}
+
+struct ISACacheCallbacks
+{
+  bool Create(uint32_t size, const byte *data, bytebuf **ret) const
+  {
+    RDCASSERT(ret);
+
+    *ret = new bytebuf(data, size);
+
+    return true;
+  }
+
+  void Destroy(bytebuf *blob) const { delete blob; }
+  uint32_t GetSize(bytebuf *blob) const { return (uint32_t)blob->size(); }
+  const byte *GetData(bytebuf *blob) const { return blob->data(); }
+};
+
+typedef ShaderCache<bytebuf *, ISACacheCallbacks> ISACache;
+
+static const uint32_t ISACacheMagic = 0xf00d015a;
+static const uint32_t ISACacheVersion = 2;
+static const size_t ISACacheMaxEntries = 4096;
+
+static void SaveISACache();
+
+static ISACache &GetISACache()
+{
+  static ISACacheCallbacks callbacks;
+  static ISACache cache("amdisa.cache", ISACacheMagic, ISACacheVersion, callbacks);
+  static bool loaded = false;
+
+  if(!loaded)
+  {
+    cache.Load();
+    loaded = true;
+
+    // write any new entries out in one go when replay shuts down
+    RenderDoc::Inst().RegisterShutdownFunction(&SaveISACache);
+  }
+
+  return cache;
+}
+
+static void SaveISACache()
+{
+  GetISACache().Save();
+}
+
+static ShaderCacheKey HashISAKey(ShaderEncoding encoding, ShaderStage stage,
+                                 const bytebuf &shaderBytes, const rdcstr &target)
+{
+  // the output also depends on the tool that produced it, so include its location and modified
+  // time to invalidate entries when the plugins are updated.
+  rdcstr tool = LocatePluginFile(
+      pluginPath, encoding == ShaderEncoding::GLSL ? virtualcontext_name : amdspv_name);
+  uint64_t toolTimestamp = FileIO::GetModifiedTimestamp(tool);
+
+  ShaderCacheKey key;
+  key.Hash(shaderBytes.data(), shaderBytes.size());
+  key.Hash(&encoding, sizeof(encoding));
+  key.Hash(&stage, sizeof(stage));
+  key.Hash(target.c_str());
+  key.Hash(tool.c_str());
+  key.Hash(&toolTimestamp, sizeof(toolTimestamp));
+  key.Hash(GitVersionHash);
+  return key;
+}
+
+static bool GetCachedDisassembly(ShaderEncoding encoding, ShaderStage stage,
+                                 const bytebuf &shaderBytes, const rdcstr &target, rdcstr &ret)
+{
+  bytebuf *entry = NULL;
+  if(!GetISACache().Find(HashISAKey(encoding, stage, shaderBytes, target), entry))
+    return false;
+
+  ret.assign((const char *)entry->data(), entry->size());
+
+  return true;
+}
+
+static void SetCachedDisassembly(ShaderEncoding encoding, ShaderStage stage,
+                                 const bytebuf &shaderBytes, const rdcstr &target,
+                                 const rdcstr &disasm)
+{
+  ISACache &cache = GetISACache();
+
+  if(cache.size() >= ISACacheMaxEntries)
+    return;
+
+  cache.Insert(HashISAKey(encoding, stage, shaderBytes, target),
+               new bytebuf((const byte *)disasm.c_str(), disasm.size()));
+}
+
 void GetTargets(GraphicsAPI api, rdcarray<rdcstr> &targets)
 {
   targets.reserve(asicCount + 1);
@@ -409,11 +519,27 @@ rdcstr Disassemble(ShaderEncoding encoding, ShaderStage stage, const bytebuf &sh
   if(encoding == ShaderEncoding::DXBC)
     return DisassembleDXBC(shaderBytes, target);
 
-  if(encoding == ShaderEncoding::SPIRV)
-    return DisassembleSPIRV(stage, shaderBytes, target);
+  if(encoding == ShaderEncoding::SPIRV || encoding == ShaderEncoding::GLSL)
+  {
+    rdcstr ret;
 
-  if(encoding == ShaderEncoding::GLSL)
-    return DisassembleGLSL(stage, shaderBytes, target);
+    // each disassembly launches an external process and goes via temporary files, so re-use the
+    // output from any previous run on the same shader and target.
+    if(GetCachedDisassembly(encoding, stage, shaderBytes, target, ret))
+      return ret;
+
+    if(encoding == ShaderEncoding::SPIRV)
+      ret = DisassembleSPIRV(stage, shaderBytes, target);
+    else
+      ret = DisassembleGLSL(stage, shaderBytes, target);
+
+    // only successful disassemblies are cached, errors may be fixed by installing the plugins or
+    // running on an AMD driver.
+    if(ret.beginsWith("; Disassembly for "))
+      SetCachedDisassembly(encoding, stage, shaderBytes, target, ret);
+
+    return ret;
+  }
 
   return StringFormat::Fmt("Unsupported encoding for shader '%s'", ToStr(encoding).c_str());
 }
@@ -24,6 +24,7 @@
 
 #include "dxbc_compile.h"
 #include "common/common.h"
+#include "common/formatting.h"
 #include "os/os_specific.h"
 #include "strings/string_utils.h"
 
@@ -68,3 +69,25 @@ HMODULE GetD3DCompiler()
 
   return LoadLibraryW(StringFormat::UTF82Wide(dll.c_str()).data());
 }
+
+rdcstr GetD3DCompilerIdentity()
+{
+  static rdcstr ret;
+  if(!ret.empty())
+    return ret;
+
+  HMODULE d3dcompiler = GetD3DCompiler();
+
+  if(d3dcompiler == NULL)
+    return ret;
+
+  wchar_t path[MAX_PATH + 1] = {};
+  GetModuleFileNameW(d3dcompiler, path, MAX_PATH);
+
+  rdcstr filename = StringFormat::Wide2UTF8(path);
+
+  // the path and modification time together are enough to tell different compiler versions apart
+  ret = StringFormat::Fmt("%s:%llu", filename.c_str(), FileIO::GetModifiedTimestamp(filename));
+
+  return ret;
+}
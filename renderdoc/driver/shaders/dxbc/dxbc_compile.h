@@ -26,4 +26,9 @@
 
 #include <windows.h>
 
+#include "api/replay/rdcstr.h"
+
 HMODULE GetD3DCompiler();
+
+// identifies the loaded d3dcompiler, for invalidating cached compiles when it changes
+rdcstr GetD3DCompilerIdentity();
@@ -500,6 +500,9 @@ const rdcstr &DXBCContainer::GetDisassembly()
     m_Disassembly =
         StringFormat::Fmt("Shader hash %08x-%08x-%08x-%08x\n\n", hash[0], hash[1], hash[2], hash[3]);
 
+    // the disassembly interleaves source lines from the debug info
+    ParseDebugInfo();
+
     if(m_DXBCByteCode)
       m_Disassembly += m_DXBCByteCode->GetDisassembly();
     else if(m_DXILByteCode)
@@ -518,7 +521,7 @@ void DXBCContainer::FillTraceLineInfo(ShaderDebugTrace &trace) const
     {
       const DXBCBytecode::Operation &op = m_DXBCByteCode->GetInstruction(i);
 
-      if(m_DebugInfo)
+      if(GetDebugInfo())
         m_DebugInfo->GetLineInfo(i, op.offset, trace.lineInfo[i]);
 
       // we add two lines for the shader hash on top of what the bytecode disassembler did
@@ -536,6 +539,8 @@ void DXBCContainer::FillStateInstructionInfo(ShaderDebugState &state) const
 
   state.sourceVars.clear();
 
+  ParseDebugInfo();
+
   if(m_DXBCByteCode)
   {
     if(instruction < m_DXBCByteCode->GetNumInstructions())
@@ -1233,7 +1238,36 @@ DXBCContainer::DXBCContainer(const void *ByteCode, size_t ByteCodeLength)
       m_DXILByteCode->FetchComputeProperties(m_Reflection);
   }
 
-  // initialise debug chunks last
+  // if we had bytecode in this container, ensure we had reflection. If it's a blob with only an
+  // input signature then we can do without reflection.
+  if(m_DXBCByteCode || m_DXILByteCode)
+  {
+    RDCASSERT(m_Reflection);
+  }
+}
+
+// SDBG/SPDB debug info can be very large and is only needed for source display and debugging, so
+// it isn't parsed until something asks for it.
+void DXBCContainer::ParseDebugInfo() const
+{
+  if(m_DebugInfoParsed)
+    return;
+
+  m_DebugInfoParsed = true;
+
+  if(m_ShaderBlob.size() < sizeof(FileHeader))
+    return;
+
+  // the debug chunks are parsed in place from the blob, they don't modify it
+  char *data = (char *)m_ShaderBlob.data();
+
+  FileHeader *header = (FileHeader *)data;
+
+  if(header->fourcc != FOURCC_DXBC || header->fileLength != (uint32_t)m_ShaderBlob.size())
+    return;
+
+  uint32_t *chunkOffsets = (uint32_t *)(header + 1);    // right after the header
+
   for(uint32_t chunkIdx = 0; chunkIdx < header->numChunks; chunkIdx++)
   {
     uint32_t *fourcc = (uint32_t *)(data + chunkOffsets[chunkIdx]);
@@ -1256,7 +1290,8 @@ DXBCContainer::DXBCContainer(const void *ByteCode, size_t ByteCodeLength)
 
   if(m_DebugInfo)
   {
-    m_DXBCByteCode->SetDebugInfo(m_DebugInfo);
+    if(m_DXBCByteCode)
+      m_DXBCByteCode->SetDebugInfo(m_DebugInfo);
 
     struct SplitFile
     {
@@ -1462,13 +1497,6 @@ DXBCContainer::DXBCContainer(const void *ByteCode, size_t ByteCodeLength)
       }
     }
   }
-
-  // if we had bytecode in this container, ensure we had reflection. If it's a blob with only an
-  // input signature then we can do without reflection.
-  if(m_DXBCByteCode || m_DXILByteCode)
-  {
-    RDCASSERT(m_Reflection);
-  }
 }
 
 DXBCContainer::~DXBCContainer()
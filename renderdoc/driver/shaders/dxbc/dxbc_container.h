@@ -151,7 +151,11 @@ public:
 
   bytebuf m_ShaderBlob;
 
-  const IDebugInfo *GetDebugInfo() const { return m_DebugInfo; }
+  const IDebugInfo *GetDebugInfo() const
+  {
+    ParseDebugInfo();
+    return m_DebugInfo;
+  }
   const Reflection *GetReflection() const { return m_Reflection; }
   D3D_PRIMITIVE_TOPOLOGY GetOutputTopology();
 
@@ -172,6 +176,8 @@ private:
   DXBCContainer(const DXBCContainer &o);
   DXBCContainer &operator=(const DXBCContainer &o);
 
+  void ParseDebugInfo() const;
+
   rdcstr m_Disassembly;
 
   D3D_PRIMITIVE_TOPOLOGY m_OutputTopology = D3D_PRIMITIVE_TOPOLOGY_UNDEFINED;
@@ -184,7 +190,8 @@ private:
   ShaderStatistics m_ShaderStats;
   DXBCBytecode::Program *m_DXBCByteCode = NULL;
   DXIL::Program *m_DXILByteCode = NULL;
-  IDebugInfo *m_DebugInfo = NULL;
+  mutable IDebugInfo *m_DebugInfo = NULL;
+  mutable bool m_DebugInfoParsed = false;
   Reflection *m_Reflection = NULL;
 };
 
@@ -445,6 +445,249 @@ bool OperationFlushing(const DXBCBytecode::OpcodeType &op)
   return false;
 }
 
+// operations that calculate derivatives, and so read registers from the rest of the quad
+static bool OperationReadsQuad(const DXBCBytecode::OpcodeType &op)
+{
+  switch(op)
+  {
+    case OPCODE_SAMPLE:
+    case OPCODE_SAMPLE_B:
+    case OPCODE_SAMPLE_C:
+    case OPCODE_LOD:
+    case OPCODE_DERIV_RTX:
+    case OPCODE_DERIV_RTX_COARSE:
+    case OPCODE_DERIV_RTX_FINE:
+    case OPCODE_DERIV_RTY:
+    case OPCODE_DERIV_RTY_COARSE:
+    case OPCODE_DERIV_RTY_FINE: return true;
+    default: break;
+  }
+
+  return false;
+}
+
+// operations which may be evaluated on the GPU through the DebugAPIWrapper
+static bool OperationEvaluatesOnGPU(const DXBCBytecode::OpcodeType &op)
+{
+  switch(op)
+  {
+    case OPCODE_RCP:
+    case OPCODE_RSQ:
+    case OPCODE_EXP:
+    case OPCODE_LOG:
+    case OPCODE_SINCOS:
+    case OPCODE_SAMPLE:
+    case OPCODE_SAMPLE_L:
+    case OPCODE_SAMPLE_B:
+    case OPCODE_SAMPLE_D:
+    case OPCODE_SAMPLE_C:
+    case OPCODE_SAMPLE_C_LZ:
+    case OPCODE_LD:
+    case OPCODE_LD_MS:
+    case OPCODE_GATHER4:
+    case OPCODE_GATHER4_C:
+    case OPCODE_GATHER4_PO:
+    case OPCODE_GATHER4_PO_C:
+    case OPCODE_LOD: return true;
+    default: break;
+  }
+
+  return false;
+}
+
+void DebugAPIWrapper::CalculateMathIntrinsics(rdcarray<MathIntrinsicRequest> &requests)
+{
+  for(MathIntrinsicRequest &req : requests)
+    req.succeeded = CalculateMathIntrinsic(req.opcode, req.input, req.output1, req.output2);
+}
+
+void DebugAPIWrapper::CalculateSampleGathers(rdcarray<SampleGatherRequest> &requests)
+{
+  for(SampleGatherRequest &req : requests)
+    req.succeeded = CalculateSampleGather(
+        req.opcode, req.resourceData, req.samplerData, req.uv, req.ddxCalc, req.ddyCalc,
+        req.texelOffsets, req.multisampleIndex, req.lodOrCompareValue, req.swizzle,
+        req.gatherChannel, req.opString.c_str(), req.output);
+}
+
+rdcstr SampleGatherShaders::GetPixelShader() const
+{
+  if(!psProgram.empty())
+    return psProgram;
+
+  return decls + funcRet + " main() : SV_Target0\n{\n" + lookup + "}\n";
+}
+
+bool CanBatchSampleGathers(const SampleGatherRequest &a, const SampleGatherShaders &aShaders,
+                           const SampleGatherRequest &b, const SampleGatherShaders &bShaders)
+{
+  // lookups with custom shaders can't be batched
+  if(aShaders.lookup.empty() || bShaders.lookup.empty())
+    return false;
+
+  // the sample bias is applied by replacing the sampler, so it must match
+  float aBias = a.opcode == OPCODE_SAMPLE_B ? a.samplerData.bias : 0.0f;
+  float bBias = b.opcode == OPCODE_SAMPLE_B ? b.samplerData.bias : 0.0f;
+
+  // the return type also determines the format of the render target
+  return aShaders.funcRet == bShaders.funcRet && aShaders.decls == bShaders.decls &&
+         aShaders.vsProgram == bShaders.vsProgram &&
+         a.resourceData.binding == b.resourceData.binding &&
+         a.samplerData.binding == b.samplerData.binding && aBias == bBias;
+}
+
+rdcstr MakeBatchedSampleGatherShader(const rdcarray<const SampleGatherShaders *> &batch)
+{
+  if(batch.size() == 1)
+    return batch[0]->GetPixelShader();
+
+  // the vertex shader covers the viewport, which is one pixel high and a pixel wide per lookup
+  rdcstr ret = batch[0]->decls;
+  ret += batch[0]->funcRet + " main(float4 pos : SV_Position) : SV_Target0\n{\n";
+  ret += "switch(uint(pos.x))\n{\n";
+  for(size_t i = 0; i < batch.size(); i++)
+    ret += StringFormat::Fmt("case %u: ", (uint32_t)i) + batch[i]->lookup;
+  ret += "}\nreturn 0;\n}\n";
+  return ret;
+}
+
+// Wraps the API wrapper while stepping a workgroup, so that the GPU operations from every lane can
+// be evaluated together. Each lane is first stepped on a throwaway copy while recording, which
+// queues up its operation instead of evaluating it. Once the whole batch has been evaluated the
+// lanes are stepped for real and the results are handed back in place of a GPU round trip each.
+class BatchedAPIWrapper : public DebugAPIWrapper
+{
+public:
+  BatchedAPIWrapper(DebugAPIWrapper *wrapped, int numLanes) : m_Wrapped(wrapped)
+  {
+    m_LaneMath.fill(numLanes, -1);
+    m_LaneSample.fill(numLanes, -1);
+  }
+
+  void BeginRecording(int lane)
+  {
+    m_Recording = true;
+    m_Lane = lane;
+  }
+
+  void Evaluate()
+  {
+    m_Recording = false;
+    if(!m_Math.empty())
+      m_Wrapped->CalculateMathIntrinsics(m_Math);
+    if(!m_Sample.empty())
+      m_Wrapped->CalculateSampleGathers(m_Sample);
+  }
+
+  void BeginStepping(int lane) { m_Lane = lane; }
+  void SetCurrentInstruction(uint32_t instruction)
+  {
+    m_Wrapped->SetCurrentInstruction(instruction);
+  }
+  void AddDebugMessage(MessageCategory c, MessageSeverity sv, MessageSource src, rdcstr d)
+  {
+    // the same message will be added again when the lane is stepped for real
+    if(!m_Recording)
+      m_Wrapped->AddDebugMessage(c, sv, src, d);
+  }
+
+  bool FetchSRV(const BindingSlot &slot) { return m_Wrapped->FetchSRV(slot); }
+  bool FetchUAV(const BindingSlot &slot) { return m_Wrapped->FetchUAV(slot); }
+  ShaderVariable GetSampleInfo(DXBCBytecode::OperandType type, bool isAbsoluteResource,
+                               const BindingSlot &slot, const char *opString)
+  {
+    return m_Wrapped->GetSampleInfo(type, isAbsoluteResource, slot, opString);
+  }
+  ShaderVariable GetBufferInfo(DXBCBytecode::OperandType type, const BindingSlot &slot,
+                               const char *opString)
+  {
+    return m_Wrapped->GetBufferInfo(type, slot, opString);
+  }
+  ShaderVariable GetResourceInfo(DXBCBytecode::OperandType type, const BindingSlot &slot,
+                                 uint32_t mipLevel, int &dim)
+  {
+    return m_Wrapped->GetResourceInfo(type, slot, mipLevel, dim);
+  }
+
+  bool CalculateMathIntrinsic(DXBCBytecode::OpcodeType opcode, const ShaderVariable &input,
+                              ShaderVariable &output1, ShaderVariable &output2)
+  {
+    if(m_Recording)
+    {
+      MathIntrinsicRequest req;
+      req.opcode = opcode;
+      req.input = input;
+
+      m_LaneMath[m_Lane] = m_Math.count();
+      m_Math.push_back(req);
+      return true;
+    }
+
+    int32_t idx = m_LaneMath[m_Lane];
+    if(idx >= 0 && m_Math[idx].opcode == opcode)
+    {
+      output1 = m_Math[idx].output1;
+      output2 = m_Math[idx].output2;
+      return m_Math[idx].succeeded;
+    }
+
+    return m_Wrapped->CalculateMathIntrinsic(opcode, input, output1, output2);
+  }
+
+  bool CalculateSampleGather(DXBCBytecode::OpcodeType opcode, SampleGatherResourceData resourceData,
+                             SampleGatherSamplerData samplerData, ShaderVariable uv,
+                             ShaderVariable ddxCalc, ShaderVariable ddyCalc,
+                             const int texelOffsets[3], int multisampleIndex,
+                             float lodOrCompareValue, const uint8_t swizzle[4],
+                             GatherChannel gatherChannel, const char *opString,
+                             ShaderVariable &output)
+  {
+    if(m_Recording)
+    {
+      SampleGatherRequest req;
+      req.opcode = opcode;
+      req.resourceData = resourceData;
+      req.samplerData = samplerData;
+      req.uv = uv;
+      req.ddxCalc = ddxCalc;
+      req.ddyCalc = ddyCalc;
+      memcpy(req.texelOffsets, texelOffsets, sizeof(req.texelOffsets));
+      req.multisampleIndex = multisampleIndex;
+      req.lodOrCompareValue = lodOrCompareValue;
+      memcpy(req.swizzle, swizzle, sizeof(req.swizzle));
+      req.gatherChannel = gatherChannel;
+      req.opString = opString;
+
+      m_LaneSample[m_Lane] = m_Sample.count();
+      m_Sample.push_back(req);
+      return true;
+    }
+
+    int32_t idx = m_LaneSample[m_Lane];
+    if(idx >= 0 && m_Sample[idx].opcode == opcode)
+    {
+      output = m_Sample[idx].output;
+      return m_Sample[idx].succeeded;
+    }
+
+    return m_Wrapped->CalculateSampleGather(opcode, resourceData, samplerData, uv, ddxCalc,
+                                            ddyCalc, texelOffsets, multisampleIndex,
+                                            lodOrCompareValue, swizzle, gatherChannel, opString,
+                                            output);
+  }
+
+private:
+  DebugAPIWrapper *m_Wrapped;
+  bool m_Recording = false;
+  int m_Lane = 0;
+
+  // the request index for each lane, or -1 if the lane didn't make one
+  rdcarray<int32_t> m_LaneMath, m_LaneSample;
+
+  rdcarray<MathIntrinsicRequest> m_Math;
+  rdcarray<SampleGatherRequest> m_Sample;
+};
+
 void DoubleSet(ShaderVariable &var, const double in[2])
 {
   var.value.d.x = in[0];
@@ -5286,6 +5529,8 @@ rdcarray<ShaderDebugState> InterpretDebugger::ContinueDebug(DXBCDebug::DebugAPIW
     steps++;
   }
 
+  const DXBCBytecode::Program *program = dxbc->GetDXBCByteCode();
+
   rdcarray<DXBCDebug::ThreadState> oldworkgroup = workgroup;
 
   rdcarray<bool> activeMask;
@@ -5296,31 +5541,78 @@ rdcarray<ShaderDebugState> InterpretDebugger::ContinueDebug(DXBCDebug::DebugAPIW
     if(active.Finished())
       break;
 
+    // calculate the current mask of which threads are active
+    CalcActiveMask(activeMask);
+
     // set up the old workgroup so that cross-workgroup/cross-quad operations (e.g. DDX/DDY) get
     // consistent results even when we step the quad out of order. Otherwise if an operation reads
     // and writes from the same register we'd trash data needed for other workgroup elements.
-    for(size_t i = 0; i < oldworkgroup.size(); i++)
-      oldworkgroup[i].variables = workgroup[i].variables;
+    // Copying the registers is expensive, so only do it when something is about to read them.
+    bool readsQuad = false;
+    for(int i = 0; i < workgroup.count(); i++)
+    {
+      uint32_t next = workgroup[i].nextInstruction;
+      if(activeMask[i] && next < program->GetNumInstructions() &&
+         OperationReadsQuad(program->GetInstruction(next).operation))
+        readsQuad = true;
+    }
 
-    // calculate the current mask of which threads are active
-    CalcActiveMask(activeMask);
+    if(readsQuad)
+    {
+      for(size_t i = 0; i < oldworkgroup.size(); i++)
+        oldworkgroup[i].variables = workgroup[i].variables;
+    }
+
+    // if more than one lane is about to evaluate something on the GPU, step a copy of each of those
+    // lanes first to collect the operations, so they can all be evaluated in one round trip.
+    int gpuLanes = 0;
+    for(int i = 0; i < workgroup.count(); i++)
+    {
+      uint32_t next = workgroup[i].nextInstruction;
+      if(activeMask[i] && next < program->GetNumInstructions() &&
+         OperationEvaluatesOnGPU(program->GetInstruction(next).operation))
+        gpuLanes++;
+    }
+
+    DXBCDebug::DebugAPIWrapper *stepWrapper = apiWrapper;
+    DXBCDebug::BatchedAPIWrapper batched(apiWrapper, workgroup.count());
+
+    if(gpuLanes > 1)
+    {
+      for(int i = 0; i < workgroup.count(); i++)
+      {
+        uint32_t next = workgroup[i].nextInstruction;
+        if(activeMask[i] && next < program->GetNumInstructions() &&
+           OperationEvaluatesOnGPU(program->GetInstruction(next).operation))
+        {
+          DXBCDebug::ThreadState lane = workgroup[i];
+          batched.BeginRecording(i);
+          lane.StepNext(NULL, &batched, oldworkgroup);
+        }
+      }
+
+      batched.Evaluate();
+      stepWrapper = &batched;
+    }
 
     // step all active members of the workgroup
     for(int i = 0; i < workgroup.count(); i++)
     {
       if(activeMask[i])
       {
+        batched.BeginStepping(i);
+
         if(i == activeLaneIndex)
         {
           ShaderDebugState state;
-          workgroup[i].StepNext(&state, apiWrapper, oldworkgroup);
+          workgroup[i].StepNext(&state, stepWrapper, oldworkgroup);
           dxbc->FillStateInstructionInfo(state);
           state.stepIndex = steps;
           ret.push_back(state);
         }
         else
         {
-          workgroup[i].StepNext(NULL, apiWrapper, oldworkgroup);
+          workgroup[i].StepNext(NULL, stepWrapper, oldworkgroup);
         }
       }
     }
@@ -5444,6 +5736,42 @@ TEST_CASE("DXBC debugging helpers", "[program]")
     flushed = flush_denorm(-foo);
     CHECK(memcmp(&flushed, &negzerof, sizeof(negzerof)) == 0);
   };
+
+  SECTION("batching sample/gather lookups")
+  {
+    SampleGatherRequest a, b;
+    a.opcode = b.opcode = OPCODE_SAMPLE_L;
+    a.resourceData.binding = b.resourceData.binding = BindingSlot(0, 0);
+    a.samplerData.binding = b.samplerData.binding = BindingSlot(0, 0);
+    a.samplerData.bias = b.samplerData.bias = 0.0f;
+
+    SampleGatherShaders aShaders, bShaders;
+    aShaders.funcRet = bShaders.funcRet = "float4";
+    aShaders.decls = bShaders.decls = "Texture2D<float4> t : register(t0);\n";
+    aShaders.vsProgram = bShaders.vsProgram = "vs";
+    aShaders.lookup = "return 1;\n";
+    bShaders.lookup = "return 2;\n";
+
+    CHECK(CanBatchSampleGathers(a, aShaders, b, bShaders));
+
+    rdcarray<const SampleGatherShaders *> batch = {&aShaders};
+    CHECK(MakeBatchedSampleGatherShader(batch) == aShaders.GetPixelShader());
+
+    batch.push_back(&bShaders);
+    rdcstr batched = MakeBatchedSampleGatherShader(batch);
+    CHECK(batched.contains("case 0: return 1;"));
+    CHECK(batched.contains("case 1: return 2;"));
+
+    // different resources, or custom shaders can't be batched
+    b.resourceData.binding = BindingSlot(1, 0);
+    CHECK_FALSE(CanBatchSampleGathers(a, aShaders, b, bShaders));
+    b.resourceData.binding = a.resourceData.binding;
+
+    bShaders.lookup.clear();
+    bShaders.psProgram = "ps";
+    CHECK_FALSE(CanBatchSampleGathers(a, aShaders, b, bShaders));
+    CHECK(bShaders.GetPixelShader() == "ps");
+  };
 };
 
 #endif    // ENABLED(ENABLE_UNIT_TESTS)
@@ -60,6 +60,10 @@ struct BindingSlot
       return registerSpace < o.registerSpace;
     return shaderRegister < o.shaderRegister;
   }
+  bool operator==(const BindingSlot &o) const
+  {
+    return registerSpace == o.registerSpace && shaderRegister == o.shaderRegister;
+  }
   uint32_t shaderRegister;
   uint32_t registerSpace;
 };
@@ -236,6 +240,61 @@ enum class GatherChannel : uint8_t
   Alpha = 3,
 };
 
+// a single GPU-evaluated transcendental operation, for evaluating several at once
+struct MathIntrinsicRequest
+{
+  DXBCBytecode::OpcodeType opcode;
+  ShaderVariable input;
+
+  ShaderVariable output1, output2;
+  bool succeeded = false;
+};
+
+// a single GPU-evaluated sample/gather operation, for evaluating several at once
+struct SampleGatherRequest
+{
+  DXBCBytecode::OpcodeType opcode;
+  SampleGatherResourceData resourceData;
+  SampleGatherSamplerData samplerData;
+  ShaderVariable uv, ddxCalc, ddyCalc;
+  int texelOffsets[3];
+  int multisampleIndex;
+  float lodOrCompareValue;
+  uint8_t swizzle[4];
+  GatherChannel gatherChannel;
+  rdcstr opString;
+
+  ShaderVariable output;
+  bool succeeded = false;
+};
+
+// the HLSL an API wrapper generates to evaluate a sample/gather on the GPU. Most lookups are a
+// single return statement in a pixel shader with no inputs, so lookups on the same resource and
+// sampler can share one pixel shader which picks the lookup by pixel, and be evaluated in one draw.
+struct SampleGatherShaders
+{
+  rdcstr funcRet;
+  rdcstr decls;
+  rdcstr vsProgram;
+
+  // the statement returning the result, if this lookup can be batched
+  rdcstr lookup;
+  // the full pixel shader for lookups that need their own vertex shader, and can't be batched
+  rdcstr psProgram;
+
+  rdcstr GetPixelShader() const;
+};
+
+// the most lookups or math operations to evaluate in one draw or dispatch
+static const uint32_t MaxSampleGatherBatch = 64;
+static const uint32_t MaxMathIntrinsicBatch = 64;
+
+bool CanBatchSampleGathers(const SampleGatherRequest &a, const SampleGatherShaders &aShaders,
+                           const SampleGatherRequest &b, const SampleGatherShaders &bShaders);
+
+// the pixel shader to evaluate the given lookups together, each in the pixel at its index
+rdcstr MakeBatchedSampleGatherShader(const rdcarray<const SampleGatherShaders *> &batch);
+
 class DebugAPIWrapper
 {
 public:
@@ -267,6 +326,12 @@ public:
                                      float lodOrCompareValue, const uint8_t swizzle[4],
                                      GatherChannel gatherChannel, const char *opString,
                                      ShaderVariable &output) = 0;
+
+  // evaluate a set of independent operations, e.g. the same instruction in each lane of a quad.
+  // Implementations should do this in as few GPU round trips as possible, the default just
+  // evaluates each request on its own.
+  virtual void CalculateMathIntrinsics(rdcarray<MathIntrinsicRequest> &requests);
+  virtual void CalculateSampleGathers(rdcarray<SampleGatherRequest> &requests);
 };
 
 class ThreadState
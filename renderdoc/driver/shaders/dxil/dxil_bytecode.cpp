@@ -37,6 +37,11 @@
 #undef LABEL
 #undef OPAQUE
 
+// uncomment this to log the full decoded bitcode tree and metadata of every program
+#define DXIL_DUMP_BITCODE OPTION_OFF
+
+#define IS_KNOWN(val, KnownID) (decltype(KnownID)(val) == KnownID)
+
 namespace DXIL
 {
 struct ProgramHeader
@@ -216,6 +221,7 @@ enum class TypeRecord : uint32_t
   TOKEN = 22,
 };
 
+#if ENABLED(DXIL_DUMP_BITCODE)
 static rdcstr getName(uint32_t parentBlock, const LLVMBC::BlockOrRecord &block)
 {
   const char *name = NULL;
@@ -540,47 +546,11 @@ static void dumpBlock(const LLVMBC::BlockOrRecord &block, int indent)
   RDCLOG("%s", line.c_str());
 }
 
-Program::Program(const byte *bytes, size_t length)
+static void dumpModule(const LLVMBC::BlockOrRecord &root)
 {
-  const byte *ptr = bytes;
-  const ProgramHeader *header = (const ProgramHeader *)ptr;
-  RDCASSERT(header->DxilMagic == MAKE_FOURCC('D', 'X', 'I', 'L'));
-
-  const byte *bitcode = ((const byte *)&header->DxilMagic) + header->BitcodeOffset;
-  RDCASSERT(bitcode + header->BitcodeSize == ptr + length);
-
-  LLVMBC::BitcodeReader reader(bitcode, header->BitcodeSize);
-
-  LLVMBC::BlockOrRecord root = reader.ReadToplevelBlock();
-
-  // the top-level block should be MODULE_BLOCK
-  RDCASSERT(KnownBlocks(root.id) == KnownBlocks::MODULE_BLOCK);
-
-  // we should have consumed all bits, only one top-level block
-  RDCASSERT(reader.AtEndOfStream());
-
-  m_Type = DXBC::ShaderType(header->ProgramType);
-  m_Major = (header->ProgramVersion & 0xf0) >> 4;
-  m_Minor = header->ProgramVersion & 0xf;
-
-  // Input signature and Output signature haven't changed.
-  // Pipeline Runtime Information we have decoded just not implemented here
-
-  rdcstr datalayout, triple;
-
-#define IS_KNOWN(val, KnownID) (decltype(KnownID)(val) == KnownID)
-
   for(const LLVMBC::BlockOrRecord &rootblock : root.children)
   {
-    if(rootblock.IsRecord() && IS_KNOWN(rootblock.id, ModuleRecord::TRIPLE))
-    {
-      m_Triple = rootblock.getString();
-    }
-    else if(rootblock.IsRecord() && IS_KNOWN(rootblock.id, ModuleRecord::DATALAYOUT))
-    {
-      m_Datalayout = rootblock.getString();
-    }
-    else if(rootblock.IsBlock() && IS_KNOWN(rootblock.id, KnownBlocks::VALUE_SYMTAB_BLOCK))
+    if(rootblock.IsBlock() && IS_KNOWN(rootblock.id, KnownBlocks::VALUE_SYMTAB_BLOCK))
     {
       for(const LLVMBC::BlockOrRecord &symtab : rootblock.children)
       {
@@ -764,6 +734,78 @@ Program::Program(const byte *bytes, size_t length)
 
   dumpBlock(root, 0);
 }
+#endif
+
+// streams the module, picking out only the records we need and skipping over every sub-block
+// without decoding it.
+class ModuleVisitor : public LLVMBC::BitcodeVisitor
+{
+public:
+  ModuleVisitor(rdcstr &triple, rdcstr &datalayout) : m_Triple(triple), m_Datalayout(datalayout) {}
+  bool BlockEnter(uint32_t blockId, uint32_t blockDwordLength)
+  {
+    m_Depth++;
+
+    // the top-level block should be MODULE_BLOCK
+    if(m_Depth == 1)
+    {
+      RDCASSERT(IS_KNOWN(blockId, KnownBlocks::MODULE_BLOCK));
+      return true;
+    }
+
+    return false;
+  }
+  void BlockExit(uint32_t blockId) { m_Depth--; }
+  void Record(uint32_t blockId, const LLVMBC::BlockOrRecord &record)
+  {
+    if(m_Depth != 1)
+      return;
+
+    if(IS_KNOWN(record.id, ModuleRecord::TRIPLE))
+      m_Triple = record.getString();
+    else if(IS_KNOWN(record.id, ModuleRecord::DATALAYOUT))
+      m_Datalayout = record.getString();
+  }
+
+private:
+  rdcstr &m_Triple;
+  rdcstr &m_Datalayout;
+  uint32_t m_Depth = 0;
+};
+
+Program::Program(const byte *bytes, size_t length)
+{
+  const byte *ptr = bytes;
+  const ProgramHeader *header = (const ProgramHeader *)ptr;
+  RDCASSERT(header->DxilMagic == MAKE_FOURCC('D', 'X', 'I', 'L'));
+
+  const byte *bitcode = ((const byte *)&header->DxilMagic) + header->BitcodeOffset;
+  RDCASSERT(bitcode + header->BitcodeSize == ptr + length);
+
+  m_Type = DXBC::ShaderType(header->ProgramType);
+  m_Major = (header->ProgramVersion & 0xf0) >> 4;
+  m_Minor = header->ProgramVersion & 0xf;
+
+  // Input signature and Output signature haven't changed.
+  // Pipeline Runtime Information we have decoded just not implemented here
+
+  {
+    LLVMBC::BitcodeReader reader(bitcode, header->BitcodeSize);
+
+    ModuleVisitor visitor(m_Triple, m_Datalayout);
+    reader.ReadToplevelBlock(visitor);
+
+    // we should have consumed all bits, only one top-level block
+    RDCASSERT(reader.AtEndOfStream());
+  }
+
+#if ENABLED(DXIL_DUMP_BITCODE)
+  {
+    LLVMBC::BitcodeReader reader(bitcode, header->BitcodeSize);
+    dumpModule(reader.ReadToplevelBlock());
+  }
+#endif
+}
 
 void Program::FetchComputeProperties(DXBC::Reflection *reflection)
 {
@@ -95,17 +95,56 @@ BitcodeReader::~BitcodeReader()
     delete it->second;
 }
 
+// builds the full tree of blocks and records from the streaming decode
+class TreeBuilder : public BitcodeVisitor
+{
+public:
+  TreeBuilder(BlockOrRecord &root) : m_Root(root) {}
+  bool BlockEnter(uint32_t blockId, uint32_t blockDwordLength)
+  {
+    BlockOrRecord *block = &m_Root;
+
+    // pointers on the stack remain valid, since only the innermost block gets children added
+    if(!m_Stack.empty())
+    {
+      m_Stack.back()->children.push_back(BlockOrRecord());
+      block = &m_Stack.back()->children.back();
+    }
+
+    block->id = blockId;
+    block->blockDwordLength = blockDwordLength;
+
+    m_Stack.push_back(block);
+    return true;
+  }
+  void BlockExit(uint32_t blockId) { m_Stack.pop_back(); }
+  void Record(uint32_t blockId, const BlockOrRecord &record)
+  {
+    m_Stack.back()->children.push_back(record);
+  }
+
+private:
+  BlockOrRecord &m_Root;
+  rdcarray<BlockOrRecord *> m_Stack;
+};
+
 BlockOrRecord BitcodeReader::ReadToplevelBlock()
 {
   BlockOrRecord ret;
 
+  TreeBuilder builder(ret);
+  ReadToplevelBlock(builder);
+
+  return ret;
+}
+
+void BitcodeReader::ReadToplevelBlock(BitcodeVisitor &visitor)
+{
   // should hit ENTER_SUBBLOCK first for top-level block
   uint32_t abbrevID = b.fixed<uint32_t>(abbrevSize());
   RDCASSERT(abbrevID == ENTER_SUBBLOCK);
 
-  ReadBlockContents(ret);
-
-  return ret;
+  ReadBlockContents(visitor);
 }
 
 bool BitcodeReader::AtEndOfStream()
@@ -113,14 +152,26 @@ bool BitcodeReader::AtEndOfStream()
   return b.AtEndOfStream();
 }
 
-void BitcodeReader::ReadBlockContents(BlockOrRecord &block)
+void BitcodeReader::ReadBlockContents(BitcodeVisitor &visitor)
 {
-  block.id = b.vbr<uint32_t>(8);
-
-  blockStack.push_back(new BlockContext(b.vbr<size_t>(4)));
+  const uint32_t blockId = b.vbr<uint32_t>(8);
+  const size_t blockAbbrevSize = b.vbr<size_t>(4);
 
   b.align32bits();
-  block.blockDwordLength = b.Read<uint32_t>();
+  const uint32_t blockDwordLength = b.Read<uint32_t>();
+
+  const bool visit = visitor.BlockEnter(blockId, blockDwordLength);
+
+  // the length gives us the end of the block directly, so skipped blocks cost nothing to decode.
+  // BLOCKINFO is block 0 and must always be read even if its records aren't visited.
+  if(!visit && blockId != 0)
+  {
+    b.SeekByte(b.ByteOffset() + blockDwordLength * sizeof(uint32_t));
+    visitor.BlockExit(blockId);
+    return;
+  }
+
+  blockStack.push_back(new BlockContext(blockAbbrevSize));
 
   // used for blockinfo only
   BlockInfo *curBlockInfo = NULL;
@@ -136,11 +187,7 @@ void BitcodeReader::ReadBlockContents(BlockOrRecord &block)
     }
     else if(abbrevID == ENTER_SUBBLOCK)
     {
-      BlockOrRecord sub;
-
-      ReadBlockContents(sub);
-
-      block.children.push_back(sub);
+      ReadBlockContents(visitor);
     }
     else if(abbrevID == DEFINE_ABBREV)
     {
@@ -179,14 +226,16 @@ void BitcodeReader::ReadBlockContents(BlockOrRecord &block)
     }
     else if(abbrevID == UNABBREV_RECORD)
     {
-      BlockOrRecord r;
+      BlockOrRecord &r = record;
+      r.blob = NULL;
+      r.blobLength = 0;
       r.id = b.vbr<uint32_t>(6);
       uint32_t numops = b.vbr<uint32_t>(6);
       r.ops.resize(numops);
       for(uint32_t i = 0; i < numops; i++)
         r.ops[i] = b.vbr<uint64_t>(6);
 
-      if(block.id == 0)    // BLOCKINFO is block 0
+      if(blockId == 0)    // BLOCKINFO is block 0
       {
         switch(BlockInfoRecord(r.id))
         {
@@ -222,13 +271,17 @@ void BitcodeReader::ReadBlockContents(BlockOrRecord &block)
         }
       }
 
-      block.children.push_back(r);
+      if(visit)
+        visitor.Record(blockId, r);
     }
     else
     {
-      const AbbrevDesc &a = getAbbrev(block.id, abbrevID);
+      const AbbrevDesc &a = getAbbrev(blockId, abbrevID);
 
-      BlockOrRecord r;
+      BlockOrRecord &r = record;
+      r.ops.clear();
+      r.blob = NULL;
+      r.blobLength = 0;
 
       // should have at least one param for the code itself
       RDCASSERT(!a.params.empty());
@@ -270,12 +323,15 @@ void BitcodeReader::ReadBlockContents(BlockOrRecord &block)
         }
       }
 
-      block.children.push_back(r);
+      if(visit)
+        visitor.Record(blockId, r);
     }
   } while(abbrevID != END_BLOCK);
 
   delete blockStack.back();
   blockStack.erase(blockStack.size() - 1);
+
+  visitor.BlockExit(blockId);
 }
 
 uint64_t BitcodeReader::decodeAbbrevParam(const AbbrevParam &param)
@@ -937,4 +993,155 @@ TEST_CASE("Check LLVM bitreader", "[llvm]")
   }
 }
 
+TEST_CASE("Check LLVM bitcode streaming", "[llvm]")
+{
+  // minimal bit writer to construct a bitstream by hand
+  rdcarray<byte> bits;
+  size_t bitOffset = 0;
+
+  auto fixed = [&](uint64_t val, size_t width) {
+    for(size_t i = 0; i < width; i++, bitOffset++)
+    {
+      if(bitOffset / 8 >= bits.size())
+        bits.push_back(0);
+      if(val & (1ULL << i))
+        bits[bitOffset / 8] |= byte(1 << (bitOffset % 8));
+    }
+  };
+  auto vbr = [&](uint64_t val, size_t width) {
+    const uint64_t hibit = 1ULL << (width - 1);
+    while(val >= hibit)
+    {
+      fixed((val & (hibit - 1)) | hibit, width);
+      val >>= (width - 1);
+    }
+    fixed(val, width);
+  };
+  auto align32 = [&]() {
+    while(bitOffset % 32)
+      fixed(0, 1);
+  };
+
+  const size_t abbrevWidth = 3;
+
+  auto enterBlock = [&](size_t parentWidth, uint32_t id) {
+    fixed(LLVMBC::ENTER_SUBBLOCK, parentWidth);
+    vbr(id, 8);
+    vbr(abbrevWidth, 4);
+    align32();
+    size_t lengthOffset = bits.size();
+    fixed(0, 32);
+    return lengthOffset;
+  };
+  auto exitBlock = [&](size_t lengthOffset) {
+    fixed(LLVMBC::END_BLOCK, abbrevWidth);
+    align32();
+    uint32_t length = uint32_t(bits.size() - lengthOffset - sizeof(uint32_t)) / 4;
+    memcpy(&bits[lengthOffset], &length, sizeof(length));
+  };
+  auto record = [&](uint32_t id, std::initializer_list<uint64_t> ops) {
+    fixed(LLVMBC::UNABBREV_RECORD, abbrevWidth);
+    vbr(id, 6);
+    vbr(ops.size(), 6);
+    for(uint64_t op : ops)
+      vbr(op, 6);
+  };
+
+  fixed('B', 8);
+  fixed('C', 8);
+  fixed(0xC0, 8);
+  fixed(0xDE, 8);
+
+  size_t outer = enterBlock(2, 8);
+  record(2, {1, 2, 300});
+  size_t inner = enterBlock(abbrevWidth, 12);
+  record(5, {7});
+  exitBlock(inner);
+  record(3, {4});
+  exitBlock(outer);
+
+  SECTION("Check tree decode")
+  {
+    LLVMBC::BitcodeReader reader(bits.data(), bits.size());
+
+    LLVMBC::BlockOrRecord root = reader.ReadToplevelBlock();
+
+    CHECK(reader.AtEndOfStream());
+
+    CHECK(root.IsBlock());
+    CHECK(root.id == 8);
+    REQUIRE(root.children.size() == 3);
+
+    CHECK(root.children[0].IsRecord());
+    CHECK(root.children[0].id == 2);
+    CHECK(root.children[0].ops == rdcarray<uint64_t>({1, 2, 300}));
+
+    CHECK(root.children[1].IsBlock());
+    CHECK(root.children[1].id == 12);
+    REQUIRE(root.children[1].children.size() == 1);
+    CHECK(root.children[1].children[0].id == 5);
+    CHECK(root.children[1].children[0].ops == rdcarray<uint64_t>({7}));
+
+    CHECK(root.children[2].IsRecord());
+    CHECK(root.children[2].id == 3);
+    CHECK(root.children[2].ops == rdcarray<uint64_t>({4}));
+  }
+
+  class EventLogger : public LLVMBC::BitcodeVisitor
+  {
+  public:
+    EventLogger(uint32_t skip) : m_Skip(skip) {}
+    bool BlockEnter(uint32_t blockId, uint32_t blockDwordLength)
+    {
+      events.push_back("+" + ToStr(blockId) + ":" + ToStr(blockDwordLength));
+      return blockId != m_Skip;
+    }
+    void BlockExit(uint32_t blockId) { events.push_back("-" + ToStr(blockId)); }
+    void Record(uint32_t blockId, const LLVMBC::BlockOrRecord &record)
+    {
+      rdcstr ev = ToStr(record.id) + ":";
+      for(size_t i = 0; i < record.ops.size(); i++)
+        ev += (i > 0 ? "," : "") + ToStr(record.ops[i]);
+      events.push_back(ev);
+    }
+
+    rdcarray<rdcstr> events;
+
+  private:
+    uint32_t m_Skip;
+  };
+
+  SECTION("Check streaming decode visits everything in order")
+  {
+    LLVMBC::BitcodeReader reader(bits.data(), bits.size());
+
+    EventLogger logger(~0U);
+    reader.ReadToplevelBlock(logger);
+
+    CHECK(reader.AtEndOfStream());
+
+    rdcarray<rdcstr> expected = {
+        "+8:5", "2:1,2,300", "+12:1", "5:7", "-12", "3:4", "-8",
+    };
+
+    CHECK(logger.events == expected);
+  }
+
+  SECTION("Check streaming decode can skip blocks")
+  {
+    LLVMBC::BitcodeReader reader(bits.data(), bits.size());
+
+    EventLogger logger(12);
+    reader.ReadToplevelBlock(logger);
+
+    CHECK(reader.AtEndOfStream());
+
+    rdcarray<rdcstr> expected = {
+        "+8:5", "2:1,2,300", "+12:1", "-12", "3:4", "-8",
+    };
+
+    CHECK(logger.events == expected);
+  }
+}
+
 #endif
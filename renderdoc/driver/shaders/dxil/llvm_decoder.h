@@ -51,6 +51,21 @@ struct BlockOrRecord
   size_t blobLength = 0;
 };
 
+// interface for streaming decode. Blocks and records are visited in stream order without building a
+// tree of the whole module, so only what the visitor keeps is retained.
+class BitcodeVisitor
+{
+public:
+  virtual ~BitcodeVisitor() {}
+  // return false to skip over the block and all of its children without decoding them. BLOCKINFO
+  // is always processed internally since it defines abbreviations, but its records are only
+  // visited if requested. BlockExit is called once for every BlockEnter, even if skipped.
+  virtual bool BlockEnter(uint32_t blockId, uint32_t blockDwordLength) = 0;
+  virtual void BlockExit(uint32_t blockId) = 0;
+  // the record is only valid for the duration of the call, its storage is re-used
+  virtual void Record(uint32_t blockId, const BlockOrRecord &record) = 0;
+};
+
 struct AbbrevParam;
 struct AbbrevDesc;
 struct BlockContext;
@@ -62,18 +77,22 @@ public:
   BitcodeReader(const byte *bitcode, size_t length);
   ~BitcodeReader();
   BlockOrRecord ReadToplevelBlock();
+  void ReadToplevelBlock(BitcodeVisitor &visitor);
   bool AtEndOfStream();
 
 private:
   BitReader b;
 
-  void ReadBlockContents(BlockOrRecord &block);
+  void ReadBlockContents(BitcodeVisitor &visitor);
   const AbbrevDesc &getAbbrev(uint32_t blockId, uint32_t abbrevID);
   size_t abbrevSize() const;
   uint64_t decodeAbbrevParam(const AbbrevParam &param);
 
   rdcarray<BlockContext *> blockStack;
   std::map<uint32_t, BlockInfo *> blockInfo;
+
+  // scratch storage for the record currently being decoded
+  BlockOrRecord record;
 };
 
 };    // namespace LLVMBC
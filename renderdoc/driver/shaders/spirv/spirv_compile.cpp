@@ -82,6 +82,12 @@ rdcstr rdcspv::Compile(const rdcspv::CompilationSettings &settings, const rdcarr
     if(settings.debugInfo)
       flags = EShMessages(flags | EShMsgDebugInfo);
 
+    if(settings.vulkan11)
+    {
+      shader->setEnvClient(glslang::EShClientVulkan, glslang::EShTargetVulkan_1_1);
+      shader->setEnvTarget(glslang::EShTargetSpv, glslang::EShTargetSpv_1_3);
+    }
+
     bool success = shader->parse(GetDefaultResources(), 110, false, flags);
 
     if(!success)
@@ -56,6 +56,8 @@ struct CompilationSettings
   ShaderStage stage = ShaderStage::Invalid;
   InputLanguage lang = InputLanguage::Unknown;
   bool debugInfo = false;
+  // target Vulkan 1.1 / SPIR-V 1.3 instead of the default 1.0, needed for subgroup operations
+  bool vulkan11 = false;
   rdcstr entryPoint;
 };
 
@@ -244,7 +244,7 @@ void ThreadState::JumpToLabel(Id target)
   Iter it = debugger.GetIterForInstruction(nextInstruction);
   if(it.opcode() == Op::LoopMerge)
   {
-    it++;
+    it = debugger.GetIterForInstruction(debugger.GetExecutedInstruction(nextInstruction));
     if(it.opcode() == Op::Branch)
     {
       JumpToLabel(OpBranch(it).targetLabel);
@@ -255,27 +255,14 @@ void ThreadState::JumpToLabel(Id target)
 void ThreadState::StepNext(ShaderDebugState *state,
                            const rdcarray<rdcarray<ShaderVariable>> &prevWorkgroup)
 {
-  Iter it = debugger.GetIterForInstruction(nextInstruction);
-  nextInstruction++;
-
-  OpDecoder opdata(it);
+  // skip any OpLine/OpNoLine, and merge statements since for now we don't care about structured
+  // control flow. This was worked out when parsing so we can go straight there.
+  uint32_t executing = debugger.GetExecutedInstruction(nextInstruction);
+  nextInstruction = executing + 1;
 
-  // skip OpLine/OpNoLine
-  while(opdata.op == Op::Line || opdata.op == Op::NoLine)
-  {
-    it++;
-    nextInstruction++;
-    opdata = OpDecoder(it);
-  }
+  Iter it = debugger.GetIterForInstruction(executing);
 
-  // for now we don't care about structured control flow so skip past merge statements so we process
-  // the branch. OpLine can't be in between so we can safely advance
-  if(opdata.op == Op::SelectionMerge || opdata.op == Op::LoopMerge)
-  {
-    it++;
-    nextInstruction++;
-    opdata = OpDecoder(it);
-  }
+  OpDecoder opdata(it);
 
   switch(opdata.op)
   {
@@ -1102,10 +1089,7 @@ void ThreadState::StepNext(ShaderDebugState *state,
     {
       Id target = OpBranch(it).targetLabel;
 
-      it++;
-
-      while(it.opcode() == Op::Line || it.opcode() == Op::NoLine)
-        it++;
+      it = debugger.GetIterForInstruction(debugger.GetExecutedInstruction(nextInstruction + 1));
 
       if(target == OpLabel(it).result)
       {
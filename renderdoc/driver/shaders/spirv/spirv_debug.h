@@ -160,6 +160,7 @@ public:
   ShaderVariable MakeCompositePointer(const ShaderVariable &base, Id id, rdcarray<uint32_t> &indices);
 
   uint32_t GetNumInstructions() { return (uint32_t)instructionOffsets.size(); }
+  uint32_t GetExecutedInstruction(uint32_t inst) const { return instructionInfo[inst].execute; }
   GlobalState GetGlobal() { return global; }
   const rdcarray<Id> &GetLiveGlobals() { return liveGlobals; }
   const rdcarray<SourceVariableMapping> &GetGlobalSourceVars() { return globalSourceVars; }
@@ -203,9 +204,9 @@ private:
   rdcarray<MemberName> memberNames;
   std::map<rdcstr, Id> entryLookup;
 
-  SparseIdMap<size_t> idDeathOffset;
+  DenseIdMap<size_t> idDeathOffset;
 
-  SparseIdMap<uint32_t> labelInstruction;
+  DenseIdMap<uint32_t> labelInstruction;
 
   // the live mutable global variables, to initialise a stack frame's live list
   rdcarray<Id> liveGlobals;
@@ -214,6 +215,7 @@ private:
   struct Function
   {
     size_t begin = 0;
+    uint32_t beginInstruction = 0;
     rdcarray<Id> parameters;
     rdcarray<Id> variables;
   };
@@ -223,6 +225,19 @@ private:
 
   rdcarray<size_t> instructionOffsets;
 
+  // decoded once after parsing for each instruction, so that stepping doesn't need to re-parse
+  // anything to find what to execute next.
+  struct InstructionInfo
+  {
+    // the instruction that's actually executed when stepping to this one. We skip over OpLine,
+    // OpNoLine and merge instructions since we don't care about structured control flow
+    uint32_t execute = 0;
+    // whether the executed instruction reads values from other lanes in the workgroup
+    bool crossLane = false;
+  };
+
+  rdcarray<InstructionInfo> instructionInfo;
+
   std::set<rdcstr> usedNames;
   std::map<Id, rdcstr> dynamicNames;
   void CalcActiveMask(rdcarray<bool> &activeMask);
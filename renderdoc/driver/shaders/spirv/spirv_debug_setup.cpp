@@ -66,12 +66,16 @@ Iter Debugger::GetIterForInstruction(uint32_t inst)
 
 uint32_t Debugger::GetInstructionForIter(Iter it)
 {
-  return instructionOffsets.indexOf(it.offs());
+  // instructions are registered in order so the offsets are sorted
+  auto found = std::lower_bound(instructionOffsets.begin(), instructionOffsets.end(), it.offs());
+  if(found == instructionOffsets.end() || *found != it.offs())
+    return ~0U;
+  return uint32_t(found - instructionOffsets.begin());
 }
 
 uint32_t Debugger::GetInstructionForFunction(Id id)
 {
-  return instructionOffsets.indexOf(functions[id].begin);
+  return functions[id].beginInstruction;
 }
 
 uint32_t Debugger::GetInstructionForLabel(Id id)
@@ -226,7 +230,7 @@ ShaderDebugTrace *Debugger::BeginDebug(DebugAPIWrapper *apiWrapper, const Shader
 
   ThreadState &active = GetActiveLane();
 
-  active.nextInstruction = instructionOffsets.indexOf(functions[entryId].begin);
+  active.nextInstruction = GetInstructionForFunction(entryId);
 
   active.ids.resize(idOffsets.size());
 
@@ -435,8 +439,20 @@ rdcarray<ShaderDebugState> Debugger::ContinueDebug()
     // set up the old workgroup so that cross-workgroup/cross-quad operations (e.g. DDX/DDY) get
     // consistent results even when we step the quad out of order. Otherwise if an operation reads
     // and writes from the same register we'd trash data needed for other workgroup elements.
-    for(size_t i = 0; i < oldworkgroup.size(); i++)
-      oldworkgroup[i] = workgroup[i].ids;
+    // Copying every ID is expensive, so only do it when something is about to read another lane.
+    bool crossLane = false;
+    for(const ThreadState &thread : workgroup)
+    {
+      if(thread.nextInstruction < instructionInfo.size() &&
+         instructionInfo[thread.nextInstruction].crossLane)
+        crossLane = true;
+    }
+
+    if(crossLane)
+    {
+      for(size_t i = 0; i < oldworkgroup.size(); i++)
+        oldworkgroup[i] = workgroup[i].ids;
+    }
 
     // calculate the current mask of which threads are active
     CalcActiveMask(activeMask);
@@ -1025,6 +1041,8 @@ void Debugger::PreParse(uint32_t maxId)
   Processor::PreParse(maxId);
 
   strings.resize(idTypes.size());
+  idDeathOffset.resize(idTypes.size());
+  labelInstruction.resize(idTypes.size());
 }
 
 void Debugger::PostParse()
@@ -1039,6 +1057,47 @@ void Debugger::PostParse()
     idDeathOffset[v.id] = ~0U;
 
   memberNames.clear();
+
+  const uint32_t numInstructions = (uint32_t)instructionOffsets.size();
+
+  rdcarray<Op> ops;
+  ops.resize(numInstructions);
+  for(uint32_t i = 0; i < numInstructions; i++)
+    ops[i] = Iter(m_SPIRV, instructionOffsets[i]).opcode();
+
+  instructionInfo.resize(numInstructions);
+  for(uint32_t i = 0; i < numInstructions; i++)
+  {
+    uint32_t exec = i;
+
+    while(exec + 1 < numInstructions && (ops[exec] == Op::Line || ops[exec] == Op::NoLine))
+      exec++;
+
+    // OpLine can't be between a merge and its branch, so we can safely skip just one
+    if(exec + 1 < numInstructions &&
+       (ops[exec] == Op::SelectionMerge || ops[exec] == Op::LoopMerge))
+      exec++;
+
+    InstructionInfo &info = instructionInfo[i];
+    info.execute = exec;
+
+    switch(ops[exec])
+    {
+      case Op::DPdx:
+      case Op::DPdy:
+      case Op::Fwidth:
+      case Op::DPdxFine:
+      case Op::DPdyFine:
+      case Op::FwidthFine:
+      case Op::DPdxCoarse:
+      case Op::DPdyCoarse:
+      case Op::FwidthCoarse: info.crossLane = true; break;
+      default:
+        info.crossLane = ops[exec] >= Op::GroupNonUniformElect &&
+                         ops[exec] <= Op::GroupNonUniformQuadSwap;
+        break;
+    }
+  }
 }
 
 void Debugger::RegisterOp(Iter it)
@@ -1091,6 +1150,7 @@ void Debugger::RegisterOp(Iter it)
     curFunction = &functions[func.result];
 
     curFunction->begin = it.offs();
+    curFunction->beginInstruction = instructionOffsets.count();
   }
   else if(opdata.op == Op::FunctionParameter)
   {
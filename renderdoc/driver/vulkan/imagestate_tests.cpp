@@ -730,6 +730,69 @@ TEST_CASE("Test ImageState type", "[imagestate]")
       CheckSubresourceState(it->state(), readSubstate);
     }
   };
+
+  SECTION("Full range use unsplits")
+  {
+    ImageState state(image, imageInfo, eFrameRef_None);
+
+    // read every array layer separately, which splits the layers
+    for(uint32_t layer = 0; layer < (uint32_t)imageInfo.layerCount; ++layer)
+    {
+      ImageSubresourceRange range = imageInfo.FullRange();
+      range.baseArrayLayer = layer;
+      range.layerCount = 1;
+      state.RecordUse(range, eFrameRef_Read, 0);
+    }
+    CheckSubresourceRanges(state, false, false, true, false);
+
+    // a use of the whole image leaves it uniform, so it should collapse without an explicit Unsplit
+    state.RecordUse(imageInfo.FullRange(), eFrameRef_Read, 0);
+    state.RecordUse(imageInfo.FullRange(), eFrameRef_CompleteWrite, 0);
+    CheckSubresourceRanges(state, false, false, false, false);
+  };
+
+  SECTION("Coalesce array layer barriers")
+  {
+    ImageState state(image, imageInfo, eFrameRef_None);
+    ImageSubresourceRange range = imageInfo.FullRange();
+    range.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
+    range.baseMipLevel = 0;
+    range.levelCount = 1;
+    range.baseArrayLayer = 2;
+    range.layerCount = 5;
+
+    VkImageMemoryBarrier barrier = {
+        /* sType = */ VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+        /* pNext = */ NULL,
+        /* srcAccessMask = */ 0,
+        /* dstAccessMask = */ 0,
+        /* oldLayout = */ VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+        /* newLayout = */ VK_IMAGE_LAYOUT_GENERAL,
+        /* srcQueueFamilyIndex = */ 0,
+        /* dstQueueFamilyIndex = */ 0,
+        /* image = */ image,
+        /* subresourceRange = */ range,
+    };
+    state.RecordBarrier(barrier, 0, transitionInfo);
+    CheckSubresourceRanges(state, true, true, true, false);
+
+    // resetting the split image only needs one barrier for the run of layers that changed layout,
+    // rather than one per layer.
+    ImageBarrierSequence barriers;
+    state.ResetToOldState(barriers, transitionInfo);
+    REQUIRE(barriers.size() == 1);
+
+    const VkImageMemoryBarrier *reset = NULL;
+    for(uint32_t b = 0; b < ImageBarrierSequence::MAX_BATCH_COUNT; ++b)
+      for(uint32_t q = 0; q < ImageBarrierSequence::MAX_QUEUE_FAMILY_COUNT; ++q)
+        if(!barriers.batches[b][q].empty())
+          reset = &barriers.batches[b][q][0];
+    REQUIRE(reset != NULL);
+    CHECK(reset->oldLayout == VK_IMAGE_LAYOUT_GENERAL);
+    CHECK(reset->newLayout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    CHECK(reset->subresourceRange.baseArrayLayer == 2);
+    CHECK(reset->subresourceRange.layerCount == 5);
+  };
 };
 
 #endif    // ENABLED(ENABLE_UNIT_TESTS)
@@ -514,9 +514,10 @@ void AnnotateShader(const SPIRVPatchData &patchData, const char *entryName,
   }
 }
 
-void VulkanReplay::ClearFeedbackCache()
+void VulkanReplay::ClearFeedbackCache(uint32_t fromEventId)
 {
-  m_BindlessFeedback.Usage.clear();
+  m_BindlessFeedback.Usage.erase(m_BindlessFeedback.Usage.lower_bound(fromEventId),
+                                 m_BindlessFeedback.Usage.end());
 }
 
 void VulkanReplay::FetchShaderFeedback(uint32_t eventId)
@@ -524,6 +525,41 @@ void VulkanReplay::FetchShaderFeedback(uint32_t eventId)
   if(m_BindlessFeedback.Usage.find(eventId) != m_BindlessFeedback.Usage.end())
     return;
 
+  // if nothing was run there's no array descriptor usage to find, and nothing to restore
+  if(!CollectShaderFeedback(eventId))
+    return;
+
+  // the current state is at this event so it's cheap to step forward through the draws after it
+  // while they're in the same partial replay, and collect their feedback now too. That way
+  // stepping through a pass doesn't run an instrumented draw and a full replay on every event.
+  const DrawcallDescription *drawcall = m_pDriver->GetDrawcall(eventId);
+  size_t prefetched = 0;
+  for(const DrawcallDescription *next = drawcall->next;
+      next && prefetched < FeedbackMaxPrefetchEvents; next = next->next)
+  {
+    if(!(next->flags & (DrawFlags::Dispatch | DrawFlags::Drawcall)))
+      continue;
+
+    if(m_BindlessFeedback.Usage.find(next->eventId) != m_BindlessFeedback.Usage.end())
+      continue;
+
+    // don't pay for a full replay to get here, stop at the end of the forward replayable range
+    if(!m_pDriver->CanReplayForwardTo(next->eventId))
+      break;
+
+    m_pDriver->ReplayToEvent(next->eventId, eReplay_WithoutDraw);
+
+    CollectShaderFeedback(next->eventId);
+    prefetched++;
+  }
+
+  // replay from the start as we may have corrupted state while fetching the above feedback.
+  m_pDriver->ReplayLog(0, eventId, eReplay_Full);
+}
+
+bool VulkanReplay::CollectShaderFeedback(uint32_t eventId)
+{
+
   // create it here so we won't re-run any code if the event is re-selected. We'll mark it as valid
   // if it actually has any data in it later.
   DynamicUsedBinds &result = m_BindlessFeedback.Usage[eventId];
@@ -540,14 +576,14 @@ void VulkanReplay::FetchShaderFeedback(uint32_t eventId)
   const DrawcallDescription *drawcall = m_pDriver->GetDrawcall(eventId);
 
   if(drawcall == NULL || !(drawcall->flags & (DrawFlags::Dispatch | DrawFlags::Drawcall)))
-    return;
+    return false;
 
   result.compute = bool(drawcall->flags & DrawFlags::Dispatch);
 
   const VulkanStatePipeline &pipe = result.compute ? state.compute : state.graphics;
 
   if(pipe.pipeline == ResourceId())
-    return;
+    return false;
 
   const VulkanCreationInfo::Pipeline &pipeInfo = creationInfo.m_Pipeline[pipe.pipeline];
 
@@ -590,7 +626,7 @@ void VulkanReplay::FetchShaderFeedback(uint32_t eventId)
 
   // if we don't have any array descriptors to feedback then just return now
   if(offsetMap.empty())
-    return;
+    return false;
 
   // we go through the driver for all these creations since they need to be properly
   // registered in order to be put in the partial replay state
@@ -713,7 +749,7 @@ void VulkanReplay::FetchShaderFeedback(uint32_t eventId)
     const VulkanCreationInfo::ShaderModule &moduleInfo =
         creationInfo.m_ShaderModule[pipeInfo.shaders[5].module];
 
-    rdcarray<uint32_t> modSpirv = moduleInfo.spirv.GetSPIRV();
+    rdcarray<uint32_t> modSpirv = moduleInfo.GetSPIRV().GetSPIRV();
 
     AnnotateShader(*pipeInfo.shaders[5].patchData, stage.pName, offsetMap, bufferAddress,
                    useBufferAddressKHR, modSpirv);
@@ -738,7 +774,7 @@ void VulkanReplay::FetchShaderFeedback(uint32_t eventId)
       const VulkanCreationInfo::ShaderModule &moduleInfo =
           creationInfo.m_ShaderModule[pipeInfo.shaders[idx].module];
 
-      rdcarray<uint32_t> modSpirv = moduleInfo.spirv.GetSPIRV();
+      rdcarray<uint32_t> modSpirv = moduleInfo.GetSPIRV().GetSPIRV();
 
       AnnotateShader(*pipeInfo.shaders[idx].patchData, stage.pName, offsetMap, bufferAddress,
                      useBufferAddressKHR, modSpirv);
@@ -899,6 +935,5 @@ void VulkanReplay::FetchShaderFeedback(uint32_t eventId)
     if(modules[i] != VK_NULL_HANDLE)
       m_pDriver->vkDestroyShaderModule(dev, modules[i], NULL);
 
-  // replay from the start as we may have corrupted state while fetching the above feedback.
-  m_pDriver->ReplayLog(0, eventId, eReplay_Full);
+  return true;
 }
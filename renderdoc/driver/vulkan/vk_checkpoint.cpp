@@ -0,0 +1,530 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019-2020 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include "vk_core.h"
+#include "vk_debug.h"
+
+// Replay checkpoints only snapshot GPU contents - images and memory. Everything else that a replay
+// builds up (descriptor set contents, re-recorded command buffers, tracked image layouts) still
+// comes from processing every chunk from the start of the frame, only the queue submits before the
+// checkpoint are skipped. That keeps checkpoints valid for any target event after them, as long as
+// they're only taken at submit boundaries where no command buffer is partially executed.
+
+static bool HasWrites(const MemRefs *memRefs)
+{
+  for(auto it = memRefs->rangeRefs.begin(); it != memRefs->rangeRefs.end(); ++it)
+    if(IncludesWrite(it->value()))
+      return true;
+
+  return false;
+}
+
+void WrappedVulkan::BeginCheckpointReplay(uint32_t lastEventID)
+{
+  m_ResumeCheckpoint = -1;
+  // a single frame capture only has its final present, so only multi-frame captures enable this
+  m_CheckpointReplay = (m_CheckpointInterval > 0 || m_FrameBoundaryEIDs.size() > 1) &&
+                       !m_CheckpointsUnsupported && m_DrawcallCallback == NULL;
+
+  if(!m_CheckpointReplay)
+    return;
+
+  // resume from the latest checkpoint whose events all lie within this replay
+  for(int32_t i = 0; i < m_Checkpoints.count(); i++)
+  {
+    if(m_Checkpoints[i].eventId > lastEventID)
+      break;
+
+    m_ResumeCheckpoint = i;
+  }
+}
+
+void WrappedVulkan::EndCheckpointReplay()
+{
+  if(m_ResumeCheckpoint >= 0)
+  {
+    // this can only happen if the replay didn't reach the submit the checkpoint was taken at, which
+    // means the frame contents won't be right. Drop the checkpoints so the next replay is correct.
+    RDCERR("Replay finished without reaching checkpoint at event %u",
+           m_Checkpoints[m_ResumeCheckpoint].eventId);
+    m_ResumeCheckpoint = -1;
+    FreeReplayCheckpoints();
+  }
+
+  m_CheckpointReplay = false;
+}
+
+void WrappedVulkan::ReplayCheckpointSubmitted()
+{
+  if(!m_CheckpointReplay)
+    return;
+
+  if(m_ResumeCheckpoint >= 0)
+  {
+    const ReplayCheckpoint &checkpoint = m_Checkpoints[m_ResumeCheckpoint];
+
+    // still before the checkpoint, keep skipping
+    if(m_RootEventID < checkpoint.eventId)
+      return;
+
+    if(m_RootEventID != checkpoint.eventId)
+      RDCWARN("Checkpoint at event %u restored at event %u", checkpoint.eventId, m_RootEventID);
+
+    RestoreReplayCheckpoint(checkpoint);
+    m_ResumeCheckpoint = -1;
+    return;
+  }
+
+  // only snapshot after submits that were entirely executed
+  if(m_RootEventID > m_LastEventID)
+    return;
+
+  // keep checkpoints at least the interval apart, in both directions since replays can go
+  // backwards and fill in earlier checkpoints.
+  size_t insertIdx = 0;
+  while(insertIdx < m_Checkpoints.size() && m_Checkpoints[insertIdx].eventId < m_RootEventID)
+    insertIdx++;
+
+  uint32_t prevEID = insertIdx > 0 ? m_Checkpoints[insertIdx - 1].eventId : 0;
+
+  if(insertIdx < m_Checkpoints.size() && m_Checkpoints[insertIdx].eventId == m_RootEventID)
+    return;
+
+  // the first submit of each frame after the first is checkpointed regardless of the interval
+  bool frameStart = false;
+  for(uint32_t boundary : m_FrameBoundaryEIDs)
+  {
+    if(boundary >= m_RootEventID)
+      break;
+    frameStart = boundary > prevEID;
+  }
+
+  if(!frameStart)
+  {
+    if(m_CheckpointInterval == 0 || m_RootEventID - prevEID < m_CheckpointInterval)
+      return;
+
+    if(insertIdx < m_Checkpoints.size() &&
+       m_Checkpoints[insertIdx].eventId - m_RootEventID < m_CheckpointInterval)
+      return;
+  }
+
+  ReplayCheckpoint checkpoint;
+  checkpoint.eventId = m_RootEventID;
+  if(CreateReplayCheckpoint(checkpoint))
+    m_Checkpoints.insert(insertIdx, checkpoint);
+}
+
+bool WrappedVulkan::CreateReplayCheckpoint(ReplayCheckpoint &checkpoint)
+{
+  VkDevice d = GetDev();
+  VkResult vkr = VK_SUCCESS;
+
+  // gather what will be snapshotted and its size before allocating anything, so that a checkpoint
+  // which won't fit in the budget is skipped cheaply.
+  rdcarray<ResourceId> images;
+  rdcarray<ResourceId> memory;
+  VkDeviceSize bytes = 0;
+
+  for(auto it = m_ImageStates.begin(); it != m_ImageStates.end(); ++it)
+  {
+    ResourceId orig = GetResourceManager()->GetOriginalID(it->first);
+    VkInitialContents initial = GetResourceManager()->GetInitialContents(orig);
+
+    // every image used in the frame has initial contents, even if only a clear
+    if(initial.type != eResImage)
+      continue;
+
+    LockedConstImageStateRef state = it->second.LockRead();
+    const ImageInfo &info = state->GetImageInfo();
+
+    if(initial.tag == VkInitialContents::Sparse || GetYUVPlaneCount(info.format) > 1)
+    {
+      RDCLOG("Frame contains sparse or multi-planar image %s, disabling replay checkpoints",
+             ToStr(orig).c_str());
+      m_CheckpointsUnsupported = true;
+      FreeReplayCheckpoints();
+      return false;
+    }
+
+    if(!state->isMemoryBound)
+      continue;
+
+    VkFormat sizeFormat = GetDepthOnlyFormat(info.format);
+    for(int m = 0; m < info.levelCount; m++)
+    {
+      VkDeviceSize mipSize = GetByteSize(info.extent.width, info.extent.height, info.extent.depth,
+                                         sizeFormat, m);
+      if(sizeFormat != info.format)
+        mipSize += GetByteSize(info.extent.width, info.extent.height, info.extent.depth,
+                               VK_FORMAT_S8_UINT, m);
+      bytes += mipSize * info.layerCount * info.sampleCount;
+    }
+
+    images.push_back(it->first);
+  }
+
+  for(auto it = m_CreationInfo.m_Memory.begin(); it != m_CreationInfo.m_Memory.end(); ++it)
+  {
+    if(it->second.wholeMemBuf == VK_NULL_HANDLE)
+      continue;
+
+    ResourceId orig = GetResourceManager()->GetOriginalID(it->first);
+    MemRefs *memRefs = GetResourceManager()->FindMemRefs(orig);
+
+    // memory that the frame never writes is identical at every event. Without reference
+    // information we have to assume it could be written if it has initial contents at all.
+    if(memRefs ? !HasWrites(memRefs)
+               : GetResourceManager()->GetInitialContents(orig).type != eResDeviceMemory)
+      continue;
+
+    bytes += it->second.size;
+    memory.push_back(it->first);
+  }
+
+  if(m_CheckpointBytes + bytes > m_CheckpointBudget)
+  {
+    RDCDEBUG("Checkpoint at event %u needs %llu bytes, over budget", checkpoint.eventId, bytes);
+    return false;
+  }
+
+  // checkpoints are purely an optimisation, never push the device over its memory budget for one
+  if(IsOverMemoryBudget(m_PhysicalDeviceData.GPULocalMemIndex, bytes))
+  {
+    RDCDEBUG("Checkpoint at event %u needs %llu bytes, over device memory budget",
+             checkpoint.eventId, bytes);
+    return false;
+  }
+
+  m_CheckpointBytes += bytes;
+
+  RDCDEBUG("Creating replay checkpoint at event %u with %zu images and %zu memory objects",
+           checkpoint.eventId, images.size(), memory.size());
+
+  // wait for all queues, the frame's work may not have been on our queue
+  ObjDisp(d)->DeviceWaitIdle(Unwrap(d));
+
+  VkCommandBufferBeginInfo beginInfo = {VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO, NULL,
+                                        VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT};
+
+  VkCommandBuffer cmd = GetNextCmd();
+
+  vkr = ObjDisp(cmd)->BeginCommandBuffer(Unwrap(cmd), &beginInfo);
+  RDCASSERTEQUAL(vkr, VK_SUCCESS);
+
+  VkMemoryBarrier memBarrier = {
+      VK_STRUCTURE_TYPE_MEMORY_BARRIER, NULL, VK_ACCESS_ALL_WRITE_BITS, VK_ACCESS_TRANSFER_READ_BIT,
+  };
+
+  DoPipelineBarrier(cmd, 1, &memBarrier);
+
+  for(ResourceId id : memory)
+  {
+    const VulkanCreationInfo::Memory &memInfo = m_CreationInfo.m_Memory[id];
+
+    VkBufferCreateInfo bufInfo = {
+        VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+        NULL,
+        0,
+        memInfo.size,
+        VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+    };
+
+    // as with initial contents, create & wrap manually rather than going through our wrapper
+    VkBuffer copy = VK_NULL_HANDLE;
+    vkr = ObjDisp(d)->CreateBuffer(Unwrap(d), &bufInfo, NULL, &copy);
+    RDCASSERTEQUAL(vkr, VK_SUCCESS);
+
+    GetResourceManager()->WrapResource(Unwrap(d), copy);
+
+    MemoryAllocation alloc =
+        AllocateMemoryForResource(copy, MemoryScope::ReplayCheckpoints, MemoryType::GPULocal);
+
+    vkr = ObjDisp(d)->BindBufferMemory(Unwrap(d), Unwrap(copy), Unwrap(alloc.mem), alloc.offs);
+    RDCASSERTEQUAL(vkr, VK_SUCCESS);
+
+    VkBufferCopy region = {0, 0, memInfo.size};
+    ObjDisp(cmd)->CmdCopyBuffer(Unwrap(cmd), Unwrap(memInfo.wholeMemBuf), Unwrap(copy), 1, &region);
+
+    checkpoint.memory.push_back({id, copy, memInfo.size});
+  }
+
+  for(ResourceId id : images)
+  {
+    LockedImageStateRef state = FindImageState(id);
+    const ImageInfo &info = state->GetImageInfo();
+
+    VkImageCreateInfo imInfo = {
+        VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+        NULL,
+        0,
+        m_CreationInfo.m_Image[id].type,
+        info.format,
+        info.extent,
+        (uint32_t)info.levelCount,
+        (uint32_t)info.layerCount,
+        (VkSampleCountFlagBits)info.sampleCount,
+        VK_IMAGE_TILING_OPTIMAL,
+        VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+        VK_SHARING_MODE_EXCLUSIVE,
+        0,
+        NULL,
+        VK_IMAGE_LAYOUT_UNDEFINED,
+    };
+
+    VkImage copy = VK_NULL_HANDLE;
+    vkr = ObjDisp(d)->CreateImage(Unwrap(d), &imInfo, NULL, &copy);
+    RDCASSERTEQUAL(vkr, VK_SUCCESS);
+
+    GetResourceManager()->WrapResource(Unwrap(d), copy);
+
+    MemoryAllocation alloc =
+        AllocateMemoryForResource(copy, MemoryScope::ReplayCheckpoints, MemoryType::GPULocal);
+
+    vkr = ObjDisp(d)->BindImageMemory(Unwrap(d), Unwrap(copy), Unwrap(alloc.mem), alloc.offs);
+    RDCASSERTEQUAL(vkr, VK_SUCCESS);
+
+    VkImageAspectFlags aspects = FormatImageAspects(info.format);
+
+    VkImageMemoryBarrier copyBarrier = {
+        VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+        NULL,
+        0,
+        VK_ACCESS_TRANSFER_WRITE_BIT,
+        VK_IMAGE_LAYOUT_UNDEFINED,
+        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+        VK_QUEUE_FAMILY_IGNORED,
+        VK_QUEUE_FAMILY_IGNORED,
+        Unwrap(copy),
+        {aspects, 0, VK_REMAINING_MIP_LEVELS, 0, VK_REMAINING_ARRAY_LAYERS},
+    };
+    DoPipelineBarrier(cmd, 1, &copyBarrier);
+
+    ImageBarrierSequence setupBarriers, cleanupBarriers;
+    state->TempTransition(m_QueueFamilyIdx, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                          VK_ACCESS_TRANSFER_READ_BIT, setupBarriers, cleanupBarriers,
+                          GetImageTransitionInfo());
+    InlineSetupImageBarriers(cmd, setupBarriers);
+    m_setupImageBarriers.Merge(setupBarriers);
+
+    rdcarray<VkImageCopy> regions;
+    for(int m = 0; m < info.levelCount; m++)
+    {
+      VkExtent3D extent = {
+          RDCMAX(1U, info.extent.width >> m), RDCMAX(1U, info.extent.height >> m),
+          RDCMAX(1U, info.extent.depth >> m),
+      };
+      VkImageSubresourceLayers sub = {aspects, (uint32_t)m, 0, (uint32_t)info.layerCount};
+      regions.push_back({sub, {0, 0, 0}, sub, {0, 0, 0}, extent});
+    }
+
+    VkImage live = GetResourceManager()->GetCurrentHandle<VkImage>(id);
+    ObjDisp(cmd)->CmdCopyImage(Unwrap(cmd), Unwrap(live), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                               Unwrap(copy), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                               (uint32_t)regions.size(), regions.data());
+
+    copyBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    copyBarrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    copyBarrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    copyBarrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    DoPipelineBarrier(cmd, 1, &copyBarrier);
+
+    InlineCleanupImageBarriers(cmd, cleanupBarriers);
+    m_cleanupImageBarriers.Merge(cleanupBarriers);
+
+    checkpoint.images.push_back({id, copy, *state});
+  }
+
+  vkr = ObjDisp(cmd)->EndCommandBuffer(Unwrap(cmd));
+  RDCASSERTEQUAL(vkr, VK_SUCCESS);
+
+  SubmitAndFlushImageStateBarriers(m_setupImageBarriers);
+  SubmitCmds();
+  FlushQ();
+  SubmitAndFlushImageStateBarriers(m_cleanupImageBarriers);
+
+  return true;
+}
+
+void WrappedVulkan::RestoreReplayCheckpoint(const ReplayCheckpoint &checkpoint)
+{
+  RDCDEBUG("Restoring replay checkpoint at event %u", checkpoint.eventId);
+
+  VkDevice d = GetDev();
+  VkResult vkr = VK_SUCCESS;
+
+  // nothing before the checkpoint was submitted, but make sure initial contents have been applied
+  ObjDisp(d)->DeviceWaitIdle(Unwrap(d));
+
+  VkCommandBufferBeginInfo beginInfo = {VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO, NULL,
+                                        VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT};
+
+  VkCommandBuffer cmd = GetNextCmd();
+
+  vkr = ObjDisp(cmd)->BeginCommandBuffer(Unwrap(cmd), &beginInfo);
+  RDCASSERTEQUAL(vkr, VK_SUCCESS);
+
+  VkMemoryBarrier memBarrier = {
+      VK_STRUCTURE_TYPE_MEMORY_BARRIER, NULL, VK_ACCESS_ALL_WRITE_BITS,
+      VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT,
+  };
+
+  DoPipelineBarrier(cmd, 1, &memBarrier);
+
+  // memory goes first, since it also overwrites the bytes under any images bound to it. The images
+  // below are then restored properly through image copies.
+  for(const ReplayCheckpoint::Memory &mem : checkpoint.memory)
+  {
+    VkBuffer dstBuf = m_CreationInfo.m_Memory[mem.id].wholeMemBuf;
+
+    VkBufferCopy region = {0, 0, mem.size};
+    ObjDisp(cmd)->CmdCopyBuffer(Unwrap(cmd), Unwrap(mem.copy), Unwrap(dstBuf), 1, &region);
+  }
+
+  memBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+  memBarrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+  DoPipelineBarrier(cmd, 1, &memBarrier);
+
+  for(const ReplayCheckpoint::Image &im : checkpoint.images)
+  {
+    LockedImageStateRef state = FindImageState(im.id);
+    if(!state)
+      continue;
+
+    const ImageInfo &info = state->GetImageInfo();
+    VkImageAspectFlags aspects = FormatImageAspects(info.format);
+
+    // the tracked layouts reflect the skipped submits, not what's actually on the GPU, so discard
+    // the contents rather than transitioning from them.
+    ImageBarrierSequence setupBarriers;
+    state->DiscardContents();
+    state->Transition(m_QueueFamilyIdx, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 0,
+                      VK_ACCESS_TRANSFER_WRITE_BIT, setupBarriers, GetImageTransitionInfo());
+    InlineSetupImageBarriers(cmd, setupBarriers);
+    m_setupImageBarriers.Merge(setupBarriers);
+
+    rdcarray<VkImageCopy> regions;
+    for(int m = 0; m < info.levelCount; m++)
+    {
+      VkExtent3D extent = {
+          RDCMAX(1U, info.extent.width >> m), RDCMAX(1U, info.extent.height >> m),
+          RDCMAX(1U, info.extent.depth >> m),
+      };
+      VkImageSubresourceLayers sub = {aspects, (uint32_t)m, 0, (uint32_t)info.layerCount};
+      regions.push_back({sub, {0, 0, 0}, sub, {0, 0, 0}, extent});
+    }
+
+    VkImage live = GetResourceManager()->GetCurrentHandle<VkImage>(im.id);
+    ObjDisp(cmd)->CmdCopyImage(Unwrap(cmd), Unwrap(im.copy), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                               Unwrap(live), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                               (uint32_t)regions.size(), regions.data());
+
+    // then put the image back into the layouts it had when the checkpoint was taken
+    ImageBarrierSequence cleanupBarriers;
+    state->Transition(im.state, VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_ALL_READ_BITS,
+                      cleanupBarriers, GetImageTransitionInfo());
+    InlineCleanupImageBarriers(cmd, cleanupBarriers);
+    m_cleanupImageBarriers.Merge(cleanupBarriers);
+  }
+
+  vkr = ObjDisp(cmd)->EndCommandBuffer(Unwrap(cmd));
+  RDCASSERTEQUAL(vkr, VK_SUCCESS);
+
+  SubmitAndFlushImageStateBarriers(m_setupImageBarriers);
+  SubmitCmds();
+  FlushQ();
+  SubmitAndFlushImageStateBarriers(m_cleanupImageBarriers);
+}
+
+void WrappedVulkan::FreeReplayCheckpoints()
+{
+  if(m_Checkpoints.empty())
+    return;
+
+  VkDevice d = GetDev();
+
+  ObjDisp(d)->DeviceWaitIdle(Unwrap(d));
+
+  for(ReplayCheckpoint &checkpoint : m_Checkpoints)
+    DestroyReplayCheckpoint(checkpoint);
+
+  m_Checkpoints.clear();
+  m_CheckpointBytes = 0;
+  m_ResumeCheckpoint = -1;
+
+  FreeAllMemory(MemoryScope::ReplayCheckpoints);
+}
+
+void WrappedVulkan::FreeReplayCheckpointsFrom(uint32_t eventId)
+{
+  // a checkpoint holds the results of every event up to and including its own, so the ones before
+  // eventId are still valid
+  int32_t keep = 0;
+  while(keep < m_Checkpoints.count() && m_Checkpoints[keep].eventId < eventId)
+    keep++;
+
+  if(keep == 0)
+  {
+    FreeReplayCheckpoints();
+    return;
+  }
+
+  if(keep == m_Checkpoints.count())
+    return;
+
+  RDCDEBUG("Freeing %d replay checkpoints from event %u", m_Checkpoints.count() - keep, eventId);
+
+  VkDevice d = GetDev();
+
+  ObjDisp(d)->DeviceWaitIdle(Unwrap(d));
+
+  for(int32_t i = keep; i < m_Checkpoints.count(); i++)
+    DestroyReplayCheckpoint(m_Checkpoints[i]);
+
+  m_Checkpoints.resize(keep);
+  m_ResumeCheckpoint = -1;
+
+  // the copies are suballocated from the checkpoint memory scope, which can only be freed as a
+  // whole. Their bytes stay counted against the budget until all checkpoints are freed.
+}
+
+void WrappedVulkan::DestroyReplayCheckpoint(ReplayCheckpoint &checkpoint)
+{
+  VkDevice d = GetDev();
+
+  for(ReplayCheckpoint::Image &im : checkpoint.images)
+  {
+    ObjDisp(d)->DestroyImage(Unwrap(d), Unwrap(im.copy), NULL);
+    GetResourceManager()->ReleaseWrappedResource(im.copy);
+  }
+
+  for(ReplayCheckpoint::Memory &mem : checkpoint.memory)
+  {
+    ObjDisp(d)->DestroyBuffer(Unwrap(d), Unwrap(mem.copy), NULL);
+    GetResourceManager()->ReleaseWrappedResource(mem.copy);
+  }
+
+  checkpoint.images.clear();
+  checkpoint.memory.clear();
+}
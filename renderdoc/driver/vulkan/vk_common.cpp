@@ -22,6 +22,7 @@
  * THE SOFTWARE.
  ******************************************************************************/
 
+#include <algorithm>
 #include "vk_common.h"
 #include "vk_core.h"
 #include "vk_manager.h"
@@ -321,6 +322,16 @@ bool VkInitParams::IsSupportedVersion(uint64_t ver)
   if(ver == CurrentVersion)
     return true;
 
+  // 0x12 -> 0x13 - shader module code is stored once per distinct blob in a separate section, and
+  // vkCreateShaderModule references it by hash
+  if(ver == 0x12)
+    return true;
+
+  // 0x11 -> 0x12 - sparse initial states only store the bound ranges of memory, and the resident
+  // pages of sparse images
+  if(ver == 0x11)
+    return true;
+
   // 0x10 -> 0x11 - non-breaking changes to image state serialization
   if(ver == 0x10)
     return true;
@@ -1006,85 +1017,129 @@ void DescriptorSetSlotImageInfo::SetFrom(const VkDescriptorImageInfo &imInfo, bo
   imageLayout = imInfo.imageLayout;
 }
 
-void DescriptorSetSlot::RemoveBindRefs(VulkanResourceManager *rm, VkResourceRecord *record)
+void DescriptorSetSlot::AddBindRefs(VulkanResourceManager *rm, VkResourceRecord *record,
+                                    FrameRefType ref)
 {
-  SCOPED_LOCK(record->descInfo->refLock);
-
+  // the references are built lazily so any of these might have been destroyed since the slot was
+  // written, without the slot being updated. That's fine provided the set isn't used, so skip them.
   if(texelBufferView != ResourceId())
   {
-    record->RemoveBindFrameRef(texelBufferView);
-
-    VkResourceRecord *viewRecord = rm->GetResourceRecord(texelBufferView);
-    if(viewRecord && viewRecord->baseResource != ResourceId())
-      record->RemoveBindFrameRef(viewRecord->baseResource);
+    VkResourceRecord *bufView = rm->GetResourceRecord(texelBufferView);
+    if(bufView)
+    {
+      record->AddBindFrameRef(bufView->GetResourceID(), eFrameRef_Read,
+                              bufView->resInfo && bufView->resInfo->IsSparse());
+      if(bufView->baseResource != ResourceId())
+        record->AddBindFrameRef(bufView->baseResource, eFrameRef_Read);
+      if(bufView->baseResourceMem != ResourceId())
+        record->AddMemFrameRef(bufView->baseResourceMem, bufView->memOffset, bufView->memSize, ref);
+    }
   }
   if(imageInfo.imageView != ResourceId())
   {
-    record->RemoveBindFrameRef(imageInfo.imageView);
-
-    VkResourceRecord *viewRecord = rm->GetResourceRecord(imageInfo.imageView);
-    if(viewRecord)
-    {
-      record->RemoveBindFrameRef(viewRecord->baseResource);
-      if(viewRecord->baseResourceMem != ResourceId())
-        record->RemoveBindFrameRef(viewRecord->baseResourceMem);
-    }
+    VkResourceRecord *view = rm->GetResourceRecord(imageInfo.imageView);
+    if(view)
+      record->AddImgFrameRef(view, ref);
   }
   if(imageInfo.sampler != ResourceId())
   {
-    record->RemoveBindFrameRef(imageInfo.sampler);
+    record->AddBindFrameRef(imageInfo.sampler, eFrameRef_Read);
   }
   if(bufferInfo.buffer != ResourceId())
   {
-    record->RemoveBindFrameRef(bufferInfo.buffer);
-
-    VkResourceRecord *bufRecord = rm->GetResourceRecord(bufferInfo.buffer);
-    if(bufRecord && bufRecord->baseResource != ResourceId())
-      record->RemoveBindFrameRef(bufRecord->baseResource);
+    VkResourceRecord *buf = rm->GetResourceRecord(bufferInfo.buffer);
+    if(buf)
+    {
+      record->AddBindFrameRef(bufferInfo.buffer, eFrameRef_Read,
+                              buf->resInfo && buf->resInfo->IsSparse());
+      if(buf->baseResource != ResourceId())
+        record->AddMemFrameRef(buf->baseResource, buf->memOffset, buf->memSize, ref);
+    }
   }
-
-  // NULL everything out now so that we don't accidentally reference an object
-  // that was removed already
-  texelBufferView = ResourceId();
-  bufferInfo.buffer = ResourceId();
-  imageInfo.imageView = ResourceId();
-  imageInfo.sampler = ResourceId();
 }
 
-void DescriptorSetSlot::AddBindRefs(VulkanResourceManager *rm, VkResourceRecord *record,
-                                    FrameRefType ref)
+void DescriptorSetSlot::AddWrittenResources(VulkanResourceManager *rm,
+                                            rdcarray<ResourceId> &written)
 {
-  SCOPED_LOCK(record->descInfo->refLock);
-
+  // these are the resources AddBindRefs would give a write reference to
   if(texelBufferView != ResourceId())
   {
     VkResourceRecord *bufView = rm->GetResourceRecord(texelBufferView);
-    record->AddBindFrameRef(bufView->GetResourceID(), eFrameRef_Read,
-                            bufView->resInfo && bufView->resInfo->IsSparse());
-    if(bufView->baseResource != ResourceId())
-      record->AddBindFrameRef(bufView->baseResource, eFrameRef_Read);
-    if(bufView->baseResourceMem != ResourceId())
-      record->AddMemFrameRef(bufView->baseResourceMem, bufView->memOffset, bufView->memSize, ref);
+    if(bufView && bufView->baseResourceMem != ResourceId())
+      written.push_back(bufView->baseResourceMem);
   }
   if(imageInfo.imageView != ResourceId())
   {
     VkResourceRecord *view = rm->GetResourceRecord(imageInfo.imageView);
-    record->AddImgFrameRef(view, ref);
-  }
-  if(imageInfo.sampler != ResourceId())
-  {
-    record->AddBindFrameRef(imageInfo.sampler, eFrameRef_Read);
+    if(view)
+      written.push_back(view->baseResource);
   }
   if(bufferInfo.buffer != ResourceId())
   {
     VkResourceRecord *buf = rm->GetResourceRecord(bufferInfo.buffer);
-    record->AddBindFrameRef(bufferInfo.buffer, eFrameRef_Read,
-                            buf->resInfo && buf->resInfo->IsSparse());
-    if(buf->baseResource != ResourceId())
-      record->AddMemFrameRef(buf->baseResource, buf->memOffset, buf->memSize, ref);
+    if(buf && buf->baseResource != ResourceId())
+      written.push_back(buf->baseResource);
   }
 }
 
+void VkResourceRecord::UpdateBindRefs(VulkanResourceManager *rm)
+{
+  if(descInfo->bindRefsGeneration == descInfo->bindGeneration)
+    return;
+
+  descInfo->bindFrameRefs.clear();
+  descInfo->bindMemRefs.clear();
+  descInfo->bindImageStates.clear();
+
+  const DescSetLayout &layout = *descInfo->layout;
+
+  for(size_t b = 0; b < descInfo->descBindings.size(); b++)
+  {
+    const DescSetLayout::Binding &layoutBinding = layout.bindings[b];
+
+    if(layoutBinding.descriptorCount == 0)
+      continue;
+
+    FrameRefType ref = GetRefType(layoutBinding.descriptorType);
+
+    DescriptorSetSlot *slots = descInfo->descBindings[b];
+    for(uint32_t a = 0; a < layoutBinding.descriptorCount; a++)
+      slots[a].AddBindRefs(rm, this, ref);
+  }
+
+  descInfo->bindRefsGeneration = descInfo->bindGeneration;
+}
+
+void VkResourceRecord::UpdateWrittenBindRefs(VulkanResourceManager *rm)
+{
+  if(descInfo->writtenRefsGeneration == descInfo->writableBindGeneration)
+    return;
+
+  rdcarray<ResourceId> &written = descInfo->writtenResources;
+  written.clear();
+
+  const DescSetLayout &layout = *descInfo->layout;
+
+  for(size_t b = 0; b < descInfo->descBindings.size(); b++)
+  {
+    const DescSetLayout::Binding &layoutBinding = layout.bindings[b];
+
+    if(layoutBinding.descriptorCount == 0 ||
+       GetRefType(layoutBinding.descriptorType) == eFrameRef_Read)
+      continue;
+
+    DescriptorSetSlot *slots = descInfo->descBindings[b];
+    for(uint32_t a = 0; a < layoutBinding.descriptorCount; a++)
+      slots[a].AddWrittenResources(rm, written);
+  }
+
+  // large bindless arrays often point at the same few resources many times over
+  std::sort(written.begin(), written.end());
+  written.resize(std::unique(written.begin(), written.end()) - written.begin());
+
+  descInfo->writtenRefsGeneration = descInfo->writableBindGeneration;
+}
+
 #if ENABLED(ENABLE_UNIT_TESTS)
 
 #undef None
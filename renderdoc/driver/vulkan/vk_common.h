@@ -351,6 +351,7 @@ enum class MemoryScope : uint8_t
   InitialContents,
   First = InitialContents,
   IndirectReadback,
+  ReplayCheckpoints,
   Count,
 };
 
@@ -375,6 +376,11 @@ struct MemoryAllocation
   MemoryType type = MemoryType::GPULocal;
   uint32_t memoryTypeIndex = 0;
   bool buffer = false;
+
+  // the range of the parent block reserved for this allocation, including any alignment padding
+  // in front of it, so that the whole range can be returned when it's freed.
+  VkDeviceSize reservedOffs = 0;
+  VkDeviceSize reservedSize = 0;
 };
 
 #define IMPLEMENT_FUNCTION_SERIALISED(ret, func, ...) \
@@ -421,8 +427,8 @@ struct DescriptorSetSlotImageInfo
 
 struct DescriptorSetSlot
 {
-  void RemoveBindRefs(VulkanResourceManager *rm, VkResourceRecord *record);
   void AddBindRefs(VulkanResourceManager *rm, VkResourceRecord *record, FrameRefType ref);
+  void AddWrittenResources(VulkanResourceManager *rm, rdcarray<ResourceId> &written);
 
   // VkDescriptorBufferInfo
   DescriptorSetSlotBufferInfo bufferInfo;
@@ -1288,6 +1294,16 @@ DECLARE_REFLECTION_STRUCT(VkVertexInputBindingDivisorDescriptionEXT);
 DECLARE_REFLECTION_STRUCT(VkViewport);
 DECLARE_REFLECTION_STRUCT(VkXYColorEXT);
 
+// plain structs of basic members, copied in one go when serialised as arrays
+DECLARE_BULK_SERIALISE_TYPE(VkOffset2D);
+DECLARE_BULK_SERIALISE_TYPE(VkOffset3D);
+DECLARE_BULK_SERIALISE_TYPE(VkExtent2D);
+DECLARE_BULK_SERIALISE_TYPE(VkExtent3D);
+DECLARE_BULK_SERIALISE_TYPE(VkRect2D);
+DECLARE_BULK_SERIALISE_TYPE(VkViewport);
+DECLARE_BULK_SERIALISE_TYPE(VkVertexInputBindingDescription);
+DECLARE_BULK_SERIALISE_TYPE(VkVertexInputAttributeDescription);
+
 DECLARE_DESERIALISE_TYPE(VkDescriptorSetLayoutBinding);
 DECLARE_DESERIALISE_TYPE(VkPresentRegionKHR);
 DECLARE_DESERIALISE_TYPE(VkSparseBufferMemoryBindInfo);
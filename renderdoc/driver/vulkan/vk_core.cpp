@@ -93,6 +93,8 @@ void VkInitParams::Set(const VkInstanceCreateInfo *pCreateInfo, ResourceId inst)
   InstanceID = inst;
 }
 
+Threading::LockStats WrappedVulkan::CoherentMapsLockStats("Vulkan coherent maps");
+
 WrappedVulkan::WrappedVulkan()
 {
   if(RenderDoc::Inst().GetCrashHandler())
@@ -120,7 +122,6 @@ WrappedVulkan::WrappedVulkan()
   m_Replay = new VulkanReplay(this);
 
   threadSerialiserTLSSlot = Threading::AllocateTLSSlot();
-  tempMemoryTLSSlot = Threading::AllocateTLSSlot();
   debugMessageSinkTLSSlot = Threading::AllocateTLSSlot();
 
   m_RootEventID = 1;
@@ -136,6 +137,15 @@ WrappedVulkan::WrappedVulkan()
 
   m_LastCmdBufferID = ResourceId();
 
+  {
+    const CaptureOptions &opts = RenderDoc::Inst().GetCaptureOptions();
+
+    m_WatchCoherentMapWrites = opts.watchCoherentMapWrites;
+    m_DeferDescriptorShadowing = opts.deferDescriptorUpdates;
+    m_DeferCreateChunks = opts.deferCreationChunks;
+    m_CompactInitialStates = opts.compactInitialStates;
+  }
+
   m_DrawcallStack.push_back(&m_ParentDrawcall);
 
   m_SetDeviceLoaderData = NULL;
@@ -157,6 +167,7 @@ WrappedVulkan::WrappedVulkan()
     m_FrameCaptureRecord->DataInSerialiser = false;
     m_FrameCaptureRecord->Length = 0;
     m_FrameCaptureRecord->InternalResource = true;
+    m_FrameCaptureRecord->SpillChunks = true;
   }
   else
   {
@@ -190,12 +201,6 @@ WrappedVulkan::~WrappedVulkan()
   for(size_t i = 0; i < m_ThreadSerialisers.size(); i++)
     delete m_ThreadSerialisers[i];
 
-  for(size_t i = 0; i < m_ThreadTempMem.size(); i++)
-  {
-    delete[] m_ThreadTempMem[i]->memory;
-    delete m_ThreadTempMem[i];
-  }
-
   delete m_Replay;
 }
 
@@ -334,8 +339,10 @@ void WrappedVulkan::FlushQ()
   // see comment in SubmitQ()
   if(m_Queue != VK_NULL_HANDLE)
   {
+    PerformanceTimer timer;
     VkResult vkr = ObjDisp(m_Queue)->QueueWaitIdle(Unwrap(m_Queue));
     RDCASSERTEQUAL(vkr, VK_SUCCESS);
+    m_GPUWaitTime += timer.GetMilliseconds();
   }
 
 #if ENABLED(SINGLE_FLUSH_VALIDATE)
@@ -597,34 +604,11 @@ void WrappedVulkan::SetDebugMessageSink(WrappedVulkan::ScopedDebugMessageSink *s
 
 byte *WrappedVulkan::GetTempMemory(size_t s)
 {
-  TempMem *mem = (TempMem *)Threading::GetTLSValue(tempMemoryTLSSlot);
-  if(mem && mem->size >= s)
-    return mem->memory;
-
-  // alloc or grow alloc
-  TempMem *newmem = mem;
-
-  if(!newmem)
-    newmem = new TempMem();
-
-  // free old memory, don't need to keep contents
-  if(newmem->memory)
-    delete[] newmem->memory;
-
-  // alloc new memory
-  newmem->size = s;
-  newmem->memory = new byte[s];
-
-  Threading::SetTLSValue(tempMemoryTLSSlot, (void *)newmem);
-
-  // if this is entirely new, save it for deletion on shutdown
-  if(!mem)
-  {
-    SCOPED_LOCK(m_ThreadTempMemLock);
-    m_ThreadTempMem.push_back(newmem);
-  }
+  // the common case of patching an empty next chain needs no memory, so skip the TLS lookup
+  if(s == 0)
+    return NULL;
 
-  return newmem->memory;
+  return m_TempMemory.Alloc(s);
 }
 
 WriteSerialiser &WrappedVulkan::GetThreadSerialiser()
@@ -1528,7 +1512,7 @@ bool WrappedVulkan::Serialise_BeginCaptureFrame(SerialiserType &ser)
 
 void WrappedVulkan::StartFrameCapture(void *dev, void *wnd)
 {
-  if(!IsBackgroundCapturing(m_State))
+  if(!IsBackgroundCapturing(m_State) || m_SubmitScope.pending)
     return;
 
   m_AppControlledCapture = true;
@@ -1541,6 +1525,31 @@ void WrappedVulkan::StartFrameCapture(void *dev, void *wnd)
   RDCEraseEl(frame.stats);
   m_CapturedFrames.push_back(frame);
 
+  const CaptureOptions &opts = RenderDoc::Inst().GetCaptureOptions();
+
+  // a capture restricted to some submissions doesn't begin until the first of them, so that the
+  // initial contents are only what those submissions see.
+  if(opts.captureQueueFamily != ~0U || opts.captureFirstSubmit > 0 || opts.captureNumSubmits > 0)
+  {
+    SCOPED_LOCK(m_SubmitScopeLock);
+
+    m_SubmitScope.enabled = true;
+    m_SubmitScope.pending = true;
+    m_SubmitScope.queueFamily = opts.captureQueueFamily;
+    m_SubmitScope.firstSubmit = opts.captureFirstSubmit;
+    m_SubmitScope.numSubmits = opts.captureNumSubmits;
+    m_SubmitScope.submitIndex = 0;
+
+    RDCLOG("Capture scoped to queue family %d, %u submissions from %u (0 is unlimited)",
+           (int)opts.captureQueueFamily, opts.captureNumSubmits, opts.captureFirstSubmit);
+    return;
+  }
+
+  BeginActiveCapture();
+}
+
+void WrappedVulkan::BeginActiveCapture()
+{
   GetResourceManager()->ClearReferencedResources();
   GetResourceManager()->ClearReferencedMemory();
 
@@ -1581,11 +1590,12 @@ void WrappedVulkan::StartFrameCapture(void *dev, void *wnd)
       RDCASSERTEQUAL(vkr, VK_SUCCESS);
     }
 
+    // descriptor set initial contents are prepared from the bindings, so they must be up to date
+    ApplyAllDeferredDescriptorWrites();
+
+    BeginInitStateBatch();
     GetResourceManager()->PrepareInitialContents();
-    SubmitAndFlushImageStateBarriers(m_setupImageBarriers);
-    SubmitCmds();
-    FlushQ();
-    SubmitAndFlushImageStateBarriers(m_cleanupImageBarriers);
+    EndInitStateBatch();
 
     RDCDEBUG("Attempting capture");
     m_FrameCaptureRecord->DeleteChunks();
@@ -1597,7 +1607,12 @@ void WrappedVulkan::StartFrameCapture(void *dev, void *wnd)
       }
     }
 
+    m_CaptureSerial++;
     m_State = CaptureState::ActiveCapturing;
+
+    // this must come after the state change, so that any object created concurrently either sees
+    // the active state and serialises its own chunk, or is deferred in time to be serialised here.
+    SerialiseAllDeferredCreateChunks();
   }
 
   GetResourceManager()->MarkResourceFrameReferenced(GetResID(m_Instance), eFrameRef_Read);
@@ -1620,8 +1635,63 @@ void WrappedVulkan::StartFrameCapture(void *dev, void *wnd)
   RDCLOG("Starting capture, frame %u", m_CapturedFrames.back().frameNumber);
 }
 
+bool WrappedVulkan::CheckSubmitScope(VkQueue queue)
+{
+  // unscoped captures include every submission. This is only changed by starting or ending a
+  // capture, so checking it without the lock is fine.
+  if(!m_SubmitScope.enabled)
+    return true;
+
+  SCOPED_LOCK(m_SubmitScopeLock);
+
+  if(!m_SubmitScope.enabled)
+    return true;
+
+  if(m_SubmitScope.queueFamily != ~0U &&
+     GetRecord(queue)->queueFamilyIndex != m_SubmitScope.queueFamily)
+    return false;
+
+  uint32_t idx = m_SubmitScope.submitIndex++;
+
+  if(idx < m_SubmitScope.firstSubmit)
+    return false;
+
+  if(m_SubmitScope.numSubmits > 0 && idx - m_SubmitScope.firstSubmit >= m_SubmitScope.numSubmits)
+    return false;
+
+  if(m_SubmitScope.pending)
+  {
+    m_SubmitScope.pending = false;
+
+    BeginActiveCapture();
+
+    // a triggered capture is numbered by the frame it actually began in
+    if(!m_AppControlledCapture)
+      m_CapturedFrames.back().frameNumber = m_FrameCounter;
+  }
+
+  return true;
+}
+
+bool WrappedVulkan::ResetSubmitScope()
+{
+  SCOPED_LOCK(m_SubmitScopeLock);
+  bool pending = m_SubmitScope.pending;
+  m_SubmitScope = SubmitScope();
+  return pending;
+}
+
 bool WrappedVulkan::EndFrameCapture(void *dev, void *wnd)
 {
+  if(m_SubmitScope.pending && ResetSubmitScope())
+  {
+    RDCWARN("No submissions were made in the capture's scope, nothing was captured");
+
+    RenderDoc::Inst().FinishCaptureWriting(NULL, m_CapturedFrames.back().frameNumber);
+    m_CapturedFrames.pop_back();
+    return false;
+  }
+
   if(!IsActiveCapturing(m_State))
     return true;
 
@@ -1710,6 +1780,8 @@ bool WrappedVulkan::EndFrameCapture(void *dev, void *wnd)
     }
   }
 
+  ResetSubmitScope();
+
   // gather backbuffer screenshot
   const uint32_t maxSize = 2048;
   RenderDoc::FramePixels fp;
@@ -1973,7 +2045,7 @@ bool WrappedVulkan::EndFrameCapture(void *dev, void *wnd)
       RDCDEBUG("Flushing %u command buffer records to file serialiser",
                (uint32_t)m_CmdBufferRecords.size());
 
-      std::map<int32_t, Chunk *> recordlist;
+      RecordChunkList recordlist;
 
       // ensure all command buffer records within the frame evne if recorded before, but
       // otherwise order must be preserved (vs. queue submits and desc set updates)
@@ -1987,23 +2059,43 @@ bool WrappedVulkan::EndFrameCapture(void *dev, void *wnd)
 
       m_FrameCaptureRecord->Insert(recordlist);
 
+      SortRecordChunks(recordlist);
+
       RDCDEBUG("Flushing %u chunks to file serialiser from context record",
                (uint32_t)recordlist.size());
 
       float num = float(recordlist.size());
       float idx = 0.0f;
 
-      for(auto it = recordlist.begin(); it != recordlist.end(); ++it)
+      for(const rdcpair<int32_t, Chunk *> &chunk : recordlist)
       {
         RenderDoc::Inst().SetProgress(CaptureProgress::SerialiseFrameContents, idx / num);
         idx += 1.0f;
-        it->second->Write(ser);
+        chunk.second->Write(ser);
       }
 
       RDCDEBUG("Done");
     }
   }
 
+  // now that all the chunks are written, write the code for the shader modules they reference
+  if(rdc)
+  {
+    SectionProperties props;
+
+    props.flags = SectionFlags::LZ4Compressed;
+    props.version = 1;
+    props.type = SectionType::ShaderBlobs;
+
+    StreamWriter *blobWriter = rdc->WriteSection(props);
+
+    m_ShaderModuleBlobs.WriteReferenced(blobWriter);
+
+    blobWriter->Finish();
+
+    delete blobWriter;
+  }
+
   RenderDoc::Inst().FinishCaptureWriting(rdc, m_CapturedFrames.back().frameNumber);
 
   SAFE_DELETE(m_HeaderChunk);
@@ -2031,6 +2123,13 @@ bool WrappedVulkan::EndFrameCapture(void *dev, void *wnd)
 
 bool WrappedVulkan::DiscardFrameCapture(void *dev, void *wnd)
 {
+  if(m_SubmitScope.pending && ResetSubmitScope())
+  {
+    RenderDoc::Inst().FinishCaptureWriting(NULL, m_CapturedFrames.back().frameNumber);
+    m_CapturedFrames.pop_back();
+    return true;
+  }
+
   if(!IsActiveCapturing(m_State))
     return true;
 
@@ -2059,6 +2158,8 @@ bool WrappedVulkan::DiscardFrameCapture(void *dev, void *wnd)
     }
   }
 
+  ResetSubmitScope();
+
   SAFE_DELETE(m_HeaderChunk);
 
   // delete cmd buffers now - had to keep them alive until after serialiser flush.
@@ -2095,10 +2196,14 @@ void WrappedVulkan::Present(void *dev, void *wnd)
   if(!activeWindow)
     return;
 
-  if(IsActiveCapturing(m_State) && !m_AppControlledCapture)
+  // a merged multi-frame capture carries on through the presents of all but its last frame
+  if(IsActiveCapturing(m_State) && !m_AppControlledCapture &&
+     !RenderDoc::Inst().ShouldContinueCapture())
     RenderDoc::Inst().EndFrameCapture(dev, wnd);
 
-  if(RenderDoc::Inst().ShouldTriggerCapture(m_FrameCounter) && IsBackgroundCapturing(m_State))
+  // a scoped capture that's still waiting for its first submission carries on into this frame
+  if(RenderDoc::Inst().ShouldTriggerCapture(m_FrameCounter) && IsBackgroundCapturing(m_State) &&
+     !m_SubmitScope.pending)
   {
     RenderDoc::Inst().StartFrameCapture(dev, wnd);
 
@@ -2151,6 +2256,37 @@ ReplayStatus WrappedVulkan::ReadLogInitialisation(RDCFile *rdc, bool storeStruct
   if(sectionIdx < 0)
     return ReplayStatus::FileCorrupted;
 
+  int blobSectionIdx = rdc->SectionIndex(SectionType::ShaderBlobs);
+
+  if(blobSectionIdx >= 0)
+  {
+    StreamReader *blobReader = rdc->ReadSection(blobSectionIdx);
+
+    uint64_t numBlobs = 0;
+    blobReader->Read(numBlobs);
+
+    for(uint64_t i = 0; i < numBlobs && !blobReader->IsErrored(); i++)
+    {
+      uint64_t hash = 0, size = 0;
+      blobReader->Read(hash);
+      blobReader->Read(size);
+
+      if(size > blobReader->GetSize())
+        break;
+
+      bytebuf &code = m_ReplayShaderBlobs[hash];
+      code.resize((size_t)size);
+      blobReader->Read(code.data(), size);
+    }
+
+    bool errored = blobReader->IsErrored();
+
+    delete blobReader;
+
+    if(errored)
+      return ReplayStatus::FileIOFailed;
+  }
+
   StreamReader *reader = rdc->ReadSection(sectionIdx);
 
   if(reader->IsErrored())
@@ -2174,17 +2310,10 @@ ReplayStatus WrappedVulkan::ReadLogInitialisation(RDCFile *rdc, bool storeStruct
 
   int chunkIdx = 0;
 
-  struct chunkinfo
-  {
-    chunkinfo() : count(0), totalsize(0), total(0.0) {}
-    int count;
-    uint64_t totalsize;
-    double total;
-  };
-
-  std::map<VulkanChunk, chunkinfo> chunkInfos;
+  ChunkLoadRecorder chunkStats;
 
   SCOPED_TIMER("chunk initialisation");
+  RDCPROFILE_ZONE("ReadLogInitialisation");
 
   uint64_t frameDataSize = 0;
 
@@ -2195,6 +2324,7 @@ ReplayStatus WrappedVulkan::ReadLogInitialisation(RDCFile *rdc, bool storeStruct
   for(;;)
   {
     PerformanceTimer timer;
+    double gpuWaitStart = m_GPUWaitTime;
 
     uint64_t offsetStart = reader->GetOffset();
 
@@ -2262,6 +2392,12 @@ ReplayStatus WrappedVulkan::ReadLogInitialisation(RDCFile *rdc, bool storeStruct
 
       m_FrameReader = new StreamReader(reader, frameDataSize);
 
+      // replaying the frame needs shader reflection, so wait for all background parsing
+      m_CreationInfo.FinishShaderJobs();
+
+      CreatePendingSubpass0Pipelines();
+      SaveReplayPipelineCache();
+
       ReplayStatus status = ContextReplayLog(m_State, 0, 0, false);
 
       if(status != ReplayStatus::Succeeded)
@@ -2271,9 +2407,8 @@ ReplayStatus WrappedVulkan::ReadLogInitialisation(RDCFile *rdc, bool storeStruct
       }
     }
 
-    chunkInfos[context].total += timer.GetMilliseconds();
-    chunkInfos[context].totalsize += offsetEnd - offsetStart;
-    chunkInfos[context].count++;
+    chunkStats.Record((uint32_t)context, offsetEnd - offsetStart, timer.GetMilliseconds(),
+                      m_GPUWaitTime - gpuWaitStart);
 
     if((SystemChunk)context == SystemChunk::CaptureScope || reader->IsErrored() || reader->AtEnd())
       break;
@@ -2281,19 +2416,12 @@ ReplayStatus WrappedVulkan::ReadLogInitialisation(RDCFile *rdc, bool storeStruct
 
   SAFE_DELETE(sink);
 
-#if ENABLED(RDOC_DEVEL)
-  for(auto it = chunkInfos.begin(); it != chunkInfos.end(); ++it)
-  {
-    double dcount = double(it->second.count);
-
-    RDCDEBUG(
-        "% 5d chunks - Time: %9.3fms total/%9.3fms avg - Size: %8.3fMB total/%7.3fMB avg - %s (%u)",
-        it->second.count, it->second.total, it->second.total / dcount,
-        double(it->second.totalsize) / (1024.0 * 1024.0),
-        double(it->second.totalsize) / (dcount * 1024.0 * 1024.0),
-        GetChunkName((uint32_t)it->first).c_str(), uint32_t(it->first));
-  }
-#endif
+  // all shader modules have been created, the code is no longer needed
+  m_ReplayShaderBlobs.clear();
+
+  m_CreationInfo.FinishShaderJobs();
+
+  CreatePendingSubpass0Pipelines();
 
   // steal the structured data for ourselves
   m_StructuredFile->Swap(m_StoredStructuredData);
@@ -2307,7 +2435,8 @@ ReplayStatus WrappedVulkan::ReadLogInitialisation(RDCFile *rdc, bool storeStruct
       rdc->GetSectionProperties(sectionIdx).compressedSize;
   GetReplay()->WriteFrameRecord().frameInfo.persistentSize = frameDataSize;
   GetReplay()->WriteFrameRecord().frameInfo.initDataSize =
-      chunkInfos[(VulkanChunk)SystemChunk::InitialContents].totalsize;
+      chunkStats.GetTotalSize((uint32_t)SystemChunk::InitialContents);
+  GetReplay()->WriteFrameRecord().frameInfo.loadStatistics = chunkStats.Bake(&GetChunkName);
 
   RDCDEBUG("Allocating %llu persistant bytes of memory for the log.",
            GetReplay()->WriteFrameRecord().frameInfo.persistentSize);
@@ -2335,6 +2464,111 @@ ReplayStatus WrappedVulkan::ReadLogInitialisation(RDCFile *rdc, bool storeStruct
   return ReplayStatus::Succeeded;
 }
 
+void WrappedVulkan::RerecordCacheChunkDone(VulkanChunk chunk, uint64_t offset)
+{
+  auto it = m_RerecordCache.find(m_RerecordCachePending);
+  if(it == m_RerecordCache.end())
+  {
+    m_RerecordCachePending = ResourceId();
+    return;
+  }
+
+  // the vkBeginCommandBuffer chunk that started the recording
+  if(m_CurChunkOffset == it->second.beginOffset)
+    return;
+
+  // we can only skip over the command buffer later if nothing else is interleaved with its
+  // commands, and secondary command buffers are re-recorded on every replay.
+  if(m_LastCmdBufferID != m_RerecordCachePending || chunk == VulkanChunk::vkCmdExecuteCommands)
+  {
+    AbandonPendingRerecord();
+    return;
+  }
+
+  if(chunk == VulkanChunk::vkEndCommandBuffer)
+  {
+    it->second.endOffset = offset;
+    m_RerecordCacheBytes += offset - it->second.beginOffset;
+    m_RerecordCachePending = ResourceId();
+  }
+}
+
+void WrappedVulkan::AbandonPendingRerecord()
+{
+  auto it = m_RerecordCache.find(m_RerecordCachePending);
+  if(it != m_RerecordCache.end())
+  {
+    // free it along with the other re-recorded command buffers at the end of the replay
+    m_RerecordCmdList.push_back({it->second.pool, it->second.cmd});
+    m_RerecordCache.erase(it);
+  }
+
+  m_RerecordCachePending = ResourceId();
+}
+
+void WrappedVulkan::RerecordCacheSetsBound(const VkDescriptorSet *sets, uint32_t count)
+{
+  auto it = m_RerecordCache.find(m_RerecordCachePending);
+  if(it == m_RerecordCache.end())
+    return;
+
+  for(uint32_t i = 0; i < count; i++)
+    if(sets[i] != VK_NULL_HANDLE)
+      it->second.boundSets.insert(GetResID(sets[i]));
+}
+
+void WrappedVulkan::RerecordCacheSetWritten(ResourceId set)
+{
+  for(auto it = m_RerecordCache.begin(); it != m_RerecordCache.end();)
+  {
+    if(it->second.boundSets.find(set) == it->second.boundSets.end())
+    {
+      ++it;
+      continue;
+    }
+
+    if(it->first == m_RerecordCachePending)
+      m_RerecordCachePending = ResourceId();
+
+    if(it->second.endOffset != 0)
+      m_RerecordCacheBytes -= it->second.endOffset - it->second.beginOffset;
+
+    // it may already have been submitted in this replay, so free it at the end along with the
+    // other re-recorded command buffers
+    m_RerecordCmdList.push_back({it->second.pool, it->second.cmd});
+    it = m_RerecordCache.erase(it);
+  }
+}
+
+void WrappedVulkan::TrimRerecordCache()
+{
+  while(m_RerecordCacheBytes > m_RerecordCacheBudget && !m_RerecordCache.empty())
+  {
+    auto lru = m_RerecordCache.begin();
+    for(auto it = m_RerecordCache.begin(); it != m_RerecordCache.end(); ++it)
+      if(it->second.lastUsed < lru->second.lastUsed)
+        lru = it;
+
+    m_RerecordCacheBytes -= lru->second.endOffset - lru->second.beginOffset;
+    m_BakedCmdBufferInfo.erase(GetResID(lru->second.cmd));
+    vkFreeCommandBuffers(GetDev(), lru->second.pool, 1, &lru->second.cmd);
+    m_RerecordCache.erase(lru);
+  }
+}
+
+void WrappedVulkan::FreeRerecordCache()
+{
+  for(auto it = m_RerecordCache.begin(); it != m_RerecordCache.end(); ++it)
+  {
+    m_BakedCmdBufferInfo.erase(GetResID(it->second.cmd));
+    vkFreeCommandBuffers(GetDev(), it->second.pool, 1, &it->second.cmd);
+  }
+
+  m_RerecordCache.clear();
+  m_RerecordCacheBytes = 0;
+  m_RerecordCachePending = ResourceId();
+}
+
 ReplayStatus WrappedVulkan::ContextReplayLog(CaptureState readType, uint32_t startEventID,
                                              uint32_t endEventID, bool partial)
 {
@@ -2416,6 +2650,8 @@ ReplayStatus WrappedVulkan::ContextReplayLog(CaptureState readType, uint32_t sta
     m_RootDrawcallID = 1;
     m_FirstEventID = 0;
     m_LastEventID = ~0U;
+
+    m_FrameBoundaryEIDs.clear();
   }
 
   if(!partial && !IsStructuredExporting(m_State))
@@ -2450,6 +2686,17 @@ ReplayStatus WrappedVulkan::ContextReplayLog(CaptureState readType, uint32_t sta
     if(ser.GetReader()->IsErrored())
       return ReplayStatus::APIDataCorrupted;
 
+    if(m_RerecordCacheSkipOffset != 0)
+    {
+      // a cached recording is being used for this command buffer, so skip to its end
+      ser.GetReader()->SetOffset(m_RerecordCacheSkipOffset);
+      m_RerecordCacheSkipOffset = 0;
+    }
+    else if(m_RerecordCachePending != ResourceId())
+    {
+      RerecordCacheChunkDone(chunktype, ser.GetReader()->GetOffset());
+    }
+
     // if there wasn't a serialisation error, but the chunk didn't succeed, then it's an API replay
     // failure.
     if(!success)
@@ -2512,14 +2759,20 @@ ReplayStatus WrappedVulkan::ContextReplayLog(CaptureState readType, uint32_t sta
 
   if(!IsStructuredExporting(m_State))
   {
+    FlushPendingReplaySemaphores();
+
     ObjDisp(GetDev())->DeviceWaitIdle(Unwrap(GetDev()));
 
     // destroy any events we created for waiting on
     for(size_t i = 0; i < m_CleanupEvents.size(); i++)
       ObjDisp(GetDev())->DestroyEvent(Unwrap(GetDev()), m_CleanupEvents[i], NULL);
 
+    AbandonPendingRerecord();
+
     for(const rdcpair<VkCommandPool, VkCommandBuffer> &rerecord : m_RerecordCmdList)
       vkFreeCommandBuffers(GetDev(), rerecord.first, 1, &rerecord.second);
+
+    TrimRerecordCache();
   }
 
   // submit the indirect preparation command buffer, if we need to
@@ -3112,6 +3365,11 @@ void WrappedVulkan::AddFrameTerminator(uint64_t queueMarkerTag)
 
 void WrappedVulkan::ReplayLog(uint32_t startEventID, uint32_t endEventID, ReplayLogType replayType)
 {
+  RDCPROFILE_ZONE("WrappedVulkan::ReplayLog");
+
+  // any replay not coming through ReplayToEvent may leave the GPU state in an arbitrary place
+  m_ReplayedToEvent = 0;
+
   bool partial = true;
 
   if(startEventID == 0 && (replayType == eReplay_WithoutDraw || replayType == eReplay_Full))
@@ -3134,6 +3392,10 @@ void WrappedVulkan::ReplayLog(uint32_t startEventID, uint32_t endEventID, Replay
 
   m_State = CaptureState::ActiveReplaying;
 
+  // replays from the start of the frame can skip ahead to a checkpoint
+  if(!partial)
+    BeginCheckpointReplay(replayType == eReplay_Full ? endEventID : RDCMAX(1U, endEventID) - 1);
+
   VkMarkerRegion::Set(StringFormat::Fmt("!!!!RenderDoc Internal: RenderDoc Replay %d (%d): %u->%u",
                                         (int)replayType, (int)partial, startEventID, endEventID));
 
@@ -3220,6 +3482,9 @@ void WrappedVulkan::ReplayLog(uint32_t startEventID, uint32_t endEventID, Replay
 
     RDCASSERTEQUAL(status, ReplayStatus::Succeeded);
 
+    if(!partial)
+      EndCheckpointReplay();
+
     if(m_OutsideCmdBuffer != VK_NULL_HANDLE)
     {
       VkCommandBuffer cmd = m_OutsideCmdBuffer;
@@ -3264,6 +3529,86 @@ void WrappedVulkan::ReplayLog(uint32_t startEventID, uint32_t endEventID, Replay
   VkMarkerRegion::Set("!!!!RenderDoc Internal: Done replay");
 }
 
+bool WrappedVulkan::CanReplayForwardTo(uint32_t eventId)
+{
+  const uint32_t replayed = m_ReplayedToEvent;
+
+  if(replayed == 0 || eventId <= replayed || m_DrawcallCallback)
+    return false;
+
+  // we can only continue on from the current partial replay state, so both events must lie in the
+  // same submission of the partial primary command buffer.
+  const PartialReplayData &partial = m_Partial[Primary];
+  if(m_Partial[Secondary].partialParent != ResourceId() || partial.partialParent == ResourceId())
+    return false;
+
+  auto it = m_BakedCmdBufferInfo.find(partial.partialParent);
+  if(it == m_BakedCmdBufferInfo.end() || replayed < partial.baseEvent ||
+     eventId >= partial.baseEvent + it->second.eventCount)
+    return false;
+
+  // these are ended at the end of every partial replay and not resumed by the next one
+  if(!m_RenderState.xfbcounters.empty() || m_RenderState.IsConditionalRenderingEnabled())
+    return false;
+
+  // render pass activity isn't carried over between partial replays either, so any event in
+  // between (including the one last replayed alone) that changes it needs a full replay.
+  for(uint32_t eid = replayed; eid < eventId; eid++)
+  {
+    const APIEvent &ev = GetEvent(eid);
+    if(ev.eventId != eid)
+      continue;
+
+    VulkanChunk chunk = (VulkanChunk)m_StructuredFile->chunks[ev.chunkIndex]->metadata.chunkID;
+    switch(chunk)
+    {
+      case VulkanChunk::vkCmdBeginRenderPass:
+      case VulkanChunk::vkCmdNextSubpass:
+      case VulkanChunk::vkCmdEndRenderPass:
+      case VulkanChunk::vkCmdBeginRenderPass2:
+      case VulkanChunk::vkCmdNextSubpass2:
+      case VulkanChunk::vkCmdEndRenderPass2:
+      case VulkanChunk::vkCmdExecuteCommands:
+      case VulkanChunk::vkCmdBeginTransformFeedbackEXT:
+      case VulkanChunk::vkCmdEndTransformFeedbackEXT:
+      case VulkanChunk::vkCmdBeginConditionalRenderingEXT:
+      case VulkanChunk::vkCmdEndConditionalRenderingEXT: return false;
+      default: break;
+    }
+  }
+
+  return true;
+}
+
+void WrappedVulkan::ReplayToEvent(uint32_t endEventID, ReplayLogType replayType)
+{
+  const uint32_t replayed = m_ReplayedToEvent;
+
+  // when moving forward within the partial command buffer, everything up to the last event is
+  // already applied so only the events in between need to be replayed on top.
+  if(replayType == eReplay_WithoutDraw && CanReplayForwardTo(endEventID))
+  {
+    if(replayed + 1 < endEventID)
+      ReplayLog(replayed + 1, endEventID, eReplay_WithoutDraw);
+
+    m_ReplayedToEvent = endEventID - 1;
+    return;
+  }
+
+  ReplayLog(0, endEventID, replayType);
+
+  // callbacks can change what's been replayed, so don't trust the state afterwards
+  if(m_DrawcallCallback)
+    return;
+
+  if(replayType == eReplay_Full)
+    m_ReplayedToEvent = endEventID;
+  else if(replayType == eReplay_WithoutDraw)
+    m_ReplayedToEvent = RDCMAX(1U, endEventID) - 1;
+  else if(replayType == eReplay_OnlyDraw && replayed != 0 && replayed + 1 == endEventID)
+    m_ReplayedToEvent = endEventID;
+}
+
 template <typename SerialiserType>
 void WrappedVulkan::Serialise_DebugMessages(SerialiserType &ser)
 {
@@ -3486,6 +3831,11 @@ VkBool32 WrappedVulkan::DebugCallback(MessageSeverity severity, MessageCategory
     if(strstr(pMessageId, "VUID-VkSwapchainCreateInfoKHR-imageExtent"))
       return false;
 
+    // with replay-time validation the capture's messages were all gathered while loading, and
+    // every later replay would just repeat them into the log.
+    if(IsActiveReplaying(m_State) && m_ReplayOptions.apiValidation)
+      return false;
+
     RDCWARN("[%s] %s", pMessageId, pMessage);
   }
 
@@ -3761,6 +4111,33 @@ void WrappedVulkan::AddDrawcall(const DrawcallDescription &d, bool hasEvents)
     RDCERR("Somehow lost drawcall stack!");
 }
 
+uint32_t WrappedVulkan::GetFirstUseEvent(ResourceId origId)
+{
+  auto it = m_FirstShaderUse.find(origId);
+  if(it != m_FirstShaderUse.end())
+    return it->second;
+
+  if(!GetResourceManager()->HasLiveResource(origId))
+    return 0;
+
+  ResourceId liveId = GetResourceManager()->GetLiveID(origId);
+
+  // shader modules and pipelines that were never used by any drawcall or dispatch
+  if(m_CreationInfo.m_ShaderModule.find(liveId) != m_CreationInfo.m_ShaderModule.end() ||
+     m_CreationInfo.m_Pipeline.find(liveId) != m_CreationInfo.m_Pipeline.end())
+    return ~0U;
+
+  auto useit = m_ResourceUses.find(liveId);
+  if(useit == m_ResourceUses.end() || useit->second.empty())
+    return 0;
+
+  uint32_t first = ~0U;
+  for(const EventUsage &u : useit->second)
+    first = RDCMIN(first, u.eventId);
+
+  return first;
+}
+
 void WrappedVulkan::AddUsage(VulkanDrawcallTreeNode &drawNode, rdcarray<DebugMessage> &debugMessages)
 {
   DrawcallDescription &d = drawNode.draw;
@@ -3813,6 +4190,10 @@ void WrappedVulkan::AddUsage(VulkanDrawcallTreeNode &drawNode, rdcarray<DebugMes
     ResourceId origPipe = GetResourceManager()->GetOriginalID(pipe);
     ResourceId origShad = GetResourceManager()->GetOriginalID(sh.module);
 
+    if(!drawNode.shaderUsage.contains(origPipe))
+      drawNode.shaderUsage.push_back(origPipe);
+    drawNode.shaderUsage.push_back(origShad);
+
     // 5 is the compute shader's index (VS, TCS, TES, GS, FS, CS)
     const rdcarray<VulkanStatePipeline::DescriptorAndOffsets> &descSets =
         (compute ? state.compute.descSets : state.graphics.descSets);
@@ -4159,6 +4540,61 @@ void WrappedVulkan::UpdateImageStates(const std::map<ResourceId, ImageState> &ds
   }
 }
 
+void WrappedVulkan::UpdateImageStates(
+    const rdcarray<const std::map<ResourceId, ImageState> *> &dstStates)
+{
+  SCOPED_LOCK(m_ImageStatesLock);
+  ImageTransitionInfo info = GetImageTransitionInfo();
+
+  // gather every state for each image in submission order, and create any new image states up
+  // front so that the merges below don't modify m_ImageStates itself.
+  struct PendingMerge
+  {
+    LockingImageState *state;
+    rdcarray<const ImageState *> srcs;
+  };
+  rdcarray<PendingMerge> pending;
+  std::map<ResourceId, size_t> pendingIndex;
+
+  size_t mergeCount = 0;
+  for(const std::map<ResourceId, ImageState> *states : dstStates)
+  {
+    for(auto dstIt = states->begin(); dstIt != states->end(); ++dstIt)
+    {
+      auto idxIt = pendingIndex.find(dstIt->first);
+      if(idxIt == pendingIndex.end())
+      {
+        auto it = m_ImageStates.find(dstIt->first);
+        if(it == m_ImageStates.end())
+        {
+          it = m_ImageStates
+                   .insert({dstIt->first,
+                            LockingImageState(dstIt->second.wrappedHandle,
+                                              dstIt->second.GetImageInfo(),
+                                              info.GetDefaultRefType())})
+                   .first;
+          dstIt->second.InitialState(*it->second.LockWrite());
+        }
+
+        idxIt = pendingIndex.insert({dstIt->first, pending.size()}).first;
+        pending.push_back({&it->second, {}});
+      }
+
+      pending[idxIt->second].srcs.push_back(&dstIt->second);
+      mergeCount++;
+    }
+  }
+
+  // spinning up threads costs more than a handful of merges, so only go wide for big submissions
+  uint32_t numThreads = mergeCount >= 256 ? Threading::NumberOfCores() : 1;
+
+  Threading::ParallelFor(numThreads, (uint32_t)pending.size(), [&pending, &info](uint32_t i) {
+    LockedImageStateRef state = pending[i].state->LockWrite();
+    for(const ImageState *src : pending[i].srcs)
+      state->Merge(*src, info);
+  });
+}
+
 #if ENABLED(ENABLE_UNIT_TESTS)
 
 #undef None
@@ -24,6 +24,7 @@
 
 #pragma once
 
+#include "common/temp_memory.h"
 #include "common/timing.h"
 #include "serialise/serialiser.h"
 #include "vk_common.h"
@@ -53,7 +54,7 @@ struct VkInitParams
   uint64_t GetSerialiseSize();
 
   // check if a frame capture section version is supported
-  static const uint64_t CurrentVersion = 0x11;
+  static const uint64_t CurrentVersion = 0x13;
   static bool IsSupportedVersion(uint64_t ver);
 };
 
@@ -126,6 +127,9 @@ struct VulkanDrawcallTreeNode
 
   rdcarray<rdcpair<ResourceId, EventUsage>> resourceUsage;
 
+  // original IDs of the pipeline and shader modules used by a drawcall or dispatch
+  rdcarray<ResourceId> shaderUsage;
+
   rdcarray<ResourceId> executedCmds;
 
   VulkanDrawcallTreeNode &operator=(const DrawcallDescription &d)
@@ -279,6 +283,22 @@ private:
   CaptureState m_State;
   bool m_AppControlledCapture = false;
 
+  // the submissions a capture is restricted to by the capture options, copied when it's triggered.
+  // Until the first submission in scope the capture is pending, and the driver is still background
+  // capturing.
+  struct SubmitScope
+  {
+    bool enabled = false;
+    bool pending = false;
+    uint32_t queueFamily = ~0U;
+    uint32_t firstSubmit = 0;
+    uint32_t numSubmits = 0;
+    // submissions to the selected queue family seen so far
+    uint32_t submitIndex = 0;
+  };
+  Threading::CriticalSection m_SubmitScopeLock;
+  SubmitScope m_SubmitScope;
+
   bool m_MarkedActive = false;
   uint32_t m_SubmitCounter = 0;
 
@@ -287,15 +307,7 @@ private:
   Threading::CriticalSection m_ThreadSerialisersLock;
   rdcarray<WriteSerialiser *> m_ThreadSerialisers;
 
-  uint64_t tempMemoryTLSSlot;
-  struct TempMem
-  {
-    TempMem() : memory(NULL), size(0) {}
-    byte *memory;
-    size_t size;
-  };
-  Threading::CriticalSection m_ThreadTempMemLock;
-  rdcarray<TempMem *> m_ThreadTempMem;
+  ThreadTempMemory m_TempMemory;
 
   VulkanReplay *m_Replay;
   ReplayOptions m_ReplayOptions;
@@ -307,6 +319,12 @@ private:
 
   std::set<rdcstr> m_StringDB;
 
+  // shader module code is stored once per distinct blob rather than in each vkCreateShaderModule
+  // chunk. While capturing the blobs are shared between module records, and on replay the blob
+  // section is loaded for the duration of ReadLogInitialisation.
+  ShaderModuleBlobStore m_ShaderModuleBlobs;
+  std::map<uint64_t, bytebuf> m_ReplayShaderBlobs;
+
   VkResourceRecord *m_FrameCaptureRecord;
   Chunk *m_HeaderChunk;
 
@@ -352,6 +370,8 @@ private:
   uint32_t m_FrameCounter = 0;
 
   rdcarray<FrameDescription> m_CapturedFrames;
+  // incremented for each capture started, to tell apart per-capture state on records
+  int32_t m_CaptureSerial = 0;
   rdcarray<DrawcallDescription *> m_Drawcalls;
 
   struct PhysicalDeviceData
@@ -375,6 +395,12 @@ private:
 
     VkPhysicalDevicePerformanceQueryFeaturesKHR performanceQueryFeatures = {};
 
+    // only filled out when both the device and the replay instance are at least 1.1
+    VkPhysicalDeviceSubgroupProperties subgroupProps = {};
+
+    // whether heap budgets can be queried with VK_EXT_memory_budget
+    bool memoryBudget = false;
+
     uint32_t queueCount = 0;
     VkQueueFamilyProperties queueProps[16] = {};
   };
@@ -404,6 +430,17 @@ private:
   // the last queue that submitted something during replay, to allow correct sync between
   // submissions
   VkQueue m_PrevQueue;
+  // when replaying queues concurrently, the semaphores signalled by a replayed submission that
+  // haven't been waited on yet. Waits on any other semaphore are dropped, since it was signalled
+  // before the frame (e.g. by a swapchain acquire).
+  rdcarray<VkSemaphore> m_PendingReplaySemaphores;
+
+  // the unwrapped semaphores patched into a replayed submission, valid until the next patch
+  rdcarray<VkSemaphore> m_ReplayWaitSems, m_ReplaySignalSems;
+  rdcarray<VkPipelineStageFlags> m_ReplayWaitStages;
+
+  void PatchReplaySemaphores(const VkSubmitInfo &original, VkSubmitInfo &submit);
+  void FlushPendingReplaySemaphores();
 
   // the physical devices. At capture time this is trivial, just the enumerated devices.
   // At replay time this is re-ordered from the real list to try and match
@@ -441,6 +478,121 @@ private:
   void InlineSetupImageBarriers(VkCommandBuffer cmd, ImageBarrierSequence &batches);
   void InlineCleanupImageBarriers(VkCommandBuffer cmd, ImageBarrierSequence &batches);
 
+  // while preparing initial contents at capture start, each resource's readback copy is submitted
+  // without waiting for it, so the GPU copies earlier resources while we record later ones. We only
+  // sync once enough data is in flight, at which point the temporary buffers & images are released
+  // and any deferred cleanup barriers on other queues are flushed.
+  struct InitStateBatch
+  {
+    bool active = false;
+    VkDeviceSize pendingBytes = 0;
+    uint32_t pendingCopies = 0;
+    rdcarray<VkBuffer> buffers;
+    rdcarray<VkImage> images;
+  } m_InitStateBatch;
+
+  static const VkDeviceSize InitStateBatchBytes = 256 * 1024 * 1024;
+  static const uint32_t InitStateBatchCopies = 128;
+
+  // opt-in with CaptureOptions::compactInitialStates. Image contents at least this large are
+  // compacted on the GPU before readback, so that tiles of a single repeated value aren't copied.
+  bool m_CompactInitialStates = false;
+  static const VkDeviceSize CompactInitStateMinSize = 4 * 1024 * 1024;
+
+  void BeginInitStateBatch();
+  void SubmitInitStateCopy(VkDeviceSize bytes);
+  void FlushInitStateBatch();
+  void EndInitStateBatch();
+
+  // opt-in with ReplayOptions::replayCheckpointInterval. While replaying the whole frame, the
+  // contents of the frame's images and memory are snapshotted at queue submit boundaries at least
+  // this many events apart, up to ReplayOptions::replayCheckpointBudgetMB of VRAM. A later
+  // replay to an event after a checkpoint skips all GPU work before it and restores the snapshot.
+  struct ReplayCheckpoint
+  {
+    struct Image
+    {
+      ResourceId id;
+      VkImage copy;
+      ImageState state;
+    };
+
+    struct Memory
+    {
+      ResourceId id;
+      VkBuffer copy;
+      VkDeviceSize size;
+    };
+
+    uint32_t eventId = 0;
+    rdcarray<Image> images;
+    rdcarray<Memory> memory;
+  };
+
+  uint32_t m_CheckpointInterval = 0;
+  VkDeviceSize m_CheckpointBudget = 0;
+  VkDeviceSize m_CheckpointBytes = 0;
+  // set once the frame is found to contain something that can't be snapshotted
+  bool m_CheckpointsUnsupported = false;
+  // true while replaying from the start of the frame without any callbacks
+  bool m_CheckpointReplay = false;
+  // sorted by eventId
+  rdcarray<ReplayCheckpoint> m_Checkpoints;
+  // index of the checkpoint that the current replay will restore, submits are skipped until then
+  int32_t m_ResumeCheckpoint = -1;
+  // the presents within a multi-frame capture. Checkpoints are always taken at the first submit of
+  // each frame, even without an interval set, so that seeking between frames is quick.
+  rdcarray<uint32_t> m_FrameBoundaryEIDs;
+
+  void BeginCheckpointReplay(uint32_t lastEventID);
+  void EndCheckpointReplay();
+  bool IsSkippingToCheckpoint() const { return m_ResumeCheckpoint >= 0; }
+  void ReplayCheckpointSubmitted();
+  bool CreateReplayCheckpoint(ReplayCheckpoint &checkpoint);
+  void RestoreReplayCheckpoint(const ReplayCheckpoint &checkpoint);
+  void DestroyReplayCheckpoint(ReplayCheckpoint &checkpoint);
+  void FreeReplayCheckpoints();
+  // free only the checkpoints that contain the results of eventId or later
+  void FreeReplayCheckpointsFrom(uint32_t eventId);
+
+  // opt-in with ReplayOptions::rerecordCacheMB. Primary command buffers that are re-recorded in
+  // full are kept between replays, and a later replay submits the cached recording and skips over
+  // the commands instead. The least recently used are freed when their serialised size goes
+  // over the budget. Only command buffers whose chunks are contiguous in the capture are cached.
+  //
+  // Updating a descriptor set invalidates any command buffer that has it bound, so a cached
+  // recording is dropped as soon as one of its bound sets is written during replay - including by
+  // the initial contents being applied.
+  struct RerecordCacheEntry
+  {
+    VkCommandPool pool = VK_NULL_HANDLE;
+    VkCommandBuffer cmd = VK_NULL_HANDLE;
+    // offsets of the vkBeginCommandBuffer chunk and just after the vkEndCommandBuffer chunk, 0 for
+    // the end while the command buffer is still being recorded
+    uint64_t beginOffset = 0;
+    uint64_t endOffset = 0;
+    uint64_t lastUsed = 0;
+    // the live descriptor sets bound in the recording
+    std::set<ResourceId> boundSets;
+  };
+
+  uint64_t m_RerecordCacheBudget = 0;
+  uint64_t m_RerecordCacheBytes = 0;
+  uint64_t m_RerecordCacheTick = 0;
+  // keyed by baked command buffer ID
+  std::map<ResourceId, RerecordCacheEntry> m_RerecordCache;
+  // the command buffer currently being recorded into the cache, if any
+  ResourceId m_RerecordCachePending;
+  // set when a cached command buffer was used, to skip the reader past its commands
+  uint64_t m_RerecordCacheSkipOffset = 0;
+
+  void RerecordCacheChunkDone(VulkanChunk chunk, uint64_t offset);
+  void AbandonPendingRerecord();
+  void RerecordCacheSetsBound(const VkDescriptorSet *sets, uint32_t count);
+  void RerecordCacheSetWritten(ResourceId set);
+  void TrimRerecordCache();
+  void FreeRerecordCache();
+
   struct QueueRemap
   {
     uint32_t family;
@@ -493,10 +645,23 @@ private:
 
   // Internal lumped/pooled memory allocations
 
-  // Each memory scope gets a separate vector of allocation objects. The vector contains the list of
-  // all 'base' allocations. The offset is used to indicate the current offset, and the size is the
-  // total size, thus the free space can be determined with size - offset.
-  rdcarray<MemoryAllocation> m_MemoryBlocks[arraydim<MemoryScope>()];
+  // Each memory scope gets a separate vector of blocks. Each block's allocation is the 'base'
+  // allocation, where the offset is used to indicate the current offset and the size is the total
+  // size, thus the untouched space at the end can be determined with size - offset.
+  // Space below the offset that has been freed is tracked in a sorted list of ranges and re-used
+  // first-fit, and once a block is entirely free it is released.
+  struct MemoryBlock
+  {
+    MemoryAllocation alloc;
+
+    // (offset, size) ranges below alloc.offs that are free, sorted by offset and never adjacent
+    rdcarray<rdcpair<VkDeviceSize, VkDeviceSize>> freeRanges;
+
+    // set when the offset has moved back after a free, in which case we no longer know whether a
+    // buffer or image comes before it
+    bool lastTypeUnknown = false;
+  };
+  rdcarray<MemoryBlock> m_MemoryBlocks[arraydim<MemoryScope>()];
 
   // Per memory scope, the size of the next allocation. This allows us to balance number of memory
   // allocation objects with size by incrementally allocating larger blocks.
@@ -507,6 +672,10 @@ private:
   void FreeAllMemory(MemoryScope scope);
   void FreeMemoryAllocation(MemoryAllocation alloc);
 
+  // returns true if allocating size more bytes in the heap backing memoryTypeIndex would exceed
+  // the budget reported by VK_EXT_memory_budget. Always false if budgets aren't available.
+  bool IsOverMemoryBudget(uint32_t memoryTypeIndex, VkDeviceSize size);
+
   // internal implementation - call one of the functions above
   MemoryAllocation AllocateMemoryForResource(bool buffer, VkMemoryRequirements mrq,
                                              MemoryScope scope, MemoryType type);
@@ -648,6 +817,13 @@ private:
   // so we just set this command buffer
   VkCommandBuffer m_OutsideCmdBuffer = VK_NULL_HANDLE;
 
+  // the last event whose effects are applied on the GPU, exactly as if the frame had been replayed
+  // up to it through ReplayToEvent. 0 if the state is unknown or has been disturbed by any other
+  // replay since.
+  uint32_t m_ReplayedToEvent = 0;
+
+  bool CanReplayForwardTo(uint32_t eventId);
+
   // stores the currently re-recording command buffer for any original command buffer ID (not bake
   // ID). This allows a quick check to see if an original command should be recorded, and also to
   // fetch the command buffer to record into.
@@ -696,9 +872,82 @@ private:
 
   ResourceId m_LastSwap;
 
-  // holds the current list of coherent mapped memory. Locked against concurrent use
+  // holds the current list of coherent mapped memory. Locked against concurrent use, the lock is
+  // taken on every map/unmap/submit so it's a lightweight one with contention counters
   rdcarray<VkResourceRecord *> m_CoherentMaps;
-  Threading::CriticalSection m_CoherentMapsLock;
+  static Threading::LockStats CoherentMapsLockStats;
+  Threading::AdaptiveLock m_CoherentMapsLock{&CoherentMapsLockStats};
+
+  // opt-in with CaptureOptions::watchCoherentMapWrites. Coherent maps are write-protected so that
+  // only the pages actually written are flushed on submit, rather than diffing against a shadow
+  // copy.
+  bool m_WatchCoherentMapWrites = false;
+
+  // opt-in with CaptureOptions::deferDescriptorUpdates. While idle, updates to read-only descriptor
+  // bindings are only journaled on the set, and applied to its slots when a capture starts or the
+  // set is copied. Writable bindings are always applied immediately, for dirty tracking on submit.
+  bool m_DeferDescriptorShadowing = false;
+
+  // sets with a non-empty journal. May contain sets that have since been freed, which are pruned
+  // when the list has doubled in size since the last time.
+  rdcarray<ResourceId> m_DeferredDescriptorSets;
+  size_t m_DeferredDescriptorSetsPruneSize = 1024;
+  Threading::CriticalSection m_DeferredDescriptorSetsLock;
+
+  // opt-in with CaptureOptions::deferCreationChunks. While idle, the creation chunks of samplers
+  // and image/buffer views are only serialised if a capture starts while the object is alive, so
+  // objects created and destroyed between captures never build a chunk.
+  bool m_DeferCreateChunks = false;
+
+  struct DeferredCreateChunk
+  {
+    DeferredCreateChunk(VkDevice dev, VkSampler obj, const VkSamplerCreateInfo &info)
+        : chunk(VulkanChunk::vkCreateSampler), device(dev)
+    {
+      handle.sampler = obj;
+      createInfo.sampler = info;
+    }
+    DeferredCreateChunk(VkDevice dev, VkImageView obj, const VkImageViewCreateInfo &info)
+        : chunk(VulkanChunk::vkCreateImageView), device(dev)
+    {
+      handle.imageView = obj;
+      createInfo.imageView = info;
+    }
+    DeferredCreateChunk(VkDevice dev, VkBufferView obj, const VkBufferViewCreateInfo &info)
+        : chunk(VulkanChunk::vkCreateBufferView), device(dev)
+    {
+      handle.bufferView = obj;
+      createInfo.bufferView = info;
+    }
+
+    VulkanChunk chunk;
+    VkDevice device;
+    // the chunk ID is reserved at creation time so the record still sorts in creation order
+    int32_t chunkID = 0;
+    // the image or buffer a view was created from, since the create info refers to its handle
+    VkResourceRecord *parent = NULL;
+    uint64_t timestampMicro = 0;
+    int64_t durationMicro = -1;
+
+    union Handle
+    {
+      VkSampler sampler;
+      VkImageView imageView;
+      VkBufferView bufferView;
+    } handle;
+
+    union
+    {
+      VkSamplerCreateInfo sampler;
+      VkImageViewCreateInfo imageView;
+      VkBufferViewCreateInfo bufferView;
+    } createInfo;
+  };
+
+  // objects whose creation chunk hasn't been serialised yet. Only modified while background
+  // capturing, and emptied when a capture starts.
+  std::map<VkResourceRecord *, DeferredCreateChunk> m_DeferredCreateChunks;
+  Threading::CriticalSection m_DeferredCreateChunksLock;
 
   rdcarray<VkResourceRecord *> m_ForcedReferences;
   Threading::CriticalSection m_ForcedReferencesLock;
@@ -756,8 +1005,11 @@ private:
 
   std::map<ResourceId, rdcarray<EventUsage>> m_ResourceUses;
   std::map<uint32_t, EventFlags> m_EventFlags;
+  // first event that each pipeline and shader module is used at, by original ID
+  std::map<ResourceId, uint32_t> m_FirstShaderUse;
 
-  // returns thread-local temporary memory
+  // returns thread-local temporary memory, valid until the next call unless a TempMemoryScope on
+  // m_TempMemory is open
   byte *GetTempMemory(size_t s);
   template <class T>
   T *GetTempArray(uint32_t arraycount)
@@ -765,12 +1017,33 @@ private:
     return (T *)GetTempMemory(sizeof(T) * arraycount);
   }
 
+  // small arrays of handles are unwrapped into inline storage, which avoids the thread-local temp
+  // memory lookup for the handful of handles typically passed to high-frequency commands. The
+  // unwrapped pointer is only valid for the full expression, i.e. as a parameter to the next call.
   template <class T>
-  T *UnwrapArray(const T *wrapped, uint32_t count)
+  struct UnwrappedArray
   {
-    T *ret = GetTempArray<T>(count);
+    static const uint32_t InlineCount = 8;
+
+    operator T *() { return count <= InlineCount ? inlineHandles : tempHandles; }
+    uint32_t count;
+    T *tempHandles;
+    T inlineHandles[InlineCount];
+  };
+
+  template <class T>
+  UnwrappedArray<T> UnwrapArray(const T *wrapped, uint32_t count)
+  {
+    UnwrappedArray<T> ret;
+    ret.count = count;
+    ret.tempHandles = NULL;
+
+    T *unwrapped = ret.inlineHandles;
+    if(count > UnwrappedArray<T>::InlineCount)
+      unwrapped = ret.tempHandles = GetTempArray<T>(count);
+
     for(uint32_t i = 0; i < count; i++)
-      ret[i] = wrapped ? Unwrap(wrapped[i]) : VK_NULL_HANDLE;
+      unwrapped[i] = wrapped ? Unwrap(wrapped[i]) : VK_NULL_HANDLE;
     return ret;
   }
 
@@ -780,12 +1053,29 @@ private:
   template <class T>
   T *UnwrapInfos(const T *infos, uint32_t count);
 
+  // on replay all pipelines are created against our own pipeline cache instead of the
+  // application's. It's persisted on disk per device and driver, so re-opening a capture - or
+  // another capture using the same shaders - doesn't need to compile everything again.
+  VkPipelineCache m_ReplayPipelineCache = VK_NULL_HANDLE;
+  size_t m_ReplayPipelineCacheSavedSize = 0;
+  rdcstr GetReplayPipelineCachePath();
+  void CreateReplayPipelineCache();
+  void SaveReplayPipelineCache();
+  void DestroyReplayPipelineCache();
+
+  // pipelines whose subpass-0 variant for partial replay of render passes is still to be created.
+  // These are only needed once the frame is replayed, so they're created in parallel at the end of
+  // loading rather than in line with each pipeline.
+  rdcarray<ResourceId> m_PendingSubpass0Pipelines;
+  void CreatePendingSubpass0Pipelines();
+
   VkIndirectPatchData FetchIndirectData(VkIndirectPatchType type, VkCommandBuffer commandBuffer,
                                         VkBuffer dataBuffer, VkDeviceSize dataOffset, uint32_t count,
                                         uint32_t stride = 0, VkBuffer counterBuffer = VK_NULL_HANDLE,
                                         VkDeviceSize counterOffset = 0);
   void ExecuteIndirectReadback(VkCommandBuffer commandBuffer,
                                const VkIndirectRecordData &indirectcopy);
+  void ReadIndirectData(const VkIndirectPatchData &indirectPatch, bytebuf &ret);
 
   WriteSerialiser &GetThreadSerialiser();
   template <typename SerialiserType>
@@ -794,8 +1084,12 @@ private:
 
   template <typename SerialiserType>
   bool Serialise_BeginCaptureFrame(SerialiserType &ser);
+  void BeginActiveCapture();
   void EndCaptureFrame(VkImage presentImage);
 
+  bool CheckSubmitScope(VkQueue queue);
+  bool ResetSubmitScope();
+
   void FirstFrame();
 
   bool CheckMemoryRequirements(const char *resourceName, ResourceId memId,
@@ -835,6 +1129,10 @@ private:
                                          const VkInitialContents *contents);
   bool Apply_SparseInitialState(WrappedVkBuffer *buf, const VkInitialContents &contents);
   bool Apply_SparseInitialState(WrappedVkImage *im, const VkInitialContents &contents);
+  MemoryAllocation Prepare_SparseRegions(rdcarray<SparseMemRegion> &regions,
+                                         VkDeviceSize &totalSize);
+  void Apply_SparseRegions(VkCommandBuffer cmd, VkBuffer srcBuf, const SparseMemRegion *regions,
+                           uint32_t numRegions);
 
   void ApplyInitialContents();
 
@@ -851,6 +1149,9 @@ private:
 
   ReplayStatus m_FailedReplayStatus = ReplayStatus::APIReplayFailed;
 
+  // total milliseconds spent blocked in FlushQ, sampled around each chunk while loading
+  double m_GPUWaitTime = 0.0;
+
   VulkanDrawcallTreeNode m_ParentDrawcall;
 
   bool m_LayersEnabled[VkCheckLayer_Max] = {};
@@ -935,6 +1236,14 @@ public:
   VulkanShaderCache *GetShaderCache() { return m_ShaderCache; }
   CaptureState GetState() { return m_State; }
   VulkanReplay *GetReplay() { return m_Replay; }
+  VkDeviceSize GetAllocatedMemorySize(MemoryScope scope);
+  uint64_t GetRerecordCacheSize() { return m_RerecordCacheBytes; }
+  void EvictRerecordCache()
+  {
+    // cached command buffers may still be executing from the last replay
+    FlushQ();
+    FreeRerecordCache();
+  }
   // replay interface
   bool Prepare_InitialState(WrappedVkRes *res);
   uint64_t GetSize_InitialState(ResourceId id, const VkInitialContents &initial);
@@ -960,6 +1269,7 @@ public:
   }
   void Shutdown();
   void ReplayLog(uint32_t startEventID, uint32_t endEventID, ReplayLogType replayType);
+  void ReplayToEvent(uint32_t endEventID, ReplayLogType replayType);
   ReplayStatus ReadLogInitialisation(RDCFile *rdc, bool storeStructuredBuffers);
 
   SDFile &GetStructuredFile() { return *m_StructuredFile; }
@@ -977,7 +1287,15 @@ public:
   uint32_t GetGPULocalMemoryIndex(uint32_t resourceRequiredBitmask);
 
   EventFlags GetEventFlags(uint32_t eid) { return m_EventFlags[eid]; }
-  rdcarray<EventUsage> GetUsage(ResourceId id) { return m_ResourceUses[id]; }
+  uint32_t GetFirstUseEvent(ResourceId origId);
+  rdcarray<EventUsage> GetUsage(ResourceId id)
+  {
+    // don't use operator[], looking up a resource with no usage shouldn't add an entry for it
+    auto it = m_ResourceUses.find(id);
+    if(it == m_ResourceUses.end())
+      return {};
+    return it->second;
+  }
   // return the pre-selected device and queue
   VkDevice GetDev()
   {
@@ -1033,6 +1351,10 @@ public:
   {
     return m_PhysicalDeviceData.performanceQueryFeatures;
   }
+  const VkPhysicalDeviceSubgroupProperties &GetPhysicalDeviceSubgroupProperties()
+  {
+    return m_PhysicalDeviceData.subgroupProps;
+  }
   VkDriverInfo GetDriverInfo() { return m_PhysicalDeviceData.driverInfo; }
   uint32_t FindCommandQueueFamily(ResourceId cmdId);
   void InsertCommandQueueFamily(ResourceId cmdId, uint32_t queueFamilyIndex);
@@ -1042,6 +1364,9 @@ public:
                                        FrameRefType refType, bool *inserted = NULL);
   bool EraseImageState(ResourceId id);
   void UpdateImageStates(const std::map<ResourceId, ImageState> &dstStates);
+  // merges several sets of states in order, e.g. every command buffer in a submission. Different
+  // images are independent so large batches are merged in parallel.
+  void UpdateImageStates(const rdcarray<const std::map<ResourceId, ImageState> *> &dstStates);
 
   inline ImageTransitionInfo GetImageTransitionInfo() const
   {
@@ -1344,6 +1669,17 @@ public:
   void ReplayDescriptorSetWrite(VkDevice device, const VkWriteDescriptorSet &writeDesc);
   void ReplayDescriptorSetCopy(VkDevice device, const VkCopyDescriptorSet &copyDesc);
 
+  DescriptorSetSlot *DeferDescriptorWrite(VkResourceRecord *record, uint32_t binding,
+                                          uint32_t arrayElement, uint32_t count,
+                                          VkDescriptorType type, bool setSampler, bool setImageView);
+  void ApplyDeferredDescriptorWrites(VkResourceRecord *record);
+  void ApplyAllDeferredDescriptorWrites();
+
+  bool DeferCreateChunk(VkResourceRecord *record, DeferredCreateChunk deferred);
+  Chunk *SerialiseDeferredCreateChunk(const DeferredCreateChunk &deferred);
+  void ReleaseDeferredCreateChunks(VkResourceRecord *record);
+  void SerialiseAllDeferredCreateChunks();
+
   IMPLEMENT_FUNCTION_SERIALISED(void, vkUpdateDescriptorSets, VkDevice device,
                                 uint32_t descriptorWriteCount,
                                 const VkWriteDescriptorSet *pDescriptorWrites,
@@ -416,6 +416,9 @@ void VulkanReplay::FillTimersAMD(uint32_t *eventStartID, uint32_t *sampleIndex,
 {
   uint32_t maxEID = m_pDriver->GetMaxEID();
 
+  // each pass needs a fresh callback, since command lists must be begun again and aliases are
+  // re-reported. Keep the last one around for the alias events after all passes are done.
+  SAFE_DELETE(m_pAMDDrawCallback);
   m_pAMDDrawCallback = new VulkanAMDDrawCallback(m_pDriver, this, *sampleIndex, *eventIDs);
 
   // replay the events to perform all the queries
@@ -448,6 +451,8 @@ rdcarray<CounterResult> VulkanReplay::FetchCountersAMD(const rdcarray<GPUCounter
 
   uint32_t passCount = m_pAMDCounters->GetPassCount();
 
+  RDCLOG("Fetching %zu AMD counters in %u passes", counters.size(), passCount);
+
   uint32_t sampleIndex = 0;
 
   rdcarray<uint32_t> eventIDs;
@@ -573,14 +578,18 @@ rdcarray<CounterResult> VulkanReplay::FetchCountersKHR(const rdcarray<GPUCounter
   for(const GPUCounter &c : counters)
     counterIndices.push_back(FromKHRCounter(c));
 
+  // the implementation packs all the requested counters into as few passes as it can, for the
+  // queue family we replay on
   VkQueryPoolPerformanceCreateInfoKHR perfCreateInfo = {
-      VK_STRUCTURE_TYPE_QUERY_POOL_PERFORMANCE_CREATE_INFO_KHR, NULL, 0,
-      (uint32_t)counterIndices.size(), &counterIndices[0]};
+      VK_STRUCTURE_TYPE_QUERY_POOL_PERFORMANCE_CREATE_INFO_KHR, NULL,
+      m_pDriver->GetQueueFamilyIndex(), (uint32_t)counterIndices.size(), &counterIndices[0]};
   uint32_t passCount = 0;
   ObjDisp(m_pDriver->GetInstance())
       ->GetPhysicalDeviceQueueFamilyPerformanceQueryPassesKHR(Unwrap(m_pDriver->GetPhysDev()),
                                                               &perfCreateInfo, &passCount);
 
+  RDCLOG("Fetching %zu KHR performance counters in %u passes", counters.size(), passCount);
+
   VkDevice dev = m_pDriver->GetDev();
   VkAcquireProfilingLockInfoKHR acquireLockInfo = {
       VK_STRUCTURE_TYPE_ACQUIRE_PROFILING_LOCK_INFO_KHR, NULL, 0, 50 * 1000 * 1000 /* 50ms */};
@@ -773,6 +782,8 @@ struct VulkanGPUTimerCallback : public VulkanDrawcallCallback
 
 rdcarray<CounterResult> VulkanReplay::FetchCounters(const rdcarray<GPUCounter> &counters)
 {
+  RDCPROFILE_ZONE("VulkanReplay::FetchCounters");
+
   uint32_t maxEID = m_pDriver->GetMaxEID();
 
   rdcarray<GPUCounter> vkCounters;
@@ -802,6 +813,10 @@ rdcarray<CounterResult> VulkanReplay::FetchCounters(const rdcarray<GPUCounter> &
     ret.append(FetchCountersKHR(vkKHRCounters));
   }
 
+  // all the generic counters come from one replay below, so don't do it if none were requested
+  if(vkCounters.empty())
+    return ret;
+
   VkPhysicalDeviceFeatures availableFeatures = m_pDriver->GetDeviceFeatures();
 
   VkDevice dev = m_pDriver->GetDev();
@@ -458,6 +458,60 @@ VulkanDebugManager::VulkanDebugManager(WrappedVulkan *driver)
   rm->SetInternalResource(GetResID(m_MS2ArrayPipe));
   rm->SetInternalResource(GetResID(m_Array2MSPipe));
 
+  //////////////////////////////////////////////////////////////////
+  // Initial contents tile compaction (via compute)
+
+  if(shaderCache->GetBuiltinModule(BuiltinShader::TileCompactCS) != VK_NULL_HANDLE)
+  {
+    // one set per compaction in flight, see VulkanDebugManager::CompactTiles
+    const uint32_t numSets = 128;
+
+    VkDescriptorPoolSize compactPoolTypes[] = {
+        {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, numSets * 2},
+    };
+
+    VkDescriptorPoolCreateInfo compactPoolInfo = {
+        VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+        NULL,
+        0,
+        numSets,
+        ARRAY_COUNT(compactPoolTypes),
+        &compactPoolTypes[0],
+    };
+
+    vkr = m_pDriver->vkCreateDescriptorPool(dev, &compactPoolInfo, NULL,
+                                            &m_TileCompactDescriptorPool);
+    RDCASSERTEQUAL(vkr, VK_SUCCESS);
+
+    rm->SetInternalResource(GetResID(m_TileCompactDescriptorPool));
+
+    CREATE_OBJECT(m_TileCompactDescSetLayout,
+                  {
+                      {0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_ALL, NULL},
+                      {1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_ALL, NULL},
+                  });
+
+    rm->SetInternalResource(GetResID(m_TileCompactDescSetLayout));
+
+    CREATE_OBJECT(m_TileCompactPipeLayout, m_TileCompactDescSetLayout, sizeof(Vec4u));
+
+    rm->SetInternalResource(GetResID(m_TileCompactPipeLayout));
+
+    CREATE_OBJECT(m_TileCompactPipe, m_TileCompactPipeLayout,
+                  shaderCache->GetBuiltinModule(BuiltinShader::TileCompactCS));
+
+    rm->SetInternalResource(GetResID(m_TileCompactPipe));
+
+    m_TileCompactDescSets.resize(numSets);
+    for(uint32_t i = 0; i < numSets; i++)
+    {
+      CREATE_OBJECT(m_TileCompactDescSets[i], m_TileCompactDescriptorPool,
+                    m_TileCompactDescSetLayout);
+
+      rm->SetInternalResource(GetResID(m_TileCompactDescSets[i]));
+    }
+  }
+
   //////////////////////////////////////////////////////////////////
   // Depth MS to Array copy (via graphics)
 
@@ -677,7 +731,8 @@ VulkanDebugManager::VulkanDebugManager(WrappedVulkan *driver)
         m_ArrayMSPipeLayout,
         shaderCache->GetBuiltinModule(BuiltinShader::BlitVS),
         shaderCache->GetBuiltinModule(BuiltinShader::DepthMS2ArrayFS),
-        {VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_STENCIL_REFERENCE},
+        {VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_STENCIL_REFERENCE,
+         VK_DYNAMIC_STATE_STENCIL_WRITE_MASK},
         VK_SAMPLE_COUNT_1_BIT,
         false,    // sampleRateShading
         true,     // depthEnable
@@ -750,6 +805,11 @@ VulkanDebugManager::~VulkanDebugManager()
   m_pDriver->vkDestroyDescriptorPool(dev, m_ArrayMSDescriptorPool, NULL);
   m_pDriver->vkDestroySampler(dev, m_ArrayMSSampler, NULL);
 
+  m_pDriver->vkDestroyDescriptorPool(dev, m_TileCompactDescriptorPool, NULL);
+  m_pDriver->vkDestroyDescriptorSetLayout(dev, m_TileCompactDescSetLayout, NULL);
+  m_pDriver->vkDestroyPipelineLayout(dev, m_TileCompactPipeLayout, NULL);
+  m_pDriver->vkDestroyPipeline(dev, m_TileCompactPipe, NULL);
+
   m_pDriver->vkDestroyImageView(dev, m_DummyStencilView[0], NULL);
   m_pDriver->vkDestroyImageView(dev, m_DummyStencilView[1], NULL);
   m_pDriver->vkDestroyImage(dev, m_DummyStencilImage[0], NULL);
@@ -1664,6 +1724,107 @@ void VulkanDebugManager::GetBufferData(ResourceId buff, uint64_t offset, uint64_
   vt->DeviceWaitIdle(Unwrap(dev));
 }
 
+VkDeviceSize VulkanDebugManager::GetCompactedTileDataOffset(VkDeviceSize size)
+{
+  VkDeviceSize numTiles = (size + CompactTileSize - 1) / CompactTileSize;
+
+  // header, then a pair of uint32s per tile. Keep the tile data 64-byte aligned
+  return AlignUp(16 + numTiles * 8, (VkDeviceSize)64);
+}
+
+VkDeviceSize VulkanDebugManager::GetCompactedSize(VkDeviceSize size)
+{
+  // in the worst case every tile is packed
+  return GetCompactedTileDataOffset(size) + AlignUp(size, CompactTileSize);
+}
+
+void VulkanDebugManager::ExpandCompactedTiles(const byte *compacted, VkDeviceSize size, byte *dst)
+{
+  const VkDeviceSize tileSize = CompactTileSize;
+  const uint32_t *tileInfo = ((const uint32_t *)compacted) + 4;
+  const byte *tileData = compacted + GetCompactedTileDataOffset(size);
+
+  for(VkDeviceSize offs = 0; offs < size; offs += tileSize, tileInfo += 2)
+  {
+    const size_t len = (size_t)RDCMIN(tileSize, size - offs);
+    const uint32_t slot = tileInfo[0];
+
+    if(slot != ~0U)
+    {
+      memcpy(dst + offs, tileData + slot * tileSize, len);
+      continue;
+    }
+
+    // constant tile, splat the value. The end of the contents may not be dword aligned
+    const uint32_t value = tileInfo[1];
+    for(size_t i = 0; i < len; i += sizeof(uint32_t))
+      memcpy(dst + offs + i, &value, RDCMIN(sizeof(uint32_t), len - i));
+  }
+}
+
+bool VulkanDebugManager::CompactTiles(VkCommandBuffer cmd, VkBuffer src, VkBuffer dst,
+                                      VkDeviceSize size)
+{
+  if(m_TileCompactPipe == VK_NULL_HANDLE || m_TileCompactSetsUsed >= m_TileCompactDescSets.size())
+    return false;
+
+  const uint32_t numTiles = uint32_t((size + CompactTileSize - 1) / CompactTileSize);
+
+  // the minimum guaranteed workgroup count is 65535 in each dimension, so wrap onto rows
+  const uint32_t tilesPerRow = RDCMIN(numTiles, 32768U);
+  const uint32_t numRows = (numTiles + tilesPerRow - 1) / tilesPerRow;
+
+  if(numRows > 65535)
+    return false;
+
+  VkDescriptorSet descSet = m_TileCompactDescSets[m_TileCompactSetsUsed++];
+
+  VkDevice dev = m_Device;
+
+  VkDescriptorBufferInfo srcdesc = {Unwrap(src), 0, VK_WHOLE_SIZE};
+  VkDescriptorBufferInfo dstdesc = {Unwrap(dst), 0, VK_WHOLE_SIZE};
+
+  VkWriteDescriptorSet writeSet[] = {
+      {VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET, NULL, Unwrap(descSet), 0, 0, 1,
+       VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, NULL, &srcdesc, NULL},
+      {VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET, NULL, Unwrap(descSet), 1, 0, 1,
+       VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, NULL, &dstdesc, NULL},
+  };
+
+  ObjDisp(dev)->UpdateDescriptorSets(Unwrap(dev), ARRAY_COUNT(writeSet), writeSet, 0, NULL);
+
+  // reset the packed tile counter
+  ObjDisp(cmd)->CmdFillBuffer(Unwrap(cmd), Unwrap(dst), 0, 16, 0);
+
+  VkMemoryBarrier barrier = {
+      VK_STRUCTURE_TYPE_MEMORY_BARRIER, NULL, VK_ACCESS_TRANSFER_WRITE_BIT,
+      VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+  };
+
+  DoPipelineBarrier(cmd, 1, &barrier);
+
+  ObjDisp(cmd)->CmdBindPipeline(Unwrap(cmd), VK_PIPELINE_BIND_POINT_COMPUTE,
+                                Unwrap(m_TileCompactPipe));
+  ObjDisp(cmd)->CmdBindDescriptorSets(Unwrap(cmd), VK_PIPELINE_BIND_POINT_COMPUTE,
+                                      Unwrap(m_TileCompactPipeLayout), 0, 1, UnwrapPtr(descSet),
+                                      0, NULL);
+
+  Vec4u params = {numTiles, tilesPerRow,
+                  uint32_t(GetCompactedTileDataOffset(size) / sizeof(uint32_t)), 0};
+
+  ObjDisp(cmd)->CmdPushConstants(Unwrap(cmd), Unwrap(m_TileCompactPipeLayout), VK_SHADER_STAGE_ALL,
+                                 0, sizeof(Vec4u), &params);
+
+  ObjDisp(cmd)->CmdDispatch(Unwrap(cmd), tilesPerRow, numRows, 1);
+
+  barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+  barrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+
+  DoPipelineBarrier(cmd, 1, &barrier);
+
+  return true;
+}
+
 void VulkanDebugManager::CustomShaderRendering::Destroy(WrappedVulkan *driver)
 {
   driver->vkDestroyRenderPass(driver->GetDev(), TexRP, NULL);
@@ -1744,12 +1905,14 @@ void VulkanReplay::DestroyResources()
 {
   ClearPostVSCache();
   ClearFeedbackCache();
+  ClearOverlayCache();
 
   m_General.Destroy(m_pDriver);
   m_TexRender.Destroy(m_pDriver);
   m_Overlay.Destroy(m_pDriver);
   m_VertexPick.Destroy(m_pDriver);
   m_PixelPick.Destroy(m_pDriver);
+  m_TexReadback.Destroy(m_pDriver);
   m_Histogram.Destroy(m_pDriver);
   m_PostVS.Destroy(m_pDriver);
 
@@ -1768,6 +1931,7 @@ void VulkanReplay::GeneralMisc::Init(WrappedVulkan *driver, VkDescriptorPool des
       {VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER, 64},
       {VK_DESCRIPTOR_TYPE_SAMPLER, 32},
       {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 32},
+      {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC, 8},
   };
 
   VkDescriptorPoolCreateInfo descPoolInfo = {
@@ -2187,6 +2351,7 @@ void VulkanReplay::OverlayRendering::Init(WrappedVulkan *driver, VkDescriptorPoo
   CREATE_OBJECT(m_QuadDescSetLayout,
                 {
                     {0, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1, VK_SHADER_STAGE_ALL, NULL},
+                    {1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC, 1, VK_SHADER_STAGE_ALL, NULL},
                 });
 
   CREATE_OBJECT(m_TriSizeDescSetLayout,
@@ -2566,6 +2731,19 @@ void VulkanReplay::PixelPicking::Init(WrappedVulkan *driver, VkDescriptorPool de
                         GPUBuffer::eGPUBufferReadback);
 }
 
+void VulkanReplay::TextureReadback::Destroy(WrappedVulkan *driver)
+{
+  VkDevice dev = driver->GetDev();
+  const VkDevDispatchTable *vt = ObjDisp(dev);
+
+  for(Slot &s : Slots)
+  {
+    vt->DestroyBuffer(Unwrap(dev), s.buf, NULL);
+    vt->FreeMemory(Unwrap(dev), s.mem, NULL);
+    s = Slot();
+  }
+}
+
 void VulkanReplay::PixelPicking::Destroy(WrappedVulkan *driver)
 {
   if(Image == VK_NULL_HANDLE)
@@ -2616,6 +2794,18 @@ void VulkanReplay::HistogramMinMax::Init(WrappedVulkan *driver, VkDescriptorPool
   compileSettings.lang = rdcspv::InputLanguage::VulkanGLSL;
   compileSettings.stage = rdcspv::ShaderStage::Compute;
 
+  // reducing each min/max block with subgroup operations needs SPIR-V 1.3, and subgroup arithmetic
+  // to be supported in compute shaders
+  const VkPhysicalDeviceSubgroupProperties &subgroupProps =
+      driver->GetPhysicalDeviceSubgroupProperties();
+  const VkSubgroupFeatureFlags subgroupOps =
+      VK_SUBGROUP_FEATURE_BASIC_BIT | VK_SUBGROUP_FEATURE_ARITHMETIC_BIT;
+  const bool subgroupReduce = (subgroupProps.supportedStages & VK_SHADER_STAGE_COMPUTE_BIT) &&
+                              (subgroupProps.supportedOperations & subgroupOps) == subgroupOps;
+
+  rdcspv::CompilationSettings subgroupSettings = compileSettings;
+  subgroupSettings.vulkan11 = true;
+
   // type max is one higher than the last RESTYPE, and RESTYPES are 1-indexed
   RDCCOMPILE_ASSERT(RESTYPE_TEXTYPEMAX == ARRAY_COUNT(m_MinMaxTilePipe),
                     "RESTYPE values don't match formats for dummy images");
@@ -2626,7 +2816,9 @@ void VulkanReplay::HistogramMinMax::Init(WrappedVulkan *driver, VkDescriptorPool
     {
       SPIRVBlob minmaxtile = NULL;
       SPIRVBlob minmaxresult = NULL;
+      SPIRVBlob minmaxhistogram = NULL;
       SPIRVBlob histogram = NULL;
+      SPIRVBlob texremap = NULL;
       rdcstr err;
 
       rdcstr defines = shaderCache->GetGlobalDefines();
@@ -2657,8 +2849,32 @@ void VulkanReplay::HistogramMinMax::Init(WrappedVulkan *driver, VkDescriptorPool
         minmaxtile = NULL;
       }
 
+      glsl = GenerateGLSLShader(GetEmbeddedResource(glsl_minmaxtile_comp), ShaderType::Vulkan, 430,
+                                defines + "#define MINMAX_HISTOGRAM 1\n");
+
+      err = shaderCache->GetSPIRVBlob(compileSettings, glsl, minmaxhistogram);
+      if(!err.empty())
+      {
+        RDCERR("Error compiling min/max histogram shader: %s. Defines are:\n%s", err.c_str(),
+               defines.c_str());
+        minmaxhistogram = NULL;
+      }
+
+      glsl = GenerateGLSLShader(GetEmbeddedResource(glsl_texremap_comp), ShaderType::Vulkan, 430,
+                                defines);
+
+      err = shaderCache->GetSPIRVBlob(compileSettings, glsl, texremap);
+      if(!err.empty())
+      {
+        RDCERR("Error compiling texture remap shader: %s. Defines are:\n%s", err.c_str(),
+               defines.c_str());
+        texremap = NULL;
+      }
+
       CREATE_OBJECT(m_MinMaxTilePipe[t][f], m_HistogramPipeLayout, minmaxtile);
+      CREATE_OBJECT(m_MinMaxHistogramPipe[t][f], m_HistogramPipeLayout, minmaxhistogram);
       CREATE_OBJECT(m_HistogramPipe[t][f], m_HistogramPipeLayout, histogram);
+      CREATE_OBJECT(m_TexRemapPipe[t][f], m_HistogramPipeLayout, texremap);
 
       if(t == 1)
       {
@@ -2675,6 +2891,54 @@ void VulkanReplay::HistogramMinMax::Init(WrappedVulkan *driver, VkDescriptorPool
 
         CREATE_OBJECT(m_MinMaxResultPipe[f], m_HistogramPipeLayout, minmaxresult);
       }
+
+      if(subgroupReduce)
+      {
+        rdcstr subgroupDefines = defines + "#define SUBGROUP_REDUCE 1\n";
+
+        minmaxtile = minmaxhistogram = minmaxresult = NULL;
+
+        glsl = GenerateGLSLShader(GetEmbeddedResource(glsl_minmaxtile_comp), ShaderType::Vulkan,
+                                  430, subgroupDefines);
+
+        err = shaderCache->GetSPIRVBlob(subgroupSettings, glsl, minmaxtile);
+        if(!err.empty())
+        {
+          RDCERR("Error compiling subgroup min/max tile shader: %s. Defines are:\n%s", err.c_str(),
+                 subgroupDefines.c_str());
+          minmaxtile = NULL;
+        }
+
+        glsl = GenerateGLSLShader(GetEmbeddedResource(glsl_minmaxtile_comp), ShaderType::Vulkan,
+                                  430, subgroupDefines + "#define MINMAX_HISTOGRAM 1\n");
+
+        err = shaderCache->GetSPIRVBlob(subgroupSettings, glsl, minmaxhistogram);
+        if(!err.empty())
+        {
+          RDCERR("Error compiling subgroup min/max histogram shader: %s. Defines are:\n%s",
+                 err.c_str(), subgroupDefines.c_str());
+          minmaxhistogram = NULL;
+        }
+
+        CREATE_OBJECT(m_SubgroupMinMaxTilePipe[t][f], m_HistogramPipeLayout, minmaxtile);
+        CREATE_OBJECT(m_SubgroupMinMaxHistogramPipe[t][f], m_HistogramPipeLayout, minmaxhistogram);
+
+        if(t == 1)
+        {
+          glsl = GenerateGLSLShader(GetEmbeddedResource(glsl_minmaxresult_comp),
+                                    ShaderType::Vulkan, 430, subgroupDefines);
+
+          err = shaderCache->GetSPIRVBlob(subgroupSettings, glsl, minmaxresult);
+          if(!err.empty())
+          {
+            RDCERR("Error compiling subgroup min/max result shader: %s. Defines are:\n%s",
+                   err.c_str(), subgroupDefines.c_str());
+            minmaxresult = NULL;
+          }
+
+          CREATE_OBJECT(m_SubgroupMinMaxResultPipe[f], m_HistogramPipeLayout, minmaxresult);
+        }
+      }
     }
   }
 
@@ -2713,9 +2977,16 @@ void VulkanReplay::HistogramMinMax::Destroy(WrappedVulkan *driver)
     for(size_t f = 0; f < ARRAY_COUNT(m_MinMaxTilePipe[0]); f++)
     {
       driver->vkDestroyPipeline(driver->GetDev(), m_MinMaxTilePipe[t][f], NULL);
+      driver->vkDestroyPipeline(driver->GetDev(), m_MinMaxHistogramPipe[t][f], NULL);
+      driver->vkDestroyPipeline(driver->GetDev(), m_SubgroupMinMaxTilePipe[t][f], NULL);
+      driver->vkDestroyPipeline(driver->GetDev(), m_SubgroupMinMaxHistogramPipe[t][f], NULL);
       driver->vkDestroyPipeline(driver->GetDev(), m_HistogramPipe[t][f], NULL);
+      driver->vkDestroyPipeline(driver->GetDev(), m_TexRemapPipe[t][f], NULL);
       if(t == 1)
+      {
         driver->vkDestroyPipeline(driver->GetDev(), m_MinMaxResultPipe[f], NULL);
+        driver->vkDestroyPipeline(driver->GetDev(), m_SubgroupMinMaxResultPipe[f], NULL);
+      }
     }
   }
 
@@ -65,6 +65,25 @@ public:
   void CopyArrayToTex2DMS(VkImage destMS, VkImage srcArray, VkExtent3D extent, uint32_t layers,
                           uint32_t samples, VkFormat fmt);
 
+  // initial contents are split into tiles of this size for compaction
+  static const VkDeviceSize CompactTileSize = 4096;
+
+  // the compacted output begins with a 16-byte header containing the number of packed tiles, then
+  // a (slot, value) pair of uint32s for each tile. A tile where every dword is 'value' has slot ~0U
+  // and isn't packed, otherwise its contents are at GetCompactedTileDataOffset() + slot * tile size
+  static VkDeviceSize GetCompactedTileDataOffset(VkDeviceSize size);
+  static VkDeviceSize GetCompactedSize(VkDeviceSize size);
+  static void ExpandCompactedTiles(const byte *compacted, VkDeviceSize size, byte *dst);
+
+  bool IsTileCompactionSupported() { return m_TileCompactPipe != VK_NULL_HANDLE; }
+  // records the compaction of src into dst. src must be sized to a whole number of tiles, and dst
+  // must be at least GetCompactedSize(size) with transfer dst usage. Both need storage buffer usage
+  // and must fit in maxStorageBufferRange. Each compaction until the next ResetTileCompaction()
+  // needs its own descriptor set, if none are free this returns false without recording anything.
+  bool CompactTiles(VkCommandBuffer cmd, VkBuffer src, VkBuffer dst, VkDeviceSize size);
+  // must only be called once any previously recorded compactions have completed
+  void ResetTileCompaction() { m_TileCompactSetsUsed = 0; }
+
   VkPipeline GetCustomPipeline() { return m_Custom.TexPipeline; }
   VkImage GetCustomTexture() { return m_Custom.TexImg; }
   VkFramebuffer GetCustomFramebuffer() { return m_Custom.TexFB; }
@@ -116,6 +135,14 @@ private:
 
   VkSampler m_ArrayMSSampler = VK_NULL_HANDLE;
 
+  // CompactTiles
+  VkDescriptorPool m_TileCompactDescriptorPool = VK_NULL_HANDLE;
+  VkDescriptorSetLayout m_TileCompactDescSetLayout = VK_NULL_HANDLE;
+  VkPipelineLayout m_TileCompactPipeLayout = VK_NULL_HANDLE;
+  VkPipeline m_TileCompactPipe = VK_NULL_HANDLE;
+  rdcarray<VkDescriptorSet> m_TileCompactDescSets;
+  uint32_t m_TileCompactSetsUsed = 0;
+
   // [0] = non-MSAA, [1] = MSAA
   VkDeviceMemory m_DummyStencilMemory = VK_NULL_HANDLE;
   VkImage m_DummyStencilImage[2] = {VK_NULL_HANDLE};
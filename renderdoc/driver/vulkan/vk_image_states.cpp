@@ -402,6 +402,7 @@ inline FrameRefType ImageSubresourceMap::Merge(const ImageSubresourceMap &other,
 {
   FrameRefType maxRefType = eFrameRef_None;
   bool didSplit = false;
+  bool changed = false;
   for(auto oIt = other.begin(); oIt != other.end(); ++oIt)
   {
     for(auto it = RangeBegin(oIt->range()); it != end(); ++it)
@@ -417,9 +418,16 @@ inline FrameRefType ImageSubresourceMap::Merge(const ImageSubresourceMap &other,
         RDCASSERT(it->range().ContainedIn(oIt->range()));
         it->SetState(subState);
         maxRefType = ComposeFrameRefsDisjoint(maxRefType, subState.refType);
+        changed = true;
       }
     }
   }
+
+  // the merge already visited every subresource, so collapsing any dimensions that became uniform
+  // doesn't change its cost but keeps later barriers and merges on this image cheap.
+  if(changed && other.size() == 1)
+    Unsplit();
+
   return maxRefType;
 }
 
@@ -743,6 +751,40 @@ template void BarrierSequence<VkImageMemoryBarrier>::AddWrapped(uint32_t batchIn
                                                                 uint32_t queueFamilyIndex,
                                                                 const VkImageMemoryBarrier &barrier);
 
+template <>
+void BarrierSequence<VkImageMemoryBarrier>::AddWrappedCoalesced(uint32_t batchIndex,
+                                                                uint32_t queueFamilyIndex,
+                                                                const VkImageMemoryBarrier &barrier)
+{
+  RDCASSERT(batchIndex < MAX_BATCH_COUNT);
+  RDCASSERT(queueFamilyIndex < MAX_QUEUE_FAMILY_COUNT);
+  rdcarray<VkImageMemoryBarrier> &batch = batches[batchIndex][queueFamilyIndex];
+
+  // subresources are visited with the array layer varying fastest, so a barrier that continues the
+  // previous one's layer range with otherwise identical parameters can extend it instead.
+  if(!batch.empty())
+  {
+    VkImageMemoryBarrier &prev = batch.back();
+    const VkImageSubresourceRange &prevRange = prev.subresourceRange;
+    const VkImageSubresourceRange &range = barrier.subresourceRange;
+    if(prev.image == barrier.image && prev.srcAccessMask == barrier.srcAccessMask &&
+       prev.dstAccessMask == barrier.dstAccessMask && prev.oldLayout == barrier.oldLayout &&
+       prev.newLayout == barrier.newLayout &&
+       prev.srcQueueFamilyIndex == barrier.srcQueueFamilyIndex &&
+       prev.dstQueueFamilyIndex == barrier.dstQueueFamilyIndex && prev.pNext == barrier.pNext &&
+       prevRange.aspectMask == range.aspectMask && prevRange.baseMipLevel == range.baseMipLevel &&
+       prevRange.levelCount == range.levelCount &&
+       prevRange.baseArrayLayer + prevRange.layerCount == range.baseArrayLayer)
+    {
+      prev.subresourceRange.layerCount += range.layerCount;
+      return;
+    }
+  }
+
+  batch.push_back(barrier);
+  ++barrierCount;
+}
+
 template <typename Barrier>
 void BarrierSequence<Barrier>::Merge(const BarrierSequence<Barrier> &other)
 {
@@ -906,6 +948,7 @@ void ImageState::Update(ImageSubresourceRange range, const ImageSubresourceState
   range.Sanitise(GetImageInfo());
 
   bool didSplit = false;
+  bool changed = false;
   for(auto it = subresourceStates.RangeBegin(range); it != subresourceStates.end(); ++it)
   {
     ImageSubresourceState subState;
@@ -919,8 +962,15 @@ void ImageState::Update(ImageSubresourceRange range, const ImageSubresourceState
       RDCASSERT(it->range().ContainedIn(range));
       it->SetState(subState);
       maxRefType = ComposeFrameRefsDisjoint(maxRefType, subState.refType);
+      changed = true;
     }
   }
+
+  // an update of the whole image visits every subresource anyway, and commonly makes a previously
+  // split image uniform again (e.g. per-layer rendering followed by a transition of all layers).
+  // Collapse it so the image doesn't stay split for the rest of its lifetime.
+  if(changed && subresourceStates.size() > 1 && range == GetImageInfo().FullRange())
+    subresourceStates.Unsplit();
 }
 
 void ImageState::Merge(const ImageState &other, ImageTransitionInfo info)
@@ -1236,12 +1286,12 @@ void ImageState::ResetToOldState(ImageBarrierSequence &barriers, ImageTransition
         /* image = */ wrappedHandle,
         /* subresourceRange = */ subRange,
     };
-    barriers.AddWrapped(MAIN_BATCH_INDEX, submitQueueFamilyIndex, barrier);
+    barriers.AddWrappedCoalesced(MAIN_BATCH_INDEX, submitQueueFamilyIndex, barrier);
 
     // acquire the subresource in the dstQueueFamily, if necessary
     if(barrier.srcQueueFamilyIndex != barrier.dstQueueFamilyIndex)
     {
-      barriers.AddWrapped(ACQUIRE_BATCH_INDEX, barrier.dstQueueFamilyIndex, barrier);
+      barriers.AddWrappedCoalesced(ACQUIRE_BATCH_INDEX, barrier.dstQueueFamilyIndex, barrier);
     }
   }
   RestoreTransfers(RESTORE_TRANSFERS_BATCH_INDEX, oldQueueFamilyTransfers, srcAccessMask, barriers,
@@ -1386,12 +1436,12 @@ void ImageState::Transition(const ImageState &dstState, VkAccessFlags srcAccessM
               /* layerCount = */ endArrayLayer - baseArrayLayer,
           },
       };
-      barriers.AddWrapped(MAIN_BATCH_INDEX, submitQueueFamilyIndex, barrier);
+      barriers.AddWrappedCoalesced(MAIN_BATCH_INDEX, submitQueueFamilyIndex, barrier);
 
       // acquire the subresource in the dstQueueFamily, if necessary
       if(barrier.srcQueueFamilyIndex != barrier.dstQueueFamilyIndex)
       {
-        barriers.AddWrapped(ACQUIRE_BATCH_INDEX, barrier.dstQueueFamilyIndex, barrier);
+        barriers.AddWrappedCoalesced(ACQUIRE_BATCH_INDEX, barrier.dstQueueFamilyIndex, barrier);
       }
     }
   }
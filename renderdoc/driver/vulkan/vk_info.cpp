@@ -23,6 +23,7 @@
  ******************************************************************************/
 
 #include "vk_info.h"
+#include "vk_shader_cache.h"
 
 VkDynamicState ConvertDynamicState(VulkanDynamicStateIndex idx)
 {
@@ -254,10 +255,11 @@ void VulkanCreationInfo::Pipeline::Init(VulkanResourceManager *resourceMan,
       }
     }
 
-    ShaderModuleReflection &reflData = info.m_ShaderModule[shadid].m_Reflections[key];
+    ShaderModule &module = info.m_ShaderModule[shadid];
+    ShaderModuleReflection &reflData = module.m_Reflections[key];
 
-    reflData.Init(resourceMan, shadid, info.m_ShaderModule[shadid].spirv, shad.entryPoint,
-                  pCreateInfo->pStages[i].stage, shad.specialization);
+    reflData.Init(resourceMan, shadid, module, shad.entryPoint, pCreateInfo->pStages[i].stage,
+                  shad.specialization, info.m_ShaderJobs);
 
     shad.refl = &reflData.refl;
     shad.mapping = &reflData.mapping;
@@ -583,10 +585,11 @@ void VulkanCreationInfo::Pipeline::Init(VulkanResourceManager *resourceMan, Vulk
       }
     }
 
-    ShaderModuleReflection &reflData = info.m_ShaderModule[shadid].m_Reflections[key];
+    ShaderModule &module = info.m_ShaderModule[shadid];
+    ShaderModuleReflection &reflData = module.m_Reflections[key];
 
-    reflData.Init(resourceMan, shadid, info.m_ShaderModule[shadid].spirv, shad.entryPoint,
-                  pCreateInfo->stage.stage, shad.specialization);
+    reflData.Init(resourceMan, shadid, module, shad.entryPoint, pCreateInfo->stage.stage,
+                  shad.specialization, info.m_ShaderJobs);
 
     shad.refl = &reflData.refl;
     shad.mapping = &reflData.mapping;
@@ -1066,7 +1069,8 @@ void VulkanCreationInfo::ImageView::Init(VulkanResourceManager *resourceMan, Vul
 
 void VulkanCreationInfo::ShaderModule::Init(VulkanResourceManager *resourceMan,
                                             VulkanCreationInfo &info,
-                                            const VkShaderModuleCreateInfo *pCreateInfo)
+                                            const VkShaderModuleCreateInfo *pCreateInfo,
+                                            Threading::JobQueue *jobs)
 {
   const uint32_t SPIRVMagic = 0x07230203;
   if(pCreateInfo->codeSize < 4 || memcmp(pCreateInfo->pCode, &SPIRVMagic, sizeof(SPIRVMagic)) != 0)
@@ -1076,33 +1080,102 @@ void VulkanCreationInfo::ShaderModule::Init(VulkanResourceManager *resourceMan,
   else
   {
     RDCASSERT(pCreateInfo->codeSize % sizeof(uint32_t) == 0);
-    spirv.Parse(rdcarray<uint32_t>((uint32_t *)(pCreateInfo->pCode),
-                                   pCreateInfo->codeSize / sizeof(uint32_t)));
+    rdcarray<uint32_t> words((uint32_t *)(pCreateInfo->pCode),
+                             pCreateInfo->codeSize / sizeof(uint32_t));
+
+    ParsedSPIRV *&shared = info.m_ParsedSPIRV[words];
+
+    // identical code was already seen, share its parse
+    if(shared)
+    {
+      parsed = shared;
+      return;
+    }
+
+    parsed = shared = new ParsedSPIRV;
+
+    if(jobs)
+    {
+      ParsedSPIRV *p = parsed;
+      p->parsePending = 1;
+      jobs->Push([p, words]() {
+        p->spirv.Parse(words);
+        Atomic::CmpExch32(&p->parsePending, 1, 0);
+      });
+    }
+    else
+    {
+      parsed->spirv.Parse(words);
+    }
   }
 }
 
+Threading::JobQueue *VulkanCreationInfo::GetShaderJobs()
+{
+  // leave a core for the thread reading the capture
+  if(!m_ShaderJobs)
+    m_ShaderJobs = new Threading::JobQueue(RDCMAX(1U, Threading::NumberOfCores() - 1));
+
+  return m_ShaderJobs;
+}
+
+void VulkanCreationInfo::FinishShaderJobs()
+{
+  SAFE_DELETE(m_ShaderJobs);
+}
+
 void VulkanCreationInfo::ShaderModuleReflection::Init(VulkanResourceManager *resourceMan,
-                                                      ResourceId id, const rdcspv::Reflector &spv,
+                                                      ResourceId id, ShaderModule &module,
                                                       const rdcstr &entry,
                                                       VkShaderStageFlagBits stage,
-                                                      const rdcarray<SpecConstant> &specInfo)
+                                                      const rdcarray<SpecConstant> &specInfo,
+                                                      Threading::JobQueue *jobs)
 {
   if(entryPoint.empty())
   {
     entryPoint = entry;
     stageIndex = StageIndex(stage);
 
-    spv.MakeReflection(GraphicsAPI::Vulkan, ShaderStage(stageIndex), entryPoint, specInfo, refl,
-                       mapping, patchData);
+    ResourceId origId = resourceMan->GetOriginalID(id);
 
-    refl.resourceId = resourceMan->GetOriginalID(id);
+    if(jobs)
+    {
+      // the module's parse job was pushed before this one, so it's already running or done
+      jobs->Push([this, &module, origId, specInfo]() {
+        module.WaitForParse();
+        module.GetSPIRV().MakeReflection(GraphicsAPI::Vulkan, ShaderStage(stageIndex), entryPoint,
+                                    specInfo, refl, mapping, patchData);
+        refl.resourceId = origId;
+      });
+    }
+    else
+    {
+      module.WaitForParse();
+      module.GetSPIRV().MakeReflection(GraphicsAPI::Vulkan, ShaderStage(stageIndex), entryPoint,
+                                  specInfo, refl, mapping, patchData);
+      refl.resourceId = origId;
+    }
   }
 }
 
-void VulkanCreationInfo::ShaderModuleReflection::PopulateDisassembly(const rdcspv::Reflector &spirv)
+void VulkanCreationInfo::ShaderModuleReflection::PopulateDisassembly(
+    const rdcspv::Reflector &spirv, VulkanShaderCache *cache)
 {
-  if(disassembly.empty())
-    disassembly = spirv.Disassemble(refl.entryPoint.c_str(), instructionLines);
+  if(!disassembly.empty())
+    return;
+
+  rdcarray<uint32_t> words;
+  if(cache)
+  {
+    words = spirv.GetSPIRV();
+    if(cache->GetCachedDisassembly(words, refl.entryPoint, disassembly, instructionLines))
+      return;
+  }
+
+  disassembly = spirv.Disassemble(refl.entryPoint.c_str(), instructionLines);
+
+  if(cache)
+    cache->SetCachedDisassembly(words, refl.entryPoint, disassembly, instructionLines);
 }
 
 void VulkanCreationInfo::DescSetPool::Init(VulkanResourceManager *resourceMan,
@@ -29,6 +29,7 @@
 #include "vk_manager.h"
 
 struct VulkanCreationInfo;
+class VulkanShaderCache;
 
 // linearised version of VkDynamicState
 enum VulkanDynamicStateIndex
@@ -151,6 +152,14 @@ struct DescUpdateTemplate
 
 struct VulkanCreationInfo
 {
+  ~VulkanCreationInfo()
+  {
+    FinishShaderJobs();
+
+    for(auto it = m_ParsedSPIRV.begin(); it != m_ParsedSPIRV.end(); ++it)
+      delete it->second;
+  }
+
   struct ShaderModuleReflectionKey
   {
     ShaderModuleReflectionKey(const rdcstr &e, ResourceId p) : entryPoint(e), specialisingPipe(p) {}
@@ -168,6 +177,8 @@ struct VulkanCreationInfo
     ResourceId specialisingPipe;
   };
 
+  struct ShaderModule;
+
   struct ShaderModuleReflection
   {
     uint32_t stageIndex;
@@ -178,11 +189,11 @@ struct VulkanCreationInfo
     SPIRVPatchData patchData;
     std::map<size_t, uint32_t> instructionLines;
 
-    void Init(VulkanResourceManager *resourceMan, ResourceId id, const rdcspv::Reflector &spv,
+    void Init(VulkanResourceManager *resourceMan, ResourceId id, ShaderModule &module,
               const rdcstr &entry, VkShaderStageFlagBits stage,
-              const rdcarray<SpecConstant> &specInfo);
+              const rdcarray<SpecConstant> &specInfo, Threading::JobQueue *jobs);
 
-    void PopulateDisassembly(const rdcspv::Reflector &spirv);
+    void PopulateDisassembly(const rdcspv::Reflector &spirv, VulkanShaderCache *cache);
   };
 
   struct Pipeline
@@ -519,10 +530,32 @@ struct VulkanCreationInfo
   };
   std::map<ResourceId, ImageView> m_ImageView;
 
+  // captures often create many shader modules with identical code, so SPIR-V is only parsed once
+  // per unique blob and the modules share it. Entries live as long as the creation info.
+  struct ParsedSPIRV
+  {
+    rdcspv::Reflector spirv;
+    volatile int32_t parsePending = 0;
+  };
+  std::map<rdcarray<uint32_t>, ParsedSPIRV *> m_ParsedSPIRV;
+
   struct ShaderModule
   {
     void Init(VulkanResourceManager *resourceMan, VulkanCreationInfo &info,
-              const VkShaderModuleCreateInfo *pCreateInfo);
+              const VkShaderModuleCreateInfo *pCreateInfo, Threading::JobQueue *jobs);
+
+    // blocks until a background parse of the SPIR-V has finished, if there is one
+    void WaitForParse()
+    {
+      while(parsed && Atomic::CmpExch32(&parsed->parsePending, 0, 0) != 0)
+        Threading::Sleep(0);
+    }
+
+    const rdcspv::Reflector &GetSPIRV() const
+    {
+      static const rdcspv::Reflector empty;
+      return parsed ? parsed->spirv : empty;
+    }
 
     ShaderModuleReflection &GetReflection(const rdcstr &entry, ResourceId pipe)
     {
@@ -535,7 +568,7 @@ struct VulkanCreationInfo
       return m_Reflections[{entry, ResourceId()}];
     }
 
-    rdcspv::Reflector spirv;
+    ParsedSPIRV *parsed = NULL;
 
     rdcstr unstrippedPath;
 
@@ -543,6 +576,13 @@ struct VulkanCreationInfo
   };
   std::map<ResourceId, ShaderModule> m_ShaderModule;
 
+  // while loading a capture, shader modules are parsed and reflected on background threads as
+  // soon as their chunks are read. Nothing reads the reflection until the frame is replayed, so
+  // the jobs are only waited on then.
+  Threading::JobQueue *m_ShaderJobs = NULL;
+  Threading::JobQueue *GetShaderJobs();
+  void FinishShaderJobs();
+
   struct DescSetPool
   {
     void Init(VulkanResourceManager *resourceMan, VulkanCreationInfo &info,
@@ -578,6 +618,8 @@ struct VulkanCreationInfo
     m_Sampler.erase(id);
     m_YCbCrSampler.erase(id);
     m_ImageView.erase(id);
+    if(m_ShaderJobs && m_ShaderModule.find(id) != m_ShaderModule.end())
+      m_ShaderJobs->Wait();
     m_ShaderModule.erase(id);
     m_DescSetPool.erase(id);
     m_Names.erase(id);
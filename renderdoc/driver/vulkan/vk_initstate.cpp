@@ -28,15 +28,76 @@
 // VKTODOLOW there's a lot of duplicated code in this file for creating a buffer to do
 // a memory copy and saving to disk.
 
-// VKTODOLOW in general we do a lot of "create buffer, use it, flush/sync then destroy".
-// I don't know what the exact cost is, but it would be nice to batch up the buffers/etc
-// used across init state use, and only do a single flush. Also we could then get some
-// nice command buffer reuse (although need to be careful we don't create too large a
-// command buffer that stalls the GPU).
+// When preparing at capture start we batch up the "create buffer, copy, destroy" work: each copy
+// is submitted as soon as it's recorded, but we only sync and destroy the temporary buffers once
+// enough data is in flight (see InitStateBatch). Outside of that, e.g. for postponed resources
+// prepared mid-capture, each copy still syncs immediately.
 // See INITSTATEBATCH
 
+void WrappedVulkan::BeginInitStateBatch()
+{
+  RDCASSERT(!m_InitStateBatch.active);
+  m_InitStateBatch.active = true;
+  m_InitStateBatch.pendingBytes = 0;
+  m_InitStateBatch.pendingCopies = 0;
+}
+
+void WrappedVulkan::SubmitInitStateCopy(VkDeviceSize bytes)
+{
+  // kick off the copy now so the GPU can get going while we record the next one
+  SubmitCmds();
+
+  m_InitStateBatch.pendingBytes += bytes;
+  m_InitStateBatch.pendingCopies++;
+
+  // limit how much readback work is in flight, so that we don't hold on to an unbounded number of
+  // temporary resources and command buffers before recycling them
+  if(!m_InitStateBatch.active || m_InitStateBatch.pendingBytes >= InitStateBatchBytes ||
+     m_InitStateBatch.pendingCopies >= InitStateBatchCopies)
+    FlushInitStateBatch();
+}
+
+void WrappedVulkan::FlushInitStateBatch()
+{
+  VkDevice d = GetDev();
+
+  SubmitCmds();
+  FlushQ();
+
+  GetDebugManager()->ResetTileCompaction();
+
+  // transitions back on other queues can only happen once the copies reading from them are done
+  SubmitAndFlushImageStateBarriers(m_cleanupImageBarriers);
+
+  for(VkBuffer buf : m_InitStateBatch.buffers)
+  {
+    ObjDisp(d)->DestroyBuffer(Unwrap(d), Unwrap(buf), NULL);
+    GetResourceManager()->ReleaseWrappedResource(buf);
+  }
+
+  for(VkImage im : m_InitStateBatch.images)
+  {
+    ObjDisp(d)->DestroyImage(Unwrap(d), Unwrap(im), NULL);
+    GetResourceManager()->ReleaseWrappedResource(im);
+  }
+
+  m_InitStateBatch.buffers.clear();
+  m_InitStateBatch.images.clear();
+  m_InitStateBatch.pendingBytes = 0;
+  m_InitStateBatch.pendingCopies = 0;
+}
+
+void WrappedVulkan::EndInitStateBatch()
+{
+  SubmitAndFlushImageStateBarriers(m_setupImageBarriers);
+  FlushInitStateBatch();
+  m_InitStateBatch.active = false;
+}
+
 bool WrappedVulkan::Prepare_InitialState(WrappedVkRes *res)
 {
+  RDCPROFILE_ZONE("WrappedVulkan::Prepare_InitialState");
+
   ResourceId id = GetResourceManager()->GetID(res);
 
   VkResourceType type = IdentifyTypeByPtr(res);
@@ -246,10 +307,44 @@ bool WrappedVulkan::Prepare_InitialState(WrappedVkRes *res)
       }
     }
 
+    // large images can be compacted on the GPU first, so that only the tiles with non-trivial
+    // contents are written to readback memory.
+    const VkDeviceSize contentsSize = bufInfo.size;
+    const bool compact =
+        m_CompactInitialStates && contentsSize >= CompactInitStateMinSize &&
+        VulkanDebugManager::GetCompactedSize(contentsSize) <=
+            GetDeviceProps().limits.maxStorageBufferRange &&
+        GetDebugManager()->IsTileCompactionSupported();
+
     // since this happens during capture, we don't want to start serialising extra buffer creates,
     // so we manually create & then just wrap.
     VkBuffer dstBuf;
 
+    // the buffer that the image is copied into. Without compaction this is the readback buffer
+    VkBuffer copyBuf = VK_NULL_HANDLE;
+
+    if(compact)
+    {
+      VkBufferCreateInfo stagingInfo = bufInfo;
+      stagingInfo.size = AlignUp(contentsSize, VulkanDebugManager::CompactTileSize);
+      stagingInfo.usage |= VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+
+      vkr = ObjDisp(d)->CreateBuffer(Unwrap(d), &stagingInfo, NULL, &copyBuf);
+      RDCASSERTEQUAL(vkr, VK_SUCCESS);
+
+      GetResourceManager()->WrapResource(Unwrap(d), copyBuf);
+
+      MemoryAllocation stagingmem =
+          AllocateMemoryForResource(copyBuf, MemoryScope::InitialContents, MemoryType::GPULocal);
+
+      vkr = ObjDisp(d)->BindBufferMemory(Unwrap(d), Unwrap(copyBuf), Unwrap(stagingmem.mem),
+                                         stagingmem.offs);
+      RDCASSERTEQUAL(vkr, VK_SUCCESS);
+
+      bufInfo.size = VulkanDebugManager::GetCompactedSize(contentsSize);
+      bufInfo.usage |= VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+    }
+
     vkr = ObjDisp(d)->CreateBuffer(Unwrap(d), &bufInfo, NULL, &dstBuf);
     RDCASSERTEQUAL(vkr, VK_SUCCESS);
 
@@ -262,6 +357,9 @@ bool WrappedVulkan::Prepare_InitialState(WrappedVkRes *res)
                                        readbackmem.offs);
     RDCASSERTEQUAL(vkr, VK_SUCCESS);
 
+    if(!compact)
+      copyBuf = dstBuf;
+
     VkCommandBufferBeginInfo beginInfo = {VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO, NULL,
                                           VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT};
 
@@ -362,7 +460,7 @@ bool WrappedVulkan::Prepare_InitialState(WrappedVkRes *res)
                                           imageInfo.extent.depth, sizeFormat, m, i);
 
             ObjDisp(d)->CmdCopyImageToBuffer(Unwrap(cmd), realim,
-                                             VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, Unwrap(dstBuf),
+                                             VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, Unwrap(copyBuf),
                                              1, &region);
           }
         }
@@ -380,7 +478,7 @@ bool WrappedVulkan::Prepare_InitialState(WrappedVkRes *res)
                                    imageInfo.extent.depth, sizeFormat, m);
 
           ObjDisp(d)->CmdCopyImageToBuffer(
-              Unwrap(cmd), realim, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, Unwrap(dstBuf), 1, &region);
+              Unwrap(cmd), realim, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, Unwrap(copyBuf), 1, &region);
 
           if(aspectFlags == (VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT))
           {
@@ -394,7 +492,7 @@ bool WrappedVulkan::Prepare_InitialState(WrappedVkRes *res)
                                      imageInfo.extent.depth, VK_FORMAT_S8_UINT, m);
 
             ObjDisp(d)->CmdCopyImageToBuffer(Unwrap(cmd), realim,
-                                             VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, Unwrap(dstBuf),
+                                             VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, Unwrap(copyBuf),
                                              1, &region);
           }
         }
@@ -406,9 +504,30 @@ bool WrappedVulkan::Prepare_InitialState(WrappedVkRes *res)
       }
     }
 
-    RDCASSERTMSG("buffer wasn't sized sufficiently!", bufOffset <= bufInfo.size, bufOffset,
+    RDCASSERTMSG("buffer wasn't sized sufficiently!", bufOffset <= contentsSize, bufOffset,
                  readbackmem.size, imageInfo.extent, imageInfo.format, numLayers,
                  imageInfo.levelCount);
+    bool compacted = false;
+
+    if(compact)
+    {
+      compacted = GetDebugManager()->CompactTiles(cmd, copyBuf, dstBuf, contentsSize);
+
+      // if we couldn't compact, read back the whole contents as normal
+      if(!compacted)
+      {
+        VkMemoryBarrier barrier = {
+            VK_STRUCTURE_TYPE_MEMORY_BARRIER, NULL, VK_ACCESS_TRANSFER_WRITE_BIT,
+            VK_ACCESS_TRANSFER_READ_BIT,
+        };
+
+        DoPipelineBarrier(cmd, 1, &barrier);
+
+        VkBufferCopy region = {0, 0, contentsSize};
+        ObjDisp(d)->CmdCopyBuffer(Unwrap(cmd), Unwrap(copyBuf), Unwrap(dstBuf), 1, &region);
+      }
+    }
+
     InlineCleanupImageBarriers(cmd, cleanupBarriers);
     m_cleanupImageBarriers.Merge(cleanupBarriers);
 
@@ -416,20 +535,21 @@ bool WrappedVulkan::Prepare_InitialState(WrappedVkRes *res)
     RDCASSERTEQUAL(vkr, VK_SUCCESS);
 
     SubmitAndFlushImageStateBarriers(m_setupImageBarriers);
-    SubmitCmds();
-    FlushQ();
-    SubmitAndFlushImageStateBarriers(m_cleanupImageBarriers);
-
-    ObjDisp(d)->DestroyBuffer(Unwrap(d), Unwrap(dstBuf), NULL);
-    GetResourceManager()->ReleaseWrappedResource(dstBuf);
 
+    // INITSTATEBATCH
+    m_InitStateBatch.buffers.push_back(dstBuf);
+    if(copyBuf != dstBuf)
+      m_InitStateBatch.buffers.push_back(copyBuf);
     if(arrayIm != VK_NULL_HANDLE)
-    {
-      ObjDisp(d)->DestroyImage(Unwrap(d), Unwrap(arrayIm), NULL);
-      GetResourceManager()->ReleaseWrappedResource(arrayIm);
-    }
+      m_InitStateBatch.images.push_back(arrayIm);
 
-    GetResourceManager()->SetInitialContents(id, VkInitialContents(type, readbackmem));
+    SubmitInitStateCopy(contentsSize);
+
+    VkInitialContents initialContents(type, readbackmem);
+    if(compacted)
+      initialContents.tileCompactedSize = contentsSize;
+
+    GetResourceManager()->SetInitialContents(id, initialContents);
 
     return true;
   }
@@ -516,13 +636,10 @@ bool WrappedVulkan::Prepare_InitialState(WrappedVkRes *res)
     RDCASSERTEQUAL(vkr, VK_SUCCESS);
 
     // INITSTATEBATCH
-    SubmitCmds();
-    FlushQ();
+    m_InitStateBatch.buffers.push_back(srcBuf);
+    m_InitStateBatch.buffers.push_back(dstBuf);
 
-    ObjDisp(d)->DestroyBuffer(Unwrap(d), Unwrap(srcBuf), NULL);
-    ObjDisp(d)->DestroyBuffer(Unwrap(d), Unwrap(dstBuf), NULL);
-    GetResourceManager()->ReleaseWrappedResource(srcBuf);
-    GetResourceManager()->ReleaseWrappedResource(dstBuf);
+    SubmitInitStateCopy(datasize);
 
     GetResourceManager()->SetInitialContents(id, VkInitialContents(type, readbackmem));
 
@@ -563,7 +680,7 @@ uint64_t WrappedVulkan::GetSize_InitialState(ResourceId id, const VkInitialConte
       return GetSize_SparseInitialState(id, initial);
 
     // the size primarily comes from the buffer, the size of which we conveniently have stored.
-    return uint64_t(128 + initial.mem.size + WriteSerialiser::GetChunkAlignment());
+    return uint64_t(128 + initial.mem.size + WriteSerialiser::GetBufferOverhead());
   }
 
   RDCERR("Unhandled resource type %s", ToStr(initial.type).c_str());
@@ -894,6 +1011,12 @@ bool WrappedVulkan::Serialise_InitialState(SerialiserType &ser, ResourceId id,
     uint64_t ContentsSize = initial ? initial->mem.size : 0;
     MemoryAllocation mappedMem;
 
+    // compacted contents are expanded into here before being written
+    byte *expandedContents = NULL;
+
+    if(initial && initial->tileCompactedSize > 0)
+      ContentsSize = initial->tileCompactedSize;
+
     // Serialise this separately so that it can be used on reading to prepare the upload memory
     SERIALISE_ELEMENT(ContentsSize);
 
@@ -924,6 +1047,13 @@ bool WrappedVulkan::Serialise_InitialState(SerialiserType &ser, ResourceId id,
 
         vkr = ObjDisp(d)->InvalidateMappedMemoryRanges(Unwrap(d), 1, &range);
         RDCASSERTEQUAL(vkr, VK_SUCCESS);
+
+        if(initial->tileCompactedSize > 0)
+        {
+          expandedContents = AllocAlignedBuffer(ContentsSize);
+          VulkanDebugManager::ExpandCompactedTiles(Contents, ContentsSize, expandedContents);
+          Contents = expandedContents;
+        }
       }
     }
     else if(IsReplayingAndReading() && !ser.IsErrored())
@@ -956,6 +1086,8 @@ bool WrappedVulkan::Serialise_InitialState(SerialiserType &ser, ResourceId id,
     // directly into upload memory
     ser.Serialise("Contents"_lit, Contents, ContentsSize, SerialiserFlags::NoFlags);
 
+    FreeAlignedBuffer(expandedContents);
+
     // unmap the resource we mapped before - we need to do this on read and on write.
     if(!IsStructuredExporting(m_State) && mappedMem.mem != VK_NULL_HANDLE)
     {
@@ -1299,6 +1431,9 @@ void WrappedVulkan::Apply_InitialState(WrappedVkRes *live, const VkInitialConten
     if(initial.numDescriptors == 0)
       return;
 
+    if(!m_RerecordCache.empty())
+      RerecordCacheSetWritten(id);
+
     // deliberately go through our wrapper implementation, to unwrap the VkWriteDescriptorSet
     // structs
     vkUpdateDescriptorSets(GetDev(), initial.numDescriptors, writes, 0, NULL);
@@ -426,7 +426,7 @@ bool VulkanResourceManager::Serialise_DeviceMemoryRefs(SerialiserType &ser,
 
       auto res = m_MemFrameRefs.insert(std::pair<ResourceId, MemRefs>(mem, MemRefs()));
       RDCASSERTMSG("MemRefIntervals for each memory resource must be contiguous", res.second);
-      Intervals<FrameRefType> &rangeRefs = res.first->second.rangeRefs;
+      FrameRefIntervals &rangeRefs = res.first->second.rangeRefs;
 
       auto it_ints = rangeRefs.begin();
       uint64_t last = 0;
@@ -548,7 +548,7 @@ void VulkanResourceManager::InsertDeviceMemoryRefs(WriteSerialiser &ser)
       memRefs = &emptyMemRefs;
     else
       memRefs = &it->second;
-    Intervals<FrameRefType> &rangeRefs = memRefs->rangeRefs;
+    FrameRefIntervals &rangeRefs = memRefs->rangeRefs;
     for(auto jt = rangeRefs.begin(); jt != rangeRefs.end(); jt++)
       data.push_back({*memIt, jt->start(), jt->value()});
   }
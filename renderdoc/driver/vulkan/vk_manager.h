@@ -37,13 +37,37 @@ struct MemIDOffset
 
 DECLARE_REFLECTION_STRUCT(MemIDOffset);
 
+// a range of a memory object that's bound to a sparse resource, and where its contents are stored
+struct SparseMemRegion
+{
+  ResourceId memory;
+  VkDeviceSize memOffs;
+  // VK_WHOLE_SIZE in older captures, which stored the whole of each memory object
+  VkDeviceSize size;
+  // the offset of the contents in the initial state data, or ~0ULL if they were all zero
+  VkDeviceSize dataOffs;
+};
+
+DECLARE_REFLECTION_STRUCT(SparseMemRegion);
+
+// a resident page within the page table of a sparse image aspect
+struct SparsePageBind
+{
+  // index into the page table, in order of width first, then height, then depth
+  uint32_t page;
+  ResourceId memory;
+  VkDeviceSize memOffs;
+};
+
+DECLARE_REFLECTION_STRUCT(SparsePageBind);
+
 struct SparseBufferInitState
 {
   VkSparseMemoryBind *binds;
   uint32_t numBinds;
 
-  MemIDOffset *memDataOffs;
-  uint32_t numUniqueMems;
+  SparseMemRegion *regions;
+  uint32_t numRegions;
 
   VkDeviceSize totalSize;
 };
@@ -58,16 +82,25 @@ struct SparseImageInitState
   VkExtent3D imgdim;    // in pages
   VkExtent3D pagedim;
 
+  // the size in bytes of a page in memory
+  VkDeviceSize pageSize;
+
+  // which aspects have a page table, even if none of their pages are resident
+  uint32_t pageAspects;
+
   // available on capture - filled out in Prepare_SparseInitialState and serialised to disk
-  MemIDOffset *pages[NUM_VK_IMAGE_ASPECTS];
+  SparsePageBind *pages[NUM_VK_IMAGE_ASPECTS];
 
   uint32_t pageCount[NUM_VK_IMAGE_ASPECTS];
 
-  // available on replay - filled out in the read path of Serialise_SparseInitialState
+  // available on replay - filled out in the read path of Serialise_SparseInitialState, with runs
+  // of adjacent pages merged into one bind
   VkSparseImageMemoryBind *pageBinds[NUM_VK_IMAGE_ASPECTS];
 
-  MemIDOffset *memDataOffs;
-  uint32_t numUniqueMems;
+  uint32_t pageBindCount[NUM_VK_IMAGE_ASPECTS];
+
+  SparseMemRegion *regions;
+  uint32_t numRegions;
 
   VkDeviceSize totalSize;
 };
@@ -133,12 +166,12 @@ struct VkInitialContents
           SAFE_DELETE_ARRAY(sparseImage.pages[i]);
           SAFE_DELETE_ARRAY(sparseImage.pageBinds[i]);
         }
-        SAFE_DELETE_ARRAY(sparseImage.memDataOffs);
+        SAFE_DELETE_ARRAY(sparseImage.regions);
       }
       else if(type == eResBuffer)
       {
         SAFE_DELETE_ARRAY(sparseBuffer.binds);
-        SAFE_DELETE_ARRAY(sparseBuffer.memDataOffs);
+        SAFE_DELETE_ARRAY(sparseBuffer.regions);
       }
     }
   }
@@ -156,6 +189,10 @@ struct VkInitialContents
   MemoryAllocation mem;
   Tag tag;
 
+  // when capturing, if non-zero then mem holds image contents of this size compacted by
+  // VulkanDebugManager::CompactTiles, which need to be expanded before they're serialised
+  VkDeviceSize tileCompactedSize;
+
   // sparse resources need extra information. Which one is valid, depends on the value of type above
   union
   {
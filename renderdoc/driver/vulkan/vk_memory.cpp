@@ -101,12 +101,16 @@ MemoryAllocation WrappedVulkan::AllocateMemoryForResource(bool buffer, VkMemoryR
            ret.size, mrq.size, mrq.alignment, mrq.memoryTypeBits, buffer ? "buffer" : "image",
            ToStr(type).c_str(), ToStr(scope).c_str());
 
-  rdcarray<MemoryAllocation> &blockList = m_MemoryBlocks[(size_t)scope];
+  rdcarray<MemoryBlock> &blockList = m_MemoryBlocks[(size_t)scope];
+
+  const VkDeviceSize granularity = m_PhysicalDeviceData.props.limits.bufferImageGranularity;
 
   // first try to find a match
   int i = 0;
-  for(MemoryAllocation &block : blockList)
+  for(MemoryBlock &memBlock : blockList)
   {
+    MemoryAllocation &block = memBlock.alloc;
+
     RDCDEBUG(
         "Considering block %d: memory type %u and type %s. Total size 0x%llx, current offset "
         "0x%llx, last alloc was %s",
@@ -121,12 +125,45 @@ MemoryAllocation WrappedVulkan::AllocateMemoryForResource(bool buffer, VkMemoryR
       continue;
     }
 
+    // try to re-use any space that's been freed. We don't know what is either side of a free range
+    // so we pad to the buffer/image granularity at both ends.
+    for(size_t r = 0; r < memBlock.freeRanges.size(); r++)
+    {
+      const VkDeviceSize rangeStart = memBlock.freeRanges[r].first;
+      const VkDeviceSize rangeEnd = rangeStart + memBlock.freeRanges[r].second;
+
+      VkDeviceSize offs = AlignUp(rangeStart, RDCMAX(mrq.alignment, granularity));
+      VkDeviceSize end = offs + AlignUp(ret.size, granularity);
+
+      if(end > rangeEnd)
+        continue;
+
+      RDCDEBUG("Re-using freed range 0x%llx -> 0x%llx at offset 0x%llx", rangeStart, rangeEnd,
+               offs);
+
+      ret.offs = offs;
+      ret.mem = block.mem;
+      ret.memoryTypeIndex = block.memoryTypeIndex;
+      ret.reservedOffs = rangeStart;
+      ret.reservedSize = end - rangeStart;
+
+      if(end == rangeEnd)
+        memBlock.freeRanges.erase(r);
+      else
+        memBlock.freeRanges[r] = make_rdcpair(end, rangeEnd - end);
+
+      break;
+    }
+
+    if(ret.mem != VK_NULL_HANDLE)
+      break;
+
     // offs is where we can put our next sub-allocation
     VkDeviceSize offs = block.offs;
 
     // if we are on a buffer/image, account for any alignment we might have to do
-    if(ret.buffer != block.buffer)
-      offs = AlignUp(offs, m_PhysicalDeviceData.props.limits.bufferImageGranularity);
+    if(ret.buffer != block.buffer || memBlock.lastTypeUnknown)
+      offs = AlignUp(offs, granularity);
 
     // align as required by the resource
     offs = AlignUp(offs, mrq.alignment);
@@ -146,13 +183,19 @@ MemoryAllocation WrappedVulkan::AllocateMemoryForResource(bool buffer, VkMemoryR
     // if the allocation will fit, we've found our candidate.
     if(ret.size <= avail)
     {
+      // the padding in front belongs to this allocation so it's returned along with it
+      ret.reservedOffs = block.offs;
+      ret.reservedSize = offs + ret.size - block.offs;
+
       // update the block offset and buffer/image bit
       block.offs = offs + ret.size;
       block.buffer = ret.buffer;
+      memBlock.lastTypeUnknown = false;
 
       // update our return value
       ret.offs = offs;
       ret.mem = block.mem;
+      ret.memoryTypeIndex = block.memoryTypeIndex;
 
       RDCDEBUG("Allocating using this block: 0x%llx -> 0x%llx", ret.offs, block.offs);
 
@@ -213,6 +256,45 @@ MemoryAllocation WrappedVulkan::AllocateMemoryForResource(bool buffer, VkMemoryR
       }
     }
 
+    // when we're close to the heap's budget, don't reserve a whole block's worth of space that we
+    // might never use - only allocate what's needed.
+    if(IsOverMemoryBudget(memoryTypeIndex, info.allocationSize))
+    {
+      RDCDEBUG("Allocation of 0x%llx bytes would exceed budget, allocating 0x%llx bytes",
+               info.allocationSize, ret.size);
+      info.allocationSize = ret.size;
+    }
+
+    // GPU local memory is only a preference, so if the device memory is exhausted or even the
+    // precise allocation would exceed the budget, place the allocation in host-visible memory
+    // instead where possible. This is slower to access from the GPU but is better than failing or
+    // forcing the driver to page the application's own resources.
+    const VkPhysicalDeviceMemoryProperties &memProps = m_PhysicalDeviceData.memProps;
+    uint32_t hostMemoryTypeIndex = memProps.memoryTypeCount;
+    if(ret.type == MemoryType::GPULocal)
+    {
+      for(uint32_t m = 0; m < memProps.memoryTypeCount; m++)
+      {
+        if((mrq.memoryTypeBits & (1 << m)) && m != memoryTypeIndex &&
+           (memProps.memoryTypes[m].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) &&
+           memProps.memoryTypes[m].heapIndex !=
+               memProps.memoryTypes[memoryTypeIndex].heapIndex)
+        {
+          hostMemoryTypeIndex = m;
+          break;
+        }
+      }
+    }
+
+    if(hostMemoryTypeIndex < memProps.memoryTypeCount &&
+       IsOverMemoryBudget(memoryTypeIndex, info.allocationSize))
+    {
+      RDCWARN("Device memory budget exceeded, allocating 0x%llx bytes in host memory",
+              info.allocationSize);
+      info.memoryTypeIndex = memoryTypeIndex = hostMemoryTypeIndex;
+      hostMemoryTypeIndex = memProps.memoryTypeCount;
+    }
+
     RDCDEBUG("Creating new allocation of 0x%llx bytes", info.allocationSize);
 
     MemoryAllocation chunk;
@@ -220,25 +302,55 @@ MemoryAllocation WrappedVulkan::AllocateMemoryForResource(bool buffer, VkMemoryR
     chunk.memoryTypeIndex = memoryTypeIndex;
     chunk.scope = scope;
     chunk.type = type;
-    chunk.size = info.allocationSize;
-
-    // the offset starts immediately after this allocation
-    chunk.offs = ret.size;
 
     VkDevice d = GetDev();
 
     // do the actual allocation
     VkResult vkr = ObjDisp(d)->AllocateMemory(Unwrap(d), &info, NULL, &chunk.mem);
-    RDCASSERTEQUAL(vkr, VK_SUCCESS);
+
+    // if a full block couldn't be allocated, retry with just what's needed
+    if(vkr != VK_SUCCESS && info.allocationSize > ret.size)
+    {
+      RDCWARN("Failed to allocate 0x%llx bytes (%s), retrying with 0x%llx bytes",
+              info.allocationSize, ToStr(vkr).c_str(), ret.size);
+      info.allocationSize = ret.size;
+      vkr = ObjDisp(d)->AllocateMemory(Unwrap(d), &info, NULL, &chunk.mem);
+    }
+
+    // and finally fall back to host memory if that's allowed
+    if(vkr != VK_SUCCESS && hostMemoryTypeIndex < memProps.memoryTypeCount)
+    {
+      RDCWARN("Failed to allocate 0x%llx bytes of device memory (%s), using host memory",
+              info.allocationSize, ToStr(vkr).c_str());
+      info.memoryTypeIndex = chunk.memoryTypeIndex = hostMemoryTypeIndex;
+      vkr = ObjDisp(d)->AllocateMemory(Unwrap(d), &info, NULL, &chunk.mem);
+    }
+
+    if(vkr != VK_SUCCESS)
+    {
+      RDCERR("Failed to allocate 0x%llx bytes of memory: %s", info.allocationSize,
+             ToStr(vkr).c_str());
+      return MemoryAllocation();
+    }
+
+    chunk.size = info.allocationSize;
+
+    // the offset starts immediately after this allocation
+    chunk.offs = ret.size;
 
     GetResourceManager()->WrapResource(Unwrap(d), chunk.mem);
 
     // push the new chunk
-    blockList.push_back(chunk);
+    MemoryBlock memBlock;
+    memBlock.alloc = chunk;
+    blockList.push_back(memBlock);
 
     // return the first bytes in the new chunk
     ret.offs = 0;
     ret.mem = chunk.mem;
+    ret.memoryTypeIndex = chunk.memoryTypeIndex;
+    ret.reservedOffs = 0;
+    ret.reservedSize = ret.size;
   }
 
   // ensure the returned size is accurate to what was requested, not what we padded
@@ -247,6 +359,26 @@ MemoryAllocation WrappedVulkan::AllocateMemoryForResource(bool buffer, VkMemoryR
   return ret;
 }
 
+bool WrappedVulkan::IsOverMemoryBudget(uint32_t memoryTypeIndex, VkDeviceSize size)
+{
+  if(!m_PhysicalDeviceData.memoryBudget ||
+     memoryTypeIndex >= m_PhysicalDeviceData.memProps.memoryTypeCount)
+    return false;
+
+  VkPhysicalDeviceMemoryBudgetPropertiesEXT budget = {
+      VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT,
+  };
+  VkPhysicalDeviceMemoryProperties2 props = {
+      VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2, &budget,
+  };
+
+  ObjDisp(m_PhysicalDevice)->GetPhysicalDeviceMemoryProperties2(Unwrap(m_PhysicalDevice), &props);
+
+  const uint32_t heap = props.memoryProperties.memoryTypes[memoryTypeIndex].heapIndex;
+
+  return budget.heapUsage[heap] + size > budget.heapBudget[heap];
+}
+
 MemoryAllocation WrappedVulkan::AllocateMemoryForResource(VkImage im, MemoryScope scope,
                                                           MemoryType type)
 {
@@ -271,23 +403,97 @@ MemoryAllocation WrappedVulkan::AllocateMemoryForResource(VkBuffer buf, MemorySc
 
 void WrappedVulkan::FreeAllMemory(MemoryScope scope)
 {
-  rdcarray<MemoryAllocation> &allocList = m_MemoryBlocks[(size_t)scope];
+  rdcarray<MemoryBlock> &blockList = m_MemoryBlocks[(size_t)scope];
 
-  if(allocList.empty())
+  if(blockList.empty())
     return;
 
   VkDevice d = GetDev();
 
-  for(MemoryAllocation alloc : allocList)
+  for(MemoryBlock &block : blockList)
   {
-    ObjDisp(d)->FreeMemory(Unwrap(d), Unwrap(alloc.mem), NULL);
-    GetResourceManager()->ReleaseWrappedResource(alloc.mem);
+    ObjDisp(d)->FreeMemory(Unwrap(d), Unwrap(block.alloc.mem), NULL);
+    GetResourceManager()->ReleaseWrappedResource(block.alloc.mem);
   }
 
-  allocList.clear();
+  blockList.clear();
+}
+
+VkDeviceSize WrappedVulkan::GetAllocatedMemorySize(MemoryScope scope)
+{
+  VkDeviceSize ret = 0;
+
+  for(const MemoryBlock &block : m_MemoryBlocks[(size_t)scope])
+    ret += block.alloc.size;
+
+  return ret;
 }
 
 void WrappedVulkan::FreeMemoryAllocation(MemoryAllocation alloc)
 {
-  // don't do anything at the moment, we only support freeing the whole scope at once.
+  if(alloc.mem == VK_NULL_HANDLE || alloc.reservedSize == 0)
+    return;
+
+  rdcarray<MemoryBlock> &blockList = m_MemoryBlocks[(size_t)alloc.scope];
+
+  size_t b = 0;
+  for(; b < blockList.size(); b++)
+    if(blockList[b].alloc.mem == alloc.mem)
+      break;
+
+  if(b == blockList.size())
+  {
+    RDCERR("Freeing allocation from unknown block in %s", ToStr(alloc.scope).c_str());
+    return;
+  }
+
+  MemoryBlock &block = blockList[b];
+  rdcarray<rdcpair<VkDeviceSize, VkDeviceSize>> &ranges = block.freeRanges;
+
+  VkDeviceSize start = alloc.reservedOffs;
+  VkDeviceSize end = alloc.reservedOffs + alloc.reservedSize;
+
+  // find where this range goes, and merge with the free neighbours on either side
+  size_t r = 0;
+  while(r < ranges.size() && ranges[r].first < start)
+    r++;
+
+  if(r < ranges.size() && ranges[r].first == end)
+  {
+    end += ranges[r].second;
+    ranges.erase(r);
+  }
+
+  if(r > 0 && ranges[r - 1].first + ranges[r - 1].second == start)
+  {
+    r--;
+    start = ranges[r].first;
+    ranges.erase(r);
+  }
+
+  if(end == block.alloc.offs)
+  {
+    // this is the last allocation, so just move the offset back. We don't know what's in front any
+    // more so the next allocation will be padded for buffer/image granularity
+    block.alloc.offs = start;
+    block.lastTypeUnknown = true;
+  }
+  else
+  {
+    ranges.insert(r, make_rdcpair(start, end - start));
+  }
+
+  // release the block entirely once nothing is left in it
+  if(block.alloc.offs == 0)
+  {
+    RDCDEBUG("Releasing empty block of 0x%llx bytes in %s", block.alloc.size,
+             ToStr(alloc.scope).c_str());
+
+    VkDevice d = GetDev();
+
+    ObjDisp(d)->FreeMemory(Unwrap(d), Unwrap(block.alloc.mem), NULL);
+    GetResourceManager()->ReleaseWrappedResource(block.alloc.mem);
+
+    blockList.erase(b);
+  }
 }
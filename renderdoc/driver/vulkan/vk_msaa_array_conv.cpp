@@ -328,10 +328,23 @@ void VulkanDebugManager::CopyDepthTex2DMSToArray(VkImage destArray, VkImage srcM
       {{0, 0}, {extent.width, extent.height}},  1,    &clearval,
   };
 
-  uint32_t numStencil = 1;
+  // the depth is written in one draw, then stencil one bit per draw. This is far fewer draws than
+  // writing each of the 256 stencil values with the stencil reference.
+  uint32_t numStencilBits = 0;
 
   if(aspectFlags & VK_IMAGE_ASPECT_STENCIL_BIT)
-    numStencil = 256;
+    numStencilBits = 8;
+
+  // bound state persists across render passes
+  ObjDisp(cmd)->CmdBindPipeline(Unwrap(cmd), VK_PIPELINE_BIND_POINT_GRAPHICS, Unwrap(pipe));
+  ObjDisp(cmd)->CmdBindDescriptorSets(Unwrap(cmd), VK_PIPELINE_BIND_POINT_GRAPHICS,
+                                      Unwrap(m_ArrayMSPipeLayout), 0, 1,
+                                      UnwrapPtr(m_ArrayMSDescSet), 0, NULL);
+
+  VkViewport viewport = {0.0f, 0.0f, (float)extent.width, (float)extent.height, 0.0f, 1.0f};
+  ObjDisp(cmd)->CmdSetViewport(Unwrap(cmd), 0, 1, &viewport);
+
+  ObjDisp(cmd)->CmdSetStencilReference(Unwrap(cmd), VK_STENCIL_FACE_FRONT_AND_BACK, 0xff);
 
   Vec4u params;
   params.x = samples;
@@ -342,22 +355,22 @@ void VulkanDebugManager::CopyDepthTex2DMSToArray(VkImage destArray, VkImage srcM
 
     ObjDisp(cmd)->CmdBeginRenderPass(Unwrap(cmd), &rpbegin, VK_SUBPASS_CONTENTS_INLINE);
 
-    ObjDisp(cmd)->CmdBindPipeline(Unwrap(cmd), VK_PIPELINE_BIND_POINT_GRAPHICS, Unwrap(pipe));
-    ObjDisp(cmd)->CmdBindDescriptorSets(Unwrap(cmd), VK_PIPELINE_BIND_POINT_GRAPHICS,
-                                        Unwrap(m_ArrayMSPipeLayout), 0, 1,
-                                        UnwrapPtr(m_ArrayMSDescSet), 0, NULL);
-
-    VkViewport viewport = {0.0f, 0.0f, (float)extent.width, (float)extent.height, 0.0f, 1.0f};
-    ObjDisp(cmd)->CmdSetViewport(Unwrap(cmd), 0, 1, &viewport);
-
     params.y = i % samples;    // currentSample;
     params.z = i / samples;    // currentSlice;
 
-    for(uint32_t s = 0; s < numStencil; s++)
+    // depth, leaving the cleared stencil untouched
+    params.w = 1000;    // currentStencilBit;
+
+    ObjDisp(cmd)->CmdSetStencilWriteMask(Unwrap(cmd), VK_STENCIL_FACE_FRONT_AND_BACK, 0);
+    ObjDisp(cmd)->CmdPushConstants(Unwrap(cmd), Unwrap(m_ArrayMSPipeLayout), VK_SHADER_STAGE_ALL, 0,
+                                   sizeof(Vec4u), &params);
+    ObjDisp(cmd)->CmdDraw(Unwrap(cmd), 4, 1, 0, 0);
+
+    for(uint32_t b = 0; b < numStencilBits; b++)
     {
-      params.w = numStencil == 1 ? 1000 : s;    // currentStencil;
+      params.w = b;    // currentStencilBit;
 
-      ObjDisp(cmd)->CmdSetStencilReference(Unwrap(cmd), VK_STENCIL_FACE_FRONT_AND_BACK, s);
+      ObjDisp(cmd)->CmdSetStencilWriteMask(Unwrap(cmd), VK_STENCIL_FACE_FRONT_AND_BACK, 1U << b);
       ObjDisp(cmd)->CmdPushConstants(Unwrap(cmd), Unwrap(m_ArrayMSPipeLayout), VK_SHADER_STAGE_ALL,
                                      0, sizeof(Vec4u), &params);
       ObjDisp(cmd)->CmdDraw(Unwrap(cmd), 4, 1, 0, 0);
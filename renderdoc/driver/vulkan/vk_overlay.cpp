@@ -42,15 +42,21 @@
 struct VulkanQuadOverdrawCallback : public VulkanDrawcallCallback
 {
   VulkanQuadOverdrawCallback(WrappedVulkan *vk, VkDescriptorSetLayout descSetLayout,
-                             VkDescriptorSet descSet, const rdcarray<uint32_t> &events)
-      : m_pDriver(vk), m_DescSetLayout(descSetLayout), m_DescSet(descSet), m_Events(events)
+                             VkDescriptorSet descSet, const rdcarray<uint32_t> &events,
+                             uint32_t statsStride)
+      : m_pDriver(vk),
+        m_DescSetLayout(descSetLayout),
+        m_DescSet(descSet),
+        m_Events(events),
+        m_StatsStride(statsStride)
   {
     m_pDriver->SetDrawcallCB(this);
   }
   ~VulkanQuadOverdrawCallback() { m_pDriver->SetDrawcallCB(NULL); }
   void PreDraw(uint32_t eid, VkCommandBuffer cmd)
   {
-    if(!m_Events.contains(eid))
+    int32_t drawIndex = m_Events.indexOf(eid);
+    if(drawIndex < 0)
       return;
 
     // we customise the pipeline to disable framebuffer writes, but perform normal testing
@@ -139,7 +145,7 @@ struct VulkanQuadOverdrawCallback : public VulkanDrawcallCallback
       rdcarray<uint32_t> spirv =
           *m_pDriver->GetShaderCache()->GetBuiltinBlob(BuiltinShader::QuadWriteFS);
 
-      // patch spirv, change descriptor set to descSet value
+      // patch spirv, change descriptor set to descSet value for both the image and the stats buffer
       size_t it = 5;
       while(it < spirv.size())
       {
@@ -148,10 +154,11 @@ struct VulkanQuadOverdrawCallback : public VulkanDrawcallCallback
 
         if(opcode == rdcspv::Op::Decorate &&
            spirv[it + 2] == (uint32_t)rdcspv::Decoration::DescriptorSet)
-        {
           spirv[it + 3] = descSet;
+
+        // decorations all come before any functions
+        if(opcode == rdcspv::Op::Function)
           break;
-        }
 
         it += WordCount;
       }
@@ -217,6 +224,7 @@ struct VulkanQuadOverdrawCallback : public VulkanDrawcallCallback
     pipestate.graphics.descSets.resize(pipe.descSet + 1);
     pipestate.graphics.descSets[pipe.descSet].pipeLayout = GetResID(pipe.pipeLayout);
     pipestate.graphics.descSets[pipe.descSet].descSet = GetResID(m_DescSet);
+    pipestate.graphics.descSets[pipe.descSet].offsets = {uint32_t(drawIndex) * m_StatsStride};
 
     if(cmd)
       pipestate.BindPipeline(m_pDriver, cmd, VulkanRenderState::BindGraphics, false);
@@ -260,6 +268,7 @@ struct VulkanQuadOverdrawCallback : public VulkanDrawcallCallback
   VkDescriptorSetLayout m_DescSetLayout;
   VkDescriptorSet m_DescSet;
   const rdcarray<uint32_t> &m_Events;
+  uint32_t m_StatsStride;
 
   // cache modified pipelines
   struct CachedPipeline
@@ -581,6 +590,27 @@ ResourceId VulkanReplay::RenderOverlay(ResourceId texid, CompType typeCast, Floa
 
   VkImageSubresourceRange subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1};
 
+  // the clear overlays modify the real target, and NaN/clipping are only a clear here, so only the
+  // overlays that replay draws are worth caching
+  const bool cacheable = overlay != DebugOverlay::NoOverlay && overlay != DebugOverlay::NaN &&
+                         overlay != DebugOverlay::Clipping &&
+                         overlay != DebugOverlay::ClearBeforeDraw &&
+                         overlay != DebugOverlay::ClearBeforePass;
+
+  OverlayCacheKey cacheKey = {texid, typeCast, clearCol, overlay, eventId};
+
+  m_OverdrawStats.clear();
+
+  if(cacheable && FetchCachedOverlay(cmd, cacheKey))
+  {
+    VkMarkerRegion::End(cmd);
+
+    vkr = vt->EndCommandBuffer(Unwrap(cmd));
+    RDCASSERTEQUAL(vkr, VK_SUCCESS);
+
+    return GetResID(m_Overlay.Image);
+  }
+
   const DrawcallDescription *mainDraw = m_pDriver->GetDrawcall(eventId);
 
   // Secondary commands can't have render passes
@@ -1772,23 +1802,47 @@ ResourceId VulkanReplay::RenderOverlay(ResourceId texid, CompType typeCast, Floa
       vkr = m_pDriver->vkCreateImageView(m_Device, &viewinfo, NULL, &quadImgView);
       RDCASSERTEQUAL(vkr, VK_SUCCESS);
 
+      // each draw accumulates its shaded pixels, helper lanes and quads into its own slot, selected
+      // with a dynamic offset
+      const uint32_t statsStride = (uint32_t)AlignUp(
+          (VkDeviceSize)sizeof(uint32_t) * 4,
+          m_pDriver->GetDeviceProps().limits.minStorageBufferOffsetAlignment);
+
+      GPUBuffer statsBuf;
+      statsBuf.Create(m_pDriver, m_Device, statsStride * events.size(), 1,
+                      GPUBuffer::eGPUBufferReadback | GPUBuffer::eGPUBufferSSBO);
+
       // update descriptor to point to our R32 result image
       VkDescriptorImageInfo imdesc = {0};
       imdesc.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
       imdesc.sampler = VK_NULL_HANDLE;
       imdesc.imageView = Unwrap(quadImgView);
 
-      VkWriteDescriptorSet write = {VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-                                    NULL,
-                                    Unwrap(m_Overlay.m_QuadDescSet),
-                                    0,
-                                    0,
-                                    1,
-                                    VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
-                                    &imdesc,
-                                    NULL,
-                                    NULL};
-      vt->UpdateDescriptorSets(Unwrap(m_Device), 1, &write, 0, NULL);
+      VkDescriptorBufferInfo statsdesc = {Unwrap(statsBuf.buf), 0, sizeof(uint32_t) * 4};
+
+      VkWriteDescriptorSet writes[2] = {
+          {VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET, NULL, Unwrap(m_Overlay.m_QuadDescSet), 0, 0, 1,
+           VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, &imdesc, NULL, NULL},
+          {VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET, NULL, Unwrap(m_Overlay.m_QuadDescSet), 1, 0, 1,
+           VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC, NULL, &statsdesc, NULL},
+      };
+      vt->UpdateDescriptorSets(Unwrap(m_Device), 2, writes, 0, NULL);
+
+      vt->CmdFillBuffer(Unwrap(cmd), Unwrap(statsBuf.buf), 0, VK_WHOLE_SIZE, 0);
+
+      VkBufferMemoryBarrier statsBarrier = {
+          VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+          NULL,
+          VK_ACCESS_TRANSFER_WRITE_BIT,
+          VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+          VK_QUEUE_FAMILY_IGNORED,
+          VK_QUEUE_FAMILY_IGNORED,
+          Unwrap(statsBuf.buf),
+          0,
+          VK_WHOLE_SIZE,
+      };
+
+      DoPipelineBarrier(cmd, 1, &statsBarrier);
 
       VkImageMemoryBarrier quadImBarrier = {
           VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
@@ -1834,7 +1888,7 @@ ResourceId VulkanReplay::RenderOverlay(ResourceId texid, CompType typeCast, Floa
 
       // declare callback struct here
       VulkanQuadOverdrawCallback cb(m_pDriver, m_Overlay.m_QuadDescSetLayout,
-                                    m_Overlay.m_QuadDescSet, events);
+                                    m_Overlay.m_QuadDescSet, events, statsStride);
 
       m_pDriver->ReplayLog(events.front(), events.back(), eReplay_Full);
 
@@ -1867,9 +1921,10 @@ ResourceId VulkanReplay::RenderOverlay(ResourceId texid, CompType typeCast, Floa
 
         vt->CmdBindPipeline(Unwrap(cmd), VK_PIPELINE_BIND_POINT_GRAPHICS,
                             Unwrap(m_Overlay.m_QuadResolvePipeline[SampleIndex(iminfo.samples)]));
+        uint32_t statsOffset = 0;
         vt->CmdBindDescriptorSets(Unwrap(cmd), VK_PIPELINE_BIND_POINT_GRAPHICS,
                                   Unwrap(m_Overlay.m_QuadResolvePipeLayout), 0, 1,
-                                  UnwrapPtr(m_Overlay.m_QuadDescSet), 0, NULL);
+                                  UnwrapPtr(m_Overlay.m_QuadDescSet), 1, &statsOffset);
 
         VkViewport viewport = {
             0.0f, 0.0f, (float)m_Overlay.ImageDim.width, (float)m_Overlay.ImageDim.height,
@@ -1879,6 +1934,11 @@ ResourceId VulkanReplay::RenderOverlay(ResourceId texid, CompType typeCast, Floa
         vt->CmdDraw(Unwrap(cmd), 4, 1, 0, 0);
         vt->CmdEndRenderPass(Unwrap(cmd));
 
+        statsBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+        statsBarrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+
+        DoPipelineBarrier(cmd, 1, &statsBarrier);
+
         vkr = vt->EndCommandBuffer(Unwrap(cmd));
         RDCASSERTEQUAL(vkr, VK_SUCCESS);
       }
@@ -1886,6 +1946,26 @@ ResourceId VulkanReplay::RenderOverlay(ResourceId texid, CompType typeCast, Floa
       m_pDriver->SubmitCmds();
       m_pDriver->FlushQ();
 
+      byte *stats = (byte *)statsBuf.Map();
+
+      if(stats)
+      {
+        m_OverdrawStats.resize(events.size());
+        for(size_t i = 0; i < events.size(); i++)
+        {
+          const uint32_t *counts = (const uint32_t *)(stats + statsStride * i);
+
+          m_OverdrawStats[i].eventId = events[i];
+          m_OverdrawStats[i].shadedPixels = counts[0];
+          m_OverdrawStats[i].helperLanes = counts[1];
+          m_OverdrawStats[i].quads = counts[2];
+        }
+
+        statsBuf.Unmap();
+      }
+
+      statsBuf.Destroy();
+
       m_pDriver->vkDestroyImageView(m_Device, quadImgView, NULL);
       m_pDriver->vkDestroyImage(m_Device, quadImg, NULL);
       m_pDriver->vkFreeMemory(m_Device, quadImgMem, NULL);
@@ -2366,6 +2446,9 @@ ResourceId VulkanReplay::RenderOverlay(ResourceId texid, CompType typeCast, Floa
     RDCASSERTEQUAL(vkr, VK_SUCCESS);
   }
 
+  if(cacheable)
+    CacheOverlay(cmd, cacheKey, iminfo.samples);
+
   VkMarkerRegion::End(cmd);
 
   vkr = vt->EndCommandBuffer(Unwrap(cmd));
@@ -2377,3 +2460,201 @@ ResourceId VulkanReplay::RenderOverlay(ResourceId texid, CompType typeCast, Floa
 
   return GetResID(m_Overlay.Image);
 }
+
+bool VulkanReplay::FetchCachedOverlay(VkCommandBuffer cmd, const OverlayCacheKey &key)
+{
+  size_t idx = 0;
+  for(; idx < m_OverlayCache.size(); idx++)
+    if(m_OverlayCache[idx].key == key)
+      break;
+
+  if(idx == m_OverlayCache.size())
+    return false;
+
+  // move to the back as the most recently used
+  CachedOverlay cached = m_OverlayCache.takeAt(idx);
+  m_OverlayCache.push_back(cached);
+
+  m_OverdrawStats = cached.OverdrawStats;
+
+  const VkDevDispatchTable *vt = ObjDisp(m_Device);
+
+  VkImageMemoryBarrier barrier = {VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+                                  NULL,
+                                  VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+                                  VK_ACCESS_TRANSFER_WRITE_BIT,
+                                  VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+                                  VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                  VK_QUEUE_FAMILY_IGNORED,
+                                  VK_QUEUE_FAMILY_IGNORED,
+                                  Unwrap(m_Overlay.Image),
+                                  {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1}};
+
+  DoPipelineBarrier(cmd, 1, &barrier);
+
+  VkImageCopy region = {
+      {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1},
+      {0, 0, 0},
+      {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1},
+      {0, 0, 0},
+      {m_Overlay.ImageDim.width, m_Overlay.ImageDim.height, 1},
+  };
+
+  vt->CmdCopyImage(Unwrap(cmd), Unwrap(cached.Image), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                   Unwrap(m_Overlay.Image), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+
+  barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+  barrier.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_SHADER_READ_BIT;
+  std::swap(barrier.oldLayout, barrier.newLayout);
+
+  DoPipelineBarrier(cmd, 1, &barrier);
+
+  return true;
+}
+
+void VulkanReplay::CacheOverlay(VkCommandBuffer cmd, const OverlayCacheKey &key,
+                                VkSampleCountFlagBits samples)
+{
+  VkImageCreateInfo imInfo = {
+      VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+      NULL,
+      0,
+      VK_IMAGE_TYPE_2D,
+      VK_FORMAT_R16G16B16A16_SFLOAT,
+      {m_Overlay.ImageDim.width, m_Overlay.ImageDim.height, 1},
+      1,
+      1,
+      samples,
+      VK_IMAGE_TILING_OPTIMAL,
+      VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+      VK_SHARING_MODE_EXCLUSIVE,
+      0,
+      NULL,
+      VK_IMAGE_LAYOUT_UNDEFINED,
+  };
+
+  CachedOverlay cached;
+  cached.key = key;
+  cached.OverdrawStats = m_OverdrawStats;
+
+  VkResult vkr = m_pDriver->vkCreateImage(m_Device, &imInfo, NULL, &cached.Image);
+  RDCASSERTEQUAL(vkr, VK_SUCCESS);
+
+  VkMemoryRequirements mrq = {0};
+  m_pDriver->vkGetImageMemoryRequirements(m_Device, cached.Image, &mrq);
+
+  // a single overlay that doesn't fit in the budget is never cached
+  if(mrq.size > OverlayCacheBudget)
+  {
+    m_pDriver->vkDestroyImage(m_Device, cached.Image, NULL);
+    return;
+  }
+
+  // evict the least recently used overlays until this one fits. These may have been read by
+  // commands that haven't executed yet, so wait for the GPU before destroying them.
+  if(m_OverlayCacheSize + mrq.size > OverlayCacheBudget)
+  {
+    m_pDriver->FlushQ();
+
+    while(!m_OverlayCache.empty() && m_OverlayCacheSize + mrq.size > OverlayCacheBudget)
+    {
+      CachedOverlay evict = m_OverlayCache.takeAt(0);
+      m_pDriver->vkDestroyImage(m_Device, evict.Image, NULL);
+      m_pDriver->vkFreeMemory(m_Device, evict.Mem, NULL);
+      m_OverlayCacheSize -= evict.Size;
+    }
+  }
+
+  VkMemoryAllocateInfo allocInfo = {
+      VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO, NULL, mrq.size,
+      m_pDriver->GetGPULocalMemoryIndex(mrq.memoryTypeBits),
+  };
+
+  vkr = m_pDriver->vkAllocateMemory(m_Device, &allocInfo, NULL, &cached.Mem);
+  if(vkr != VK_SUCCESS)
+  {
+    m_pDriver->vkDestroyImage(m_Device, cached.Image, NULL);
+    return;
+  }
+
+  vkr = m_pDriver->vkBindImageMemory(m_Device, cached.Image, cached.Mem, 0);
+  RDCASSERTEQUAL(vkr, VK_SUCCESS);
+
+  cached.Size = mrq.size;
+
+  const VkDevDispatchTable *vt = ObjDisp(m_Device);
+
+  VkImageMemoryBarrier barriers[2] = {
+      {VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+       NULL,
+       VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+       VK_ACCESS_TRANSFER_READ_BIT,
+       VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+       VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+       VK_QUEUE_FAMILY_IGNORED,
+       VK_QUEUE_FAMILY_IGNORED,
+       Unwrap(m_Overlay.Image),
+       {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1}},
+      {VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+       NULL,
+       0,
+       VK_ACCESS_TRANSFER_WRITE_BIT,
+       VK_IMAGE_LAYOUT_UNDEFINED,
+       VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+       VK_QUEUE_FAMILY_IGNORED,
+       VK_QUEUE_FAMILY_IGNORED,
+       Unwrap(cached.Image),
+       {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1}},
+  };
+
+  DoPipelineBarrier(cmd, 2, barriers);
+
+  VkImageCopy region = {
+      {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1},
+      {0, 0, 0},
+      {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1},
+      {0, 0, 0},
+      {m_Overlay.ImageDim.width, m_Overlay.ImageDim.height, 1},
+  };
+
+  vt->CmdCopyImage(Unwrap(cmd), Unwrap(m_Overlay.Image), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                   Unwrap(cached.Image), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+
+  // the overlay goes back to the layout the rest of the replay expects, and the cached copy rests
+  // as a copy source
+  barriers[0].srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+  barriers[0].dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_SHADER_READ_BIT;
+  std::swap(barriers[0].oldLayout, barriers[0].newLayout);
+
+  barriers[1].srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+  barriers[1].dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+  barriers[1].oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+  barriers[1].newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+
+  DoPipelineBarrier(cmd, 2, barriers);
+
+  m_OverlayCache.push_back(cached);
+  m_OverlayCacheSize += cached.Size;
+}
+
+void VulkanReplay::ClearOverlayCache(uint32_t fromEventId)
+{
+  if(m_OverlayCache.empty())
+    return;
+
+  m_pDriver->FlushQ();
+
+  for(int32_t i = m_OverlayCache.count() - 1; i >= 0; i--)
+  {
+    CachedOverlay &cached = m_OverlayCache[i];
+
+    if(cached.key.eventId < fromEventId)
+      continue;
+
+    m_pDriver->vkDestroyImage(m_Device, cached.Image, NULL);
+    m_pDriver->vkFreeMemory(m_Device, cached.Mem, NULL);
+
+    m_OverlayCacheSize -= cached.Size;
+    m_OverlayCache.erase(i);
+  }
+}
@@ -163,7 +163,7 @@ private:
   {
     const VulkanCreationInfo::ShaderModule &moduleInfo =
         m_pDriver->GetDebugManager()->GetShaderInfo(shaderId);
-    rdcarray<uint32_t> modSpirv = moduleInfo.spirv.GetSPIRV();
+    rdcarray<uint32_t> modSpirv = moduleInfo.GetSPIRV().GetSPIRV();
     rdcspv::Editor editor(modSpirv);
     editor.Prepare();
 
@@ -52,6 +52,10 @@ void WrappedVulkan::AddRequiredExtensions(bool instance, rdcarray<rdcstr> &exten
 {
   bool device = !instance;
 
+  // in headless replay we don't enable any WSI, so the replay never touches presentation
+  if(RenderDoc::Inst().GetGlobalEnvironment().headless)
+    return;
+
 // check if our compile-time options expect any WSI to be available, or if it's all disabled
 #define EXPECT_WSI 0
 
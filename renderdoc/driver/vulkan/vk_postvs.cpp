@@ -1211,11 +1211,11 @@ static void ConvertToMeshOutputCompute(const ShaderReflection &refl, const SPIRV
   }
 }
 
-void VulkanReplay::ClearPostVSCache()
+void VulkanReplay::ClearPostVSCache(uint32_t fromEventId)
 {
   VkDevice dev = m_Device;
 
-  for(auto it = m_PostVS.Data.begin(); it != m_PostVS.Data.end(); ++it)
+  for(auto it = m_PostVS.Data.lower_bound(fromEventId); it != m_PostVS.Data.end(); ++it)
   {
     if(it->second.vsout.idxbuf != VK_NULL_HANDLE)
     {
@@ -1232,7 +1232,47 @@ void VulkanReplay::ClearPostVSCache()
     }
   }
 
-  m_PostVS.Data.clear();
+  m_PostVS.Data.erase(m_PostVS.Data.lower_bound(fromEventId), m_PostVS.Data.end());
+
+  for(auto it = m_PostVS.Alias.begin(); it != m_PostVS.Alias.end();)
+  {
+    if(it->first >= fromEventId || it->second >= fromEventId)
+      it = m_PostVS.Alias.erase(it);
+    else
+      ++it;
+  }
+
+  // the patched modules are built from the current shader code, so they must go whenever a
+  // replacement changes it
+  for(auto it = m_PostVS.PatchedModules.begin(); it != m_PostVS.PatchedModules.end(); ++it)
+    m_pDriver->vkDestroyShaderModule(dev, it->second.module, NULL);
+
+  m_PostVS.PatchedModules.clear();
+}
+
+uint64_t VulkanReplay::GetPostVSCacheSize()
+{
+  VkDevice dev = m_Device;
+
+  uint64_t ret = 0;
+
+  for(auto it = m_PostVS.Data.begin(); it != m_PostVS.Data.end(); ++it)
+  {
+    VkBuffer bufs[] = {it->second.vsout.buf, it->second.vsout.idxbuf, it->second.gsout.buf,
+                       it->second.gsout.idxbuf};
+
+    for(VkBuffer buf : bufs)
+    {
+      if(buf == VK_NULL_HANDLE)
+        continue;
+
+      VkMemoryRequirements mrq = {};
+      m_pDriver->vkGetBufferMemoryRequirements(dev, buf, &mrq);
+      ret += mrq.size;
+    }
+  }
+
+  return ret;
 }
 
 void VulkanReplay::PatchReservedDescriptors(const VulkanStatePipeline &pipe,
@@ -1970,7 +2010,6 @@ void VulkanReplay::FetchVSOut(uint32_t eventId, VulkanRenderState &state)
   }
 
   uint32_t bufStride = 0;
-  rdcarray<uint32_t> modSpirv = moduleInfo.spirv.GetSPIRV();
 
   struct CompactedAttrBuffer
   {
@@ -2338,25 +2377,48 @@ void VulkanReplay::FetchVSOut(uint32_t eventId, VulkanRenderState &state)
     m_pDriver->vkUpdateDescriptorSets(dev, numWrites, descWrites, 0, NULL);
   }
 
-  ConvertToMeshOutputCompute(*refl, *pipeInfo.shaders[0].patchData,
-                             pipeInfo.shaders[0].entryPoint.c_str(), attrInstDivisor, drawcall,
-                             numVerts, numViews, modSpirv, bufStride);
+  // everything that ConvertToMeshOutputCompute bakes into the shader
+  VulkanPostVSPatchKey patchKey;
+  patchKey.module = pipeInfo.shaders[0].module;
+  patchKey.entryPoint = pipeInfo.shaders[0].entryPoint;
+  patchKey.kind = VulkanPostVSPatchKey::Kind::MeshOutputCompute;
+  patchKey.params.push_back(numVerts);
+  patchKey.params.push_back(numViews);
+  patchKey.params.push_back(drawcall->numInstances);
+  patchKey.params.push_back((drawcall->flags & DrawFlags::Indexed) ? 1U : 0U);
+  patchKey.params.push_back(drawcall->vertexOffset);
+  patchKey.params.push_back(uint32_t(drawcall->baseVertex));
+  patchKey.params.push_back(drawcall->instanceOffset);
+  patchKey.params.append(attrInstDivisor);
+
+  VulkanPostVSPatchedModule &patched = m_PostVS.PatchedModules[patchKey];
+
+  if(patched.module == VK_NULL_HANDLE)
+  {
+    rdcarray<uint32_t> modSpirv = moduleInfo.GetSPIRV().GetSPIRV();
+
+    ConvertToMeshOutputCompute(*refl, *pipeInfo.shaders[0].patchData,
+                               pipeInfo.shaders[0].entryPoint.c_str(), attrInstDivisor, drawcall,
+                               numVerts, numViews, modSpirv, patched.stride);
+
+    // create vertex shader with modified code
+    VkShaderModuleCreateInfo moduleCreateInfo = {
+        VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO, NULL,         0,
+        modSpirv.size() * sizeof(uint32_t),          &modSpirv[0],
+    };
+
+    vkr = m_pDriver->vkCreateShaderModule(dev, &moduleCreateInfo, NULL, &patched.module);
+    RDCASSERTEQUAL(vkr, VK_SUCCESS);
+  }
+
+  VkShaderModule module = patched.module;
+  bufStride = patched.stride;
 
   VkComputePipelineCreateInfo compPipeInfo = {VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO};
 
   // repoint pipeline layout
   compPipeInfo.layout = pipeLayout;
 
-  // create vertex shader with modified code
-  VkShaderModuleCreateInfo moduleCreateInfo = {
-      VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO, NULL,         0,
-      modSpirv.size() * sizeof(uint32_t),          &modSpirv[0],
-  };
-
-  VkShaderModule module;
-  vkr = m_pDriver->vkCreateShaderModule(dev, &moduleCreateInfo, NULL, &module);
-  RDCASSERTEQUAL(vkr, VK_SUCCESS);
-
   compPipeInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
   compPipeInfo.stage.module = module;
   compPipeInfo.stage.pName = PatchedMeshOutputEntryPoint;
@@ -2422,11 +2484,6 @@ void VulkanReplay::FetchVSOut(uint32_t eventId, VulkanRenderState &state)
     vkr = m_pDriver->vkCreateBuffer(dev, &bufInfo, NULL, &meshBuffer);
     RDCASSERTEQUAL(vkr, VK_SUCCESS);
 
-    bufInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
-
-    vkr = m_pDriver->vkCreateBuffer(dev, &bufInfo, NULL, &readbackBuffer);
-    RDCASSERTEQUAL(vkr, VK_SUCCESS);
-
     VkMemoryRequirements mrq = {0};
     m_pDriver->vkGetBufferMemoryRequirements(dev, meshBuffer, &mrq);
 
@@ -2448,6 +2505,14 @@ void VulkanReplay::FetchVSOut(uint32_t eventId, VulkanRenderState &state)
     vkr = m_pDriver->vkBindBufferMemory(dev, meshBuffer, meshMem, 0);
     RDCASSERTEQUAL(vkr, VK_SUCCESS);
 
+    // only the first instance's vertices are read back, to guess the projection below
+    VkBufferCreateInfo readbackInfo = bufInfo;
+    readbackInfo.size = RDCMIN(bufInfo.size, uint64_t(numVerts) * uint64_t(bufStride));
+    readbackInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+
+    vkr = m_pDriver->vkCreateBuffer(dev, &readbackInfo, NULL, &readbackBuffer);
+    RDCASSERTEQUAL(vkr, VK_SUCCESS);
+
     m_pDriver->vkGetBufferMemoryRequirements(dev, readbackBuffer, &mrq);
 
     allocInfo.memoryTypeIndex = m_pDriver->GetReadbackMemoryIndex(mrq.memoryTypeBits);
@@ -2526,7 +2591,7 @@ void VulkanReplay::FetchVSOut(uint32_t eventId, VulkanRenderState &state)
     DoPipelineBarrier(cmd, 1, &meshbufbarrier);
 
     VkBufferCopy bufcopy = {
-        0, 0, bufInfo.size,
+        0, 0, readbackInfo.size,
     };
 
     // copy to readback buffer
@@ -2542,18 +2607,102 @@ void VulkanReplay::FetchVSOut(uint32_t eventId, VulkanRenderState &state)
     vkr = ObjDisp(dev)->EndCommandBuffer(Unwrap(cmd));
     RDCASSERTEQUAL(vkr, VK_SUCCESS);
 
-    // submit & flush so that we don't have to keep pipeline around for a while
     m_pDriver->SubmitCmds();
-    m_pDriver->FlushQ();
   }
 
+  // everything used for the fetch must stay alive until it's finished on the GPU
+  VulkanPostVSFetch fetch;
+  fetch.eventId = eventId;
+  fetch.readbackBuffer = readbackBuffer;
+  fetch.readbackMem = readbackMem;
+  fetch.numVerts = numVerts;
+  fetch.stride = bufStride;
+  fetch.hasPosOut = refl->outputSignature[0].systemValue == ShaderBuiltin::Position;
+
   for(CompactedAttrBuffer attrBuf : vbuffers)
   {
-    m_pDriver->vkDestroyBufferView(dev, attrBuf.view, NULL);
-    m_pDriver->vkDestroyBuffer(dev, attrBuf.buf, NULL);
-    m_pDriver->vkFreeMemory(dev, attrBuf.mem, NULL);
+    if(attrBuf.buf == VK_NULL_HANDLE)
+      continue;
+
+    fetch.views.push_back(attrBuf.view);
+    fetch.buffers.push_back(attrBuf.buf);
+    fetch.memory.push_back(attrBuf.mem);
+  }
+
+  if(uniqIdxBuf != VK_NULL_HANDLE)
+  {
+    fetch.views.push_back(uniqIdxBufView);
+    fetch.buffers.push_back(uniqIdxBuf);
+    fetch.memory.push_back(uniqIdxBufMem);
   }
 
+  fetch.descpool = descpool;
+  fetch.descSets = descSets;
+  fetch.setLayouts = setLayouts;
+  fetch.pipeLayout = pipeLayout;
+  fetch.pipe = pipe;
+
+  // fill out m_PostVS.Data
+  m_PostVS.Data[eventId].vsin.topo = pipeCreateInfo.pInputAssemblyState->topology;
+  m_PostVS.Data[eventId].vsout.topo = pipeCreateInfo.pInputAssemblyState->topology;
+  m_PostVS.Data[eventId].vsout.buf = meshBuffer;
+  m_PostVS.Data[eventId].vsout.bufmem = meshMem;
+
+  m_PostVS.Data[eventId].vsout.baseVertex = 0;
+
+  m_PostVS.Data[eventId].vsout.numViews = numViews;
+
+  m_PostVS.Data[eventId].vsout.vertStride = bufStride;
+
+  m_PostVS.Data[eventId].vsout.useIndices = bool(drawcall->flags & DrawFlags::Indexed);
+  m_PostVS.Data[eventId].vsout.numVerts = drawcall->numIndices;
+
+  m_PostVS.Data[eventId].vsout.instStride = 0;
+  if(drawcall->flags & DrawFlags::Instanced)
+    m_PostVS.Data[eventId].vsout.instStride = uint32_t(bufSize / (drawcall->numInstances * numViews));
+
+  m_PostVS.Data[eventId].vsout.idxbuf = VK_NULL_HANDLE;
+  if(m_PostVS.Data[eventId].vsout.useIndices && state.ibuffer.buf != ResourceId())
+  {
+    VkIndexType type = VK_INDEX_TYPE_UINT16;
+    if(idxsize == 4)
+      type = VK_INDEX_TYPE_UINT32;
+    else if(idxsize == 1)
+      type = VK_INDEX_TYPE_UINT8_EXT;
+
+    m_PostVS.Data[eventId].vsout.idxbuf = rebasedIdxBuf;
+    m_PostVS.Data[eventId].vsout.idxbufmem = rebasedIdxBufMem;
+    m_PostVS.Data[eventId].vsout.idxFmt = type;
+  }
+
+  m_PostVS.Data[eventId].vsout.hasPosOut = fetch.hasPosOut;
+
+  // when fetching a whole pass the readback waits until the end, so the GPU isn't synchronised
+  // for every draw.
+  if(m_PostVS.Batching)
+  {
+    m_PostVS.Pending.push_back(fetch);
+
+    if(m_PostVS.Pending.size() >= PostVSMaxPendingFetches)
+      FlushPendingVSOut();
+  }
+  else
+  {
+    m_pDriver->FlushQ();
+
+    FinishVSOut(fetch);
+  }
+}
+
+void VulkanReplay::FinishVSOut(const VulkanPostVSFetch &fetch)
+{
+  VkResult vkr = VK_SUCCESS;
+  VkDevice dev = m_Device;
+
+  const uint32_t numVerts = fetch.numVerts;
+  const uint32_t bufStride = fetch.stride;
+  VkDeviceMemory readbackMem = fetch.readbackMem;
+
   // readback mesh data
   byte *byteData = NULL;
   vkr = m_pDriver->vkMapMemory(m_Device, readbackMem, 0, VK_WHOLE_SIZE, 0, (void **)&byteData);
@@ -2579,7 +2728,7 @@ void VulkanReplay::FetchVSOut(uint32_t eventId, VulkanRenderState &state)
   // and position is the first value
 
   for(uint32_t i = 1;
-      refl->outputSignature[0].systemValue == ShaderBuiltin::Position && i < numVerts; i++)
+      fetch.hasPosOut && i < numVerts; i++)
   {
     //////////////////////////////////////////////////////////////////////////////////
     // derive near/far, assuming a standard perspective matrix
@@ -2636,72 +2785,48 @@ void VulkanReplay::FetchVSOut(uint32_t eventId, VulkanRenderState &state)
 
   m_pDriver->vkUnmapMemory(m_Device, readbackMem);
 
+  m_PostVS.Data[fetch.eventId].vsout.nearPlane = nearp;
+  m_PostVS.Data[fetch.eventId].vsout.farPlane = farp;
+
   // clean up temporary memories
-  m_pDriver->vkDestroyBuffer(m_Device, readbackBuffer, NULL);
+  m_pDriver->vkDestroyBuffer(m_Device, fetch.readbackBuffer, NULL);
   m_pDriver->vkFreeMemory(m_Device, readbackMem, NULL);
 
-  if(uniqIdxBuf != VK_NULL_HANDLE)
-  {
-    m_pDriver->vkDestroyBuffer(m_Device, uniqIdxBuf, NULL);
-    m_pDriver->vkFreeMemory(m_Device, uniqIdxBufMem, NULL);
-    m_pDriver->vkDestroyBufferView(m_Device, uniqIdxBufView, NULL);
-  }
-
-  // fill out m_PostVS.Data
-  m_PostVS.Data[eventId].vsin.topo = pipeCreateInfo.pInputAssemblyState->topology;
-  m_PostVS.Data[eventId].vsout.topo = pipeCreateInfo.pInputAssemblyState->topology;
-  m_PostVS.Data[eventId].vsout.buf = meshBuffer;
-  m_PostVS.Data[eventId].vsout.bufmem = meshMem;
-
-  m_PostVS.Data[eventId].vsout.baseVertex = 0;
-
-  m_PostVS.Data[eventId].vsout.numViews = numViews;
-
-  m_PostVS.Data[eventId].vsout.vertStride = bufStride;
-  m_PostVS.Data[eventId].vsout.nearPlane = nearp;
-  m_PostVS.Data[eventId].vsout.farPlane = farp;
-
-  m_PostVS.Data[eventId].vsout.useIndices = bool(drawcall->flags & DrawFlags::Indexed);
-  m_PostVS.Data[eventId].vsout.numVerts = drawcall->numIndices;
-
-  m_PostVS.Data[eventId].vsout.instStride = 0;
-  if(drawcall->flags & DrawFlags::Instanced)
-    m_PostVS.Data[eventId].vsout.instStride = uint32_t(bufSize / (drawcall->numInstances * numViews));
-
-  m_PostVS.Data[eventId].vsout.idxbuf = VK_NULL_HANDLE;
-  if(m_PostVS.Data[eventId].vsout.useIndices && state.ibuffer.buf != ResourceId())
+  for(size_t i = 0; i < fetch.buffers.size(); i++)
   {
-    VkIndexType type = VK_INDEX_TYPE_UINT16;
-    if(idxsize == 4)
-      type = VK_INDEX_TYPE_UINT32;
-    else if(idxsize == 1)
-      type = VK_INDEX_TYPE_UINT8_EXT;
-
-    m_PostVS.Data[eventId].vsout.idxbuf = rebasedIdxBuf;
-    m_PostVS.Data[eventId].vsout.idxbufmem = rebasedIdxBufMem;
-    m_PostVS.Data[eventId].vsout.idxFmt = type;
+    m_pDriver->vkDestroyBufferView(dev, fetch.views[i], NULL);
+    m_pDriver->vkDestroyBuffer(dev, fetch.buffers[i], NULL);
+    m_pDriver->vkFreeMemory(dev, fetch.memory[i], NULL);
   }
 
-  m_PostVS.Data[eventId].vsout.hasPosOut =
-      refl->outputSignature[0].systemValue == ShaderBuiltin::Position;
-
   // delete descriptors. Technically we don't have to free the descriptor sets, but our tracking on
   // replay doesn't handle destroying children of pooled objects so we do it explicitly anyway.
-  m_pDriver->vkFreeDescriptorSets(dev, descpool, (uint32_t)descSets.size(), descSets.data());
+  m_pDriver->vkFreeDescriptorSets(dev, fetch.descpool, (uint32_t)fetch.descSets.size(),
+                                  fetch.descSets.data());
 
   // delete pipeline layout
-  m_pDriver->vkDestroyPipelineLayout(dev, pipeLayout, NULL);
+  m_pDriver->vkDestroyPipelineLayout(dev, fetch.pipeLayout, NULL);
 
-  m_pDriver->vkDestroyDescriptorPool(dev, descpool, NULL);
+  m_pDriver->vkDestroyDescriptorPool(dev, fetch.descpool, NULL);
 
-  for(VkDescriptorSetLayout layout : setLayouts)
+  for(VkDescriptorSetLayout layout : fetch.setLayouts)
     m_pDriver->vkDestroyDescriptorSetLayout(dev, layout, NULL);
 
-  // delete pipeline
-  m_pDriver->vkDestroyPipeline(dev, pipe, NULL);
+  // delete pipeline. The shader module is cached in m_PostVS.PatchedModules
+  m_pDriver->vkDestroyPipeline(dev, fetch.pipe, NULL);
+}
+
+void VulkanReplay::FlushPendingVSOut()
+{
+  if(m_PostVS.Pending.empty())
+    return;
+
+  m_pDriver->FlushQ();
 
-  // delete shader/shader module
-  m_pDriver->vkDestroyShaderModule(dev, module, NULL);
+  for(const VulkanPostVSFetch &fetch : m_PostVS.Pending)
+    FinishVSOut(fetch);
+
+  m_PostVS.Pending.clear();
 }
 
 void VulkanReplay::FetchTessGSOut(uint32_t eventId, VulkanRenderState &state)
@@ -2801,26 +2926,37 @@ void VulkanReplay::FetchTessGSOut(uint32_t eventId, VulkanRenderState &state)
   const VulkanCreationInfo::ShaderModule &moduleInfo =
       creationInfo.m_ShaderModule[pipeInfo.shaders[stageIndex].module];
 
-  rdcarray<uint32_t> modSpirv = moduleInfo.spirv.GetSPIRV();
+  VkResult vkr = VK_SUCCESS;
+  VkDevice dev = m_Device;
 
-  uint32_t xfbStride = 0;
+  // the XFB annotations don't depend on the draw, so the module is shared by every draw using it
+  VulkanPostVSPatchKey patchKey;
+  patchKey.module = pipeInfo.shaders[stageIndex].module;
+  patchKey.entryPoint = pipeInfo.shaders[stageIndex].entryPoint;
+  patchKey.kind = VulkanPostVSPatchKey::Kind::XFBAnnotations;
 
-  // adds XFB annotations in order of the output signature (with the position first)
-  AddXFBAnnotations(*lastRefl, *pipeInfo.shaders[stageIndex].patchData,
-                    pipeInfo.shaders[stageIndex].entryPoint.c_str(), modSpirv, xfbStride);
+  VulkanPostVSPatchedModule &patched = m_PostVS.PatchedModules[patchKey];
 
-  // create vertex shader with modified code
-  VkShaderModuleCreateInfo moduleCreateInfo = {
-      VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO, NULL,         0,
-      modSpirv.size() * sizeof(uint32_t),          &modSpirv[0],
-  };
+  if(patched.module == VK_NULL_HANDLE)
+  {
+    rdcarray<uint32_t> modSpirv = moduleInfo.GetSPIRV().GetSPIRV();
 
-  VkResult vkr = VK_SUCCESS;
-  VkDevice dev = m_Device;
+    // adds XFB annotations in order of the output signature (with the position first)
+    AddXFBAnnotations(*lastRefl, *pipeInfo.shaders[stageIndex].patchData,
+                      pipeInfo.shaders[stageIndex].entryPoint.c_str(), modSpirv, patched.stride);
 
-  VkShaderModule module;
-  vkr = m_pDriver->vkCreateShaderModule(dev, &moduleCreateInfo, NULL, &module);
-  RDCASSERTEQUAL(vkr, VK_SUCCESS);
+    // create vertex shader with modified code
+    VkShaderModuleCreateInfo moduleCreateInfo = {
+        VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO, NULL,         0,
+        modSpirv.size() * sizeof(uint32_t),          &modSpirv[0],
+    };
+
+    vkr = m_pDriver->vkCreateShaderModule(dev, &moduleCreateInfo, NULL, &patched.module);
+    RDCASSERTEQUAL(vkr, VK_SUCCESS);
+  }
+
+  VkShaderModule module = patched.module;
+  uint32_t xfbStride = patched.stride;
 
   VkGraphicsPipelineCreateInfo pipeCreateInfo;
 
@@ -2961,9 +3097,6 @@ void VulkanReplay::FetchTessGSOut(uint32_t eventId, VulkanRenderState &state)
 
       // delete pipeline
       m_pDriver->vkDestroyPipeline(dev, pipe, NULL);
-
-      // delete shader/shader module
-      m_pDriver->vkDestroyShaderModule(dev, module, NULL);
       return;
     }
 
@@ -3243,9 +3376,6 @@ void VulkanReplay::FetchTessGSOut(uint32_t eventId, VulkanRenderState &state)
 
   // delete pipeline
   m_pDriver->vkDestroyPipeline(dev, pipe, NULL);
-
-  // delete shader/shader module
-  m_pDriver->vkDestroyShaderModule(dev, module, NULL);
 }
 
 void VulkanReplay::InitPostVSBuffers(uint32_t eventId, VulkanRenderState &state)
@@ -3336,12 +3466,21 @@ void VulkanReplay::InitPostVSBuffers(const rdcarray<uint32_t> &events)
   // command buffer
   m_pDriver->ReplayLog(0, events.front(), eReplay_WithoutDraw);
 
-  VulkanInitPostVSCallback cb(m_pDriver, events);
+  m_PostVS.Batching = true;
+
+  {
+    VulkanInitPostVSCallback cb(m_pDriver, events);
+
+    // now we replay the events, which are guaranteed (because we generated them in
+    // GetPassEvents above) to come from the same command buffer, so the event IDs are
+    // still locally continuous, even if we jump into replaying.
+    m_pDriver->ReplayLog(events.front(), events.back(), eReplay_Full);
+  }
+
+  m_PostVS.Batching = false;
 
-  // now we replay the events, which are guaranteed (because we generated them in
-  // GetPassEvents above) to come from the same command buffer, so the event IDs are
-  // still locally continuous, even if we jump into replaying.
-  m_pDriver->ReplayLog(events.front(), events.back(), eReplay_Full);
+  // read back all the draws' outputs together
+  FlushPendingVSOut();
 }
 
 MeshFormat VulkanReplay::GetPostVSBuffers(uint32_t eventId, uint32_t instID, uint32_t viewID,
@@ -453,26 +453,46 @@ void VulkanReplay::RenderMesh(uint32_t eventId, const rdcarray<MeshFormat> &seco
   {
     size_t mapsUsed = 0;
 
+    // secondary draws only differ in their colour as far as the UBO is concerned, and there are
+    // only a couple of colours in use (other draws in the pass, other instances). Only map a new
+    // UBO when the colour changes, and only rebind state that changed, so that showing a whole
+    // pass of thousands of draws doesn't need a map (and regular flushes) for each one.
+    FloatVector boundColor;
+    uint32_t uboOffs = 0;
+    bool uboValid = false;
+    VkPipeline boundPipe = VK_NULL_HANDLE;
+    VkBuffer boundVB = VK_NULL_HANDLE;
+    VkDeviceSize boundVBOffs = 0;
+    VkBuffer boundIB = VK_NULL_HANDLE;
+    VkDeviceSize boundIBOffs = 0;
+    VkIndexType boundIdxType = VK_INDEX_TYPE_MAX_ENUM;
+
     for(size_t i = 0; i < secondaryDraws.size(); i++)
     {
       const MeshFormat &fmt = secondaryDraws[i];
 
       if(fmt.vertexResourceId != ResourceId())
       {
-        // TODO should move the color to a push constant so we don't have to map all the time
-        uint32_t uboOffs = 0;
-        MeshUBOData *data = (MeshUBOData *)m_MeshRender.UBO.Map(&uboOffs);
+        if(!uboValid || fmt.meshColor != boundColor)
+        {
+          MeshUBOData *data = (MeshUBOData *)m_MeshRender.UBO.Map(&uboOffs);
 
-        data->mvp = ModelViewProj;
-        data->color = Vec4f(fmt.meshColor.x, fmt.meshColor.y, fmt.meshColor.z, fmt.meshColor.w);
-        data->homogenousInput = cfg.position.unproject;
-        data->pointSpriteSize = Vec2f(0.0f, 0.0f);
-        data->displayFormat = MESHDISPLAY_SOLID;
-        data->rawoutput = 0;
+          data->mvp = ModelViewProj;
+          data->color = Vec4f(fmt.meshColor.x, fmt.meshColor.y, fmt.meshColor.z, fmt.meshColor.w);
+          data->homogenousInput = cfg.position.unproject;
+          data->pointSpriteSize = Vec2f(0.0f, 0.0f);
+          data->displayFormat = MESHDISPLAY_SOLID;
+          data->rawoutput = 0;
 
-        m_MeshRender.UBO.Unmap();
+          m_MeshRender.UBO.Unmap();
 
-        mapsUsed++;
+          mapsUsed++;
+          uboValid = true;
+          boundColor = fmt.meshColor;
+
+          // the descriptor set needs rebinding with the new dynamic offset
+          boundPipe = VK_NULL_HANDLE;
+        }
 
         if(mapsUsed + 1 >= m_MeshRender.UBO.GetRingCount())
         {
@@ -494,23 +514,39 @@ void VulkanReplay::RenderMesh(uint32_t eventId, const rdcarray<MeshFormat> &seco
           vt->CmdBeginRenderPass(Unwrap(cmd), &rpbegin, VK_SUBPASS_CONTENTS_INLINE);
 
           vt->CmdSetViewport(Unwrap(cmd), 0, 1, &viewport);
+
+          // the UBO contents are still valid, but everything needs to be bound again on the new
+          // command buffer
+          boundPipe = VK_NULL_HANDLE;
+          boundVB = boundIB = VK_NULL_HANDLE;
         }
 
         MeshDisplayPipelines secondaryCache = GetDebugManager()->CacheMeshDisplayPipelines(
             m_MeshRender.PipeLayout, secondaryDraws[i], secondaryDraws[i]);
 
-        vt->CmdBindDescriptorSets(Unwrap(cmd), VK_PIPELINE_BIND_POINT_GRAPHICS,
-                                  Unwrap(m_MeshRender.PipeLayout), 0, 1,
-                                  UnwrapPtr(m_MeshRender.DescSet), 1, &uboOffs);
+        VkPipeline pipe = secondaryCache.pipes[MeshDisplayPipelines::ePipe_WireDepth];
 
-        vt->CmdBindPipeline(Unwrap(cmd), VK_PIPELINE_BIND_POINT_GRAPHICS,
-                            Unwrap(secondaryCache.pipes[MeshDisplayPipelines::ePipe_WireDepth]));
+        if(pipe != boundPipe)
+        {
+          vt->CmdBindDescriptorSets(Unwrap(cmd), VK_PIPELINE_BIND_POINT_GRAPHICS,
+                                    Unwrap(m_MeshRender.PipeLayout), 0, 1,
+                                    UnwrapPtr(m_MeshRender.DescSet), 1, &uboOffs);
+
+          vt->CmdBindPipeline(Unwrap(cmd), VK_PIPELINE_BIND_POINT_GRAPHICS, Unwrap(pipe));
+
+          boundPipe = pipe;
+        }
 
         VkBuffer vb =
             m_pDriver->GetResourceManager()->GetCurrentHandle<VkBuffer>(fmt.vertexResourceId);
 
         VkDeviceSize offs = fmt.vertexByteOffset;
-        vt->CmdBindVertexBuffers(Unwrap(cmd), 0, 1, UnwrapPtr(vb), &offs);
+        if(vb != boundVB || offs != boundVBOffs)
+        {
+          vt->CmdBindVertexBuffers(Unwrap(cmd), 0, 1, UnwrapPtr(vb), &offs);
+          boundVB = vb;
+          boundVBOffs = offs;
+        }
 
         if(fmt.indexByteStride)
         {
@@ -525,7 +561,13 @@ void VulkanReplay::RenderMesh(uint32_t eventId, const rdcarray<MeshFormat> &seco
             VkBuffer ib =
                 m_pDriver->GetResourceManager()->GetLiveHandle<VkBuffer>(fmt.indexResourceId);
 
-            vt->CmdBindIndexBuffer(Unwrap(cmd), Unwrap(ib), fmt.indexByteOffset, idxtype);
+            if(ib != boundIB || fmt.indexByteOffset != boundIBOffs || idxtype != boundIdxType)
+            {
+              vt->CmdBindIndexBuffer(Unwrap(cmd), Unwrap(ib), fmt.indexByteOffset, idxtype);
+              boundIB = ib;
+              boundIBOffs = fmt.indexByteOffset;
+              boundIdxType = idxtype;
+            }
           }
           vt->CmdDrawIndexed(Unwrap(cmd), fmt.numIndices, 1, 0, fmt.baseVertex, 0);
         }
@@ -176,6 +176,46 @@ rdcarray<GPUDevice> VulkanReplay::GetAvailableGPUs()
   return ret;
 }
 
+rdcarray<MemoryUsage> VulkanReplay::GetMemoryUsage()
+{
+  uint64_t reflectionSize = 0;
+  for(auto it = m_pDriver->m_CreationInfo.m_ShaderModule.begin();
+      it != m_pDriver->m_CreationInfo.m_ShaderModule.end(); ++it)
+  {
+    for(auto &refl : it->second.m_Reflections)
+      reflectionSize += EstimateReflectionSize(refl.second.refl) + refl.second.disassembly.size();
+  }
+
+  uint64_t readbackSize = 0;
+  for(const TextureReadback::Slot &s : m_TexReadback.Slots)
+    readbackSize += s.size;
+
+  rdcarray<MemoryUsage> ret;
+  ret.push_back(MemoryUsage(MemoryCategory::InitialContents, 0,
+                            m_pDriver->GetAllocatedMemorySize(MemoryScope::InitialContents)));
+  ret.push_back(MemoryUsage(MemoryCategory::PostVSCache, 0, GetPostVSCacheSize()));
+  ret.push_back(
+      MemoryUsage(MemoryCategory::ShaderCache, m_pDriver->GetShaderCache()->GetMemoryUsage(), 0));
+  // the cache is limited by the serialised size of the command buffers, which is what we report
+  // in lieu of the driver's command buffer memory
+  ret.push_back(MemoryUsage(MemoryCategory::RerecordCache, 0, m_pDriver->GetRerecordCacheSize()));
+  ret.push_back(MemoryUsage(MemoryCategory::TextureReadback, 0, readbackSize));
+  ret.push_back(MemoryUsage(MemoryCategory::ShaderReflection, reflectionSize, 0));
+  return ret;
+}
+
+void VulkanReplay::EvictCache(MemoryCategory category)
+{
+  switch(category)
+  {
+    case MemoryCategory::PostVSCache: ClearPostVSCache(); break;
+    case MemoryCategory::ShaderCache: m_pDriver->GetShaderCache()->EvictCachedData(); break;
+    case MemoryCategory::RerecordCache: m_pDriver->EvictRerecordCache(); break;
+    case MemoryCategory::TextureReadback: m_TexReadback.Destroy(m_pDriver); break;
+    default: break;
+  }
+}
+
 APIProperties VulkanReplay::GetAPIProperties()
 {
   APIProperties ret = m_pDriver->APIProps;
@@ -202,7 +242,7 @@ ReplayStatus VulkanReplay::ReadLogInitialisation(RDCFile *rdc, bool storeStructu
 
 void VulkanReplay::ReplayLog(uint32_t endEventID, ReplayLogType replayType)
 {
-  m_pDriver->ReplayLog(0, endEventID, replayType);
+  m_pDriver->ReplayToEvent(endEventID, replayType);
 }
 
 const SDFile &VulkanReplay::GetStructuredFile()
@@ -415,12 +455,12 @@ rdcarray<ShaderEntryPoint> VulkanReplay::GetShaderEntryPoints(ResourceId shader)
   if(shad == m_pDriver->m_CreationInfo.m_ShaderModule.end())
     return {};
 
-  rdcarray<rdcstr> entries = shad->second.spirv.EntryPoints();
+  rdcarray<rdcstr> entries = shad->second.GetSPIRV().EntryPoints();
 
   rdcarray<ShaderEntryPoint> ret;
 
   for(const rdcstr &e : entries)
-    ret.push_back({e, shad->second.spirv.StageForEntry(e)});
+    ret.push_back({e, shad->second.GetSPIRV().StageForEntry(e)});
 
   return ret;
 }
@@ -439,8 +479,8 @@ ShaderReflection *VulkanReplay::GetShader(ResourceId pipeline, ResourceId shader
   // if this shader was never used in a pipeline the reflection won't be prepared. Do that now -
   // this will be ignored if it was already prepared.
   shad->second.GetReflection(entry.name, pipeline)
-      .Init(GetResourceManager(), shader, shad->second.spirv, entry.name,
-            VkShaderStageFlagBits(1 << uint32_t(entry.stage)), {});
+      .Init(GetResourceManager(), shader, shad->second, entry.name,
+            VkShaderStageFlagBits(1 << uint32_t(entry.stage)), {}, NULL);
 
   return &shad->second.GetReflection(entry.name, pipeline).refl;
 }
@@ -550,7 +590,7 @@ rdcstr VulkanReplay::DisassembleShader(ResourceId pipeline, const ShaderReflecti
   {
     VulkanCreationInfo::ShaderModuleReflection &moduleRefl =
         it->second.GetReflection(refl->entryPoint, pipeline);
-    moduleRefl.PopulateDisassembly(it->second.spirv);
+    moduleRefl.PopulateDisassembly(it->second.GetSPIRV(), m_pDriver->GetShaderCache());
 
     return moduleRefl.disassembly;
   }
@@ -1026,6 +1066,16 @@ void VulkanReplay::SavePipelineState(uint32_t eventId)
 
   VkMarkerRegion::End();
 
+  // hold onto the descriptor sets converted for the previous event. Any set whose contents and
+  // usage haven't changed since then can be moved across below instead of being converted again,
+  // which saves walking every element of large descriptor arrays on each event change.
+  rdcarray<VKPipe::DescriptorSet> prevDescSets[2];
+  rdcarray<uint64_t> prevDescSetHashes[2];
+  prevDescSets[0].swap(m_VulkanPipelineState.graphics.descriptorSets);
+  prevDescSets[1].swap(m_VulkanPipelineState.compute.descriptorSets);
+  prevDescSetHashes[0].swap(m_DescriptorSetHashes[0]);
+  prevDescSetHashes[1].swap(m_DescriptorSetHashes[1]);
+
   m_VulkanPipelineState = VKPipe::State();
 
   m_VulkanPipelineState.pushconsts.resize(state.pushConstSize);
@@ -1526,6 +1576,8 @@ void VulkanReplay::SavePipelineState(uint32_t eventId)
   // Descriptor sets
   m_VulkanPipelineState.graphics.descriptorSets.resize(state.graphics.descSets.size());
   m_VulkanPipelineState.compute.descriptorSets.resize(state.compute.descSets.size());
+  m_DescriptorSetHashes[0].fill(state.graphics.descSets.size(), 0);
+  m_DescriptorSetHashes[1].fill(state.compute.descSets.size(), 0);
 
   {
     rdcarray<VKPipe::DescriptorSet> *dsts[] = {
@@ -1578,7 +1630,66 @@ void VulkanReplay::SavePipelineState(uint32_t eventId)
 
         curBind.set = (uint32_t)i;
 
-        ResourceId layoutId = m_pDriver->m_DescriptorSetState[src].layout;
+        const WrappedVulkan::DescriptorSetInfo &setInfo = m_pDriver->m_DescriptorSetState[src];
+        ResourceId layoutId = setInfo.layout;
+        const DescSetLayout &setLayout = c.m_DescSetLayout[layoutId];
+
+        // any used binds from earlier sets can't match anything in this one, skip past them and
+        // find the range that belongs to this set.
+        while(usedBindsSize && usedBindsData->set < curBind.set)
+        {
+          usedBindsData++;
+          usedBindsSize--;
+        }
+
+        size_t setUsedBindsSize = 0;
+        while(setUsedBindsSize < usedBindsSize &&
+              usedBindsData[setUsedBindsSize].set == curBind.set)
+          setUsedBindsSize++;
+
+        // the converted set depends only on the set and its layout, the dynamic usage within it,
+        // and the current descriptor contents (including dynamic offsets). Creation info and
+        // original IDs are fixed for the whole replay.
+        uint64_t hash = ShaderCacheHash(&src, sizeof(src), 0);
+        hash = ShaderCacheHash(&layoutId, sizeof(layoutId), hash);
+        hash = ShaderCacheHash(&hasUsedBinds, sizeof(hasUsedBinds), hash);
+        hash = ShaderCacheHash(usedBindsData, sizeof(BindIdx) * setUsedBindsSize, hash);
+        for(size_t b = 0; b < setInfo.currentBindings.size() && b < setLayout.bindings.size(); b++)
+          hash = ShaderCacheHash(setInfo.currentBindings[b],
+                                 sizeof(DescriptorSetSlot) * setLayout.bindings[b].descriptorCount,
+                                 hash);
+
+        // 0 marks an unused or already consumed entry
+        if(hash == 0)
+          hash = 1;
+
+        m_DescriptorSetHashes[p][i] = hash;
+
+        bool reused = false;
+        for(size_t pp = 0; pp < ARRAY_COUNT(prevDescSets) && !reused; pp++)
+        {
+          for(size_t pi = 0; pi < prevDescSetHashes[pp].size(); pi++)
+          {
+            if(prevDescSetHashes[pp][pi] == hash)
+            {
+              VKPipe::DescriptorSet &prev = prevDescSets[pp][pi];
+              dst.layoutResourceId = prev.layoutResourceId;
+              dst.descriptorSetResourceId = prev.descriptorSetResourceId;
+              dst.pushDescriptor = prev.pushDescriptor;
+              dst.bindings.swap(prev.bindings);
+              prevDescSetHashes[pp][pi] = 0;
+              reused = true;
+              break;
+            }
+          }
+        }
+
+        if(reused)
+        {
+          usedBindsData += setUsedBindsSize;
+          usedBindsSize -= setUsedBindsSize;
+          continue;
+        }
 
         // push descriptors don't have a real descriptor set backing them
         if(c.m_DescSetLayout[layoutId].flags & VK_DESCRIPTOR_SET_LAYOUT_CREATE_PUSH_DESCRIPTOR_BIT_KHR)
@@ -1936,7 +2047,8 @@ void VulkanReplay::FillCBufferVariables(ResourceId pipeline, ResourceId shader,
 
   if(c.bufferBacked)
   {
-    StandardFillCBufferVariables(refl.resourceId, c.variables, outvars, data);
+    m_CBufferLayouts.Fill(pipeline, shader, entryPoint, cbufSlot, refl.resourceId, c.variables,
+                          outvars, data);
   }
   else
   {
@@ -1958,7 +2070,8 @@ void VulkanReplay::FillCBufferVariables(ResourceId pipeline, ResourceId shader,
       bytebuf pushdata;
       pushdata.resize(sizeof(m_pDriver->m_RenderState.pushconsts));
       memcpy(&pushdata[0], m_pDriver->m_RenderState.pushconsts, pushdata.size());
-      StandardFillCBufferVariables(refl.resourceId, c.variables, outvars, pushdata);
+      m_CBufferLayouts.Fill(pipeline, shader, entryPoint, cbufSlot, refl.resourceId, c.variables,
+                            outvars, pushdata);
     }
   }
 }
@@ -2169,8 +2282,42 @@ bool VulkanReplay::GetMinMax(ResourceId texid, const Subresource &sub, CompType
   return GetMinMax(texid, sub, typeCast, false, minval, maxval);
 }
 
+bool VulkanReplay::GetMinMaxHistogram(ResourceId texid, const Subresource &sub, CompType typeCast,
+                                      float histMin, float histMax, bool channels[4],
+                                      float *minval, float *maxval, rdcarray<uint32_t> &histogram)
+{
+  VkFormat format = VK_FORMAT_UNDEFINED;
+  {
+    LockedConstImageStateRef state = m_pDriver->FindConstImageState(texid);
+    if(!state)
+      return false;
+    format = state->GetImageInfo().format;
+  }
+
+  // depth/stencil takes two passes to get the min/max and a stencil histogram is rescaled, so
+  // those don't share a pass.
+  const bool stencilHistogram =
+      IsStencilFormat(format) && !channels[0] && channels[1] && !channels[2] && !channels[3];
+
+  if(!IsDepthAndStencilFormat(format) && !stencilHistogram && histMin < histMax)
+  {
+    uint32_t chans = 0;
+    for(uint32_t c = 0; c < 4; c++)
+      chans |= channels[c] ? (1U << c) : 0U;
+
+    // same delta as GetHistogram, so that values equal to histMax land in the last bucket
+    if(GetMinMax(texid, sub, typeCast, false, minval, maxval, histMin, histMax + histMax * 1e-6f,
+                 chans, &histogram))
+      return true;
+  }
+
+  return IReplayDriver::GetMinMaxHistogram(texid, sub, typeCast, histMin, histMax, channels,
+                                           minval, maxval, histogram);
+}
+
 bool VulkanReplay::GetMinMax(ResourceId texid, const Subresource &sub, CompType typeCast,
-                             bool stencil, float *minval, float *maxval)
+                             bool stencil, float *minval, float *maxval, float histMin,
+                             float histMax, uint32_t histChannels, rdcarray<uint32_t> *histogram)
 {
   VkDevice dev = m_pDriver->GetDev();
   const VkDevDispatchTable *vt = ObjDisp(dev);
@@ -2247,14 +2394,31 @@ bool VulkanReplay::GetMinMax(ResourceId texid, const Subresource &sub, CompType
 
   descSetBinding += textype;
 
-  if(m_Histogram.m_MinMaxTilePipe[textype][intTypeIndex] == VK_NULL_HANDLE)
+  VkPipeline tilePipe = histogram ? m_Histogram.m_MinMaxHistogramPipe[textype][intTypeIndex]
+                                  : m_Histogram.m_MinMaxTilePipe[textype][intTypeIndex];
+  VkPipeline resultPipe = m_Histogram.m_MinMaxResultPipe[intTypeIndex];
+
+  // the subgroup tile pass leaves one entry per block instead of one per tile, so it's only used
+  // when the matching result pass is available too
+  VkPipeline subgroupTilePipe =
+      histogram ? m_Histogram.m_SubgroupMinMaxHistogramPipe[textype][intTypeIndex]
+                : m_Histogram.m_SubgroupMinMaxTilePipe[textype][intTypeIndex];
+  if(subgroupTilePipe != VK_NULL_HANDLE &&
+     m_Histogram.m_SubgroupMinMaxResultPipe[intTypeIndex] != VK_NULL_HANDLE)
+  {
+    tilePipe = subgroupTilePipe;
+    resultPipe = m_Histogram.m_SubgroupMinMaxResultPipe[intTypeIndex];
+  }
+
+  if(tilePipe == VK_NULL_HANDLE || resultPipe == VK_NULL_HANDLE)
     return false;
 
-  VkDescriptorBufferInfo bufdescs[3];
+  VkDescriptorBufferInfo bufdescs[4];
   RDCEraseEl(bufdescs);
   m_Histogram.m_MinMaxTileResult.FillDescriptor(bufdescs[0]);
   m_Histogram.m_MinMaxResult.FillDescriptor(bufdescs[1]);
   m_Histogram.m_HistogramUBO.FillDescriptor(bufdescs[2]);
+  m_Histogram.m_HistogramBuf.FillDescriptor(bufdescs[3]);
 
   VkDescriptorImageInfo altimdesc[2] = {};
   for(uint32_t i = 1; i < GetYUVPlaneCount(texviews.castedFormat); i++)
@@ -2275,8 +2439,8 @@ bool VulkanReplay::GetMinMax(ResourceId texid, const Subresource &sub, CompType
       },
       {
           VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET, NULL, Unwrap(m_Histogram.m_HistogramDescSet[0]),
-          1, 0, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, NULL, &bufdescs[0],
-          NULL    // source = unused, bind tile result
+          1, 0, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, NULL, histogram ? &bufdescs[3] : &bufdescs[0],
+          NULL    // histogram result if needed, otherwise unused so bind tile result
       },
       {VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET, NULL, Unwrap(m_Histogram.m_HistogramDescSet[0]), 2,
        0, 1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, NULL, &bufdescs[2], NULL},
@@ -2349,9 +2513,10 @@ bool VulkanReplay::GetMinMax(ResourceId texid, const Subresource &sub, CompType
   data->HistogramSample = (int)RDCCLAMP(sub.sample, 0U, uint32_t(iminfo.samples) - 1);
   if(sub.sample == ~0U)
     data->HistogramSample = -iminfo.samples;
-  data->HistogramMin = 0.0f;
-  data->HistogramMax = 1.0f;
-  data->HistogramChannels = 0xf;
+  data->HistogramMin = histMin;
+  data->HistogramMax = histMax;
+  data->HistogramChannels = histogram ? histChannels : 0xf;
+  data->HistogramFlags = 0;
 
   Vec4u YUVDownsampleRate = {};
   Vec4u YUVAChannels = {};
@@ -2377,12 +2542,35 @@ bool VulkanReplay::GetMinMax(ResourceId texid, const Subresource &sub, CompType
   m_pDriver->InlineSetupImageBarriers(cmd, setupBarriers);
   m_pDriver->SubmitAndFlushImageStateBarriers(setupBarriers);
 
-  int blocksX = (int)ceil(iminfo.extent.width / float(HGRAM_PIXELS_PER_TILE * HGRAM_TILES_PER_BLOCK));
-  int blocksY =
-      (int)ceil(iminfo.extent.height / float(HGRAM_PIXELS_PER_TILE * HGRAM_TILES_PER_BLOCK));
+  // match the block count the shaders calculate from the mip's resolution, any extra blocks would
+  // alias the tile results of the next row
+  int blocksX = (int)ceil(RDCMAX(uint32_t(iminfo.extent.width) >> sub.mip, 1U) /
+                          float(HGRAM_PIXELS_PER_TILE * HGRAM_TILES_PER_BLOCK));
+  int blocksY = (int)ceil(RDCMAX(uint32_t(iminfo.extent.height) >> sub.mip, 1U) /
+                          float(HGRAM_PIXELS_PER_TILE * HGRAM_TILES_PER_BLOCK));
 
-  vt->CmdBindPipeline(Unwrap(cmd), VK_PIPELINE_BIND_POINT_COMPUTE,
-                      Unwrap(m_Histogram.m_MinMaxTilePipe[textype][intTypeIndex]));
+  VkBufferMemoryBarrier histbarrier = {
+      VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+      NULL,
+      VK_ACCESS_TRANSFER_WRITE_BIT,
+      VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+      VK_QUEUE_FAMILY_IGNORED,
+      VK_QUEUE_FAMILY_IGNORED,
+      Unwrap(m_Histogram.m_HistogramBuf.buf),
+      0,
+      m_Histogram.m_HistogramBuf.totalsize,
+  };
+
+  if(histogram)
+  {
+    vt->CmdFillBuffer(Unwrap(cmd), Unwrap(m_Histogram.m_HistogramBuf.buf), 0,
+                      m_Histogram.m_HistogramBuf.totalsize, 0);
+
+    // ensure the clear completes before the tile pass adds to the buckets
+    DoPipelineBarrier(cmd, 1, &histbarrier);
+  }
+
+  vt->CmdBindPipeline(Unwrap(cmd), VK_PIPELINE_BIND_POINT_COMPUTE, Unwrap(tilePipe));
   vt->CmdBindDescriptorSets(Unwrap(cmd), VK_PIPELINE_BIND_POINT_COMPUTE,
                             Unwrap(m_Histogram.m_HistogramPipeLayout), 0, 1,
                             UnwrapPtr(m_Histogram.m_HistogramDescSet[0]), 0, NULL);
@@ -2415,8 +2603,7 @@ bool VulkanReplay::GetMinMax(ResourceId texid, const Subresource &sub, CompType
   // ensure shader writes complete before coalescing the tiles
   DoPipelineBarrier(cmd, 1, &tilebarrier);
 
-  vt->CmdBindPipeline(Unwrap(cmd), VK_PIPELINE_BIND_POINT_COMPUTE,
-                      Unwrap(m_Histogram.m_MinMaxResultPipe[intTypeIndex]));
+  vt->CmdBindPipeline(Unwrap(cmd), VK_PIPELINE_BIND_POINT_COMPUTE, Unwrap(resultPipe));
   vt->CmdBindDescriptorSets(Unwrap(cmd), VK_PIPELINE_BIND_POINT_COMPUTE,
                             Unwrap(m_Histogram.m_HistogramPipeLayout), 0, 1,
                             UnwrapPtr(m_Histogram.m_HistogramDescSet[1]), 0, NULL);
@@ -2446,12 +2633,42 @@ bool VulkanReplay::GetMinMax(ResourceId texid, const Subresource &sub, CompType
 
   DoPipelineBarrier(cmd, 1, &tilebarrier);
 
+  if(histogram)
+  {
+    // the tile pass wrote the buckets, which the barrier above doesn't cover
+    histbarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    histbarrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+
+    DoPipelineBarrier(cmd, 1, &histbarrier);
+
+    bufcopy.size = m_Histogram.m_HistogramBuf.totalsize;
+
+    vt->CmdCopyBuffer(Unwrap(cmd), Unwrap(m_Histogram.m_HistogramBuf.buf),
+                      Unwrap(m_Histogram.m_HistogramReadback.buf), 1, &bufcopy);
+
+    histbarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    histbarrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+    histbarrier.buffer = Unwrap(m_Histogram.m_HistogramReadback.buf);
+    histbarrier.size = m_Histogram.m_HistogramReadback.totalsize;
+
+    DoPipelineBarrier(cmd, 1, &histbarrier);
+  }
+
   vt->EndCommandBuffer(Unwrap(cmd));
 
   // submit cmds and wait for idle so we can readback
   m_pDriver->SubmitCmds();
   m_pDriver->FlushQ();
 
+  if(histogram)
+  {
+    uint32_t *buckets = (uint32_t *)m_Histogram.m_HistogramReadback.Map(NULL);
+
+    histogram->assign(buckets, HGRAM_NUM_BUCKETS);
+
+    m_Histogram.m_HistogramReadback.Unmap();
+  }
+
   Vec4f *minmax = (Vec4f *)m_Histogram.m_MinMaxReadback.Map(NULL);
 
   minval[0] = minmax[0].x;
@@ -2767,6 +2984,357 @@ rdcarray<EventUsage> VulkanReplay::GetUsage(ResourceId id)
   return m_pDriver->GetUsage(id);
 }
 
+bool VulkanReplay::GetTextureReadbackBuffer(VkDeviceSize size, VkBuffer &buf, VkDeviceMemory &mem)
+{
+  VkDevice dev = m_pDriver->GetDev();
+  const VkDevDispatchTable *vt = ObjDisp(dev);
+
+  VkResult vkr = VK_SUCCESS;
+
+  TextureReadback::Slot *slot = NULL;
+
+  if(size <= TexReadbackMaxPooledSize)
+  {
+    m_TexReadback.Tick++;
+
+    // prefer the smallest existing buffer that fits
+    for(TextureReadback::Slot &s : m_TexReadback.Slots)
+    {
+      if(s.buf != VK_NULL_HANDLE && s.size >= size && (slot == NULL || s.size < slot->size))
+        slot = &s;
+    }
+
+    if(slot)
+    {
+      slot->lastUsed = m_TexReadback.Tick;
+      buf = slot->buf;
+      mem = slot->mem;
+      return true;
+    }
+
+    // otherwise replace the least recently used slot. Unused slots have lastUsed of 0
+    slot = &m_TexReadback.Slots[0];
+    for(TextureReadback::Slot &s : m_TexReadback.Slots)
+    {
+      if(s.lastUsed < slot->lastUsed)
+        slot = &s;
+    }
+
+    vt->DestroyBuffer(Unwrap(dev), slot->buf, NULL);
+    vt->FreeMemory(Unwrap(dev), slot->mem, NULL);
+
+    // round up so that slightly different sizes (e.g. neighbouring mips) share a buffer
+    const VkDeviceSize maxSize = TexReadbackMaxPooledSize;
+    size = RDCMIN(AlignUp(size, (VkDeviceSize)1024 * 1024), maxSize);
+  }
+
+  VkBufferCreateInfo bufInfo = {
+      VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+      NULL,
+      0,
+      size,
+      // storage usage so the compute remap can write into it directly
+      VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT |
+          VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+  };
+
+  buf = VK_NULL_HANDLE;
+  vkr = vt->CreateBuffer(Unwrap(dev), &bufInfo, NULL, &buf);
+  RDCASSERTEQUAL(vkr, VK_SUCCESS);
+
+  VkMemoryRequirements mrq = {0};
+
+  vt->GetBufferMemoryRequirements(Unwrap(dev), buf, &mrq);
+
+  VkMemoryAllocateInfo allocInfo = {
+      VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO, NULL, mrq.size,
+      m_pDriver->GetReadbackMemoryIndex(mrq.memoryTypeBits),
+  };
+
+  mem = VK_NULL_HANDLE;
+  vkr = vt->AllocateMemory(Unwrap(dev), &allocInfo, NULL, &mem);
+  RDCASSERTEQUAL(vkr, VK_SUCCESS);
+
+  vkr = vt->BindBufferMemory(Unwrap(dev), buf, mem, 0);
+  RDCASSERTEQUAL(vkr, VK_SUCCESS);
+
+  if(slot == NULL)
+    return false;
+
+  slot->buf = buf;
+  slot->mem = mem;
+  slot->size = size;
+  slot->lastUsed = m_TexReadback.Tick;
+
+  return true;
+}
+
+bool VulkanReplay::RemapTextureDataCompute(ResourceId tex, const Subresource &sub,
+                                           const GetTextureDataParams &params, bytebuf &data)
+{
+  const VulkanCreationInfo::Image &iminfo = m_pDriver->m_CreationInfo.m_Image[tex];
+
+  // depth/stencil and MSAA images need the special handling in the render path
+  if(FormatImageAspects(iminfo.format) != VK_IMAGE_ASPECT_COLOR_BIT ||
+     iminfo.samples != VK_SAMPLE_COUNT_1_BIT)
+    return false;
+
+  VkFormat outFormat = VK_FORMAT_UNDEFINED;
+  uint32_t mode = TEXREMAP_RGBA8;
+  uint32_t texelSize = 4;
+
+  if(params.remap == RemapTexture::RGBA8)
+  {
+    outFormat = IsSRGBFormat(iminfo.format) ? VK_FORMAT_R8G8B8A8_SRGB : VK_FORMAT_R8G8B8A8_UNORM;
+  }
+  else if(params.remap == RemapTexture::RGBA16)
+  {
+    outFormat = VK_FORMAT_R16G16B16A16_SFLOAT;
+    mode = TEXREMAP_RGBA16;
+    texelSize = 8;
+  }
+  else if(params.remap == RemapTexture::RGBA32)
+  {
+    outFormat = VK_FORMAT_R32G32B32A32_SFLOAT;
+    mode = TEXREMAP_RGBA32;
+    texelSize = 16;
+  }
+  else
+  {
+    return false;
+  }
+
+  if(params.typeCast != CompType::Typeless)
+    outFormat = GetViewCastedFormat(outFormat, params.typeCast);
+
+  // integer or normalised casts of the output aren't packed by the shader
+  if(outFormat != VK_FORMAT_R8G8B8A8_UNORM && outFormat != VK_FORMAT_R8G8B8A8_SRGB &&
+     outFormat != VK_FORMAT_R16G16B16A16_SFLOAT && outFormat != VK_FORMAT_R32G32B32A32_SFLOAT)
+    return false;
+
+  if(IsSRGBFormat(outFormat))
+    mode = TEXREMAP_RGBA8_SRGB;
+
+  int textype = RESTYPE_TEX2D;
+  if(iminfo.type == VK_IMAGE_TYPE_1D)
+    textype = RESTYPE_TEX1D;
+  else if(iminfo.type == VK_IMAGE_TYPE_3D)
+    textype = RESTYPE_TEX3D;
+
+  VkDevice dev = m_pDriver->GetDev();
+  const VkDevDispatchTable *vt = ObjDisp(dev);
+
+  LockedConstImageStateRef state = m_pDriver->FindConstImageState(tex);
+  if(!state || !state->isMemoryBound)
+    return false;
+
+  TextureDisplayViews &texviews = m_TexRender.TextureViews[tex];
+  VkImage liveIm = m_pDriver->GetResourceManager()->GetCurrentHandle<VkImage>(tex);
+
+  CreateTexImageView(liveIm, iminfo, params.typeCast, texviews);
+
+  uint32_t descSetBinding = 5;
+  uint32_t intTypeIndex = 0;
+
+  if(IsUIntFormat(texviews.castedFormat))
+  {
+    descSetBinding = 10;
+    intTypeIndex = 1;
+  }
+  else if(IsSIntFormat(texviews.castedFormat))
+  {
+    descSetBinding = 15;
+    intTypeIndex = 2;
+  }
+
+  descSetBinding += textype;
+
+  VkPipeline pipe = m_Histogram.m_TexRemapPipe[textype][intTypeIndex];
+  if(pipe == VK_NULL_HANDLE || texviews.views[0] == VK_NULL_HANDLE)
+    return false;
+
+  const uint32_t width = RDCMAX(1U, iminfo.extent.width >> sub.mip);
+  const uint32_t height = RDCMAX(1U, iminfo.extent.height >> sub.mip);
+  const uint32_t depth = RDCMAX(1U, iminfo.extent.depth >> sub.mip);
+
+  const uint32_t dataSize = width * height * depth * texelSize;
+
+  VkBuffer readbackBuf = VK_NULL_HANDLE;
+  VkDeviceMemory readbackMem = VK_NULL_HANDLE;
+
+  bool pooledReadback = GetTextureReadbackBuffer(dataSize, readbackBuf, readbackMem);
+
+  VkDescriptorImageInfo imdesc = {0};
+  imdesc.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+  imdesc.imageView = Unwrap(texviews.views[0]);
+  imdesc.sampler = Unwrap(m_General.PointSampler);
+
+  VkDescriptorBufferInfo bufdescs[2];
+  RDCEraseEl(bufdescs);
+  bufdescs[0].buffer = readbackBuf;
+  bufdescs[0].offset = 0;
+  bufdescs[0].range = dataSize;
+  m_Histogram.m_HistogramUBO.FillDescriptor(bufdescs[1]);
+
+  VkDescriptorImageInfo altimdesc[2] = {};
+  for(uint32_t i = 1; i < GetYUVPlaneCount(texviews.castedFormat); i++)
+  {
+    RDCASSERT(texviews.views[i] != VK_NULL_HANDLE);
+    altimdesc[i - 1].imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    altimdesc[i - 1].imageView = Unwrap(texviews.views[i]);
+    altimdesc[i - 1].sampler = Unwrap(m_General.PointSampler);
+  }
+
+  VkDescriptorSet descSet = Unwrap(m_Histogram.m_HistogramDescSet[0]);
+
+  VkWriteDescriptorSet writeSet[] = {
+      // destination = readback buffer, source is unused so bind it again
+      {VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET, NULL, descSet, 0, 0, 1,
+       VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, NULL, &bufdescs[0], NULL},
+      {VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET, NULL, descSet, 1, 0, 1,
+       VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, NULL, &bufdescs[0], NULL},
+      {VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET, NULL, descSet, 2, 0, 1,
+       VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, NULL, &bufdescs[1], NULL},
+
+      // sampled view
+      {VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET, NULL, descSet, descSetBinding, 0, 1,
+       VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, &imdesc, NULL, NULL},
+      // YUV secondary planes (if needed)
+      {VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET, NULL, descSet, 10, 0,
+       GetYUVPlaneCount(texviews.castedFormat) - 1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+       altimdesc, NULL, NULL},
+  };
+
+  rdcarray<VkWriteDescriptorSet> writeSets;
+  for(size_t i = 0; i < ARRAY_COUNT(writeSet); i++)
+  {
+    if(writeSet[i].descriptorCount > 0)
+      writeSets.push_back(writeSet[i]);
+  }
+
+  for(size_t i = 0; i < ARRAY_COUNT(m_TexRender.DummyWrites); i++)
+  {
+    VkWriteDescriptorSet &write = m_TexRender.DummyWrites[i];
+
+    if(write.dstBinding == descSetBinding)
+      continue;
+
+    if(write.dstBinding == 10)
+    {
+      if(write.dstArrayElement == 0 && GetYUVPlaneCount(texviews.castedFormat) >= 2)
+        continue;
+      if(write.dstArrayElement == 1 && GetYUVPlaneCount(texviews.castedFormat) >= 3)
+        continue;
+    }
+
+    write.dstSet = descSet;
+    writeSets.push_back(write);
+  }
+
+  vt->UpdateDescriptorSets(Unwrap(dev), (uint32_t)writeSets.size(), &writeSets[0], 0, NULL);
+
+  HistogramUBOData *ubo = (HistogramUBOData *)m_Histogram.m_HistogramUBO.Map(NULL);
+
+  ubo->HistogramTextureResolution.x = (float)width;
+  ubo->HistogramTextureResolution.y = (float)height;
+  ubo->HistogramTextureResolution.z = (float)depth;
+  ubo->HistogramSlice = (float)RDCCLAMP(sub.slice, 0U, (uint32_t)iminfo.arrayLayers - 1) + 0.001f;
+  ubo->HistogramMip = (int)sub.mip;
+  ubo->HistogramNumSamples = 1;
+  ubo->HistogramSample = 0;
+  ubo->HistogramMin = params.blackPoint;
+  ubo->HistogramMax = params.whitePoint;
+  ubo->HistogramChannels = 0xf;
+  ubo->HistogramFlags = mode;
+
+  Vec4u YUVDownsampleRate = {};
+  Vec4u YUVAChannels = {};
+
+  GetYUVShaderParameters(texviews.castedFormat, YUVDownsampleRate, YUVAChannels);
+
+  ubo->HistogramYUVDownsampleRate = YUVDownsampleRate;
+  ubo->HistogramYUVAChannels = YUVAChannels;
+
+  m_Histogram.m_HistogramUBO.Unmap();
+
+  VkCommandBufferBeginInfo beginInfo = {VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO, NULL,
+                                        VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT};
+
+  VkCommandBuffer cmd = m_pDriver->GetNextCmd();
+
+  VkResult vkr = vt->BeginCommandBuffer(Unwrap(cmd), &beginInfo);
+  RDCASSERTEQUAL(vkr, VK_SUCCESS);
+
+  ImageBarrierSequence setupBarriers, cleanupBarriers;
+  state->TempTransition(m_pDriver->m_QueueFamilyIdx, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                        VK_ACCESS_SHADER_READ_BIT, setupBarriers, cleanupBarriers,
+                        m_pDriver->GetImageTransitionInfo());
+  m_pDriver->InlineSetupImageBarriers(cmd, setupBarriers);
+  m_pDriver->SubmitAndFlushImageStateBarriers(setupBarriers);
+
+  vt->CmdBindPipeline(Unwrap(cmd), VK_PIPELINE_BIND_POINT_COMPUTE, Unwrap(pipe));
+  vt->CmdBindDescriptorSets(Unwrap(cmd), VK_PIPELINE_BIND_POINT_COMPUTE,
+                            Unwrap(m_Histogram.m_HistogramPipeLayout), 0, 1,
+                            UnwrapPtr(m_Histogram.m_HistogramDescSet[0]), 0, NULL);
+
+  // every depth slice of a 3D texture is written in this one dispatch
+  vt->CmdDispatch(Unwrap(cmd), (width + TEXREMAP_GROUP_SIZE - 1) / TEXREMAP_GROUP_SIZE,
+                  (height + TEXREMAP_GROUP_SIZE - 1) / TEXREMAP_GROUP_SIZE, depth);
+
+  VkBufferMemoryBarrier bufBarrier = {
+      VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+      NULL,
+      VK_ACCESS_SHADER_WRITE_BIT,
+      VK_ACCESS_HOST_READ_BIT,
+      VK_QUEUE_FAMILY_IGNORED,
+      VK_QUEUE_FAMILY_IGNORED,
+      readbackBuf,
+      0,
+      dataSize,
+  };
+
+  // wait for the shader writes to finish before reading back to host
+  DoPipelineBarrier(cmd, 1, &bufBarrier);
+
+  m_pDriver->InlineCleanupImageBarriers(cmd, cleanupBarriers);
+
+  vkr = vt->EndCommandBuffer(Unwrap(cmd));
+  RDCASSERTEQUAL(vkr, VK_SUCCESS);
+
+  m_pDriver->SubmitCmds();
+  m_pDriver->FlushQ();
+
+  if(!cleanupBarriers.empty())
+    m_pDriver->SubmitAndFlushImageStateBarriers(cleanupBarriers);
+
+  byte *pData = NULL;
+  vkr = vt->MapMemory(Unwrap(dev), readbackMem, 0, VK_WHOLE_SIZE, 0, (void **)&pData);
+  RDCASSERTEQUAL(vkr, VK_SUCCESS);
+
+  VkMappedMemoryRange range = {
+      VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE, NULL, readbackMem, 0, VK_WHOLE_SIZE,
+  };
+
+  vkr = vt->InvalidateMappedMemoryRanges(Unwrap(dev), 1, &range);
+  RDCASSERTEQUAL(vkr, VK_SUCCESS);
+
+  RDCASSERT(pData != NULL);
+
+  data.resize(dataSize);
+  if(pData)
+    memcpy(data.data(), pData, dataSize);
+
+  vt->UnmapMemory(Unwrap(dev), readbackMem);
+
+  if(!pooledReadback)
+  {
+    vt->DestroyBuffer(Unwrap(dev), readbackBuf, NULL);
+    vt->FreeMemory(Unwrap(dev), readbackMem, NULL);
+  }
+
+  return true;
+}
+
 void VulkanReplay::GetTextureData(ResourceId tex, const Subresource &sub,
                                   const GetTextureDataParams &params, bytebuf &data)
 {
@@ -2779,6 +3347,11 @@ void VulkanReplay::GetTextureData(ResourceId tex, const Subresource &sub,
     return;
   }
 
+  // colour remaps decode with a single compute dispatch straight into the readback buffer,
+  // rather than rendering each slice to a temporary image and copying it out
+  if(params.remap != RemapTexture::NoRemap && RemapTextureDataCompute(tex, sub, params, data))
+    return;
+
   const VulkanCreationInfo::Image &imInfo = m_pDriver->m_CreationInfo.m_Image[tex];
 
   LockedConstImageStateRef lockedImage = m_pDriver->FindConstImageState(tex);
@@ -3358,33 +3931,9 @@ void VulkanReplay::GetTextureData(ResourceId tex, const Subresource &sub,
                             VK_FORMAT_S8_UINT, s.mip);
   }
 
-  VkBufferCreateInfo bufInfo = {
-      VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
-      NULL,
-      0,
-      dataSize,
-      VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-  };
-
   VkBuffer readbackBuf = VK_NULL_HANDLE;
-  vkr = vt->CreateBuffer(Unwrap(dev), &bufInfo, NULL, &readbackBuf);
-  RDCASSERTEQUAL(vkr, VK_SUCCESS);
-
-  VkMemoryRequirements mrq = {0};
-
-  vt->GetBufferMemoryRequirements(Unwrap(dev), readbackBuf, &mrq);
-
-  VkMemoryAllocateInfo allocInfo = {
-      VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO, NULL, dataSize,
-      m_pDriver->GetReadbackMemoryIndex(mrq.memoryTypeBits),
-  };
-
   VkDeviceMemory readbackMem = VK_NULL_HANDLE;
-  vkr = vt->AllocateMemory(Unwrap(dev), &allocInfo, NULL, &readbackMem);
-  RDCASSERTEQUAL(vkr, VK_SUCCESS);
-
-  vkr = vt->BindBufferMemory(Unwrap(dev), readbackBuf, readbackMem, 0);
-  RDCASSERTEQUAL(vkr, VK_SUCCESS);
+  bool pooledReadback = GetTextureReadbackBuffer(dataSize, readbackBuf, readbackMem);
 
   if(isDepth && isStencil)
   {
@@ -3574,8 +4123,11 @@ void VulkanReplay::GetTextureData(ResourceId tex, const Subresource &sub,
   vt->UnmapMemory(Unwrap(dev), readbackMem);
 
   // clean up temporary objects
-  vt->DestroyBuffer(Unwrap(dev), readbackBuf, NULL);
-  vt->FreeMemory(Unwrap(dev), readbackMem, NULL);
+  if(!pooledReadback)
+  {
+    vt->DestroyBuffer(Unwrap(dev), readbackBuf, NULL);
+    vt->FreeMemory(Unwrap(dev), readbackMem, NULL);
+  }
 
   if(tmpImage != VK_NULL_HANDLE)
   {
@@ -3702,12 +4254,10 @@ void VulkanReplay::BuildTargetShader(ShaderEncoding sourceEncoding, const bytebu
         return;
     }
 
-    rdcarray<rdcstr> sources;
-    sources.push_back(rdcstr((char *)source.begin(), source.size()));
-
     rdcspv::CompilationSettings settings(rdcspv::InputLanguage::VulkanGLSL, stage);
 
-    rdcstr output = rdcspv::Compile(settings, sources, spirv);
+    rdcstr output = m_pDriver->GetShaderCache()->GetUserSPIRVBlob(
+        settings, rdcstr((char *)source.begin(), source.size()), spirv);
 
     if(spirv.empty())
     {
@@ -3753,8 +4303,7 @@ void VulkanReplay::ReplaceResource(ResourceId from, ResourceId to)
   // now update any derived resources
   RefreshDerivedReplacements();
 
-  ClearPostVSCache();
-  ClearFeedbackCache();
+  InvalidateReplacedResults(from);
 }
 
 void VulkanReplay::RemoveReplacement(ResourceId id)
@@ -3765,9 +4314,28 @@ void VulkanReplay::RemoveReplacement(ResourceId id)
 
     RefreshDerivedReplacements();
 
-    ClearPostVSCache();
-    ClearFeedbackCache();
+    InvalidateReplacedResults(id);
+  }
+}
+
+void VulkanReplay::InvalidateReplacedResults(ResourceId id)
+{
+  // replay results from the first use of the resource onwards may differ, anything cached for
+  // earlier events is still valid. That includes checkpoints, so the next replay can resume from
+  // the last one before the edited shader is used instead of from the start of the frame.
+  uint32_t firstUse = m_pDriver->GetFirstUseEvent(id);
+
+  if(firstUse != ~0U)
+  {
+    ClearPostVSCache(firstUse);
+    ClearFeedbackCache(firstUse);
+    ClearOverlayCache(firstUse);
+
+    m_pDriver->FreeReplayCheckpointsFrom(firstUse);
   }
+
+  // cached command buffers aren't tracked by event and may have the old pipelines baked in
+  m_pDriver->FreeRerecordCache();
 }
 
 void VulkanReplay::RefreshDerivedReplacements()
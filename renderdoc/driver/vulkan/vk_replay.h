@@ -197,6 +197,64 @@ struct VulkanPostVSData
   }
 };
 
+// identifies a patched copy of a shader module used to fetch post-transform data. Patches can bake
+// draw parameters into the SPIR-V, so any that a patch kind depends on are listed in params.
+// Specialization constants aren't part of the key, they're applied when creating the pipeline.
+struct VulkanPostVSPatchKey
+{
+  enum class Kind : uint32_t
+  {
+    MeshOutputCompute,
+    XFBAnnotations,
+  };
+
+  ResourceId module;
+  rdcstr entryPoint;
+  Kind kind;
+  rdcarray<uint32_t> params;
+
+  bool operator<(const VulkanPostVSPatchKey &o) const
+  {
+    if(module != o.module)
+      return module < o.module;
+    if(entryPoint != o.entryPoint)
+      return entryPoint < o.entryPoint;
+    if(kind != o.kind)
+      return kind < o.kind;
+    return params < o.params;
+  }
+};
+
+struct VulkanPostVSPatchedModule
+{
+  VkShaderModule module = VK_NULL_HANDLE;
+  // the output stride calculated while patching
+  uint32_t stride = 0;
+};
+
+// the part of a vertex output fetch that waits on the GPU - reading back the positions to guess
+// the projection, and destroying the temporary objects used to run the fetch.
+struct VulkanPostVSFetch
+{
+  uint32_t eventId = 0;
+
+  VkBuffer readbackBuffer = VK_NULL_HANDLE;
+  VkDeviceMemory readbackMem = VK_NULL_HANDLE;
+  uint32_t numVerts = 0;
+  uint32_t stride = 0;
+  bool hasPosOut = false;
+
+  rdcarray<VkBufferView> views;
+  rdcarray<VkBuffer> buffers;
+  rdcarray<VkDeviceMemory> memory;
+
+  VkDescriptorPool descpool = VK_NULL_HANDLE;
+  rdcarray<VkDescriptorSet> descSets;
+  rdcarray<VkDescriptorSetLayout> setLayouts;
+  VkPipelineLayout pipeLayout = VK_NULL_HANDLE;
+  VkPipeline pipe = VK_NULL_HANDLE;
+};
+
 struct BindIdx
 {
   uint32_t set, bind, arrayidx;
@@ -251,6 +309,7 @@ public:
   void SetRGP(AMDRGPControl *rgp) { m_RGP = rgp; }
   void SetProxy(bool p) { m_Proxy = p; }
   bool IsRemoteProxy() { return m_Proxy; }
+  void FetchStructuredChunks(const rdcarray<uint32_t> &chunkIndices) {}
   void Shutdown();
 
   void CreateResources();
@@ -258,6 +317,8 @@ public:
 
   DriverInformation GetDriverInfo() { return m_DriverInfo; }
   rdcarray<GPUDevice> GetAvailableGPUs();
+  rdcarray<MemoryUsage> GetMemoryUsage();
+  void EvictCache(MemoryCategory category);
   APIProperties GetAPIProperties();
 
   ResourceDescription &GetResourceDesc(ResourceId id);
@@ -321,6 +382,9 @@ public:
                  float *maxval);
   bool GetHistogram(ResourceId texid, const Subresource &sub, CompType typeCast, float minval,
                     float maxval, bool channels[4], rdcarray<uint32_t> &histogram);
+  bool GetMinMaxHistogram(ResourceId texid, const Subresource &sub, CompType typeCast,
+                          float histMin, float histMax, bool channels[4], float *minval,
+                          float *maxval, rdcarray<uint32_t> &histogram);
 
   void InitPostVSBuffers(uint32_t eventId);
   void InitPostVSBuffers(uint32_t eventId, VulkanRenderState &state);
@@ -382,6 +446,7 @@ public:
   ResourceId RenderOverlay(ResourceId cfg, CompType typeCast, FloatVector clearCol,
                            DebugOverlay overlay, uint32_t eventId,
                            const rdcarray<uint32_t> &passEvents);
+  rdcarray<OverdrawStatistics> GetOverdrawStatistics() { return m_OverdrawStats; }
   ResourceId ApplyCustomShader(ResourceId shader, ResourceId texid, const Subresource &sub,
                                CompType typeCast);
 
@@ -414,7 +479,8 @@ public:
   AMDCounters *GetAMDCounters() { return m_pAMDCounters; }
 private:
   void FetchShaderFeedback(uint32_t eventId);
-  void ClearFeedbackCache();
+  bool CollectShaderFeedback(uint32_t eventId);
+  void ClearFeedbackCache(uint32_t fromEventId = 0);
 
   void PatchReservedDescriptors(const VulkanStatePipeline &pipe, VkDescriptorPool &descpool,
                                 rdcarray<VkDescriptorSetLayout> &setLayouts,
@@ -424,16 +490,41 @@ private:
                                 size_t newBindingsCount);
 
   void FetchVSOut(uint32_t eventId, VulkanRenderState &state);
+  void FinishVSOut(const VulkanPostVSFetch &fetch);
+  void FlushPendingVSOut();
   void FetchTessGSOut(uint32_t eventId, VulkanRenderState &state);
-  void ClearPostVSCache();
+  void ClearPostVSCache(uint32_t fromEventId = 0);
+  uint64_t GetPostVSCacheSize();
+
+  struct OverlayCacheKey
+  {
+    ResourceId texid;
+    CompType typeCast;
+    FloatVector clearCol;
+    DebugOverlay overlay;
+    uint32_t eventId;
+
+    bool operator==(const OverlayCacheKey &o) const
+    {
+      return texid == o.texid && typeCast == o.typeCast && clearCol == o.clearCol &&
+             overlay == o.overlay && eventId == o.eventId;
+    }
+  };
+
+  bool FetchCachedOverlay(VkCommandBuffer cmd, const OverlayCacheKey &key);
+  void CacheOverlay(VkCommandBuffer cmd, const OverlayCacheKey &key, VkSampleCountFlagBits samples);
+  void ClearOverlayCache(uint32_t fromEventId = 0);
 
   void RefreshDerivedReplacements();
+  void InvalidateReplacedResults(ResourceId id);
 
   bool RenderTextureInternal(TextureDisplay cfg, const ImageState &imageState,
                              VkRenderPassBeginInfo rpbegin, int flags);
 
+  // if histogram is set, it's filled in over [histMin, histMax] from the same pass as the min/max
   bool GetMinMax(ResourceId texid, const Subresource &sub, CompType typeCast, bool stencil,
-                 float *minval, float *maxval);
+                 float *minval, float *maxval, float histMin = 0.0f, float histMax = 1.0f,
+                 uint32_t histChannels = 0, rdcarray<uint32_t> *histogram = NULL);
 
   VulkanDebugManager *GetDebugManager();
   VulkanResourceManager *GetResourceManager();
@@ -497,6 +588,8 @@ private:
 
   HighlightCache m_HighlightCache;
 
+  CBufferLayoutCache m_CBufferLayouts;
+
   bool m_Proxy;
 
   FrameRecord m_FrameRecord;
@@ -603,6 +696,25 @@ private:
     VkPipelineLayout m_TriSizePipeLayout = VK_NULL_HANDLE;
   } m_Overlay;
 
+  // copies of recently rendered overlays, so flipping back to an event doesn't re-run the overlay's
+  // replay passes. Least recently used first, and bounded by OverlayCacheBudget bytes.
+  struct CachedOverlay
+  {
+    OverlayCacheKey key;
+    VkImage Image = VK_NULL_HANDLE;
+    VkDeviceMemory Mem = VK_NULL_HANDLE;
+    VkDeviceSize Size = 0;
+    rdcarray<OverdrawStatistics> OverdrawStats;
+  };
+
+  static const VkDeviceSize OverlayCacheBudget = 256 * 1024 * 1024;
+
+  rdcarray<CachedOverlay> m_OverlayCache;
+  VkDeviceSize m_OverlayCacheSize = 0;
+
+  // per-draw costs from the last quad overdraw overlay, empty for any other overlay
+  rdcarray<OverdrawStatistics> m_OverdrawStats;
+
   struct MeshRendering
   {
     void Init(WrappedVulkan *driver, VkDescriptorPool descriptorPool);
@@ -650,6 +762,31 @@ private:
     VkRenderPass RP = VK_NULL_HANDLE;
   } m_PixelPick;
 
+  // staging buffers for GetTextureData kept between calls, so dumping many textures doesn't
+  // create and free a readback allocation every time.
+  struct TextureReadback
+  {
+    void Destroy(WrappedVulkan *driver);
+
+    struct Slot
+    {
+      VkBuffer buf = VK_NULL_HANDLE;
+      VkDeviceMemory mem = VK_NULL_HANDLE;
+      VkDeviceSize size = 0;
+      uint64_t lastUsed = 0;
+    };
+
+    Slot Slots[4];
+    uint64_t Tick = 0;
+  } m_TexReadback;
+
+  // readbacks larger than this get a temporary buffer rather than a pooled one
+  static const VkDeviceSize TexReadbackMaxPooledSize = 32 * 1024 * 1024;
+
+  bool GetTextureReadbackBuffer(VkDeviceSize size, VkBuffer &buf, VkDeviceMemory &mem);
+  bool RemapTextureDataCompute(ResourceId tex, const Subresource &sub,
+                               const GetTextureDataParams &params, bytebuf &data);
+
   struct HistogramMinMax
   {
     void Init(WrappedVulkan *driver, VkDescriptorPool descriptorPool);
@@ -670,8 +807,18 @@ private:
     // float, uint, sint for each of 1D, 2D, 3D, 2DMS
     VkPipeline m_HistogramPipe[5][3] = {{VK_NULL_HANDLE}};
     VkPipeline m_MinMaxTilePipe[5][3] = {{VK_NULL_HANDLE}};
+    // remap to RGBA for readback, shares the descriptor layout and UBO above
+    VkPipeline m_TexRemapPipe[5][3] = {{VK_NULL_HANDLE}};
     // float, uint, sint
     VkPipeline m_MinMaxResultPipe[3] = {VK_NULL_HANDLE};
+    // min/max tile pass that also fills out the histogram buffer, paired with m_MinMaxResultPipe
+    VkPipeline m_MinMaxHistogramPipe[5][3] = {{VK_NULL_HANDLE}};
+    // variants of the above that reduce each block to one entry with subgroup operations, only
+    // created when the device supports subgroup arithmetic in compute. These must be used together
+    // since the tile buffer layout is different.
+    VkPipeline m_SubgroupMinMaxTilePipe[5][3] = {{VK_NULL_HANDLE}};
+    VkPipeline m_SubgroupMinMaxHistogramPipe[5][3] = {{VK_NULL_HANDLE}};
+    VkPipeline m_SubgroupMinMaxResultPipe[3] = {VK_NULL_HANDLE};
   } m_Histogram;
 
   struct PostVS
@@ -683,8 +830,20 @@ private:
 
     std::map<uint32_t, VulkanPostVSData> Data;
     std::map<uint32_t, uint32_t> Alias;
+
+    // set while fetching every draw in a pass in one replay, the fetches then wait in Pending and
+    // are finished together.
+    bool Batching = false;
+    rdcarray<VulkanPostVSFetch> Pending;
+
+    // patched shader modules, shared between every fetch of draws that use the same shader with
+    // the same baked parameters. Released in ClearPostVSCache.
+    std::map<VulkanPostVSPatchKey, VulkanPostVSPatchedModule> PatchedModules;
   } m_PostVS;
 
+  // limit on how many fetches keep their temporary objects alive while batching
+  static const size_t PostVSMaxPendingFetches = 64;
+
   struct Feedback
   {
     void Destroy(WrappedVulkan *driver);
@@ -694,10 +853,15 @@ private:
     std::map<uint32_t, DynamicUsedBinds> Usage;
   } m_BindlessFeedback;
 
+  // limit on how many following draws have their feedback collected along with a requested one
+  static const size_t FeedbackMaxPrefetchEvents = 256;
+
   rdcarray<ResourceDescription> m_Resources;
   std::map<ResourceId, size_t> m_ResourceIdx;
 
   VKPipe::State m_VulkanPipelineState;
+  // hash of the inputs used to convert each of the graphics and compute descriptor sets above
+  rdcarray<uint64_t> m_DescriptorSetHashes[2];
 
   DriverInformation m_DriverInfo;
 
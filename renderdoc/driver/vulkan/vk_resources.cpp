@@ -23,6 +23,7 @@
  ******************************************************************************/
 
 #include "vk_resources.h"
+#include "common/shader_cache.h"
 #include "maths/vec.h"
 #include "vk_info.h"
 
@@ -3428,6 +3429,101 @@ VkResourceRecord::~VkResourceRecord()
 
   if(resType == eResDescUpdateTemplate)
     SAFE_DELETE(descTemplateInfo);
+
+  if(resType == eResShaderModule && shaderBlob)
+    shaderBlob->store->Release(shaderBlob, this);
+}
+
+ShaderModuleBlobStore::~ShaderModuleBlobStore()
+{
+  for(auto it = m_Blobs.begin(); it != m_Blobs.end(); ++it)
+    delete it->second;
+}
+
+ShaderModuleBlob *ShaderModuleBlobStore::Acquire(VkResourceRecord *record, const void *code,
+                                                 size_t size)
+{
+  uint64_t hash = ShaderCacheHash(code, size);
+
+  // 0 is reserved for code that's serialised inline
+  if(hash == 0)
+    return NULL;
+
+  SCOPED_LOCK(m_Lock);
+
+  ShaderModuleBlob *&blob = m_Blobs[hash];
+
+  if(blob == NULL)
+  {
+    blob = new ShaderModuleBlob;
+    blob->store = this;
+    blob->hash = hash;
+    blob->code.assign((const byte *)code, size);
+  }
+  else if(blob->code.size() != size || memcmp(blob->code.data(), code, size) != 0)
+  {
+    return NULL;
+  }
+
+  blob->users.push_back(record);
+
+  return blob;
+}
+
+void ShaderModuleBlobStore::Release(ShaderModuleBlob *blob, VkResourceRecord *record)
+{
+  SCOPED_LOCK(m_Lock);
+
+  blob->users.removeOne(record);
+
+  if(blob->users.empty())
+  {
+    m_Blobs.erase(blob->hash);
+    delete blob;
+  }
+}
+
+uint64_t ShaderModuleBlobStore::FindHash(const void *code, size_t size)
+{
+  uint64_t hash = ShaderCacheHash(code, size);
+
+  SCOPED_LOCK(m_Lock);
+
+  auto it = m_Blobs.find(hash);
+
+  if(it == m_Blobs.end() || it->second->code.size() != size ||
+     memcmp(it->second->code.data(), code, size) != 0)
+    return 0;
+
+  return hash;
+}
+
+void ShaderModuleBlobStore::WriteReferenced(StreamWriter *writer)
+{
+  SCOPED_LOCK(m_Lock);
+
+  rdcarray<ShaderModuleBlob *> written;
+
+  for(auto it = m_Blobs.begin(); it != m_Blobs.end(); ++it)
+  {
+    for(VkResourceRecord *record : it->second->users)
+    {
+      if(record->IsDataWritten())
+      {
+        written.push_back(it->second);
+        break;
+      }
+    }
+  }
+
+  writer->Write((uint64_t)written.size());
+
+  for(ShaderModuleBlob *blob : written)
+  {
+    writer->Write(blob->hash);
+    writer->Write((uint64_t)blob->code.size());
+    writer->Write(blob->code.data(), blob->code.size());
+  }
 }
 
 void VkResourceRecord::MarkImageFrameReferenced(VkResourceRecord *img, const ImageRange &range,
@@ -1031,6 +1031,10 @@ struct CmdBufferRecordingInfo
 
   std::map<ResourceId, MemRefs> memFrameRefs;
 
+  // the capture this buffer's references were last pulled into, when it's executed as a secondary.
+  // Lets a secondary that's executed many times in a frame be referenced and written only once.
+  volatile int32_t captureSerial = 0;
+
   // AdvanceFrame/Present should be called after this buffer is submitted
   bool present;
 };
@@ -1053,18 +1057,58 @@ struct DescriptorSetData
   // create from the layout.
   rdcarray<DescriptorSetSlot *> descBindings;
 
-  // lock protecting bindFrameRefs and bindMemRefs
+  // incremented whenever any binding in descBindings is updated. Updates only write the slots and
+  // bump this, the reference data below is derived from the slots on demand.
+  uint32_t bindGeneration = 1;
+
+  // as bindGeneration, but only incremented when a binding the GPU can write through (storage
+  // images and buffers) is updated.
+  uint32_t writableBindGeneration = 1;
+
+  // lock protecting the derived reference data below
   Threading::CriticalSection refLock;
 
-  // contains the framerefs (ref counted) for the bound resources
-  // in the binding slots. Updated when updating descriptor sets
-  // and then applied in a block on descriptor set bind.
-  // the refcount has the high-bit set if this resource has sparse
-  // mapping information
+  // called after updating bindings of the given reference type, invalidating the derived data
+  void BindingsUpdated(FrameRefType ref)
+  {
+    SCOPED_LOCK(refLock);
+    bindGeneration++;
+    if(ref != eFrameRef_Read)
+      writableBindGeneration++;
+  }
+
+  // contains the framerefs for the bound resources in the binding slots. Rebuilt from descBindings
+  // by VkResourceRecord::UpdateBindRefs when the set is used during an active capture and the
+  // bindings have changed since, then applied in a block on descriptor set bind.
+  // The count has the high-bit set if this resource has sparse mapping information
   static const uint32_t SPARSE_REF_BIT = 0x80000000;
-  std::map<ResourceId, rdcpair<uint32_t, FrameRefType> > bindFrameRefs;
+  uint32_t bindRefsGeneration = 0;
+  ResourceIdMap<rdcpair<uint32_t, FrameRefType> > bindFrameRefs;
   std::map<ResourceId, MemRefs> bindMemRefs;
   std::map<ResourceId, ImageState> bindImageStates;
+
+  // with WrappedVulkan::m_DeferDescriptorShadowing, journal of updates not yet applied to
+  // descBindings. deferredSlots holds each write's descriptors back to back, with only the fields
+  // the write sets filled in.
+  struct DeferredWrite
+  {
+    uint32_t binding;
+    uint32_t arrayElement;
+    uint32_t count;
+    VkDescriptorType type;
+    bool setSampler;
+    bool setImageView;
+  };
+  rdcarray<DeferredWrite> deferredWrites;
+  rdcarray<DescriptorSetSlot> deferredSlots;
+  // whether this set is in WrappedVulkan::m_DeferredDescriptorSets
+  bool deferredListed = false;
+
+  // the sorted, unique resources (images and memory) that could be written through this set.
+  // Rebuilt by VkResourceRecord::UpdateWrittenBindRefs, used to track dirty resources on submit
+  // whether or not we're capturing, without building the full reference data above.
+  uint32_t writtenRefsGeneration = 0;
+  rdcarray<ResourceId> writtenResources;
 };
 
 struct PipelineLayoutData
@@ -1080,6 +1124,7 @@ struct MemMapState
         needRefData(false),
         mapFlushed(false),
         mapCoherent(false),
+        writeWatched(false),
         mappedPtr(NULL),
         refData(NULL)
   {
@@ -1088,6 +1133,8 @@ struct MemMapState
   bool needRefData;
   bool mapFlushed;
   bool mapCoherent;
+  // the mapped pointer is write-protected with MemoryWatch, and refData isn't used
+  bool writeWatched;
   byte *mappedPtr;
   byte *refData;
 };
@@ -1552,6 +1599,8 @@ struct BarrierSequence
   rdcarray<Barrier> batches[MAX_BATCH_COUNT][MAX_QUEUE_FAMILY_COUNT];
   size_t barrierCount = 0;
   void AddWrapped(uint32_t batchIndex, uint32_t queueFamilyIndex, const Barrier &barrier);
+  // as AddWrapped, but extends the last barrier in the batch if this continues its array layers
+  void AddWrappedCoalesced(uint32_t batchIndex, uint32_t queueFamilyIndex, const Barrier &barrier);
   void Merge(const BarrierSequence<Barrier> &other);
   bool IsBatchEmpty(uint32_t batchIndex) const;
   void ExtractUnwrappedBatch(uint32_t batchIndex, uint32_t queueFamilyIndex,
@@ -1948,16 +1997,34 @@ FrameRefType ImgRefs::Merge(const ImgRefs &other, Compose comp)
   return maxRefType;
 }
 
+// memory can be referenced in thousands of small ranges, which are cheaper to walk and search in a
+// sorted array than in a node-based map
+typedef Intervals<FrameRefType, IntervalsVectorMap<FrameRefType>> FrameRefIntervals;
+
 struct MemRefs
 {
-  Intervals<FrameRefType> rangeRefs;
+  FrameRefIntervals rangeRefs;
   WrappedVkRes *initializedLiveRes;
+
+  // the contiguous range most recently updated with a single ref type, and the largest ref that
+  // produced. Updating with the same ref type again inside this range can't change anything, so
+  // re-binding the same or neighbouring ranges of a memory only pays for the part not yet covered.
+  // This relies on each MemRefs always being updated with the same compose function.
+  VkDeviceSize coalescedStart = 0;
+  VkDeviceSize coalescedEnd = 0;
+  FrameRefType coalescedRef = eFrameRef_None;
+  FrameRefType coalescedMaxRef = eFrameRef_None;
+
   inline MemRefs() : initializedLiveRes(NULL) {}
   inline MemRefs(VkDeviceSize offset, VkDeviceSize size, FrameRefType refType)
       : initializedLiveRes(NULL)
   {
     size = RDCMIN(size, UINT64_MAX - offset);
     rangeRefs.update(offset, offset + size, refType, ComposeFrameRefs);
+
+    coalescedStart = offset;
+    coalescedEnd = offset + size;
+    coalescedRef = coalescedMaxRef = refType;
   }
   template <typename Compose>
   FrameRefType Update(VkDeviceSize offset, VkDeviceSize size, FrameRefType refType, Compose comp);
@@ -1975,13 +2042,41 @@ FrameRefType MemRefs::Update(VkDeviceSize offset, VkDeviceSize size, FrameRefTyp
                              Compose comp)
 {
   size = RDCMIN(size, UINT64_MAX - offset);
+  VkDeviceSize end = offset + size;
   FrameRefType maxRefType = eFrameRef_None;
-  rangeRefs.update(offset, offset + size, refType,
-                   [&maxRefType, comp](FrameRefType oldRef, FrameRefType newRef) -> FrameRefType {
-                     FrameRefType ref = comp(oldRef, newRef);
-                     maxRefType = ComposeFrameRefsDisjoint(maxRefType, ref);
-                     return ref;
-                   });
+  auto composeMax = [&maxRefType, comp](FrameRefType oldRef, FrameRefType newRef) -> FrameRefType {
+    FrameRefType ref = comp(oldRef, newRef);
+    maxRefType = ComposeFrameRefsDisjoint(maxRefType, ref);
+    return ref;
+  };
+
+  // write-before-read composed with itself becomes read-before-write, so only the other ref types
+  // can be skipped when re-applied.
+  if(refType == coalescedRef && refType != eFrameRef_None &&
+     refType != eFrameRef_WriteBeforeRead && coalescedStart < coalescedEnd &&
+     offset <= coalescedEnd && end >= coalescedStart)
+  {
+    if(offset < coalescedStart)
+      rangeRefs.update(offset, coalescedStart, refType, composeMax);
+    if(end > coalescedEnd)
+      rangeRefs.update(coalescedEnd, end, refType, composeMax);
+
+    coalescedStart = RDCMIN(coalescedStart, offset);
+    coalescedEnd = RDCMAX(coalescedEnd, end);
+    coalescedMaxRef = ComposeFrameRefsDisjoint(coalescedMaxRef, maxRefType);
+
+    // callers compose this into a disjoint whole-resource ref, where returning the ref of the
+    // wider coalesced range again has no further effect.
+    return coalescedMaxRef;
+  }
+
+  rangeRefs.update(offset, end, refType, composeMax);
+
+  coalescedStart = offset;
+  coalescedEnd = end;
+  coalescedRef = refType;
+  coalescedMaxRef = maxRefType;
+
   return maxRefType;
 }
 
@@ -1989,6 +2084,8 @@ template <typename Compose>
 FrameRefType MemRefs::Merge(MemRefs &other, Compose comp)
 {
   FrameRefType maxRefType = eFrameRef_None;
+  coalescedStart = coalescedEnd = 0;
+  coalescedRef = coalescedMaxRef = eFrameRef_None;
   rangeRefs.merge(other.rangeRefs,
                   [&maxRefType, comp](FrameRefType oldRef, FrameRefType newRef) -> FrameRefType {
                     FrameRefType ref = comp(oldRef, newRef);
@@ -2041,6 +2138,42 @@ inline FrameRefType MarkMemoryReferenced(std::map<ResourceId, MemRefs> &memRefs,
   return MarkMemoryReferenced(memRefs, mem, offset, size, refType, ComposeFrameRefs);
 }
 
+struct ShaderModuleBlobStore;
+
+// the code for a shader module, shared between every module created with identical code. The
+// vkCreateShaderModule chunks only reference it by hash, and each blob is written once to the
+// capture's shader blob section
+struct ShaderModuleBlob
+{
+  ShaderModuleBlobStore *store;
+  uint64_t hash;
+  bytebuf code;
+
+  // the shader module records using this blob. The blob is only written if one of them was
+  // written to the capture.
+  rdcarray<VkResourceRecord *> users;
+};
+
+struct ShaderModuleBlobStore
+{
+  ~ShaderModuleBlobStore();
+
+  // returns the blob for this code, adding the record as a user. Returns NULL if the hash collides
+  // with a blob holding different code, in which case the code must be serialised inline.
+  ShaderModuleBlob *Acquire(VkResourceRecord *record, const void *code, size_t size);
+  void Release(ShaderModuleBlob *blob, VkResourceRecord *record);
+
+  // returns the hash to reference this code by, or 0 if it isn't stored.
+  uint64_t FindHash(const void *code, size_t size);
+
+  // write every blob used by a record that has been written to the capture
+  void WriteReferenced(StreamWriter *writer);
+
+private:
+  Threading::CriticalSection m_Lock;
+  std::map<uint64_t, ShaderModuleBlob *> m_Blobs;
+};
+
 struct DescUpdateTemplate;
 struct ImageLayouts;
 
@@ -2148,27 +2281,10 @@ public:
     p.second = ComposeFrameRefsDisjoint(p.second, maxRef);
   }
 
-  void RemoveBindFrameRef(ResourceId id)
-  {
-    // ignore any NULL IDs - probably an object that was
-    // deleted since it was bound.
-    if(id == ResourceId())
-      return;
-
-    auto it = descInfo->bindFrameRefs.find(id);
-
-    // in the case of re-used handles bound to descriptor sets,
-    // it's possible to try and remove a frameref on something we
-    // don't have (which means we'll have a corresponding stale ref)
-    // but this is harmless so we can ignore it.
-    if(it == descInfo->bindFrameRefs.end())
-      return;
-
-    it->second.first--;
-
-    if((it->second.first & ~DescriptorSetData::SPARSE_REF_BIT) == 0)
-      descInfo->bindFrameRefs.erase(it);
-  }
+  // rebuild descInfo's bindFrameRefs/bindMemRefs/bindImageStates, or writtenResources, from the
+  // current bindings if they're out of date. Must be called with descInfo->refLock held.
+  void UpdateBindRefs(VulkanResourceManager *rm);
+  void UpdateWrittenBindRefs(VulkanResourceManager *rm);
 
   // we have a lot of 'cold' data in the resource record, as it can be accessed
   // through the wrapped objects without locking any lookup structures.
@@ -2216,6 +2332,7 @@ public:
     PipelineLayoutData *pipeLayoutInfo;      // only for pipeline layouts
     DescriptorSetData *descInfo;             // only for descriptor sets and descriptor set layouts
     DescUpdateTemplate *descTemplateInfo;    // only for descriptor update templates
+    ShaderModuleBlob *shaderBlob;            // only for shader modules
     uint32_t queueFamilyIndex;               // only for queues and command pools
   };
 
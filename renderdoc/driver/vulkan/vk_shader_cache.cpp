@@ -23,7 +23,7 @@
  ******************************************************************************/
 
 #include "vk_shader_cache.h"
-#include "common/shader_cache.h"
+#include "api/replay/version.h"
 #include "data/glsl_shaders.h"
 #include "strings/string_utils.h"
 
@@ -91,6 +91,8 @@ static const BuiltinShaderConfig builtinShaders[] = {
      rdcspv::ShaderStage::Fragment, FeatureCheck::NoCheck, true},
     {BuiltinShader::TexRemapSInt, EmbeddedResource(glsl_texremap_frag),
      rdcspv::ShaderStage::Fragment, FeatureCheck::NoCheck, true},
+    {BuiltinShader::TileCompactCS, EmbeddedResource(glsl_tilecompact_comp),
+     rdcspv::ShaderStage::Compute, FeatureCheck::NoCheck, true},
 };
 
 RDCCOMPILE_ASSERT(ARRAY_COUNT(builtinShaders) == arraydim<BuiltinShader>(),
@@ -98,7 +100,7 @@ RDCCOMPILE_ASSERT(ARRAY_COUNT(builtinShaders) == arraydim<BuiltinShader>(),
 
 struct VulkanBlobShaderCallbacks
 {
-  bool Create(uint32_t size, byte *data, SPIRVBlob *ret) const
+  bool Create(uint32_t size, const byte *data, SPIRVBlob *ret) const
   {
     RDCASSERT(ret);
 
@@ -118,14 +120,41 @@ struct VulkanBlobShaderCallbacks
   const byte *GetData(SPIRVBlob blob) const { return (const byte *)blob->data(); }
 } VulkanShaderCacheCallbacks;
 
+struct VulkanDisassemblyCacheCallbacks
+{
+  bool Create(uint32_t size, const byte *data, bytebuf **ret) const
+  {
+    RDCASSERT(ret);
+
+    *ret = new bytebuf(data, size);
+
+    return true;
+  }
+
+  void Destroy(bytebuf *blob) const { delete blob; }
+  uint32_t GetSize(bytebuf *blob) const { return (uint32_t)blob->size(); }
+  const byte *GetData(bytebuf *blob) const { return blob->data(); }
+} VulkanDisassemblyCacheCallbacks;
+
+static ShaderCacheKey HashDisassemblyKey(const rdcarray<uint32_t> &spirv, const rdcstr &entryPoint)
+{
+  ShaderCacheKey key;
+  key.Hash(spirv.data(), spirv.byteSize());
+  key.Hash(entryPoint.c_str());
+  key.Hash(GitVersionHash);
+  return key;
+}
+
 VulkanShaderCache::VulkanShaderCache(WrappedVulkan *driver)
+    : m_ShaderCache("vkshaders.cache", m_ShaderCacheMagic, m_ShaderCacheVersion,
+                    VulkanShaderCacheCallbacks),
+      m_DisassemblyCache("vkdisasm.cache", m_DisassemblyCacheMagic, m_DisassemblyCacheVersion,
+                         VulkanDisassemblyCacheCallbacks),
+      m_UserShaderCache("vkusershaders.cache", m_UserShaderCacheMagic, m_UserShaderCacheVersion,
+                        VulkanShaderCacheCallbacks)
 {
   // Load shader cache, if present
-  bool success = LoadShaderCache("vkshaders.cache", m_ShaderCacheMagic, m_ShaderCacheVersion,
-                                 m_ShaderCache, VulkanShaderCacheCallbacks);
-
-  // if we failed to load from the cache
-  m_ShaderCacheDirty = !success;
+  m_ShaderCache.Load();
 
   m_pDriver = driver;
   m_Device = driver->GetDev();
@@ -227,19 +256,96 @@ VulkanShaderCache::VulkanShaderCache(WrappedVulkan *driver)
 
 VulkanShaderCache::~VulkanShaderCache()
 {
-  if(m_ShaderCacheDirty)
+  // only new entries are written, appended to the existing cache
+  m_ShaderCache.Save();
+  m_DisassemblyCache.Save();
+  m_UserShaderCache.Save();
+
+  for(size_t i = 0; i < ARRAY_COUNT(m_BuiltinShaderModules); i++)
+    m_pDriver->vkDestroyShaderModule(m_Device, m_BuiltinShaderModules[i], NULL);
+}
+
+bool VulkanShaderCache::GetCachedDisassembly(const rdcarray<uint32_t> &spirv,
+                                             const rdcstr &entryPoint, rdcstr &disassembly,
+                                             std::map<size_t, uint32_t> &instructionLines)
+{
+  if(!m_DisassemblyCacheLoaded)
   {
-    SaveShaderCache("vkshaders.cache", m_ShaderCacheMagic, m_ShaderCacheVersion, m_ShaderCache,
-                    VulkanShaderCacheCallbacks);
+    m_DisassemblyCache.Load();
+    m_DisassemblyCacheLoaded = true;
   }
-  else
+
+  bytebuf *entry = NULL;
+  if(!m_DisassemblyCache.Find(HashDisassemblyKey(spirv, entryPoint), entry))
+    return false;
+
+  // entry layout: number of lines, {offset, line} pairs, then the disassembly text
+  const bytebuf &blob = *entry;
+  const size_t headerSize = sizeof(uint32_t);
+  const size_t lineSize = sizeof(uint64_t) + sizeof(uint32_t);
+
+  if(blob.size() < headerSize)
+    return false;
+
+  const byte *ptr = blob.data();
+  uint32_t numLines = 0;
+  memcpy(&numLines, ptr, sizeof(uint32_t));
+  ptr += headerSize;
+
+  if(blob.size() < headerSize + numLines * lineSize)
+    return false;
+
+  instructionLines.clear();
+  for(uint32_t i = 0; i < numLines; i++)
   {
-    for(auto it = m_ShaderCache.begin(); it != m_ShaderCache.end(); ++it)
-      VulkanShaderCacheCallbacks.Destroy(it->second);
+    uint64_t offset = 0;
+    uint32_t line = 0;
+    memcpy(&offset, ptr, sizeof(uint64_t));
+    memcpy(&line, ptr + sizeof(uint64_t), sizeof(uint32_t));
+    ptr += lineSize;
+
+    instructionLines[(size_t)offset] = line;
   }
 
-  for(size_t i = 0; i < ARRAY_COUNT(m_BuiltinShaderModules); i++)
-    m_pDriver->vkDestroyShaderModule(m_Device, m_BuiltinShaderModules[i], NULL);
+  disassembly.assign((const char *)ptr, blob.data() + blob.size() - ptr);
+
+  return true;
+}
+
+void VulkanShaderCache::SetCachedDisassembly(const rdcarray<uint32_t> &spirv,
+                                             const rdcstr &entryPoint, const rdcstr &disassembly,
+                                             const std::map<size_t, uint32_t> &instructionLines)
+{
+  if(m_DisassemblyCache.size() >= m_DisassemblyCacheMaxEntries)
+    return;
+
+  uint32_t numLines = (uint32_t)instructionLines.size();
+
+  bytebuf *blob = new bytebuf;
+  blob->append((const byte *)&numLines, sizeof(numLines));
+
+  for(auto it = instructionLines.begin(); it != instructionLines.end(); ++it)
+  {
+    uint64_t offset = it->first;
+    blob->append((const byte *)&offset, sizeof(offset));
+    blob->append((const byte *)&it->second, sizeof(uint32_t));
+  }
+
+  blob->append((const byte *)disassembly.c_str(), disassembly.size());
+
+  m_DisassemblyCache.Insert(HashDisassemblyKey(spirv, entryPoint), blob);
+}
+
+uint64_t VulkanShaderCache::GetMemoryUsage()
+{
+  return m_ShaderCache.GetMemoryUsage() + m_DisassemblyCache.GetMemoryUsage() +
+         m_UserShaderCache.GetMemoryUsage();
+}
+
+void VulkanShaderCache::EvictCachedData()
+{
+  m_DisassemblyCache.EvictResults();
+  m_UserShaderCache.EvictResults();
 }
 
 rdcstr VulkanShaderCache::GetSPIRVBlob(const rdcspv::CompilationSettings &settings,
@@ -247,18 +353,18 @@ rdcstr VulkanShaderCache::GetSPIRVBlob(const rdcspv::CompilationSettings &settin
 {
   RDCASSERT(!src.empty());
 
-  uint32_t hash = strhash(src.c_str());
+  uint64_t hash = ShaderCacheHash(src.c_str());
 
   char typestr[3] = {'a', 'a', 0};
   typestr[0] += (char)settings.stage;
   typestr[1] += (char)settings.lang;
-  hash = strhash(typestr, hash);
+  hash = ShaderCacheHash(typestr, hash);
 
-  if(m_ShaderCache.find(hash) != m_ShaderCache.end())
-  {
-    outBlob = m_ShaderCache[hash];
+  if(settings.vulkan11)
+    hash = ShaderCacheHash("vk11", hash);
+
+  if(m_ShaderCache.Find(hash, outBlob))
     return "";
-  }
 
   SPIRVBlob spirv = new rdcarray<uint32_t>();
   rdcstr errors = rdcspv::Compile(settings, {src}, *spirv);
@@ -279,27 +385,62 @@ rdcstr VulkanShaderCache::GetSPIRVBlob(const rdcspv::CompilationSettings &settin
   outBlob = spirv;
 
   if(m_CacheShaders)
+    m_ShaderCache.Insert(hash, spirv);
+
+  return errors;
+}
+
+rdcstr VulkanShaderCache::GetUserSPIRVBlob(const rdcspv::CompilationSettings &settings,
+                                           const rdcstr &src, rdcarray<uint32_t> &spirv)
+{
+  if(!m_UserShaderCacheLoaded)
   {
-    m_ShaderCache[hash] = spirv;
-    m_ShaderCacheDirty = true;
+    m_UserShaderCache.Load();
+    m_UserShaderCacheLoaded = true;
+  }
+
+  uint64_t hash = ShaderCacheHash(src.c_str());
+  hash = ShaderCacheHash(settings.entryPoint.c_str(), hash);
+  hash = ShaderCacheHash(&settings.stage, sizeof(settings.stage), hash);
+  hash = ShaderCacheHash(&settings.lang, sizeof(settings.lang), hash);
+  hash = ShaderCacheHash(&settings.debugInfo, sizeof(settings.debugInfo), hash);
+  hash = ShaderCacheHash(GitVersionHash, hash);
+
+  SPIRVBlob cached = NULL;
+  if(m_UserShaderCache.Find(hash, cached))
+  {
+    spirv = *cached;
+    return "";
   }
 
+  rdcstr errors = rdcspv::Compile(settings, {src}, spirv);
+
+  if(!spirv.empty() && m_UserShaderCache.size() < m_UserShaderCacheMaxEntries)
+    m_UserShaderCache.Insert(hash, new rdcarray<uint32_t>(spirv));
+
   return errors;
 }
 
 void VulkanShaderCache::MakeGraphicsPipelineInfo(VkGraphicsPipelineCreateInfo &pipeCreateInfo,
                                                  ResourceId pipeline)
+{
+  MakeGraphicsPipelineInfo(pipeCreateInfo, pipeline, m_GraphicsPipelineStorage);
+}
+
+void VulkanShaderCache::MakeGraphicsPipelineInfo(VkGraphicsPipelineCreateInfo &pipeCreateInfo,
+                                                 ResourceId pipeline,
+                                                 GraphicsPipelineInfoStorage &storage)
 {
   const VulkanCreationInfo::Pipeline &pipeInfo = m_pDriver->m_CreationInfo.m_Pipeline[pipeline];
 
   VulkanResourceManager *rm = m_pDriver->GetResourceManager();
 
-  static VkPipelineShaderStageCreateInfo stages[6];
-  static VkSpecializationInfo specInfo[6];
-  static rdcarray<VkSpecializationMapEntry> specMapEntries;
+  VkPipelineShaderStageCreateInfo *stages = storage.stages;
+  VkSpecializationInfo *specInfo = storage.specInfo;
+  rdcarray<VkSpecializationMapEntry> &specMapEntries = storage.specMapEntries;
 
   // the specialization constants can't use more than a uint64_t, so we just over-allocate
-  static rdcarray<uint64_t> specdata;
+  rdcarray<uint64_t> &specdata = storage.specdata;
 
   size_t specEntries = 0;
 
@@ -354,14 +495,12 @@ void VulkanShaderCache::MakeGraphicsPipelineInfo(VkGraphicsPipelineCreateInfo &p
     }
   }
 
-  static VkPipelineVertexInputStateCreateInfo vi = {
-      VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
-  };
+  VkPipelineVertexInputStateCreateInfo &vi = storage.vi;
 
   vi.pNext = NULL;
 
-  static VkVertexInputAttributeDescription viattr[128] = {};
-  static VkVertexInputBindingDescription vibind[128] = {};
+  VkVertexInputAttributeDescription *viattr = storage.viattr;
+  VkVertexInputBindingDescription *vibind = storage.vibind;
 
   vi.pVertexAttributeDescriptions = viattr;
   vi.pVertexBindingDescriptions = vibind;
@@ -385,10 +524,8 @@ void VulkanShaderCache::MakeGraphicsPipelineInfo(VkGraphicsPipelineCreateInfo &p
                                                                  : VK_VERTEX_INPUT_RATE_VERTEX;
   }
 
-  static VkPipelineVertexInputDivisorStateCreateInfoEXT vertexDivisor = {
-      VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_DIVISOR_STATE_CREATE_INFO_EXT,
-  };
-  static VkVertexInputBindingDivisorDescriptionEXT vibindDivisors[128] = {};
+  VkPipelineVertexInputDivisorStateCreateInfoEXT &vertexDivisor = storage.vertexDivisor;
+  VkVertexInputBindingDivisorDescriptionEXT *vibindDivisors = storage.vibindDivisors;
 
   if(m_pDriver->GetExtensions(GetRecord(m_Device)).ext_EXT_vertex_attribute_divisor)
   {
@@ -405,25 +542,21 @@ void VulkanShaderCache::MakeGraphicsPipelineInfo(VkGraphicsPipelineCreateInfo &p
     vi.pNext = &vertexDivisor;
   }
 
-  RDCASSERT(ARRAY_COUNT(viattr) >= pipeInfo.vertexAttrs.size());
-  RDCASSERT(ARRAY_COUNT(vibind) >= pipeInfo.vertexBindings.size());
+  RDCASSERT(ARRAY_COUNT(storage.viattr) >= pipeInfo.vertexAttrs.size());
+  RDCASSERT(ARRAY_COUNT(storage.vibind) >= pipeInfo.vertexBindings.size());
 
-  static VkPipelineInputAssemblyStateCreateInfo ia = {
-      VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO};
+  VkPipelineInputAssemblyStateCreateInfo &ia = storage.ia;
 
   ia.topology = pipeInfo.topology;
   ia.primitiveRestartEnable = pipeInfo.primitiveRestartEnable;
 
-  static VkPipelineTessellationStateCreateInfo tess = {
-      VK_STRUCTURE_TYPE_PIPELINE_TESSELLATION_STATE_CREATE_INFO};
+  VkPipelineTessellationStateCreateInfo &tess = storage.tess;
 
   tess.pNext = NULL;
 
   tess.patchControlPoints = pipeInfo.patchControlPoints;
 
-  static VkPipelineTessellationDomainOriginStateCreateInfo tessDomain = {
-      VK_STRUCTURE_TYPE_PIPELINE_TESSELLATION_DOMAIN_ORIGIN_STATE_CREATE_INFO,
-  };
+  VkPipelineTessellationDomainOriginStateCreateInfo &tessDomain = storage.tessDomain;
 
   if(m_pDriver->GetExtensions(GetRecord(m_Device)).ext_KHR_maintenance2)
   {
@@ -433,11 +566,10 @@ void VulkanShaderCache::MakeGraphicsPipelineInfo(VkGraphicsPipelineCreateInfo &p
     tess.pNext = &tessDomain;
   }
 
-  static VkPipelineViewportStateCreateInfo vp = {
-      VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO};
+  VkPipelineViewportStateCreateInfo &vp = storage.vp;
 
-  static VkViewport views[32] = {};
-  static VkRect2D scissors[32] = {};
+  VkViewport *views = storage.views;
+  VkRect2D *scissors = storage.scissors;
 
   memcpy(views, &pipeInfo.viewports[0], pipeInfo.viewports.size() * sizeof(VkViewport));
 
@@ -449,12 +581,10 @@ void VulkanShaderCache::MakeGraphicsPipelineInfo(VkGraphicsPipelineCreateInfo &p
   vp.pScissors = &scissors[0];
   vp.scissorCount = (uint32_t)pipeInfo.scissors.size();
 
-  RDCASSERT(ARRAY_COUNT(views) >= pipeInfo.viewports.size());
-  RDCASSERT(ARRAY_COUNT(scissors) >= pipeInfo.scissors.size());
+  RDCASSERT(ARRAY_COUNT(storage.views) >= pipeInfo.viewports.size());
+  RDCASSERT(ARRAY_COUNT(storage.scissors) >= pipeInfo.scissors.size());
 
-  static VkPipelineRasterizationStateCreateInfo rs = {
-      VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO,
-  };
+  VkPipelineRasterizationStateCreateInfo &rs = storage.rs;
 
   rs.pNext = NULL;
 
@@ -469,9 +599,7 @@ void VulkanShaderCache::MakeGraphicsPipelineInfo(VkGraphicsPipelineCreateInfo &p
   rs.depthBiasSlopeFactor = pipeInfo.depthBiasSlopeFactor;
   rs.lineWidth = pipeInfo.lineWidth;
 
-  static VkPipelineRasterizationConservativeStateCreateInfoEXT conservRast = {
-      VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_CONSERVATIVE_STATE_CREATE_INFO_EXT,
-  };
+  VkPipelineRasterizationConservativeStateCreateInfoEXT &conservRast = storage.conservRast;
 
   if(m_pDriver->GetExtensions(GetRecord(m_Device)).ext_EXT_conservative_rasterization)
   {
@@ -482,9 +610,7 @@ void VulkanShaderCache::MakeGraphicsPipelineInfo(VkGraphicsPipelineCreateInfo &p
     rs.pNext = &conservRast;
   }
 
-  static VkPipelineRasterizationStateStreamCreateInfoEXT rastStream = {
-      VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_STREAM_CREATE_INFO_EXT,
-  };
+  VkPipelineRasterizationStateStreamCreateInfoEXT &rastStream = storage.rastStream;
 
   if(m_pDriver->GetExtensions(GetRecord(m_Device)).ext_EXT_transform_feedback)
   {
@@ -494,9 +620,7 @@ void VulkanShaderCache::MakeGraphicsPipelineInfo(VkGraphicsPipelineCreateInfo &p
     rs.pNext = &rastStream;
   }
 
-  static VkPipelineRasterizationDepthClipStateCreateInfoEXT depthClipState = {
-      VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_DEPTH_CLIP_STATE_CREATE_INFO_EXT,
-  };
+  VkPipelineRasterizationDepthClipStateCreateInfoEXT &depthClipState = storage.depthClipState;
 
   if(m_pDriver->GetExtensions(GetRecord(m_Device)).ext_EXT_depth_clip_enable)
   {
@@ -506,9 +630,7 @@ void VulkanShaderCache::MakeGraphicsPipelineInfo(VkGraphicsPipelineCreateInfo &p
     rs.pNext = &depthClipState;
   }
 
-  static VkPipelineRasterizationLineStateCreateInfoEXT lineRasterState = {
-      VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_LINE_STATE_CREATE_INFO_EXT,
-  };
+  VkPipelineRasterizationLineStateCreateInfoEXT &lineRasterState = storage.lineRasterState;
 
   if(m_pDriver->GetExtensions(GetRecord(m_Device)).ext_EXT_line_rasterization)
   {
@@ -521,9 +643,7 @@ void VulkanShaderCache::MakeGraphicsPipelineInfo(VkGraphicsPipelineCreateInfo &p
     rs.pNext = &lineRasterState;
   }
 
-  static VkPipelineMultisampleStateCreateInfo msaa = {
-      VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO,
-  };
+  VkPipelineMultisampleStateCreateInfo &msaa = storage.msaa;
 
   msaa.pNext = NULL;
 
@@ -534,9 +654,7 @@ void VulkanShaderCache::MakeGraphicsPipelineInfo(VkGraphicsPipelineCreateInfo &p
   msaa.alphaToCoverageEnable = pipeInfo.alphaToCoverageEnable;
   msaa.alphaToOneEnable = pipeInfo.alphaToOneEnable;
 
-  static VkPipelineSampleLocationsStateCreateInfoEXT sampleLoc = {
-      VK_STRUCTURE_TYPE_PIPELINE_SAMPLE_LOCATIONS_STATE_CREATE_INFO_EXT,
-  };
+  VkPipelineSampleLocationsStateCreateInfoEXT &sampleLoc = storage.sampleLoc;
 
   if(m_pDriver->GetExtensions(GetRecord(m_Device)).ext_EXT_sample_locations)
   {
@@ -551,8 +669,7 @@ void VulkanShaderCache::MakeGraphicsPipelineInfo(VkGraphicsPipelineCreateInfo &p
     msaa.pNext = &sampleLoc;
   }
 
-  static VkPipelineDepthStencilStateCreateInfo ds = {
-      VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO};
+  VkPipelineDepthStencilStateCreateInfo &ds = storage.ds;
 
   ds.depthTestEnable = pipeInfo.depthTestEnable;
   ds.depthWriteEnable = pipeInfo.depthWriteEnable;
@@ -564,14 +681,13 @@ void VulkanShaderCache::MakeGraphicsPipelineInfo(VkGraphicsPipelineCreateInfo &p
   ds.minDepthBounds = pipeInfo.minDepthBounds;
   ds.maxDepthBounds = pipeInfo.maxDepthBounds;
 
-  static VkPipelineColorBlendStateCreateInfo cb = {
-      VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO};
+  VkPipelineColorBlendStateCreateInfo &cb = storage.cb;
 
   cb.logicOpEnable = pipeInfo.logicOpEnable;
   cb.logicOp = pipeInfo.logicOp;
   memcpy(cb.blendConstants, pipeInfo.blendConst, sizeof(cb.blendConstants));
 
-  static VkPipelineColorBlendAttachmentState atts[32] = {};
+  VkPipelineColorBlendAttachmentState *atts = storage.atts;
 
   cb.attachmentCount = (uint32_t)pipeInfo.attachments.size();
   cb.pAttachments = atts;
@@ -588,11 +704,11 @@ void VulkanShaderCache::MakeGraphicsPipelineInfo(VkGraphicsPipelineCreateInfo &p
     atts[i].dstColorBlendFactor = pipeInfo.attachments[i].blend.Destination;
   }
 
-  RDCASSERT(ARRAY_COUNT(atts) >= pipeInfo.attachments.size());
+  RDCASSERT(ARRAY_COUNT(storage.atts) >= pipeInfo.attachments.size());
 
-  static VkDynamicState dynSt[VkDynamicCount];
+  VkDynamicState *dynSt = storage.dynSt;
 
-  static VkPipelineDynamicStateCreateInfo dyn = {VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO};
+  VkPipelineDynamicStateCreateInfo &dyn = storage.dyn;
 
   dyn.dynamicStateCount = 0;
   dyn.pDynamicStates = dynSt;
@@ -601,7 +717,8 @@ void VulkanShaderCache::MakeGraphicsPipelineInfo(VkGraphicsPipelineCreateInfo &p
     if(pipeInfo.dynamicStates[i])
       dynSt[dyn.dynamicStateCount++] = ConvertDynamicState((VulkanDynamicStateIndex)i);
 
-  // since we don't have to worry about threading, we point everything at the above static structs
+  // everything points into the storage, which must stay alive and untouched until the pipeline
+  // has been created
 
   VkGraphicsPipelineCreateInfo ret = {
       VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
@@ -625,9 +742,7 @@ void VulkanShaderCache::MakeGraphicsPipelineInfo(VkGraphicsPipelineCreateInfo &p
       0,                 // base pipeline index
   };
 
-  static VkPipelineDiscardRectangleStateCreateInfoEXT discardRects = {
-      VK_STRUCTURE_TYPE_PIPELINE_DISCARD_RECTANGLE_STATE_CREATE_INFO_EXT,
-  };
+  VkPipelineDiscardRectangleStateCreateInfoEXT &discardRects = storage.discardRects;
 
   if(m_pDriver->GetExtensions(GetRecord(m_Device)).ext_EXT_discard_rectangles)
   {
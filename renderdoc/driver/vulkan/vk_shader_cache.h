@@ -24,6 +24,7 @@
 
 #pragma once
 
+#include "common/shader_cache.h"
 #include "core/core.h"
 #include "driver/shaders/spirv/spirv_compile.h"
 #include "vk_core.h"
@@ -54,11 +55,83 @@ enum class BuiltinShader
   TexRemapFloat,
   TexRemapUInt,
   TexRemapSInt,
+  TileCompactCS,
   Count,
 };
 
 ITERABLE_OPERATORS(BuiltinShader);
 
+// the structs a graphics pipeline create info from MakeGraphicsPipelineInfo points into. Creating
+// pipelines on several threads at once needs one of these per thread.
+struct GraphicsPipelineInfoStorage
+{
+  VkPipelineShaderStageCreateInfo stages[6] = {};
+  VkSpecializationInfo specInfo[6] = {};
+  rdcarray<VkSpecializationMapEntry> specMapEntries;
+  rdcarray<uint64_t> specdata;
+  VkPipelineVertexInputStateCreateInfo vi = {
+      VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
+  };
+  VkVertexInputAttributeDescription viattr[128] = {};
+  VkVertexInputBindingDescription vibind[128] = {};
+  VkPipelineVertexInputDivisorStateCreateInfoEXT vertexDivisor = {
+      VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_DIVISOR_STATE_CREATE_INFO_EXT,
+  };
+  VkVertexInputBindingDivisorDescriptionEXT vibindDivisors[128] = {};
+  VkPipelineInputAssemblyStateCreateInfo ia = {
+      VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO,
+  };
+  VkPipelineTessellationStateCreateInfo tess = {
+      VK_STRUCTURE_TYPE_PIPELINE_TESSELLATION_STATE_CREATE_INFO,
+  };
+  VkPipelineTessellationDomainOriginStateCreateInfo tessDomain = {
+      VK_STRUCTURE_TYPE_PIPELINE_TESSELLATION_DOMAIN_ORIGIN_STATE_CREATE_INFO,
+  };
+  VkPipelineViewportStateCreateInfo vp = {
+      VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO,
+  };
+  VkViewport views[32] = {};
+  VkRect2D scissors[32] = {};
+  VkPipelineRasterizationStateCreateInfo rs = {
+      VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO,
+  };
+  VkPipelineRasterizationConservativeStateCreateInfoEXT conservRast = {
+      VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_CONSERVATIVE_STATE_CREATE_INFO_EXT,
+  };
+  VkPipelineRasterizationStateStreamCreateInfoEXT rastStream = {
+      VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_STREAM_CREATE_INFO_EXT,
+  };
+  VkPipelineRasterizationDepthClipStateCreateInfoEXT depthClipState = {
+      VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_DEPTH_CLIP_STATE_CREATE_INFO_EXT,
+  };
+  VkPipelineRasterizationLineStateCreateInfoEXT lineRasterState = {
+      VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_LINE_STATE_CREATE_INFO_EXT,
+  };
+  VkPipelineMultisampleStateCreateInfo msaa = {
+      VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO,
+  };
+  VkPipelineSampleLocationsStateCreateInfoEXT sampleLoc = {
+      VK_STRUCTURE_TYPE_PIPELINE_SAMPLE_LOCATIONS_STATE_CREATE_INFO_EXT,
+  };
+  VkPipelineDepthStencilStateCreateInfo ds = {
+      VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO,
+  };
+  VkPipelineColorBlendStateCreateInfo cb = {
+      VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO,
+  };
+  VkPipelineColorBlendAttachmentState atts[32] = {};
+  VkDynamicState dynSt[VkDynamicCount] = {};
+  VkPipelineDynamicStateCreateInfo dyn = {
+      VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO,
+  };
+  VkPipelineDiscardRectangleStateCreateInfoEXT discardRects = {
+      VK_STRUCTURE_TYPE_PIPELINE_DISCARD_RECTANGLE_STATE_CREATE_INFO_EXT,
+  };
+};
+
+struct VulkanBlobShaderCallbacks;
+struct VulkanDisassemblyCacheCallbacks;
+
 class VulkanShaderCache
 {
 public:
@@ -67,6 +140,10 @@ public:
 
   rdcstr GetSPIRVBlob(const rdcspv::CompilationSettings &settings, const rdcstr &src,
                       SPIRVBlob &outBlob);
+  // shaders compiled for shader editing and custom display are kept on disk between sessions,
+  // keyed by the source, compile settings and the build of RenderDoc (which contains the compiler).
+  rdcstr GetUserSPIRVBlob(const rdcspv::CompilationSettings &settings, const rdcstr &src,
+                          rdcarray<uint32_t> &spirv);
 
   SPIRVBlob GetBuiltinBlob(BuiltinShader builtin) { return m_BuiltinShaderBlobs[(size_t)builtin]; }
   VkShaderModule GetBuiltinModule(BuiltinShader builtin)
@@ -75,21 +152,55 @@ public:
   }
 
   void MakeGraphicsPipelineInfo(VkGraphicsPipelineCreateInfo &pipeCreateInfo, ResourceId pipeline);
+  void MakeGraphicsPipelineInfo(VkGraphicsPipelineCreateInfo &pipeCreateInfo, ResourceId pipeline,
+                                GraphicsPipelineInfoStorage &storage);
   void MakeComputePipelineInfo(VkComputePipelineCreateInfo &pipeCreateInfo, ResourceId pipeline);
 
   rdcstr GetGlobalDefines() { return m_GlobalDefines; }
   void SetCaching(bool enabled) { m_CacheShaders = enabled; }
+  // disassembly of capture shaders is kept on disk between sessions, keyed by the SPIR-V contents,
+  // the entry point and the build of RenderDoc that produced it.
+  bool GetCachedDisassembly(const rdcarray<uint32_t> &spirv, const rdcstr &entryPoint,
+                            rdcstr &disassembly, std::map<size_t, uint32_t> &instructionLines);
+  void SetCachedDisassembly(const rdcarray<uint32_t> &spirv, const rdcstr &entryPoint,
+                            const rdcstr &disassembly,
+                            const std::map<size_t, uint32_t> &instructionLines);
+
+  // the memory held by cached shaders and disassembly loaded from disk
+  uint64_t GetMemoryUsage();
+  // frees cached disassembly and user shaders loaded from disk, which are copied out when they're
+  // looked up. The built-in shaders are kept since their blobs are held onto.
+  void EvictCachedData();
+
 private:
   static const uint32_t m_ShaderCacheMagic = 0xf00d00d5;
-  static const uint32_t m_ShaderCacheVersion = 1;
+  static const uint32_t m_ShaderCacheVersion = 2;
+
+  static const uint32_t m_DisassemblyCacheMagic = 0xf00d0d15;
+  static const uint32_t m_DisassemblyCacheVersion = 3;
+  static const size_t m_DisassemblyCacheMaxEntries = 4096;
+
+  static const uint32_t m_UserShaderCacheMagic = 0xf00d05e5;
+  static const uint32_t m_UserShaderCacheVersion = 1;
+  static const size_t m_UserShaderCacheMaxEntries = 1024;
 
   WrappedVulkan *m_pDriver = NULL;
   VkDevice m_Device = VK_NULL_HANDLE;
 
   rdcstr m_GlobalDefines;
 
-  bool m_ShaderCacheDirty = false, m_CacheShaders = false;
-  std::map<uint32_t, SPIRVBlob> m_ShaderCache;
+  bool m_CacheShaders = false;
+  ShaderCache<SPIRVBlob, VulkanBlobShaderCallbacks> m_ShaderCache;
+
+  // loaded on first use, since capturing never needs it
+  bool m_DisassemblyCacheLoaded = false;
+  ShaderCache<bytebuf *, VulkanDisassemblyCacheCallbacks> m_DisassemblyCache;
+
+  // also loaded on first use, only needed when editing shaders
+  bool m_UserShaderCacheLoaded = false;
+  ShaderCache<SPIRVBlob, VulkanBlobShaderCallbacks> m_UserShaderCache;
+
+  GraphicsPipelineInfoStorage m_GraphicsPipelineStorage;
 
   SPIRVBlob m_BuiltinShaderBlobs[arraydim<BuiltinShader>()] = {NULL};
   VkShaderModule m_BuiltinShaderModules[arraydim<BuiltinShader>()] = {VK_NULL_HANDLE};
@@ -114,7 +114,7 @@ ShaderDebugTrace *VulkanReplay::DebugVertex(uint32_t eventId, uint32_t vertid, u
   VulkanCreationInfo::ShaderModuleReflection &shadRefl =
       shader.GetReflection(entryPoint, state.graphics.pipeline);
 
-  shadRefl.PopulateDisassembly(shader.spirv);
+  shadRefl.PopulateDisassembly(shader.GetSPIRV(), m_pDriver->GetShaderCache());
   VulkanAPIWrapper *apiWrapper = new VulkanAPIWrapper(m_pDriver);
 
   for(uint32_t set = 0; set < state.graphics.descSets.size(); set++)
@@ -259,7 +259,7 @@ ShaderDebugTrace *VulkanReplay::DebugVertex(uint32_t eventId, uint32_t vertid, u
   }
 
   rdcspv::Debugger *debugger = new rdcspv::Debugger;
-  debugger->Parse(shader.spirv.GetSPIRV());
+  debugger->Parse(shader.GetSPIRV().GetSPIRV());
   ShaderDebugTrace *ret = debugger->BeginDebug(apiWrapper, ShaderStage::Vertex, entryPoint, spec,
                                                shadRefl.instructionLines, shadRefl.patchData, 0);
 
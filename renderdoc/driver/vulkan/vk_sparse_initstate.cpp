@@ -25,6 +25,9 @@
 #include "vk_core.h"
 #include "vk_debug.h"
 
+// the granularity at which all-zero memory is dropped from sparse initial contents
+static const VkDeviceSize SparseZeroCheckSize = 64 * 1024;
+
 template <typename SerialiserType>
 void DoSerialise(SerialiserType &ser, MemIDOffset &el)
 {
@@ -32,13 +35,55 @@ void DoSerialise(SerialiserType &ser, MemIDOffset &el)
   SERIALISE_MEMBER(memOffs);
 }
 
+template <typename SerialiserType>
+void DoSerialise(SerialiserType &ser, SparseMemRegion &el)
+{
+  SERIALISE_MEMBER(memory);
+  SERIALISE_MEMBER(memOffs);
+  SERIALISE_MEMBER(size);
+  SERIALISE_MEMBER(dataOffs);
+}
+
+template <typename SerialiserType>
+void DoSerialise(SerialiserType &ser, SparsePageBind &el)
+{
+  SERIALISE_MEMBER(page);
+  SERIALISE_MEMBER(memory);
+  SERIALISE_MEMBER(memOffs);
+}
+
+// older captures stored the whole of each bound memory object, one after the other
+template <typename SerialiserType>
+static void SerialiseOldSparseMems(SerialiserType &ser, SparseMemRegion *&regions,
+                                   uint32_t &numRegions)
+{
+  MemIDOffset *memDataOffs = NULL;
+  uint32_t numUniqueMems = 0;
+
+  SERIALISE_ELEMENT_ARRAY(memDataOffs, numUniqueMems);
+  SERIALISE_ELEMENT(numUniqueMems);
+
+  regions = new SparseMemRegion[numUniqueMems];
+  numRegions = numUniqueMems;
+
+  for(uint32_t i = 0; i < numUniqueMems; i++)
+    regions[i] = {memDataOffs[i].memory, 0, VK_WHOLE_SIZE, memDataOffs[i].memOffs};
+}
+
 template <typename SerialiserType>
 void DoSerialise(SerialiserType &ser, SparseBufferInitState &el)
 {
   SERIALISE_MEMBER_ARRAY(binds, numBinds);
   SERIALISE_MEMBER(numBinds);
-  SERIALISE_MEMBER_ARRAY(memDataOffs, numUniqueMems);
-  SERIALISE_MEMBER(numUniqueMems);
+  if(ser.VersionAtLeast(0x12))
+  {
+    SERIALISE_MEMBER_ARRAY(regions, numRegions);
+    SERIALISE_MEMBER(numRegions);
+  }
+  else
+  {
+    SerialiseOldSparseMems(ser, el.regions, el.numRegions);
+  }
   SERIALISE_MEMBER(totalSize);
 }
 
@@ -46,7 +91,7 @@ template <>
 void Deserialise(const SparseBufferInitState &el)
 {
   delete[] el.binds;
-  delete[] el.memDataOffs;
+  delete[] el.regions;
 }
 
 template <typename SerialiserType>
@@ -56,11 +101,59 @@ void DoSerialise(SerialiserType &ser, SparseImageInitState &el)
   SERIALISE_MEMBER(opaqueCount);
   SERIALISE_MEMBER(imgdim);
   SERIALISE_MEMBER(pagedim);
-  for(uint32_t a = 0; a < NUM_VK_IMAGE_ASPECTS; a++)
-    SERIALISE_MEMBER_ARRAY(pages[a], pageCount[a]);
-  SERIALISE_MEMBER(pageCount);
-  SERIALISE_MEMBER_ARRAY(memDataOffs, numUniqueMems);
-  SERIALISE_MEMBER(numUniqueMems);
+  if(ser.VersionAtLeast(0x12))
+  {
+    SERIALISE_MEMBER(pageSize);
+    SERIALISE_MEMBER(pageAspects);
+    for(uint32_t a = 0; a < NUM_VK_IMAGE_ASPECTS; a++)
+      SERIALISE_MEMBER_ARRAY(pages[a], pageCount[a]);
+    SERIALISE_MEMBER(pageCount);
+    SERIALISE_MEMBER_ARRAY(regions, numRegions);
+    SERIALISE_MEMBER(numRegions);
+  }
+  else
+  {
+    // older captures stored the whole page table, including pages that weren't resident
+    MemIDOffset *pages[NUM_VK_IMAGE_ASPECTS] = {};
+    uint32_t pageCount[NUM_VK_IMAGE_ASPECTS] = {};
+
+    for(uint32_t a = 0; a < NUM_VK_IMAGE_ASPECTS; a++)
+      ser.Serialise("pages[a]"_lit, pages[a], pageCount[a], SerialiserFlags::AllocateMemory);
+    SERIALISE_ELEMENT(pageCount);
+
+    // we don't know the page size, so adjacent pages can't be merged when binding
+    el.pageSize = 0;
+    el.pageAspects = 0;
+
+    for(uint32_t a = 0; a < NUM_VK_IMAGE_ASPECTS; a++)
+    {
+      el.pages[a] = NULL;
+      el.pageCount[a] = 0;
+
+      if(pageCount[a] == 0)
+      {
+        delete[] pages[a];
+        continue;
+      }
+
+      el.pageAspects |= 1U << a;
+
+      for(uint32_t i = 0; i < pageCount[a]; i++)
+        if(pages[a][i].memory != ResourceId())
+          el.pageCount[a]++;
+
+      el.pages[a] = new SparsePageBind[el.pageCount[a]];
+
+      uint32_t p = 0;
+      for(uint32_t i = 0; i < pageCount[a]; i++)
+        if(pages[a][i].memory != ResourceId())
+          el.pages[a][p++] = {i, pages[a][i].memory, pages[a][i].memOffs};
+
+      delete[] pages[a];
+    }
+
+    SerialiseOldSparseMems(ser, el.regions, el.numRegions);
+  }
   SERIALISE_MEMBER(totalSize);
 }
 
@@ -68,37 +161,118 @@ template <>
 void Deserialise(const SparseImageInitState &el)
 {
   delete[] el.opaque;
-  delete[] el.memDataOffs;
+  delete[] el.regions;
   for(uint32_t a = 0; a < NUM_VK_IMAGE_ASPECTS; a++)
     delete[] el.pages[a];
 }
 
-bool WrappedVulkan::Prepare_SparseInitialState(WrappedVkBuffer *buf)
+static bool IsAllZero(const byte *data, size_t size)
 {
-  ResourceId id = buf->id;
+  const uint64_t *data64 = (const uint64_t *)data;
+  size_t i = 0;
 
-  // VKTODOLOW this is a bit conservative, as we save the whole memory object rather than just the
-  // bound range.
-  std::map<VkDeviceMemory, VkDeviceSize> boundMems;
+  for(; i < size / sizeof(uint64_t); i++)
+    if(data64[i] != 0)
+      return false;
 
-  // value will be filled out later once all memories are added
-  for(size_t i = 0; i < buf->record->resInfo->opaquemappings.size(); i++)
-    boundMems[buf->record->resInfo->opaquemappings[i].memory] = 0;
+  for(i *= sizeof(uint64_t); i < size; i++)
+    if(data[i] != 0)
+      return false;
 
-  uint32_t numElems = (uint32_t)buf->record->resInfo->opaquemappings.size();
+  return true;
+}
 
-  VkInitialContents initContents;
+// splits off the all-zero parts of the regions so that their contents don't need to be stored.
+// Returns the contents for the remaining regions, which is either the original contents or a
+// packed copy to free with FreeAlignedBuffer.
+static byte *RemoveZeroSparseData(const SparseMemRegion *regions, uint32_t numRegions,
+                                  byte *contents, rdcarray<SparseMemRegion> &outRegions,
+                                  VkDeviceSize &outSize)
+{
+  outRegions.clear();
+  outSize = 0;
 
-  initContents.tag = VkInitialContents::Sparse;
-  initContents.type = eResBuffer;
+  byte *packed = NULL;
 
-  initContents.sparseBuffer.numBinds = numElems;
-  initContents.sparseBuffer.binds = new VkSparseMemoryBind[numElems];
-  initContents.sparseBuffer.numUniqueMems = (uint32_t)boundMems.size();
-  initContents.sparseBuffer.memDataOffs = new MemIDOffset[boundMems.size()];
+  for(uint32_t i = 0; i < numRegions; i++)
+  {
+    const SparseMemRegion &r = regions[i];
+
+    for(VkDeviceSize offs = 0; offs < r.size; offs += SparseZeroCheckSize)
+    {
+      const VkDeviceSize len = RDCMIN(SparseZeroCheckSize, r.size - offs);
+      const byte *src = contents + r.dataOffs + offs;
+
+      const bool zero = IsAllZero(src, (size_t)len);
+
+      // allocate the packed copy the first time we need to skip anything
+      if(zero && !packed)
+      {
+        VkDeviceSize total = 0;
+        for(uint32_t j = 0; j < numRegions; j++)
+          total += regions[j].size;
+
+        packed = AllocAlignedBuffer(total);
+        memcpy(packed, contents, (size_t)outSize);
+      }
 
-  memcpy(initContents.sparseBuffer.binds, &buf->record->resInfo->opaquemappings[0],
-         sizeof(VkSparseMemoryBind) * numElems);
+      SparseMemRegion *prev = outRegions.empty() ? NULL : &outRegions.back();
+
+      // extend the previous region if this is contiguous with it, in memory and in the data
+      if(prev && prev->memory == r.memory && prev->memOffs + prev->size == r.memOffs + offs &&
+         (zero ? prev->dataOffs == ~0ULL
+               : (prev->dataOffs != ~0ULL && prev->dataOffs + prev->size == outSize)))
+      {
+        prev->size += len;
+      }
+      else
+      {
+        outRegions.push_back({r.memory, r.memOffs + offs, len, zero ? ~0ULL : outSize});
+      }
+
+      if(!zero)
+      {
+        if(packed)
+          memcpy(packed + outSize, src, (size_t)len);
+        outSize += len;
+      }
+    }
+  }
+
+  return packed ? packed : contents;
+}
+
+MemoryAllocation WrappedVulkan::Prepare_SparseRegions(rdcarray<SparseMemRegion> &regions,
+                                                      VkDeviceSize &totalSize)
+{
+  // sort and merge the bound ranges, so that we copy each byte of memory at most once
+  std::sort(regions.begin(), regions.end(), [](const SparseMemRegion &a, const SparseMemRegion &b) {
+    if(a.memory != b.memory)
+      return a.memory < b.memory;
+    return a.memOffs < b.memOffs;
+  });
+
+  rdcarray<SparseMemRegion> merged;
+  merged.reserve(regions.size());
+
+  for(const SparseMemRegion &r : regions)
+  {
+    SparseMemRegion *prev = merged.empty() ? NULL : &merged.back();
+
+    if(prev && prev->memory == r.memory && r.memOffs <= prev->memOffs + prev->size)
+      prev->size = RDCMAX(prev->size, r.memOffs + r.size - prev->memOffs);
+    else
+      merged.push_back(r);
+  }
+
+  regions.swap(merged);
+
+  totalSize = 0;
+  for(SparseMemRegion &r : regions)
+  {
+    r.dataOffs = totalSize;
+    totalSize += r.size;
+  }
 
   VkDevice d = GetDev();
   // INITSTATEBATCH
@@ -108,26 +282,10 @@ bool WrappedVulkan::Prepare_SparseInitialState(WrappedVkBuffer *buf)
       VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
       NULL,
       0,
-      0,
+      RDCMAX(totalSize, (VkDeviceSize)4),
       VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
   };
 
-  uint32_t memidx = 0;
-  for(auto it = boundMems.begin(); it != boundMems.end(); ++it)
-  {
-    // store offset
-    it->second = bufInfo.size;
-
-    initContents.sparseBuffer.memDataOffs[memidx].memory = GetResID(it->first);
-    initContents.sparseBuffer.memDataOffs[memidx].memOffs = bufInfo.size;
-
-    // increase size
-    bufInfo.size += GetRecord(it->first)->Length;
-    memidx++;
-  }
-
-  initContents.sparseBuffer.totalSize = bufInfo.size;
-
   // since this happens during capture, we don't want to start serialising extra buffer creates, so
   // we manually create & then just wrap.
   VkBuffer dstBuf;
@@ -142,14 +300,11 @@ bool WrappedVulkan::Prepare_SparseInitialState(WrappedVkBuffer *buf)
   MemoryAllocation readbackmem =
       AllocateMemoryForResource(dstBuf, MemoryScope::InitialContents, MemoryType::Readback);
 
-  initContents.mem = readbackmem;
-
   vkr = ObjDisp(d)->BindBufferMemory(Unwrap(d), Unwrap(dstBuf), Unwrap(readbackmem.mem),
                                      readbackmem.offs);
   RDCASSERTEQUAL(vkr, VK_SUCCESS);
 
-  rdcarray<VkBuffer> bufdeletes;
-  bufdeletes.push_back(dstBuf);
+  m_InitStateBatch.buffers.push_back(dstBuf);
 
   VkCommandBufferBeginInfo beginInfo = {VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO, NULL,
                                         VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT};
@@ -157,40 +312,76 @@ bool WrappedVulkan::Prepare_SparseInitialState(WrappedVkBuffer *buf)
   vkr = ObjDisp(d)->BeginCommandBuffer(Unwrap(cmd), &beginInfo);
   RDCASSERTEQUAL(vkr, VK_SUCCESS);
 
-  // copy all of the bound memory objects
-  for(auto it = boundMems.begin(); it != boundMems.end(); ++it)
+  rdcarray<VkBufferCopy> copies;
+
+  // copy the bound ranges of each memory object
+  for(size_t i = 0; i < regions.size();)
   {
+    ResourceId memid = regions[i].memory;
+    VkDeviceMemory mem = GetResourceManager()->GetCurrentHandle<VkDeviceMemory>(memid);
+
+    copies.clear();
+    for(; i < regions.size() && regions[i].memory == memid; i++)
+      copies.push_back({regions[i].memOffs, regions[i].dataOffs, regions[i].size});
+
     VkBuffer srcBuf;
 
-    bufInfo.size = GetRecord(it->first)->Length;
+    bufInfo.size = GetRecord(mem)->Length;
     vkr = ObjDisp(d)->CreateBuffer(Unwrap(d), &bufInfo, NULL, &srcBuf);
     RDCASSERTEQUAL(vkr, VK_SUCCESS);
 
     GetResourceManager()->WrapResource(Unwrap(d), srcBuf);
 
-    vkr = ObjDisp(d)->BindBufferMemory(Unwrap(d), Unwrap(srcBuf), Unwrap(it->first), 0);
+    vkr = ObjDisp(d)->BindBufferMemory(Unwrap(d), Unwrap(srcBuf), Unwrap(mem), 0);
     RDCASSERTEQUAL(vkr, VK_SUCCESS);
 
-    // copy srcbuf into its area in dstbuf
-    VkBufferCopy region = {0, it->second, bufInfo.size};
-
-    ObjDisp(d)->CmdCopyBuffer(Unwrap(cmd), Unwrap(srcBuf), Unwrap(dstBuf), 1, &region);
+    ObjDisp(d)->CmdCopyBuffer(Unwrap(cmd), Unwrap(srcBuf), Unwrap(dstBuf), (uint32_t)copies.size(),
+                              copies.data());
 
-    bufdeletes.push_back(srcBuf);
+    m_InitStateBatch.buffers.push_back(srcBuf);
   }
 
   vkr = ObjDisp(d)->EndCommandBuffer(Unwrap(cmd));
   RDCASSERTEQUAL(vkr, VK_SUCCESS);
 
   // INITSTATEBATCH
-  SubmitCmds();
-  FlushQ();
+  SubmitInitStateCopy(totalSize);
 
-  for(size_t i = 0; i < bufdeletes.size(); i++)
-  {
-    ObjDisp(d)->DestroyBuffer(Unwrap(d), Unwrap(bufdeletes[i]), NULL);
-    GetResourceManager()->ReleaseWrappedResource(bufdeletes[i]);
-  }
+  return readbackmem;
+}
+
+bool WrappedVulkan::Prepare_SparseInitialState(WrappedVkBuffer *buf)
+{
+  ResourceId id = buf->id;
+
+  const rdcarray<VkSparseMemoryBind> &opaquemappings = buf->record->resInfo->opaquemappings;
+
+  // only the ranges of memory that are bound to the buffer are saved
+  rdcarray<SparseMemRegion> regions;
+  for(const VkSparseMemoryBind &bind : opaquemappings)
+    if(bind.memory != VK_NULL_HANDLE)
+      regions.push_back({GetResID(bind.memory), bind.memoryOffset, bind.size, 0});
+
+  uint32_t numElems = (uint32_t)opaquemappings.size();
+
+  VkInitialContents initContents;
+
+  initContents.tag = VkInitialContents::Sparse;
+  initContents.type = eResBuffer;
+
+  initContents.sparseBuffer.numBinds = numElems;
+  initContents.sparseBuffer.binds = new VkSparseMemoryBind[numElems];
+
+  if(numElems > 0)
+    memcpy(initContents.sparseBuffer.binds, &opaquemappings[0],
+           sizeof(VkSparseMemoryBind) * numElems);
+
+  initContents.mem = Prepare_SparseRegions(regions, initContents.sparseBuffer.totalSize);
+
+  initContents.sparseBuffer.numRegions = (uint32_t)regions.size();
+  initContents.sparseBuffer.regions = new SparseMemRegion[regions.size()];
+  if(!regions.empty())
+    memcpy(initContents.sparseBuffer.regions, regions.data(), regions.byteSize());
 
   GetResourceManager()->SetInitialContents(id, initContents);
 
@@ -203,26 +394,17 @@ bool WrappedVulkan::Prepare_SparseInitialState(WrappedVkImage *im)
 
   ResourceInfo *sparse = im->record->resInfo;
 
-  // VKTODOLOW this is a bit conservative, as we save the whole memory object rather than just the
-  // bound range.
-  std::map<VkDeviceMemory, VkDeviceSize> boundMems;
+  // the page size in bytes is the sparse block size, which is the required alignment
+  const VkDeviceSize pageSize = sparse->memreqs.alignment;
 
-  // value will be filled out later once all memories are added
-  for(size_t i = 0; i < sparse->opaquemappings.size(); i++)
-    boundMems[sparse->opaquemappings[i].memory] = 0;
+  // only the ranges of memory that are bound, either opaquely or to resident pages, are saved
+  rdcarray<SparseMemRegion> regions;
+  for(const VkSparseMemoryBind &bind : sparse->opaquemappings)
+    if(bind.memory != VK_NULL_HANDLE)
+      regions.push_back({GetResID(bind.memory), bind.memoryOffset, bind.size, 0});
 
   uint32_t pagePerAspect = sparse->imgdim.width * sparse->imgdim.height * sparse->imgdim.depth;
 
-  for(uint32_t a = 0; a < NUM_VK_IMAGE_ASPECTS; a++)
-  {
-    if(sparse->pages[a])
-    {
-      for(uint32_t i = 0; i < pagePerAspect; i++)
-        if(sparse->pages[a][i].first != VK_NULL_HANDLE)
-          boundMems[sparse->pages[a][i].first] = 0;
-    }
-  }
-
   uint32_t opaqueCount = (uint32_t)sparse->opaquemappings.size();
 
   VkInitialContents initContents;
@@ -236,123 +418,51 @@ bool WrappedVulkan::Prepare_SparseInitialState(WrappedVkImage *im)
   sparseInit.opaque = new VkSparseMemoryBind[opaqueCount];
   sparseInit.imgdim = sparse->imgdim;
   sparseInit.pagedim = sparse->pagedim;
-  sparseInit.numUniqueMems = (uint32_t)boundMems.size();
-  sparseInit.memDataOffs = new MemIDOffset[boundMems.size()];
+  sparseInit.pageSize = pageSize;
+  sparseInit.pageAspects = 0;
 
   if(opaqueCount > 0)
     memcpy(sparseInit.opaque, &sparse->opaquemappings[0], sizeof(VkSparseMemoryBind) * opaqueCount);
 
-  for(uint32_t a = 0; a < NUM_VK_IMAGE_ASPECTS; a++)
-  {
-    sparseInit.pageCount[a] = (sparse->pages[a] ? pagePerAspect : 0);
-
-    if(sparseInit.pageCount[a] != 0)
-    {
-      sparseInit.pages[a] = new MemIDOffset[pagePerAspect];
-
-      for(uint32_t i = 0; i < pagePerAspect; i++)
-      {
-        sparseInit.pages[a][i].memory = GetResID(sparse->pages[a][i].first);
-        sparseInit.pages[a][i].memOffs = sparse->pages[a][i].second;
-      }
-    }
-    else
-    {
-      sparseInit.pages[a] = NULL;
-    }
-  }
-
-  VkDevice d = GetDev();
-  // INITSTATEBATCH
-  VkCommandBuffer cmd = GetNextCmd();
-
-  VkBufferCreateInfo bufInfo = {
-      VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
-      NULL,
-      0,
-      0,
-      VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-  };
+  rdcarray<SparsePageBind> resident;
 
-  uint32_t memidx = 0;
-  for(auto it = boundMems.begin(); it != boundMems.end(); ++it)
+  for(uint32_t a = 0; a < NUM_VK_IMAGE_ASPECTS; a++)
   {
-    // store offset
-    it->second = bufInfo.size;
+    sparseInit.pages[a] = NULL;
+    sparseInit.pageCount[a] = 0;
 
-    sparseInit.memDataOffs[memidx].memory = GetResID(it->first);
-    sparseInit.memDataOffs[memidx].memOffs = bufInfo.size;
+    if(!sparse->pages[a])
+      continue;
 
-    // increase size
-    bufInfo.size += GetRecord(it->first)->Length;
-    memidx++;
-  }
-
-  sparseInit.totalSize = bufInfo.size;
-
-  // since this happens during capture, we don't want to start serialising extra buffer creates, so
-  // we manually create & then just wrap.
-  VkBuffer dstBuf;
-
-  VkResult vkr = VK_SUCCESS;
-
-  vkr = ObjDisp(d)->CreateBuffer(Unwrap(d), &bufInfo, NULL, &dstBuf);
-  RDCASSERTEQUAL(vkr, VK_SUCCESS);
-
-  GetResourceManager()->WrapResource(Unwrap(d), dstBuf);
-
-  MemoryAllocation readbackmem =
-      AllocateMemoryForResource(dstBuf, MemoryScope::InitialContents, MemoryType::Readback);
+    sparseInit.pageAspects |= 1U << a;
 
-  initContents.mem = readbackmem;
+    resident.clear();
 
-  vkr = ObjDisp(d)->BindBufferMemory(Unwrap(d), Unwrap(dstBuf), Unwrap(readbackmem.mem),
-                                     readbackmem.offs);
-  RDCASSERTEQUAL(vkr, VK_SUCCESS);
-
-  rdcarray<VkBuffer> bufdeletes;
-  bufdeletes.push_back(dstBuf);
-
-  VkCommandBufferBeginInfo beginInfo = {VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO, NULL,
-                                        VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT};
-
-  vkr = ObjDisp(d)->BeginCommandBuffer(Unwrap(cmd), &beginInfo);
-  RDCASSERTEQUAL(vkr, VK_SUCCESS);
-
-  // copy all of the bound memory objects
-  for(auto it = boundMems.begin(); it != boundMems.end(); ++it)
-  {
-    VkBuffer srcBuf;
-
-    bufInfo.size = GetRecord(it->first)->Length;
-    vkr = ObjDisp(d)->CreateBuffer(Unwrap(d), &bufInfo, NULL, &srcBuf);
-    RDCASSERTEQUAL(vkr, VK_SUCCESS);
-
-    GetResourceManager()->WrapResource(Unwrap(d), srcBuf);
-
-    vkr = ObjDisp(d)->BindBufferMemory(Unwrap(d), Unwrap(srcBuf), Unwrap(it->first), 0);
-    RDCASSERTEQUAL(vkr, VK_SUCCESS);
+    for(uint32_t i = 0; i < pagePerAspect; i++)
+    {
+      const rdcpair<VkDeviceMemory, VkDeviceSize> &page = sparse->pages[a][i];
 
-    // copy srcbuf into its area in dstbuf
-    VkBufferCopy region = {0, it->second, bufInfo.size};
+      if(page.first == VK_NULL_HANDLE)
+        continue;
 
-    ObjDisp(d)->CmdCopyBuffer(Unwrap(cmd), Unwrap(srcBuf), Unwrap(dstBuf), 1, &region);
+      resident.push_back({i, GetResID(page.first), page.second});
+      regions.push_back({GetResID(page.first), page.second, pageSize, 0});
+    }
 
-    bufdeletes.push_back(srcBuf);
+    if(!resident.empty())
+    {
+      sparseInit.pageCount[a] = (uint32_t)resident.size();
+      sparseInit.pages[a] = new SparsePageBind[resident.size()];
+      memcpy(sparseInit.pages[a], resident.data(), resident.byteSize());
+    }
   }
 
-  vkr = ObjDisp(d)->EndCommandBuffer(Unwrap(cmd));
-  RDCASSERTEQUAL(vkr, VK_SUCCESS);
+  initContents.mem = Prepare_SparseRegions(regions, sparseInit.totalSize);
 
-  // INITSTATEBATCH
-  SubmitCmds();
-  FlushQ();
-
-  for(size_t i = 0; i < bufdeletes.size(); i++)
-  {
-    ObjDisp(d)->DestroyBuffer(Unwrap(d), Unwrap(bufdeletes[i]), NULL);
-    GetResourceManager()->ReleaseWrappedResource(bufdeletes[i]);
-  }
+  sparseInit.numRegions = (uint32_t)regions.size();
+  sparseInit.regions = new SparseMemRegion[regions.size()];
+  if(!regions.empty())
+    memcpy(sparseInit.regions, regions.data(), regions.byteSize());
 
   GetResourceManager()->SetInitialContents(id, initContents);
 
@@ -371,11 +481,12 @@ uint64_t WrappedVulkan::GetSize_SparseInitialState(ResourceId id, const VkInitia
     // the list of memory objects bound
     ret += 8 + sizeof(VkSparseMemoryBind) * info.numBinds;
 
-    // the list of memory regions to copy
-    ret += 8 + sizeof(MemIDOffset) * info.numUniqueMems;
+    // the list of memory regions to copy. Splitting off zero data can add a region per zero run
+    ret += 8 + sizeof(SparseMemRegion) * info.numRegions * 2;
+    ret += sizeof(SparseMemRegion) * (info.totalSize / SparseZeroCheckSize);
 
     // the actual data
-    ret += uint64_t(info.totalSize + WriteSerialiser::GetChunkAlignment());
+    ret += uint64_t(info.totalSize + WriteSerialiser::GetBufferOverhead());
 
     return ret;
   }
@@ -392,15 +503,16 @@ uint64_t WrappedVulkan::GetSize_SparseInitialState(ResourceId id, const VkInitia
     // the list of memory objects bound
     ret += sizeof(VkSparseMemoryBind) * info.opaqueCount;
 
-    // the page tables
+    // the resident pages
     for(uint32_t a = 0; a < NUM_VK_IMAGE_ASPECTS; a++)
-      ret += 8 + sizeof(MemIDOffset) * info.pageCount[a];
+      ret += 8 + sizeof(SparsePageBind) * info.pageCount[a];
 
-    // the list of memory regions to copy
-    ret += sizeof(MemIDOffset) * info.numUniqueMems;
+    // the list of memory regions to copy. Splitting off zero data can add a region per zero run
+    ret += 8 + sizeof(SparseMemRegion) * info.numRegions * 2;
+    ret += sizeof(SparseMemRegion) * (info.totalSize / SparseZeroCheckSize);
 
     // the actual data
-    ret += uint64_t(info.totalSize + WriteSerialiser::GetChunkAlignment());
+    ret += uint64_t(info.totalSize + WriteSerialiser::GetBufferOverhead());
 
     return ret;
   }
@@ -416,18 +528,13 @@ bool WrappedVulkan::Serialise_SparseBufferInitialState(SerialiserType &ser, Reso
   VkDevice d = !IsStructuredExporting(m_State) ? GetDev() : VK_NULL_HANDLE;
   VkResult vkr = VK_SUCCESS;
 
-  SERIALISE_ELEMENT_LOCAL(SparseState, contents->sparseBuffer);
-
   MemoryAllocation mappedMem;
   byte *Contents = NULL;
-  uint64_t ContentsSize = (uint64_t)SparseState.totalSize;
 
-  // Serialise this separately so that it can be used on reading to prepare the upload memory
-  SERIALISE_ELEMENT(ContentsSize);
-
-  // the memory/buffer that we allocated on read, to upload the initial contents.
-  MemoryAllocation uploadMemory;
-  VkBuffer uploadBuf = VK_NULL_HANDLE;
+  // when writing, all-zero data is split off and the rest is packed into here if necessary
+  SparseBufferInitState writeState = {};
+  rdcarray<SparseMemRegion> writeRegions;
+  byte *packedContents = NULL;
 
   // during writing, we already have the memory copied off - we just need to map it.
   if(ser.IsWriting())
@@ -449,15 +556,37 @@ bool WrappedVulkan::Serialise_SparseBufferInitialState(SerialiserType &ser, Reso
 
     vkr = ObjDisp(d)->InvalidateMappedMemoryRanges(Unwrap(d), 1, &range);
     RDCASSERTEQUAL(vkr, VK_SUCCESS);
+
+    writeState = contents->sparseBuffer;
+
+    byte *packed = RemoveZeroSparseData(writeState.regions, writeState.numRegions, Contents,
+                                        writeRegions, writeState.totalSize);
+    if(packed != Contents)
+      packedContents = Contents = packed;
+
+    writeState.regions = writeRegions.data();
+    writeState.numRegions = (uint32_t)writeRegions.size();
   }
-  else if(IsReplayingAndReading() && !ser.IsErrored())
+
+  SERIALISE_ELEMENT_LOCAL(SparseState, writeState);
+
+  uint64_t ContentsSize = (uint64_t)SparseState.totalSize;
+
+  // Serialise this separately so that it can be used on reading to prepare the upload memory
+  SERIALISE_ELEMENT(ContentsSize);
+
+  // the memory/buffer that we allocated on read, to upload the initial contents.
+  MemoryAllocation uploadMemory;
+  VkBuffer uploadBuf = VK_NULL_HANDLE;
+
+  if(IsReplayingAndReading() && !ser.IsErrored())
   {
     // create a buffer with memory attached, which we will fill with the initial contents
     VkBufferCreateInfo bufInfo = {
         VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
         NULL,
         0,
-        ContentsSize,
+        RDCMAX(ContentsSize, (uint64_t)4),
         VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
     };
 
@@ -483,6 +612,8 @@ bool WrappedVulkan::Serialise_SparseBufferInitialState(SerialiserType &ser, Reso
   // directly into upload memory
   ser.Serialise("Contents"_lit, Contents, ContentsSize, SerialiserFlags::NoFlags);
 
+  FreeAlignedBuffer(packedContents);
+
   // unmap the resource we mapped before - we need to do this on read and on write.
   if(!IsStructuredExporting(m_State) && mappedMem.mem != VK_NULL_HANDLE)
   {
@@ -532,18 +663,13 @@ bool WrappedVulkan::Serialise_SparseImageInitialState(SerialiserType &ser, Resou
   VkDevice d = !IsStructuredExporting(m_State) ? GetDev() : VK_NULL_HANDLE;
   VkResult vkr = VK_SUCCESS;
 
-  SERIALISE_ELEMENT_LOCAL(SparseState, contents->sparseImage);
-
   MemoryAllocation mappedMem;
   byte *Contents = NULL;
-  uint64_t ContentsSize = (uint64_t)SparseState.totalSize;
-
-  // Serialise this separately so that it can be used on reading to prepare the upload memory
-  SERIALISE_ELEMENT(ContentsSize);
 
-  // the memory/buffer that we allocated on read, to upload the initial contents.
-  MemoryAllocation uploadMemory;
-  VkBuffer uploadBuf = VK_NULL_HANDLE;
+  // when writing, all-zero data is split off and the rest is packed into here if necessary
+  SparseImageInitState writeState = {};
+  rdcarray<SparseMemRegion> writeRegions;
+  byte *packedContents = NULL;
 
   // during writing, we already have the memory copied off - we just need to map it.
   if(ser.IsWriting())
@@ -552,15 +678,37 @@ bool WrappedVulkan::Serialise_SparseImageInitialState(SerialiserType &ser, Resou
     vkr = ObjDisp(d)->MapMemory(Unwrap(d), Unwrap(mappedMem.mem), mappedMem.offs, mappedMem.size, 0,
                                 (void **)&Contents);
     RDCASSERTEQUAL(vkr, VK_SUCCESS);
+
+    writeState = contents->sparseImage;
+
+    byte *packed = RemoveZeroSparseData(writeState.regions, writeState.numRegions, Contents,
+                                        writeRegions, writeState.totalSize);
+    if(packed != Contents)
+      packedContents = Contents = packed;
+
+    writeState.regions = writeRegions.data();
+    writeState.numRegions = (uint32_t)writeRegions.size();
   }
-  else if(IsReplayingAndReading() && !ser.IsErrored())
+
+  SERIALISE_ELEMENT_LOCAL(SparseState, writeState);
+
+  uint64_t ContentsSize = (uint64_t)SparseState.totalSize;
+
+  // Serialise this separately so that it can be used on reading to prepare the upload memory
+  SERIALISE_ELEMENT(ContentsSize);
+
+  // the memory/buffer that we allocated on read, to upload the initial contents.
+  MemoryAllocation uploadMemory;
+  VkBuffer uploadBuf = VK_NULL_HANDLE;
+
+  if(IsReplayingAndReading() && !ser.IsErrored())
   {
     // create a buffer with memory attached, which we will fill with the initial contents
     VkBufferCreateInfo bufInfo = {
         VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
         NULL,
         0,
-        ContentsSize,
+        RDCMAX(ContentsSize, (uint64_t)4),
         VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
     };
 
@@ -586,6 +734,8 @@ bool WrappedVulkan::Serialise_SparseImageInitialState(SerialiserType &ser, Resou
   // directly into upload memory
   ser.Serialise("Contents"_lit, Contents, ContentsSize, SerialiserFlags::NoFlags);
 
+  FreeAlignedBuffer(packedContents);
+
   // unmap the resource we mapped before - we need to do this on read and on write.
   if(!IsStructuredExporting(m_State) && mappedMem.mem != VK_NULL_HANDLE)
     ObjDisp(d)->UnmapMemory(Unwrap(d), Unwrap(mappedMem.mem));
@@ -601,42 +751,66 @@ bool WrappedVulkan::Serialise_SparseImageInitialState(SerialiserType &ser, Resou
     initContents.tag = VkInitialContents::Sparse;
     initContents.sparseImage = SparseState;
 
+    const VkExtent3D &imgdim = SparseState.imgdim;
+    const VkExtent3D &pagedim = SparseState.pagedim;
+
+    rdcarray<VkSparseImageMemoryBind> binds;
+
     for(uint32_t a = 0; a < NUM_VK_IMAGE_ASPECTS; a++)
     {
+      initContents.sparseImage.pageBinds[a] = NULL;
+      initContents.sparseImage.pageBindCount[a] = 0;
+
       if(SparseState.pageCount[a] == 0)
+        continue;
+
+      binds.clear();
+
+      for(uint32_t i = 0; i < SparseState.pageCount[a]; i++)
       {
-        initContents.sparseImage.pageBinds[a] = NULL;
-      }
-      else
-      {
-        initContents.sparseImage.pageBinds[a] = new VkSparseImageMemoryBind[SparseState.pageCount[a]];
+        const SparsePageBind &page = SparseState.pages[a][i];
+
+        VkDeviceMemory mem =
+            Unwrap(GetResourceManager()->GetLiveHandle<VkDeviceMemory>(page.memory));
 
-        uint32_t i = 0;
+        VkOffset3D offset = {
+            int32_t((page.page % imgdim.width) * pagedim.width),
+            int32_t(((page.page / imgdim.width) % imgdim.height) * pagedim.height),
+            int32_t((page.page / (imgdim.width * imgdim.height)) * pagedim.depth),
+        };
 
-        for(uint32_t z = 0; z < SparseState.imgdim.depth; z++)
+        // merge runs of pages along a row that are also contiguous in memory, so that they can be
+        // bound together
+        if(!binds.empty() && SparseState.pageSize > 0)
         {
-          for(uint32_t y = 0; y < SparseState.imgdim.height; y++)
+          VkSparseImageMemoryBind &prev = binds.back();
+
+          const VkDeviceSize prevPages = prev.extent.width / pagedim.width;
+
+          if(prev.memory == mem && prev.offset.y == offset.y && prev.offset.z == offset.z &&
+             prev.offset.x + int32_t(prev.extent.width) == offset.x &&
+             prev.memoryOffset + prevPages * SparseState.pageSize == page.memOffs)
           {
-            for(uint32_t x = 0; x < SparseState.imgdim.width; x++)
-            {
-              VkSparseImageMemoryBind &p = initContents.sparseImage.pageBinds[a][i];
-
-              p.memory = Unwrap(GetResourceManager()->GetLiveHandle<VkDeviceMemory>(
-                  SparseState.pages[a][i].memory));
-              p.memoryOffset = SparseState.pages[a][i].memOffs;
-              p.extent = SparseState.pagedim;
-              p.subresource.aspectMask = (VkImageAspectFlags)(1 << a);
-              p.subresource.arrayLayer = 0;
-              p.subresource.mipLevel = 0;
-              p.offset.x = x * p.extent.width;
-              p.offset.y = y * p.extent.height;
-              p.offset.z = z * p.extent.depth;
-
-              i++;
-            }
+            prev.extent.width += pagedim.width;
+            continue;
           }
         }
+
+        VkSparseImageMemoryBind p = {};
+        p.subresource.aspectMask = (VkImageAspectFlags)(1 << a);
+        p.subresource.arrayLayer = 0;
+        p.subresource.mipLevel = 0;
+        p.offset = offset;
+        p.extent = pagedim;
+        p.memory = mem;
+        p.memoryOffset = page.memOffs;
+
+        binds.push_back(p);
       }
+
+      initContents.sparseImage.pageBindCount[a] = (uint32_t)binds.size();
+      initContents.sparseImage.pageBinds[a] = new VkSparseImageMemoryBind[binds.size()];
+      memcpy(initContents.sparseImage.pageBinds[a], binds.data(), binds.byteSize());
     }
 
     // delete and free the pages array, we no longer need it.
@@ -662,6 +836,49 @@ template bool WrappedVulkan::Serialise_SparseImageInitialState(ReadSerialiser &s
 template bool WrappedVulkan::Serialise_SparseImageInitialState(WriteSerialiser &ser, ResourceId id,
                                                                const VkInitialContents *contents);
 
+void WrappedVulkan::Apply_SparseRegions(VkCommandBuffer cmd, VkBuffer srcBuf,
+                                        const SparseMemRegion *regions, uint32_t numRegions)
+{
+  rdcarray<VkBufferCopy> copies;
+
+  for(uint32_t i = 0; i < numRegions;)
+  {
+    const ResourceId memid = regions[i].memory;
+
+    VkDeviceMemory dstMem = GetResourceManager()->GetLiveHandle<VkDeviceMemory>(memid);
+
+    ResourceId id = GetResID(dstMem);
+
+    VkBuffer dstBuf = m_CreationInfo.m_Memory[id].wholeMemBuf;
+
+    VkDeviceSize memSize = m_CreationInfo.m_Memory[id].size;
+
+    // copy all of the regions in the same memory at once. Zero regions are filled instead
+    copies.clear();
+    for(; i < numRegions && regions[i].memory == memid; i++)
+    {
+      const SparseMemRegion &r = regions[i];
+
+      // older captures stored the whole memory from the given offset
+      VkDeviceSize size = r.size == VK_WHOLE_SIZE ? memSize - r.memOffs : r.size;
+
+      if(dstBuf == VK_NULL_HANDLE)
+        continue;
+
+      if(r.dataOffs == ~0ULL)
+        ObjDisp(cmd)->CmdFillBuffer(Unwrap(cmd), Unwrap(dstBuf), r.memOffs, size, 0);
+      else
+        copies.push_back({r.dataOffs, r.memOffs, size});
+    }
+
+    if(dstBuf == VK_NULL_HANDLE)
+      RDCERR("Whole memory buffer not present for %s", ToStr(id).c_str());
+    else if(!copies.empty())
+      ObjDisp(cmd)->CmdCopyBuffer(Unwrap(cmd), Unwrap(srcBuf), Unwrap(dstBuf),
+                                  (uint32_t)copies.size(), copies.data());
+  }
+}
+
 bool WrappedVulkan::Apply_SparseInitialState(WrappedVkBuffer *buf, const VkInitialContents &contents)
 {
   const SparseBufferInitState &info = contents.sparseBuffer;
@@ -732,25 +949,7 @@ bool WrappedVulkan::Apply_SparseInitialState(WrappedVkBuffer *buf, const VkIniti
   vkr = ObjDisp(cmd)->BeginCommandBuffer(Unwrap(cmd), &beginInfo);
   RDCASSERTEQUAL(vkr, VK_SUCCESS);
 
-  for(uint32_t i = 0; i < info.numUniqueMems; i++)
-  {
-    VkDeviceMemory dstMem =
-        GetResourceManager()->GetLiveHandle<VkDeviceMemory>(info.memDataOffs[i].memory);
-
-    ResourceId id = GetResID(dstMem);
-
-    VkBuffer dstBuf = m_CreationInfo.m_Memory[id].wholeMemBuf;
-
-    VkDeviceSize size = m_CreationInfo.m_Memory[id].size;
-
-    // fill the whole memory from the given offset
-    VkBufferCopy region = {info.memDataOffs[i].memOffs, 0, size};
-
-    if(dstBuf != VK_NULL_HANDLE)
-      ObjDisp(cmd)->CmdCopyBuffer(Unwrap(cmd), Unwrap(srcBuf), Unwrap(dstBuf), 1, &region);
-    else
-      RDCERR("Whole memory buffer not present for %s", ToStr(id).c_str());
-  }
+  Apply_SparseRegions(cmd, srcBuf, info.regions, info.numRegions);
 
   vkr = ObjDisp(cmd)->EndCommandBuffer(Unwrap(cmd));
   RDCASSERTEQUAL(vkr, VK_SUCCESS);
@@ -821,10 +1020,17 @@ bool WrappedVulkan::Apply_SparseInitialState(WrappedVkImage *im, const VkInitial
     SubmitSemaphores();
   }
 
+  if(info.pageAspects)
   {
+    // unbind the whole page table of each aspect, then bind the resident pages. As with opaque
+    // binds, a semaphore is needed to order the two batches.
+    VkSparseImageMemoryBind unbinds[NUM_VK_IMAGE_ASPECTS];
     VkSparseImageMemoryBindInfo imgBinds[NUM_VK_IMAGE_ASPECTS];
+    RDCEraseEl(unbinds);
     RDCEraseEl(imgBinds);
 
+    VkSemaphore sem = GetNextSemaphore();
+
     VkBindSparseInfo bindsparse = {
         VK_STRUCTURE_TYPE_BIND_SPARSE_INFO,
         NULL,
@@ -836,24 +1042,60 @@ bool WrappedVulkan::Apply_SparseInitialState(WrappedVkImage *im, const VkInitial
         NULL,    // opaque bind
         0,
         imgBinds,
-        0,
-        NULL,    // signal semaphores
+        1,
+        UnwrapPtr(sem),    // signal semaphores
     };
 
-    // blat the page tables
     for(uint32_t a = 0; a < NUM_VK_IMAGE_ASPECTS; a++)
     {
-      if(!info.pageBinds[a])
+      if((info.pageAspects & (1U << a)) == 0)
         continue;
 
+      VkSparseImageMemoryBind &unbind = unbinds[bindsparse.imageBindCount];
+
+      unbind.subresource.aspectMask = (VkImageAspectFlags)(1 << a);
+      unbind.extent.width = info.imgdim.width * info.pagedim.width;
+      unbind.extent.height = info.imgdim.height * info.pagedim.height;
+      unbind.extent.depth = info.imgdim.depth * info.pagedim.depth;
+
       imgBinds[bindsparse.imageBindCount].image = im->real.As<VkImage>();
-      imgBinds[bindsparse.imageBindCount].bindCount = info.pageCount[a];
-      imgBinds[bindsparse.imageBindCount].pBinds = info.pageBinds[a];
+      imgBinds[bindsparse.imageBindCount].bindCount = 1;
+      imgBinds[bindsparse.imageBindCount].pBinds = &unbind;
 
       bindsparse.imageBindCount++;
     }
 
     ObjDisp(q)->QueueBindSparse(Unwrap(q), 1, &bindsparse, VK_NULL_HANDLE);
+
+    bindsparse.imageBindCount = 0;
+
+    for(uint32_t a = 0; a < NUM_VK_IMAGE_ASPECTS; a++)
+    {
+      if(!info.pageBinds[a] || info.pageBindCount[a] == 0)
+        continue;
+
+      imgBinds[bindsparse.imageBindCount].image = im->real.As<VkImage>();
+      imgBinds[bindsparse.imageBindCount].bindCount = info.pageBindCount[a];
+      imgBinds[bindsparse.imageBindCount].pBinds = info.pageBinds[a];
+
+      bindsparse.imageBindCount++;
+    }
+
+    if(bindsparse.imageBindCount > 0)
+    {
+      // wait for unbind semaphore
+      bindsparse.waitSemaphoreCount = 1;
+      bindsparse.pWaitSemaphores = bindsparse.pSignalSemaphores;
+
+      bindsparse.signalSemaphoreCount = 0;
+      bindsparse.pSignalSemaphores = NULL;
+
+      ObjDisp(q)->QueueBindSparse(Unwrap(q), 1, &bindsparse, VK_NULL_HANDLE);
+    }
+
+    // marks that the above semaphore has been used, so next time we
+    // flush it will be moved back to the pool
+    SubmitSemaphores();
   }
 
   VkResult vkr = VK_SUCCESS;
@@ -868,26 +1110,7 @@ bool WrappedVulkan::Apply_SparseInitialState(WrappedVkImage *im, const VkInitial
   vkr = ObjDisp(cmd)->BeginCommandBuffer(Unwrap(cmd), &beginInfo);
   RDCASSERTEQUAL(vkr, VK_SUCCESS);
 
-  for(uint32_t i = 0; i < info.numUniqueMems; i++)
-  {
-    VkDeviceMemory dstMem =
-        GetResourceManager()->GetLiveHandle<VkDeviceMemory>(info.memDataOffs[i].memory);
-
-    ResourceId id = GetResID(dstMem);
-
-    // since this is short lived it isn't wrapped. Note that we want
-    // to cache this up front, so it will then be wrapped
-    VkBuffer dstBuf = m_CreationInfo.m_Memory[id].wholeMemBuf;
-    VkDeviceSize size = m_CreationInfo.m_Memory[id].size;
-
-    // fill the whole memory from the given offset
-    VkBufferCopy region = {info.memDataOffs[i].memOffs, 0, size};
-
-    if(dstBuf != VK_NULL_HANDLE)
-      ObjDisp(cmd)->CmdCopyBuffer(Unwrap(cmd), Unwrap(srcBuf), Unwrap(dstBuf), 1, &region);
-    else
-      RDCERR("Whole memory buffer not present for %s", ToStr(id).c_str());
-  }
+  Apply_SparseRegions(cmd, srcBuf, info.regions, info.numRegions);
 
   vkr = ObjDisp(cmd)->EndCommandBuffer(Unwrap(cmd));
   RDCASSERTEQUAL(vkr, VK_SUCCESS);
@@ -136,7 +136,7 @@ void VulkanRenderState::BindPipeline(WrappedVulkan *vk, VkCommandBuffer cmd,
   if(graphics.pipeline != ResourceId() && binding == BindGraphics)
   {
     VkPipeline pipe = vk->GetResourceManager()->GetCurrentHandle<VkPipeline>(graphics.pipeline);
-    const VulkanCreationInfo::Pipeline pipeinfo =
+    const VulkanCreationInfo::Pipeline &pipeinfo =
         vk->GetDebugManager()->GetPipelineInfo(graphics.pipeline);
 
     if(subpass0 && pipeinfo.subpass0pipe != VK_NULL_HANDLE)
@@ -230,15 +230,33 @@ void VulkanRenderState::BindPipeline(WrappedVulkan *vk, VkCommandBuffer cmd,
           ibuffer.offs, type);
     }
 
-    for(size_t i = 0; i < vbuffers.size(); i++)
+    // bind each contiguous run of vertex buffers with a single call
     {
-      if(vbuffers[i].buf == ResourceId())
-        continue;
+      VkBuffer vbs[32];
+      VkDeviceSize offs[32];
+      uint32_t first = 0, count = 0;
 
-      ObjDisp(cmd)->CmdBindVertexBuffers(
-          Unwrap(cmd), (uint32_t)i, 1,
-          UnwrapPtr(vk->GetResourceManager()->GetCurrentHandle<VkBuffer>(vbuffers[i].buf)),
-          &vbuffers[i].offs);
+      for(size_t i = 0; i < vbuffers.size(); i++)
+      {
+        if(count > 0 && (vbuffers[i].buf == ResourceId() || count == ARRAY_COUNT(vbs)))
+        {
+          ObjDisp(cmd)->CmdBindVertexBuffers(Unwrap(cmd), first, count, vbs, offs);
+          count = 0;
+        }
+
+        if(vbuffers[i].buf == ResourceId())
+          continue;
+
+        if(count == 0)
+          first = (uint32_t)i;
+
+        vbs[count] = Unwrap(vk->GetResourceManager()->GetCurrentHandle<VkBuffer>(vbuffers[i].buf));
+        offs[count] = vbuffers[i].offs;
+        count++;
+      }
+
+      if(count > 0)
+        ObjDisp(cmd)->CmdBindVertexBuffers(Unwrap(cmd), first, count, vbs, offs);
     }
 
     for(size_t i = 0; i < xfbbuffers.size(); i++)
@@ -89,6 +89,10 @@ void WrappedVulkan::AddRequiredExtensions(bool instance, rdcarray<rdcstr> &exten
 {
   bool device = !instance;
 
+  // in headless replay we don't enable any WSI, so the replay never touches presentation
+  if(RenderDoc::Inst().GetGlobalEnvironment().headless)
+    return;
+
   if(instance)
   {
     // for windows we require both extensions as there's no alternative
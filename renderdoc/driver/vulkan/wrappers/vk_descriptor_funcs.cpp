@@ -587,6 +587,9 @@ void WrappedVulkan::ReplayDescriptorSetWrite(VkDevice device, const VkWriteDescr
   if(writeDesc.descriptorCount == 0)
     return;
 
+  if(!m_RerecordCache.empty())
+    RerecordCacheSetWritten(GetResID(writeDesc.dstSet));
+
   const DescSetLayout &layout =
       m_CreationInfo.m_DescSetLayout[m_DescriptorSetState[GetResID(writeDesc.dstSet)].layout];
 
@@ -742,6 +745,9 @@ void WrappedVulkan::ReplayDescriptorSetCopy(VkDevice device, const VkCopyDescrip
   ObjDisp(device)->UpdateDescriptorSets(Unwrap(device), 0, NULL, 1, &unwrapped);
 
   ResourceId dstSetId = GetResID(copyDesc.dstSet);
+
+  if(!m_RerecordCache.empty())
+    RerecordCacheSetWritten(dstSetId);
   ResourceId srcSetId = GetResID(copyDesc.srcSet);
 
   // update our local tracking
@@ -821,6 +827,135 @@ bool WrappedVulkan::Serialise_vkUpdateDescriptorSets(SerialiserType &ser, VkDevi
   return true;
 }
 
+DescriptorSetSlot *WrappedVulkan::DeferDescriptorWrite(VkResourceRecord *record, uint32_t binding,
+                                                     uint32_t arrayElement, uint32_t count,
+                                                     VkDescriptorType type, bool setSampler,
+                                                     bool setImageView)
+{
+  // writable bindings are needed on every submit to track dirty resources, so aren't deferred
+  if(!m_DeferDescriptorShadowing || !IsBackgroundCapturing(m_State) ||
+     GetRefType(type) != eFrameRef_Read)
+    return NULL;
+
+  DescriptorSetData *descInfo = record->descInfo;
+
+  // don't let the journal grow much beyond the size of the set itself, for sets that are
+  // repeatedly updated but never copied from or captured
+  uint32_t numSlots = 0;
+  for(const DescSetLayout::Binding &b : descInfo->layout->bindings)
+    numSlots += b.descriptorCount;
+
+  if(descInfo->deferredSlots.size() + count > RDCMAX(numSlots, 256U))
+    ApplyDeferredDescriptorWrites(record);
+
+  if(!descInfo->deferredListed)
+  {
+    SCOPED_LOCK(m_DeferredDescriptorSetsLock);
+
+    descInfo->deferredListed = true;
+    m_DeferredDescriptorSets.push_back(record->GetResourceID());
+
+    // sets are often allocated and freed every frame, so drop any that have gone away
+    if(m_DeferredDescriptorSets.size() >= m_DeferredDescriptorSetsPruneSize)
+    {
+      size_t keep = 0;
+      for(size_t i = 0; i < m_DeferredDescriptorSets.size(); i++)
+      {
+        if(GetResourceManager()->HasResourceRecord(m_DeferredDescriptorSets[i]))
+          m_DeferredDescriptorSets[keep++] = m_DeferredDescriptorSets[i];
+      }
+      m_DeferredDescriptorSets.resize(keep);
+
+      m_DeferredDescriptorSetsPruneSize = RDCMAX((size_t)1024, keep * 2);
+    }
+  }
+
+  DescriptorSetData::DeferredWrite write = {binding,    arrayElement, count,
+                                            type,       setSampler,   setImageView};
+  descInfo->deferredWrites.push_back(write);
+
+  size_t first = descInfo->deferredSlots.size();
+  descInfo->deferredSlots.resize(first + count);
+  return &descInfo->deferredSlots[first];
+}
+
+void WrappedVulkan::ApplyDeferredDescriptorWrites(VkResourceRecord *record)
+{
+  DescriptorSetData *descInfo = record->descInfo;
+
+  if(descInfo->deferredWrites.empty())
+    return;
+
+  const DescSetLayout &layout = *descInfo->layout;
+  const DescriptorSetSlot *src = descInfo->deferredSlots.data();
+
+  for(const DescriptorSetData::DeferredWrite &write : descInfo->deferredWrites)
+  {
+    DescriptorSetSlot **binding = &descInfo->descBindings[write.binding];
+    const DescSetLayout::Binding *layoutBinding = &layout.bindings[write.binding];
+
+    // roll over onto subsequent bindings the same way as the original update
+    uint32_t curIdx = write.arrayElement;
+
+    for(uint32_t d = 0; d < write.count; d++, curIdx++, src++)
+    {
+      if(curIdx >= layoutBinding->descriptorCount)
+      {
+        layoutBinding++;
+        binding++;
+        curIdx = 0;
+      }
+
+      DescriptorSetSlot &bind = (*binding)[curIdx];
+
+      if(write.type == VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER)
+      {
+        bind.texelBufferView = src->texelBufferView;
+      }
+      else if(write.type == VK_DESCRIPTOR_TYPE_SAMPLER ||
+              write.type == VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER ||
+              write.type == VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE ||
+              write.type == VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT)
+      {
+        if(write.setSampler)
+          bind.imageInfo.sampler = src->imageInfo.sampler;
+        if(write.setImageView)
+          bind.imageInfo.imageView = src->imageInfo.imageView;
+        bind.imageInfo.imageLayout = src->imageInfo.imageLayout;
+      }
+      else
+      {
+        bind.bufferInfo = src->bufferInfo;
+      }
+    }
+  }
+
+  descInfo->deferredWrites.clear();
+  descInfo->deferredSlots.clear();
+
+  descInfo->BindingsUpdated(eFrameRef_Read);
+}
+
+void WrappedVulkan::ApplyAllDeferredDescriptorWrites()
+{
+  rdcarray<ResourceId> sets;
+  {
+    SCOPED_LOCK(m_DeferredDescriptorSetsLock);
+    sets.swap(m_DeferredDescriptorSets);
+  }
+
+  for(ResourceId id : sets)
+  {
+    // the set may have been freed since it was journaled, which is fine
+    VkResourceRecord *record = GetResourceManager()->GetResourceRecord(id);
+    if(record && record->descInfo)
+    {
+      ApplyDeferredDescriptorWrites(record);
+      record->descInfo->deferredListed = false;
+    }
+  }
+}
+
 void WrappedVulkan::vkUpdateDescriptorSets(VkDevice device, uint32_t writeCount,
                                            const VkWriteDescriptorSet *pDescriptorWrites,
                                            uint32_t copyCount,
@@ -996,6 +1131,8 @@ void WrappedVulkan::vkUpdateDescriptorSets(VkDevice device, uint32_t writeCount,
 
         SCOPED_LOCK(setrecord->descInfo->refLock);
 
+        setrecord->UpdateBindRefs(GetResourceManager());
+
         for(auto refit = setrecord->descInfo->bindFrameRefs.begin();
             refit != setrecord->descInfo->bindFrameRefs.end(); ++refit)
         {
@@ -1015,6 +1152,9 @@ void WrappedVulkan::vkUpdateDescriptorSets(VkDevice device, uint32_t writeCount,
   // need to track descriptor set contents whether capframing or idle
   if(IsCaptureMode(m_State))
   {
+    // deferred writes are applied when capturing starts, so don't race with that
+    SCOPED_READLOCK(m_CapTransitionLock);
+
     for(uint32_t i = 0; i < writeCount; i++)
     {
       const VkWriteDescriptorSet &descWrite = pDescriptorWrites[i];
@@ -1044,7 +1184,19 @@ void WrappedVulkan::vkUpdateDescriptorSets(VkDevice device, uint32_t writeCount,
       // (would need to version handles somehow, but don't have enough bits
       // to do that reliably).
       //
-      // This is handled by RemoveBindFrameRef silently dropping id == ResourceId()
+      // This is handled by the references being built lazily from the slots, skipping any
+      // resources that no longer exist.
+
+      // ignore descriptors not part of the write, as they might not even point to a valid
+      // object so trying to get their ID could crash
+      bool sampler = !layoutBinding->immutableSampler &&
+                     (descWrite.descriptorType == VK_DESCRIPTOR_TYPE_SAMPLER ||
+                      descWrite.descriptorType == VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER);
+      bool imageView = descWrite.descriptorType != VK_DESCRIPTOR_TYPE_SAMPLER;
+
+      DescriptorSetSlot *deferred =
+          DeferDescriptorWrite(record, descWrite.dstBinding, descWrite.dstArrayElement,
+                               descWrite.descriptorCount, descWrite.descriptorType, sampler, imageView);
 
       // start at the dstArrayElement
       uint32_t curIdx = descWrite.dstArrayElement;
@@ -1069,9 +1221,7 @@ void WrappedVulkan::vkUpdateDescriptorSets(VkDevice device, uint32_t writeCount,
           curIdx = 0;
         }
 
-        DescriptorSetSlot &bind = (*binding)[curIdx];
-
-        bind.RemoveBindRefs(GetResourceManager(), record);
+        DescriptorSetSlot &bind = deferred ? deferred[d] : (*binding)[curIdx];
 
         if(descWrite.descriptorType == VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER ||
            descWrite.descriptorType == VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER)
@@ -1084,27 +1234,16 @@ void WrappedVulkan::vkUpdateDescriptorSets(VkDevice device, uint32_t writeCount,
                 descWrite.descriptorType == VK_DESCRIPTOR_TYPE_STORAGE_IMAGE ||
                 descWrite.descriptorType == VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT)
         {
-          bool sampler = true;
-          bool imageView = true;
-
-          // ignore descriptors not part of the write, as they might not even point to a valid
-          // object so trying to get their ID could crash
-          if(layoutBinding->immutableSampler ||
-             (descWrite.descriptorType != VK_DESCRIPTOR_TYPE_SAMPLER &&
-              descWrite.descriptorType != VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER))
-            sampler = false;
-          if(descWrite.descriptorType == VK_DESCRIPTOR_TYPE_SAMPLER)
-            imageView = false;
-
           bind.imageInfo.SetFrom(descWrite.pImageInfo[d], sampler, imageView);
         }
         else
         {
           bind.bufferInfo.SetFrom(descWrite.pBufferInfo[d]);
         }
-
-        bind.AddBindRefs(GetResourceManager(), record, ref);
       }
+
+      if(!deferred)
+        record->descInfo->BindingsUpdated(ref);
     }
 
     // this is almost identical to the above loop, except that instead of sourcing the descriptors
@@ -1121,6 +1260,10 @@ void WrappedVulkan::vkUpdateDescriptorSets(VkDevice device, uint32_t writeCount,
       RDCASSERT(srcrecord->descInfo && srcrecord->descInfo->layout);
       const DescSetLayout &srclayout = *srcrecord->descInfo->layout;
 
+      // copies read the source's bindings, and must land in order with the destination's journal
+      ApplyDeferredDescriptorWrites(srcrecord);
+      ApplyDeferredDescriptorWrites(dstrecord);
+
       RDCASSERT(pDescriptorCopies[i].dstBinding < dstrecord->descInfo->descBindings.size());
       RDCASSERT(pDescriptorCopies[i].srcBinding < srcrecord->descInfo->descBindings.size());
 
@@ -1158,12 +1301,10 @@ void WrappedVulkan::vkUpdateDescriptorSets(VkDevice device, uint32_t writeCount,
           curSrcIdx = 0;
         }
 
-        DescriptorSetSlot &bind = (*dstbinding)[curDstIdx];
-
-        bind.RemoveBindRefs(GetResourceManager(), dstrecord);
-        bind = (*srcbinding)[curSrcIdx];
-        bind.AddBindRefs(GetResourceManager(), dstrecord, ref);
+        (*dstbinding)[curDstIdx] = (*srcbinding)[curSrcIdx];
       }
+
+      dstrecord->descInfo->BindingsUpdated(ref);
     }
   }
 }
@@ -1402,6 +1543,9 @@ void WrappedVulkan::vkUpdateDescriptorSetWithTemplate(
   // need to track descriptor set contents whether capframing or idle
   if(IsCaptureMode(m_State))
   {
+    // deferred writes are applied when capturing starts, so don't race with that
+    SCOPED_READLOCK(m_CapTransitionLock);
+
     for(const VkDescriptorUpdateTemplateEntry &entry : tempInfo->updates)
     {
       VkResourceRecord *record = GetRecord(descriptorSet);
@@ -1416,6 +1560,17 @@ void WrappedVulkan::vkUpdateDescriptorSetWithTemplate(
 
       FrameRefType ref = GetRefType(layoutBinding->descriptorType);
 
+      // ignore descriptors not part of the write, as they might not even point to a valid
+      // object so trying to get their ID could crash
+      bool sampler = !layoutBinding->immutableSampler &&
+                     (entry.descriptorType == VK_DESCRIPTOR_TYPE_SAMPLER ||
+                      entry.descriptorType == VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER);
+      bool imageView = entry.descriptorType != VK_DESCRIPTOR_TYPE_SAMPLER;
+
+      DescriptorSetSlot *deferred =
+          DeferDescriptorWrite(record, entry.dstBinding, entry.dstArrayElement,
+                               entry.descriptorCount, entry.descriptorType, sampler, imageView);
+
       // start at the dstArrayElement
       uint32_t curIdx = entry.dstArrayElement;
 
@@ -1441,9 +1596,7 @@ void WrappedVulkan::vkUpdateDescriptorSetWithTemplate(
 
         const byte *src = (const byte *)pData + entry.offset + entry.stride * d;
 
-        DescriptorSetSlot &bind = (*binding)[curIdx];
-
-        bind.RemoveBindRefs(GetResourceManager(), record);
+        DescriptorSetSlot &bind = deferred ? deferred[d] : (*binding)[curIdx];
 
         if(entry.descriptorType == VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER ||
            entry.descriptorType == VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER)
@@ -1458,27 +1611,16 @@ void WrappedVulkan::vkUpdateDescriptorSetWithTemplate(
         {
           const VkDescriptorImageInfo &srcInfo = *(const VkDescriptorImageInfo *)src;
 
-          bool sampler = true;
-          bool imageView = true;
-
-          // ignore descriptors not part of the write, as they might not even point to a valid
-          // object so trying to get their ID could crash
-          if(layoutBinding->immutableSampler ||
-             (entry.descriptorType != VK_DESCRIPTOR_TYPE_SAMPLER &&
-              entry.descriptorType != VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER))
-            sampler = false;
-          if(entry.descriptorType == VK_DESCRIPTOR_TYPE_SAMPLER)
-            imageView = false;
-
           bind.imageInfo.SetFrom(srcInfo, sampler, imageView);
         }
         else
         {
           bind.bufferInfo.SetFrom(*(const VkDescriptorBufferInfo *)src);
         }
-
-        bind.AddBindRefs(GetResourceManager(), record, ref);
       }
+
+      if(!deferred)
+        record->descInfo->BindingsUpdated(ref);
     }
   }
 }
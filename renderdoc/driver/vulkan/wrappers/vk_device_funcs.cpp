@@ -178,6 +178,10 @@ ReplayStatus WrappedVulkan::Initialise(VkInitParams &params, uint64_t sectionVer
   m_SectionVersion = sectionVersion;
   m_ReplayOptions = opts;
 
+  m_CheckpointInterval = opts.replayCheckpointInterval;
+  m_CheckpointBudget = VkDeviceSize(opts.replayCheckpointBudgetMB) * 1024 * 1024;
+  m_RerecordCacheBudget = uint64_t(opts.rerecordCacheMB) * 1024 * 1024;
+
   m_ResourceManager->SetOptimisationLevel(m_ReplayOptions.optimisation);
 
   StripUnwantedLayers(params.Layers);
@@ -816,6 +820,9 @@ void WrappedVulkan::Shutdown()
     }
   }
 
+  FreeReplayCheckpoints();
+  FreeRerecordCache();
+
   FreeAllMemory(MemoryScope::InitialContents);
 
   // we do more in Shutdown than the equivalent vkDestroyInstance since on replay there's
@@ -834,6 +841,8 @@ void WrappedVulkan::Shutdown()
   SAFE_DELETE(m_DebugManager);
   SAFE_DELETE(m_ShaderCache);
 
+  DestroyReplayPipelineCache();
+
   if(m_Instance && ObjDisp(m_Instance)->DestroyDebugReportCallbackEXT &&
      m_DbgReportCallback != VK_NULL_HANDLE)
     ObjDisp(m_Instance)->DestroyDebugReportCallbackEXT(Unwrap(m_Instance), m_DbgReportCallback, NULL);
@@ -2861,6 +2870,20 @@ bool WrappedVulkan::Serialise_vkCreateDevice(SerialiserType &ser, VkPhysicalDevi
       ObjDisp(physicalDevice)->GetPhysicalDeviceProperties2(Unwrap(physicalDevice), &availBase);
     }
 
+    m_PhysicalDeviceData.subgroupProps = {
+        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SUBGROUP_PROPERTIES,
+    };
+
+    // subgroup operations need SPIR-V 1.3, which is only allowed if the instance was created with
+    // 1.1 as well as the device supporting it.
+    if(physProps.apiVersion >= VK_MAKE_VERSION(1, 1, 0) &&
+       m_InitParams.APIVersion >= VK_API_VERSION_1_1)
+    {
+      VkPhysicalDeviceProperties2 availBase = {VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2};
+      availBase.pNext = &m_PhysicalDeviceData.subgroupProps;
+      ObjDisp(physicalDevice)->GetPhysicalDeviceProperties2(Unwrap(physicalDevice), &availBase);
+    }
+
 // we unset the extension because it may be a 'shared' extension that's available at both instance
 // and device. Only set it to enabled if it's really enabled for this device. This can happen with a
 // device extension that is reported by another physical device than the one selected - it becomes
@@ -3008,6 +3031,14 @@ bool WrappedVulkan::Serialise_vkCreateDevice(SerialiserType &ser, VkPhysicalDevi
     m_PhysicalDeviceData.GPULocalMemIndex = m_PhysicalDeviceData.GetMemoryIndex(
         ~0U, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
 
+    // the budget is only queried on the physical device, so the extension doesn't need enabling
+    m_PhysicalDeviceData.memoryBudget =
+        m_EnabledExtensions.ext_KHR_get_physical_device_properties2 &&
+        supportedExtensions.find(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME) != supportedExtensions.end();
+
+    if(m_PhysicalDeviceData.memoryBudget)
+      RDCLOG("Using VK_EXT_memory_budget to limit replay memory allocations");
+
     APIProps.vendor = GetDriverInfo().Vendor();
 
     // temporarily disable the debug message sink, to ignore any false positive messages from our
@@ -3015,6 +3046,8 @@ bool WrappedVulkan::Serialise_vkCreateDevice(SerialiserType &ser, VkPhysicalDevi
     ScopedDebugMessageSink *sink = GetDebugMessageSink();
     SetDebugMessageSink(NULL);
 
+    CreateReplayPipelineCache();
+
     m_ShaderCache = new VulkanShaderCache(this);
 
     m_DebugManager = new VulkanDebugManager(this);
@@ -3543,6 +3576,12 @@ void WrappedVulkan::vkDestroyDevice(VkDevice device, const VkAllocationCallbacks
 
   m_InternalCmds.Reset();
 
+  // any objects still pending are leaked and will never be captured
+  {
+    SCOPED_LOCK(m_DeferredCreateChunksLock);
+    m_DeferredCreateChunks.clear();
+  }
+
   m_QueueFamilyIdx = ~0U;
   m_PrevQueue = m_Queue = VK_NULL_HANDLE;
 
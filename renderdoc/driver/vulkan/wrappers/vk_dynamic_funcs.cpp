@@ -89,7 +89,7 @@ void WrappedVulkan::vkCmdSetViewport(VkCommandBuffer commandBuffer, uint32_t fir
     SCOPED_SERIALISE_CHUNK(VulkanChunk::vkCmdSetViewport);
     Serialise_vkCmdSetViewport(ser, commandBuffer, firstViewport, viewportCount, pViewports);
 
-    record->AddChunk(scope.Get());
+    record->AddStreamedChunk(scope);
   }
 }
 
@@ -157,7 +157,7 @@ void WrappedVulkan::vkCmdSetScissor(VkCommandBuffer commandBuffer, uint32_t firs
     SCOPED_SERIALISE_CHUNK(VulkanChunk::vkCmdSetScissor);
     Serialise_vkCmdSetScissor(ser, commandBuffer, firstScissor, scissorCount, pScissors);
 
-    record->AddChunk(scope.Get());
+    record->AddStreamedChunk(scope);
   }
 }
 
@@ -214,7 +214,7 @@ void WrappedVulkan::vkCmdSetLineWidth(VkCommandBuffer commandBuffer, float lineW
     SCOPED_SERIALISE_CHUNK(VulkanChunk::vkCmdSetLineWidth);
     Serialise_vkCmdSetLineWidth(ser, commandBuffer, lineWidth);
 
-    record->AddChunk(scope.Get());
+    record->AddStreamedChunk(scope);
   }
 }
 
@@ -281,7 +281,7 @@ void WrappedVulkan::vkCmdSetDepthBias(VkCommandBuffer commandBuffer, float depth
     SCOPED_SERIALISE_CHUNK(VulkanChunk::vkCmdSetDepthBias);
     Serialise_vkCmdSetDepthBias(ser, commandBuffer, depthBias, depthBiasClamp, slopeScaledDepthBias);
 
-    record->AddChunk(scope.Get());
+    record->AddStreamedChunk(scope);
   }
 }
 
@@ -340,7 +340,7 @@ void WrappedVulkan::vkCmdSetBlendConstants(VkCommandBuffer commandBuffer, const
     SCOPED_SERIALISE_CHUNK(VulkanChunk::vkCmdSetBlendConstants);
     Serialise_vkCmdSetBlendConstants(ser, commandBuffer, blendConst);
 
-    record->AddChunk(scope.Get());
+    record->AddStreamedChunk(scope);
   }
 }
 
@@ -402,7 +402,7 @@ void WrappedVulkan::vkCmdSetDepthBounds(VkCommandBuffer commandBuffer, float min
     SCOPED_SERIALISE_CHUNK(VulkanChunk::vkCmdSetDepthBounds);
     Serialise_vkCmdSetDepthBounds(ser, commandBuffer, minDepthBounds, maxDepthBounds);
 
-    record->AddChunk(scope.Get());
+    record->AddStreamedChunk(scope);
   }
 }
 
@@ -468,7 +468,7 @@ void WrappedVulkan::vkCmdSetStencilCompareMask(VkCommandBuffer commandBuffer,
     SCOPED_SERIALISE_CHUNK(VulkanChunk::vkCmdSetStencilCompareMask);
     Serialise_vkCmdSetStencilCompareMask(ser, commandBuffer, faceMask, compareMask);
 
-    record->AddChunk(scope.Get());
+    record->AddStreamedChunk(scope);
   }
 }
 
@@ -534,7 +534,7 @@ void WrappedVulkan::vkCmdSetStencilWriteMask(VkCommandBuffer commandBuffer,
     SCOPED_SERIALISE_CHUNK(VulkanChunk::vkCmdSetStencilWriteMask);
     Serialise_vkCmdSetStencilWriteMask(ser, commandBuffer, faceMask, writeMask);
 
-    record->AddChunk(scope.Get());
+    record->AddStreamedChunk(scope);
   }
 }
 
@@ -600,7 +600,7 @@ void WrappedVulkan::vkCmdSetStencilReference(VkCommandBuffer commandBuffer,
     SCOPED_SERIALISE_CHUNK(VulkanChunk::vkCmdSetStencilReference);
     Serialise_vkCmdSetStencilReference(ser, commandBuffer, faceMask, reference);
 
-    record->AddChunk(scope.Get());
+    record->AddStreamedChunk(scope);
   }
 }
 
@@ -664,7 +664,7 @@ void WrappedVulkan::vkCmdSetSampleLocationsEXT(VkCommandBuffer commandBuffer,
     SCOPED_SERIALISE_CHUNK(VulkanChunk::vkCmdSetSampleLocationsEXT);
     Serialise_vkCmdSetSampleLocationsEXT(ser, commandBuffer, pSampleLocationsInfo);
 
-    record->AddChunk(scope.Get());
+    record->AddStreamedChunk(scope);
   }
 }
 
@@ -739,7 +739,7 @@ void WrappedVulkan::vkCmdSetDiscardRectangleEXT(VkCommandBuffer commandBuffer,
     Serialise_vkCmdSetDiscardRectangleEXT(ser, commandBuffer, firstDiscardRectangle,
                                           discardRectangleCount, pDiscardRectangles);
 
-    record->AddChunk(scope.Get());
+    record->AddStreamedChunk(scope);
   }
 }
 
@@ -805,7 +805,7 @@ void WrappedVulkan::vkCmdSetLineStippleEXT(VkCommandBuffer commandBuffer,
     SCOPED_SERIALISE_CHUNK(VulkanChunk::vkCmdSetLineStippleEXT);
     Serialise_vkCmdSetLineStippleEXT(ser, commandBuffer, lineStippleFactor, lineStipplePattern);
 
-    record->AddChunk(scope.Get());
+    record->AddStreamedChunk(scope);
   }
 }
 
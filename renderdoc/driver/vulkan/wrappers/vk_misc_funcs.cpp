@@ -126,6 +126,7 @@ VkFramebufferCreateInfo WrappedVulkan::UnwrapInfo(const VkFramebufferCreateInfo
       return;                                                                                      \
     type unwrappedObj = Unwrap(obj);                                                               \
     m_ForcedReferences.removeOne(GetRecord(obj));                                                  \
+    ReleaseDeferredCreateChunks(GetRecord(obj));                                                   \
     if(IsReplayMode(m_State))                                                                      \
       m_CreationInfo.erase(GetResID(obj));                                                         \
     GetResourceManager()->ReleaseWrappedResource(obj, true);                                       \
@@ -154,6 +155,118 @@ DESTROY_IMPL(VkSamplerYcbcrConversion, DestroySamplerYcbcrConversion)
 
 #undef DESTROY_IMPL
 
+bool WrappedVulkan::DeferCreateChunk(VkResourceRecord *record, DeferredCreateChunk deferred)
+{
+  if(!m_DeferCreateChunks)
+    return false;
+
+  // the create info is copied shallowly, so anything with a next chain is serialised immediately
+  if(deferred.createInfo.sampler.pNext != NULL)
+    return false;
+
+  SCOPED_LOCK(m_DeferredCreateChunksLock);
+
+  // the state is checked under the lock, pairing with SerialiseAllDeferredCreateChunks()
+  if(!IsBackgroundCapturing(m_State))
+    return false;
+
+  WriteSerialiser &ser = GetThreadSerialiser();
+  deferred.timestampMicro = ser.ChunkMetadata().timestampMicro;
+  deferred.durationMicro = ser.ChunkMetadata().durationMicro;
+  deferred.chunkID = record->ReserveChunkID();
+
+  if(deferred.chunk == VulkanChunk::vkCreateImageView)
+    deferred.parent = GetRecord(deferred.createInfo.imageView.image);
+  else if(deferred.chunk == VulkanChunk::vkCreateBufferView)
+    deferred.parent = GetRecord(deferred.createInfo.bufferView.buffer);
+
+  m_DeferredCreateChunks.insert({record, deferred});
+
+  return true;
+}
+
+Chunk *WrappedVulkan::SerialiseDeferredCreateChunk(const DeferredCreateChunk &deferred)
+{
+  CACHE_THREAD_SERIALISER();
+
+  ser.ChunkMetadata().timestampMicro = deferred.timestampMicro;
+  ser.ChunkMetadata().durationMicro = deferred.durationMicro;
+
+  SCOPED_SERIALISE_CHUNK(deferred.chunk);
+
+  DeferredCreateChunk::Handle handle = deferred.handle;
+
+  switch(deferred.chunk)
+  {
+    case VulkanChunk::vkCreateSampler:
+      Serialise_vkCreateSampler(ser, deferred.device, &deferred.createInfo.sampler, NULL,
+                                &handle.sampler);
+      break;
+    case VulkanChunk::vkCreateImageView:
+      Serialise_vkCreateImageView(ser, deferred.device, &deferred.createInfo.imageView, NULL,
+                                  &handle.imageView);
+      break;
+    case VulkanChunk::vkCreateBufferView:
+      Serialise_vkCreateBufferView(ser, deferred.device, &deferred.createInfo.bufferView, NULL,
+                                   &handle.bufferView);
+      break;
+    default: RDCERR("Unexpected deferred chunk %s", ToStr(deferred.chunk).c_str()); break;
+  }
+
+  return scope.Get();
+}
+
+void WrappedVulkan::ReleaseDeferredCreateChunks(VkResourceRecord *record)
+{
+  if(!m_DeferCreateChunks || record == NULL)
+    return;
+
+  // if anything else still holds this record as a parent, it could be pulled into a later capture
+  // even though the object is gone. Serialise any pending chunk that refers to it while the handle
+  // is still valid, rather than dropping it.
+  const bool referenced = record->GetRefCount() > 1;
+
+  SCOPED_LOCK(m_DeferredCreateChunksLock);
+
+  if(m_DeferredCreateChunks.empty())
+    return;
+
+  auto it = m_DeferredCreateChunks.find(record);
+  if(it != m_DeferredCreateChunks.end())
+  {
+    if(referenced)
+      record->AddChunk(SerialiseDeferredCreateChunk(it->second), it->second.chunkID);
+    m_DeferredCreateChunks.erase(it);
+  }
+
+  if(!referenced)
+    return;
+
+  // views that are still alive refer to this image or buffer by handle
+  for(it = m_DeferredCreateChunks.begin(); it != m_DeferredCreateChunks.end();)
+  {
+    if(it->second.parent == record)
+    {
+      it->first->AddChunk(SerialiseDeferredCreateChunk(it->second), it->second.chunkID);
+      it = m_DeferredCreateChunks.erase(it);
+    }
+    else
+    {
+      ++it;
+    }
+  }
+}
+
+void WrappedVulkan::SerialiseAllDeferredCreateChunks()
+{
+  SCOPED_LOCK(m_DeferredCreateChunksLock);
+
+  for(auto it = m_DeferredCreateChunks.begin(); it != m_DeferredCreateChunks.end(); ++it)
+    it->first->AddChunk(SerialiseDeferredCreateChunk(it->second), it->second.chunkID);
+
+  m_DeferredCreateChunks.clear();
+}
+
 // needs to be separate because it releases internal resources
 void WrappedVulkan::vkDestroySwapchainKHR(VkDevice device, VkSwapchainKHR obj,
                                           const VkAllocationCallbacks *pAllocator)
@@ -198,6 +311,8 @@ void WrappedVulkan::vkDestroyImage(VkDevice device, VkImage obj,
 
   EraseImageState(GetResID(obj));
 
+  ReleaseDeferredCreateChunks(GetRecord(obj));
+
   VkImage unwrappedObj = Unwrap(obj);
   GetResourceManager()->ReleaseWrappedResource(obj, true);
   return ObjDisp(device)->DestroyImage(Unwrap(device), unwrappedObj, pAllocator);
@@ -531,20 +646,18 @@ VkResult WrappedVulkan::vkCreateSampler(VkDevice device, const VkSamplerCreateIn
 
     if(IsCaptureMode(m_State))
     {
-      Chunk *chunk = NULL;
+      VkResourceRecord *record = GetResourceManager()->AddResourceRecord(*pSampler);
 
+      if(!DeferCreateChunk(record, DeferredCreateChunk(device, *pSampler, *pCreateInfo)))
       {
         CACHE_THREAD_SERIALISER();
 
         SCOPED_SERIALISE_CHUNK(VulkanChunk::vkCreateSampler);
         Serialise_vkCreateSampler(ser, device, pCreateInfo, NULL, pSampler);
 
-        chunk = scope.Get();
+        record->AddChunk(scope.Get());
       }
 
-      VkResourceRecord *record = GetResourceManager()->AddResourceRecord(*pSampler);
-      record->AddChunk(chunk);
-
       const VkSamplerYcbcrConversionInfo *ycbcr =
           (const VkSamplerYcbcrConversionInfo *)FindNextStruct(
               pCreateInfo, VK_STRUCTURE_TYPE_SAMPLER_YCBCR_CONVERSION_INFO);
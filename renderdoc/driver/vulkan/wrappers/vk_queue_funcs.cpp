@@ -177,6 +177,79 @@ static void appendChain(VkBaseInStructure *chain, void *item)
   chain->pNext = (VkBaseInStructure *)item;
 }
 
+void WrappedVulkan::PatchReplaySemaphores(const VkSubmitInfo &original, VkSubmitInfo &submit)
+{
+  m_ReplayWaitSems.clear();
+  m_ReplayWaitStages.clear();
+  m_ReplaySignalSems.clear();
+
+  for(uint32_t i = 0; i < original.waitSemaphoreCount; i++)
+  {
+    int32_t idx = m_PendingReplaySemaphores.indexOf(original.pWaitSemaphores[i]);
+
+    // not signalled in this replay, so it was signalled before the frame and there's nothing to
+    // wait for. Waiting on it would never complete.
+    if(idx < 0)
+      continue;
+
+    m_PendingReplaySemaphores.erase(idx);
+
+    m_ReplayWaitSems.push_back(Unwrap(original.pWaitSemaphores[i]));
+    m_ReplayWaitStages.push_back(original.pWaitDstStageMask[i]);
+  }
+
+  for(uint32_t i = 0; i < original.signalSemaphoreCount; i++)
+  {
+    VkSemaphore sem = original.pSignalSemaphores[i];
+
+    // a binary semaphore can't be signalled twice without a wait in between
+    if(sem == VK_NULL_HANDLE || m_PendingReplaySemaphores.contains(sem))
+      continue;
+
+    m_PendingReplaySemaphores.push_back(sem);
+
+    m_ReplaySignalSems.push_back(Unwrap(sem));
+  }
+
+  submit.waitSemaphoreCount = (uint32_t)m_ReplayWaitSems.size();
+  submit.pWaitSemaphores = m_ReplayWaitSems.data();
+  submit.pWaitDstStageMask = m_ReplayWaitStages.data();
+  submit.signalSemaphoreCount = (uint32_t)m_ReplaySignalSems.size();
+  submit.pSignalSemaphores = m_ReplaySignalSems.data();
+}
+
+void WrappedVulkan::FlushPendingReplaySemaphores()
+{
+  if(m_PendingReplaySemaphores.empty())
+    return;
+
+  // wait on everything that was signalled and never waited on in the frame, so that the semaphores
+  // are unsignalled again when the next replay signals them.
+  rdcarray<VkPipelineStageFlags> stages;
+  stages.fill(m_PendingReplaySemaphores.size(), VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
+
+  rdcarray<VkSemaphore> sems;
+  for(VkSemaphore sem : m_PendingReplaySemaphores)
+    sems.push_back(Unwrap(sem));
+
+  VkSubmitInfo submitInfo = {
+      VK_STRUCTURE_TYPE_SUBMIT_INFO,
+      m_SubmitChain,
+      (uint32_t)sems.size(),
+      sems.data(),    // wait semaphores
+      stages.data(),
+      0,
+      NULL,    // command buffers
+      0,
+      NULL,    // signal semaphores
+  };
+
+  VkResult vkr = ObjDisp(m_Queue)->QueueSubmit(Unwrap(m_Queue), 1, &submitInfo, VK_NULL_HANDLE);
+  RDCASSERTEQUAL(vkr, VK_SUCCESS);
+
+  m_PendingReplaySemaphores.clear();
+}
+
 template <typename SerialiserType>
 bool WrappedVulkan::Serialise_vkQueueSubmit(SerialiserType &ser, VkQueue queue, uint32_t submitCount,
                                             const VkSubmitInfo *pSubmits, VkFence fence)
@@ -192,26 +265,49 @@ bool WrappedVulkan::Serialise_vkQueueSubmit(SerialiserType &ser, VkQueue queue,
 
   if(IsReplayingAndReading())
   {
-    // if there are multiple queue submissions in flight, wait for the previous queue to finish
-    // before executing this, as we don't have the sync information to properly sync.
-    if(m_PrevQueue != queue)
+    // when replaying queues concurrently we keep the original semaphores to sync against other
+    // queues. Timeline semaphore values only ever increase so they can't be signalled again on the
+    // next replay, submissions using them are serialised instead.
+    bool concurrent = m_ReplayOptions.concurrentQueues;
+    for(uint32_t i = 0; i < submitCount; i++)
+      if(FindNextStruct(&pSubmits[i], VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO))
+        concurrent = false;
+
+    if(concurrent)
     {
-      RDCDEBUG("Previous queue execution was on queue %s, now executing %s, syncing GPU",
-               ToStr(GetResID(m_PrevQueue)).c_str(), ToStr(GetResID(queue)).c_str());
-      if(m_PrevQueue != VK_NULL_HANDLE)
-        ObjDisp(m_PrevQueue)->QueueWaitIdle(Unwrap(m_PrevQueue));
+      m_PrevQueue = queue;
+    }
+    else if(m_ReplayOptions.concurrentQueues)
+    {
+      // other queues could be running anything, so wait for all of them
+      FlushPendingReplaySemaphores();
+      ObjDisp(GetDev())->DeviceWaitIdle(Unwrap(GetDev()));
 
       m_PrevQueue = queue;
     }
+    else
+    {
+      // if there are multiple queue submissions in flight, wait for the previous queue to finish
+      // before executing this, as we don't have the sync information to properly sync.
+      if(m_PrevQueue != queue)
+      {
+        RDCDEBUG("Previous queue execution was on queue %s, now executing %s, syncing GPU",
+                 ToStr(GetResID(m_PrevQueue)).c_str(), ToStr(GetResID(queue)).c_str());
+        if(m_PrevQueue != VK_NULL_HANDLE)
+          ObjDisp(m_PrevQueue)->QueueWaitIdle(Unwrap(m_PrevQueue));
 
-    // if we ever waited on any semaphores, wait for idle here.
-    bool doWait = false;
-    for(uint32_t i = 0; i < submitCount; i++)
-      if(pSubmits[i].waitSemaphoreCount > 0)
-        doWait = true;
+        m_PrevQueue = queue;
+      }
 
-    if(doWait)
-      ObjDisp(queue)->QueueWaitIdle(Unwrap(queue));
+      // if we ever waited on any semaphores, wait for idle here.
+      bool doWait = false;
+      for(uint32_t i = 0; i < submitCount; i++)
+        if(pSubmits[i].waitSemaphoreCount > 0)
+          doWait = true;
+
+      if(doWait)
+        ObjDisp(queue)->QueueWaitIdle(Unwrap(queue));
+    }
 
     // add a drawcall use for this submission, to tally up with any debug messages that come from it
     if(IsLoading(m_State))
@@ -252,6 +348,9 @@ bool WrappedVulkan::Serialise_vkQueueSubmit(SerialiserType &ser, VkQueue queue,
         UnwrapNextChain(m_State, "VkSubmitInfo", tempMem, (VkBaseInStructure *)&unwrapped);
         appendChain((VkBaseInStructure *)&unwrapped, m_SubmitChain);
 
+        if(concurrent)
+          PatchReplaySemaphores(pSubmits[sub], unwrapped);
+
         ObjDisp(queue)->QueueSubmit(Unwrap(queue), 1, &unwrapped, VK_NULL_HANDLE);
 
         AddEvent();
@@ -356,7 +455,15 @@ bool WrappedVulkan::Serialise_vkQueueSubmit(SerialiserType &ser, VkQueue queue,
 
         if(submitInfo.commandBufferCount == 0)
         {
-          // do nothing, don't bother with the logic below
+          // nothing to execute, but the submission may still be part of syncing the queues
+          if(concurrent && startEID < m_LastEventID && !IsSkippingToCheckpoint() &&
+             (pSubmits[sub].waitSemaphoreCount > 0 || pSubmits[sub].signalSemaphoreCount > 0))
+          {
+            VkSubmitInfo syncSubmit = {VK_STRUCTURE_TYPE_SUBMIT_INFO};
+            PatchReplaySemaphores(pSubmits[sub], syncSubmit);
+
+            ObjDisp(queue)->QueueSubmit(Unwrap(queue), 1, &syncSubmit, VK_NULL_HANDLE);
+          }
         }
         else if(m_LastEventID <= startEID)
         {
@@ -422,19 +529,32 @@ bool WrappedVulkan::Serialise_vkQueueSubmit(SerialiserType &ser, VkQueue queue,
           rerecordedSubmit.commandBufferCount = (uint32_t)rerecordedCmds.size();
           rerecordedSubmit.pCommandBuffers = &rerecordedCmds[0];
 
+          if(IsSkippingToCheckpoint())
+          {
+            // the results of this submit will be restored from a checkpoint
+          }
 #if ENABLED(SINGLE_FLUSH_VALIDATE)
-          rerecordedSubmit.commandBufferCount = 1;
-          for(size_t i = 0; i < rerecordedCmds.size(); i++)
+          else
           {
-            ObjDisp(queue)->QueueSubmit(Unwrap(queue), 1, &rerecordedSubmit, VK_NULL_HANDLE);
-            rerecordedSubmit.pCommandBuffers++;
+            rerecordedSubmit.commandBufferCount = 1;
+            for(size_t i = 0; i < rerecordedCmds.size(); i++)
+            {
+              ObjDisp(queue)->QueueSubmit(Unwrap(queue), 1, &rerecordedSubmit, VK_NULL_HANDLE);
+              rerecordedSubmit.pCommandBuffers++;
 
-            FlushQ();
+              FlushQ();
+            }
           }
 #else
-          // don't submit the fence, since we have nothing to wait on it being signalled, and we
-          // might not have it correctly in the unsignalled state.
-          ObjDisp(queue)->QueueSubmit(Unwrap(queue), 1, &rerecordedSubmit, VK_NULL_HANDLE);
+          else
+          {
+            if(concurrent)
+              PatchReplaySemaphores(pSubmits[sub], rerecordedSubmit);
+
+            // don't submit the fence, since we have nothing to wait on it being signalled, and we
+            // might not have it correctly in the unsignalled state.
+            ObjDisp(queue)->QueueSubmit(Unwrap(queue), 1, &rerecordedSubmit, VK_NULL_HANDLE);
+          }
 #endif
         }
       }
@@ -443,6 +563,9 @@ bool WrappedVulkan::Serialise_vkQueueSubmit(SerialiserType &ser, VkQueue queue,
       FlushQ();
 #endif
     }
+
+    if(IsActiveReplaying(m_State))
+      ReplayCheckpointSubmitted();
   }
 
   return true;
@@ -537,6 +660,17 @@ void WrappedVulkan::InsertDrawsAndRefreshIDs(BakedCmdBufferInfo &cmdBufInfo)
 {
   rdcarray<VulkanDrawcallTreeNode> &cmdBufNodes = cmdBufInfo.draw->children;
 
+  // any indirect arguments were copied into host visible memory by the command buffer that was
+  // just submitted. Wait once for it here, then each draw's arguments can be read directly
+  for(size_t i = 0; i < cmdBufNodes.size(); i++)
+  {
+    if(cmdBufNodes[i].indirectPatch.type != VkIndirectPatchType::NoPatch)
+    {
+      ObjDisp(m_Device)->DeviceWaitIdle(Unwrap(m_Device));
+      break;
+    }
+  }
+
   // assign new drawcall IDs
   for(size_t i = 0; i < cmdBufNodes.size(); i++)
   {
@@ -559,8 +693,8 @@ void WrappedVulkan::InsertDrawsAndRefreshIDs(BakedCmdBufferInfo &cmdBufInfo)
     {
       VkDispatchIndirectCommand unknown = {0};
       bytebuf argbuf;
-      GetDebugManager()->GetBufferData(GetResID(n.indirectPatch.buf), 0, 0, argbuf);
-      VkDispatchIndirectCommand *args = (VkDispatchIndirectCommand *)&argbuf[0];
+      ReadIndirectData(n.indirectPatch, argbuf);
+      VkDispatchIndirectCommand *args = (VkDispatchIndirectCommand *)argbuf.data();
 
       if(argbuf.size() < sizeof(VkDispatchIndirectCommand))
       {
@@ -583,7 +717,7 @@ void WrappedVulkan::InsertDrawsAndRefreshIDs(BakedCmdBufferInfo &cmdBufInfo)
       bool hasCount = (n.indirectPatch.type == VkIndirectPatchType::DrawIndirectCount ||
                        n.indirectPatch.type == VkIndirectPatchType::DrawIndexedIndirectCount);
       bytebuf argbuf;
-      GetDebugManager()->GetBufferData(GetResID(n.indirectPatch.buf), 0, 0, argbuf);
+      ReadIndirectData(n.indirectPatch, argbuf);
 
       byte *ptr = argbuf.begin(), *end = argbuf.end();
 
@@ -728,6 +862,10 @@ void WrappedVulkan::InsertDrawsAndRefreshIDs(BakedCmdBufferInfo &cmdBufInfo)
       m_EventFlags[u.eventId] |= PipeRWUsageEventFlags(u.usage);
     }
 
+    // submits are processed in order, so the first insert is the earliest use
+    for(ResourceId id : n.shaderUsage)
+      m_FirstShaderUse.insert({id, n.draw.eventId});
+
     GetDrawcallStack().back()->children.push_back(n);
 
     // if this is a push marker too, step down the drawcall stack
@@ -747,7 +885,11 @@ VkResult WrappedVulkan::vkQueueSubmit(VkQueue queue, uint32_t submitCount,
     RenderDoc::Inst().AddActiveDriver(RDCDriver::Vulkan, false);
   }
 
-  if(IsActiveCapturing(m_State))
+  // this may begin a scoped capture, so it's checked before anything else looks at the state. It
+  // must only be called once per submission, since it counts them.
+  const bool inSubmitScope = CheckSubmitScope(queue);
+
+  if(IsActiveCapturing(m_State) && inSubmitScope)
   {
     // 15 is quite a lot of submissions.
     const int expectedMaxSubmissions = 15;
@@ -816,10 +958,16 @@ VkResult WrappedVulkan::vkQueueSubmit(VkQueue queue, uint32_t submitCount,
   {
     SCOPED_READLOCK(m_CapTransitionLock);
 
-    bool capframe = IsActiveCapturing(m_State);
+    // submissions outside a scoped capture are still tracked for dirtiness and image states, but
+    // aren't recorded and don't pull their resources into the capture.
+    bool capframe = IsActiveCapturing(m_State) && inSubmitScope;
+    int32_t captureSerial = m_CaptureSerial;
 
     std::set<ResourceId> refdIDs;
 
+    // image states from every command buffer in the submission, merged together once at the end
+    rdcarray<const std::map<ResourceId, ImageState> *> submitImageStates;
+
     for(uint32_t s = 0; s < submitCount; s++)
     {
       for(uint32_t i = 0; i < pSubmits[s].commandBufferCount; i++)
@@ -829,7 +977,7 @@ VkResult WrappedVulkan::vkQueueSubmit(VkQueue queue, uint32_t submitCount,
         VkResourceRecord *record = GetRecord(pSubmits[s].pCommandBuffers[i]);
         present |= record->bakedCommands->cmdInfo->present;
 
-        UpdateImageStates(record->bakedCommands->cmdInfo->imageStates);
+        submitImageStates.push_back(&record->bakedCommands->cmdInfo->imageStates);
 
         for(auto it = record->bakedCommands->cmdInfo->dirtied.begin();
             it != record->bakedCommands->cmdInfo->dirtied.end(); ++it)
@@ -847,17 +995,12 @@ VkResult WrappedVulkan::vkQueueSubmit(VkQueue queue, uint32_t submitCount,
 
           SCOPED_LOCK(setrecord->descInfo->refLock);
 
-          const std::map<ResourceId, rdcpair<uint32_t, FrameRefType>> &frameRefs =
-              setrecord->descInfo->bindFrameRefs;
+          setrecord->UpdateWrittenBindRefs(GetResourceManager());
 
-          for(auto refit = frameRefs.begin(); refit != frameRefs.end(); ++refit)
+          for(ResourceId id : setrecord->descInfo->writtenResources)
           {
-            if(refit->second.second == eFrameRef_PartialWrite ||
-               refit->second.second == eFrameRef_ReadBeforeWrite)
-            {
-              if(GetResourceManager()->HasCurrentResource(refit->first))
-                GetResourceManager()->MarkDirtyResource(refit->first);
-            }
+            if(GetResourceManager()->HasCurrentResource(id))
+              GetResourceManager()->MarkDirtyResource(id);
           }
         }
 
@@ -874,6 +1017,8 @@ VkResult WrappedVulkan::vkQueueSubmit(VkQueue queue, uint32_t submitCount,
 
             SCOPED_LOCK(setrecord->descInfo->refLock);
 
+            setrecord->UpdateBindRefs(GetResourceManager());
+
             for(auto refit = setrecord->descInfo->bindFrameRefs.begin();
                 refit != setrecord->descInfo->bindFrameRefs.end(); ++refit)
             {
@@ -888,6 +1033,10 @@ VkResult WrappedVulkan::vkQueueSubmit(VkQueue queue, uint32_t submitCount,
                 GetResourceManager()->MarkSparseMapReferenced(sparserecord->resInfo);
               }
             }
+            // the set's states can change under refLock, so they can't be deferred. Flush what's
+            // been gathered so far first to keep the merges in submission order.
+            UpdateImageStates(submitImageStates);
+            submitImageStates.clear();
             UpdateImageStates(setrecord->descInfo->bindImageStates);
             GetResourceManager()->MergeReferencedMemory(setrecord->descInfo->bindMemRefs);
           }
@@ -911,21 +1060,38 @@ VkResult WrappedVulkan::vkQueueSubmit(VkQueue queue, uint32_t submitCount,
           for(size_t sub = 0; sub < subcmds.size(); sub++)
           {
             VkResourceRecord *bakedSubcmds = subcmds[sub]->bakedCommands;
-            bakedSubcmds->AddResourceReferences(GetResourceManager());
             bakedSubcmds->AddReferencedIDs(refdIDs);
-            UpdateImageStates(bakedSubcmds->cmdInfo->imageStates);
-            GetResourceManager()->MergeReferencedMemory(bakedSubcmds->cmdInfo->memFrameRefs);
+            submitImageStates.push_back(&bakedSubcmds->cmdInfo->imageStates);
+          }
+
+          // a secondary shared between several primaries (or submitted repeatedly) only needs its
+          // frame references and chunks pulled in once per capture. Claim each one for this
+          // capture so that only the first submit does the work, even across queues.
+          rdcarray<VkResourceRecord *> newSubcmds;
+
+          for(size_t sub = 0; sub < subcmds.size(); sub++)
+          {
+            VkResourceRecord *bakedSubcmds = subcmds[sub]->bakedCommands;
+            CmdBufferRecordingInfo *subInfo = bakedSubcmds->cmdInfo;
+
+            int32_t prevSerial = subInfo->captureSerial;
+            if(prevSerial == captureSerial ||
+               Atomic::CmpExch32(&subInfo->captureSerial, prevSerial, captureSerial) != prevSerial)
+              continue;
+
+            bakedSubcmds->AddResourceReferences(GetResourceManager());
+            GetResourceManager()->MergeReferencedMemory(subInfo->memFrameRefs);
             GetResourceManager()->MarkResourceFrameReferenced(
                 subcmds[sub]->cmdInfo->allocRecord->GetResourceID(), eFrameRef_Read);
 
             bakedSubcmds->AddRef();
+            newSubcmds.push_back(bakedSubcmds);
           }
 
           {
             SCOPED_LOCK(m_CmdBufferRecordsLock);
             m_CmdBufferRecords.push_back(record->bakedCommands);
-            for(size_t sub = 0; sub < subcmds.size(); sub++)
-              m_CmdBufferRecords.push_back(subcmds[sub]->bakedCommands);
+            m_CmdBufferRecords.append(newSubcmds);
           }
 
           record->bakedCommands->AddRef();
@@ -935,6 +1101,8 @@ VkResult WrappedVulkan::vkQueueSubmit(VkQueue queue, uint32_t submitCount,
       }
     }
 
+    UpdateImageStates(submitImageStates);
+
     if(capframe)
     {
       GetResourceManager()->MarkResourceFrameReferenced(GetResID(queue), eFrameRef_Read);
@@ -964,8 +1132,14 @@ VkResult WrappedVulkan::vkQueueSubmit(VkQueue queue, uint32_t submitCount,
             continue;
           }
 
-          size_t diffStart = 0, diffEnd = 0;
-          bool found = true;
+          OverheadCounters::Add(OverheadCounter::ScannedMapBytes, int64_t(state.mapSize));
+
+          // differences far apart are flushed as separate ranges, so that touching both ends of
+          // a large mapping doesn't serialise everything in between
+          const size_t maxDiffRanges = 16;
+          size_t diffStarts[maxDiffRanges] = {0};
+          size_t diffEnds[maxDiffRanges] = {0};
+          size_t numDiffRanges = 1;
 
 // enabled as this is necessary for programs with very large coherent mappings
 // (> 1GB) as otherwise more than a couple of vkQueueSubmit calls leads to vast
@@ -988,30 +1162,54 @@ VkResult WrappedVulkan::vkQueueSubmit(VkQueue queue, uint32_t submitCount,
           // data that would be needed by the GPU in this submit. As long as the
           // refdata we use for future use is identical to what was serialised, we
           // shouldn't miss anything
-          state.needRefData = true;
+          state.needRefData = !state.writeWatched;
 
           // if we have a previous set of data, compare.
           // otherwise just serialise it all
-          if(state.refData)
-            found = FindDiffRange((byte *)state.mappedPtr, state.refData, (size_t)state.mapSize,
-                                  diffStart, diffEnd);
+          if(state.writeWatched)
+          {
+            // the pages written since the last submit are known exactly, no need to compare
+            rdcarray<rdcpair<size_t, size_t>> written;
+            MemoryWatch::FetchWrites(state.mappedPtr + (size_t)state.mapOffset, written);
+
+            // merge anything beyond what we can flush at once into the last range
+            numDiffRanges = RDCMIN(written.size(), maxDiffRanges);
+            for(size_t r = 0; r < written.size(); r++)
+            {
+              size_t idx = RDCMIN(r, maxDiffRanges - 1);
+              if(r == idx)
+                diffStarts[idx] = written[r].first;
+              diffEnds[idx] = written[r].first + written[r].second;
+            }
+          }
+          else if(state.refData)
+            numDiffRanges = FindDiffRanges((byte *)state.mappedPtr, state.refData,
+                                           (size_t)state.mapSize, 64 * 1024, diffStarts, diffEnds,
+                                           maxDiffRanges);
           else
 #endif
-            diffEnd = (size_t)state.mapSize;
+            diffEnds[0] = (size_t)state.mapSize;
 
-          if(found)
+          if(numDiffRanges > 0)
           {
             // MULTIDEVICE should find the device for this queue.
             // MULTIDEVICE only want to flush maps associated with this queue
             VkDevice dev = GetDev();
 
             {
-              RDCLOG("Persistent map flush forced for %s (%llu -> %llu)",
-                     ToStr(record->GetResourceID()).c_str(), (uint64_t)diffStart, (uint64_t)diffEnd);
-              VkMappedMemoryRange range = {VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE, NULL,
-                                           (VkDeviceMemory)(uint64_t)record->Resource,
-                                           state.mapOffset + diffStart, diffEnd - diffStart};
-              vkFlushMappedMemoryRanges(dev, 1, &range);
+              VkMappedMemoryRange ranges[maxDiffRanges];
+
+              for(size_t r = 0; r < numDiffRanges; r++)
+              {
+                RDCLOG("Persistent map flush forced for %s (%llu -> %llu)",
+                       ToStr(record->GetResourceID()).c_str(), (uint64_t)diffStarts[r],
+                       (uint64_t)diffEnds[r]);
+                ranges[r] = {VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE, NULL,
+                             (VkDeviceMemory)(uint64_t)record->Resource,
+                             state.mapOffset + diffStarts[r], diffEnds[r] - diffStarts[r]};
+              }
+
+              vkFlushMappedMemoryRanges(dev, (uint32_t)numDiffRanges, ranges);
               state.mapFlushed = false;
             }
 
@@ -1079,8 +1277,17 @@ bool WrappedVulkan::Serialise_vkQueueBindSparse(SerialiserType &ser, VkQueue que
       if(pBindInfo[i].waitSemaphoreCount > 0)
         doWait = true;
 
-    if(doWait)
+    // sparse binds aren't replayed concurrently. With concurrent queues any other queue could be
+    // running work, so wait for all of them.
+    if(m_ReplayOptions.concurrentQueues)
+    {
+      FlushPendingReplaySemaphores();
+      ObjDisp(GetDev())->DeviceWaitIdle(Unwrap(GetDev()));
+    }
+    else if(doWait)
+    {
       ObjDisp(queue)->QueueWaitIdle(Unwrap(queue));
+    }
 
     for(uint32_t bind = 0; bind < bindInfoCount; bind++)
     {
@@ -1153,6 +1360,10 @@ bool WrappedVulkan::Serialise_vkQueueBindSparse(SerialiserType &ser, VkQueue que
     // don't submit the fence, since we have nothing to wait on it being signalled, and we might
     // not have it correctly in the unsignalled state.
     ObjDisp(queue)->QueueBindSparse(Unwrap(queue), bindInfoCount, pBindInfo, VK_NULL_HANDLE);
+
+    // its signals were dropped, so later work on other queues must not start until it's done
+    if(m_ReplayOptions.concurrentQueues)
+      ObjDisp(queue)->QueueWaitIdle(Unwrap(queue));
   }
 
   return true;
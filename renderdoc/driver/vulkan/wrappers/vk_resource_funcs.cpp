@@ -537,6 +537,13 @@ void WrappedVulkan::vkFreeMemory(VkDevice device, VkDeviceMemory memory,
       wrapped->record->memMapState->refData = NULL;
     }
 
+    if(wrapped->record->memMapState && wrapped->record->memMapState->writeWatched)
+    {
+      MemMapState &state = *wrapped->record->memMapState;
+      MemoryWatch::Unwatch(state.mappedPtr + (size_t)state.mapOffset);
+      state.writeWatched = false;
+    }
+
     {
       SCOPED_LOCK(m_CoherentMapsLock);
       m_CoherentMaps.removeOne(wrapped->record);
@@ -587,6 +594,9 @@ VkResult WrappedVulkan::vkMapMemory(VkDevice device, VkDeviceMemory mem, VkDevic
 
       if(state.mapCoherent)
       {
+        state.writeWatched =
+            m_WatchCoherentMapWrites && MemoryWatch::Watch(realData, (size_t)state.mapSize);
+
         SCOPED_LOCK(m_CoherentMapsLock);
         m_CoherentMaps.push_back(memrecord);
       }
@@ -708,6 +718,10 @@ void WrappedVulkan::vkUnmapMemory(VkDevice device, VkDeviceMemory mem)
         }
       }
 
+      if(state.writeWatched)
+        MemoryWatch::Unwatch(state.mappedPtr + (size_t)state.mapOffset);
+      state.writeWatched = false;
+
       state.mappedPtr = NULL;
     }
 
@@ -799,7 +813,9 @@ bool WrappedVulkan::Serialise_vkFlushMappedMemoryRanges(SerialiserType &ser, VkD
 
     const byte *serialisedData = ser.GetWriter()->GetData() + offs;
 
-    memcpy(state->refData, serialisedData, (size_t)memRangeSize);
+    // the range may only cover part of the map when just the differences are flushed
+    memcpy(state->refData + (size_t)(MemRange.offset - state->mapOffset), serialisedData,
+           (size_t)memRangeSize);
   }
 
   return true;
@@ -1437,21 +1453,20 @@ VkResult WrappedVulkan::vkCreateBufferView(VkDevice device, const VkBufferViewCr
 
     if(IsCaptureMode(m_State))
     {
-      Chunk *chunk = NULL;
+      VkResourceRecord *bufferRecord = GetRecord(pCreateInfo->buffer);
+
+      VkResourceRecord *record = GetResourceManager()->AddResourceRecord(*pView);
 
+      if(!DeferCreateChunk(record, DeferredCreateChunk(device, *pView, *pCreateInfo)))
       {
         CACHE_THREAD_SERIALISER();
 
         SCOPED_SERIALISE_CHUNK(VulkanChunk::vkCreateBufferView);
         Serialise_vkCreateBufferView(ser, device, pCreateInfo, NULL, pView);
 
-        chunk = scope.Get();
+        record->AddChunk(scope.Get());
       }
 
-      VkResourceRecord *bufferRecord = GetRecord(pCreateInfo->buffer);
-
-      VkResourceRecord *record = GetResourceManager()->AddResourceRecord(*pView);
-      record->AddChunk(chunk);
       record->AddParent(bufferRecord);
 
       // store the base resource
@@ -1960,21 +1975,20 @@ VkResult WrappedVulkan::vkCreateImageView(VkDevice device, const VkImageViewCrea
 
     if(IsCaptureMode(m_State))
     {
-      Chunk *chunk = NULL;
+      VkResourceRecord *imageRecord = GetRecord(pCreateInfo->image);
+
+      VkResourceRecord *record = GetResourceManager()->AddResourceRecord(*pView);
 
+      if(!DeferCreateChunk(record, DeferredCreateChunk(device, *pView, *pCreateInfo)))
       {
         CACHE_THREAD_SERIALISER();
 
         SCOPED_SERIALISE_CHUNK(VulkanChunk::vkCreateImageView);
         Serialise_vkCreateImageView(ser, device, pCreateInfo, NULL, pView);
 
-        chunk = scope.Get();
+        record->AddChunk(scope.Get());
       }
 
-      VkResourceRecord *imageRecord = GetRecord(pCreateInfo->image);
-
-      VkResourceRecord *record = GetResourceManager()->AddResourceRecord(*pView);
-      record->AddChunk(chunk);
       record->AddParent(imageRecord);
 
       // store the base resource. Note images have a baseResource pointing
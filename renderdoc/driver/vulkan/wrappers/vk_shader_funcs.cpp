@@ -23,6 +23,7 @@
  ******************************************************************************/
 
 #include "../vk_core.h"
+#include "../vk_shader_cache.h"
 #include "driver/shaders/spirv/spirv_reflect.h"
 
 template <>
@@ -92,6 +93,167 @@ VkPipelineLayoutCreateInfo WrappedVulkan::UnwrapInfo(const VkPipelineLayoutCreat
   return ret;
 }
 
+// a cache that's grown larger than this is thrown away and started again, rather than letting it
+// grow without bound as different captures are opened
+static const uint64_t MaxReplayPipelineCacheSize = 256 * 1024 * 1024;
+
+rdcstr WrappedVulkan::GetReplayPipelineCachePath()
+{
+  const VkPhysicalDeviceProperties &props = m_PhysicalDeviceData.props;
+
+  rdcstr uuid;
+  for(size_t i = 0; i < VK_UUID_SIZE; i++)
+    uuid += StringFormat::Fmt("%02x", props.pipelineCacheUUID[i]);
+
+  // the driver checks the header of whatever data we give it, but keying the file by the device
+  // and driver means switching between GPUs or drivers doesn't throw away the others' caches.
+  return FileIO::GetAppFolderFilename(StringFormat::Fmt("vk_pipeline_cache/%08x_%08x_%08x_%s.bin",
+                                                        props.vendorID, props.deviceID,
+                                                        props.driverVersion, uuid.c_str()));
+}
+
+void WrappedVulkan::CreateReplayPipelineCache()
+{
+  rdcstr path = GetReplayPipelineCachePath();
+
+  bytebuf data;
+
+  if(FileIO::GetFileSize(path) > MaxReplayPipelineCacheSize)
+    RDCLOG("Discarding oversized replay pipeline cache %s", path.c_str());
+  else if(FileIO::exists(path.c_str()) && !FileIO::ReadAll(path.c_str(), data))
+    data.clear();
+
+  VkPipelineCacheCreateInfo cacheInfo = {VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO};
+  cacheInfo.initialDataSize = data.size();
+  cacheInfo.pInitialData = data.data();
+
+  VkResult vkr = ObjDisp(m_Device)->CreatePipelineCache(Unwrap(m_Device), &cacheInfo, NULL,
+                                                        &m_ReplayPipelineCache);
+
+  // drivers should ignore incompatible data, but in case one rejects it try again from empty
+  if(vkr != VK_SUCCESS && !data.empty())
+  {
+    RDCWARN("Couldn't create pipeline cache from %s: %s", path.c_str(), ToStr(vkr).c_str());
+
+    cacheInfo.initialDataSize = 0;
+    cacheInfo.pInitialData = NULL;
+    data.clear();
+
+    vkr = ObjDisp(m_Device)->CreatePipelineCache(Unwrap(m_Device), &cacheInfo, NULL,
+                                                 &m_ReplayPipelineCache);
+  }
+
+  if(vkr != VK_SUCCESS)
+  {
+    RDCERR("Failed to create replay pipeline cache: %s", ToStr(vkr).c_str());
+    m_ReplayPipelineCache = VK_NULL_HANDLE;
+    return;
+  }
+
+  m_ReplayPipelineCacheSavedSize = data.size();
+
+  RDCLOG("Loaded %llu bytes of replay pipeline cache", (uint64_t)data.size());
+}
+
+void WrappedVulkan::SaveReplayPipelineCache()
+{
+  if(m_ReplayPipelineCache == VK_NULL_HANDLE)
+    return;
+
+  size_t size = 0;
+  VkResult vkr =
+      ObjDisp(m_Device)->GetPipelineCacheData(Unwrap(m_Device), m_ReplayPipelineCache, &size, NULL);
+
+  // the cache only grows, so if the size hasn't changed there's nothing new to save
+  if(vkr != VK_SUCCESS || size == m_ReplayPipelineCacheSavedSize)
+    return;
+
+  bytebuf data;
+  data.resize(size);
+  vkr = ObjDisp(m_Device)->GetPipelineCacheData(Unwrap(m_Device), m_ReplayPipelineCache, &size,
+                                                data.data());
+
+  if(vkr != VK_SUCCESS)
+    return;
+
+  data.resize(size);
+
+  rdcstr path = GetReplayPipelineCachePath();
+  FileIO::CreateParentDirectory(path);
+
+  if(FileIO::WriteAll(path.c_str(), data))
+    m_ReplayPipelineCacheSavedSize = size;
+  else
+    RDCWARN("Couldn't write replay pipeline cache to %s", path.c_str());
+}
+
+void WrappedVulkan::DestroyReplayPipelineCache()
+{
+  if(m_ReplayPipelineCache == VK_NULL_HANDLE)
+    return;
+
+  SaveReplayPipelineCache();
+
+  ObjDisp(m_Device)->DestroyPipelineCache(Unwrap(m_Device), m_ReplayPipelineCache, NULL);
+  m_ReplayPipelineCache = VK_NULL_HANDLE;
+}
+
+void WrappedVulkan::CreatePendingSubpass0Pipelines()
+{
+  if(m_PendingSubpass0Pipelines.empty())
+    return;
+
+  PerformanceTimer timer;
+
+  rdcarray<VkPipeline> pipes;
+  pipes.resize(m_PendingSubpass0Pipelines.size());
+
+  // building the create info and the driver compile run on the workers, each with its own storage.
+  // Nothing else is created while this runs so the creation info can be read freely, and the
+  // results are wrapped afterwards on this thread.
+  Threading::ParallelFor(
+      Threading::NumberOfCores(), (uint32_t)pipes.size(), [this, &pipes](uint32_t i) {
+        ResourceId id = m_PendingSubpass0Pipelines[i];
+        const VulkanCreationInfo::Pipeline &pipeInfo = m_CreationInfo.m_Pipeline[id];
+
+        GraphicsPipelineInfoStorage storage;
+        VkGraphicsPipelineCreateInfo pipeCreateInfo;
+        m_ShaderCache->MakeGraphicsPipelineInfo(pipeCreateInfo, id, storage);
+
+        pipeCreateInfo.renderPass =
+            m_CreationInfo.m_RenderPass[pipeInfo.renderpass].loadRPs[pipeInfo.subpass];
+        pipeCreateInfo.subpass = 0;
+
+        VkGraphicsPipelineCreateInfo *unwrapped = UnwrapInfos(&pipeCreateInfo, 1);
+        VkResult ret = ObjDisp(m_Device)->CreateGraphicsPipelines(
+            Unwrap(m_Device), m_ReplayPipelineCache, 1, unwrapped, NULL, &pipes[i]);
+
+        if(ret != VK_SUCCESS)
+        {
+          RDCERR("Failed to create subpass 0 pipeline for %s, VkResult: %s", ToStr(id).c_str(),
+                 ToStr(ret).c_str());
+          pipes[i] = VK_NULL_HANDLE;
+        }
+      });
+
+  for(size_t i = 0; i < pipes.size(); i++)
+  {
+    if(pipes[i] == VK_NULL_HANDLE)
+      continue;
+
+    m_CreationInfo.m_Pipeline[m_PendingSubpass0Pipelines[i]].subpass0pipe = pipes[i];
+
+    ResourceId subpass0id = GetResourceManager()->WrapResource(Unwrap(m_Device), pipes[i]);
+
+    // register as a live-only resource, so it is cleaned up properly
+    GetResourceManager()->AddLiveResource(subpass0id, pipes[i]);
+  }
+
+  RDCLOG("Created %zu subpass 0 pipelines in %.2fms", pipes.size(), timer.GetMilliseconds());
+
+  m_PendingSubpass0Pipelines.clear();
+}
+
 // Shader functions
 template <typename SerialiserType>
 bool WrappedVulkan::Serialise_vkCreatePipelineLayout(SerialiserType &ser, VkDevice device,
@@ -210,8 +372,29 @@ bool WrappedVulkan::Serialise_vkCreateShaderModule(SerialiserType &ser, VkDevice
                                                    const VkAllocationCallbacks *pAllocator,
                                                    VkShaderModule *pShaderModule)
 {
+  // if the code is shared in the shader blob section, only its hash is serialised here. Code that
+  // couldn't be shared is serialised inline with a hash of 0.
+  uint64_t CodeHash = 0;
+  VkShaderModuleCreateInfo referencedInfo = {};
+
+  if(ser.IsWriting())
+  {
+    referencedInfo = *pCreateInfo;
+    CodeHash = m_ShaderModuleBlobs.FindHash(pCreateInfo->pCode, pCreateInfo->codeSize);
+
+    if(CodeHash != 0)
+    {
+      referencedInfo.codeSize = 0;
+      referencedInfo.pCode = NULL;
+    }
+  }
+
   SERIALISE_ELEMENT(device);
-  SERIALISE_ELEMENT_LOCAL(CreateInfo, *pCreateInfo);
+  SERIALISE_ELEMENT_LOCAL(CreateInfo, referencedInfo);
+  if(ser.VersionAtLeast(0x13))
+  {
+    SERIALISE_ELEMENT(CodeHash);
+  }
   SERIALISE_ELEMENT_OPT(pAllocator);
   SERIALISE_ELEMENT_LOCAL(ShaderModule, GetResID(*pShaderModule)).TypedAs("VkShaderModule"_lit);
 
@@ -221,7 +404,24 @@ bool WrappedVulkan::Serialise_vkCreateShaderModule(SerialiserType &ser, VkDevice
   {
     VkShaderModule sh = VK_NULL_HANDLE;
 
-    VkShaderModuleCreateInfo patched = CreateInfo;
+    VkShaderModuleCreateInfo withCode = CreateInfo;
+
+    if(CodeHash != 0)
+    {
+      auto it = m_ReplayShaderBlobs.find(CodeHash);
+
+      if(it == m_ReplayShaderBlobs.end())
+      {
+        RDCERR("Shader module code with hash %llx missing from capture", CodeHash);
+        m_FailedReplayStatus = ReplayStatus::FileCorrupted;
+        return false;
+      }
+
+      withCode.codeSize = it->second.size();
+      withCode.pCode = (const uint32_t *)it->second.data();
+    }
+
+    VkShaderModuleCreateInfo patched = withCode;
 
     byte *tempMem = GetTempMemory(GetNextPatchSize(patched.pNext));
 
@@ -255,7 +455,11 @@ bool WrappedVulkan::Serialise_vkCreateShaderModule(SerialiserType &ser, VkDevice
         live = GetResourceManager()->WrapResource(Unwrap(device), sh);
         GetResourceManager()->AddLiveResource(ShaderModule, sh);
 
-        m_CreationInfo.m_ShaderModule[live].Init(GetResourceManager(), m_CreationInfo, &CreateInfo);
+        // while loading, parse in the background
+        Threading::JobQueue *jobs = IsLoading(m_State) ? m_CreationInfo.GetShaderJobs() : NULL;
+
+        m_CreationInfo.m_ShaderModule[live].Init(GetResourceManager(), m_CreationInfo, &withCode,
+                                                 jobs);
       }
     }
 
@@ -283,6 +487,11 @@ VkResult WrappedVulkan::vkCreateShaderModule(VkDevice device,
     {
       Chunk *chunk = NULL;
 
+      // share the code before serialising, so the chunk can reference it by hash
+      VkResourceRecord *record = GetResourceManager()->AddResourceRecord(*pShaderModule);
+      record->shaderBlob =
+          m_ShaderModuleBlobs.Acquire(record, pCreateInfo->pCode, pCreateInfo->codeSize);
+
       {
         CACHE_THREAD_SERIALISER();
 
@@ -292,14 +501,14 @@ VkResult WrappedVulkan::vkCreateShaderModule(VkDevice device,
         chunk = scope.Get();
       }
 
-      VkResourceRecord *record = GetResourceManager()->AddResourceRecord(*pShaderModule);
       record->AddChunk(chunk);
     }
     else
     {
       GetResourceManager()->AddLiveResource(id, *pShaderModule);
 
-      m_CreationInfo.m_ShaderModule[id].Init(GetResourceManager(), m_CreationInfo, pCreateInfo);
+      m_CreationInfo.m_ShaderModule[id].Init(GetResourceManager(), m_CreationInfo, pCreateInfo,
+                                             NULL);
     }
   }
 
@@ -418,7 +627,7 @@ bool WrappedVulkan::Serialise_vkCreateGraphicsPipelines(
     VkRenderPass origRP = CreateInfo.renderPass;
     VkPipelineCache origCache = pipelineCache;
 
-    // don't use pipeline caches on replay
+    // don't use the application's pipeline caches on replay, only our own
     pipelineCache = VK_NULL_HANDLE;
 
     // if we have pipeline executable properties, capture the data
@@ -429,7 +638,7 @@ bool WrappedVulkan::Serialise_vkCreateGraphicsPipelines(
     }
 
     VkGraphicsPipelineCreateInfo *unwrapped = UnwrapInfos(&CreateInfo, 1);
-    VkResult ret = ObjDisp(device)->CreateGraphicsPipelines(Unwrap(device), Unwrap(pipelineCache),
+    VkResult ret = ObjDisp(device)->CreateGraphicsPipelines(Unwrap(device), m_ReplayPipelineCache,
                                                             1, unwrapped, NULL, &pipe);
 
     if(ret != VK_SUCCESS)
@@ -461,21 +670,30 @@ bool WrappedVulkan::Serialise_vkCreateGraphicsPipelines(
 
         pipeInfo.Init(GetResourceManager(), m_CreationInfo, live, &CreateInfo);
 
-        ResourceId renderPassID = GetResID(CreateInfo.renderPass);
+        if(IsLoading(m_State))
+        {
+          // not needed until the frame is replayed, see CreatePendingSubpass0Pipelines
+          m_PendingSubpass0Pipelines.push_back(live);
+        }
+        else
+        {
+          ResourceId renderPassID = GetResID(CreateInfo.renderPass);
 
-        CreateInfo.renderPass = m_CreationInfo.m_RenderPass[renderPassID].loadRPs[CreateInfo.subpass];
-        CreateInfo.subpass = 0;
+          CreateInfo.renderPass =
+              m_CreationInfo.m_RenderPass[renderPassID].loadRPs[CreateInfo.subpass];
+          CreateInfo.subpass = 0;
 
-        unwrapped = UnwrapInfos(&CreateInfo, 1);
-        ret = ObjDisp(device)->CreateGraphicsPipelines(Unwrap(device), Unwrap(pipelineCache), 1,
-                                                       unwrapped, NULL, &pipeInfo.subpass0pipe);
-        RDCASSERTEQUAL(ret, VK_SUCCESS);
+          unwrapped = UnwrapInfos(&CreateInfo, 1);
+          ret = ObjDisp(device)->CreateGraphicsPipelines(Unwrap(device), m_ReplayPipelineCache, 1,
+                                                         unwrapped, NULL, &pipeInfo.subpass0pipe);
+          RDCASSERTEQUAL(ret, VK_SUCCESS);
 
-        ResourceId subpass0id =
-            GetResourceManager()->WrapResource(Unwrap(device), pipeInfo.subpass0pipe);
+          ResourceId subpass0id =
+              GetResourceManager()->WrapResource(Unwrap(device), pipeInfo.subpass0pipe);
 
-        // register as a live-only resource, so it is cleaned up properly
-        GetResourceManager()->AddLiveResource(subpass0id, pipeInfo.subpass0pipe);
+          // register as a live-only resource, so it is cleaned up properly
+          GetResourceManager()->AddLiveResource(subpass0id, pipeInfo.subpass0pipe);
+        }
       }
     }
 
@@ -504,10 +722,15 @@ VkResult WrappedVulkan::vkCreateGraphicsPipelines(VkDevice device, VkPipelineCac
                                                   VkPipeline *pPipelines)
 {
   VkGraphicsPipelineCreateInfo *unwrapped = UnwrapInfos(pCreateInfos, count);
+
+  // our own pipelines created on replay go through the replay cache too
+  VkPipelineCache cache = Unwrap(pipelineCache);
+  if(IsReplayMode(m_State) && cache == VK_NULL_HANDLE)
+    cache = m_ReplayPipelineCache;
+
   VkResult ret;
-  SERIALISE_TIME_CALL(
-      ret = ObjDisp(device)->CreateGraphicsPipelines(Unwrap(device), Unwrap(pipelineCache), count,
-                                                     unwrapped, pAllocator, pPipelines));
+  SERIALISE_TIME_CALL(ret = ObjDisp(device)->CreateGraphicsPipelines(
+                          Unwrap(device), cache, count, unwrapped, pAllocator, pPipelines));
 
   if(ret == VK_SUCCESS)
   {
@@ -619,7 +842,7 @@ bool WrappedVulkan::Serialise_vkCreateComputePipelines(SerialiserType &ser, VkDe
 
     VkPipelineCache origCache = pipelineCache;
 
-    // don't use pipeline caches on replay
+    // don't use the application's pipeline caches on replay, only our own
     pipelineCache = VK_NULL_HANDLE;
 
     // if we have pipeline executable properties, capture the data
@@ -630,7 +853,7 @@ bool WrappedVulkan::Serialise_vkCreateComputePipelines(SerialiserType &ser, VkDe
     }
 
     VkComputePipelineCreateInfo *unwrapped = UnwrapInfos(&CreateInfo, 1);
-    VkResult ret = ObjDisp(device)->CreateComputePipelines(Unwrap(device), Unwrap(pipelineCache), 1,
+    VkResult ret = ObjDisp(device)->CreateComputePipelines(Unwrap(device), m_ReplayPipelineCache, 1,
                                                            unwrapped, NULL, &pipe);
 
     if(ret != VK_SUCCESS)
@@ -684,10 +907,15 @@ VkResult WrappedVulkan::vkCreateComputePipelines(VkDevice device, VkPipelineCach
                                                  const VkAllocationCallbacks *pAllocator,
                                                  VkPipeline *pPipelines)
 {
+  // our own pipelines created on replay go through the replay cache too
+  VkPipelineCache cache = Unwrap(pipelineCache);
+  if(IsReplayMode(m_State) && cache == VK_NULL_HANDLE)
+    cache = m_ReplayPipelineCache;
+
   VkResult ret;
   SERIALISE_TIME_CALL(ret = ObjDisp(device)->CreateComputePipelines(
-                          Unwrap(device), Unwrap(pipelineCache), count,
-                          UnwrapInfos(pCreateInfos, count), pAllocator, pPipelines));
+                          Unwrap(device), cache, count, UnwrapInfos(pCreateInfos, count),
+                          pAllocator, pPipelines));
 
   if(ret == VK_SUCCESS)
   {
@@ -682,6 +682,9 @@ bool WrappedVulkan::Serialise_vkQueuePresentKHR(SerialiserType &ser, VkQueue que
 
   if(IsReplayingAndReading() && IsLoading(m_State))
   {
+    // a present within the capture ends one frame of a multi-frame capture
+    m_FrameBoundaryEIDs.push_back(m_RootEventID);
+
     AddEvent();
 
     DrawcallDescription draw;
@@ -30,6 +30,15 @@
 #include "common/common.h"
 #include "os/os_specific.h"
 
+// x64 always has SSE2. The NEON half conversion instructions are only guaranteed on aarch64
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CONVERT_USE_SSE2 1
+#include <emmintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define CONVERT_USE_NEON 1
+#include <arm_neon.h>
+#endif
+
 //	for(int i=0; i < 256; i++)
 //	{
 //		uint8_t comp = i&0xff;
@@ -352,6 +361,138 @@ float ConvertComponent(const ResourceFormat &fmt, const byte *data)
   return 0.0f;
 }
 
+void ConvertFromHalves(const uint16_t *comps, size_t count, float *out)
+{
+  size_t i = 0;
+
+#if defined(CONVERT_USE_SSE2)
+  // shift the exponent and mantissa into place and rescale the exponent with a float multiply,
+  // which also normalises subnormals. Inf/NaN have their exponent forced to all 1s afterwards.
+  const __m128i expMantMask = _mm_set1_epi32(0x7fff);
+  const __m128i infNanThreshold = _mm_set1_epi32(0x7bff);
+  const __m128i infNanExp = _mm_set1_epi32(0xff << 23);
+  const __m128 rebias = _mm_castsi128_ps(_mm_set1_epi32((254 - 15) << 23));
+  const __m128i zero = _mm_setzero_si128();
+
+  for(; i + 8 <= count; i += 8)
+  {
+    __m128i halves = _mm_loadu_si128((const __m128i *)(comps + i));
+
+    __m128i words[2] = {_mm_unpacklo_epi16(halves, zero), _mm_unpackhi_epi16(halves, zero)};
+
+    for(int w = 0; w < 2; w++)
+    {
+      __m128i expMant = _mm_and_si128(words[w], expMantMask);
+      __m128i sign = _mm_slli_epi32(_mm_xor_si128(words[w], expMant), 16);
+
+      __m128 scaled = _mm_mul_ps(_mm_castsi128_ps(_mm_slli_epi32(expMant, 13)), rebias);
+
+      __m128i infNan = _mm_and_si128(_mm_cmpgt_epi32(expMant, infNanThreshold), infNanExp);
+
+      _mm_storeu_ps(out + i + w * 4,
+                    _mm_or_ps(scaled, _mm_castsi128_ps(_mm_or_si128(sign, infNan))));
+    }
+  }
+#elif defined(CONVERT_USE_NEON)
+  for(; i + 4 <= count; i += 4)
+    vst1q_f32(out + i, vcvt_f32_f16(vreinterpret_f16_u16(vld1_u16(comps + i))));
+#endif
+
+  for(; i < count; i++)
+    out[i] = ConvertFromHalf(comps[i]);
+}
+
+void ConvertComponents(const ResourceFormat &fmt, const byte *data, size_t count, float *out)
+{
+  size_t i = 0;
+
+  if(fmt.compByteWidth == 4 && (fmt.compType == CompType::Float || fmt.compType == CompType::Depth))
+  {
+    memcpy(out, data, count * sizeof(float));
+    return;
+  }
+  else if(fmt.compByteWidth == 2 && fmt.compType == CompType::Float)
+  {
+    ConvertFromHalves((const uint16_t *)data, count, out);
+    return;
+  }
+  else if(fmt.compByteWidth == 1 && fmt.compType == CompType::UNormSRGB)
+  {
+    for(; i < count; i++)
+      out[i] = SRGB8_lookuptable[data[i]];
+    return;
+  }
+  else if(fmt.compByteWidth == 1 && fmt.compType == CompType::UNorm)
+  {
+#if defined(CONVERT_USE_SSE2)
+    // divide rather than multiply by the reciprocal, so the results match the scalar path exactly
+    const __m128 scale = _mm_set1_ps(255.0f);
+    const __m128i zero = _mm_setzero_si128();
+
+    for(; i + 16 <= count; i += 16)
+    {
+      __m128i bytes = _mm_loadu_si128((const __m128i *)(data + i));
+      __m128i lo = _mm_unpacklo_epi8(bytes, zero);
+      __m128i hi = _mm_unpackhi_epi8(bytes, zero);
+
+      __m128i words[4] = {
+          _mm_unpacklo_epi16(lo, zero), _mm_unpackhi_epi16(lo, zero),
+          _mm_unpacklo_epi16(hi, zero), _mm_unpackhi_epi16(hi, zero),
+      };
+
+      for(int w = 0; w < 4; w++)
+        _mm_storeu_ps(out + i + w * 4, _mm_div_ps(_mm_cvtepi32_ps(words[w]), scale));
+    }
+#elif defined(CONVERT_USE_NEON)
+    const float32x4_t scale = vdupq_n_f32(255.0f);
+
+    for(; i + 8 <= count; i += 8)
+    {
+      uint16x8_t words = vmovl_u8(vld1_u8(data + i));
+
+      vst1q_f32(out + i, vdivq_f32(vcvtq_f32_u32(vmovl_u16(vget_low_u16(words))), scale));
+      vst1q_f32(out + i + 4, vdivq_f32(vcvtq_f32_u32(vmovl_u16(vget_high_u16(words))), scale));
+    }
+#endif
+
+    for(; i < count; i++)
+      out[i] = float(data[i]) / 255.0f;
+    return;
+  }
+  else if(fmt.compByteWidth == 2 &&
+          (fmt.compType == CompType::UNorm || fmt.compType == CompType::Depth))
+  {
+    const uint16_t *u16 = (const uint16_t *)data;
+
+#if defined(CONVERT_USE_SSE2)
+    const __m128 scale = _mm_set1_ps(65535.0f);
+    const __m128i zero = _mm_setzero_si128();
+
+    for(; i + 8 <= count; i += 8)
+    {
+      __m128i words = _mm_loadu_si128((const __m128i *)(u16 + i));
+
+      _mm_storeu_ps(out + i,
+                    _mm_div_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(words, zero)), scale));
+      _mm_storeu_ps(out + i + 4,
+                    _mm_div_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(words, zero)), scale));
+    }
+#elif defined(CONVERT_USE_NEON)
+    const float32x4_t scale = vdupq_n_f32(65535.0f);
+
+    for(; i + 4 <= count; i += 4)
+      vst1q_f32(out + i, vdivq_f32(vcvtq_f32_u32(vmovl_u16(vld1_u16(u16 + i))), scale));
+#endif
+
+    for(; i < count; i++)
+      out[i] = float(u16[i]) / 65535.0f;
+    return;
+  }
+
+  for(; i < count; i++)
+    out[i] = ConvertComponent(fmt, data + i * fmt.compByteWidth);
+}
+
 #if ENABLED(ENABLE_UNIT_TESTS)
 
 #undef None
@@ -398,7 +539,69 @@ TEST_CASE("Check format conversion", "[format]")
       if(i == UINT16_MAX)
         break;
     }
-  }
+  };
+
+  SECTION("Check batch half conversion matches")
+  {
+    rdcarray<uint16_t> halves;
+    halves.resize(65536 + 3);
+    for(size_t i = 0; i < halves.size(); i++)
+      halves[i] = uint16_t(i & 0xffff);
+
+    rdcarray<float> floats;
+    floats.resize(halves.size());
+    ConvertFromHalves(halves.data(), halves.size(), floats.data());
+
+    for(size_t i = 0; i < halves.size(); i++)
+    {
+      float f = ConvertFromHalf(halves[i]);
+
+      if(std::isnan(f))
+        CHECK(std::isnan(floats[i]));
+      else
+        CHECK(f == floats[i]);
+    }
+  };
+
+  SECTION("Check batch component conversion matches")
+  {
+    rdcarray<byte> data;
+    data.resize(1024 + 7);
+    for(size_t i = 0; i < data.size(); i++)
+      data[i] = byte((i * 37) & 0xff);
+
+    rdcarray<float> floats;
+    floats.resize(data.size());
+
+    ResourceFormat fmt;
+    fmt.type = ResourceFormatType::Regular;
+
+    rdcpair<CompType, uint8_t> formats[] = {
+        {CompType::UNorm, 1}, {CompType::UNormSRGB, 1}, {CompType::SNorm, 1},
+        {CompType::UInt, 1},  {CompType::UNorm, 2},     {CompType::Depth, 2},
+        {CompType::SInt, 2},  {CompType::Float, 2},     {CompType::Float, 4},
+        {CompType::UInt, 4},
+    };
+
+    for(rdcpair<CompType, uint8_t> f : formats)
+    {
+      fmt.compType = f.first;
+      fmt.compByteWidth = f.second;
+
+      size_t count = data.size() / fmt.compByteWidth;
+      ConvertComponents(fmt, data.data(), count, floats.data());
+
+      for(size_t i = 0; i < count; i++)
+      {
+        float expected = ConvertComponent(fmt, data.data() + i * fmt.compByteWidth);
+
+        if(std::isnan(expected))
+          CHECK(std::isnan(floats[i]));
+        else
+          CHECK(expected == floats[i]);
+      }
+    }
+  };
 
   SECTION("Check SRGB <-> Linear conversions are reflexive")
   {
@@ -25,6 +25,7 @@
 
 #pragma once
 
+#include <stddef.h>
 #include <stdint.h>
 #include "half_convert.h"
 #include "vec.h"
@@ -104,3 +105,8 @@ typedef uint8_t byte;
 
 struct ResourceFormat;
 float ConvertComponent(const ResourceFormat &fmt, const byte *data);
+
+// batch versions of the above for converting whole rows or images at once. Components are tightly
+// packed at compByteWidth apart, and the results are identical to converting one at a time.
+void ConvertFromHalves(const uint16_t *comps, size_t count, float *out);
+void ConvertComponents(const ResourceFormat &fmt, const byte *data, size_t count, float *out);
@@ -25,6 +25,7 @@
 
 #include "os/os_specific.h"
 #include "api/replay/control_types.h"
+#include "common/threading.h"
 #include "strings/string_utils.h"
 
 int utf8printv(char *buf, size_t bufsize, const char *fmt, va_list args);
@@ -115,6 +116,241 @@ rdcstr OSUtility::MakeMachineIdentString(uint64_t ident)
   return ret;
 }
 
+void Network::SplitHostPort(rdcstr &host, uint16_t &port)
+{
+  int32_t colon = host.find_last_of(":");
+
+  // more than one colon is an IPv6 address, which we leave alone
+  if(colon <= 0 || host.find(':') != colon || colon + 1 == host.count())
+    return;
+
+  uint32_t value = 0;
+  for(int32_t i = colon + 1; i < host.count(); i++)
+  {
+    if(host[i] < '0' || host[i] > '9')
+      return;
+
+    value = value * 10 + uint32_t(host[i] - '0');
+
+    if(value > 0xffff)
+      return;
+  }
+
+  if(value == 0)
+    return;
+
+  port = uint16_t(value);
+  host.resize(colon);
+}
+
+namespace MemoryWatch
+{
+struct WatchedRegion
+{
+  uint8_t *base;
+  size_t size;
+  uint8_t *pageBase;
+  size_t numPages;
+  // incremented by the fault handler each time a page is written while protected, compared against
+  // the count seen at the last fetch to tell which pages are dirty.
+  int32_t *faults;
+  int32_t *seenFaults;
+  volatile int32_t active;
+};
+
+static const uint32_t MaxWatchedRegions = 256;
+
+static WatchedRegion regions[MaxWatchedRegions] = {};
+static Threading::SpinLock regionLock;
+static size_t pageSize = 0;
+static bool handlerInstalled = false;
+
+// the fault handler can't take regionLock, since it runs inside whatever the faulting thread was
+// doing. Instead it counts itself in here for as long as it looks at any region, and Unwatch waits
+// for this to drain after deactivating a region before it frees anything the handler might use.
+static volatile int32_t faultsInFlight = 0;
+
+bool HandleWriteFault(void *address)
+{
+  uint8_t *addr = (uint8_t *)address;
+
+  // must be counted before reading any region's active flag, pairing with Unwatch clearing the
+  // flag before it checks the count
+  Atomic::Inc32(&faultsInFlight);
+
+  bool handled = false;
+
+  for(uint32_t i = 0; i < MaxWatchedRegions; i++)
+  {
+    WatchedRegion &region = regions[i];
+
+    if(region.active && addr >= region.pageBase &&
+       addr < region.pageBase + region.numPages * pageSize)
+    {
+      size_t page = (addr - region.pageBase) / pageSize;
+
+      // unprotect before counting, so that a fetch which sees the new count can never re-protect
+      // the page only for us to then make it writable again behind its back
+      SetPagesWritable(region.pageBase + page * pageSize, pageSize, true);
+      Atomic::Inc32(&region.faults[page]);
+
+      handled = true;
+      break;
+    }
+  }
+
+  Atomic::Dec32(&faultsInFlight);
+
+  return handled;
+}
+
+bool Watch(void *base, size_t size)
+{
+  if(size == 0)
+    return false;
+
+  Threading::ScopedSpinLock lock(regionLock);
+
+  if(pageSize == 0)
+    pageSize = GetPageSize();
+
+  uint8_t *pageBase = (uint8_t *)((uintptr_t)base & ~uintptr_t(pageSize - 1));
+  uint8_t *pageEnd = AlignUpPtr((uint8_t *)base + size, pageSize);
+
+  WatchedRegion *region = NULL;
+
+  for(uint32_t i = 0; i < MaxWatchedRegions; i++)
+  {
+    if(regions[i].active)
+    {
+      uint8_t *otherEnd = regions[i].pageBase + regions[i].numPages * pageSize;
+      if(pageBase < otherEnd && regions[i].pageBase < pageEnd)
+      {
+        RDCERR("Can't watch %p, it shares pages with another watched region", base);
+        return false;
+      }
+    }
+    else if(region == NULL)
+    {
+      region = &regions[i];
+    }
+  }
+
+  if(region == NULL)
+  {
+    RDCWARN("Too many watched memory regions");
+    return false;
+  }
+
+  if(!handlerInstalled)
+  {
+    InstallWriteFaultHandler();
+    handlerInstalled = true;
+  }
+
+  region->base = (uint8_t *)base;
+  region->size = size;
+  region->pageBase = pageBase;
+  region->numPages = (pageEnd - pageBase) / pageSize;
+  region->faults = new int32_t[region->numPages]();
+  region->seenFaults = new int32_t[region->numPages]();
+
+  // publish the region before protecting it so that no fault can miss it
+  Atomic::Inc32(&region->active);
+
+  if(!SetPagesWritable(region->pageBase, region->numPages * pageSize, false))
+  {
+    RDCWARN("Couldn't write-protect %p for write tracking", base);
+    Atomic::Dec32(&region->active);
+    SAFE_DELETE_ARRAY(region->faults);
+    SAFE_DELETE_ARRAY(region->seenFaults);
+    return false;
+  }
+
+  return true;
+}
+
+void Unwatch(void *base)
+{
+  Threading::ScopedSpinLock lock(regionLock);
+
+  for(uint32_t i = 0; i < MaxWatchedRegions; i++)
+  {
+    WatchedRegion &region = regions[i];
+
+    if(region.active && region.base == base)
+    {
+      // once everything is writable there can be no more faults for this region
+      SetPagesWritable(region.pageBase, region.numPages * pageSize, true);
+      Atomic::Dec32(&region.active);
+
+      // a handler that saw the region active just before we cleared it may still be about to count
+      // a fault, so wait until no handler is running before freeing the counts. New handlers will
+      // see the region inactive, so this can't wait forever.
+      while(Atomic::CmpExch32(&faultsInFlight, 0, 0) != 0)
+        Threading::Sleep(0);
+
+      SAFE_DELETE_ARRAY(region.faults);
+      SAFE_DELETE_ARRAY(region.seenFaults);
+      return;
+    }
+  }
+}
+
+void FetchWrites(void *base, rdcarray<rdcpair<size_t, size_t>> &writtenRanges)
+{
+  Threading::ScopedSpinLock lock(regionLock);
+
+  WatchedRegion *region = NULL;
+
+  for(uint32_t i = 0; i < MaxWatchedRegions; i++)
+    if(regions[i].active && regions[i].base == base)
+      region = &regions[i];
+
+  if(region == NULL)
+    return;
+
+  volatile int32_t *faults = region->faults;
+  int32_t *seen = region->seenFaults;
+
+  size_t page = 0;
+  while(page < region->numPages)
+  {
+    if(faults[page] == seen[page])
+    {
+      page++;
+      continue;
+    }
+
+    // find the run of written pages
+    size_t runStart = page;
+    while(page < region->numPages && faults[page] != seen[page])
+    {
+      seen[page] = faults[page];
+      page++;
+    }
+
+    SetPagesWritable(region->pageBase + runStart * pageSize, (page - runStart) * pageSize, false);
+
+    // any page written after we snapshotted its count but before it was protected again will have
+    // become writable, so protect it again until the count is stable
+    for(size_t p = runStart; p < page; p++)
+    {
+      while(faults[p] != seen[p])
+      {
+        seen[p] = faults[p];
+        SetPagesWritable(region->pageBase + p * pageSize, pageSize, false);
+      }
+    }
+
+    uint8_t *rangeStart = RDCMAX(region->pageBase + runStart * pageSize, region->base);
+    uint8_t *rangeEnd = RDCMIN(region->pageBase + page * pageSize, region->base + region->size);
+
+    writtenRanges.push_back({size_t(rangeStart - region->base), size_t(rangeEnd - rangeStart)});
+  }
+}
+};
+
 #if ENABLED(ENABLE_UNIT_TESTS)
 
 #include "3rdparty/catch/catch.hpp"
@@ -397,6 +633,30 @@ TEST_CASE("Test OS-specific functions", "[osspecific]")
   const int numValues = 10;
   const int totalCount = numThreads * numValues;
 
+  SECTION("TLS slots")
+  {
+    int a = 0, b = 0;
+
+    uint64_t slot = Threading::AllocateTLSSlot();
+    Threading::SetTLSValue(slot, &a);
+    CHECK(Threading::GetTLSValue(slot) == &a);
+
+    // set the slot on another thread too, which must be cleared when the slot is freed
+    Threading::ThreadHandle th = Threading::CreateThread([slot, &b]() {
+      Threading::SetTLSValue(slot, &b);
+    });
+    Threading::JoinThread(th);
+    Threading::CloseThread(th);
+
+    Threading::FreeTLSSlot(slot);
+
+    // a freed slot is reused, and starts out empty
+    uint64_t reused = Threading::AllocateTLSSlot();
+    CHECK(reused == slot);
+    CHECK(Threading::GetTLSValue(reused) == NULL);
+
+    Threading::FreeTLSSlot(reused);
+  };
   SECTION("Simple threads")
   {
     uint64_t value = Threading::GetCurrentID();
@@ -559,6 +819,124 @@ TEST_CASE("Test OS-specific functions", "[osspecific]")
     Network::ParseIPRangeCIDR("216.58.211.174/31", ip, mask);
     CHECK(ip == Network::MakeIP(216, 58, 211, 174));
     CHECK(mask == 0xFFFFFFFe);
+
+    rdcstr host = "localhost";
+    uint16_t port = 1234;
+    Network::SplitHostPort(host, port);
+    CHECK(host == "localhost");
+    CHECK(port == 1234);
+
+    host = "localhost:39921";
+    Network::SplitHostPort(host, port);
+    CHECK(host == "localhost");
+    CHECK(port == 39921);
+
+    port = 1234;
+    for(rdcstr bad : {"localhost:", "localhost:99999", "localhost:12ab", ":80", "::1"})
+    {
+      host = bad;
+      Network::SplitHostPort(host, port);
+      CHECK(host == bad);
+      CHECK(port == 1234);
+    }
+  };
+  SECTION("Memory write watching")
+  {
+    const size_t pageSize = MemoryWatch::GetPageSize();
+
+    byte *mem = AllocAlignedBuffer(pageSize * 4, pageSize);
+    memset(mem, 0, pageSize * 4);
+
+    // watch from partway into the first page to check ranges are clamped to the region
+    byte *base = mem + 100;
+    const size_t size = pageSize * 4 - 100;
+
+    REQUIRE(MemoryWatch::Watch(base, size));
+
+    rdcarray<rdcpair<size_t, size_t>> written;
+    MemoryWatch::FetchWrites(base, written);
+    CHECK(written.empty());
+
+    base[10] = 1;
+    base[pageSize * 2 + 5] = 2;
+    base[pageSize * 2 + 50] = 3;
+
+    MemoryWatch::FetchWrites(base, written);
+    REQUIRE(written.size() == 2);
+    CHECK(written[0].first == 0);
+    CHECK(written[0].second == pageSize - 100);
+    CHECK(written[1].first == pageSize * 2 - 100);
+    CHECK(written[1].second == pageSize);
+
+    // pages are protected again after fetching
+    written.clear();
+    MemoryWatch::FetchWrites(base, written);
+    CHECK(written.empty());
+
+    base[size - 1] = 4;
+
+    MemoryWatch::FetchWrites(base, written);
+    REQUIRE(written.size() == 1);
+    CHECK(written[0].first == pageSize * 3 - 100);
+    CHECK(written[0].second == pageSize);
+
+    MemoryWatch::Unwatch(base);
+
+    // no longer tracked or protected
+    base[0] = 5;
+    written.clear();
+    MemoryWatch::FetchWrites(base, written);
+    CHECK(written.empty());
+
+    CHECK(base[pageSize * 2 + 50] == 3);
+
+    FreeAlignedBuffer(mem);
+  };
+  SECTION("Memory write watching from several threads")
+  {
+    const size_t pageSize = MemoryWatch::GetPageSize();
+    const int numThreads = 4;
+
+    // each thread watches, writes and unwatches its own region over and over, so faults are being
+    // handled on some threads while regions are unwatched and freed on others
+    volatile int32_t errors = 0;
+
+    Threading::ThreadHandle threads[numThreads];
+    for(int threadID = 0; threadID < numThreads; threadID++)
+    {
+      threads[threadID] = Threading::CreateThread([&errors, pageSize]() {
+        byte *mem = AllocAlignedBuffer(pageSize * 2, pageSize);
+        rdcarray<rdcpair<size_t, size_t>> written;
+
+        for(int i = 0; i < 200; i++)
+        {
+          if(!MemoryWatch::Watch(mem, pageSize * 2))
+          {
+            Atomic::Inc32(&errors);
+            break;
+          }
+
+          mem[pageSize + (i % pageSize)] = byte(i);
+
+          written.clear();
+          MemoryWatch::FetchWrites(mem, written);
+          if(written.size() != 1 || written[0].first != pageSize)
+            Atomic::Inc32(&errors);
+
+          MemoryWatch::Unwatch(mem);
+        }
+
+        FreeAlignedBuffer(mem);
+      });
+    }
+
+    for(int threadID = 0; threadID < numThreads; threadID++)
+    {
+      Threading::JoinThread(threads[threadID]);
+      Threading::CloseThread(threads[threadID]);
+    }
+
+    CHECK(errors == 0);
   };
 };
 
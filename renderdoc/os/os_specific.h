@@ -137,14 +137,56 @@ public:
   data m_Data;
 };
 
+// a lightweight non-recursive mutex, cheaper than CriticalSection to take and release. Locking it
+// again on the thread that already holds it deadlocks.
+template <class data>
+class MutexTemplate
+{
+public:
+  MutexTemplate();
+  ~MutexTemplate();
+  void Lock();
+  bool Trylock();
+  void Unlock();
+
+  // no copying
+  MutexTemplate &operator=(const MutexTemplate &other) = delete;
+  MutexTemplate(const MutexTemplate &other) = delete;
+
+  data m_Data;
+};
+
+// a counting semaphore. Wait() blocks until the count is non-zero then decrements it, Signal()
+// increments it and wakes a waiter.
+template <class data>
+class SemaphoreTemplate
+{
+public:
+  SemaphoreTemplate(uint32_t initialCount = 0);
+  ~SemaphoreTemplate();
+
+  void Wait();
+  void Signal();
+
+  // no copying
+  SemaphoreTemplate &operator=(const SemaphoreTemplate &other) = delete;
+  SemaphoreTemplate(const SemaphoreTemplate &other) = delete;
+
+  data m_Data;
+};
+
 void Init();
 void Shutdown();
 uint64_t AllocateTLSSlot();
+// releases a slot so it can be allocated again, clearing its value on every thread. Nothing may be
+// using the slot on any thread when it's freed.
+void FreeTLSSlot(uint64_t slot);
 
 void *GetTLSValue(uint64_t slot);
 void SetTLSValue(uint64_t slot, void *value);
 
-// must typedef CriticalSectionTemplate<X> CriticalSection
+// must typedef CriticalSectionTemplate<X> CriticalSection, RWLockTemplate<Y> RWLock,
+// MutexTemplate<M> Mutex and SemaphoreTemplate<Z> Semaphore
 
 void SetCurrentThreadName(const rdcstr &name);
 
@@ -156,6 +198,9 @@ void DetachThread(ThreadHandle handle);
 void CloseThread(ThreadHandle handle);
 void Sleep(uint32_t milliseconds);
 
+// returns the number of logical processors currently available, always at least 1
+uint32_t NumberOfCores();
+
 // kind of windows specific, to handle this case:
 // http://blogs.msdn.com/b/oldnewthing/archive/2013/11/05/10463645.aspx
 void KeepModuleAlive();
@@ -218,6 +263,10 @@ inline bool MatchIPMask(uint32_t ip, uint32_t range, uint32_t mask)
 // aaa.bbb.ccc.ddd/nn
 bool ParseIPRangeCIDR(const char *str, uint32_t &ip, uint32_t &mask);
 
+// splits an optional trailing :port off a hostname. If there's no valid port suffix, host is left
+// untouched and port keeps the default it was passed in with
+void SplitHostPort(rdcstr &host, uint16_t &port);
+
 void Init();
 void Shutdown();
 };
@@ -259,6 +308,17 @@ class StackResolver
 public:
   virtual ~StackResolver() {}
   virtual AddressDetails GetAddr(uint64_t addr) = 0;
+
+  // resolve a whole list of addresses. Resolvers that can look up several addresses more cheaply
+  // in one go than one at a time should override this.
+  virtual rdcarray<AddressDetails> GetAddrs(const rdcarray<uint64_t> &addrs)
+  {
+    rdcarray<AddressDetails> ret;
+    ret.reserve(addrs.size());
+    for(uint64_t addr : addrs)
+      ret.push_back(GetAddr(addr));
+    return ret;
+  }
 };
 
 void Init();
@@ -312,6 +372,14 @@ void fseek64(FILE *f, uint64_t offset, int origin);
 
 void ftruncateat(FILE *f, uint64_t length);
 
+// maps a read-only view of length bytes starting at offset in the file. The view stays valid until
+// unmapped, even if the FILE is closed. Returns NULL if the region can't be mapped or the file is
+// too short to cover it, in which case the file should be read normally. On some platforms the file
+// can still be truncated while mapped, and touching the lost pages faults - so readers of a mapped
+// view must re-check the file size, see StreamReader::SetExternalMemoryCheck.
+const void *MapFileRegion(FILE *f, uint64_t offset, uint64_t length);
+void UnmapFileRegion(const void *data, uint64_t length);
+
 bool fflush(FILE *f);
 
 bool feof(FILE *f);
@@ -497,6 +565,26 @@ uint64_t GetMachineIdent();
 rdcstr MakeMachineIdentString(uint64_t ident);
 };
 
+// tracks CPU writes to a block of memory by write-protecting the pages that cover it and catching
+// the resulting faults. Any page that is written is unprotected on its first write so the cost is
+// at most one fault per page between fetches. Regions must not share pages with each other.
+namespace MemoryWatch
+{
+bool Watch(void *base, size_t size);
+void Unwatch(void *base);
+// fetches the [offset, offset+size) ranges relative to base, rounded out to page boundaries, that
+// have been written since the region was watched or last fetched and protects them again.
+void FetchWrites(void *base, rdcarray<rdcpair<size_t, size_t>> &writtenRanges);
+
+// implemented per-platform, for use by the above
+size_t GetPageSize();
+bool SetPagesWritable(void *pages, size_t size, bool writable);
+void InstallWriteFaultHandler();
+// called by the platform's fault handler - returns true if the fault was in a watched region and
+// has been handled, so execution can continue
+bool HandleWriteFault(void *address);
+};
+
 namespace Bits
 {
 inline uint32_t CountLeadingZeroes(uint32_t value);
@@ -41,6 +41,38 @@ uint64_t Timing::GetTick()
   return mach_absolute_time();
 }
 
+namespace Threading
+{
+template <>
+Mutex::MutexTemplate()
+{
+  m_Data = OS_UNFAIR_LOCK_INIT;
+}
+
+template <>
+Mutex::~MutexTemplate()
+{
+}
+
+template <>
+void Mutex::Lock()
+{
+  os_unfair_lock_lock(&m_Data);
+}
+
+template <>
+bool Mutex::Trylock()
+{
+  return os_unfair_lock_trylock(&m_Data);
+}
+
+template <>
+void Mutex::Unlock()
+{
+  os_unfair_lock_unlock(&m_Data);
+}
+};
+
 void Threading::SetCurrentThreadName(const rdcstr &name)
 {
 }
@@ -159,73 +159,127 @@ public:
   LinuxResolver(rdcarray<LookupModule> modules) { m_Modules = modules; }
   Callstack::AddressDetails GetAddr(uint64_t addr)
   {
-    EnsureCached(addr);
+    EnsureCached({addr});
 
     return m_Cache[addr];
   }
 
-private:
-  void EnsureCached(uint64_t addr)
+  rdcarray<Callstack::AddressDetails> GetAddrs(const rdcarray<uint64_t> &addrs)
   {
-    auto it = m_Cache.insert(
-        std::pair<uint64_t, Callstack::AddressDetails>(addr, Callstack::AddressDetails()));
-    if(!it.second)
-      return;
+    EnsureCached(addrs);
 
-    Callstack::AddressDetails &ret = it.first->second;
+    rdcarray<Callstack::AddressDetails> ret;
+    ret.reserve(addrs.size());
+    for(uint64_t addr : addrs)
+      ret.push_back(m_Cache[addr]);
+    return ret;
+  }
 
-    ret.filename = "Unknown";
-    ret.line = 0;
-    ret.function = StringFormat::Fmt("0x%08llx", addr);
+private:
+  void EnsureCached(const rdcarray<uint64_t> &addrs)
+  {
+    // gather the addresses we haven't seen before by module, so that each module only needs one
+    // addr2line invocation for all of its addresses.
+    std::map<size_t, rdcarray<uint64_t>> pending;
 
-    for(size_t i = 0; i < m_Modules.size(); i++)
+    for(uint64_t addr : addrs)
     {
-      if(addr >= m_Modules[i].base && addr < m_Modules[i].end)
+      auto it = m_Cache.insert(
+          std::pair<uint64_t, Callstack::AddressDetails>(addr, Callstack::AddressDetails()));
+      if(!it.second)
+        continue;
+
+      Callstack::AddressDetails &ret = it.first->second;
+
+      ret.filename = "Unknown";
+      ret.line = 0;
+      ret.function = StringFormat::Fmt("0x%08llx", addr);
+
+      for(size_t i = 0; i < m_Modules.size(); i++)
       {
-        uint64_t relative = addr - m_Modules[i].base + m_Modules[i].offset;
-        rdcstr cmd = StringFormat::Fmt("addr2line -fCe \"%s\" 0x%llx", m_Modules[i].path, relative);
+        if(addr >= m_Modules[i].base && addr < m_Modules[i].end)
+        {
+          pending[i].push_back(addr);
+          break;
+        }
+      }
+    }
+
+    for(auto it = pending.begin(); it != pending.end(); ++it)
+      Resolve(m_Modules[it->first], it->second);
+  }
+
+  void Resolve(const LookupModule &mod, const rdcarray<uint64_t> &addrs)
+  {
+    // addr2line prints a function line and a file:line line for each address it's given, so pass
+    // addresses in batches to keep the command line to a sensible length.
+    const size_t batchSize = 128;
+
+    for(size_t batch = 0; batch < addrs.size(); batch += batchSize)
+    {
+      const size_t batchEnd = RDCMIN(addrs.size(), batch + batchSize);
+
+      rdcstr cmd = StringFormat::Fmt("addr2line -fCe \"%s\"", mod.path);
+      for(size_t i = batch; i < batchEnd; i++)
+        cmd += StringFormat::Fmt(" 0x%llx", addrs[i] - mod.base + mod.offset);
+
+      FILE *f = ::popen(cmd.c_str(), "r");
 
-        FILE *f = ::popen(cmd.c_str(), "r");
+      if(!f)
+        continue;
 
-        char result[2048] = {0};
-        fread(result, 1, 2047, f);
+      rdcstr result;
+      char buf[4096];
+      size_t numRead = 0;
+      while((numRead = fread(buf, 1, sizeof(buf), f)) > 0)
+        result.append(buf, numRead);
 
-        fclose(f);
+      ::pclose(f);
 
-        char *line2 = strchr(result, '\n');
-        if(line2)
+      char *line = result.data();
+
+      for(size_t i = batch; i < batchEnd && line && *line; i++)
+      {
+        char *line2 = strchr(line, '\n');
+        if(!line2)
+          break;
+
+        *line2 = 0;
+        line2++;
+
+        char *next = strchr(line2, '\n');
+        if(next)
         {
-          *line2 = 0;
-          line2++;
+          *next = 0;
+          next++;
         }
 
-        ret.function = result;
+        Callstack::AddressDetails &ret = m_Cache[addrs[i]];
 
-        if(line2)
-        {
-          char *linenum = line2 + strlen(line2) - 1;
-          while(linenum > line2 && *linenum != ':')
-            linenum--;
+        ret.function = line;
 
-          ret.line = 0;
+        char *linenum = line2 + strlen(line2);
+        while(linenum > line2 && *linenum != ':')
+          linenum--;
 
-          if(*linenum == ':')
+        ret.line = 0;
+
+        if(*linenum == ':')
+        {
+          *linenum = 0;
+          linenum++;
+
+          while(*linenum >= '0' && *linenum <= '9')
           {
-            *linenum = 0;
+            ret.line *= 10;
+            ret.line += (uint32_t(*linenum) - uint32_t('0'));
             linenum++;
-
-            while(*linenum >= '0' && *linenum <= '9')
-            {
-              ret.line *= 10;
-              ret.line += (uint32_t(*linenum) - uint32_t('0'));
-              linenum++;
-            }
           }
-
-          ret.filename = line2;
         }
 
-        break;
+        ret.filename = line2;
+
+        line = next;
       }
     }
   }
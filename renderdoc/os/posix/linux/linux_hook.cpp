@@ -28,6 +28,7 @@
 #include <map>
 #include "3rdparty/plthook/plthook.h"
 #include "common/threading.h"
+#include "common/timing.h"
 #include "hooks/hooks.h"
 #include "os/os_specific.h"
 #include "strings/string_utils.h"
@@ -38,6 +39,15 @@ static std::map<rdcstr, rdcarray<FunctionLoadCallback>> libraryCallbacks;
 static rdcarray<rdcstr> libraryHooks;
 static rdcarray<FunctionHook> functionHooks;
 
+// for each library we've found loaded, how many of functionHooks have been looked up in it. Since a
+// library's exports don't change, only hooks registered since then need to be looked up again.
+static std::map<rdcstr, size_t> libraryResolvedHooks;
+
+// function hook indices by name, for matching against PLT entries. Rebuilt if more hooks are
+// registered
+static std::map<rdcstr, rdcarray<size_t>> functionHookIndices;
+static size_t functionHookIndicesCount = 0;
+
 void *intercept_dlopen(const char *filename, int flag, void *ret);
 void plthook_lib(void *handle);
 
@@ -126,8 +136,32 @@ void plthook_lib(void *handle)
 
   plthook_replace(plthook, "dlopen", (void *)dlopen, NULL);
 
-  for(FunctionHook &hook : functionHooks)
+  if(functionHookIndicesCount != functionHooks.size())
+  {
+    functionHookIndices.clear();
+    for(size_t i = 0; i < functionHooks.size(); i++)
+      functionHookIndices[functionHooks[i].function].push_back(i);
+    functionHookIndicesCount = functionHooks.size();
+  }
+
+  // walk the PLT once and only replace the functions it actually imports, rather than searching it
+  // for every registered hook.
+  rdcarray<size_t> imported;
+
+  unsigned int pos = 0;
+  const char *name = NULL;
+  void **addr = NULL;
+  while(plthook_enum(plthook, &pos, &name, &addr) == 0)
   {
+    const char *version = strchr(name, '@');
+    auto it = functionHookIndices.find(version ? rdcstr(name, version - name) : rdcstr(name));
+    if(it != functionHookIndices.end())
+      imported.append(it->second);
+  }
+
+  for(size_t i : imported)
+  {
+    FunctionHook &hook = functionHooks[i];
     void *orig = NULL;
     plthook_replace(plthook, hook.function.c_str(), hook.hook, &orig);
     if(hook.orig && *hook.orig == NULL && orig)
@@ -137,6 +171,20 @@ void plthook_lib(void *handle)
   plthook_close(plthook);
 }
 
+static void ResolveFunctionHooks(const rdcstr &libName, void *handle)
+{
+  size_t &resolved = libraryResolvedHooks[libName];
+
+  for(size_t i = resolved; i < functionHooks.size(); i++)
+  {
+    FunctionHook &hook = functionHooks[i];
+    if(hook.orig && *hook.orig == NULL)
+      *hook.orig = dlsym(handle, hook.function.c_str());
+  }
+
+  resolved = functionHooks.size();
+}
+
 static void CheckLoadedLibraries()
 {
   // don't process anything if the busy flag was set, otherwise set it ourselves
@@ -148,15 +196,18 @@ static void CheckLoadedLibraries()
   for(auto it = libraryHooks.begin(); it != libraryHooks.end(); ++it)
   {
     rdcstr libName = *it;
+
+    // this is called on every dlopen, so skip libraries we've already fully processed without
+    // touching the loader at all.
+    auto resolved = libraryResolvedHooks.find(libName);
+    if(resolved != libraryResolvedHooks.end() && resolved->second == functionHooks.size())
+      continue;
+
     void *handle = realdlopen(libName.c_str(), RTLD_NOW | RTLD_NOLOAD | RTLD_GLOBAL);
 
     if(handle)
     {
-      for(FunctionHook &hook : functionHooks)
-      {
-        if(hook.orig && *hook.orig == NULL)
-          *hook.orig = dlsym(handle, hook.function.c_str());
-      }
+      ResolveFunctionHooks(libName, handle);
 
       rdcarray<FunctionLoadCallback> callbacks;
 
@@ -181,6 +232,8 @@ void *intercept_dlopen(const char *filename, int flag, void *ret)
   if(filename == NULL)
     return ret;
 
+  PerformanceTimer timer;
+
   if(flag & RTLD_DEEPBIND)
     plthook_lib(ret);
 
@@ -193,11 +246,7 @@ void *intercept_dlopen(const char *filename, int flag, void *ret)
     {
       RDCDEBUG("Redirecting dlopen to ourselves for %s", filename);
 
-      for(FunctionHook &hook : functionHooks)
-      {
-        if(hook.orig && *hook.orig == NULL)
-          *hook.orig = dlsym(ret, hook.function.c_str());
-      }
+      ResolveFunctionHooks(libName, ret);
 
       rdcarray<FunctionLoadCallback> callbacks;
 
@@ -217,6 +266,8 @@ void *intercept_dlopen(const char *filename, int flag, void *ret)
   // did in EndHookRegistration to see if any library has been loaded.
   CheckLoadedLibraries();
 
+  RDCDEBUG("Processed dlopen of %s in %.2fms", filename, timer.GetMilliseconds());
+
   return ret;
 }
 
@@ -237,7 +288,12 @@ void LibraryHooks::RemoveHooks()
 
 void LibraryHooks::EndHookRegistration()
 {
+  PerformanceTimer timer;
+
   CheckLoadedLibraries();
+
+  RDCLOG("Resolved %zu function hooks over %zu libraries in %.2fms", functionHooks.size(),
+         libraryHooks.size(), timer.GetMilliseconds());
 }
 
 void LibraryHooks::Refresh()
@@ -29,6 +29,7 @@
 #include <signal.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
 #include <sys/types.h>
 #include <sys/wait.h>
 #include <unistd.h>
@@ -887,6 +888,60 @@ void Process::Shutdown()
   }
 }
 
+size_t MemoryWatch::GetPageSize()
+{
+  return (size_t)sysconf(_SC_PAGESIZE);
+}
+
+bool MemoryWatch::SetPagesWritable(void *pages, size_t size, bool writable)
+{
+  return mprotect(pages, size, writable ? (PROT_READ | PROT_WRITE) : PROT_READ) == 0;
+}
+
+// depending on the platform a write to protected memory raises either of these
+static const int writeFaultSignals[] = {SIGSEGV, SIGBUS};
+static struct sigaction old_fault_actions[ARRAY_COUNT(writeFaultSignals)];
+
+static void WriteFaultHandler(int signum, siginfo_t *handler_info, void *handler_context)
+{
+  if(MemoryWatch::HandleWriteFault(handler_info->si_addr))
+    return;
+
+  for(size_t i = 0; i < ARRAY_COUNT(writeFaultSignals); i++)
+  {
+    if(writeFaultSignals[i] != signum)
+      continue;
+
+    struct sigaction &old_action = old_fault_actions[i];
+
+    if(old_action.sa_flags & SA_SIGINFO)
+    {
+      old_action.sa_sigaction(signum, handler_info, handler_context);
+    }
+    else if(old_action.sa_handler == SIG_DFL || old_action.sa_handler == SIG_IGN)
+    {
+      // a genuine fault. Put back the old handling and return, so the faulting instruction runs
+      // again and gets the default behaviour
+      sigaction(signum, &old_action, NULL);
+    }
+    else
+    {
+      old_action.sa_handler(signum);
+    }
+  }
+}
+
+void MemoryWatch::InstallWriteFaultHandler()
+{
+  struct sigaction new_action = {};
+  sigemptyset(&new_action.sa_mask);
+  new_action.sa_flags = SA_SIGINFO | SA_RESTART;
+  new_action.sa_sigaction = &WriteFaultHandler;
+
+  for(size_t i = 0; i < ARRAY_COUNT(writeFaultSignals); i++)
+    sigaction(writeFaultSignals[i], &new_action, &old_fault_actions[i]);
+}
+
 #if ENABLED(ENABLE_UNIT_TESTS)
 
 #include "3rdparty/catch/catch.hpp"
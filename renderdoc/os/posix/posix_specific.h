@@ -28,6 +28,10 @@
 #include <signal.h>
 #include "data/embedded_files.h"
 
+#if ENABLED(RDOC_APPLE)
+#include <os/lock.h>
+#endif
+
 // this works on all supported clang versions
 #if defined(__clang__)
 
@@ -105,6 +109,25 @@ struct pthreadRWLockData
   pthread_rwlockattr_t attr;
 };
 typedef RWLockTemplate<pthreadRWLockData> RWLock;
+
+#if ENABLED(RDOC_APPLE)
+typedef MutexTemplate<os_unfair_lock> Mutex;
+#else
+// 0 when unlocked, 1 when locked, 2 when locked and another thread may be waiting on the futex
+struct futexMutexData
+{
+  volatile int32_t state;
+};
+typedef MutexTemplate<futexMutexData> Mutex;
+#endif
+
+struct pthreadSemaphoreData
+{
+  pthread_mutex_t lock;
+  pthread_cond_t cond;
+  uint32_t count;
+};
+typedef SemaphoreTemplate<pthreadSemaphoreData> Semaphore;
 };
 
 namespace Bits
@@ -32,6 +32,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <sys/file.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <time.h>
@@ -440,6 +441,44 @@ void ftruncateat(FILE *f, uint64_t length)
   ::ftruncate(fd, (off_t)length);
 }
 
+const void *MapFileRegion(FILE *f, uint64_t offset, uint64_t length)
+{
+  if(f == NULL || length == 0)
+    return NULL;
+
+  // pages past the end of the file can be mapped but fault when touched, so don't map a region the
+  // file doesn't fully cover and let it be read normally instead
+  struct ::stat st = {};
+  if(fstat(::fileno(f), &st) != 0 || uint64_t(st.st_size) < offset + length)
+    return NULL;
+
+  // mmap offsets must be page aligned, so map from the page containing offset
+  uint64_t pageSize = (uint64_t)sysconf(_SC_PAGESIZE);
+  uint64_t delta = offset % pageSize;
+
+  if(length + delta > (uint64_t)SIZE_MAX)
+    return NULL;
+
+  void *view = mmap(NULL, size_t(length + delta), PROT_READ, MAP_PRIVATE, ::fileno(f),
+                    off_t(offset - delta));
+
+  if(view == MAP_FAILED)
+    return NULL;
+
+  return (const byte *)view + delta;
+}
+
+void UnmapFileRegion(const void *data, uint64_t length)
+{
+  if(data == NULL)
+    return;
+
+  uintptr_t pageSize = (uintptr_t)sysconf(_SC_PAGESIZE);
+  uintptr_t base = uintptr_t(data) & ~(pageSize - 1);
+
+  munmap((void *)base, size_t(length + (uintptr_t(data) - base)));
+}
+
 bool fflush(FILE *f)
 {
   return ::fflush(f) == 0;
@@ -27,6 +27,11 @@
 #include "common/common.h"
 #include "os/os_specific.h"
 
+#if DISABLED(RDOC_APPLE)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+
 void CacheDebuggerPresent();
 
 uint64_t Timing::GetUnixTimestamp()
@@ -157,6 +162,99 @@ void RWLock::ReadUnlock()
   pthread_rwlock_unlock(&m_Data.rwlock);
 }
 
+#if DISABLED(RDOC_APPLE)
+// Apple has no futex, os_unfair_lock is used instead - see apple_threading.cpp
+static void FutexWait(volatile int32_t *addr, int32_t val)
+{
+  syscall(SYS_futex, addr, FUTEX_WAIT_PRIVATE, val, NULL, NULL, 0);
+}
+
+static void FutexWake(volatile int32_t *addr)
+{
+  syscall(SYS_futex, addr, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+}
+
+template <>
+Mutex::MutexTemplate()
+{
+  m_Data.state = 0;
+}
+
+template <>
+Mutex::~MutexTemplate()
+{
+}
+
+template <>
+void Mutex::Lock()
+{
+  // uncontended fast path never enters the kernel
+  int32_t c = Atomic::CmpExch32(&m_Data.state, 0, 1);
+  if(c == 0)
+    return;
+
+  // mark the lock as contended so the owner knows to wake us, and sleep until it's released
+  if(c != 2)
+    c = __atomic_exchange_n(&m_Data.state, 2, __ATOMIC_ACQUIRE);
+  while(c != 0)
+  {
+    FutexWait(&m_Data.state, 2);
+    c = __atomic_exchange_n(&m_Data.state, 2, __ATOMIC_ACQUIRE);
+  }
+}
+
+template <>
+bool Mutex::Trylock()
+{
+  return Atomic::CmpExch32(&m_Data.state, 0, 1) == 0;
+}
+
+template <>
+void Mutex::Unlock()
+{
+  // only go to the kernel if someone may be waiting
+  if(__atomic_fetch_sub(&m_Data.state, 1, __ATOMIC_RELEASE) != 1)
+  {
+    __atomic_store_n(&m_Data.state, 0, __ATOMIC_RELEASE);
+    FutexWake(&m_Data.state);
+  }
+}
+#endif
+
+template <>
+Semaphore::SemaphoreTemplate(uint32_t initialCount)
+{
+  pthread_mutex_init(&m_Data.lock, NULL);
+  pthread_cond_init(&m_Data.cond, NULL);
+  m_Data.count = initialCount;
+}
+
+template <>
+Semaphore::~SemaphoreTemplate()
+{
+  pthread_cond_destroy(&m_Data.cond);
+  pthread_mutex_destroy(&m_Data.lock);
+}
+
+template <>
+void Semaphore::Wait()
+{
+  pthread_mutex_lock(&m_Data.lock);
+  while(m_Data.count == 0)
+    pthread_cond_wait(&m_Data.cond, &m_Data.lock);
+  m_Data.count--;
+  pthread_mutex_unlock(&m_Data.lock);
+}
+
+template <>
+void Semaphore::Signal()
+{
+  pthread_mutex_lock(&m_Data.lock);
+  m_Data.count++;
+  pthread_cond_signal(&m_Data.cond);
+  pthread_mutex_unlock(&m_Data.lock);
+}
+
 struct ThreadInitData
 {
   std::function<void()> entryFunc;
@@ -187,6 +285,7 @@ struct TLSData
 
 static CriticalSection *m_TLSListLock = NULL;
 static rdcarray<TLSData *> *m_TLSList = NULL;
+static rdcarray<uint64_t> *m_FreeTLSSlots = NULL;
 
 void Init()
 {
@@ -196,6 +295,7 @@ void Init()
 
   m_TLSListLock = new CriticalSection();
   m_TLSList = new rdcarray<TLSData *>();
+  m_FreeTLSSlots = new rdcarray<uint64_t>();
 
   CacheDebuggerPresent();
 }
@@ -206,8 +306,14 @@ void Shutdown()
     delete m_TLSList->at(i);
 
   delete m_TLSList;
+  delete m_FreeTLSSlots;
   delete m_TLSListLock;
 
+  // anything destroyed after this can't free its slot
+  m_TLSList = NULL;
+  m_FreeTLSSlots = NULL;
+  m_TLSListLock = NULL;
+
   pthread_key_delete(OSTLSHandle);
 }
 
@@ -216,9 +322,40 @@ void Shutdown()
 // value
 uint64_t AllocateTLSSlot()
 {
+  // reuse a freed slot if there is one, so that objects which each take a slot for their lifetime
+  // don't grow every thread's vector forever. Slots allocated before Init() are never freed.
+  if(m_TLSListLock)
+  {
+    m_TLSListLock->Lock();
+    uint64_t ret = 0;
+    if(!m_FreeTLSSlots->empty())
+    {
+      ret = m_FreeTLSSlots->back();
+      m_FreeTLSSlots->pop_back();
+    }
+    m_TLSListLock->Unlock();
+
+    if(ret != 0)
+      return ret;
+  }
+
   return Atomic::Inc64(&nextTLSSlot);
 }
 
+void FreeTLSSlot(uint64_t slot)
+{
+  if(slot == 0 || m_TLSListLock == NULL)
+    return;
+
+  // clear the slot on every thread, so whoever allocates it next doesn't see our stale values
+  m_TLSListLock->Lock();
+  for(TLSData *slots : *m_TLSList)
+    if(slot - 1 < slots->data.size())
+      slots->data[(size_t)slot - 1] = NULL;
+  m_FreeTLSSlots->push_back(slot);
+  m_TLSListLock->Unlock();
+}
+
 // look up our per-thread vector.
 void *GetTLSValue(uint64_t slot)
 {
@@ -250,8 +387,13 @@ void SetTLSValue(uint64_t slot, void *value)
       m_TLSListLock->Unlock();
     }
 
+    // resizing takes the lock so that FreeTLSSlot never clears a slot in a vector being moved
     if(slot - 1 >= slots->data.size())
-    slots->data.resize((size_t)slot);
+    {
+      m_TLSListLock->Lock();
+      slots->data.resize((size_t)slot);
+      m_TLSListLock->Unlock();
+    }
   }
 
   slots->data[(size_t)slot - 1] = value;
@@ -303,4 +445,10 @@ void Sleep(uint32_t milliseconds)
 {
   usleep(milliseconds * 1000);
 }
+
+uint32_t NumberOfCores()
+{
+  long cores = sysconf(_SC_NPROCESSORS_ONLN);
+  return cores > 0 ? (uint32_t)cores : 1;
+}
 };
@@ -653,23 +653,22 @@ BOOL CALLBACK EnumModule(PCWSTR ModuleName, DWORD64 BaseOfDll, PVOID UserContext
 
 void Win32Callstack::Collect()
 {
-  rdcarray<PVOID> stack32;
+  PVOID stack[64];
 
-  stack32.resize(64);
+  USHORT num = RtlCaptureStackBackTrace(0, 63, stack, NULL);
 
-  USHORT num = RtlCaptureStackBackTrace(0, 63, &stack32[0], NULL);
-
-  stack32.resize(num);
-
-  while(!stack32.empty() && (uint64_t)stack32[0] >= (uint64_t)renderdocBase &&
-        (uint64_t)stack32[0] <= (uint64_t)renderdocBase + renderdocSize)
+  // skip past our own frames at the top of the stack. This is done by index into a local array
+  // since it happens for every chunk when capturing callstacks.
+  USHORT first = 0;
+  while(first < num && (uint64_t)stack[first] >= (uint64_t)renderdocBase &&
+        (uint64_t)stack[first] <= (uint64_t)renderdocBase + renderdocSize)
   {
-    stack32.erase(0, 1);
+    first++;
   }
 
-  m_AddrStack.resize(stack32.size());
-  for(size_t i = 0; i < stack32.size(); i++)
-    m_AddrStack[i] = (DWORD64)stack32[i];
+  m_AddrStack.resize(num - first);
+  for(USHORT i = first; i < num; i++)
+    m_AddrStack[i - first] = (DWORD64)stack[i];
 }
 
 Win32Callstack::Win32Callstack()
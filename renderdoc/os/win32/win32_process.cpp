@@ -1641,3 +1641,43 @@ void Process::Shutdown()
 {
   // nothing to do
 }
+
+size_t MemoryWatch::GetPageSize()
+{
+  SYSTEM_INFO info = {};
+  GetSystemInfo(&info);
+  return (size_t)info.dwPageSize;
+}
+
+bool MemoryWatch::SetPagesWritable(void *pages, size_t size, bool writable)
+{
+  // mapped device memory is often write-combined or uncached, keep those modifiers when changing
+  // the access protection
+  MEMORY_BASIC_INFORMATION mem = {};
+  VirtualQuery(pages, &mem, sizeof(mem));
+
+  DWORD modifiers = mem.Protect & (PAGE_NOCACHE | PAGE_WRITECOMBINE);
+
+  DWORD oldProtect = 0;
+  return VirtualProtect(pages, size, (writable ? PAGE_READWRITE : PAGE_READONLY) | modifiers,
+                        &oldProtect) != FALSE;
+}
+
+static LONG CALLBACK WriteFaultHandler(PEXCEPTION_POINTERS info)
+{
+  PEXCEPTION_RECORD rec = info->ExceptionRecord;
+
+  // the first parameter is 1 for a write access, the second is the address accessed
+  if(rec->ExceptionCode == EXCEPTION_ACCESS_VIOLATION && rec->NumberParameters >= 2 &&
+     rec->ExceptionInformation[0] == 1 &&
+     MemoryWatch::HandleWriteFault((void *)rec->ExceptionInformation[1]))
+    return EXCEPTION_CONTINUE_EXECUTION;
+
+  return EXCEPTION_CONTINUE_SEARCH;
+}
+
+void MemoryWatch::InstallWriteFaultHandler()
+{
+  // first in line, so faults in watched memory are handled before any crash handler sees them
+  AddVectoredExceptionHandler(1, &WriteFaultHandler);
+}
@@ -64,6 +64,8 @@ namespace Threading
 {
 typedef CriticalSectionTemplate<CRITICAL_SECTION> CriticalSection;
 typedef RWLockTemplate<SRWLOCK> RWLock;
+typedef MutexTemplate<SRWLOCK> Mutex;
+typedef SemaphoreTemplate<HANDLE> Semaphore;
 };
 
 namespace Bits
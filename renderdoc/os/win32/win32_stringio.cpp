@@ -643,6 +643,54 @@ void ftruncateat(FILE *f, uint64_t length)
   ::_chsize_s(fd, (int64_t)length);
 }
 
+const void *MapFileRegion(FILE *f, uint64_t offset, uint64_t length)
+{
+  if(f == NULL || length == 0)
+    return NULL;
+
+  HANDLE file = (HANDLE)::_get_osfhandle(::_fileno(f));
+
+  if(file == INVALID_HANDLE_VALUE)
+    return NULL;
+
+  HANDLE mapping = CreateFileMappingW(file, NULL, PAGE_READONLY, 0, 0, NULL);
+
+  if(mapping == NULL)
+    return NULL;
+
+  // view offsets must be aligned to the allocation granularity
+  SYSTEM_INFO info = {};
+  GetSystemInfo(&info);
+  uint64_t delta = offset % info.dwAllocationGranularity;
+  uint64_t viewOffset = offset - delta;
+
+  void *view = NULL;
+
+  if(length + delta <= (uint64_t)SIZE_MAX)
+    view = MapViewOfFile(mapping, FILE_MAP_READ, DWORD(viewOffset >> 32),
+                         DWORD(viewOffset & 0xffffffff), SIZE_T(length + delta));
+
+  // the view keeps the mapping alive
+  CloseHandle(mapping);
+
+  if(view == NULL)
+    return NULL;
+
+  return (const byte *)view + delta;
+}
+
+void UnmapFileRegion(const void *data, uint64_t length)
+{
+  if(data == NULL)
+    return;
+
+  SYSTEM_INFO info = {};
+  GetSystemInfo(&info);
+  uintptr_t base = uintptr_t(data) & ~uintptr_t(info.dwAllocationGranularity - 1);
+
+  UnmapViewOfFile((void *)base);
+}
+
 bool fflush(FILE *f)
 {
   return ::fflush(f) == 0;
@@ -151,6 +151,50 @@ void RWLock::ReadUnlock()
   ReleaseSRWLockShared(&m_Data);
 }
 
+Mutex::MutexTemplate()
+{
+  InitializeSRWLock(&m_Data);
+}
+
+Mutex::~MutexTemplate()
+{
+}
+
+void Mutex::Lock()
+{
+  AcquireSRWLockExclusive(&m_Data);
+}
+
+bool Mutex::Trylock()
+{
+  return TryAcquireSRWLockExclusive(&m_Data) != FALSE;
+}
+
+void Mutex::Unlock()
+{
+  ReleaseSRWLockExclusive(&m_Data);
+}
+
+Semaphore::SemaphoreTemplate(uint32_t initialCount)
+{
+  m_Data = CreateSemaphore(NULL, (LONG)initialCount, LONG_MAX, NULL);
+}
+
+Semaphore::~SemaphoreTemplate()
+{
+  CloseHandle(m_Data);
+}
+
+void Semaphore::Wait()
+{
+  WaitForSingleObject(m_Data, INFINITE);
+}
+
+void Semaphore::Signal()
+{
+  ReleaseSemaphore(m_Data, 1, NULL);
+}
+
 struct ThreadInitData
 {
   std::function<void()> entryFunc;
@@ -181,6 +225,7 @@ struct TLSData
 
 static CriticalSection *m_TLSListLock = NULL;
 static rdcarray<TLSData *> *m_TLSList = NULL;
+static rdcarray<uint64_t> *m_FreeTLSSlots = NULL;
 
 void Init()
 {
@@ -190,6 +235,7 @@ void Init()
 
   m_TLSListLock = new CriticalSection();
   m_TLSList = new rdcarray<TLSData *>();
+  m_FreeTLSSlots = new rdcarray<uint64_t>();
 }
 
 void Shutdown()
@@ -201,8 +247,14 @@ void Shutdown()
   }
 
   delete m_TLSList;
+  delete m_FreeTLSSlots;
   delete m_TLSListLock;
 
+  // anything destroyed after this can't free its slot
+  m_TLSList = NULL;
+  m_FreeTLSSlots = NULL;
+  m_TLSListLock = NULL;
+
   TlsFree(OSTLSHandle);
 }
 
@@ -211,9 +263,40 @@ void Shutdown()
 // value
 uint64_t AllocateTLSSlot()
 {
+  // reuse a freed slot if there is one, so that objects which each take a slot for their lifetime
+  // don't grow every thread's vector forever. Slots allocated before Init() are never freed.
+  if(m_TLSListLock)
+  {
+    m_TLSListLock->Lock();
+    uint64_t ret = 0;
+    if(!m_FreeTLSSlots->empty())
+    {
+      ret = m_FreeTLSSlots->back();
+      m_FreeTLSSlots->pop_back();
+    }
+    m_TLSListLock->Unlock();
+
+    if(ret != 0)
+      return ret;
+  }
+
   return Atomic::Inc64(&nextTLSSlot);
 }
 
+void FreeTLSSlot(uint64_t slot)
+{
+  if(slot == 0 || m_TLSListLock == NULL)
+    return;
+
+  // clear the slot on every thread, so whoever allocates it next doesn't see our stale values
+  m_TLSListLock->Lock();
+  for(TLSData *slots : *m_TLSList)
+    if(slot - 1 < slots->data.size())
+      slots->data[(size_t)slot - 1] = NULL;
+  m_FreeTLSSlots->push_back(slot);
+  m_TLSListLock->Unlock();
+}
+
 // look up our per-thread vector.
 void *GetTLSValue(uint64_t slot)
 {
@@ -245,8 +328,13 @@ void SetTLSValue(uint64_t slot, void *value)
       m_TLSListLock->Unlock();
     }
 
+    // resizing takes the lock so that FreeTLSSlot never clears a slot in a vector being moved
     if(slot - 1 >= slots->data.size())
-    slots->data.resize((size_t)slot);
+    {
+      m_TLSListLock->Lock();
+      slots->data.resize((size_t)slot);
+      m_TLSListLock->Unlock();
+    }
   }
 
   slots->data[(size_t)slot - 1] = value;
@@ -355,4 +443,11 @@ void Sleep(uint32_t milliseconds)
 {
   ::Sleep((DWORD)milliseconds);
 }
+
+uint32_t NumberOfCores()
+{
+  SYSTEM_INFO info = {};
+  GetSystemInfo(&info);
+  return info.dwNumberOfProcessors > 0 ? (uint32_t)info.dwNumberOfProcessors : 1;
+}
 };
@@ -215,6 +215,10 @@ static void SetActiveWindow(void *device, void *wndHandle)
 
 static void StartFrameCapture(void *device, void *wndHandle)
 {
+  // if the flight recorder is capturing a frame in the background, drop it so the application's
+  // own capture can begin.
+  RenderDoc::Inst().DiscardFlightRecording(device, wndHandle);
+
   RenderDoc::Inst().StartFrameCapture(device, wndHandle);
 
   if(device == NULL || wndHandle == NULL)
@@ -245,22 +249,22 @@ int RENDERDOC_CC SetCaptureOptionF32(RENDERDOC_CaptureOption opt, float val);
 uint32_t RENDERDOC_CC GetCaptureOptionU32(RENDERDOC_CaptureOption opt);
 float RENDERDOC_CC GetCaptureOptionF32(RENDERDOC_CaptureOption opt);
 
-void RENDERDOC_CC GetAPIVersion_1_4_1(int *major, int *minor, int *patch)
+void RENDERDOC_CC GetAPIVersion_1_5_0(int *major, int *minor, int *patch)
 {
   if(major)
     *major = 1;
   if(minor)
-    *minor = 4;
+    *minor = 5;
   if(patch)
-    *patch = 1;
+    *patch = 0;
 }
 
-RENDERDOC_API_1_4_1 api_1_4_1;
-void Init_1_4_1()
+RENDERDOC_API_1_5_0 api_1_5_0;
+void Init_1_5_0()
 {
-  RENDERDOC_API_1_4_1 &api = api_1_4_1;
+  RENDERDOC_API_1_5_0 &api = api_1_5_0;
 
-  api.GetAPIVersion = &GetAPIVersion_1_4_1;
+  api.GetAPIVersion = &GetAPIVersion_1_5_0;
 
   api.SetCaptureOptionU32 = &SetCaptureOptionU32;
   api.SetCaptureOptionF32 = &SetCaptureOptionF32;
@@ -325,16 +329,17 @@ extern "C" RENDERDOC_API int RENDERDOC_CC RENDERDOC_GetAPI(RENDERDOC_Version ver
     ret = 1;                                                       \
   }
 
-  API_VERSION_HANDLE(1_0_0, 1_4_1);
-  API_VERSION_HANDLE(1_0_1, 1_4_1);
-  API_VERSION_HANDLE(1_0_2, 1_4_1);
-  API_VERSION_HANDLE(1_1_0, 1_4_1);
-  API_VERSION_HANDLE(1_1_1, 1_4_1);
-  API_VERSION_HANDLE(1_1_2, 1_4_1);
-  API_VERSION_HANDLE(1_2_0, 1_4_1);
-  API_VERSION_HANDLE(1_3_0, 1_4_1);
-  API_VERSION_HANDLE(1_4_0, 1_4_1);
-  API_VERSION_HANDLE(1_4_1, 1_4_1);
+  API_VERSION_HANDLE(1_0_0, 1_5_0);
+  API_VERSION_HANDLE(1_0_1, 1_5_0);
+  API_VERSION_HANDLE(1_0_2, 1_5_0);
+  API_VERSION_HANDLE(1_1_0, 1_5_0);
+  API_VERSION_HANDLE(1_1_1, 1_5_0);
+  API_VERSION_HANDLE(1_1_2, 1_5_0);
+  API_VERSION_HANDLE(1_2_0, 1_5_0);
+  API_VERSION_HANDLE(1_3_0, 1_5_0);
+  API_VERSION_HANDLE(1_4_0, 1_5_0);
+  API_VERSION_HANDLE(1_4_1, 1_5_0);
+  API_VERSION_HANDLE(1_5_0, 1_5_0);
 
 #undef API_VERSION_HANDLE
 
@@ -508,21 +508,23 @@ TEST_CASE("Test array type", "[basictypes]")
     CHECK(valueConstructor == 1);
     // for the temporary going out of scope
     CHECK(destructor == 2);
-    // for the temporary being copied into the new element
-    CHECK(copyConstructor == 2);
+    // for the temporary being moved into the new element
+    CHECK(moveConstructor == 1);
 
     // previous value
     CHECK(constructor == 1);
+    CHECK(copyConstructor == 1);
 
     test.reserve(1000);
 
     // single element in test was moved to new backing storage
     CHECK(destructor == 3);
-    CHECK(copyConstructor == 3);
+    CHECK(moveConstructor == 2);
 
     // previous values
     CHECK(valueConstructor == 1);
     CHECK(constructor == 1);
+    CHECK(copyConstructor == 1);
 
     test.resize(50);
 
@@ -532,7 +534,7 @@ TEST_CASE("Test array type", "[basictypes]")
     // previous values
     CHECK(valueConstructor == 1);
     CHECK(destructor == 3);
-    CHECK(copyConstructor == 3);
+    CHECK(moveConstructor == 2);
 
     test.clear();
 
@@ -542,13 +544,14 @@ TEST_CASE("Test array type", "[basictypes]")
     // previous values
     CHECK(constructor == 50);
     CHECK(valueConstructor == 1);
-    CHECK(copyConstructor == 3);
+    CHECK(moveConstructor == 2);
 
-    // still should have had no moves
-    CHECK(moveConstructor == 0);
+    // the only copy was pushing the named value
+    CHECK(copyConstructor == 1);
 
     // reset counters
     constructor = 0;
+    moveConstructor = 0;
     valueConstructor = 0;
     copyConstructor = 0;
     destructor = 0;
@@ -631,6 +634,7 @@ TEST_CASE("Test array type", "[basictypes]")
   SECTION("Inserting from array into itself")
   {
     constructor = 0;
+    moveConstructor = 0;
     valueConstructor = 0;
     copyConstructor = 0;
     destructor = 0;
@@ -670,10 +674,11 @@ TEST_CASE("Test array type", "[basictypes]")
     CHECK(test.capacity() == 100);
     CHECK(test.size() == 6);
 
-    // 5 copies and 5 destructs to shift the array contents up, then another copy for inserting tmp
+    // 5 moves and 5 destructs to shift the array contents up, then a copy for inserting tmp
     CHECK(constructor == 6);
     CHECK(valueConstructor == 0);
-    CHECK(copyConstructor == 5 + 1);
+    CHECK(moveConstructor == 5);
+    CHECK(copyConstructor == 1);
     CHECK(destructor == 5);
 
     CHECK(test[0].value == 999);
@@ -685,11 +690,12 @@ TEST_CASE("Test array type", "[basictypes]")
     CHECK(test.capacity() == 100);
     CHECK(test.size() == 7);
 
-    // on top of the above, another 6 copies & destructs to shift the array contents, 1 copy for
+    // on top of the above, another 6 moves & destructs to shift the array contents, 1 copy for
     // inserting test[0], and a copy&destruct of the temporary copy
     CHECK(constructor == 6);
     CHECK(valueConstructor == 0);
-    CHECK(copyConstructor == (5 + 1) + 6 + 1 + 1);
+    CHECK(moveConstructor == (5) + 6);
+    CHECK(copyConstructor == (1) + 1 + 1);
     CHECK(destructor == (5) + 6 + 1);
 
     CHECK(test[0].value == 999);
@@ -713,17 +719,19 @@ TEST_CASE("Test array type", "[basictypes]")
     // on top of the above:
     // - 7 copies and destructs for the duplication (copies into the new storage, destructs from the
     // old storage)
-    // - 7 copies and destructs for shifting the array contents
+    // - 7 moves and destructs for shifting the array contents
     // - 3 copies for the inserted items
     CHECK(constructor == 6);
     CHECK(valueConstructor == 0);
-    CHECK(copyConstructor == (5 + 1 + 6 + 1 + 1) + 7 + 7 + 3);
+    CHECK(moveConstructor == (5 + 6) + 7);
+    CHECK(copyConstructor == (1 + 1 + 1) + 7 + 3);
     CHECK(destructor == (5 + 6 + 1) + 7 + 7);
   };
 
   SECTION("Inserting from array's unused memory into itself")
   {
     constructor = 0;
+    moveConstructor = 0;
     valueConstructor = 0;
     copyConstructor = 0;
     destructor = 0;
@@ -762,11 +770,12 @@ TEST_CASE("Test array type", "[basictypes]")
     // on top of the above:
     // - 1 copy and destruct for the duplication (copy into the new storage, destruct from
     // the old storage)
-    // - 1 copy and destruct for shifting the array contents
+    // - 1 move and destruct for shifting the array contents
     // - 3 copies for the inserted items
     CHECK(constructor == 5);
     CHECK(valueConstructor == 0);
-    CHECK(copyConstructor == 1 + 1 + 3);
+    CHECK(moveConstructor == 1);
+    CHECK(copyConstructor == 1 + 3);
     CHECK(destructor == 4 + 1 + 1);
   };
 };
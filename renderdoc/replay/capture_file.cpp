@@ -28,6 +28,7 @@
 #include "replay/replay_controller.h"
 #include "serialise/rdcfile.h"
 #include "serialise/serialiser.h"
+#include "serialise/structured_diff.h"
 #include "stb/stb_image.h"
 #include "stb/stb_image_resize.h"
 #include "stb/stb_image_write.h"
@@ -111,6 +112,7 @@ public:
 
   ReplayStatus OpenFile(const char *filename, const char *filetype,
                         RENDERDOC_ProgressCallback progress);
+  ReplayStatus OpenFileHeader(const char *filename);
   ReplayStatus OpenBuffer(const bytebuf &buffer, const char *filetype,
                           RENDERDOC_ProgressCallback progress);
   bool CopyFileTo(const char *filename);
@@ -142,6 +144,14 @@ public:
     return m_StructuredData;
   }
 
+  uint32_t DiffStructuredData(ICaptureFile *other, RENDERDOC_CaptureDiffCallback callback)
+  {
+    if(!other)
+      return 0;
+
+    return ::DiffStructuredData(GetStructuredData(), other->GetStructuredData(), callback);
+  }
+
   void SetStructuredData(const SDFile &file)
   {
     m_StructuredData.version = file.version;
@@ -238,6 +248,15 @@ ReplayStatus CaptureFile::OpenFile(const char *filename, const char *filetype,
   return Init();
 }
 
+ReplayStatus CaptureFile::OpenFileHeader(const char *filename)
+{
+  SAFE_DELETE(m_RDC);
+  m_RDC = new RDCFile;
+  m_RDC->Open(filename, true);
+
+  return Init();
+}
+
 ReplayStatus CaptureFile::OpenBuffer(const bytebuf &buffer, const char *filetype,
                                      RENDERDOC_ProgressCallback progress)
 {
@@ -463,10 +482,11 @@ ReplayStatus CaptureFile::Convert(const char *filename, const char *filetype, co
 
   bool success = true;
 
-  // when we don't have a frame capture section, write it from the structured data.
+  // when we don't have a frame capture section, or we've been given structured data to write
+  // (which may have been modified), write it from the structured data.
   int frameCaptureIndex = m_RDC->SectionIndex(SectionType::FrameCapture);
 
-  if(frameCaptureIndex == -1)
+  if(frameCaptureIndex == -1 || file != NULL)
   {
     if(file == NULL)
     {
@@ -475,7 +495,7 @@ ReplayStatus CaptureFile::Convert(const char *filename, const char *filetype, co
     }
 
     SectionProperties frameCapture;
-    frameCapture.flags = SectionFlags::ZstdCompressed;
+    frameCapture.flags = SectionFlags::ZstdCompressed | SectionFlags::ZstdDictionary;
     frameCapture.type = SectionType::FrameCapture;
     frameCapture.name = ToStr(frameCapture.type);
     frameCapture.version = file->version;
@@ -496,7 +516,7 @@ ReplayStatus CaptureFile::Convert(const char *filename, const char *filetype, co
   {
     // otherwise write it straight, but compress it to zstd
     SectionProperties props = m_RDC->GetSectionProperties(frameCaptureIndex);
-    props.flags = SectionFlags::ZstdCompressed;
+    props.flags = SectionFlags::ZstdCompressed | SectionFlags::ZstdDictionary;
 
     StreamWriter *writer = output.WriteSection(props);
     StreamReader *reader = m_RDC->ReadSection(frameCaptureIndex);
@@ -519,7 +539,8 @@ ReplayStatus CaptureFile::Convert(const char *filename, const char *filetype, co
   {
     const SectionProperties &props = m_RDC->GetSectionProperties(i);
 
-    if(props.type == SectionType::FrameCapture)
+    // the seek table is regenerated along with the frame capture above
+    if(props.type == SectionType::FrameCapture || props.type == SectionType::SeekTable)
       continue;
 
     StreamWriter *writer = output.WriteSection(props);
@@ -815,12 +836,11 @@ rdcarray<rdcstr> CaptureFile::GetResolve(const rdcarray<uint64_t> &callstack)
     return ret;
   }
 
-  ret.reserve(callstack.size());
-  for(uint64_t frame : callstack)
-  {
-    Callstack::AddressDetails info = m_Resolver->GetAddr(frame);
+  rdcarray<Callstack::AddressDetails> details = m_Resolver->GetAddrs(callstack);
+
+  ret.reserve(details.size());
+  for(Callstack::AddressDetails &info : details)
     ret.push_back(info.formattedString());
-  }
 
   return ret;
 }
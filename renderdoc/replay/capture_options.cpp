@@ -50,6 +50,19 @@ int RENDERDOC_CC SetCaptureOptionU32(RENDERDOC_CaptureOption opt, uint32_t val)
       break;
     case eRENDERDOC_Option_CaptureAllCmdLists: opts.captureAllCmdLists = (val != 0); break;
     case eRENDERDOC_Option_DebugOutputMute: opts.debugOutputMute = (val != 0); break;
+    case eRENDERDOC_Option_CaptureQueueFamily: opts.captureQueueFamily = val; break;
+    case eRENDERDOC_Option_CaptureFirstSubmit: opts.captureFirstSubmit = val; break;
+    case eRENDERDOC_Option_CaptureNumSubmits: opts.captureNumSubmits = val; break;
+    case eRENDERDOC_Option_MergeMultiFrameCaptures:
+      opts.mergeMultiFrameCaptures = (val != 0);
+      break;
+    case eRENDERDOC_Option_CaptureMemoryBudgetMB: opts.captureMemoryBudgetMB = val; break;
+    case eRENDERDOC_Option_WatchCoherentMapWrites: opts.watchCoherentMapWrites = (val != 0); break;
+    case eRENDERDOC_Option_DeferDescriptorUpdates: opts.deferDescriptorUpdates = (val != 0); break;
+    case eRENDERDOC_Option_DedupInitialContents: opts.dedupInitialContents = (val != 0); break;
+    case eRENDERDOC_Option_CompactInitialStates: opts.compactInitialStates = (val != 0); break;
+    case eRENDERDOC_Option_AsyncCaptureWrite: opts.asyncCaptureWrite = (val != 0); break;
+    case eRENDERDOC_Option_DeferCreationChunks: opts.deferCreationChunks = (val != 0); break;
     case eRENDERDOC_Option_AllowUnsupportedVendorExtensions:
       if(val == 0x10DE)
         RenderDoc::Inst().EnableVendorExtensions(VendorExtensions::NvAPI);
@@ -85,6 +98,27 @@ int RENDERDOC_CC SetCaptureOptionF32(RENDERDOC_CaptureOption opt, float val)
       break;
     case eRENDERDOC_Option_CaptureAllCmdLists: opts.captureAllCmdLists = (val != 0.0f); break;
     case eRENDERDOC_Option_DebugOutputMute: opts.debugOutputMute = (val != 0.0f); break;
+    case eRENDERDOC_Option_CaptureQueueFamily:
+      opts.captureQueueFamily = val < 0.0f ? ~0U : (uint32_t)val;
+      break;
+    case eRENDERDOC_Option_CaptureFirstSubmit: opts.captureFirstSubmit = (uint32_t)val; break;
+    case eRENDERDOC_Option_CaptureNumSubmits: opts.captureNumSubmits = (uint32_t)val; break;
+    case eRENDERDOC_Option_MergeMultiFrameCaptures:
+      opts.mergeMultiFrameCaptures = (val != 0.0f);
+      break;
+    case eRENDERDOC_Option_CaptureMemoryBudgetMB:
+      opts.captureMemoryBudgetMB = val < 0.0f ? 0 : (uint32_t)val;
+      break;
+    case eRENDERDOC_Option_WatchCoherentMapWrites:
+      opts.watchCoherentMapWrites = (val != 0.0f);
+      break;
+    case eRENDERDOC_Option_DeferDescriptorUpdates:
+      opts.deferDescriptorUpdates = (val != 0.0f);
+      break;
+    case eRENDERDOC_Option_DedupInitialContents: opts.dedupInitialContents = (val != 0.0f); break;
+    case eRENDERDOC_Option_CompactInitialStates: opts.compactInitialStates = (val != 0.0f); break;
+    case eRENDERDOC_Option_AsyncCaptureWrite: opts.asyncCaptureWrite = (val != 0.0f); break;
+    case eRENDERDOC_Option_DeferCreationChunks: opts.deferCreationChunks = (val != 0.0f); break;
     case eRENDERDOC_Option_AllowUnsupportedVendorExtensions:
       RDCWARN("AllowUnsupportedVendorExtensions unexpected parameter %f", val);
       break;
@@ -124,6 +158,28 @@ uint32_t RENDERDOC_CC GetCaptureOptionU32(RENDERDOC_CaptureOption opt)
       return (RenderDoc::Inst().GetCaptureOptions().captureAllCmdLists ? 1 : 0);
     case eRENDERDOC_Option_DebugOutputMute:
       return (RenderDoc::Inst().GetCaptureOptions().debugOutputMute ? 1 : 0);
+    case eRENDERDOC_Option_CaptureQueueFamily:
+      return (RenderDoc::Inst().GetCaptureOptions().captureQueueFamily);
+    case eRENDERDOC_Option_CaptureFirstSubmit:
+      return (RenderDoc::Inst().GetCaptureOptions().captureFirstSubmit);
+    case eRENDERDOC_Option_CaptureNumSubmits:
+      return (RenderDoc::Inst().GetCaptureOptions().captureNumSubmits);
+    case eRENDERDOC_Option_MergeMultiFrameCaptures:
+      return (RenderDoc::Inst().GetCaptureOptions().mergeMultiFrameCaptures ? 1 : 0);
+    case eRENDERDOC_Option_CaptureMemoryBudgetMB:
+      return (RenderDoc::Inst().GetCaptureOptions().captureMemoryBudgetMB);
+    case eRENDERDOC_Option_WatchCoherentMapWrites:
+      return (RenderDoc::Inst().GetCaptureOptions().watchCoherentMapWrites ? 1 : 0);
+    case eRENDERDOC_Option_DeferDescriptorUpdates:
+      return (RenderDoc::Inst().GetCaptureOptions().deferDescriptorUpdates ? 1 : 0);
+    case eRENDERDOC_Option_DedupInitialContents:
+      return (RenderDoc::Inst().GetCaptureOptions().dedupInitialContents ? 1 : 0);
+    case eRENDERDOC_Option_CompactInitialStates:
+      return (RenderDoc::Inst().GetCaptureOptions().compactInitialStates ? 1 : 0);
+    case eRENDERDOC_Option_AsyncCaptureWrite:
+      return (RenderDoc::Inst().GetCaptureOptions().asyncCaptureWrite ? 1 : 0);
+    case eRENDERDOC_Option_DeferCreationChunks:
+      return (RenderDoc::Inst().GetCaptureOptions().deferCreationChunks ? 1 : 0);
     case eRENDERDOC_Option_AllowUnsupportedVendorExtensions: return 0;
     default: break;
   }
@@ -161,6 +217,31 @@ float RENDERDOC_CC GetCaptureOptionF32(RENDERDOC_CaptureOption opt)
       return (RenderDoc::Inst().GetCaptureOptions().captureAllCmdLists ? 1.0f : 0.0f);
     case eRENDERDOC_Option_DebugOutputMute:
       return (RenderDoc::Inst().GetCaptureOptions().debugOutputMute ? 1.0f : 0.0f);
+    case eRENDERDOC_Option_CaptureQueueFamily:
+    {
+      uint32_t family = RenderDoc::Inst().GetCaptureOptions().captureQueueFamily;
+      return family == ~0U ? -1.0f : family * 1.0f;
+    }
+    case eRENDERDOC_Option_CaptureFirstSubmit:
+      return (RenderDoc::Inst().GetCaptureOptions().captureFirstSubmit * 1.0f);
+    case eRENDERDOC_Option_CaptureNumSubmits:
+      return (RenderDoc::Inst().GetCaptureOptions().captureNumSubmits * 1.0f);
+    case eRENDERDOC_Option_MergeMultiFrameCaptures:
+      return (RenderDoc::Inst().GetCaptureOptions().mergeMultiFrameCaptures ? 1.0f : 0.0f);
+    case eRENDERDOC_Option_CaptureMemoryBudgetMB:
+      return (RenderDoc::Inst().GetCaptureOptions().captureMemoryBudgetMB * 1.0f);
+    case eRENDERDOC_Option_WatchCoherentMapWrites:
+      return (RenderDoc::Inst().GetCaptureOptions().watchCoherentMapWrites ? 1.0f : 0.0f);
+    case eRENDERDOC_Option_DeferDescriptorUpdates:
+      return (RenderDoc::Inst().GetCaptureOptions().deferDescriptorUpdates ? 1.0f : 0.0f);
+    case eRENDERDOC_Option_DedupInitialContents:
+      return (RenderDoc::Inst().GetCaptureOptions().dedupInitialContents ? 1.0f : 0.0f);
+    case eRENDERDOC_Option_CompactInitialStates:
+      return (RenderDoc::Inst().GetCaptureOptions().compactInitialStates ? 1.0f : 0.0f);
+    case eRENDERDOC_Option_AsyncCaptureWrite:
+      return (RenderDoc::Inst().GetCaptureOptions().asyncCaptureWrite ? 1.0f : 0.0f);
+    case eRENDERDOC_Option_DeferCreationChunks:
+      return (RenderDoc::Inst().GetCaptureOptions().deferCreationChunks ? 1.0f : 0.0f);
     case eRENDERDOC_Option_AllowUnsupportedVendorExtensions: return 0.0f;
     default: break;
   }
@@ -184,4 +265,17 @@ CaptureOptions::CaptureOptions()
   refAllResources = false;
   captureAllCmdLists = false;
   debugOutputMute = true;
+  flightRecorderFrames = 0;
+  flightRecorderMemoryMB = 512;
+  captureQueueFamily = ~0U;
+  captureFirstSubmit = 0;
+  captureNumSubmits = 0;
+  mergeMultiFrameCaptures = false;
+  captureMemoryBudgetMB = 0;
+  watchCoherentMapWrites = false;
+  deferDescriptorUpdates = false;
+  dedupInitialContents = false;
+  compactInitialStates = false;
+  asyncCaptureWrite = false;
+  deferCreationChunks = false;
 }
@@ -270,6 +270,16 @@ extern "C" RENDERDOC_API void RENDERDOC_CC RENDERDOC_GetLogFileContents(rdcstr &
   logfile = FileIO::logfile_readall(RDCGETLOGFILE());
 }
 
+extern "C" RENDERDOC_API void RENDERDOC_CC RENDERDOC_SetSelfProfiling(bool enabled)
+{
+  Profiler::SetEnabled(enabled);
+}
+
+extern "C" RENDERDOC_API bool RENDERDOC_CC RENDERDOC_WriteSelfProfileTrace(const char *filename)
+{
+  return Profiler::WriteChromeTrace(filename);
+}
+
 extern "C" RENDERDOC_API void RENDERDOC_CC RENDERDOC_InitialiseReplay(GlobalEnvironment env,
                                                                       const rdcarray<rdcstr> &args)
 {
@@ -509,8 +519,11 @@ RENDERDOC_BecomeRemoteServer(const char *listenhost, RENDERDOC_KillCallback kill
       return ret;
     };
 
-  RenderDoc::Inst().BecomeRemoteServer(listenhost, RenderDoc_RemoteServerPort, killReplay,
-                                       previewWindow);
+  rdcstr host = listenhost;
+  uint16_t port = RenderDoc_RemoteServerPort;
+  Network::SplitHostPort(host, port);
+
+  RenderDoc::Inst().BecomeRemoteServer(host.c_str(), port, killReplay, previewWindow);
 }
 
 extern "C" RENDERDOC_API void RENDERDOC_CC RENDERDOC_StartSelfHostCapture(const char *dllname)
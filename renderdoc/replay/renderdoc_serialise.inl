@@ -73,6 +73,30 @@ void DoSerialise(SerialiserType &ser, PathEntry &el)
   SIZE_CHECK(40);
 }
 
+template <class SerialiserType>
+void DoSerialise(SerialiserType &ser, Thumbnail &el)
+{
+  SERIALISE_MEMBER(type);
+  SERIALISE_MEMBER(data);
+  SERIALISE_MEMBER(width);
+  SERIALISE_MEMBER(height);
+
+  SIZE_CHECK(40);
+}
+
+template <class SerialiserType>
+void DoSerialise(SerialiserType &ser, CaptureSummary &el)
+{
+  SERIALISE_MEMBER(path);
+  SERIALISE_MEMBER(status);
+  SERIALISE_MEMBER(driverName);
+  SERIALISE_MEMBER(machineIdent);
+  SERIALISE_MEMBER(fileSize);
+  SERIALISE_MEMBER(thumbnail);
+
+  SIZE_CHECK(128);
+}
+
 template <class SerialiserType>
 void DoSerialise(SerialiserType &ser, SectionProperties &el)
 {
@@ -111,8 +135,21 @@ void DoSerialise(SerialiserType &ser, CaptureOptions &el)
   SERIALISE_MEMBER(refAllResources);
   SERIALISE_MEMBER(captureAllCmdLists);
   SERIALISE_MEMBER(debugOutputMute);
+  SERIALISE_MEMBER(flightRecorderFrames);
+  SERIALISE_MEMBER(flightRecorderMemoryMB);
+  SERIALISE_MEMBER(captureQueueFamily);
+  SERIALISE_MEMBER(captureFirstSubmit);
+  SERIALISE_MEMBER(captureNumSubmits);
+  SERIALISE_MEMBER(mergeMultiFrameCaptures);
+  SERIALISE_MEMBER(captureMemoryBudgetMB);
+  SERIALISE_MEMBER(watchCoherentMapWrites);
+  SERIALISE_MEMBER(deferDescriptorUpdates);
+  SERIALISE_MEMBER(dedupInitialContents);
+  SERIALISE_MEMBER(compactInitialStates);
+  SERIALISE_MEMBER(asyncCaptureWrite);
+  SERIALISE_MEMBER(deferCreationChunks);
 
-  SIZE_CHECK(20);
+  SIZE_CHECK(56);
 }
 
 template <typename SerialiserType>
@@ -398,6 +435,17 @@ void DoSerialise(SerialiserType &ser, ShaderDebugState &el)
   SIZE_CHECK(88);
 }
 
+template <typename SerialiserType>
+void DoSerialise(SerialiserType &ser, ShaderDebugRunParameters &el)
+{
+  SERIALISE_MEMBER(breakpoints);
+  SERIALISE_MEMBER(watchVariables);
+  SERIALISE_MEMBER(stopOnEvents);
+  SERIALISE_MEMBER(keyframeInterval);
+
+  SIZE_CHECK(56);
+}
+
 template <typename SerialiserType>
 void DoSerialise(SerialiserType &ser, ShaderDebugTrace &el)
 {
@@ -750,6 +798,19 @@ void DoSerialise(SerialiserType &ser, FrameStatistics &el)
   SIZE_CHECK(1432);
 }
 
+template <typename SerialiserType>
+void DoSerialise(SerialiserType &ser, ChunkLoadStatistics &el)
+{
+  SERIALISE_MEMBER(name);
+  SERIALISE_MEMBER(chunkID);
+  SERIALISE_MEMBER(count);
+  SERIALISE_MEMBER(byteSize);
+  SERIALISE_MEMBER(cpuTime);
+  SERIALISE_MEMBER(gpuWaitTime);
+
+  SIZE_CHECK(56);
+}
+
 template <typename SerialiserType>
 void DoSerialise(SerialiserType &ser, FrameDescription &el)
 {
@@ -762,8 +823,9 @@ void DoSerialise(SerialiserType &ser, FrameDescription &el)
   SERIALISE_MEMBER(captureTime);
   SERIALISE_MEMBER(stats);
   SERIALISE_MEMBER(debugMessages);
+  SERIALISE_MEMBER(loadStatistics);
 
-  SIZE_CHECK(1512);
+  SIZE_CHECK(1536);
 }
 
 template <typename SerialiserType>
@@ -772,7 +834,7 @@ void DoSerialise(SerialiserType &ser, FrameRecord &el)
   SERIALISE_MEMBER(frameInfo);
   SERIALISE_MEMBER(drawcallList);
 
-  SIZE_CHECK(1536);
+  SIZE_CHECK(1560);
 }
 
 template <typename SerialiserType>
@@ -889,6 +951,27 @@ void DoSerialise(SerialiserType &ser, PixelModification &el)
   SIZE_CHECK(100);
 }
 
+template <typename SerialiserType>
+void DoSerialise(SerialiserType &ser, PixelHistoryResult &el)
+{
+  SERIALISE_MEMBER(x);
+  SERIALISE_MEMBER(y);
+  SERIALISE_MEMBER(modifications);
+
+  SIZE_CHECK(32);
+}
+
+template <typename SerialiserType>
+void DoSerialise(SerialiserType &ser, OverdrawStatistics &el)
+{
+  SERIALISE_MEMBER(eventId);
+  SERIALISE_MEMBER(shadedPixels);
+  SERIALISE_MEMBER(helperLanes);
+  SERIALISE_MEMBER(quads);
+
+  SIZE_CHECK(16);
+}
+
 template <typename SerialiserType>
 void DoSerialise(SerialiserType &ser, EventUsage &el)
 {
@@ -909,6 +992,51 @@ void DoSerialise(SerialiserType &ser, CounterResult &el)
   SIZE_CHECK(16);
 }
 
+template <typename SerialiserType>
+void DoSerialise(SerialiserType &ser, EventTiming &el)
+{
+  SERIALISE_MEMBER(eventId);
+  SERIALISE_MEMBER(median);
+  SERIALISE_MEMBER(mean);
+  SERIALISE_MEMBER(variance);
+  SERIALISE_MEMBER(minimum);
+  SERIALISE_MEMBER(maximum);
+  SERIALISE_MEMBER(samples);
+
+  SIZE_CHECK(56);
+}
+
+template <typename SerialiserType>
+void DoSerialise(SerialiserType &ser, MarkerRegionTiming &el)
+{
+  SERIALISE_MEMBER(eventId);
+  SERIALISE_MEMBER(name);
+  SERIALISE_MEMBER(depth);
+  SERIALISE_MEMBER(gpuDurations);
+
+  SIZE_CHECK(64);
+}
+
+template <typename SerialiserType>
+void DoSerialise(SerialiserType &ser, ReplayLoopMeasurement &el)
+{
+  SERIALISE_MEMBER(cpuTimes);
+  SERIALISE_MEMBER(gpuTimes);
+  SERIALISE_MEMBER(regions);
+
+  SIZE_CHECK(72);
+}
+
+template <typename SerialiserType>
+void DoSerialise(SerialiserType &ser, MemoryUsage &el)
+{
+  SERIALISE_MEMBER(category);
+  SERIALISE_MEMBER(cpuBytes);
+  SERIALISE_MEMBER(gpuBytes);
+
+  SIZE_CHECK(24);
+}
+
 template <typename SerialiserType>
 void DoSerialise(SerialiserType &ser, CounterValue &el)
 {
@@ -937,8 +1065,12 @@ void DoSerialise(SerialiserType &ser, ReplayOptions &el)
   SERIALISE_MEMBER(forceGPUDeviceID);
   SERIALISE_MEMBER(forceGPUDriverName);
   SERIALISE_MEMBER(optimisation);
+  SERIALISE_MEMBER(concurrentQueues);
+  SERIALISE_MEMBER(replayCheckpointInterval);
+  SERIALISE_MEMBER(replayCheckpointBudgetMB);
+  SERIALISE_MEMBER(rerecordCacheMB);
 
-  SIZE_CHECK(48);
+  SIZE_CHECK(64);
 }
 
 #pragma region Common pipeline state
@@ -2254,6 +2386,8 @@ void DoSerialise(SerialiserType &ser, VKPipe::State &el)
 
 INSTANTIATE_SERIALISE_TYPE(ExecuteResult)
 INSTANTIATE_SERIALISE_TYPE(PathEntry)
+INSTANTIATE_SERIALISE_TYPE(Thumbnail)
+INSTANTIATE_SERIALISE_TYPE(CaptureSummary)
 INSTANTIATE_SERIALISE_TYPE(SectionProperties)
 INSTANTIATE_SERIALISE_TYPE(EnvironmentModification)
 INSTANTIATE_SERIALISE_TYPE(CaptureOptions)
@@ -2273,6 +2407,7 @@ INSTANTIATE_SERIALISE_TYPE(ShaderReflection)
 INSTANTIATE_SERIALISE_TYPE(ShaderVariable)
 INSTANTIATE_SERIALISE_TYPE(SourceVariableMapping);
 INSTANTIATE_SERIALISE_TYPE(ShaderDebugState)
+INSTANTIATE_SERIALISE_TYPE(ShaderDebugRunParameters)
 INSTANTIATE_SERIALISE_TYPE(ShaderDebugTrace)
 INSTANTIATE_SERIALISE_TYPE(ResourceDescription)
 INSTANTIATE_SERIALISE_TYPE(TextureDescription)
@@ -2297,6 +2432,7 @@ INSTANTIATE_SERIALISE_TYPE(DepthStencilStats)
 INSTANTIATE_SERIALISE_TYPE(RasterizationStats)
 INSTANTIATE_SERIALISE_TYPE(OutputTargetStats)
 INSTANTIATE_SERIALISE_TYPE(FrameStatistics)
+INSTANTIATE_SERIALISE_TYPE(ChunkLoadStatistics)
 INSTANTIATE_SERIALISE_TYPE(FrameDescription)
 INSTANTIATE_SERIALISE_TYPE(FrameRecord)
 INSTANTIATE_SERIALISE_TYPE(MeshFormat)
@@ -2306,8 +2442,14 @@ INSTANTIATE_SERIALISE_TYPE(CounterDescription)
 INSTANTIATE_SERIALISE_TYPE(PixelValue)
 INSTANTIATE_SERIALISE_TYPE(Subresource)
 INSTANTIATE_SERIALISE_TYPE(PixelModification)
+INSTANTIATE_SERIALISE_TYPE(PixelHistoryResult)
+INSTANTIATE_SERIALISE_TYPE(OverdrawStatistics)
 INSTANTIATE_SERIALISE_TYPE(EventUsage)
 INSTANTIATE_SERIALISE_TYPE(CounterResult)
+INSTANTIATE_SERIALISE_TYPE(EventTiming)
+INSTANTIATE_SERIALISE_TYPE(MarkerRegionTiming)
+INSTANTIATE_SERIALISE_TYPE(ReplayLoopMeasurement)
+INSTANTIATE_SERIALISE_TYPE(MemoryUsage)
 INSTANTIATE_SERIALISE_TYPE(CounterValue)
 INSTANTIATE_SERIALISE_TYPE(GPUDevice)
 INSTANTIATE_SERIALISE_TYPE(ReplayOptions)
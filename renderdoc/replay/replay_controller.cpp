@@ -27,6 +27,7 @@
 #include <string.h>
 #include <time.h>
 #include "common/dds_readwrite.h"
+#include "common/threading.h"
 #include "driver/ihv/amd/amd_isa.h"
 #include "driver/ihv/amd/amd_rgp.h"
 #include "jpeg-compressor/jpgd.h"
@@ -96,6 +97,11 @@ void ReplayController::SetFrameEvent(uint32_t eventId, bool force)
   {
     m_EventID = eventId;
 
+    m_MinMaxCache.clear();
+    m_HistogramCache.clear();
+
+    ApplyMemoryBudgets();
+
     m_pDevice->ReplayLog(eventId, eReplay_WithoutDraw);
 
     for(size_t i = 0; i < m_Outputs.size(); i++)
@@ -104,7 +110,130 @@ void ReplayController::SetFrameEvent(uint32_t eventId, bool force)
     m_pDevice->ReplayLog(eventId, eReplay_OnlyDraw);
 
     FetchPipelineState(eventId);
+
+    DrawcallDescription *draw = GetDrawcallByEID(eventId);
+    if(draw)
+    {
+      rdcarray<uint32_t> chunks;
+      for(const APIEvent &ev : draw->events)
+        chunks.push_back(ev.chunkIndex);
+      m_pDevice->FetchStructuredChunks(chunks);
+    }
+  }
+}
+
+static void AddUniqueResources(rdcarray<ResourceId> &ids,
+                               const rdcarray<BoundResourceArray> &bindings)
+{
+  for(const BoundResourceArray &arr : bindings)
+  {
+    for(const BoundResource &res : arr.resources)
+    {
+      if(res.resourceId != ResourceId() && !ids.contains(res.resourceId))
+        ids.push_back(res.resourceId);
+    }
+  }
+}
+
+rdcarray<EventVisitResult> ReplayController::VisitEvents(
+    const rdcarray<uint32_t> &eventIds, EventVisitData data,
+    const rdcarray<EventVisitBufferRange> &buffers)
+{
+  CHECK_REPLAY_THREAD();
+
+  rdcarray<EventVisitResult> ret;
+  ret.resize(eventIds.size());
+
+  if(eventIds.empty())
+    return ret;
+
+  // visit in ascending order so each replay can carry on from the previous event where the driver
+  // is able to, rather than starting again from the beginning of the frame.
+  rdcarray<rdcpair<uint32_t, size_t>> order;
+  order.reserve(eventIds.size());
+  for(size_t i = 0; i < eventIds.size(); i++)
+    order.push_back({eventIds[i], i});
+  std::sort(order.begin(), order.end());
+
+  const bool needState = bool(data & (EventVisitData::Shaders | EventVisitData::BoundResources));
+
+  uint32_t replayedEvent = 0;
+
+  for(const rdcpair<uint32_t, size_t> &o : order)
+  {
+    const uint32_t eventId = o.first;
+    EventVisitResult &res = ret[o.second];
+
+    res.eventId = eventId;
+
+    // duplicate events only need to be replayed once
+    if(replayedEvent != eventId)
+    {
+      m_pDevice->ReplayLog(eventId, eReplay_WithoutDraw);
+      m_pDevice->ReplayLog(eventId, eReplay_OnlyDraw);
+      replayedEvent = eventId;
+
+      if(needState)
+        FetchPipelineState(eventId);
+    }
+
+    if(data & EventVisitData::Drawcall)
+    {
+      const DrawcallDescription *draw = GetDrawcallByEID(eventId);
+      if(draw && draw->eventId == eventId)
+      {
+        res.flags = draw->flags;
+        res.numIndices = draw->numIndices;
+        res.numInstances = draw->numInstances;
+        res.baseVertex = draw->baseVertex;
+        res.indexOffset = draw->indexOffset;
+        res.vertexOffset = draw->vertexOffset;
+        res.instanceOffset = draw->instanceOffset;
+        for(int i = 0; i < 3; i++)
+          res.dispatchDimension[i] = draw->dispatchDimension[i];
+      }
+    }
+
+    if(data & EventVisitData::Shaders)
+    {
+      res.shaders.resize((size_t)ShaderStage::Count);
+      for(uint32_t stage = 0; stage < (uint32_t)ShaderStage::Count; stage++)
+        res.shaders[stage] = m_PipeState.GetShader(StageFromIndex(stage));
+    }
+
+    if(data & EventVisitData::BoundResources)
+    {
+      for(uint32_t stage = 0; stage < (uint32_t)ShaderStage::Count; stage++)
+      {
+        if(m_PipeState.GetShader(StageFromIndex(stage)) == ResourceId())
+          continue;
+
+        AddUniqueResources(res.readOnlyResources,
+                           m_PipeState.GetReadOnlyResources(StageFromIndex(stage)));
+        AddUniqueResources(res.readWriteResources,
+                           m_PipeState.GetReadWriteResources(StageFromIndex(stage)));
+      }
+
+      for(const BoundVBuffer &vb : m_PipeState.GetVBuffers())
+        res.vertexBuffers.push_back(vb.resourceId);
+      res.indexBuffer = m_PipeState.GetIBuffer().resourceId;
+
+      for(const BoundResource &rt : m_PipeState.GetOutputTargets())
+        res.outputTargets.push_back(rt.resourceId);
+      res.depthTarget = m_PipeState.GetDepthTarget().resourceId;
+    }
+
+    for(const EventVisitBufferRange &range : buffers)
+    {
+      res.bufferDataOffsets.push_back(res.bufferData.size());
+      res.bufferData.append(GetBufferData(range.resourceId, range.byteOffset, range.byteSize));
+    }
   }
+
+  // put the replay and pipeline state back at the current event
+  SetFrameEvent(m_EventID, true);
+
+  return ret;
 }
 
 const D3D11Pipe::State *ReplayController::GetD3D11PipelineState()
@@ -189,6 +318,13 @@ const SDFile &ReplayController::GetStructuredFile()
   return m_pDevice->GetStructuredFile();
 }
 
+void ReplayController::FetchStructuredChunks(const rdcarray<uint32_t> &chunkIndices)
+{
+  CHECK_REPLAY_THREAD();
+
+  m_pDevice->FetchStructuredChunks(chunkIndices);
+}
+
 DrawcallDescription *ReplayController::GetDrawcallByEID(uint32_t eventId)
 {
   CHECK_REPLAY_THREAD();
@@ -421,6 +557,65 @@ rdcarray<CounterResult> ReplayController::FetchCounters(const rdcarray<GPUCounte
   return m_pDevice->FetchCounters(counters);
 }
 
+rdcarray<EventTiming> ReplayController::FetchEventTimings(uint32_t repeats)
+{
+  CHECK_REPLAY_THREAD();
+
+  repeats = RDCMAX(1U, repeats);
+
+  // only request the duration, so the drivers don't set up any other queries that would perturb
+  // the timings
+  std::map<uint32_t, rdcarray<double>> durations;
+
+  for(uint32_t r = 0; r < repeats; r++)
+  {
+    rdcarray<CounterResult> results = m_pDevice->FetchCounters({GPUCounter::EventGPUDuration});
+
+    for(const CounterResult &res : results)
+    {
+      // drivers return a negative duration when the query failed
+      if(res.counter == GPUCounter::EventGPUDuration && res.value.d >= 0.0)
+        durations[res.eventId].push_back(res.value.d);
+    }
+  }
+
+  rdcarray<EventTiming> ret;
+  ret.reserve(durations.size());
+
+  for(auto it = durations.begin(); it != durations.end(); ++it)
+  {
+    rdcarray<double> &times = it->second;
+    std::sort(times.begin(), times.end());
+
+    const size_t count = times.size();
+
+    EventTiming timing;
+    timing.eventId = it->first;
+    timing.samples = (uint32_t)count;
+    timing.minimum = times[0];
+    timing.maximum = times[count - 1];
+
+    if(count % 2 == 1)
+      timing.median = times[count / 2];
+    else
+      timing.median = (times[count / 2 - 1] + times[count / 2]) * 0.5;
+
+    double sum = 0.0;
+    for(double t : times)
+      sum += t;
+    timing.mean = sum / double(count);
+
+    double sqsum = 0.0;
+    for(double t : times)
+      sqsum += (t - timing.mean) * (t - timing.mean);
+    timing.variance = sqsum / double(count);
+
+    ret.push_back(timing);
+  }
+
+  return ret;
+}
+
 rdcarray<GPUCounter> ReplayController::EnumerateCounters()
 {
   CHECK_REPLAY_THREAD();
@@ -548,11 +743,12 @@ bytebuf ReplayController::GetTextureData(ResourceId tex, const Subresource &sub)
   return ret;
 }
 
-bool ReplayController::SaveTexture(const TextureSave &saveData, const char *path)
+bool ReplayController::FetchTextureSaveData(const TextureSave &saveData, TextureSaveData &save)
 {
   CHECK_REPLAY_THREAD();
 
-  TextureSave sd = saveData;    // mutable copy
+  TextureSave &sd = save.sd;
+  sd = saveData;    // mutable copy
   ResourceId liveid = m_pDevice->GetLiveID(sd.resourceId);
 
   if(liveid == ResourceId())
@@ -561,9 +757,8 @@ bool ReplayController::SaveTexture(const TextureSave &saveData, const char *path
     return false;
   }
 
-  TextureDescription td = m_pDevice->GetTexture(liveid);
-
-  bool success = false;
+  TextureDescription &td = save.td;
+  td = m_pDevice->GetTexture(liveid);
 
   // clamp sample/mip/slice indices
   if(td.msSamp == 1)
@@ -714,7 +909,7 @@ bool ReplayController::SaveTexture(const TextureSave &saveData, const char *path
     // otherwise take all mips, as by default
   }
 
-  rdcarray<byte *> subdata;
+  rdcarray<byte *> &subdata = save.subdata;
 
   bool downcast = false;
 
@@ -864,6 +1059,7 @@ bool ReplayController::SaveTexture(const TextureSave &saveData, const char *path
 
         for(size_t i = 0; i < subdata.size(); i++)
           delete[] subdata[i];
+        subdata.clear();
 
         return false;
       }
@@ -923,6 +1119,27 @@ bool ReplayController::SaveTexture(const TextureSave &saveData, const char *path
     }
   }
 
+  save.rowPitch = rowPitch;
+  save.numMips = numMips;
+  save.numSlices = numSlices;
+  save.singleSlice = singleSlice;
+
+  return true;
+}
+
+bool ReplayController::EncodeTextureSaveData(TextureSaveData &save, const char *path)
+{
+  TextureSave &sd = save.sd;
+  TextureDescription &td = save.td;
+  rdcarray<byte *> &subdata = save.subdata;
+
+  uint32_t rowPitch = save.rowPitch;
+  uint32_t numMips = save.numMips;
+  uint32_t numSlices = save.numSlices;
+  bool singleSlice = save.singleSlice;
+
+  bool success = false;
+
   // should have been handled above, but verify incoming data is RGBA8 or RGBA32
   if(sd.slice.slicesAsGrid && (td.format.compByteWidth == 1 || td.format.compByteWidth == 4) &&
      td.format.compCount == 4 && !td.format.Special())
@@ -1273,8 +1490,22 @@ bool ReplayController::SaveTexture(const TextureSave &saveData, const char *path
       if(saveFmt.compType == CompType::Depth && pixStride == 3)
         pixStride = 4;
 
+      // regular tightly packed formats are converted a row at a time
+      const bool batchConvert = saveFmt.type == ResourceFormatType::Regular &&
+                                pixStride == saveFmt.compCount * saveFmt.compByteWidth;
+
+      rdcarray<float> rowData;
+      if(batchConvert)
+        rowData.resize(td.width * saveFmt.compCount);
+
       for(uint32_t y = 0; y < td.height; y++)
       {
+        if(batchConvert)
+        {
+          ConvertComponents(saveFmt, srcData, rowData.size(), rowData.data());
+          srcData += pixStride * td.width;
+        }
+
         for(uint32_t x = 0; x < td.width; x++)
         {
           float r = 0.0f;
@@ -1308,6 +1539,19 @@ bool ReplayController::SaveTexture(const TextureSave &saveData, const char *path
 
             srcData += 4;
           }
+          else if(batchConvert)
+          {
+            const float *comps = rowData.data() + x * saveFmt.compCount;
+
+            if(saveFmt.compCount >= 1)
+              r = comps[0];
+            if(saveFmt.compCount >= 2)
+              g = comps[1];
+            if(saveFmt.compCount >= 3)
+              b = comps[2];
+            if(saveFmt.compCount >= 4)
+              a = comps[3];
+          }
           else
           {
             if(saveFmt.compCount >= 1)
@@ -1448,29 +1692,144 @@ bool ReplayController::SaveTexture(const TextureSave &saveData, const char *path
 
   for(size_t i = 0; i < subdata.size(); i++)
     delete[] subdata[i];
+  subdata.clear();
 
   return success;
 }
 
-rdcarray<PixelModification> ReplayController::PixelHistory(ResourceId target, uint32_t x, uint32_t y,
-                                                           const Subresource &sub, CompType typeCast)
+bool ReplayController::SaveTexture(const TextureSave &saveData, const char *path)
 {
   CHECK_REPLAY_THREAD();
 
-  rdcarray<PixelModification> ret;
+  TextureSaveData save;
 
-  Subresource subresource = sub;
+  if(!FetchTextureSaveData(saveData, save))
+    return false;
+
+  return EncodeTextureSaveData(save, path);
+}
+
+rdcarray<uint32_t> ReplayController::SaveTextures(const rdcarray<TextureSave> &saveData,
+                                                  const rdcarray<rdcstr> &paths)
+{
+  CHECK_REPLAY_THREAD();
+
+  rdcarray<uint32_t> failed;
+
+  if(saveData.size() != paths.size())
+  {
+    RDCERR("Mismatched texture save list (%zu) and path list (%zu)", saveData.size(), paths.size());
+    for(uint32_t i = 0; i < saveData.size(); i++)
+      failed.push_back(i);
+    return failed;
+  }
+
+  const uint32_t count = (uint32_t)saveData.size();
+
+  if(count == 0)
+    return failed;
+
+  // readbacks happen here on the replay thread, while the conversion and encoding of each texture
+  // happens on worker threads. The number of read back textures waiting to be encoded is bounded
+  // so that large batches don't hold every texture in memory at once.
+  const uint32_t numThreads = RDCMIN(Threading::NumberOfCores(), count);
+  const uint32_t maxInFlight = numThreads * 2;
+
+  struct PendingSave
+  {
+    uint32_t idx;
+    TextureSaveData data;
+  };
+
+  Threading::Semaphore emptySlots(maxInFlight);
+  Threading::Semaphore filledSlots(0);
+  Threading::CriticalSection queueLock;
+  rdcarray<PendingSave *> queue;
+  rdcarray<bool> success;
+  success.resize(count);
+
+  rdcarray<Threading::ThreadHandle> threads;
+  for(uint32_t t = 0; t < numThreads; t++)
+  {
+    threads.push_back(Threading::CreateThread([&]() {
+      for(;;)
+      {
+        filledSlots.Wait();
+
+        PendingSave *pending = NULL;
+        {
+          SCOPED_LOCK(queueLock);
+          pending = queue.front();
+          queue.erase(0);
+        }
+
+        // a NULL entry means there are no more textures coming
+        if(pending == NULL)
+          break;
+
+        success[pending->idx] = EncodeTextureSaveData(pending->data, paths[pending->idx].c_str());
+        delete pending;
+
+        emptySlots.Signal();
+      }
+    }));
+  }
+
+  for(uint32_t i = 0; i < count; i++)
+  {
+    emptySlots.Wait();
+
+    PendingSave *pending = new PendingSave;
+    pending->idx = i;
+
+    if(!FetchTextureSaveData(saveData[i], pending->data))
+    {
+      delete pending;
+      emptySlots.Signal();
+      continue;
+    }
+
+    {
+      SCOPED_LOCK(queueLock);
+      queue.push_back(pending);
+    }
+    filledSlots.Signal();
+  }
+
+  // wake each worker with a terminator once the real work is queued ahead of it
+  {
+    SCOPED_LOCK(queueLock);
+    for(uint32_t t = 0; t < numThreads; t++)
+      queue.push_back(NULL);
+  }
+  for(uint32_t t = 0; t < numThreads; t++)
+    filledSlots.Signal();
+
+  for(Threading::ThreadHandle t : threads)
+  {
+    Threading::JoinThread(t);
+    Threading::CloseThread(t);
+  }
+
+  for(uint32_t i = 0; i < count; i++)
+    if(!success[i])
+      failed.push_back(i);
+
+  return failed;
+}
+
+bool ReplayController::PreparePixelHistory(ResourceId target, Subresource &subresource,
+                                           uint32_t &width, uint32_t &height, ResourceId &liveId,
+                                           rdcarray<EventUsage> &events)
+{
+  width = height = ~0U;
 
   for(size_t t = 0; t < m_Textures.size(); t++)
   {
     if(m_Textures[t].resourceId == target)
     {
-      if(x >= m_Textures[t].width || y >= m_Textures[t].height)
-      {
-        RDCDEBUG("PixelHistory out of bounds on %s (%u,%u) vs (%u,%u)", ToStr(target).c_str(), x, y,
-                 m_Textures[t].width, m_Textures[t].height);
-        return ret;
-      }
+      width = m_Textures[t].width;
+      height = m_Textures[t].height;
 
       if(m_Textures[t].msSamp == 1)
         subresource.sample = ~0U;
@@ -1490,14 +1849,14 @@ rdcarray<PixelModification> ReplayController::PixelHistory(ResourceId target, ui
     }
   }
 
-  ResourceId id = m_pDevice->GetLiveID(target);
+  liveId = m_pDevice->GetLiveID(target);
 
-  if(id == ResourceId())
-    return ret;
+  if(liveId == ResourceId())
+    return false;
 
-  rdcarray<EventUsage> usage = m_pDevice->GetUsage(id);
+  rdcarray<EventUsage> usage = m_pDevice->GetUsage(liveId);
 
-  rdcarray<EventUsage> events;
+  events.clear();
 
   for(size_t i = 0; i < usage.size(); i++)
   {
@@ -1561,107 +1920,634 @@ rdcarray<PixelModification> ReplayController::PixelHistory(ResourceId target, ui
   if(events.empty())
   {
     RDCDEBUG("Target %s not written to before %u", ToStr(target).c_str(), m_EventID);
-    return ret;
+    return false;
   }
 
-  id = m_pDevice->GetLiveID(target);
-
-  if(id == ResourceId())
-    return ret;
-
-  ret = m_pDevice->PixelHistory(events, id, x, y, subresource, typeCast);
-
-  SetFrameEvent(m_EventID, true);
-
-  return ret;
+  return true;
 }
 
-PixelValue ReplayController::PickPixel(ResourceId tex, uint32_t x, uint32_t y,
-                                       const Subresource &sub, CompType typeCast)
+rdcarray<PixelModification> ReplayController::PixelHistory(ResourceId target, uint32_t x, uint32_t y,
+                                                           const Subresource &sub, CompType typeCast)
 {
   CHECK_REPLAY_THREAD();
 
-  PixelValue ret;
+  rdcarray<PixelModification> ret;
 
-  RDCEraseEl(ret.floatValue);
+  Subresource subresource = sub;
+  uint32_t width = 0, height = 0;
+  ResourceId id;
+  rdcarray<EventUsage> events;
 
-  if(tex == ResourceId())
+  if(!PreparePixelHistory(target, subresource, width, height, id, events))
     return ret;
 
-  m_pDevice->PickPixel(m_pDevice->GetLiveID(tex), x, y, sub, typeCast, ret.floatValue);
+  if(x >= width || y >= height)
+  {
+    RDCDEBUG("PixelHistory out of bounds on %s (%u,%u) vs (%u,%u)", ToStr(target).c_str(), x, y,
+             width, height);
+    return ret;
+  }
+
+  ret = m_pDevice->PixelHistory(events, id, x, y, subresource, typeCast);
+
+  SetFrameEvent(m_EventID, true);
 
   return ret;
 }
 
-rdcpair<PixelValue, PixelValue> ReplayController::GetMinMax(ResourceId textureId,
-                                                            const Subresource &sub, CompType typeCast)
+void ReplayController::StreamPixelHistory(ResourceId target, uint32_t x, uint32_t y,
+                                          const Subresource &sub, CompType typeCast,
+                                          uint32_t batchSize, bool mostRecentFirst,
+                                          RENDERDOC_PixelHistoryCallback callback)
 {
   CHECK_REPLAY_THREAD();
 
-  PixelValue minval = {{0.0f, 0.0f, 0.0f, 0.0f}};
-  PixelValue maxval = {{1.0f, 1.0f, 1.0f, 1.0f}};
-
-  m_pDevice->GetMinMax(m_pDevice->GetLiveID(textureId), sub, typeCast, &minval.floatValue[0],
-                       &maxval.floatValue[0]);
-
-  return make_rdcpair(minval, maxval);
-}
+  if(!callback)
+    return;
 
-rdcarray<uint32_t> ReplayController::GetHistogram(ResourceId textureId, const Subresource &sub,
-                                                  CompType typeCast, float minval, float maxval,
-                                                  bool channels[4])
-{
-  CHECK_REPLAY_THREAD();
+  Subresource subresource = sub;
+  uint32_t width = 0, height = 0;
+  ResourceId id;
+  rdcarray<EventUsage> events;
 
-  rdcarray<uint32_t> hist;
+  if(!PreparePixelHistory(target, subresource, width, height, id, events))
+  {
+    callback({}, 1.0f);
+    return;
+  }
 
-  m_pDevice->GetHistogram(m_pDevice->GetLiveID(textureId), sub, typeCast, minval, maxval, channels,
-                          hist);
+  if(x >= width || y >= height)
+  {
+    RDCDEBUG("PixelHistory out of bounds on %s (%u,%u) vs (%u,%u)", ToStr(target).c_str(), x, y,
+             width, height);
+    callback({}, 1.0f);
+    return;
+  }
 
-  return hist;
-}
+  batchSize = RDCMAX(batchSize, 1U);
 
-ShaderDebugTrace *ReplayController::DebugVertex(uint32_t vertid, uint32_t instid, uint32_t idx)
-{
-  CHECK_REPLAY_THREAD();
+  // split the events into batches, without splitting the usages of one event across batches since
+  // the drivers expect to see all of an event's usages together
+  rdcarray<size_t> batchStarts;
+  for(size_t i = 0; i < events.size(); i++)
+  {
+    if(batchStarts.empty() || (i - batchStarts.back() >= batchSize &&
+                               events[i].eventId != events[i - 1].eventId))
+      batchStarts.push_back(i);
+  }
+  batchStarts.push_back(events.size());
 
-  ShaderDebugTrace *ret = m_pDevice->DebugVertex(m_EventID, vertid, instid, idx);
+  const size_t numBatches = batchStarts.size() - 1;
 
-  SetFrameEvent(m_EventID, true);
+  for(size_t b = 0; b < numBatches; b++)
+  {
+    const size_t batch = mostRecentFirst ? numBatches - 1 - b : b;
 
-  return ret;
-}
+    rdcarray<EventUsage> batchEvents;
+    batchEvents.assign(events.data() + batchStarts[batch],
+                       batchStarts[batch + 1] - batchStarts[batch]);
 
-ShaderDebugTrace *ReplayController::DebugPixel(uint32_t x, uint32_t y, uint32_t sample,
-                                               uint32_t primitive)
-{
-  CHECK_REPLAY_THREAD();
+    // each event's history is calculated by replaying up to it, so batches are independent
+    rdcarray<PixelModification> mods =
+        m_pDevice->PixelHistory(batchEvents, id, x, y, subresource, typeCast);
 
-  ShaderDebugTrace *ret = m_pDevice->DebugPixel(m_EventID, x, y, sample, primitive);
+    if(!callback(mods, float(b + 1) / float(numBatches)))
+      break;
+  }
 
   SetFrameEvent(m_EventID, true);
-
-  return ret;
 }
 
-ShaderDebugTrace *ReplayController::DebugThread(const uint32_t groupid[3], const uint32_t threadid[3])
+rdcarray<PixelHistoryResult> ReplayController::BatchPixelHistory(ResourceId target,
+                                                                 const rdcarray<uint32_t> &pixels,
+                                                                 const Subresource &sub,
+                                                                 CompType typeCast)
 {
   CHECK_REPLAY_THREAD();
 
-  ShaderDebugTrace *ret = m_pDevice->DebugThread(m_EventID, groupid, threadid);
+  rdcarray<PixelHistoryResult> ret;
+  ret.resize(pixels.size() / 2);
 
-  SetFrameEvent(m_EventID, true);
+  for(size_t i = 0; i < ret.size(); i++)
+  {
+    ret[i].x = pixels[i * 2 + 0];
+    ret[i].y = pixels[i * 2 + 1];
+  }
 
-  return ret;
-}
+  // the texture, subresource and the events that wrote to it are the same for every pixel, so look
+  // them up once for the whole batch.
+  Subresource subresource = sub;
+  uint32_t width = 0, height = 0;
+  ResourceId id;
+  rdcarray<EventUsage> events;
 
-rdcarray<ShaderDebugState> ReplayController::ContinueDebug(ShaderDebugger *debugger)
-{
-  CHECK_REPLAY_THREAD();
+  if(ret.empty() || !PreparePixelHistory(target, subresource, width, height, id, events))
+    return ret;
 
-  rdcarray<ShaderDebugState> ret = m_pDevice->ContinueDebug(debugger);
+  // pixels can be listed more than once, e.g. when gathered from several diffs. Only fetch each
+  // pixel's history once, with the unique in-bounds pixels passed to the driver in one call
+  std::map<rdcpair<uint32_t, uint32_t>, size_t> fetched;
+  rdcarray<uint32_t> unique;
 
-  return ret;
+  for(size_t i = 0; i < ret.size(); i++)
+  {
+    PixelHistoryResult &res = ret[i];
+
+    if(res.x >= width || res.y >= height)
+    {
+      RDCDEBUG("PixelHistory out of bounds on %s (%u,%u) vs (%u,%u)", ToStr(target).c_str(), res.x,
+               res.y, width, height);
+      continue;
+    }
+
+    if(fetched.find({res.x, res.y}) != fetched.end())
+      continue;
+
+    fetched[{res.x, res.y}] = unique.size() / 2;
+    unique.push_back(res.x);
+    unique.push_back(res.y);
+  }
+
+  if(unique.empty())
+    return ret;
+
+  rdcarray<PixelHistoryResult> histories =
+      m_pDevice->BatchPixelHistory(events, id, unique, subresource, typeCast);
+
+  for(size_t i = 0; i < ret.size(); i++)
+  {
+    auto it = fetched.find({ret[i].x, ret[i].y});
+    if(it != fetched.end() && it->second < histories.size())
+      ret[i].modifications = histories[it->second].modifications;
+  }
+
+  // the driver leaves the replay wherever its last pass was, but we only need to restore the
+  // current event once at the end of the batch.
+  SetFrameEvent(m_EventID, true);
+
+  return ret;
+}
+
+PixelValue ReplayController::PickPixel(ResourceId tex, uint32_t x, uint32_t y,
+                                       const Subresource &sub, CompType typeCast)
+{
+  CHECK_REPLAY_THREAD();
+
+  PixelValue ret;
+
+  RDCEraseEl(ret.floatValue);
+
+  if(tex == ResourceId())
+    return ret;
+
+  m_pDevice->PickPixel(m_pDevice->GetLiveID(tex), x, y, sub, typeCast, ret.floatValue);
+
+  return ret;
+}
+
+rdcpair<PixelValue, PixelValue> ReplayController::GetMinMax(ResourceId textureId,
+                                                            const Subresource &sub, CompType typeCast)
+{
+  CHECK_REPLAY_THREAD();
+
+  // internal textures like overlays and custom shader outputs change without the event changing
+  const bool cache = IsCaptureTexture(textureId);
+  const TextureStatsKey key = {textureId, sub, typeCast, 0.0f, 0.0f, 0};
+
+  if(cache)
+  {
+    auto it = m_MinMaxCache.find(key);
+    if(it != m_MinMaxCache.end())
+      return it->second;
+  }
+
+  PixelValue minval = {{0.0f, 0.0f, 0.0f, 0.0f}};
+  PixelValue maxval = {{1.0f, 1.0f, 1.0f, 1.0f}};
+
+  m_pDevice->GetMinMax(m_pDevice->GetLiveID(textureId), sub, typeCast, &minval.floatValue[0],
+                       &maxval.floatValue[0]);
+
+  if(cache)
+  {
+    m_MinMaxCache[key] = make_rdcpair(minval, maxval);
+    TrimTextureStatsCache();
+  }
+
+  return make_rdcpair(minval, maxval);
+}
+
+rdcarray<uint32_t> ReplayController::GetHistogram(ResourceId textureId, const Subresource &sub,
+                                                  CompType typeCast, float minval, float maxval,
+                                                  bool channels[4])
+{
+  CHECK_REPLAY_THREAD();
+
+  const bool cache = IsCaptureTexture(textureId);
+  TextureStatsKey key = {textureId, sub, typeCast, minval, maxval, 0};
+  for(uint32_t c = 0; c < 4; c++)
+    key.channels |= channels[c] ? (1U << c) : 0U;
+
+  if(cache)
+  {
+    auto it = m_HistogramCache.find(key);
+    if(it != m_HistogramCache.end())
+      return it->second;
+  }
+
+  rdcarray<uint32_t> hist;
+
+  // the min/max is nearly always wanted alongside the histogram, and some drivers can fetch both
+  // from a single pass over the texture, so do that if it isn't cached yet.
+  const TextureStatsKey minmaxKey = {textureId, sub, typeCast, 0.0f, 0.0f, 0};
+
+  if(cache && m_MinMaxCache.find(minmaxKey) == m_MinMaxCache.end())
+  {
+    PixelValue minv = {{0.0f, 0.0f, 0.0f, 0.0f}};
+    PixelValue maxv = {{1.0f, 1.0f, 1.0f, 1.0f}};
+
+    m_pDevice->GetMinMaxHistogram(m_pDevice->GetLiveID(textureId), sub, typeCast, minval, maxval,
+                                  channels, &minv.floatValue[0], &maxv.floatValue[0], hist);
+
+    m_MinMaxCache[minmaxKey] = make_rdcpair(minv, maxv);
+  }
+  else
+  {
+    m_pDevice->GetHistogram(m_pDevice->GetLiveID(textureId), sub, typeCast, minval, maxval,
+                            channels, hist);
+  }
+
+  if(cache)
+  {
+    m_HistogramCache[key] = hist;
+    TrimTextureStatsCache();
+  }
+
+  return hist;
+}
+
+bool ReplayController::IsCaptureTexture(ResourceId id)
+{
+  for(const TextureDescription &tex : m_Textures)
+    if(tex.resourceId == id)
+      return true;
+
+  return false;
+}
+
+ShaderDebugTrace *ReplayController::DebugVertex(uint32_t vertid, uint32_t instid, uint32_t idx)
+{
+  CHECK_REPLAY_THREAD();
+
+  ShaderDebugRecord record;
+  record.type = ShaderDebugRecord::Vertex;
+  record.eventId = m_EventID;
+  record.params[0] = vertid;
+  record.params[1] = instid;
+  record.params[2] = idx;
+
+  ShaderDebugTrace *ret = RecordDebug(StartDebug(record), record);
+
+  SetFrameEvent(m_EventID, true);
+
+  return ret;
+}
+
+ShaderDebugTrace *ReplayController::DebugPixel(uint32_t x, uint32_t y, uint32_t sample,
+                                               uint32_t primitive)
+{
+  CHECK_REPLAY_THREAD();
+
+  ShaderDebugRecord record;
+  record.type = ShaderDebugRecord::Pixel;
+  record.eventId = m_EventID;
+  record.params[0] = x;
+  record.params[1] = y;
+  record.params[2] = sample;
+  record.params[3] = primitive;
+
+  ShaderDebugTrace *ret = RecordDebug(StartDebug(record), record);
+
+  SetFrameEvent(m_EventID, true);
+
+  return ret;
+}
+
+ShaderDebugTrace *ReplayController::DebugThread(const uint32_t groupid[3], const uint32_t threadid[3])
+{
+  CHECK_REPLAY_THREAD();
+
+  ShaderDebugRecord record;
+  record.type = ShaderDebugRecord::Thread;
+  record.eventId = m_EventID;
+  for(int i = 0; i < 3; i++)
+  {
+    record.params[i] = groupid[i];
+    record.params[3 + i] = threadid[i];
+  }
+
+  ShaderDebugTrace *ret = RecordDebug(StartDebug(record), record);
+
+  SetFrameEvent(m_EventID, true);
+
+  return ret;
+}
+
+ShaderDebugTrace *ReplayController::RecordDebug(ShaderDebugTrace *trace,
+                                                const ShaderDebugRecord &record)
+{
+  if(trace && trace->debugger)
+    m_DebugRecords[trace->debugger] = record;
+
+  return trace;
+}
+
+ShaderDebugTrace *ReplayController::StartDebug(const ShaderDebugRecord &record)
+{
+  const uint32_t *p = record.params;
+
+  switch(record.type)
+  {
+    case ShaderDebugRecord::Vertex: return m_pDevice->DebugVertex(record.eventId, p[0], p[1], p[2]);
+    case ShaderDebugRecord::Pixel:
+      return m_pDevice->DebugPixel(record.eventId, p[0], p[1], p[2], p[3]);
+    case ShaderDebugRecord::Thread: return m_pDevice->DebugThread(record.eventId, p, p + 3);
+  }
+
+  return NULL;
+}
+
+void ReplayController::TrackDebugState(ShaderDebugRecord &record)
+{
+  if(record.tracking)
+    return;
+
+  record.tracking = true;
+
+  if(record.numSteps == 0)
+    return;
+
+  // the debug was only stepped so far, so nothing has been tracked. Run a fresh debug of the same
+  // invocation up to where it has got to, as ReconstructDebugSteps does, to catch up.
+  const uint32_t numSteps = record.numSteps;
+
+  ShaderDebugTrace *trace = StartDebug(record);
+
+  SetFrameEvent(m_EventID, true);
+
+  if(trace && trace->debugger)
+  {
+    while(true)
+    {
+      rdcarray<ShaderDebugState> states = m_pDevice->ContinueDebug(trace->debugger);
+
+      if(states.empty())
+        break;
+
+      for(const ShaderDebugState &state : states)
+      {
+        if(state.stepIndex < numSteps)
+          ApplyDebugState(record, state);
+      }
+
+      if(states.back().stepIndex + 1 >= numSteps)
+        break;
+    }
+  }
+
+  if(trace)
+  {
+    SAFE_DELETE(trace->debugger);
+    delete trace;
+  }
+}
+
+void ReplayController::ApplyDebugState(ShaderDebugRecord &record, const ShaderDebugState &state)
+{
+  for(const ShaderVariableChange &c : state.changes)
+  {
+    // a variable going out of scope (or being renamed) removes the old name
+    if(!c.before.name.empty() && c.before.name != c.after.name)
+    {
+      auto it = record.variableIndex.find(c.before.name);
+      if(it != record.variableIndex.end())
+      {
+        record.variables[it->second].name.clear();
+        record.variableIndex.erase(it);
+      }
+    }
+
+    if(c.after.name.empty())
+      continue;
+
+    auto it = record.variableIndex.find(c.after.name);
+    if(it != record.variableIndex.end())
+    {
+      record.variables[it->second] = c.after;
+    }
+    else
+    {
+      record.variableIndex[c.after.name] = record.variables.size();
+      record.variables.push_back(c.after);
+    }
+  }
+
+  // compact away out of scope variables once they make up most of the list
+  if(record.variableIndex.size() * 2 < record.variables.size())
+  {
+    rdcarray<ShaderVariable> vars;
+    vars.reserve(record.variableIndex.size());
+    for(ShaderVariable &var : record.variables)
+    {
+      if(var.name.empty())
+        continue;
+
+      record.variableIndex[var.name] = vars.size();
+      vars.push_back(std::move(var));
+    }
+    record.variables.swap(vars);
+  }
+
+  record.numSteps = RDCMAX(record.numSteps, state.stepIndex + 1);
+}
+
+ShaderDebugState ReplayController::MakeDebugKeyframe(const ShaderDebugRecord &record,
+                                                     const ShaderDebugState &state)
+{
+  ShaderDebugState ret;
+  ret.nextInstruction = state.nextInstruction;
+  ret.stepIndex = state.stepIndex;
+  ret.flags = state.flags;
+  ret.sourceVars = state.sourceVars;
+  ret.callstack = state.callstack;
+
+  ret.changes.reserve(record.variableIndex.size());
+  for(const ShaderVariable &var : record.variables)
+  {
+    if(!var.name.empty())
+      ret.changes.push_back({ShaderVariable(), var});
+  }
+
+  return ret;
+}
+
+rdcarray<ShaderDebugState> ReplayController::ContinueDebug(ShaderDebugger *debugger)
+{
+  CHECK_REPLAY_THREAD();
+
+  rdcarray<ShaderDebugState> ret;
+
+  auto it = m_DebugRecords.find(debugger);
+
+  // return any states left over from stopping partway through a RunDebug before stepping further
+  if(it != m_DebugRecords.end() && !it->second.pending.empty())
+    ret.swap(it->second.pending);
+  else
+    ret = m_pDevice->ContinueDebug(debugger);
+
+  if(it != m_DebugRecords.end() && !ret.empty())
+  {
+    // only RunDebug needs the variable state, otherwise just count the steps
+    if(it->second.tracking)
+    {
+      for(const ShaderDebugState &state : ret)
+        ApplyDebugState(it->second, state);
+    }
+    else
+    {
+      it->second.numSteps = RDCMAX(it->second.numSteps, ret.back().stepIndex + 1);
+    }
+  }
+
+  return ret;
+}
+
+rdcarray<ShaderDebugState> ReplayController::RunDebug(ShaderDebugger *debugger,
+                                                      const ShaderDebugRunParameters &params)
+{
+  CHECK_REPLAY_THREAD();
+
+  rdcarray<ShaderDebugState> ret;
+
+  auto it = m_DebugRecords.find(debugger);
+  if(it == m_DebugRecords.end())
+  {
+    RDCERR("Unrecognised shader debugger passed to RunDebug");
+    return ret;
+  }
+
+  ShaderDebugRecord &record = it->second;
+
+  TrackDebugState(record);
+
+  rdcarray<ShaderDebugState> states;
+  states.swap(record.pending);
+
+  ShaderDebugState lastState;
+  bool stepped = false;
+
+  while(true)
+  {
+    if(states.empty())
+      states = m_pDevice->ContinueDebug(debugger);
+
+    if(states.empty())
+      break;
+
+    for(size_t i = 0; i < states.size(); i++)
+    {
+      const ShaderDebugState &state = states[i];
+
+      ApplyDebugState(record, state);
+
+      bool stop = params.breakpoints.contains(state.nextInstruction) ||
+                  (state.flags & params.stopOnEvents) != ShaderEvents::NoEvent;
+
+      for(size_t c = 0; !stop && c < state.changes.size() && !params.watchVariables.empty(); c++)
+        stop = params.watchVariables.contains(state.changes[c].before.name) ||
+               params.watchVariables.contains(state.changes[c].after.name);
+
+      if(stop)
+      {
+        ret.push_back(MakeDebugKeyframe(record, state));
+
+        // the debugger steps in batches, so hold onto whatever it ran past the stopping point
+        record.pending.assign(states.data() + i + 1, states.size() - i - 1);
+        return ret;
+      }
+
+      if(params.keyframeInterval > 0 && (state.stepIndex % params.keyframeInterval) == 0)
+        ret.push_back(MakeDebugKeyframe(record, state));
+    }
+
+    lastState = states.back();
+    stepped = true;
+    states.clear();
+  }
+
+  // the debug completed, make sure the final state is returned
+  if(stepped && (ret.empty() || ret.back().stepIndex != lastState.stepIndex))
+    ret.push_back(MakeDebugKeyframe(record, lastState));
+
+  return ret;
+}
+
+rdcarray<ShaderDebugState> ReplayController::ReconstructDebugSteps(ShaderDebugger *debugger,
+                                                                   uint32_t firstStep,
+                                                                   uint32_t count)
+{
+  CHECK_REPLAY_THREAD();
+
+  rdcarray<ShaderDebugState> ret;
+
+  auto it = m_DebugRecords.find(debugger);
+  if(it == m_DebugRecords.end())
+  {
+    RDCERR("Unrecognised shader debugger passed to ReconstructDebugSteps");
+    return ret;
+  }
+
+  const uint32_t endStep = RDCMIN(firstStep + count, it->second.numSteps);
+  if(firstStep >= endStep)
+    return ret;
+
+  // the debuggers can't snapshot their internal state, so start a fresh debug of the same
+  // invocation and run it up to the requested range. Debugging is deterministic so the states are
+  // identical to the original run.
+  ShaderDebugTrace *trace = StartDebug(it->second);
+
+  SetFrameEvent(m_EventID, true);
+
+  if(trace && trace->debugger)
+  {
+    ret.reserve(endStep - firstStep);
+
+    while(true)
+    {
+      rdcarray<ShaderDebugState> states = m_pDevice->ContinueDebug(trace->debugger);
+
+      if(states.empty())
+        break;
+
+      const uint32_t lastStep = states.back().stepIndex;
+
+      for(ShaderDebugState &state : states)
+      {
+        if(state.stepIndex >= firstStep && state.stepIndex < endStep)
+          ret.push_back(std::move(state));
+      }
+
+      if(lastStep + 1 >= endStep)
+        break;
+    }
+  }
+
+  if(trace)
+  {
+    SAFE_DELETE(trace->debugger);
+    delete trace;
+  }
+
+  return ret;
 }
 
 void ReplayController::FreeTrace(ShaderDebugTrace *trace)
@@ -1670,6 +2556,7 @@ void ReplayController::FreeTrace(ShaderDebugTrace *trace)
 
   if(trace)
   {
+    m_DebugRecords.erase(trace->debugger);
     SAFE_DELETE(trace->debugger);
     delete trace;
   }
@@ -1700,6 +2587,79 @@ rdcarray<ShaderVariable> ReplayController::GetCBufferVariableContents(
   return v;
 }
 
+rdcarray<ConstantBlockFetch> ReplayController::GetCBufferVariableContentsBatch(
+    const rdcarray<ConstantBlockFetch> &fetches)
+{
+  CHECK_REPLAY_THREAD();
+
+  rdcarray<ConstantBlockFetch> ret = fetches;
+
+  // work out the range needed from each buffer, so it can be read back in one go. A size of 0
+  // means the rest of the buffer.
+  struct BufferRange
+  {
+    uint64_t start = ~0ULL;
+    uint64_t end = 0;
+    bool toEnd = false;
+    bytebuf data;
+  };
+
+  std::map<ResourceId, BufferRange> ranges;
+
+  for(const ConstantBlockFetch &f : ret)
+  {
+    if(f.buffer == ResourceId())
+      continue;
+
+    BufferRange &range = ranges[f.buffer];
+    range.start = RDCMIN(range.start, f.byteOffset);
+    if(f.byteSize == 0)
+      range.toEnd = true;
+    else
+      range.end = RDCMAX(range.end, f.byteOffset + f.byteSize);
+  }
+
+  for(auto it = ranges.begin(); it != ranges.end(); ++it)
+  {
+    ResourceId live = m_pDevice->GetLiveID(it->first);
+    if(live == ResourceId())
+      continue;
+
+    BufferRange &range = it->second;
+    m_pDevice->GetBufferData(live, range.start, range.toEnd ? 0 : range.end - range.start,
+                             range.data);
+  }
+
+  bytebuf data;
+
+  for(ConstantBlockFetch &f : ret)
+  {
+    f.variables.clear();
+    data.clear();
+
+    if(f.buffer != ResourceId())
+    {
+      const BufferRange &range = ranges[f.buffer];
+
+      uint64_t start = f.byteOffset - range.start;
+      uint64_t end = f.byteSize == 0 ? range.data.size() : start + f.byteSize;
+      end = RDCMIN(end, (uint64_t)range.data.size());
+
+      if(start < end)
+        data.assign(range.data.data() + start, size_t(end - start));
+    }
+
+    ResourceId pipeline = m_pDevice->GetLiveID(f.pipeline);
+    ResourceId shader = m_pDevice->GetLiveID(f.shader);
+
+    if(shader != ResourceId())
+      m_pDevice->FillCBufferVariables(pipeline, shader, f.entryPoint, f.cbufSlot, f.variables,
+                                      data);
+  }
+
+  return ret;
+}
+
 rdcarray<WindowingSystem> ReplayController::GetSupportedWindowSystems()
 {
   CHECK_REPLAY_THREAD();
@@ -1823,6 +2783,92 @@ void ReplayController::ReplayLoop(WindowingData window, ResourceId texid)
   Atomic::Inc32(&m_ReplayLoopFinished);
 }
 
+// returns the summed duration of every event under the given drawcalls, and appends a timing
+// sample to each marker region found along the way
+static double SumRegionDurations(const rdcarray<DrawcallDescription> &draws,
+                                 const std::map<uint32_t, double> &durations,
+                                 rdcarray<MarkerRegionTiming> &regions, size_t &regionIdx,
+                                 uint32_t depth)
+{
+  double total = 0.0;
+
+  for(const DrawcallDescription &d : draws)
+  {
+    if(d.flags & DrawFlags::PushMarker)
+    {
+      // regions are visited in the same order every iteration, so create them on the first pass
+      if(regionIdx >= regions.size())
+      {
+        MarkerRegionTiming region;
+        region.eventId = d.eventId;
+        region.name = d.name;
+        region.depth = depth;
+        regions.push_back(region);
+      }
+
+      size_t idx = regionIdx++;
+
+      double regionTotal = SumRegionDurations(d.children, durations, regions, regionIdx, depth + 1);
+      regions[idx].gpuDurations.push_back(regionTotal);
+
+      total += regionTotal;
+      continue;
+    }
+
+    auto it = durations.find(d.eventId);
+    if(it != durations.end())
+      total += it->second;
+
+    total += SumRegionDurations(d.children, durations, regions, regionIdx, depth);
+  }
+
+  return total;
+}
+
+ReplayLoopMeasurement ReplayController::MeasureReplayLoop(uint32_t iterations)
+{
+  CHECK_REPLAY_THREAD();
+
+  ReplayLoopMeasurement ret;
+
+  m_ReplayLoopCancel = 0;
+  m_ReplayLoopFinished = 0;
+
+  for(uint32_t i = 0; i < iterations && Atomic::CmpExch32(&m_ReplayLoopCancel, 0, 0) == 0; i++)
+  {
+    PerformanceTimer timer;
+
+    m_pDevice->ReplayLog(10000000, eReplay_Full);
+
+    double cpuTime = timer.GetMilliseconds() / 1000.0;
+
+    // the timestamps need their own replay, so the query overhead isn't counted in the CPU time
+    rdcarray<CounterResult> results = m_pDevice->FetchCounters({GPUCounter::EventGPUDuration});
+
+    std::map<uint32_t, double> durations;
+    for(const CounterResult &res : results)
+    {
+      if(res.counter == GPUCounter::EventGPUDuration && res.value.d >= 0.0)
+        durations[res.eventId] = res.value.d;
+    }
+
+    size_t regionIdx = 0;
+    double gpuTime =
+        SumRegionDurations(m_FrameRecord.drawcallList, durations, ret.regions, regionIdx, 0);
+
+    ret.cpuTimes.push_back(cpuTime);
+    ret.gpuTimes.push_back(gpuTime);
+  }
+
+  // restore back to where we were
+  m_pDevice->ReplayLog(m_EventID, eReplay_Full);
+
+  // mark that the loop is finished
+  Atomic::Inc32(&m_ReplayLoopFinished);
+
+  return ret;
+}
+
 void ReplayController::CancelReplayLoop()
 {
   CHECK_REPLAY_THREAD();
@@ -1834,10 +2880,136 @@ void ReplayController::CancelReplayLoop()
     Threading::Sleep(1);
 }
 
+static uint64_t StructuredObjectSize(const SDObject *obj)
+{
+  uint64_t ret = sizeof(SDObject) + obj->name.size() + obj->type.name.size() +
+                 obj->data.str.size() + obj->data.children.size() * sizeof(SDObject *);
+
+  for(const SDObject *child : obj->data.children)
+    ret += StructuredObjectSize(child);
+
+  return ret;
+}
+
+rdcarray<MemoryUsage> ReplayController::GetMemoryUsage()
+{
+  CHECK_REPLAY_THREAD();
+
+  const SDFile &file = m_pDevice->GetStructuredFile();
+
+  uint64_t structuredSize = 0;
+  for(const SDChunk *chunk : file.chunks)
+    structuredSize += StructuredObjectSize(chunk);
+  for(const bytebuf *buf : file.buffers)
+    structuredSize += buf->size();
+
+  uint64_t textureSize = 0;
+  for(const TextureDescription &tex : m_Textures)
+    textureSize += tex.byteSize;
+
+  uint64_t bufferSize = 0;
+  for(const BufferDescription &buf : m_Buffers)
+    bufferSize += buf.length;
+
+  rdcarray<MemoryUsage> ret;
+  ret.push_back(MemoryUsage(MemoryCategory::StructuredData, structuredSize, 0));
+  ret.push_back(MemoryUsage(MemoryCategory::ReplayTextures, 0, textureSize));
+  ret.push_back(MemoryUsage(MemoryCategory::ReplayBuffers, 0, bufferSize));
+  ret.push_back(MemoryUsage(MemoryCategory::TextureStatsCache, GetTextureStatsCacheSize(), 0));
+  ret.append(m_pDevice->GetMemoryUsage());
+  return ret;
+}
+
+static bool IsEvictable(MemoryCategory category)
+{
+  switch(category)
+  {
+    case MemoryCategory::PostVSCache:
+    case MemoryCategory::TextureStatsCache:
+    case MemoryCategory::ShaderCache:
+    case MemoryCategory::RerecordCache:
+    case MemoryCategory::TextureReadback: return true;
+    default: break;
+  }
+
+  return false;
+}
+
+void ReplayController::SetMemoryBudget(MemoryCategory category, uint64_t bytes)
+{
+  CHECK_REPLAY_THREAD();
+
+  if(!IsEvictable(category))
+  {
+    RDCWARN("Memory category %s can't be evicted, ignoring budget", ToStr(category).c_str());
+    return;
+  }
+
+  if(bytes == 0)
+    m_MemoryBudgets.erase(category);
+  else
+    m_MemoryBudgets[category] = bytes;
+
+  ApplyMemoryBudgets();
+}
+
+uint64_t ReplayController::GetTextureStatsCacheSize()
+{
+  uint64_t ret = m_MinMaxCache.size() * (sizeof(TextureStatsKey) + sizeof(PixelValue) * 2);
+
+  for(auto it = m_HistogramCache.begin(); it != m_HistogramCache.end(); ++it)
+    ret += sizeof(TextureStatsKey) + it->second.byteSize();
+
+  return ret;
+}
+
+void ReplayController::TrimTextureStatsCache()
+{
+  auto it = m_MemoryBudgets.find(MemoryCategory::TextureStatsCache);
+  if(it == m_MemoryBudgets.end())
+    return;
+
+  uint64_t size = GetTextureStatsCacheSize();
+  if(size > it->second)
+  {
+    RDCLOG("%s is using %llu bytes, over its budget of %llu. Evicting",
+           ToStr(MemoryCategory::TextureStatsCache).c_str(), size, it->second);
+    m_MinMaxCache.clear();
+    m_HistogramCache.clear();
+  }
+}
+
+void ReplayController::ApplyMemoryBudgets()
+{
+  if(m_MemoryBudgets.empty())
+    return;
+
+  // this cache is held here rather than by the driver
+  TrimTextureStatsCache();
+
+  for(const MemoryUsage &usage : m_pDevice->GetMemoryUsage())
+  {
+    auto it = m_MemoryBudgets.find(usage.category);
+    if(it != m_MemoryBudgets.end() && usage.cpuBytes + usage.gpuBytes > it->second)
+    {
+      RDCLOG("%s is using %llu bytes, over its budget of %llu. Evicting",
+             ToStr(usage.category).c_str(), usage.cpuBytes + usage.gpuBytes, it->second);
+      m_pDevice->EvictCache(usage.category);
+    }
+  }
+}
+
 ReplayOutput *ReplayController::CreateOutput(WindowingData window, ReplayOutputType type)
 {
   CHECK_REPLAY_THREAD();
 
+  if(RenderDoc::Inst().GetGlobalEnvironment().headless &&
+     window.system != WindowingSystem::Unknown && window.system != WindowingSystem::Headless)
+  {
+    RDCERR("Can't create a %s output when replaying headless", ToStr(window.system).c_str());
+    return NULL;
+  }
+
   ReplayOutput *out = new ReplayOutput(this, window, type);
 
   m_Outputs.push_back(out);
@@ -25,6 +25,7 @@
 
 #pragma once
 
+#include <map>
 #include <set>
 #include "api/replay/renderdoc_replay.h"
 #include "common/common.h"
@@ -58,6 +59,7 @@ public:
 
   ResourceId GetCustomShaderTexID();
   ResourceId GetDebugOverlayTexID();
+  rdcarray<OverdrawStatistics> GetOverdrawStatistics();
   rdcpair<uint32_t, uint32_t> PickVertex(uint32_t x, uint32_t y);
 
 private:
@@ -75,6 +77,8 @@ private:
 
   void DisplayMesh();
 
+  bool ThumbnailWrittenBetween(ResourceId texture, uint32_t eventA, uint32_t eventB);
+
   uint64_t m_ThreadID;
 
   ReplayController *m_pRenderer;
@@ -101,6 +105,10 @@ private:
 
   rdcarray<OutputPair> m_Thumbnails;
 
+  // sorted list of events that write to each texture shown in a thumbnail, fetched on first use.
+  // Usage doesn't change over the lifetime of a capture so this never needs to be invalidated
+  std::map<ResourceId, rdcarray<uint32_t>> m_ThumbnailWrites;
+
   float m_ContextX;
   float m_ContextY;
   OutputPair m_PixelContext;
@@ -110,6 +118,13 @@ private:
 
   rdcarray<uint32_t> passEvents;
 
+  // the post-transform data for the other draws in the pass and other instances, which only
+  // change with the event or the mesh display settings. Kept so that moving the camera doesn't
+  // re-query every draw in the pass each frame
+  rdcarray<MeshFormat> m_SecondaryDraws;
+  bool m_SecondaryDrawsDirty = true;
+  bool m_SecondaryDrawsDarkTheme = false;
+
   int32_t m_Width;
   int32_t m_Height;
 
@@ -136,6 +151,8 @@ public:
   void FileChanged();
 
   void SetFrameEvent(uint32_t eventId, bool force);
+  rdcarray<EventVisitResult> VisitEvents(const rdcarray<uint32_t> &eventIds, EventVisitData data,
+                                         const rdcarray<EventVisitBufferRange> &buffers);
 
   const D3D11Pipe::State *GetD3D11PipelineState();
   const D3D12Pipe::State *GetD3D12PipelineState();
@@ -164,9 +181,11 @@ public:
 
   FrameDescription GetFrameInfo();
   const SDFile &GetStructuredFile();
+  void FetchStructuredChunks(const rdcarray<uint32_t> &chunkIndices);
   const rdcarray<DrawcallDescription> &GetDrawcalls();
   void AddFakeMarkers();
   rdcarray<CounterResult> FetchCounters(const rdcarray<GPUCounter> &counters);
+  rdcarray<EventTiming> FetchEventTimings(uint32_t repeats);
   rdcarray<GPUCounter> EnumerateCounters();
   CounterDescription DescribeCounter(GPUCounter counterID);
   const rdcarray<TextureDescription> &GetTextures();
@@ -185,10 +204,20 @@ public:
                                   float minval, float maxval, bool channels[4]);
   rdcarray<PixelModification> PixelHistory(ResourceId target, uint32_t x, uint32_t y,
                                            const Subresource &sub, CompType typeCast);
+  void StreamPixelHistory(ResourceId target, uint32_t x, uint32_t y, const Subresource &sub,
+                          CompType typeCast, uint32_t batchSize, bool mostRecentFirst,
+                          RENDERDOC_PixelHistoryCallback callback);
+  rdcarray<PixelHistoryResult> BatchPixelHistory(ResourceId target,
+                                                 const rdcarray<uint32_t> &pixels,
+                                                 const Subresource &sub, CompType typeCast);
   ShaderDebugTrace *DebugVertex(uint32_t vertid, uint32_t instid, uint32_t idx);
   ShaderDebugTrace *DebugPixel(uint32_t x, uint32_t y, uint32_t sample, uint32_t primitive);
   ShaderDebugTrace *DebugThread(const uint32_t groupid[3], const uint32_t threadid[3]);
   rdcarray<ShaderDebugState> ContinueDebug(ShaderDebugger *debugger);
+  rdcarray<ShaderDebugState> RunDebug(ShaderDebugger *debugger,
+                                      const ShaderDebugRunParameters &params);
+  rdcarray<ShaderDebugState> ReconstructDebugSteps(ShaderDebugger *debugger, uint32_t firstStep,
+                                                   uint32_t count);
   void FreeTrace(ShaderDebugTrace *trace);
 
   MeshFormat GetPostVSData(uint32_t instID, uint32_t viewID, MeshDataStage stage);
@@ -199,7 +228,11 @@ public:
   bytebuf GetTextureData(ResourceId buff, const Subresource &sub);
 
   bool SaveTexture(const TextureSave &saveData, const char *path);
+  rdcarray<uint32_t> SaveTextures(const rdcarray<TextureSave> &saveData,
+                                  const rdcarray<rdcstr> &paths);
 
+  rdcarray<ConstantBlockFetch> GetCBufferVariableContentsBatch(
+      const rdcarray<ConstantBlockFetch> &fetches);
   rdcarray<ShaderVariable> GetCBufferVariableContents(ResourceId pipeline, ResourceId shader,
                                                       const char *entryPoint, uint32_t cbufslot,
                                                       ResourceId buffer, uint64_t offset,
@@ -208,8 +241,12 @@ public:
   rdcarray<WindowingSystem> GetSupportedWindowSystems();
 
   void ReplayLoop(WindowingData window, ResourceId texid);
+  ReplayLoopMeasurement MeasureReplayLoop(uint32_t iterations);
   void CancelReplayLoop();
 
+  rdcarray<MemoryUsage> GetMemoryUsage();
+  void SetMemoryBudget(MemoryCategory category, uint64_t bytes);
+
   rdcstr CreateRGPProfile(WindowingData window);
 
   ReplayOutput *CreateOutput(WindowingData window, ReplayOutputType type);
@@ -222,6 +259,10 @@ private:
 
   void FetchPipelineState(uint32_t eventId);
 
+  void ApplyMemoryBudgets();
+  uint64_t GetTextureStatsCacheSize();
+  void TrimTextureStatsCache();
+
   DrawcallDescription *GetDrawcallByEID(uint32_t eventId);
   bool ContainsMarker(const rdcarray<DrawcallDescription> &draws);
   bool PassEquivalent(const DrawcallDescription &a, const DrawcallDescription &b);
@@ -257,5 +298,90 @@ private:
   std::set<ResourceId> m_TargetResources;
   std::set<ResourceId> m_CustomShaders;
 
+  // min/max and histogram results for capture textures at the current event. Cleared whenever
+  // the frame is replayed to a different event or forcibly refreshed.
+  struct TextureStatsKey
+  {
+    ResourceId texture;
+    Subresource sub;
+    CompType typeCast;
+    float minval, maxval;
+    uint32_t channels;
+
+    bool operator<(const TextureStatsKey &o) const
+    {
+      if(texture != o.texture)
+        return texture < o.texture;
+      if(sub != o.sub)
+        return sub < o.sub;
+      if(typeCast != o.typeCast)
+        return typeCast < o.typeCast;
+      if(minval != o.minval)
+        return minval < o.minval;
+      if(maxval != o.maxval)
+        return maxval < o.maxval;
+      return channels < o.channels;
+    }
+  };
+
+  bool IsCaptureTexture(ResourceId id);
+
+  bool PreparePixelHistory(ResourceId target, Subresource &subresource, uint32_t &width,
+                           uint32_t &height, ResourceId &liveId, rdcarray<EventUsage> &events);
+
+  // the subresources of a texture read back for saving, along with what's needed to convert and
+  // write them out without touching the replay device - so this can happen on any thread.
+  struct TextureSaveData
+  {
+    TextureSave sd;
+    TextureDescription td;
+    rdcarray<byte *> subdata;
+    uint32_t rowPitch = 0;
+    uint32_t numMips = 0;
+    uint32_t numSlices = 0;
+    bool singleSlice = false;
+  };
+
+  bool FetchTextureSaveData(const TextureSave &saveData, TextureSaveData &save);
+  static bool EncodeTextureSaveData(TextureSaveData &save, const char *path);
+
+  std::map<TextureStatsKey, rdcpair<PixelValue, PixelValue>> m_MinMaxCache;
+  std::map<TextureStatsKey, rdcarray<uint32_t>> m_HistogramCache;
+
+  // per-category budgets in bytes set with SetMemoryBudget, only for categories with a budget
+  std::map<MemoryCategory, uint64_t> m_MemoryBudgets;
+
+  // how a shader debug was started, so that it can be deterministically re-executed to reconstruct
+  // steps. Once RunDebug has been used on it, it also holds the full variable state at the last
+  // step that was run, so that keyframes can be returned - plain stepping doesn't pay for that.
+  struct ShaderDebugRecord
+  {
+    enum
+    {
+      Vertex,
+      Pixel,
+      Thread,
+    } type;
+    uint32_t eventId = 0;
+    uint32_t params[6] = {};
+
+    uint32_t numSteps = 0;
+
+    bool tracking = false;
+    // variables that go out of scope are left with an empty name, and skipped in keyframes
+    rdcarray<ShaderVariable> variables;
+    std::map<rdcstr, size_t> variableIndex;
+    rdcarray<ShaderDebugState> pending;
+  };
+
+  ShaderDebugTrace *RecordDebug(ShaderDebugTrace *trace, const ShaderDebugRecord &record);
+  ShaderDebugTrace *StartDebug(const ShaderDebugRecord &record);
+  void TrackDebugState(ShaderDebugRecord &record);
+  static void ApplyDebugState(ShaderDebugRecord &record, const ShaderDebugState &state);
+  static ShaderDebugState MakeDebugKeyframe(const ShaderDebugRecord &record,
+                                            const ShaderDebugState &state);
+
+  std::map<ShaderDebugger *, ShaderDebugRecord> m_DebugRecords;
+
   friend struct ReplayOutput;
 };
@@ -547,6 +547,148 @@ void StandardFillCBufferVariables(ResourceId shader, const rdcarray<ShaderConsta
   StandardFillCBufferVariables(shader, invars, outvars, data, 0);
 }
 
+void CBufferLayoutCache::BuildPlan(const rdcarray<ShaderConstant> &invars, uint32_t baseOffset,
+                                   rdcarray<ShaderVariable> &outvars, rdcarray<LeafFill> &leaves)
+{
+  // this must produce exactly the same tree as StandardFillCBufferVariables above, only recording
+  // where each leaf's data comes from instead of reading it.
+  for(size_t v = 0; v < invars.size(); v++)
+  {
+    const ShaderVariableDescriptor &desc = invars[v].type.descriptor;
+    const rdcstr &basename = invars[v].name;
+
+    uint8_t rows = desc.rows;
+    uint8_t cols = desc.columns;
+    uint32_t elems = RDCMAX(1U, desc.elements);
+    const bool rowMajor = desc.rowMajorStorage != 0;
+    const bool isArray = elems > 1;
+
+    uint32_t dataOffset = baseOffset + invars[v].byteOffset;
+
+    ShaderVariable var;
+    var.name = basename;
+    var.rows = var.columns = 0;
+    var.type = VarType::Float;
+    var.rowMajor = rowMajor;
+
+    if(!invars[v].type.members.empty() || (rows == 0 && cols == 0))
+    {
+      if(isArray)
+      {
+        var.members.resize(elems);
+        for(uint32_t i = 0; i < elems; i++)
+        {
+          ShaderVariable &vr = var.members[i];
+          vr.name = StringFormat::Fmt("%s[%u]", basename.c_str(), i);
+          vr.rows = vr.columns = 0;
+          vr.type = VarType::Float;
+          vr.rowMajor = rowMajor;
+          vr.isStruct = true;
+
+          BuildPlan(invars[v].type.members, dataOffset, vr.members, leaves);
+
+          dataOffset += desc.arrayByteStride;
+        }
+
+        var.isStruct = false;
+      }
+      else
+      {
+        var.isStruct = true;
+
+        BuildPlan(invars[v].type.members, dataOffset, var.members, leaves);
+      }
+
+      outvars.push_back(var);
+      continue;
+    }
+
+    var.type = desc.type;
+    var.isStruct = false;
+    var.columns = cols;
+
+    if(!isArray)
+    {
+      var.rows = rows;
+      leaves.push_back({desc, dataOffset});
+    }
+    else
+    {
+      var.members.resize(elems);
+
+      for(uint32_t e = 0; e < elems; e++)
+      {
+        ShaderVariable &el = var.members[e];
+        el.name = StringFormat::Fmt("%s[%u]", basename.c_str(), e);
+        el.rows = rows;
+        el.type = desc.type;
+        el.isStruct = false;
+        el.columns = cols;
+        el.rowMajor = rowMajor;
+
+        leaves.push_back({desc, dataOffset});
+
+        dataOffset += desc.arrayByteStride;
+      }
+
+      var.columns = 0;
+    }
+
+    outvars.push_back(var);
+  }
+}
+
+void CBufferLayoutCache::ApplyPlan(ResourceId reflId, const rdcarray<LeafFill> &leaves,
+                                   size_t &leafIdx, ShaderVariable *vars, size_t numVars,
+                                   const bytebuf &data)
+{
+  for(size_t i = 0; i < numVars; i++)
+  {
+    ShaderVariable &var = vars[i];
+
+    // leaves are the only variables with a size, structs and arrays are 0x0
+    if(var.rows == 0 && var.columns == 0)
+    {
+      ApplyPlan(reflId, leaves, leafIdx, var.members.data(), var.members.size(), data);
+      continue;
+    }
+
+    if(leafIdx >= leaves.size())
+    {
+      RDCERR("Constant buffer layout plan has fewer leaves than variables");
+      return;
+    }
+
+    const LeafFill &leaf = leaves[leafIdx++];
+    StandardFillCBufferVariable(reflId, leaf.desc, leaf.dataOffset, data, var,
+                                leaf.desc.matrixByteStride);
+  }
+}
+
+void CBufferLayoutCache::Fill(ResourceId pipeline, ResourceId shader, const rdcstr &entryPoint,
+                              uint32_t cbufSlot, ResourceId reflId,
+                              const rdcarray<ShaderConstant> &invars,
+                              rdcarray<ShaderVariable> &outvars, const bytebuf &data)
+{
+  Key key = {pipeline, shader, entryPoint, cbufSlot};
+
+  auto it = m_Plans.find(key);
+  if(it == m_Plans.end())
+  {
+    it = m_Plans.insert(std::make_pair(key, Plan())).first;
+    BuildPlan(invars, 0, it->second.vars, it->second.leaves);
+  }
+
+  const Plan &plan = it->second;
+
+  // like StandardFillCBufferVariables, append to any existing variables
+  size_t first = outvars.size();
+  outvars.append(plan.vars);
+
+  size_t leafIdx = 0;
+  ApplyPlan(reflId, plan.leaves, leafIdx, outvars.data() + first, plan.vars.size(), data);
+}
+
 uint64_t CalcMeshOutputSize(uint64_t curSize, uint64_t requiredOutput)
 {
   // resize exponentially up to 256MB to avoid repeated resizes
@@ -561,6 +703,101 @@ uint64_t CalcMeshOutputSize(uint64_t curSize, uint64_t requiredOutput)
   return curSize;
 }
 
+static uint64_t EstimateTypeSize(const ShaderVariableType &type)
+{
+  uint64_t ret = type.descriptor.name.size();
+
+  for(const ShaderConstant &member : type.members)
+    ret += sizeof(ShaderConstant) + member.name.size() + EstimateTypeSize(member.type);
+
+  return ret;
+}
+
+uint64_t EstimateReflectionSize(const ShaderReflection &refl)
+{
+  uint64_t ret = sizeof(ShaderReflection) + refl.entryPoint.size() + refl.rawBytes.size();
+
+  for(const ShaderSourceFile &file : refl.debugInfo.files)
+    ret += sizeof(ShaderSourceFile) + file.filename.size() + file.contents.size();
+
+  for(const rdcarray<SigParameter> *sig : {&refl.inputSignature, &refl.outputSignature})
+    for(const SigParameter &param : *sig)
+      ret += sizeof(SigParameter) + param.varName.size() + param.semanticName.size() +
+             param.semanticIdxName.size();
+
+  for(const ConstantBlock &block : refl.constantBlocks)
+  {
+    ret += sizeof(ConstantBlock) + block.name.size();
+    for(const ShaderConstant &var : block.variables)
+      ret += sizeof(ShaderConstant) + var.name.size() + EstimateTypeSize(var.type);
+  }
+
+  for(const ShaderSampler &samp : refl.samplers)
+    ret += sizeof(ShaderSampler) + samp.name.size();
+
+  for(const rdcarray<ShaderResource> *res : {&refl.readOnlyResources, &refl.readWriteResources})
+    for(const ShaderResource &r : *res)
+      ret += sizeof(ShaderResource) + r.name.size() + EstimateTypeSize(r.variableType);
+
+  for(const rdcstr &iface : refl.interfaces)
+    ret += sizeof(rdcstr) + iface.size();
+
+  for(const ShaderVariableType &type : refl.pointerTypes)
+    ret += sizeof(ShaderVariableType) + EstimateTypeSize(type);
+
+  return ret;
+}
+
+void ChunkLoadRecorder::Record(uint32_t chunkID, uint64_t byteSize, double cpuMS, double gpuWaitMS)
+{
+  ChunkLoadStatistics &stats = m_Stats[chunkID];
+  stats.count++;
+  stats.byteSize += byteSize;
+  stats.cpuTime += cpuMS;
+  stats.gpuWaitTime += gpuWaitMS;
+}
+
+uint64_t ChunkLoadRecorder::GetTotalSize(uint32_t chunkID) const
+{
+  auto it = m_Stats.find(chunkID);
+  return it == m_Stats.end() ? 0 : it->second.byteSize;
+}
+
+rdcarray<ChunkLoadStatistics> ChunkLoadRecorder::Bake(rdcstr (*getChunkName)(uint32_t)) const
+{
+  rdcarray<ChunkLoadStatistics> ret;
+  ret.reserve(m_Stats.size());
+
+  for(auto it = m_Stats.begin(); it != m_Stats.end(); ++it)
+  {
+    ChunkLoadStatistics stats = it->second;
+    stats.chunkID = it->first;
+    stats.name = getChunkName(it->first);
+
+#if ENABLED(RDOC_DEVEL)
+    double dcount = double(stats.count);
+
+    RDCDEBUG(
+        "% 5u chunks - Time: %9.3fms total/%9.3fms avg (GPU wait %9.3fms) - Size: %8.3fMB "
+        "total/%7.3fMB avg - %s (%u)",
+        stats.count, stats.cpuTime, stats.cpuTime / dcount, stats.gpuWaitTime,
+        double(stats.byteSize) / (1024.0 * 1024.0),
+        double(stats.byteSize) / (dcount * 1024.0 * 1024.0), stats.name.c_str(), stats.chunkID);
+#endif
+
+    stats.cpuTime /= 1000.0;
+    stats.gpuWaitTime /= 1000.0;
+
+    ret.push_back(stats);
+  }
+
+  std::sort(ret.begin(), ret.end(), [](const ChunkLoadStatistics &a, const ChunkLoadStatistics &b) {
+    return a.cpuTime > b.cpuTime;
+  });
+
+  return ret;
+}
+
 FloatVector HighlightCache::InterpretVertex(const byte *data, uint32_t vert, const MeshDisplay &cfg,
                                             const byte *end, bool useidx, bool &valid)
 {
@@ -1161,3 +1398,111 @@ const Vec4f colorRamp[22] = {
     Vec4f(1.000000f, 0.376471f, 0.752941f, 1.0f), Vec4f(1.000000f, 0.627451f, 1.000000f, 1.0f),
     Vec4f(1.000000f, 0.878431f, 1.000000f, 1.0f), Vec4f(1.000000f, 1.000000f, 1.000000f, 1.0f),
 };
+
+#if ENABLED(ENABLE_UNIT_TESTS)
+
+#include "3rdparty/catch/catch.hpp"
+
+static ShaderConstant MakeConstant(const char *name, uint32_t offset, VarType type, uint8_t rows,
+                                   uint8_t cols, uint32_t elems = 1)
+{
+  ShaderConstant c;
+  c.name = name;
+  c.byteOffset = offset;
+  c.type.descriptor.type = type;
+  c.type.descriptor.rows = rows;
+  c.type.descriptor.columns = cols;
+  c.type.descriptor.elements = elems;
+  c.type.descriptor.matrixByteStride = 16;
+  c.type.descriptor.arrayByteStride = 16 * rows;
+  return c;
+}
+
+// ShaderVariable's default constructor only clears the first half of the value union, so compare
+// only the components that are actually used.
+static bool SameVariable(const ShaderVariable &a, const ShaderVariable &b)
+{
+  if(a.name != b.name || a.type != b.type || a.rows != b.rows || a.columns != b.columns ||
+     a.isStruct != b.isStruct || a.rowMajor != b.rowMajor || a.members.size() != b.members.size())
+    return false;
+
+  for(uint32_t i = 0; i < a.rows * a.columns; i++)
+  {
+    if(a.value.u64v[i] != b.value.u64v[i] && VarTypeByteSize(a.type) == 8)
+      return false;
+    if(a.value.uv[i] != b.value.uv[i] && VarTypeByteSize(a.type) != 8)
+      return false;
+  }
+
+  for(size_t i = 0; i < a.members.size(); i++)
+    if(!SameVariable(a.members[i], b.members[i]))
+      return false;
+
+  return true;
+}
+
+static bool SameVariables(const rdcarray<ShaderVariable> &a, const rdcarray<ShaderVariable> &b)
+{
+  if(a.size() != b.size())
+    return false;
+
+  for(size_t i = 0; i < a.size(); i++)
+    if(!SameVariable(a[i], b[i]))
+      return false;
+
+  return true;
+}
+
+TEST_CASE("Cached constant buffer layouts match the uncached fill", "[cbuffer]")
+{
+  rdcarray<ShaderConstant> invars;
+  invars.push_back(MakeConstant("scalar", 0, VarType::Float, 1, 1));
+  invars.push_back(MakeConstant("vec", 16, VarType::SInt, 1, 3));
+  invars.push_back(MakeConstant("mat", 32, VarType::Float, 4, 4));
+  invars.push_back(MakeConstant("halfs", 96, VarType::Half, 1, 2, 3));
+
+  ShaderConstant s = MakeConstant("structs", 144, VarType::Float, 0, 0, 2);
+  s.type.descriptor.arrayByteStride = 32;
+  s.type.members.push_back(MakeConstant("a", 0, VarType::UInt, 1, 4));
+  s.type.members.push_back(MakeConstant("b", 16, VarType::Double, 1, 2));
+  invars.push_back(s);
+
+  ShaderConstant empty = MakeConstant("empty", 208, VarType::Float, 0, 0);
+  invars.push_back(empty);
+
+  bytebuf data;
+  data.resize(256);
+  for(size_t i = 0; i < data.size(); i++)
+    data[i] = byte(i * 7 + 3);
+
+  rdcarray<ShaderVariable> expected;
+  StandardFillCBufferVariables(ResourceId(), invars, expected, data);
+
+  CBufferLayoutCache cache;
+
+  // the second fill uses the cached plan, with different data
+  for(int pass = 0; pass < 2; pass++)
+  {
+    rdcarray<ShaderVariable> actual;
+    cache.Fill(ResourceId(), ResourceId(), "main", 0, ResourceId(), invars, actual, data);
+
+    CHECK(SameVariables(actual, expected));
+
+    for(size_t i = 0; i < data.size(); i++)
+      data[i] = byte(i * 13 + 1);
+
+    expected.clear();
+    StandardFillCBufferVariables(ResourceId(), invars, expected, data);
+  }
+
+  // existing variables are kept and the new ones appended
+  rdcarray<ShaderVariable> appended;
+  appended.push_back(ShaderVariable());
+  cache.Fill(ResourceId(), ResourceId(), "main", 0, ResourceId(), invars, appended, data);
+
+  REQUIRE(appended.size() == expected.size() + 1);
+  for(size_t i = 0; i < expected.size(); i++)
+    CHECK(SameVariable(appended[i + 1], expected[i]));
+}
+
+#endif    // ENABLED(ENABLE_UNIT_TESTS)
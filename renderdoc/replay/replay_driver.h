@@ -179,6 +179,24 @@ public:
   virtual rdcarray<PixelModification> PixelHistory(rdcarray<EventUsage> events, ResourceId target,
                                                    uint32_t x, uint32_t y, const Subresource &sub,
                                                    CompType typeCast) = 0;
+  // fetches the history of several pixels in one subresource, given as x,y pairs. Drivers that can
+  // share the replay passes between pixels override this, otherwise it's one PixelHistory call per
+  // pixel. Over a remote connection this is still a single round trip for the whole batch.
+  virtual rdcarray<PixelHistoryResult> BatchPixelHistory(rdcarray<EventUsage> events,
+                                                         ResourceId target,
+                                                         rdcarray<uint32_t> pixels,
+                                                         const Subresource &sub, CompType typeCast)
+  {
+    rdcarray<PixelHistoryResult> ret;
+    ret.resize(pixels.size() / 2);
+    for(size_t i = 0; i < ret.size(); i++)
+    {
+      ret[i].x = pixels[i * 2 + 0];
+      ret[i].y = pixels[i * 2 + 1];
+      ret[i].modifications = PixelHistory(events, target, ret[i].x, ret[i].y, sub, typeCast);
+    }
+    return ret;
+  }
   virtual ShaderDebugTrace *DebugVertex(uint32_t eventId, uint32_t vertid, uint32_t instid,
                                         uint32_t idx) = 0;
   virtual ShaderDebugTrace *DebugPixel(uint32_t eventId, uint32_t x, uint32_t y, uint32_t sample,
@@ -190,6 +208,7 @@ public:
   virtual ResourceId RenderOverlay(ResourceId texid, CompType typeCast, FloatVector clearCol,
                                    DebugOverlay overlay, uint32_t eventId,
                                    const rdcarray<uint32_t> &passEvents) = 0;
+  virtual rdcarray<OverdrawStatistics> GetOverdrawStatistics() = 0;
 
   virtual bool IsRenderOutput(ResourceId id) = 0;
 
@@ -200,6 +219,9 @@ public:
   virtual DriverInformation GetDriverInfo() = 0;
 
   virtual rdcarray<GPUDevice> GetAvailableGPUs() = 0;
+
+  virtual rdcarray<MemoryUsage> GetMemoryUsage() = 0;
+  virtual void EvictCache(MemoryCategory category) = 0;
 };
 
 class IReplayDriver : public IRemoteDriver
@@ -207,6 +229,10 @@ class IReplayDriver : public IRemoteDriver
 public:
   virtual bool IsRemoteProxy() = 0;
 
+  // when the structured file is only partially available, as with remote replay, make sure the
+  // contents of the given chunks are present. Otherwise this does nothing.
+  virtual void FetchStructuredChunks(const rdcarray<uint32_t> &chunkIndices) = 0;
+
   virtual rdcarray<WindowingSystem> GetSupportedWindowSystems() = 0;
 
   virtual AMDRGPControl *GetRGPControl() = 0;
@@ -227,6 +253,16 @@ public:
                          float *maxval) = 0;
   virtual bool GetHistogram(ResourceId texid, const Subresource &sub, CompType typeCast, float minval,
                             float maxval, bool channels[4], rdcarray<uint32_t> &histogram) = 0;
+  // fetches the min/max and a histogram over [histMin, histMax] together. Drivers that can build
+  // both from a single pass over the texture override this, otherwise it's the two calls above.
+  virtual bool GetMinMaxHistogram(ResourceId texid, const Subresource &sub, CompType typeCast,
+                                  float histMin, float histMax, bool channels[4], float *minval,
+                                  float *maxval, rdcarray<uint32_t> &histogram)
+  {
+    bool ret = GetMinMax(texid, sub, typeCast, minval, maxval);
+    ret &= GetHistogram(texid, sub, typeCast, histMin, histMax, channels, histogram);
+    return ret;
+  }
   virtual void PickPixel(ResourceId texture, uint32_t x, uint32_t y, const Subresource &sub,
                          CompType typeCast, float pixel[4]) = 0;
 
@@ -274,6 +310,15 @@ struct IDeviceProtocolHandler : public IDeviceProtocolController
   virtual rdcstr RemapHostname(const rdcstr &deviceID) = 0;
   virtual uint16_t RemapPort(const rdcstr &deviceID, uint16_t srcPort) = 0;
   virtual IRemoteServer *CreateRemoteServer(Network::Socket *sock, const rdcstr &deviceID) = 0;
+
+  // some devices can copy files from them directly, more quickly than they can be sent across a
+  // forwarded connection. PullFile returns false if the copy failed and should be done another way.
+  virtual bool CanPullFiles(const rdcstr &deviceID) { return false; }
+  virtual bool PullFile(const rdcstr &deviceID, const rdcstr &remotePath, const rdcstr &localPath,
+                        uint64_t totalSize, RENDERDOC_ProgressCallback progress)
+  {
+    return false;
+  }
 };
 
 // utility functions useful in any driver implementation
@@ -289,12 +334,84 @@ void PatchTriangleFanRestartIndexBufer(rdcarray<uint32_t> &patchedIndices, uint3
 
 uint64_t CalcMeshOutputSize(uint64_t curSize, uint64_t requiredOutput);
 
+// an estimate of the memory held by a shader's reflection, including its bytecode and source
+uint64_t EstimateReflectionSize(const ShaderReflection &refl);
+
+// accumulates the cost of each chunk type while a driver processes chunks in
+// ReadLogInitialisation, for FrameDescription::loadStatistics. Times are in milliseconds as they
+// come from PerformanceTimer and are converted to seconds when baked.
+class ChunkLoadRecorder
+{
+public:
+  void Record(uint32_t chunkID, uint64_t byteSize, double cpuMS, double gpuWaitMS);
+  uint64_t GetTotalSize(uint32_t chunkID) const;
+
+  // returns the statistics sorted with the most expensive chunk type first
+  rdcarray<ChunkLoadStatistics> Bake(rdcstr (*getChunkName)(uint32_t)) const;
+
+private:
+  std::map<uint32_t, ChunkLoadStatistics> m_Stats;
+};
+
 void StandardFillCBufferVariable(ResourceId shader, const ShaderVariableDescriptor &desc,
                                  uint32_t dataOffset, const bytebuf &data, ShaderVariable &outvar,
                                  uint32_t matStride);
 void StandardFillCBufferVariables(ResourceId shader, const rdcarray<ShaderConstant> &invars,
                                   rdcarray<ShaderVariable> &outvars, const bytebuf &data);
 
+// caches the result of walking a constant block's reflection, so that the UI re-fetching the same
+// cbuffer at every event only copies the variable tree and fills in the leaf values. A plan is
+// keyed on everything that can change the reflection a driver returns, and reflection for a given
+// key never changes so the cache doesn't need invalidating.
+class CBufferLayoutCache
+{
+public:
+  // equivalent to StandardFillCBufferVariables(reflId, invars, outvars, data)
+  void Fill(ResourceId pipeline, ResourceId shader, const rdcstr &entryPoint, uint32_t cbufSlot,
+            ResourceId reflId, const rdcarray<ShaderConstant> &invars,
+            rdcarray<ShaderVariable> &outvars, const bytebuf &data);
+
+private:
+  struct Key
+  {
+    ResourceId pipeline, shader;
+    rdcstr entryPoint;
+    uint32_t cbufSlot;
+
+    bool operator<(const Key &o) const
+    {
+      if(pipeline != o.pipeline)
+        return pipeline < o.pipeline;
+      if(shader != o.shader)
+        return shader < o.shader;
+      if(cbufSlot != o.cbufSlot)
+        return cbufSlot < o.cbufSlot;
+      return entryPoint < o.entryPoint;
+    }
+  };
+
+  struct LeafFill
+  {
+    ShaderVariableDescriptor desc;
+    uint32_t dataOffset;
+  };
+
+  struct Plan
+  {
+    // the variable tree with all values zeroed
+    rdcarray<ShaderVariable> vars;
+    // one entry for every leaf variable in vars, in depth-first order
+    rdcarray<LeafFill> leaves;
+  };
+
+  static void BuildPlan(const rdcarray<ShaderConstant> &invars, uint32_t baseOffset,
+                        rdcarray<ShaderVariable> &outvars, rdcarray<LeafFill> &leaves);
+  static void ApplyPlan(ResourceId reflId, const rdcarray<LeafFill> &leaves, size_t &leafIdx,
+                        ShaderVariable *vars, size_t numVars, const bytebuf &data);
+
+  std::map<Key, Plan> m_Plans;
+};
+
 // simple cache for when we need buffer data for highlighting
 // vertices, typical use will be lots of vertices in the same
 // mesh, not jumping back and forth much between meshes.
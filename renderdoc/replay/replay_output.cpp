@@ -202,6 +202,13 @@ void ReplayOutput::SetMeshDisplay(const MeshDisplay &o)
 
   if(o.showWholePass != m_RenderData.meshDisplay.showWholePass)
     m_OverlayDirty = true;
+
+  const MeshDisplay &prev = m_RenderData.meshDisplay;
+  if(o.showWholePass != prev.showWholePass || o.showPrevInstances != prev.showPrevInstances ||
+     o.showAllInstances != prev.showAllInstances || o.curInstance != prev.curInstance ||
+     o.curView != prev.curView || o.type != prev.type)
+    m_SecondaryDrawsDirty = true;
+
   m_RenderData.meshDisplay = o;
   m_MainOutput.dirty = true;
 }
@@ -210,17 +217,92 @@ void ReplayOutput::SetFrameEvent(int eventId)
 {
   CHECK_REPLAY_THREAD();
 
+  uint32_t prevEventID = m_EventID;
+
   m_EventID = eventId;
 
   m_OverlayDirty = (m_RenderData.texDisplay.overlay != DebugOverlay::NoOverlay);
   m_MainOutput.dirty = true;
+  m_SecondaryDrawsDirty = true;
 
+  // thumbnails only need to be re-rendered if their contents could have changed. If we're
+  // re-replaying the same event then something else changed (e.g. a resource replacement) so
+  // refresh everything
   for(size_t i = 0; i < m_Thumbnails.size(); i++)
-    m_Thumbnails[i].dirty = true;
+  {
+    if(prevEventID == m_EventID ||
+       ThumbnailWrittenBetween(m_Thumbnails[i].texture, prevEventID, m_EventID))
+      m_Thumbnails[i].dirty = true;
+  }
 
   RefreshOverlay();
 }
 
+bool ReplayOutput::ThumbnailWrittenBetween(ResourceId texture, uint32_t eventA, uint32_t eventB)
+{
+  CHECK_REPLAY_THREAD();
+
+  if(texture == ResourceId())
+    return false;
+
+  auto it = m_ThumbnailWrites.find(texture);
+
+  if(it == m_ThumbnailWrites.end())
+  {
+    rdcarray<uint32_t> &writes = m_ThumbnailWrites[texture];
+
+    rdcarray<EventUsage> usage = m_pDevice->GetUsage(m_pDevice->GetLiveID(texture));
+
+    for(const EventUsage &u : usage)
+    {
+      switch(u.usage)
+      {
+        case ResourceUsage::VertexBuffer:
+        case ResourceUsage::IndexBuffer:
+        case ResourceUsage::VS_Constants:
+        case ResourceUsage::HS_Constants:
+        case ResourceUsage::DS_Constants:
+        case ResourceUsage::GS_Constants:
+        case ResourceUsage::PS_Constants:
+        case ResourceUsage::CS_Constants:
+        case ResourceUsage::All_Constants:
+        case ResourceUsage::VS_Resource:
+        case ResourceUsage::HS_Resource:
+        case ResourceUsage::DS_Resource:
+        case ResourceUsage::GS_Resource:
+        case ResourceUsage::PS_Resource:
+        case ResourceUsage::CS_Resource:
+        case ResourceUsage::All_Resource:
+        case ResourceUsage::InputTarget:
+        case ResourceUsage::CopySrc:
+        case ResourceUsage::ResolveSrc:
+        case ResourceUsage::Indirect:
+          // read-only, contents can't change
+          continue;
+
+        // anything else is conservatively treated as a write, including barriers which may
+        // transition or discard contents
+        default: writes.push_back(u.eventId); break;
+      }
+    }
+
+    std::sort(writes.begin(), writes.end());
+
+    it = m_ThumbnailWrites.find(texture);
+  }
+
+  const rdcarray<uint32_t> &writes = it->second;
+
+  // the contents at an event include that event's writes, so moving from A to B is only visible
+  // if there's a write in (min(A,B), max(A,B)]
+  uint32_t lo = RDCMIN(eventA, eventB);
+  uint32_t hi = RDCMAX(eventA, eventB);
+
+  const uint32_t *firstAfter = std::upper_bound(writes.begin(), writes.end(), lo);
+
+  return firstAfter != writes.end() && *firstAfter <= hi;
+}
+
 void ReplayOutput::RefreshOverlay()
 {
   CHECK_REPLAY_THREAD();
@@ -310,6 +392,23 @@ ResourceId ReplayOutput::GetDebugOverlayTexID()
   return m_OverlayResourceId;
 }
 
+rdcarray<OverdrawStatistics> ReplayOutput::GetOverdrawStatistics()
+{
+  CHECK_REPLAY_THREAD();
+
+  if(m_RenderData.texDisplay.overlay != DebugOverlay::QuadOverdrawPass &&
+     m_RenderData.texDisplay.overlay != DebugOverlay::QuadOverdrawDraw)
+    return {};
+
+  // make sure the statistics are for the current overlay
+  GetDebugOverlayTexID();
+
+  if(m_OverlayResourceId == ResourceId())
+    return {};
+
+  return m_pDevice->GetOverdrawStatistics();
+}
+
 void ReplayOutput::ClearThumbnails()
 {
   CHECK_REPLAY_THREAD();
@@ -358,11 +457,16 @@ bool ReplayOutput::AddThumbnail(WindowingData window, ResourceId texID, const Su
   {
     if(m_Thumbnails[i].wndHandle == GetHandle(window))
     {
+      // the UI re-sets every thumbnail on each event change, so only re-render if the displayed
+      // texture actually changed. Changes in contents are handled in SetFrameEvent
+      if(m_Thumbnails[i].texture != texID || m_Thumbnails[i].depthMode != depthMode ||
+         m_Thumbnails[i].sub != sub || m_Thumbnails[i].typeCast != typeCast)
+        m_Thumbnails[i].dirty = true;
+
       m_Thumbnails[i].texture = texID;
       m_Thumbnails[i].depthMode = depthMode;
       m_Thumbnails[i].sub = sub;
       m_Thumbnails[i].typeCast = typeCast;
-      m_Thumbnails[i].dirty = true;
 
       return true;
     }
@@ -792,7 +896,7 @@ void ReplayOutput::DisplayMesh()
   mesh.second.vertexResourceId = m_pDevice->GetLiveID(mesh.second.vertexResourceId);
   mesh.second.indexResourceId = m_pDevice->GetLiveID(mesh.second.indexResourceId);
 
-  rdcarray<MeshFormat> secondaryDraws;
+  rdcarray<MeshFormat> &secondaryDraws = m_SecondaryDraws;
 
   // we choose a pallette here so that the colours stay consistent (i.e the
   // current draw is always the same colour), but also to indicate somewhat
@@ -815,7 +919,20 @@ void ReplayOutput::DisplayMesh()
     passDraws = FloatVector(0.4f, 0.4f, 0.45f, 1.0f);
   }
 
-  if(m_RenderData.meshDisplay.type != MeshDataStage::VSIn)
+  // the colours are baked into the cached draws
+  if(RenderDoc::Inst().IsDarkTheme() != m_SecondaryDrawsDarkTheme)
+    m_SecondaryDrawsDirty = true;
+
+  bool refreshSecondary = m_SecondaryDrawsDirty;
+
+  if(refreshSecondary)
+  {
+    secondaryDraws.clear();
+    m_SecondaryDrawsDirty = false;
+    m_SecondaryDrawsDarkTheme = RenderDoc::Inst().IsDarkTheme();
+  }
+
+  if(refreshSecondary && m_RenderData.meshDisplay.type != MeshDataStage::VSIn)
   {
     for(size_t i = 0; m_RenderData.meshDisplay.showWholePass && i < passEvents.size(); i++)
     {
@@ -0,0 +1,300 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019-2020 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include <map>
+#include "api/replay/structured_data.h"
+#include "common/common.h"
+#include "serialise/rdcfile.h"
+#include "serialise/zstdio.h"
+
+// Columnar binary export, intended for bulk analysis of capture contents rather than for
+// re-importing. Layout:
+//
+// uncompressed header:
+//   char magic[4] = "RDCC"
+//   uint32_t formatVersion
+//   uint64_t sdfileVersion
+//   uint32_t numChunks
+//
+// followed by a zstd-compressed stream containing:
+//   uint32_t numStrings, then per string: uint32_t length, char data[length]
+//   uint32_t numTables, then per table (one per distinct chunk name):
+//     uint32_t name        (string index)
+//     uint32_t numRows
+//     uint32_t chunkIndex[numRows]
+//     uint32_t chunkID[numRows]
+//     uint64_t threadID[numRows]
+//     uint64_t timestamp[numRows]
+//     uint64_t duration[numRows]
+//     uint32_t numColumns, then per column:
+//       uint32_t path      (string index, members joined with '.' and array elements as "[]")
+//       uint32_t basetype  (SDBasic)
+//       uint32_t count[numRows]   number of values this row has in the column
+//       uint64_t numValues
+//       uint64_t values[numValues]
+//
+// Every leaf value is stored as 64 bits: integers and resource IDs as-is, floats as doubles, and
+// strings and enums as an index into the string dictionary. Buffers store their buffer index.
+// Scalars have count 1 or 0 if the member was absent, arrays have one value per element.
+
+static const uint32_t ColumnarFormatVersion = 1;
+
+struct ColumnarColumn
+{
+  uint32_t path;
+  SDBasic type;
+  rdcarray<uint32_t> counts;
+  rdcarray<uint64_t> values;
+};
+
+struct ColumnarTable
+{
+  uint32_t name;
+  rdcarray<uint32_t> chunkIndex;
+  rdcarray<uint32_t> chunkID;
+  rdcarray<uint64_t> threadID;
+  rdcarray<uint64_t> timestamp;
+  rdcarray<uint64_t> duration;
+
+  rdcarray<ColumnarColumn> columns;
+  // keyed by path with the basetype appended, so a path seen with different types (e.g. unions)
+  // gets distinct columns.
+  std::map<rdcstr, size_t> columnLookup;
+};
+
+struct ColumnarBuilder
+{
+  rdcarray<rdcstr> strings;
+  std::map<rdcstr, uint32_t> stringLookup;
+
+  rdcarray<ColumnarTable> tables;
+  std::map<rdcstr, size_t> tableLookup;
+
+  // scratch path for the current leaf, appended to and truncated as we recurse
+  rdcstr path;
+
+  uint32_t GetString(const rdcstr &str)
+  {
+    auto it = stringLookup.find(str);
+    if(it != stringLookup.end())
+      return it->second;
+
+    uint32_t idx = (uint32_t)strings.size();
+    strings.push_back(str);
+    stringLookup[str] = idx;
+    return idx;
+  }
+
+  void AddChunk(uint32_t index, const SDChunk *chunk)
+  {
+    auto it = tableLookup.find(chunk->name);
+    if(it == tableLookup.end())
+    {
+      it = tableLookup.insert(std::make_pair(chunk->name, tables.size())).first;
+      tables.push_back(ColumnarTable());
+      tables.back().name = GetString(chunk->name);
+    }
+
+    ColumnarTable &table = tables[it->second];
+
+    table.chunkIndex.push_back(index);
+    table.chunkID.push_back(chunk->metadata.chunkID);
+    table.threadID.push_back(chunk->metadata.threadID);
+    table.timestamp.push_back((uint64_t)chunk->metadata.timestampMicro);
+    table.duration.push_back((uint64_t)chunk->metadata.durationMicro);
+
+    const size_t row = table.chunkIndex.size() - 1;
+
+    for(size_t c = 0; c < chunk->NumChildren(); c++)
+    {
+      const SDObject *child = chunk->GetChild(c);
+      path = child->name;
+      AddObject(table, row, child);
+    }
+  }
+
+  void AddObject(ColumnarTable &table, size_t row, const SDObject *obj)
+  {
+    switch(obj->type.basetype)
+    {
+      case SDBasic::Chunk:
+      case SDBasic::Struct:
+      {
+        const size_t len = path.size();
+        for(size_t c = 0; c < obj->NumChildren(); c++)
+        {
+          const SDObject *child = obj->GetChild(c);
+          path.push_back('.');
+          path += child->name;
+          AddObject(table, row, child);
+          path.resize(len);
+        }
+        return;
+      }
+      case SDBasic::Array:
+      {
+        const size_t len = path.size();
+        path += "[]";
+        for(size_t c = 0; c < obj->NumChildren(); c++)
+          AddObject(table, row, obj->GetChild(c));
+        path.resize(len);
+        return;
+      }
+      case SDBasic::Null: return;
+      default: break;
+    }
+
+    uint64_t value = 0;
+
+    switch(obj->type.basetype)
+    {
+      case SDBasic::String:
+      case SDBasic::Enum: value = GetString(obj->data.str); break;
+      case SDBasic::Float: memcpy(&value, &obj->data.basic.d, sizeof(value)); break;
+      case SDBasic::Boolean: value = obj->data.basic.b ? 1 : 0; break;
+      case SDBasic::Character: value = (uint64_t)(byte)obj->data.basic.c; break;
+      // buffers store their index in u, resources share storage with u too
+      default: value = obj->data.basic.u; break;
+    }
+
+    ColumnarColumn &col = GetColumn(table, obj->type.basetype);
+    col.counts.resize(row + 1);
+    col.counts[row]++;
+    col.values.push_back(value);
+  }
+
+  ColumnarColumn &GetColumn(ColumnarTable &table, SDBasic type)
+  {
+    const size_t len = path.size();
+    path.push_back(char('A' + (uint32_t)type));
+
+    auto it = table.columnLookup.find(path);
+    if(it == table.columnLookup.end())
+    {
+      it = table.columnLookup.insert(std::make_pair(path, table.columns.size())).first;
+      path.resize(len);
+
+      table.columns.push_back(ColumnarColumn());
+      table.columns.back().path = GetString(path);
+      table.columns.back().type = type;
+    }
+    else
+    {
+      path.resize(len);
+    }
+
+    return table.columns[it->second];
+  }
+};
+
+template <typename T>
+static void WriteArray(StreamWriter *writer, const rdcarray<T> &arr)
+{
+  writer->Write(arr.data(), arr.byteSize());
+}
+
+ReplayStatus exportColumnar(const char *filename, const RDCFile &rdc, const SDFile &structData,
+                            RENDERDOC_ProgressCallback progress)
+{
+  FILE *f = FileIO::fopen(filename, "wb");
+
+  if(!f)
+    return ReplayStatus::FileIOFailed;
+
+  ColumnarBuilder builder;
+
+  const uint32_t numChunks = (uint32_t)structData.chunks.size();
+
+  for(uint32_t i = 0; i < numChunks; i++)
+  {
+    builder.AddChunk(i, structData.chunks[i]);
+
+    if(progress && (i % 1024) == 0)
+      progress(0.5f * float(i) / float(numChunks));
+  }
+
+  StreamWriter *fileWriter = new StreamWriter(f, Ownership::Stream);
+
+  fileWriter->Write("RDCC", 4);
+  fileWriter->Write(ColumnarFormatVersion);
+  fileWriter->Write(structData.version);
+  fileWriter->Write(numChunks);
+
+  StreamWriter writer(new ZSTDCompressor(fileWriter, Ownership::Stream), Ownership::Stream);
+
+  writer.Write((uint32_t)builder.strings.size());
+  for(const rdcstr &s : builder.strings)
+  {
+    writer.Write((uint32_t)s.size());
+    writer.Write(s.c_str(), s.size());
+  }
+
+  writer.Write((uint32_t)builder.tables.size());
+  for(size_t t = 0; t < builder.tables.size(); t++)
+  {
+    ColumnarTable &table = builder.tables[t];
+
+    const uint32_t numRows = (uint32_t)table.chunkIndex.size();
+
+    writer.Write(table.name);
+    writer.Write(numRows);
+    WriteArray(&writer, table.chunkIndex);
+    WriteArray(&writer, table.chunkID);
+    WriteArray(&writer, table.threadID);
+    WriteArray(&writer, table.timestamp);
+    WriteArray(&writer, table.duration);
+
+    writer.Write((uint32_t)table.columns.size());
+    for(ColumnarColumn &col : table.columns)
+    {
+      // rows after the last one that had a value in this column won't have been filled yet
+      col.counts.resize(numRows);
+
+      writer.Write(col.path);
+      writer.Write((uint32_t)col.type);
+      WriteArray(&writer, col.counts);
+      writer.Write((uint64_t)col.values.size());
+      WriteArray(&writer, col.values);
+    }
+
+    if(progress)
+      progress(0.5f + 0.5f * float(t) / float(builder.tables.size()));
+  }
+
+  writer.Finish();
+
+  if(progress)
+    progress(1.0f);
+
+  return writer.IsErrored() ? ReplayStatus::FileIOFailed : ReplayStatus::Succeeded;
+}
+
+static ConversionRegistration ColumnarConversionRegistration(
+    &exportColumnar,
+    {
+        "columnar.rdcc", "Columnar binary structured data",
+        R"(Exports the structured data as compressed per-chunk-type tables with dictionary encoded
+strings. Intended for bulk analysis of capture contents, it cannot be imported.)",
+        false,
+    });
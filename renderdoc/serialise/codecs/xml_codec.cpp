@@ -154,21 +154,42 @@ static void HexEncode(const bytebuf &in, rdcstr &out)
 
 static void HexDecode(const char *str, const char *end, bytebuf &out)
 {
-  out.reserve((end - str) / 2);
+  // lookup from character to nibble value, with 0xff for non-hex characters. This lets us check and
+  // decode a pair of characters with two loads instead of a chain of range compares each.
+  static const struct HexTable
+  {
+    HexTable()
+    {
+      memset(nibble, 0xff, sizeof(nibble));
+      for(int c = 0; c < 256; c++)
+        if(IsHex((char)c))
+          nibble[c] = FromHex((char)c);
+    }
+    byte nibble[256];
+  } table;
 
-  if(str[0] == '\n')
+  if(str < end && str[0] == '\n')
     str++;
 
+  // the output is never larger than half the input, so size it up-front and write directly rather
+  // than pushing back one byte at a time.
+  out.resize((end - str) / 2);
+  byte *dst = out.data();
+
   while(str + 1 < end)
   {
-    if(IsHex(str[0]) && IsHex(str[1]))
+    const byte hi = table.nibble[(byte)str[0]];
+    const byte lo = table.nibble[(byte)str[1]];
+
+    // both nibbles are valid only if neither has any high bits set
+    if((hi | lo) < 0x10)
     {
-      out.push_back(byte((FromHex(str[0]) << 4) | FromHex(str[1])));
+      *(dst++) = byte((hi << 4) | lo);
 
       str += 2;
 
       // allow a space after hex, as a byte group
-      if(str[0] == ' ')
+      if(str < end && str[0] == ' ')
         str++;
 
       // if we encounter more spaces though, it indicates the end of a line.
@@ -177,16 +198,15 @@ static void HexDecode(const char *str, const char *end, bytebuf &out)
     {
       // on the first non-hex char we encounter, skip to the next newline. This might do nothing if
       // the char itself was a newline.
-      while(str[0] != '\n' && str < end)
-        str++;
+      const char *nl = (const char *)memchr(str, '\n', end - str);
 
-      // the loop above terminates in two ways - when it encounters a newline or when it reaches the
-      // end of the string. We can just assume we encountered a newline and increment past it - if
-      // we're already past the end, going further past will still make us fail the loop condition
-      // and terminate.
-      str++;
+      // if there's no further newline we've reached the end of the string. Otherwise increment
+      // past the newline and continue.
+      str = nl ? nl + 1 : end;
     }
   }
+
+  out.resize(dst - out.data());
 }
 
 static void Obj2XML(pugi::xml_node &parent, SDObject &child)
@@ -320,7 +340,8 @@ static ReplayStatus Structured2XML(const char *filename, const RDCFile &file, ui
   {
     const SectionProperties &props = file.GetSectionProperties(i);
 
-    if(props.type == SectionType::FrameCapture)
+    // the seek table is tied to the compressed frame capture and is regenerated when it's written
+    if(props.type == SectionType::FrameCapture || props.type == SectionType::SeekTable)
       continue;
 
     StreamReader *reader = file.ReadSection(i);
@@ -363,6 +384,8 @@ static ReplayStatus Structured2XML(const char *filename, const RDCFile &file, ui
       xSection.append_attribute("lz4");
     if(props.flags & SectionFlags::ZstdCompressed)
       xSection.append_attribute("zstd");
+    if(props.flags & SectionFlags::ZstdDictionary)
+      xSection.append_attribute("zstddict");
 
     pugi::xml_node name = xSection.append_child("name");
     name.text() = props.name.c_str();
@@ -399,13 +422,29 @@ static ReplayStatus Structured2XML(const char *filename, const RDCFile &file, ui
   if(progress)
     progress(StructuredProgress(0.2f));
 
-  pugi::xml_node xChunks = xRoot.append_child("chunks");
+  xml_file_writer writer(filename);
 
-  xChunks.append_attribute("version") = version;
+  // the header and sections are small, so write them out through the document. The chunks can be
+  // many times larger than the capture itself once expanded to XML, so instead of building them
+  // all into the document each chunk is built on its own, written and then freed. The output is
+  // the same as saving the whole document at once.
+  rdcstr rootOpen = "<?xml version=\"1.0\"?>\n<rdc>\n";
+  writer.write(rootOpen.c_str(), rootOpen.size());
+
+  for(pugi::xml_node child = xRoot.first_child(); child; child = child.next_sibling())
+    child.print(writer, "\t", pugi::format_default, pugi::encoding_auto, 1);
+
+  doc.reset();
+
+  rdcstr chunksOpen = StringFormat::Fmt("\t<chunks version=\"%llu\"%s>\n", version,
+                                        chunks.empty() ? " /" : "");
+  writer.write(chunksOpen.c_str(), chunksOpen.size());
 
   for(size_t c = 0; c < chunks.size(); c++)
   {
-    pugi::xml_node xChunk = xChunks.append_child("chunk");
+    pugi::xml_document chunkDoc;
+
+    pugi::xml_node xChunk = chunkDoc.append_child("chunk");
     SDChunk *chunk = chunks[c];
 
     xChunk.append_attribute("id") = chunk->metadata.chunkID;
@@ -442,12 +481,14 @@ static ReplayStatus Structured2XML(const char *filename, const RDCFile &file, ui
         Obj2XML(xChunk, *chunk->data.children[o]);
     }
 
+    xChunk.print(writer, "\t", pugi::format_default, pugi::encoding_auto, 2);
+
     if(progress)
       progress(StructuredProgress(0.2f + 0.8f * (float(c) / float(chunks.size()))));
   }
 
-  xml_file_writer writer(filename);
-  doc.save(writer);
+  rdcstr rootClose = chunks.empty() ? "</rdc>\n" : "\t</chunks>\n</rdc>\n";
+  writer.write(rootClose.c_str(), rootClose.size());
 
   return writer.stream.IsErrored() ? ReplayStatus::FileIOFailed : ReplayStatus::Succeeded;
 }
@@ -545,14 +586,16 @@ static SDObject *XML2Obj(pugi::xml_node &obj)
   return ret;
 }
 
-static ReplayStatus XML2Structured(const char *xml, const ThumbTypeAndData &thumb,
+static ReplayStatus XML2Structured(rdcstr &xml, const ThumbTypeAndData &thumb,
                                    const ThumbTypeAndData &extThumb,
                                    const StructuredBufferList &buffers, RDCFile *rdc,
                                    uint64_t &version, StructuredChunkList &chunks,
                                    RENDERDOC_ProgressCallback progress)
 {
   pugi::xml_document doc;
-  doc.load_string(xml);
+  // parse in-place so pugixml references the text directly instead of taking a second copy of what
+  // may be a very large document.
+  doc.load_buffer_inplace(xml.data(), xml.size());
 
   pugi::xml_node root = doc.child("rdc");
 
@@ -651,6 +694,8 @@ static ReplayStatus XML2Structured(const char *xml, const ThumbTypeAndData &thum
       props.flags |= SectionFlags::LZ4Compressed;
     if(xSection.attribute("zstd"))
       props.flags |= SectionFlags::ZstdCompressed;
+    if(xSection.attribute("zstddict"))
+      props.flags |= SectionFlags::ZstdDictionary;
 
     pugi::xml_node name = xSection.child("name");
     if(!name)
@@ -731,7 +776,7 @@ static ReplayStatus XML2Structured(const char *xml, const ThumbTypeAndData &thum
   size_t chunkIdx = 0;
   size_t numChunks = std::distance(xChunks.begin(), xChunks.end());
 
-  for(pugi::xml_node xChunk = xChunks.first_child(); xChunk; xChunk = xChunk.next_sibling())
+  for(pugi::xml_node xChunk = xChunks.first_child(); xChunk; xChunk = xChunks.first_child())
   {
     if(strcmp(xChunk.name(), "chunk") != 0)
       return ReplayStatus::FileCorrupted;
@@ -779,6 +824,10 @@ static ReplayStatus XML2Structured(const char *xml, const ThumbTypeAndData &thum
 
     chunks.push_back(chunk);
 
+    // each chunk is only visited once, so release its nodes as soon as it's converted. This keeps
+    // the DOM from staying fully resident alongside the structured data we're building.
+    xChunks.remove_child(xChunk);
+
     if(progress)
       progress(StructuredProgress(0.2f + 0.8f * (float(chunkIdx) / float(numChunks))));
 
@@ -959,7 +1008,7 @@ ReplayStatus importXMLZ(const char *filename, StreamReader &reader, RDCFile *rdc
   buf.resize((size_t)reader.GetSize());
   reader.Read(buf.data(), buf.size());
 
-  return XML2Structured(buf.c_str(), thumb, extThumb, structData.buffers, rdc, structData.version,
+  return XML2Structured(buf, thumb, extThumb, structData.buffers, rdc, structData.version,
                         structData.chunks, progress);
 }
 
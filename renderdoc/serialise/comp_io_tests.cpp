@@ -190,4 +190,488 @@ TEST_CASE("Test ZSTD compression/decompression", "[streamio][zstd]")
   delete[] randomData;
 };
 
+TEST_CASE("Test parallel compression is readable by regular decompressors", "[streamio]")
+{
+  const uint64_t dataSize = 8 * 1024 * 1024 + 1234;
+
+  byte *inputData = new byte[(size_t)dataSize];
+
+  // mix of compressible and incompressible data, in runs that don't line up with block sizes
+  for(uint64_t i = 0; i < dataSize; i++)
+    inputData[i] = ((i / 100000) % 2) ? (rand() & 0xff) : byte(i & 0x3f);
+
+  byte *readData = new byte[(size_t)dataSize];
+
+  SECTION("LZ4")
+  {
+    StreamWriter buf(StreamWriter::DefaultScratchSize);
+
+    {
+      StreamWriter writer(new LZ4Compressor(&buf, Ownership::Nothing, 4), Ownership::Stream);
+
+      // write in uneven pieces so writes straddle page and batch boundaries
+      for(uint64_t offs = 0; offs < dataSize; offs += 77777)
+        writer.Write(inputData + offs, RDCMIN<uint64_t>(77777, dataSize - offs));
+
+      CHECK(writer.GetOffset() == dataSize);
+
+      writer.Finish();
+
+      CHECK_FALSE(writer.IsErrored());
+    }
+
+    CHECK(buf.GetOffset() < dataSize);
+
+    StreamReader reader(
+        new LZ4Decompressor(new StreamReader(buf.GetData(), buf.GetOffset()), Ownership::Stream),
+        dataSize, Ownership::Stream);
+
+    reader.Read(readData, dataSize);
+
+    CHECK_FALSE(reader.IsErrored());
+    CHECK(reader.AtEnd());
+    CHECK_FALSE(memcmp(readData, inputData, (size_t)dataSize));
+  };
+
+  SECTION("ZSTD")
+  {
+    StreamWriter buf(StreamWriter::DefaultScratchSize);
+
+    {
+      StreamWriter writer(new ZSTDCompressor(&buf, Ownership::Nothing, 4), Ownership::Stream);
+
+      for(uint64_t offs = 0; offs < dataSize; offs += 77777)
+        writer.Write(inputData + offs, RDCMIN<uint64_t>(77777, dataSize - offs));
+
+      CHECK(writer.GetOffset() == dataSize);
+
+      writer.Finish();
+
+      CHECK_FALSE(writer.IsErrored());
+    }
+
+    CHECK(buf.GetOffset() < dataSize);
+
+    StreamReader reader(
+        new ZSTDDecompressor(new StreamReader(buf.GetData(), buf.GetOffset()), Ownership::Stream),
+        dataSize, Ownership::Stream);
+
+    reader.Read(readData, dataSize);
+
+    CHECK_FALSE(reader.IsErrored());
+    CHECK(reader.AtEnd());
+    CHECK_FALSE(memcmp(readData, inputData, (size_t)dataSize));
+  };
+
+  SECTION("Sections smaller than a batch")
+  {
+    // these only ever fill part of the batch storage, which grows a page at a time
+    const uint64_t sizes[] = {0, 100, 64 * 1024, 64 * 1024 + 1, 300 * 1024, 1024 * 1024 + 5};
+
+    for(uint64_t size : sizes)
+    {
+      for(int zstd = 0; zstd < 2; zstd++)
+      {
+        StreamWriter buf(StreamWriter::DefaultScratchSize);
+
+        Compressor *comp = NULL;
+        Decompressor *decomp = NULL;
+
+        if(zstd)
+          comp = new ZSTDCompressor(&buf, Ownership::Nothing, 4);
+        else
+          comp = new LZ4Compressor(&buf, Ownership::Nothing, 4);
+
+        {
+          StreamWriter writer(comp, Ownership::Stream);
+          writer.Write(inputData, size);
+          writer.Finish();
+
+          CHECK_FALSE(writer.IsErrored());
+        }
+
+        StreamReader *compReader = new StreamReader(buf.GetData(), buf.GetOffset());
+
+        if(zstd)
+          decomp = new ZSTDDecompressor(compReader, Ownership::Stream);
+        else
+          decomp = new LZ4Decompressor(compReader, Ownership::Stream);
+
+        StreamReader reader(decomp, size, Ownership::Stream);
+
+        reader.Read(readData, size);
+
+        CHECK_FALSE(reader.IsErrored());
+        CHECK(reader.AtEnd());
+        CHECK_FALSE(memcmp(readData, inputData, (size_t)size));
+      }
+    }
+  };
+
+  delete[] readData;
+  delete[] inputData;
+};
+
+TEST_CASE("Test seeking in compressed streams with a seek table", "[streamio]")
+{
+  const uint64_t dataSize = 4 * 1024 * 1024 + 4321;
+
+  byte *inputData = new byte[(size_t)dataSize];
+
+  for(uint64_t i = 0; i < dataSize; i++)
+    inputData[i] = byte((i * 7) ^ (i >> 11));
+
+  StreamWriter buf(StreamWriter::DefaultScratchSize);
+  BlockSeekTable table;
+
+  bool lz4 = false;
+
+  SECTION("LZ4")
+  {
+    lz4 = true;
+  };
+
+  SECTION("ZSTD")
+  {
+    lz4 = false;
+  };
+
+  {
+    Compressor *comp = NULL;
+    if(lz4)
+      comp = new LZ4Compressor(&buf, Ownership::Nothing, 4);
+    else
+      comp = new ZSTDCompressor(&buf, Ownership::Nothing);
+
+    StreamWriter writer(comp, Ownership::Stream);
+
+    writer.Write(inputData, dataSize);
+    writer.Finish();
+
+    CHECK_FALSE(writer.IsErrored());
+
+    REQUIRE(comp->HasSeekTable());
+    table = comp->GetSeekTable();
+  }
+
+  CHECK(table.blockOffsets.size() == (dataSize + table.blockSize - 1) / table.blockSize);
+
+  Decompressor *decomp = NULL;
+  if(lz4)
+    decomp = new LZ4Decompressor(new StreamReader(buf.GetData(), buf.GetOffset()), Ownership::Stream);
+  else
+    decomp = new ZSTDDecompressor(new StreamReader(buf.GetData(), buf.GetOffset()), Ownership::Stream);
+
+  decomp->SetSeekTable(table);
+
+  StreamReader reader(decomp, dataSize, Ownership::Stream);
+
+  byte readData[1024];
+
+  // read a little from the start
+  reader.Read(readData, 100);
+  CHECK_FALSE(memcmp(readData, inputData, 100));
+
+  // skip far ahead, landing mid-block
+  reader.SkipBytes(3 * 1024 * 1024 + 12345);
+  uint64_t offs = reader.GetOffset();
+  CHECK(offs == 3 * 1024 * 1024 + 12345 + 100);
+  reader.Read(readData, 1024);
+  CHECK_FALSE(memcmp(readData, inputData + offs, 1024));
+
+  // jump back to an earlier offset
+  reader.SetOffset(777777);
+  CHECK(reader.GetOffset() == 777777);
+  reader.Read(readData, 1024);
+  CHECK_FALSE(memcmp(readData, inputData + 777777, 1024));
+
+  // and read up to the end across the final partial block
+  reader.SetOffset(dataSize - 1000);
+  reader.Read(readData, 1000);
+  CHECK_FALSE(memcmp(readData, inputData + dataSize - 1000, 1000));
+
+  CHECK_FALSE(reader.IsErrored());
+  CHECK(reader.AtEnd());
+
+  delete[] inputData;
+};
+
+TEST_CASE("Test failed seeks in compressed streams", "[streamio]")
+{
+  const uint64_t dataSize = 2 * 1024 * 1024 + 4321;
+
+  byte *inputData = new byte[(size_t)dataSize];
+
+  for(uint64_t i = 0; i < dataSize; i++)
+    inputData[i] = byte((i * 7) ^ (i >> 11));
+
+  StreamWriter buf(StreamWriter::DefaultScratchSize);
+  BlockSeekTable table;
+
+  bool lz4 = false;
+
+  SECTION("LZ4")
+  {
+    lz4 = true;
+  };
+
+  SECTION("ZSTD")
+  {
+    lz4 = false;
+  };
+
+  {
+    Compressor *comp = NULL;
+    if(lz4)
+      comp = new LZ4Compressor(&buf, Ownership::Nothing, 4);
+    else
+      comp = new ZSTDCompressor(&buf, Ownership::Nothing);
+
+    StreamWriter writer(comp, Ownership::Stream);
+
+    writer.Write(inputData, dataSize);
+    writer.Finish();
+
+    REQUIRE(comp->HasSeekTable());
+    table = comp->GetSeekTable();
+  }
+
+  REQUIRE(table.blockOffsets.size() > 1);
+
+  // point the second block part way into the first, as if the seek table were corrupt
+  table.blockOffsets[1] = table.blockOffsets[0] + 7;
+
+  Decompressor *decomp = NULL;
+  if(lz4)
+    decomp = new LZ4Decompressor(new StreamReader(buf.GetData(), buf.GetOffset()), Ownership::Stream);
+  else
+    decomp = new ZSTDDecompressor(new StreamReader(buf.GetData(), buf.GetOffset()), Ownership::Stream);
+
+  decomp->SetSeekTable(table);
+
+  byte readData[1024];
+
+  REQUIRE(decomp->Read(readData, 100));
+  CHECK_FALSE(memcmp(readData, inputData, 100));
+
+  // an offset past the seek table is rejected up front and leaves the decompressor as it was
+  CHECK_FALSE(decomp->Seek(dataSize + table.blockSize));
+  REQUIRE(decomp->Read(readData, 100));
+  CHECK_FALSE(memcmp(readData, inputData + 100, 100));
+
+  // a seek that fails part way can't resume from the old position, so all later reads must fail
+  // rather than returning data from the wrong place
+  CHECK_FALSE(decomp->Seek(table.blockSize + 10));
+  CHECK_FALSE(decomp->Read(readData, 100));
+
+  delete decomp;
+  delete[] inputData;
+};
+
+TEST_CASE("Test ZSTD first block dictionary", "[streamio][zstd]")
+{
+  // build a stream of small records that look like serialised chunks - a fixed layout with a few
+  // varying fields, referring to the same few hundred resources over and over. Each block on its
+  // own has to re-learn all of that, which is where the dictionary helps.
+  struct Record
+  {
+    uint32_t chunkID;
+    uint32_t length;
+    uint64_t resourceID;
+    float matrix[16];
+    char name[32];
+  };
+
+  const uint64_t numRecords = 48 * 1024;
+  const uint64_t dataSize = numRecords * sizeof(Record) + 1234;
+
+  byte *inputData = new byte[(size_t)dataSize];
+  memset(inputData, 0, (size_t)dataSize);
+
+  for(uint64_t i = 0; i < numRecords; i++)
+  {
+    Record rec = {};
+    rec.chunkID = 1000 + uint32_t(i % 37);
+    rec.length = sizeof(Record) + uint32_t(i % 5) * 16;
+    rec.resourceID = 0x100000000ULL + (i * 2654435761ULL) % 300;
+    for(int m = 0; m < 16; m++)
+      rec.matrix[m] = (m % 5) == 0 ? 1.0f : float(i % 11) * 0.25f;
+    snprintf(rec.name, sizeof(rec.name), "Resource %u", uint32_t(rec.resourceID & 0xffff));
+
+    memcpy(inputData + i * sizeof(Record), &rec, sizeof(Record));
+  }
+
+  uint32_t numThreads = 1;
+
+  SECTION("Serial")
+  {
+    numThreads = 1;
+  };
+
+  SECTION("Parallel")
+  {
+    numThreads = 4;
+  };
+
+  uint64_t plainSize = 0;
+
+  {
+    StreamWriter buf(StreamWriter::DefaultScratchSize);
+    StreamWriter writer(new ZSTDCompressor(&buf, Ownership::Nothing, numThreads),
+                        Ownership::Stream);
+
+    writer.Write(inputData, dataSize);
+    writer.Finish();
+
+    CHECK_FALSE(writer.IsErrored());
+
+    plainSize = buf.GetOffset();
+  }
+
+  StreamWriter buf(StreamWriter::DefaultScratchSize);
+  BlockSeekTable table;
+
+  {
+    Compressor *comp = new ZSTDCompressor(&buf, Ownership::Nothing, numThreads,
+                                          ZSTDCompressor::DefaultLevel, true);
+
+    StreamWriter writer(comp, Ownership::Stream);
+
+    writer.Write(inputData, dataSize);
+    writer.Finish();
+
+    CHECK_FALSE(writer.IsErrored());
+
+    REQUIRE(comp->HasSeekTable());
+    table = comp->GetSeekTable();
+  }
+
+  CHECK(buf.GetOffset() < plainSize);
+
+  // decompress it linearly
+  {
+    StreamReader reader(new ZSTDDecompressor(new StreamReader(buf.GetData(), buf.GetOffset()),
+                                             Ownership::Stream, true),
+                        dataSize, Ownership::Stream);
+
+    byte *readData = new byte[(size_t)dataSize];
+
+    reader.Read(readData, dataSize);
+    CHECK_FALSE(memcmp(readData, inputData, (size_t)dataSize));
+
+    CHECK_FALSE(reader.IsErrored());
+    CHECK(reader.AtEnd());
+
+    delete[] readData;
+  }
+
+  // and with seeking, which must still load the dictionary from the first block
+  {
+    Decompressor *decomp = new ZSTDDecompressor(new StreamReader(buf.GetData(), buf.GetOffset()),
+                                                Ownership::Stream, true);
+    decomp->SetSeekTable(table);
+
+    StreamReader reader(decomp, dataSize, Ownership::Stream);
+
+    byte readData[1024];
+
+    reader.SetOffset(2 * 1024 * 1024 + 4567);
+    reader.Read(readData, 1024);
+    CHECK_FALSE(memcmp(readData, inputData + 2 * 1024 * 1024 + 4567, 1024));
+
+    reader.SetOffset(1000);
+    reader.Read(readData, 1024);
+    CHECK_FALSE(memcmp(readData, inputData + 1000, 1024));
+
+    reader.SetOffset(dataSize - 1000);
+    reader.Read(readData, 1000);
+    CHECK_FALSE(memcmp(readData, inputData + dataSize - 1000, 1000));
+
+    CHECK_FALSE(reader.IsErrored());
+    CHECK(reader.AtEnd());
+  }
+
+  delete[] inputData;
+};
+
+TEST_CASE("Test read-ahead decompression", "[streamio]")
+{
+  // several ring slots worth, not a multiple of the slot or block size
+  const uint64_t dataSize = 12 * 1024 * 1024 + 5555;
+
+  byte *inputData = new byte[(size_t)dataSize];
+
+  for(uint64_t i = 0; i < dataSize; i++)
+    inputData[i] = byte((i * 13) ^ (i >> 9));
+
+  StreamWriter buf(StreamWriter::DefaultScratchSize);
+  BlockSeekTable table;
+
+  bool lz4 = false;
+
+  SECTION("LZ4")
+  {
+    lz4 = true;
+  };
+
+  SECTION("ZSTD")
+  {
+    lz4 = false;
+  };
+
+  {
+    Compressor *comp = NULL;
+    if(lz4)
+      comp = new LZ4Compressor(&buf, Ownership::Nothing, 4);
+    else
+      comp = new ZSTDCompressor(&buf, Ownership::Nothing);
+
+    StreamWriter writer(comp, Ownership::Stream);
+
+    writer.Write(inputData, dataSize);
+    writer.Finish();
+
+    CHECK_FALSE(writer.IsErrored());
+
+    table = comp->GetSeekTable();
+  }
+
+  Decompressor *decomp = NULL;
+  if(lz4)
+    decomp = new LZ4Decompressor(new StreamReader(buf.GetData(), buf.GetOffset()), Ownership::Stream);
+  else
+    decomp = new ZSTDDecompressor(new StreamReader(buf.GetData(), buf.GetOffset()), Ownership::Stream);
+
+  decomp->SetSeekTable(table);
+
+  StreamReader reader(new ReadAheadDecompressor(decomp, dataSize), dataSize, Ownership::Stream);
+
+  byte *readData = new byte[(size_t)dataSize];
+
+  // read in odd-sized pieces so reads straddle slot boundaries
+  uint64_t offs = 0;
+  while(offs < 5 * 1024 * 1024)
+  {
+    reader.Read(readData + offs, 333333);
+    offs += 333333;
+  }
+
+  CHECK_FALSE(memcmp(readData, inputData, (size_t)offs));
+
+  // seeking restarts the worker at the new offset
+  reader.SetOffset(1234567);
+  reader.Read(readData, 4096);
+  CHECK_FALSE(memcmp(readData, inputData + 1234567, 4096));
+
+  reader.SetOffset(9 * 1024 * 1024 + 17);
+  reader.Read(readData, dataSize - (9 * 1024 * 1024 + 17));
+  CHECK_FALSE(memcmp(readData, inputData + 9 * 1024 * 1024 + 17, dataSize - (9 * 1024 * 1024 + 17)));
+
+  CHECK_FALSE(reader.IsErrored());
+  CHECK(reader.AtEnd());
+
+  delete[] readData;
+  delete[] inputData;
+};
+
 #endif    // ENABLED(ENABLE_UNIT_TESTS)
@@ -23,14 +23,43 @@
  ******************************************************************************/
 
 #include "lz4io.h"
+#include "common/profiler.h"
+#include "common/threading.h"
 
 static const uint64_t lz4BlockSize = 64 * 1024;
 
-LZ4Compressor::LZ4Compressor(StreamWriter *write, Ownership own) : Compressor(write, own)
+// how many pages each thread gets per batch when compressing in parallel
+static const uint32_t lz4PagesPerThread = 16;
+
+LZ4Compressor::LZ4Compressor(StreamWriter *write, Ownership own, uint32_t numThreads)
+    : Compressor(write, own)
 {
-  m_Page[0] = AllocAlignedBuffer(lz4BlockSize);
-  m_Page[1] = AllocAlignedBuffer(lz4BlockSize);
-  m_CompressBuffer = AllocAlignedBuffer(LZ4_COMPRESSBOUND(lz4BlockSize));
+  m_NumThreads = RDCMAX(1U, numThreads);
+
+  if(m_NumThreads > 1)
+  {
+    m_BatchSize = m_NumThreads * lz4PagesPerThread;
+    m_BatchLengths.resize(m_BatchSize);
+    m_BatchCompSizes.resize(m_BatchSize);
+
+    // start with room for a single page and grow as pages are queued, so small sections don't
+    // pay for a whole batch
+    m_BatchCapacity = 1;
+    m_BatchPages = AllocAlignedBuffer(lz4BlockSize);
+
+    m_Page[0] = m_BatchPages;
+    m_Page[1] = NULL;
+    m_CompressBuffer = AllocAlignedBuffer(LZ4_COMPRESSBOUND(lz4BlockSize));
+
+    // independent blocks can be seeked to
+    m_SeekTable.blockSize = lz4BlockSize;
+  }
+  else
+  {
+    m_Page[0] = AllocAlignedBuffer(lz4BlockSize);
+    m_Page[1] = AllocAlignedBuffer(lz4BlockSize);
+    m_CompressBuffer = AllocAlignedBuffer(LZ4_COMPRESSBOUND(lz4BlockSize));
+  }
 
   m_PageOffset = 0;
 
@@ -39,9 +68,22 @@ LZ4Compressor::LZ4Compressor(StreamWriter *write, Ownership own) : Compressor(wr
 
 LZ4Compressor::~LZ4Compressor()
 {
-  FreeAlignedBuffer(m_Page[0]);
-  FreeAlignedBuffer(m_Page[1]);
+  FreeBuffers();
+}
+
+void LZ4Compressor::FreeBuffers()
+{
+  if(m_BatchPages)
+  {
+    FreeAlignedBuffer(m_BatchPages);
+  }
+  else
+  {
+    FreeAlignedBuffer(m_Page[0]);
+    FreeAlignedBuffer(m_Page[1]);
+  }
   FreeAlignedBuffer(m_CompressBuffer);
+  m_Page[0] = m_Page[1] = m_CompressBuffer = m_BatchPages = NULL;
 }
 
 bool LZ4Compressor::Write(const void *data, uint64_t numBytes)
@@ -114,15 +156,50 @@ bool LZ4Compressor::Finish()
   // precisely 64kb in size
   // only the last one can be smaller, so we only write a partial page when finishing.
   // Calling Write() after Finish() is illegal
+  if(m_NumThreads > 1)
+  {
+    if(!m_CompressBuffer)
+      return false;
+
+    // queue the last page directly, since nothing more will be written there's no need to make
+    // room for another page.
+    m_BatchLengths[m_BatchCount++] = (uint32_t)m_PageOffset;
+    m_PageOffset = 0;
+
+    return FlushBatch();
+  }
+
   return FlushPage0();
 }
 
 bool LZ4Compressor::FlushPage0()
 {
+  RDCPROFILE_ZONE("LZ4Compressor::FlushPage");
+
   // if we encountered a stream error this will be NULL
   if(!m_CompressBuffer)
     return false;
 
+  if(m_NumThreads > 1)
+  {
+    // queue this page in the batch and move on to the next one. Once the batch is full it's
+    // compressed and written in one go
+    m_BatchLengths[m_BatchCount++] = (uint32_t)m_PageOffset;
+    m_PageOffset = 0;
+
+    bool success = true;
+
+    if(m_BatchCount == m_BatchSize)
+      success = FlushBatch();
+    else if(m_BatchCount == m_BatchCapacity)
+      GrowBatch();
+
+    if(m_BatchPages)
+      m_Page[0] = m_BatchPages + lz4BlockSize * m_BatchCount;
+
+    return success;
+  }
+
   // m_PageOffset is the amount written, usually equal to lz4BlockSize except the last block.
   int32_t compSize =
       LZ4_compress_fast_continue(&m_LZ4Comp, (const char *)m_Page[0], (char *)m_CompressBuffer,
@@ -131,10 +208,7 @@ bool LZ4Compressor::FlushPage0()
   if(compSize < 0)
   {
     RDCERR("Error compressing: %i", compSize);
-    FreeAlignedBuffer(m_Page[0]);
-    FreeAlignedBuffer(m_Page[1]);
-    FreeAlignedBuffer(m_CompressBuffer);
-    m_Page[0] = m_Page[1] = m_CompressBuffer = NULL;
+    FreeBuffers();
     return false;
   }
 
@@ -152,6 +226,58 @@ bool LZ4Compressor::FlushPage0()
   return success;
 }
 
+void LZ4Compressor::GrowBatch()
+{
+  uint32_t capacity = RDCMIN(m_BatchCapacity * 2, m_BatchSize);
+
+  byte *pages = AllocAlignedBuffer(lz4BlockSize * capacity);
+  memcpy(pages, m_BatchPages, size_t(lz4BlockSize * m_BatchCount));
+  FreeAlignedBuffer(m_BatchPages);
+  m_BatchPages = pages;
+
+  // the compressed data is only used during FlushBatch, so there's nothing to keep
+  FreeAlignedBuffer(m_CompressBuffer);
+  m_CompressBuffer = AllocAlignedBuffer(LZ4_COMPRESSBOUND(lz4BlockSize) * capacity);
+
+  m_BatchCapacity = capacity;
+}
+
+bool LZ4Compressor::FlushBatch()
+{
+  const uint64_t compBound = LZ4_COMPRESSBOUND(lz4BlockSize);
+
+  // each page is compressed with no dictionary, so they're all independent. The decompressor uses
+  // the streaming API which is happy to decode blocks that don't reference any history.
+  Threading::ParallelFor(m_NumThreads, m_BatchCount, [this, compBound](uint32_t i) {
+    m_BatchCompSizes[i] = LZ4_compress_fast(
+        (const char *)(m_BatchPages + lz4BlockSize * i), (char *)(m_CompressBuffer + compBound * i),
+        (int)m_BatchLengths[i], (int)compBound, 1);
+  });
+
+  bool success = true;
+
+  for(uint32_t i = 0; success && i < m_BatchCount; i++)
+  {
+    int32_t compSize = m_BatchCompSizes[i];
+
+    if(compSize <= 0)
+    {
+      RDCERR("Error compressing: %i", compSize);
+      FreeBuffers();
+      return false;
+    }
+
+    m_SeekTable.blockOffsets.push_back(m_Write->GetOffset());
+
+    success &= m_Write->Write(compSize);
+    success &= m_Write->Write(m_CompressBuffer + compBound * i, compSize);
+  }
+
+  m_BatchCount = 0;
+
+  return success;
+}
+
 LZ4Decompressor::LZ4Decompressor(StreamReader *read, Ownership own) : Decompressor(read, own)
 {
   m_Page[0] = AllocAlignedBuffer(lz4BlockSize);
@@ -246,8 +372,48 @@ bool LZ4Decompressor::Read(void *data, uint64_t numBytes)
   return success;
 }
 
+bool LZ4Decompressor::Seek(uint64_t uncompressedOffset)
+{
+  // we can only seek if the blocks were compressed independently
+  if(!m_CompressBuffer || m_SeekTable.blockSize != lz4BlockSize)
+    return false;
+
+  uint64_t block = uncompressedOffset / lz4BlockSize;
+
+  if(block >= m_SeekTable.blockOffsets.size())
+    return false;
+
+  // past this point the read position has moved, so a failure can't fall back to reading on from
+  // where we were. FillPage0 frees the buffers on error so that later reads fail, do the same here.
+  m_Read->SetOffset(m_SeekTable.blockOffsets[block]);
+
+  if(!m_Read->IsErrored())
+  {
+    // no history is needed to decode an independent block
+    LZ4_setStreamDecode(&m_LZ4Decomp, NULL, 0);
+
+    if(!FillPage0())
+      return false;
+
+    m_PageOffset = uncompressedOffset - block * lz4BlockSize;
+
+    if(m_PageOffset <= m_PageLength)
+      return true;
+
+    RDCERR("Seek table is inconsistent with block %llu of length %llu", block, m_PageLength);
+  }
+
+  FreeAlignedBuffer(m_Page[0]);
+  FreeAlignedBuffer(m_Page[1]);
+  FreeAlignedBuffer(m_CompressBuffer);
+  m_Page[0] = m_Page[1] = m_CompressBuffer = NULL;
+  return false;
+}
+
 bool LZ4Decompressor::FillPage0()
 {
+  RDCPROFILE_ZONE("LZ4Decompressor::FillPage");
+
   // swap pages
   std::swap(m_Page[0], m_Page[1]);
 
@@ -30,7 +30,9 @@
 class LZ4Compressor : public Compressor
 {
 public:
-  LZ4Compressor(StreamWriter *write, Ownership own);
+  // with numThreads > 1 pages are batched up and compressed as independent blocks across that many
+  // threads. This loses the inter-block history but is still readable by LZ4Decompressor.
+  LZ4Compressor(StreamWriter *write, Ownership own, uint32_t numThreads = 1);
   ~LZ4Compressor();
 
   bool Write(const void *data, uint64_t numBytes);
@@ -38,11 +40,25 @@ public:
 
 private:
   bool FlushPage0();
+  bool FlushBatch();
+  void GrowBatch();
+  void FreeBuffers();
 
   byte *m_Page[2];
   byte *m_CompressBuffer;
   uint64_t m_PageOffset;
 
+  // parallel batch state. m_Page[0] points into m_BatchPages at the page currently being filled,
+  // and m_CompressBuffer holds one compressed block per page. Both have room for m_BatchCapacity
+  // pages, which doubles up to m_BatchSize as needed.
+  uint32_t m_NumThreads;
+  uint32_t m_BatchSize = 0;
+  uint32_t m_BatchCapacity = 0;
+  uint32_t m_BatchCount = 0;
+  byte *m_BatchPages = NULL;
+  rdcarray<uint32_t> m_BatchLengths;
+  rdcarray<int32_t> m_BatchCompSizes;
+
   LZ4_stream_t m_LZ4Comp;
 };
 
@@ -54,6 +70,7 @@ public:
 
   bool Recompress(Compressor *comp);
   bool Read(void *data, uint64_t numBytes);
+  bool Seek(uint64_t uncompressedOffset);
 
 private:
   bool FillPage0();
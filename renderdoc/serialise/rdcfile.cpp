@@ -228,11 +228,14 @@ RDCFile::~RDCFile()
   if(m_File)
     FileIO::fclose(m_File);
 
+  if(m_Stream)
+    m_Stream->Finish(m_Error == ContainerError::NoError);
+
   if(m_Thumb.pixels)
     delete[] m_Thumb.pixels;
 }
 
-void RDCFile::Open(const char *path)
+void RDCFile::Open(const char *path, bool headerOnly)
 {
   // silently fail when opening the empty string, to allow 'releasing' a capture file by opening an
   // empty path.
@@ -286,7 +289,7 @@ void RDCFile::Open(const char *path)
 
   StreamReader reader(m_File, fileSize, Ownership::Nothing);
 
-  Init(reader);
+  Init(reader, headerOnly);
 }
 
 void RDCFile::Open(const bytebuf &buffer)
@@ -296,10 +299,10 @@ void RDCFile::Open(const bytebuf &buffer)
 
   StreamReader reader(m_Buffer);
 
-  Init(reader);
+  Init(reader, false);
 }
 
-void RDCFile::Init(StreamReader &reader)
+void RDCFile::Init(StreamReader &reader, bool headerOnly)
 {
   RDCDEBUG("Opened capture file for read");
 
@@ -585,6 +588,11 @@ void RDCFile::Init(StreamReader &reader)
     RETURNERROR(ContainerError::Corrupt, "Capture file doesn't have a frame capture");
   }
 
+  if(headerOnly)
+    return;
+
+  ReadSeekTable();
+
   int index = SectionIndex(SectionType::ExtendedThumbnail);
   if(index >= 0)
   {
@@ -616,6 +624,80 @@ void RDCFile::Init(StreamReader &reader)
   }
 }
 
+void RDCFile::ReadSeekTable()
+{
+  m_FrameCaptureSeekTable = BlockSeekTable();
+
+  int tableIndex = SectionIndex(SectionType::SeekTable);
+  int frameIndex = SectionIndex(SectionType::FrameCapture);
+
+  if(tableIndex < 0 || frameIndex < 0)
+    return;
+
+  const SectionProperties &frameProps = m_Sections[frameIndex];
+
+  StreamReader *reader = ReadSection(tableIndex);
+
+  uint64_t compressedSize = 0, uncompressedSize = 0, blockSize = 0, numBlocks = 0;
+  reader->Read(compressedSize);
+  reader->Read(uncompressedSize);
+  reader->Read(blockSize);
+  reader->Read(numBlocks);
+
+  // the table is only valid for the frame capture section it was written alongside. If the sizes
+  // don't match then the frame capture was rewritten by something that didn't update the table.
+  if(!reader->IsErrored() && blockSize > 0 && compressedSize == frameProps.compressedSize &&
+     uncompressedSize == frameProps.uncompressedSize &&
+     numBlocks == (uncompressedSize + blockSize - 1) / blockSize &&
+     numBlocks * sizeof(uint64_t) <= reader->GetSize())
+  {
+    BlockSeekTable table;
+    table.blockSize = blockSize;
+    table.blockOffsets.resize((size_t)numBlocks);
+    reader->Read(table.blockOffsets.data(), numBlocks * sizeof(uint64_t));
+
+    if(!reader->IsErrored())
+      m_FrameCaptureSeekTable = table;
+  }
+
+  delete reader;
+}
+
+void RDCFile::WriteSeekTable(const BlockSeekTable &table)
+{
+  int frameIndex = SectionIndex(SectionType::FrameCapture);
+
+  if(frameIndex < 0)
+    return;
+
+  // don't add a table if there's nothing to index and no stale table to replace
+  if(table.blockSize == 0 && SectionIndex(SectionType::SeekTable) < 0)
+    return;
+
+  const SectionProperties &frameProps = m_Sections[frameIndex];
+
+  SectionProperties props;
+  props.type = SectionType::SeekTable;
+  props.version = 1;
+
+  StreamWriter *writer = WriteSection(props);
+
+  writer->Write(frameProps.compressedSize);
+  writer->Write(frameProps.uncompressedSize);
+  writer->Write(table.blockSize);
+  writer->Write((uint64_t)table.blockOffsets.size());
+  writer->Write(table.blockOffsets.data(), table.blockOffsets.byteSize());
+
+  writer->Finish();
+
+  delete writer;
+
+  if(table.blockSize > 0)
+    m_FrameCaptureSeekTable = table;
+  else
+    m_FrameCaptureSeekTable = BlockSeekTable();
+}
+
 bool RDCFile::CopyFileTo(const char *filename)
 {
   if(!m_File)
@@ -671,6 +753,36 @@ void RDCFile::Create(const char *filename)
 
   RDCDEBUG("Opened capture file for write");
 
+  {
+    StreamWriter writer(m_File, Ownership::Nothing);
+
+    WriteFileHeader(writer);
+
+    if(m_Error != ContainerError::NoError)
+      return;
+  }
+
+  // re-open as read-only now.
+  FileIO::fclose(m_File);
+  m_File = FileIO::fopen(filename, "rb");
+  FileIO::fseek64(m_File, 0, SEEK_END);
+}
+
+void RDCFile::Create(RDCFileStream *stream)
+{
+  m_Stream = stream;
+
+  RDCDEBUG("creating streamed RDC file.");
+
+  StreamWriter writer(m_Stream, Ownership::Nothing);
+
+  WriteFileHeader(writer);
+
+  m_StreamOffset = writer.GetOffset();
+}
+
+void RDCFile::WriteFileHeader(StreamWriter &writer)
+{
   FileHeader header;    // automagically initialised with correct data apart from length
 
   BinaryThumbnail thumbHeader = {0};
@@ -729,30 +841,21 @@ void RDCFile::Create(const char *filename)
   header.headerLength = sizeof(FileHeader) + offsetof(BinaryThumbnail, data) + thumbHeader.length +
                         offsetof(CaptureMetaData, driverName) + meta.driverNameLength;
 
-  {
-    StreamWriter writer(m_File, Ownership::Nothing);
+  writer.Write(header);
+  writer.Write(&thumbHeader, offsetof(BinaryThumbnail, data));
 
-    writer.Write(header);
-    writer.Write(&thumbHeader, offsetof(BinaryThumbnail, data));
+  if(thumbHeader.length > 0)
+    writer.Write(jpgPixels, thumbHeader.length);
 
-    if(thumbHeader.length > 0)
-      writer.Write(jpgPixels, thumbHeader.length);
+  writer.Write(&meta, offsetof(CaptureMetaData, driverName));
 
-    writer.Write(&meta, offsetof(CaptureMetaData, driverName));
+  writer.Write(m_DriverName.c_str(), meta.driverNameLength);
 
-    writer.Write(m_DriverName.c_str(), meta.driverNameLength);
-
-    delete[] jpgBuffer;
-    if(writer.IsErrored())
-    {
-      RETURNERROR(ContainerError::FileIO, "Error writing file header");
-    }
+  delete[] jpgBuffer;
+  if(writer.IsErrored())
+  {
+    RETURNERROR(ContainerError::FileIO, "Error writing file header");
   }
-
-  // re-open as read-only now.
-  FileIO::fclose(m_File);
-  m_File = FileIO::fopen(filename, "rb");
-  FileIO::fseek64(m_File, 0, SEEK_END);
 }
 
 int RDCFile::SectionIndex(SectionType type) const
@@ -789,6 +892,12 @@ StreamReader *RDCFile::ReadSection(int index) const
   if(m_Error != ContainerError::NoError)
     return new StreamReader(StreamReader::InvalidStream);
 
+  if(m_Stream)
+  {
+    RDCERR("Sections can't be read back from a streamed file.");
+    return new StreamReader(StreamReader::InvalidStream);
+  }
+
   if(m_File == NULL)
   {
     if(index < (int)m_MemorySections.size())
@@ -800,29 +909,138 @@ StreamReader *RDCFile::ReadSection(int index) const
 
   const SectionProperties &props = m_Sections[index];
   SectionLocation offsetSize = m_SectionLocations[index];
-  FileIO::fseek64(m_File, offsetSize.dataOffset, SEEK_SET);
 
-  StreamReader *fileReader = new StreamReader(m_File, offsetSize.diskLength, Ownership::Nothing);
+  // large uncompressed sections are mapped instead of streamed through a buffer. That way big reads
+  // like initial contents come straight out of the page cache without a second copy in memory.
+  if(!(props.flags & (SectionFlags::LZ4Compressed | SectionFlags::ZstdCompressed)) &&
+     offsetSize.diskLength >= MinMappedSectionSize)
+  {
+    const byte *view =
+        (const byte *)FileIO::MapFileRegion(m_File, offsetSize.dataOffset, offsetSize.diskLength);
+
+    // the reader can outlive m_File, so it gets its own handle to check the file's size with in
+    // case it's truncated while mapped. Without one, fall back to reading through the FILE.
+    FILE *sizeFile = view ? FileIO::fopen(m_Filename.c_str(), "rb") : NULL;
+
+    if(view && sizeFile)
+    {
+      uint64_t length = offsetSize.diskLength;
+      uint64_t dataOffset = offsetSize.dataOffset;
+
+      StreamReader *mappedReader = new StreamReader(StreamReader::ExternalMemory, view, length);
+      mappedReader->SetExternalMemoryCheck([sizeFile, dataOffset]() {
+        FileIO::fseek64(sizeFile, 0, SEEK_END);
+        uint64_t fileSize = FileIO::ftell64(sizeFile);
+        return fileSize > dataOffset ? fileSize - dataOffset : 0;
+      });
+      mappedReader->AddCloseCallback([view, length, sizeFile]() {
+        FileIO::UnmapFileRegion(view, length);
+        FileIO::fclose(sizeFile);
+      });
+      return mappedReader;
+    }
+
+    FileIO::UnmapFileRegion(view, offsetSize.diskLength);
+  }
+
+  // the frame capture is read while replay initialisation processes its chunks, so big compressed
+  // captures get decompressed ahead on another thread. That thread needs its own file handle, since
+  // other sections can be read from m_File while the frame capture reader is still alive.
+  bool readAhead = props.type == SectionType::FrameCapture &&
+                   (props.flags & (SectionFlags::LZ4Compressed | SectionFlags::ZstdCompressed)) &&
+                   props.uncompressedSize >= MinReadAheadSectionSize &&
+                   Threading::NumberOfCores() > 1;
+
+  FILE *readFile = m_File;
+  Ownership fileOwnership = Ownership::Nothing;
+
+  if(readAhead)
+  {
+    readFile = FileIO::fopen(m_Filename.c_str(), "rb");
+
+    if(readFile)
+    {
+      fileOwnership = Ownership::Stream;
+    }
+    else
+    {
+      readFile = m_File;
+      readAhead = false;
+    }
+  }
+
+  FileIO::fseek64(readFile, offsetSize.dataOffset, SEEK_SET);
+
+  StreamReader *fileReader = new StreamReader(readFile, offsetSize.diskLength, fileOwnership);
 
   StreamReader *compReader = NULL;
 
+  Decompressor *decompressor = NULL;
+
   if(props.flags & SectionFlags::LZ4Compressed)
+    decompressor = new LZ4Decompressor(fileReader, Ownership::Stream);
+  else if(props.flags & SectionFlags::ZstdCompressed)
+    decompressor = new ZSTDDecompressor(fileReader, Ownership::Stream,
+                                        bool(props.flags & SectionFlags::ZstdDictionary));
+
+  if(decompressor)
   {
+    if(props.type == SectionType::FrameCapture && m_FrameCaptureSeekTable.blockSize > 0)
+      decompressor->SetSeekTable(m_FrameCaptureSeekTable);
+
+    if(readAhead)
+      decompressor = new ReadAheadDecompressor(decompressor, props.uncompressedSize);
+
     // the user will delete the compressed reader, and then it will delete the compressor and the
     // file reader
-    compReader = new StreamReader(new LZ4Decompressor(fileReader, Ownership::Stream),
-                                  props.uncompressedSize, Ownership::Stream);
-  }
-  else if(props.flags & SectionFlags::ZstdCompressed)
-  {
-    compReader = new StreamReader(new ZSTDDecompressor(fileReader, Ownership::Stream),
-                                  props.uncompressedSize, Ownership::Stream);
+    compReader = new StreamReader(decompressor, props.uncompressedSize, Ownership::Stream);
   }
 
   // if we're compressing return that writer, otherwise return the file writer directly
   return compReader ? compReader : fileReader;
 }
 
+static BinarySectionHeader MakeSectionHeader(const SectionProperties &props, const rdcstr &name)
+{
+  BinarySectionHeader header = {// IsASCII
+                                '\0',
+                                // zero
+                                {0, 0, 0},
+                                // sectionType
+                                props.type,
+                                // sectionCompressedLength
+                                0,
+                                // sectionUncompressedLength
+                                0,
+                                // sectionVersion
+                                props.version,
+                                // sectionFlags
+                                props.flags,
+                                // sectionNameLength
+                                uint32_t(name.length() + 1)};
+
+  return header;
+}
+
+// returns the compressor for a section according to its flags, or NULL if it's not compressed.
+// The user will delete the compressed writer, which deletes the compressor and the file writer.
+static Compressor *CreateSectionCompressor(SectionFlags flags, StreamWriter *fileWriter)
+{
+  // spread compression over the available cores, up to a limit since each thread's share of a batch
+  // is held in memory. Batch storage grows as pages are written, so small sections stay small.
+  uint32_t numThreads = RDCMIN(Threading::NumberOfCores(), 8U);
+
+  if(flags & SectionFlags::LZ4Compressed)
+    return new LZ4Compressor(fileWriter, Ownership::Stream, numThreads);
+
+  if(flags & SectionFlags::ZstdCompressed)
+    return new ZSTDCompressor(fileWriter, Ownership::Stream, numThreads,
+                              ZSTDCompressor::DefaultLevel,
+                              bool(flags & SectionFlags::ZstdDictionary));
+
+  return NULL;
+}
+
 StreamWriter *RDCFile::WriteSection(const SectionProperties &props)
 {
   if(m_Error != ContainerError::NoError)
@@ -830,7 +1048,7 @@ StreamWriter *RDCFile::WriteSection(const SectionProperties &props)
 
   RDCASSERT((size_t)props.type < (size_t)SectionType::Count);
 
-  if(m_File == NULL)
+  if(m_File == NULL && m_Stream == NULL)
   {
     // if we have no file to write to, we just cache it in memory for future use (e.g. later writing
     // to disk via the CaptureFile interface wih structured data for the frame capture section)
@@ -847,7 +1065,9 @@ StreamWriter *RDCFile::WriteSection(const SectionProperties &props)
     return w;
   }
 
-  // re-open the file as read-write
+  // re-open the file as read-write. A streamed file has nothing to re-open, it's handled once the
+  // section's name is known.
+  if(m_File)
   {
     uint64_t offs = FileIO::ftell64(m_File);
     FileIO::fclose(m_File);
@@ -890,6 +1110,9 @@ StreamWriter *RDCFile::WriteSection(const SectionProperties &props)
     return new StreamWriter(StreamWriter::InvalidStream);
   }
 
+  if(m_Stream)
+    return WriteStreamSection(props, name);
+
   // For handling a section that does exist, it depends on the section type:
   // - For frame capture, then we just write to a new file since we want it
   //   to be first. Once the writing is done, copy across any other sections
@@ -1097,22 +1320,7 @@ StreamWriter *RDCFile::WriteSection(const SectionProperties &props)
   size_t numWritten;
 
   // write section header
-  BinarySectionHeader header = {// IsASCII
-                                '\0',
-                                // zero
-                                {0, 0, 0},
-                                // sectionType
-                                type,
-                                // sectionCompressedLength
-                                0,
-                                // sectionUncompressedLength
-                                0,
-                                // sectionVersion
-                                props.version,
-                                // sectionFlags
-                                props.flags,
-                                // sectionNameLength
-                                uint32_t(name.length() + 1)};
+  BinarySectionHeader header = MakeSectionHeader(props, name);
 
   // write the header then name
   numWritten = FileIO::fwrite(&header, 1, offsetof(BinarySectionHeader, name), m_File);
@@ -1124,23 +1332,26 @@ StreamWriter *RDCFile::WriteSection(const SectionProperties &props)
     return new StreamWriter(StreamWriter::InvalidStream);
   }
 
-  // create a writer for writing to disk. It shouldn't close the file
-  StreamWriter *fileWriter = new StreamWriter(m_File, Ownership::Nothing);
+  // create a writer for writing to disk. It shouldn't close the file. The frame capture is by far
+  // the largest section, so its data is written on another thread while the next pages are being
+  // compressed. Nothing else touches m_File until the writer is destroyed.
+  StreamWriter *fileWriter = NULL;
+  if(type == SectionType::FrameCapture && Threading::NumberOfCores() > 1)
+    fileWriter = new StreamWriter(StreamWriter::WriteBehind, m_File, Ownership::Nothing);
+  else
+    fileWriter = new StreamWriter(m_File, Ownership::Nothing);
 
   StreamWriter *compWriter = NULL;
+  Compressor *compressor = CreateSectionCompressor(props.flags, fileWriter);
 
-  if(props.flags & SectionFlags::LZ4Compressed)
-  {
-    // the user will delete the compressed writer, and then it will delete the compressor and the
-    // file writer
-    compWriter =
-        new StreamWriter(new LZ4Compressor(fileWriter, Ownership::Stream), Ownership::Stream);
-  }
-  else if(props.flags & SectionFlags::ZstdCompressed)
-  {
-    compWriter =
-        new StreamWriter(new ZSTDCompressor(fileWriter, Ownership::Stream), Ownership::Stream);
-  }
+  if(compressor)
+    compWriter = new StreamWriter(compressor, Ownership::Stream);
+
+  // if we're writing the frame capture, the seek table is written out once the section is
+  // complete. The compressor is mid-destruction when the callbacks run, but the table lives in the
+  // base class so is still available.
+  const bool writeSeekTable = (type == SectionType::FrameCapture);
+  m_PendingSeekTable = BlockSeekTable();
 
   uint64_t dataOffset = FileIO::ftell64(m_File);
 
@@ -1148,9 +1359,13 @@ StreamWriter *RDCFile::WriteSection(const SectionProperties &props)
   m_CurrentWritingProps.name = name;
 
   // register a destroy callback to tidy up the section at the end
-  fileWriter->AddCloseCallback([this, type, name, headerOffset, dataOffset, fileWriter, compWriter]() {
+  fileWriter->AddCloseCallback([this, type, name, headerOffset, dataOffset, fileWriter, compWriter,
+                                compressor, writeSeekTable]() {
     FileIO::fflush(m_File);
 
+    if(writeSeekTable && compressor && compressor->HasSeekTable())
+      m_PendingSeekTable = compressor->GetSeekTable();
+
     // the offset of the file writer is how many bytes were written to disk - the compressed length.
     uint64_t compressedLength = fileWriter->GetOffset();
 
@@ -1203,10 +1418,112 @@ StreamWriter *RDCFile::WriteSection(const SectionProperties &props)
     FileIO::fseek64(m_File, prevPos, SEEK_SET);
   });
 
+  if(writeSeekTable)
+  {
+    fileWriter->AddCloseCallback([this]() {
+      BlockSeekTable table;
+      std::swap(table, m_PendingSeekTable);
+      WriteSeekTable(table);
+    });
+  }
+
   // if we're compressing return that writer, otherwise return the file writer directly
   return compWriter ? compWriter : fileWriter;
 }
 
+StreamWriter *RDCFile::WriteStreamSection(const SectionProperties &props, const rdcstr &name)
+{
+  // everything written so far has already been sent, so sections can only be added at the end
+  if(SectionIndex(props.type) >= 0 || SectionIndex(name.c_str()) >= 0)
+  {
+    RDCERR("Section '%s' can't be replaced in a streamed file.", name.c_str());
+    return new StreamWriter(StreamWriter::InvalidStream);
+  }
+
+  const SectionType type = props.type;
+  const uint64_t headerOffset = m_StreamOffset;
+
+  {
+    BinarySectionHeader header = MakeSectionHeader(props, name);
+
+    StreamWriter headerWriter(m_Stream, Ownership::Nothing);
+    headerWriter.Write(&header, offsetof(BinarySectionHeader, name));
+    headerWriter.Write(name.c_str(), name.size() + 1);
+
+    if(headerWriter.IsErrored())
+    {
+      SETERROR(ContainerError::FileIO, "Error writing streamed section header");
+      return new StreamWriter(StreamWriter::InvalidStream);
+    }
+
+    m_StreamOffset += headerWriter.GetOffset();
+  }
+
+  const uint64_t dataOffset = m_StreamOffset;
+
+  StreamWriter *fileWriter = new StreamWriter(m_Stream, Ownership::Nothing);
+
+  Compressor *compressor = CreateSectionCompressor(props.flags, fileWriter);
+  StreamWriter *compWriter = compressor ? new StreamWriter(compressor, Ownership::Stream) : NULL;
+
+  const bool writeSeekTable = (type == SectionType::FrameCapture);
+  m_PendingSeekTable = BlockSeekTable();
+
+  m_CurrentWritingProps = props;
+  m_CurrentWritingProps.name = name;
+
+  fileWriter->AddCloseCallback([this, type, name, headerOffset, dataOffset, fileWriter, compWriter,
+                                compressor, writeSeekTable]() {
+    if(fileWriter->IsErrored())
+    {
+      m_CurrentWritingProps = SectionProperties();
+      RETURNERROR(ContainerError::FileIO, "Error streaming section %u (%s)", type, name.c_str());
+    }
+
+    if(writeSeekTable && compressor && compressor->HasSeekTable())
+      m_PendingSeekTable = compressor->GetSeekTable();
+
+    uint64_t lengths[2] = {fileWriter->GetOffset(), fileWriter->GetOffset()};
+    if(compWriter)
+      lengths[1] = compWriter->GetOffset();
+
+    RDCLOG("Finishing stream of section %u (%s). Compressed from %llu bytes to %llu", type,
+           name.c_str(), lengths[1], lengths[0]);
+
+    m_StreamOffset = dataOffset + lengths[0];
+
+    m_CurrentWritingProps.compressedSize = lengths[0];
+    m_CurrentWritingProps.uncompressedSize = lengths[1];
+
+    m_Sections.push_back(m_CurrentWritingProps);
+    SectionLocation loc;
+    loc.headerOffset = headerOffset;
+    loc.dataOffset = dataOffset;
+    loc.diskLength = lengths[0];
+    m_SectionLocations.push_back(loc);
+
+    m_CurrentWritingProps = SectionProperties();
+
+    // the compressed and uncompressed lengths are adjacent in the header
+    if(!m_Stream->Patch(headerOffset + offsetof(BinarySectionHeader, sectionCompressedLength),
+                        lengths, sizeof(lengths)))
+    {
+      RETURNERROR(ContainerError::FileIO, "Error applying fixup to streamed section header");
+    }
+  });
+
+  if(writeSeekTable)
+  {
+    fileWriter->AddCloseCallback([this]() {
+      BlockSeekTable table;
+      std::swap(table, m_PendingSeekTable);
+      WriteSeekTable(table);
+    });
+  }
+
+  return compWriter ? compWriter : fileWriter;
+}
+
 FILE *RDCFile::StealImageFileHandle(rdcstr &filename)
 {
   if(m_Driver != RDCDriver::Image)
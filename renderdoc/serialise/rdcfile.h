@@ -55,6 +55,17 @@ struct ExtThumbnailHeader
   FileType format;
 };
 
+// where a capture goes when it's streamed instead of written to a file. The file's bytes are
+// written in order, except for each section's lengths which are only known once the section is
+// finished, and are then patched over the section header written earlier.
+class RDCFileStream : public StreamSink
+{
+public:
+  virtual bool Patch(uint64_t offset, const void *data, uint64_t numBytes) = 0;
+  // called once nothing more will be written, with whether the whole file was written successfully
+  virtual void Finish(bool success) = 0;
+};
+
 class RDCFile
 {
 public:
@@ -68,10 +79,18 @@ public:
   static const uint32_t V1_0_VERSION = 0x00000100;
   static const uint32_t V1_1_VERSION = 0x00000101;
 
+  // uncompressed sections at least this large are memory-mapped when read
+  static const uint64_t MinMappedSectionSize = 4 * 1024 * 1024;
+
+  // compressed frame captures at least this large are decompressed ahead on a worker thread
+  static const uint64_t MinReadAheadSectionSize = 16 * 1024 * 1024;
+
   ~RDCFile();
 
-  // opens an existing file for read and/or modification. Error if file doesn't exist
-  void Open(const char *filename);
+  // opens an existing file for read and/or modification. Error if file doesn't exist. If headerOnly
+  // is set, only the file header and section table are read - nothing is decompressed, so the
+  // extended thumbnail and frame capture seek table are not loaded.
+  void Open(const char *filename, bool headerOnly = false);
   void Open(const bytebuf &buffer);
 
   bool CopyFileTo(const char *filename);
@@ -83,6 +102,10 @@ public:
   // creates a new file with current properties, file will be overwritten if it already exists
   void Create(const char *filename);
 
+  // as above, but the file is written to a stream instead of to disk. Sections can only be appended
+  // and can't be read back. The stream isn't owned, and is finished when this RDCFile is destroyed.
+  void Create(RDCFileStream *stream);
+
   ContainerError ErrorCode() const { return m_Error; }
   rdcstr ErrorString() const { return m_ErrorString; }
   RDCDriver GetDriver() const { return m_Driver; }
@@ -101,12 +124,20 @@ public:
   FILE *StealImageFileHandle(rdcstr &filename);
 
 private:
-  void Init(StreamReader &reader);
+  void Init(StreamReader &reader, bool headerOnly);
+  void WriteFileHeader(StreamWriter &writer);
+  StreamWriter *WriteStreamSection(const SectionProperties &props, const rdcstr &name);
+  void ReadSeekTable();
+  void WriteSeekTable(const BlockSeekTable &table);
 
   FILE *m_File = NULL;
   rdcstr m_Filename;
   bytebuf m_Buffer;
 
+  // set instead of m_File when the file is being streamed, with how many bytes have been written
+  RDCFileStream *m_Stream = NULL;
+  uint64_t m_StreamOffset = 0;
+
   SectionProperties m_CurrentWritingProps;
 
   uint32_t m_SerVer = 0;
@@ -129,4 +160,11 @@ private:
   rdcarray<SectionProperties> m_Sections;
   rdcarray<SectionLocation> m_SectionLocations;
   rdcarray<bytebuf> m_MemorySections;
+
+  // block index for the frame capture section, if it was written with independent blocks. Empty
+  // if the section can only be read sequentially.
+  BlockSeekTable m_FrameCaptureSeekTable;
+
+  // the table from the compressor while the frame capture section is being finished
+  BlockSeekTable m_PendingSeekTable;
 };
@@ -27,7 +27,499 @@
 
 #include "serialiser.h"
 #include "core/core.h"
+#include "common/threading.h"
+#include "lz4/lz4.h"
 #include "strings/string_utils.h"
+#include "zstd/xxhash.h"
+
+namespace ChunkAllocator
+{
+// enough for a good number of typical chunks, which are a few hundred bytes at most
+static const size_t SlabSize = 256 * 1024;
+// anything bigger than this goes straight to the heap so it doesn't waste the tail of a slab
+static const size_t MaxSlabAllocation = 16 * 1024;
+static const size_t AllocAlignment = 16;
+
+// threads are hashed onto a fixed set of slabs. That keeps contention on each lock low without
+// needing per-thread state, which would leak whenever an application thread exits.
+static const uint32_t NumShards = 16;
+
+struct Slab
+{
+  // one reference for each live allocation, plus one while the slab is current for a shard
+  int32_t refcount;
+  uint32_t used;
+};
+
+// every allocation is preceded by its slab, or NULL if it came from the heap
+struct AllocHeader
+{
+  Slab *slab;
+  uint64_t padding;
+};
+
+RDCCOMPILE_ASSERT(sizeof(Slab) <= AllocAlignment, "Slab header must fit in the alignment");
+RDCCOMPILE_ASSERT(sizeof(AllocHeader) == AllocAlignment, "AllocHeader must match the alignment");
+
+struct Shard
+{
+  Threading::SpinLock lock;
+  Slab *current = NULL;
+};
+
+static Shard shards[NumShards];
+
+#if ENABLED(RDOC_DEVEL)
+static int64_t liveSlabs = 0;
+static int64_t slabMem = 0;
+
+uint64_t NumLiveSlabs()
+{
+  return liveSlabs;
+}
+
+uint64_t SlabMem()
+{
+  return slabMem;
+}
+#endif
+
+static void ReleaseSlab(Slab *slab)
+{
+  if(Atomic::Dec32(&slab->refcount) == 0)
+  {
+    FreeAlignedBuffer((byte *)slab);
+
+#if ENABLED(RDOC_DEVEL)
+    Atomic::Dec64(&liveSlabs);
+    Atomic::ExchAdd64(&slabMem, -int64_t(SlabSize));
+#endif
+  }
+}
+
+void *Allocate(size_t size)
+{
+  size_t total = AlignUp(size + sizeof(AllocHeader), AllocAlignment);
+
+  AllocHeader *header = NULL;
+
+  if(total > MaxSlabAllocation)
+  {
+    header = (AllocHeader *)AllocAlignedBuffer(total);
+    header->slab = NULL;
+    return header + 1;
+  }
+
+  // thread IDs are often pointers or otherwise have poorly distributed low bits, so mix them
+  uint64_t threadHash = Threading::GetCurrentID() * 0x9E3779B97F4A7C15ULL;
+  Shard &shard = shards[(threadHash >> 32) % NumShards];
+
+  shard.lock.Lock();
+
+  Slab *slab = shard.current;
+
+  if(slab == NULL || slab->used + total > SlabSize)
+  {
+    // the old slab lives on until all of its chunks have been freed
+    if(slab)
+      ReleaseSlab(slab);
+
+    slab = (Slab *)AllocAlignedBuffer(SlabSize);
+    slab->refcount = 1;
+    slab->used = AllocAlignment;
+
+#if ENABLED(RDOC_DEVEL)
+    Atomic::Inc64(&liveSlabs);
+    Atomic::ExchAdd64(&slabMem, int64_t(SlabSize));
+#endif
+
+    shard.current = slab;
+  }
+
+  header = (AllocHeader *)((byte *)slab + slab->used);
+  slab->used += (uint32_t)total;
+  Atomic::Inc32(&slab->refcount);
+
+  shard.lock.Unlock();
+
+  header->slab = slab;
+  return header + 1;
+}
+
+void Free(void *ptr)
+{
+  if(ptr == NULL)
+    return;
+
+  AllocHeader *header = ((AllocHeader *)ptr) - 1;
+
+  if(header->slab)
+    ReleaseSlab(header->slab);
+  else
+    FreeAlignedBuffer((byte *)header);
+}
+
+// a few adopted buffers are kept around to replace the next ones adopted. Very large ones aren't
+// worth holding on to.
+static const uint32_t MaxPooledBuffers = 8;
+static const uint64_t MaxPooledBufferSize = 16 * 1024 * 1024;
+
+static Threading::SpinLock poolLock;
+static byte *pooledBuffers[MaxPooledBuffers] = {};
+static uint64_t pooledSizes[MaxPooledBuffers] = {};
+static uint32_t numPooled = 0;
+
+byte *AcquireWriteBuffer(uint64_t &size)
+{
+  {
+    Threading::ScopedSpinLock lock(poolLock);
+
+    if(numPooled > 0)
+    {
+      numPooled--;
+      size = pooledSizes[numPooled];
+      return pooledBuffers[numPooled];
+    }
+  }
+
+  size = StreamWriter::DefaultScratchSize;
+  return AllocAlignedBuffer(size);
+}
+
+void ReleaseWriteBuffer(byte *buffer, uint64_t size)
+{
+  if(size <= MaxPooledBufferSize)
+  {
+    Threading::ScopedSpinLock lock(poolLock);
+
+    if(numPooled < MaxPooledBuffers)
+    {
+      pooledBuffers[numPooled] = buffer;
+      pooledSizes[numPooled] = size;
+      numPooled++;
+      return;
+    }
+  }
+
+  FreeAlignedBuffer(buffer);
+}
+
+void ReleaseCurrentSlabs()
+{
+  for(uint32_t i = 0; i < NumShards; i++)
+  {
+    shards[i].lock.Lock();
+    if(shards[i].current)
+      ReleaseSlab(shards[i].current);
+    shards[i].current = NULL;
+    shards[i].lock.Unlock();
+  }
+}
+};
+
+// chunks bigger than this are kept as normal chunks rather than wasting the tail of a block
+static const uint64_t MaxStreamedChunkSize = StreamWriter::DefaultScratchSize / 4;
+
+ChunkStream::~ChunkStream()
+{
+  for(Entry &e : m_Entries)
+    delete e.chunk;
+
+  for(const rdcpair<byte *, uint64_t> &block : m_Blocks)
+    ChunkAllocator::ReleaseWriteBuffer(block.first, block.second);
+}
+
+void ChunkStream::Append(Serialiser<SerialiserMode::Writing> &ser, uint32_t chunkType, int32_t ID)
+{
+  StreamWriter *writer = ser.GetWriter();
+
+  uint64_t length = writer->GetOffset();
+
+  Entry e = {ID, chunkType, (uint32_t)length, NULL, NULL};
+
+  if(length > MaxStreamedChunkSize)
+  {
+    e.chunk = new Chunk(ser, chunkType);
+    m_Entries.push_back(e);
+    return;
+  }
+
+  if(m_Blocks.empty() || m_BlockUsed + length > m_Blocks.back().second)
+  {
+    uint64_t size = 0;
+    byte *block = ChunkAllocator::AcquireWriteBuffer(size);
+    m_Blocks.push_back({block, size});
+    m_BlockUsed = 0;
+  }
+
+  e.data = m_Blocks.back().first + m_BlockUsed;
+  m_BlockUsed += length;
+
+  memcpy(e.data, writer->GetData(), (size_t)length);
+  writer->Rewind();
+
+  m_Entries.push_back(e);
+
+  OverheadCounters::Add(OverheadCounter::SerialisedChunks, 1);
+}
+
+void ChunkStream::TakeChunks(rdcarray<rdcpair<int32_t, Chunk *>> &chunks)
+{
+  chunks.reserve(chunks.size() + m_Entries.size());
+
+  for(const Entry &e : m_Entries)
+  {
+    if(e.chunk)
+      chunks.push_back({e.ID, e.chunk});
+    else
+      chunks.push_back({e.ID, new Chunk(e.chunkType, e.data, e.length)});
+  }
+
+  m_Entries.clear();
+}
+
+namespace ChunkSpill
+{
+// chunks are compressed in independent blocks of this size, so they can be streamed back out
+// without decompressing a whole large chunk at once
+static const uint32_t BlockSize = 64 * 1024;
+
+struct File
+{
+  Threading::CriticalSection lock;
+  FILE *f = NULL;
+  rdcstr path;
+  uint64_t size = 0;
+  // one for each chunk spilled into the file, plus one while it's the active file for a capture
+  int32_t refcount = 1;
+
+  bytebuf compressed;
+  bytebuf decompressed;
+};
+
+static Threading::CriticalSection activeLock;
+static File *activeFile = NULL;
+static uint32_t fileIndex = 0;
+
+// only changed under activeLock, read atomically elsewhere
+static volatile int64_t budget = 0;
+static volatile int64_t held = 0;
+static volatile int64_t spilled = 0;
+// identifies the current capture, so that chunks counted in an earlier one aren't uncounted from it
+static volatile int32_t capture = 0;
+
+void BeginCapture(uint64_t budgetBytes)
+{
+  SCOPED_LOCK(activeLock);
+
+  held = 0;
+  spilled = 0;
+  budget = (int64_t)budgetBytes;
+  Atomic::Inc32(&capture);
+}
+
+void Uncount(int32_t chunkCapture, uint32_t length)
+{
+  if(chunkCapture == Atomic::CmpExch32(&capture, 0, 0))
+    Atomic::ExchAdd64(&held, -int64_t(length));
+}
+
+void EndCapture()
+{
+  SCOPED_LOCK(activeLock);
+
+  budget = 0;
+
+  if(spilled > 0)
+    RDCLOG("Spilled %llu bytes of frame chunks to disk to stay within the capture memory budget",
+           (uint64_t)spilled);
+
+  // chunks that were spilled keep the file alive until they're deleted
+  if(activeFile)
+    Release(activeFile);
+  activeFile = NULL;
+}
+
+uint64_t SpilledBytes()
+{
+  return (uint64_t)Atomic::ExchAdd64(&spilled, 0);
+}
+
+void Consider(Chunk *chunk)
+{
+  const int64_t limit = Atomic::ExchAdd64(&budget, 0);
+
+  if(limit == 0 || chunk->IsSpilled())
+    return;
+
+  // counted until it's either spilled or deleted
+  chunk->m_SpillCapture = Atomic::CmpExch32(&capture, 0, 0);
+  Atomic::ExchAdd64(&held, int64_t(chunk->GetLength()));
+  if(Atomic::ExchAdd64(&held, 0) <= limit)
+    return;
+
+  File *file = NULL;
+
+  {
+    SCOPED_LOCK(activeLock);
+
+    // the capture may have ended while we were waiting
+    if(budget == 0)
+      return;
+
+    if(!activeFile)
+    {
+      File *newFile = new File;
+      newFile->path = StringFormat::Fmt("%srenderdoc_spill_%u_%u.bin",
+                                        FileIO::GetTempFolderFilename().c_str(),
+                                        Process::GetCurrentPID(), fileIndex++);
+      newFile->f = FileIO::fopen(newFile->path.c_str(), "w+b");
+
+      if(!newFile->f)
+      {
+        RDCERR("Couldn't open %s to spill capture chunks, disabling spilling",
+               newFile->path.c_str());
+        delete newFile;
+        budget = 0;
+        return;
+      }
+
+      RDCLOG("Capture memory budget of %llu bytes exceeded, spilling frame chunks to %s",
+             (uint64_t)limit, newFile->path.c_str());
+
+      activeFile = newFile;
+    }
+
+    file = activeFile;
+    AddRef(file);
+  }
+
+  if(chunk->Spill(file))
+  {
+    chunk->m_SpillCapture = 0;
+    Atomic::ExchAdd64(&held, -int64_t(chunk->GetLength()));
+    Atomic::ExchAdd64(&spilled, int64_t(chunk->GetLength()));
+  }
+
+  Release(file);
+}
+
+bool Write(File *file, const byte *data, uint32_t length, uint64_t &offset)
+{
+  SCOPED_LOCK(file->lock);
+
+  if(!file->f)
+    return false;
+
+  file->compressed.resize(LZ4_COMPRESSBOUND(BlockSize));
+
+  FileIO::fseek64(file->f, file->size, SEEK_SET);
+  offset = file->size;
+
+  uint64_t written = 0;
+
+  for(uint32_t pos = 0; pos < length; pos += BlockSize)
+  {
+    int blockLength = (int)RDCMIN(BlockSize, length - pos);
+
+    uint32_t compLength = (uint32_t)LZ4_compress_default(
+        (const char *)data + pos, (char *)file->compressed.data(), blockLength,
+        (int)file->compressed.size());
+
+    if(compLength == 0 || FileIO::fwrite(&compLength, sizeof(compLength), 1, file->f) != 1 ||
+       FileIO::fwrite(file->compressed.data(), 1, compLength, file->f) != compLength)
+    {
+      RDCERR("Failed to write %u bytes to spill file %s", length, file->path.c_str());
+      // leave the file's size as it was, anything partially written will be overwritten
+      return false;
+    }
+
+    written += sizeof(compLength) + compLength;
+  }
+
+  file->size += written;
+  file->refcount++;
+
+  return true;
+}
+
+void Stream(File *file, uint64_t offset, uint32_t length, StreamWriter *writer)
+{
+  SCOPED_LOCK(file->lock);
+
+  file->compressed.resize(LZ4_COMPRESSBOUND(BlockSize));
+  file->decompressed.resize(BlockSize);
+
+  FileIO::fseek64(file->f, offset, SEEK_SET);
+
+  for(uint32_t pos = 0; pos < length; pos += BlockSize)
+  {
+    int blockLength = (int)RDCMIN(BlockSize, length - pos);
+
+    uint32_t compLength = 0;
+    bool success = FileIO::fread(&compLength, sizeof(compLength), 1, file->f) == 1 &&
+                   compLength <= file->compressed.size() &&
+                   FileIO::fread(file->compressed.data(), 1, compLength, file->f) == compLength;
+
+    if(success)
+      success = LZ4_decompress_safe((const char *)file->compressed.data(),
+                                    (char *)file->decompressed.data(), (int)compLength,
+                                    blockLength) == blockLength;
+
+    if(!success)
+    {
+      RDCERR("Failed to read back spilled chunk from %s", file->path.c_str());
+      // write zeroes so the rest of the capture is still well-formed
+      memset(file->decompressed.data(), 0, BlockSize);
+      for(; pos < length; pos += BlockSize)
+        writer->Write(file->decompressed.data(), RDCMIN(BlockSize, length - pos));
+      return;
+    }
+
+    writer->Write(file->decompressed.data(), blockLength);
+  }
+}
+
+void AddRef(File *file)
+{
+  SCOPED_LOCK(file->lock);
+  file->refcount++;
+}
+
+void Release(File *file)
+{
+  {
+    SCOPED_LOCK(file->lock);
+    file->refcount--;
+    if(file->refcount > 0)
+      return;
+  }
+
+  if(file->f)
+    FileIO::fclose(file->f);
+  FileIO::Delete(file->path.c_str());
+  delete file;
+}
+};
+
+bool Chunk::Spill(ChunkSpill::File *file)
+{
+  if(m_Borrowed || m_DataRefs || m_Spill || m_Length == 0)
+    return false;
+
+  uint64_t offset = 0;
+  if(!ChunkSpill::Write(file, m_Data, m_Length, offset))
+    return false;
+
+  FreeData();
+
+  m_Data = NULL;
+  m_AdoptedSize = 0;
+  m_Spill = file;
+  m_SpillOffset = offset;
+
+  return true;
+}
 
 #if ENABLED(RDOC_DEVEL)
 
@@ -123,6 +615,8 @@ uint32_t Serialiser<SerialiserMode::Reading>::BeginChunk(uint32_t, uint64_t)
 
     chunkID = c & ChunkIndexMask;
 
+    m_ChunkBufferRefs = (c & ChunkBufferRefs) != 0;
+
     /////////////////
 
     m_ChunkMetadata.chunkID = chunkID;
@@ -332,6 +826,50 @@ void Serialiser<SerialiserMode::Writing>::SetChunkMetadataRecording(uint32_t fla
   m_ChunkFlags = flags;
 }
 
+template <>
+bool Serialiser<SerialiserMode::Writing>::SetBufferDeduplication(bool enabled)
+{
+  m_BufferDedup = enabled && m_Write->IsSeekableOnRead();
+  return m_BufferDedup;
+}
+
+template <>
+bool Serialiser<SerialiserMode::Reading>::SetBufferDeduplication(bool enabled)
+{
+  RDCERR("Buffer deduplication is only set when writing");
+  return false;
+}
+
+template <>
+uint64_t Serialiser<SerialiserMode::Writing>::FindBufferRef(const byte *data, uint64_t byteSize)
+{
+  uint64_t hash = XXH64(data, (size_t)byteSize, 0);
+  uint64_t check = XXH64(data, (size_t)byteSize, byteSize);
+
+  auto it = m_BufferRefs.find(hash);
+  if(it != m_BufferRefs.end())
+  {
+    if(it->second.size == byteSize && it->second.check == check)
+      return it->second.offset;
+
+    // a collision on the first hash, just write this buffer inline
+    return 0;
+  }
+
+  // the data will be written after the 0 reference and aligning
+  BufferRef &ref = m_BufferRefs[hash];
+  ref.check = check;
+  ref.size = byteSize;
+  ref.offset = AlignUp(m_Write->GetOffset() + sizeof(uint64_t), ChunkAlignment);
+  return 0;
+}
+
+template <>
+uint64_t Serialiser<SerialiserMode::Reading>::FindBufferRef(const byte *data, uint64_t byteSize)
+{
+  return 0;
+}
+
 template <>
 uint32_t Serialiser<SerialiserMode::Writing>::BeginChunk(uint32_t chunkID, uint64_t byteLength)
 {
@@ -346,6 +884,10 @@ uint32_t Serialiser<SerialiserMode::Writing>::BeginChunk(uint32_t chunkID, uint6
       c |= m_ChunkFlags;
       if(byteLength > 0xffffffff)
         c |= Chunk64BitSize;
+      if(m_BufferDedup)
+        c |= ChunkBufferRefs;
+
+      m_ChunkBufferRefs = m_BufferDedup;
 
       m_ChunkMetadata.chunkID = chunkID;
 
@@ -490,11 +1032,15 @@ void Serialiser<SerialiserMode::Writing>::EndChunk()
     {
       uint64_t numPadBytes = m_ChunkMetadata.length - writtenLength;
 
-      // need to write some padding bytes so that the length is accurate
-      for(uint64_t i = 0; i < numPadBytes; i++)
+      // need to write some padding bytes so that the length is accurate. This can be large if
+      // a deduplicated buffer was estimated at its full size, so write it in blocks
+      byte padBytes[1024];
+      memset(padBytes, 0xbb, sizeof(padBytes));
+      for(uint64_t remaining = numPadBytes; remaining > 0;)
       {
-        byte padByte = 0xbb;
-        m_Write->Write(padByte);
+        uint64_t numBytes = RDCMIN(remaining, (uint64_t)sizeof(padBytes));
+        m_Write->Write(padBytes, numBytes);
+        remaining -= numBytes;
       }
 
       RDCDEBUG("Chunk estimated at %llu bytes, actual length %llu. Added %llu bytes padding.",
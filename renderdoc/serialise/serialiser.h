@@ -24,9 +24,11 @@
 
 #pragma once
 
+#include <map>
 #include <set>
 #include "api/replay/structured_data.h"
 #include "common/formatting.h"
+#include "common/overhead_counters.h"
 #include "streamio.h"
 
 // function to deallocate anything from a serialise. Default impl
@@ -49,6 +51,26 @@ void Deserialise(const T &el)
   template void DoSerialise(Serialiser<SerialiserMode::Writing> &, type &); \
   template void DoSerialise(Serialiser<SerialiserMode::Reading> &, type &);
 
+// types whose serialised bytes are exactly their in-memory bytes, so arrays of them can be read and
+// written with one copy when structured data isn't being exported. Basic types and enums qualify
+// automatically. A struct can opt in with DECLARE_BULK_SERIALISE_TYPE only if it has no padding and
+// its DoSerialise serialises every member in declaration order with nothing but basic types or
+// other bulk types - in particular no ResourceIds, which are remapped on read.
+template <typename T>
+struct IsBulkSerialisable
+{
+  static const bool value =
+      (std::is_arithmetic<T>::value || std::is_enum<T>::value) && !std::is_same<T, bool>::value;
+};
+
+#define DECLARE_BULK_SERIALISE_TYPE(type)                                                   \
+  template <>                                                                               \
+  struct IsBulkSerialisable<type>                                                           \
+  {                                                                                         \
+    RDCCOMPILE_ASSERT(std::is_trivially_copyable<type>::value, "bulk type must be trivial"); \
+    static const bool value = true;                                                         \
+  }
+
 typedef rdcstr (*ChunkLookup)(uint32_t chunkType);
 
 enum class SerialiserFlags
@@ -105,8 +127,15 @@ public:
     ChunkDuration = 0x00040000,
     ChunkTimestamp = 0x00080000,
     Chunk64BitSize = 0x00100000,
+    // large byte buffers in this chunk are preceded by the offset of an earlier, identical copy
+    // in the stream - or 0 if the data follows inline. See SetBufferDeduplication
+    ChunkBufferRefs = 0x00200000,
   };
 
+  // buffers smaller than this are always written inline, as it's not worth the hashing or the seek
+  // on read to deduplicate them
+  static const uint64_t BufferDedupMinSize = 64 * 1024;
+
   //////////////////////////////////////////
   // Init and error handling
   ~Serialiser();
@@ -121,6 +150,11 @@ public:
   uint32_t GetChunkMetadataRecording() { return m_ChunkFlags; }
   void SetChunkMetadataRecording(uint32_t flags);
 
+  // only valid for writing. While enabled, large byte buffers with the same contents as one
+  // written earlier are stored as a reference to the earlier copy. The reader has to seek back to
+  // fetch them, so this is only enabled (and returns true) if the stream allows that.
+  bool SetBufferDeduplication(bool enabled);
+
 // debug-only option to dump out (roughly) the data going through the serialiser as it happens
 #if ENABLED(RDOC_DEVEL)
   void EnableDumping(FileIO::LogFileHandle *debugLog) { m_DebugDumpLog = debugLog; }
@@ -131,6 +165,10 @@ public:
   // Utility functions
 
   static uint64_t GetChunkAlignment() { return ChunkAlignment; }
+  // the most a byte buffer can take up on top of its own size - the alignment padding, plus the
+  // reference to an earlier copy when buffer deduplication is enabled. Use this when estimating
+  // the size of chunks that may contain deduplicated buffers.
+  static uint64_t GetBufferOverhead() { return ChunkAlignment + sizeof(uint64_t); }
   void *GetUserData() { return m_pUserData; }
   void SetUserData(void *userData) { m_pUserData = userData; }
   void SetStringDatabase(std::set<rdcstr> *db) { m_ExtStringDB = db; }
@@ -228,12 +266,17 @@ public:
       obj.type.byteSize = sizeof(T);
       if(std::is_union<T>::value)
         obj.type.flags |= SDTypeFlags::Union;
+
+      ReserveStructMembers<T>(obj);
     }
 
     SerialiseDispatch<Serialiser, T>::Do(*this, el);
 
     if(ExportStructure())
+    {
+      RecordStructMembers<T>(*m_StructureStack.back());
       m_StructureStack.pop_back();
+    }
 
     return *this;
   }
@@ -277,23 +320,47 @@ public:
     }
 
     byte *tempAlloc = NULL;
+    const byte *directData = NULL;
 
     {
       if(IsWriting())
       {
+        // the reference goes before the alignment. It can push the data onto the next aligned
+        // offset, so it's accounted for in GetBufferOverhead()
+        uint64_t refOffset = 0;
+        if(m_ChunkBufferRefs && byteSize >= BufferDedupMinSize)
+        {
+          refOffset = FindBufferRef(el, byteSize);
+          m_Write->Write(refOffset);
+        }
+
         // ensure byte alignment
         m_Write->AlignTo<ChunkAlignment>();
 
-        if(el)
-          m_Write->Write(el, byteSize);
-        else
-          RDCASSERT(byteSize == 0);
+        // if there's an earlier copy the data isn't written again
+        if(refOffset == 0)
+        {
+          if(el)
+            m_Write->Write(el, byteSize);
+          else
+            RDCASSERT(byteSize == 0);
+        }
       }
       else if(IsReading())
       {
+        uint64_t refOffset = 0;
+        if(m_ChunkBufferRefs && byteSize >= BufferDedupMinSize)
+          m_Read->Read(refOffset);
+
         // ensure byte alignment
         m_Read->AlignTo<ChunkAlignment>();
 
+        // if the data is only needed for export and the stream is in memory (e.g. a mapped file)
+        // we can copy it out directly instead of going via a temporary allocation.
+        if(el == NULL && !(flags & SerialiserFlags::AllocateMemory) && ExportStructure() &&
+           m_ExportBuffers && refOffset == 0)
+          directData = m_Read->ReadDirect(byteSize);
+
 // Coverity is unable to tie this allocation together with the automatic scoped deallocation in the
 // ScopedDeseralise* classes. We can verify with e.g. valgrind that there are no leaks, so to keep
 // the analysis non-spammy we just don't allocate for coverity builds
@@ -309,7 +376,7 @@ public:
         // if we're exporting the buffers, make sure to always alloc space to read the data, so we
         // can save it out, even if the external code has no use for it and has asked for no
         // allocation.
-        if(el == NULL && ExportStructure() && m_ExportBuffers)
+        if(el == NULL && directData == NULL && ExportStructure() && m_ExportBuffers)
         {
           if(byteSize > 0)
             el = tempAlloc = AllocAlignedBuffer(byteSize);
@@ -318,7 +385,22 @@ public:
         }
 #endif
 
-        m_Read->Read(el, byteSize);
+        if(refOffset)
+        {
+          // the data was written earlier in the stream, jump back to read it then return here. If
+          // nothing wants the data there's nothing to skip either.
+          if(el)
+          {
+            uint64_t resumeOffset = m_Read->GetOffset();
+            m_Read->SetOffset(refOffset);
+            m_Read->Read(el, byteSize);
+            m_Read->SetOffset(resumeOffset);
+          }
+        }
+        else if(directData == NULL)
+        {
+          m_Read->Read(el, byteSize);
+        }
       }
     }
 
@@ -334,6 +416,8 @@ public:
         alloc->resize((size_t)byteSize);
         if(el)
           memcpy(alloc->data(), el, (size_t)byteSize);
+        else if(directData)
+          memcpy(alloc->data(), directData, (size_t)byteSize);
 
         m_StructuredFile->buffers.push_back(alloc);
       }
@@ -516,6 +600,8 @@ public:
         if(std::is_union<T>::value)
           obj.type.flags |= SDTypeFlags::Union;
 
+        ReserveStructMembers<T>(obj);
+
         // Check against the serialised count here - on read if we don't have the right size this
         // means we won't read past the provided data.
         if(i < count)
@@ -528,6 +614,7 @@ public:
           el[i] = T();
         }
 
+        RecordStructMembers<T>(obj);
         m_StructureStack.pop_back();
       }
 
@@ -546,8 +633,7 @@ public:
     }
     else
     {
-      for(size_t i = 0; i < N && i < count; i++)
-        SerialiseDispatch<Serialiser, T>::Do(*this, el[i]);
+      SerialiseArrayDispatch<Serialiser, T>::Do(*this, el, RDCMIN((size_t)count, N));
 
       for(size_t i = N; i < count; i++)
       {
@@ -650,8 +736,11 @@ public:
         if(std::is_union<T>::value)
           obj.type.flags |= SDTypeFlags::Union;
 
+        ReserveStructMembers<T>(obj);
+
         SerialiseDispatch<Serialiser, T>::Do(*this, el[i]);
 
+        RecordStructMembers<T>(obj);
         m_StructureStack.pop_back();
       }
 
@@ -672,8 +761,8 @@ public:
       }
 #endif
 
-      for(size_t i = 0; el && i < arrayCount; i++)
-        SerialiseDispatch<Serialiser, T>::Do(*this, el[i]);
+      if(el)
+        SerialiseArrayDispatch<Serialiser, T>::Do(*this, el, (size_t)arrayCount);
     }
 
     return *this;
@@ -731,8 +820,11 @@ public:
         obj.type.basetype = SDBasic::Struct;
         obj.type.byteSize = sizeof(U);
 
+        ReserveStructMembers<U>(obj);
+
         SerialiseDispatch<Serialiser, U>::Do(*this, el[i]);
 
+        RecordStructMembers<U>(obj);
         m_StructureStack.pop_back();
       }
 
@@ -743,8 +835,7 @@ public:
       if(IsReading())
         el.resize((int)size);
 
-      for(size_t i = 0; i < (size_t)size; i++)
-        SerialiseDispatch<Serialiser, U>::Do(*this, el[i]);
+      SerialiseArrayDispatch<Serialiser, U>::Do(*this, el.data(), (size_t)size);
     }
 
     return *this;
@@ -1244,6 +1335,29 @@ protected:
   void SetDummy(bool dummy) { m_Dummy = dummy; }
 private:
   static const uint64_t ChunkAlignment = 64;
+
+  // the number of members a struct type had the last time it was exported. Struct members are
+  // pushed one at a time, so without this the member list of every struct regrows from empty and
+  // ends up over-allocated. It's only a hint so unsynchronised access between threads is fine.
+  template <class T>
+  static volatile int32_t &StructMemberHint()
+  {
+    static volatile int32_t hint = 0;
+    return hint;
+  }
+
+  template <class T>
+  void ReserveStructMembers(SDObject &obj)
+  {
+    obj.data.children.reserve((size_t)StructMemberHint<T>());
+  }
+
+  template <class T>
+  void RecordStructMembers(const SDObject &obj)
+  {
+    if(obj.type.basetype == SDBasic::Struct)
+      StructMemberHint<T>() = (int32_t)obj.NumChildren();
+  }
   template <class SerialiserMode, typename T, bool isEnum = std::is_enum<T>::value>
   struct SerialiseDispatch
   {
@@ -1266,6 +1380,33 @@ private:
     }
   };
 
+  // arrays serialise their elements one by one, unless the element type is bulk serialisable in
+  // which case the whole array is copied in one go.
+  template <class SerialiserMode, typename T, bool isBulk = IsBulkSerialisable<T>::value>
+  struct SerialiseArrayDispatch
+  {
+    static void Do(SerialiserMode &ser, T *el, size_t count)
+    {
+      for(size_t i = 0; i < count; i++)
+        SerialiseDispatch<SerialiserMode, T>::Do(ser, el[i]);
+    }
+  };
+
+  template <class SerialiserMode, typename T>
+  struct SerialiseArrayDispatch<SerialiserMode, T, true>
+  {
+    static void Do(SerialiserMode &ser, T *el, size_t count)
+    {
+      if(count == 0)
+        return;
+
+      if(ser.IsWriting())
+        ser.m_Write->Write(el, count * sizeof(T));
+      else if(ser.IsReading())
+        ser.m_Read->Read(el, count * sizeof(T));
+    }
+  };
+
   void VerifyArraySize(uint64_t &count)
   {
     uint64_t size = m_Read->GetSize();
@@ -1320,6 +1461,23 @@ private:
   uint32_t m_ChunkFlags = 0;
   SDChunkMetaData m_ChunkMetadata;
 
+  // see SetBufferDeduplication. Buffers written so far are looked up by one hash of their contents,
+  // and a second independent hash guards against collisions.
+  struct BufferRef
+  {
+    uint64_t check;
+    uint64_t size;
+    uint64_t offset;
+  };
+  std::map<uint64_t, BufferRef> m_BufferRefs;
+  bool m_BufferDedup = false;
+  // whether the current chunk has ChunkBufferRefs set
+  bool m_ChunkBufferRefs = false;
+
+  // returns the offset of an earlier copy of this data, or 0 if there isn't one - in which case it
+  // is recorded as being about to be written at the current offset.
+  uint64_t FindBufferRef(const byte *data, uint64_t byteSize);
+
   // a database of strings read from the file, useful when serialised structures
   // expect a char* to return and point to static memory
   std::set<rdcstr> m_StringDB;
@@ -1449,16 +1607,110 @@ class ScopedChunk;
 
 // holds the memory, length and type for a given chunk, so that it can be
 // passed around and moved between owners before being serialised out
+// chunks are small and there are a great many of them during capture, so rather than a heap
+// allocation each they're bump-allocated out of shared slabs. Each slab is freed in one go once the
+// last chunk allocated from it is deleted. Allocations too large for a slab fall back to the heap.
+namespace ChunkAllocator
+{
+void *Allocate(size_t size);
+void Free(void *ptr);
+
+// stop allocating from the slabs currently in use, so that they can be freed as soon as their
+// chunks are. Called at the end of each frame so one frame's chunks don't pin the next frame's.
+void ReleaseCurrentSlabs();
+
+// chunks at least this large take over the serialiser's buffer instead of copying out of it, and
+// the serialiser carries on with a replacement buffer. Freed chunk buffers are pooled to be handed
+// back out as replacements.
+const uint64_t MinAdoptSize = 64 * 1024;
+byte *AcquireWriteBuffer(uint64_t &size);
+void ReleaseWriteBuffer(byte *buffer, uint64_t size);
+
+#if ENABLED(RDOC_DEVEL)
+uint64_t NumLiveSlabs();
+uint64_t SlabMem();
+#else
+inline uint64_t NumLiveSlabs()
+{
+  return 0;
+}
+inline uint64_t SlabMem()
+{
+  return 0;
+}
+#endif
+};
+
+class Chunk;
+
+// while capturing with a memory budget, once the frame's chunks have grown past the budget any
+// further chunks recorded into frame records are compressed out to a temporary file and their
+// memory freed. They're streamed back out of the file a block at a time when the capture is
+// written.
+namespace ChunkSpill
+{
+struct File;
+
+// start counting frame chunk memory against the given budget in bytes. 0 disables spilling
+void BeginCapture(uint64_t budget);
+// stop spilling chunks. Any that were spilled stay readable until they're deleted
+void EndCapture();
+// count a newly recorded frame chunk against the budget, spilling it if the budget is exceeded
+void Consider(Chunk *chunk);
+// called when a chunk that was counted and kept in memory is deleted, to stop counting it. The
+// capture it was counted in is passed so that chunks outliving their capture don't affect the next
+void Uncount(int32_t capture, uint32_t length);
+
+// the total size of chunk data spilled, before compression, since the last BeginCapture()
+uint64_t SpilledBytes();
+
+bool Write(File *file, const byte *data, uint32_t length, uint64_t &offset);
+void Stream(File *file, uint64_t offset, uint32_t length, StreamWriter *writer);
+void AddRef(File *file);
+void Release(File *file);
+};
+
 class Chunk
 {
 public:
+  static void *operator new(size_t size) { return ChunkAllocator::Allocate(size); }
+  static void operator delete(void *ptr) { ChunkAllocator::Free(ptr); }
   ~Chunk()
   {
-    FreeAlignedBuffer(m_Data);
+    if(m_SpillCapture)
+      ChunkSpill::Uncount(m_SpillCapture, m_Length);
+
+    // borrowed data is owned and freed by whatever it was borrowed from, and spilled data only
+    // needs its reference on the spill file released
+    if(m_Borrowed || m_Spill)
+    {
+      if(m_Spill)
+        ChunkSpill::Release(m_Spill);
+
+#if ENABLED(RDOC_DEVEL)
+      Atomic::Dec64(&m_LiveChunks);
+#endif
+      return;
+    }
+
+    // shared data is only freed along with the last chunk referencing it
+    if(m_DataRefs)
+    {
+      if(Atomic::Dec32(m_DataRefs) > 0)
+      {
+#if ENABLED(RDOC_DEVEL)
+        Atomic::Dec64(&m_LiveChunks);
+#endif
+        return;
+      }
+
+      delete m_DataRefs;
+    }
+
+    FreeData();
 
 #if ENABLED(RDOC_DEVEL)
     Atomic::Dec64(&m_LiveChunks);
-    Atomic::ExchAdd64(&m_TotalMem, -int64_t(m_Length));
 #endif
   }
 
@@ -1478,17 +1730,35 @@ public:
   // grab current contents of the serialiser into this chunk
   Chunk(Serialiser<SerialiserMode::Writing> &ser, uint32_t chunkType)
   {
-    m_Length = (uint32_t)ser.GetWriter()->GetOffset();
+    StreamWriter *writer = ser.GetWriter();
 
-    RDCASSERT(ser.GetWriter()->GetOffset() < 0xffffffff);
+    m_Length = (uint32_t)writer->GetOffset();
+
+    RDCASSERT(writer->GetOffset() < 0xffffffff);
 
     m_ChunkType = chunkType;
 
-    m_Data = AllocAlignedBuffer(m_Length);
+    // big chunks adopt the writer's buffer, unless that would pin a lot more memory than the chunk
+    // actually uses
+    if(m_Length >= ChunkAllocator::MinAdoptSize &&
+       writer->GetBufferSize() <= uint64_t(m_Length) * 2)
+    {
+      uint64_t newSize = 0;
+      byte *newBuffer = ChunkAllocator::AcquireWriteBuffer(newSize);
+
+      m_AdoptedSize = writer->GetBufferSize();
+      m_Data = writer->DetachBuffer(newBuffer, newSize);
+    }
+    else
+    {
+      m_Data = (byte *)ChunkAllocator::Allocate(m_Length);
+
+      memcpy(m_Data, writer->GetData(), (size_t)m_Length);
 
-    memcpy(m_Data, ser.GetWriter()->GetData(), (size_t)m_Length);
+      writer->Rewind();
+    }
 
-    ser.GetWriter()->Rewind();
+    OverheadCounters::Add(OverheadCounter::SerialisedChunks, 1);
 
 #if ENABLED(RDOC_DEVEL)
     Atomic::Inc64(&m_LiveChunks);
@@ -1496,14 +1766,39 @@ public:
 #endif
   }
 
-  byte *GetData() const { return m_Data; }
+  // creates a chunk referencing data owned elsewhere, such as by a ChunkStream, which must outlive
+  // the chunk
+  Chunk(uint32_t chunkType, byte *data, uint32_t length)
+      : m_ChunkType(chunkType), m_Length(length), m_Data(data), m_Borrowed(true)
+  {
+#if ENABLED(RDOC_DEVEL)
+    Atomic::Inc64(&m_LiveChunks);
+#endif
+  }
+
+  // not valid for spilled chunks, which only have their data on disk
+  byte *GetData() const
+  {
+    RDCASSERTMSG("Spilled chunk data isn't in memory", !m_Spill);
+    return m_Data;
+  }
+  bool IsSpilled() const { return m_Spill != NULL; }
+  uint32_t GetLength() const { return m_Length; }
+  // compresses the chunk's data out to the spill file and frees it. Only chunks that own their data
+  // outright can be spilled.
+  bool Spill(ChunkSpill::File *file);
+
   Chunk *Duplicate()
   {
+    // spilled data is never modified, so a duplicate can read it from the same place
+    if(m_Spill)
+      return Share();
+
     Chunk *ret = new Chunk();
     ret->m_Length = m_Length;
     ret->m_ChunkType = m_ChunkType;
 
-    ret->m_Data = AllocAlignedBuffer(m_Length);
+    ret->m_Data = (byte *)ChunkAllocator::Allocate(m_Length);
 
     memcpy(ret->m_Data, m_Data, (size_t)m_Length);
 
@@ -1515,9 +1810,57 @@ public:
     return ret;
   }
 
+  // returns a new chunk referencing this chunk's data instead of copying it. The data is refcounted
+  // and freed with whichever chunk is deleted last. Chunk data is never modified once created so
+  // this can be used anywhere a duplicate is only recorded somewhere else. Not safe to call
+  // concurrently on the same chunk.
+  Chunk *Share()
+  {
+    RDCASSERTMSG("Borrowed chunks can't be shared", !m_Borrowed);
+
+    if(m_Spill)
+    {
+      ChunkSpill::AddRef(m_Spill);
+
+      Chunk *ret = new Chunk();
+      ret->m_Length = m_Length;
+      ret->m_ChunkType = m_ChunkType;
+      ret->m_Data = NULL;
+      ret->m_Spill = m_Spill;
+      ret->m_SpillOffset = m_SpillOffset;
+
+#if ENABLED(RDOC_DEVEL)
+      Atomic::Inc64(&m_LiveChunks);
+#endif
+
+      return ret;
+    }
+
+    if(!m_DataRefs)
+      m_DataRefs = new int32_t(1);
+
+    Atomic::Inc32(m_DataRefs);
+
+    Chunk *ret = new Chunk();
+    ret->m_Length = m_Length;
+    ret->m_ChunkType = m_ChunkType;
+    ret->m_Data = m_Data;
+    ret->m_AdoptedSize = m_AdoptedSize;
+    ret->m_DataRefs = m_DataRefs;
+
+#if ENABLED(RDOC_DEVEL)
+    Atomic::Inc64(&m_LiveChunks);
+#endif
+
+    return ret;
+  }
+
   void Write(Serialiser<SerialiserMode::Writing> &ser)
   {
-    ser.GetWriter()->Write((const void *)m_Data, (size_t)m_Length);
+    if(m_Spill)
+      ChunkSpill::Stream(m_Spill, m_SpillOffset, m_Length, ser.GetWriter());
+    else
+      ser.GetWriter()->Write((const void *)m_Data, (size_t)m_Length);
   }
 
 private:
@@ -1525,18 +1868,86 @@ private:
   Chunk(const Chunk &) = delete;
   Chunk &operator=(const Chunk &) = delete;
 
+  // frees owned data, that isn't shared with any other chunk
+  void FreeData()
+  {
+    if(m_AdoptedSize)
+      ChunkAllocator::ReleaseWriteBuffer(m_Data, m_AdoptedSize);
+    else
+      ChunkAllocator::Free(m_Data);
+
+#if ENABLED(RDOC_DEVEL)
+    Atomic::ExchAdd64(&m_TotalMem, -int64_t(m_Length));
+#endif
+  }
+
   friend class ScopedChunk;
+  friend void ChunkSpill::Consider(Chunk *chunk);
 
   uint32_t m_ChunkType;
 
   uint32_t m_Length;
   byte *m_Data;
 
+  // if non-zero, m_Data is a serialiser buffer of this size that the chunk adopted
+  uint64_t m_AdoptedSize = 0;
+
+  // if non-NULL, m_Data is shared between several chunks and this is the number referencing it
+  volatile int32_t *m_DataRefs = NULL;
+
+  // if true, m_Data isn't owned by this chunk at all
+  bool m_Borrowed = false;
+
+  // if non-NULL, m_Data has been freed and the data is in this spill file at m_SpillOffset
+  ChunkSpill::File *m_Spill = NULL;
+  uint64_t m_SpillOffset = 0;
+
+  // if non-zero, the capture in which this chunk was counted against the spill budget while its
+  // data stayed in memory
+  int32_t m_SpillCapture = 0;
+
 #if ENABLED(RDOC_DEVEL)
   static int64_t m_LiveChunks, m_TotalMem;
 #endif
 };
 
+// a contiguous stream of chunks, for records that accumulate a great many small chunks like command
+// buffers. Chunks are copied straight out of the serialiser into shared blocks, with only an index
+// entry each, and are only turned into Chunk objects if they're needed.
+class ChunkStream
+{
+public:
+  ChunkStream() = default;
+  ~ChunkStream();
+
+  // takes the current contents of the serialiser, as a chunk of the given type and ID
+  void Append(Serialiser<SerialiserMode::Writing> &ser, uint32_t chunkType, int32_t ID);
+
+  // moves every chunk in the stream into the list, emptying the stream. The chunks borrow the
+  // stream's memory, so they must be deleted before the stream is.
+  void TakeChunks(rdcarray<rdcpair<int32_t, Chunk *>> &chunks);
+
+  size_t NumChunks() const { return m_Entries.size(); }
+private:
+  ChunkStream(const ChunkStream &) = delete;
+  ChunkStream &operator=(const ChunkStream &) = delete;
+
+  struct Entry
+  {
+    int32_t ID;
+    uint32_t chunkType;
+    uint32_t length;
+    byte *data;
+    // chunks too big to be worth copying into a block are kept as normal chunks
+    Chunk *chunk;
+  };
+
+  rdcarray<Entry> m_Entries;
+
+  rdcarray<rdcpair<byte *, uint64_t>> m_Blocks;
+  uint64_t m_BlockUsed = 0;
+};
+
 #ifndef SERIALISER_IMPL
 class ScopedChunk
 {
@@ -1559,6 +1970,13 @@ public:
     return new Chunk(m_Ser, m_Idx);
   }
 
+  // appends the chunk to a stream, rather than allocating a Chunk for it
+  void Stream(ChunkStream &stream, int32_t ID)
+  {
+    End();
+    stream.Append(m_Ser, m_Idx, ID);
+  }
+
 private:
   WriteSerialiser &m_Ser;
   uint32_t m_Idx;
@@ -720,6 +720,532 @@ TEST_CASE("Verify multiple chunks can be merged", "[serialiser][chunks]")
   delete buf;
 };
 
+TEST_CASE("Chunk allocations from slabs", "[serialiser][chunks]")
+{
+  ChunkAllocator::ReleaseCurrentSlabs();
+
+  uint64_t baseSlabs = ChunkAllocator::NumLiveSlabs();
+
+  // enough small allocations to span several slabs, plus some too large for a slab
+  rdcarray<byte *> allocs;
+  for(uint32_t i = 0; i < 4000; i++)
+  {
+    size_t size = (i % 100 == 0) ? 20000 + i : 40 + (i % 300);
+    byte *mem = (byte *)ChunkAllocator::Allocate(size);
+
+    CHECK(((uintptr_t)mem % 16) == 0);
+    memset(mem, i & 0xff, size);
+
+    allocs.push_back(mem);
+  }
+
+  // check nothing overlapped
+  for(uint32_t i = 0; i < 4000; i++)
+    CHECK(allocs[i][0] == byte(i & 0xff));
+
+#if ENABLED(RDOC_DEVEL)
+  CHECK(ChunkAllocator::NumLiveSlabs() > baseSlabs);
+#endif
+
+  ChunkAllocator::ReleaseCurrentSlabs();
+
+  // slabs stay alive until their last allocation is freed
+  for(size_t i = 0; i < allocs.size(); i++)
+    ChunkAllocator::Free(allocs[i]);
+
+  CHECK(ChunkAllocator::NumLiveSlabs() == baseSlabs);
+};
+
+TEST_CASE("Large chunks adopt the serialiser buffer", "[serialiser][chunks]")
+{
+  enum ChunkType
+  {
+    BIG_DATA = 5,
+    SMALL_INT,
+  };
+
+  bytebuf payload;
+  payload.resize(512 * 1024);
+  for(size_t i = 0; i < payload.size(); i++)
+    payload[i] = byte((i * 31) >> 3);
+
+  rdcarray<Chunk *> chunks;
+  {
+    WriteSerialiser ser(new StreamWriter(StreamWriter::DefaultScratchSize), Ownership::Stream);
+
+    // alternate big and small chunks so the adopted buffers get replaced and reused
+    for(int i = 0; i < 3; i++)
+    {
+      {
+        SCOPED_SERIALISE_CHUNK(BIG_DATA);
+        SERIALISE_ELEMENT(payload);
+        chunks.push_back(scope.Get());
+      }
+
+      {
+        SCOPED_SERIALISE_CHUNK(SMALL_INT);
+        SERIALISE_ELEMENT(i);
+        chunks.push_back(scope.Get());
+      }
+    }
+
+    REQUIRE_FALSE(ser.IsErrored());
+  }
+
+  StreamWriter *buf = new StreamWriter(StreamWriter::DefaultScratchSize);
+
+  {
+    WriteSerialiser ser(buf, Ownership::Nothing);
+
+    for(Chunk *c : chunks)
+      c->Write(ser);
+  }
+
+  for(Chunk *c : chunks)
+    delete c;
+
+  {
+    ReadSerialiser ser(new StreamReader(buf->GetData(), buf->GetOffset()), Ownership::Stream);
+
+    for(int i = 0; i < 3; i++)
+    {
+      CHECK(ser.ReadChunk<uint32_t>() == (uint32_t)BIG_DATA);
+      bytebuf readPayload;
+      SERIALISE_ELEMENT(readPayload);
+      CHECK((readPayload == payload));
+      ser.EndChunk();
+
+      CHECK(ser.ReadChunk<uint32_t>() == (uint32_t)SMALL_INT);
+      int readInt = -1;
+      SERIALISE_ELEMENT(readInt);
+      CHECK(readInt == i);
+      ser.EndChunk();
+    }
+
+    CHECK_FALSE(ser.IsErrored());
+    CHECK(ser.GetReader()->AtEnd());
+  }
+
+  delete buf;
+};
+
+TEST_CASE("Shared chunks outlive the chunk they were shared from", "[serialiser][chunks]")
+{
+  enum ChunkType
+  {
+    INT_DATA = 5,
+  };
+
+  Chunk *original = NULL;
+  {
+    WriteSerialiser ser(new StreamWriter(StreamWriter::DefaultScratchSize), Ownership::Stream);
+
+    SCOPED_SERIALISE_CHUNK(INT_DATA);
+    uint32_t value = 0x1234;
+    SERIALISE_ELEMENT(value);
+    original = scope.Get();
+  }
+
+  Chunk *shared[3] = {};
+  for(Chunk *&c : shared)
+    c = original->Share();
+
+  CHECK(shared[0]->GetData() == original->GetData());
+  CHECK(shared[0]->GetChunkType<uint32_t>() == (uint32_t)INT_DATA);
+
+  StreamWriter *buf = new StreamWriter(StreamWriter::DefaultScratchSize);
+
+  {
+    WriteSerialiser ser(buf, Ownership::Nothing);
+
+    original->Write(ser);
+
+    // deleting the original and some shares in any order leaves the last one valid
+    delete original;
+    delete shared[1];
+
+    shared[0]->Write(ser);
+    delete shared[0];
+
+    shared[2]->Write(ser);
+    delete shared[2];
+  }
+
+  {
+    ReadSerialiser ser(new StreamReader(buf->GetData(), buf->GetOffset()), Ownership::Stream);
+
+    for(int i = 0; i < 3; i++)
+    {
+      CHECK(ser.ReadChunk<uint32_t>() == (uint32_t)INT_DATA);
+      uint32_t value = 0;
+      SERIALISE_ELEMENT(value);
+      CHECK(value == 0x1234);
+      ser.EndChunk();
+    }
+
+    CHECK_FALSE(ser.IsErrored());
+    CHECK(ser.GetReader()->AtEnd());
+  }
+
+  delete buf;
+};
+
+TEST_CASE("Streamed chunks are written out in ID order", "[serialiser][chunks]")
+{
+  enum ChunkType
+  {
+    INT_DATA = 5,
+    BIG_DATA,
+  };
+
+  bytebuf payload;
+  payload.resize(StreamWriter::DefaultScratchSize);
+  for(size_t i = 0; i < payload.size(); i++)
+    payload[i] = byte((i * 13) >> 2);
+
+  rdcarray<rdcpair<int32_t, Chunk *>> chunks;
+
+  {
+    ChunkStream stream;
+
+    {
+      WriteSerialiser ser(new StreamWriter(StreamWriter::DefaultScratchSize), Ownership::Stream);
+
+      // enough small chunks to span several blocks, with the occasional one too big to stream.
+      // IDs are appended in reverse to check that they're kept with their chunk
+      for(uint32_t i = 0; i < 5000; i++)
+      {
+        if(i % 1000 == 500)
+        {
+          SCOPED_SERIALISE_CHUNK(BIG_DATA);
+          SERIALISE_ELEMENT(payload);
+          scope.Stream(stream, int32_t(10000 - i));
+        }
+        else
+        {
+          SCOPED_SERIALISE_CHUNK(INT_DATA);
+          SERIALISE_ELEMENT(i);
+          scope.Stream(stream, int32_t(10000 - i));
+        }
+      }
+
+      REQUIRE_FALSE(ser.IsErrored());
+    }
+
+    CHECK(stream.NumChunks() == 5000);
+
+    stream.TakeChunks(chunks);
+
+    CHECK(stream.NumChunks() == 0);
+    REQUIRE(chunks.size() == 5000);
+
+    std::map<int32_t, Chunk *> recordlist;
+    for(const rdcpair<int32_t, Chunk *> &c : chunks)
+      recordlist[c.first] = c.second;
+
+    StreamWriter *buf = new StreamWriter(StreamWriter::DefaultScratchSize);
+
+    {
+      WriteSerialiser ser(buf, Ownership::Nothing);
+
+      for(auto it = recordlist.begin(); it != recordlist.end(); ++it)
+        it->second->Write(ser);
+    }
+
+    // the chunks must be deleted before the stream they borrow from
+    for(const rdcpair<int32_t, Chunk *> &c : chunks)
+      delete c.second;
+
+    ReadSerialiser ser(new StreamReader(buf->GetData(), buf->GetOffset()), Ownership::Stream);
+
+    for(uint32_t i = 4999; i < 5000; i--)
+    {
+      CAPTURE(i);
+      if(i % 1000 == 500)
+      {
+        CHECK(ser.ReadChunk<uint32_t>() == (uint32_t)BIG_DATA);
+        bytebuf readPayload;
+        SERIALISE_ELEMENT(readPayload);
+        CHECK((readPayload == payload));
+      }
+      else
+      {
+        CHECK(ser.ReadChunk<uint32_t>() == (uint32_t)INT_DATA);
+        uint32_t value = ~0U;
+        SERIALISE_ELEMENT(value);
+        CHECK(value == i);
+      }
+      ser.EndChunk();
+    }
+
+    CHECK_FALSE(ser.IsErrored());
+    CHECK(ser.GetReader()->AtEnd());
+
+    delete buf;
+  }
+};
+
+TEST_CASE("Chunks past the capture memory budget are spilled and streamed back",
+          "[serialiser][chunks]")
+{
+  enum ChunkType
+  {
+    PAYLOAD = 7,
+  };
+
+  // big enough to span several compression blocks, and not a multiple of the block size
+  bytebuf payload;
+  payload.resize(150 * 1024 + 37);
+  for(size_t i = 0; i < payload.size(); i++)
+    payload[i] = byte((i * 29) >> 3);
+
+  const uint32_t numChunks = 10;
+
+  rdcarray<Chunk *> chunks;
+
+  ChunkSpill::BeginCapture(400 * 1024);
+
+  {
+    WriteSerialiser ser(new StreamWriter(StreamWriter::DefaultScratchSize), Ownership::Stream);
+
+    for(uint32_t i = 0; i < numChunks; i++)
+    {
+      SCOPED_SERIALISE_CHUNK(PAYLOAD);
+      SERIALISE_ELEMENT(i);
+      SERIALISE_ELEMENT(payload);
+
+      Chunk *chunk = scope.Get();
+      ChunkSpill::Consider(chunk);
+      chunks.push_back(chunk);
+    }
+
+    REQUIRE_FALSE(ser.IsErrored());
+  }
+
+  ChunkSpill::EndCapture();
+
+  // the first two chunks fit in the budget, the rest are spilled
+  CHECK_FALSE(chunks[0]->IsSpilled());
+  CHECK_FALSE(chunks[1]->IsSpilled());
+  for(uint32_t i = 2; i < numChunks; i++)
+    CHECK(chunks[i]->IsSpilled());
+
+  CHECK(ChunkSpill::SpilledBytes() == uint64_t(chunks[2]->GetLength()) * (numChunks - 2));
+
+  // a shared spilled chunk reads from the same place and keeps the spill file alive
+  Chunk *shared = chunks[5]->Share();
+  CHECK(shared->IsSpilled());
+  delete chunks[5];
+  chunks[5] = shared;
+
+  StreamWriter *buf = new StreamWriter(StreamWriter::DefaultScratchSize);
+
+  {
+    WriteSerialiser ser(buf, Ownership::Nothing);
+
+    // write out of order, to check that reading back from the spill file seeks correctly
+    for(uint32_t i = numChunks; i > 0; i--)
+      chunks[i - 1]->Write(ser);
+  }
+
+  for(Chunk *c : chunks)
+    delete c;
+
+  ReadSerialiser ser(new StreamReader(buf->GetData(), buf->GetOffset()), Ownership::Stream);
+
+  for(uint32_t i = numChunks; i > 0; i--)
+  {
+    CAPTURE(i);
+
+    CHECK(ser.ReadChunk<uint32_t>() == (uint32_t)PAYLOAD);
+
+    uint32_t idx = ~0U;
+    bytebuf readPayload;
+    SERIALISE_ELEMENT(idx);
+    SERIALISE_ELEMENT(readPayload);
+
+    CHECK(idx == i - 1);
+    CHECK((readPayload == payload));
+
+    ser.EndChunk();
+  }
+
+  CHECK_FALSE(ser.IsErrored());
+  CHECK(ser.GetReader()->AtEnd());
+
+  delete buf;
+};
+
+TEST_CASE("Deleted chunks stop counting against the capture memory budget", "[serialiser][chunks]")
+{
+  enum ChunkType
+  {
+    PAYLOAD = 7,
+  };
+
+  bytebuf payload;
+  payload.resize(150 * 1024);
+
+  // from a previous capture, deleted during the next one
+  Chunk *oldChunk = NULL;
+
+  ChunkSpill::BeginCapture(400 * 1024);
+
+  {
+    WriteSerialiser ser(new StreamWriter(StreamWriter::DefaultScratchSize), Ownership::Stream);
+
+    {
+      SCOPED_SERIALISE_CHUNK(PAYLOAD);
+      SERIALISE_ELEMENT(payload);
+      oldChunk = scope.Get();
+      ChunkSpill::Consider(oldChunk);
+    }
+
+    ChunkSpill::EndCapture();
+    ChunkSpill::BeginCapture(400 * 1024);
+
+    delete oldChunk;
+
+    // only ever two chunks are alive at once, which fit in the budget however many are recorded
+    Chunk *prev = NULL;
+    for(uint32_t i = 0; i < 10; i++)
+    {
+      SCOPED_SERIALISE_CHUNK(PAYLOAD);
+      SERIALISE_ELEMENT(payload);
+
+      Chunk *chunk = scope.Get();
+      ChunkSpill::Consider(chunk);
+      CHECK_FALSE(chunk->IsSpilled());
+
+      delete prev;
+      prev = chunk;
+    }
+
+    delete prev;
+  }
+
+  ChunkSpill::EndCapture();
+
+  CHECK(ChunkSpill::SpilledBytes() == 0);
+};
+
+TEST_CASE("Identical buffers are deduplicated", "[serialiser]")
+{
+  const uint64_t size = WriteSerialiser::BufferDedupMinSize * 2;
+
+  bytebuf a, b;
+  a.resize((size_t)size);
+  for(size_t i = 0; i < a.size(); i++)
+    a[i] = byte((i * 7) >> 2);
+  b = a;
+  b[100] ^= 0xff;
+
+  // the third buffer differs by one byte, the rest are the same
+  const bytebuf *expected[4] = {&a, &a, &b, &a};
+
+  StreamWriter *buf = new StreamWriter(StreamWriter::DefaultScratchSize);
+
+  {
+    WriteSerialiser ser(buf, Ownership::Nothing);
+
+    REQUIRE(ser.SetBufferDeduplication(true));
+
+    for(uint32_t i = 0; i < 4; i++)
+    {
+      SCOPED_SERIALISE_CHUNK(1);
+
+      byte *data = (byte *)expected[i]->data();
+      ser.Serialise("data"_lit, data, size);
+      SERIALISE_ELEMENT(i);
+    }
+
+    REQUIRE_FALSE(ser.IsErrored());
+  }
+
+  // only the two unique buffers should have been written
+  CHECK(buf->GetOffset() > size * 2);
+  CHECK(buf->GetOffset() < size * 3);
+
+  SECTION("Read with allocation")
+  {
+    ReadSerialiser ser(new StreamReader(buf->GetData(), buf->GetOffset()), Ownership::Stream);
+
+    for(uint32_t i = 0; i < 4; i++)
+    {
+      CHECK(ser.ReadChunk<uint32_t>() == 1);
+
+      byte *data = NULL;
+      ser.Serialise("data"_lit, data, size, SerialiserFlags::AllocateMemory);
+      REQUIRE(data);
+      CHECK(memcmp(data, expected[i]->data(), (size_t)size) == 0);
+      FreeAlignedBuffer(data);
+
+      uint32_t idx = ~0U;
+      SERIALISE_ELEMENT(idx);
+      CHECK(idx == i);
+
+      ser.EndChunk();
+    }
+
+    CHECK_FALSE(ser.IsErrored());
+    CHECK(ser.GetReader()->AtEnd());
+  }
+
+  SECTION("Read skipping the data")
+  {
+    ReadSerialiser ser(new StreamReader(buf->GetData(), buf->GetOffset()), Ownership::Stream);
+
+    for(uint32_t i = 0; i < 4; i++)
+    {
+      CHECK(ser.ReadChunk<uint32_t>() == 1);
+
+      byte *data = NULL;
+      ser.Serialise("data"_lit, data, size);
+      CHECK(data == NULL);
+
+      uint32_t idx = ~0U;
+      SERIALISE_ELEMENT(idx);
+      CHECK(idx == i);
+
+      ser.EndChunk();
+    }
+
+    CHECK_FALSE(ser.IsErrored());
+    CHECK(ser.GetReader()->AtEnd());
+  }
+
+  SECTION("Structured export")
+  {
+    ReadSerialiser ser(new StreamReader(buf->GetData(), buf->GetOffset()), Ownership::Stream);
+
+    ChunkLookup testChunkLoop = [](uint32_t) -> rdcstr { return "TestChunk"; };
+
+    ser.ConfigureStructuredExport(testChunkLoop, true);
+
+    for(uint32_t i = 0; i < 4; i++)
+    {
+      ser.ReadChunk<uint32_t>();
+
+      byte *data = NULL;
+      ser.Serialise("data"_lit, data, size);
+
+      uint32_t idx = ~0U;
+      SERIALISE_ELEMENT(idx);
+
+      ser.EndChunk();
+    }
+
+    CHECK_FALSE(ser.IsErrored());
+
+    const SDFile &file = ser.GetStructuredFile();
+    REQUIRE(file.buffers.size() == 4);
+    for(uint32_t i = 0; i < 4; i++)
+      CHECK((*file.buffers[i] == *expected[i]));
+  }
+
+  delete buf;
+};
+
 TEST_CASE("Read/write container types", "[serialiser][structured]")
 {
   StreamWriter *buf = new StreamWriter(StreamWriter::DefaultScratchSize);
@@ -896,6 +1422,162 @@ TEST_CASE("Read/write container types", "[serialiser][structured]")
   delete buf;
 };
 
+struct packedstruct
+{
+  float x, y;
+  uint32_t w, h;
+};
+
+DECLARE_REFLECTION_STRUCT(packedstruct);
+DECLARE_BULK_SERIALISE_TYPE(packedstruct);
+
+template <class SerialiserType>
+void DoSerialise(SerialiserType &ser, packedstruct &el)
+{
+  SERIALISE_MEMBER(x);
+  SERIALISE_MEMBER(y);
+  SERIALISE_MEMBER(w);
+  SERIALISE_MEMBER(h);
+}
+
+// identical layout and serialisation to packedstruct, but serialised element by element
+struct unpackedstruct
+{
+  float x, y;
+  uint32_t w, h;
+};
+
+DECLARE_REFLECTION_STRUCT(unpackedstruct);
+
+template <class SerialiserType>
+void DoSerialise(SerialiserType &ser, unpackedstruct &el)
+{
+  SERIALISE_MEMBER(x);
+  SERIALISE_MEMBER(y);
+  SERIALISE_MEMBER(w);
+  SERIALISE_MEMBER(h);
+}
+
+TEST_CASE("Bulk serialised arrays match per-element serialisation", "[serialiser][structured]")
+{
+  StreamWriter *bulkbuf = new StreamWriter(StreamWriter::DefaultScratchSize);
+  StreamWriter *elembuf = new StreamWriter(StreamWriter::DefaultScratchSize);
+
+  rdcarray<uint16_t> shorts = {1, 2, 3, 5, 8};
+  uint32_t fixed[4] = {13, 21, 34, 55};
+
+  {
+    WriteSerialiser ser(bulkbuf, Ownership::Nothing);
+
+    SCOPED_SERIALISE_CHUNK(5);
+
+    rdcarray<packedstruct> structs = {{1.0f, 2.0f, 3, 4}, {5.0f, 6.0f, 7, 8}};
+    const packedstruct *structPtr = structs.data();
+
+    SERIALISE_ELEMENT(structs);
+    SERIALISE_ELEMENT_ARRAY(structPtr, structs.size());
+    SERIALISE_ELEMENT(shorts);
+    SERIALISE_ELEMENT(fixed);
+  }
+
+  {
+    WriteSerialiser ser(elembuf, Ownership::Nothing);
+
+    SCOPED_SERIALISE_CHUNK(5);
+
+    rdcarray<unpackedstruct> structs = {{1.0f, 2.0f, 3, 4}, {5.0f, 6.0f, 7, 8}};
+    const unpackedstruct *structPtr = structs.data();
+
+    SERIALISE_ELEMENT(structs);
+    SERIALISE_ELEMENT_ARRAY(structPtr, structs.size());
+    SERIALISE_ELEMENT(shorts);
+    SERIALISE_ELEMENT(fixed);
+  }
+
+  REQUIRE(bulkbuf->GetOffset() == elembuf->GetOffset());
+  CHECK(memcmp(bulkbuf->GetData(), elembuf->GetData(), (size_t)bulkbuf->GetOffset()) == 0);
+
+  SECTION("Read without structured export")
+  {
+    ReadSerialiser ser(new StreamReader(bulkbuf->GetData(), bulkbuf->GetOffset()),
+                       Ownership::Stream);
+
+    ser.ReadChunk<uint32_t>();
+
+    rdcarray<packedstruct> structs;
+    packedstruct *structPtr = NULL;
+    rdcarray<uint16_t> readShorts;
+    uint32_t readFixed[4] = {};
+
+    SERIALISE_ELEMENT(structs);
+    SERIALISE_ELEMENT_ARRAY(structPtr, 2);
+    SERIALISE_ELEMENT(readShorts);
+    SERIALISE_ELEMENT(readFixed);
+
+    ser.EndChunk();
+
+    REQUIRE_FALSE(ser.IsErrored());
+    CHECK(ser.GetReader()->AtEnd());
+
+    REQUIRE(structs.size() == 2);
+    CHECK(structs[1].x == 5.0f);
+    CHECK(structs[1].h == 8);
+
+    REQUIRE(structPtr);
+    CHECK(structPtr[0].y == 2.0f);
+    CHECK(structPtr[1].w == 7);
+
+    CHECK(readShorts == shorts);
+
+    CHECK(readFixed[0] == 13);
+    CHECK(readFixed[3] == 55);
+  }
+
+  SECTION("Read with structured export")
+  {
+    ReadSerialiser ser(new StreamReader(bulkbuf->GetData(), bulkbuf->GetOffset()),
+                       Ownership::Stream);
+
+    ser.ConfigureStructuredExport([](uint32_t) -> rdcstr { return "TestChunk"; }, true);
+
+    ser.ReadChunk<uint32_t>();
+    {
+      rdcarray<packedstruct> structs;
+      packedstruct *structPtr = NULL;
+      rdcarray<uint16_t> readShorts;
+      uint32_t readFixed[4] = {};
+
+      SERIALISE_ELEMENT(structs);
+      SERIALISE_ELEMENT_ARRAY(structPtr, 2);
+      SERIALISE_ELEMENT(readShorts);
+      SERIALISE_ELEMENT(readFixed);
+    }
+    ser.EndChunk();
+
+    REQUIRE_FALSE(ser.IsErrored());
+
+    const SDChunk &chunk = *ser.GetStructuredFile().chunks[0];
+
+    REQUIRE(chunk.NumChildren() == 4);
+
+    const SDObject &structs = *chunk.GetChild(0);
+    REQUIRE(structs.NumChildren() == 2);
+    CHECK(structs.GetChild(1)->GetChild(0)->AsFloat() == 5.0f);
+    CHECK(structs.GetChild(1)->GetChild(3)->AsUInt32() == 8);
+
+    CHECK(chunk.GetChild(1)->GetChild(1)->GetChild(2)->AsUInt32() == 7);
+
+    const SDObject &readShorts = *chunk.GetChild(2);
+    REQUIRE(readShorts.NumChildren() == 5);
+    CHECK(readShorts.GetChild(4)->AsUInt32() == 8);
+
+    CHECK(chunk.GetChild(3)->GetChild(2)->AsUInt32() == 34);
+  }
+
+  delete bulkbuf;
+  delete elembuf;
+}
+
 struct struct1
 {
   struct1() : x(0.0f), y(0.0f), width(0.0f), height(0.0f) {}
@@ -24,6 +24,7 @@
 
 #include "streamio.h"
 #include <errno.h>
+#include "3rdparty/zstd/xxhash.h"
 #include "common/timing.h"
 
 Compressor::~Compressor()
@@ -38,6 +39,339 @@ Decompressor::~Decompressor()
     delete m_Read;
 }
 
+ReadAheadDecompressor::ReadAheadDecompressor(Decompressor *inner, uint64_t uncompressedSize)
+    : Decompressor(NULL, Ownership::Nothing), m_Inner(inner), m_UncompressedSize(uncompressedSize)
+{
+  for(uint32_t i = 0; i < NumSlots; i++)
+    m_Slots[i] = AllocAlignedBuffer(SlotSize);
+
+  Start(0);
+}
+
+ReadAheadDecompressor::~ReadAheadDecompressor()
+{
+  Stop();
+
+  for(uint32_t i = 0; i < NumSlots; i++)
+    FreeAlignedBuffer(m_Slots[i]);
+
+  delete m_Inner;
+}
+
+void ReadAheadDecompressor::Start(uint64_t offset)
+{
+  m_ProduceOffset = m_ConsumeOffset = offset;
+  m_ReadSlot = 0;
+  m_ReadSlotOffset = 0;
+  m_HaveSlot = false;
+  m_StopRequested = 0;
+
+  m_EmptySlots = new Threading::Semaphore(NumSlots);
+  m_FilledSlots = new Threading::Semaphore(0);
+
+  m_Thread = Threading::CreateThread([this]() { ProduceSlots(); });
+
+  if(m_Thread == 0)
+  {
+    RDCERR("Couldn't create read-ahead decompression thread");
+    m_Failed = true;
+  }
+}
+
+void ReadAheadDecompressor::Stop()
+{
+  if(m_Thread)
+  {
+    Atomic::Inc32(&m_StopRequested);
+
+    // the worker only ever blocks waiting for an empty slot, so this is enough to wake it
+    m_EmptySlots->Signal();
+
+    Threading::JoinThread(m_Thread);
+    Threading::CloseThread(m_Thread);
+    m_Thread = 0;
+  }
+
+  SAFE_DELETE(m_EmptySlots);
+  SAFE_DELETE(m_FilledSlots);
+}
+
+void ReadAheadDecompressor::ProduceSlots()
+{
+  uint32_t slot = 0;
+
+  while(m_ProduceOffset < m_UncompressedSize)
+  {
+    m_EmptySlots->Wait();
+
+    if(Atomic::CmpExch32(&m_StopRequested, 0, 0) != 0)
+      return;
+
+    uint64_t length = RDCMIN(uint64_t(SlotSize), m_UncompressedSize - m_ProduceOffset);
+
+    m_SlotValid[slot] = m_Inner->Read(m_Slots[slot], length);
+    m_SlotLength[slot] = length;
+    m_ProduceOffset += length;
+
+    bool valid = m_SlotValid[slot];
+
+    m_FilledSlots->Signal();
+
+    // the consumer will see the failure when it reaches this slot
+    if(!valid)
+      return;
+
+    slot = (slot + 1) % NumSlots;
+  }
+}
+
+bool ReadAheadDecompressor::Read(void *data, uint64_t numBytes)
+{
+  if(m_Failed)
+    return false;
+
+  // the worker stops at the end of the stream, so never wait for data that won't come
+  if(numBytes > m_UncompressedSize - m_ConsumeOffset)
+  {
+    RDCERR("Reading %llu bytes at %llu, past the end of %llu byte stream", numBytes,
+           m_ConsumeOffset, m_UncompressedSize);
+    memset(data, 0, (size_t)numBytes);
+    m_Failed = true;
+    return false;
+  }
+
+  byte *dst = (byte *)data;
+
+  while(numBytes > 0)
+  {
+    if(!m_HaveSlot)
+    {
+      m_FilledSlots->Wait();
+      m_HaveSlot = true;
+      m_ReadSlotOffset = 0;
+
+      if(!m_SlotValid[m_ReadSlot])
+      {
+        memset(dst, 0, (size_t)numBytes);
+        m_Failed = true;
+        return false;
+      }
+    }
+
+    uint64_t chunk = RDCMIN(numBytes, m_SlotLength[m_ReadSlot] - m_ReadSlotOffset);
+
+    memcpy(dst, m_Slots[m_ReadSlot] + m_ReadSlotOffset, (size_t)chunk);
+
+    dst += chunk;
+    numBytes -= chunk;
+    m_ReadSlotOffset += chunk;
+    m_ConsumeOffset += chunk;
+
+    // hand the slot back to the worker once it's fully consumed
+    if(m_ReadSlotOffset == m_SlotLength[m_ReadSlot])
+    {
+      m_HaveSlot = false;
+      m_ReadSlot = (m_ReadSlot + 1) % NumSlots;
+      m_EmptySlots->Signal();
+    }
+  }
+
+  return true;
+}
+
+bool ReadAheadDecompressor::Seek(uint64_t uncompressedOffset)
+{
+  // without a seek table the inner decompressor can't seek, and we must not disturb it since it
+  // has already decompressed ahead of the consumer
+  if(!m_Inner->HasSeekTable() || uncompressedOffset > m_UncompressedSize)
+    return false;
+
+  Stop();
+
+  if(!m_Inner->Seek(uncompressedOffset))
+  {
+    m_Failed = true;
+    return false;
+  }
+
+  m_Failed = false;
+  Start(uncompressedOffset);
+
+  return !m_Failed;
+}
+
+bool ReadAheadDecompressor::Recompress(Compressor *comp)
+{
+  if(m_Failed)
+    return false;
+
+  bool success = true;
+
+  uint64_t remaining = m_UncompressedSize - m_ConsumeOffset;
+
+  while(success && remaining > 0)
+  {
+    // read one slot at a time straight out of the ring
+    uint64_t length = RDCMIN(uint64_t(SlotSize), remaining);
+
+    if(!m_HaveSlot)
+    {
+      m_FilledSlots->Wait();
+      m_HaveSlot = true;
+      m_ReadSlotOffset = 0;
+
+      if(!m_SlotValid[m_ReadSlot])
+      {
+        m_Failed = true;
+        success = false;
+        break;
+      }
+    }
+
+    length = RDCMIN(length, m_SlotLength[m_ReadSlot] - m_ReadSlotOffset);
+
+    success &= comp->Write(m_Slots[m_ReadSlot] + m_ReadSlotOffset, length);
+
+    m_ReadSlotOffset += length;
+    m_ConsumeOffset += length;
+    remaining -= length;
+
+    if(m_ReadSlotOffset == m_SlotLength[m_ReadSlot])
+    {
+      m_HaveSlot = false;
+      m_ReadSlot = (m_ReadSlot + 1) % NumSlots;
+      m_EmptySlots->Signal();
+    }
+  }
+
+  success &= comp->Finish();
+
+  return success;
+}
+
+WriteBehindFile::WriteBehindFile(FILE *file)
+    : m_File(file), m_EmptySlots(NumSlots), m_FilledSlots(0)
+{
+  for(uint32_t i = 0; i < NumSlots; i++)
+    m_Slots[i] = AllocAlignedBuffer(SlotSize);
+
+  m_Thread = Threading::CreateThread([this]() { ConsumeSlots(); });
+
+  if(m_Thread == 0)
+  {
+    RDCERR("Couldn't create write-behind thread");
+    m_Failed = 1;
+  }
+}
+
+WriteBehindFile::~WriteBehindFile()
+{
+  if(!Flush())
+    RDCERR("Not all data could be written to file");
+
+  if(m_Thread)
+  {
+    Atomic::Inc32(&m_StopRequested);
+
+    // everything has been flushed so the worker is waiting for a filled slot, this wakes it
+    m_FilledSlots.Signal();
+
+    Threading::JoinThread(m_Thread);
+    Threading::CloseThread(m_Thread);
+    m_Thread = 0;
+  }
+
+  for(uint32_t i = 0; i < NumSlots; i++)
+    FreeAlignedBuffer(m_Slots[i]);
+}
+
+void WriteBehindFile::ConsumeSlots()
+{
+  uint32_t slot = 0;
+
+  for(;;)
+  {
+    m_FilledSlots.Wait();
+
+    if(Atomic::CmpExch32(&m_StopRequested, 0, 0) != 0)
+      return;
+
+    // once a write has failed, keep handing slots back without writing them so the producer never
+    // blocks. It will see the failure on its next call.
+    if(Atomic::CmpExch32(&m_Failed, 0, 0) == 0)
+    {
+      uint64_t written =
+          (uint64_t)FileIO::fwrite(m_Slots[slot], 1, (size_t)m_SlotLength[slot], m_File);
+
+      if(written != m_SlotLength[slot])
+        Atomic::Inc32(&m_Failed);
+    }
+
+    m_EmptySlots.Signal();
+
+    slot = (slot + 1) % NumSlots;
+  }
+}
+
+void WriteBehindFile::SubmitSlot()
+{
+  m_HaveSlot = false;
+  m_FilledSlots.Signal();
+  m_WriteSlot = (m_WriteSlot + 1) % NumSlots;
+}
+
+bool WriteBehindFile::Write(const void *data, uint64_t numBytes)
+{
+  if(Atomic::CmpExch32(&m_Failed, 0, 0) != 0)
+    return false;
+
+  const byte *src = (const byte *)data;
+
+  while(numBytes > 0)
+  {
+    if(!m_HaveSlot)
+    {
+      m_EmptySlots.Wait();
+      m_HaveSlot = true;
+      m_SlotLength[m_WriteSlot] = 0;
+    }
+
+    uint64_t chunk = RDCMIN(numBytes, SlotSize - m_SlotLength[m_WriteSlot]);
+
+    memcpy(m_Slots[m_WriteSlot] + m_SlotLength[m_WriteSlot], src, (size_t)chunk);
+
+    src += chunk;
+    numBytes -= chunk;
+    m_SlotLength[m_WriteSlot] += chunk;
+
+    // hand the slot to the worker as soon as it's full
+    if(m_SlotLength[m_WriteSlot] == SlotSize)
+      SubmitSlot();
+  }
+
+  return true;
+}
+
+bool WriteBehindFile::Flush()
+{
+  if(m_Thread == 0)
+    return false;
+
+  if(m_HaveSlot && m_SlotLength[m_WriteSlot] > 0)
+    SubmitSlot();
+
+  // once every slot is empty again, everything submitted has been written. Take them all and then
+  // give them back - except an empty slot we're still holding, which we already have.
+  const uint32_t numWait = m_HaveSlot ? NumSlots - 1 : NumSlots;
+
+  for(uint32_t i = 0; i < numWait; i++)
+    m_EmptySlots.Wait();
+  for(uint32_t i = 0; i < numWait; i++)
+    m_EmptySlots.Signal();
+
+  return Atomic::CmpExch32(&m_Failed, 0, 0) == 0;
+}
+
 static const uint64_t initialBufferSize = 64 * 1024;
 const byte StreamWriter::empty[128] = {};
 
@@ -61,6 +395,16 @@ StreamReader::StreamReader(const bytebuf &buffer)
   m_Ownership = Ownership::Nothing;
 }
 
+StreamReader::StreamReader(StreamExternalMemoryType, const byte *buffer, uint64_t bufferSize)
+{
+  m_InputSize = m_BufferSize = bufferSize;
+  m_BufferHead = m_BufferBase = (byte *)buffer;
+
+  m_ExternalMemory = true;
+
+  m_Ownership = Ownership::Nothing;
+}
+
 StreamReader::StreamReader(StreamInvalidType)
 {
   m_InputSize = 0;
@@ -113,6 +457,7 @@ StreamReader::StreamReader(FILE *file, uint64_t fileSize, Ownership own)
   }
 
   m_File = file;
+  m_FileBase = FileIO::ftell64(file);
   m_InputSize = fileSize;
 
   m_BufferSize = initialBufferSize;
@@ -178,7 +523,8 @@ StreamReader::~StreamReader()
   for(StreamCloseCallback cb : m_Callbacks)
     cb();
 
-  FreeAlignedBuffer(m_BufferBase);
+  if(!m_ExternalMemory)
+    FreeAlignedBuffer(m_BufferBase);
 
   if(m_Ownership == Ownership::Stream)
   {
@@ -194,13 +540,67 @@ void StreamReader::SetOffset(uint64_t offs)
 {
   if(m_File || m_Decompressor)
   {
-    RDCERR("File and decompress stream readers do not support seeking");
+    // if the offset is still within the window we have buffered, just move the head
+    if(m_BufferBase && offs >= m_ReadOffset && offs - m_ReadOffset < m_BufferSize)
+    {
+      m_BufferHead = m_BufferBase + (offs - m_ReadOffset);
+      return;
+    }
+
+    if(!SeekExternal(offs))
+      RDCERR("Stream reader can't seek to offset %llu", offs);
     return;
   }
 
+  // re-check a mapped file's size on the next read, rather than trusting a check made elsewhere
+  m_ExternalChecked = 0;
+
   m_BufferHead = m_BufferBase + offs;
 }
 
+bool StreamReader::CheckExternalMemory(uint64_t end)
+{
+  uint64_t covered = m_ExternalCheck();
+
+  if(covered < end)
+  {
+    RDCERR("Mapped file was truncated to %llu bytes while reading up to %llu", covered, end);
+    m_BufferHead = m_BufferBase + m_BufferSize;
+    m_HasError = true;
+    return false;
+  }
+
+  // checking costs a syscall, so let small reads after this one go unchecked for a while
+  m_ExternalChecked = RDCMIN(covered, end + ExternalCheckWindow);
+  return true;
+}
+
+bool StreamReader::SeekExternal(uint64_t offs)
+{
+  if(!m_BufferBase || offs > m_InputSize)
+    return false;
+
+  if(m_Decompressor)
+  {
+    if(!m_Decompressor->Seek(offs))
+      return false;
+  }
+  else if(m_File)
+  {
+    FileIO::fseek64(m_File, m_FileBase + offs, SEEK_SET);
+  }
+  else
+  {
+    return false;
+  }
+
+  // refill the window starting at the new offset, the same as when the stream was first opened
+  m_ReadOffset = offs;
+  m_BufferHead = m_BufferBase;
+
+  return ReadFromExternal(0, RDCMIN(m_InputSize - offs, m_BufferSize));
+}
+
 bool StreamReader::Reserve(uint64_t numBytes)
 {
   RDCASSERT(m_Sock || m_File || m_Decompressor);
@@ -389,6 +789,17 @@ StreamWriter::StreamWriter(FILE *file, Ownership own)
   m_InMemory = false;
 }
 
+StreamWriter::StreamWriter(StreamWriteBehindType, FILE *file, Ownership own)
+{
+  m_BufferBase = m_BufferHead = m_BufferEnd = NULL;
+
+  m_File = file;
+  m_WriteBehind = new WriteBehindFile(file);
+
+  m_Ownership = own;
+  m_InMemory = false;
+}
+
 StreamWriter::StreamWriter(Compressor *compressor, Ownership own)
 {
   m_BufferBase = m_BufferHead = m_BufferEnd = NULL;
@@ -399,8 +810,34 @@ StreamWriter::StreamWriter(Compressor *compressor, Ownership own)
   m_InMemory = false;
 }
 
+StreamWriter::StreamWriter(StreamSink *sink, Ownership own)
+{
+  m_BufferBase = m_BufferHead = m_BufferEnd = NULL;
+
+  m_Sink = sink;
+
+  m_Ownership = own;
+  m_InMemory = false;
+}
+
+byte *StreamWriter::DetachBuffer(byte *newBuffer, uint64_t newBufferSize)
+{
+  RDCASSERT(m_InMemory);
+
+  byte *ret = m_BufferBase;
+
+  m_BufferBase = m_BufferHead = newBuffer;
+  m_BufferEnd = m_BufferBase + newBufferSize;
+  m_WriteSize = 0;
+
+  return ret;
+}
+
 StreamWriter::~StreamWriter()
 {
+  // everything must reach the file before the callbacks, which may go on to use it
+  SAFE_DELETE(m_WriteBehind);
+
   for(StreamCloseCallback cb : m_Callbacks)
     cb();
 
@@ -413,6 +850,9 @@ StreamWriter::~StreamWriter()
 
     if(m_Compressor)
       delete m_Compressor;
+
+    if(m_Sink)
+      delete m_Sink;
   }
 }
 
@@ -466,6 +906,28 @@ bool StreamWriter::FlushSocketData()
   return true;
 }
 
+bool StreamWriter::FlushWriteBehind()
+{
+  if(!m_WriteBehind->Flush())
+  {
+    HandleError();
+    return false;
+  }
+
+  return FileIO::fflush(m_File);
+}
+
+bool StreamWriter::FlushSink()
+{
+  if(!m_Sink->Flush())
+  {
+    HandleError();
+    return false;
+  }
+
+  return true;
+}
+
 void StreamWriter::HandleError()
 {
   if(m_File)
@@ -477,6 +939,9 @@ void StreamWriter::HandleError()
 
   FreeAlignedBuffer(m_BufferBase);
 
+  // stop the worker before the file can be closed
+  SAFE_DELETE(m_WriteBehind);
+
   if(m_Ownership == Ownership::Stream)
   {
     if(m_File)
@@ -487,6 +952,9 @@ void StreamWriter::HandleError()
 
     if(m_Compressor)
       delete m_Compressor;
+
+    if(m_Sink)
+      delete m_Sink;
   }
 
   m_BufferBase = m_BufferHead = m_BufferEnd = NULL;
@@ -495,6 +963,7 @@ void StreamWriter::HandleError()
   m_File = NULL;
   m_Sock = NULL;
   m_Compressor = NULL;
+  m_Sink = NULL;
 
   m_Ownership = Ownership::Nothing;
   m_InMemory = false;
@@ -542,3 +1011,210 @@ void StreamTransfer(StreamWriter *writer, StreamReader *reader, RENDERDOC_Progre
 
   delete[] buf;
 }
+
+static uint64_t ChecksumFileRange(const rdcstr &filename, uint64_t offset, uint64_t length)
+{
+  FILE *f = FileIO::fopen(filename.c_str(), "rb");
+
+  if(!f)
+    return 0;
+
+  bytebuf buf;
+  buf.resize((size_t)length);
+
+  FileIO::fseek64(f, offset, SEEK_SET);
+  size_t numRead = FileIO::fread(buf.data(), 1, buf.size(), f);
+  FileIO::fclose(f);
+
+  if(numRead != buf.size())
+    return 0;
+
+  return XXH64(buf.data(), buf.size(), 0);
+}
+
+void GetFileTransferResumePoint(const rdcstr &partialFilename, uint64_t &offset,
+                                uint64_t &checksum)
+{
+  offset = checksum = 0;
+
+  if(!FileIO::exists(partialFilename.c_str()))
+    return;
+
+  uint64_t size = FileIO::GetFileSize(partialFilename);
+
+  // only resume after a whole block, anything after that might have been written partially.
+  uint64_t blockOffset = (size / FileTransferBlockSize) * FileTransferBlockSize;
+
+  if(blockOffset == 0)
+    return;
+
+  checksum = GetFileTransferChecksum(partialFilename, blockOffset);
+
+  if(checksum != 0)
+    offset = blockOffset;
+}
+
+uint64_t HashFileContents(const rdcstr &filename)
+{
+  FILE *f = FileIO::fopen(filename.c_str(), "rb");
+
+  if(!f)
+    return 0;
+
+  XXH64_state_t *state = XXH64_createState();
+  XXH64_reset(state, 0);
+
+  bytebuf buf;
+  buf.resize((size_t)FileTransferBlockSize);
+
+  size_t numRead = 0;
+  while((numRead = FileIO::fread(buf.data(), 1, buf.size(), f)) > 0)
+    XXH64_update(state, buf.data(), numRead);
+
+  FileIO::fclose(f);
+
+  uint64_t ret = XXH64_digest(state);
+  XXH64_freeState(state);
+
+  return ret;
+}
+
+uint64_t GetFileTransferChecksum(const rdcstr &filename, uint64_t offset)
+{
+  uint64_t length = RDCMIN(offset, FileTransferBlockSize);
+  return ChecksumFileRange(filename, offset - length, length);
+}
+
+uint64_t ValidateFileTransferResumePoint(const rdcstr &filename, uint64_t offset,
+                                         uint64_t checksum)
+{
+  if(offset == 0 || offset > FileIO::GetFileSize(filename))
+    return 0;
+
+  if(GetFileTransferChecksum(filename, offset) != checksum)
+  {
+    RDCLOG("Partial copy of '%s' doesn't match, restarting transfer", filename.c_str());
+    return 0;
+  }
+
+  RDCLOG("Resuming transfer of '%s' from %llu bytes", filename.c_str(), offset);
+
+  return offset;
+}
+
+bool SendFileBlocks(StreamWriter *writer, const rdcstr &filename, uint64_t startOffset,
+                    uint64_t totalSize, RENDERDOC_ProgressCallback progress)
+{
+  FILE *f = FileIO::fopen(filename.c_str(), "rb");
+
+  if(f)
+    FileIO::fseek64(f, startOffset, SEEK_SET);
+  else
+    RDCERR("Can't open file '%s'", filename.c_str());
+
+  bytebuf buf;
+  buf.resize((size_t)FileTransferBlockSize);
+
+  if(progress)
+    progress(0.0001f);
+
+  for(uint64_t offs = startOffset; offs < totalSize; offs += FileTransferBlockSize)
+  {
+    size_t len = (size_t)RDCMIN(FileTransferBlockSize, totalSize - offs);
+
+    // if the file can't be read, still send the block so the receiver stays in sync. The checksum
+    // won't match so it will stop there.
+    size_t numRead = f ? FileIO::fread(buf.data(), 1, len, f) : 0;
+    uint64_t checksum = XXH64(buf.data(), len, 0);
+    if(numRead != len)
+      checksum = ~checksum;
+
+    writer->Write(buf.data(), len);
+    writer->Write(checksum);
+
+    if(writer->IsErrored())
+      break;
+
+    if(progress)
+      progress(float(offs + len) / float(totalSize));
+  }
+
+  if(f)
+    FileIO::fclose(f);
+
+  if(progress)
+    progress(1.0f);
+
+  return f && !writer->IsErrored();
+}
+
+bool ReceiveFileBlocks(StreamReader *reader, const rdcstr &partialFilename, uint64_t startOffset,
+                       uint64_t totalSize, RENDERDOC_ProgressCallback progress)
+{
+  FILE *f = NULL;
+
+  if(startOffset > 0)
+  {
+    f = FileIO::fopen(partialFilename.c_str(), "r+b");
+    if(f)
+    {
+      FileIO::ftruncateat(f, startOffset);
+      FileIO::fseek64(f, startOffset, SEEK_SET);
+    }
+  }
+  else
+  {
+    FileIO::CreateParentDirectory(partialFilename);
+    f = FileIO::fopen(partialFilename.c_str(), "wb");
+  }
+
+  if(!f)
+    RDCERR("Can't open '%s' to receive file", partialFilename.c_str());
+
+  bool intact = (f != NULL);
+
+  bytebuf buf;
+  buf.resize((size_t)FileTransferBlockSize);
+
+  if(progress)
+    progress(0.0001f);
+
+  for(uint64_t offs = startOffset; offs < totalSize; offs += FileTransferBlockSize)
+  {
+    size_t len = (size_t)RDCMIN(FileTransferBlockSize, totalSize - offs);
+
+    uint64_t checksum = 0;
+    reader->Read(buf.data(), len);
+    reader->Read(checksum);
+
+    if(reader->IsErrored())
+    {
+      intact = false;
+      break;
+    }
+
+    // once a block is bad we stop writing, so the partial file only ever contains verified data.
+    if(intact && XXH64(buf.data(), len, 0) != checksum)
+    {
+      RDCERR("Checksum mismatch at offset %llu receiving '%s'", offs, partialFilename.c_str());
+      intact = false;
+    }
+
+    if(intact && FileIO::fwrite(buf.data(), 1, len, f) != len)
+    {
+      RDCERR("Error writing to '%s': %s", partialFilename.c_str(), FileIO::ErrorString().c_str());
+      intact = false;
+    }
+
+    if(progress)
+      progress(float(offs + len) / float(totalSize));
+  }
+
+  if(f)
+    FileIO::fclose(f);
+
+  if(progress)
+    progress(1.0f);
+
+  return intact;
+}
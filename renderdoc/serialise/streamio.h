@@ -40,6 +40,15 @@ class StreamReader;
 
 typedef std::function<void()> StreamCloseCallback;
 
+// describes where each block starts in a compressed stream, when every block can be decompressed
+// independently. All blocks except the last decompress to exactly blockSize bytes, so block i
+// contains uncompressed bytes [i * blockSize, (i + 1) * blockSize).
+struct BlockSeekTable
+{
+  uint64_t blockSize = 0;
+  rdcarray<uint64_t> blockOffsets;
+};
+
 class Compressor
 {
 public:
@@ -48,9 +57,16 @@ public:
   virtual bool Write(const void *data, uint64_t numBytes) = 0;
   virtual bool Finish() = 0;
 
+  // returns true if every block written was independent and the seek table can be used to jump
+  // into the compressed stream. The table is stored in the base class so that it can still be
+  // fetched while the compressor is being destroyed.
+  bool HasSeekTable() const { return m_SeekTable.blockSize > 0; }
+  const BlockSeekTable &GetSeekTable() const { return m_SeekTable; }
 protected:
   StreamWriter *m_Write;
   Ownership m_Ownership;
+
+  BlockSeekTable m_SeekTable;
 };
 
 class Decompressor
@@ -61,9 +77,116 @@ public:
   virtual bool Recompress(Compressor *comp) = 0;
   virtual bool Read(void *data, uint64_t numBytes) = 0;
 
+  // if a seek table has been provided, jump so that the next Read() returns data starting at the
+  // given uncompressed offset. Returns false if seeking isn't possible, e.g. there's no usable seek
+  // table or the offset is out of range. Those checks are made before anything is touched, so
+  // then the decompressor is unchanged and can still be read sequentially. If the jump itself
+  // fails because the stream is corrupt, the decompressor is left failed and every later Read()
+  // fails too, the same as after a failed Read().
+  virtual bool Seek(uint64_t uncompressedOffset) { return false; }
+  void SetSeekTable(const BlockSeekTable &table) { m_SeekTable = table; }
+  bool HasSeekTable() const { return m_SeekTable.blockSize > 0; }
 protected:
   StreamReader *m_Read;
   Ownership m_Ownership;
+
+  BlockSeekTable m_SeekTable;
+};
+
+// runs another decompressor on a worker thread, decompressing ahead into a small ring of slots so
+// that decompression overlaps with whatever the reading thread does with the data. Takes ownership
+// of the inner decompressor. Read/Seek/Recompress must only be called from one thread.
+class ReadAheadDecompressor : public Decompressor
+{
+public:
+  ReadAheadDecompressor(Decompressor *inner, uint64_t uncompressedSize);
+  ~ReadAheadDecompressor();
+
+  bool Recompress(Compressor *comp);
+  bool Read(void *data, uint64_t numBytes);
+  bool Seek(uint64_t uncompressedOffset);
+
+private:
+  static const uint32_t NumSlots = 8;
+  static const uint64_t SlotSize = 1024 * 1024;
+
+  void Start(uint64_t offset);
+  void Stop();
+  void ProduceSlots();
+
+  Decompressor *m_Inner;
+  uint64_t m_UncompressedSize;
+
+  byte *m_Slots[NumSlots] = {};
+  uint64_t m_SlotLength[NumSlots] = {};
+  bool m_SlotValid[NumSlots] = {};
+
+  // uncompressed offset of the next slot the worker will fill
+  uint64_t m_ProduceOffset = 0;
+
+  // the slot currently being consumed, if m_HaveSlot is set, and how far into it we've read
+  uint32_t m_ReadSlot = 0;
+  uint64_t m_ReadSlotOffset = 0;
+  bool m_HaveSlot = false;
+  uint64_t m_ConsumeOffset = 0;
+
+  bool m_Failed = false;
+  int32_t m_StopRequested = 0;
+
+  // counts the slots free for the worker to fill, and the slots filled and waiting to be read.
+  // Recreated on every Start() so a seek begins from a clean count.
+  Threading::Semaphore *m_EmptySlots = NULL;
+  Threading::Semaphore *m_FilledSlots = NULL;
+  Threading::ThreadHandle m_Thread = 0;
+};
+
+// writes to a file on a worker thread. Data is copied into a small ring of large slots, and each
+// full slot is written out while the next is being filled, so that producing the data (e.g.
+// compressing the next page) overlaps with writing the last. Write/Flush must only be called from
+// one thread, and nothing else may touch the file until Flush() returns or this is destroyed.
+class WriteBehindFile
+{
+public:
+  WriteBehindFile(FILE *file);
+  ~WriteBehindFile();
+
+  bool Write(const void *data, uint64_t numBytes);
+  // waits until everything written so far has been passed to the file
+  bool Flush();
+
+private:
+  static const uint32_t NumSlots = 4;
+  static const uint64_t SlotSize = 1024 * 1024;
+
+  void SubmitSlot();
+  void ConsumeSlots();
+
+  FILE *m_File;
+
+  byte *m_Slots[NumSlots] = {};
+  uint64_t m_SlotLength[NumSlots] = {};
+
+  // the slot currently being filled, if m_HaveSlot is set
+  uint32_t m_WriteSlot = 0;
+  bool m_HaveSlot = false;
+
+  int32_t m_Failed = 0;
+  int32_t m_StopRequested = 0;
+
+  // counts the slots free to be filled, and the slots filled and waiting to be written
+  Threading::Semaphore m_EmptySlots;
+  Threading::Semaphore m_FilledSlots;
+  Threading::ThreadHandle m_Thread = 0;
+};
+
+// a destination for a StreamWriter that isn't memory, a file, a socket or a compressor - for when
+// the data is consumed somewhere else, e.g. handed to another thread to send on.
+class StreamSink
+{
+public:
+  virtual ~StreamSink() {}
+  virtual bool Write(const void *data, uint64_t numBytes) = 0;
+  virtual bool Flush() = 0;
 };
 
 class StreamReader
@@ -77,10 +200,17 @@ public:
   {
     DummyStream
   };
+  enum StreamExternalMemoryType
+  {
+    ExternalMemory
+  };
 
   StreamReader(StreamInvalidType);
   StreamReader(StreamDummyType);
   StreamReader(const byte *buffer, uint64_t bufferSize);
+  // reads from memory owned elsewhere without copying it, e.g. a memory-mapped file. The memory must
+  // stay valid until the reader is destroyed - a close callback can be used to release it.
+  StreamReader(StreamExternalMemoryType, const byte *buffer, uint64_t bufferSize);
   StreamReader(const bytebuf &buffer);
 
   StreamReader(Network::Socket *sock, Ownership own);
@@ -149,6 +279,15 @@ public:
       return false;
     }
 
+    // a mapped file can be truncated while we read it, which would fault instead of failing
+    if(m_ExternalCheck && GetOffset() + numBytes > m_ExternalChecked &&
+       !CheckExternalMemory(GetOffset() + numBytes))
+    {
+      if(data)
+        memset(data, 0, (size_t)numBytes);
+      return false;
+    }
+
     // if we're reading from an external source, reserve enough bytes to do the read
     if(m_File || m_Sock || m_Decompressor)
     {
@@ -175,8 +314,35 @@ public:
     return true;
   }
 
+  // for readers whose whole contents are in memory, returns a pointer to the next numBytes and
+  // advances past them instead of copying. Returns NULL without advancing for file, socket or
+  // decompressor readers, which need to use Read().
+  const byte *ReadDirect(uint64_t numBytes)
+  {
+    if(m_File || m_Sock || m_Decompressor || m_Dummy || !m_BufferBase)
+      return NULL;
+
+    if(GetOffset() + numBytes > GetSize())
+      return NULL;
+
+    if(m_ExternalCheck && GetOffset() + numBytes > m_ExternalChecked &&
+       !CheckExternalMemory(GetOffset() + numBytes))
+      return NULL;
+
+    const byte *ret = m_BufferHead;
+    m_BufferHead += numBytes;
+    return ret;
+  }
+
   bool SkipBytes(uint64_t numBytes)
   {
+    // fast path for seekable decompressors, skip whole blocks without decompressing them
+    if(m_Decompressor && numBytes > Available() + SeekThreshold)
+    {
+      if(SeekExternal(GetOffset() + numBytes))
+        return true;
+    }
+
     // fast path for file skipping
     if(m_File && numBytes > Available())
     {
@@ -203,6 +369,15 @@ public:
   }
 
   void AddCloseCallback(StreamCloseCallback callback) { m_Callbacks.push_back(callback); }
+  // for external memory backed by a mapped file, returns how many bytes of the stream the file
+  // still covers. It's called before reading past what was last checked, and if the file has been
+  // truncated the read fails instead of faulting.
+  void SetExternalMemoryCheck(std::function<uint64_t()> check)
+  {
+    m_ExternalCheck = check;
+    m_ExternalChecked = 0;
+  }
+
 private:
   inline uint64_t Available()
   {
@@ -212,6 +387,15 @@ private:
   }
   bool Reserve(uint64_t numBytes);
   bool ReadFromExternal(uint64_t bufferOffs, uint64_t length);
+  bool SeekExternal(uint64_t offs);
+  bool CheckExternalMemory(uint64_t end);
+
+  // skips shorter than this just read through the decompressor, since seeking has to decompress at
+  // least one whole block anyway
+  static const uint64_t SeekThreshold = 256 * 1024;
+
+  // how far past a read of a mapped file can be read before the file's size is checked again
+  static const uint64_t ExternalCheckWindow = 1024 * 1024;
 
   // base of the buffer allocation
   byte *m_BufferBase;
@@ -230,6 +414,9 @@ private:
   // file pointer, if we're reading from a file
   FILE *m_File = NULL;
 
+  // the position in m_File that corresponds to offset 0 in this stream
+  uint64_t m_FileBase = 0;
+
   // socket, if we're reading from a socket
   Network::Socket *m_Sock = NULL;
 
@@ -246,6 +433,14 @@ private:
   // structured serialiser to 'read' pre-existing data.
   bool m_Dummy = false;
 
+  // flag indicating m_BufferBase points to memory we don't own and must not free
+  bool m_ExternalMemory = false;
+
+  // if set, the external memory is a mapped file that could shrink. m_ExternalChecked is how far
+  // into the stream the file was last known to cover.
+  std::function<uint64_t()> m_ExternalCheck;
+  uint64_t m_ExternalChecked = 0;
+
   // do we own the file/compressor? are we responsible for
   // cleaning it up?
   Ownership m_Ownership;
@@ -261,12 +456,20 @@ public:
   {
     InvalidStream
   };
+  enum StreamWriteBehindType
+  {
+    WriteBehind
+  };
 
   StreamWriter(StreamInvalidType);
   StreamWriter(uint64_t initialBufSize);
   StreamWriter(FILE *file, Ownership own);
+  // writes to the file from a worker thread, see WriteBehindFile. The file must not be used by
+  // anything else until Flush()/Finish() or until the writer is destroyed.
+  StreamWriter(StreamWriteBehindType, FILE *file, Ownership own);
   StreamWriter(Network::Socket *file, Ownership own);
   StreamWriter(Compressor *compressor, Ownership own);
+  StreamWriter(StreamSink *sink, Ownership own);
 
   bool IsErrored() { return m_HasError; }
   static const int DefaultScratchSize = 32 * 1024;
@@ -286,7 +489,18 @@ public:
   }
 
   uint64_t GetOffset() { return m_WriteSize; }
+  // whether a reader of what's written here will be able to seek back to any earlier offset. Not
+  // possible over a socket, or with compression that has dependencies between blocks
+  bool IsSeekableOnRead() const
+  {
+    return !m_Sock && !m_Sink && !m_HasError && (!m_Compressor || m_Compressor->HasSeekTable());
+  }
   const byte *GetData() { return m_BufferBase; }
+  uint64_t GetBufferSize() { return m_BufferEnd - m_BufferBase; }
+  // for in-memory writers only. Hands ownership of the buffer holding the written data to the
+  // caller, who must free it with FreeAlignedBuffer, and carries on writing from the start of
+  // newBuffer as if Rewind() had been called.
+  byte *DetachBuffer(byte *newBuffer, uint64_t newBufferSize);
   template <uint64_t alignment>
   bool AlignTo()
   {
@@ -336,6 +550,16 @@ public:
     {
       return m_Compressor->Write(data, numBytes);
     }
+    else if(m_WriteBehind)
+    {
+      if(!m_WriteBehind->Write(data, numBytes))
+      {
+        HandleError();
+        return false;
+      }
+
+      return true;
+    }
     else if(m_File)
     {
       uint64_t written = (uint64_t)FileIO::fwrite(data, 1, (size_t)numBytes, m_File);
@@ -351,6 +575,16 @@ public:
     {
       return SendSocketData(data, numBytes);
     }
+    else if(m_Sink)
+    {
+      if(!m_Sink->Write(data, numBytes))
+      {
+        HandleError();
+        return false;
+      }
+
+      return true;
+    }
     else
     {
       // we're in an error-state, nothing to write to
@@ -392,7 +626,7 @@ public:
   template <typename T>
   bool WriteAt(uint64_t offs, const T &data)
   {
-    if(!m_File && !m_Sock && !m_Compressor)
+    if(!m_File && !m_Sock && !m_Compressor && !m_Sink)
     {
       RDCASSERT(ptrdiff_t(offs + sizeof(data)) <= m_BufferHead - m_BufferBase);
       byte *oldHead = m_BufferHead;
@@ -406,7 +640,7 @@ public:
       return ret;
     }
 
-    RDCERR("Can't seek a file/socket/compressor stream writer");
+    RDCERR("Can't seek a file/socket/compressor/sink stream writer");
 
     return false;
   }
@@ -415,10 +649,14 @@ public:
   {
     if(m_Compressor)
       return true;
+    else if(m_WriteBehind)
+      return FlushWriteBehind();
     else if(m_File)
       return FileIO::fflush(m_File);
     else if(m_Sock)
       return FlushSocketData();
+    else if(m_Sink)
+      return FlushSink();
 
     return true;
   }
@@ -427,10 +665,14 @@ public:
   {
     if(m_Compressor)
       return m_Compressor->Finish();
+    else if(m_WriteBehind)
+      return FlushWriteBehind();
     else if(m_File)
       return FileIO::fflush(m_File);
     else if(m_Sock)
       return true;
+    else if(m_Sink)
+      return FlushSink();
 
     return true;
   }
@@ -466,6 +708,8 @@ private:
 
   bool SendSocketData(const void *data, uint64_t numBytes);
   bool FlushSocketData();
+  bool FlushWriteBehind();
+  bool FlushSink();
 
   // used for aligned writes
   static const byte empty[128];
@@ -485,12 +729,18 @@ private:
   // file pointer, if we're writing to a file
   FILE *m_File = NULL;
 
+  // the worker writing to m_File, if writes are asynchronous
+  WriteBehindFile *m_WriteBehind = NULL;
+
   // the compressor, if writing to it
   Compressor *m_Compressor = NULL;
 
   // the socket, if writing to it
   Network::Socket *m_Sock = NULL;
 
+  // the sink, if writing to it
+  StreamSink *m_Sink = NULL;
+
   // true if we're not writing to file/compressor, used to optimise checks in Write
   bool m_InMemory = true;
 
@@ -506,3 +756,38 @@ private:
 };
 
 void StreamTransfer(StreamWriter *writer, StreamReader *reader, RENDERDOC_ProgressCallback progress);
+
+// resumable file transfers. The file is sent in fixed-size blocks each followed by a checksum, and
+// the receiver writes into a partial file as blocks are verified. If the transfer is interrupted,
+// everything up to the last good block is kept and a later transfer can pick up from there.
+static const uint64_t FileTransferBlockSize = 1024 * 1024;
+
+// on the receiving side, find where a transfer into partialFilename can resume from - the end of
+// the last complete block - and the checksum of that block. Both are 0 if there's nothing to
+// resume.
+void GetFileTransferResumePoint(const rdcstr &partialFilename, uint64_t &offset,
+                                uint64_t &checksum);
+
+// a hash of a file's whole contents, to identify identical files on either side of a connection.
+uint64_t HashFileContents(const rdcstr &filename);
+
+// the checksum a resume point at offset in filename is identified by - that of the block (or less,
+// at the start of the file) immediately before it.
+uint64_t GetFileTransferChecksum(const rdcstr &filename, uint64_t offset);
+
+// on the sending side, check the receiver's resume point against the source file. Returns the
+// offset to start sending from, which is 0 if the partial data doesn't match. A resume point at the
+// end of the file means the receiver already has all of it.
+uint64_t ValidateFileTransferResumePoint(const rdcstr &filename, uint64_t offset,
+                                         uint64_t checksum);
+
+// send totalSize - startOffset bytes of filename in checksummed blocks. The receiver must be told
+// totalSize separately.
+bool SendFileBlocks(StreamWriter *writer, const rdcstr &filename, uint64_t startOffset,
+                    uint64_t totalSize, RENDERDOC_ProgressCallback progress);
+
+// receive totalSize - startOffset bytes of checksummed blocks into partialFilename, discarding
+// anything already in the file past startOffset. Returns true if the file is now complete. Even on
+// failure all blocks are consumed from the reader, unless the reader itself fails.
+bool ReceiveFileBlocks(StreamReader *reader, const rdcstr &partialFilename, uint64_t startOffset,
+                       uint64_t totalSize, RENDERDOC_ProgressCallback progress);
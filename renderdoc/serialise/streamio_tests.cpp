@@ -24,6 +24,7 @@
 
 #include "streamio.h"
 #include "common/timing.h"
+#include "rdcfile.h"
 
 #if ENABLED(ENABLE_UNIT_TESTS)
 
@@ -94,6 +95,363 @@ TEST_CASE("Test basic stream I/O operations", "[streamio]")
   CHECK(reader.IsErrored());
 };
 
+TEST_CASE("Test reading from a memory-mapped file", "[streamio]")
+{
+  rdcstr filename = FileIO::GetTempFolderFilename() + "renderdoc_streamio_map_test";
+
+  bytebuf data;
+  data.resize(100000);
+  for(size_t i = 0; i < data.size(); i++)
+    data[i] = byte(i * 13);
+
+  REQUIRE(FileIO::WriteAll(filename.c_str(), data));
+
+  FILE *f = FileIO::fopen(filename.c_str(), "rb");
+  REQUIRE(f);
+
+  // map from an offset that isn't page aligned
+  const uint64_t offset = 1234;
+  const uint64_t length = data.size() - offset;
+
+  const byte *view = (const byte *)FileIO::MapFileRegion(f, offset, length);
+  REQUIRE(view);
+
+  // the mapping stays valid after the file is closed
+  FileIO::fclose(f);
+
+  bool unmapped = false;
+
+  {
+    StreamReader reader(StreamReader::ExternalMemory, view, length);
+    reader.AddCloseCallback([view, length, &unmapped]() {
+      FileIO::UnmapFileRegion(view, length);
+      unmapped = true;
+    });
+
+    uint32_t val = 0;
+    reader.Read(val);
+    CHECK(memcmp(&val, data.data() + offset, sizeof(val)) == 0);
+
+    const byte *direct = reader.ReadDirect(5000);
+    REQUIRE(direct);
+    CHECK(direct == view + sizeof(val));
+    CHECK(memcmp(direct, data.data() + offset + sizeof(val), 5000) == 0);
+    CHECK(reader.GetOffset() == 5000 + sizeof(val));
+
+    // can't directly read past the end
+    CHECK(reader.ReadDirect(length) == NULL);
+    CHECK(reader.GetOffset() == 5000 + sizeof(val));
+
+    reader.SetOffset(length - 4);
+    reader.Read(val);
+    CHECK(memcmp(&val, data.data() + data.size() - 4, sizeof(val)) == 0);
+
+    CHECK_FALSE(reader.IsErrored());
+    CHECK(reader.AtEnd());
+  }
+
+  CHECK(unmapped);
+
+  f = FileIO::fopen(filename.c_str(), "rb");
+  REQUIRE(f);
+
+  // a region running past the end of the file isn't mapped, since touching it would fault
+  CHECK(FileIO::MapFileRegion(f, offset, data.size()) == NULL);
+
+  view = (const byte *)FileIO::MapFileRegion(f, offset, length);
+  REQUIRE(view);
+
+  FileIO::fclose(f);
+
+  {
+    StreamReader reader(StreamReader::ExternalMemory, view, length);
+    reader.AddCloseCallback([view, length]() { FileIO::UnmapFileRegion(view, length); });
+
+    // pretend the file is truncated part way through reading it
+    uint64_t covered = length;
+    reader.SetExternalMemoryCheck([&covered]() { return covered; });
+
+    uint32_t val = 0;
+    reader.Read(val);
+    CHECK(memcmp(&val, data.data() + offset, sizeof(val)) == 0);
+    CHECK_FALSE(reader.IsErrored());
+
+    covered = 1000;
+
+    reader.SetOffset(length - 4);
+    CHECK_FALSE(reader.Read(val));
+    CHECK(val == 0);
+    CHECK(reader.IsErrored());
+  }
+
+  FileIO::Delete(filename.c_str());
+};
+
+TEST_CASE("Test writing to a file from a write-behind thread", "[streamio]")
+{
+  rdcstr filename = FileIO::GetTempFolderFilename() + "renderdoc_streamio_writebehind_test";
+
+  // several slots worth, not a multiple of the slot size
+  bytebuf data;
+  data.resize(5 * 1024 * 1024 + 777);
+  for(size_t i = 0; i < data.size(); i++)
+    data[i] = byte((i * 13) ^ (i >> 11));
+
+  FILE *f = FileIO::fopen(filename.c_str(), "wb");
+  REQUIRE(f);
+
+  uint64_t sizeInCallback = 0;
+
+  {
+    StreamWriter writer(StreamWriter::WriteBehind, f, Ownership::Nothing);
+
+    // by the time close callbacks run, everything must be in the file
+    writer.AddCloseCallback([f, &sizeInCallback]() {
+      FileIO::fflush(f);
+      sizeInCallback = FileIO::ftell64(f);
+    });
+
+    // write in odd-sized pieces so they straddle slot boundaries
+    size_t offs = 0;
+    while(offs < 3 * 1024 * 1024)
+    {
+      writer.Write(data.data() + offs, 333333);
+      offs += 333333;
+    }
+
+    // a flush waits for the partial slot too, and writing carries on afterwards
+    CHECK(writer.Flush());
+    CHECK(FileIO::ftell64(f) == offs);
+
+    uint32_t val = 0x12345678;
+    writer.Write(data.data() + offs, data.size() - offs);
+    writer.Write(val);
+
+    CHECK(writer.GetOffset() == data.size() + sizeof(val));
+    CHECK_FALSE(writer.IsErrored());
+  }
+
+  CHECK(sizeInCallback == data.size() + sizeof(uint32_t));
+
+  FileIO::fclose(f);
+
+  bytebuf readBack;
+  REQUIRE(FileIO::ReadAll(filename.c_str(), readBack));
+  REQUIRE(readBack.size() == data.size() + sizeof(uint32_t));
+  CHECK(memcmp(readBack.data(), data.data(), data.size()) == 0);
+
+  uint32_t val = 0;
+  memcpy(&val, readBack.data() + data.size(), sizeof(val));
+  CHECK(val == 0x12345678);
+
+  FileIO::Delete(filename.c_str());
+};
+
+TEST_CASE("Test resumable file transfers", "[streamio]")
+{
+  rdcstr source = FileIO::GetTempFolderFilename() + "renderdoc_streamio_xfer_src";
+  rdcstr partial = FileIO::GetTempFolderFilename() + "renderdoc_streamio_xfer_dst.partial";
+
+  // two and a half blocks
+  bytebuf data;
+  data.resize(size_t(FileTransferBlockSize * 5 / 2));
+  for(size_t i = 0; i < data.size(); i++)
+    data[i] = byte(i * 7 + (i >> 12));
+
+  REQUIRE(FileIO::WriteAll(source.c_str(), data));
+
+  const uint64_t totalSize = data.size();
+
+  uint64_t offset = 1, checksum = 1;
+
+  FileIO::Delete(partial.c_str());
+  GetFileTransferResumePoint(partial, offset, checksum);
+  CHECK(offset == 0);
+  CHECK(checksum == 0);
+
+  SECTION("Complete transfer")
+  {
+    StreamWriter writer(StreamWriter::DefaultScratchSize);
+    CHECK(SendFileBlocks(&writer, source, 0, totalSize, NULL));
+
+    StreamReader reader(writer.GetData(), writer.GetOffset());
+    CHECK(ReceiveFileBlocks(&reader, partial, 0, totalSize, NULL));
+    CHECK(reader.AtEnd());
+
+    bytebuf received;
+    REQUIRE(FileIO::ReadAll(partial.c_str(), received));
+    CHECK(received == data);
+
+    CHECK(HashFileContents(partial) == HashFileContents(source));
+    CHECK(HashFileContents(partial) != 0);
+  };
+
+  SECTION("Corrupted block is not kept, and transfer resumes after the last good block")
+  {
+    StreamWriter writer(StreamWriter::DefaultScratchSize);
+    CHECK(SendFileBlocks(&writer, source, 0, totalSize, NULL));
+
+    // corrupt a byte in the second block
+    bytebuf wire(writer.GetData(), (size_t)writer.GetOffset());
+    wire[size_t(FileTransferBlockSize + sizeof(uint64_t) + 100)] ^= 0xff;
+
+    {
+      StreamReader reader(wire);
+      CHECK_FALSE(ReceiveFileBlocks(&reader, partial, 0, totalSize, NULL));
+      // the remaining blocks were still consumed
+      CHECK(reader.AtEnd());
+    }
+
+    CHECK(FileIO::GetFileSize(partial) == FileTransferBlockSize);
+
+    GetFileTransferResumePoint(partial, offset, checksum);
+    CHECK(offset == FileTransferBlockSize);
+
+    uint64_t startOffset = ValidateFileTransferResumePoint(source, offset, checksum);
+    CHECK(startOffset == FileTransferBlockSize);
+
+    // a mismatching checksum restarts from the beginning
+    CHECK(ValidateFileTransferResumePoint(source, offset, checksum + 1) == 0);
+
+    StreamWriter resumeWriter(StreamWriter::DefaultScratchSize);
+    CHECK(SendFileBlocks(&resumeWriter, source, startOffset, totalSize, NULL));
+
+    StreamReader reader(resumeWriter.GetData(), resumeWriter.GetOffset());
+    CHECK(ReceiveFileBlocks(&reader, partial, startOffset, totalSize, NULL));
+
+    bytebuf received;
+    REQUIRE(FileIO::ReadAll(partial.c_str(), received));
+    CHECK(received == data);
+  };
+
+  FileIO::Delete(partial.c_str());
+  FileIO::Delete(source.c_str());
+};
+
+TEST_CASE("Test streaming a capture file as it's written", "[streamio]")
+{
+  struct MemoryFileStream : public RDCFileStream
+  {
+    bool Write(const void *data, uint64_t numBytes) override
+    {
+      contents.append((const byte *)data, (size_t)numBytes);
+      return true;
+    }
+    bool Flush() override { return true; }
+    bool Patch(uint64_t offset, const void *data, uint64_t numBytes) override
+    {
+      if(offset + numBytes > contents.size())
+        return false;
+      memcpy(contents.data() + offset, data, (size_t)numBytes);
+      patches++;
+      return true;
+    }
+    void Finish(bool s) override
+    {
+      finished = true;
+      success = s;
+    }
+
+    bytebuf contents;
+    int patches = 0;
+    bool finished = false, success = false;
+  };
+
+  MemoryFileStream stream;
+
+  bytebuf data;
+  data.resize(256 * 1024);
+  for(size_t i = 0; i < data.size(); i++)
+    data[i] = byte((i * 13) ^ (i >> 9));
+
+  const char extraName[] = "extra section";
+
+  {
+    RDCFile rdc;
+    rdc.SetData(RDCDriver::Unknown, "Test", 0, NULL);
+    rdc.Create(&stream);
+
+    REQUIRE((rdc.ErrorCode() == ContainerError::NoError));
+
+    SectionProperties props;
+    props.type = SectionType::FrameCapture;
+    props.flags = SectionFlags::ZstdCompressed;
+    props.version = 1;
+
+    StreamWriter *w = rdc.WriteSection(props);
+    w->Write(data.data(), data.size());
+    w->Finish();
+    CHECK_FALSE(w->IsErrored());
+    delete w;
+
+    props.type = SectionType::Unknown;
+    props.flags = SectionFlags::NoFlags;
+    props.name = extraName;
+    w = rdc.WriteSection(props);
+    w->Write(extraName, sizeof(extraName));
+    w->Finish();
+    CHECK_FALSE(w->IsErrored());
+    delete w;
+
+    // sections already sent can't be replaced
+    w = rdc.WriteSection(props);
+    CHECK(w->IsErrored());
+    delete w;
+
+    // the compressed frame capture also gets a seek table section
+    CHECK(rdc.NumSections() == 3);
+    CHECK((rdc.ErrorCode() == ContainerError::NoError));
+
+    CHECK_FALSE(stream.finished);
+  }
+
+  CHECK(stream.finished);
+  CHECK(stream.success);
+  // each section's lengths were patched in once it was finished
+  CHECK(stream.patches == 3);
+
+  // what was streamed is a normal capture file
+  rdcstr filename = FileIO::GetTempFolderFilename() + "renderdoc_streamio_rdc_stream_test.rdc";
+  REQUIRE(FileIO::WriteAll(filename.c_str(), stream.contents));
+
+  {
+    RDCFile rdc;
+    rdc.Open(filename.c_str());
+
+    REQUIRE((rdc.ErrorCode() == ContainerError::NoError));
+    REQUIRE(rdc.NumSections() == 3);
+
+    int frameIdx = rdc.SectionIndex(SectionType::FrameCapture);
+    int extraIdx = rdc.SectionIndex(extraName);
+    REQUIRE(frameIdx >= 0);
+    REQUIRE(extraIdx >= 0);
+    CHECK(rdc.SectionIndex(SectionType::SeekTable) >= 0);
+
+    CHECK(rdc.GetSectionProperties(frameIdx).uncompressedSize == data.size());
+    CHECK(rdc.GetSectionProperties(frameIdx).compressedSize < data.size());
+
+    bytebuf readBack;
+    readBack.resize(data.size());
+
+    StreamReader *reader = rdc.ReadSection(frameIdx);
+    reader->Read(readBack.data(), readBack.size());
+    CHECK_FALSE(reader->IsErrored());
+    delete reader;
+
+    CHECK(readBack == data);
+
+    char extraReadBack[sizeof(extraName)] = {};
+    reader = rdc.ReadSection(extraIdx);
+    reader->Read(extraReadBack, sizeof(extraReadBack));
+    CHECK_FALSE(reader->IsErrored());
+    delete reader;
+
+    CHECK(rdcstr(extraReadBack) == extraName);
+  }
+
+  FileIO::Delete(filename.c_str());
+};
+
 TEST_CASE("Test stream I/O operations over the network", "[streamio][network]")
 {
   uint16_t port = 8235;
@@ -0,0 +1,480 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019-2020 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+
+#include "structured_diff.h"
+#include <map>
+#include <unordered_map>
+#include "common/formatting.h"
+#include "serialiser.h"
+
+namespace
+{
+// how far ahead to look for a chunk with the same name before giving up and treating the current
+// pair as a single modified chunk.
+static const size_t ResyncWindow = 64;
+
+static uint64_t HashBytes(const void *data, size_t size, uint64_t hash)
+{
+  // FNV-1a, this only needs to be fast and well-distributed - not cryptographic.
+  const byte *bytes = (const byte *)data;
+  for(size_t i = 0; i < size; i++)
+    hash = (hash ^ bytes[i]) * 1099511628211ULL;
+  return hash;
+}
+
+static const uint64_t HashSeed = 14695981039346656037ULL;
+
+// ResourceIds are allocated at runtime, so two captures of the same application will almost never
+// use the same IDs for the same resources. Instead each resource is identified by the name of the
+// chunk where it first appears - normally the one that creates it - and how many resources were
+// first seen in that kind of chunk before it, so the Nth image created matches in both files.
+struct NormalisedResource
+{
+  const rdcstr *chunk;
+  uint32_t index;
+};
+
+struct SubtreeHasher
+{
+  SubtreeHasher(const SDFile &f) : file(f)
+  {
+    std::map<rdcstr, uint32_t> counts;
+    for(const SDChunk *chunk : file.chunks)
+      NormaliseResources(chunk->name, chunk, counts);
+  }
+  const SDFile &file;
+  std::unordered_map<const SDObject *, uint64_t> hashes;
+  std::map<ResourceId, NormalisedResource> resources;
+
+  void NormaliseResources(const rdcstr &chunkName, const SDObject *obj,
+                          std::map<rdcstr, uint32_t> &counts)
+  {
+    if(obj->type.basetype == SDBasic::Resource)
+    {
+      ResourceId id = obj->data.basic.id;
+      if(id != ResourceId() && resources.find(id) == resources.end())
+        resources[id] = {&chunkName, counts[chunkName]++};
+      return;
+    }
+
+    for(size_t i = 0; i < obj->NumChildren(); i++)
+      NormaliseResources(chunkName, obj->GetChild(i), counts);
+  }
+
+  const NormalisedResource *GetResource(ResourceId id) const
+  {
+    auto it = resources.find(id);
+    return it == resources.end() ? NULL : &it->second;
+  }
+
+  uint64_t Hash(const SDObject *obj)
+  {
+    auto it = hashes.find(obj);
+    if(it != hashes.end())
+      return it->second;
+
+    uint64_t hash = HashSeed;
+    hash = HashBytes(obj->name.c_str(), obj->name.size(), hash);
+    hash = HashBytes(obj->type.name.c_str(), obj->type.name.size(), hash);
+    hash = HashBytes(&obj->type.basetype, sizeof(obj->type.basetype), hash);
+
+    if(obj->type.basetype == SDBasic::Buffer)
+    {
+      // the object only holds an index into the file's buffers, the contents are what matter. If
+      // the buffers weren't loaded the best we can do is the size.
+      uint64_t idx = obj->data.basic.u;
+      if(idx < file.buffers.size() && file.buffers[idx])
+        hash = HashBytes(file.buffers[idx]->data(), file.buffers[idx]->size(), hash);
+      else
+        hash = HashBytes(&obj->type.byteSize, sizeof(obj->type.byteSize), hash);
+    }
+    else if(obj->type.basetype == SDBasic::Resource)
+    {
+      const NormalisedResource *res = GetResource(obj->data.basic.id);
+      if(res)
+      {
+        hash = HashBytes(res->chunk->c_str(), res->chunk->size(), hash);
+        hash = HashBytes(&res->index, sizeof(res->index), hash);
+      }
+    }
+    else
+    {
+      hash = HashBytes(&obj->data.basic, sizeof(obj->data.basic), hash);
+      hash = HashBytes(obj->data.str.c_str(), obj->data.str.size(), hash);
+    }
+
+    for(size_t i = 0; i < obj->NumChildren(); i++)
+    {
+      uint64_t child = Hash(obj->GetChild(i));
+      hash = HashBytes(&child, sizeof(child), hash);
+    }
+
+    hashes[obj] = hash;
+    return hash;
+  }
+};
+
+static rdcstr ValueString(const SubtreeHasher &hasher, const SDObject *obj)
+{
+  if(!obj)
+    return "<missing>";
+
+  switch(obj->type.basetype)
+  {
+    case SDBasic::Chunk:
+    case SDBasic::Struct: return StringFormat::Fmt("{%s}", obj->type.name.c_str());
+    case SDBasic::Array: return StringFormat::Fmt("[%zu elements]", obj->NumChildren());
+    case SDBasic::Null: return "NULL";
+    case SDBasic::Buffer:
+    {
+      const SDFile &file = hasher.file;
+      uint64_t idx = obj->data.basic.u;
+      uint64_t size = obj->type.byteSize;
+      if(idx < file.buffers.size() && file.buffers[idx])
+        size = file.buffers[idx]->size();
+      return StringFormat::Fmt("[buffer %llu bytes]", size);
+    }
+    case SDBasic::String:
+    case SDBasic::Enum: return obj->data.str;
+    case SDBasic::UnsignedInteger: return ToStr(obj->data.basic.u);
+    case SDBasic::SignedInteger: return ToStr(obj->data.basic.i);
+    case SDBasic::Float: return ToStr(obj->data.basic.d);
+    case SDBasic::Boolean: return ToStr(obj->data.basic.b);
+    case SDBasic::Character: return ToStr(obj->data.basic.c);
+    case SDBasic::Resource:
+    {
+      const NormalisedResource *res = hasher.GetResource(obj->data.basic.id);
+      if(!res)
+        return ToStr(obj->data.basic.id);
+      return StringFormat::Fmt("%s #%u", res->chunk->c_str(), res->index);
+    }
+  }
+
+  return rdcstr();
+}
+
+struct Differ
+{
+  Differ(const SDFile &fileA, const SDFile &fileB, RENDERDOC_CaptureDiffCallback cb)
+      : a(fileA), b(fileB), hashA(fileA), hashB(fileB), callback(cb)
+  {
+  }
+
+  const SDFile &a, &b;
+  SubtreeHasher hashA, hashB;
+  RENDERDOC_CaptureDiffCallback callback;
+  uint32_t count = 0;
+  bool stopped = false;
+
+  void Report(int32_t chunkA, int32_t chunkB, const rdcstr &name, const rdcstr &path,
+              const rdcstr &valueA, const rdcstr &valueB)
+  {
+    if(stopped)
+      return;
+
+    CaptureDifference diff;
+    diff.chunkA = chunkA;
+    diff.chunkB = chunkB;
+    diff.name = name;
+    diff.path = path;
+    diff.valueA = valueA;
+    diff.valueB = valueB;
+
+    count++;
+    if(callback && !callback(diff))
+      stopped = true;
+  }
+
+  void DiffMembers(int32_t chunkA, int32_t chunkB, const rdcstr &chunkName, const rdcstr &path,
+                   const SDObject *objA, const SDObject *objB)
+  {
+    if(stopped)
+      return;
+
+    if(!objA || !objB || objA->type.basetype != objB->type.basetype ||
+       objA->type.name != objB->type.name)
+    {
+      Report(chunkA, chunkB, chunkName, path, ValueString(hashA, objA),
+             ValueString(hashB, objB));
+      return;
+    }
+
+    if(hashA.Hash(objA) == hashB.Hash(objB))
+      return;
+
+    // leaves, or buffers which have no children but differing contents
+    if(objA->NumChildren() == 0 && objB->NumChildren() == 0)
+    {
+      rdcstr valueA = ValueString(hashA, objA), valueB = ValueString(hashB, objB);
+
+      if(objA->type.basetype == SDBasic::Buffer && valueA == valueB)
+        valueB += " (contents differ)";
+
+      Report(chunkA, chunkB, chunkName, path, valueA, valueB);
+      return;
+    }
+
+    const bool isArray = objA->type.basetype == SDBasic::Array;
+
+    size_t num = RDCMAX(objA->NumChildren(), objB->NumChildren());
+    for(size_t i = 0; i < num && !stopped; i++)
+    {
+      const SDObject *childA = objA->GetChild(i);
+      const SDObject *childB = objB->GetChild(i);
+
+      rdcstr childPath = path;
+      if(isArray)
+      {
+        childPath += StringFormat::Fmt("[%zu]", i);
+      }
+      else
+      {
+        if(!childPath.empty())
+          childPath += ".";
+        childPath += childA ? childA->name : childB->name;
+      }
+
+      DiffMembers(chunkA, chunkB, chunkName, childPath, childA, childB);
+    }
+  }
+
+  void Run()
+  {
+    const size_t numA = a.chunks.size(), numB = b.chunks.size();
+
+    size_t i = 0, j = 0;
+    while(i < numA && j < numB && !stopped)
+    {
+      const SDChunk *chunkA = a.chunks[i];
+      const SDChunk *chunkB = b.chunks[j];
+
+      if(hashA.Hash(chunkA) == hashB.Hash(chunkB))
+      {
+        i++;
+        j++;
+        continue;
+      }
+
+      if(chunkA->name == chunkB->name)
+      {
+        DiffMembers((int32_t)i, (int32_t)j, chunkA->name, rdcstr(), chunkA, chunkB);
+        i++;
+        j++;
+        continue;
+      }
+
+      // the chunks don't line up. Look for the nearest point where they do again, on either side,
+      // and report everything skipped over as removed or added.
+      size_t removed = 0, added = 0;
+      for(size_t k = 1; k <= ResyncWindow; k++)
+      {
+        if(i + k < numA && a.chunks[i + k]->name == chunkB->name)
+        {
+          removed = k;
+          break;
+        }
+        if(j + k < numB && b.chunks[j + k]->name == chunkA->name)
+        {
+          added = k;
+          break;
+        }
+      }
+
+      if(removed > 0)
+      {
+        for(size_t k = 0; k < removed && !stopped; k++, i++)
+          Report((int32_t)i, -1, a.chunks[i]->name, rdcstr(), a.chunks[i]->name, rdcstr());
+      }
+      else if(added > 0)
+      {
+        for(size_t k = 0; k < added && !stopped; k++, j++)
+          Report(-1, (int32_t)j, b.chunks[j]->name, rdcstr(), rdcstr(), b.chunks[j]->name);
+      }
+      else
+      {
+        // no resync point nearby, treat this as one chunk being replaced by another
+        Report((int32_t)i, (int32_t)j, chunkA->name, rdcstr(), chunkA->name, chunkB->name);
+        i++;
+        j++;
+      }
+    }
+
+    for(; i < numA && !stopped; i++)
+      Report((int32_t)i, -1, a.chunks[i]->name, rdcstr(), a.chunks[i]->name, rdcstr());
+    for(; j < numB && !stopped; j++)
+      Report(-1, (int32_t)j, b.chunks[j]->name, rdcstr(), rdcstr(), b.chunks[j]->name);
+  }
+};
+};    // anonymous namespace
+
+uint32_t DiffStructuredData(const SDFile &a, const SDFile &b,
+                            RENDERDOC_CaptureDiffCallback callback)
+{
+  Differ differ(a, b, callback);
+  differ.Run();
+  return differ.count;
+}
+
+#if ENABLED(ENABLE_UNIT_TESTS)
+
+#include "3rdparty/catch/catch.hpp"
+
+static SDChunk *MakeChunk(const char *name, uint32_t value)
+{
+  SDChunk *chunk = new SDChunk(name);
+  SDObject *info = makeSDStruct("CreateInfo", "CreateInfo");
+  info->data.children.push_back(makeSDUInt32("width", value));
+  info->data.children.push_back(makeSDUInt32("height", 64));
+  chunk->data.children.push_back(info);
+  return chunk;
+}
+
+TEST_CASE("Test structured data diffing", "[structured_diff]")
+{
+  SDFile a, b;
+
+  rdcarray<CaptureDifference> diffs;
+  auto collect = [&diffs](const CaptureDifference &d) {
+    diffs.push_back(d);
+    return true;
+  };
+
+  SECTION("Identical files have no differences")
+  {
+    for(uint32_t i = 0; i < 10; i++)
+    {
+      a.chunks.push_back(MakeChunk("Draw", i));
+      b.chunks.push_back(MakeChunk("Draw", i));
+    }
+
+    CHECK(DiffStructuredData(a, b, collect) == 0);
+    CHECK(diffs.empty());
+  };
+
+  SECTION("Modified member reports its path and values")
+  {
+    a.chunks.push_back(MakeChunk("Create", 1));
+    a.chunks.push_back(MakeChunk("Draw", 2));
+    b.chunks.push_back(MakeChunk("Create", 1));
+    b.chunks.push_back(MakeChunk("Draw", 3));
+
+    REQUIRE(DiffStructuredData(a, b, collect) == 1);
+    CHECK(diffs[0].chunkA == 1);
+    CHECK(diffs[0].chunkB == 1);
+    CHECK(diffs[0].name == "Draw");
+    CHECK(diffs[0].path == "CreateInfo.width");
+    CHECK(diffs[0].valueA == "2");
+    CHECK(diffs[0].valueB == "3");
+  };
+
+  SECTION("Inserted and removed chunks don't misalign the rest")
+  {
+    a.chunks.push_back(MakeChunk("Create", 1));
+    a.chunks.push_back(MakeChunk("Marker", 0));
+    a.chunks.push_back(MakeChunk("Draw", 2));
+    a.chunks.push_back(MakeChunk("Draw", 3));
+
+    b.chunks.push_back(MakeChunk("Create", 1));
+    b.chunks.push_back(MakeChunk("Draw", 2));
+    b.chunks.push_back(MakeChunk("Dispatch", 0));
+    b.chunks.push_back(MakeChunk("Draw", 3));
+
+    REQUIRE(DiffStructuredData(a, b, collect) == 2);
+    CHECK(diffs[0].chunkA == 1);
+    CHECK(diffs[0].chunkB == -1);
+    CHECK(diffs[0].name == "Marker");
+    CHECK(diffs[1].chunkA == -1);
+    CHECK(diffs[1].chunkB == 2);
+    CHECK(diffs[1].name == "Dispatch");
+  };
+
+  SECTION("Buffers are compared by contents")
+  {
+    for(SDFile *f : {&a, &b})
+    {
+      SDChunk *chunk = new SDChunk("Upload");
+      SDObject *buf = new SDObject("Contents", "Buffer");
+      buf->type.basetype = SDBasic::Buffer;
+      buf->type.byteSize = 4;
+      buf->data.basic.u = 0;
+      chunk->data.children.push_back(buf);
+      f->chunks.push_back(chunk);
+      f->buffers.push_back(new bytebuf({1, 2, 3, 4}));
+    }
+
+    CHECK(DiffStructuredData(a, b, collect) == 0);
+
+    (*b.buffers[0])[2] = 9;
+
+    REQUIRE(DiffStructuredData(a, b, collect) == 1);
+    CHECK(diffs[0].path == "Contents");
+  };
+
+  SECTION("Resources are matched by creation order, not by ID")
+  {
+    ResourceId imagesB[2];
+
+    for(SDFile *f : {&a, &b})
+    {
+      ResourceId images[2];
+      for(ResourceId &id : images)
+      {
+        id = ResourceIDGen::GetNewUniqueID();
+        SDChunk *chunk = new SDChunk("CreateImage");
+        chunk->data.children.push_back(makeSDResourceId("Image", id));
+        f->chunks.push_back(chunk);
+      }
+
+      SDChunk *chunk = new SDChunk("Draw");
+      chunk->data.children.push_back(makeSDResourceId("Target", images[1]));
+      f->chunks.push_back(chunk);
+
+      imagesB[0] = images[0];
+      imagesB[1] = images[1];
+    }
+
+    CHECK(DiffStructuredData(a, b, collect) == 0);
+
+    b.chunks.back()->data.children[0]->data.basic.id = imagesB[0];
+
+    REQUIRE(DiffStructuredData(a, b, collect) == 1);
+    CHECK(diffs[0].path == "Target");
+    CHECK(diffs[0].valueA == "CreateImage #1");
+    CHECK(diffs[0].valueB == "CreateImage #0");
+  };
+
+  SECTION("Returning false from the callback stops the diff")
+  {
+    for(uint32_t i = 0; i < 10; i++)
+    {
+      a.chunks.push_back(MakeChunk("Draw", i));
+      b.chunks.push_back(MakeChunk("Draw", i + 1));
+    }
+
+    CHECK(DiffStructuredData(a, b, [](const CaptureDifference &) { return false; }) == 1);
+  };
+}
+
+#endif    // ENABLED(ENABLE_UNIT_TESTS)
@@ -24,26 +24,89 @@
 
 #define ZSTD_STATIC_LINKING_ONLY
 #include "zstdio.h"
+#include "common/profiler.h"
+#include "common/threading.h"
 
 static const uint64_t zstdBlockSize = 128 * 1024;
 static const uint64_t compressBlockSize = ZSTD_compressBound(zstdBlockSize);
 
-ZSTDCompressor::ZSTDCompressor(StreamWriter *write, Ownership own) : Compressor(write, own)
+// how many pages each thread gets per batch when compressing in parallel
+static const uint32_t zstdPagesPerThread = 8;
+
+ZSTDCompressor::ZSTDCompressor(StreamWriter *write, Ownership own, uint32_t numThreads, int level,
+                               bool firstPageDictionary)
+    : Compressor(write, own)
 {
-  m_Page = AllocAlignedBuffer(zstdBlockSize);
-  m_CompressBuffer = AllocAlignedBuffer(compressBlockSize);
+  m_NumThreads = RDCMAX(1U, numThreads);
+  m_Level = level;
+  m_UseDictionary = firstPageDictionary;
+
+  if(m_NumThreads > 1)
+  {
+    m_BatchSize = m_NumThreads * zstdPagesPerThread;
+    m_BatchLengths.resize(m_BatchSize);
+    m_BatchCompSizes.resize(m_BatchSize);
+
+    // contexts are created the first time a thread gets any pages
+    m_ThreadContexts.resize(m_NumThreads);
+    for(ZSTD_CCtx *&ctx : m_ThreadContexts)
+      ctx = NULL;
+
+    // see LZ4Compressor, the batch starts with a single page and grows as pages are queued
+    m_BatchCapacity = 1;
+    m_BatchPages = AllocAlignedBuffer(zstdBlockSize);
+
+    m_Page = m_BatchPages;
+    m_CompressBuffer = AllocAlignedBuffer(compressBlockSize);
+  }
+  else
+  {
+    m_Page = AllocAlignedBuffer(zstdBlockSize);
+    m_CompressBuffer = AllocAlignedBuffer(compressBlockSize);
+  }
 
   m_PageOffset = 0;
 
+  // every page is compressed as its own frame, so the stream can always be seeked
+  m_SeekTable.blockSize = zstdBlockSize;
+
   m_Stream = ZSTD_createCStream();
 }
 
 ZSTDCompressor::~ZSTDCompressor()
 {
   ZSTD_freeCStream(m_Stream);
+  ZSTD_freeCDict(m_Dictionary);
 
-  FreeAlignedBuffer(m_Page);
+  for(ZSTD_CCtx *ctx : m_ThreadContexts)
+    ZSTD_freeCCtx(ctx);
+
+  FreeBuffers();
+}
+
+void ZSTDCompressor::FreeBuffers()
+{
+  if(m_BatchPages)
+    FreeAlignedBuffer(m_BatchPages);
+  else
+    FreeAlignedBuffer(m_Page);
   FreeAlignedBuffer(m_CompressBuffer);
+  m_Page = m_CompressBuffer = m_BatchPages = NULL;
+}
+
+void ZSTDCompressor::CreateDictionary(const byte *page, uint64_t length)
+{
+  // the contents are copied so the page can be re-used straight away. It's always treated as raw
+  // content, even if the data happens to start with the zstd dictionary magic number.
+  m_Dictionary = ZSTD_createCDict_advanced(
+      page, (size_t)length, ZSTD_dlm_byCopy, ZSTD_dct_rawContent,
+      ZSTD_getCParams(m_Level, zstdBlockSize, (size_t)length), ZSTD_defaultCMem);
+
+  if(m_Dictionary == NULL)
+  {
+    RDCERR("Couldn't create compression dictionary");
+    FreeBuffers();
+  }
 }
 
 bool ZSTDCompressor::Write(const void *data, uint64_t numBytes)
@@ -112,15 +175,49 @@ bool ZSTDCompressor::Finish()
   // only the last one can be smaller, so we only write a partial page when finishing.
   // Calling Write() after Finish() is illegal
 
+  if(m_NumThreads > 1)
+  {
+    if(!m_CompressBuffer)
+      return false;
+
+    // queue the last page directly, there's no need to make room for another page after it
+    m_BatchLengths[m_BatchCount++] = (uint32_t)m_PageOffset;
+    m_PageOffset = 0;
+
+    return FlushBatch();
+  }
+
   return FlushPage();
 }
 
 bool ZSTDCompressor::FlushPage()
 {
+  RDCPROFILE_ZONE("ZSTDCompressor::FlushPage");
+
   // if we encountered a stream error this will be NULL
   if(!m_CompressBuffer)
     return false;
 
+  if(m_NumThreads > 1)
+  {
+    // queue this page in the batch and move on to the next one. Once the batch is full it's
+    // compressed and written in one go
+    m_BatchLengths[m_BatchCount++] = (uint32_t)m_PageOffset;
+    m_PageOffset = 0;
+
+    bool success = true;
+
+    if(m_BatchCount == m_BatchSize)
+      success = FlushBatch();
+    else if(m_BatchCount == m_BatchCapacity)
+      GrowBatch();
+
+    if(m_BatchPages)
+      m_Page = m_BatchPages + zstdBlockSize * m_BatchCount;
+
+    return success;
+  }
+
   ZSTD_inBuffer in = {m_Page, (size_t)m_PageOffset, 0};
   ZSTD_outBuffer out = {m_CompressBuffer, ZSTD_CStreamOutSize(), 0};
 
@@ -132,27 +229,118 @@ bool ZSTDCompressor::FlushPage()
   if(!m_CompressBuffer)
     return false;
 
+  m_SeekTable.blockOffsets.push_back(m_Write->GetOffset());
+
   // a bit redundant to write this but it means we can read the entire frame without
   // doing multiple reads
   success &= m_Write->Write((uint32_t)out.pos);
   success &= m_Write->Write(m_CompressBuffer, out.pos);
 
+  if(m_UseDictionary && m_Dictionary == NULL)
+  {
+    CreateDictionary(m_Page, m_PageOffset);
+
+    if(!m_CompressBuffer)
+      return false;
+  }
+
   // start writing to the start of the page again
   m_PageOffset = 0;
 
   return success;
 }
 
+void ZSTDCompressor::GrowBatch()
+{
+  uint32_t capacity = RDCMIN(m_BatchCapacity * 2, m_BatchSize);
+
+  byte *pages = AllocAlignedBuffer(zstdBlockSize * capacity);
+  memcpy(pages, m_BatchPages, size_t(zstdBlockSize * m_BatchCount));
+  FreeAlignedBuffer(m_BatchPages);
+  m_BatchPages = pages;
+
+  FreeAlignedBuffer(m_CompressBuffer);
+  m_CompressBuffer = AllocAlignedBuffer(compressBlockSize * capacity);
+
+  m_BatchCapacity = capacity;
+}
+
+bool ZSTDCompressor::FlushBatch()
+{
+  uint32_t first = 0;
+
+  // the very first page has to be compressed on its own before the others, as it's their dictionary
+  if(m_UseDictionary && m_Dictionary == NULL && m_BatchCount > 0)
+  {
+    if(m_ThreadContexts[0] == NULL)
+      m_ThreadContexts[0] = ZSTD_createCCtx();
+
+    m_BatchCompSizes[0] = ZSTD_compressCCtx(m_ThreadContexts[0], m_CompressBuffer,
+                                            compressBlockSize, m_BatchPages, m_BatchLengths[0],
+                                            m_Level);
+
+    CreateDictionary(m_BatchPages, m_BatchLengths[0]);
+
+    if(!m_CompressBuffer)
+      return false;
+
+    first = 1;
+  }
+
+  // give each thread a fixed stride of pages so that it can keep using its own context. Partial
+  // batches only use as many threads as they have pages.
+  const uint32_t strides = RDCMIN(m_NumThreads, m_BatchCount - first);
+
+  Threading::ParallelFor(strides, strides, [this, first, strides](uint32_t t) {
+    if(m_ThreadContexts[t] == NULL)
+      m_ThreadContexts[t] = ZSTD_createCCtx();
+
+    for(uint32_t i = first + t; i < m_BatchCount; i += strides)
+    {
+      if(m_Dictionary)
+        m_BatchCompSizes[i] = ZSTD_compress_usingCDict(
+            m_ThreadContexts[t], m_CompressBuffer + compressBlockSize * i, compressBlockSize,
+            m_BatchPages + zstdBlockSize * i, m_BatchLengths[i], m_Dictionary);
+      else
+        m_BatchCompSizes[i] = ZSTD_compressCCtx(
+            m_ThreadContexts[t], m_CompressBuffer + compressBlockSize * i, compressBlockSize,
+            m_BatchPages + zstdBlockSize * i, m_BatchLengths[i], m_Level);
+    }
+  });
+
+  bool success = true;
+
+  for(uint32_t i = 0; success && i < m_BatchCount; i++)
+  {
+    size_t compSize = m_BatchCompSizes[i];
+
+    if(ZSTD_isError(compSize))
+    {
+      RDCERR("Error compressing: %s", ZSTD_getErrorName(compSize));
+      FreeBuffers();
+      return false;
+    }
+
+    m_SeekTable.blockOffsets.push_back(m_Write->GetOffset());
+
+    success &= m_Write->Write((uint32_t)compSize);
+    success &= m_Write->Write(m_CompressBuffer + compressBlockSize * i, compSize);
+  }
+
+  m_BatchCount = 0;
+
+  return success;
+}
+
 bool ZSTDCompressor::CompressZSTDFrame(ZSTD_inBuffer &in, ZSTD_outBuffer &out)
 {
-  size_t err = ZSTD_initCStream(m_Stream, 7);
+  size_t err = m_Dictionary ? ZSTD_initCStream_usingCDict(m_Stream, m_Dictionary)
+                            : ZSTD_initCStream(m_Stream, m_Level);
 
   if(ZSTD_isError(err))
   {
     RDCERR("Error compressing: %s", ZSTD_getErrorName(err));
-    FreeAlignedBuffer(m_Page);
-    FreeAlignedBuffer(m_CompressBuffer);
-    m_Page = m_CompressBuffer = NULL;
+    FreeBuffers();
     return false;
   }
 
@@ -170,9 +358,7 @@ bool ZSTDCompressor::CompressZSTDFrame(ZSTD_inBuffer &in, ZSTD_outBuffer &out)
         RDCERR("Error compressing: %s", ZSTD_getErrorName(err));
       else
         RDCERR("Error compressing, no progress made");
-      FreeAlignedBuffer(m_Page);
-      FreeAlignedBuffer(m_CompressBuffer);
-      m_Page = m_CompressBuffer = NULL;
+      FreeBuffers();
       return false;
     }
   }
@@ -185,17 +371,18 @@ bool ZSTDCompressor::CompressZSTDFrame(ZSTD_inBuffer &in, ZSTD_outBuffer &out)
       RDCERR("Error compressing: %s", ZSTD_getErrorName(err));
     else
       RDCERR("Error compressing, couldn't end stream");
-    FreeAlignedBuffer(m_Page);
-    FreeAlignedBuffer(m_CompressBuffer);
-    m_Page = m_CompressBuffer = NULL;
+    FreeBuffers();
     return false;
   }
 
   return true;
 }
 
-ZSTDDecompressor::ZSTDDecompressor(StreamReader *read, Ownership own) : Decompressor(read, own)
+ZSTDDecompressor::ZSTDDecompressor(StreamReader *read, Ownership own, bool firstPageDictionary)
+    : Decompressor(read, own)
 {
+  m_UseDictionary = firstPageDictionary;
+
   m_Page = AllocAlignedBuffer(zstdBlockSize);
   m_CompressBuffer = AllocAlignedBuffer(compressBlockSize);
 
@@ -208,6 +395,7 @@ ZSTDDecompressor::ZSTDDecompressor(StreamReader *read, Ownership own) : Decompre
 ZSTDDecompressor::~ZSTDDecompressor()
 {
   ZSTD_freeDStream(m_Stream);
+  ZSTD_freeDDict(m_Dictionary);
   FreeAlignedBuffer(m_Page);
   FreeAlignedBuffer(m_CompressBuffer);
 }
@@ -286,13 +474,74 @@ bool ZSTDDecompressor::Read(void *data, uint64_t numBytes)
   return success;
 }
 
+bool ZSTDDecompressor::Seek(uint64_t uncompressedOffset)
+{
+  if(!m_CompressBuffer || m_SeekTable.blockSize != zstdBlockSize)
+    return false;
+
+  uint64_t block = uncompressedOffset / zstdBlockSize;
+
+  if(block >= m_SeekTable.blockOffsets.size())
+    return false;
+
+  // past this point the read position has moved, so a failure can't fall back to reading on from
+  // where we were. FillPage frees the buffers on error so that later reads fail, do the same here.
+
+  // later pages can't be decompressed without the first, so read it now if we haven't already
+  if(m_UseDictionary && m_Dictionary == NULL && block > 0)
+  {
+    m_Read->SetOffset(m_SeekTable.blockOffsets[0]);
+    m_NextPage = 0;
+
+    if(!m_Read->IsErrored() && !FillPage())
+      return false;
+  }
+
+  if(!m_Read->IsErrored())
+  {
+    m_Read->SetOffset(m_SeekTable.blockOffsets[block]);
+    m_NextPage = block;
+  }
+
+  if(!m_Read->IsErrored())
+  {
+    if(!FillPage())
+      return false;
+
+    m_PageOffset = uncompressedOffset - block * zstdBlockSize;
+
+    if(m_PageOffset <= m_PageLength)
+      return true;
+
+    RDCERR("Seek table is inconsistent with block %llu of length %llu", block, m_PageLength);
+  }
+
+  FreeAlignedBuffer(m_Page);
+  FreeAlignedBuffer(m_CompressBuffer);
+  m_Page = m_CompressBuffer = NULL;
+  return false;
+}
+
 bool ZSTDDecompressor::FillPage()
 {
+  RDCPROFILE_ZONE("ZSTDDecompressor::FillPage");
+
   uint32_t compSize = 0;
 
   bool success = true;
 
   success &= m_Read->Read(compSize);
+
+  // a corrupt size (e.g. from a bad seek table) must not be read into the fixed-size buffer
+  if(!success || compSize > compressBlockSize)
+  {
+    RDCERR("Error reading size: %u", compSize);
+    FreeAlignedBuffer(m_Page);
+    FreeAlignedBuffer(m_CompressBuffer);
+    m_Page = m_CompressBuffer = NULL;
+    return false;
+  }
+
   success &= m_Read->Read(m_CompressBuffer, compSize);
 
   if(!success)
@@ -303,7 +552,27 @@ bool ZSTDDecompressor::FillPage()
     return false;
   }
 
-  size_t err = ZSTD_initDStream(m_Stream);
+  const uint64_t page = m_NextPage++;
+
+  size_t err = 0;
+
+  if(m_UseDictionary && page > 0)
+  {
+    if(m_Dictionary == NULL)
+    {
+      RDCERR("Decompressing page %llu without the first page's dictionary", page);
+      FreeAlignedBuffer(m_Page);
+      FreeAlignedBuffer(m_CompressBuffer);
+      m_Page = m_CompressBuffer = NULL;
+      return false;
+    }
+
+    err = ZSTD_initDStream_usingDDict(m_Stream, m_Dictionary);
+  }
+  else
+  {
+    err = ZSTD_initDStream(m_Stream);
+  }
 
   if(ZSTD_isError(err))
   {
@@ -341,5 +610,20 @@ bool ZSTDDecompressor::FillPage()
   m_PageOffset = 0;
   m_PageLength = out.pos;
 
+  if(m_UseDictionary && page == 0 && m_Dictionary == NULL)
+  {
+    m_Dictionary = ZSTD_createDDict_advanced(m_Page, (size_t)m_PageLength, ZSTD_dlm_byCopy,
+                                             ZSTD_dct_rawContent, ZSTD_defaultCMem);
+
+    if(m_Dictionary == NULL)
+    {
+      RDCERR("Couldn't create decompression dictionary");
+      FreeAlignedBuffer(m_Page);
+      FreeAlignedBuffer(m_CompressBuffer);
+      m_Page = m_CompressBuffer = NULL;
+      return false;
+    }
+  }
+
   return success;
 }
@@ -30,7 +30,18 @@
 class ZSTDCompressor : public Compressor
 {
 public:
-  ZSTDCompressor(StreamWriter *write, Ownership own);
+  static const int DefaultLevel = 7;
+
+  // with numThreads > 1 pages are batched up and compressed across that many threads. Every page is
+  // already an independent zstd frame so the output is identical in format. The level only affects
+  // the compression ratio and speed, the decompressor doesn't need to know it.
+  //
+  // If firstPageDictionary is set then the first page is used as a dictionary for all later pages.
+  // Pages are small so on their own they compress repetitive data like chunk headers poorly. Each
+  // page can still be decompressed on its own once the first page has been, so seeking still works,
+  // but the decompressor must be told to expect it.
+  ZSTDCompressor(StreamWriter *write, Ownership own, uint32_t numThreads = 1,
+                 int level = DefaultLevel, bool firstPageDictionary = false);
   ~ZSTDCompressor();
 
   bool Write(const void *data, uint64_t numBytes);
@@ -38,6 +49,10 @@ public:
 
 private:
   bool FlushPage();
+  bool FlushBatch();
+  void GrowBatch();
+  void FreeBuffers();
+  void CreateDictionary(const byte *page, uint64_t length);
 
   bool CompressZSTDFrame(ZSTD_inBuffer &in, ZSTD_outBuffer &out);
 
@@ -46,16 +61,34 @@ private:
   uint64_t m_PageOffset;
 
   ZSTD_CStream *m_Stream;
+
+  int m_Level;
+
+  bool m_UseDictionary;
+  ZSTD_CDict *m_Dictionary = NULL;
+
+  // parallel batch state. m_Page points into m_BatchPages at the page currently being filled, and
+  // m_CompressBuffer holds one compressed frame per page. Both have room for m_BatchCapacity pages,
+  // which doubles up to m_BatchSize as needed. Each thread has its own context.
+  uint32_t m_NumThreads;
+  uint32_t m_BatchSize = 0;
+  uint32_t m_BatchCapacity = 0;
+  uint32_t m_BatchCount = 0;
+  byte *m_BatchPages = NULL;
+  rdcarray<uint32_t> m_BatchLengths;
+  rdcarray<size_t> m_BatchCompSizes;
+  rdcarray<ZSTD_CCtx *> m_ThreadContexts;
 };
 
 class ZSTDDecompressor : public Decompressor
 {
 public:
-  ZSTDDecompressor(StreamReader *read, Ownership own);
+  ZSTDDecompressor(StreamReader *read, Ownership own, bool firstPageDictionary = false);
   ~ZSTDDecompressor();
 
   bool Recompress(Compressor *comp);
   bool Read(void *data, uint64_t numBytes);
+  bool Seek(uint64_t uncompressedOffset);
 
 private:
   bool FillPage();
@@ -65,5 +98,11 @@ private:
   uint64_t m_PageOffset;
   uint64_t m_PageLength;
 
+  // index of the page that the next FillPage() will read
+  uint64_t m_NextPage = 0;
+
   ZSTD_DStream *m_Stream;
+
+  bool m_UseDictionary;
+  ZSTD_DDict *m_Dictionary = NULL;
 };
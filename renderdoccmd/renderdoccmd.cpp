@@ -26,7 +26,13 @@
 #include "renderdoccmd.h"
 #include <app/renderdoc_app.h>
 #include <replay/version.h>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <mutex>
+#include <set>
 #include <string>
+#include <thread>
 
 rdcstr conv(const std::string &s)
 {
@@ -70,8 +76,32 @@ rdcarray<rdcstr> convertArgs(const std::vector<std::string> &args)
   return ret;
 }
 
+// replays to an offscreen output, for when no window system is available or wanted
+static void HeadlessRendererPreview(IReplayController *renderer, TextureDisplay &displayCfg,
+                                    uint32_t width, uint32_t height, uint32_t numLoops)
+{
+  IReplayOutput *out = renderer->CreateOutput(CreateHeadlessWindowingData(width, height),
+                                              ReplayOutputType::Texture);
+
+  if(out == NULL)
+  {
+    std::cerr << "Couldn't create headless output." << std::endl;
+    return;
+  }
+
+  out->SetTextureDisplay(displayCfg);
+
+  for(uint32_t loopCount = 0; numLoops == 0 || loopCount < numLoops; loopCount++)
+  {
+    renderer->SetFrameEvent(10000000, true);
+    out->Display();
+  }
+
+  out->Shutdown();
+}
+
 void DisplayRendererPreview(IReplayController *renderer, uint32_t width, uint32_t height,
-                            uint32_t numLoops)
+                            uint32_t numLoops, bool headless)
 {
   if(renderer == NULL)
     return;
@@ -121,7 +151,10 @@ void DisplayRendererPreview(IReplayController *renderer, uint32_t width, uint32_
       d.resourceId = id;
   }
 
-  DisplayRendererPreview(renderer, d, width, height, numLoops);
+  if(headless)
+    HeadlessRendererPreview(renderer, d, width, height, numLoops);
+  else
+    DisplayRendererPreview(renderer, d, width, height, numLoops);
 }
 
 static std::vector<std::string> version_lines;
@@ -457,6 +490,8 @@ struct RemoteServerCommand : public Command
 {
 private:
   std::string host;
+  uint32_t port = 0;
+  uint32_t workers = 1;
   bool daemon = false;
   bool preview = false;
 
@@ -467,7 +502,16 @@ public:
     parser.add("daemon", 'd', "Go into the background.");
     parser.add<std::string>(
         "host", 'h', "The interface to listen on. By default listens on all interfaces", false, "");
+    parser.add<uint32_t>("port", 'p',
+                         "The port to listen on, to run several servers on one machine. By "
+                         "default the standard remote server port is used.",
+                         false, 0);
     parser.add("preview", 'v', "Display a preview window when a replay is active.");
+    parser.add<uint32_t>("workers", 'w',
+                         "Run this many server processes, on consecutive ports starting at --port. "
+                         "Workers that exit are restarted. Replays can be spread across them, e.g. "
+                         "with the farm command.",
+                         false, 1);
   }
   virtual const char *Description()
   {
@@ -479,12 +523,41 @@ public:
   {
     env.enumerateGPUs = true;
     host = parser.get<std::string>("host");
+    port = parser.get<uint32_t>("port");
     daemon = parser.exist("daemon");
     preview = parser.exist("preview");
+    workers = std::max(1U, parser.get<uint32_t>("workers"));
+
+    if(workers > 1 && port == 0)
+    {
+      std::cerr << "Error: --workers requires --port to choose the ports the workers listen on."
+                << std::endl
+                << std::endl
+                << parser.usage();
+      return false;
+    }
+
     return true;
   }
   virtual int Execute(const CaptureOptions &)
   {
+    // each worker is a separate server process with its own replay device, so replays on different
+    // workers run in parallel and a crash in one replay doesn't take down the others.
+    std::vector<std::vector<std::string>> workerArgs;
+    for(uint32_t w = 1; w < workers; w++)
+    {
+      std::vector<std::string> args = {"remoteserver", "--port", std::to_string(port + w)};
+      if(!host.empty())
+      {
+        args.push_back("--host");
+        args.push_back(host);
+      }
+      workerArgs.push_back(args);
+    }
+
+    if(port != 0)
+      host = (host.empty() ? "0.0.0.0" : host) + ":" + std::to_string(port);
+
     std::cerr << "Spawning a replay host listening on " << (host.empty() ? "*" : host) << "..."
               << std::endl;
 
@@ -507,9 +580,45 @@ public:
     if(DisplayRemoteServerPreview(false, {}).system != WindowingSystem::Unknown)
       previewWindow = &DisplayRemoteServerPreview;
 
+    std::atomic<bool> stopWorkers(false);
+    std::vector<uint64_t> workerProcs(workerArgs.size(), 0);
+    std::vector<bool> launchFailed(workerArgs.size(), false);
+
+    // this process serves the first port, the rest are watched from here and restarted if they exit
+    std::thread supervisor([&]() {
+      while(!stopWorkers && !killSignal)
+      {
+        for(size_t w = 0; w < workerProcs.size(); w++)
+        {
+          if(launchFailed[w] || (workerProcs[w] != 0 && IsWorkerProcessRunning(workerProcs[w])))
+            continue;
+
+          std::cerr << (workerProcs[w] ? "Restarting" : "Starting") << " worker on port "
+                    << workerArgs[w][2] << std::endl;
+
+          workerProcs[w] = LaunchWorkerProcess(workerArgs[w]);
+
+          if(workerProcs[w] == 0)
+          {
+            std::cerr << "Couldn't launch worker on port " << workerArgs[w][2] << std::endl;
+            launchFailed[w] = true;
+          }
+        }
+
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+      }
+    });
+
     RENDERDOC_BecomeRemoteServer(host.empty() ? NULL : host.c_str(), []() { return killSignal; },
                                  previewWindow);
 
+    stopWorkers = true;
+    supervisor.join();
+
+    for(uint64_t proc : workerProcs)
+      if(proc != 0)
+        StopWorkerProcess(proc);
+
     std::cerr << std::endl << "Cleaning up from replay hosting." << std::endl;
 
     return 0;
@@ -524,6 +633,8 @@ private:
   uint32_t width = 0;
   uint32_t height = 0;
   uint32_t loops = 0;
+  bool headless = false;
+  ReplayOptions opts;
 
 public:
   ReplayCommand() : Command() {}
@@ -537,6 +648,19 @@ public:
     parser.add<std::string>("remote-host", 0,
                             "Instead of replaying locally, replay on this host over the network.",
                             false);
+    parser.add("concurrent-queues", 0,
+               "Replay work on different queues concurrently, as it was captured, instead of "
+               "serialising it.");
+    parser.add<uint32_t>("checkpoint-interval", 0,
+                         "Snapshot resources at least this many events apart while replaying, so "
+                         "later replays can skip ahead. 0 disables checkpoints.",
+                         false, 0);
+    parser.add<uint32_t>("checkpoint-budget", 0,
+                         "The most GPU memory in MB that replay checkpoints can use.", false, 1024);
+    parser.add<uint32_t>("rerecord-cache", 0,
+                         "Cache re-recorded command buffers between replays, up to this many MB. "
+                         "0 disables the cache.",
+                         false, 0);
   }
   virtual const char *Description()
   {
@@ -544,8 +668,10 @@ public:
   }
   virtual bool IsInternalOnly() { return false; }
   virtual bool IsCaptureCommand() { return false; }
-  virtual bool Parse(cmdline::parser &parser, GlobalEnvironment &)
+  virtual bool Parse(cmdline::parser &parser, GlobalEnvironment &env)
   {
+    headless = env.headless;
+
     std::vector<std::string> rest = parser.rest();
     if(rest.empty())
     {
@@ -555,271 +681,1522 @@ public:
       return false;
     }
 
-    filename = rest[0];
+    filename = rest[0];
+
+    rest.erase(rest.begin());
+
+    parser.set_rest(rest);
+
+    if(parser.exist("remote-host"))
+      remote_host = parser.get<std::string>("remote-host");
+
+    width = parser.get<uint32_t>("width");
+    height = parser.get<uint32_t>("height");
+    loops = parser.get<uint32_t>("loops");
+
+    opts.concurrentQueues = parser.exist("concurrent-queues");
+    opts.replayCheckpointInterval = parser.get<uint32_t>("checkpoint-interval");
+    opts.replayCheckpointBudgetMB = parser.get<uint32_t>("checkpoint-budget");
+    opts.rerecordCacheMB = parser.get<uint32_t>("rerecord-cache");
+
+    return true;
+  }
+  virtual int Execute(const CaptureOptions &)
+  {
+    if(!remote_host.empty())
+    {
+      std::cout << "Replaying '" << filename << "' on " << remote_host << "." << std::endl;
+
+      IRemoteServer *remote = NULL;
+      ReplayStatus status = RENDERDOC_CreateRemoteServerConnection(remote_host.c_str(), &remote);
+
+      if(remote == NULL || status != ReplayStatus::Succeeded)
+      {
+        std::cerr << "Error: " << ToStr(status) << " - Couldn't connect to " << remote_host << "."
+                  << std::endl;
+        std::cerr << "       Have you run renderdoccmd remoteserver on '" << remote_host << "'?"
+                  << std::endl;
+        return 1;
+      }
+
+      std::cerr << "Copying capture file to remote server" << std::endl;
+
+      rdcstr remotePath = remote->CopyCaptureToRemote(filename.c_str(), NULL);
+
+      IReplayController *renderer = NULL;
+      rdctie(status, renderer) = remote->OpenCapture(~0U, remotePath.c_str(), opts, NULL);
+
+      if(status == ReplayStatus::Succeeded)
+      {
+        DisplayRendererPreview(renderer, width, height, loops, headless);
+
+        remote->CloseCapture(renderer);
+      }
+      else
+      {
+        std::cerr << "Couldn't load and replay '" << filename << "': " << ToStr(status) << std::endl;
+      }
+
+      remote->ShutdownConnection();
+    }
+    else
+    {
+      std::cout << "Replaying '" << filename << "' locally.." << std::endl;
+
+      ICaptureFile *file = RENDERDOC_OpenCaptureFile();
+
+      if(file->OpenFile(filename.c_str(), "rdc", NULL) != ReplayStatus::Succeeded)
+      {
+        std::cerr << "Couldn't load '" << filename << "'." << std::endl;
+        return 1;
+      }
+
+      IReplayController *renderer = NULL;
+      ReplayStatus status = ReplayStatus::InternalError;
+      rdctie(status, renderer) = file->OpenCapture(opts, NULL);
+
+      file->Shutdown();
+
+      if(status == ReplayStatus::Succeeded)
+      {
+        DisplayRendererPreview(renderer, width, height, loops, headless);
+
+        renderer->Shutdown();
+      }
+      else
+      {
+        std::cerr << "Couldn't load and replay '" << filename << "': " << ToStr(status) << std::endl;
+        return 1;
+      }
+    }
+    return 0;
+  }
+};
+
+static std::string json_escape(const std::string &str)
+{
+  std::string ret;
+  for(char c : str)
+  {
+    if(c == '"' || c == '\\')
+      ret.push_back('\\');
+    ret.push_back(c);
+  }
+  return ret;
+}
+
+struct formats_reader
+{
+  formats_reader(bool input)
+  {
+    ICaptureFile *tmp = RENDERDOC_OpenCaptureFile();
+
+    for(const CaptureFileFormat &f : tmp->GetCaptureFileFormats())
+    {
+      if(!f.openSupported && input)
+        continue;
+
+      exts.push_back(conv(f.extension));
+      names.push_back(conv(f.name));
+    }
+
+    tmp->Shutdown();
+  }
+  std::string operator()(const std::string &s)
+  {
+    if(std::find(exts.begin(), exts.end(), s) == exts.end())
+      throw cmdline::cmdline_error("'" + s + "' is not one of the accepted values");
+    return s;
+  }
+  std::string description() const
+  {
+    std::string ret = "Options are:";
+    for(size_t i = 0; i < exts.size(); i++)
+      ret += "\n  * " + exts[i] + " - " + names[i];
+    return ret;
+  }
+
+private:
+  std::vector<std::string> exts;
+  std::vector<std::string> names;
+};
+
+struct ConvertCommand : public Command
+{
+private:
+  rdcarray<CaptureFileFormat> m_Formats;
+  bool list_formats = false;
+  std::string infile;
+  std::string outfile;
+  std::string infmt;
+  std::string outfmt;
+
+public:
+  ConvertCommand() : Command() {}
+  virtual void AddOptions(cmdline::parser &parser)
+  {
+    parser.add<std::string>("filename", 'f', "The file to convert from.", false);
+    parser.add<std::string>("output", 'o', "The file to convert to.", false);
+    parser.add<std::string>("input-format", 'i', "The format of the input file.", false, "",
+                            formats_reader(true));
+    parser.add<std::string>("convert-format", 'c', "The format of the output file.", false, "",
+                            formats_reader(false));
+    parser.add("list-formats", '\0', "Print a list of target formats.");
+    parser.stop_at_rest(true);
+  }
+  virtual const char *Description() { return "Convert between capture formats."; }
+  virtual bool IsInternalOnly() { return false; }
+  virtual bool IsCaptureCommand() { return false; }
+  virtual bool Parse(cmdline::parser &parser, GlobalEnvironment &)
+  {
+    list_formats = parser.exist("list-formats");
+
+    if(list_formats)
+      return true;
+
+    infile = parser.get<std::string>("filename");
+    outfile = parser.get<std::string>("output");
+
+    if(infile.empty())
+    {
+      std::cerr << "Need an input filename (-f)." << std::endl << std::endl;
+      std::cerr << parser.usage() << std::endl;
+      return false;
+    }
+
+    if(outfile.empty())
+    {
+      std::cerr << "Need an output filename (-o)." << std::endl << std::endl;
+      std::cerr << parser.usage() << std::endl;
+      return false;
+    }
+
+    infmt = parser.get<std::string>("input-format");
+    outfmt = parser.get<std::string>("convert-format");
+
+    return true;
+  }
+
+  virtual int Execute(const CaptureOptions &)
+  {
+    ICaptureFile *tmp = RENDERDOC_OpenCaptureFile();
+
+    m_Formats = tmp->GetCaptureFileFormats();
+
+    tmp->Shutdown();
+
+    if(list_formats)
+    {
+      std::cout << "Available formats:" << std::endl;
+      for(CaptureFileFormat f : m_Formats)
+        std::cout << "'" << f.extension << "': " << f.name << std::endl
+                  << " * " << f.description << std::endl
+                  << std::endl;
+      return 0;
+    }
+
+    // sort the formats by the length of the extension, so we check the longest ones first. This
+    // means that .zip.xml will get chosen before just .xml
+    std::sort(m_Formats.begin(), m_Formats.end(),
+              [](const CaptureFileFormat &a, const CaptureFileFormat &b) {
+                return a.extension.size() > b.extension.size();
+              });
+
+    if(infmt.empty())
+    {
+      // try to guess the format by looking for the extension in the filename
+      for(CaptureFileFormat f : m_Formats)
+      {
+        if(infile.find(conv("." + f.extension)) != std::string::npos)
+        {
+          infmt = conv(f.extension);
+          break;
+        }
+      }
+    }
+
+    if(infmt.empty())
+    {
+      std::cerr << "Couldn't guess input format from filename '" << infile << "'." << std::endl
+                << std::endl;
+      return 1;
+    }
+
+    if(outfmt.empty())
+    {
+      // try to guess the format by looking for the extension in the filename
+      for(CaptureFileFormat f : m_Formats)
+      {
+        if(outfile.find(conv("." + f.extension)) != std::string::npos)
+        {
+          outfmt = conv(f.extension);
+          break;
+        }
+      }
+    }
+
+    if(outfmt.empty())
+    {
+      std::cerr << "Couldn't guess output format from filename '" << outfile << "'." << std::endl
+                << std::endl;
+      return 1;
+    }
+
+    ICaptureFile *file = RENDERDOC_OpenCaptureFile();
+
+    ReplayStatus st = file->OpenFile(infile.c_str(), infmt.c_str(), NULL);
+
+    if(st != ReplayStatus::Succeeded)
+    {
+      std::cerr << "Couldn't load '" << infile << "' as '" << infmt << "': " << ToStr(st)
+                << std::endl;
+      return 1;
+    }
+
+    st = file->Convert(outfile.c_str(), outfmt.c_str(), NULL, NULL);
+
+    if(st != ReplayStatus::Succeeded)
+    {
+      std::cerr << "Couldn't convert '" << infile << "' to '" << outfile << "' as '" << outfmt
+                << "': " << ToStr(st) << std::endl;
+      return 1;
+    }
+
+    std::cout << "Converted '" << infile << "' to '" << outfile << "'" << std::endl;
+
+    return 0;
+  }
+};
+
+struct TrimCommand : public Command
+{
+private:
+  std::string infile;
+  std::string outfile;
+
+public:
+  TrimCommand() : Command() {}
+  virtual void AddOptions(cmdline::parser &parser)
+  {
+    parser.add<std::string>("filename", 'f', "The capture to trim.", false);
+    parser.add<std::string>("output", 'o', "The file to write the trimmed capture to.", false);
+  }
+  virtual const char *Description()
+  {
+    return "Rewrite a capture without the initial contents of textures and buffers that the frame "
+           "never uses.";
+  }
+  virtual bool IsInternalOnly() { return false; }
+  virtual bool IsCaptureCommand() { return false; }
+  virtual bool Parse(cmdline::parser &parser, GlobalEnvironment &)
+  {
+    infile = parser.get<std::string>("filename");
+    outfile = parser.get<std::string>("output");
+
+    if(infile.empty())
+    {
+      std::cerr << "Need an input filename (-f)." << std::endl << std::endl;
+      std::cerr << parser.usage() << std::endl;
+      return false;
+    }
+
+    if(outfile.empty())
+    {
+      std::cerr << "Need an output filename (-o)." << std::endl << std::endl;
+      std::cerr << parser.usage() << std::endl;
+      return false;
+    }
+
+    if(outfile == infile)
+    {
+      std::cerr << "The output filename must be different to the input." << std::endl;
+      return false;
+    }
+
+    return true;
+  }
+
+  virtual int Execute(const CaptureOptions &)
+  {
+    ICaptureFile *file = RENDERDOC_OpenCaptureFile();
+
+    ReplayStatus st = file->OpenFile(infile.c_str(), "rdc", NULL);
+
+    if(st != ReplayStatus::Succeeded)
+    {
+      std::cerr << "Couldn't load '" << infile << "': " << ToStr(st) << std::endl;
+      file->Shutdown();
+      return 1;
+    }
+
+    IReplayController *renderer = NULL;
+    rdctie(st, renderer) = file->OpenCapture(ReplayOptions(), NULL);
+
+    if(st != ReplayStatus::Succeeded)
+    {
+      std::cerr << "Couldn't replay '" << infile << "': " << ToStr(st) << std::endl;
+      file->Shutdown();
+      return 1;
+    }
+
+    // only textures and buffers are considered. Other objects with initial contents such as
+    // descriptors, or memory that buffers are bound to, don't have their use tracked directly.
+    std::set<ResourceId> unused;
+    for(const ResourceDescription &res : renderer->GetResources())
+    {
+      if(res.type != ResourceType::Texture && res.type != ResourceType::Buffer)
+        continue;
+
+      if(renderer->GetUsage(res.resourceId).empty())
+        unused.insert(res.resourceId);
+    }
+
+    renderer->Shutdown();
+
+    const SDFile &structured = file->GetStructuredData();
+
+    // build the trimmed file out of the existing chunks and buffers without copying them.
+    // Buffers are only written as they're referenced, so those that belonged to dropped chunks
+    // don't need to be removed.
+    SDFile trimmed;
+    trimmed.version = structured.version;
+
+    for(bytebuf *buf : structured.buffers)
+      trimmed.buffers.push_back(buf);
+
+    size_t dropped = 0;
+    uint64_t droppedBytes = 0;
+
+    for(SDChunk *chunk : structured.chunks)
+    {
+      if(chunk->name == "Internal: Initial Contents")
+      {
+        SDObject *id = chunk->FindChild("id");
+
+        if(id && id->type.basetype == SDBasic::Resource &&
+           unused.find(id->AsResourceId()) != unused.end())
+        {
+          dropped++;
+          droppedBytes += chunk->metadata.length;
+          continue;
+        }
+      }
+
+      trimmed.chunks.push_back(chunk);
+    }
+
+    st = file->Convert(outfile.c_str(), "rdc", &trimmed, NULL);
+
+    // the chunks and buffers are still owned by the capture file
+    trimmed.chunks.clear();
+    trimmed.buffers.clear();
+
+    file->Shutdown();
+
+    if(st != ReplayStatus::Succeeded)
+    {
+      std::cerr << "Couldn't write '" << outfile << "': " << ToStr(st) << std::endl;
+      return 1;
+    }
+
+    std::cout << "Wrote '" << outfile << "', dropping initial contents for " << dropped << " of "
+              << unused.size() << " unused resources (" << droppedBytes / 1024 << " KB)"
+              << std::endl;
+
+    return 0;
+  }
+};
+
+struct DiffCommand : public Command
+{
+private:
+  std::string fileA;
+  std::string fileB;
+  uint32_t maxDiffs = 0;
+
+public:
+  DiffCommand() : Command() {}
+  virtual void AddOptions(cmdline::parser &parser)
+  {
+    parser.add<std::string>("first", 'a', "The first capture to compare.", false);
+    parser.add<std::string>("second", 'b', "The second capture to compare.", false);
+    parser.add<uint32_t>("max", 'n', "Stop after this many differences. 0 means no limit.", false,
+                         0);
+  }
+  virtual const char *Description()
+  {
+    return "Compare the structured data of two captures and print each difference as it's found.";
+  }
+  virtual bool IsInternalOnly() { return false; }
+  virtual bool IsCaptureCommand() { return false; }
+  virtual bool Parse(cmdline::parser &parser, GlobalEnvironment &)
+  {
+    fileA = parser.get<std::string>("first");
+    fileB = parser.get<std::string>("second");
+    maxDiffs = parser.get<uint32_t>("max");
+
+    if(fileA.empty() || fileB.empty())
+    {
+      std::cerr << "Need two captures to compare (-a and -b)." << std::endl << std::endl;
+      std::cerr << parser.usage() << std::endl;
+      return false;
+    }
+
+    return true;
+  }
+
+  virtual int Execute(const CaptureOptions &)
+  {
+    ICaptureFile *a = RENDERDOC_OpenCaptureFile();
+    ICaptureFile *b = RENDERDOC_OpenCaptureFile();
+
+    ReplayStatus st = a->OpenFile(fileA.c_str(), "rdc", NULL);
+
+    if(st != ReplayStatus::Succeeded)
+    {
+      std::cerr << "Couldn't load '" << fileA << "': " << ToStr(st) << std::endl;
+      a->Shutdown();
+      b->Shutdown();
+      return 1;
+    }
+
+    st = b->OpenFile(fileB.c_str(), "rdc", NULL);
+
+    if(st != ReplayStatus::Succeeded)
+    {
+      std::cerr << "Couldn't load '" << fileB << "': " << ToStr(st) << std::endl;
+      a->Shutdown();
+      b->Shutdown();
+      return 1;
+    }
+
+    if(a->DriverName() != b->DriverName())
+      std::cerr << "Warning: comparing a " << a->DriverName().c_str() << " capture against a "
+                << b->DriverName().c_str() << " capture." << std::endl;
+
+    uint32_t limit = maxDiffs;
+    uint32_t printed = 0;
+
+    uint32_t count = a->DiffStructuredData(b, [limit, &printed](const CaptureDifference &diff) {
+      if(diff.chunkB < 0)
+      {
+        std::cout << "- [" << diff.chunkA << "] " << diff.name.c_str() << std::endl;
+      }
+      else if(diff.chunkA < 0)
+      {
+        std::cout << "+ [" << diff.chunkB << "] " << diff.name.c_str() << std::endl;
+      }
+      else
+      {
+        std::cout << "~ [" << diff.chunkA << "/" << diff.chunkB << "] " << diff.name.c_str();
+        if(!diff.path.empty())
+          std::cout << " " << diff.path.c_str();
+        std::cout << ": " << diff.valueA.c_str() << " -> " << diff.valueB.c_str() << std::endl;
+      }
+
+      printed++;
+      return limit == 0 || printed < limit;
+    });
+
+    a->Shutdown();
+    b->Shutdown();
+
+    std::cout << count << " difference(s)";
+    if(limit > 0 && count >= limit)
+      std::cout << " (stopped early)";
+    std::cout << std::endl;
+
+    return count == 0 ? 0 : 2;
+  }
+};
+
+struct BenchmarkCommand : public Command
+{
+private:
+  std::string filename;
+  std::string outfile;
+  std::string tracefile;
+  uint32_t iterations = 5;
+  uint32_t seeks = 100;
+  uint32_t draws = 20;
+  uint32_t textures = 10;
+  uint32_t loop = 0;
+  uint32_t seed = 0;
+
+  typedef std::chrono::high_resolution_clock clock;
+
+  static double msSince(clock::time_point start)
+  {
+    return std::chrono::duration<double, std::milli>(clock::now() - start).count();
+  }
+
+  struct Timings
+  {
+    std::vector<double> samples;
+
+    void add(double ms) { samples.push_back(ms); }
+    std::string json()
+    {
+      if(samples.empty())
+        return "null";
+
+      std::sort(samples.begin(), samples.end());
+
+      double total = 0.0;
+      for(double s : samples)
+        total += s;
+
+      std::ostringstream oss;
+      oss << "{\"count\": " << samples.size() << ", \"avg_ms\": " << total / samples.size()
+          << ", \"min_ms\": " << samples.front() << ", \"max_ms\": " << samples.back()
+          << ", \"p95_ms\": " << samples[std::min(samples.size() - 1, samples.size() * 95 / 100)]
+          << "}";
+      return oss.str();
+    }
+  };
+
+  static void flatten(const rdcarray<DrawcallDescription> &list, std::vector<uint32_t> &events,
+                      std::vector<uint32_t> &drawEvents)
+  {
+    for(const DrawcallDescription &d : list)
+    {
+      events.push_back(d.eventId);
+      if(d.flags & DrawFlags::Drawcall)
+        drawEvents.push_back(d.eventId);
+      flatten(d.children, events, drawEvents);
+    }
+  }
+
+  // pick count random elements (with replacement) from the list
+  std::vector<uint32_t> pick(const std::vector<uint32_t> &list, uint32_t count)
+  {
+    std::vector<uint32_t> ret;
+    for(uint32_t i = 0; i < count && !list.empty(); i++)
+      ret.push_back(list[rand() % list.size()]);
+    return ret;
+  }
+
+public:
+  BenchmarkCommand() : Command() {}
+  virtual void AddOptions(cmdline::parser &parser)
+  {
+    parser.set_footer("<capture.rdc>");
+    parser.add<std::string>("output", 'o', "Write the JSON results to this file instead of stdout.",
+                            false);
+    parser.add<std::string>(
+        "trace", 0,
+        "Write a self-profile trace to this file, giving a breakdown of the capture load phases.",
+        false);
+    parser.add<uint32_t>("iterations", 'i', "How many full replays of the frame to time.", false,
+                         5);
+    parser.add<uint32_t>("seeks", 0, "How many seeks to random events to time.", false, 100);
+    parser.add<uint32_t>("draws", 0, "How many random draws to fetch post-VS data for.", false, 20);
+    parser.add<uint32_t>("textures", 0, "How many of the largest textures to read back.", false,
+                         10);
+    parser.add<uint32_t>("loop", 0,
+                         "How many measured replay loop iterations to run, with GPU timings "
+                         "for every marker region.",
+                         false, 0);
+    parser.add<uint32_t>("seed", 0, "The random seed used to pick events.", false, 0);
+  }
+  virtual const char *Description()
+  {
+    return "Benchmark loading and replaying a capture, and print the timings as JSON.";
+  }
+  virtual bool IsInternalOnly() { return false; }
+  virtual bool IsCaptureCommand() { return false; }
+  virtual bool Parse(cmdline::parser &parser, GlobalEnvironment &)
+  {
+    std::vector<std::string> rest = parser.rest();
+    if(rest.empty())
+    {
+      std::cerr << "Error: benchmark command requires a filename to load." << std::endl
+                << std::endl
+                << parser.usage();
+      return false;
+    }
+
+    filename = rest[0];
+
+    rest.erase(rest.begin());
+
+    parser.set_rest(rest);
+
+    if(parser.exist("output"))
+      outfile = parser.get<std::string>("output");
+    if(parser.exist("trace"))
+      tracefile = parser.get<std::string>("trace");
+
+    iterations = parser.get<uint32_t>("iterations");
+    seeks = parser.get<uint32_t>("seeks");
+    draws = parser.get<uint32_t>("draws");
+    textures = parser.get<uint32_t>("textures");
+    loop = parser.get<uint32_t>("loop");
+    seed = parser.get<uint32_t>("seed");
+
+    return true;
+  }
+  virtual int Execute(const CaptureOptions &)
+  {
+    srand(seed);
+
+    if(!tracefile.empty())
+      RENDERDOC_SetSelfProfiling(true);
+
+    clock::time_point start = clock::now();
+
+    ICaptureFile *file = RENDERDOC_OpenCaptureFile();
+
+    if(file->OpenFile(filename.c_str(), "rdc", NULL) != ReplayStatus::Succeeded)
+    {
+      std::cerr << "Couldn't load '" << filename << "'." << std::endl;
+      file->Shutdown();
+      return 1;
+    }
+
+    double openFileMS = msSince(start);
+
+    IReplayController *renderer = NULL;
+    ReplayStatus status = ReplayStatus::InternalError;
+
+    // this covers reading the chunks, creating resources and preparing initial contents. The
+    // trace gives the breakdown between those phases
+    start = clock::now();
+    rdctie(status, renderer) = file->OpenCapture(ReplayOptions(), NULL);
+    double openCaptureMS = msSince(start);
+
+    file->Shutdown();
+
+    if(status != ReplayStatus::Succeeded)
+    {
+      std::cerr << "Couldn't load and replay '" << filename << "': " << ToStr(status) << std::endl;
+      return 1;
+    }
+
+    std::vector<uint32_t> events, drawEvents;
+    flatten(renderer->GetDrawcalls(), events, drawEvents);
+
+    // the driver's per-chunk-type costs from loading, most expensive first
+    std::ostringstream loadJson;
+    {
+      rdcarray<ChunkLoadStatistics> stats = renderer->GetFrameInfo().loadStatistics;
+
+      loadJson << "[";
+      for(size_t i = 0; i < stats.size(); i++)
+      {
+        loadJson << (i > 0 ? ", " : "") << "{\"chunk\": \"" << json_escape(stats[i].name.c_str())
+                 << "\", \"count\": " << stats[i].count << ", \"bytes\": " << stats[i].byteSize
+                 << ", \"cpu_ms\": " << stats[i].cpuTime * 1000.0
+                 << ", \"gpu_wait_ms\": " << stats[i].gpuWaitTime * 1000.0 << "}";
+      }
+      loadJson << "]";
+    }
+
+    uint32_t lastEvent = events.empty() ? 0 : events.back();
+
+    Timings fullReplay;
+    for(uint32_t i = 0; i < iterations; i++)
+    {
+      start = clock::now();
+      renderer->SetFrameEvent(lastEvent, true);
+      fullReplay.add(msSince(start));
+    }
+
+    Timings seek;
+    for(uint32_t eid : pick(events, seeks))
+    {
+      start = clock::now();
+      renderer->SetFrameEvent(eid, false);
+      seek.add(msSince(start));
+    }
+
+    Timings postvs;
+    for(uint32_t eid : pick(drawEvents, draws))
+    {
+      renderer->SetFrameEvent(eid, false);
+
+      start = clock::now();
+      renderer->GetPostVSData(0, 0, MeshDataStage::VSOut);
+      postvs.add(msSince(start));
+    }
+
+    renderer->SetFrameEvent(lastEvent, false);
+
+    Timings counters;
+    {
+      start = clock::now();
+      renderer->FetchCounters({GPUCounter::EventGPUDuration});
+      counters.add(msSince(start));
+    }
+
+    rdcarray<TextureDescription> texs = renderer->GetTextures();
+    std::sort(texs.begin(), texs.end(),
+              [](const TextureDescription &a, const TextureDescription &b) {
+                return a.byteSize > b.byteSize;
+              });
+    texs.resize(std::min(texs.size(), (size_t)textures));
+
+    Timings readback;
+    uint64_t readbackBytes = 0;
+    for(const TextureDescription &tex : texs)
+    {
+      start = clock::now();
+      bytebuf data = renderer->GetTextureData(tex.resourceId, Subresource());
+      readback.add(msSince(start));
+      readbackBytes += data.size();
+    }
+
+    double readbackMS = 0.0;
+    for(double s : readback.samples)
+      readbackMS += s;
+
+    std::string loopJson = "null";
+    if(loop > 0)
+    {
+      ReplayLoopMeasurement measured = renderer->MeasureReplayLoop(loop);
+
+      Timings cpu, gpu;
+      for(double t : measured.cpuTimes)
+        cpu.add(t * 1000.0);
+      for(double t : measured.gpuTimes)
+        gpu.add(t * 1000.0);
+
+      std::ostringstream oss;
+      oss << "{\"cpu\": " << cpu.json() << ", \"gpu\": " << gpu.json() << ", \"regions\": [";
+      for(size_t i = 0; i < measured.regions.size(); i++)
+      {
+        const MarkerRegionTiming &region = measured.regions[i];
+
+        Timings regionGPU;
+        for(double t : region.gpuDurations)
+          regionGPU.add(t * 1000.0);
+
+        oss << (i > 0 ? ", " : "") << "{\"event\": " << region.eventId << ", \"name\": \""
+            << json_escape(region.name.c_str()) << "\", \"depth\": " << region.depth
+            << ", \"gpu\": " << regionGPU.json() << "}";
+      }
+      oss << "]}";
+      loopJson = oss.str();
+    }
+
+    renderer->Shutdown();
+
+    std::ostringstream json;
+    json << "{\"capture\": \"" << json_escape(filename) << "\", \"version\": \""
+         << RENDERDOC_GetVersionString() << "\", \"events\": " << events.size()
+         << ", \"draws\": " << drawEvents.size() << ", \"open_file_ms\": " << openFileMS
+         << ", \"open_capture_ms\": " << openCaptureMS << ", \"load_chunks\": " << loadJson.str()
+         << ", \"full_replay\": " << fullReplay.json()
+         << ", \"seek\": " << seek.json() << ", \"postvs\": " << postvs.json()
+         << ", \"counters\": " << counters.json() << ", \"readback\": " << readback.json()
+         << ", \"readback_bytes\": " << readbackBytes << ", \"readback_mb_per_sec\": "
+         << (readbackMS > 0.0 ? double(readbackBytes) / (readbackMS * 1000.0) : 0.0)
+         << ", \"loop\": " << loopJson << "}";
+
+    if(!tracefile.empty())
+    {
+      RENDERDOC_SetSelfProfiling(false);
+      if(!RENDERDOC_WriteSelfProfileTrace(tracefile.c_str()))
+        std::cerr << "Couldn't write profile trace to '" << tracefile << "'." << std::endl;
+    }
+
+    if(outfile.empty())
+    {
+      std::cout << json.str() << std::endl;
+    }
+    else
+    {
+      FILE *f = fopen(outfile.c_str(), "w");
+      if(!f)
+      {
+        std::cerr << "Couldn't open '" << outfile << "' for writing." << std::endl;
+        return 1;
+      }
+      fputs(json.str().c_str(), f);
+      fputs("\n", f);
+      fclose(f);
+    }
+
+    return 0;
+  }
+};
+
+struct ScanCommand : public Command
+{
+private:
+  std::vector<std::string> filenames;
+  uint32_t threads = 1;
+
+  static std::string scan(const std::string &filename)
+  {
+    std::ostringstream json;
+    json << "{\"capture\": \"" << json_escape(filename) << "\"";
+
+    ICaptureFile *file = RENDERDOC_OpenCaptureFile();
+
+    ReplayStatus status = file->OpenFileHeader(filename.c_str());
+
+    if(status == ReplayStatus::Succeeded)
+    {
+      Thumbnail thumb = file->GetThumbnail(FileType::JPG, 0);
+
+      json << ", \"driver\": \"" << json_escape(conv(file->DriverName())) << "\""
+           << ", \"machine_ident\": \"" << json_escape(file->RecordedMachineIdent()) << "\""
+           << ", \"thumbnail\": {\"width\": " << thumb.width << ", \"height\": " << thumb.height
+           << ", \"bytes\": " << thumb.data.size() << "}, \"sections\": [";
+
+      for(int i = 0; i < file->GetSectionCount(); i++)
+      {
+        SectionProperties props = file->GetSectionProperties(i);
+
+        json << (i > 0 ? ", " : "") << "{\"name\": \"" << json_escape(conv(props.name))
+             << "\", \"type\": \"" << ToStr(props.type) << "\", \"flags\": \""
+             << ToStr(props.flags) << "\", \"version\": " << props.version
+             << ", \"compressed_size\": " << props.compressedSize
+             << ", \"uncompressed_size\": " << props.uncompressedSize << "}";
+      }
+
+      json << "]";
+    }
+    else
+    {
+      json << ", \"error\": \"" << ToStr(status) << "\"";
+    }
+
+    json << "}";
+
+    file->Shutdown();
+
+    return json.str();
+  }
+
+public:
+  ScanCommand() : Command() {}
+  virtual void AddOptions(cmdline::parser &parser)
+  {
+    parser.set_footer("<capture.rdc> [<capture.rdc> ...]");
+    parser.add<uint32_t>("threads", 'j', "How many files to scan in parallel.", false, 1);
+  }
+  virtual const char *Description()
+  {
+    return "Read just the header and sections of captures, and print them as JSON.";
+  }
+  virtual bool IsInternalOnly() { return false; }
+  virtual bool IsCaptureCommand() { return false; }
+  virtual bool Parse(cmdline::parser &parser, GlobalEnvironment &)
+  {
+    filenames = parser.rest();
+    if(filenames.empty())
+    {
+      std::cerr << "Error: scan command requires at least one filename to scan." << std::endl
+                << std::endl
+                << parser.usage();
+      return false;
+    }
+
+    parser.set_rest({});
+
+    threads = std::max(1U, parser.get<uint32_t>("threads"));
+
+    return true;
+  }
+  virtual int Execute(const CaptureOptions &)
+  {
+    std::vector<std::string> results(filenames.size());
+
+    // files are handed out to workers one at a time, results are printed in the original order
+    std::atomic<size_t> next(0);
+
+    auto worker = [&]() {
+      for(size_t i = next++; i < filenames.size(); i = next++)
+        results[i] = scan(filenames[i]);
+    };
+
+    std::vector<std::thread> workers;
+    for(uint32_t t = 1; t < threads && t < filenames.size(); t++)
+      workers.push_back(std::thread(worker));
+
+    worker();
+
+    for(std::thread &t : workers)
+      t.join();
+
+    for(const std::string &r : results)
+      std::cout << r << std::endl;
+
+    return 0;
+  }
+};
+
+struct FarmCommand : public Command
+{
+private:
+  std::string filename;
+  std::string outfile;
+  std::string texturedir;
+  std::string serverList;
+  std::vector<std::string> servers;
+  bool counters = false;
+  bool postvs = false;
+
+  // set when this process is a worker launched by the farm command, running one share of the jobs
+  std::string workerOutput;
+  uint32_t workerServer = 0;
+  uint32_t workerSlice = 0;
+  uint32_t workerSlices = 1;
+
+  enum class JobType
+  {
+    Counter,
+    PostVS,
+    Texture,
+  };
+
+  struct Job
+  {
+    JobType type;
+    uint32_t index;
+    GPUCounter counter;
+    uint32_t eventId;
+    ResourceId resourceId;
+  };
+
+  static void flatten(const rdcarray<DrawcallDescription> &list, std::vector<uint32_t> &drawEvents)
+  {
+    for(const DrawcallDescription &d : list)
+    {
+      if(d.flags & DrawFlags::Drawcall)
+        drawEvents.push_back(d.eventId);
+      flatten(d.children, drawEvents);
+    }
+  }
+
+  static std::string counterValue(const CounterDescription &desc, const CounterValue &val)
+  {
+    std::ostringstream oss;
+    if(desc.resultType == CompType::Float)
+    {
+      if(desc.resultByteWidth == 8)
+        oss << val.d;
+      else
+        oss << val.f;
+    }
+    else
+    {
+      if(desc.resultByteWidth == 8)
+        oss << val.u64;
+      else
+        oss << val.u32;
+    }
+    return oss.str();
+  }
+
+  // every worker builds the job list from its own replay of the same capture, so it's identical in
+  // each and a job's index identifies it between processes
+  std::vector<Job> buildJobs(IReplayController *renderer)
+  {
+    std::vector<Job> ret;
+    Job job = {};
+
+    if(counters)
+    {
+      job.type = JobType::Counter;
+      for(GPUCounter c : renderer->EnumerateCounters())
+      {
+        job.counter = c;
+        ret.push_back(job);
+      }
+    }
+
+    if(postvs)
+    {
+      std::vector<uint32_t> drawEvents;
+      flatten(renderer->GetDrawcalls(), drawEvents);
+
+      job.type = JobType::PostVS;
+      for(uint32_t eid : drawEvents)
+      {
+        job.eventId = eid;
+        ret.push_back(job);
+      }
+    }
+
+    if(!texturedir.empty())
+    {
+      job.type = JobType::Texture;
+      job.index = 0;
+      for(const TextureDescription &tex : renderer->GetTextures())
+      {
+        job.resourceId = tex.resourceId;
+        ret.push_back(job);
+        job.index++;
+      }
+    }
+
+    return ret;
+  }
+
+  std::string runJob(IReplayController *renderer, const Job &job)
+  {
+    std::ostringstream json;
+
+    if(job.type == JobType::Counter)
+    {
+      CounterDescription desc = renderer->DescribeCounter(job.counter);
+
+      json << "{\"counter\": \"" << json_escape(conv(desc.name)) << "\", \"results\": [";
+
+      rdcarray<CounterResult> results = renderer->FetchCounters({job.counter});
+      for(size_t i = 0; i < results.size(); i++)
+        json << (i > 0 ? ", " : "") << "{\"event\": " << results[i].eventId
+             << ", \"value\": " << counterValue(desc, results[i].value) << "}";
+
+      json << "]}";
+    }
+    else if(job.type == JobType::PostVS)
+    {
+      renderer->SetFrameEvent(job.eventId, true);
+
+      MeshFormat vs = renderer->GetPostVSData(0, 0, MeshDataStage::VSOut);
+      MeshFormat gs = renderer->GetPostVSData(0, 0, MeshDataStage::GSOut);
+
+      json << "{\"event\": " << job.eventId << ", \"vs_out\": {\"indices\": " << vs.numIndices
+           << ", \"stride\": " << vs.vertexByteStride << "}, \"gs_out\": {\"indices\": "
+           << gs.numIndices << ", \"stride\": " << gs.vertexByteStride << "}}";
+    }
+    else if(job.type == JobType::Texture)
+    {
+      std::string path = texturedir + "/texture_" + std::to_string(job.index) + ".dds";
+
+      TextureSave save;
+      save.resourceId = job.resourceId;
+      save.destType = FileType::DDS;
+
+      bool success = renderer->SaveTexture(save, path.c_str());
+
+      json << "{\"resource\": \"" << ToStr(job.resourceId) << "\", \"path\": \""
+           << json_escape(path) << "\", \"saved\": " << (success ? "true" : "false") << "}";
+    }
+
+    return json.str();
+  }
+
+  static char jobTypeChar(JobType type) { return char('0' + (int)type); }
+
+  static std::string tempFile(const std::string &stamp, size_t slice, uint32_t attempt)
+  {
+    const char *dir = getenv("TMPDIR");
+    if(dir == NULL)
+      dir = getenv("TEMP");
+    if(dir == NULL)
+      dir = ".";
+
+    return std::string(dir) + "/renderdoc_farm_" + stamp + "_" + std::to_string(slice) + "_" +
+           std::to_string(attempt) + ".txt";
+  }
+
+  // replays the capture on one server and runs every job in its share, writing the results one per
+  // line to the output file as they complete. The parent only trusts the share if "done" is
+  // written at the end.
+  int runWorker(size_t server, size_t slice, size_t slices, const std::string &output)
+  {
+    FILE *out = fopen(output.c_str(), "w");
+    if(!out)
+    {
+      std::cerr << "Couldn't open '" << output << "' for writing." << std::endl;
+      return 1;
+    }
+
+    const std::string &url = servers[server];
+
+    IRemoteServer *remote = NULL;
+    ReplayStatus status = RENDERDOC_CreateRemoteServerConnection(url.c_str(), &remote);
+
+    if(remote == NULL || status != ReplayStatus::Succeeded)
+    {
+      std::cerr << "Couldn't connect to " << url << ": " << ToStr(status) << std::endl;
+      fprintf(out, "error %s\n", ToStr(status).c_str());
+      fclose(out);
+      return 1;
+    }
+
+    rdcstr remotePath = remote->CopyCaptureToRemote(filename.c_str(), NULL);
+
+    // servers sharing a machine each take a different GPU, by their order in the list
+    ReplayOptions opts;
+    rdcarray<GPUDevice> gpus = remote->GetAvailableGPUs();
+    if(!gpus.empty())
+    {
+      const GPUDevice &gpu = gpus[server % gpus.size()];
+      opts.forceGPUVendor = gpu.vendor;
+      opts.forceGPUDeviceID = gpu.deviceID;
+      opts.forceGPUDriverName = gpu.driver;
+
+      fprintf(out, "gpu %s\n", json_escape(conv(gpu.name)).c_str());
+    }
+
+    IReplayController *renderer = NULL;
+    rdctie(status, renderer) = remote->OpenCapture(~0U, remotePath.c_str(), opts, NULL);
+
+    if(status != ReplayStatus::Succeeded)
+    {
+      std::cerr << "Couldn't load and replay '" << filename << "' on " << url << ": "
+                << ToStr(status) << std::endl;
+      fprintf(out, "error %s\n", ToStr(status).c_str());
+      fclose(out);
+      remote->ShutdownConnection();
+      return 1;
+    }
+
+    std::vector<Job> jobs = buildJobs(renderer);
 
-    rest.erase(rest.begin());
+    std::string types;
+    for(const Job &job : jobs)
+      types += jobTypeChar(job.type);
+    fprintf(out, "jobs %s\n", types.c_str());
 
-    parser.set_rest(rest);
+    // flush each result so that if the replay crashes, everything finished so far is kept
+    for(size_t i = slice; i < jobs.size(); i += slices)
+    {
+      fprintf(out, "result %zu %s\n", i, runJob(renderer, jobs[i]).c_str());
+      fflush(out);
+    }
 
-    if(parser.exist("remote-host"))
-      remote_host = parser.get<std::string>("remote-host");
+    fprintf(out, "done\n");
+    fclose(out);
 
-    width = parser.get<uint32_t>("width");
-    height = parser.get<uint32_t>("height");
-    loops = parser.get<uint32_t>("loops");
+    remote->CloseCapture(renderer);
+    remote->ShutdownConnection();
 
-    return true;
+    return 0;
   }
-  virtual int Execute(const CaptureOptions &)
+
+  struct WorkerRun
   {
-    if(!remote_host.empty())
-    {
-      std::cout << "Replaying '" << filename << "' on " << remote_host << "." << std::endl;
+    size_t server;
+    size_t slice;
+    std::string output;
+  };
 
-      IRemoteServer *remote = NULL;
-      ReplayStatus status = RENDERDOC_CreateRemoteServerConnection(remote_host.c_str(), &remote);
+  struct WorkerResult
+  {
+    bool done = false;
+    uint32_t jobs = 0;
+    std::string gpu;
+    std::string error;
+  };
+
+  // each replay runs in its own worker process, since a replay's local proxy device isn't safe to
+  // share with another in the same process. Waits for all of the runs to finish.
+  void runWorkers(const std::vector<WorkerRun> &runs, size_t slices)
+  {
+    std::vector<uint64_t> procs;
+    std::vector<const WorkerRun *> local;
 
-      if(remote == NULL || status != ReplayStatus::Succeeded)
+    for(const WorkerRun &run : runs)
+    {
+      std::vector<std::string> args = {"farm",
+                                       "--servers",
+                                       serverList,
+                                       "--worker-server",
+                                       std::to_string(run.server),
+                                       "--worker-slice",
+                                       std::to_string(run.slice),
+                                       "--worker-slices",
+                                       std::to_string(slices),
+                                       "--worker-output",
+                                       run.output};
+      if(counters)
+        args.push_back("--counters");
+      if(postvs)
+        args.push_back("--postvs");
+      if(!texturedir.empty())
       {
-        std::cerr << "Error: " << ToStr(status) << " - Couldn't connect to " << remote_host << "."
-                  << std::endl;
-        std::cerr << "       Have you run renderdoccmd remoteserver on '" << remote_host << "'?"
-                  << std::endl;
-        return 1;
+        args.push_back("--save-textures");
+        args.push_back(texturedir);
       }
+      args.push_back(filename);
 
-      std::cerr << "Copying capture file to remote server" << std::endl;
+      uint64_t proc = LaunchWorkerProcess(args);
+      if(proc != 0)
+        procs.push_back(proc);
+      else
+        local.push_back(&run);
+    }
 
-      rdcstr remotePath = remote->CopyCaptureToRemote(filename.c_str(), NULL);
+    // where worker processes aren't supported, run those shares here one at a time so that only
+    // one replay is ever open in this process
+    for(const WorkerRun *run : local)
+      runWorker(run->server, run->slice, slices, run->output);
 
-      IReplayController *renderer = NULL;
-      rdctie(status, renderer) = remote->OpenCapture(~0U, remotePath.c_str(), ReplayOptions(), NULL);
+    for(uint64_t proc : procs)
+      while(IsWorkerProcessRunning(proc))
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  }
 
-      if(status == ReplayStatus::Succeeded)
-      {
-        DisplayRendererPreview(renderer, width, height, loops);
+  // reads back what a worker wrote, merging its results in and then deleting the file
+  WorkerResult readWorker(const WorkerRun &run, std::string &types,
+                          std::vector<std::string> &results)
+  {
+    WorkerResult ret;
 
-        remote->CloseCapture(renderer);
+    std::ifstream in(run.output);
+    std::string line;
+    while(std::getline(in, line))
+    {
+      if(line.compare(0, 4, "gpu ") == 0)
+      {
+        ret.gpu = line.substr(4);
       }
-      else
+      else if(line.compare(0, 6, "error ") == 0)
       {
-        std::cerr << "Couldn't load and replay '" << filename << "': " << ToStr(status) << std::endl;
+        ret.error = line.substr(6);
       }
-
-      remote->ShutdownConnection();
-    }
-    else
-    {
-      std::cout << "Replaying '" << filename << "' locally.." << std::endl;
-
-      ICaptureFile *file = RENDERDOC_OpenCaptureFile();
-
-      if(file->OpenFile(filename.c_str(), "rdc", NULL) != ReplayStatus::Succeeded)
+      else if(line.compare(0, 5, "jobs ") == 0)
       {
-        std::cerr << "Couldn't load '" << filename << "'." << std::endl;
-        return 1;
+        if(types.empty())
+        {
+          types = line.substr(5);
+          results.resize(types.size());
+        }
       }
-
-      IReplayController *renderer = NULL;
-      ReplayStatus status = ReplayStatus::InternalError;
-      rdctie(status, renderer) = file->OpenCapture(ReplayOptions(), NULL);
-
-      file->Shutdown();
-
-      if(status == ReplayStatus::Succeeded)
+      else if(line.compare(0, 7, "result ") == 0)
       {
-        DisplayRendererPreview(renderer, width, height, loops);
-
-        renderer->Shutdown();
+        size_t space = line.find(' ', 7);
+        size_t idx = (size_t)strtoull(line.c_str() + 7, NULL, 10);
+        if(space != std::string::npos && idx < results.size())
+        {
+          results[idx] = line.substr(space + 1);
+          ret.jobs++;
+        }
       }
-      else
+      else if(line == "done")
       {
-        std::cerr << "Couldn't load and replay '" << filename << "': " << ToStr(status) << std::endl;
-        return 1;
+        ret.done = true;
       }
     }
-    return 0;
-  }
-};
-
-struct formats_reader
-{
-  formats_reader(bool input)
-  {
-    ICaptureFile *tmp = RENDERDOC_OpenCaptureFile();
+    in.close();
 
-    for(const CaptureFileFormat &f : tmp->GetCaptureFileFormats())
-    {
-      if(!f.openSupported && input)
-        continue;
+    remove(run.output.c_str());
 
-      exts.push_back(conv(f.extension));
-      names.push_back(conv(f.name));
-    }
+    if(!ret.done && ret.error.empty())
+      ret.error = "Worker exited before finishing";
 
-    tmp->Shutdown();
-  }
-  std::string operator()(const std::string &s)
-  {
-    if(std::find(exts.begin(), exts.end(), s) == exts.end())
-      throw cmdline::cmdline_error("'" + s + "' is not one of the accepted values");
-    return s;
-  }
-  std::string description() const
-  {
-    std::string ret = "Options are:";
-    for(size_t i = 0; i < exts.size(); i++)
-      ret += "\n  * " + exts[i] + " - " + names[i];
     return ret;
   }
 
-private:
-  std::vector<std::string> exts;
-  std::vector<std::string> names;
-};
-
-struct ConvertCommand : public Command
-{
-private:
-  rdcarray<CaptureFileFormat> m_Formats;
-  bool list_formats = false;
-  std::string infile;
-  std::string outfile;
-  std::string infmt;
-  std::string outfmt;
-
 public:
-  ConvertCommand() : Command() {}
+  FarmCommand() : Command() {}
   virtual void AddOptions(cmdline::parser &parser)
   {
-    parser.add<std::string>("filename", 'f', "The file to convert from.", false);
-    parser.add<std::string>("output", 'o', "The file to convert to.", false);
-    parser.add<std::string>("input-format", 'i', "The format of the input file.", false, "",
-                            formats_reader(true));
-    parser.add<std::string>("convert-format", 'c', "The format of the output file.", false, "",
-                            formats_reader(false));
-    parser.add("list-formats", '\0', "Print a list of target formats.");
-    parser.stop_at_rest(true);
+    parser.set_footer("<capture.rdc>");
+    parser.add<std::string>("servers", 's',
+                            "Comma-separated list of remote servers to share the work between, as "
+                            "host or host:port. Run one 'remoteserver --port' per GPU to use "
+                            "several GPUs on one machine.",
+                            true);
+    parser.add<std::string>("output", 'o', "Write the JSON results to this file instead of stdout.",
+                            false);
+    parser.add("counters", 0, "Fetch every available GPU counter for all events.");
+    parser.add("postvs", 0, "Fetch the post-transform data for every draw.");
+    parser.add<std::string>("save-textures", 0, "Save every texture as DDS into this directory.",
+                            false);
+    parser.add<std::string>("worker-output", 0,
+                            "Internal: run as a farm worker writing to this file.", false);
+    parser.add<uint32_t>("worker-server", 0, "Internal: the server a farm worker replays on.",
+                         false);
+    parser.add<uint32_t>("worker-slice", 0, "Internal: the share of jobs a farm worker runs.",
+                         false);
+    parser.add<uint32_t>("worker-slices", 0, "Internal: the number of shares of jobs.", false, 1);
+  }
+  virtual const char *Description()
+  {
+    return "Share independent analysis of a capture between several replay servers, and print "
+           "the merged results as JSON.";
   }
-  virtual const char *Description() { return "Convert between capture formats."; }
   virtual bool IsInternalOnly() { return false; }
   virtual bool IsCaptureCommand() { return false; }
   virtual bool Parse(cmdline::parser &parser, GlobalEnvironment &)
   {
-    list_formats = parser.exist("list-formats");
-
-    if(list_formats)
-      return true;
-
-    infile = parser.get<std::string>("filename");
-    outfile = parser.get<std::string>("output");
-
-    if(infile.empty())
+    std::vector<std::string> rest = parser.rest();
+    if(rest.empty())
     {
-      std::cerr << "Need an input filename (-f)." << std::endl << std::endl;
-      std::cerr << parser.usage() << std::endl;
+      std::cerr << "Error: farm command requires a filename to load." << std::endl
+                << std::endl
+                << parser.usage();
       return false;
     }
 
-    if(outfile.empty())
-    {
-      std::cerr << "Need an output filename (-o)." << std::endl << std::endl;
-      std::cerr << parser.usage() << std::endl;
-      return false;
-    }
+    filename = rest[0];
 
-    infmt = parser.get<std::string>("input-format");
-    outfmt = parser.get<std::string>("convert-format");
+    rest.erase(rest.begin());
 
-    return true;
-  }
+    parser.set_rest(rest);
 
-  virtual int Execute(const CaptureOptions &)
-  {
-    ICaptureFile *tmp = RENDERDOC_OpenCaptureFile();
+    serverList = parser.get<std::string>("servers");
+    for(size_t start = 0; start <= serverList.size();)
+    {
+      size_t end = serverList.find(',', start);
+      if(end == std::string::npos)
+        end = serverList.size();
 
-    m_Formats = tmp->GetCaptureFileFormats();
+      if(end > start)
+        servers.push_back(serverList.substr(start, end - start));
 
-    tmp->Shutdown();
+      start = end + 1;
+    }
 
-    if(list_formats)
+    if(servers.empty())
     {
-      std::cout << "Available formats:" << std::endl;
-      for(CaptureFileFormat f : m_Formats)
-        std::cout << "'" << f.extension << "': " << f.name << std::endl
-                  << " * " << f.description << std::endl
-                  << std::endl;
-      return 0;
+      std::cerr << "Error: farm command requires at least one server." << std::endl
+                << std::endl
+                << parser.usage();
+      return false;
     }
 
-    // sort the formats by the length of the extension, so we check the longest ones first. This
-    // means that .zip.xml will get chosen before just .xml
-    std::sort(m_Formats.begin(), m_Formats.end(),
-              [](const CaptureFileFormat &a, const CaptureFileFormat &b) {
-                return a.extension.size() > b.extension.size();
-              });
+    if(parser.exist("output"))
+      outfile = parser.get<std::string>("output");
+    if(parser.exist("save-textures"))
+      texturedir = parser.get<std::string>("save-textures");
 
-    if(infmt.empty())
+    counters = parser.exist("counters");
+    postvs = parser.exist("postvs");
+
+    if(parser.exist("worker-output"))
     {
-      // try to guess the format by looking for the extension in the filename
-      for(CaptureFileFormat f : m_Formats)
+      workerOutput = parser.get<std::string>("worker-output");
+      workerServer = parser.get<uint32_t>("worker-server");
+      workerSlice = parser.get<uint32_t>("worker-slice");
+      workerSlices = std::max(1U, parser.get<uint32_t>("worker-slices"));
+
+      if(workerServer >= servers.size())
       {
-        if(infile.find(conv("." + f.extension)) != std::string::npos)
-        {
-          infmt = conv(f.extension);
-          break;
-        }
+        std::cerr << "Error: farm worker server index out of range." << std::endl;
+        return false;
       }
     }
 
-    if(infmt.empty())
+    return true;
+  }
+  virtual int Execute(const CaptureOptions &)
+  {
+    if(!workerOutput.empty())
+      return runWorker(workerServer, workerSlice, workerSlices, workerOutput);
+
+    // workers all save into the same directory, so it must exist before any of them start
+    if(!texturedir.empty() && !MakeDirectory(texturedir))
     {
-      std::cerr << "Couldn't guess input format from filename '" << infile << "'." << std::endl
-                << std::endl;
+      std::cerr << "Couldn't create texture output directory '" << texturedir << "'." << std::endl;
       return 1;
     }
 
-    if(outfmt.empty())
+    // the jobs are split into one share per server, each run by its own worker process
+    const size_t slices = servers.size();
+    const std::string stamp =
+        std::to_string(std::chrono::system_clock::now().time_since_epoch().count());
+
+    std::vector<WorkerRun> runs;
+    for(size_t w = 0; w < slices; w++)
+      runs.push_back({w, w, tempFile(stamp, w, 0)});
+
+    runWorkers(runs, slices);
+
+    std::string types;
+    std::vector<std::string> results;
+    std::vector<uint32_t> serverJobs(slices, 0);
+    std::vector<std::string> serverGPU(slices), serverError(slices);
+    std::vector<size_t> working, failed;
+
+    for(const WorkerRun &run : runs)
     {
-      // try to guess the format by looking for the extension in the filename
-      for(CaptureFileFormat f : m_Formats)
-      {
-        if(outfile.find(conv("." + f.extension)) != std::string::npos)
-        {
-          outfmt = conv(f.extension);
-          break;
-        }
-      }
+      WorkerResult res = readWorker(run, types, results);
+
+      serverGPU[run.server] = res.gpu;
+      serverError[run.server] = res.error;
+      serverJobs[run.server] += res.jobs;
+
+      if(res.done)
+        working.push_back(run.server);
+      else
+        failed.push_back(run.slice);
     }
 
-    if(outfmt.empty())
+    // a share whose server couldn't replay, or whose worker died part way through, is run again on
+    // the servers that did succeed
+    if(!failed.empty() && !working.empty())
     {
-      std::cerr << "Couldn't guess output format from filename '" << outfile << "'." << std::endl
+      std::cerr << "Retrying " << failed.size() << " share(s) of the jobs on other servers."
                 << std::endl;
-      return 1;
-    }
 
-    ICaptureFile *file = RENDERDOC_OpenCaptureFile();
+      runs.clear();
+      for(size_t f = 0; f < failed.size(); f++)
+        runs.push_back({working[f % working.size()], failed[f], tempFile(stamp, failed[f], 1)});
 
-    ReplayStatus st = file->OpenFile(infile.c_str(), infmt.c_str(), NULL);
+      runWorkers(runs, slices);
 
-    if(st != ReplayStatus::Succeeded)
+      for(const WorkerRun &run : runs)
+        serverJobs[run.server] += readWorker(run, types, results).jobs;
+    }
+
+    if(working.empty())
     {
-      std::cerr << "Couldn't load '" << infile << "' as '" << infmt << "': " << ToStr(st)
-                << std::endl;
+      std::cerr << "Couldn't replay '" << filename << "' on any server." << std::endl;
       return 1;
     }
 
-    st = file->Convert(outfile.c_str(), outfmt.c_str(), NULL, NULL);
+    std::ostringstream json;
+    json << "{\"capture\": \"" << json_escape(filename) << "\", \"servers\": [";
+    for(size_t w = 0; w < slices; w++)
+    {
+      json << (w > 0 ? ", " : "") << "{\"server\": \"" << json_escape(servers[w]) << "\"";
+      if(!serverGPU[w].empty())
+        json << ", \"gpu\": \"" << serverGPU[w] << "\"";
+      if(!serverError[w].empty())
+        json << ", \"error\": \"" << serverError[w] << "\"";
+      else
+        json << ", \"jobs\": " << serverJobs[w];
+      json << "}";
+    }
+    json << "]";
 
-    if(st != ReplayStatus::Succeeded)
+    // results are merged back in the original job order, regardless of which server ran them
+    const char *names[] = {"counters", "postvs", "textures"};
+    JobType jobTypes[] = {JobType::Counter, JobType::PostVS, JobType::Texture};
+    for(size_t t = 0; t < 3; t++)
     {
-      std::cerr << "Couldn't convert '" << infile << "' to '" << outfile << "' as '" << outfmt
-                << "': " << ToStr(st) << std::endl;
-      return 1;
+      json << ", \"" << names[t] << "\": [";
+      bool first = true;
+      for(size_t i = 0; i < types.size(); i++)
+      {
+        if(types[i] != jobTypeChar(jobTypes[t]))
+          continue;
+
+        if(results[i].empty())
+          json << (first ? "" : ", ") << "null";
+        else
+          json << (first ? "" : ", ") << results[i];
+        first = false;
+      }
+      json << "]";
     }
+    json << "}";
 
-    std::cout << "Converted '" << infile << "' to '" << outfile << "'" << std::endl;
+    if(outfile.empty())
+    {
+      std::cout << json.str() << std::endl;
+    }
+    else
+    {
+      FILE *f = fopen(outfile.c_str(), "w");
+      if(!f)
+      {
+        std::cerr << "Couldn't open '" << outfile << "' for writing." << std::endl;
+        return 1;
+      }
+      fputs(json.str().c_str(), f);
+      fputs("\n", f);
+      fclose(f);
+    }
 
     return 0;
   }
@@ -1557,6 +2934,11 @@ int renderdoccmd(GlobalEnvironment &env, std::vector<std::string> &argv)
     add_command("capaltbit", new CapAltBitCommand());
     add_command("test", new TestCommand());
     add_command("convert", new ConvertCommand());
+    add_command("trim", new TrimCommand());
+    add_command("diff", new DiffCommand());
+    add_command("benchmark", new BenchmarkCommand());
+    add_command("scan", new ScanCommand());
+    add_command("farm", new FarmCommand());
     add_command("embed", new EmbeddedSectionCommand(false));
     add_command("extract", new EmbeddedSectionCommand(true));
 
@@ -1633,6 +3015,43 @@ int renderdoccmd(GlobalEnvironment &env, std::vector<std::string> &argv)
               "Capturing Option: Include all live resources, not just those used by a frame.");
       cmd.add("opt-capture-all-cmd-lists", 0,
               "Capturing Option: In D3D11, record all command lists from application start.");
+      cmd.add("opt-merge-multi-frame-captures", 0,
+              "Capturing Option: Record consecutive captured frames into a single capture.");
+      cmd.add<int>("opt-flight-recorder-frames", 0,
+                   "Capturing Option: Keep this many recent frames in memory, to be saved later.",
+                   false, 0, cmdline::range(0, 10000));
+      cmd.add<int>("opt-flight-recorder-memory", 0,
+                   "Capturing Option: Memory limit in MB for frames kept by the flight recorder.",
+                   false, 512, cmdline::range(0, 1024 * 1024));
+      cmd.add<int>("opt-capture-memory-budget", 0,
+                   "Capturing Option: Spill captured commands to disk past this many MB, or 0.",
+                   false, 0, cmdline::range(0, 1024 * 1024));
+      cmd.add("opt-watch-coherent-map-writes", 0,
+              "Capturing Option: Only save the pages written through persistent mappings.");
+      cmd.add("opt-defer-descriptor-updates", 0,
+              "Capturing Option: In Vulkan, defer read-only descriptor updates until a capture.");
+      cmd.add("opt-dedup-initial-contents", 0,
+              "Capturing Option: Store identical initial contents only once in the capture.");
+      cmd.add("opt-compact-initial-states", 0,
+              "Capturing Option: In Vulkan, compact large images on the GPU before readback.");
+      cmd.add("opt-async-capture-write", 0,
+              "Capturing Option: Write captures to disk on a background thread.");
+      cmd.add("opt-defer-creation-chunks", 0,
+              "Capturing Option: In Vulkan, only record samplers and views alive at a capture.");
+      cmd.add<int>("opt-capture-queue-family", 0,
+                   "Capturing Option: In Vulkan, only capture submissions to this queue family.",
+                   false, -1, cmdline::range(-1, 1024));
+      cmd.add<int>("opt-capture-first-submit", 0,
+                   "Capturing Option: The first submission to capture, from the capture's start.",
+                   false, 0, cmdline::range(0, 1000000));
+      cmd.add<int>("opt-capture-num-submits", 0,
+                   "Capturing Option: How many submissions to capture, or 0 for all of them.",
+                   false, 0, cmdline::range(0, 1000000));
+    }
+    else
+    {
+      cmd.add("headless", 0,
+              "Replay without initialising any windowing system, using only offscreen outputs.");
     }
 
     cmd.parse_check(argv, true);
@@ -1662,8 +3081,28 @@ int renderdoccmd(GlobalEnvironment &env, std::vector<std::string> &argv)
         opts.refAllResources = true;
       if(cmd.exist("opt-capture-all-cmd-lists"))
         opts.captureAllCmdLists = true;
+      if(cmd.exist("opt-merge-multi-frame-captures"))
+        opts.mergeMultiFrameCaptures = true;
+      if(cmd.exist("opt-watch-coherent-map-writes"))
+        opts.watchCoherentMapWrites = true;
+      if(cmd.exist("opt-defer-descriptor-updates"))
+        opts.deferDescriptorUpdates = true;
+      if(cmd.exist("opt-dedup-initial-contents"))
+        opts.dedupInitialContents = true;
+      if(cmd.exist("opt-compact-initial-states"))
+        opts.compactInitialStates = true;
+      if(cmd.exist("opt-async-capture-write"))
+        opts.asyncCaptureWrite = true;
+      if(cmd.exist("opt-defer-creation-chunks"))
+        opts.deferCreationChunks = true;
 
       opts.delayForDebugger = (uint32_t)cmd.get<int>("opt-delay-for-debugger");
+      opts.flightRecorderFrames = (uint32_t)cmd.get<int>("opt-flight-recorder-frames");
+      opts.flightRecorderMemoryMB = (uint32_t)cmd.get<int>("opt-flight-recorder-memory");
+      opts.captureMemoryBudgetMB = (uint32_t)cmd.get<int>("opt-capture-memory-budget");
+      opts.captureQueueFamily = (uint32_t)cmd.get<int>("opt-capture-queue-family");
+      opts.captureFirstSubmit = (uint32_t)cmd.get<int>("opt-capture-first-submit");
+      opts.captureNumSubmits = (uint32_t)cmd.get<int>("opt-capture-num-submits");
     }
 
     if(!it->second->HandlesUsageManually() && cmd.exist("help"))
@@ -1673,6 +3112,9 @@ int renderdoccmd(GlobalEnvironment &env, std::vector<std::string> &argv)
       return 0;
     }
 
+    if(!it->second->IsCaptureCommand() && cmd.exist("headless"))
+      env.headless = true;
+
     if(!it->second->Parse(cmd, env))
     {
       clean_up();
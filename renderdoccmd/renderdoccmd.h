@@ -58,3 +58,12 @@ void DisplayRendererPreview(IReplayController *renderer, TextureDisplay &display
                             uint32_t height, uint32_t numLoops);
 WindowingData DisplayRemoteServerPreview(bool active, const rdcarray<WindowingSystem> &systems);
 void Daemonise();
+
+// launch another instance of this program with the given arguments, used to run remote server
+// workers. Returns an opaque handle, or 0 if it couldn't be launched or it's unsupported.
+uint64_t LaunchWorkerProcess(const std::vector<std::string> &args);
+bool IsWorkerProcessRunning(uint64_t worker);
+void StopWorkerProcess(uint64_t worker);
+
+// create a directory, succeeding if it already exists. Parent directories must exist.
+bool MakeDirectory(const std::string &path);
@@ -27,8 +27,10 @@
 #include <GLES2/gl2.h>
 #include <GLES2/gl2ext.h>
 #include <dlfcn.h>
+#include <errno.h>
 #include <locale.h>
 #include <string.h>
+#include <sys/stat.h>
 #include <unistd.h>
 #include <string>
 
@@ -74,6 +76,26 @@ void Daemonise()
 {
 }
 
+uint64_t LaunchWorkerProcess(const std::vector<std::string> &args)
+{
+  // not supported
+  return 0;
+}
+
+bool IsWorkerProcessRunning(uint64_t worker)
+{
+  return false;
+}
+
+void StopWorkerProcess(uint64_t worker)
+{
+}
+
+bool MakeDirectory(const std::string &path)
+{
+  return mkdir(path.c_str(), 0755) == 0 || errno == EEXIST;
+}
+
 void DisplayGenericSplash()
 {
   ANDROID_LOG("Trying to splash");
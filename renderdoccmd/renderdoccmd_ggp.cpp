@@ -23,8 +23,10 @@
  ******************************************************************************/
 
 #include "renderdoccmd.h"
+#include <errno.h>
 #include <signal.h>
 #include <string.h>
+#include <sys/stat.h>
 #include <unistd.h>
 
 #include <ggp_c/ggp.h>
@@ -48,6 +50,26 @@ void Daemonise()
   daemon(1, 0);
 }
 
+uint64_t LaunchWorkerProcess(const std::vector<std::string> &args)
+{
+  // not supported
+  return 0;
+}
+
+bool IsWorkerProcessRunning(uint64_t worker)
+{
+  return false;
+}
+
+void StopWorkerProcess(uint64_t worker)
+{
+}
+
+bool MakeDirectory(const std::string &path)
+{
+  return mkdir(path.c_str(), 0755) == 0 || errno == EEXIST;
+}
+
 WindowingData DisplayRemoteServerPreview(bool active, const rdcarray<WindowingSystem> &systems)
 {
   static WindowingData remoteServerPreview = {WindowingSystem::Unknown};
@@ -25,6 +25,7 @@
 
 #include "renderdoccmd.h"
 #include <dlfcn.h>
+#include <errno.h>
 #include <iconv.h>
 #include <limits.h>
 #include <locale.h>
@@ -33,8 +34,10 @@
 #include <string.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <sys/wait.h>
 #include <unistd.h>
 #include <string>
+#include <vector>
 
 #if defined(RENDERDOC_WINDOWING_XLIB)
 #include <X11/Xlib-xcb.h>
@@ -48,6 +51,48 @@ void Daemonise()
   daemon(1, 0);
 }
 
+uint64_t LaunchWorkerProcess(const std::vector<std::string> &args)
+{
+  char exe[PATH_MAX + 1] = {};
+  if(readlink("/proc/self/exe", exe, PATH_MAX) <= 0)
+    return 0;
+
+  std::vector<char *> argv;
+  argv.push_back(exe);
+  for(const std::string &a : args)
+    argv.push_back((char *)a.c_str());
+  argv.push_back(NULL);
+
+  pid_t pid = fork();
+
+  if(pid == 0)
+  {
+    execv(exe, argv.data());
+    _exit(1);
+  }
+
+  return pid > 0 ? (uint64_t)pid : 0;
+}
+
+bool IsWorkerProcessRunning(uint64_t worker)
+{
+  int status = 0;
+  return waitpid((pid_t)worker, &status, WNOHANG) == 0;
+}
+
+void StopWorkerProcess(uint64_t worker)
+{
+  kill((pid_t)worker, SIGTERM);
+
+  int status = 0;
+  waitpid((pid_t)worker, &status, 0);
+}
+
+bool MakeDirectory(const std::string &path)
+{
+  return mkdir(path.c_str(), 0755) == 0 || errno == EEXIST;
+}
+
 static Display *display = NULL;
 
 WindowingData DisplayRemoteServerPreview(bool active, const rdcarray<WindowingSystem> &systems)
@@ -332,11 +377,21 @@ int main(int argc, char *argv[])
   GlobalEnvironment env;
 
 #if defined(RENDERDOC_WINDOWING_XLIB) || defined(RENDERDOC_WINDOWING_XCB)
-  // call XInitThreads - although we don't use xlib concurrently the driver might need to.
-  XInitThreads();
+  // the command line isn't parsed yet, but a headless replay must not touch the display at all
+  // since connecting to a missing or remote one can stall.
+  bool headless = false;
+  for(int i = 1; i < argc; i++)
+    if(!strcmp(argv[i], "--headless"))
+      headless = true;
+
+  if(!headless)
+  {
+    // call XInitThreads - although we don't use xlib concurrently the driver might need to.
+    XInitThreads();
 
-  // we don't check if display successfully opened, it's only a problem if it's needed later.
-  display = env.xlibDisplay = XOpenDisplay(NULL);
+    // we don't check if display successfully opened, it's only a problem if it's needed later.
+    display = env.xlibDisplay = XOpenDisplay(NULL);
+  }
 #endif
 
   // add compiled-in support to version line
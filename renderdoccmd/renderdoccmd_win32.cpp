@@ -130,6 +130,49 @@ void Daemonise()
   // nothing really to do, windows version of renderdoccmd is already 'detached'
 }
 
+uint64_t LaunchWorkerProcess(const std::vector<std::string> &args)
+{
+  wchar_t exe[MAX_PATH + 1] = {};
+  if(GetModuleFileNameW(NULL, exe, MAX_PATH) == 0)
+    return 0;
+
+  std::wstring cmdline = L"\"" + std::wstring(exe) + L"\"";
+  for(const std::string &a : args)
+    cmdline += L" \"" + conv(a) + L"\"";
+
+  STARTUPINFOW si = {};
+  si.cb = sizeof(si);
+  PROCESS_INFORMATION pi = {};
+
+  if(!CreateProcessW(exe, &cmdline[0], NULL, NULL, FALSE, 0, NULL, NULL, &si, &pi))
+    return 0;
+
+  CloseHandle(pi.hThread);
+
+  return (uint64_t)pi.hProcess;
+}
+
+bool IsWorkerProcessRunning(uint64_t worker)
+{
+  if(WaitForSingleObject((HANDLE)worker, 0) == WAIT_TIMEOUT)
+    return true;
+
+  CloseHandle((HANDLE)worker);
+  return false;
+}
+
+void StopWorkerProcess(uint64_t worker)
+{
+  TerminateProcess((HANDLE)worker, 0);
+  WaitForSingleObject((HANDLE)worker, INFINITE);
+  CloseHandle((HANDLE)worker);
+}
+
+bool MakeDirectory(const std::string &path)
+{
+  return CreateDirectoryW(conv(path).c_str(), NULL) || GetLastError() == ERROR_ALREADY_EXISTS;
+}
+
 WindowingData DisplayRemoteServerPreview(bool active, const rdcarray<WindowingSystem> &systems)
 {
   static WindowingData remoteServerPreview = {WindowingSystem::Unknown};
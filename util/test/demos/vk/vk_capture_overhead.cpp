@@ -0,0 +1,359 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019-2020 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include "vk_test.h"
+
+RD_TEST(VK_Capture_Overhead, VulkanGraphicsTest)
+{
+  static constexpr const char *Description =
+      "Benchmark rather than a test. Runs a parameterised heavy workload and prints frame timings, "
+      "and the cost of a capture if RenderDoc is present, as a single line of JSON. Run it both "
+      "with and without RenderDoc injected to compare. Parameters: --draws, --buffers, "
+      "--descriptors, --maps, --threads, --warmup, --capture-frame.";
+
+  std::string common = R"EOSHADER(
+
+#version 420 core
+
+struct v2f
+{
+	vec4 pos;
+	vec4 col;
+	vec4 uv;
+};
+
+)EOSHADER";
+
+  const std::string vertex = R"EOSHADER(
+
+layout(location = 0) in vec3 Position;
+layout(location = 1) in vec4 Color;
+layout(location = 2) in vec2 UV;
+
+layout(set = 0, binding = 0, std140) uniform constsbuf
+{
+  vec4 offset;
+  vec4 col;
+};
+
+layout(location = 0) out v2f vertOut;
+
+void main()
+{
+	vertOut.pos = vec4(Position.xy*vec2(0.02f,-0.02f) + offset.xy, Position.z, 1);
+	gl_Position = vertOut.pos;
+	vertOut.col = col;
+	vertOut.uv = vec4(UV.xy, 0, 1);
+}
+
+)EOSHADER";
+
+  const std::string pixel = R"EOSHADER(
+
+layout(location = 0) in v2f vertIn;
+
+layout(location = 0, index = 0) out vec4 Color;
+
+void main()
+{
+	Color = vertIn.col;
+}
+
+)EOSHADER";
+
+  // workload parameters
+  uint32_t numDraws = 2000;
+  uint32_t numBuffers = 1000;
+  uint32_t numDescriptors = 1000;
+  uint32_t numMaps = 100;
+  uint32_t numThreads = 1;
+  int warmupFrames = 50;
+  int captureFrame = 150;
+
+  static const uint32_t mapSize = 64 * 1024;
+
+  void Prepare(int argc, char **argv)
+  {
+    // this is a benchmark, so run for a fixed number of frames by default
+    maxFrameCount = 300;
+
+    VulkanGraphicsTest::Prepare(argc, argv);
+
+    for(int i = 0; i + 1 < argc; i++)
+    {
+      uint32_t val = (uint32_t)atoi(argv[i + 1]);
+
+      if(!strcmp(argv[i], "--draws"))
+        numDraws = std::max(1U, val);
+      else if(!strcmp(argv[i], "--buffers"))
+        numBuffers = std::max(1U, val);
+      else if(!strcmp(argv[i], "--descriptors"))
+        numDescriptors = std::max(1U, val);
+      else if(!strcmp(argv[i], "--maps"))
+        numMaps = val;
+      else if(!strcmp(argv[i], "--threads"))
+        numThreads = std::max(1U, std::min(val, 64U));
+      else if(!strcmp(argv[i], "--warmup"))
+        warmupFrames = atoi(argv[i + 1]);
+      else if(!strcmp(argv[i], "--capture-frame"))
+        captureFrame = atoi(argv[i + 1]);
+    }
+  }
+
+  int main()
+  {
+    // initialise, create window, create context, etc
+    if(!Init())
+      return 3;
+
+    VkDescriptorSetLayout setlayout = createDescriptorSetLayout(vkh::DescriptorSetLayoutCreateInfo({
+        {0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT},
+    }));
+
+    VkPipelineLayout layout = createPipelineLayout(vkh::PipelineLayoutCreateInfo({setlayout}));
+
+    vkh::GraphicsPipelineCreateInfo pipeCreateInfo;
+
+    pipeCreateInfo.layout = layout;
+    pipeCreateInfo.renderPass = mainWindow->rp;
+
+    pipeCreateInfo.vertexInputState.vertexBindingDescriptions = {vkh::vertexBind(0, DefaultA2V)};
+    pipeCreateInfo.vertexInputState.vertexAttributeDescriptions = {
+        vkh::vertexAttr(0, 0, DefaultA2V, pos), vkh::vertexAttr(1, 0, DefaultA2V, col),
+        vkh::vertexAttr(2, 0, DefaultA2V, uv),
+    };
+
+    pipeCreateInfo.stages = {
+        CompileShaderModule(common + vertex, ShaderLang::glsl, ShaderStage::vert, "main"),
+        CompileShaderModule(common + pixel, ShaderLang::glsl, ShaderStage::frag, "main"),
+    };
+
+    VkPipeline pipe = createGraphicsPipeline(pipeCreateInfo);
+
+    AllocatedBuffer vb(
+        this, vkh::BufferCreateInfo(sizeof(DefaultTri), VK_BUFFER_USAGE_VERTEX_BUFFER_BIT |
+                                                            VK_BUFFER_USAGE_TRANSFER_DST_BIT),
+        VmaAllocationCreateInfo({0, VMA_MEMORY_USAGE_CPU_TO_GPU}));
+
+    vb.upload(DefaultTri);
+
+    // one small uniform buffer per resource, each placing its draws somewhere on screen
+    std::vector<AllocatedBuffer> cbs;
+    cbs.reserve(numBuffers);
+    for(uint32_t i = 0; i < numBuffers; i++)
+    {
+      cbs.push_back(AllocatedBuffer(
+          this, vkh::BufferCreateInfo(sizeof(Vec4f) * 2, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT),
+          VmaAllocationCreateInfo({0, VMA_MEMORY_USAGE_CPU_TO_GPU})));
+
+      Vec4f data[2] = {
+          Vec4f(RANDF(-0.95f, 0.95f), RANDF(-0.95f, 0.95f), 0.0f, 0.0f),
+          Vec4f(RANDF(0.2f, 1.0f), RANDF(0.2f, 1.0f), RANDF(0.2f, 1.0f), 1.0f),
+      };
+      cbs.back().upload(data);
+    }
+
+    std::vector<VkDescriptorSet> descsets(numDescriptors);
+    for(uint32_t i = 0; i < numDescriptors; i++)
+    {
+      descsets[i] = allocateDescriptorSet(setlayout);
+
+      VkBuffer buf = cbs[i % numBuffers].buffer;
+
+      vkh::updateDescriptorSets(
+          device, {
+                      vkh::WriteDescriptorSet(descsets[i], 0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+                                              {vkh::DescriptorBufferInfo(buf)}),
+                  });
+    }
+
+    // buffers that are mapped and written every frame
+    std::vector<AllocatedBuffer> mapbufs;
+    mapbufs.reserve(numMaps);
+    for(uint32_t i = 0; i < numMaps; i++)
+      mapbufs.push_back(AllocatedBuffer(
+          this, vkh::BufferCreateInfo(mapSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT),
+          VmaAllocationCreateInfo({0, VMA_MEMORY_USAGE_CPU_TO_GPU})));
+
+    std::vector<byte> mapData(mapSize);
+
+    // each thread records its share of the draws into a secondary command buffer from its own
+    // pool, so there's no synchronisation needed while recording.
+    std::vector<VkCommandPool> pools(numThreads);
+    std::vector<VkCommandBuffer> secondaries(numThreads);
+    for(uint32_t t = 0; t < numThreads; t++)
+    {
+      CHECK_VKR(vkCreateCommandPool(device, vkh::CommandPoolCreateInfo(0, queueFamilyIndex), NULL,
+                                    &pools[t]));
+      CHECK_VKR(vkAllocateCommandBuffers(
+          device, vkh::CommandBufferAllocateInfo(pools[t], 1, VK_COMMAND_BUFFER_LEVEL_SECONDARY),
+          &secondaries[t]));
+    }
+
+    auto recordDraws = [&](uint32_t t) {
+      VkCommandBuffer cmd = secondaries[t];
+
+      vkh::CommandBufferInheritanceInfo inherit(mainWindow->rp, 0, mainWindow->GetFB());
+
+      vkBeginCommandBuffer(cmd, vkh::CommandBufferBeginInfo(
+                                    VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT |
+                                        VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT,
+                                    &inherit));
+
+      vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, pipe);
+      vkCmdSetViewport(cmd, 0, 1, &mainWindow->viewport);
+      vkCmdSetScissor(cmd, 0, 1, &mainWindow->scissor);
+      vkh::cmdBindVertexBuffers(cmd, 0, {vb.buffer}, {0});
+
+      uint32_t perThread = (numDraws + numThreads - 1) / numThreads;
+      uint32_t begin = t * perThread;
+      uint32_t end = std::min(numDraws, begin + perThread);
+
+      for(uint32_t d = begin; d < end; d++)
+      {
+        vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, layout, 0, 1,
+                                &descsets[d % numDescriptors], 0, NULL);
+        vkCmdDraw(cmd, 3, 1, 0, 0);
+      }
+
+      vkEndCommandBuffer(cmd);
+    };
+
+    typedef std::chrono::high_resolution_clock clock;
+
+    std::vector<double> frameTimes;
+    double captureFrameMS = -1.0, endCaptureMS = -1.0;
+
+    while(Running())
+    {
+      clock::time_point frameStart = clock::now();
+
+      const bool capturing = rdoc && curFrame == captureFrame;
+
+      if(capturing)
+        rdoc->StartFrameCapture(NULL, NULL);
+
+      // the secondaries are re-recorded every frame, so wait for the previous frame to be done
+      vkDeviceWaitIdle(device);
+
+      for(uint32_t t = 0; t < numThreads; t++)
+        vkResetCommandPool(device, pools[t], 0);
+
+      for(uint32_t i = 0; i < numMaps; i++)
+      {
+        memset(mapData.data(), (curFrame + i) & 0xff, mapData.size());
+        mapbufs[i].upload(mapData.data(), mapData.size());
+      }
+
+      if(numThreads == 1)
+      {
+        recordDraws(0);
+      }
+      else
+      {
+        std::vector<std::thread> threads;
+        for(uint32_t t = 0; t < numThreads; t++)
+          threads.push_back(std::thread(recordDraws, t));
+        for(std::thread &th : threads)
+          th.join();
+      }
+
+      VkCommandBuffer cmd = GetCommandBuffer();
+
+      vkBeginCommandBuffer(cmd, vkh::CommandBufferBeginInfo());
+
+      VkImage swapimg =
+          StartUsingBackbuffer(cmd, VK_ACCESS_TRANSFER_WRITE_BIT, VK_IMAGE_LAYOUT_GENERAL);
+
+      vkCmdClearColorImage(cmd, swapimg, VK_IMAGE_LAYOUT_GENERAL,
+                           vkh::ClearColorValue(0.2f, 0.2f, 0.2f, 1.0f), 1,
+                           vkh::ImageSubresourceRange());
+
+      vkCmdBeginRenderPass(
+          cmd, vkh::RenderPassBeginInfo(mainWindow->rp, mainWindow->GetFB(), mainWindow->scissor),
+          VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+
+      vkCmdExecuteCommands(cmd, numThreads, secondaries.data());
+
+      vkCmdEndRenderPass(cmd);
+
+      FinishUsingBackbuffer(cmd, VK_ACCESS_TRANSFER_WRITE_BIT, VK_IMAGE_LAYOUT_GENERAL);
+
+      vkEndCommandBuffer(cmd);
+
+      Submit(0, 1, {cmd}, secondaries);
+
+      if(capturing)
+      {
+        clock::time_point endStart = clock::now();
+        rdoc->EndFrameCapture(NULL, NULL);
+        endCaptureMS = std::chrono::duration<double, std::milli>(clock::now() - endStart).count();
+      }
+
+      Present();
+
+      double ms = std::chrono::duration<double, std::milli>(clock::now() - frameStart).count();
+
+      if(capturing)
+        captureFrameMS = ms;
+      else if(curFrame >= warmupFrames)
+        frameTimes.push_back(ms);
+    }
+
+    vkDeviceWaitIdle(device);
+
+    for(VkCommandPool pool : pools)
+      vkDestroyCommandPool(device, pool, NULL);
+
+    double avg = 0.0, minTime = 0.0, maxTime = 0.0, p95 = 0.0;
+
+    if(!frameTimes.empty())
+    {
+      for(double t : frameTimes)
+        avg += t;
+      avg /= double(frameTimes.size());
+
+      std::sort(frameTimes.begin(), frameTimes.end());
+      minTime = frameTimes.front();
+      maxTime = frameTimes.back();
+      p95 = frameTimes[std::min(frameTimes.size() - 1, frameTimes.size() * 95 / 100)];
+    }
+
+    printf(
+        "{\"test\": \"%s\", \"renderdoc\": %s, \"draws\": %u, \"buffers\": %u, "
+        "\"descriptors\": %u, \"maps\": %u, \"threads\": %u, \"frames\": %zu, "
+        "\"avg_ms\": %.4f, \"min_ms\": %.4f, \"max_ms\": %.4f, \"p95_ms\": %.4f, "
+        "\"capture_frame_ms\": %.4f, \"end_capture_ms\": %.4f}\n",
+        TestName, rdoc ? "true" : "false", numDraws, numBuffers, numDescriptors, numMaps,
+        numThreads, frameTimes.size(), avg, minTime, maxTime, p95, captureFrameMS, endCaptureMS);
+    fflush(stdout);
+
+    return 0;
+  }
+};
+
+REGISTER_TEST();